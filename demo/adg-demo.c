@@ -29,6 +29,12 @@
 /* Whether render the boxes to highlight the extents of every entity */
 static gboolean show_extents = FALSE;
 
+/* Whether overlay the frame rate and the timings on the drawing */
+static gboolean show_statistics = FALSE;
+
+/* Number of edits performed by the benchmark mode (0 to disable it) */
+static gint n_benchmark = 0;
+
 
 typedef struct _DemoPart DemoPart;
 
@@ -96,6 +102,10 @@ parse_args(gint *p_argc, gchar **p_argv[])
          (gpointer) _adg_version, _("Display version information"), NULL},
         {"show-extents", 'E', 0, G_OPTION_ARG_NONE,
          &show_extents, _("Show the boundary boxes of every entity"), NULL},
+        {"statistics", 'S', 0, G_OPTION_ARG_NONE,
+         &show_statistics, _("Show the frame rate and the arrange and render timings"), NULL},
+        {"benchmark", 'b', 0, G_OPTION_ARG_INT,
+         &n_benchmark, _("Edit, arrange and render the drawing offscreen N times, then exit"), "N"},
         {NULL}
     };
     GError *error;
@@ -663,6 +673,26 @@ _adg_canvas_init(AdgCanvas *canvas, DemoPart *part)
     return canvas;
 }
 
+/* Regenerates the models of part from its current dimensions */
+static void
+_adg_part_rebuild(DemoPart *part)
+{
+    adg_model_reset(ADG_MODEL(part->body));
+    adg_model_reset(ADG_MODEL(part->hole));
+    adg_model_reset(ADG_MODEL(part->axis));
+    adg_model_reset(ADG_MODEL(part->edges));
+
+    _adg_part_define_title_block(part);
+    _adg_part_define_body(part);
+    _adg_part_define_hole(part);
+    _adg_part_define_axis(part);
+
+    adg_model_changed(ADG_MODEL(part->body));
+    adg_model_changed(ADG_MODEL(part->hole));
+    adg_model_changed(ADG_MODEL(part->axis));
+    adg_model_changed(ADG_MODEL(part->edges));
+}
+
 static GtkRadioButton *
 _adg_group_get_active(GtkRadioButton *radio_group)
 {
@@ -709,21 +739,7 @@ _adg_do_edit(DemoPart *part)
     _adg_part_ui_to_string(part, &part->DATE);
 
     _adg_part_lock(part);
-
-    adg_model_reset(ADG_MODEL(part->body));
-    adg_model_reset(ADG_MODEL(part->hole));
-    adg_model_reset(ADG_MODEL(part->axis));
-    adg_model_reset(ADG_MODEL(part->edges));
-
-    _adg_part_define_title_block(part);
-    _adg_part_define_body(part);
-    _adg_part_define_hole(part);
-    _adg_part_define_axis(part);
-
-    adg_model_changed(ADG_MODEL(part->body));
-    adg_model_changed(ADG_MODEL(part->hole));
-    adg_model_changed(ADG_MODEL(part->axis));
-    adg_model_changed(ADG_MODEL(part->edges));
+    _adg_part_rebuild(part);
 
     gtk_widget_queue_draw(GTK_WIDGET(part->area));
 }
@@ -812,77 +828,51 @@ _adg_do_save_as(GtkWindow *window, GtkResponseType response, AdgCanvas *canvas)
     gtk_widget_hide(GTK_WIDGET(window));
 }
 
-static void
-_adg_print_prepare(GtkPrintOperation *operation, GtkPrintContext *context)
-{
-    gtk_print_operation_set_n_pages(operation, 1);
-}
+static GtkPrintSettings *_adg_print_settings = NULL;
 
 static void
-_adg_print_page(GtkPrintOperation *operation, GtkPrintContext *context,
-                gint page_nr, AdgEntity *canvas)
+_adg_print_done(GtkPrintOperation *operation, GtkPrintOperationResult result)
 {
-    cairo_t *cr = gtk_print_context_get_cairo_context(context);
-    cairo_matrix_t old_map;
-
-    adg_matrix_copy(&old_map, adg_entity_get_global_map(canvas));;
-
-    adg_entity_set_global_map(canvas, adg_matrix_identity());
-    adg_entity_render(canvas, cr);
+    if (result != GTK_PRINT_OPERATION_RESULT_APPLY)
+        return;
 
-    adg_entity_set_global_map(canvas, &old_map);
+    if (_adg_print_settings)
+        g_object_unref(_adg_print_settings);
+    _adg_print_settings = gtk_print_operation_get_print_settings(operation);
+    if (_adg_print_settings)
+        g_object_ref(_adg_print_settings);
 }
 
 static void
 _adg_do_print(GtkWidget *button, AdgCanvas *canvas)
 {
-    static GtkPrintSettings *settings = NULL;
     GtkWindow *window;
     GtkPrintOperation *operation;
-    GtkPageSetup *page_setup;
     GError *error;
 
     window = (GtkWindow *) gtk_widget_get_toplevel(button);
-    operation = gtk_print_operation_new();
-    page_setup = adg_canvas_get_page_setup(canvas);
+    operation = adg_canvas_print_operation_new(canvas);
     error = NULL;
 
-    if (settings)
-        gtk_print_operation_set_print_settings(operation, settings);
-    if (page_setup)
-        gtk_print_operation_set_default_page_setup(operation, page_setup);
-
-    g_signal_connect(operation, "begin-print",
-                     G_CALLBACK(_adg_print_prepare), NULL);
-    g_signal_connect(operation, "draw-page",
-                     G_CALLBACK(_adg_print_page), canvas);
-
-    gtk_print_operation_set_use_full_page(operation, FALSE);
-    gtk_print_operation_set_unit(operation, GTK_UNIT_POINTS);
+    if (_adg_print_settings)
+        gtk_print_operation_set_print_settings(operation, _adg_print_settings);
 #if GTK_CHECK_VERSION(2, 18, 0)
     gtk_print_operation_set_embed_page_setup(operation, TRUE);
 #endif
 
-    switch (gtk_print_operation_run(operation,
-                                    GTK_PRINT_OPERATION_ACTION_PRINT_DIALOG,
-                                    window, &error)) {
-
-    case GTK_PRINT_OPERATION_RESULT_APPLY:
-        if (settings)
-            g_object_unref(settings);
-        settings = gtk_print_operation_get_print_settings(operation);
-        if (settings)
-            g_object_ref(settings);
-        break;
-
-    default:
-        break;
-    }
+    /* The operation can run asynchronously, so the print
+     * settings are saved when it is done */
+    g_signal_connect(operation, "done",
+                     G_CALLBACK(_adg_print_done), NULL);
 
+    gtk_print_operation_run(operation, GTK_PRINT_OPERATION_ACTION_PRINT_DIALOG,
+                            window, &error);
     g_object_unref(operation);
 
-    if (error)
+    if (error) {
         _adg_error(error->message, window);
+        g_error_free(error);
+    }
 }
 
 static gboolean
@@ -1120,6 +1110,7 @@ _adg_main_window(GtkBuilder *builder)
     _adg_canvas_init(canvas, part);
     adg_gtk_area_set_canvas(part->area, canvas);
     adg_canvas_autoscale(canvas);
+    adg_gtk_area_switch_statistics(part->area, show_statistics);
 
     button_help = (GtkWidget *) gtk_builder_get_object(builder, "mainHelp");
     g_assert(GTK_IS_BUTTON(button_help));
@@ -1158,6 +1149,122 @@ _adg_main_window(GtkBuilder *builder)
 }
 
 
+/**
+ * _adg_benchmark:
+ * @n_edits: number of edits to perform
+ *
+ * Non-interactive mode, enabled by the --benchmark option. Builds the
+ * same drawing shown by the user interface, without any widget, and
+ * performs @n_edits edits: every edit changes some dimension (as done
+ * by _adg_do_edit()), arranges the canvas and renders it on an image
+ * surface. The time spent in every phase is printed at the end.
+ **/
+static void
+_adg_benchmark(gint n_edits)
+{
+    DemoPart *part;
+    AdgCanvas *canvas;
+    const CpmlExtents *extents;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    GTimer *timer;
+    gdouble edit, arrange, render, start;
+    gint n;
+
+    part = g_new0(DemoPart, 1);
+    part->body = adg_path_new();
+    part->hole = adg_path_new();
+    part->axis = adg_path_new();
+    part->title_block = adg_title_block_new();
+    part->edges = adg_edges_new_with_source(ADG_TRAIL(part->body));
+
+    /* Same defaults used by the user interface */
+    part->A = 50;
+    part->B = 20.6;
+    part->C = 2;
+    part->DHOLE = 2;
+    part->LHOLE = 3;
+    part->D1 = 9.3;
+    part->D2 = 6.5;
+    part->LD2 = 7;
+    part->D3 = 13.8;
+    part->LD3 = 3.5;
+    part->D4 = 6.5;
+    part->D5 = 4.5;
+    part->D6 = 7.2;
+    part->D7 = 2;
+    part->RD34 = 1;
+    part->LD5 = 5;
+    part->LD6 = 1;
+    part->LD7 = 0.5;
+    part->GROOVE = FALSE;
+    part->ZGROOVE = 16;
+    part->DGROOVE = 8.3;
+    part->LGROOVE = 1;
+    part->TITLE = g_strdup("SAMPLE DRAWING");
+    part->DRAWING = g_strdup("EXAMPLE");
+    part->AUTHOR = g_strdup("adg-demo");
+    part->DATE = g_strdup("09/03/2011");
+
+    _adg_part_rebuild(part);
+    canvas = _adg_canvas_init(adg_canvas_new(), part);
+    adg_canvas_autoscale(canvas);
+    adg_entity_arrange(ADG_ENTITY(canvas));
+
+    extents = adg_entity_get_extents(ADG_ENTITY(canvas));
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         ceil(extents->size.x),
+                                         ceil(extents->size.y));
+    cairo_surface_set_device_offset(surface, -extents->org.x, -extents->org.y);
+
+    timer = g_timer_new();
+    edit = arrange = render = 0;
+
+    for (n = 0; n < n_edits; ++n) {
+        /* Oscillate the main dimensions around their defaults */
+        start = g_timer_elapsed(timer, NULL);
+        part->A = 50 + sin(n * 0.1) * 5;
+        part->D1 = 9.3 + sin(n * 0.2) * 0.5;
+        part->LD2 = 7 + cos(n * 0.1);
+        part->GROOVE = (n & 8) != 0;
+        _adg_part_rebuild(part);
+        edit += g_timer_elapsed(timer, NULL) - start;
+
+        start = g_timer_elapsed(timer, NULL);
+        adg_entity_arrange(ADG_ENTITY(canvas));
+        arrange += g_timer_elapsed(timer, NULL) - start;
+
+        start = g_timer_elapsed(timer, NULL);
+        cr = cairo_create(surface);
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        adg_entity_render(ADG_ENTITY(canvas), cr);
+        cairo_destroy(cr);
+        cairo_surface_flush(surface);
+        render += g_timer_elapsed(timer, NULL) - start;
+    }
+
+    g_print(_("%d edits in %.3f s (%.1f edits/s)\n"), n_edits,
+            edit + arrange + render, n_edits / (edit + arrange + render));
+    g_print(_("edit    %10.3f ms per edit\n"), edit * 1000 / n_edits);
+    g_print(_("arrange %10.3f ms per edit\n"), arrange * 1000 / n_edits);
+    g_print(_("render  %10.3f ms per edit\n"), render * 1000 / n_edits);
+
+    g_timer_destroy(timer);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+    g_object_unref(part->body);
+    g_object_unref(part->hole);
+    g_object_unref(part->axis);
+    g_object_unref(part->edges);
+    g_free(part->TITLE);
+    g_free(part->DRAWING);
+    g_free(part->AUTHOR);
+    g_free(part->DATE);
+    g_free(part);
+}
+
+
 int
 main(gint argc, gchar **argv)
 {
@@ -1170,6 +1277,11 @@ main(gint argc, gchar **argv)
     parse_args(&argc, &argv);
     adg_switch_extents(show_extents);
 
+    if (n_benchmark > 0) {
+        _adg_benchmark(n_benchmark);
+        return 0;
+    }
+
     path = _demo_file("adg-demo.ui");
     if (path == NULL) {
         g_printerr(_("adg-demo.ui not found!\n"));
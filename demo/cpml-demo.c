@@ -20,11 +20,15 @@
 #include "demo.h"
 #include <cpml.h>
 #include <math.h>
+#include <string.h>
 #include <gtk/gtk.h>
 
 
 static void     parse_args              (gint           *p_argc,
                                          gchar         **p_argv[]);
+static void     benchmark               (gint            n_curves);
+
+static gint     n_benchmark = 0;
 static cairo_path_t *
                 duplicate_and_stroke    (cairo_t        *cr);
 static void     stroke_and_destroy      (cairo_t        *cr,
@@ -183,6 +187,11 @@ main(gint argc, gchar **argv)
     _demo_init(argc, argv);
     parse_args(&argc, &argv);
 
+    if (n_benchmark > 0) {
+        benchmark(n_benchmark);
+        return 0;
+    }
+
     /* Prepend the package icons path */
     if (is_installed) {
 #ifdef G_OS_WIN32
@@ -297,6 +306,8 @@ parse_args(gint *p_argc, gchar **p_argv[])
     GOptionEntry entries[] = {
         {"version", 'V', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK,
          (gpointer) version, _("Display version information"), NULL},
+        {"benchmark", 'b', 0, G_OPTION_ARG_INT,
+         &n_benchmark, _("Benchmark the offset and intersection algorithms on N random curves, then exit"), "N"},
         {NULL}
     };
 
@@ -314,6 +325,234 @@ parse_args(gint *p_argc, gchar **p_argv[])
 }
 
 
+/**********************************************
+ * Benchmark
+ **********************************************/
+
+/* Offset distance used by the benchmark: the control points
+ * of the random curves are in the [0, 100] range */
+#define BENCHMARK_OFFSET    10.
+/* Number of samples per curve used to measure the offset error */
+#define BENCHMARK_SAMPLES   16
+
+typedef struct {
+    cairo_path_data_t   data[6];
+    cairo_path_t        path;
+    CpmlSegment         segment;
+    CpmlPrimitive       primitive;
+} BenchmarkCurve;
+
+static void
+benchmark_curve_bind(BenchmarkCurve *curve)
+{
+    curve->path.status = CAIRO_STATUS_SUCCESS;
+    curve->path.data = curve->data;
+    curve->path.num_data = G_N_ELEMENTS(curve->data);
+    cpml_segment_from_cairo(&curve->segment, &curve->path);
+    cpml_primitive_from_segment(&curve->primitive, &curve->segment);
+}
+
+static void
+benchmark_curve_init(BenchmarkCurve *curve, GRand *rand)
+{
+    gint n;
+
+    curve->data[0].header.type = CAIRO_PATH_MOVE_TO;
+    curve->data[0].header.length = 2;
+    curve->data[2].header.type = CAIRO_PATH_CURVE_TO;
+    curve->data[2].header.length = 4;
+
+    for (n = 1; n < 6; ++n) {
+        if (n == 2)
+            continue;
+        curve->data[n].point.x = g_rand_double_range(rand, 0, 100);
+        curve->data[n].point.y = g_rand_double_range(rand, 0, 100);
+    }
+
+    benchmark_curve_bind(curve);
+}
+
+static void
+benchmark_curve_copy(BenchmarkCurve *curve, const BenchmarkCurve *src)
+{
+    memcpy(curve->data, src->data, sizeof(curve->data));
+    benchmark_curve_bind(curve);
+}
+
+/* Maximum distance between the exact offset of curve and offseted */
+static double
+benchmark_offset_error(const BenchmarkCurve *curve,
+                       const BenchmarkCurve *offseted)
+{
+    CpmlPair exact, pair;
+    double error, max_error, pos;
+    gint n;
+
+    max_error = 0;
+
+    for (n = 0; n <= BENCHMARK_SAMPLES; ++n) {
+        cpml_curve_put_offset_at_time(&curve->primitive,
+                                      (double) n / BENCHMARK_SAMPLES,
+                                      BENCHMARK_OFFSET, &exact);
+        pos = cpml_primitive_get_closest_pos(&offseted->primitive, &exact);
+        cpml_curve_put_pair_at_time(&offseted->primitive, pos, &pair);
+        error = cpml_pair_distance(&exact, &pair);
+
+        /* A broken offset is reported as a failure by the caller */
+        if (! isfinite(error))
+            return error;
+
+        if (error > max_error)
+            max_error = error;
+    }
+
+    return max_error;
+}
+
+static void
+benchmark_offset(const BenchmarkCurve *curves, gint n_curves)
+{
+    static const struct {
+        CpmlCurveOffsetAlgorithm algorithm;
+        const gchar *name;
+    } algorithms[] = {
+        { CPML_CURVE_OFFSET_ALGORITHM_GEOMETRICAL, "geometrical" },
+        { CPML_CURVE_OFFSET_ALGORITHM_HANDCRAFT,   "handcraft" },
+        { CPML_CURVE_OFFSET_ALGORITHM_BAIOCA,      "baioca" }
+    };
+    BenchmarkCurve *offseted;
+    CpmlOffsetContext context;
+    GTimer *timer;
+    gdouble elapsed, error, max_error, sum_error;
+    gint n, i, n_failures;
+
+    offseted = g_new(BenchmarkCurve, n_curves);
+    timer = g_timer_new();
+    context.tolerance = 0;
+
+    g_print("%-16s %14s %12s %12s %9s\n",
+            "offset", "curves/s", "max error", "mean error", "failures");
+
+    for (i = 0; i < G_N_ELEMENTS(algorithms); ++i) {
+        context.algorithm = algorithms[i].algorithm;
+
+        for (n = 0; n < n_curves; ++n)
+            benchmark_curve_copy(&offseted[n], &curves[n]);
+
+        g_timer_start(timer);
+        for (n = 0; n < n_curves; ++n)
+            cpml_primitive_offset_full(&offseted[n].primitive,
+                                       BENCHMARK_OFFSET, &context);
+        g_timer_stop(timer);
+        elapsed = g_timer_elapsed(timer, NULL);
+
+        max_error = sum_error = 0;
+        n_failures = 0;
+        for (n = 0; n < n_curves; ++n) {
+            error = benchmark_offset_error(&curves[n], &offseted[n]);
+            if (! isfinite(error)) {
+                ++ n_failures;
+                continue;
+            }
+            if (error > max_error)
+                max_error = error;
+            sum_error += error;
+        }
+
+        g_print("%-16s %14.0f %12.6f %12.6f %9d\n", algorithms[i].name,
+                elapsed > 0 ? n_curves / elapsed : 0., max_error,
+                n_failures < n_curves ? sum_error / (n_curves - n_failures) : 0.,
+                n_failures);
+    }
+
+    g_timer_destroy(timer);
+    g_free(offseted);
+}
+
+static void
+benchmark_intersections(const BenchmarkCurve *curves, gint n_curves)
+{
+    BenchmarkCurve line;
+    CpmlPair dest[9];
+    GTimer *timer;
+    gdouble elapsed;
+    gulong n_found;
+    gint n;
+
+    timer = g_timer_new();
+
+    g_print("\n%-16s %14s %12s\n", "intersections", "pairs/s", "found");
+
+    /* Curve against curve: every curve with the next one */
+    n_found = 0;
+    g_timer_start(timer);
+    for (n = 0; n < n_curves; ++n)
+        n_found += cpml_primitive_put_intersections(&curves[n].primitive,
+                                                    &curves[(n + 1) % n_curves].primitive,
+                                                    G_N_ELEMENTS(dest), dest);
+    g_timer_stop(timer);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_print("%-16s %14.0f %12lu\n", "curve/curve",
+            elapsed > 0 ? n_curves / elapsed : 0., n_found);
+
+    /* Curve against line: the chord of the next curve is used */
+    n_found = 0;
+    g_timer_start(timer);
+    for (n = 0; n < n_curves; ++n) {
+        benchmark_curve_copy(&line, &curves[(n + 1) % n_curves]);
+        line.data[2].header.type = CAIRO_PATH_LINE_TO;
+        line.data[2].header.length = 2;
+        line.data[3] = line.data[5];
+        line.path.num_data = 4;
+        cpml_segment_from_cairo(&line.segment, &line.path);
+        cpml_primitive_from_segment(&line.primitive, &line.segment);
+
+        n_found += cpml_primitive_put_intersections(&curves[n].primitive,
+                                                    &line.primitive,
+                                                    G_N_ELEMENTS(dest), dest);
+    }
+    g_timer_stop(timer);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_print("%-16s %14.0f %12lu\n", "curve/line",
+            elapsed > 0 ? n_curves / elapsed : 0., n_found);
+
+    g_timer_destroy(timer);
+}
+
+/**
+ * benchmark:
+ * @n_curves: number of random curves to generate
+ *
+ * Non-interactive mode, enabled by the --benchmark option. Generates
+ * a corpus of @n_curves random Bézier curves (always the same, as the
+ * seed is fixed) and prints the throughput and the error of every
+ * offset algorithm, followed by the throughput of the intersection
+ * routines. The offset error is the maximum distance between the
+ * exact offset (cpml_curve_put_offset_at_time()) and the offset
+ * curve, sampled at regular time intervals.
+ **/
+static void
+benchmark(gint n_curves)
+{
+    BenchmarkCurve *curves;
+    GRand *rand;
+    gint n;
+
+    curves = g_new(BenchmarkCurve, n_curves);
+    rand = g_rand_new_with_seed(n_curves);
+
+    for (n = 0; n < n_curves; ++n)
+        benchmark_curve_init(&curves[n], rand);
+
+    g_rand_free(rand);
+
+    benchmark_offset(curves, n_curves);
+    benchmark_intersections(curves, n_curves);
+
+    g_free(curves);
+}
+
+
 static cairo_path_t *
 duplicate_and_stroke(cairo_t *cr)
 {
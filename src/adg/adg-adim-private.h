@@ -42,8 +42,16 @@ G_BEGIN_DECLS
  * [12] = second extension line end
  */
 
+typedef struct _AdgADimInput   AdgADimInput;
 typedef struct _AdgADimPrivate AdgADimPrivate;
 
+/* Everything the angular geometry depends on, compared bitwise */
+struct _AdgADimInput {
+    CpmlPair              ref1, ref2, pos, org1, org2;
+    gdouble               from_offset, to_offset;
+    gdouble               spacing, level;
+};
+
 struct _AdgADimPrivate {
     AdgPoint             *org1;
     AdgPoint             *org2;
@@ -70,6 +78,11 @@ struct _AdgADimPrivate {
         cairo_matrix_t    global_map;
     }                     quote;
 
+    struct {
+        gboolean          is_valid;
+        AdgADimInput      input;
+    }                     cache;
+
     struct {
         cairo_path_t      path;
         cairo_path_data_t data[13];
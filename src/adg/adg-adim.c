@@ -51,10 +51,13 @@
 #include "adg-toy-text.h"
 #include "adg-dim.h"
 #include "adg-dim-private.h"
+#include "adg-entity-private.h"
 
 #include "adg-adim.h"
 #include "adg-adim-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_adim_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_adim_parent_class)
@@ -83,15 +86,19 @@ static void             _adg_set_property       (GObject        *object,
 static void             _adg_global_changed     (AdgEntity      *entity);
 static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_invalidate         (AdgEntity      *entity);
+static void             _adg_geometry_changed   (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
 static gchar *          _adg_default_value      (AdgDim         *dim);
 static gboolean         _adg_compute_geometry   (AdgDim         *dim);
 static void             _adg_update_entities    (AdgADim        *adim);
 static void             _adg_unset_trail        (AdgADim        *adim);
 static void             _adg_dispose_trail      (AdgADim        *adim);
 static void             _adg_dispose_markers    (AdgADim        *adim);
+static void             _adg_reset_markers      (AdgADim        *adim);
+static gboolean         _adg_update_points      (AdgADim        *adim);
 static gboolean         _adg_get_info           (AdgADim        *adim,
                                                  CpmlVector      vector[],
                                                  CpmlPair       *center,
@@ -121,8 +128,10 @@ adg_adim_class_init(AdgADimClass *klass)
     entity_class->global_changed = _adg_global_changed;
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
+    entity_class->geometry_changed = _adg_geometry_changed;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
 
     dim_class->default_value = _adg_default_value;
     dim_class->compute_geometry = _adg_compute_geometry;
@@ -188,6 +197,7 @@ adg_adim_init(AdgADim *adim)
     data->trail = NULL;
     data->marker1 = NULL;
     data->marker2 = NULL;
+    data->cache.is_valid = FALSE;
 
     adim->data = data;
 
@@ -201,9 +211,12 @@ adg_adim_init(AdgADim *adim)
     adg_dim_style_set_number_arguments(dim_style, "Dm");
     adg_dim_style_set_number_format(dim_style, "%g°(%g')");
 
-    adg_entity_set_style((AdgEntity *) adim,
-                         ADG_DRESS_DIMENSION,
-                         (AdgStyle *) dim_style);
+    /* Every instance shares the same tweaked style */
+    style = adg_style_intern((AdgStyle *) dim_style);
+    g_object_unref(dim_style);
+
+    adg_entity_set_style((AdgEntity *) adim, ADG_DRESS_DIMENSION, style);
+    g_object_unref(style);
 }
 
 static void
@@ -790,9 +803,9 @@ _adg_invalidate(AdgEntity *entity)
     adim = (AdgADim *) entity;
     data = adim->data;
 
-    _adg_dispose_trail(adim);
-    _adg_dispose_markers(adim);
+    /* The trail and the markers are kept for the next arrange */
     _adg_unset_trail(adim);
+    _adg_reset_markers(adim);
 
     if (data->org1)
         adg_point_invalidate(data->org1);
@@ -803,6 +816,30 @@ _adg_invalidate(AdgEntity *entity)
         _ADG_OLD_ENTITY_CLASS->invalidate(entity);
 }
 
+static void
+_adg_geometry_changed(AdgEntity *entity)
+{
+    AdgADim *adim = (AdgADim *) entity;
+    AdgADimPrivate *data = adim->data;
+
+    /* Same as invalidate but without checking the markers against
+     * the dim style, that is not affected by geometric changes */
+    _adg_unset_trail(adim);
+
+    if (data->marker1 != NULL)
+        adg_entity_invalidate((AdgEntity *) data->marker1);
+    if (data->marker2 != NULL)
+        adg_entity_invalidate((AdgEntity *) data->marker2);
+
+    if (data->org1)
+        adg_point_invalidate(data->org1);
+    if (data->org2)
+        adg_point_invalidate(data->org2);
+
+    if (_ADG_OLD_ENTITY_CLASS->geometry_changed != NULL)
+        _ADG_OLD_ENTITY_CLASS->geometry_changed(entity);
+}
+
 static void
 _adg_arrange(AdgEntity *entity)
 {
@@ -835,8 +872,8 @@ _adg_arrange(AdgEntity *entity)
         return;
     }
 
-    global = adg_entity_get_global_matrix(entity);
-    local = adg_entity_get_local_matrix(entity);
+    global = _adg_entity_get_global_matrix(entity);
+    local = _adg_entity_get_local_matrix(entity);
     extents.is_defined = FALSE;
 
     cpml_pair_copy(&ref1, (CpmlPair *) adg_dim_get_ref1(dim));
@@ -940,6 +977,25 @@ _adg_arrange(AdgEntity *entity)
     adg_entity_set_extents(entity, &extents);
 }
 
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgADimPrivate *data = ((AdgADim *) entity)->data;
+    gsize usage;
+
+    usage = _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgADimPrivate);
+
+    if (data->trail != NULL)
+        usage += adg_trail_get_memory_usage(data->trail);
+    if (data->marker1 != NULL)
+        usage += adg_entity_get_memory_usage((AdgEntity *) data->marker1);
+    if (data->marker2 != NULL)
+        usage += adg_entity_get_memory_usage((AdgEntity *) data->marker2);
+
+    return usage;
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -968,7 +1024,7 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     if (data->marker2 != NULL)
         adg_entity_render((AdgEntity *) data->marker2, cr);
 
-    cairo_transform(cr, adg_entity_get_global_matrix(entity));
+    cairo_transform(cr, _adg_entity_get_global_matrix(entity));
     dress = adg_dim_style_get_line_dress(dim_style);
     adg_entity_apply_dress(entity, dress, cr);
 
@@ -1009,9 +1065,10 @@ _adg_compute_geometry(AdgDim *dim)
     CpmlVector vector[3];
     CpmlPair center;
     gdouble distance;
+    AdgADimInput input;
 
     adim = (AdgADim *) dim;
-    if (! _adg_get_info(adim, vector, &center, &distance))
+    if (! _adg_update_points(adim))
         return FALSE;
 
     data = adim->data;
@@ -1021,6 +1078,26 @@ _adg_compute_geometry(AdgDim *dim)
     spacing = adg_dim_style_get_baseline_spacing(dim_style);
     level = adg_dim_get_level((AdgDim *) adim);
 
+    /* Skip the whole computation when no input has changed */
+    memset(&input, 0, sizeof(input));
+    cpml_pair_copy(&input.ref1, (CpmlPair *) adg_dim_get_ref1(dim));
+    cpml_pair_copy(&input.ref2, (CpmlPair *) adg_dim_get_ref2(dim));
+    cpml_pair_copy(&input.pos, (CpmlPair *) adg_dim_get_pos(dim));
+    cpml_pair_copy(&input.org1, (CpmlPair *) data->org1);
+    cpml_pair_copy(&input.org2, (CpmlPair *) data->org2);
+    input.from_offset = from_offset;
+    input.to_offset = to_offset;
+    input.spacing = spacing;
+    input.level = level;
+
+    if (data->cache.is_valid &&
+        memcmp(&input, &data->cache.input, sizeof(input)) == 0)
+        return TRUE;
+
+    data->cache.is_valid = FALSE;
+    if (! _adg_get_info(adim, vector, &center, &distance))
+        return FALSE;
+
     /* shift.from1 */
     cpml_vector_set_length(&vector[0], from_offset);
     cpml_pair_copy(&data->shift.from1, &vector[0]);
@@ -1067,6 +1144,8 @@ _adg_compute_geometry(AdgDim *dim)
     data->point.base12.x = vector[1].x + center.x;
     data->point.base12.y = vector[1].y + center.y;
 
+    data->cache.input = input;
+    data->cache.is_valid = TRUE;
     return TRUE;
 }
 
@@ -1133,16 +1212,46 @@ _adg_dispose_markers(AdgADim *adim)
     }
 }
 
+static void
+_adg_reset_markers(AdgADim *adim)
+{
+    AdgADimPrivate *data;
+    AdgDimStyle *dim_style;
+
+    data = adim->data;
+    dim_style = _ADG_GET_DIM_STYLE(adim);
+
+    /* Without a resolved dim style the markers cannot be checked */
+    if (dim_style == NULL) {
+        _adg_dispose_markers(adim);
+        return;
+    }
+
+    if (data->marker1 != NULL) {
+        if (adg_dim_style_reset_marker1(dim_style, data->marker1)) {
+            adg_entity_invalidate((AdgEntity *) data->marker1);
+        } else {
+            g_object_unref(data->marker1);
+            data->marker1 = NULL;
+        }
+    }
+
+    if (data->marker2 != NULL) {
+        if (adg_dim_style_reset_marker2(dim_style, data->marker2)) {
+            adg_entity_invalidate((AdgEntity *) data->marker2);
+        } else {
+            g_object_unref(data->marker2);
+            data->marker2 = NULL;
+        }
+    }
+}
+
 static gboolean
-_adg_get_info(AdgADim *adim, CpmlVector vector[],
-              CpmlPair *center, gdouble *distance)
+_adg_update_points(AdgADim *adim)
 {
     AdgDim *dim;
     AdgADimPrivate *data;
     AdgPoint *ref1_point, *ref2_point, *pos_point;
-    const CpmlPair *ref1, *ref2, *pos;
-    const CpmlPair *org1, *org2;
-    gdouble factor;
 
     dim = (AdgDim *) adim;
     data = adim->data;
@@ -1175,9 +1284,24 @@ _adg_get_info(AdgADim *adim, CpmlVector vector[],
         return FALSE;
     }
 
-    ref1 = (CpmlPair *) ref1_point;
-    ref2 = (CpmlPair *) ref2_point;
-    pos  = (CpmlPair *) pos_point;
+    return TRUE;
+}
+
+static gboolean
+_adg_get_info(AdgADim *adim, CpmlVector vector[],
+              CpmlPair *center, gdouble *distance)
+{
+    AdgDim *dim;
+    AdgADimPrivate *data;
+    const CpmlPair *ref1, *ref2, *pos;
+    const CpmlPair *org1, *org2;
+    gdouble factor;
+
+    dim = (AdgDim *) adim;
+    data = adim->data;
+    ref1 = (CpmlPair *) adg_dim_get_ref1(dim);
+    ref2 = (CpmlPair *) adg_dim_get_ref2(dim);
+    pos  = (CpmlPair *) adg_dim_get_pos(dim);
     org1 = (CpmlPair *) data->org1;
     org2 = (CpmlPair *) data->org2;
 
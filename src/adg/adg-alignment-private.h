@@ -29,6 +29,13 @@ typedef struct _AdgAlignmentPrivate AdgAlignmentPrivate;
 struct _AdgAlignmentPrivate {
     CpmlPair     factor;
     CpmlVector   shift;
+
+    struct {
+        gboolean        is_defined;
+        cairo_matrix_t  ctm;
+        CpmlExtents     extents;
+        CpmlExtents     measured;
+    }            cache;
 };
 
 G_END_DECLS
@@ -54,6 +54,7 @@
 #include "adg-internal.h"
 #include "adg-entity.h"
 #include "adg-container.h"
+#include "adg-entity-private.h"
 
 #include "adg-alignment.h"
 #include "adg-alignment-private.h"
@@ -78,9 +79,12 @@ static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
+static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_measure            (AdgEntity      *entity,
+                                                 const cairo_matrix_t *ctm);
 
 
 static void
@@ -98,6 +102,7 @@ adg_alignment_class_init(AdgAlignmentClass *klass)
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
+    entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
 
@@ -120,6 +125,7 @@ adg_alignment_init(AdgAlignment *alignment)
     data->factor.y = 0;
     data->shift.x = 0;
     data->shift.y = 0;
+    data->cache.is_defined = FALSE;
 
     alignment->data = data;
 }
@@ -152,10 +158,9 @@ _adg_set_property(GObject *object, guint prop_id,
     switch (prop_id) {
     case PROP_FACTOR:
         pair = g_value_get_boxed(value);
-        if (! cpml_pair_equal(&data->factor, pair)) {
-            cpml_pair_copy(&data->factor, pair);
-            adg_entity_invalidate((AdgEntity *) object);
-        }
+        /* The children are not affected by the factor: the property
+         * notification is enough to have the shift recomputed */
+        cpml_pair_copy(&data->factor, pair);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -270,52 +275,57 @@ adg_alignment_get_factor(AdgAlignment *alignment)
 }
 
 
+static void
+_adg_invalidate(AdgEntity *entity)
+{
+    AdgAlignmentPrivate *data = ((AdgAlignment *) entity)->data;
+
+    data->cache.is_defined = FALSE;
+
+    if (_ADG_OLD_ENTITY_CLASS->invalidate)
+        _ADG_OLD_ENTITY_CLASS->invalidate(entity);
+}
+
 static void
 _adg_arrange(AdgEntity *entity)
 {
     AdgAlignmentPrivate *data;
-    const CpmlExtents *extents;
     CpmlExtents new_extents;
-    cairo_matrix_t ctm, ctm_inverted, old_map;
+    cairo_matrix_t ctm;
 
     if (_ADG_OLD_ENTITY_CLASS->arrange == NULL)
         return;
 
     data = ((AdgAlignment *) entity)->data;
-    extents = adg_entity_get_extents(entity);
     data->shift.x = 0;
     data->shift.y = 0;
 
+    /* Arrange the children in place */
+    _ADG_OLD_ENTITY_CLASS->arrange(entity);
+
     /* The shift is performed only when relevant */
     if (data->factor.x != 0 || data->factor.y != 0) {
-        /* Force the ctm to be the identity matrix */
-        adg_matrix_copy(&old_map, adg_entity_get_global_map(entity));
         adg_matrix_copy(&ctm, adg_entity_get_global_map(entity));
-        adg_matrix_transform(&ctm, adg_entity_get_local_matrix(entity),
+        adg_matrix_transform(&ctm, _adg_entity_get_local_matrix(entity),
                              ADG_TRANSFORM_AFTER);
-        adg_matrix_copy(&ctm_inverted, &ctm);
-        cairo_matrix_invert(&ctm_inverted);
-        adg_entity_transform_global_map(entity, &ctm_inverted,
-                                        ADG_TRANSFORM_AFTER);
-        adg_entity_global_changed(entity);
-
-        /* Calculating the shift */
-        _ADG_OLD_ENTITY_CLASS->arrange(entity);
-        extents = adg_entity_get_extents(entity);
-        if (extents->is_defined) {
-            data->shift.x = -extents->size.x * data->factor.x;
-            data->shift.y = -extents->size.y * data->factor.y;
+
+        /* Children with the same extents under the same ctm have not
+         * changed, so the size measured last time is still valid */
+        if (! data->cache.is_defined ||
+            ! adg_matrix_equal(&ctm, &data->cache.ctm) ||
+            ! cpml_extents_equal(_adg_entity_get_extents(entity),
+                                 &data->cache.extents))
+            _adg_measure(entity, &ctm);
+
+        if (data->cache.measured.is_defined) {
+            data->shift.x = -data->cache.measured.size.x * data->factor.x;
+            data->shift.y = -data->cache.measured.size.y * data->factor.y;
             cpml_vector_transform(&data->shift, &ctm);
         }
-
-        /* Restore the old global map */
-        adg_entity_set_global_map(entity, &old_map);
-        adg_entity_global_changed(entity);
     }
 
     /* Add the shift to the extents */
-    _ADG_OLD_ENTITY_CLASS->arrange(entity);
-    cpml_extents_copy(&new_extents, adg_entity_get_extents(entity));
+    cpml_extents_copy(&new_extents, _adg_entity_get_extents(entity));
     new_extents.org.x += data->shift.x;
     new_extents.org.y += data->shift.y;
     adg_entity_set_extents(entity, &new_extents);
@@ -334,3 +344,34 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     cairo_translate(cr, data->shift.x, data->shift.y);
     _ADG_OLD_ENTITY_CLASS->render(entity, cr);
 }
+
+/* Measures the children of @entity with an identity ctm and
+ * rearranges them in place, updating the alignment cache */
+static void
+_adg_measure(AdgEntity *entity, const cairo_matrix_t *ctm)
+{
+    AdgAlignmentPrivate *data;
+    cairo_matrix_t ctm_inverted, old_map;
+
+    data = ((AdgAlignment *) entity)->data;
+
+    /* Force the ctm to be the identity matrix */
+    adg_matrix_copy(&old_map, adg_entity_get_global_map(entity));
+    adg_matrix_copy(&ctm_inverted, ctm);
+    cairo_matrix_invert(&ctm_inverted);
+    adg_entity_transform_global_map(entity, &ctm_inverted,
+                                    ADG_TRANSFORM_AFTER);
+    adg_entity_global_changed(entity);
+
+    _ADG_OLD_ENTITY_CLASS->arrange(entity);
+    cpml_extents_copy(&data->cache.measured, _adg_entity_get_extents(entity));
+
+    /* Restore the old global map */
+    adg_entity_set_global_map(entity, &old_map);
+    adg_entity_global_changed(entity);
+
+    _ADG_OLD_ENTITY_CLASS->arrange(entity);
+    cpml_extents_copy(&data->cache.extents, _adg_entity_get_extents(entity));
+    adg_matrix_copy(&data->cache.ctm, ctm);
+    data->cache.is_defined = TRUE;
+}
@@ -30,6 +30,12 @@
  * on #AdgArrow entities.
  * </para></note>
  *
+ * The model of an arrow is a template of unitary size, scaled and
+ * positioned by the local matrix of every instance. Arrows with the
+ * same #AdgArrow:angle share the same template, so rendering many
+ * identical arrows costs a single path and one transformation per
+ * arrow. The shared template must be considered read-only.
+ *
  * Since: 1.0
  **/
 
@@ -49,10 +55,26 @@
 #include "adg-path.h"
 #include "adg-marker.h"
 #include "adg-entity-private.h"
+#include "adg-trail-private.h"
 
 #include "adg-arrow.h"
 #include "adg-arrow-private.h"
 
+/* Upper limit of the shared templates: arrows with other angles
+ * get their own model */
+#define _ADG_MAX_TEMPLATES      16
+
+
+typedef struct _AdgArrowTemplate AdgArrowTemplate;
+
+struct _AdgArrowTemplate {
+    gdouble      angle;
+    AdgModel    *model;
+};
+
+
+G_LOCK_DEFINE_STATIC(_adg_templates);
+
 
 G_DEFINE_TYPE(AdgArrow, adg_arrow, ADG_TYPE_MARKER)
 
@@ -74,6 +96,8 @@ static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
 static AdgModel *       _adg_create_model       (AdgMarker      *marker);
+static AdgModel *       _adg_build_model        (gdouble         angle);
+static GArray *         _adg_templates = NULL;
 
 
 static void
@@ -145,10 +169,16 @@ _adg_set_property(GObject *object, guint prop_id,
                   const GValue *value, GParamSpec *pspec)
 {
     AdgArrowPrivate *data = ((AdgArrow *) object)->data;
+    gdouble angle;
 
     switch (prop_id) {
     case PROP_ANGLE:
-        data->angle = cpml_angle(g_value_get_double(value));
+        angle = cpml_angle(g_value_get_double(value));
+        if (angle != data->angle) {
+            data->angle = angle;
+            /* The cached model depends on the angle */
+            adg_marker_set_model((AdgMarker *) object, NULL);
+        }
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -254,7 +284,7 @@ _adg_arrange(AdgEntity *entity)
         return;
 
     cpml_extents_copy(&new_extents, extents);
-    cpml_extents_transform(&new_extents, adg_entity_get_local_matrix(entity));
+    cpml_extents_transform(&new_extents, _adg_entity_get_local_matrix(entity));
     adg_entity_set_extents(entity, &new_extents);
 }
 
@@ -268,12 +298,11 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     if (model == NULL)
         return;
 
-    cairo_path = adg_trail_get_cairo_path((AdgTrail *) model);
+    cairo_path = _adg_trail_get_cairo_path((AdgTrail *) model);
 
     if (cairo_path != NULL) {
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_global_matrix(entity));
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, adg_entity_get_combined_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
@@ -285,12 +314,52 @@ static AdgModel *
 _adg_create_model(AdgMarker *marker)
 {
     AdgArrowPrivate *data;
+    AdgArrowTemplate *template;
+    AdgModel *model;
+    guint n;
+
+    data = ((AdgArrow *) marker)->data;
+    model = NULL;
+
+    G_LOCK(_adg_templates);
+
+    if (_adg_templates == NULL)
+        _adg_templates = g_array_new(FALSE, FALSE, sizeof(AdgArrowTemplate));
+
+    for (n = 0; n < _adg_templates->len; ++n) {
+        template = &g_array_index(_adg_templates, AdgArrowTemplate, n);
+        if (template->angle == data->angle) {
+            model = g_object_ref(template->model);
+            break;
+        }
+    }
+
+    if (model == NULL) {
+        model = _adg_build_model(data->angle);
+
+        if (_adg_templates->len < _ADG_MAX_TEMPLATES) {
+            AdgArrowTemplate new_template;
+
+            /* The template is held until the end of the program */
+            new_template.angle = data->angle;
+            new_template.model = g_object_ref(model);
+            g_array_append_val(_adg_templates, new_template);
+        }
+    }
+
+    G_UNLOCK(_adg_templates);
+
+    return model;
+}
+
+static AdgModel *
+_adg_build_model(gdouble angle)
+{
     AdgPath *path;
     CpmlPair p1, p2;
 
-    data = ((AdgArrow *) marker)->data;
     path = adg_path_new();
-    cpml_vector_from_angle(&p1, data->angle / 2);
+    cpml_vector_from_angle(&p1, angle / 2);
     p2.x = p1.x;
     p2.y = -p1.y;
 
@@ -299,5 +368,10 @@ _adg_create_model(AdgMarker *marker)
     adg_path_line_to(path, &p2);
     adg_path_close(path);
 
+    /* Fill the caches now: the template is accessed concurrently by
+     * every arrow using it, so it must be read-only from now on */
+    adg_trail_get_cairo_path((AdgTrail *) path);
+    adg_trail_get_extents((AdgTrail *) path);
+
     return (AdgModel *) path;
 }
@@ -25,6 +25,15 @@
 G_BEGIN_DECLS
 
 typedef struct _AdgCanvasPrivate AdgCanvasPrivate;
+typedef struct _AdgArrangeFrame  AdgArrangeFrame;
+
+/* An entry of the explicit stack used by adg_canvas_arrange_step():
+ * containers are pushed twice, the first time to be expanded into
+ * their children and the second time to be arranged themselves */
+struct _AdgArrangeFrame {
+    AdgEntity     *entity;
+    gboolean       expanded;
+};
 
 struct _AdgCanvasPrivate {
     CpmlPair       size;
@@ -36,6 +45,17 @@ struct _AdgCanvasPrivate {
     gdouble        top_margin, right_margin, bottom_margin, left_margin;
     gboolean       has_frame;
     gdouble        top_padding, right_padding, bottom_padding, left_padding;
+    gboolean       has_render_list;
+    GPtrArray     *render_nodes;
+    GPtrArray     *render_list;
+    GArray        *render_layers;
+    guint32        hidden_layers;
+    AdgSpatialIndex *spatial_index;
+    CpmlExtents    damage;
+    GHashTable    *damaged;
+    gboolean       is_damaged;
+    gboolean       damage_all;
+    GArray        *arrange_stack;
 };
 
 G_END_DECLS
@@ -58,6 +58,21 @@
  * simply ignoredby the arrange phase. They are still used by
  * adg_canvas_autoscale() though, if called.
  *
+ * Different canvases can be generated and rendered in parallel on
+ * different threads, as long as they do not share any entity, model
+ * or style instance: these objects are not thread-safe and must be
+ * accessed by one thread at a time. What is shared by the whole
+ * process (the dress register, the font map used by #AdgText and the
+ * type registrations) is thread-safe. adg_model_freeze_changes() is
+ * global too, so it should not be used while other threads are
+ * generating drawings.
+ *
+ * Before arranging its children, the canvas shapes in a single pass
+ * the text of every #AdgTextual entity it contains (see
+ * adg_textual_shape()), so text shaping is not interleaved with the
+ * geometric work. The texts built by other entities while arranging,
+ * e.g. the quotes of the dimensions, are still shaped on demand.
+ *
  * Since: 1.0
  **/
 
@@ -83,6 +98,7 @@
  * AdgCanvasError:
  * @ADG_CANVAS_ERROR_SURFACE: Invalid surface type.
  * @ADG_CANVAS_ERROR_CAIRO: The underlying cairo library returned an error.
+ * @ADG_CANVAS_ERROR_SNAPSHOT: Invalid, incompatible or unsupported snapshot.
  *
  * Error codes returned by #AdgCanvas methods.
  *
@@ -91,14 +107,36 @@
 
 
 #include "adg-internal.h"
+#include <math.h>
+#include <string.h>
 
 #include "adg-container.h"
 #include "adg-table.h"
 #include "adg-title-block.h"
 #include "adg-style.h"
 #include "adg-color-style.h"
+#include "adg-dash.h"
+#include "adg-line-style.h"
 #include "adg-dress.h"
 #include "adg-param-dress.h"
+#include "adg-spatial-index.h"
+#include "adg-textual.h"
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-stroke.h"
+#include "adg-hatch.h"
+#include "adg-instance-array.h"
+#include "adg-path.h"
+#include "adg-edges.h"
+#include "adg-point.h"
+#include "adg-alignment.h"
+#include "adg-dim.h"
+#include "adg-render-context.h"
+#include "adg-entity-private.h"
+#include "adg-container-private.h"
+#include "adg-trail-private.h"
+#include "adg-table-private.h"
+#include "adg-instance-array-private.h"
 
 #include <adg-canvas.h>
 #include "adg-canvas-private.h"
@@ -112,14 +150,90 @@
 #ifdef CAIRO_HAS_SVG_SURFACE
 #include <cairo-svg.h>
 #endif
+#ifdef SNAPSHOT_ENABLED
+#include <cairo-script.h>
+#include <cairo-script-interpreter.h>
+#endif
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_canvas_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_canvas_parent_class)
+#define _ADG_OLD_CONTAINER_CLASS  ((AdgContainerClass *) adg_canvas_parent_class)
+
+#define _ADG_SNAPSHOT_MAGIC    "ADGS"
+#define _ADG_SNAPSHOT_VERSION  1
+
+/* Number of vertices used to approximate a curve in DXF */
+#define _ADG_DXF_CURVE_STEPS   16
 
 
 G_DEFINE_TYPE(AdgCanvas, adg_canvas, ADG_TYPE_CONTAINER)
 
+/* A snapshot is this header followed by script_size bytes of
+ * cairo script, i.e. the serialized cairo operations of the
+ * rendered drawing */
+typedef struct {
+    gchar               magic[4];
+    guint32             version;
+    guint32             script_size;
+    guint32             reserved;
+    gdouble             width;
+    gdouble             height;
+} _AdgSnapshotHeader;
+
+/* State of adg_canvas_export_dxf() and adg_canvas_export_stream():
+ * the output is accumulated in buffer and flushed to write_func
+ * after every entity */
+typedef struct {
+    cairo_write_func_t  write_func;
+    gpointer            closure;
+    GString            *buffer;
+    cairo_status_t      status;
+} AdgDxfWriter;
+
+/* State of adg_canvas_export_svg(): the shared definitions are
+ * collected while walking the canvas and keyed on their contents,
+ * so identical shapes and styles are emitted only once */
+typedef struct {
+    GString            *style;
+    GString            *defs;
+    GString            *body;
+    GHashTable         *classes;
+    GHashTable         *paths;
+    GHashTable         *images;
+    gdouble             factor;
+    guint32             hidden_layers;
+} AdgSvgWriter;
+
+/* State of adg_canvas_export_tiled(): the scanlines are compressed
+ * on the fly into IDAT chunks of about ADG_PNG_CHUNK bytes, so only
+ * one strip of pixels and one chunk are kept in memory */
+#define ADG_PNG_CHUNK           65536
+
+typedef struct {
+    cairo_write_func_t  write_func;
+    gpointer            closure;
+    cairo_status_t      status;
+    guchar              chunk[ADG_PNG_CHUNK + 16];
+    guint               chunk_len;
+    guint32             bits;
+    guint               n_bits;
+    gint                last;
+    guint               run;
+    guint32             adler_a, adler_b;
+    guint               adler_pending;
+} AdgPngWriter;
+
+/* A page of adg_canvas_export_sheets_full(): recording is NULL
+ * when the sheet is rendered straight on the document */
+typedef struct {
+    AdgCanvas          *canvas;
+    cairo_surface_t    *recording;
+    gdouble             factor;
+    gdouble             width, height;
+    gdouble             left, top;
+} AdgSheetJob;
+
 enum {
     PROP_0,
     PROP_SIZE,
@@ -136,7 +250,13 @@ enum {
     PROP_TOP_PADDING,
     PROP_RIGHT_PADDING,
     PROP_BOTTOM_PADDING,
-    PROP_LEFT_PADDING
+    PROP_LEFT_PADDING,
+    PROP_HAS_RENDER_LIST
+};
+
+enum {
+    DAMAGED,
+    LAST_SIGNAL
 };
 
 
@@ -153,15 +273,219 @@ static void             _adg_global_changed     (AdgEntity      *entity);
 static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
+static void             _adg_render_backdrop    (AdgCanvas      *canvas,
+                                                 cairo_t        *cr);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_render_form        (AdgCanvas      *canvas,
+                                                 GHashTable     *forms,
+                                                 guint32         hidden_layers,
+                                                 cairo_t        *cr);
+static gchar *          _adg_dup_form_signature (AdgCanvas      *canvas,
+                                                 const cairo_matrix_t *ctm,
+                                                 guint32         hidden_layers);
+static void             _adg_damage             (AdgEntity      *entity,
+                                                 AdgEntity      *source);
+static void             _adg_add_damage         (gpointer        key,
+                                                 gpointer        value,
+                                                 gpointer        user_data);
+static void             _adg_add                (AdgContainer   *container,
+                                                 AdgEntity      *entity);
+static void             _adg_remove             (AdgContainer   *container,
+                                                 AdgEntity      *entity);
+static gboolean         _adg_autoscale_arrange  (AdgCanvas      *canvas,
+                                                 gdouble         factor,
+                                                 CpmlExtents    *extents);
+static gboolean         _adg_autoscale_center   (AdgCanvas      *canvas,
+                                                 const CpmlExtents *extents);
+static void             _adg_autoscale_walk     (AdgEntity      *entity,
+                                                 GArray         *boxes);
+static void             _adg_autoscale_estimate (AdgCanvas      *canvas,
+                                                 GArray         *boxes1,
+                                                 gdouble         factor1,
+                                                 GArray         *boxes2,
+                                                 gdouble         factor2,
+                                                 gdouble         factor,
+                                                 CpmlExtents    *extents);
 static void             _adg_apply_paddings     (AdgCanvas      *canvas,
                                                  CpmlExtents    *extents);
+static void             _adg_render_list_clear  (AdgCanvas      *canvas);
+static void             _adg_render_list_walk   (AdgCanvas      *canvas,
+                                                 AdgEntity      *entity,
+                                                 guint32         layers);
+static void             _adg_render_list_compile(AdgCanvas      *canvas);
+static void             _adg_render_list_replay (AdgCanvas      *canvas,
+                                                 guint32         hidden_layers,
+                                                 cairo_t        *cr);
+static gboolean         _adg_is_batchable       (AdgEntity      *entity,
+                                                 AdgEntity      *first);
+static guint            _adg_render_batch       (AdgCanvas      *canvas,
+                                                 guint           first,
+                                                 guint32         hidden_layers,
+                                                 cairo_t        *cr);
+static void             _adg_spatial_index_clear(AdgCanvas      *canvas);
+static void             _adg_spatial_index_walk (AdgEntity      *entity,
+                                                 AdgSpatialIndex *index);
+static void             _adg_collect_dims       (AdgEntity      *entity,
+                                                 GPtrArray      *dims);
+static gboolean         _adg_quote_collides     (AdgEntity      *quote,
+                                                 GSList         *others,
+                                                 GHashTable     *order,
+                                                 guint           n_order);
+static gboolean         _adg_extents_overlap    (const CpmlExtents *extents1,
+                                                 const CpmlExtents *extents2);
+static void             _adg_arrange_stack_clear(AdgCanvas      *canvas);
+static void             _adg_arrange_push       (GArray         *stack,
+                                                 AdgEntity      *entity);
+static gint64           _adg_now_us             (void);
+static void             _adg_shape_texts        (AdgCanvas      *canvas);
+static void             _adg_shape_walk         (AdgEntity      *entity,
+                                                 GHashTable     *shaped);
+static cairo_surface_t *_adg_export_surface    (cairo_surface_type_t type,
+                                                 const gchar    *file,
+                                                 cairo_write_func_t write_func,
+                                                 gpointer        closure,
+                                                 gdouble         width,
+                                                 gdouble         height);
+static GObject *        _adg_clone_object       (GObject        *src,
+                                                 GHashTable     *clones);
+static GObject *        _adg_clone_properties   (GObject        *src,
+                                                 GHashTable     *clones);
+static void             _adg_clone_entity       (AdgEntity      *src,
+                                                 AdgEntity      *dst,
+                                                 GHashTable     *clones);
+static void             _adg_dxf_flush          (AdgDxfWriter   *writer);
+static void             _adg_dxf_group          (AdgDxfWriter   *writer,
+                                                 gint            code,
+                                                 const gchar    *value);
+static void             _adg_dxf_real           (AdgDxfWriter   *writer,
+                                                 gint            code,
+                                                 gdouble         value);
+static void             _adg_dxf_point          (AdgDxfWriter   *writer,
+                                                 gint            code,
+                                                 const CpmlPair *pair);
+static gchar *          _adg_dxf_layer          (AdgDress        dress);
+static AdgDress         _adg_dxf_dress          (AdgEntity      *entity);
+static void             _adg_dxf_collect        (AdgEntity      *entity,
+                                                 GHashTable     *layers);
+static void             _adg_dxf_walk           (AdgEntity      *entity,
+                                                 AdgDxfWriter   *writer);
+static void             _adg_dxf_stroke         (AdgStroke      *stroke,
+                                                 AdgDxfWriter   *writer);
+static void             _adg_dxf_polyline       (AdgDxfWriter   *writer,
+                                                 const gchar    *layer,
+                                                 const CpmlPrimitive *primitive,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_dxf_text           (AdgTextual     *textual,
+                                                 AdgDxfWriter   *writer);
+static void             _adg_svg_walk           (AdgEntity      *entity,
+                                                 AdgSvgWriter   *writer,
+                                                 const cairo_matrix_t *instance);
+static void             _adg_svg_stroke         (AdgStroke      *stroke,
+                                                 AdgSvgWriter   *writer,
+                                                 const cairo_matrix_t *instance);
+static void             _adg_svg_fallback       (AdgEntity      *entity,
+                                                 AdgSvgWriter   *writer,
+                                                 const cairo_matrix_t *instance);
+static const gchar *    _adg_svg_share          (GHashTable     *table,
+                                                 gchar          *key,
+                                                 gchar           prefix,
+                                                 gboolean       *is_new);
+static void             _adg_svg_number         (GString        *buffer,
+                                                 gdouble         value);
+static void             _adg_svg_matrix         (GString        *buffer,
+                                                 const cairo_matrix_t *matrix);
+static guint            _adg_stream_id          (AdgEntity      *entity);
+static void             _adg_stream_string      (GString        *buffer,
+                                                 const gchar    *string);
+static void             _adg_stream_extents     (GString        *buffer,
+                                                 const CpmlExtents *extents);
+#ifdef CAIRO_HAS_SVG_SURFACE
+static cairo_status_t   _adg_stream_append      (gpointer        closure,
+                                                 const guchar   *data,
+                                                 guint           length);
+static gchar *          _adg_stream_svg         (AdgEntity      *entity,
+                                                 const CpmlExtents *extents);
+#endif
+static gboolean         _adg_render_to_buffer   (AdgCanvas      *canvas,
+                                                 guchar         *buffer,
+                                                 cairo_format_t  format,
+                                                 gint            width,
+                                                 gint            height,
+                                                 gint            stride,
+                                                 gboolean        preview,
+                                                 GError        **gerror);
+static void             _adg_export_page_size   (AdgCanvas      *canvas,
+                                                 gdouble         factor,
+                                                 gdouble        *width,
+                                                 gdouble        *height,
+                                                 gdouble        *left,
+                                                 gdouble        *top);
+static gboolean         _adg_export             (AdgCanvas      *canvas,
+                                                 cairo_surface_type_t type,
+                                                 const gchar    *file,
+                                                 cairo_write_func_t write_func,
+                                                 gpointer        closure,
+                                                 gdouble         factor,
+                                                 cairo_surface_t *recording,
+                                                 GError        **gerror);
+static guint32          _adg_png_crc            (guint32         crc,
+                                                 const guchar   *data,
+                                                 gsize           length);
+static void             _adg_png_put32          (guchar         *dst,
+                                                 guint32         value);
+static void             _adg_png_write          (AdgPngWriter   *writer,
+                                                 const guchar   *data,
+                                                 guint           length);
+static void             _adg_png_chunk          (AdgPngWriter   *writer,
+                                                 const gchar    *type,
+                                                 const guchar   *data,
+                                                 guint           length);
+static void             _adg_png_flush          (AdgPngWriter   *writer);
+static void             _adg_png_bits           (AdgPngWriter   *writer,
+                                                 guint32         value,
+                                                 guint           n_bits);
+static void             _adg_png_code           (AdgPngWriter   *writer,
+                                                 guint32         code,
+                                                 guint           n_bits);
+static void             _adg_png_symbol         (AdgPngWriter   *writer,
+                                                 guint           symbol);
+static void             _adg_png_match          (AdgPngWriter   *writer,
+                                                 guint           length);
+static void             _adg_png_flush_run      (AdgPngWriter   *writer);
+static void             _adg_png_bytes          (AdgPngWriter   *writer,
+                                                 const guchar   *data,
+                                                 guint           length);
+static void             _adg_png_begin          (AdgPngWriter   *writer,
+                                                 gint            width,
+                                                 gint            height);
+static void             _adg_png_end            (AdgPngWriter   *writer);
+static void             _adg_sheet_prepare      (AdgSheetJob    *job);
+static guint            _adg_get_num_processors (void);
+static void             _adg_sheets_record      (AdgSheetJob    *jobs,
+                                                 guint           n_jobs,
+                                                 guint           n_threads);
+#ifdef SNAPSHOT_ENABLED
+static cairo_status_t   _adg_snapshot_write     (gpointer        closure,
+                                                 const guchar   *data,
+                                                 guint           length);
+static cairo_surface_t *_adg_snapshot_surface   (gpointer        closure,
+                                                 cairo_content_t content,
+                                                 gdouble         width,
+                                                 gdouble         height,
+                                                 glong           uid);
+#endif
 static void             _adg_update_margin      (AdgCanvas      *canvas,
                                                  gdouble        *margin,
                                                  gdouble        *side,
                                                  gdouble         new_margin);
 
+static guint            _adg_signals[LAST_SIGNAL] = { 0 };
+
+/* The forms shared by the sheets of a multi-page export, bound to the
+ * cairo context of every page: see adg_canvas_export_sheets_full() */
+static cairo_user_data_key_t _adg_forms_key;
+
 
 GQuark
 adg_canvas_error_quark(void)
@@ -179,10 +503,12 @@ adg_canvas_class_init(AdgCanvasClass *klass)
 {
     GObjectClass *gobject_class;
     AdgEntityClass *entity_class;
+    AdgContainerClass *container_class;
     GParamSpec *param;
 
     gobject_class = (GObjectClass *) klass;
     entity_class = (AdgEntityClass *) klass;
+    container_class = (AdgContainerClass *) klass;
 
     g_type_class_add_private(klass, sizeof(AdgCanvasPrivate));
 
@@ -195,6 +521,10 @@ adg_canvas_class_init(AdgCanvasClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->damage = _adg_damage;
+
+    container_class->add = _adg_add;
+    container_class->remove = _adg_remove;
 
     param = g_param_spec_boxed("size",
                                P_("Canvas Size"),
@@ -300,6 +630,31 @@ adg_canvas_class_init(AdgCanvasClass *klass)
                                 -G_MAXDOUBLE, G_MAXDOUBLE, 15,
                                 G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_LEFT_PADDING, param);
+
+    param = g_param_spec_boolean("has-render-list",
+                                 P_("Has Render List Flag"),
+                                 P_("If enabled, the entity tree is flattened into a render list after the first rendering and that list is replayed until something changes"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_HAS_RENDER_LIST, param);
+
+    /**
+     * AdgCanvas::damaged:
+     * @canvas: an #AdgCanvas
+     *
+     * Emitted when some entity of @canvas is going to change its
+     * extents and no damage has been accumulated since the last
+     * adg_canvas_take_damage() call. It is intended as a hook for
+     * scheduling a partial redraw: see adg_canvas_take_damage().
+     *
+     * Since: 1.0
+     **/
+    _adg_signals[DAMAGED] =
+        g_signal_new("damaged", ADG_TYPE_CANVAS,
+                     G_SIGNAL_RUN_LAST, 0,
+                     NULL, NULL,
+                     g_cclosure_marshal_VOID__VOID,
+                     G_TYPE_NONE, 0);
 }
 
 static void
@@ -330,6 +685,17 @@ adg_canvas_init(AdgCanvas *canvas)
     data->right_padding = 15;
     data->bottom_padding = 15;
     data->left_padding = 15;
+    data->has_render_list = FALSE;
+    data->render_nodes = NULL;
+    data->render_list = NULL;
+    data->render_layers = NULL;
+    data->hidden_layers = 0;
+    data->spatial_index = NULL;
+    data->damage.is_defined = FALSE;
+    data->damaged = g_hash_table_new_full(NULL, NULL, g_object_unref, NULL);
+    data->is_damaged = FALSE;
+    data->damage_all = FALSE;
+    data->arrange_stack = NULL;
 
     canvas->data = data;
 }
@@ -343,6 +709,15 @@ _adg_dispose(GObject *object)
     canvas = (AdgCanvas *) object;
     data = canvas->data;
 
+    _adg_render_list_clear(canvas);
+    _adg_spatial_index_clear(canvas);
+    _adg_arrange_stack_clear(canvas);
+
+    if (data->damaged != NULL) {
+        g_hash_table_destroy(data->damaged);
+        data->damaged = NULL;
+    }
+
     if (data->title_block) {
         g_object_unref(data->title_block);
         data->title_block = NULL;
@@ -410,6 +785,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_LEFT_PADDING:
         g_value_set_double(value, data->left_padding);
         break;
+    case PROP_HAS_RENDER_LIST:
+        g_value_set_boolean(value, data->has_render_list);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -428,6 +806,10 @@ _adg_set_property(GObject *object, guint prop_id,
     canvas = (AdgCanvas *) object;
     data = canvas->data;
 
+    /* Any property change can affect the layout,
+     * so the render list must be compiled again */
+    _adg_render_list_clear(canvas);
+
     switch (prop_id) {
     case PROP_SIZE:
         cpml_pair_copy(&data->size, g_value_get_boxed(value));
@@ -489,6 +871,9 @@ _adg_set_property(GObject *object, guint prop_id,
     case PROP_LEFT_PADDING:
         data->left_padding = g_value_get_double(value);
         break;
+    case PROP_HAS_RENDER_LIST:
+        data->has_render_list = g_value_get_boolean(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -511,6 +896,53 @@ adg_canvas_new(void)
     return g_object_new(ADG_TYPE_CANVAS, NULL);
 }
 
+/**
+ * adg_canvas_clone:
+ * @canvas: an #AdgCanvas
+ *
+ * Creates a deep copy of @canvas, e.g. to instantiate a drawing
+ * from a template canvas and customize it without affecting the
+ * template. The whole hierarchy is duplicated:
+ * <itemizedlist>
+ * <listitem>every entity is cloned with its properties, its style
+ *           overrides and, for containers, its children;</listitem>
+ * <listitem>the #AdgPath and #AdgEdges models are cloned only once,
+ *           so entities sharing a model in @canvas share the cloned
+ *           model in the copy, and #AdgPoint properties bound to
+ *           named pairs are rebound to the cloned models. Paths are
+ *           duplicated with adg_path_dup(), so their primitives are
+ *           shared with @canvas until modified;</listitem>
+ * <listitem>styles are not modified by the entities, so they are
+ *           shared with @canvas together with their caches (e.g.
+ *           the scaled fonts of #AdgFontStyle). The same applies to
+ *           models of any other type, whose content cannot be
+ *           reproduced without knowing how they are built.</listitem>
+ * </itemizedlist>
+ *
+ * The rows of generic #AdgTable entities are not cloned: only the
+ * title block, whose cells are driven by its properties, is
+ * reproduced faithfully.
+ *
+ * Returns: (transfer full): the clone of @canvas or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgCanvas *
+adg_canvas_clone(AdgCanvas *canvas)
+{
+    GHashTable *clones;
+    GObject *clone;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), NULL);
+
+    /* Maps every source object to its clone */
+    clones = g_hash_table_new(NULL, NULL);
+    clone = _adg_clone_object((GObject *) canvas, clones);
+    g_hash_table_destroy(clones);
+
+    return (AdgCanvas *) clone;
+}
+
 /**
  * adg_canvas_set_size:
  * @canvas:                an #AdgCanvas
@@ -749,18 +1181,27 @@ adg_canvas_get_scales(AdgCanvas *canvas)
  * The paddings are taken into account while computing the drawing
  * extents.
  *
+ * To avoid arranging the whole drawing once per scale, the extents
+ * of every entity are sampled with the first and the last scale and
+ * modeled as the sum of a part in model space, proportional to the
+ * scale, and a part in paper space (texts, markers...), constant.
+ * The extents of the intermediate scales are then estimated and the
+ * candidates that surely do not fit are skipped. The chosen scale
+ * is always verified with a real arrange, so the estimation only
+ * affects the speed of this function.
+ *
  * Since: 1.0
  **/
 void
 adg_canvas_autoscale(AdgCanvas *canvas)
 {
     AdgCanvasPrivate *data;
-    gchar **p_scale;
+    gchar **p_scale, **p_first, **p_last, **p_resume;
     AdgEntity *entity;
-    cairo_matrix_t map;
     CpmlExtents extents;
     AdgTitleBlock *title_block;
-    CpmlPair delta;
+    GArray *first_boxes, *last_boxes;
+    gdouble first_factor, last_factor;
 
     g_return_if_fail(ADG_IS_CANVAS(canvas));
     g_return_if_fail(_ADG_OLD_ENTITY_CLASS->arrange != NULL);
@@ -773,47 +1214,81 @@ adg_canvas_autoscale(AdgCanvas *canvas)
      * signal does not invalidate the global matrix: let's do it right now */
     adg_entity_global_changed(entity);
 
+    /* Look for the first and the last valid scales */
+    p_first = p_last = NULL;
     for (p_scale = data->scales; p_scale != NULL && *p_scale != NULL; ++p_scale) {
+        if (adg_scale_factor(*p_scale) > 0) {
+            if (p_first == NULL)
+                p_first = p_scale;
+            p_last = p_scale;
+        }
+    }
+
+    if (p_first == NULL)
+        return;
+
+    /* Just in case @canvas is empty */
+    first_factor = adg_scale_factor(*p_first);
+    if (! _adg_autoscale_arrange(canvas, first_factor, &extents))
+        return;
+
+    if (title_block != NULL)
+        adg_title_block_set_scale(title_block, *p_first);
+
+    /* Bail out if paper size is not specified or invalid */
+    if (data->size.x <= 0 || data->size.y <= 0)
+        return;
+
+    if (_adg_autoscale_center(canvas, &extents) || p_last == p_first)
+        return;
+
+    /* Sample the extents with the last scale and skip the
+     * intermediate candidates that are estimated not to fit */
+    first_boxes = g_array_new(FALSE, FALSE, sizeof(CpmlExtents));
+    adg_container_foreach((AdgContainer *) canvas,
+                          G_CALLBACK(_adg_autoscale_walk), first_boxes);
+
+    last_factor = adg_scale_factor(*p_last);
+    _adg_autoscale_arrange(canvas, last_factor, &extents);
+    last_boxes = g_array_new(FALSE, FALSE, sizeof(CpmlExtents));
+    adg_container_foreach((AdgContainer *) canvas,
+                          G_CALLBACK(_adg_autoscale_walk), last_boxes);
+
+    p_resume = p_first + 1;
+    if (first_boxes->len == last_boxes->len && first_factor != last_factor) {
+        for (; p_resume < p_last; ++p_resume) {
+            gdouble factor = adg_scale_factor(*p_resume);
+            if (factor <= 0)
+                continue;
+
+            _adg_autoscale_estimate(canvas, first_boxes, first_factor,
+                                    last_boxes, last_factor,
+                                    factor, &extents);
+            if (extents.is_defined &&
+                extents.size.x <= data->size.x &&
+                extents.size.y <= data->size.y)
+                break;
+        }
+    }
+
+    g_array_free(first_boxes, TRUE);
+    g_array_free(last_boxes, TRUE);
+
+    /* Verify the remaining candidates with a real arrange */
+    for (p_scale = p_resume; *p_scale != NULL; ++p_scale) {
         const gchar *scale = *p_scale;
         gdouble factor = adg_scale_factor(scale);
         if (factor <= 0)
             continue;
 
-        cairo_matrix_init_scale(&map, factor, factor);
-        adg_entity_set_local_map(entity, &map);
-        adg_entity_local_changed(entity);
-
-        /* Arrange the entities inside the canvas, but not the canvas itself,
-         * just to get the bounding box of the drawing without the paper */
-        _ADG_OLD_ENTITY_CLASS->arrange(entity);
-        cpml_extents_copy(&extents, adg_entity_get_extents(entity));
-
-        /* Just in case @canvas is empty */
-        if (! extents.is_defined)
+        if (! _adg_autoscale_arrange(canvas, factor, &extents))
             return;
 
-        _adg_apply_paddings(canvas, &extents);
-
         if (title_block != NULL)
             adg_title_block_set_scale(title_block, scale);
 
-        /* Bail out if paper size is not specified or invalid */
-        if (data->size.x <= 0 || data->size.y <= 0)
-            break;
-
-        /* If the drawing extents are fully contained inside the paper size,
-         * center the drawing in the paper and bail out */
-        delta.x = data->size.x - extents.size.x;
-        delta.y = data->size.y - extents.size.y;
-        if (delta.x >= 0 && delta.y >= 0) {
-            cairo_matrix_t transform;
-            cairo_matrix_init_translate(&transform,
-                                        delta.x / 2 - extents.org.x,
-                                        delta.y / 2 - extents.org.y);
-            adg_entity_transform_local_map(entity, &transform,
-                                           ADG_TRANSFORM_AFTER);
+        if (_adg_autoscale_center(canvas, &extents))
             break;
-        }
     }
 }
 
@@ -1439,144 +1914,643 @@ adg_canvas_get_paddings(AdgCanvas *canvas,
     }
 }
 
+/**
+ * adg_canvas_switch_render_list:
+ * @canvas:    an #AdgCanvas
+ * @new_state: the new flag status
+ *
+ * Sets a new status on the #AdgCanvas:has-render-list property.
+ *
+ * When enabled, the first rendering of @canvas flattens the entity
+ * tree into a linear list of leaf entities. The following renderings
+ * replay that list directly, without emitting the #AdgEntity::arrange
+ * and #AdgEntity::render signals through the containers. The list is
+ * dropped and compiled again as soon as any entity in the tree is
+ * invalidated, changes its matrices or properties, is destroyed or
+ * a child is added to or removed from a container.
+ *
+ * While replaying, consecutive #AdgStroke entities that resolve their
+ * line dress to the same style and share the same global matrix are
+ * appended to a single path and stroked at once, so the backend
+ * receives far fewer stroke operations. Overlapping parts of strokes
+ * batched together are painted only once, which is noticeable only
+ * with translucent line colors.
+ *
+ * The debug rectangles enabled by adg_switch_extents() are not
+ * drawn for the replayed entities.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_switch_render_list(AdgCanvas *canvas, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_object_set(canvas, "has-render-list", new_state, NULL);
+}
 
-static void
-_adg_global_changed(AdgEntity *entity)
+/**
+ * adg_canvas_has_render_list:
+ * @canvas: an #AdgCanvas
+ *
+ * Gets the current status of the #AdgCanvas:has-render-list property,
+ * that is whether the rendering of @canvas should be compiled into a
+ * render list (<constant>TRUE</constant>) or not
+ * (<constant>FALSE</constant>).
+ *
+ * Returns: the current status of the render list flag.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_has_render_list(AdgCanvas *canvas)
 {
-    AdgCanvasPrivate *data = ((AdgCanvas *) entity)->data;
+    AdgCanvasPrivate *data;
 
-    if (_ADG_OLD_ENTITY_CLASS->global_changed)
-        _ADG_OLD_ENTITY_CLASS->global_changed(entity);
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
 
-    if (data->title_block)
-        adg_entity_global_changed((AdgEntity *) data->title_block);
+    data = canvas->data;
+    return data->has_render_list;
 }
 
-static void
-_adg_local_changed(AdgEntity *entity)
+/**
+ * adg_canvas_set_layer_visible:
+ * @canvas:  an #AdgCanvas
+ * @layer:   the layer to show or hide, between 0 and 31
+ * @visible: <constant>TRUE</constant> to show @layer, <constant>FALSE</constant> to hide it
+ *
+ * Shows or hides the entities of @canvas whose #AdgEntity:layer is
+ * @layer, together with their children.
+ *
+ * Toggling a layer does not modify the entity tree nor triggers a new
+ * arrange phase: the hidden entities are simply skipped while
+ * rendering. When the render list is enabled (see
+ * adg_canvas_switch_render_list()), the list is kept and only the
+ * replayed entities change. The whole sheet is damaged, so any
+ * handler of the #AdgCanvas::damaged signal is notified.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_set_layer_visible(AdgCanvas *canvas, guint layer, gboolean visible)
 {
-    AdgCanvasPrivate *data = ((AdgCanvas *) entity)->data;
-    AdgTitleBlock *title_block = data->title_block;
-
-    if (_ADG_OLD_ENTITY_CLASS->local_changed)
-        _ADG_OLD_ENTITY_CLASS->local_changed(entity);
+    AdgCanvasPrivate *data;
+    guint32 hidden_layers;
 
-    if (title_block != NULL) {
-        const gchar *scale = adg_title_block_get_scale(title_block);
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_return_if_fail(layer < 32);
 
-        if (scale != NULL && scale[0] != '\0') {
-            const cairo_matrix_t *map = adg_entity_get_local_map(entity);
-            gdouble factor = adg_scale_factor(scale);
+    data = canvas->data;
+    hidden_layers = data->hidden_layers;
 
-            if (map->xx != factor || map->yy != factor)
-                adg_title_block_set_scale(title_block, "---");
-        }
+    if (visible)
+        hidden_layers &= ~(1u << layer);
+    else
+        hidden_layers |= 1u << layer;
 
-        adg_entity_local_changed((AdgEntity *) title_block);
+    if (hidden_layers != data->hidden_layers) {
+        data->hidden_layers = hidden_layers;
+        _adg_damage((AdgEntity *) canvas, (AdgEntity *) canvas);
     }
 }
 
-static void
-_adg_invalidate(AdgEntity *entity)
+/**
+ * adg_canvas_is_layer_visible:
+ * @canvas: an #AdgCanvas
+ * @layer:  the layer to check, between 0 and 31
+ *
+ * Checks if @layer is visible on @canvas. See
+ * adg_canvas_set_layer_visible() for details.
+ *
+ * Returns: <constant>TRUE</constant> if @layer is visible, <constant>FALSE</constant> if it is hidden or on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_is_layer_visible(AdgCanvas *canvas, guint layer)
 {
-    AdgCanvasPrivate *data = ((AdgCanvas *) entity)->data;
+    AdgCanvasPrivate *data;
 
-    if (_ADG_OLD_ENTITY_CLASS->invalidate)
-        _ADG_OLD_ENTITY_CLASS->invalidate(entity);
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(layer < 32, FALSE);
 
-    if (data->title_block)
-        adg_entity_invalidate((AdgEntity *) data->title_block);
+    data = canvas->data;
+
+    return (data->hidden_layers & (1u << layer)) == 0;
 }
 
-static void
-_adg_arrange(AdgEntity *entity)
+/**
+ * adg_canvas_render_backdrop:
+ * @canvas: an #AdgCanvas
+ * @cr:     the destination cairo context
+ *
+ * Renders only the background and, if enabled, the frame of @canvas
+ * on @cr, without rendering any of its children. @canvas is arranged
+ * before the rendering, so the backdrop always matches its current
+ * extents.
+ *
+ * This is intended for code that renders the children on its own,
+ * e.g. the progressive rendering of #AdgGtkArea.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_render_backdrop(AdgCanvas *canvas, cairo_t *cr)
 {
-    AdgCanvas *canvas;
-    AdgCanvasPrivate *data;
-    CpmlExtents extents;
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_return_if_fail(cr != NULL);
 
-    if (_ADG_OLD_ENTITY_CLASS->arrange)
-        _ADG_OLD_ENTITY_CLASS->arrange(entity);
+    adg_entity_arrange((AdgEntity *) canvas);
+    _adg_render_backdrop(canvas, cr);
+}
 
-    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+/**
+ * adg_canvas_take_damage:
+ * @canvas: an #AdgCanvas
+ * @damage: (out): where to store the damaged region
+ *
+ * Gets the region of @canvas, in global space, that must be
+ * rendered again since the last call to this function and resets
+ * it. The damage is the union of the old and new extents of any
+ * entity that has been invalidated, has changed its geometry or
+ * has been added to or removed from @canvas in the meantime.
+ *
+ * @canvas is arranged before computing the damage, so the new
+ * extents are always available. The extents do not consider the
+ * line width nor any other pen related detail, so the caller
+ * should enlarge the result a bit before using it as clip region.
+ *
+ * The #AdgCanvas::damaged signal is emitted the first time
+ * @canvas gets damaged after a call to this function. The damage
+ * is accumulated only while at least one handler is connected to
+ * that signal.
+ *
+ * Returns: <constant>TRUE</constant> if @damage is defined, that is something must be redrawn.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_take_damage(AdgCanvas *canvas, CpmlExtents *damage)
+{
+    AdgCanvasPrivate *data;
 
-    /* The extents should be defined, otherwise there is no drawing */
-    g_return_if_fail(extents.is_defined);
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(damage != NULL, FALSE);
 
-    canvas = (AdgCanvas *) entity;
     data = canvas->data;
 
-    _adg_apply_paddings(canvas, &extents);
-
-    if (data->size.x > 0 || data->size.y > 0) {
-        const cairo_matrix_t *global = adg_entity_get_global_matrix(entity);
-        CpmlExtents paper;
+    adg_entity_arrange((AdgEntity *) canvas);
 
-        paper.org.x = 0;
-        paper.org.y = 0;
-        paper.size.x = data->size.x;
-        paper.size.y = data->size.y;
+    /* Add the new extents of the damaged entities */
+    g_hash_table_foreach(data->damaged, _adg_add_damage, &data->damage);
+    g_hash_table_remove_all(data->damaged);
 
-        cairo_matrix_transform_point(global, &paper.org.x, &paper.org.y);
-        cairo_matrix_transform_distance(global, &paper.size.x, &paper.size.y);
+    if (data->damage_all) {
+        CpmlExtents extents;
 
-        if (data->size.x > 0) {
-            extents.org.x = paper.org.x;
-            extents.size.x = paper.size.x;
-        }
-        if (data->size.y > 0) {
-            extents.org.y = paper.org.y;
-            extents.size.y = paper.size.y;
+        cpml_extents_copy(&extents, _adg_entity_get_extents((AdgEntity *) canvas));
+        if (extents.is_defined) {
+            adg_canvas_apply_margins(canvas, &extents);
+            cpml_extents_add(&data->damage, &extents);
         }
     }
 
-    if (data->title_block) {
-        AdgEntity *title_block_entity;
-        const CpmlExtents *title_block_extents;
-        CpmlPair shift;
+    cpml_extents_copy(damage, &data->damage);
 
-        title_block_entity = (AdgEntity *) data->title_block;
-        adg_entity_arrange(title_block_entity);
-        title_block_extents = adg_entity_get_extents(title_block_entity);
+    data->damage.is_defined = FALSE;
+    data->is_damaged = FALSE;
+    data->damage_all = FALSE;
 
-        shift.x = extents.org.x + extents.size.x - title_block_extents->org.x
-            - title_block_extents->size.x;
-        shift.y = extents.org.y + extents.size.y - title_block_extents->org.y
-            - title_block_extents->size.y;
+    return damage->is_defined;
+}
 
-        /* The following block could be optimized by skipping tiny shift,
-         * usually left by rounding errors */
-        if (shift.x != 0 || shift.y != 0) {
-            cairo_matrix_t unglobal, map;
-            adg_matrix_copy(&unglobal, adg_entity_get_global_matrix(entity));
-            cairo_matrix_invert(&unglobal);
+/**
+ * adg_canvas_arrange_step:
+ * @canvas: an #AdgCanvas
+ * @budget_us: the time budget, in microseconds
+ *
+ * Performs a slice of the arrange phase of @canvas, stopping as soon
+ * as @budget_us microseconds have elapsed. The tree is traversed with
+ * an explicit stack retained by @canvas, so every call resumes where
+ * the previous one left off. Plain #AdgContainer instances are walked
+ * into and their children arranged one by one, while any other entity
+ * (composite ones included) is arranged as a whole.
+ *
+ * At least one entity is arranged on every call, so a zero or
+ * negative @budget_us still progresses. Changes made to @canvas
+ * between two calls are honored: the last step arranges @canvas
+ * itself, picking up whatever has been left out.
+ *
+ * This is meant to be called from an idle handler of an interactive
+ * application, e.g.:
+ *
+ * <informalexample><programlisting language="C">
+ * static gboolean
+ * arrange_idle(gpointer user_data)
+ * {
+ *     AdgGtkArea *area = user_data;
+ *     AdgCanvas *canvas = adg_gtk_area_get_canvas(area);
+ *
+ *     if (adg_canvas_arrange_step(canvas, 5000)) {
+ *         gtk_widget_queue_draw((GtkWidget *) area);
+ *         return FALSE;
+ *     }
+ *
+ *     return TRUE;
+ * }
+ * </programlisting></informalexample>
+ *
+ * Returns: <constant>TRUE</constant> if @canvas is fully arranged, <constant>FALSE</constant> if more steps are needed.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_arrange_step(AdgCanvas *canvas, gint64 budget_us)
+{
+    AdgCanvasPrivate *data;
+    GArray *stack;
+    gint64 deadline;
 
-            cairo_matrix_transform_distance(&unglobal, &shift.x, &shift.y);
-            cairo_matrix_init_translate(&map, shift.x, shift.y);
-            adg_entity_transform_global_map(title_block_entity, &map,
-                                            ADG_TRANSFORM_AFTER);
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
 
-            adg_entity_global_changed(title_block_entity);
-            adg_entity_arrange(title_block_entity);
-            title_block_extents = adg_entity_get_extents(title_block_entity);
-            cpml_extents_add(&extents, title_block_extents);
-        }
+    data = canvas->data;
+
+    if (data->arrange_stack == NULL) {
+        AdgEntityPrivate *entity_data = ((AdgEntity *) canvas)->data;
+
+        if (entity_data->arranged)
+            return TRUE;
+
+        data->arrange_stack = g_array_new(FALSE, FALSE,
+                                          sizeof(AdgArrangeFrame));
+        _adg_arrange_push(data->arrange_stack, (AdgEntity *) canvas);
     }
 
-    /* Impose the new extents */
-    adg_entity_set_extents(entity, &extents);
-}
+    stack = data->arrange_stack;
+    deadline = _adg_now_us() + budget_us;
 
-static void
-_adg_render(AdgEntity *entity, cairo_t *cr)
-{
-    AdgCanvasPrivate *data;
-    const CpmlExtents *extents;
+    while (stack->len > 0) {
+        AdgArrangeFrame *frame;
+        AdgEntity *entity;
+        AdgEntityPrivate *entity_data;
 
-    data = ((AdgCanvas *) entity)->data;
-    extents = adg_entity_get_extents(entity);
+        frame = &g_array_index(stack, AdgArrangeFrame, stack->len - 1);
+        entity = frame->entity;
+        entity_data = entity->data;
 
-    cairo_save(cr);
+        if (entity_data->arranged) {
+            g_array_set_size(stack, stack->len - 1);
+            g_object_unref(entity);
+            continue;
+        }
+
+        if (!frame->expanded && (entity == (AdgEntity *) canvas ||
+                                 G_OBJECT_TYPE(entity) == ADG_TYPE_CONTAINER)) {
+            GPtrArray *order;
+            guint n;
+
+            /* The children need the matrices of their parent, so they
+             * must be defined before arranging anything below it */
+            frame->expanded = TRUE;
+            _adg_entity_update_matrices(entity);
+
+            /* Same order of the container arrange, dependencies
+             * included: pushing it backward pops the first child first */
+            order = _adg_container_arrange_order((AdgContainer *) entity);
+            for (n = order->len; n-- > 0; )
+                _adg_arrange_push(stack, g_ptr_array_index(order, n));
+            g_ptr_array_free(order, TRUE);
+            continue;
+        }
+
+        g_array_set_size(stack, stack->len - 1);
+        adg_entity_arrange(entity);
+        g_object_unref(entity);
+
+        if (_adg_now_us() >= deadline)
+            break;
+    }
+
+    if (stack->len > 0)
+        return FALSE;
+
+    _adg_arrange_stack_clear(canvas);
+    return TRUE;
+}
+
+/**
+ * adg_canvas_get_spatial_index:
+ * @canvas: an #AdgCanvas
+ *
+ * Gets an #AdgSpatialIndex of the entities contained by @canvas,
+ * title block included. Only the leaf entities are indexed, that is
+ * the containers are traversed but not indexed themselves.
+ *
+ * @canvas is arranged before returning, so the index is always up to
+ * date. The index is lazily built and then retained until something
+ * in @canvas changes, so calling this function on every motion event
+ * of an interactive application is cheap.
+ *
+ * The returned index is owned by @canvas and should not be modified
+ * or freed. It is valid until the next change on @canvas.
+ *
+ * Returns: (transfer none): the spatial index of @canvas or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgSpatialIndex *
+adg_canvas_get_spatial_index(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), NULL);
+
+    adg_entity_arrange((AdgEntity *) canvas);
+    data = canvas->data;
+
+    if (data->spatial_index == NULL) {
+        data->spatial_index = adg_spatial_index_new();
+
+        if (data->title_block)
+            _adg_spatial_index_walk((AdgEntity *) data->title_block,
+                                    data->spatial_index);
+
+        adg_container_foreach((AdgContainer *) canvas,
+                              G_CALLBACK(_adg_spatial_index_walk),
+                              data->spatial_index);
+    }
+
+    return data->spatial_index;
+}
+
+/**
+ * adg_canvas_layout_quotes:
+ * @canvas: an #AdgCanvas
+ * @max_sweeps: the maximum number of sweeps, or 0 for the default
+ *
+ * Moves the quotes of the dimensions inside @canvas so they do not
+ * overlap each other. The dimensions are visited in the order
+ * returned by adg_container_children(): when the quote of a
+ * dimension overlaps the quote of a dimension already visited, its
+ * level is increased by one (see adg_dim_set_level()), i.e. the
+ * quote is moved away from the measured geometry by the baseline
+ * spacing of its #AdgDimStyle. The positions and the reference
+ * points are never changed.
+ *
+ * Every sweep indexes the current quotes in an #AdgSpatialIndex, so
+ * finding the collisions costs O(n log n) instead of O(n²). Only the
+ * dimensions that have been moved are arranged again, before
+ * checking the next one. The process is repeated until a sweep does
+ * not move anything or @max_sweeps sweeps (4 by default) have been
+ * performed.
+ *
+ * Returns: the number of level changes performed.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_canvas_layout_quotes(AdgCanvas *canvas, guint max_sweeps)
+{
+    GPtrArray *dims, *moved;
+    GHashTable *order;
+    AdgSpatialIndex *index;
+    AdgDim *dim;
+    AdgEntity *quote;
+    const CpmlExtents *extents;
+    GSList *hits;
+    guint sweep, n, k, n_moved;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), 0);
+
+    if (max_sweeps == 0)
+        max_sweeps = 4;
+
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    dims = g_ptr_array_new();
+    adg_container_foreach((AdgContainer *) canvas,
+                          G_CALLBACK(_adg_collect_dims), dims);
+
+    /* Map every quote to its rank (1 based) in the visit order */
+    order = g_hash_table_new(NULL, NULL);
+    for (n = 0; n < dims->len; ++n) {
+        quote = (AdgEntity *) adg_dim_get_quote(g_ptr_array_index(dims, n));
+        if (quote != NULL)
+            g_hash_table_insert(order, quote, GUINT_TO_POINTER(n + 1));
+    }
+
+    moved = g_ptr_array_new();
+    n_moved = 0;
+
+    for (sweep = 0; sweep < max_sweeps; ++sweep) {
+        index = adg_spatial_index_new();
+        for (n = 0; n < dims->len; ++n) {
+            quote = (AdgEntity *) adg_dim_get_quote(g_ptr_array_index(dims, n));
+            if (quote != NULL)
+                adg_spatial_index_add(index, quote);
+        }
+
+        g_ptr_array_set_size(moved, 0);
+
+        for (n = 0; n < dims->len; ++n) {
+            dim = g_ptr_array_index(dims, n);
+            quote = (AdgEntity *) adg_dim_get_quote(dim);
+            if (quote == NULL)
+                continue;
+
+            extents = adg_entity_get_extents(quote);
+            if (! extents->is_defined)
+                continue;
+
+            /* The quotes moved in this sweep are not where the index
+             * thinks they are, so they are checked one by one */
+            hits = adg_spatial_index_query_extents(index, extents);
+            for (k = 0; k < moved->len; ++k)
+                hits = g_slist_prepend(hits, g_ptr_array_index(moved, k));
+
+            if (_adg_quote_collides(quote, hits, order, n + 1)) {
+                adg_dim_set_level(dim, adg_dim_get_level(dim) + 1);
+                adg_entity_invalidate((AdgEntity *) dim);
+                adg_entity_arrange((AdgEntity *) dim);
+                g_ptr_array_add(moved, adg_dim_get_quote(dim));
+                ++ n_moved;
+            }
+
+            g_slist_free(hits);
+        }
+
+        adg_spatial_index_destroy(index);
+
+        /* Let the containers update their extents: only the
+         * moved dimensions are dirty */
+        adg_entity_arrange((AdgEntity *) canvas);
+
+        if (moved->len == 0)
+            break;
+    }
+
+    g_ptr_array_free(moved, TRUE);
+    g_hash_table_destroy(order);
+    g_ptr_array_free(dims, TRUE);
+
+    return n_moved;
+}
+
+
+static void
+_adg_global_changed(AdgEntity *entity)
+{
+    AdgCanvasPrivate *data = ((AdgCanvas *) entity)->data;
+
+    _adg_render_list_clear((AdgCanvas *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->global_changed)
+        _ADG_OLD_ENTITY_CLASS->global_changed(entity);
+
+    if (data->title_block)
+        adg_entity_global_changed((AdgEntity *) data->title_block);
+}
+
+static void
+_adg_local_changed(AdgEntity *entity)
+{
+    AdgCanvasPrivate *data = ((AdgCanvas *) entity)->data;
+    AdgTitleBlock *title_block = data->title_block;
+
+    _adg_render_list_clear((AdgCanvas *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->local_changed)
+        _ADG_OLD_ENTITY_CLASS->local_changed(entity);
+
+    if (title_block != NULL) {
+        const gchar *scale = adg_title_block_get_scale(title_block);
+
+        if (scale != NULL && scale[0] != '\0') {
+            const cairo_matrix_t *map = adg_entity_get_local_map(entity);
+            gdouble factor = adg_scale_factor(scale);
+
+            if (map->xx != factor || map->yy != factor)
+                adg_title_block_set_scale(title_block, "---");
+        }
+
+        adg_entity_local_changed((AdgEntity *) title_block);
+    }
+}
+
+static void
+_adg_invalidate(AdgEntity *entity)
+{
+    AdgCanvasPrivate *data = ((AdgCanvas *) entity)->data;
+
+    _adg_render_list_clear((AdgCanvas *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->invalidate)
+        _ADG_OLD_ENTITY_CLASS->invalidate(entity);
+
+    if (data->title_block)
+        adg_entity_invalidate((AdgEntity *) data->title_block);
+}
+
+static void
+_adg_arrange(AdgEntity *entity)
+{
+    AdgCanvas *canvas;
+    AdgCanvasPrivate *data;
+    CpmlExtents extents;
+
+    canvas = (AdgCanvas *) entity;
+    data = canvas->data;
+
+    /* A valid render list implies nothing changed since the last
+     * arrange, so the current extents are still good */
+    if (data->render_list != NULL)
+        return;
+
+    /* Something changed: the spatial index is no more valid */
+    _adg_spatial_index_clear(canvas);
+
+    _adg_shape_texts(canvas);
+
+    if (_ADG_OLD_ENTITY_CLASS->arrange)
+        _ADG_OLD_ENTITY_CLASS->arrange(entity);
+
+    cpml_extents_copy(&extents, _adg_entity_get_extents(entity));
+
+    /* The extents should be defined, otherwise there is no drawing */
+    g_return_if_fail(extents.is_defined);
+
+    _adg_apply_paddings(canvas, &extents);
+
+    if (data->size.x > 0 || data->size.y > 0) {
+        const cairo_matrix_t *global = _adg_entity_get_global_matrix(entity);
+        CpmlExtents paper;
+
+        paper.org.x = 0;
+        paper.org.y = 0;
+        paper.size.x = data->size.x;
+        paper.size.y = data->size.y;
+
+        cairo_matrix_transform_point(global, &paper.org.x, &paper.org.y);
+        cairo_matrix_transform_distance(global, &paper.size.x, &paper.size.y);
+
+        if (data->size.x > 0) {
+            extents.org.x = paper.org.x;
+            extents.size.x = paper.size.x;
+        }
+        if (data->size.y > 0) {
+            extents.org.y = paper.org.y;
+            extents.size.y = paper.size.y;
+        }
+    }
+
+    if (data->title_block) {
+        AdgEntity *title_block_entity;
+        const CpmlExtents *title_block_extents;
+        CpmlPair shift;
+
+        title_block_entity = (AdgEntity *) data->title_block;
+        adg_entity_arrange(title_block_entity);
+        title_block_extents = adg_entity_get_extents(title_block_entity);
+
+        shift.x = extents.org.x + extents.size.x - title_block_extents->org.x
+            - title_block_extents->size.x;
+        shift.y = extents.org.y + extents.size.y - title_block_extents->org.y
+            - title_block_extents->size.y;
+
+        /* The following block could be optimized by skipping tiny shift,
+         * usually left by rounding errors */
+        if (shift.x != 0 || shift.y != 0) {
+            cairo_matrix_t unglobal, map;
+            adg_matrix_copy(&unglobal, _adg_entity_get_global_matrix(entity));
+            cairo_matrix_invert(&unglobal);
+
+            cairo_matrix_transform_distance(&unglobal, &shift.x, &shift.y);
+            cairo_matrix_init_translate(&map, shift.x, shift.y);
+            adg_entity_transform_global_map(title_block_entity, &map,
+                                            ADG_TRANSFORM_AFTER);
+
+            adg_entity_global_changed(title_block_entity);
+            adg_entity_arrange(title_block_entity);
+            title_block_extents = adg_entity_get_extents(title_block_entity);
+            cpml_extents_add(&extents, title_block_extents);
+        }
+    }
+
+    /* Impose the new extents */
+    adg_entity_set_extents(entity, &extents);
+}
+
+static void
+_adg_render_backdrop(AdgCanvas *canvas, cairo_t *cr)
+{
+    AdgCanvasPrivate *data;
+    AdgEntity *entity;
+    const CpmlExtents *extents;
+
+    data = canvas->data;
+    entity = (AdgEntity *) canvas;
+    extents = _adg_entity_get_extents(entity);
+
+    cairo_save(cr);
 
     /* Background fill */
     cairo_rectangle(cr, extents->org.x - data->left_margin,
@@ -1586,139 +2560,3205 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     adg_entity_apply_dress(entity, data->background_dress, cr);
     cairo_fill(cr);
 
-    /* Frame line */
-    if (data->has_frame) {
-        cairo_rectangle(cr, extents->org.x, extents->org.y,
-                        extents->size.x, extents->size.y);
-        cairo_transform(cr, adg_entity_get_global_matrix(entity));
-        adg_entity_apply_dress(entity, data->frame_dress, cr);
-        cairo_stroke(cr);
+    /* Frame line */
+    if (data->has_frame) {
+        cairo_rectangle(cr, extents->org.x, extents->org.y,
+                        extents->size.x, extents->size.y);
+        cairo_transform(cr, _adg_entity_get_global_matrix(entity));
+        adg_entity_apply_dress(entity, data->frame_dress, cr);
+        cairo_stroke(cr);
+    }
+
+    cairo_restore(cr);
+}
+
+static void
+_adg_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgCanvasPrivate *data;
+    guint32 old_layers, hidden_layers;
+    GHashTable *forms;
+    guint old_parts;
+
+    data = ((AdgCanvas *) entity)->data;
+
+    /* The hidden layers are bound to cr, so nested entities can
+     * check them without walking up to the canvas */
+    old_layers = adg_get_hidden_layers(cr);
+    hidden_layers = old_layers | data->hidden_layers;
+    adg_set_hidden_layers(cr, hidden_layers);
+
+    /* A recording cache on the title block would be filled with
+     * only one of its parts, so the forms cannot be used there */
+    forms = adg_has_preview(cr) ? NULL : cairo_get_user_data(cr, &_adg_forms_key);
+    if (data->title_block != NULL &&
+        adg_entity_has_recording_cache((AdgEntity *) data->title_block))
+        forms = NULL;
+
+    if (forms != NULL) {
+        /* The backdrop and the static part of the title block come
+         * from the shared form: only the rest is rendered here */
+        _adg_render_form((AdgCanvas *) entity, forms, hidden_layers, cr);
+
+        if (data->title_block) {
+            old_parts = _adg_table_get_hidden_parts(cr);
+            _adg_table_set_hidden_parts(cr, old_parts | ADG_TABLE_PARTS_STATIC);
+            adg_entity_render((AdgEntity *) data->title_block, cr);
+            _adg_table_set_hidden_parts(cr, old_parts);
+        }
+
+        if (_ADG_OLD_ENTITY_CLASS->render)
+            _ADG_OLD_ENTITY_CLASS->render(entity, cr);
+
+        adg_set_hidden_layers(cr, old_layers);
+        return;
+    }
+
+    _adg_render_backdrop((AdgCanvas *) entity, cr);
+
+    /* The replay bypasses the level of detail of the preview */
+    if (data->render_list != NULL && ! adg_has_preview(cr)) {
+        _adg_render_list_replay((AdgCanvas *) entity, hidden_layers, cr);
+    } else {
+        if (data->title_block)
+            adg_entity_render((AdgEntity *) data->title_block, cr);
+
+        if (_ADG_OLD_ENTITY_CLASS->render)
+            _ADG_OLD_ENTITY_CLASS->render(entity, cr);
+
+        if (data->has_render_list)
+            _adg_render_list_compile((AdgCanvas *) entity);
+    }
+
+    adg_set_hidden_layers(cr, old_layers);
+}
+
+/* Paints the backdrop and the static part of the title block of
+ * @canvas from a form recorded once in @forms and shared by every
+ * sheet with the same signature. Painting the same recording surface
+ * on different pages lets the PDF backend emit it only once, as a
+ * form XObject referenced by every page */
+static void
+_adg_render_form(AdgCanvas *canvas, GHashTable *forms,
+                 guint32 hidden_layers, cairo_t *cr)
+{
+    AdgCanvasPrivate *data;
+    cairo_matrix_t ctm;
+    gchar *signature;
+    cairo_surface_t *form;
+    cairo_t *form_cr;
+
+    data = canvas->data;
+    cairo_get_matrix(cr, &ctm);
+    signature = _adg_dup_form_signature(canvas, &ctm, hidden_layers);
+    form = g_hash_table_lookup(forms, signature);
+
+    if (form == NULL) {
+        /* Recorded in device space, so it can be painted
+         * with the identity matrix on any page */
+        form = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+        form_cr = cairo_create(form);
+        cairo_set_matrix(form_cr, &ctm);
+        adg_set_hidden_layers(form_cr, hidden_layers);
+        adg_switch_state_tracking(form_cr, adg_has_state_tracking(cr));
+        adg_set_render_context(form_cr, adg_get_render_context(cr));
+
+        _adg_render_backdrop(canvas, form_cr);
+
+        if (data->title_block) {
+            _adg_table_set_hidden_parts(form_cr, ADG_TABLE_PARTS_DYNAMIC);
+            adg_entity_render((AdgEntity *) data->title_block, form_cr);
+        }
+
+        cairo_destroy(form_cr);
+        g_hash_table_insert(forms, signature, form);
+    } else {
+        g_free(signature);
+    }
+
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_set_source_surface(cr, form, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+/* Collects whatever changes the form of @canvas: the layout of the
+ * sheet, the resolved styles, the transformation in use and the
+ * static part of the title block. The styles are compared by
+ * identity, so sheets using the same (default) styles match */
+static gchar *
+_adg_dup_form_signature(AdgCanvas *canvas, const cairo_matrix_t *ctm,
+                        guint32 hidden_layers)
+{
+    AdgCanvasPrivate *data;
+    AdgEntity *entity;
+    const CpmlExtents *extents;
+    GString *signature;
+    gchar *title_block;
+
+    data = canvas->data;
+    entity = (AdgEntity *) canvas;
+    extents = _adg_entity_get_extents(entity);
+    signature = g_string_new(NULL);
+
+    g_string_append_printf(signature,
+                           "%.17g,%.17g,%.17g,%.17g %.17g,%.17g,%.17g,%.17g",
+                           extents->org.x, extents->org.y,
+                           extents->size.x, extents->size.y,
+                           data->top_margin, data->right_margin,
+                           data->bottom_margin, data->left_margin);
+    g_string_append_printf(signature, " %d %p %p %u",
+                           data->has_frame,
+                           (gpointer) adg_entity_style(entity, data->background_dress),
+                           (gpointer) adg_entity_style(entity, data->frame_dress),
+                           hidden_layers);
+    g_string_append_printf(signature,
+                           " %.17g,%.17g,%.17g,%.17g,%.17g,%.17g",
+                           ctm->xx, ctm->yx, ctm->xy,
+                           ctm->yy, ctm->x0, ctm->y0);
+
+    if (data->title_block) {
+        title_block = _adg_table_dup_signature((AdgTable *) data->title_block);
+        g_string_append_printf(signature, "\n%s", title_block);
+        g_free(title_block);
+    }
+
+    return g_string_free(signature, FALSE);
+}
+
+static void
+_adg_damage(AdgEntity *entity, AdgEntity *source)
+{
+    AdgCanvas *canvas;
+    AdgCanvasPrivate *data;
+
+    canvas = (AdgCanvas *) entity;
+    data = canvas->data;
+
+    /* Nothing to do while disposing or if nobody is interested:
+     * the damaged entities are referenced, so tracking them without
+     * any adg_canvas_take_damage() call would keep them alive */
+    if (data->damaged == NULL ||
+        !g_signal_has_handler_pending(canvas, _adg_signals[DAMAGED], 0, TRUE))
+        return;
+
+    if (source == entity) {
+        /* The canvas itself: damage the whole sheet, margins included */
+        CpmlExtents extents;
+
+        cpml_extents_copy(&extents, _adg_entity_get_extents(entity));
+        if (extents.is_defined) {
+            adg_canvas_apply_margins(canvas, &extents);
+            cpml_extents_add(&data->damage, &extents);
+        }
+        data->damage_all = TRUE;
+    } else {
+        /* Keep track of the old extents now and
+         * of the new ones in adg_canvas_take_damage() */
+        cpml_extents_add(&data->damage, adg_entity_get_extents(source));
+        if (g_hash_table_lookup(data->damaged, source) == NULL)
+            g_hash_table_insert(data->damaged, g_object_ref(source), source);
+    }
+
+    if (!data->is_damaged) {
+        data->is_damaged = TRUE;
+        g_signal_emit(canvas, _adg_signals[DAMAGED], 0);
+    }
+}
+
+static void
+_adg_add_damage(gpointer key, gpointer value, gpointer user_data)
+{
+    cpml_extents_add((CpmlExtents *) user_data,
+                     adg_entity_get_extents((AdgEntity *) key));
+}
+
+static void
+_adg_add(AdgContainer *container, AdgEntity *entity)
+{
+    _adg_render_list_clear((AdgCanvas *) container);
+
+    if (_ADG_OLD_CONTAINER_CLASS->add)
+        _ADG_OLD_CONTAINER_CLASS->add(container, entity);
+}
+
+static void
+_adg_remove(AdgContainer *container, AdgEntity *entity)
+{
+    _adg_render_list_clear((AdgCanvas *) container);
+
+    if (_ADG_OLD_CONTAINER_CLASS->remove)
+        _ADG_OLD_CONTAINER_CLASS->remove(container, entity);
+}
+
+/* Applies the scale @factor to @canvas and arranges its content
+ * (but not the canvas itself) to get the extents of the drawing,
+ * paddings included, in @extents */
+static gboolean
+_adg_autoscale_arrange(AdgCanvas *canvas, gdouble factor, CpmlExtents *extents)
+{
+    AdgEntity *entity;
+    cairo_matrix_t map;
+
+    entity = (AdgEntity *) canvas;
+
+    cairo_matrix_init_scale(&map, factor, factor);
+    adg_entity_set_local_map(entity, &map);
+    adg_entity_local_changed(entity);
+
+    _ADG_OLD_ENTITY_CLASS->arrange(entity);
+    cpml_extents_copy(extents, _adg_entity_get_extents(entity));
+
+    if (! extents->is_defined)
+        return FALSE;
+
+    _adg_apply_paddings(canvas, extents);
+    return TRUE;
+}
+
+/* If @extents fit the paper, centers the drawing on it */
+static gboolean
+_adg_autoscale_center(AdgCanvas *canvas, const CpmlExtents *extents)
+{
+    AdgCanvasPrivate *data;
+    CpmlPair delta;
+    cairo_matrix_t transform;
+
+    data = canvas->data;
+    delta.x = data->size.x - extents->size.x;
+    delta.y = data->size.y - extents->size.y;
+
+    if (delta.x < 0 || delta.y < 0)
+        return FALSE;
+
+    cairo_matrix_init_translate(&transform,
+                                delta.x / 2 - extents->org.x,
+                                delta.y / 2 - extents->org.y);
+    adg_entity_transform_local_map((AdgEntity *) canvas, &transform,
+                                   ADG_TRANSFORM_AFTER);
+    return TRUE;
+}
+
+/* Collects the extents of the leaves contributing to the extents
+ * of the canvas, i.e. skipping the floating and collapsed entities */
+static void
+_adg_autoscale_walk(AdgEntity *entity, GArray *boxes)
+{
+    if (adg_entity_has_floating(entity) || _adg_entity_is_collapsed(entity))
+        return;
+
+    if (ADG_IS_CONTAINER(entity)) {
+        adg_container_foreach((AdgContainer *) entity,
+                              G_CALLBACK(_adg_autoscale_walk), boxes);
+    } else {
+        g_array_append_vals(boxes, _adg_entity_get_extents(entity), 1);
+    }
+}
+
+/* Estimates the extents of the drawing with the scale @factor by
+ * linearly interpolating the extents sampled with two other scales */
+static void
+_adg_autoscale_estimate(AdgCanvas *canvas,
+                        GArray *boxes1, gdouble factor1,
+                        GArray *boxes2, gdouble factor2,
+                        gdouble factor, CpmlExtents *extents)
+{
+    const CpmlExtents *box1, *box2;
+    CpmlExtents box;
+    gdouble t, x1, y1, x2, y2;
+    guint n;
+
+    t = (factor - factor1) / (factor2 - factor1);
+    extents->is_defined = FALSE;
+
+    for (n = 0; n < boxes1->len; ++n) {
+        box1 = &g_array_index(boxes1, CpmlExtents, n);
+        box2 = &g_array_index(boxes2, CpmlExtents, n);
+        if (! box1->is_defined || ! box2->is_defined)
+            continue;
+
+        x1 = box1->org.x + t * (box2->org.x - box1->org.x);
+        y1 = box1->org.y + t * (box2->org.y - box1->org.y);
+        x2 = box1->org.x + box1->size.x +
+            t * (box2->org.x + box2->size.x - box1->org.x - box1->size.x);
+        y2 = box1->org.y + box1->size.y +
+            t * (box2->org.y + box2->size.y - box1->org.y - box1->size.y);
+
+        box.is_defined = TRUE;
+        box.org.x = MIN(x1, x2);
+        box.org.y = MIN(y1, y2);
+        box.size.x = fabs(x2 - x1);
+        box.size.y = fabs(y2 - y1);
+        cpml_extents_add(extents, &box);
+    }
+
+    if (extents->is_defined)
+        _adg_apply_paddings(canvas, extents);
+}
+
+static void
+_adg_apply_paddings(AdgCanvas *canvas, CpmlExtents *extents)
+{
+    AdgCanvasPrivate *data = canvas->data;
+
+    extents->org.x -= data->left_padding;
+    extents->size.x += data->left_padding + data->right_padding;
+    extents->org.y -= data->top_padding;
+    extents->size.y += data->top_padding + data->bottom_padding;
+}
+
+static void
+_adg_render_list_clear(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data;
+    GPtrArray *nodes;
+    AdgEntity *entity;
+    guint n;
+
+    data = canvas->data;
+    nodes = data->render_nodes;
+
+    if (nodes == NULL)
+        return;
+
+    /* Reset the pointers before disconnecting the handlers:
+     * this function can be reentered while unreferencing */
+    data->render_nodes = NULL;
+
+    for (n = 0; n < nodes->len; ++n) {
+        entity = g_ptr_array_index(nodes, n);
+        g_signal_handlers_disconnect_by_func(entity, _adg_render_list_clear,
+                                             canvas);
+        g_object_unref(entity);
+    }
+
+    g_ptr_array_free(nodes, TRUE);
+    g_ptr_array_free(data->render_list, TRUE);
+    g_array_free(data->render_layers, TRUE);
+    data->render_list = NULL;
+    data->render_layers = NULL;
+}
+
+/* @layers is the mask of the layers of the ancestors of @entity:
+ * hiding any of them hides @entity too */
+static void
+_adg_render_list_walk(AdgCanvas *canvas, AdgEntity *entity, guint32 layers)
+{
+    AdgCanvasPrivate *data;
+    GCallback callback;
+    GObject *object;
+
+    data = canvas->data;
+    callback = G_CALLBACK(_adg_render_list_clear);
+    object = (GObject *) entity;
+    layers |= 1u << adg_entity_get_layer(entity);
+
+    /* Any change on a watched entity drops the whole list */
+    g_object_ref(object);
+    g_ptr_array_add(data->render_nodes, entity);
+    g_signal_connect_swapped(object, "notify", callback, canvas);
+    g_signal_connect_swapped(object, "destroy", callback, canvas);
+    g_signal_connect_swapped(object, "global-changed", callback, canvas);
+    g_signal_connect_swapped(object, "local-changed", callback, canvas);
+    g_signal_connect_swapped(object, "invalidate", callback, canvas);
+
+    /* Hidden entities are watched, so showing them drops the list */
+    if (! adg_entity_is_visible(entity))
+        return;
+
+    /* Flatten only plain containers: any subclass overriding the
+     * render() method (e.g. AdgAlignment) is rendered as a whole */
+    if (ADG_IS_CONTAINER(entity) &&
+        ADG_ENTITY_GET_CLASS(entity)->render == _ADG_OLD_ENTITY_CLASS->render) {
+        GSList *children;
+
+        g_signal_connect_swapped(object, "add", callback, canvas);
+        g_signal_connect_swapped(object, "remove", callback, canvas);
+
+        children = adg_container_children((AdgContainer *) entity);
+        while (children != NULL) {
+            if (children->data != NULL)
+                _adg_render_list_walk(canvas, children->data, layers);
+            children = g_slist_delete_link(children, children);
+        }
+    } else if (ADG_ENTITY_GET_CLASS(entity)->render != NULL) {
+        g_ptr_array_add(data->render_list, entity);
+        g_array_append_val(data->render_layers, layers);
+    }
+}
+
+static void
+_adg_render_list_compile(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data;
+    GSList *children;
+
+    data = canvas->data;
+
+    _adg_render_list_clear(canvas);
+
+    data->render_nodes = g_ptr_array_new();
+    data->render_list = g_ptr_array_new();
+    data->render_layers = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+    /* Keep the same order used by _adg_render(). The layers are stored
+     * alongside the entities, so showing or hiding a layer changes only
+     * which entities are replayed and the list is still valid */
+    if (data->title_block)
+        _adg_render_list_walk(canvas, (AdgEntity *) data->title_block, 0);
+
+    children = adg_container_children((AdgContainer *) canvas);
+    while (children != NULL) {
+        if (children->data != NULL)
+            _adg_render_list_walk(canvas, children->data, 0);
+        children = g_slist_delete_link(children, children);
+    }
+}
+
+static void
+_adg_render_list_replay(AdgCanvas *canvas, guint32 hidden_layers, cairo_t *cr)
+{
+    AdgCanvasPrivate *data;
+    GPtrArray *list;
+    AdgEntity *entity;
+    guint n;
+
+    data = canvas->data;
+    list = data->render_list;
+
+    /* Bail out if the list has been dropped by some side effect */
+    n = 0;
+    while (data->render_list == list && n < list->len) {
+        entity = g_ptr_array_index(list, n);
+        if (g_array_index(data->render_layers, guint32, n) & hidden_layers) {
+            ++n;
+        } else if (_adg_is_batchable(entity, NULL)) {
+            n += _adg_render_batch(canvas, n, hidden_layers, cr);
+        } else {
+            cairo_save(cr);
+            ADG_ENTITY_GET_CLASS(entity)->render(entity, cr);
+            cairo_restore(cr);
+            ++n;
+        }
+    }
+}
+
+/* Checks if @entity is a plain stroke that can be stroked together
+ * with other ones. If @first is not NULL, @entity must also resolve
+ * its line dress to the same style and have the same global matrix
+ * of @first, the entity starting the batch */
+static gboolean
+_adg_is_batchable(AdgEntity *entity, AdgEntity *first)
+{
+    AdgStroke *stroke;
+    AdgTrail *trail;
+
+    /* Subclasses could override the rendering */
+    if (G_OBJECT_TYPE(entity) != ADG_TYPE_STROKE)
+        return FALSE;
+
+    stroke = (AdgStroke *) entity;
+    trail = adg_stroke_get_trail(stroke);
+
+    /* Cached dashes need their own path */
+    if (trail == NULL || adg_stroke_has_dash_cache(stroke) ||
+        adg_trail_get_cairo_path(trail) == NULL)
+        return FALSE;
+
+    if (first == NULL)
+        return TRUE;
+
+    return adg_entity_style(entity, adg_stroke_get_line_dress(stroke)) ==
+           adg_entity_style(first, adg_stroke_get_line_dress((AdgStroke *) first)) &&
+           adg_matrix_equal(_adg_entity_get_global_matrix(entity),
+                            adg_entity_get_global_matrix(first));
+}
+
+/* Strokes at once the batchable entities of the render list starting
+ * from @first, returning the number of entities rendered. Entities in
+ * @hidden_layers break the batch */
+static guint
+_adg_render_batch(AdgCanvas *canvas, guint first, guint32 hidden_layers,
+                  cairo_t *cr)
+{
+    AdgCanvasPrivate *data;
+    GPtrArray *list;
+    AdgEntity *entity, *first_entity;
+    AdgTrail *trail;
+    guint n;
+
+    data = canvas->data;
+    list = data->render_list;
+    first_entity = g_ptr_array_index(list, first);
+
+    cairo_save(cr);
+    cairo_transform(cr, adg_entity_get_global_matrix(first_entity));
+
+    n = first;
+    do {
+        entity = g_ptr_array_index(list, n);
+        trail = adg_stroke_get_trail((AdgStroke *) entity);
+        cairo_save(cr);
+        cairo_transform(cr, _adg_entity_get_local_matrix(entity));
+        cairo_append_path(cr, _adg_trail_get_cairo_path(trail));
+        cairo_restore(cr);
+        ++n;
+    } while (n < list->len &&
+             (g_array_index(data->render_layers, guint32, n) & hidden_layers) == 0 &&
+             _adg_is_batchable(g_ptr_array_index(list, n), first_entity));
+
+    adg_entity_apply_dress(first_entity,
+                           adg_stroke_get_line_dress((AdgStroke *) first_entity),
+                           cr);
+    cairo_stroke(cr);
+    cairo_restore(cr);
+
+    return n - first;
+}
+
+static void
+_adg_spatial_index_clear(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data = canvas->data;
+
+    if (data->spatial_index != NULL) {
+        adg_spatial_index_destroy(data->spatial_index);
+        data->spatial_index = NULL;
+    }
+}
+
+static void
+_adg_arrange_stack_clear(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data = canvas->data;
+    guint n;
+
+    if (data->arrange_stack == NULL)
+        return;
+
+    for (n = 0; n < data->arrange_stack->len; ++n)
+        g_object_unref(g_array_index(data->arrange_stack,
+                                     AdgArrangeFrame, n).entity);
+
+    g_array_free(data->arrange_stack, TRUE);
+    data->arrange_stack = NULL;
+}
+
+static void
+_adg_arrange_push(GArray *stack, AdgEntity *entity)
+{
+    AdgArrangeFrame frame;
+
+    frame.entity = g_object_ref(entity);
+    frame.expanded = FALSE;
+
+    g_array_append_val(stack, frame);
+}
+
+static gint64
+_adg_now_us(void)
+{
+    GTimeVal now;
+
+    g_get_current_time(&now);
+
+    return (gint64) now.tv_sec * G_USEC_PER_SEC + now.tv_usec;
+}
+
+static void
+_adg_collect_dims(AdgEntity *entity, GPtrArray *dims)
+{
+    if (ADG_IS_CONTAINER(entity))
+        adg_container_foreach((AdgContainer *) entity,
+                              G_CALLBACK(_adg_collect_dims), dims);
+    else if (ADG_IS_DIM(entity))
+        g_ptr_array_add(dims, entity);
+}
+
+/* Checks if @quote overlaps any quote in @others ranked before
+ * @n_order: collisions with the following quotes are left to them */
+static gboolean
+_adg_quote_collides(AdgEntity *quote, GSList *others,
+                    GHashTable *order, guint n_order)
+{
+    const CpmlExtents *extents;
+    AdgEntity *other;
+    guint rank;
+
+    extents = adg_entity_get_extents(quote);
+
+    for (; others != NULL; others = others->next) {
+        other = others->data;
+        if (other == quote)
+            continue;
+
+        rank = GPOINTER_TO_UINT(g_hash_table_lookup(order, other));
+        if (rank == 0 || rank >= n_order)
+            continue;
+
+        if (_adg_extents_overlap(extents, adg_entity_get_extents(other)))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* Unlike cpml_extents_is_inside(), touching boxes do not overlap */
+static gboolean
+_adg_extents_overlap(const CpmlExtents *extents1,
+                     const CpmlExtents *extents2)
+{
+    if (! extents1->is_defined || ! extents2->is_defined)
+        return FALSE;
+
+    return extents1->org.x < extents2->org.x + extents2->size.x &&
+           extents2->org.x < extents1->org.x + extents1->size.x &&
+           extents1->org.y < extents2->org.y + extents2->size.y &&
+           extents2->org.y < extents1->org.y + extents1->size.y;
+}
+
+static void
+_adg_spatial_index_walk(AdgEntity *entity, AdgSpatialIndex *index)
+{
+    if (ADG_IS_CONTAINER(entity)) {
+        adg_container_foreach((AdgContainer *) entity,
+                              G_CALLBACK(_adg_spatial_index_walk), index);
+    } else {
+        adg_spatial_index_add(index, entity);
+    }
+}
+
+/* Shapes in a single pass the texts of the canvas, so the shaping
+ * is not interleaved with the geometric arrange. Only one entity per
+ * (font dress, text) pair is shaped: the other ones will pick the
+ * result from the text caches while arranging */
+static void
+_adg_shape_texts(AdgCanvas *canvas)
+{
+    GHashTable *shaped = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                               g_free, NULL);
+
+    adg_container_foreach((AdgContainer *) canvas,
+                          G_CALLBACK(_adg_shape_walk), shaped);
+
+    g_hash_table_destroy(shaped);
+}
+
+static void
+_adg_shape_walk(AdgEntity *entity, GHashTable *shaped)
+{
+    if (ADG_IS_CONTAINER(entity)) {
+        adg_container_foreach((AdgContainer *) entity,
+                              G_CALLBACK(_adg_shape_walk), shaped);
+    } else if (ADG_IS_TEXTUAL(entity)) {
+        AdgTextual *textual;
+        gchar *text, *key;
+
+        textual = (AdgTextual *) entity;
+        text = adg_textual_dup_text(textual);
+        if (text == NULL)
+            return;
+
+        key = g_strdup_printf("%d\x1f%s",
+                              adg_textual_get_font_dress(textual), text);
+        g_free(text);
+
+        if (g_hash_table_lookup(shaped, key) == NULL) {
+            g_hash_table_insert(shaped, key, entity);
+            adg_textual_shape(textual);
+        } else {
+            g_free(key);
+        }
+    }
+}
+
+
+/**
+ * adg_canvas_export:
+ * @canvas: an #AdgCanvas
+ * @type: (type gint): the export format
+ * @file: the name of the resulting file
+ * @gerror: (allow-none): return location for errors
+ *
+ * A helper function that provides a bare export functionality.
+ * It basically exports the drawing in @canvas in the @file
+ * in the @type format. Any error will be reported in @gerror,
+ * if not <constant>NULL</constant>.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export(AdgCanvas *canvas, cairo_surface_type_t type,
+                  const gchar *file, GError **gerror)
+{
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    return _adg_export(canvas, type, file, NULL, NULL,
+                       adg_canvas_get_factor(canvas), NULL, gerror);
+}
+
+/**
+ * adg_canvas_export_to_stream:
+ * @canvas: an #AdgCanvas
+ * @type: (type gint): the export format
+ * @write_func: (scope call): the function called to write the output
+ * @closure: closure data passed to @write_func
+ * @gerror: (allow-none): return location for errors
+ *
+ * Similar to adg_canvas_export() but, instead of writing to a file,
+ * the output is passed chunk by chunk to @write_func, e.g. for sending
+ * the drawing straight to a socket without intermediate files.
+ * Any error will be reported in @gerror, if not <constant>NULL</constant>.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_to_stream(AdgCanvas *canvas, cairo_surface_type_t type,
+                            cairo_write_func_t write_func, gpointer closure,
+                            GError **gerror)
+{
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(write_func != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    return _adg_export(canvas, type, NULL, write_func, closure,
+                       adg_canvas_get_factor(canvas), NULL, gerror);
+}
+
+/**
+ * adg_canvas_export_tiled:
+ * @canvas: an #AdgCanvas
+ * @strip_height: the height of the strips, in pixels, or 0 for the default
+ * @write_func: (scope call): the function called to write the output
+ * @closure: closure data passed to @write_func
+ * @gerror: (allow-none): return location for errors
+ *
+ * Exports @canvas as a PNG image, like adg_canvas_export() does with
+ * #CAIRO_SURFACE_TYPE_IMAGE, without ever allocating the whole
+ * image. The sheet is rendered in horizontal strips of
+ * @strip_height rows (256 by default) into a single image surface
+ * and every strip is compressed and passed to @write_func before
+ * rendering the next one, so the memory needed does not depend on
+ * the height of the output. This allows to rasterize sheets bigger
+ * than the image surfaces supported by cairo, e.g. an A0 sheet at
+ * 600 DPI with a #AdgCanvas:factor of about 8.3.
+ *
+ * Any strip is rendered by replaying the whole canvas with the strip
+ * as clip area, so the entities that are completely outside of it
+ * are culled as usual. The compression is limited to runs of equal
+ * bytes, that is good enough for the large uniform areas typical of
+ * technical drawings: the output can be recompressed with any PNG
+ * optimizer if size matters.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_tiled(AdgCanvas *canvas, gint strip_height,
+                        cairo_write_func_t write_func, gpointer closure,
+                        GError **gerror)
+{
+    gdouble top, left, width, height, factor;
+    gint n_width, n_height, y, n_rows, row, col, stride;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    cairo_status_t status;
+    AdgPngWriter *writer;
+    const guchar *data;
+    const guint32 *pixel;
+    guchar *scanline;
+    ADG_TRACE_START(span);
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(write_func != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    if (strip_height <= 0)
+        strip_height = 256;
+
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    factor = adg_canvas_get_factor(canvas);
+    _adg_export_page_size(canvas, factor, &width, &height, &left, &top);
+    n_width = width;
+    n_height = height;
+    strip_height = MIN(strip_height, MAX(n_height, 1));
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24,
+                                         n_width, strip_height);
+    status = cairo_surface_status(surface);
+    if (status != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        return FALSE;
+    }
+
+    writer = g_new(AdgPngWriter, 1);
+    writer->write_func = write_func;
+    writer->closure = closure;
+    writer->status = CAIRO_STATUS_SUCCESS;
+    _adg_png_begin(writer, n_width, n_height);
+
+    /* Every scanline is prefixed by its filter type (0, i.e. none) */
+    scanline = g_malloc(n_width * 3 + 1);
+    scanline[0] = 0;
+    stride = cairo_image_surface_get_stride(surface);
+
+    for (y = 0; y < n_height && writer->status == CAIRO_STATUS_SUCCESS;
+         y += strip_height) {
+        n_rows = MIN(strip_height, n_height - y);
+
+        /* Moving the device offset up by y pixels shows the strip
+         * starting at row y: the surface bounds act as clip area */
+        cairo_surface_set_device_offset(surface, left, top - y);
+        cairo_surface_set_device_scale(surface, factor, factor);
+        cr = cairo_create(surface);
+
+        cairo_save(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_restore(cr);
+
+        adg_entity_render((AdgEntity *) canvas, cr);
+        status = cairo_status(cr);
+        cairo_destroy(cr);
+
+        if (status != CAIRO_STATUS_SUCCESS) {
+            writer->status = status;
+            break;
+        }
+
+        cairo_surface_flush(surface);
+        data = cairo_image_surface_get_data(surface);
+
+        for (row = 0; row < n_rows; ++row) {
+            pixel = (const guint32 *) (data + row * stride);
+            for (col = 0; col < n_width; ++col) {
+                scanline[col * 3 + 1] = pixel[col] >> 16;
+                scanline[col * 3 + 2] = pixel[col] >> 8;
+                scanline[col * 3 + 3] = pixel[col];
+            }
+            _adg_png_bytes(writer, scanline, n_width * 3 + 1);
+        }
+    }
+
+    if (writer->status == CAIRO_STATUS_SUCCESS)
+        _adg_png_end(writer);
+
+    status = writer->status;
+    g_free(scanline);
+    g_free(writer);
+    cairo_surface_destroy(surface);
+
+    ADG_TRACE_STOP(span, "export", "tiled");
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * adg_canvas_render_to_buffer:
+ * @canvas: an #AdgCanvas
+ * @buffer: (array): the pixel buffer to render into
+ * @format: (type gint): the pixel format of @buffer
+ * @width: the width of @buffer, in pixels
+ * @height: the height of @buffer, in pixels
+ * @stride: the number of bytes between the start of two rows of @buffer
+ * @gerror: (allow-none): return location for errors
+ *
+ * Renders @canvas into a caller-provided @buffer, e.g. for building
+ * thumbnails in memory without encoding and decoding any image file.
+ * The supported formats are #CAIRO_FORMAT_ARGB32, #CAIRO_FORMAT_RGB24
+ * and #CAIRO_FORMAT_A8, with the memory layout described by the cairo
+ * documentation. @stride must be at least the value returned by
+ * cairo_format_stride_for_width() for @format and @width.
+ *
+ * The drawing, margins included, is scaled to fit @width x @height
+ * without distortion and centered in the buffer. The content of
+ * @buffer is cleared before rendering, so the areas not covered by
+ * the sheet are transparent (or black with #CAIRO_FORMAT_RGB24).
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_render_to_buffer(AdgCanvas *canvas, guchar *buffer,
+                            cairo_format_t format, gint width, gint height,
+                            gint stride, GError **gerror)
+{
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(buffer != NULL, FALSE);
+    g_return_val_if_fail(width > 0 && height > 0, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    return _adg_render_to_buffer(canvas, buffer, format, width, height,
+                                 stride, FALSE, gerror);
+}
+
+/**
+ * adg_canvas_render_preview:
+ * @canvas: an #AdgCanvas
+ * @buffer: (array): the pixel buffer to render into
+ * @format: (type gint): the pixel format of @buffer
+ * @width: the width of @buffer, in pixels
+ * @height: the height of @buffer, in pixels
+ * @stride: the number of bytes between the start of two rows of @buffer
+ * @gerror: (allow-none): return location for errors
+ *
+ * Similar to adg_canvas_render_to_buffer() but the rendering is
+ * performed in preview quality (see adg_switch_preview()), i.e. the
+ * details that cannot be seen in a small thumbnail are skipped or
+ * simplified. This is intended for batch generation of previews,
+ * where the speed matters more than the fidelity.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_render_preview(AdgCanvas *canvas, guchar *buffer,
+                          cairo_format_t format, gint width, gint height,
+                          gint stride, GError **gerror)
+{
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(buffer != NULL, FALSE);
+    g_return_val_if_fail(width > 0 && height > 0, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    return _adg_render_to_buffer(canvas, buffer, format, width, height,
+                                 stride, TRUE, gerror);
+}
+
+/**
+ * adg_canvas_export_multi:
+ * @canvas: an #AdgCanvas
+ * @n_targets: number of targets
+ * @types: (array length=n_targets) (type gint): the export formats
+ * @files: (array length=n_targets): the names of the resulting files
+ * @factors: (array length=n_targets) (allow-none): the factors to use
+ * @gerror: (allow-none): return location for errors
+ *
+ * Exports the drawing in @canvas to @n_targets files in one pass.
+ * The n-th file is named @files[n] and it is written in the
+ * @types[n] format. If @factors is not <constant>NULL</constant>,
+ * @factors[n] is used instead of #AdgCanvas:factor, e.g. for
+ * generating a small PNG thumbnail together with the full size PDF.
+ *
+ * @canvas is arranged and rendered only once into a cairo recording
+ * surface that is then replayed on every target, so styles and
+ * layouts are not computed again for any additional format.
+ *
+ * The export stops on the first error, reported in @gerror if not
+ * <constant>NULL</constant>.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_multi(AdgCanvas *canvas, guint n_targets,
+                        const cairo_surface_type_t *types,
+                        const gchar **files, const gdouble *factors,
+                        GError **gerror)
+{
+    cairo_surface_t *recording;
+    cairo_t *cr;
+    gdouble factor;
+    gboolean success;
+    guint n;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(n_targets == 0 || types != NULL, FALSE);
+    g_return_val_if_fail(n_targets == 0 || files != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    for (n = 0; n < n_targets; ++n) {
+        g_return_val_if_fail(files[n] != NULL, FALSE);
+        g_return_val_if_fail(factors == NULL || factors[n] > 0, FALSE);
+    }
+
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    /* Render the drawing once */
+    recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+    cr = cairo_create(recording);
+    adg_entity_render((AdgEntity *) canvas, cr);
+    cairo_destroy(cr);
+
+    success = TRUE;
+    for (n = 0; success && n < n_targets; ++n) {
+        factor = factors != NULL ? factors[n] : adg_canvas_get_factor(canvas);
+        success = _adg_export(canvas, types[n], files[n], NULL, NULL,
+                              factor, recording, gerror);
+    }
+
+    cairo_surface_destroy(recording);
+    return success;
+}
+
+/**
+ * adg_canvas_export_sheets:
+ * @n_canvases: number of canvases
+ * @canvases: (array length=n_canvases): the canvases to export
+ * @type: (type gint): the export format
+ * @write_func: (scope call): the function called to write the output
+ * @closure: closure data passed to @write_func
+ * @gerror: (allow-none): return location for errors
+ *
+ * Exports a set of sheets in a single multi-page document, one page
+ * per canvas in the same order of @canvases. Every page has the
+ * size of its own canvas, margins included, computed as in
+ * adg_canvas_export() with the #AdgCanvas:factor of that canvas.
+ * The output is passed chunk by chunk to @write_func, as done by
+ * adg_canvas_export_to_stream().
+ *
+ * Only the paged formats are supported, i.e. @type must be
+ * #CAIRO_SURFACE_TYPE_PDF or #CAIRO_SURFACE_TYPE_PS. Using a single
+ * surface for all the sheets lets cairo share the font subsets and
+ * the resources among the pages, so the result is much smaller and
+ * faster to generate than separate documents merged afterwards.
+ *
+ * The export stops on the first error, reported in @gerror if not
+ * <constant>NULL</constant>.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_sheets(guint n_canvases, AdgCanvas **canvases,
+                         cairo_surface_type_t type,
+                         cairo_write_func_t write_func, gpointer closure,
+                         GError **gerror)
+{
+    return adg_canvas_export_sheets_full(n_canvases, canvases, type,
+                                         write_func, closure, 1, gerror);
+}
+
+/**
+ * adg_canvas_export_sheets_full:
+ * @n_canvases: number of canvases
+ * @canvases: (array length=n_canvases): the canvases to export
+ * @type: (type gint): the export format
+ * @write_func: (scope call): the function called to write the output
+ * @closure: closure data passed to @write_func
+ * @n_threads: number of worker threads, or 0 to use one per processor
+ * @gerror: (allow-none): return location for errors
+ *
+ * Similar to adg_canvas_export_sheets() but the sheets can be
+ * arranged and rendered concurrently. When @n_threads is greater
+ * than 1 (or 0 on a multiprocessor machine), every canvas is
+ * arranged and rendered on a worker thread into its own cairo
+ * recording surface. The recordings are then replayed in order on
+ * the final document by the calling thread, so the output does not
+ * depend on the number of threads.
+ *
+ * As explained in the #AdgCanvas description, the canvases can be
+ * processed in parallel only if they do not share any entity,
+ * model or style instance. The sheets are exported sequentially
+ * if @n_threads is 1 or if the GLib version in use does not
+ * support the needed thread primitives.
+ *
+ * When exporting to PDF sequentially, the background, the frame and
+ * the static part of the title block (its frame, grid, titles and
+ * non-textual values such as the logo) are recorded once and shared
+ * by all the sheets with the same layout: the document contains a
+ * single form XObject referenced by every page, while only the
+ * textual values of the title block are emitted per page.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_sheets_full(guint n_canvases, AdgCanvas **canvases,
+                              cairo_surface_type_t type,
+                              cairo_write_func_t write_func, gpointer closure,
+                              guint n_threads, GError **gerror)
+{
+    AdgSheetJob *jobs, *job;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    cairo_status_t status;
+    GHashTable *forms;
+    guint n;
+    ADG_TRACE_START(span);
+
+    g_return_val_if_fail(n_canvases > 0, FALSE);
+    g_return_val_if_fail(canvases != NULL, FALSE);
+    g_return_val_if_fail(write_func != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    for (n = 0; n < n_canvases; ++n)
+        g_return_val_if_fail(ADG_IS_CANVAS(canvases[n]), FALSE);
+
+    if (type != CAIRO_SURFACE_TYPE_PDF && type != CAIRO_SURFACE_TYPE_PS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
+                    "surface type '%d' does not support multiple pages",
+                    type);
+        return FALSE;
+    }
+
+    jobs = g_new0(AdgSheetJob, n_canvases);
+    for (n = 0; n < n_canvases; ++n)
+        jobs[n].canvas = canvases[n];
+
+    /* Without workers, the sheets are arranged and rendered
+     * straight on the document, one page at a time */
+    if (n_threads == 0)
+        n_threads = _adg_get_num_processors();
+    if (n_threads > 1 && n_canvases > 1)
+        _adg_sheets_record(jobs, n_canvases, n_threads);
+
+    surface = NULL;
+    status = CAIRO_STATUS_SUCCESS;
+    forms = NULL;
+    if (type == CAIRO_SURFACE_TYPE_PDF)
+        forms = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                      (GDestroyNotify) cairo_surface_destroy);
+
+    for (n = 0; status == CAIRO_STATUS_SUCCESS && n < n_canvases; ++n) {
+        job = &jobs[n];
+
+        if (job->recording == NULL)
+            _adg_sheet_prepare(job);
+
+        if (surface == NULL) {
+            surface = _adg_export_surface(type, NULL, write_func, closure,
+                                          job->width, job->height);
+            if (surface == NULL)
+                break;
+#ifdef CAIRO_HAS_PDF_SURFACE
+        } else if (type == CAIRO_SURFACE_TYPE_PDF) {
+            cairo_pdf_surface_set_size(surface, job->width, job->height);
+#endif
+#ifdef CAIRO_HAS_PS_SURFACE
+        } else if (type == CAIRO_SURFACE_TYPE_PS) {
+            cairo_ps_surface_set_size(surface, job->width, job->height);
+#endif
+        }
+
+        /* The device transformation must be changed before
+         * creating the context of every page */
+        cairo_surface_set_device_offset(surface, job->left, job->top);
+        cairo_surface_set_device_scale(surface, job->factor, job->factor);
+        cr = cairo_create(surface);
+
+        if (job->recording != NULL) {
+            cairo_set_source_surface(cr, job->recording, 0, 0);
+            cairo_paint(cr);
+        } else {
+            if (forms != NULL)
+                cairo_set_user_data(cr, &_adg_forms_key, forms, NULL);
+            adg_entity_render((AdgEntity *) job->canvas, cr);
+        }
+
+        cairo_show_page(cr);
+        status = cairo_status(cr);
+        cairo_destroy(cr);
+    }
+
+    for (n = 0; n < n_canvases; ++n) {
+        if (jobs[n].recording != NULL)
+            cairo_surface_destroy(jobs[n].recording);
+    }
+    g_free(jobs);
+
+    if (surface == NULL) {
+        if (forms != NULL)
+            g_hash_table_destroy(forms);
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
+                    "unable to handle surface type '%d'",
+                    type);
+        return FALSE;
+    }
+
+    /* Flush the trailer of the document before checking for errors */
+    cairo_surface_finish(surface);
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = cairo_surface_status(surface);
+    cairo_surface_destroy(surface);
+
+    /* The forms are referenced by the document until it is finished */
+    if (forms != NULL)
+        g_hash_table_destroy(forms);
+
+    ADG_TRACE_STOP(span, "export", "sheets");
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * adg_canvas_export_dxf:
+ * @canvas: an #AdgCanvas
+ * @write_func: (scope call): the function called to write the output
+ * @closure: closure data passed to @write_func
+ * @gerror: (allow-none): return location for errors
+ *
+ * Exports the geometry of @canvas in the AutoCAD DXF format (release
+ * 12, the most widely understood by CAD and CAM software). Instead
+ * of going through a cairo surface, the arranged canvas is walked
+ * and every entity is translated into the equivalent DXF entities:
+ * <itemizedlist>
+ * <listitem>the trails of #AdgStroke and #AdgHatch entities become
+ *           LINE and ARC entities, while Bézier curves (and arcs
+ *           distorted by non-uniform scaling) are approximated with
+ *           POLYLINE entities;</listitem>
+ * <listitem>the #AdgTextual entities become TEXT entities, placed at
+ *           the bottom left corner of their extents.</listitem>
+ * </itemizedlist>
+ * Any other entity (dimensions, tables, the title block...) is not
+ * exported. Every entity is put on a layer named after its line,
+ * fill or font dress.
+ *
+ * The coordinates are the ones of the canvas, i.e. the global
+ * and local matrices are applied, with the y axis pointing upward as
+ * expected by DXF. The output is passed chunk by chunk to
+ * @write_func while walking the canvas, so no intermediate document
+ * is built in memory.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_dxf(AdgCanvas *canvas, cairo_write_func_t write_func,
+                      gpointer closure, GError **gerror)
+{
+    AdgDxfWriter writer;
+    GHashTable *layers;
+    GHashTableIter iter;
+    gpointer layer;
+    gchar *n_layers;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(write_func != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    writer.write_func = write_func;
+    writer.closure = closure;
+    writer.buffer = g_string_sized_new(4096);
+    writer.status = CAIRO_STATUS_SUCCESS;
+
+    _adg_dxf_group(&writer, 0, "SECTION");
+    _adg_dxf_group(&writer, 2, "HEADER");
+    _adg_dxf_group(&writer, 9, "$ACADVER");
+    _adg_dxf_group(&writer, 1, "AC1009");
+    _adg_dxf_group(&writer, 0, "ENDSEC");
+
+    /* The layers must be declared before the entities using them,
+     * so a first (cheap) pass just collects their names */
+    layers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    g_hash_table_insert(layers, g_strdup("0"), NULL);
+    _adg_dxf_collect((AdgEntity *) canvas, layers);
+
+    n_layers = g_strdup_printf("%u", g_hash_table_size(layers));
+    _adg_dxf_group(&writer, 0, "SECTION");
+    _adg_dxf_group(&writer, 2, "TABLES");
+    _adg_dxf_group(&writer, 0, "TABLE");
+    _adg_dxf_group(&writer, 2, "LAYER");
+    _adg_dxf_group(&writer, 70, n_layers);
+    g_free(n_layers);
+
+    g_hash_table_iter_init(&iter, layers);
+    while (g_hash_table_iter_next(&iter, &layer, NULL)) {
+        _adg_dxf_group(&writer, 0, "LAYER");
+        _adg_dxf_group(&writer, 2, layer);
+        _adg_dxf_group(&writer, 70, "0");
+        _adg_dxf_group(&writer, 62, "7");
+        _adg_dxf_group(&writer, 6, "CONTINUOUS");
+    }
+    g_hash_table_destroy(layers);
+
+    _adg_dxf_group(&writer, 0, "ENDTAB");
+    _adg_dxf_group(&writer, 0, "ENDSEC");
+    _adg_dxf_flush(&writer);
+
+    _adg_dxf_group(&writer, 0, "SECTION");
+    _adg_dxf_group(&writer, 2, "ENTITIES");
+    _adg_dxf_walk((AdgEntity *) canvas, &writer);
+    _adg_dxf_group(&writer, 0, "ENDSEC");
+    _adg_dxf_group(&writer, 0, "EOF");
+    _adg_dxf_flush(&writer);
+
+    g_string_free(writer.buffer, TRUE);
+
+    if (writer.status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(writer.status));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * adg_canvas_export_stream:
+ * @canvas: an #AdgCanvas
+ * @versions: (allow-none) (element-type guint guint): the record versions of the previous export
+ * @write_func: (scope call): the function called to write the output
+ * @closure: closure data passed to @write_func
+ * @gerror: (allow-none): return location for errors
+ *
+ * Exports the compiled render list of @canvas as a JSON stream meant
+ * to be consumed by web clients. Every item of the render list (see
+ * adg_canvas_switch_render_list()) becomes a record with a stable id,
+ * the type name, the mask of the layers it belongs to, its extents
+ * and the SVG document rendering that item alone, positioned at the
+ * origin of its extents. The stream has the following layout:
+ *
+ * <informalexample><programlisting>
+ * {"version":1,"extents":[x,y,width,height],
+ *  "entities":[{"id":1,"type":"AdgStroke","layers":1,
+ *               "extents":[x,y,width,height],"svg":"..."},...],
+ *  "order":[1,...],"removed":[...]}
+ * </programlisting></informalexample>
+ *
+ * The ids are bound to the entities, so they do not change across
+ * exports as long as the entities are alive. "order" lists the ids of
+ * the whole render list in painting order.
+ *
+ * When @versions is not <constant>NULL</constant>, the export works in
+ * diff mode: @versions maps the ids to the versions of the records
+ * sent by the previous export, so only the new and changed records
+ * are emitted and the ids no more in the render list are listed in
+ * "removed". @versions is then updated in place for the next call.
+ * Start with an empty table created with
+ * <code>g_hash_table_new(NULL, NULL)</code> to get a full export and
+ * keep passing it to get the diffs.
+ *
+ * This requires a cairo library with SVG support.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_stream(AdgCanvas *canvas, GHashTable *versions,
+                         cairo_write_func_t write_func, gpointer closure,
+                         GError **gerror)
+{
+#ifdef CAIRO_HAS_SVG_SURFACE
+    AdgCanvasPrivate *data;
+    AdgDxfWriter writer;
+    GHashTable *seen;
+    GHashTableIter iter;
+    GString *record, *order;
+    gpointer key, value;
+    AdgEntity *entity;
+    const CpmlExtents *extents;
+    gchar *svg;
+    guint n, id, version, n_records;
+    gboolean has_list;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(write_func != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    data = canvas->data;
+
+    /* The render list is compiled on the fly if not enabled,
+     * so the record order is the painting order in both cases */
+    adg_entity_arrange((AdgEntity *) canvas);
+    has_list = data->render_list != NULL;
+    if (! has_list)
+        _adg_render_list_compile(canvas);
+
+    writer.write_func = write_func;
+    writer.closure = closure;
+    writer.buffer = g_string_sized_new(4096);
+    writer.status = CAIRO_STATUS_SUCCESS;
+
+    seen = g_hash_table_new(NULL, NULL);
+    record = g_string_sized_new(4096);
+    order = g_string_new(NULL);
+    n_records = 0;
+
+    g_string_append(writer.buffer, "{\"version\":1,\"extents\":");
+    _adg_stream_extents(writer.buffer, _adg_entity_get_extents((AdgEntity *) canvas));
+    g_string_append(writer.buffer, ",\"entities\":[");
+
+    for (n = 0; n < data->render_list->len; ++n) {
+        entity = g_ptr_array_index(data->render_list, n);
+        extents = _adg_entity_get_extents(entity);
+        id = _adg_stream_id(entity);
+
+        g_string_append_printf(order, order->len > 0 ? ",%u" : "%u", id);
+        g_hash_table_insert(seen, GUINT_TO_POINTER(id), NULL);
+
+        /* The record, id excluded, is what is versioned */
+        g_string_printf(record, ",\"type\":\"%s\",\"layers\":%u,\"extents\":",
+                        G_OBJECT_TYPE_NAME(entity),
+                        g_array_index(data->render_layers, guint32, n));
+        _adg_stream_extents(record, extents);
+        g_string_append(record, ",\"svg\":");
+        svg = extents->is_defined ? _adg_stream_svg(entity, extents) : NULL;
+        if (svg != NULL)
+            _adg_stream_string(record, svg);
+        else
+            g_string_append(record, "null");
+        g_free(svg);
+
+        version = g_str_hash(record->str);
+        if (versions != NULL) {
+            if (g_hash_table_lookup_extended(versions, GUINT_TO_POINTER(id),
+                                             NULL, &value) &&
+                GPOINTER_TO_UINT(value) == version)
+                continue;
+            g_hash_table_insert(versions, GUINT_TO_POINTER(id),
+                                GUINT_TO_POINTER(version));
+        }
+
+        g_string_append_printf(writer.buffer,
+                               n_records > 0 ? ",{\"id\":%u%s}" : "{\"id\":%u%s}",
+                               id, record->str);
+        ++n_records;
+        _adg_dxf_flush(&writer);
+    }
+
+    g_string_append_printf(writer.buffer, "],\"order\":[%s],\"removed\":[",
+                           order->str);
+
+    if (versions != NULL) {
+        n_records = 0;
+        g_hash_table_iter_init(&iter, versions);
+        while (g_hash_table_iter_next(&iter, &key, NULL)) {
+            if (g_hash_table_lookup_extended(seen, key, NULL, NULL))
+                continue;
+            g_string_append_printf(writer.buffer, n_records > 0 ? ",%u" : "%u",
+                                   GPOINTER_TO_UINT(key));
+            g_hash_table_iter_remove(&iter);
+            ++n_records;
+        }
+    }
+
+    g_string_append(writer.buffer, "]}\n");
+    _adg_dxf_flush(&writer);
+
+    g_string_free(writer.buffer, TRUE);
+    g_string_free(record, TRUE);
+    g_string_free(order, TRUE);
+    g_hash_table_destroy(seen);
+
+    if (! has_list && ! data->has_render_list)
+        _adg_render_list_clear(canvas);
+
+    if (writer.status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(writer.status));
+        return FALSE;
+    }
+
+    return TRUE;
+#else
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(write_func != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
+                "unable to handle surface type '%d'",
+                CAIRO_SURFACE_TYPE_SVG);
+    return FALSE;
+#endif
+}
+
+/**
+ * adg_canvas_export_svg:
+ * @canvas: an #AdgCanvas
+ * @write_func: (scope call): the function called to write the output
+ * @closure: closure data passed to @write_func
+ * @gerror: (allow-none): return location for errors
+ *
+ * Exports @canvas as a SVG document written natively instead of going
+ * through the cairo SVG surface, that repeats the whole geometry for
+ * every instance. Here every unique shape is emitted once in
+ * <code>&lt;defs&gt;</code> and referenced by <code>&lt;use&gt;</code>
+ * elements carrying the instance transformation, while the styles are
+ * collected in a <code>&lt;style&gt;</code> sheet and referenced by
+ * class:
+ * <itemizedlist>
+ * <listitem>the trails of #AdgStroke entities become shared paths,
+ *           so the same geometry placed many times (e.g. by different
+ *           local maps or by an #AdgInstanceArray) is stored once;</listitem>
+ * <listitem>#AdgInstanceArray entities are expanded into one
+ *           <code>&lt;use&gt;</code> per instance;</listitem>
+ * <listitem>any other entity (dimensions, texts, markers, logos...)
+ *           is rendered alone by cairo and embedded as an image:
+ *           identical renderings, such as the same logo or marker at
+ *           different positions, are shared as well. This requires
+ *           a cairo library with SVG support, otherwise these entities
+ *           are skipped.</listitem>
+ * </itemizedlist>
+ *
+ * The page has the same size of the one produced by
+ * adg_canvas_export(). The line widths do not depend on the instance
+ * transformations, hence the strokes use the
+ * <code>non-scaling-stroke</code> vector effect. Entities on hidden
+ * layers are not exported.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_export_svg(AdgCanvas *canvas, cairo_write_func_t write_func,
+                      gpointer closure, GError **gerror)
+{
+    AdgCanvasPrivate *data;
+    AdgSvgWriter writer;
+    GString *head;
+    cairo_status_t status;
+    cairo_matrix_t page;
+    gdouble top, left, width, height;
+    GSList *children;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(write_func != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    data = canvas->data;
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    writer.style = g_string_new(NULL);
+    writer.defs = g_string_sized_new(4096);
+    writer.body = g_string_sized_new(4096);
+    writer.classes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    writer.paths = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    writer.images = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    writer.factor = adg_canvas_get_factor(canvas);
+    writer.hidden_layers = data->hidden_layers;
+
+    _adg_export_page_size(canvas, writer.factor, &width, &height, &left, &top);
+    cairo_matrix_init(&page, writer.factor, 0, 0, writer.factor, left, top);
+
+    /* Same order used by _adg_render() */
+    if (data->title_block)
+        _adg_svg_walk((AdgEntity *) data->title_block, &writer, NULL);
+
+    children = adg_container_children((AdgContainer *) canvas);
+    while (children != NULL) {
+        if (children->data != NULL)
+            _adg_svg_walk(children->data, &writer, NULL);
+        children = g_slist_delete_link(children, children);
+    }
+
+    head = g_string_sized_new(1024);
+    g_string_append(head, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                    "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                    "xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"");
+    _adg_svg_number(head, width);
+    g_string_append(head, "pt\" height=\"");
+    _adg_svg_number(head, height);
+    g_string_append(head, "pt\" viewBox=\"0 0 ");
+    _adg_svg_number(head, width);
+    g_string_append_c(head, ' ');
+    _adg_svg_number(head, height);
+    g_string_append_printf(head, "\">\n<style>\n%s</style>\n<defs>\n",
+                           writer.style->str);
+
+#ifdef CAIRO_HAS_SVG_SURFACE
+    {
+        /* The backdrop (background and frame) is not shared, so it is
+         * embedded as is on the page space */
+        GString *svg;
+        cairo_surface_t *surface;
+        cairo_t *cr;
+        gchar *base64;
+
+        svg = g_string_new(NULL);
+        surface = cairo_svg_surface_create_for_stream(_adg_stream_append, svg,
+                                                      width, height);
+        cairo_surface_set_device_offset(surface, left, top);
+        cairo_surface_set_device_scale(surface, writer.factor, writer.factor);
+        cr = cairo_create(surface);
+        _adg_render_backdrop(canvas, cr);
+        cairo_destroy(cr);
+        cairo_surface_finish(surface);
+        cairo_surface_destroy(surface);
+
+        base64 = g_base64_encode((const guchar *) svg->str, svg->len);
+        g_string_append(writer.defs, "</defs>\n<image x=\"0\" y=\"0\" width=\"");
+        _adg_svg_number(writer.defs, width);
+        g_string_append(writer.defs, "\" height=\"");
+        _adg_svg_number(writer.defs, height);
+        g_string_append_printf(writer.defs,
+                               "\" xlink:href=\"data:image/svg+xml;base64,%s\"/>\n",
+                               base64);
+        g_free(base64);
+        g_string_free(svg, TRUE);
+    }
+#else
+    g_string_append(writer.defs, "</defs>\n");
+#endif
+
+    g_string_append(writer.defs, "<g transform=\"");
+    _adg_svg_matrix(writer.defs, &page);
+    g_string_append(writer.defs, "\">\n");
+    g_string_append(writer.body, "</g>\n</svg>\n");
+
+    status = write_func(closure, (const guchar *) head->str, head->len);
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = write_func(closure, (const guchar *) writer.defs->str,
+                            writer.defs->len);
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = write_func(closure, (const guchar *) writer.body->str,
+                            writer.body->len);
+
+    g_string_free(head, TRUE);
+    g_string_free(writer.style, TRUE);
+    g_string_free(writer.defs, TRUE);
+    g_string_free(writer.body, TRUE);
+    g_hash_table_destroy(writer.classes);
+    g_hash_table_destroy(writer.paths);
+    g_hash_table_destroy(writer.images);
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * adg_canvas_save_snapshot:
+ * @canvas: an #AdgCanvas
+ * @file: the name of the snapshot file
+ * @gerror: (allow-none): return location for errors
+ *
+ * Arranges and renders @canvas and stores the resulting drawing in
+ * @file. The snapshot is the flattened sequence of cairo operations
+ * (paths, matrices, sources and line styles already resolved from
+ * the dresses, shaped glyph runs and embedded fonts) serialized as
+ * cairo script, preceded by a small versioned header.
+ *
+ * A snapshot can be loaded with adg_canvas_load_snapshot(), e.g.
+ * to serve an already arranged drawing after a restart without
+ * reconstructing the entities. The size of the snapshot is the size
+ * of the drawing exported with a factor of 1, margins included.
+ *
+ * The snapshot support needs the cairo script surface and the cairo
+ * script interpreter, so it must be explicitly enabled at configure
+ * time with <code>--enable-snapshot</code>. If not enabled, this
+ * function always fails with #ADG_CANVAS_ERROR_SNAPSHOT.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_save_snapshot(AdgCanvas *canvas, const gchar *file,
+                         GError **gerror)
+{
+#ifdef SNAPSHOT_ENABLED
+    const CpmlExtents *extents;
+    gdouble top, bottom, left, right;
+    cairo_rectangle_t rect;
+    cairo_surface_t *recording;
+    cairo_device_t *script;
+    cairo_status_t status;
+    cairo_t *cr;
+    _AdgSnapshotHeader header;
+    GByteArray *snapshot;
+    gboolean success;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    adg_entity_arrange((AdgEntity *) canvas);
+    extents = _adg_entity_get_extents((AdgEntity *) canvas);
+    adg_canvas_get_margins(canvas, &top, &right, &bottom, &left);
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.width = extents->size.x + left + right;
+    rect.height = extents->size.y + top + bottom;
+
+    /* Same placement used by adg_canvas_export() */
+    recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &rect);
+    cairo_surface_set_device_offset(recording, left, top);
+    cr = cairo_create(recording);
+    adg_entity_render((AdgEntity *) canvas, cr);
+    cairo_destroy(cr);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _ADG_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = _ADG_SNAPSHOT_VERSION;
+    header.width = rect.width;
+    header.height = rect.height;
+
+    snapshot = g_byte_array_new();
+    g_byte_array_append(snapshot, (guint8 *) &header, sizeof(header));
+
+    script = cairo_script_create_for_stream(_adg_snapshot_write, snapshot);
+    status = cairo_script_from_recording_surface(script, recording);
+    cairo_device_finish(script);
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = cairo_device_status(script);
+    cairo_device_destroy(script);
+    cairo_surface_destroy(recording);
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        g_byte_array_free(snapshot, TRUE);
+        return FALSE;
+    }
+
+    ((_AdgSnapshotHeader *) snapshot->data)->script_size =
+        snapshot->len - sizeof(header);
+    success = g_file_set_contents(file, (gchar *) snapshot->data,
+                                  snapshot->len, gerror);
+    g_byte_array_free(snapshot, TRUE);
+
+    return success;
+#else
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+
+    g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                "snapshot support not enabled");
+    return FALSE;
+#endif
+}
+
+/**
+ * adg_canvas_load_snapshot:
+ * @file: the name of a file created by adg_canvas_save_snapshot()
+ * @gerror: (allow-none): return location for errors
+ *
+ * Loads a snapshot into a cairo recording surface. The operations are
+ * replayed once by the cairo script interpreter at load time: no
+ * entity is created, so neither arrange nor text shaping is performed.
+ * The returned surface is vectorial and can be rendered as many times
+ * as needed at any scale, e.g.:
+ *
+ * |[
+ * cairo_set_source_surface(cr, snapshot, 0, 0);
+ * cairo_paint(cr);
+ * ]|
+ *
+ * Returns: (transfer full): a new recording surface to be destroyed with cairo_surface_destroy() or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+cairo_surface_t *
+adg_canvas_load_snapshot(const gchar *file, GError **gerror)
+{
+#ifdef SNAPSHOT_ENABLED
+    gchar *contents;
+    gsize length;
+    _AdgSnapshotHeader header;
+    cairo_rectangle_t rect;
+    cairo_surface_t *recording;
+    cairo_script_interpreter_t *csi;
+    cairo_script_interpreter_hooks_t hooks;
+    cairo_status_t status;
+
+    g_return_val_if_fail(file != NULL, NULL);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, NULL);
+
+    if (! g_file_get_contents(file, &contents, &length, gerror))
+        return NULL;
+
+    if (length >= sizeof(header))
+        memcpy(&header, contents, sizeof(header));
+
+    if (length < sizeof(header) ||
+        memcmp(header.magic, _ADG_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != _ADG_SNAPSHOT_VERSION ||
+        header.script_size != length - sizeof(header) ||
+        header.width <= 0 || header.height <= 0) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                    "invalid or incompatible snapshot in '%s'", file);
+        g_free(contents);
+        return NULL;
+    }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.width = header.width;
+    rect.height = header.height;
+    recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &rect);
+
+    /* The script draws on the surface returned by the hook */
+    memset(&hooks, 0, sizeof(hooks));
+    hooks.closure = recording;
+    hooks.surface_create = _adg_snapshot_surface;
+
+    csi = cairo_script_interpreter_create();
+    cairo_script_interpreter_install_hooks(csi, &hooks);
+    cairo_script_interpreter_feed_string(csi, contents + sizeof(header),
+                                         header.script_size);
+    status = cairo_script_interpreter_finish(csi);
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = cairo_script_interpreter_destroy(csi);
+    else
+        cairo_script_interpreter_destroy(csi);
+
+    g_free(contents);
+
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = cairo_surface_status(recording);
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        cairo_surface_destroy(recording);
+        return NULL;
+    }
+
+    return recording;
+#else
+    g_return_val_if_fail(file != NULL, NULL);
+
+    g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                "snapshot support not enabled");
+    return NULL;
+#endif
+}
+
+static cairo_surface_t *
+_adg_export_surface(cairo_surface_type_t type, const gchar *file,
+                    cairo_write_func_t write_func, gpointer closure,
+                    gdouble width, gdouble height)
+{
+    cairo_surface_t *surface;
+
+    /* When write_func is specified, file is ignored */
+    switch (type) {
+#ifdef CAIRO_HAS_PNG_FUNCTIONS
+    case CAIRO_SURFACE_TYPE_IMAGE:
+        surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+        break;
+#endif
+#ifdef CAIRO_HAS_PDF_SURFACE
+    case CAIRO_SURFACE_TYPE_PDF:
+        surface = write_func != NULL ?
+            cairo_pdf_surface_create_for_stream(write_func, closure, width, height) :
+            cairo_pdf_surface_create(file, width, height);
+        break;
+#endif
+#ifdef CAIRO_HAS_PS_SURFACE
+    case CAIRO_SURFACE_TYPE_PS:
+        surface = write_func != NULL ?
+            cairo_ps_surface_create_for_stream(write_func, closure, width, height) :
+            cairo_ps_surface_create(file, width, height);
+        break;
+#endif
+#ifdef CAIRO_HAS_SVG_SURFACE
+    case CAIRO_SURFACE_TYPE_SVG:
+        surface = write_func != NULL ?
+            cairo_svg_surface_create_for_stream(write_func, closure, width, height) :
+            cairo_svg_surface_create(file, width, height);
+        break;
+#endif
+    default:
+        surface = NULL;
+        break;
+    }
+
+    return surface;
+}
+
+static gboolean
+_adg_render_to_buffer(AdgCanvas *canvas, guchar *buffer,
+                      cairo_format_t format, gint width, gint height,
+                      gint stride, gboolean preview, GError **gerror)
+{
+    gdouble top, left, page_width, page_height, factor;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    cairo_status_t status;
+
+    if (format != CAIRO_FORMAT_ARGB32 && format != CAIRO_FORMAT_RGB24 &&
+        format != CAIRO_FORMAT_A8) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
+                    "unsupported pixel format '%d'",
+                    format);
+        return FALSE;
+    }
+
+    if (stride < cairo_format_stride_for_width(format, width)) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
+                    "stride %d too small for a width of %d pixels",
+                    stride, width);
+        return FALSE;
+    }
+
+    adg_entity_arrange((AdgEntity *) canvas);
+    _adg_export_page_size(canvas, 1, &page_width, &page_height, &left, &top);
+
+    surface = cairo_image_surface_create_for_data(buffer, format,
+                                                  width, height, stride);
+    cr = cairo_create(surface);
+    cairo_surface_destroy(surface);
+    adg_switch_preview(cr, preview);
+
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    if (page_width > 0 && page_height > 0) {
+        factor = MIN(width / page_width, height / page_height);
+        cairo_translate(cr, (width - factor * page_width) / 2,
+                        (height - factor * page_height) / 2);
+        cairo_scale(cr, factor, factor);
+        cairo_translate(cr, left, top);
+        adg_entity_render((AdgEntity *) canvas, cr);
+    }
+
+    surface = cairo_get_target(cr);
+    cairo_surface_flush(surface);
+    status = cairo_status(cr);
+    cairo_destroy(cr);
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Computes the size of the page needed to export @canvas with
+ * @factor, margins included, and the offset of the drawing */
+static void
+_adg_export_page_size(AdgCanvas *canvas, gdouble factor,
+                      gdouble *width, gdouble *height,
+                      gdouble *left, gdouble *top)
+{
+    const CpmlExtents *extents;
+
+    extents = _adg_entity_get_extents((AdgEntity *) canvas);
+
+    *top    = factor * adg_canvas_get_top_margin(canvas);
+    *left   = factor * adg_canvas_get_left_margin(canvas);
+    *width  = factor * (extents->size.x + adg_canvas_get_right_margin(canvas)) + *left;
+    *height = factor * (extents->size.y + adg_canvas_get_bottom_margin(canvas)) + *top;
+}
+
+static gboolean
+_adg_export(AdgCanvas *canvas, cairo_surface_type_t type, const gchar *file,
+            cairo_write_func_t write_func, gpointer closure,
+            gdouble factor, cairo_surface_t *recording, GError **gerror)
+{
+    gdouble top, left, width, height;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    cairo_status_t status;
+    ADG_TRACE_START(span);
+
+    _adg_export_page_size(canvas, factor, &width, &height, &left, &top);
+
+    surface = _adg_export_surface(type, file, write_func, closure,
+                                  width, height);
+
+    if (surface == NULL) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
+                    "unable to handle surface type '%d'",
+                    type);
+        return FALSE;
+    }
+
+    cairo_surface_set_device_offset(surface, left, top);
+    cairo_surface_set_device_scale(surface, factor, factor);
+    cr = cairo_create(surface);
+    cairo_surface_destroy(surface);
+
+    if (recording != NULL) {
+        /* Replay the previously recorded drawing */
+        cairo_set_source_surface(cr, recording, 0, 0);
+        cairo_paint(cr);
+    } else {
+        adg_entity_render((AdgEntity *) canvas, cr);
+    }
+
+    if (cairo_surface_get_type(surface) == CAIRO_SURFACE_TYPE_IMAGE) {
+        status = write_func != NULL ?
+            cairo_surface_write_to_png_stream(surface, write_func, closure) :
+            cairo_surface_write_to_png(surface, file);
+    } else {
+        cairo_show_page(cr);
+        status = cairo_status(cr);
+    }
+
+    cairo_destroy(cr);
+
+    ADG_TRACE_STOP(span, "export", file != NULL ? file : "stream");
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static guint32
+_adg_png_crc(guint32 crc, const guchar *data, gsize length)
+{
+    static gsize table_ready = 0;
+    static guint32 table[256];
+    guint32 c;
+    gsize n, k;
+
+    if (g_once_init_enter(&table_ready)) {
+        for (n = 0; n < 256; ++n) {
+            c = n;
+            for (k = 0; k < 8; ++k)
+                c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        g_once_init_leave(&table_ready, 1);
+    }
+
+    for (n = 0; n < length; ++n)
+        crc = table[(crc ^ data[n]) & 0xff] ^ (crc >> 8);
+
+    return crc;
+}
+
+static void
+_adg_png_put32(guchar *dst, guint32 value)
+{
+    dst[0] = value >> 24;
+    dst[1] = value >> 16;
+    dst[2] = value >> 8;
+    dst[3] = value;
+}
+
+static void
+_adg_png_write(AdgPngWriter *writer, const guchar *data, guint length)
+{
+    if (writer->status == CAIRO_STATUS_SUCCESS)
+        writer->status = writer->write_func(writer->closure, data, length);
+}
+
+static void
+_adg_png_chunk(AdgPngWriter *writer, const gchar *type,
+               const guchar *data, guint length)
+{
+    guchar header[8], trailer[4];
+    guint32 crc;
+
+    _adg_png_put32(header, length);
+    memcpy(header + 4, type, 4);
+
+    crc = _adg_png_crc(0xffffffff, header + 4, 4);
+    crc = _adg_png_crc(crc, data, length);
+    _adg_png_put32(trailer, crc ^ 0xffffffff);
+
+    _adg_png_write(writer, header, 8);
+    if (length > 0)
+        _adg_png_write(writer, data, length);
+    _adg_png_write(writer, trailer, 4);
+}
+
+static void
+_adg_png_flush(AdgPngWriter *writer)
+{
+    if (writer->chunk_len > 0)
+        _adg_png_chunk(writer, "IDAT", writer->chunk, writer->chunk_len);
+
+    writer->chunk_len = 0;
+}
+
+/* Appends the @n_bits least significant bits of @value to the
+ * deflate stream, the first bit being the least significant one */
+static void
+_adg_png_bits(AdgPngWriter *writer, guint32 value, guint n_bits)
+{
+    writer->bits |= value << writer->n_bits;
+    writer->n_bits += n_bits;
+
+    while (writer->n_bits >= 8) {
+        writer->chunk[writer->chunk_len] = writer->bits & 0xff;
+        ++ writer->chunk_len;
+        writer->bits >>= 8;
+        writer->n_bits -= 8;
+    }
+
+    if (writer->chunk_len >= ADG_PNG_CHUNK)
+        _adg_png_flush(writer);
+}
+
+/* Huffman codes are stored starting from the most significant bit */
+static void
+_adg_png_code(AdgPngWriter *writer, guint32 code, guint n_bits)
+{
+    guint32 reversed;
+    guint n;
+
+    reversed = 0;
+    for (n = 0; n < n_bits; ++n) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+
+    _adg_png_bits(writer, reversed, n_bits);
+}
+
+/* Emits @symbol (a literal byte, the end of block marker or a length
+ * code) using the fixed Huffman table of RFC 1951, section 3.2.6 */
+static void
+_adg_png_symbol(AdgPngWriter *writer, guint symbol)
+{
+    if (symbol < 144)
+        _adg_png_code(writer, 0x30 + symbol, 8);
+    else if (symbol < 256)
+        _adg_png_code(writer, 0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        _adg_png_code(writer, symbol - 256, 7);
+    else
+        _adg_png_code(writer, 0xc0 + symbol - 280, 8);
+}
+
+/* Emits a back reference of @length bytes at distance 1, i.e. a run
+ * of the last byte: this is the only kind of match looked for, as it
+ * catches the uniform areas that make up most of a drawing */
+static void
+_adg_png_match(AdgPngWriter *writer, guint length)
+{
+    static const guint16 base[] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    static const guint8 extra[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    guint n;
+
+    n = G_N_ELEMENTS(base) - 1;
+    while (base[n] > length)
+        -- n;
+
+    _adg_png_symbol(writer, 257 + n);
+    _adg_png_bits(writer, length - base[n], extra[n]);
+
+    /* Distance code 0, i.e. distance 1, with no extra bits */
+    _adg_png_code(writer, 0, 5);
+}
+
+static void
+_adg_png_flush_run(AdgPngWriter *writer)
+{
+    if (writer->run >= 3) {
+        _adg_png_match(writer, writer->run);
+    } else {
+        for (; writer->run > 0; -- writer->run)
+            _adg_png_symbol(writer, writer->last);
+    }
+
+    writer->run = 0;
+}
+
+static void
+_adg_png_bytes(AdgPngWriter *writer, const guchar *data, guint length)
+{
+    guint n;
+
+    for (n = 0; n < length; ++n) {
+        writer->adler_a += data[n];
+        writer->adler_b += writer->adler_a;
+
+        /* Largest n such that the sums cannot overflow (see zlib) */
+        if (++ writer->adler_pending == 5552) {
+            writer->adler_a %= 65521;
+            writer->adler_b %= 65521;
+            writer->adler_pending = 0;
+        }
+
+        if (data[n] == writer->last) {
+            ++ writer->run;
+            if (writer->run == 258)
+                _adg_png_flush_run(writer);
+        } else {
+            _adg_png_flush_run(writer);
+            _adg_png_symbol(writer, data[n]);
+            writer->last = data[n];
+        }
+    }
+}
+
+static void
+_adg_png_begin(AdgPngWriter *writer, gint width, gint height)
+{
+    static const guchar signature[] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+    };
+    guchar ihdr[13];
+
+    _adg_png_write(writer, signature, sizeof(signature));
+
+    /* 8 bits per sample, truecolor, no interlacing */
+    _adg_png_put32(ihdr, width);
+    _adg_png_put32(ihdr + 4, height);
+    ihdr[8] = 8;
+    ihdr[9] = 2;
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    _adg_png_chunk(writer, "IHDR", ihdr, sizeof(ihdr));
+
+    /* zlib header (deflate, 32K window, fastest compression) followed
+     * by the header of a single final block with fixed Huffman codes */
+    writer->chunk[0] = 0x78;
+    writer->chunk[1] = 0x01;
+    writer->chunk_len = 2;
+    writer->bits = 0;
+    writer->n_bits = 0;
+    _adg_png_bits(writer, 1, 1);
+    _adg_png_bits(writer, 1, 2);
+
+    writer->last = -1;
+    writer->run = 0;
+    writer->adler_a = 1;
+    writer->adler_b = 0;
+    writer->adler_pending = 0;
+}
+
+static void
+_adg_png_end(AdgPngWriter *writer)
+{
+    _adg_png_flush_run(writer);
+    _adg_png_symbol(writer, 256);
+
+    /* Pad to a byte boundary */
+    if (writer->n_bits > 0)
+        _adg_png_bits(writer, 0, 8 - writer->n_bits);
+
+    writer->adler_a %= 65521;
+    writer->adler_b %= 65521;
+    _adg_png_put32(writer->chunk + writer->chunk_len,
+                   (writer->adler_b << 16) | writer->adler_a);
+    writer->chunk_len += 4;
+    _adg_png_flush(writer);
+
+    _adg_png_chunk(writer, "IEND", NULL, 0);
+}
+
+/* Returns a new reference to the clone of @src, creating it if needed.
+ * Objects that are not cloned (styles, models of unknown types...) are
+ * returned as new references to themselves */
+static GObject *
+_adg_clone_object(GObject *src, GHashTable *clones)
+{
+    GObject *dst;
+
+    dst = g_hash_table_lookup(clones, src);
+    if (dst != NULL)
+        return g_object_ref(dst);
+
+    if (ADG_IS_PATH(src))
+        dst = (GObject *) adg_path_dup((AdgPath *) src);
+    else if (ADG_IS_ENTITY(src) || ADG_IS_EDGES(src))
+        dst = _adg_clone_properties(src, clones);
+    else
+        return g_object_ref(src);
+
+    g_hash_table_insert(clones, src, dst);
+
+    if (ADG_IS_ENTITY(src))
+        _adg_clone_entity((AdgEntity *) src, (AdgEntity *) dst, clones);
+
+    return dst;
+}
+
+/* Same as adg_object_clone(), but the objects referenced by the
+ * properties are cloned too and the points are rebound to them */
+static GObject *
+_adg_clone_properties(GObject *src, GHashTable *clones)
+{
+    GObject *dst;
+    GParameter *params;
+    GParamSpec **specs;
+    GValue *value;
+    GObject *object;
+    AdgPoint *point;
+    AdgModel *model;
+    guint n, n_specs, n_params;
+
+    specs = g_object_class_list_properties(G_OBJECT_GET_CLASS(src), &n_specs);
+    params = g_new0(GParameter, n_specs);
+    n_params = 0;
+
+    for (n = 0; n < n_specs; ++n) {
+        /* The parent is set when the clone is added to its container */
+        if ((specs[n]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+            (ADG_IS_ENTITY(src) && strcmp(specs[n]->name, "parent") == 0))
+            continue;
+
+        params[n_params].name = g_intern_string(specs[n]->name);
+        value = &params[n_params].value;
+        g_value_init(value, specs[n]->value_type);
+        g_object_get_property(src, specs[n]->name, value);
+
+        if (G_VALUE_HOLDS_OBJECT(value) && g_value_get_object(value) != NULL) {
+            object = _adg_clone_object(g_value_get_object(value), clones);
+            g_value_take_object(value, object);
+        } else if (G_VALUE_HOLDS(value, ADG_TYPE_POINT) &&
+                   g_value_get_boxed(value) != NULL) {
+            point = g_value_get_boxed(value);
+            model = adg_point_get_model(point);
+            if (model != NULL) {
+                point = adg_point_dup(point);
+                model = (AdgModel *) _adg_clone_object((GObject *) model, clones);
+                adg_point_set_pair_from_model(point, model,
+                                              adg_point_get_name(point));
+                g_object_unref(model);
+                g_value_take_boxed(value, point);
+            }
+        }
+
+        ++ n_params;
+    }
+
+    dst = g_object_newv(G_TYPE_FROM_INSTANCE(src), n_params, params);
+
+    for (n = 0; n < n_params; ++n)
+        g_value_unset(&params[n].value);
+
+    g_free(specs);
+    g_free(params);
+
+    return dst;
+}
+
+static void
+_adg_clone_entity(AdgEntity *src, AdgEntity *dst, GHashTable *clones)
+{
+    AdgEntityPrivate *data;
+    GSList *children, *child;
+    guint n;
+
+    data = src->data;
+    for (n = 0; n < data->n_styles; ++n)
+        adg_entity_set_style(dst, data->styles[n].dress, data->styles[n].style);
+
+    if (! ADG_IS_CONTAINER(src))
+        return;
+
+    /* adg_container_children() returns the newest child first */
+    children = g_slist_reverse(adg_container_children((AdgContainer *) src));
+    for (child = children; child != NULL; child = child->next)
+        adg_container_add((AdgContainer *) dst,
+                          (AdgEntity *) _adg_clone_object(child->data, clones));
+    g_slist_free(children);
+}
+
+static void
+_adg_dxf_flush(AdgDxfWriter *writer)
+{
+    if (writer->status == CAIRO_STATUS_SUCCESS && writer->buffer->len > 0)
+        writer->status = writer->write_func(writer->closure,
+                                            (const guchar *) writer->buffer->str,
+                                            writer->buffer->len);
+
+    g_string_truncate(writer->buffer, 0);
+}
+
+static void
+_adg_dxf_group(AdgDxfWriter *writer, gint code, const gchar *value)
+{
+    g_string_append_printf(writer->buffer, "%3d\n%s\n", code, value);
+}
+
+static void
+_adg_dxf_real(AdgDxfWriter *writer, gint code, gdouble value)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* DXF always uses the dot as decimal separator */
+    _adg_dxf_group(writer, code,
+                   g_ascii_formatd(buffer, sizeof(buffer), "%.6f", value));
+}
+
+static void
+_adg_dxf_point(AdgDxfWriter *writer, gint code, const CpmlPair *pair)
+{
+    _adg_dxf_real(writer, code, pair->x);
+    _adg_dxf_real(writer, code + 10, pair->y);
+    _adg_dxf_real(writer, code + 20, 0);
+}
+
+/* DXF release 12 accepts only letters, digits, '-', '_' and '$'
+ * in layer names: anything else is replaced by an underscore */
+static gchar *
+_adg_dxf_layer(AdgDress dress)
+{
+    const gchar *name;
+    gchar *layer, *p;
+
+    name = adg_dress_get_name(dress);
+    if (name == NULL || *name == '\0')
+        return g_strdup("0");
+
+    layer = g_ascii_strup(name, -1);
+    for (p = layer; *p != '\0'; ++p) {
+        if (! g_ascii_isalnum(*p) && *p != '-' && *p != '_' && *p != '$')
+            *p = '_';
+    }
+
+    return layer;
+}
+
+static AdgDress
+_adg_dxf_dress(AdgEntity *entity)
+{
+    if (ADG_IS_HATCH(entity))
+        return adg_hatch_get_fill_dress((AdgHatch *) entity);
+    else if (ADG_IS_STROKE(entity))
+        return adg_stroke_get_line_dress((AdgStroke *) entity);
+    else if (ADG_IS_TEXTUAL(entity))
+        return adg_textual_get_font_dress((AdgTextual *) entity);
+
+    return ADG_DRESS_UNDEFINED;
+}
+
+static void
+_adg_dxf_collect(AdgEntity *entity, GHashTable *layers)
+{
+    AdgDress dress;
+    gchar *layer;
+
+    if (ADG_IS_CONTAINER(entity)) {
+        adg_container_foreach((AdgContainer *) entity,
+                              G_CALLBACK(_adg_dxf_collect), layers);
+        return;
+    }
+
+    dress = _adg_dxf_dress(entity);
+    if (dress == ADG_DRESS_UNDEFINED)
+        return;
+
+    layer = _adg_dxf_layer(dress);
+    if (g_hash_table_lookup_extended(layers, layer, NULL, NULL))
+        g_free(layer);
+    else
+        g_hash_table_insert(layers, layer, NULL);
+}
+
+static void
+_adg_dxf_walk(AdgEntity *entity, AdgDxfWriter *writer)
+{
+    if (writer->status != CAIRO_STATUS_SUCCESS ||
+        ! adg_entity_is_visible(entity))
+        return;
+
+    if (ADG_IS_CONTAINER(entity)) {
+        adg_container_foreach((AdgContainer *) entity,
+                              G_CALLBACK(_adg_dxf_walk), writer);
+    } else if (ADG_IS_STROKE(entity)) {
+        _adg_dxf_stroke((AdgStroke *) entity, writer);
+        _adg_dxf_flush(writer);
+    } else if (ADG_IS_TEXTUAL(entity)) {
+        _adg_dxf_text((AdgTextual *) entity, writer);
+        _adg_dxf_flush(writer);
+    }
+}
+
+static void
+_adg_dxf_stroke(AdgStroke *stroke, AdgDxfWriter *writer)
+{
+    AdgEntity *entity;
+    AdgTrail *trail;
+    cairo_matrix_t matrix, flip;
+    gboolean is_conformal;
+    gchar *layer;
+    CpmlSegment segment;
+    CpmlPrimitive primitive, arc;
+    cairo_path_data_t arc_data[4];
+    CpmlPair from, to, center;
+    gdouble r, start, end;
+    guint n, n_segments;
+    gint n_point;
+
+    entity = (AdgEntity *) stroke;
+    trail = adg_stroke_get_trail(stroke);
+    if (trail == NULL)
+        return;
+
+    /* From trail space to DXF space, where the y axis points upward */
+    adg_matrix_copy(&matrix, adg_entity_get_combined_matrix(entity));
+    cairo_matrix_init_scale(&flip, 1, -1);
+    cairo_matrix_multiply(&matrix, &matrix, &flip);
+
+    /* Arcs are preserved only if they remain circular */
+    is_conformal =
+        (fabs(matrix.xx - matrix.yy) < 1e-9 && fabs(matrix.xy + matrix.yx) < 1e-9) ||
+        (fabs(matrix.xx + matrix.yy) < 1e-9 && fabs(matrix.xy - matrix.yx) < 1e-9);
+
+    layer = _adg_dxf_layer(_adg_dxf_dress(entity));
+    n_segments = adg_trail_n_segments(trail);
+
+    for (n = 1; n <= n_segments; ++n) {
+        if (! adg_trail_put_segment(trail, n, &segment))
+            continue;
+
+        cpml_primitive_from_segment(&primitive, &segment);
+
+        do {
+            switch ((int) cpml_primitive_type(&primitive)) {
+
+            case CPML_LINE:
+            case CPML_CLOSE:
+                cpml_primitive_put_point(&primitive, 0, &from);
+                cpml_primitive_put_point(&primitive, -1, &to);
+                cairo_matrix_transform_point(&matrix, &from.x, &from.y);
+                cairo_matrix_transform_point(&matrix, &to.x, &to.y);
+                _adg_dxf_group(writer, 0, "LINE");
+                _adg_dxf_group(writer, 8, layer);
+                _adg_dxf_point(writer, 10, &from);
+                _adg_dxf_point(writer, 11, &to);
+                break;
+
+            case CPML_ARC:
+                if (! is_conformal) {
+                    _adg_dxf_polyline(writer, layer, &primitive, &matrix);
+                    break;
+                }
+
+                /* Transform the three points defining the arc and
+                 * compute the arc parameters directly in DXF space */
+                for (n_point = 0; n_point < 3; ++n_point) {
+                    cpml_primitive_put_point(&primitive, n_point, &to);
+                    cairo_matrix_transform_point(&matrix, &to.x, &to.y);
+                    cpml_pair_to_cairo(&to, &arc_data[n_point == 0 ? 0 : n_point + 1]);
+                }
+                arc_data[1].header.type = CPML_ARC;
+                arc_data[1].header.length = 3;
+                arc.segment = NULL;
+                arc.org = &arc_data[0];
+                arc.data = &arc_data[1];
+
+                if (! cpml_arc_info(&arc, &center, &r, &start, &end))
+                    break;
+
+                /* DXF arcs are always counterclockwise */
+                if (end < start) {
+                    gdouble tmp = start;
+                    start = end;
+                    end = tmp;
+                }
+
+                _adg_dxf_group(writer, 0, "ARC");
+                _adg_dxf_group(writer, 8, layer);
+                _adg_dxf_point(writer, 10, &center);
+                _adg_dxf_real(writer, 40, r);
+                _adg_dxf_real(writer, 50, start * 180 / G_PI);
+                _adg_dxf_real(writer, 51, end * 180 / G_PI);
+                break;
+
+            case CPML_CURVE:
+                _adg_dxf_polyline(writer, layer, &primitive, &matrix);
+                break;
+            }
+        } while (cpml_primitive_next(&primitive));
+    }
+
+    g_free(layer);
+}
+
+static void
+_adg_dxf_polyline(AdgDxfWriter *writer, const gchar *layer,
+                  const CpmlPrimitive *primitive, const cairo_matrix_t *matrix)
+{
+    CpmlPair pair;
+    guint n;
+
+    _adg_dxf_group(writer, 0, "POLYLINE");
+    _adg_dxf_group(writer, 8, layer);
+    _adg_dxf_group(writer, 66, "1");
+
+    for (n = 0; n <= _ADG_DXF_CURVE_STEPS; ++n) {
+        cpml_primitive_put_pair_at(primitive,
+                                   (gdouble) n / _ADG_DXF_CURVE_STEPS, &pair);
+        cairo_matrix_transform_point(matrix, &pair.x, &pair.y);
+        _adg_dxf_group(writer, 0, "VERTEX");
+        _adg_dxf_group(writer, 8, layer);
+        _adg_dxf_point(writer, 10, &pair);
+    }
+
+    _adg_dxf_group(writer, 0, "SEQEND");
+    _adg_dxf_group(writer, 8, layer);
+}
+
+static void
+_adg_dxf_text(AdgTextual *textual, AdgDxfWriter *writer)
+{
+    const CpmlExtents *extents;
+    gchar *text, *layer;
+    CpmlPair org;
+
+    extents = _adg_entity_get_extents((AdgEntity *) textual);
+    text = adg_textual_dup_text(textual);
+
+    if (extents->is_defined && text != NULL && *text != '\0') {
+        layer = _adg_dxf_layer(adg_textual_get_font_dress(textual));
+        org.x = extents->org.x;
+        org.y = -(extents->org.y + extents->size.y);
+
+        _adg_dxf_group(writer, 0, "TEXT");
+        _adg_dxf_group(writer, 8, layer);
+        _adg_dxf_point(writer, 10, &org);
+        _adg_dxf_real(writer, 40, extents->size.y);
+        _adg_dxf_group(writer, 1, text);
+
+        g_free(layer);
+    }
+
+    g_free(text);
+}
+
+/* @instance is the transformation, in global space, applied by the
+ * instance arrays containing @entity or NULL if there are none */
+static void
+_adg_svg_walk(AdgEntity *entity, AdgSvgWriter *writer,
+              const cairo_matrix_t *instance)
+{
+    if (! adg_entity_is_visible(entity) ||
+        (writer->hidden_layers & (1u << adg_entity_get_layer(entity))))
+        return;
+
+    if (ADG_IS_INSTANCE_ARRAY(entity)) {
+        AdgInstanceArrayPrivate *data;
+        const cairo_matrix_t *transform;
+        cairo_matrix_t matrix;
+        GSList *children, *child;
+        guint n;
+
+        data = ((AdgInstanceArray *) entity)->data;
+        children = adg_container_children((AdgContainer *) entity);
+
+        for (n = 0; n < data->transforms->len; ++n) {
+            transform = &g_array_index(data->transforms, cairo_matrix_t, n);
+            if (instance != NULL)
+                cairo_matrix_multiply(&matrix, transform, instance);
+            else
+                adg_matrix_copy(&matrix, transform);
+
+            for (child = children; child != NULL; child = child->next)
+                if (child->data != NULL)
+                    _adg_svg_walk(child->data, writer, &matrix);
+        }
+
+        g_slist_free(children);
+    } else if (ADG_IS_CONTAINER(entity) &&
+               ADG_ENTITY_GET_CLASS(entity)->render == _ADG_OLD_ENTITY_CLASS->render) {
+        GSList *children = adg_container_children((AdgContainer *) entity);
+
+        while (children != NULL) {
+            if (children->data != NULL)
+                _adg_svg_walk(children->data, writer, instance);
+            children = g_slist_delete_link(children, children);
+        }
+    } else if (ADG_IS_STROKE(entity)) {
+        _adg_svg_stroke((AdgStroke *) entity, writer, instance);
+    } else if (ADG_ENTITY_GET_CLASS(entity)->render != NULL) {
+        _adg_svg_fallback(entity, writer, instance);
+    }
+}
+
+static void
+_adg_svg_stroke(AdgStroke *stroke, AdgSvgWriter *writer,
+                const cairo_matrix_t *instance)
+{
+    AdgEntity *entity;
+    AdgTrail *trail;
+    const cairo_path_t *cairo_path;
+    const cairo_path_data_t *item, *end;
+    AdgStyle *style;
+    AdgLineStyle *line_style;
+    AdgColorStyle *color_style;
+    const AdgDash *dash;
+    cairo_matrix_t matrix, global;
+    GString *buffer;
+    const gchar *path_id, *class_id;
+    gchar *key;
+    gdouble scale;
+    gboolean is_new;
+    gint n;
+
+    entity = (AdgEntity *) stroke;
+    trail = adg_stroke_get_trail(stroke);
+    cairo_path = trail != NULL ? adg_trail_get_cairo_path(trail) : NULL;
+    if (cairo_path == NULL || cairo_path->num_data <= 0)
+        return;
+
+    /* The path, in trail space, is the shared definition */
+    buffer = g_string_new(NULL);
+    end = cairo_path->data + cairo_path->num_data;
+    for (item = cairo_path->data; item < end; item += item->header.length) {
+        switch (item->header.type) {
+        case CAIRO_PATH_MOVE_TO:
+            g_string_append(buffer, "M");
+            break;
+        case CAIRO_PATH_LINE_TO:
+            g_string_append(buffer, "L");
+            break;
+        case CAIRO_PATH_CURVE_TO:
+            g_string_append(buffer, "C");
+            break;
+        case CAIRO_PATH_CLOSE_PATH:
+            g_string_append(buffer, "Z");
+            break;
+        }
+        for (n = 1; n < item->header.length; ++n) {
+            _adg_svg_number(buffer, item[n].point.x);
+            g_string_append_c(buffer, ' ');
+            _adg_svg_number(buffer, item[n].point.y);
+            g_string_append_c(buffer, ' ');
+        }
+    }
+
+    key = g_string_free(buffer, FALSE);
+    path_id = _adg_svg_share(writer->paths, key, 'p', &is_new);
+    if (is_new)
+        g_string_append_printf(writer->defs, "<path id=\"%s\" d=\"%s\"/>\n",
+                               path_id, key);
+
+    /* The line width is expressed in global space: with a
+     * non-scaling stroke it must be scaled up to page space */
+    adg_matrix_copy(&global, adg_entity_get_global_matrix(entity));
+    if (instance != NULL)
+        cairo_matrix_multiply(&global, &global, instance);
+    scale = sqrt(fabs(global.xx * global.yy - global.xy * global.yx)) *
+        writer->factor;
+
+    buffer = g_string_new("stroke-linecap:");
+    style = adg_entity_style(entity, adg_stroke_get_line_dress(stroke));
+    line_style = ADG_IS_LINE_STYLE(style) ? (AdgLineStyle *) style : NULL;
+    color_style = NULL;
+
+    if (line_style != NULL) {
+        style = adg_entity_style(entity,
+                                 adg_line_style_get_color_dress(line_style));
+        if (ADG_IS_COLOR_STYLE(style))
+            color_style = (AdgColorStyle *) style;
+
+        switch (adg_line_style_get_cap(line_style)) {
+        case CAIRO_LINE_CAP_ROUND:
+            g_string_append(buffer, "round");
+            break;
+        case CAIRO_LINE_CAP_SQUARE:
+            g_string_append(buffer, "square");
+            break;
+        default:
+            g_string_append(buffer, "butt");
+            break;
+        }
+        g_string_append(buffer, ";stroke-linejoin:");
+        switch (adg_line_style_get_join(line_style)) {
+        case CAIRO_LINE_JOIN_ROUND:
+            g_string_append(buffer, "round");
+            break;
+        case CAIRO_LINE_JOIN_BEVEL:
+            g_string_append(buffer, "bevel");
+            break;
+        default:
+            g_string_append(buffer, "miter");
+            break;
+        }
+        g_string_append(buffer, ";stroke-width:");
+        _adg_svg_number(buffer, adg_line_style_get_width(line_style) * scale);
+
+        dash = adg_line_style_get_dash(line_style);
+        if (dash != NULL && adg_dash_get_num_dashes(dash) > 0) {
+            const gdouble *dashes = adg_dash_get_dashes(dash);
+
+            g_string_append(buffer, ";stroke-dasharray:");
+            for (n = 0; n < adg_dash_get_num_dashes(dash); ++n) {
+                if (n > 0)
+                    g_string_append_c(buffer, ',');
+                _adg_svg_number(buffer, dashes[n] * scale);
+            }
+            g_string_append(buffer, ";stroke-dashoffset:");
+            _adg_svg_number(buffer, adg_dash_get_offset(dash) * scale);
+        }
+    } else {
+        g_string_append(buffer, "butt;stroke-width:1");
     }
 
-    cairo_restore(cr);
+    if (color_style != NULL) {
+        g_string_append_printf(buffer, ";stroke:rgb(%d,%d,%d);stroke-opacity:",
+                               (gint) (adg_color_style_get_red(color_style) * 255 + 0.5),
+                               (gint) (adg_color_style_get_green(color_style) * 255 + 0.5),
+                               (gint) (adg_color_style_get_blue(color_style) * 255 + 0.5));
+        _adg_svg_number(buffer, adg_color_style_get_alpha(color_style));
+    } else {
+        g_string_append(buffer, ";stroke:black");
+    }
+    g_string_append(buffer, ";fill:none;vector-effect:non-scaling-stroke");
+
+    key = g_string_free(buffer, FALSE);
+    class_id = _adg_svg_share(writer->classes, key, 'c', &is_new);
+    if (is_new)
+        g_string_append_printf(writer->style, ".%s{%s}\n", class_id, key);
+
+    adg_matrix_copy(&matrix, adg_entity_get_combined_matrix(entity));
+    if (instance != NULL)
+        cairo_matrix_multiply(&matrix, &matrix, instance);
+
+    g_string_append_printf(writer->body,
+                           "<use xlink:href=\"#%s\" class=\"%s\" transform=\"",
+                           path_id, class_id);
+    _adg_svg_matrix(writer->body, &matrix);
+    g_string_append(writer->body, "\"/>\n");
+}
 
-    if (data->title_block)
-        adg_entity_render((AdgEntity *) data->title_block, cr);
+static void
+_adg_svg_fallback(AdgEntity *entity, AdgSvgWriter *writer,
+                  const cairo_matrix_t *instance)
+{
+#ifdef CAIRO_HAS_SVG_SURFACE
+    const CpmlExtents *extents;
+    cairo_matrix_t matrix;
+    gchar *svg, *base64;
+    const gchar *image_id;
+    gboolean is_new;
 
-    if (_ADG_OLD_ENTITY_CLASS->render)
-        _ADG_OLD_ENTITY_CLASS->render(entity, cr);
+    extents = _adg_entity_get_extents(entity);
+    if (! extents->is_defined)
+        return;
+
+    /* The rendering is done relative to the extents origin,
+     * so the same shape at different positions is shared */
+    svg = _adg_stream_svg(entity, extents);
+    image_id = _adg_svg_share(writer->images, svg, 'i', &is_new);
+
+    if (is_new) {
+        base64 = g_base64_encode((const guchar *) svg, strlen(svg));
+        g_string_append_printf(writer->defs, "<image id=\"%s\" width=\"",
+                               image_id);
+        _adg_svg_number(writer->defs, MAX(ceil(extents->size.x), 1));
+        g_string_append(writer->defs, "\" height=\"");
+        _adg_svg_number(writer->defs, MAX(ceil(extents->size.y), 1));
+        g_string_append_printf(writer->defs,
+                               "\" xlink:href=\"data:image/svg+xml;base64,%s\"/>\n",
+                               base64);
+        g_free(base64);
+    }
+
+    cairo_matrix_init_translate(&matrix, extents->org.x, extents->org.y);
+    if (instance != NULL)
+        cairo_matrix_multiply(&matrix, &matrix, instance);
+
+    g_string_append_printf(writer->body, "<use xlink:href=\"#%s\" transform=\"",
+                           image_id);
+    _adg_svg_matrix(writer->body, &matrix);
+    g_string_append(writer->body, "\"/>\n");
+#endif
+}
+
+/* Looks up @key in @table, adding it with a new id if not found.
+ * @table takes ownership of @key: when *@is_new is set @key is still
+ * valid, being the one stored in @table, otherwise it is freed */
+static const gchar *
+_adg_svg_share(GHashTable *table, gchar *key, gchar prefix, gboolean *is_new)
+{
+    gchar *id;
+
+    id = g_hash_table_lookup(table, key);
+    *is_new = id == NULL;
+
+    if (id == NULL) {
+        id = g_strdup_printf("%c%u", prefix, g_hash_table_size(table) + 1);
+        g_hash_table_insert(table, key, id);
+    } else {
+        g_free(key);
+    }
+
+    return id;
 }
 
 static void
-_adg_apply_paddings(AdgCanvas *canvas, CpmlExtents *extents)
+_adg_svg_number(GString *buffer, gdouble value)
 {
-    AdgCanvasPrivate *data = canvas->data;
+    gchar number[G_ASCII_DTOSTR_BUF_SIZE];
 
-    extents->org.x -= data->left_padding;
-    extents->size.x += data->left_padding + data->right_padding;
-    extents->org.y -= data->top_padding;
-    extents->size.y += data->top_padding + data->bottom_padding;
+    /* SVG always uses the dot as decimal separator */
+    g_string_append(buffer, g_ascii_formatd(number, sizeof(number),
+                                            "%.6g", value));
 }
 
+static void
+_adg_svg_matrix(GString *buffer, const cairo_matrix_t *matrix)
+{
+    g_string_append(buffer, "matrix(");
+    _adg_svg_number(buffer, matrix->xx);
+    g_string_append_c(buffer, ' ');
+    _adg_svg_number(buffer, matrix->yx);
+    g_string_append_c(buffer, ' ');
+    _adg_svg_number(buffer, matrix->xy);
+    g_string_append_c(buffer, ' ');
+    _adg_svg_number(buffer, matrix->yy);
+    g_string_append_c(buffer, ' ');
+    _adg_svg_number(buffer, matrix->x0);
+    g_string_append_c(buffer, ' ');
+    _adg_svg_number(buffer, matrix->y0);
+    g_string_append_c(buffer, ')');
+}
 
-/**
- * adg_canvas_export:
- * @canvas: an #AdgCanvas
- * @type: (type gint): the export format
- * @file: the name of the resulting file
- * @gerror: (allow-none): return location for errors
- *
- * A helper function that provides a bare export functionality.
- * It basically exports the drawing in @canvas in the @file
- * in the @type format. Any error will be reported in @gerror,
- * if not <constant>NULL</constant>.
- *
- * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
- *
- * Since: 1.0
- **/
-gboolean
-adg_canvas_export(AdgCanvas *canvas, cairo_surface_type_t type,
-                  const gchar *file, GError **gerror)
+/* The ids are bound to the entities, so they are stable across
+ * the exports. 0 is never used, to be distinguishable from NULL */
+static guint
+_adg_stream_id(AdgEntity *entity)
 {
-    AdgEntity *entity;
-    const CpmlExtents *extents;
-    gdouble top, bottom, left, right, width, height, factor;
-    cairo_surface_t *surface;
-    cairo_t *cr;
-    cairo_status_t status;
+    static guint last_id = 0;
+    static GQuark quark = 0;
+    guint id;
 
-    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
-    g_return_val_if_fail(file != NULL, FALSE);
-    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+    if (G_UNLIKELY(quark == 0))
+        quark = g_quark_from_static_string("adg-stream-id");
 
-    entity = (AdgEntity *) canvas;
+    id = GPOINTER_TO_UINT(g_object_get_qdata((GObject *) entity, quark));
+    if (id == 0) {
+        id = ++last_id;
+        g_object_set_qdata((GObject *) entity, quark, GUINT_TO_POINTER(id));
+    }
 
-    adg_entity_arrange(entity);
-    extents = adg_entity_get_extents(entity);
+    return id;
+}
 
-    factor = adg_canvas_get_factor(canvas);
-    top    = factor * adg_canvas_get_top_margin(canvas);
-    bottom = factor * adg_canvas_get_bottom_margin(canvas);
-    left   = factor * adg_canvas_get_left_margin(canvas);
-    right  = factor * adg_canvas_get_right_margin(canvas);
-    width  = factor * extents->size.x + left + right;
-    height = factor * extents->size.y + top + bottom;
+static void
+_adg_stream_string(GString *buffer, const gchar *string)
+{
+    const gchar *p;
 
-    switch (type) {
-#ifdef CAIRO_HAS_PNG_FUNCTIONS
-    case CAIRO_SURFACE_TYPE_IMAGE:
-        surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
-        break;
-#endif
-#ifdef CAIRO_HAS_PDF_SURFACE
-    case CAIRO_SURFACE_TYPE_PDF:
-        surface = cairo_pdf_surface_create(file, width, height);
-        break;
-#endif
-#ifdef CAIRO_HAS_PS_SURFACE
-    case CAIRO_SURFACE_TYPE_PS:
-        surface = cairo_ps_surface_create(file, width, height);
-        break;
-#endif
-#ifdef CAIRO_HAS_SVG_SURFACE
-    case CAIRO_SURFACE_TYPE_SVG:
-        surface = cairo_svg_surface_create(file, width, height);
-        break;
-#endif
-    default:
-        surface = NULL;
-        break;
+    g_string_append_c(buffer, '"');
+
+    for (p = string; *p != '\0'; ++p) {
+        switch (*p) {
+        case '"':
+            g_string_append(buffer, "\\\"");
+            break;
+        case '\\':
+            g_string_append(buffer, "\\\\");
+            break;
+        case '\n':
+            g_string_append(buffer, "\\n");
+            break;
+        default:
+            if ((guchar) *p < 0x20)
+                g_string_append_printf(buffer, "\\u%04x", (guint) *p);
+            else
+                g_string_append_c(buffer, *p);
+            break;
+        }
     }
 
-    if (surface == NULL) {
-        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
-                    "unable to handle surface type '%d'",
-                    type);
-        return FALSE;
+    g_string_append_c(buffer, '"');
+}
+
+static void
+_adg_stream_extents(GString *buffer, const CpmlExtents *extents)
+{
+    gchar x[G_ASCII_DTOSTR_BUF_SIZE], y[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar width[G_ASCII_DTOSTR_BUF_SIZE], height[G_ASCII_DTOSTR_BUF_SIZE];
+
+    if (! extents->is_defined) {
+        g_string_append(buffer, "null");
+        return;
     }
 
-    cairo_surface_set_device_offset(surface, left, top);
-    cairo_surface_set_device_scale(surface, factor, factor);
+    /* JSON always uses the dot as decimal separator */
+    g_string_append_printf(buffer, "[%s,%s,%s,%s]",
+                           g_ascii_formatd(x, sizeof(x), "%.3f", extents->org.x),
+                           g_ascii_formatd(y, sizeof(y), "%.3f", extents->org.y),
+                           g_ascii_formatd(width, sizeof(width), "%.3f", extents->size.x),
+                           g_ascii_formatd(height, sizeof(height), "%.3f", extents->size.y));
+}
+
+#ifdef CAIRO_HAS_SVG_SURFACE
+
+static cairo_status_t
+_adg_stream_append(gpointer closure, const guchar *data, guint length)
+{
+    g_string_append_len((GString *) closure, (const gchar *) data, length);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/* Renders @entity alone on a SVG document as big as its extents */
+static gchar *
+_adg_stream_svg(AdgEntity *entity, const CpmlExtents *extents)
+{
+    GString *svg;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    svg = g_string_new(NULL);
+    surface = cairo_svg_surface_create_for_stream(_adg_stream_append, svg,
+                                                  MAX(ceil(extents->size.x), 1),
+                                                  MAX(ceil(extents->size.y), 1));
     cr = cairo_create(surface);
+    cairo_translate(cr, -extents->org.x, -extents->org.y);
+
+    /* Same as the render list replay: the entity is already arranged */
+    ADG_ENTITY_GET_CLASS(entity)->render(entity, cr);
+
+    cairo_destroy(cr);
+    cairo_surface_finish(surface);
     cairo_surface_destroy(surface);
 
-    adg_entity_render(ADG_ENTITY(canvas), cr);
+    return g_string_free(svg, FALSE);
+}
+
+#endif
 
-    if (cairo_surface_get_type(surface) == CAIRO_SURFACE_TYPE_IMAGE) {
-        status = cairo_surface_write_to_png(surface, file);
-    } else {
-        cairo_show_page(cr);
-        status = cairo_status(cr);
-    }
+/* Arranges the canvas of @job and computes its page size */
+static void
+_adg_sheet_prepare(AdgSheetJob *job)
+{
+    job->factor = adg_canvas_get_factor(job->canvas);
+    adg_entity_arrange((AdgEntity *) job->canvas);
+    _adg_export_page_size(job->canvas, job->factor, &job->width,
+                          &job->height, &job->left, &job->top);
+}
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+
+typedef struct {
+    GMutex      mutex;
+    GCond       cond;
+    guint       pending;
+} AdgSheetBatch;
+
+static void
+_adg_sheet_record(gpointer job_data, gpointer user_data)
+{
+    AdgSheetJob *job;
+    AdgSheetBatch *batch;
+    cairo_t *cr;
 
+    job = job_data;
+    batch = user_data;
+
+    _adg_sheet_prepare(job);
+    job->recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+    cr = cairo_create(job->recording);
+    adg_entity_render((AdgEntity *) job->canvas, cr);
     cairo_destroy(cr);
 
-    if (status != CAIRO_STATUS_SUCCESS) {
-        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
-                    "cairo reported '%s'",
-                    cairo_status_to_string(status));
-        return FALSE;
+    g_mutex_lock(&batch->mutex);
+    if (-- batch->pending == 0)
+        g_cond_signal(&batch->cond);
+    g_mutex_unlock(&batch->mutex);
+}
+
+static guint
+_adg_get_num_processors(void)
+{
+    return g_get_num_processors();
+}
+
+static void
+_adg_sheets_record(AdgSheetJob *jobs, guint n_jobs, guint n_threads)
+{
+    GThreadPool *pool;
+    AdgSheetBatch batch;
+    guint n;
+
+    g_mutex_init(&batch.mutex);
+    g_cond_init(&batch.cond);
+    batch.pending = n_jobs;
+
+    pool = g_thread_pool_new(_adg_sheet_record, &batch,
+                             MIN(n_threads, n_jobs), TRUE, NULL);
+
+    if (pool != NULL) {
+        g_mutex_lock(&batch.mutex);
+        for (n = 0; n < n_jobs; ++n)
+            g_thread_pool_push(pool, &jobs[n], NULL);
+
+        while (batch.pending > 0)
+            g_cond_wait(&batch.cond, &batch.mutex);
+        g_mutex_unlock(&batch.mutex);
+
+        g_thread_pool_free(pool, FALSE, TRUE);
     }
 
-    return TRUE;
+    g_cond_clear(&batch.cond);
+    g_mutex_clear(&batch.mutex);
+}
+
+#else
+
+static guint
+_adg_get_num_processors(void)
+{
+    return 1;
+}
+
+static void
+_adg_sheets_record(AdgSheetJob *jobs, guint n_jobs, guint n_threads)
+{
+    /* Parallel export not supported by this GLib version */
+}
+
+#endif
+
+#ifdef SNAPSHOT_ENABLED
+
+static cairo_status_t
+_adg_snapshot_write(gpointer closure, const guchar *data, guint length)
+{
+    g_byte_array_append((GByteArray *) closure, data, length);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_surface_t *
+_adg_snapshot_surface(gpointer closure, cairo_content_t content,
+                      gdouble width, gdouble height, glong uid)
+{
+    return cairo_surface_reference((cairo_surface_t *) closure);
 }
 
+#endif
+
 
 #if GTK3_ENABLED || GTK2_ENABLED
 #include <gtk/gtk.h>
@@ -1886,6 +5926,163 @@ adg_canvas_get_page_setup(AdgCanvas *canvas)
     return g_object_get_data((GObject *) canvas, "_adg_page_setup");
 }
 
+typedef struct {
+    AdgCanvas       *canvas;
+    cairo_surface_t *recording;
+    CpmlPair         org;
+    guint            n_columns;
+} AdgPrintJob;
+
+static void
+_adg_print_job_free(gpointer user_data)
+{
+    AdgPrintJob *job = user_data;
+
+    if (job->recording != NULL)
+        cairo_surface_destroy(job->recording);
+
+    g_object_unref(job->canvas);
+    g_free(job);
+}
+
+static void
+_adg_print_begin(GtkPrintOperation *operation, GtkPrintContext *context,
+                 AdgPrintJob *job)
+{
+    AdgEntity *entity;
+    cairo_matrix_t old_map;
+    CpmlExtents extents;
+    gdouble width, height, right, bottom;
+    guint n_rows;
+    cairo_t *cr;
+
+    entity = (AdgEntity *) job->canvas;
+    width = gtk_print_context_get_width(context);
+    height = gtk_print_context_get_height(context);
+
+    /* Arrange and render the drawing only once, without the global
+     * map used on screen: the pages just replay the recording */
+    adg_matrix_copy(&old_map, adg_entity_get_global_map(entity));
+    adg_entity_set_global_map(entity, adg_matrix_identity());
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, _adg_entity_get_extents(entity));
+
+    if (job->recording != NULL)
+        cairo_surface_destroy(job->recording);
+    job->recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+    cr = cairo_create(job->recording);
+    adg_entity_render(entity, cr);
+    cairo_destroy(cr);
+
+    adg_entity_set_global_map(entity, &old_map);
+
+    /* Tile the drawing on as many pages as needed: a drawing that
+     * fits the printable area is printed as is on a single page */
+    job->org.x = job->org.y = 0;
+    job->n_columns = n_rows = 1;
+
+    if (extents.is_defined && width > 0 && height > 0) {
+        right = extents.org.x + extents.size.x;
+        bottom = extents.org.y + extents.size.y;
+        job->org.x = MIN(extents.org.x, 0);
+        job->org.y = MIN(extents.org.y, 0);
+        job->n_columns = MAX(ceil((right - job->org.x) / width - 1e-6), 1);
+        n_rows = MAX(ceil((bottom - job->org.y) / height - 1e-6), 1);
+    }
+
+    gtk_print_operation_set_n_pages(operation, job->n_columns * n_rows);
+}
+
+static void
+_adg_print_draw(GtkPrintOperation *operation, GtkPrintContext *context,
+                gint page_nr, AdgPrintJob *job)
+{
+    cairo_t *cr;
+    gdouble width, height;
+
+    if (job->recording == NULL)
+        return;
+
+    cr = gtk_print_context_get_cairo_context(context);
+    width = gtk_print_context_get_width(context);
+    height = gtk_print_context_get_height(context);
+
+    cairo_save(cr);
+    cairo_rectangle(cr, 0, 0, width, height);
+    cairo_clip(cr);
+    cairo_set_source_surface(cr, job->recording,
+                             - job->org.x - (page_nr % job->n_columns) * width,
+                             - job->org.y - (page_nr / job->n_columns) * height);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+static void
+_adg_print_end(GtkPrintOperation *operation, GtkPrintContext *context,
+               AdgPrintJob *job)
+{
+    if (job->recording != NULL) {
+        cairo_surface_destroy(job->recording);
+        job->recording = NULL;
+    }
+}
+
+/**
+ * adg_canvas_print_operation_new:
+ * @canvas: an #AdgCanvas
+ *
+ * Creates a new #GtkPrintOperation ready to print @canvas. The
+ * default page setup is the one bound to @canvas (see
+ * adg_canvas_set_page_setup()), the unit is set to points and the
+ * operation is allowed to run asynchronously, so it can be run with
+ * gtk_print_operation_run() without blocking the user interface
+ * where the platform supports it.
+ *
+ * @canvas is arranged and rendered only once, when the printing
+ * begins, into a cairo recording surface: the pages just replay
+ * that recording, so the drawing is not arranged again per page.
+ * Drawings larger than the printable area are tiled on as many
+ * pages as needed, left to right and top to bottom.
+ *
+ * The operation keeps a reference to @canvas until destroyed.
+ *
+ * Returns: (transfer full): a newly created #GtkPrintOperation or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+GtkPrintOperation *
+adg_canvas_print_operation_new(AdgCanvas *canvas)
+{
+    GtkPrintOperation *operation;
+    GtkPageSetup *page_setup;
+    AdgPrintJob *job;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), NULL);
+
+    operation = gtk_print_operation_new();
+    page_setup = adg_canvas_get_page_setup(canvas);
+    job = g_new0(AdgPrintJob, 1);
+    job->canvas = g_object_ref(canvas);
+    g_object_set_data_full((GObject *) operation, "_adg_print_job",
+                           job, _adg_print_job_free);
+
+    if (page_setup != NULL)
+        gtk_print_operation_set_default_page_setup(operation, page_setup);
+
+    gtk_print_operation_set_use_full_page(operation, FALSE);
+    gtk_print_operation_set_unit(operation, GTK_UNIT_POINTS);
+    gtk_print_operation_set_allow_async(operation, TRUE);
+
+    g_signal_connect(operation, "begin-print",
+                     G_CALLBACK(_adg_print_begin), job);
+    g_signal_connect(operation, "draw-page",
+                     G_CALLBACK(_adg_print_draw), job);
+    g_signal_connect(operation, "end-print",
+                     G_CALLBACK(_adg_print_end), job);
+
+    return operation;
+}
+
 #else
 
 static void
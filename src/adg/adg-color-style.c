@@ -70,6 +70,8 @@ static void             _adg_set_property       (GObject        *object,
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gboolean         _adg_is_current_source  (AdgColorStyle  *color_style,
+                                                 cairo_t        *cr);
 
 
 static void
@@ -417,9 +419,33 @@ _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 {
     AdgColorStylePrivate *data = ((AdgColorStyle *) style)->data;
 
+    /* Setting the source allocates a new pattern: avoid it if the
+     * same color is already in use, as often happens when many
+     * entities share the same dress */
+    if (_adg_is_current_source((AdgColorStyle *) style, cr))
+        return;
+
     if (data->alpha == 1.)
         cairo_set_source_rgb(cr, data->red, data->green, data->blue);
     else
         cairo_set_source_rgba(cr, data->red, data->green, data->blue,
                               data->alpha);
 }
+
+static gboolean
+_adg_is_current_source(AdgColorStyle *color_style, cairo_t *cr)
+{
+    AdgColorStylePrivate *data = color_style->data;
+    cairo_pattern_t *source;
+    gdouble red, green, blue, alpha;
+
+    source = cairo_get_source(cr);
+
+    if (cairo_pattern_get_type(source) != CAIRO_PATTERN_TYPE_SOLID ||
+        cairo_pattern_get_rgba(source, &red, &green, &blue,
+                               &alpha) != CAIRO_STATUS_SUCCESS)
+        return FALSE;
+
+    return red == data->red && green == data->green &&
+           blue == data->blue && alpha == data->alpha;
+}
@@ -27,9 +27,28 @@ G_BEGIN_DECLS
 typedef struct _AdgContainerPrivate AdgContainerPrivate;
 
 struct _AdgContainerPrivate {
-    GSList      *children;
+    GPtrArray   *children;
+    GHashTable  *positions;
+    guint        n_holes;
+    gboolean     parallel_arrange;
+
+    /* Incremental extents: contributions is parallel to children */
+    CpmlExtents  extents;
+    GArray      *contributions;
+    GPtrArray   *dirty;
+    gboolean     is_stale;
+
+    /* Arrange order: links between children learned while arranging */
+    GArray      *links;
+    AdgEntity   *arranging;
+    gboolean     relinked;
 };
 
+
+void            _adg_container_mark_dirty       (AdgContainer    *container,
+                                                 AdgEntity       *child);
+GPtrArray *     _adg_container_arrange_order    (AdgContainer    *container);
+
 G_END_DECLS
 
 
@@ -32,6 +32,20 @@
  * when destroyed and it will be able to update its children when an entity
  * is destroyed.
  *
+ * When #AdgContainer:parallel-arrange is enabled, the children are
+ * arranged concurrently on a shared pool of worker threads. This is
+ * useful for big sheets with a lot of independent dimensions and texts,
+ * but it is only available when ADG is built against GLib 2.36 or later:
+ * on older versions the property is accepted but the children are
+ * always arranged sequentially.
+ *
+ * Some children change, while arranging, the models other siblings
+ * depend on (see adg_model_add_dependency()). The container keeps
+ * track of the siblings invalidated in this way and, from then on,
+ * arranges them after the children they depend on, so every child is
+ * arranged only once per update. A container with such dependencies
+ * is always arranged sequentially.
+ *
  * Since: 1.0
  **/
 
@@ -51,14 +65,17 @@
  * @add:      signal that adds a new entity to the container.
  * @remove:   signal that removes a specific entity from the container.
  *
- * #AdgContainer effectively stores a #GSList of children into its
- * private data and keeps a reference to every child it owns.
+ * #AdgContainer effectively stores an array of children into its
+ * private data and keeps a reference to every child it owns. Adding
+ * and removing a child are O(1) operations, so containers with
+ * thousands of children do not incur any quadratic behavior.
  *
  * Since: 1.0
  **/
 
 
 #include "adg-internal.h"
+#include "adg-entity-private.h"
 
 #include "adg-container.h"
 #include "adg-container-private.h"
@@ -72,7 +89,8 @@ G_DEFINE_TYPE(AdgContainer, adg_container, ADG_TYPE_ENTITY)
 
 enum {
     PROP_0,
-    PROP_CHILD
+    PROP_CHILD,
+    PROP_PARALLEL_ARRANGE
 };
 
 enum {
@@ -83,17 +101,26 @@ enum {
 
 
 static void             _adg_dispose            (GObject        *object);
+static void             _adg_finalize           (GObject        *object);
+static void             _adg_get_property       (GObject        *object,
+                                                 guint           prop_id,
+                                                 GValue         *value,
+                                                 GParamSpec     *pspec);
 static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
 static void             _adg_destroy            (AdgEntity      *entity);
-static void             _adg_global_changed     (AdgEntity      *entity);
-static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
-static void             _adg_add_extents        (AdgEntity      *entity,
-                                                 CpmlExtents    *extents);
+static void             _adg_arrange_children   (AdgContainer   *container);
+static void             _adg_get_contribution   (AdgEntity      *entity,
+                                                 CpmlExtents    *contribution);
+static gboolean         _adg_update_extents     (AdgContainer   *container);
+static void             _adg_rebuild_extents    (AdgContainer   *container);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
+static void             _adg_trim_caches        (AdgEntity      *entity,
+                                                 AdgTrimLevel    level);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
 static GSList *         _adg_children           (AdgContainer   *container);
@@ -101,11 +128,24 @@ static void             _adg_add                (AdgContainer   *container,
                                                  AdgEntity      *entity);
 static void             _adg_remove             (AdgContainer   *container,
                                                  AdgEntity      *entity);
+static gboolean         _adg_unlink             (AdgContainer   *container,
+                                                 AdgEntity      *entity);
 static void             _adg_remove_from_list   (gpointer        container,
                                                  GObject        *entity);
+static void             _adg_add_link           (AdgContainer   *container,
+                                                 AdgEntity      *before,
+                                                 AdgEntity      *after);
+static void             _adg_forget_links       (AdgContainer   *container,
+                                                 AdgEntity      *entity);
 
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
 
+/* @after depends on a model changed while arranging @before */
+typedef struct {
+    AdgEntity  *before;
+    AdgEntity  *after;
+} AdgArrangeLink;
+
 
 static void
 adg_container_class_init(AdgContainerClass *klass)
@@ -120,14 +160,16 @@ adg_container_class_init(AdgContainerClass *klass)
     g_type_class_add_private(klass, sizeof(AdgContainerPrivate));
 
     gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
+    gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
     entity_class->destroy = _adg_destroy;
-    entity_class->global_changed = _adg_global_changed;
-    entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
+    entity_class->trim_caches = _adg_trim_caches;
 
     klass->children = _adg_children;
     klass->add = _adg_add;
@@ -140,6 +182,13 @@ adg_container_class_init(AdgContainerClass *klass)
                                 G_PARAM_WRITABLE);
     g_object_class_install_property(gobject_class, PROP_CHILD, param);
 
+    param = g_param_spec_boolean("parallel-arrange",
+                                 P_("Parallel Arrange"),
+                                 P_("Whether the children should be arranged concurrently on different threads"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_PARALLEL_ARRANGE, param);
+
     /**
      * AdgContainer::add:
      * @container: an #AdgContainer
@@ -183,7 +232,17 @@ adg_container_init(AdgContainer *container)
                                                             ADG_TYPE_CONTAINER,
                                                             AdgContainerPrivate);
 
-    data->children = NULL;
+    data->children = g_ptr_array_new();
+    data->positions = g_hash_table_new(NULL, NULL);
+    data->n_holes = 0;
+    data->parallel_arrange = FALSE;
+    data->extents.is_defined = FALSE;
+    data->contributions = g_array_new(FALSE, TRUE, sizeof(CpmlExtents));
+    data->dirty = g_ptr_array_new();
+    data->is_stale = TRUE;
+    data->links = g_array_new(FALSE, FALSE, sizeof(AdgArrangeLink));
+    data->arranging = NULL;
+    data->relinked = FALSE;
 
     container->data = data;
 }
@@ -201,23 +260,59 @@ _adg_dispose(GObject *object)
      * a "remove" signal for every child and will drop all the
      * references from the children to this container (and, obviously,
      * from the container to the children). */
-    while (data->children != NULL)
-        adg_container_remove(container, (AdgEntity *) data->children->data);
+    while (data->children->len > 0)
+        adg_container_remove(container,
+                             g_ptr_array_index(data->children,
+                                               data->children->len - 1));
 
     if (_ADG_PARENT_OBJECT_CLASS->dispose)
         _ADG_PARENT_OBJECT_CLASS->dispose(object);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgContainerPrivate *data = ((AdgContainer *) object)->data;
+
+    g_ptr_array_free(data->children, TRUE);
+    g_hash_table_destroy(data->positions);
+    g_array_free(data->contributions, TRUE);
+    g_ptr_array_free(data->dirty, TRUE);
+    g_array_free(data->links, TRUE);
+
+    if (_ADG_PARENT_OBJECT_CLASS->finalize)
+        _ADG_PARENT_OBJECT_CLASS->finalize(object);
+}
+
+static void
+_adg_get_property(GObject *object,
+                  guint prop_id, GValue *value, GParamSpec *pspec)
+{
+    AdgContainerPrivate *data = ((AdgContainer *) object)->data;
+
+    switch (prop_id) {
+    case PROP_PARALLEL_ARRANGE:
+        g_value_set_boolean(value, data->parallel_arrange);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
 static void
 _adg_set_property(GObject *object,
                   guint prop_id, const GValue *value, GParamSpec *pspec)
 {
     AdgContainer *container = (AdgContainer *) object;
+    AdgContainerPrivate *data = container->data;
 
     switch (prop_id) {
     case PROP_CHILD:
         adg_container_add(container, g_value_get_object(value));
         break;
+    case PROP_PARALLEL_ARRANGE:
+        data->parallel_arrange = g_value_get_boolean(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -329,6 +424,52 @@ adg_container_children(AdgContainer *container)
     return klass->children(container);
 }
 
+/**
+ * adg_container_set_parallel_arrange:
+ * @container: an #AdgContainer
+ * @parallel_arrange: <constant>TRUE</constant> to arrange the children concurrently
+ *
+ * Sets the #AdgContainer:parallel-arrange property of @container.
+ * If enabled, the children of @container are arranged on a pool of
+ * worker threads and the extents are merged afterwards. Nested
+ * containers are arranged sequentially inside the worker that
+ * picked them up.
+ *
+ * The children must be independent from each other, that is they
+ * must not share models or styles that are modified while arranging.
+ *
+ * Since: 1.0
+ **/
+void
+adg_container_set_parallel_arrange(AdgContainer *container,
+                                   gboolean parallel_arrange)
+{
+    g_return_if_fail(ADG_IS_CONTAINER(container));
+    g_object_set(container, "parallel-arrange", parallel_arrange, NULL);
+}
+
+/**
+ * adg_container_get_parallel_arrange:
+ * @container: an #AdgContainer
+ *
+ * Checks if the children of @container are arranged concurrently.
+ * See adg_container_set_parallel_arrange() for details.
+ *
+ * Returns: <constant>TRUE</constant> if the parallel arrange is enabled, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_container_get_parallel_arrange(AdgContainer *container)
+{
+    AdgContainerPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_CONTAINER(container), FALSE);
+
+    data = container->data;
+    return data->parallel_arrange;
+}
+
 /**
  * adg_container_foreach:
  * @container: an #AdgContainer
@@ -463,69 +604,554 @@ adg_container_propagate_valist(AdgContainer *container,
 static void
 _adg_destroy(AdgEntity *entity)
 {
-    adg_container_propagate_by_name((AdgContainer *) entity, "destroy");
+    AdgContainer *container;
+    AdgContainerPrivate *data;
+    GPtrArray *children;
+    AdgEntity *child;
+    guint n;
+
+    container = (AdgContainer *) entity;
+    data = container->data;
+
+    /* The whole subtree is going away: the children are detached in
+     * bulk, so there is no need to update the children array, the
+     * positions and the extents of the ancestors for every child */
+    children = data->children;
+    data->children = g_ptr_array_new();
+    g_hash_table_remove_all(data->positions);
+    data->n_holes = 0;
+    g_array_set_size(data->links, 0);
+    g_array_set_size(data->contributions, 0);
+    g_ptr_array_set_size(data->dirty, 0);
+    data->is_stale = TRUE;
+
+    for (n = 0; n < children->len; ++n) {
+        child = g_ptr_array_index(children, n);
+        if (child == NULL)
+            continue;
+
+        g_object_weak_unref((GObject *) child, _adg_remove_from_list, container);
+        _adg_entity_teardown(child);
+    }
+
+    g_ptr_array_free(children, TRUE);
 
     if (_ADG_PARENT_ENTITY_CLASS->destroy)
         _ADG_PARENT_ENTITY_CLASS->destroy(entity);
 }
 
-static void
-_adg_global_changed(AdgEntity *entity)
+
+/**
+ * _adg_container_arrange_order:
+ * @container: an #AdgContainer
+ *
+ * Gets the children of @container in the order they should be
+ * arranged. This is the order of adg_container_children(), i.e. from
+ * the newest child to the oldest one, adjusted so that every child
+ * comes after the siblings it depends on. The dependencies are
+ * learned while arranging: whenever a child is invalidated through
+ * its models (see adg_model_add_dependency()) while arranging one of
+ * its siblings, it is moved after that sibling. Circular dependencies
+ * are broken by falling back to the default order.
+ *
+ * Returns: a new #GPtrArray of #AdgEntity, to be freed with g_ptr_array_free().
+ **/
+GPtrArray *
+_adg_container_arrange_order(AdgContainer *container)
 {
-    if (_ADG_PARENT_ENTITY_CLASS->global_changed)
-        _ADG_PARENT_ENTITY_CLASS->global_changed(entity);
+    AdgContainerPrivate *data;
+    GPtrArray *order;
+    AdgArrangeLink *link;
+    AdgEntity *child;
+    guint *indegree;
+    gboolean *emitted, progress;
+    guint n, m, position, n_children;
+
+    data = container->data;
+    n_children = data->children->len;
+    order = g_ptr_array_sized_new(n_children - data->n_holes);
+
+    if (data->links->len == 0) {
+        for (n = n_children; n-- > 0; ) {
+            child = g_ptr_array_index(data->children, n);
+            if (child != NULL)
+                g_ptr_array_add(order, child);
+        }
+        return order;
+    }
+
+    indegree = g_new0(guint, n_children);
+    emitted = g_new0(gboolean, n_children);
+
+    for (m = 0; m < data->links->len; ++m) {
+        link = &g_array_index(data->links, AdgArrangeLink, m);
+        position = GPOINTER_TO_UINT(g_hash_table_lookup(data->positions,
+                                                        link->after));
+        ++ indegree[position - 1];
+    }
 
-    adg_container_propagate_by_name((AdgContainer *) entity, "global-changed");
+    /* Kahn's algorithm, picking the ready children in the default order
+     * so the result does not change between two arranges */
+    while (order->len < n_children - data->n_holes) {
+        progress = FALSE;
+
+        for (n = n_children; n-- > 0; ) {
+            child = g_ptr_array_index(data->children, n);
+            if (child == NULL || emitted[n] || indegree[n] > 0)
+                continue;
+
+            emitted[n] = TRUE;
+            progress = TRUE;
+            g_ptr_array_add(order, child);
+
+            for (m = 0; m < data->links->len; ++m) {
+                link = &g_array_index(data->links, AdgArrangeLink, m);
+                if (link->before != child)
+                    continue;
+                position = GPOINTER_TO_UINT(g_hash_table_lookup(data->positions,
+                                                                link->after));
+                if (indegree[position - 1] > 0)
+                    -- indegree[position - 1];
+            }
+        }
+
+        /* Only a cycle can stop the progress: break it on the first
+         * child left, so it is arranged in its default order */
+        if (! progress) {
+            for (n = n_children; n-- > 0; ) {
+                if (g_ptr_array_index(data->children, n) != NULL && ! emitted[n]) {
+                    indegree[n] = 0;
+                    break;
+                }
+            }
+        }
+    }
+
+    g_free(emitted);
+    g_free(indegree);
+
+    return order;
 }
 
-static void
-_adg_local_changed(AdgEntity *entity)
+/**
+ * _adg_container_mark_dirty:
+ * @container: an #AdgContainer
+ * @child: a child of @container
+ *
+ * Notifies @container that the extents of @child must be checked
+ * again on the next arrange. Called by #AdgEntity whenever an
+ * arranged child is unarranged.
+ **/
+void
+_adg_container_mark_dirty(AdgContainer *container, AdgEntity *child)
 {
-    if (_ADG_PARENT_ENTITY_CLASS->local_changed)
-        _ADG_PARENT_ENTITY_CLASS->local_changed(entity);
+    AdgContainerPrivate *data = container->data;
+
+    /* A sibling unarranged while arranging another child depends on
+     * some model changed by the latter: remember to arrange it later */
+    if (data->arranging != NULL && data->arranging != child)
+        _adg_add_link(container, data->arranging, child);
+
+    if (data->is_stale)
+        return;
+
+    /* Too many changes: rebuilding from scratch is cheaper */
+    if (data->dirty->len >= data->children->len) {
+        g_ptr_array_set_size(data->dirty, 0);
+        data->is_stale = TRUE;
+        return;
+    }
 
-    adg_container_propagate_by_name((AdgContainer *) entity, "local-changed");
+    g_ptr_array_add(data->dirty, child);
 }
 
+
 static void
 _adg_invalidate(AdgEntity *entity)
 {
-    adg_container_propagate_by_name((AdgContainer *) entity, "invalidate");
+    AdgContainerPrivate *data = ((AdgContainer *) entity)->data;
+
+    adg_container_foreach((AdgContainer *) entity,
+                          G_CALLBACK(adg_entity_invalidate), NULL);
+
+    g_ptr_array_set_size(data->dirty, 0);
+    data->is_stale = TRUE;
 }
 
 static void
 _adg_arrange(AdgEntity *entity)
 {
-    AdgContainer *container = (AdgContainer *) entity;
-    CpmlExtents extents = { 0 };
+    AdgContainer *container;
+    AdgContainerPrivate *data;
+
+    container = (AdgContainer *) entity;
+    data = container->data;
+
+    _adg_arrange_children(container);
 
-    adg_container_propagate_by_name(container, "arrange", NULL);
-    adg_container_foreach(container, G_CALLBACK(_adg_add_extents), &extents);
-    adg_entity_set_extents(entity, &extents);
+    if (data->is_stale || ! _adg_update_extents(container))
+        _adg_rebuild_extents(container);
+
+    adg_entity_set_extents(entity, &data->extents);
 }
 
+#if GLIB_CHECK_VERSION(2, 36, 0)
+
+typedef struct {
+    GMutex      mutex;
+    GCond       cond;
+    guint       pending;
+} AdgArrangeBatch;
+
+typedef struct {
+    AdgEntity        *entity;
+    AdgArrangeBatch  *batch;
+} AdgArrangeJob;
+
+/* Set on the worker threads, so nested parallel containers
+ * are arranged sequentially instead of waiting on the pool */
+static GPrivate _adg_in_worker;
+
 static void
-_adg_add_extents(AdgEntity *entity, CpmlExtents *extents)
+_adg_arrange_job(gpointer job_data, gpointer user_data)
+{
+    AdgArrangeJob *job;
+    AdgArrangeBatch *batch;
+
+    job = job_data;
+    batch = job->batch;
+
+    g_private_set(&_adg_in_worker, GINT_TO_POINTER(1));
+    adg_entity_arrange(job->entity);
+
+    g_mutex_lock(&batch->mutex);
+    if (-- batch->pending == 0)
+        g_cond_signal(&batch->cond);
+    g_mutex_unlock(&batch->mutex);
+
+    g_free(job);
+}
+
+static GThreadPool *
+_adg_arrange_pool(void)
 {
-    if (! adg_entity_has_floating(entity)) {
-        cpml_extents_add(extents, adg_entity_get_extents(entity));
+    static GThreadPool *pool = NULL;
+    static gsize initialized = 0;
+
+    if (g_once_init_enter(&initialized)) {
+        pool = g_thread_pool_new(_adg_arrange_job, NULL,
+                                 g_get_num_processors(), FALSE, NULL);
+        g_once_init_leave(&initialized, 1);
     }
+
+    return pool;
+}
+
+static gboolean
+_adg_arrange_parallel(AdgContainer *container)
+{
+    AdgContainerPrivate *data;
+    GThreadPool *pool;
+    AdgArrangeBatch batch;
+    AdgArrangeJob *job;
+    AdgEntity *child;
+    guint n;
+
+    data = container->data;
+
+    /* Children depending on their siblings must be arranged in order */
+    if (! data->parallel_arrange || data->links->len > 0 ||
+        data->children->len - data->n_holes < 2 ||
+        g_private_get(&_adg_in_worker) != NULL)
+        return FALSE;
+
+    pool = _adg_arrange_pool();
+    if (pool == NULL)
+        return FALSE;
+
+    g_mutex_init(&batch.mutex);
+    g_cond_init(&batch.cond);
+    batch.pending = 0;
+
+    g_mutex_lock(&batch.mutex);
+    for (n = 0; n < data->children->len; ++n) {
+        child = g_ptr_array_index(data->children, n);
+        if (child == NULL)
+            continue;
+
+        job = g_new(AdgArrangeJob, 1);
+        job->entity = child;
+        job->batch = &batch;
+        ++ batch.pending;
+        g_thread_pool_push(pool, job, NULL);
+    }
+
+    while (batch.pending > 0)
+        g_cond_wait(&batch.cond, &batch.mutex);
+    g_mutex_unlock(&batch.mutex);
+
+    g_cond_clear(&batch.cond);
+    g_mutex_clear(&batch.mutex);
+
+    return TRUE;
+}
+
+#else
+
+static gboolean
+_adg_arrange_parallel(AdgContainer *container)
+{
+    /* Parallel arrange not supported by this GLib version */
+    return FALSE;
+}
+
+#endif
+
+static void
+_adg_arrange_children(AdgContainer *container)
+{
+    AdgContainerPrivate *data;
+    GPtrArray *order;
+    AdgEntity *child;
+    guint n;
+
+    if (_adg_arrange_parallel(container))
+        return;
+
+    data = container->data;
+    order = _adg_container_arrange_order(container);
+
+    /* The children removed while arranging must stay valid until
+     * the end of the walk */
+    g_ptr_array_foreach(order, (GFunc) g_object_ref, NULL);
+
+    data->relinked = FALSE;
+    for (n = 0; n < order->len; ++n) {
+        child = g_ptr_array_index(order, n);
+        data->arranging = child;
+        adg_entity_arrange(child);
+    }
+    data->arranging = NULL;
+
+    /* A new dependency has been found: the siblings invalidated after
+     * being arranged are arranged again now, while the next arrange
+     * will use the updated order and visit them only once */
+    if (data->relinked) {
+        for (n = 0; n < order->len; ++n)
+            adg_entity_arrange(g_ptr_array_index(order, n));
+    }
+
+    g_ptr_array_foreach(order, (GFunc) g_object_unref, NULL);
+    g_ptr_array_free(order, TRUE);
+}
+
+static void
+_adg_add_link(AdgContainer *container, AdgEntity *before, AdgEntity *after)
+{
+    AdgContainerPrivate *data;
+    AdgArrangeLink *link;
+    guint n;
+
+    data = container->data;
+
+    /* Only direct children can be linked */
+    if (g_hash_table_lookup(data->positions, after) == NULL)
+        return;
+
+    for (n = 0; n < data->links->len; ++n) {
+        link = &g_array_index(data->links, AdgArrangeLink, n);
+        if (link->before == before && link->after == after)
+            return;
+    }
+
+    g_array_set_size(data->links, data->links->len + 1);
+    link = &g_array_index(data->links, AdgArrangeLink, data->links->len - 1);
+    link->before = before;
+    link->after = after;
+    data->relinked = TRUE;
+}
+
+static void
+_adg_forget_links(AdgContainer *container, AdgEntity *entity)
+{
+    AdgContainerPrivate *data;
+    AdgArrangeLink *link;
+    guint n;
+
+    data = container->data;
+
+    n = 0;
+    while (n < data->links->len) {
+        link = &g_array_index(data->links, AdgArrangeLink, n);
+        if (link->before == entity || link->after == entity)
+            g_array_remove_index_fast(data->links, n);
+        else
+            ++ n;
+    }
+}
+
+static void
+_adg_get_contribution(AdgEntity *entity, CpmlExtents *contribution)
+{
+    if (adg_entity_has_floating(entity) || _adg_entity_is_collapsed(entity))
+        contribution->is_defined = FALSE;
+    else
+        cpml_extents_copy(contribution, _adg_entity_get_extents(entity));
+}
+
+static gboolean
+_adg_on_border(const CpmlExtents *extents, const CpmlExtents *src)
+{
+    return src->org.x <= extents->org.x ||
+           src->org.y <= extents->org.y ||
+           src->org.x + src->size.x >= extents->org.x + extents->size.x ||
+           src->org.y + src->size.y >= extents->org.y + extents->size.y;
+}
+
+/**
+ * _adg_update_extents:
+ * @container: an #AdgContainer
+ *
+ * Updates the cached union of the extents of the children by checking
+ * only the children marked as dirty since the last arrange. A child
+ * that grows is simply added to the union; a child that shrinks or
+ * moves away from one of the borders of the union requires a full
+ * rebuild.
+ *
+ * Returns: %TRUE on success, %FALSE if a rebuild is needed.
+ **/
+static gboolean
+_adg_update_extents(AdgContainer *container)
+{
+    AdgContainerPrivate *data;
+    CpmlExtents *old, new;
+    guint position, n;
+
+    data = container->data;
+
+    for (n = 0; n < data->dirty->len; ++n) {
+        position = GPOINTER_TO_UINT(g_hash_table_lookup(data->positions,
+                                                        g_ptr_array_index(data->dirty, n)));
+        /* Removed in the meantime */
+        if (position == 0)
+            continue;
+
+        old = &g_array_index(data->contributions, CpmlExtents, position - 1);
+        _adg_get_contribution(g_ptr_array_index(data->children, position - 1),
+                              &new);
+
+        if (cpml_extents_equal(old, &new))
+            continue;
+
+        if (old->is_defined && ! cpml_extents_is_inside(&new, old) &&
+            _adg_on_border(&data->extents, old))
+            return FALSE;
+
+        cpml_extents_add(&data->extents, &new);
+        *old = new;
+    }
+
+    g_ptr_array_set_size(data->dirty, 0);
+    return TRUE;
+}
+
+static void
+_adg_rebuild_extents(AdgContainer *container)
+{
+    AdgContainerPrivate *data;
+    CpmlExtents *contribution;
+    AdgEntity *child;
+    guint n;
+
+    data = container->data;
+    data->extents.is_defined = FALSE;
+
+    for (n = 0; n < data->children->len; ++n) {
+        child = g_ptr_array_index(data->children, n);
+        contribution = &g_array_index(data->contributions, CpmlExtents, n);
+
+        if (child == NULL) {
+            contribution->is_defined = FALSE;
+            continue;
+        }
+
+        _adg_get_contribution(child, contribution);
+        cpml_extents_add(&data->extents, contribution);
+    }
+
+    g_ptr_array_set_size(data->dirty, 0);
+    data->is_stale = FALSE;
 }
 
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
-    adg_container_propagate_by_name((AdgContainer *) entity, "render", cr);
+    adg_container_foreach((AdgContainer *) entity,
+                          G_CALLBACK(adg_entity_render), cr);
 }
 
 
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgContainerPrivate *data;
+    gsize usage;
+    AdgEntity *child;
+    guint n;
+
+    data = ((AdgContainer *) entity)->data;
+    usage = _ADG_PARENT_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgContainerPrivate);
+
+    /* The positions table has roughly three pointers per entry */
+    usage += data->children->len * sizeof(gpointer) * 4;
+
+    for (n = 0; n < data->children->len; ++n) {
+        child = g_ptr_array_index(data->children, n);
+        if (child != NULL)
+            usage += adg_entity_get_memory_usage(child);
+    }
+
+    return usage;
+}
+
+static void
+_adg_trim_caches(AdgEntity *entity, AdgTrimLevel level)
+{
+    AdgContainerPrivate *data;
+    AdgEntity *child;
+    guint n;
+
+    data = ((AdgContainer *) entity)->data;
+
+    for (n = 0; n < data->children->len; ++n) {
+        child = g_ptr_array_index(data->children, n);
+        if (child != NULL)
+            adg_entity_trim_caches(child, level);
+    }
+
+    _ADG_PARENT_ENTITY_CLASS->trim_caches(entity, level);
+}
+
 static GSList *
 _adg_children(AdgContainer *container)
 {
-    AdgContainerPrivate *data = container->data;
+    AdgContainerPrivate *data;
+    GSList *children;
+    gpointer child;
+    guint n;
+
+    data = container->data;
+    children = NULL;
 
-    /* The NULL case is already managed by GLib */
-    return g_slist_copy(data->children);
+    /* Prepending returns the children from the newest to the oldest */
+    for (n = 0; n < data->children->len; ++n) {
+        child = g_ptr_array_index(data->children, n);
+        if (child != NULL)
+            children = g_slist_prepend(children, child);
+    }
+
+    return children;
 }
 
 static void
@@ -546,30 +1172,89 @@ _adg_add(AdgContainer *container, AdgEntity *entity)
     }
 
     data = container->data;
-    data->children = g_slist_prepend(data->children, entity);
+    g_ptr_array_add(data->children, entity);
+    g_hash_table_insert(data->positions, entity,
+                        GUINT_TO_POINTER(data->children->len));
+    g_array_set_size(data->contributions, data->children->len);
 
     g_object_ref_sink(entity);
     adg_entity_set_parent(entity, (AdgEntity *) container);
     g_object_weak_ref((GObject *) entity, _adg_remove_from_list, container);
+
+    /* The new child could be already arranged */
+    _adg_container_mark_dirty(container, entity);
+}
+
+static gboolean
+_adg_unlink(AdgContainer *container, AdgEntity *entity)
+{
+    AdgContainerPrivate *data;
+    CpmlExtents *contribution;
+    guint position, n, len;
+    gpointer child;
+
+    data = container->data;
+
+    /* Positions are stored 1-based, so 0 (NULL) means not found */
+    position = GPOINTER_TO_UINT(g_hash_table_lookup(data->positions, entity));
+    if (position == 0)
+        return FALSE;
+
+    g_hash_table_remove(data->positions, entity);
+    _adg_forget_links(container, entity);
+
+    /* Dropping a child on the border of the union shrinks it */
+    contribution = &g_array_index(data->contributions, CpmlExtents, position - 1);
+    if (contribution->is_defined && _adg_on_border(&data->extents, contribution))
+        data->is_stale = TRUE;
+    contribution->is_defined = FALSE;
+
+    /* Leave a hole, to keep the order of the other children intact */
+    g_ptr_array_index(data->children, position - 1) = NULL;
+    ++ data->n_holes;
+
+    /* Trim the trailing holes */
+    len = data->children->len;
+    while (len > 0 && g_ptr_array_index(data->children, len - 1) == NULL) {
+        -- len;
+        -- data->n_holes;
+    }
+    g_ptr_array_set_size(data->children, len);
+    g_array_set_size(data->contributions, len);
+
+    /* Compact the array when the holes are more than the children:
+     * this keeps removal O(1) amortized */
+    if (data->n_holes > len / 2) {
+        len = 0;
+        for (n = 0; n < data->children->len; ++n) {
+            child = g_ptr_array_index(data->children, n);
+            if (child != NULL) {
+                g_ptr_array_index(data->children, len) = child;
+                g_array_index(data->contributions, CpmlExtents, len) =
+                    g_array_index(data->contributions, CpmlExtents, n);
+                ++ len;
+                g_hash_table_insert(data->positions, child,
+                                    GUINT_TO_POINTER(len));
+            }
+        }
+        g_ptr_array_set_size(data->children, len);
+        g_array_set_size(data->contributions, len);
+        data->n_holes = 0;
+    }
+
+    return TRUE;
 }
 
 static void
 _adg_remove_from_list(gpointer container, GObject *entity)
 {
-    AdgContainerPrivate *data = ((AdgContainer *) container)->data;
-    data->children = g_slist_remove(data->children, entity);
+    _adg_unlink((AdgContainer *) container, (AdgEntity *) entity);
 }
 
 static void
 _adg_remove(AdgContainer *container, AdgEntity *entity)
 {
-    AdgContainerPrivate *data;
-    GSList *node;
-
-    data = container->data;
-    node = g_slist_find(data->children, entity);
-
-    if (node == NULL) {
+    if (! _adg_unlink(container, entity)) {
         g_warning(_("Attempting to remove an entity with type %s from a "
                     "container of type %s, but the entity is not present"),
                   g_type_name(G_OBJECT_TYPE(entity)),
@@ -578,7 +1263,6 @@ _adg_remove(AdgContainer *container, AdgEntity *entity)
     }
 
     g_object_weak_unref((GObject *) entity, _adg_remove_from_list, container);
-    data->children = g_slist_delete_link(data->children, node);
     adg_entity_set_parent(entity, NULL);
     g_object_unref(entity);
 }
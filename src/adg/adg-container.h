@@ -71,6 +71,12 @@ void            adg_container_add               (AdgContainer    *container,
 void            adg_container_remove            (AdgContainer    *container,
                                                  AdgEntity       *entity);
 
+void            adg_container_set_parallel_arrange
+                                                (AdgContainer    *container,
+                                                 gboolean         parallel_arrange);
+gboolean        adg_container_get_parallel_arrange
+                                                (AdgContainer    *container);
+
 void            adg_container_foreach           (AdgContainer    *container,
                                                  GCallback        callback,
                                                  gpointer         user_data);
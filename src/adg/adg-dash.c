@@ -62,12 +62,14 @@
 GType
 adg_dash_get_type(void)
 {
-    static GType dash_type = 0;
+    static gsize dash_type = 0;
 
-    if (G_UNLIKELY(dash_type == 0))
-        dash_type = g_boxed_type_register_static("AdgDash",
-                                                 (GBoxedCopyFunc) adg_dash_dup,
-                                                 (GBoxedFreeFunc) adg_dash_destroy);
+    if (g_once_init_enter(&dash_type)) {
+        GType new_type = g_boxed_type_register_static("AdgDash",
+                                                      (GBoxedCopyFunc) adg_dash_dup,
+                                                      (GBoxedFreeFunc) adg_dash_destroy);
+        g_once_init_leave(&dash_type, new_type);
+    }
 
     return dash_type;
 }
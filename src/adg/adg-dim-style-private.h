@@ -25,14 +25,44 @@
 G_BEGIN_DECLS
 
 typedef struct _AdgMarkerData AdgMarkerData;
+typedef struct _AdgNumberOp AdgNumberOp;
 typedef struct _AdgDimStylePrivate AdgDimStylePrivate;
 
+typedef enum {
+    ADG_NUMBER_OP_LITERAL,
+    ADG_NUMBER_OP_VALUE,
+    ADG_NUMBER_OP_GROUP,
+    ADG_NUMBER_OP_END
+} AdgNumberOpType;
+
 struct _AdgMarkerData {
     GType                type;
     guint                n_parameters;
     GParameter          *parameters;
 };
 
+/* How a converted value is finalized: left as is, truncated
+ * or rounded to the requested decimals */
+typedef enum {
+    ADG_NUMBER_MODE_RAW,
+    ADG_NUMBER_MODE_TRUNCATED,
+    ADG_NUMBER_MODE_ROUNDED
+} AdgNumberMode;
+
+/* A step of the compiled number format: a literal chunk, a % directive
+ * with its argument or the beginning/end of a group. The argument of a
+ * directive is decoded at compile time in the number of sexagesimal
+ * extractions to perform (0 for the value, 1 for minutes and 2 for
+ * seconds) and in the finalization mode; stage is -1 for invalid
+ * arguments */
+struct _AdgNumberOp {
+    AdgNumberOpType      type;
+    gchar               *text;
+    gchar                argument;
+    gint                 stage;
+    AdgNumberMode        mode;
+};
+
 struct _AdgDimStylePrivate {
     AdgMarkerData        marker1;
     AdgMarkerData        marker2;
@@ -51,9 +81,14 @@ struct _AdgDimStylePrivate {
     CpmlPair             limits_shift;
     gchar               *number_format;
     gchar               *number_arguments;
+    GArray              *number_program;
     gchar               *number_tag;
     gint                 decimals;
     gint                 rounding;
+
+    /* 10^rounding and 10^decimals, refreshed with their properties */
+    gdouble              rounding_coefficient;
+    gdouble              decimals_coefficient;
 };
 
 G_END_DECLS
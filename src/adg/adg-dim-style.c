@@ -82,8 +82,18 @@
 #include <math.h>
 
 
+#define _ADG_OLD_STYLE_CLASS  ((AdgStyleClass *) adg_dim_style_parent_class)
+
 #define VALID_FORMATS "aieDdMmSs"
 
+#define OR_3S(a,b) ( \
+    ((a) == ADG_THREE_STATE_ON ||      (b) == ADG_THREE_STATE_ON)      ? ADG_THREE_STATE_ON : \
+    ((a) == ADG_THREE_STATE_UNKNOWN && (b) == ADG_THREE_STATE_UNKNOWN) ? ADG_THREE_STATE_UNKNOWN : \
+                                                                         ADG_THREE_STATE_OFF )
+
+
+G_LOCK_DEFINE_STATIC(_adg_number_program);
+
 
 G_DEFINE_TYPE(AdgDimStyle, adg_dim_style, ADG_TYPE_STYLE)
 
@@ -121,14 +131,50 @@ static void             _adg_set_property       (GObject        *object,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
 static AdgStyle *       _adg_clone              (AdgStyle       *style);
+static gboolean         _adg_equal              (AdgStyle       *style,
+                                                 AdgStyle       *other);
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
 static AdgMarker *      _adg_marker_new         (const AdgMarkerData
                                                                 *marker_data);
+static gboolean         _adg_reset_marker       (const AdgMarkerData
+                                                                *marker_data,
+                                                 AdgMarker      *marker);
 static void             _adg_set_marker         (AdgMarkerData  *marker_data,
                                                  AdgMarker      *marker);
 static void             _adg_free_marker        (AdgMarkerData  *marker_data);
+static gboolean         _adg_marker_equal       (const AdgMarkerData
+                                                                *marker_data,
+                                                 const AdgMarkerData
+                                                                *marker_data2);
+static GArray *         _adg_compile_format     (const gchar    *format,
+                                                 const gchar    *arguments);
+static gboolean         _adg_compile_level      (GArray         *program,
+                                                 const gchar   **format,
+                                                 const gchar   **argument);
+static void             _adg_compile_segment    (GArray         *program,
+                                                 const gchar    *segment,
+                                                 gsize           len,
+                                                 const gchar   **argument);
+static void             _adg_append_op          (GArray         *program,
+                                                 AdgNumberOpType type,
+                                                 gchar          *text,
+                                                 gchar           argument);
+static void             _adg_free_ops           (GArray         *program);
+static gboolean         _adg_decode_argument    (gchar           argument,
+                                                 gint           *stage,
+                                                 AdgNumberMode  *mode);
+static gdouble          _adg_convert            (AdgDimStylePrivate *data,
+                                                 gdouble         value,
+                                                 gint            stage,
+                                                 AdgNumberMode   mode);
+static void             _adg_update_coefficients(AdgDimStylePrivate *data);
+static void             _adg_free_program       (AdgDimStyle    *dim_style);
+static AdgThreeState    _adg_eval_level         (AdgDimStyle    *dim_style,
+                                                 guint          *n,
+                                                 gdouble         value,
+                                                 GString        *result);
 
 
 static void
@@ -148,6 +194,7 @@ adg_dim_style_class_init(AdgDimStyleClass *klass)
     gobject_class->set_property = _adg_set_property;
 
     style_class->clone = _adg_clone;
+    style_class->equal = _adg_equal;
     style_class->apply = _adg_apply;
 
     param = g_param_spec_object("marker1",
@@ -316,9 +363,11 @@ adg_dim_style_init(AdgDimStyle *dim_style)
     data->limits_shift.y = +2;
     data->number_format = g_strdup("%-.7g");
     data->number_arguments = g_strdup("d");
+    data->number_program = NULL;
     data->number_tag = g_strdup("<>");
     data->decimals = 2;
     data->rounding = 6;
+    _adg_update_coefficients(data);
 
     dim_style->data = data;
 }
@@ -337,6 +386,8 @@ _adg_finalize(GObject *object)
     g_free(data->number_arguments);
     data->number_arguments = NULL;
 
+    _adg_free_program((AdgDimStyle *) object);
+
     g_free(data->number_tag);
     data->number_tag = NULL;
 }
@@ -461,12 +512,14 @@ _adg_set_property(GObject *object, guint prop_id,
     case PROP_NUMBER_FORMAT:
         g_free(data->number_format);
         data->number_format = g_value_dup_string(value);
+        _adg_free_program((AdgDimStyle *) object);
         break;
     case PROP_NUMBER_ARGUMENTS: {
         const gchar *arguments = g_value_get_string(value);
         g_return_if_fail(arguments == NULL || strspn(arguments, VALID_FORMATS) == strlen(arguments));
         g_free(data->number_arguments);
         data->number_arguments = g_strdup(arguments);
+        _adg_free_program((AdgDimStyle *) object);
         break;
     }
     case PROP_NUMBER_TAG:
@@ -475,9 +528,11 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     case PROP_DECIMALS:
         data->decimals = g_value_get_int(value);
+        _adg_update_coefficients(data);
         break;
     case PROP_ROUNDING:
         data->rounding = g_value_get_int(value);
+        _adg_update_coefficients(data);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -550,6 +605,40 @@ adg_dim_style_marker1_new(AdgDimStyle *dim_style)
     return _adg_marker_new(&data->marker1);
 }
 
+/**
+ * adg_dim_style_reset_marker1:
+ * @dim_style: an #AdgDimStyle
+ * @marker: an #AdgMarker previously returned by adg_dim_style_marker1_new()
+ *
+ * Brings @marker back to the current #AdgDimStyle:marker1 template,
+ * so it can be reused instead of creating a new marker entity. Only
+ * the properties different from the template are changed. The
+ * properties binding @marker to its owner, that is #AdgEntity:parent,
+ * #AdgMarker:trail, #AdgMarker:n-segment and #AdgMarker:model, are
+ * left untouched.
+ *
+ * The reset fails if the template is not set, if it is of a different
+ * type or if a construct only property differs: in these cases @marker
+ * should be dropped and a new one created with
+ * adg_dim_style_marker1_new().
+ *
+ * Returns: <constant>TRUE</constant> if @marker has been reset, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_dim_style_reset_marker1(AdgDimStyle *dim_style, AdgMarker *marker)
+{
+    AdgDimStylePrivate *data;
+
+    g_return_val_if_fail(ADG_IS_DIM_STYLE(dim_style), FALSE);
+    g_return_val_if_fail(ADG_IS_MARKER(marker), FALSE);
+
+    data = dim_style->data;
+
+    return _adg_reset_marker(&data->marker1, marker);
+}
+
 /**
  * adg_dim_style_set_marker2:
  * @dim_style: an #AdgStyle
@@ -599,6 +688,40 @@ adg_dim_style_marker2_new(AdgDimStyle *dim_style)
     return _adg_marker_new(&data->marker2);
 }
 
+/**
+ * adg_dim_style_reset_marker2:
+ * @dim_style: an #AdgDimStyle
+ * @marker: an #AdgMarker previously returned by adg_dim_style_marker2_new()
+ *
+ * Brings @marker back to the current #AdgDimStyle:marker2 template,
+ * so it can be reused instead of creating a new marker entity. Only
+ * the properties different from the template are changed. The
+ * properties binding @marker to its owner, that is #AdgEntity:parent,
+ * #AdgMarker:trail, #AdgMarker:n-segment and #AdgMarker:model, are
+ * left untouched.
+ *
+ * The reset fails if the template is not set, if it is of a different
+ * type or if a construct only property differs: in these cases @marker
+ * should be dropped and a new one created with
+ * adg_dim_style_marker2_new().
+ *
+ * Returns: <constant>TRUE</constant> if @marker has been reset, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_dim_style_reset_marker2(AdgDimStyle *dim_style, AdgMarker *marker)
+{
+    AdgDimStylePrivate *data;
+
+    g_return_val_if_fail(ADG_IS_DIM_STYLE(dim_style), FALSE);
+    g_return_val_if_fail(ADG_IS_MARKER(marker), FALSE);
+
+    data = dim_style->data;
+
+    return _adg_reset_marker(&data->marker2, marker);
+}
+
 /**
  * adg_dim_style_set_color_dress:
  * @dim_style: an #AdgDimStyle object
@@ -1355,7 +1478,8 @@ adg_dim_style_get_rounding(AdgDimStyle *dim_style)
 gboolean
 adg_dim_style_convert(AdgDimStyle *dim_style, gdouble *value, gchar format)
 {
-    AdgDimStylePrivate *data;
+    gint stage;
+    AdgNumberMode mode;
 
     g_return_val_if_fail(ADG_IS_DIM_STYLE(dim_style), FALSE);
 
@@ -1364,62 +1488,72 @@ adg_dim_style_convert(AdgDimStyle *dim_style, gdouble *value, gchar format)
         return FALSE;
     }
 
-    data = dim_style->data;
-
-    /* Round the raw value, if requested */
-    if (data->rounding > -1) {
-        gdouble coefficient = pow(10, data->rounding);
-        *value = round(*value * coefficient) / coefficient;
+    if (! _adg_decode_argument(format, &stage, &mode)) {
+        g_return_val_if_reached(FALSE);
+        return FALSE;
     }
 
-    switch (format) {
-
-    case 'a':                           /* Raw value */
-        break;
+    *value = _adg_convert(dim_style->data, *value, stage, mode);
+    return TRUE;
+}
 
-    case 'i':                           /* Raw minutes */
-        *value = (*value - (gint) *value) * 60;
-        break;
+/**
+ * adg_dim_style_format_value:
+ * @dim_style: an #AdgDimStyle object
+ * @value: the value to format
+ *
+ * Formats @value according to the #AdgDimStyle:number-format and
+ * #AdgDimStyle:number-arguments properties of @dim_style. See
+ * adg_dim_style_set_number_format() for the syntax of the format.
+ *
+ * The number format is parsed only once, the first time it is used
+ * after a change, so formatting many values is cheap.
+ *
+ * Returns: (transfer full): the formatted text, to be freed with g_free(), or %NULL on errors.
+ *
+ * Since: 1.0
+ **/
+gchar *
+adg_dim_style_format_value(AdgDimStyle *dim_style, gdouble value)
+{
+    AdgDimStylePrivate *data;
+    GString *result;
+    gchar *src, *dst;
+    guint n;
 
-    case 'e':                           /* Raw seconds */
-        adg_dim_style_convert(dim_style, value, 'i');
-        *value = (*value - (gint) *value) * 60;
-        break;
+    g_return_val_if_fail(ADG_IS_DIM_STYLE(dim_style), NULL);
 
-    case 'D':                           /* Truncated value */
-        *value = (gint) *value;
-        break;
+    data = dim_style->data;
 
-    case 'd':                           /* Rounded value */
-        *value = adg_round(*value, data->decimals);
-        break;
+    if (data->number_format == NULL)
+        return NULL;
 
-    case 'M':                           /* Truncated minutes */
-        adg_dim_style_convert(dim_style, value, 'i');
-        *value = (gint) *value;
-        break;
+    if (data->number_arguments == NULL)
+        return g_strdup(data->number_format);
 
-    case 'm':                           /* Rounded minutes */
-        adg_dim_style_convert(dim_style, value, 'i');
-        *value = adg_round(*value, data->decimals);
-        break;
+    /* Dimensions sharing this style could be arranged in parallel */
+    G_LOCK(_adg_number_program);
+    if (data->number_program == NULL)
+        data->number_program = _adg_compile_format(data->number_format,
+                                                   data->number_arguments);
+    G_UNLOCK(_adg_number_program);
 
-    case 'S':                           /* Truncated seconds */
-        adg_dim_style_convert(dim_style, value, 'e');
-        *value = (gint) *value;
-        break;
+    /* Likely unbalanced parenthesis */
+    g_return_val_if_fail(data->number_program != NULL, NULL);
 
-    case 's':                           /* Rounded seconds */
-        adg_dim_style_convert(dim_style, value, 'e');
-        *value = adg_round(*value, data->decimals);
-        break;
+    result = g_string_new("");
+    n = 0;
+    _adg_eval_level(dim_style, &n, value, result);
 
-    default:
-        g_return_val_if_reached(FALSE);
-        return FALSE;
+    /* Substitute the escape sequences ("\%", "\(" and "\)") */
+    for (src = dst = result->str; *src != '\0'; ++src, ++dst) {
+        if (src[0] == '\\' && src[1] != '\0' && strchr("%()", src[1]) != NULL)
+            ++src;
+        *dst = *src;
     }
+    *dst = '\0';
 
-    return TRUE;
+    return g_string_free(result, FALSE);
 }
 
 
@@ -1444,6 +1578,19 @@ _adg_clone(AdgStyle *style)
     return (AdgStyle *) dim_style;
 }
 
+static gboolean
+_adg_equal(AdgStyle *style, AdgStyle *other)
+{
+    AdgDimStylePrivate *data = ((AdgDimStyle *) style)->data;
+    AdgDimStylePrivate *other_data = ((AdgDimStyle *) other)->data;
+
+    /* The markers are write-only, so they are not checked by the
+     * property based comparison of the parent class */
+    return _adg_marker_equal(&data->marker1, &other_data->marker1) &&
+           _adg_marker_equal(&data->marker2, &other_data->marker2) &&
+           _ADG_OLD_STYLE_CLASS->equal(style, other);
+}
+
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 {
@@ -1462,6 +1609,65 @@ _adg_marker_new(const AdgMarkerData *marker_data)
                          marker_data->parameters);
 }
 
+static gboolean
+_adg_reset_marker(const AdgMarkerData *marker_data, AdgMarker *marker)
+{
+    GObject *object;
+    GParamSpec *spec;
+    const GParameter *parameter;
+    GValue value = { 0 };
+    gboolean same;
+    guint n;
+
+    if (marker_data->type == 0 || G_OBJECT_TYPE(marker) != marker_data->type)
+        return FALSE;
+
+    object = (GObject *) marker;
+
+    /* Check the construct only properties before changing anything */
+    for (n = 0; n < marker_data->n_parameters; ++n) {
+        parameter = &marker_data->parameters[n];
+        spec = g_object_class_find_property(G_OBJECT_GET_CLASS(object),
+                                            parameter->name);
+        if ((spec->flags & G_PARAM_CONSTRUCT_ONLY) == 0)
+            continue;
+
+        g_value_init(&value, spec->value_type);
+        g_object_get_property(object, spec->name, &value);
+        same = g_param_values_cmp(spec, &value, &parameter->value) == 0;
+        g_value_unset(&value);
+
+        if (! same)
+            return FALSE;
+    }
+
+    g_object_freeze_notify(object);
+
+    for (n = 0; n < marker_data->n_parameters; ++n) {
+        parameter = &marker_data->parameters[n];
+        spec = g_object_class_find_property(G_OBJECT_GET_CLASS(object),
+                                            parameter->name);
+
+        /* Skip the properties bound to the owner of the marker */
+        if ((spec->flags & G_PARAM_CONSTRUCT_ONLY) != 0 ||
+            strcmp(spec->name, "parent") == 0 ||
+            strcmp(spec->name, "trail") == 0 ||
+            strcmp(spec->name, "n-segment") == 0 ||
+            strcmp(spec->name, "model") == 0)
+            continue;
+
+        g_value_init(&value, spec->value_type);
+        g_object_get_property(object, spec->name, &value);
+        if (g_param_values_cmp(spec, &value, &parameter->value) != 0)
+            g_object_set_property(object, spec->name, &parameter->value);
+        g_value_unset(&value);
+    }
+
+    g_object_thaw_notify(object);
+
+    return TRUE;
+}
+
 static void
 _adg_set_marker(AdgMarkerData *marker_data, AdgMarker *marker)
 {
@@ -1513,3 +1719,307 @@ _adg_free_marker(AdgMarkerData *marker_data)
     marker_data->n_parameters = 0;
     marker_data->parameters = NULL;
 }
+
+static gboolean
+_adg_marker_equal(const AdgMarkerData *marker_data,
+                  const AdgMarkerData *marker_data2)
+{
+    guint n;
+
+    if (marker_data->type != marker_data2->type ||
+        marker_data->n_parameters != marker_data2->n_parameters)
+        return FALSE;
+
+    /* The parameters come from g_object_class_list_properties() on the
+     * same type, so they are in the same order and have intern names */
+    for (n = 0; n < marker_data->n_parameters; ++n) {
+        if (marker_data->parameters[n].name != marker_data2->parameters[n].name ||
+            ! _adg_value_equal(&marker_data->parameters[n].value,
+                               &marker_data2->parameters[n].value))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static GArray *
+_adg_compile_format(const gchar *format, const gchar *arguments)
+{
+    GArray *program;
+    const gchar *argument;
+
+    program = g_array_new(FALSE, FALSE, sizeof(AdgNumberOp));
+    argument = arguments;
+
+    /* Check that all format string has been parsed, otherwise there are
+     * likely too many close parenthesis */
+    if (! _adg_compile_level(program, &format, &argument) || *format != '\0') {
+        _adg_free_ops(program);
+        return NULL;
+    }
+
+    return program;
+}
+
+/* Compiles the format up to the end of the current group (or of the
+ * string), expanding the nested groups recursively */
+static gboolean
+_adg_compile_level(GArray *program, const gchar **format, const gchar **argument)
+{
+    const gchar *bog, *eog;
+    gsize len;
+
+    eog = adg_unescaped_strchr(*format, ')');
+
+    /* Compile eventual groups found in the same nesting level */
+    while ((bog = adg_unescaped_strchr(*format, '(')) != NULL) {
+        /* If eog precedes bog, it means that bog is in another nest */
+        if (eog != NULL && eog < bog)
+            break;
+
+        _adg_compile_segment(program, *format, bog - *format, argument);
+        *format = bog + 1;
+
+        _adg_append_op(program, ADG_NUMBER_OP_GROUP, NULL, '\0');
+        if (! _adg_compile_level(program, format, argument))
+            return FALSE;
+
+        /* Ensure there is a matching closing parenthesis */
+        if (**format != ')')
+            return FALSE;
+
+        _adg_append_op(program, ADG_NUMBER_OP_END, NULL, '\0');
+
+        /* Skip the closing parenthesis */
+        ++ *format;
+        eog = adg_unescaped_strchr(*format, ')');
+    }
+
+    /* Compile until closing parenthesis (End Of Group) or '\0' */
+    len = eog == NULL ? strlen(*format) : (gsize) (eog - *format);
+    _adg_compile_segment(program, *format, len, argument);
+    *format += len;
+
+    return TRUE;
+}
+
+/* Splits a segment without groups in literal chunks and % directives.
+ * A directive starts with an unescaped '%' and ends at the first
+ * conversion character (one of "eEfFgG") found on the same line */
+static void
+_adg_compile_segment(GArray *program, const gchar *segment, gsize len,
+                     const gchar **argument)
+{
+    const gchar *end, *literal, *p, *q;
+
+    end = segment + len;
+    literal = segment;
+
+    for (p = segment; p < end; ++p) {
+        if (*p != '%' || (p > segment && p[-1] == '\\'))
+            continue;
+
+        for (q = p + 1; q < end && *q != '\n'; ++q)
+            if (strchr("eEfFgG", *q) != NULL)
+                break;
+
+        if (q == end || *q == '\n')
+            continue;
+
+        if (p > literal)
+            _adg_append_op(program, ADG_NUMBER_OP_LITERAL,
+                           g_strndup(literal, p - literal), '\0');
+
+        _adg_append_op(program, ADG_NUMBER_OP_VALUE,
+                       g_strndup(p, q - p + 1), **argument);
+
+        /* Consume the argument, if any */
+        if (**argument != '\0')
+            ++ *argument;
+
+        p = q;
+        literal = q + 1;
+    }
+
+    if (end > literal)
+        _adg_append_op(program, ADG_NUMBER_OP_LITERAL,
+                       g_strndup(literal, end - literal), '\0');
+}
+
+static void
+_adg_append_op(GArray *program, AdgNumberOpType type,
+               gchar *text, gchar argument)
+{
+    AdgNumberOp op;
+
+    op.type = type;
+    op.text = text;
+    op.argument = argument;
+    if (type != ADG_NUMBER_OP_VALUE ||
+        ! _adg_decode_argument(argument, &op.stage, &op.mode)) {
+        op.stage = -1;
+        op.mode = ADG_NUMBER_MODE_RAW;
+    }
+    g_array_append_val(program, op);
+}
+
+static void
+_adg_free_ops(GArray *program)
+{
+    guint n;
+
+    for (n = 0; n < program->len; ++n)
+        g_free(g_array_index(program, AdgNumberOp, n).text);
+
+    g_array_free(program, TRUE);
+}
+
+static void
+_adg_free_program(AdgDimStyle *dim_style)
+{
+    AdgDimStylePrivate *data = dim_style->data;
+
+    if (data->number_program != NULL) {
+        _adg_free_ops(data->number_program);
+        data->number_program = NULL;
+    }
+}
+
+static gboolean
+_adg_decode_argument(gchar argument, gint *stage, AdgNumberMode *mode)
+{
+    const gchar *p;
+
+    if (argument == '\0' || (p = strchr(VALID_FORMATS, argument)) == NULL)
+        return FALSE;
+
+    /* VALID_FORMATS is "aieDdMmSs": the raw values first, then a
+     * truncated/rounded couple for every stage */
+    switch (p - VALID_FORMATS) {
+    case 0:
+    case 1:
+    case 2:
+        *stage = p - VALID_FORMATS;
+        *mode = ADG_NUMBER_MODE_RAW;
+        break;
+    default:
+        *stage = (p - VALID_FORMATS - 3) / 2;
+        *mode = (p - VALID_FORMATS) % 2 == 1 ?
+            ADG_NUMBER_MODE_TRUNCATED : ADG_NUMBER_MODE_ROUNDED;
+        break;
+    }
+
+    return TRUE;
+}
+
+/* Converts @value without recursion: the raw value is rounded once,
+ * then the minutes and the seconds are extracted as needed */
+static gdouble
+_adg_convert(AdgDimStylePrivate *data, gdouble value,
+             gint stage, AdgNumberMode mode)
+{
+    gint n;
+
+    if (data->rounding > -1)
+        value = round(value * data->rounding_coefficient) /
+            data->rounding_coefficient;
+
+    for (n = 0; n < stage; ++n)
+        value = (value - (gint) value) * 60;
+
+    switch (mode) {
+    case ADG_NUMBER_MODE_TRUNCATED:
+        value = (gint) value;
+        break;
+    case ADG_NUMBER_MODE_ROUNDED:
+        value = round(value * data->decimals_coefficient) /
+            data->decimals_coefficient;
+        break;
+    default:
+        break;
+    }
+
+    return value;
+}
+
+static void
+_adg_update_coefficients(AdgDimStylePrivate *data)
+{
+    /* As in adg_round(), non-positive decimals round to units */
+    data->rounding_coefficient = pow(10, data->rounding);
+    data->decimals_coefficient = data->decimals > 0 ? pow(10, data->decimals) : 1;
+}
+
+/* Evaluates the program from the *n op up to the end of the current
+ * group, returning its valorized state. A group whose values are all
+ * zero is dropped from @result */
+static AdgThreeState
+_adg_eval_level(AdgDimStyle *dim_style, guint *n, gdouble value,
+                GString *result)
+{
+    AdgDimStylePrivate *data;
+    AdgThreeState valorized, group_valorized;
+    const AdgNumberOp *op;
+    gboolean failed;
+    gdouble converted;
+    gsize len;
+    gchar buffer[256];
+
+    data = dim_style->data;
+    valorized = ADG_THREE_STATE_UNKNOWN;
+    failed = FALSE;
+
+    while (*n < data->number_program->len) {
+        op = &g_array_index(data->number_program, AdgNumberOp, *n);
+        ++ *n;
+
+        switch (op->type) {
+
+        case ADG_NUMBER_OP_LITERAL:
+            g_string_append(result, op->text);
+            break;
+
+        case ADG_NUMBER_OP_VALUE:
+            /* After a failed conversion, the rest of the chunk
+             * is left untouched */
+            if (failed) {
+                g_string_append(result, op->text);
+                break;
+            }
+
+            /* Invalid arguments are delegated to the public API,
+             * only to get the usual warning */
+            converted = value;
+            if (op->stage >= 0) {
+                converted = _adg_convert(data, value, op->stage, op->mode);
+            } else if (! adg_dim_style_convert(dim_style, &converted, op->argument)) {
+                /* Conversion failed: invalid argument? */
+                failed = TRUE;
+                break;
+            }
+
+            g_ascii_formatd(buffer, 256, op->text, converted);
+            g_string_append(result, buffer);
+            valorized = OR_3S(valorized, converted != 0 ?
+                              ADG_THREE_STATE_ON : ADG_THREE_STATE_OFF);
+            break;
+
+        case ADG_NUMBER_OP_GROUP:
+            len = result->len;
+            group_valorized = _adg_eval_level(dim_style, n, value, result);
+            valorized = OR_3S(valorized, group_valorized);
+
+            /* Drop the group if not valorized */
+            if (group_valorized == ADG_THREE_STATE_OFF)
+                g_string_truncate(result, len);
+
+            failed = FALSE;
+            break;
+
+        case ADG_NUMBER_OP_END:
+            return valorized;
+        }
+    }
+
+    return valorized;
+}
@@ -57,9 +57,13 @@ AdgDimStyle *   adg_dim_style_new               (void);
 void            adg_dim_style_set_marker1       (AdgDimStyle    *dim_style,
                                                  AdgMarker      *marker);
 AdgMarker *     adg_dim_style_marker1_new       (AdgDimStyle    *dim_style);
+gboolean        adg_dim_style_reset_marker1     (AdgDimStyle    *dim_style,
+                                                 AdgMarker      *marker);
 void            adg_dim_style_set_marker2       (AdgDimStyle    *dim_style,
                                                  AdgMarker      *marker);
 AdgMarker *     adg_dim_style_marker2_new       (AdgDimStyle    *dim_style);
+gboolean        adg_dim_style_reset_marker2     (AdgDimStyle    *dim_style,
+                                                 AdgMarker      *marker);
 void            adg_dim_style_set_color_dress   (AdgDimStyle    *dim_style,
                                                  AdgDress        dress);
 AdgDress        adg_dim_style_get_color_dress   (AdgDimStyle    *dim_style);
@@ -118,6 +122,8 @@ gint            adg_dim_style_get_rounding      (AdgDimStyle    *dim_style);
 gboolean        adg_dim_style_convert           (AdgDimStyle    *dim_style,
                                                  gdouble        *value,
                                                  gchar           format);
+gchar *         adg_dim_style_format_value      (AdgDimStyle    *dim_style,
+                                                 gdouble         value);
 
 G_END_DECLS
 
@@ -82,10 +82,6 @@
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_dim_parent_class)
 
 /* A convenience macro for ORing two AdgThreeState values */
-#define OR_3S(a,b) ( \
-    ((a) == ADG_THREE_STATE_ON ||      (b) == ADG_THREE_STATE_ON)      ? ADG_THREE_STATE_ON : \
-    ((a) == ADG_THREE_STATE_UNKNOWN && (b) == ADG_THREE_STATE_UNKNOWN) ? ADG_THREE_STATE_UNKNOWN : \
-                                                                         ADG_THREE_STATE_OFF )
 
 
 G_DEFINE_ABSTRACT_TYPE(AdgDim, adg_dim, ADG_TYPE_ENTITY)
@@ -119,6 +115,10 @@ static void     _adg_global_changed     (AdgEntity          *entity);
 static void     _adg_local_changed      (AdgEntity          *entity);
 static void     _adg_invalidate         (AdgEntity          *entity);
 static void     _adg_arrange            (AdgEntity          *entity);
+static gsize    _adg_memory_usage       (AdgEntity          *entity);
+static void     _adg_trim_caches        (AdgEntity          *entity,
+                                         AdgTrimLevel        level);
+static void     _adg_geometry_changed   (AdgEntity          *entity);
 static gboolean _adg_compute_geometry   (AdgDim             *dim);
 static gchar *  _adg_default_value      (AdgDim             *dim);
 static gdouble  _adg_quote_angle        (gdouble             angle);
@@ -132,10 +132,10 @@ static gboolean _adg_set_min            (AdgDim             *dim,
                                          const gchar        *min);
 static gboolean _adg_set_max            (AdgDim             *dim,
                                          const gchar        *max);
-static gboolean _adg_replace            (const GMatchInfo   *match_info,
-                                         GString            *result,
-                                         gpointer            user_data);
-static gchar *  _adg_text_expand        (AdgDimReplaceData  *data);
+static void     _adg_update_limit       (AdgDim             *dim,
+                                         AdgTextual        **limit,
+                                         const gchar        *text,
+                                         AdgDress            dress);
 
 
 static void
@@ -158,7 +158,10 @@ adg_dim_class_init(AdgDimClass *klass)
     entity_class->global_changed = _adg_global_changed;
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
+    entity_class->geometry_changed = _adg_geometry_changed;
     entity_class->arrange = _adg_arrange;
+    entity_class->memory_usage = _adg_memory_usage;
+    entity_class->trim_caches = _adg_trim_caches;
 
     klass->compute_geometry = _adg_compute_geometry;
     klass->quote_angle = _adg_quote_angle;
@@ -259,6 +262,8 @@ adg_dim_init(AdgDim *dim)
 #endif
 
     dim->data = data;
+
+    ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_DIM, sizeof(AdgDim) + sizeof(AdgDimPrivate));
 }
 
 static void
@@ -271,8 +276,12 @@ _adg_dispose(GObject *object)
     data = ((AdgDim *) object)->data;
 
     if (data->quote.entity) {
+        /* The quote texts are owned by the quote container */
         g_object_unref(data->quote.entity);
         data->quote.entity = NULL;
+        data->quote.value = NULL;
+        data->quote.min = NULL;
+        data->quote.max = NULL;
     }
 
     if (data->ref1)
@@ -297,6 +306,9 @@ _adg_finalize(GObject *object)
     g_free(data->min);
     g_free(data->max);
 
+    ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_DIM,
+                    -(gssize) (sizeof(AdgDim) + sizeof(AdgDimPrivate)));
+
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
 }
@@ -1007,11 +1019,6 @@ gchar *
 adg_dim_get_text(AdgDim *dim, gdouble value)
 {
     AdgDimStyle *dim_style;
-    const gchar *format;
-    const gchar *arguments;
-    AdgDimReplaceData data;
-    gchar *raw, *result;
-    GRegex *regex;
 
     g_return_val_if_fail(ADG_IS_DIM(dim), NULL);
 
@@ -1021,40 +1028,7 @@ adg_dim_get_text(AdgDim *dim, gdouble value)
                                                      adg_dim_get_dim_dress(dim));
     }
 
-    format = adg_dim_style_get_number_format(dim_style);
-    if (format == NULL) {
-        return NULL;
-    }
-
-    arguments = adg_dim_style_get_number_arguments(dim_style);
-    if (arguments == NULL) {
-        return g_strdup(format);
-    }
-
-    /* Expand the values */
-    data.dim_style = dim_style;
-    data.value = value;
-    data.format = format;
-    data.argument = arguments;
-    data.regex = g_regex_new("(?<!\\\\)%.*[eEfFgG]", G_REGEX_UNGREEDY, 0, NULL);
-    raw = _adg_text_expand(&data);
-    g_regex_unref(data.regex);
-
-    /* Check that all format string has been parsed, otherwise there are
-     * likely too many close parenthesis */
-    if (*data.format != '\0') {
-        g_free(raw);
-        g_return_val_if_reached(NULL);
-        return NULL;
-    }
-
-    /* Substitute the escape sequences ("\%", "\(" and "\)") */
-    regex = g_regex_new("\\\\([%()])", G_REGEX_UNGREEDY, 0, NULL);
-    result = g_regex_replace(regex, raw, -1, 0, "\\1", 0, NULL);
-    g_free(raw);
-    g_regex_unref(regex);
-
-    return result;
+    return adg_dim_style_format_value(dim_style, value);
 }
 
 /**
@@ -1463,12 +1437,23 @@ _adg_invalidate(AdgEntity *entity)
 {
     AdgDimPrivate *data = ((AdgDim *) entity)->data;
 
-    if (data->quote.value) {
-        g_object_unref(data->quote.value);
-        data->quote.value = NULL;
-    }
+    /* The quote texts are kept: they will be updated while arranging */
     if (data->quote.entity)
         adg_entity_invalidate((AdgEntity *) data->quote.entity);
+
+    _adg_geometry_changed(entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->invalidate)
+        _ADG_OLD_ENTITY_CLASS->invalidate(entity);
+}
+
+static void
+_adg_geometry_changed(AdgEntity *entity)
+{
+    AdgDimPrivate *data = ((AdgDim *) entity)->data;
+
+    /* Only the points must be updated: the quote, whose global map
+     * is set on every arrange, is just moved and not reshaped */
     if (data->ref1)
         adg_point_invalidate(data->ref1);
     if (data->ref2)
@@ -1481,9 +1466,6 @@ _adg_invalidate(AdgEntity *entity)
         g_free(data->geometry.notice);
         data->geometry.notice = NULL;
     }
-
-    if (_ADG_OLD_ENTITY_CLASS->invalidate)
-        _ADG_OLD_ENTITY_CLASS->invalidate(entity);
 }
 
 static void
@@ -1515,22 +1497,26 @@ _adg_arrange(AdgEntity *entity)
     quote_entity = (AdgEntity *) data->quote.entity;
     quote_container = (AdgContainer *) data->quote.entity;
 
-    if (data->quote.value == NULL) {
+    {
         AdgDimClass *klass;
         AdgDress dress;
         const gchar *tag;
         gchar *value;
-        gchar *text;
+        gchar *text, *old_text;
 
         klass = ADG_DIM_GET_CLASS(dim);
         dress = adg_dim_style_get_value_dress(data->dim_style);
         tag = adg_dim_style_get_number_tag(data->dim_style);
         value = klass->default_value ? klass->default_value(dim) : NULL;
 
-        data->quote.value = g_object_new(ADG_TYPE_BEST_TEXT,
-                                         "local-mix", ADG_MIX_PARENT,
-                                         "font-dress", dress, NULL);
-        adg_container_add(quote_container, (AdgEntity *) data->quote.value);
+        if (data->quote.value == NULL) {
+            data->quote.value = g_object_new(ADG_TYPE_BEST_TEXT,
+                                             "local-mix", ADG_MIX_PARENT,
+                                             "font-dress", dress, NULL);
+            adg_container_add(quote_container, (AdgEntity *) data->quote.value);
+        } else if (adg_textual_get_font_dress(data->quote.value) != dress) {
+            adg_textual_set_font_dress(data->quote.value, dress);
+        }
 
         if (data->value)
             text = adg_string_replace(data->value, tag, value);
@@ -1539,31 +1525,20 @@ _adg_arrange(AdgEntity *entity)
 
         g_free(value);
 
-        adg_textual_set_text(data->quote.value, text);
-        g_free(text);
-    }
-
-    if (data->quote.min == NULL && data->min != NULL) {
-        AdgDress dress = adg_dim_style_get_min_dress(data->dim_style);
+        /* Reuse the existing text entity: it is updated (and
+         * reshaped) only when the text really changed */
+        old_text = adg_textual_dup_text(data->quote.value);
+        if (g_strcmp0(text, old_text) != 0)
+            adg_textual_set_text(data->quote.value, text);
 
-        data->quote.min = g_object_new(ADG_TYPE_BEST_TEXT,
-                                       "local-mix", ADG_MIX_PARENT,
-                                       "font-dress", dress, NULL);
-
-        adg_container_add(quote_container, (AdgEntity *) data->quote.min);
-        adg_textual_set_text(data->quote.min, data->min);
+        g_free(old_text);
+        g_free(text);
     }
 
-    if (data->quote.max == NULL && data->max != NULL) {
-        AdgDress dress = adg_dim_style_get_max_dress(data->dim_style);
-
-        data->quote.max = g_object_new(ADG_TYPE_BEST_TEXT,
-                                       "local-mix", ADG_MIX_PARENT,
-                                       "font-dress", dress, NULL);
-
-        adg_container_add(quote_container, (AdgEntity *) data->quote.max);
-        adg_textual_set_text(data->quote.max, data->max);
-    }
+    _adg_update_limit(dim, &data->quote.min, data->min,
+                      adg_dim_style_get_min_dress(data->dim_style));
+    _adg_update_limit(dim, &data->quote.max, data->max,
+                      adg_dim_style_get_max_dress(data->dim_style));
 
     value_entity = (AdgEntity *) data->quote.value;
     min_entity = (AdgEntity *) data->quote.min;
@@ -1622,6 +1597,42 @@ _adg_compute_geometry(AdgDim *dim)
     return FALSE;
 }
 
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgDimPrivate *data = ((AdgDim *) entity)->data;
+    gsize usage;
+
+    usage = _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgDimPrivate);
+
+    if (data->value != NULL)
+        usage += strlen(data->value) + 1;
+    if (data->min != NULL)
+        usage += strlen(data->min) + 1;
+    if (data->max != NULL)
+        usage += strlen(data->max) + 1;
+    if (data->geometry.notice != NULL)
+        usage += strlen(data->geometry.notice) + 1;
+
+    /* The quote is not a child of any container, so it is owned here */
+    if (data->quote.entity != NULL)
+        usage += adg_entity_get_memory_usage((AdgEntity *) data->quote.entity);
+
+    return usage;
+}
+
+static void
+_adg_trim_caches(AdgEntity *entity, AdgTrimLevel level)
+{
+    AdgDimPrivate *data = ((AdgDim *) entity)->data;
+
+    if (data->quote.entity != NULL)
+        adg_entity_trim_caches((AdgEntity *) data->quote.entity, level);
+
+    _ADG_OLD_ENTITY_CLASS->trim_caches(entity, level);
+}
+
 static gchar *
 _adg_default_value(AdgDim *dim)
 {
@@ -1690,11 +1701,6 @@ _adg_set_value(AdgDim *dim, const gchar *value)
     g_free(data->value);
     data->value = g_strdup(value);
 
-    if (data->quote.value) {
-        g_object_unref(data->quote.value);
-        data->quote.value = NULL;
-    }
-
     return TRUE;
 }
 
@@ -1709,11 +1715,6 @@ _adg_set_min(AdgDim *dim, const gchar *min)
     g_free(data->min);
     data->min = g_strdup(min);
 
-    if (data->quote.min) {
-        g_object_unref(data->quote.min);
-        data->quote.min = NULL;
-    }
-
     return TRUE;
 }
 
@@ -1728,129 +1729,42 @@ _adg_set_max(AdgDim *dim, const gchar *max)
     g_free(data->max);
     data->max = g_strdup(max);
 
-    if (data->quote.max) {
-        g_object_unref(data->quote.max);
-        data->quote.max = NULL;
-    }
-
     return TRUE;
 }
 
-static gboolean
-_adg_replace(const GMatchInfo *match_info, GString *result, gpointer user_data)
+/* Keeps the limit text entity in sync with @text, creating it only
+ * when needed: the same entity is reused across the arrange phases
+ * and dropped only when the limit is unset */
+static void
+_adg_update_limit(AdgDim *dim, AdgTextual **limit,
+                  const gchar *text, AdgDress dress)
 {
-    AdgDimReplaceData *data;
-    gdouble value;
-    gchar *format;
-    gchar buffer[256];
-
-    data = (AdgDimReplaceData *) user_data;
-    value = data->value;
-
-    if (! adg_dim_style_convert(data->dim_style, &value, *data->argument)) {
-        /* Conversion failed: invalid argument? */
-        g_return_val_if_reached(TRUE);
-        return TRUE;
-    }
-
-    format = g_match_info_fetch(match_info, 0);
-
-    /* This should never happen */
-    g_return_val_if_fail(format != NULL, TRUE);
-
-    /* Consume the recently used argument */
-    ++ data->argument;
-
-    g_ascii_formatd(buffer, 256, format, value);
-    g_free(format);
-    g_string_append(result, buffer);
-
-    /* Set the valorized flag */
-    if (value != 0) {
-        data->valorized = ADG_THREE_STATE_ON;
-    } else if (data->valorized == ADG_THREE_STATE_UNKNOWN) {
-        data->valorized = ADG_THREE_STATE_OFF;
-    }
-
-    return FALSE;
-}
+    AdgDimPrivate *data;
+    gchar *old_text;
 
-static gchar *
-_adg_text_expand(AdgDimReplaceData *data)
-{
-    GString *result;
-    const gchar *bog, *eog;
-    gchar *string;
-    AdgThreeState valorized;
-    gssize len;
-
-    valorized = ADG_THREE_STATE_UNKNOWN;
-    result = g_string_new("");
-    eog = adg_unescaped_strchr(data->format, ')');
-
-    /* Expand eventual groups found in the same nesting level */
-    while ((bog = adg_unescaped_strchr(data->format, '(')) != NULL) {
-        /* If eog precedes bog, it means that bog is in another nest */
-        if (eog != NULL && eog < bog) {
-            break;
-        }
+    data = dim->data;
 
-        len = bog - data->format;
-
-        /* Parse template before the bog */
-        data->valorized = ADG_THREE_STATE_UNKNOWN;
-        string = g_regex_replace_eval(data->regex,
-                                      data->format, len, 0,
-                                      0,
-                                      _adg_replace, data,
-                                      NULL);
-        valorized = OR_3S(valorized, data->valorized);
-
-        data->format += len+1;
-        g_string_append(result, string);
-        g_free(string);
-
-        /* Recursively expand the group */
-        string = _adg_text_expand(data);
-        valorized = OR_3S(valorized, data->valorized);
-
-        g_string_append(result, string);
-        g_free(string);
-
-        /* Ensure there is a matching closing parenthesis */
-        if (*data->format != ')') {
-            g_string_free(result, TRUE);
-            g_return_val_if_reached(NULL);
-            return NULL;
+    if (text == NULL) {
+        if (*limit != NULL) {
+            adg_container_remove((AdgContainer *) data->quote.entity,
+                                 (AdgEntity *) *limit);
+            *limit = NULL;
         }
-
-        /* Skip the closing parenthesis */
-        ++ data->format;
-        eog = adg_unescaped_strchr(data->format, ')');
+        return;
     }
 
-    /* Expand until closing parenthesis (End Of Group) or '\0' */
-    len = eog == NULL ? strlen(data->format) : (eog - data->format);
-    data->valorized = ADG_THREE_STATE_UNKNOWN;
-    string = g_regex_replace_eval(data->regex,
-                                  data->format, len, 0,
-                                  0,
-                                  _adg_replace, data,
-                                  NULL);
-
-    data->format += len;
-    g_string_append(result, string);
-    g_free(string);
-
-    /* Store the final valorized state */
-    valorized = OR_3S(valorized, data->valorized);
-    data->valorized = valorized;
-
-    /* Drop the result only if we are inside a group */
-    if (*data->format && valorized == ADG_THREE_STATE_OFF) {
-        g_string_free(result, TRUE);
-        return g_strdup("");
+    if (*limit == NULL) {
+        *limit = g_object_new(ADG_TYPE_BEST_TEXT,
+                              "local-mix", ADG_MIX_PARENT,
+                              "font-dress", dress, NULL);
+        adg_container_add((AdgContainer *) data->quote.entity,
+                          (AdgEntity *) *limit);
+    } else if (adg_textual_get_font_dress(*limit) != dress) {
+        adg_textual_set_font_dress(*limit, dress);
     }
 
-    return g_string_free(result, FALSE);
+    old_text = adg_textual_dup_text(*limit);
+    if (g_strcmp0(text, old_text) != 0)
+        adg_textual_set_text(*limit, text);
+    g_free(old_text);
 }
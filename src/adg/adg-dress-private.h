@@ -29,6 +29,7 @@ typedef struct _AdgDressPrivate AdgDressPrivate;
 struct _AdgDressPrivate {
     AdgStyle    *fallback;
     GType        ancestor_type;
+    gint         is_builtin;
 };
 
 G_END_DECLS
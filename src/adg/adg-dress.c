@@ -30,6 +30,13 @@
  * a dress only in a specific entity branch of the hierarchy or
  * customize multiple entities at once.
  *
+ * The dress register is shared by the whole process but it is
+ * thread-safe: it is initialized only once and the fallback styles
+ * can be read concurrently from any thread. Anyway the fallback
+ * styles themselves are shared, so they should be changed with
+ * adg_dress_set_fallback() only before starting to generate
+ * drawings on different threads.
+ *
  * Since: 1.0
  **/
 
@@ -185,10 +192,12 @@
 
 
 static GArray *         _adg_data_array             (void);
+G_LOCK_DEFINE_STATIC(_adg_fallback);
 static void             _adg_data_register          (AdgDress    dress,
-                                                     AdgStyle   *fallback,
+                                                     gboolean    is_builtin,
                                                      GType       ancestor_type);
 static void             _adg_data_register_builtins (void);
+static AdgStyle *       _adg_builtin_fallback       (AdgDress    dress);
 static AdgDressPrivate *_adg_data_lookup            (AdgDress    dress);
 
 
@@ -327,12 +336,10 @@ void
 adg_dress_set_fallback(AdgDress dress, AdgStyle *fallback)
 {
     AdgDressPrivate *data = _adg_data_lookup(dress);
+    AdgStyle *old_fallback;
 
     g_return_if_fail(data != NULL);
 
-    if (data->fallback == fallback)
-        return;
-
     /* Check if the new fallback style is compatible with this dress */
     if (fallback != NULL && !adg_dress_style_is_compatible(dress, fallback)) {
         g_warning(_("%s: the fallback style of '%s' dress (%d) must be a '%s' derived type, but a '%s' has been provided"),
@@ -342,13 +349,20 @@ adg_dress_set_fallback(AdgDress dress, AdgStyle *fallback)
         return;
     }
 
-    if (data->fallback != NULL)
-        g_object_unref(data->fallback);
+    if (fallback != NULL)
+        g_object_ref(fallback);
 
-    data->fallback = fallback;
+    /* Only writers are serialized: readers access the registry
+     * without locking, so the swap is done with a single store.
+     * An explicit fallback, even NULL, prevails on the built-in one */
+    G_LOCK(_adg_fallback);
+    old_fallback = data->fallback;
+    g_atomic_int_set(&data->is_builtin, FALSE);
+    g_atomic_pointer_set((gpointer *) &data->fallback, fallback);
+    G_UNLOCK(_adg_fallback);
 
-    if (data->fallback != NULL)
-        g_object_ref(data->fallback);
+    if (old_fallback != NULL)
+        g_object_unref(old_fallback);
 }
 
 /**
@@ -359,6 +373,10 @@ adg_dress_set_fallback(AdgDress dress, AdgStyle *fallback)
  * are raised if the dress is not found. The returned style
  * is owned by dress and should not be freed or modified.
  *
+ * The built-in fallback styles are created on demand, that is
+ * the first time this function is called on that specific dress,
+ * so a process never pays for the styles it does not use.
+ *
  * Returns: (transfer none): the requested #AdgStyle derived instance or <constant>NULL</constant> if not set.
  *
  * Since: 1.0
@@ -367,7 +385,32 @@ AdgStyle *
 adg_dress_get_fallback(AdgDress dress)
 {
     AdgDressPrivate *data = _adg_data_lookup(dress);
-    return data != NULL ? data->fallback : NULL;
+    AdgStyle *fallback;
+
+    if (data == NULL)
+        return NULL;
+
+    fallback = g_atomic_pointer_get((gpointer *) &data->fallback);
+    if (fallback != NULL || ! g_atomic_int_get(&data->is_builtin))
+        return fallback;
+
+    /* The style is built outside the lock because its construction
+     * could look up other dresses: if another thread won the race,
+     * the fresh instance is simply dropped */
+    fallback = _adg_builtin_fallback(dress);
+
+    G_LOCK(_adg_fallback);
+    if (data->is_builtin) {
+        g_atomic_pointer_set((gpointer *) &data->fallback, fallback);
+        g_atomic_int_set(&data->is_builtin, FALSE);
+        fallback = NULL;
+    }
+    G_UNLOCK(_adg_fallback);
+
+    if (fallback != NULL)
+        g_object_unref(fallback);
+
+    return g_atomic_pointer_get((gpointer *) &data->fallback);
 }
 
 /**
@@ -395,247 +438,242 @@ adg_dress_style_is_compatible(AdgDress dress, AdgStyle *style)
 }
 
 
+/* The following register keeps track of the metadata bound to every
+ * #AdgDress value, such as the fallback style and the ancestor type.
+ *
+ * The AdgDress value is cohincident with the index of its metadata
+ * inside this register, that is if %ADG_DRESS_COLOR_BACKGROUND is 2,
+ * array->data[2] will contain its metadata.
+ *
+ * The register is filled only once, so after the initialization it
+ * can be safely read by many threads without locking. The built-in
+ * fallback styles are not created here: every dress with is_builtin
+ * set gets its own by _adg_builtin_fallback() on the first lookup.
+ */
+static GArray *_adg_data = NULL;
+
 static GArray *
 _adg_data_array(void)
 {
-    /* The following register keeps track of the metadata bound to every
-     * #AdgDress value, such as the fallback style and the ancestor type.
-     *
-     * The AdgDress value is cohincident with the index of its metadata
-     * inside this register, that is if %ADG_DRESS_COLOR_BACKGROUND is 2,
-     * array->data[2] will contain its metadata.
-     */
-    static GArray *array = NULL;
-
-    if (G_UNLIKELY(array == NULL)) {
-        array = g_array_new(FALSE, FALSE, sizeof(AdgDressPrivate));
+    static gsize initialized = 0;
+
+    if (g_once_init_enter(&initialized)) {
+        _adg_data = g_array_new(FALSE, FALSE, sizeof(AdgDressPrivate));
         _adg_data_register_builtins();
+        g_once_init_leave(&initialized, 1);
     }
 
-    return array;
+    return _adg_data;
 }
 
 static void
-_adg_data_register(AdgDress dress, AdgStyle *fallback, GType ancestor_type)
+_adg_data_register(AdgDress dress, gboolean is_builtin, GType ancestor_type)
 {
-    GArray         *array = _adg_data_array();
     AdgDressPrivate data;
 
-    data.fallback = fallback;
+    /* Called only while initializing the register, so _adg_data_array()
+     * cannot be used here: it would wait for itself */
+    data.fallback = NULL;
     data.ancestor_type = ancestor_type;
+    data.is_builtin = is_builtin;
 
-    g_array_insert_vals(array, dress, g_memdup(&data, sizeof(data)), 1);
+    g_array_insert_vals(_adg_data, dress, &data, 1);
 }
 
 static void
 _adg_data_register_builtins(void)
 {
-    AdgDash *dash;
-    AdgMarker *arrow1, *arrow2;
-
-    _adg_data_register(ADG_DRESS_UNDEFINED,
-                       NULL,
-                       G_TYPE_INVALID);
+    _adg_data_register(ADG_DRESS_UNDEFINED,             FALSE, G_TYPE_INVALID);
 
 
     /* Predefined colors */
 
-    _adg_data_register(ADG_DRESS_COLOR,
-                       NULL,
-                       ADG_TYPE_COLOR_STYLE);
-
-    _adg_data_register(ADG_DRESS_COLOR_BACKGROUND,
-                       g_object_new(ADG_TYPE_COLOR_STYLE,
-                                    "blue",  1.,
-                                    "green", 1.,
-                                    "red",   1.,
-                                    NULL),
-                       ADG_TYPE_COLOR_STYLE);
-
-    _adg_data_register(ADG_DRESS_COLOR_STROKE,
-                       g_object_new(ADG_TYPE_COLOR_STYLE,
-                                    NULL),
-                       ADG_TYPE_COLOR_STYLE);
-
-    _adg_data_register(ADG_DRESS_COLOR_DIMENSION,
-                       g_object_new(ADG_TYPE_COLOR_STYLE,
-                                    "red",   0.,
-                                    "green", 0.4,
-                                    "blue",  0.6,
-                                    NULL),
-                       ADG_TYPE_COLOR_STYLE);
-
-    _adg_data_register(ADG_DRESS_COLOR_ANNOTATION,
-                       g_object_new(ADG_TYPE_COLOR_STYLE,
-                                    "red",   0.4,
-                                    "green", 0.4,
-                                    "blue",  0.2,
-                                    NULL),
-                       ADG_TYPE_COLOR_STYLE);
-
-    _adg_data_register(ADG_DRESS_COLOR_FILL,
-                       g_object_new(ADG_TYPE_COLOR_STYLE,
-                                    "red",   0.25,
-                                    "green", 0.25,
-                                    "blue",  0.25,
-                                    NULL),
-                       ADG_TYPE_COLOR_STYLE);
-
-    _adg_data_register(ADG_DRESS_COLOR_AXIS,
-                       g_object_new(ADG_TYPE_COLOR_STYLE,
-                                    "red",   0.,
-                                    "green", 0.75,
-                                    "blue",  0.25,
-                                    NULL),
-                       ADG_TYPE_COLOR_STYLE);
-
-    _adg_data_register(ADG_DRESS_COLOR_HIDDEN,
-                       g_object_new(ADG_TYPE_COLOR_STYLE,
-                                    "red",   0.5,
-                                    "green", 0.5,
-                                    "blue",  0.5,
-                                    NULL),
-                       ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR,                 FALSE, ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR_BACKGROUND,      TRUE,  ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR_STROKE,          TRUE,  ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR_DIMENSION,       TRUE,  ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR_ANNOTATION,      TRUE,  ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR_FILL,            TRUE,  ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR_AXIS,            TRUE,  ADG_TYPE_COLOR_STYLE);
+    _adg_data_register(ADG_DRESS_COLOR_HIDDEN,          TRUE,  ADG_TYPE_COLOR_STYLE);
 
 
     /* Predefined lines */
 
-    _adg_data_register(ADG_DRESS_LINE,
-                       NULL,
-                       ADG_TYPE_LINE_STYLE);
-
-    _adg_data_register(ADG_DRESS_LINE_STROKE,
-                       g_object_new(ADG_TYPE_LINE_STYLE,
-                                    "color-dress", ADG_DRESS_COLOR_STROKE,
-                                    "width",       1.5,
-                                    NULL),
-                       ADG_TYPE_LINE_STYLE);
-
-    _adg_data_register(ADG_DRESS_LINE_DIMENSION,
-                       g_object_new(ADG_TYPE_LINE_STYLE,
-                                    "width", 0.5,
-                                    NULL),
-                       ADG_TYPE_LINE_STYLE);
-
-    _adg_data_register(ADG_DRESS_LINE_FILL,
-                       g_object_new(ADG_TYPE_LINE_STYLE,
-                                    "color-dress", ADG_DRESS_COLOR_FILL,
-                                    "width",       0.5,
-                                    NULL),
-                       ADG_TYPE_LINE_STYLE);
-
-    _adg_data_register(ADG_DRESS_LINE_GRID,
-                       g_object_new(ADG_TYPE_LINE_STYLE,
-                                    "antialias", CAIRO_ANTIALIAS_NONE,
-                                    "width",     1.,
-                                    NULL),
-                       ADG_TYPE_LINE_STYLE);
-
-    _adg_data_register(ADG_DRESS_LINE_FRAME,
-                       g_object_new(ADG_TYPE_LINE_STYLE,
-                                    "color-dress", ADG_DRESS_COLOR_ANNOTATION,
-                                    "antialias",   CAIRO_ANTIALIAS_NONE,
-                                    "width",       2.,
-                                    NULL),
-                       ADG_TYPE_LINE_STYLE);
-
-
-    dash = adg_dash_new_with_dashes(4, 2 MM, 2 MM, 10 MM, 2 MM);
-    _adg_data_register(ADG_DRESS_LINE_AXIS,
-                       g_object_new(ADG_TYPE_LINE_STYLE,
-                                    "color-dress", ADG_DRESS_COLOR_AXIS,
-                                    "width",       0.25 MM,
-                                    "dash",        dash,
-                                    NULL),
-                       ADG_TYPE_LINE_STYLE);
-    adg_dash_destroy(dash);
-
-    dash = adg_dash_new_with_dashes(2, 6 MM, 3 MM);
-    _adg_data_register(ADG_DRESS_LINE_HIDDEN,
-                       g_object_new(ADG_TYPE_LINE_STYLE,
-                                    "color-dress", ADG_DRESS_COLOR_HIDDEN,
-                                    "width",       0.25 MM,
-                                    "dash",        dash,
-                                    NULL),
-                       ADG_TYPE_LINE_STYLE);
-    adg_dash_destroy(dash);
+    _adg_data_register(ADG_DRESS_LINE,                  FALSE, ADG_TYPE_LINE_STYLE);
+    _adg_data_register(ADG_DRESS_LINE_STROKE,           TRUE,  ADG_TYPE_LINE_STYLE);
+    _adg_data_register(ADG_DRESS_LINE_DIMENSION,        TRUE,  ADG_TYPE_LINE_STYLE);
+    _adg_data_register(ADG_DRESS_LINE_FILL,             TRUE,  ADG_TYPE_LINE_STYLE);
+    _adg_data_register(ADG_DRESS_LINE_GRID,             TRUE,  ADG_TYPE_LINE_STYLE);
+    _adg_data_register(ADG_DRESS_LINE_FRAME,            TRUE,  ADG_TYPE_LINE_STYLE);
+    _adg_data_register(ADG_DRESS_LINE_AXIS,             TRUE,  ADG_TYPE_LINE_STYLE);
+    _adg_data_register(ADG_DRESS_LINE_HIDDEN,           TRUE,  ADG_TYPE_LINE_STYLE);
 
 
     /* Predefined fonts */
 
-    _adg_data_register(ADG_DRESS_FONT,
-                       g_object_new(ADG_TYPE_BEST_FONT_STYLE,
-                                    "family", "Serif",
-                                    "size",   14.,
-                                    NULL),
-                       ADG_TYPE_BEST_FONT_STYLE);
-
-    _adg_data_register(ADG_DRESS_FONT_TEXT,
-                       g_object_new(ADG_TYPE_BEST_FONT_STYLE,
-                                    "color-dress", ADG_DRESS_COLOR_ANNOTATION,
-                                    "family",      "Sans",
-                                    "weight",      CAIRO_FONT_WEIGHT_BOLD,
-                                    "size",        12.,
-                                    NULL),
-                       ADG_TYPE_BEST_FONT_STYLE);
-
-    _adg_data_register(ADG_DRESS_FONT_ANNOTATION,
-                       g_object_new(ADG_TYPE_BEST_FONT_STYLE,
-                                    "color-dress", ADG_DRESS_COLOR_ANNOTATION,
-                                    "family",      "Sans",
-                                    "size",        8.,
-                                    NULL),
-                       ADG_TYPE_BEST_FONT_STYLE);
-
-    _adg_data_register(ADG_DRESS_FONT_QUOTE_TEXT,
-                       g_object_new(ADG_TYPE_BEST_FONT_STYLE,
-                                    "family", "Sans",
-                                    "weight", CAIRO_FONT_WEIGHT_BOLD,
-                                    "size",   12.,
-                                    NULL),
-                       ADG_TYPE_BEST_FONT_STYLE);
-
-    _adg_data_register(ADG_DRESS_FONT_QUOTE_ANNOTATION,
-                       g_object_new(ADG_TYPE_BEST_FONT_STYLE,
-                                    "family",      "Sans",
-                                    "size",        8.,
-                                    NULL),
-                       ADG_TYPE_BEST_FONT_STYLE);
+    _adg_data_register(ADG_DRESS_FONT,                  TRUE,  ADG_TYPE_BEST_FONT_STYLE);
+    _adg_data_register(ADG_DRESS_FONT_TEXT,             TRUE,  ADG_TYPE_BEST_FONT_STYLE);
+    _adg_data_register(ADG_DRESS_FONT_ANNOTATION,       TRUE,  ADG_TYPE_BEST_FONT_STYLE);
+    _adg_data_register(ADG_DRESS_FONT_QUOTE_TEXT,       TRUE,  ADG_TYPE_BEST_FONT_STYLE);
+    _adg_data_register(ADG_DRESS_FONT_QUOTE_ANNOTATION, TRUE,  ADG_TYPE_BEST_FONT_STYLE);
 
 
     /* Predefined dimension styles */
 
-    arrow1 = (AdgMarker *) adg_arrow_new();
-    arrow2 = (AdgMarker *) adg_arrow_new();
-    adg_marker_set_pos(arrow2, 1);
-    _adg_data_register(ADG_DRESS_DIMENSION,
-                       g_object_new(ADG_TYPE_DIM_STYLE,
-                                    "marker1", arrow1,
-                                    "marker2", arrow2,
-                                    NULL),
-                       ADG_TYPE_DIM_STYLE);
-    g_object_unref(arrow1);
-    g_object_unref(arrow2);
+    _adg_data_register(ADG_DRESS_DIMENSION,             TRUE,  ADG_TYPE_DIM_STYLE);
 
 
     /* Predefined fill styles */
 
-    _adg_data_register(ADG_DRESS_FILL,
-                       NULL,
-                       ADG_TYPE_FILL_STYLE);
-
-    _adg_data_register(ADG_DRESS_FILL_HATCH,
-                       g_object_new(ADG_TYPE_RULED_FILL,
-                                    "line-dress", ADG_DRESS_LINE_FILL,
-                                    NULL),
-                       ADG_TYPE_FILL_STYLE);
+    _adg_data_register(ADG_DRESS_FILL,                  FALSE, ADG_TYPE_FILL_STYLE);
+    _adg_data_register(ADG_DRESS_FILL_HATCH,            TRUE,  ADG_TYPE_FILL_STYLE);
 
 
     /* Predefined table styles */
 
-    _adg_data_register(ADG_DRESS_TABLE,
-                       g_object_new(ADG_TYPE_TABLE_STYLE, NULL),
-                       ADG_TYPE_TABLE_STYLE);
+    _adg_data_register(ADG_DRESS_TABLE,                 TRUE,  ADG_TYPE_TABLE_STYLE);
+}
+
+static AdgStyle *
+_adg_builtin_fallback(AdgDress dress)
+{
+    AdgStyle *style;
+    AdgDash *dash;
+    AdgMarker *arrow1, *arrow2;
+
+    switch (dress) {
+    case ADG_DRESS_COLOR_BACKGROUND:
+        return g_object_new(ADG_TYPE_COLOR_STYLE,
+                            "blue",  1.,
+                            "green", 1.,
+                            "red",   1.,
+                            NULL);
+    case ADG_DRESS_COLOR_STROKE:
+        return g_object_new(ADG_TYPE_COLOR_STYLE,
+                            NULL);
+    case ADG_DRESS_COLOR_DIMENSION:
+        return g_object_new(ADG_TYPE_COLOR_STYLE,
+                            "red",   0.,
+                            "green", 0.4,
+                            "blue",  0.6,
+                            NULL);
+    case ADG_DRESS_COLOR_ANNOTATION:
+        return g_object_new(ADG_TYPE_COLOR_STYLE,
+                            "red",   0.4,
+                            "green", 0.4,
+                            "blue",  0.2,
+                            NULL);
+    case ADG_DRESS_COLOR_FILL:
+        return g_object_new(ADG_TYPE_COLOR_STYLE,
+                            "red",   0.25,
+                            "green", 0.25,
+                            "blue",  0.25,
+                            NULL);
+    case ADG_DRESS_COLOR_AXIS:
+        return g_object_new(ADG_TYPE_COLOR_STYLE,
+                            "red",   0.,
+                            "green", 0.75,
+                            "blue",  0.25,
+                            NULL);
+    case ADG_DRESS_COLOR_HIDDEN:
+        return g_object_new(ADG_TYPE_COLOR_STYLE,
+                            "red",   0.5,
+                            "green", 0.5,
+                            "blue",  0.5,
+                            NULL);
+    case ADG_DRESS_LINE_STROKE:
+        return g_object_new(ADG_TYPE_LINE_STYLE,
+                            "color-dress", ADG_DRESS_COLOR_STROKE,
+                            "width",       1.5,
+                            NULL);
+    case ADG_DRESS_LINE_DIMENSION:
+        return g_object_new(ADG_TYPE_LINE_STYLE,
+                            "width", 0.5,
+                            NULL);
+    case ADG_DRESS_LINE_FILL:
+        return g_object_new(ADG_TYPE_LINE_STYLE,
+                            "color-dress", ADG_DRESS_COLOR_FILL,
+                            "width",       0.5,
+                            NULL);
+    case ADG_DRESS_LINE_GRID:
+        return g_object_new(ADG_TYPE_LINE_STYLE,
+                            "antialias", CAIRO_ANTIALIAS_NONE,
+                            "width",     1.,
+                            NULL);
+    case ADG_DRESS_LINE_FRAME:
+        return g_object_new(ADG_TYPE_LINE_STYLE,
+                            "color-dress", ADG_DRESS_COLOR_ANNOTATION,
+                            "antialias",   CAIRO_ANTIALIAS_NONE,
+                            "width",       2.,
+                            NULL);
+    case ADG_DRESS_LINE_AXIS:
+        dash = adg_dash_new_with_dashes(4, 2 MM, 2 MM, 10 MM, 2 MM);
+        style = g_object_new(ADG_TYPE_LINE_STYLE,
+                             "color-dress", ADG_DRESS_COLOR_AXIS,
+                             "width",       0.25 MM,
+                             "dash",        dash,
+                             NULL);
+        adg_dash_destroy(dash);
+        return style;
+    case ADG_DRESS_LINE_HIDDEN:
+        dash = adg_dash_new_with_dashes(2, 6 MM, 3 MM);
+        style = g_object_new(ADG_TYPE_LINE_STYLE,
+                             "color-dress", ADG_DRESS_COLOR_HIDDEN,
+                             "width",       0.25 MM,
+                             "dash",        dash,
+                             NULL);
+        adg_dash_destroy(dash);
+        return style;
+    case ADG_DRESS_FONT:
+        return g_object_new(ADG_TYPE_BEST_FONT_STYLE,
+                            "family", "Serif",
+                            "size",   14.,
+                            NULL);
+    case ADG_DRESS_FONT_TEXT:
+        return g_object_new(ADG_TYPE_BEST_FONT_STYLE,
+                            "color-dress", ADG_DRESS_COLOR_ANNOTATION,
+                            "family",      "Sans",
+                            "weight",      CAIRO_FONT_WEIGHT_BOLD,
+                            "size",        12.,
+                            NULL);
+    case ADG_DRESS_FONT_ANNOTATION:
+        return g_object_new(ADG_TYPE_BEST_FONT_STYLE,
+                            "color-dress", ADG_DRESS_COLOR_ANNOTATION,
+                            "family",      "Sans",
+                            "size",        8.,
+                            NULL);
+    case ADG_DRESS_FONT_QUOTE_TEXT:
+        return g_object_new(ADG_TYPE_BEST_FONT_STYLE,
+                            "family", "Sans",
+                            "weight", CAIRO_FONT_WEIGHT_BOLD,
+                            "size",   12.,
+                            NULL);
+    case ADG_DRESS_FONT_QUOTE_ANNOTATION:
+        return g_object_new(ADG_TYPE_BEST_FONT_STYLE,
+                            "family",      "Sans",
+                            "size",        8.,
+                            NULL);
+    case ADG_DRESS_DIMENSION:
+        arrow1 = (AdgMarker *) adg_arrow_new();
+        arrow2 = (AdgMarker *) adg_arrow_new();
+        adg_marker_set_pos(arrow2, 1);
+        style = g_object_new(ADG_TYPE_DIM_STYLE,
+                             "marker1", arrow1,
+                             "marker2", arrow2,
+                             NULL);
+        g_object_unref(arrow1);
+        g_object_unref(arrow2);
+        return style;
+    case ADG_DRESS_FILL_HATCH:
+        return g_object_new(ADG_TYPE_RULED_FILL,
+                            "line-dress", ADG_DRESS_LINE_FILL,
+                            NULL);
+    case ADG_DRESS_TABLE:
+        return g_object_new(ADG_TYPE_TABLE_STYLE, NULL);
+    default:
+        return NULL;
+    }
 }
 
 static AdgDressPrivate *
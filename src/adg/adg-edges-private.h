@@ -24,8 +24,17 @@
 
 G_BEGIN_DECLS
 
+typedef struct _AdgEdgesSegment AdgEdgesSegment;
 typedef struct _AdgEdgesPrivate AdgEdgesPrivate;
 
+/* Vertices found on a single segment of the source, kept together
+ * with a copy of the segment data to detect changes */
+struct _AdgEdgesSegment {
+    cairo_path_data_t   *data;
+    gint                 num_data;
+    GArray              *vertices;
+};
+
 struct _AdgEdgesPrivate {
     AdgTrail        *source;
     gdouble          axis_angle;
@@ -35,6 +44,12 @@ struct _AdgEdgesPrivate {
         cairo_path_t path;
         GArray      *array;
     }                cairo;
+
+    GArray          *segments;
+
+    /* Scratch buffers reused by every rebuild of the cairo path */
+    GArray          *vertices;
+    GArray          *order;
 };
 
 G_END_DECLS
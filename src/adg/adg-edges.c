@@ -52,6 +52,7 @@
 #include "adg-model.h"
 #include "adg-trail.h"
 #include <math.h>
+#include <string.h>
 
 #include "adg-edges.h"
 #include "adg-edges-private.h"
@@ -84,13 +85,25 @@ static void             _adg_set_property       (GObject        *object,
                                                  GParamSpec     *pspec);
 static void             _adg_clear              (AdgModel       *model);
 static cairo_path_t *   _adg_get_cairo_path     (AdgTrail       *trail);
+static gboolean         _adg_prepare            (AdgTrail       *trail);
 static void             _adg_unset_source       (AdgEdges       *edges);
 static void             _adg_clear_cairo_path   (AdgEdges       *edges);
-static GSList *         _adg_get_vertices       (GSList         *vertices,
+static void             _adg_clear_segments     (AdgEdges       *edges,
+                                                 guint           from);
+static const GArray *   _adg_segment_vertices   (AdgEdges       *edges,
+                                                 guint           n,
                                                  CpmlSegment    *segment,
                                                  gdouble         threshold);
-static GSList *         _adg_optimize_vertices  (GSList         *vertices);
-static GArray *         _adg_path_build         (const GSList   *vertices);
+static void             _adg_get_vertices       (GArray         *vertices,
+                                                 CpmlSegment    *segment,
+                                                 gdouble         threshold);
+static void             _adg_optimize_vertices  (GArray         *vertices);
+static gint             _adg_compare_vertices   (gconstpointer   a,
+                                                 gconstpointer   b,
+                                                 gpointer        user_data);
+static void             _adg_path_build         (const GArray   *vertices,
+                                                 GArray         *order,
+                                                 GArray         *array);
 static void             _adg_path_transform     (GArray         *path_data,
                                                  const cairo_matrix_t*map);
 
@@ -117,6 +130,7 @@ adg_edges_class_init(AdgEdgesClass *klass)
     model_class->clear = _adg_clear;
 
     trail_class->get_cairo_path = _adg_get_cairo_path;
+    trail_class->prepare = _adg_prepare;
 
     param = g_param_spec_object("source",
                                 P_("Source"),
@@ -151,7 +165,10 @@ adg_edges_init(AdgEdges *edges)
     data->axis_angle = 0;
 
     data->cairo.path.status = CAIRO_STATUS_INVALID_PATH_DATA;
-    data->cairo.array = NULL;
+    data->cairo.array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    data->segments = g_array_new(FALSE, FALSE, sizeof(AdgEdgesSegment));
+    data->vertices = g_array_new(FALSE, FALSE, sizeof(CpmlPair));
+    data->order = g_array_new(FALSE, FALSE, sizeof(guint));
 
     edges->data = data;
 }
@@ -170,7 +187,15 @@ _adg_dispose(GObject *object)
 static void
 _adg_finalize(GObject *object)
 {
-    _adg_clear_cairo_path((AdgEdges *) object);
+    AdgEdges *edges = (AdgEdges *) object;
+    AdgEdgesPrivate *data = edges->data;
+
+    _adg_clear_cairo_path(edges);
+    _adg_clear_segments(edges, 0);
+    g_array_free(data->cairo.array, TRUE);
+    g_array_free(data->segments, TRUE);
+    g_array_free(data->vertices, TRUE);
+    g_array_free(data->order, TRUE);
 
     if (_ADG_OLD_OBJECT_CLASS->finalize != NULL)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
@@ -228,6 +253,7 @@ _adg_set_property(GObject *object, guint prop_id,
                                     (GWeakNotify) _adg_unset_source, object);
         }
 
+        _adg_clear_segments(edges, 0);
         _adg_clear((AdgModel *) object);
         break;
     case PROP_AXIS_ANGLE:
@@ -241,6 +267,7 @@ _adg_set_property(GObject *object, guint prop_id,
         tmp_double = g_value_get_double(value);
         if (data->critical_angle != tmp_double) {
             data->critical_angle = tmp_double;
+            _adg_clear_segments(edges, 0);
             _adg_clear_cairo_path(edges);
         }
         break;
@@ -431,7 +458,7 @@ _adg_get_cairo_path(AdgTrail *trail)
     AdgEdgesPrivate *data;
     gdouble threshold;
     CpmlSegment segment;
-    GSList *vertices;
+    GArray *vertices;
     cairo_matrix_t map;
 
     edges = (AdgEdges *) trail;
@@ -444,7 +471,8 @@ _adg_get_cairo_path(AdgTrail *trail)
     _adg_clear_cairo_path((AdgEdges *) trail);
 
     if (data->source != NULL) {
-        gint n;
+        guint n;
+        const GArray *segment_vertices;
 
         /* The threshold is squared because the _adg_get_vertices()
          * function uses cpml_pair_squared_distance() against the
@@ -452,22 +480,27 @@ _adg_get_cairo_path(AdgTrail *trail)
         threshold = sin(data->critical_angle);
         threshold *= threshold * 2;
 
-        vertices = NULL;
+        /* Only the segments changed since the last call are scanned:
+         * the vertices of the others are taken from the cache */
+        vertices = data->vertices;
+        g_array_set_size(vertices, 0);
         for (n = 1; adg_trail_put_segment(data->source, n, &segment); ++ n) {
-            vertices = _adg_get_vertices(vertices, &segment, threshold);
+            segment_vertices = _adg_segment_vertices(edges, n - 1,
+                                                     &segment, threshold);
+            g_array_append_vals(vertices, segment_vertices->data,
+                                segment_vertices->len);
         }
+        _adg_clear_segments(edges, n - 1);
 
         /* Rotate all the vertices so the axis will always be on y=0:
          * this is mainly needed to not complicate the _adg_path_build()
          * code which assumes the y=0 axis is in effect */
         cairo_matrix_init_rotate(&map, -data->axis_angle);
-        g_slist_foreach(vertices, (GFunc) cpml_pair_transform, &map);
-
-        vertices = _adg_optimize_vertices(vertices);
-        data->cairo.array = _adg_path_build(vertices);
+        cpml_pairs_transform(vertices->len, (CpmlPair *) vertices->data,
+                             (CpmlPair *) vertices->data, &map);
 
-        g_slist_foreach(vertices, (GFunc) g_free, NULL);
-        g_slist_free(vertices);
+        _adg_optimize_vertices(vertices);
+        _adg_path_build(vertices, data->order, data->cairo.array);
 
         /* Reapply the inverse of the previous transformation to
          * move the vertices to their original positions */
@@ -482,11 +515,23 @@ _adg_get_cairo_path(AdgTrail *trail)
     return &data->cairo.path;
 }
 
+static gboolean
+_adg_prepare(AdgTrail *trail)
+{
+    AdgEdgesPrivate *data = ((AdgEdges *) trail)->data;
+
+    /* The source is only read by _adg_get_cairo_path() through its
+     * segments index: once built, it can be shared by more workers.
+     * An empty source would be queried again, so it is not shareable */
+    return data->source == NULL || adg_trail_n_segments(data->source) > 0;
+}
+
 static void
 _adg_unset_source(AdgEdges *edges)
 {
     AdgEdgesPrivate *data = edges->data;
     data->source = NULL;
+    _adg_clear_segments(edges, 0);
 }
 
 static void
@@ -494,33 +539,86 @@ _adg_clear_cairo_path(AdgEdges *edges)
 {
     AdgEdgesPrivate *data = edges->data;
 
-    if (data->cairo.array != NULL) {
-        g_array_free(data->cairo.array, TRUE);
-        data->cairo.array = NULL;
-    }
+    /* Keep the allocated capacity for the next rebuild */
+    g_array_set_size(data->cairo.array, 0);
 
     data->cairo.path.status = CAIRO_STATUS_INVALID_PATH_DATA;
     data->cairo.path.data = NULL;
     data->cairo.path.num_data = 0;
 }
 
+static void
+_adg_clear_segments(AdgEdges *edges, guint from)
+{
+    AdgEdgesPrivate *data;
+    AdgEdgesSegment *edges_segment;
+    guint n;
+
+    data = edges->data;
+
+    for (n = from; n < data->segments->len; ++ n) {
+        edges_segment = &g_array_index(data->segments, AdgEdgesSegment, n);
+        g_free(edges_segment->data);
+        g_array_free(edges_segment->vertices, TRUE);
+    }
+
+    if (from < data->segments->len)
+        g_array_set_size(data->segments, from);
+}
+
+/* Returns the vertices of @segment, that is the @n-th segment of the
+ * source, rescanning it only if it differs from the cached one */
+static const GArray *
+_adg_segment_vertices(AdgEdges *edges, guint n, CpmlSegment *segment,
+                      gdouble threshold)
+{
+    AdgEdgesPrivate *data;
+    AdgEdgesSegment *edges_segment;
+    gsize size;
+
+    data = edges->data;
+    size = sizeof(cairo_path_data_t) * segment->num_data;
+
+    if (n < data->segments->len) {
+        edges_segment = &g_array_index(data->segments, AdgEdgesSegment, n);
+        if (edges_segment->num_data == segment->num_data &&
+            memcmp(edges_segment->data, segment->data, size) == 0)
+            return edges_segment->vertices;
+
+        /* Rescan in place, reusing the buffers of the cached segment */
+        if (edges_segment->num_data != segment->num_data)
+            edges_segment->data = g_realloc(edges_segment->data, size);
+        g_array_set_size(edges_segment->vertices, 0);
+    } else {
+        g_array_set_size(data->segments, n + 1);
+        edges_segment = &g_array_index(data->segments, AdgEdgesSegment, n);
+        edges_segment->data = g_malloc(size);
+        edges_segment->vertices = g_array_new(FALSE, FALSE, sizeof(CpmlPair));
+    }
+
+    memcpy(edges_segment->data, segment->data, size);
+    edges_segment->num_data = segment->num_data;
+    _adg_get_vertices(edges_segment->vertices, segment, threshold);
+
+    return edges_segment->vertices;
+}
+
 /**
  * _adg_get_vertices:
- * @vertices: a #GSList
+ * @vertices: a #GArray of #CpmlPair
  * @segment: a #CpmlSegment
  * @threshold: a theshold value
  *
- * Collects a list of #CpmlPair corners where the angle has a minimum
+ * Collects the #CpmlPair corners where the angle has a minimum
  * threshold incidence of @threshold. The threshold is considered as
  * the squared distance between the two unit vectors, the one before
- * and the one after every corner.
- *
- * Returns: the original #GSList with new vertices appended.
+ * and the one after every corner. The vertices found are appended
+ * to @vertices.
  *
  * Since: 1.0
  **/
-static GSList *
-_adg_get_vertices(GSList *vertices, CpmlSegment *segment, gdouble threshold)
+static void
+_adg_get_vertices(GArray *vertices, CpmlSegment *segment, gdouble threshold)
 {
     CpmlPrimitive primitive;
     CpmlVector old, new;
@@ -543,90 +641,94 @@ _adg_get_vertices(GSList *vertices, CpmlSegment *segment, gdouble threshold)
         if (new.x == 0 ||
             cpml_pair_squared_distance(&old, &new) > threshold) {
             cpml_primitive_put_pair_at(&primitive, 0, &pair);
-            vertices = g_slist_append(vertices, cpml_pair_dup(&pair));
+            g_array_append_val(vertices, pair);
         }
 
         cpml_primitive_put_vector_at(&primitive, 1, &old);
     } while (cpml_primitive_next(&primitive));
-
-    return vertices;
 }
 
-/* Removes adjacent vertices lying on the same edge */
-static GSList *
-_adg_optimize_vertices(GSList *vertices)
+/* Removes adjacent vertices lying on the same edge, preserving
+ * the one with the lowest y, by compacting the array in-place */
+static void
+_adg_optimize_vertices(GArray *vertices)
 {
-    GSList *vertex, *old_vertex;
     CpmlPair *pair, *old_pair;
+    guint n, n_kept;
 
-    /* Check for empty list */
-    if (vertices == NULL)
-        return vertices;
-
-    old_vertex = vertices;
+    /* Check for empty array */
+    if (vertices->len == 0)
+        return;
 
-    while ((vertex = old_vertex->next) != NULL) {
-        pair = vertex->data;
-        old_pair = old_vertex->data;
+    pair = (CpmlPair *) vertices->data;
+    n_kept = 1;
 
-        if (pair->x != old_pair->x) {
-            old_vertex = vertex;
-            continue;
-        }
+    for (n = 1; n < vertices->len; ++ n) {
+        old_pair = &pair[n_kept - 1];
 
-        if (old_pair->y < pair->y) {
-            /* Preserve the old vertex and remove the current one */
-            g_free(pair);
-            vertices = g_slist_delete_link(vertices, vertex);
-        } else {
-            /* Preserve the current vertex and remove the old one */
-            g_free(old_pair);
-            vertices = g_slist_delete_link(vertices, old_vertex);
-            old_vertex = vertex;
+        if (pair[n].x != old_pair->x) {
+            pair[n_kept] = pair[n];
+            ++ n_kept;
+        } else if (old_pair->y >= pair[n].y) {
+            /* Replace the old vertex with the current one */
+            *old_pair = pair[n];
         }
     }
 
-    return vertices;
+    g_array_set_size(vertices, n_kept);
 }
 
-static GArray *
-_adg_path_build(const GSList *vertices)
+/* Sorts the vertex indices by x, keeping the original order
+ * between vertices with the same x */
+static gint
+_adg_compare_vertices(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const CpmlPair *pair = user_data;
+    guint n1 = *(const guint *) a;
+    guint n2 = *(const guint *) b;
+
+    if (pair[n1].x < pair[n2].x)
+        return -1;
+    if (pair[n1].x > pair[n2].x)
+        return 1;
+
+    return n1 < n2 ? -1 : n1 > n2 ? 1 : 0;
+}
+
+static void
+_adg_path_build(const GArray *vertices, GArray *order_array, GArray *array)
 {
     cairo_path_data_t line[4];
-    GArray *array;
-    const GSList *vertex, *vertex2;
-    const CpmlPair *pair, *pair2;
+    const CpmlPair *pair;
+    guint *order;
+    guint n;
 
     line[0].header.type = CPML_MOVE;
     line[0].header.length = 2;
     line[2].header.type = CPML_LINE;
     line[2].header.length = 2;
 
-    array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
-    vertex = vertices;
-
-    while (vertex != NULL) {
-        pair = vertex->data;
-        vertex = vertex->next;
-        vertex2 = vertex;
-
-        while (vertex2 != NULL) {
-            pair2 = vertex2->data;
-
-            if (pair->x == pair2->x) {
-                /* Opposite vertex found: append a line in the path
-                 * and quit from this loop */
-                cpml_pair_to_cairo(pair, &line[1]);
-                cpml_pair_to_cairo(pair2, &line[3]);
-                array = g_array_append_vals(array, line, G_N_ELEMENTS(line));
-                break;
-            }
-
-            vertex2 = vertex2->next;
+    if (vertices->len < 2)
+        return;
+
+    pair = (const CpmlPair *) vertices->data;
+    g_array_set_size(order_array, vertices->len);
+    order = (guint *) order_array->data;
+    for (n = 0; n < vertices->len; ++ n)
+        order[n] = n;
+
+    g_qsort_with_data(order, vertices->len, sizeof(guint),
+                      _adg_compare_vertices, (gpointer) pair);
+
+    /* After sorting, every vertex is immediately followed by the next
+     * vertex with the same x, if any: that is its opposite vertex */
+    for (n = 0; n + 1 < vertices->len; ++ n) {
+        if (pair[order[n]].x == pair[order[n + 1]].x) {
+            cpml_pair_to_cairo(&pair[order[n]], &line[1]);
+            cpml_pair_to_cairo(&pair[order[n + 1]], &line[3]);
+            g_array_append_vals(array, line, G_N_ELEMENTS(line));
         }
     }
-
-    return array;
 }
 
 static void
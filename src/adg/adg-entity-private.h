@@ -25,18 +25,39 @@
 G_BEGIN_DECLS
 
 typedef struct _AdgEntityPrivate AdgEntityPrivate;
+typedef struct _AdgEntityStyle   AdgEntityStyle;
+
+/* Style overrides are usually a handful, so they are stored in
+ * a small array sorted by dress instead of an hash table */
+struct _AdgEntityStyle {
+    AdgDress             dress;
+    AdgStyle            *style;
+};
 
 struct _AdgEntityPrivate {
     gboolean             floating;
+    guint                layer;
+    gboolean             visible;
+    gboolean             keep_layout;
     AdgEntity           *parent;
     cairo_matrix_t       global_map;
     cairo_matrix_t       local_map;
     AdgMix               local_mix;
-    GHashTable          *hash_styles;
+    AdgEntityStyle      *styles;
+    guint                n_styles;
 
+    struct {
+        gint             serial;
+        GPtrArray       *styles;
+    }                    style_cache;
+
+    /* is_shifted is set when the last global change was a pure
+     * translation by shift: the extents are already moved accordingly */
     struct {
         gboolean         is_defined;
         cairo_matrix_t   matrix;
+        gboolean         is_shifted;
+        CpmlPair         shift;
     }                    global;
 
     struct {
@@ -44,9 +65,62 @@ struct _AdgEntityPrivate {
         cairo_matrix_t   matrix;
     }                    local;
 
+    /* local.matrix × global.matrix, refreshed whenever one of them changes */
+    struct {
+        gboolean         is_invertible;
+        cairo_matrix_t   matrix;
+        cairo_matrix_t   inverse;
+    }                    combined;
+
     CpmlExtents          extents;
+    gboolean             arranged;
+    gboolean             arranging;
+
+    struct {
+        gboolean         is_enabled;
+        cairo_surface_t *surface;
+        cairo_matrix_t   ctm;
+        guint32          hidden_layers;
+    }                    recording;
 };
 
+
+/* Unchecked accessors used by the library itself on the hot paths:
+ * no type check is performed, so @entity must be a valid AdgEntity.
+ * The public API keeps its checked counterparts */
+
+static inline const cairo_matrix_t *
+_adg_entity_get_global_matrix(AdgEntity *entity)
+{
+    return &((AdgEntityPrivate *) entity->data)->global.matrix;
+}
+
+static inline const cairo_matrix_t *
+_adg_entity_get_local_matrix(AdgEntity *entity)
+{
+    return &((AdgEntityPrivate *) entity->data)->local.matrix;
+}
+
+static inline const CpmlExtents *
+_adg_entity_get_extents(AdgEntity *entity)
+{
+    return &((AdgEntityPrivate *) entity->data)->extents;
+}
+
+/* A collapsed entity is invisible and does not keep its layout:
+ * it is skipped by the arrange phase and does not contribute
+ * to the extents of its parent */
+static inline gboolean
+_adg_entity_is_collapsed(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = entity->data;
+
+    return ! data->visible && ! data->keep_layout;
+}
+
+void            _adg_entity_teardown            (AdgEntity       *entity);
+void            _adg_entity_update_matrices     (AdgEntity       *entity);
+
 G_END_DECLS
 
 
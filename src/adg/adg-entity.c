@@ -58,6 +58,16 @@
  * @invalidate:     invalidating callback, used to clear the internal cache
  * @arrange:        prepare the layout and fill the extents struct
  * @render:         rendering callback, it must be implemented by every entity
+ * @memory_usage:   returns the bytes used by the entity and by the caches
+ *                  it owns, chaining up to the parent implementation
+ * @trim_caches:    releases the derived data owned by the entity, chaining
+ *                  up to the parent implementation
+ * @geometry_changed: only the coordinates of the referenced points changed,
+ *                  so the cached objects can be kept and updated in place;
+ *                  when not implemented the entity is invalidated
+ * @damage:         called on a toplevel entity just before one of its
+ *                  descendants (or the toplevel itself), specified by
+ *                  source, is going to lose its extents
  *
  * Any entity (if not abstract) must implement at least the @render method.
  * The other signal handlers can be overriden to provide custom behaviors
@@ -66,6 +76,21 @@
  * Since: 1.0
  **/
 
+/**
+ * AdgProfile:
+ * @type:            the entity type
+ * @n_arranges:      number of arrange() calls
+ * @arrange_time:    cumulative time spent arranging, in nanoseconds
+ * @n_renders:       number of render() calls
+ * @render_time:     cumulative time spent rendering, in nanoseconds
+ * @n_invalidations: number of invalidations
+ *
+ * Statistics collected on all the entities of a given type while
+ * profiling. See adg_switch_profiling() for details.
+ *
+ * Since: 1.0
+ **/
+
 /**
  * AdgEntityCallback:
  * @entity: an #AdgEntity
@@ -80,6 +105,8 @@
 
 
 #include "adg-internal.h"
+#include <math.h>
+#include <string.h>
 #if GTK3_ENABLED || GTK2_ENABLED
 #include <gtk/gtk.h>
 #endif
@@ -92,13 +119,26 @@
 #include "adg-style.h"
 #include "adg-model.h"
 #include "adg-point.h"
+#include "adg-textual.h"
 #include "adg-cairo-fallback.h"
+#include "adg-render-context.h"
 
 #include "adg-entity-private.h"
+#include "adg-container-private.h"
+#include "adg-render-context-private.h"
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_entity_parent_class)
 
+/* Maximum scale drift between the recording cache and the
+ * current rendering before a new recording is required */
+#define _ADG_RECORDING_DRIFT   1.5
+#define _ADG_RECORDING_EPSILON 1e-9
+
+/* Level of detail thresholds (in pixels) of the preview quality */
+#define _ADG_PREVIEW_THRESHOLD      1.
+#define _ADG_PREVIEW_TEXT_THRESHOLD 4.
+
 
 G_DEFINE_ABSTRACT_TYPE(AdgEntity, adg_entity, G_TYPE_INITIALLY_UNOWNED)
 
@@ -108,7 +148,11 @@ enum {
     PROP_PARENT,
     PROP_GLOBAL_MAP,
     PROP_LOCAL_MAP,
-    PROP_LOCAL_MIX
+    PROP_LOCAL_MIX,
+    PROP_HAS_RECORDING_CACHE,
+    PROP_LAYER,
+    PROP_VISIBLE,
+    PROP_KEEP_LAYOUT
 };
 
 enum {
@@ -122,7 +166,6 @@ enum {
     LAST_SIGNAL
 };
 
-
 static void             _adg_dispose            (GObject         *object);
 static void             _adg_get_property       (GObject         *object,
                                                  guint            prop_id,
@@ -132,18 +175,132 @@ static void             _adg_set_property       (GObject         *object,
                                                  guint            prop_id,
                                                  const GValue    *value,
                                                  GParamSpec      *pspec);
+static void             _adg_notify             (GObject         *object,
+                                                 GParamSpec      *pspec);
 static void             _adg_destroy            (AdgEntity       *entity);
+static AdgStyle *       _adg_style_override     (AdgEntity       *entity,
+                                                 AdgDress         dress);
+static guint            _adg_style_position     (AdgEntityPrivate *data,
+                                                 AdgDress         dress);
+static void             _adg_clear_styles       (AdgEntity       *entity);
 static void             _adg_set_parent         (AdgEntity       *entity,
                                                  AdgEntity       *parent);
+static void             _adg_set_visible        (AdgEntity       *entity,
+                                                 gboolean         visible);
 static void             _adg_global_changed     (AdgEntity       *entity);
 static void             _adg_local_changed      (AdgEntity       *entity);
+static void             _adg_update_combined    (AdgEntity       *entity);
+static void             _adg_emit_changed       (AdgEntity       *entity,
+                                                 guint            signal);
+static void             _adg_propagate_changed  (AdgEntity       *entity,
+                                                 guint            signal);
 static void             _adg_real_invalidate    (AdgEntity       *entity);
 static void             _adg_real_arrange       (AdgEntity       *entity);
 static void             _adg_real_render        (AdgEntity       *entity,
                                                  cairo_t         *cr);
+static gsize            _adg_memory_usage       (AdgEntity       *entity);
+static void             _adg_trim_caches        (AdgEntity       *entity,
+                                                 AdgTrimLevel     level);
+static void             _adg_unarrange          (AdgEntity       *entity);
+static void             _adg_damage             (AdgEntity       *entity);
+static void             _adg_clear_recording    (AdgEntity       *entity);
+static gboolean         _adg_recording_remap    (AdgEntity       *entity,
+                                                 const cairo_matrix_t *ctm,
+                                                 cairo_matrix_t  *remap);
+static void             _adg_render_tracked     (AdgEntity       *entity,
+                                                 cairo_t         *cr);
+static void             _adg_render_recording   (AdgEntity       *entity,
+                                                 cairo_t         *cr);
+static gboolean         _adg_is_clipped         (AdgEntity       *entity,
+                                                 cairo_t         *cr);
+static gboolean         _adg_is_culled          (AdgEntity       *entity,
+                                                 cairo_t         *cr,
+                                                 const CpmlExtents *region);
+static gboolean         _adg_apply_lod          (AdgEntity       *entity,
+                                                 cairo_t         *cr,
+                                                 AdgRenderContext *context);
+static guint64          _adg_profile_now        (void);
+static void             _adg_profile_update     (AdgEntity       *entity,
+                                                 guint            counter,
+                                                 guint64          elapsed);
+static void             _adg_profile_collect    (gpointer         key,
+                                                 gpointer         value,
+                                                 gpointer         user_data);
+static gint             _adg_profile_compare    (gconstpointer    a,
+                                                 gconstpointer    b);
+static void             _adg_cascade_node_free  (gpointer         data);
+static guint            _adg_cascade_link_hash  (gconstpointer    key);
+static gboolean         _adg_cascade_link_equal (gconstpointer    a,
+                                                 gconstpointer    b);
+static void             _adg_cascade_dump_node  (gpointer         key,
+                                                 gpointer         value,
+                                                 gpointer         user_data);
+static void             _adg_cascade_dump_link  (gpointer         key,
+                                                 gpointer         value,
+                                                 gpointer         user_data);
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
 static gboolean         _adg_show_extents = FALSE;
 
+/* Level of detail rules per entity type: no rules, no checks */
+static GHashTable *     _adg_lod_rules = NULL;
+
+/* Preview renderings are flagged on the cairo context, so they do not
+ * interfere with the renderings performed by other threads */
+static cairo_user_data_key_t _adg_preview_key;
+
+/* Same as above for the state tracking mode */
+static cairo_user_data_key_t _adg_state_tracking_key;
+
+/* Same as above for the mask of the hidden layers */
+static cairo_user_data_key_t _adg_hidden_layers_key;
+
+/* Statistics per entity type, collected only when profiling */
+enum {
+    _ADG_PROFILE_ARRANGE,
+    _ADG_PROFILE_RENDER,
+    _ADG_PROFILE_INVALIDATE
+};
+static gboolean         _adg_profiling = FALSE;
+static GHashTable *     _adg_profiles = NULL;
+G_LOCK_DEFINE_STATIC(_adg_profiles);
+
+/* Invalidation cascades, collected only when tracing: the nodes are
+ * the models and entities involved, keyed by address, while the
+ * links connect a cause to the events it triggered */
+typedef struct {
+    gchar              *label;
+    guint               n_roots;
+    guint               counts[ADG_CASCADE_N_EVENTS];
+} AdgCascadeNode;
+
+typedef struct {
+    gpointer            cause;
+    gpointer            effect;
+    AdgCascadeEvent     event;
+    guint               count;
+} AdgCascadeLink;
+
+static const gchar *    _adg_cascade_names[ADG_CASCADE_N_EVENTS] = {
+    "changed",
+    "geometry-changed",
+    "invalidate",
+    "global-changed",
+    "local-changed"
+};
+static gboolean         _adg_cascade_tracing = FALSE;
+static GHashTable *     _adg_cascade_nodes = NULL;
+static GHashTable *     _adg_cascade_links = NULL;
+static GPtrArray *      _adg_cascade_stack = NULL;
+G_LOCK_DEFINE_STATIC(_adg_cascade);
+
+/* Bumped whenever a style override or a parent relationship changes
+ * anywhere, so every style cache can check if it is still valid */
+static gint             _adg_style_serial = 1;
+
+/* Marker for the dresses not yet resolved in the style cache */
+static gchar            _adg_unresolved;
+G_LOCK_DEFINE_STATIC(_adg_style_cache);
+
 
 static void
 adg_entity_class_init(AdgEntityClass *klass)
@@ -157,9 +314,16 @@ adg_entity_class_init(AdgEntityClass *klass)
 
     g_type_class_add_private(klass, sizeof(AdgEntityPrivate));
 
+    /* Profiling can be enabled without recompiling the application */
+    if (g_getenv("ADG_PROFILING") != NULL)
+        _adg_profiling = TRUE;
+    if (g_getenv("ADG_INVALIDATION_TRACING") != NULL)
+        _adg_cascade_tracing = TRUE;
+
     gobject_class->dispose = _adg_dispose;
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
+    gobject_class->notify = _adg_notify;
 
     klass->destroy = _adg_destroy;
     klass->parent_set = NULL;
@@ -168,6 +332,8 @@ adg_entity_class_init(AdgEntityClass *klass)
     klass->invalidate = NULL;
     klass->arrange= NULL;
     klass->render = NULL;
+    klass->memory_usage = _adg_memory_usage;
+    klass->trim_caches = _adg_trim_caches;
 
     param = g_param_spec_boolean("floating",
                                  P_("Floating Entity"),
@@ -203,6 +369,31 @@ adg_entity_class_init(AdgEntityClass *klass)
                               G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_LOCAL_MIX, param);
 
+    param = g_param_spec_boolean("has-recording-cache",
+                                 P_("Has Recording Cache"),
+                                 P_("If enabled, the rendering of this entity and its children is recorded once and replayed until something changes"),
+                                 FALSE, G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_HAS_RECORDING_CACHE, param);
+
+    param = g_param_spec_uint("layer",
+                              P_("Layer"),
+                              P_("The layer this entity belongs to: hiding a layer hides all its entities and their children"),
+                              0, 31, 0,
+                              G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_LAYER, param);
+
+    param = g_param_spec_boolean("visible",
+                                 P_("Visible"),
+                                 P_("Whether this entity and its children are rendered: hiding an entity preserves all its caches"),
+                                 TRUE, G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_VISIBLE, param);
+
+    param = g_param_spec_boolean("keep-layout",
+                                 P_("Keep Layout"),
+                                 P_("Flag that keeps (TRUE) or drops (FALSE) an invisible entity from the arrange phase and from the extents of its parent"),
+                                 TRUE, G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_KEEP_LAYOUT, param);
+
     /**
      * AdgEntity::destroy:
      * @entity: an #AdgEntity
@@ -335,6 +526,10 @@ adg_entity_class_init(AdgEntityClass *klass)
      * automatically emit #AdgEntity::arrange just before the real
      * rendering on the cairo context.
      *
+     * The rendering is skipped when the extents of @entity do not
+     * intersect the clip region of @cr, so redrawing a small area
+     * (e.g. in an exposed widget) does not traverse the whole tree.
+     *
      * Since: 1.0
      **/
     closure = g_cclosure_new(G_CALLBACK(_adg_real_render), NULL, NULL);
@@ -353,16 +548,33 @@ adg_entity_init(AdgEntity *entity)
                                                          ADG_TYPE_ENTITY,
                                                          AdgEntityPrivate);
     data->floating = FALSE;
+    data->layer = 0;
+    data->visible = TRUE;
+    data->keep_layout = TRUE;
     data->parent = NULL;
     cairo_matrix_init_identity(&data->global_map);
     cairo_matrix_init_identity(&data->local_map);
     data->local_mix = ADG_MIX_ANCESTORS;
-    data->hash_styles = NULL;
+    data->styles = NULL;
+    data->n_styles = 0;
+    data->style_cache.serial = 0;
+    data->style_cache.styles = NULL;
     data->global.is_defined = FALSE;
     adg_matrix_copy(&data->global.matrix, adg_matrix_null());
+    data->global.is_shifted = FALSE;
+    data->global.shift.x = 0;
+    data->global.shift.y = 0;
     data->local.is_defined = FALSE;
     adg_matrix_copy(&data->local.matrix, adg_matrix_null());
+    data->combined.is_invertible = FALSE;
+    adg_matrix_copy(&data->combined.matrix, adg_matrix_null());
+    adg_matrix_copy(&data->combined.inverse, adg_matrix_null());
     data->extents.is_defined = FALSE;
+    data->arranged = FALSE;
+    data->arranging = FALSE;
+    data->recording.is_enabled = FALSE;
+    data->recording.surface = NULL;
+    data->recording.hidden_layers = 0;
 
     entity->data = data;
 }
@@ -377,14 +589,20 @@ _adg_dispose(GObject *object)
     data = entity->data;
 
     /* This call will emit a "notify" signal for parent.
-     * Consequentially, the references to the old parent is dropped. */
-    adg_entity_set_parent(entity, NULL);
+     * Consequentially, the references to the old parent is dropped.
+     * Entities detached by _adg_entity_teardown() skip it */
+    if (data->parent != NULL)
+        adg_entity_set_parent(entity, NULL);
+
+    _adg_clear_styles(entity);
 
-    if (data->hash_styles != NULL) {
-        g_hash_table_destroy(data->hash_styles);
-        data->hash_styles = NULL;
+    if (data->style_cache.styles != NULL) {
+        g_ptr_array_free(data->style_cache.styles, TRUE);
+        data->style_cache.styles = NULL;
     }
 
+    _adg_clear_recording(entity);
+
     if (_ADG_OLD_OBJECT_CLASS->dispose)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
@@ -415,6 +633,18 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_LOCAL_MIX:
         g_value_set_enum(value, data->local_mix);
         break;
+    case PROP_HAS_RECORDING_CACHE:
+        g_value_set_boolean(value, data->recording.is_enabled);
+        break;
+    case PROP_LAYER:
+        g_value_set_uint(value, data->layer);
+        break;
+    case PROP_VISIBLE:
+        g_value_set_boolean(value, data->visible);
+        break;
+    case PROP_KEEP_LAYOUT:
+        g_value_set_boolean(value, data->keep_layout);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -447,12 +677,37 @@ _adg_set_property(GObject *object, guint prop_id,
         data->local_mix = g_value_get_enum(value);
         data->local.is_defined = FALSE;
         break;
+    case PROP_HAS_RECORDING_CACHE:
+        data->recording.is_enabled = g_value_get_boolean(value);
+        _adg_clear_recording((AdgEntity *) object);
+        break;
+    case PROP_LAYER:
+        data->layer = g_value_get_uint(value);
+        break;
+    case PROP_VISIBLE:
+        _adg_set_visible((AdgEntity *) object, g_value_get_boolean(value));
+        break;
+    case PROP_KEEP_LAYOUT:
+        data->keep_layout = g_value_get_boolean(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
     }
 }
 
+static void
+_adg_notify(GObject *object, GParamSpec *pspec)
+{
+    /* Any property change could affect the layout, except the
+     * visibility: _adg_set_visible() already did what is needed */
+    if (pspec->owner_type != ADG_TYPE_ENTITY || pspec->param_id != PROP_VISIBLE)
+        _adg_unarrange((AdgEntity *) object);
+
+    if (_ADG_OLD_OBJECT_CLASS->notify)
+        _ADG_OLD_OBJECT_CLASS->notify(object, pspec);
+}
+
 
 /**
  * adg_switch_extents:
@@ -462,6 +717,11 @@ _adg_set_property(GObject *object, guint prop_id,
  * around every entity to show their extents. Useful for
  * debugging purposes.
  *
+ * This is a process wide setting, ignored by the renderings
+ * performed with an #AdgRenderContext: use
+ * adg_render_context_switch_extents() to show the extents of a
+ * single rendering without affecting the other threads.
+ *
  * Since: 1.0
  **/
 void
@@ -471,297 +731,953 @@ adg_switch_extents(gboolean state)
 }
 
 /**
- * adg_entity_destroy:
- * @entity: an #AdgEntity
+ * adg_switch_profiling:
+ * @state: new profiling state
  *
- * Emits the #AdgEntity::destroy signal on @entity and on all of
- * its children, if any.
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * collection of statistics on the entities. When enabled, every
+ * arrange, render and invalidation is accounted to the type of the
+ * entity, so adg_profiling_report() can show where the time goes.
+ * Profiling is also enabled at startup when the
+ * <envar>ADG_PROFILING</envar> environment variable is set.
+ *
+ * The time spent in containers includes the time spent in their
+ * children. The entities replayed by the render list of #AdgCanvas
+ * are not accounted.
+ *
+ * The renderings performed with an #AdgRenderContext ignore this
+ * setting and follow adg_render_context_switch_profiling() instead.
  *
  * Since: 1.0
  **/
 void
-adg_entity_destroy(AdgEntity *entity)
+adg_switch_profiling(gboolean state)
 {
-    g_return_if_fail(ADG_IS_ENTITY(entity));
-
-    g_signal_emit(entity, _adg_signals[DESTROY], 0);
+    _adg_profiling = state;
 }
 
 /**
- * adg_entity_switch_floating:
- * @entity: an #AdgEntity
- * @new_state: the new floating state
+ * adg_profiling_report:
+ * @n_profiles: (out): where to store the number of profiles
  *
- * Sets or resets the floating state of @entity.
- *
- * By default all entities are not floating. When an entity is "floating", its
- * extents does not concur on increasing the extents of its own container. In
- * other words, during the arrange phase #AdgContainer only considers the
- * non-floating children to compute its extents. In particular, this affects
- * how adg_canvas_autoscale() works: all floating entities are not taken into
- * consideration.
+ * Gets the statistics collected while profiling, one #AdgProfile
+ * for every entity type encountered, sorted by type name. The
+ * times are cumulative and expressed in nanoseconds, although the
+ * timer resolution is usually coarser.
  *
- * A typical example is the title block or any other annotation not dependent
- * from the model for positioning.
+ * Returns: (transfer full) (array length=n_profiles): a newly allocated array of #AdgProfile to be freed with g_free() or <constant>NULL</constant> if no statistics are available.
  *
  * Since: 1.0
  **/
-void
-adg_entity_switch_floating(AdgEntity  *entity, gboolean new_state)
+AdgProfile *
+adg_profiling_report(guint *n_profiles)
 {
-    AdgEntityPrivate *data;
+    GArray *report;
 
-    g_return_if_fail(ADG_IS_ENTITY(entity));
-    g_return_if_fail(adg_is_boolean_value(new_state));
+    g_return_val_if_fail(n_profiles != NULL, NULL);
 
-    data = entity->data;
+    report = g_array_new(FALSE, FALSE, sizeof(AdgProfile));
+
+    G_LOCK(_adg_profiles);
+    if (_adg_profiles != NULL)
+        g_hash_table_foreach(_adg_profiles, _adg_profile_collect, report);
+    G_UNLOCK(_adg_profiles);
+
+    *n_profiles = report->len;
+
+    if (report->len == 0) {
+        g_array_free(report, TRUE);
+        return NULL;
+    }
+
+    g_array_sort(report, _adg_profile_compare);
 
-    data->floating = new_state;
+    return (AdgProfile *) g_array_free(report, FALSE);
 }
 
 /**
- * adg_entity_has_floating:
- * @entity: an #AdgEntity
- *
- * Checks if @entity has the floating state enabled.
- *
- * See adg_entity_switch_floating() for a description of what the floating
- * state is.
+ * adg_profiling_reset:
  *
- * Returns: the current state of the floating flag.
+ * Drops the statistics collected so far while profiling.
  *
  * Since: 1.0
  **/
-gboolean
-adg_entity_has_floating(AdgEntity *entity)
+void
+adg_profiling_reset(void)
 {
-    AdgEntityPrivate *data;
-
-    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
-
-    data = entity->data;
+    G_LOCK(_adg_profiles);
+    if (_adg_profiles != NULL) {
+        g_hash_table_destroy(_adg_profiles);
+        _adg_profiles = NULL;
+    }
+    G_UNLOCK(_adg_profiles);
+}
 
-    return data->floating;
+/**
+ * adg_switch_invalidation_tracing:
+ * @state: new tracing state
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * tracing of the invalidation cascades. When enabled, every
+ * #AdgModel::changed emission and every geometry change, invalidation,
+ * global and local change of an entity is recorded, together with
+ * the event that caused it, if any. Use adg_invalidation_tracing_dump()
+ * to find out why editing a single value rearranges the whole sheet.
+ * Tracing is also enabled at startup when the
+ * <envar>ADG_INVALIDATION_TRACING</envar> environment variable is set.
+ *
+ * The chain of causes is global, so the trace is meaningful only if
+ * a single thread at a time is changing models and entities. The
+ * entities invalidated at the end of a batch of changes (see
+ * adg_model_freeze_changes()) are reported without their cause.
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_invalidation_tracing(gboolean state)
+{
+    _adg_cascade_tracing = state;
 }
 
 /**
- * adg_entity_get_canvas:
- * @entity: an #AdgEntity
+ * adg_invalidation_tracing_dump:
  *
- * Walks on the @entity hierarchy and gets the first parent of @entity,
- * that is the first #AdgCanvas instance. The returned object is
- * owned by @entity and should not be freed or modified.
+ * Dumps the invalidation cascades traced so far as a graph in the
+ * Graphviz DOT language. Every node is a model or an entity, labeled
+ * with its type, its address and how many times every event happened
+ * on it ("roots" counts the events without a traced cause). Every
+ * edge goes from a cause to the event it triggered and is labeled
+ * with the event name and the number of occurrences. Redundant
+ * invalidations show up as edges with high counts or as entities
+ * reached by many paths.
  *
- * Returns: (transfer none): the requested canvas or <constant>NULL</constant> on errors or if there is no #AdgCanvas in the @entity hierarchy.
+ * Addresses are not reference counted, so an address reused by a
+ * new object after a finalization is accounted to the same node.
+ *
+ * Returns: (transfer full): a newly allocated string to be freed with g_free().
  *
  * Since: 1.0
  **/
-AdgCanvas *
-adg_entity_get_canvas(AdgEntity *entity)
+gchar *
+adg_invalidation_tracing_dump(void)
 {
-    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+    GString *dump;
 
-    while (entity) {
-        if (ADG_IS_CANVAS(entity))
-            return (AdgCanvas *) entity;
+    dump = g_string_new("digraph invalidations {\n"
+                        "    node [shape=box];\n");
 
-        entity = adg_entity_get_parent(entity);
+    G_LOCK(_adg_cascade);
+    if (_adg_cascade_nodes != NULL) {
+        g_hash_table_foreach(_adg_cascade_nodes, _adg_cascade_dump_node, dump);
+        g_hash_table_foreach(_adg_cascade_links, _adg_cascade_dump_link, dump);
     }
+    G_UNLOCK(_adg_cascade);
 
-    return NULL;
+    g_string_append(dump, "}\n");
+
+    return g_string_free(dump, FALSE);
 }
 
 /**
- * adg_entity_set_parent:
- * @entity: an #AdgEntity
- * @parent: the parent entity
- *
- * <note><para>
- * This function is only useful in entity implementations.
- * </para></note>
+ * adg_invalidation_tracing_reset:
  *
- * Sets a new parent on @entity. Changing the @parent of an entity
- * emits the #AdgEntity::parent-set signal on it.
+ * Drops the invalidation cascades traced so far.
  *
- * There is no reference management at this level: they should be
- * handled at a higher level, e.g. by #AdgContainer.
+ * Since: 1.0
+ **/
+void
+adg_invalidation_tracing_reset(void)
+{
+    G_LOCK(_adg_cascade);
+    if (_adg_cascade_nodes != NULL) {
+        g_hash_table_destroy(_adg_cascade_nodes);
+        g_hash_table_destroy(_adg_cascade_links);
+        _adg_cascade_nodes = NULL;
+        _adg_cascade_links = NULL;
+    }
+    G_UNLOCK(_adg_cascade);
+}
+
+/**
+ * adg_switch_preview:
+ * @cr:    a #cairo_t
+ * @state: new preview state
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * preview quality on the renderings performed on @cr, e.g. to build
+ * thumbnails. In preview quality the details that cannot be seen at
+ * small sizes are sacrificed for speed:
+ * <itemizedlist>
+ * <listitem>the entities smaller than a pixel and the texts smaller
+ *           than a few pixels are skipped, as if a level of detail
+ *           rule with %ADG_LOD_POLICY_SKIP was set for any type
+ *           without a rule of its own (see adg_set_lod());</listitem>
+ * <listitem>hatches are filled without antialiasing;</listitem>
+ * <listitem>the cells of the tables, the title block included, are
+ *           not rendered: only the frame and the grid are.</listitem>
+ * </itemizedlist>
+ *
+ * The state is bound to @cr, so different threads can render in
+ * preview and full quality at the same time.
  *
  * Since: 1.0
  **/
 void
-adg_entity_set_parent(AdgEntity *entity, AdgEntity *parent)
+adg_switch_preview(cairo_t *cr, gboolean state)
 {
-    g_return_if_fail(ADG_IS_ENTITY(entity));
-    g_object_set(entity, "parent", parent, NULL);
+    g_return_if_fail(cr != NULL);
+
+    cairo_set_user_data(cr, &_adg_preview_key,
+                        state ? GINT_TO_POINTER(1) : NULL, NULL);
 }
 
 /**
- * adg_entity_get_parent:
- * @entity: an #AdgEntity
+ * adg_has_preview:
+ * @cr: a #cairo_t
  *
- * Gets the parent of @entity. The returned object is owned
- * by @entity and should not be freed or modified.
+ * Checks if the renderings on @cr must be performed in preview
+ * quality, either because of adg_switch_preview() or because of
+ * the #AdgRenderContext bound to @cr. See adg_switch_preview() for
+ * details.
  *
- * Returns: (transfer none): the parent entity or <constant>NULL</constant> on errors or if @entity is a toplevel.
+ * Returns: <constant>TRUE</constant> if the preview quality is enabled on @cr, <constant>FALSE</constant> otherwise.
  *
  * Since: 1.0
  **/
-AdgEntity *
-adg_entity_get_parent(AdgEntity *entity)
+gboolean
+adg_has_preview(cairo_t *cr)
 {
-    AdgEntityPrivate *data;
+    AdgRenderContext *context;
 
-    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+    g_return_val_if_fail(cr != NULL, FALSE);
 
-    data = entity->data;
+    if (cairo_get_user_data(cr, &_adg_preview_key) != NULL)
+        return TRUE;
 
-    return data->parent;
+    context = adg_get_render_context(cr);
+    return context != NULL && context->preview;
 }
 
 /**
- * adg_entity_set_global_map:
- * @entity: an #AdgEntity object
- * @map: the new map
- *
- * Sets the new global transformation of @entity to @map:
- * the old map is discarded. If @map is <constant>NULL</constant>,
- * the global map is left unchanged.
+ * adg_switch_state_tracking:
+ * @cr:    a #cairo_t
+ * @state: new state tracking mode
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * state tracking mode on the renderings performed on @cr.
+ *
+ * By default every entity is rendered between a cairo_save() and
+ * cairo_restore() pair. This is cheap on raster surfaces but on the
+ * PDF and PostScript backends every pair is a full copy of the
+ * graphic state and becomes q/Q operators in the output. In state
+ * tracking mode the pair is dropped: the transformation matrix is
+ * reset explicitly after every entity and only the state that the
+ * styles do not set on their own (the antialiasing and the dash
+ * pattern) is reverted, and only if it has been changed. Any other
+ * state is simply overwritten by the next entity when applying its
+ * dresses.
  *
  * Since: 1.0
  **/
 void
-adg_entity_set_global_map(AdgEntity *entity, const cairo_matrix_t *map)
+adg_switch_state_tracking(cairo_t *cr, gboolean state)
 {
-    g_return_if_fail(ADG_IS_ENTITY(entity));
-    g_object_set(entity, "global-map", map, NULL);
+    g_return_if_fail(cr != NULL);
+
+    cairo_set_user_data(cr, &_adg_state_tracking_key,
+                        state ? GINT_TO_POINTER(1) : NULL, NULL);
 }
 
 /**
- * adg_entity_transform_global_map:
- * @entity: an #AdgEntity object
- * @transformation: the transformation to apply
- * @mode: how @transformation should be applied
+ * adg_has_state_tracking:
+ * @cr: a #cairo_t
  *
- * Convenient function to change the global map of @entity by
- * applying @tranformation using the @mode operator. This is
- * logically equivalent to the following:
+ * Checks if the state tracking mode is enabled on @cr, either
+ * because of adg_switch_state_tracking() or because of the
+ * #AdgRenderContext bound to @cr. See adg_switch_state_tracking()
+ * for details.
  *
- * <informalexample><programlisting language="C">
- * cairo_matrix_t map;
- * adg_matrix_copy(&map, adg_entity_get_global_map(entity));
- * adg_matrix_transform(&map, transformation, mode);
- * adg_entity_set_global_map(entity, &map);
- * </programlisting></informalexample>
+ * Returns: <constant>TRUE</constant> if the state tracking mode is enabled on @cr, <constant>FALSE</constant> otherwise.
  *
  * Since: 1.0
  **/
-void
-adg_entity_transform_global_map(AdgEntity *entity,
-                                const cairo_matrix_t *transformation,
-                                AdgTransformMode mode)
+gboolean
+adg_has_state_tracking(cairo_t *cr)
 {
-    AdgEntityPrivate *data;
-    cairo_matrix_t map;
-
-    g_return_if_fail(ADG_IS_ENTITY(entity));
-    g_return_if_fail(transformation != NULL);
+    AdgRenderContext *context;
 
-    data = entity->data;
+    g_return_val_if_fail(cr != NULL, FALSE);
 
-    adg_matrix_copy(&map, &data->global_map);
-    adg_matrix_transform(&map, transformation, mode);
+    if (cairo_get_user_data(cr, &_adg_state_tracking_key) != NULL)
+        return TRUE;
 
-    g_object_set(entity, "global-map", &map, NULL);
+    context = adg_get_render_context(cr);
+    return context != NULL && context->state_tracking;
 }
 
 /**
- * adg_entity_get_global_map:
- * @entity: an #AdgEntity object
+ * adg_set_hidden_layers:
+ * @cr:     a #cairo_t
+ * @layers: the mask of the layers to hide
  *
- * Gets the transformation to be used to compute the global matrix
- * of @entity.
+ * Hides the entities whose #AdgEntity:layer is included in @layers
+ * from the renderings performed on @cr: the layer n is hidden when
+ * the bit (1 << n) is set. The children of a hidden entity are
+ * hidden too, regardless of their own layer.
  *
- * Returns: the requested map or <constant>NULL</constant> on errors.
+ * #AdgCanvas sets this mask by itself while rendering, according to
+ * adg_canvas_set_layer_visible(), so there is usually no need to
+ * call this function directly.
+ *
+ * The mask is bound to @cr, so different threads can render different
+ * layers of the same drawing at the same time.
  *
  * Since: 1.0
  **/
-const cairo_matrix_t *
-adg_entity_get_global_map(AdgEntity *entity)
+void
+adg_set_hidden_layers(cairo_t *cr, guint32 layers)
 {
-    AdgEntityPrivate *data;
-
-    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
-
-    data = entity->data;
+    g_return_if_fail(cr != NULL);
 
-    return &data->global_map;
+    cairo_set_user_data(cr, &_adg_hidden_layers_key,
+                        GUINT_TO_POINTER(layers), NULL);
 }
 
 /**
- * adg_entity_get_global_matrix:
- * @entity: an #AdgEntity object
+ * adg_get_hidden_layers:
+ * @cr: a #cairo_t
  *
- * Gets the current global matrix of @entity. The returned value
- * is owned by @entity and should not be changed or freed.
- *
- * The global matrix is computed in the arrange() phase by
- * combining all the global maps of the @entity hierarchy using
- * the %ADG_MIX_ANCESTORS method.
+ * Gets the mask of the layers hidden from the renderings performed
+ * on @cr. See adg_set_hidden_layers() for details.
  *
- * Returns: the global matrix or <constant>NULL</constant> on errors.
+ * Returns: the mask of the hidden layers, 0 when all the layers are visible.
  *
  * Since: 1.0
  **/
-const cairo_matrix_t *
-adg_entity_get_global_matrix(AdgEntity *entity)
+guint32
+adg_get_hidden_layers(cairo_t *cr)
 {
-    AdgEntityPrivate *data;
-
-    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+    g_return_val_if_fail(cr != NULL, 0);
 
-    data = entity->data;
-
-    return &data->global.matrix;
+    return GPOINTER_TO_UINT(cairo_get_user_data(cr, &_adg_hidden_layers_key));
 }
 
 /**
- * adg_entity_set_local_map:
- * @entity: an #AdgEntity object
- * @map: the new map
- *
- * Sets the new local transformation of @entity to @map:
- * the old map is discarded. If @map is <constant>NULL</constant>,
- * the local map is left unchanged.
+ * adg_set_lod:
+ * @type:      an #AdgEntity derived type
+ * @threshold: the size threshold, in device units (usually pixels)
+ * @policy:    how to render entities below @threshold
+ *
+ * Sets the level of detail rule for the entities of @type and for
+ * the entities derived from @type that do not have a rule of their
+ * own. Whenever the extents of one of that entities, transformed in
+ * device space, are smaller than @threshold in both directions, the
+ * entity is rendered according to @policy instead of as usual.
+ *
+ * This is intended to skip (or replace with a box) the details too
+ * small to be visible, such as tiny texts, markers and hatches at
+ * low zoom levels, that would otherwise dominate the rendering time.
+ * The rules are honored by any rendering, so they apply to both
+ * #AdgGtkArea and the exports of #AdgCanvas. There are no rules by
+ * default.
+ *
+ * Setting a non-positive @threshold removes the rule of @type. A
+ * rule with %ADG_LOD_POLICY_RENDER can be used to exclude a derived
+ * type from the rule of its ancestors.
+ *
+ * The rules are not applied to the entities replayed by the render
+ * list of #AdgCanvas.
  *
  * Since: 1.0
  **/
 void
-adg_entity_set_local_map(AdgEntity *entity, const cairo_matrix_t *map)
+adg_set_lod(GType type, gdouble threshold, AdgLodPolicy policy)
 {
-    g_return_if_fail(ADG_IS_ENTITY(entity));
-    g_object_set(entity, "local-map", map, NULL);
+    g_return_if_fail(g_type_is_a(type, ADG_TYPE_ENTITY));
+
+    _adg_lod_rules_set(&_adg_lod_rules, type, threshold, policy);
 }
 
 /**
- * adg_entity_transform_local_map:
- * @entity: an #AdgEntity object
- * @transformation: the transformation to apply
- * @mode: how @transformation should be applied
+ * adg_get_lod:
+ * @type:      an #AdgEntity derived type
+ * @threshold: (out) (allow-none): where to store the threshold
  *
- * Convenient function to change the local map of @entity by
- * applying @tranformation using the @mode operator. This is
- * logically equivalent to the following:
+ * Gets the level of detail rule applied to the entities of @type,
+ * that is the rule set by adg_set_lod() on @type or on its nearest
+ * ancestor. If no rule is found, @threshold is set to 0.
  *
- * <informalexample><programlisting language="C">
- * cairo_matrix_t map;
- * adg_matrix_copy(&map, adg_entity_get_local_map(entity));
- * adg_matrix_transform(&map, transformation, mode);
- * adg_entity_set_local_map(entity, &map);
- * </programlisting></informalexample>
+ * Returns: the policy to apply or %ADG_LOD_POLICY_RENDER if the entities of @type are always rendered.
  *
  * Since: 1.0
  **/
-void
+AdgLodPolicy
+adg_get_lod(GType type, gdouble *threshold)
+{
+    const AdgLodRule *rule;
+
+    g_return_val_if_fail(g_type_is_a(type, ADG_TYPE_ENTITY),
+                         ADG_LOD_POLICY_RENDER);
+
+    rule = _adg_lod_rules_lookup(_adg_lod_rules, type);
+
+    if (threshold != NULL)
+        *threshold = rule != NULL ? rule->threshold : 0;
+
+    return rule != NULL ? rule->policy : ADG_LOD_POLICY_RENDER;
+}
+
+/**
+ * adg_entity_destroy:
+ * @entity: an #AdgEntity
+ *
+ * Emits the #AdgEntity::destroy signal on @entity and on all of
+ * its children, if any.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_destroy(AdgEntity *entity)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+
+    g_signal_emit(entity, _adg_signals[DESTROY], 0);
+}
+
+/**
+ * _adg_entity_teardown:
+ * @entity: an #AdgEntity
+ *
+ * Destroys @entity as part of the destruction of its whole tree. The
+ * parent is going away too, so @entity is detached without damaging
+ * nor unarranging its ancestors and without emitting the
+ * #AdgEntity::parent-set signal. Furthermore the #AdgEntity::destroy
+ * signal is emitted only when somebody is listening to it: otherwise
+ * the default handler is called directly.
+ *
+ * This is meant to be called by the containers on their children
+ * while being destroyed. The caller is responsible of dropping the
+ * bookkeeping bound to @entity, such as the weak references.
+ *
+ * Since: 1.0
+ **/
+void
+_adg_entity_teardown(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = entity->data;
+
+    data->parent = NULL;
+
+    if (g_signal_has_handler_pending(entity, _adg_signals[DESTROY], 0, FALSE))
+        g_signal_emit(entity, _adg_signals[DESTROY], 0);
+    else
+        ADG_ENTITY_GET_CLASS(entity)->destroy(entity);
+}
+
+/**
+ * _adg_entity_update_matrices:
+ * @entity: an #AdgEntity
+ *
+ * Refreshes the global and local matrices of @entity, if they are
+ * not defined. This is the first step of the arrange phase and it is
+ * exposed separately so incremental arrangers can prepare a container
+ * before arranging its children one at a time.
+ *
+ * Since: 1.0
+ **/
+void
+_adg_entity_update_matrices(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = entity->data;
+
+    /* Update the global matrix, if required */
+    if (!data->global.is_defined) {
+        data->global.is_defined = TRUE;
+        _adg_emit_changed(entity, GLOBAL_CHANGED);
+    }
+
+    /* Update the local matrix, if required */
+    if (!data->local.is_defined) {
+        data->local.is_defined = TRUE;
+        _adg_emit_changed(entity, LOCAL_CHANGED);
+    }
+}
+
+/**
+ * adg_entity_switch_floating:
+ * @entity: an #AdgEntity
+ * @new_state: the new floating state
+ *
+ * Sets or resets the floating state of @entity.
+ *
+ * By default all entities are not floating. When an entity is "floating", its
+ * extents does not concur on increasing the extents of its own container. In
+ * other words, during the arrange phase #AdgContainer only considers the
+ * non-floating children to compute its extents. In particular, this affects
+ * how adg_canvas_autoscale() works: all floating entities are not taken into
+ * consideration.
+ *
+ * A typical example is the title block or any other annotation not dependent
+ * from the model for positioning.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_switch_floating(AdgEntity  *entity, gboolean new_state)
+{
+    AdgEntityPrivate *data;
+
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(adg_is_boolean_value(new_state));
+
+    data = entity->data;
+
+    if (data->floating != new_state) {
+        data->floating = new_state;
+        /* The extents of the parent depend on this flag */
+        _adg_unarrange(entity);
+    }
+}
+
+/**
+ * adg_entity_has_floating:
+ * @entity: an #AdgEntity
+ *
+ * Checks if @entity has the floating state enabled.
+ *
+ * See adg_entity_switch_floating() for a description of what the floating
+ * state is.
+ *
+ * Returns: the current state of the floating flag.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_entity_has_floating(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
+
+    data = entity->data;
+
+    return data->floating;
+}
+
+/**
+ * adg_entity_switch_recording_cache:
+ * @entity: an #AdgEntity
+ * @new_state: the new recording cache state
+ *
+ * Enables or disables the recording cache on @entity.
+ *
+ * When enabled, the rendering of @entity (and of its children, if
+ * any) is captured in a cairo recording surface the first time and
+ * that surface is simply replayed by the following renderings. The
+ * recording is discarded whenever @entity or any of its descendants
+ * changes, in the same way the arrange phase is triggered again, or
+ * when it is rendered with a different transformation matrix. Pure
+ * translations (e.g. panning) and uniform scales up to a factor of
+ * 1.5 in either direction (e.g. zooming the render map of an
+ * AdgGtkArea) do not require a new recording: the old one is
+ * replayed with the proper transformation.
+ *
+ * This is useful for static subtrees with a costly rendering, such
+ * as the title block.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_switch_recording_cache(AdgEntity *entity, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_object_set(entity, "has-recording-cache", new_state, NULL);
+}
+
+/**
+ * adg_entity_has_recording_cache:
+ * @entity: an #AdgEntity
+ *
+ * Checks if @entity has the recording cache enabled. See
+ * adg_entity_switch_recording_cache() for further details.
+ *
+ * Returns: the current state of the recording cache flag.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_entity_has_recording_cache(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
+
+    data = entity->data;
+
+    return data->recording.is_enabled;
+}
+
+/**
+ * adg_entity_set_layer:
+ * @entity: an #AdgEntity
+ * @layer: the new layer, between 0 and 31
+ *
+ * Moves @entity (and its children, if any) to @layer. The layers can
+ * be hidden and shown on a rendering basis, without touching the
+ * entity tree: see adg_canvas_set_layer_visible() and
+ * adg_set_hidden_layers(). By default every entity is in layer 0.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_set_layer(AdgEntity *entity, guint layer)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_object_set(entity, "layer", layer, NULL);
+}
+
+/**
+ * adg_entity_get_layer:
+ * @entity: an #AdgEntity
+ *
+ * Gets the layer of @entity. See adg_entity_set_layer() for details.
+ *
+ * Returns: the layer of @entity or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_entity_get_layer(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), 0);
+
+    data = entity->data;
+
+    return data->layer;
+}
+
+/**
+ * adg_entity_switch_visible:
+ * @entity: an #AdgEntity
+ * @new_state: the new visibility state
+ *
+ * Shows or hides @entity and its children, if any. By default every
+ * entity is visible.
+ *
+ * Unlike removing @entity from its container, hiding it does not
+ * touch the entity tree nor any cache of @entity, so toggling e.g.
+ * construction geometry or alternate views is immediate. By default
+ * a hidden entity is still arranged and concurs on the extents of
+ * its parent, so the layout of the drawing does not change: see
+ * adg_entity_switch_keep_layout() to drop it from the layout too.
+ *
+ * Unlike the layers (see adg_entity_set_layer()), the visibility is
+ * a property of the entity and not of the rendering, so it is
+ * honored by every rendering and exporting.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_switch_visible(AdgEntity *entity, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(adg_is_boolean_value(new_state));
+    g_object_set(entity, "visible", new_state, NULL);
+}
+
+/**
+ * adg_entity_is_visible:
+ * @entity: an #AdgEntity
+ *
+ * Checks if @entity is visible. See adg_entity_switch_visible() for
+ * details. The visibility of the ancestors of @entity is not
+ * considered.
+ *
+ * Returns: <constant>TRUE</constant> if @entity is visible, <constant>FALSE</constant> if it is hidden or on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_entity_is_visible(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
+
+    data = entity->data;
+
+    return data->visible;
+}
+
+/**
+ * adg_entity_switch_keep_layout:
+ * @entity: an #AdgEntity
+ * @new_state: the new keep layout state
+ *
+ * Sets or resets the keep layout state of @entity, relevant only
+ * while @entity is hidden (see adg_entity_switch_visible()).
+ *
+ * By default the keep layout state is enabled, so a hidden entity
+ * is arranged as usual and takes up its space. When disabled, a
+ * hidden entity is excluded from the computation of the extents of
+ * its parent (as it was floating, see adg_entity_switch_floating())
+ * and it is not arranged at all. Its caches are kept anyway: when
+ * shown again, it is arranged only if something changed in the
+ * meantime.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_switch_keep_layout(AdgEntity *entity, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(adg_is_boolean_value(new_state));
+    g_object_set(entity, "keep-layout", new_state, NULL);
+}
+
+/**
+ * adg_entity_has_keep_layout:
+ * @entity: an #AdgEntity
+ *
+ * Checks if @entity has the keep layout state enabled. See
+ * adg_entity_switch_keep_layout() for details.
+ *
+ * Returns: the current state of the keep layout flag.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_entity_has_keep_layout(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
+
+    data = entity->data;
+
+    return data->keep_layout;
+}
+
+/**
+ * adg_entity_get_canvas:
+ * @entity: an #AdgEntity
+ *
+ * Walks on the @entity hierarchy and gets the first parent of @entity,
+ * that is the first #AdgCanvas instance. The returned object is
+ * owned by @entity and should not be freed or modified.
+ *
+ * Returns: (transfer none): the requested canvas or <constant>NULL</constant> on errors or if there is no #AdgCanvas in the @entity hierarchy.
+ *
+ * Since: 1.0
+ **/
+AdgCanvas *
+adg_entity_get_canvas(AdgEntity *entity)
+{
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    while (entity) {
+        if (ADG_IS_CANVAS(entity))
+            return (AdgCanvas *) entity;
+
+        entity = adg_entity_get_parent(entity);
+    }
+
+    return NULL;
+}
+
+/**
+ * adg_entity_set_parent:
+ * @entity: an #AdgEntity
+ * @parent: the parent entity
+ *
+ * <note><para>
+ * This function is only useful in entity implementations.
+ * </para></note>
+ *
+ * Sets a new parent on @entity. Changing the @parent of an entity
+ * emits the #AdgEntity::parent-set signal on it.
+ *
+ * There is no reference management at this level: they should be
+ * handled at a higher level, e.g. by #AdgContainer.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_set_parent(AdgEntity *entity, AdgEntity *parent)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_object_set(entity, "parent", parent, NULL);
+}
+
+/**
+ * adg_entity_get_parent:
+ * @entity: an #AdgEntity
+ *
+ * Gets the parent of @entity. The returned object is owned
+ * by @entity and should not be freed or modified.
+ *
+ * Returns: (transfer none): the parent entity or <constant>NULL</constant> on errors or if @entity is a toplevel.
+ *
+ * Since: 1.0
+ **/
+AdgEntity *
+adg_entity_get_parent(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    data = entity->data;
+
+    return data->parent;
+}
+
+/**
+ * adg_entity_set_global_map:
+ * @entity: an #AdgEntity object
+ * @map: the new map
+ *
+ * Sets the new global transformation of @entity to @map:
+ * the old map is discarded. If @map is <constant>NULL</constant>,
+ * the global map is left unchanged.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_set_global_map(AdgEntity *entity, const cairo_matrix_t *map)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_object_set(entity, "global-map", map, NULL);
+}
+
+/**
+ * adg_entity_transform_global_map:
+ * @entity: an #AdgEntity object
+ * @transformation: the transformation to apply
+ * @mode: how @transformation should be applied
+ *
+ * Convenient function to change the global map of @entity by
+ * applying @tranformation using the @mode operator. This is
+ * logically equivalent to the following:
+ *
+ * <informalexample><programlisting language="C">
+ * cairo_matrix_t map;
+ * adg_matrix_copy(&map, adg_entity_get_global_map(entity));
+ * adg_matrix_transform(&map, transformation, mode);
+ * adg_entity_set_global_map(entity, &map);
+ * </programlisting></informalexample>
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_transform_global_map(AdgEntity *entity,
+                                const cairo_matrix_t *transformation,
+                                AdgTransformMode mode)
+{
+    AdgEntityPrivate *data;
+    cairo_matrix_t map;
+
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(transformation != NULL);
+
+    data = entity->data;
+
+    adg_matrix_copy(&map, &data->global_map);
+    adg_matrix_transform(&map, transformation, mode);
+
+    g_object_set(entity, "global-map", &map, NULL);
+}
+
+/**
+ * adg_entity_get_global_map:
+ * @entity: an #AdgEntity object
+ *
+ * Gets the transformation to be used to compute the global matrix
+ * of @entity.
+ *
+ * Returns: the requested map or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+const cairo_matrix_t *
+adg_entity_get_global_map(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    data = entity->data;
+
+    return &data->global_map;
+}
+
+/**
+ * adg_entity_get_global_matrix:
+ * @entity: an #AdgEntity object
+ *
+ * Gets the current global matrix of @entity. The returned value
+ * is owned by @entity and should not be changed or freed.
+ *
+ * The global matrix is computed in the arrange() phase by
+ * combining all the global maps of the @entity hierarchy using
+ * the %ADG_MIX_ANCESTORS method.
+ *
+ * Returns: the global matrix or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+const cairo_matrix_t *
+adg_entity_get_global_matrix(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    data = entity->data;
+
+    return &data->global.matrix;
+}
+
+/**
+ * adg_entity_set_local_map:
+ * @entity: an #AdgEntity object
+ * @map: the new map
+ *
+ * Sets the new local transformation of @entity to @map:
+ * the old map is discarded. If @map is <constant>NULL</constant>,
+ * the local map is left unchanged.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_set_local_map(AdgEntity *entity, const cairo_matrix_t *map)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_object_set(entity, "local-map", map, NULL);
+}
+
+/**
+ * adg_entity_transform_local_map:
+ * @entity: an #AdgEntity object
+ * @transformation: the transformation to apply
+ * @mode: how @transformation should be applied
+ *
+ * Convenient function to change the local map of @entity by
+ * applying @tranformation using the @mode operator. This is
+ * logically equivalent to the following:
+ *
+ * <informalexample><programlisting language="C">
+ * cairo_matrix_t map;
+ * adg_matrix_copy(&map, adg_entity_get_local_map(entity));
+ * adg_matrix_transform(&map, transformation, mode);
+ * adg_entity_set_local_map(entity, &map);
+ * </programlisting></informalexample>
+ *
+ * Since: 1.0
+ **/
+void
 adg_entity_transform_local_map(AdgEntity *entity,
                                const cairo_matrix_t *transformation,
                                AdgTransformMode mode)
@@ -829,6 +1745,62 @@ adg_entity_get_local_matrix(AdgEntity *entity)
     return &data->local.matrix;
 }
 
+/**
+ * adg_entity_get_combined_matrix:
+ * @entity: an #AdgEntity object
+ *
+ * Gets the local matrix of @entity already combined with its global
+ * matrix, that is the transformation from the entity (model) space
+ * to the canvas space. This is what the entities usually apply
+ * before appending their paths, so a single cairo_transform() call
+ * is required instead of two. The returned value is owned by
+ * @entity and should not be changed or freed.
+ *
+ * The combined matrix is cached and it is refreshed whenever
+ * the global or the local matrix changes.
+ *
+ * Returns: the combined matrix or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+const cairo_matrix_t *
+adg_entity_get_combined_matrix(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    data = entity->data;
+
+    return &data->combined.matrix;
+}
+
+/**
+ * adg_entity_get_inverse_matrix:
+ * @entity: an #AdgEntity object
+ *
+ * Gets the inverse of the combined matrix of @entity (see
+ * adg_entity_get_combined_matrix()), useful to bring points
+ * from the canvas space back to the entity space, e.g. for hit
+ * testing. The returned value is owned by @entity and should not
+ * be changed or freed.
+ *
+ * Returns: the inverse matrix or <constant>NULL</constant> if the combined matrix is not invertible or on errors.
+ *
+ * Since: 1.0
+ **/
+const cairo_matrix_t *
+adg_entity_get_inverse_matrix(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    data = entity->data;
+
+    return data->combined.is_invertible ? &data->combined.inverse : NULL;
+}
+
 /**
  * adg_entity_set_local_mix:
  * @entity: an #AdgEntity object
@@ -957,28 +1929,32 @@ void
 adg_entity_set_style(AdgEntity *entity, AdgDress dress, AdgStyle *style)
 {
     AdgEntityPrivate *data;
-    gpointer p_dress;
+    AdgEntityStyle *item;
     AdgStyle *old_style;
+    guint n;
 
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
     data = entity->data;
+    n = _adg_style_position(data, dress);
+    item = NULL;
+    old_style = NULL;
 
-    if (data->hash_styles == NULL && style == NULL)
-        return;
-
-    if (data->hash_styles == NULL)
-        data->hash_styles = g_hash_table_new_full(NULL, NULL,
-                                                  NULL, g_object_unref);
-
-    p_dress = GINT_TO_POINTER(dress);
-    old_style = g_hash_table_lookup(data->hash_styles, p_dress);
+    if (n < data->n_styles && data->styles[n].dress == dress) {
+        item = data->styles + n;
+        old_style = item->style;
+    }
 
     if (style == old_style)
         return;
 
+    _adg_unarrange(entity);
+
     if (style == NULL) {
-        g_hash_table_remove(data->hash_styles, p_dress);
+        g_object_unref(old_style);
+        -- data->n_styles;
+        memmove(item, item + 1, (data->n_styles - n) * sizeof(AdgEntityStyle));
+        g_atomic_int_inc(&_adg_style_serial);
         return;
     }
 
@@ -993,7 +1969,20 @@ adg_entity_set_style(AdgEntity *entity, AdgDress dress, AdgStyle *style)
     }
 
     g_object_ref(style);
-    g_hash_table_replace(data->hash_styles, p_dress, style);
+
+    if (old_style != NULL) {
+        g_object_unref(old_style);
+    } else {
+        /* Make room for the new override, keeping the array sorted */
+        data->styles = g_renew(AdgEntityStyle, data->styles, data->n_styles + 1);
+        item = data->styles + n;
+        memmove(item + 1, item, (data->n_styles - n) * sizeof(AdgEntityStyle));
+        item->dress = dress;
+        ++ data->n_styles;
+    }
+
+    item->style = style;
+    g_atomic_int_inc(&_adg_style_serial);
 }
 
 /**
@@ -1014,15 +2003,17 @@ AdgStyle *
 adg_entity_get_style(AdgEntity *entity, AdgDress dress)
 {
     AdgEntityPrivate *data;
+    guint n;
 
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
     data = entity->data;
+    n = _adg_style_position(data, dress);
 
-    if (data->hash_styles == NULL)
-        return NULL;
+    if (n < data->n_styles && data->styles[n].dress == dress)
+        return data->styles[n].style;
 
-    return g_hash_table_lookup(data->hash_styles, GINT_TO_POINTER(dress));
+    return NULL;
 }
 
 /**
@@ -1044,6 +2035,10 @@ adg_entity_get_style(AdgEntity *entity, AdgDress dress)
  * <listitem>returns the main style with adg_dress_get_fallback().</listitem>
  * </orderedlist>
  *
+ * The result of the first two checks is cached by @entity, so
+ * subsequent calls are resolved with a single array lookup until
+ * a style override or a parent is changed.
+ *
  * The returned object is owned by @entity and should not be
  * freed or modified.
  *
@@ -1058,16 +2053,16 @@ adg_entity_style(AdgEntity *entity, AdgDress dress)
 
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
-    style = adg_entity_get_style(entity, dress);
-
-    if (style == NULL) {
-        AdgEntityPrivate *data = entity->data;
+    /* The caches of the ancestors are shared by all their children,
+     * that can be arranged on different threads */
+    G_LOCK(_adg_style_cache);
+    style = _adg_style_override(entity, dress);
+    G_UNLOCK(_adg_style_cache);
 
-        if (data->parent != NULL)
-            style = adg_entity_style(data->parent, dress);
-        else
-            style = adg_dress_get_fallback(dress);
-    }
+    /* The fallback is not cached because it can be changed at any
+     * time by adg_dress_set_fallback(), and it is cheap anyway */
+    if (style == NULL)
+        style = adg_dress_get_fallback(dress);
 
     return style;
 }
@@ -1104,6 +2099,12 @@ adg_entity_apply_dress(AdgEntity *entity, AdgDress dress, cairo_t *cr)
  * Emits the #AdgEntity::global-changed signal on @entity and on all of
  * its children, if any.
  *
+ * The hierarchy is visited breadth-first without recursion, so every
+ * parent is updated before its children. The signal is really emitted
+ * only on the entities with a handler connected to it: on the others
+ * the class handler is called directly, skipping the #GSignal
+ * machinery.
+ *
  * Since: 1.0
  **/
 void
@@ -1111,7 +2112,7 @@ adg_entity_global_changed(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[GLOBAL_CHANGED], 0);
+    _adg_propagate_changed(entity, GLOBAL_CHANGED);
 }
 
 /**
@@ -1119,7 +2120,8 @@ adg_entity_global_changed(AdgEntity *entity)
  * @entity: an #AdgEntity
  *
  * Emits the #AdgEntity::local-changed signal on @entity and on all of
- * its children, if any.
+ * its children, if any. The same considerations of
+ * adg_entity_global_changed() apply.
  *
  * Since: 1.0
  **/
@@ -1128,7 +2130,7 @@ adg_entity_local_changed(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[LOCAL_CHANGED], 0);
+    _adg_propagate_changed(entity, LOCAL_CHANGED);
 }
 
 /**
@@ -1138,7 +2140,8 @@ adg_entity_local_changed(AdgEntity *entity)
  * Emits the #AdgEntity::invalidate signal on @entity and on all of
  * its children, if any, clearing the eventual cache stored by the
  * #AdgEntity::arrange signal and setting the entity state similary
- * to the just initialized entity.
+ * to the just initialized entity. The emission is bypassed when
+ * nobody is listening, as explained in adg_entity_arrange().
  *
  * Since: 1.0
  **/
@@ -1147,7 +2150,10 @@ adg_entity_invalidate(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[INVALIDATE], 0);
+    if (g_signal_has_handler_pending(entity, _adg_signals[INVALIDATE], 0, FALSE))
+        g_signal_emit(entity, _adg_signals[INVALIDATE], 0);
+    else
+        _adg_real_invalidate(entity);
 }
 
 /**
@@ -1158,6 +2164,15 @@ adg_entity_invalidate(AdgEntity *entity)
  * if any. The arrange call is implicitely called by the
  * #AdgEntity::render signal but not by adg_entity_get_extents().
  *
+ * When no handler is connected to #AdgEntity::arrange, the default
+ * handler is called directly to avoid the cost of a #GSignal emission,
+ * so the signal is really emitted only if someone is listening.
+ *
+ * The arrange phase is skipped if nothing changed since the last
+ * arrange, that is if neither @entity nor any of its descendants
+ * has been invalidated, has changed its global or local matrix,
+ * its styles or whatever property.
+ *
  * Since: 1.0
  **/
 void
@@ -1165,7 +2180,10 @@ adg_entity_arrange(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[ARRANGE], 0);
+    if (g_signal_has_handler_pending(entity, _adg_signals[ARRANGE], 0, FALSE))
+        g_signal_emit(entity, _adg_signals[ARRANGE], 0);
+    else
+        _adg_real_arrange(entity);
 }
 
 /**
@@ -1175,6 +2193,8 @@ adg_entity_arrange(AdgEntity *entity)
  *
  * Emits the #AdgEntity::render signal on @entity and on all of its
  * children, if any, causing the rendering to the @cr cairo context.
+ * Like adg_entity_arrange(), the emission is skipped in favor of a
+ * direct call when no handler is connected.
  *
  * Since: 1.0
  **/
@@ -1183,7 +2203,45 @@ adg_entity_render(AdgEntity *entity, cairo_t *cr)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[RENDER], 0, cr);
+    if (g_signal_has_handler_pending(entity, _adg_signals[RENDER], 0, FALSE))
+        g_signal_emit(entity, _adg_signals[RENDER], 0, cr);
+    else
+        _adg_real_render(entity, cr);
+}
+
+/**
+ * adg_entity_render_with_context:
+ * @entity:  an #AdgEntity
+ * @cr:      a #cairo_t drawing context
+ * @context: (allow-none): the options of this rendering
+ *
+ * Renders @entity on @cr, as adg_entity_render() does, using the
+ * options of @context instead of the global ones. @context is bound
+ * to @cr only for the duration of the call: the previously bound
+ * context, if any, is restored afterward. Pass
+ * <constant>NULL</constant> to render with the global settings.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_render_with_context(AdgEntity *entity, cairo_t *cr,
+                               AdgRenderContext *context)
+{
+    AdgRenderContext *old_context;
+
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(cr != NULL);
+
+    old_context = adg_get_render_context(cr);
+    if (old_context != NULL)
+        adg_render_context_ref(old_context);
+
+    adg_set_render_context(cr, context);
+    adg_entity_render(entity, cr);
+    adg_set_render_context(cr, old_context);
+
+    if (old_context != NULL)
+        adg_render_context_unref(old_context);
 }
 
 /**
@@ -1205,7 +2263,9 @@ adg_entity_render(AdgEntity *entity, cairo_t *cr)
  * </programlisting></informalexample>
  *
  * This function takes care of the dependencies between @entity and
- * the eventual models bound to the old and new points.
+ * the eventual models bound to the old and new points. The dependencies
+ * are added with adg_model_add_named_dependency(), so @entity will be
+ * invalidated only when the named pairs it uses change.
  *
  * @old_point can be <constant>NULL</constant>, in which case a
  * clone of @new_point will be returned. Also @new_point can
@@ -1231,31 +2291,220 @@ adg_entity_point(AdgEntity *entity, AdgPoint *old_point, const AdgPoint *new_poi
         old_model = old_point != NULL ? adg_point_get_model(old_point) : NULL;
         new_model = new_point != NULL ? adg_point_get_model(new_point) : NULL;
 
-        if (new_model != old_model) {
-            /* Handle model-entity dependencies */
-            if (new_model != NULL)
-                adg_model_add_dependency(new_model, entity);
-            if (old_model != NULL)
-                adg_model_remove_dependency(old_model, entity);
-        }
+        /* Handle model-entity dependencies: they are bound to the
+         * named pair, so the entity is invalidated only when that
+         * specific pair changes. The new dependency is added before
+         * removing the old one to avoid dropping the last reference */
+        if (new_model != NULL)
+            adg_model_add_named_dependency(new_model, entity,
+                                           adg_point_get_name(new_point));
+        if (old_model != NULL)
+            adg_model_remove_named_dependency(old_model, entity,
+                                              adg_point_get_name(old_point));
+
+        if (new_point != NULL)
+            point = adg_point_dup(new_point);
+        if (old_point != NULL)
+            adg_point_destroy(old_point);
+    }
+
+    return point;
+}
+
+/**
+ * adg_entity_get_memory_usage:
+ * @entity: an #AdgEntity
+ *
+ * Estimates the memory used by @entity: this includes the instance and
+ * private data and the derived data cached by the implementation, such
+ * as the cairo paths, the glyphs and the text layouts. Containers add
+ * the memory used by their children, so calling this function on a
+ * canvas returns the footprint of the whole drawing.
+ *
+ * Shared resources, such as the models referenced by #AdgStroke or the
+ * styles, are not included. Also the memory allocated inside third
+ * party libraries (e.g. the internals of cairo recording surfaces) is
+ * either estimated or ignored, so the returned value should be used
+ * to compare entities rather than as an exact measure.
+ *
+ * Returns: the estimated number of bytes used by @entity.
+ *
+ * Since: 1.0
+ **/
+gsize
+adg_entity_get_memory_usage(AdgEntity *entity)
+{
+    AdgEntityClass *klass;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), 0);
+
+    klass = ADG_ENTITY_GET_CLASS(entity);
+    if (klass->memory_usage == NULL)
+        return 0;
+
+    return klass->memory_usage(entity);
+}
+
+/**
+ * adg_entity_geometry_changed:
+ * @entity: an #AdgEntity
+ *
+ * Notifies @entity that only the coordinates of the points it
+ * references have changed, while its structure is unaffected. This is
+ * what happens when a named pair used by @entity is moved, and in fact
+ * it is called by #AdgModel on the dependencies bound to named pairs.
+ *
+ * Entities implementing the geometry_changed() method (such as the
+ * dimensions) keep their trails, markers and quote texts and just
+ * recompute the coordinates on the next arrange. Any other entity is
+ * simply invalidated with adg_entity_invalidate().
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_geometry_changed(AdgEntity *entity)
+{
+    AdgEntityClass *klass;
+    AdgEntityPrivate *data;
+    gboolean traced;
+
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+
+    traced = _adg_cascade_enter(entity, ADG_CASCADE_GEOMETRY_CHANGED);
+    klass = ADG_ENTITY_GET_CLASS(entity);
+
+    if (klass->geometry_changed == NULL) {
+        adg_entity_invalidate(entity);
+    } else {
+        _adg_damage(entity);
+        klass->geometry_changed(entity);
+
+        data = entity->data;
+        data->extents.is_defined = FALSE;
+        _adg_unarrange(entity);
+    }
+
+    if (traced)
+        _adg_cascade_leave();
+}
+
+/**
+ * adg_entity_trim_caches:
+ * @entity: an #AdgEntity
+ * @level: (type AdgTrimLevel): how much data must be released
+ *
+ * Releases the data derived by @entity and by its descendants that can
+ * be computed again on demand. Unlike adg_entity_invalidate(), with
+ * %ADG_TRIM_LEVEL_RENDER the arrange results are kept, so the next
+ * rendering only rebuilds what has been dropped. %ADG_TRIM_LEVEL_ARRANGE
+ * releases also the arrange results.
+ *
+ * The models and the styles are not touched: this is meant to shrink
+ * idle drawings for memory pressure, without altering their content.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_trim_caches(AdgEntity *entity, AdgTrimLevel level)
+{
+    AdgEntityClass *klass;
+
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(adg_is_enum_value(level, ADG_TYPE_TRIM_LEVEL));
+
+    klass = ADG_ENTITY_GET_CLASS(entity);
+    if (klass->trim_caches != NULL)
+        klass->trim_caches(entity, level);
+}
+
+
+static void
+_adg_destroy(AdgEntity *entity)
+{
+    GObject *object = (GObject *) entity;
+
+    g_object_run_dispose(object);
+    g_object_unref(object);
+}
+
+/* Returns the style overriding @dress on @entity or on any of its
+ * ancestors, or NULL if the fallback style should be used */
+static AdgStyle *
+_adg_style_override(AdgEntity *entity, AdgDress dress)
+{
+    AdgEntityPrivate *data;
+    GPtrArray *styles;
+    AdgStyle *style;
+    gint serial;
+
+    data = entity->data;
+
+    if (dress < 0) {
+        style = adg_entity_get_style(entity, dress);
+        if (style == NULL && data->parent != NULL)
+            style = _adg_style_override(data->parent, dress);
+        return style;
+    }
+
+    if (data->style_cache.styles == NULL)
+        data->style_cache.styles = g_ptr_array_new();
+
+    styles = data->style_cache.styles;
 
-        if (new_point != NULL)
-            point = adg_point_dup(new_point);
-        if (old_point != NULL)
-            adg_point_destroy(old_point);
+    /* Flush the cache if something changed after it was filled */
+    serial = g_atomic_int_get(&_adg_style_serial);
+    if (data->style_cache.serial != serial) {
+        g_ptr_array_set_size(styles, 0);
+        data->style_cache.serial = serial;
     }
 
-    return point;
+    while (styles->len <= (guint) dress)
+        g_ptr_array_add(styles, &_adg_unresolved);
+
+    style = g_ptr_array_index(styles, dress);
+    if (style != (gpointer) &_adg_unresolved)
+        return style;
+
+    style = adg_entity_get_style(entity, dress);
+    if (style == NULL && data->parent != NULL)
+        style = _adg_style_override(data->parent, dress);
+
+    g_ptr_array_index(styles, dress) = style;
+    return style;
 }
 
+/* Returns the position of @dress in the style overrides array
+ * or the position where it should be inserted if not found */
+static guint
+_adg_style_position(AdgEntityPrivate *data, AdgDress dress)
+{
+    guint n;
+
+    for (n = 0; n < data->n_styles; ++ n)
+        if (data->styles[n].dress >= dress)
+            break;
+
+    return n;
+}
 
 static void
-_adg_destroy(AdgEntity *entity)
+_adg_clear_styles(AdgEntity *entity)
 {
-    GObject *object = (GObject *) entity;
+    AdgEntityPrivate *data;
+    guint n;
 
-    g_object_run_dispose(object);
-    g_object_unref(object);
+    data = entity->data;
+
+    if (data->styles == NULL)
+        return;
+
+    for (n = 0; n < data->n_styles; ++ n)
+        g_object_unref(data->styles[n].style);
+
+    g_free(data->styles);
+    data->styles = NULL;
+    data->n_styles = 0;
+    g_atomic_int_inc(&_adg_style_serial);
 }
 
 static void
@@ -1267,30 +2516,100 @@ _adg_set_parent(AdgEntity *entity, AdgEntity *parent)
     data = entity->data;
     old_parent = data->parent;
 
+    /* Both the old and the new parent must be arranged again */
+    if (old_parent != NULL) {
+        _adg_damage(entity);
+        _adg_unarrange(old_parent);
+    }
+
     data->parent = parent;
     data->global.is_defined = FALSE;
+    g_atomic_int_inc(&_adg_style_serial);
     data->local.is_defined = FALSE;
 
+    _adg_unarrange(entity);
+
+    if (parent != NULL)
+        _adg_damage(entity);
+
     g_signal_emit(entity, _adg_signals[PARENT_SET], 0, old_parent);
 }
 
+static void
+_adg_set_visible(AdgEntity *entity, gboolean visible)
+{
+    AdgEntityPrivate *data;
+    AdgEntity *parent;
+
+    data = entity->data;
+
+    if (data->visible == visible)
+        return;
+
+    /* Hiding or showing damages the same region */
+    _adg_damage(entity);
+    data->visible = visible;
+    parent = data->parent;
+
+    if (data->keep_layout || parent == NULL) {
+        /* The layout does not change: only the recordings replayed
+         * by the ancestors are stale */
+        while (parent != NULL) {
+            _adg_clear_recording(parent);
+            parent = ((AdgEntityPrivate *) parent->data)->parent;
+        }
+    } else {
+        /* The extents of the parent change but the caches of entity
+         * are kept, so it will not be arranged again when shown */
+        if (ADG_IS_CONTAINER(parent))
+            _adg_container_mark_dirty((AdgContainer *) parent, entity);
+        _adg_unarrange(parent);
+    }
+}
+
 static void
 _adg_global_changed(AdgEntity *entity)
 {
     AdgEntityPrivate *data;
     const cairo_matrix_t *map;
-    cairo_matrix_t *matrix;
+    cairo_matrix_t *matrix, old_matrix;
+    CpmlExtents *extents;
 
     data = entity->data;
     map = &data->global_map;
     matrix = &data->global.matrix;
+    extents = &data->extents;
+
+    _adg_unarrange(entity);
+    adg_matrix_copy(&old_matrix, matrix);
 
     if (data->parent) {
-        adg_matrix_copy(matrix, adg_entity_get_global_matrix(data->parent));
+        adg_matrix_copy(matrix, _adg_entity_get_global_matrix(data->parent));
         adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
     } else {
         adg_matrix_copy(matrix, map);
     }
+
+    _adg_update_combined(entity);
+
+    /* A translation (e.g. panning or placing the title block) moves
+     * the extents without changing their shape: subclasses can check
+     * global.is_shifted to keep their caches instead of rebuilding */
+    data->global.is_shifted = extents->is_defined &&
+                              matrix->xx == old_matrix.xx &&
+                              matrix->yx == old_matrix.yx &&
+                              matrix->xy == old_matrix.xy &&
+                              matrix->yy == old_matrix.yy;
+
+    if (data->global.is_shifted) {
+        data->global.shift.x = matrix->x0 - old_matrix.x0;
+        data->global.shift.y = matrix->y0 - old_matrix.y0;
+
+        /* Track the old position before moving */
+        _adg_damage(entity);
+        extents->org.x += data->global.shift.x;
+        extents->org.y += data->global.shift.y;
+    }
 }
 
 static void
@@ -1303,6 +2622,9 @@ _adg_local_changed(AdgEntity *entity)
     data = entity->data;
     map = &data->local_map;
     matrix = &data->local.matrix;
+    data->global.is_shifted = FALSE;
+
+    _adg_unarrange(entity);
 
     switch (data->local_mix) {
     case ADG_MIX_DISABLED:
@@ -1313,7 +2635,7 @@ _adg_local_changed(AdgEntity *entity)
         break;
     case ADG_MIX_ANCESTORS:
         if (data->parent) {
-            adg_matrix_copy(matrix, adg_entity_get_local_matrix(data->parent));
+            adg_matrix_copy(matrix, _adg_entity_get_local_matrix(data->parent));
             adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
         } else {
             adg_matrix_copy(matrix, map);
@@ -1321,7 +2643,7 @@ _adg_local_changed(AdgEntity *entity)
         break;
     case ADG_MIX_ANCESTORS_NORMALIZED:
         if (data->parent) {
-            adg_matrix_copy(matrix, adg_entity_get_local_matrix(data->parent));
+            adg_matrix_copy(matrix, _adg_entity_get_local_matrix(data->parent));
             adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
         } else {
             adg_matrix_copy(matrix, map);
@@ -1353,6 +2675,74 @@ _adg_local_changed(AdgEntity *entity)
         g_return_if_reached();
         break;
     }
+
+    _adg_update_combined(entity);
+}
+
+/* Emits the global-changed or local-changed @signal on @entity, calling
+ * the class handler directly when no handler is connected */
+static void
+_adg_emit_changed(AdgEntity *entity, guint signal)
+{
+    AdgEntityClass *klass;
+    gboolean traced;
+
+    traced = _adg_cascade_enter(entity, signal == GLOBAL_CHANGED ?
+                                ADG_CASCADE_GLOBAL_CHANGED :
+                                ADG_CASCADE_LOCAL_CHANGED);
+
+    if (g_signal_has_handler_pending(entity, _adg_signals[signal], 0, FALSE)) {
+        g_signal_emit(entity, _adg_signals[signal], 0);
+    } else {
+        klass = ADG_ENTITY_GET_CLASS(entity);
+        if (signal == GLOBAL_CHANGED && klass->global_changed != NULL)
+            klass->global_changed(entity);
+        else if (signal == LOCAL_CHANGED && klass->local_changed != NULL)
+            klass->local_changed(entity);
+    }
+
+    if (traced)
+        _adg_cascade_leave();
+}
+
+static void
+_adg_propagate_changed(AdgEntity *entity, guint signal)
+{
+    GPtrArray *queue;
+    GSList *children, *child;
+    guint n;
+
+    /* The queue grows while it is visited: the children of the n-th
+     * entity are appended at the end, giving a breadth-first walk */
+    queue = g_ptr_array_new();
+    g_ptr_array_add(queue, entity);
+
+    for (n = 0; n < queue->len; ++n) {
+        entity = g_ptr_array_index(queue, n);
+
+        _adg_emit_changed(entity, signal);
+
+        if (ADG_IS_CONTAINER(entity)) {
+            children = adg_container_children((AdgContainer *) entity);
+            for (child = children; child != NULL; child = child->next)
+                g_ptr_array_add(queue, child->data);
+            g_slist_free(children);
+        }
+    }
+
+    g_ptr_array_free(queue, TRUE);
+}
+
+static void
+_adg_update_combined(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = entity->data;
+
+    cairo_matrix_multiply(&data->combined.matrix,
+                          &data->local.matrix, &data->global.matrix);
+    adg_matrix_copy(&data->combined.inverse, &data->combined.matrix);
+    data->combined.is_invertible =
+        cairo_matrix_invert(&data->combined.inverse) == CAIRO_STATUS_SUCCESS;
 }
 
 static void
@@ -1360,6 +2750,12 @@ _adg_real_invalidate(AdgEntity *entity)
 {
     AdgEntityClass *klass = ADG_ENTITY_GET_CLASS(entity);
     AdgEntityPrivate *data = entity->data;
+    gboolean traced;
+
+    traced = _adg_cascade_enter(entity, ADG_CASCADE_INVALIDATE);
+
+    _adg_damage(entity);
+    data->global.is_shifted = FALSE;
 
     /* Do not raise any warning if invalidate() is not defined,
      * assuming entity does not have additional cache to be cleared */
@@ -1367,6 +2763,13 @@ _adg_real_invalidate(AdgEntity *entity)
         klass->invalidate(entity);
 
     data->extents.is_defined = FALSE;
+    _adg_unarrange(entity);
+
+    if (_adg_profiling)
+        _adg_profile_update(entity, _ADG_PROFILE_INVALIDATE, 0);
+
+    if (traced)
+        _adg_cascade_leave();
 }
 
 static void
@@ -1374,21 +2777,17 @@ _adg_real_arrange(AdgEntity *entity)
 {
     AdgEntityClass *klass;
     AdgEntityPrivate *data;
+    ADG_TRACE_START(span);
 
     klass = ADG_ENTITY_GET_CLASS(entity);
     data = entity->data;
 
-    /* Update the global matrix, if required */
-    if (!data->global.is_defined) {
-        data->global.is_defined = TRUE;
-        g_signal_emit(entity, _adg_signals[GLOBAL_CHANGED], 0);
-    }
+    /* Nothing changed since the last arrange: skip the whole subtree.
+     * Collapsed entities are skipped too, leaving their caches as is */
+    if (data->arranged || _adg_entity_is_collapsed(entity))
+        return;
 
-    /* Update the local matrix, if required */
-    if (!data->local.is_defined) {
-        data->local.is_defined = TRUE;
-        g_signal_emit(entity, _adg_signals[LOCAL_CHANGED], 0);
-    }
+    _adg_entity_update_matrices(entity);
 
     /* The arrange() method must be defined */
     if (klass->arrange == NULL) {
@@ -1398,13 +2797,32 @@ _adg_real_arrange(AdgEntity *entity)
         return;
     }
 
-    klass->arrange(entity);
+    data->arranging = TRUE;
+
+    if (_adg_profiling) {
+        guint64 start = _adg_profile_now();
+        klass->arrange(entity);
+        _adg_profile_update(entity, _ADG_PROFILE_ARRANGE,
+                            _adg_profile_now() - start);
+    } else {
+        klass->arrange(entity);
+    }
+
+    data->arranging = FALSE;
+    data->arranged = TRUE;
+
+    ADG_TRACE_STOP(span, "arrange", G_OBJECT_TYPE_NAME(entity));
 }
 
 static void
 _adg_real_render(AdgEntity *entity, cairo_t *cr)
 {
     AdgEntityClass *klass = ADG_ENTITY_GET_CLASS(entity);
+    AdgEntityPrivate *data = entity->data;
+    AdgRenderContext *context;
+    gboolean profiling, show_extents;
+    guint64 start;
+    ADG_TRACE_START(span);
 
     /* The render method must be defined */
     if (klass->render == NULL) {
@@ -1413,15 +2831,55 @@ _adg_real_render(AdgEntity *entity, cairo_t *cr)
         return;
     }
 
+    /* Hidden entities are not even arranged */
+    if (! data->visible || (adg_get_hidden_layers(cr) & (1u << data->layer)))
+        return;
+
     /* Before the rendering, the entity should be arranged */
-    g_signal_emit(entity, _adg_signals[ARRANGE], 0);
+    adg_entity_arrange(entity);
 
-    cairo_save(cr);
-    klass->render(entity, cr);
-    cairo_restore(cr);
+    /* The options bound to cr take precedence over the global ones */
+    context = adg_get_render_context(cr);
+    if (context != NULL) {
+        profiling = context->profiling;
+        show_extents = context->show_extents;
+    } else {
+        profiling = _adg_profiling;
+        show_extents = _adg_show_extents;
+    }
+
+    /* Skip the entities that cannot leave marks on the clip region */
+    if (_adg_is_clipped(entity, cr))
+        return;
+
+    if (context != NULL && _adg_is_culled(entity, cr, &context->cull_region))
+        return;
+
+    /* Skip the entities too small to be seen */
+    if ((_adg_lod_rules != NULL || adg_has_preview(cr) ||
+         (context != NULL && context->lod_rules != NULL)) &&
+        _adg_apply_lod(entity, cr, context))
+        return;
+
+    start = profiling ? _adg_profile_now() : 0;
+
+    if (data->recording.is_enabled) {
+        _adg_render_recording(entity, cr);
+    } else if (adg_has_state_tracking(cr)) {
+        _adg_render_tracked(entity, cr);
+    } else {
+        cairo_save(cr);
+        klass->render(entity, cr);
+        cairo_restore(cr);
+    }
+
+    if (profiling)
+        _adg_profile_update(entity, _ADG_PROFILE_RENDER,
+                            _adg_profile_now() - start);
 
-    if (_adg_show_extents) {
-        AdgEntityPrivate *data = entity->data;
+    ADG_TRACE_STOP(span, "render", G_OBJECT_TYPE_NAME(entity));
+
+    if (show_extents) {
         CpmlExtents *extents = &data->extents;
 
         if (extents->is_defined) {
@@ -1434,3 +2892,497 @@ _adg_real_render(AdgEntity *entity, cairo_t *cr)
         }
     }
 }
+
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = entity->data;
+    GTypeQuery query;
+
+    g_type_query(G_OBJECT_TYPE(entity), &query);
+
+    return query.instance_size + sizeof(AdgEntityPrivate) +
+        sizeof(AdgEntityStyle) * data->n_styles;
+}
+
+static void
+_adg_trim_caches(AdgEntity *entity, AdgTrimLevel level)
+{
+    _adg_clear_recording(entity);
+
+    if (level == ADG_TRIM_LEVEL_ARRANGE)
+        adg_entity_invalidate(entity);
+}
+
+static void
+_adg_unarrange(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+    AdgEntity *parent;
+
+    /* Clear the flag on entity and on all its ancestors, so an arrange
+     * on any of them will walk down to this entity. Changes performed
+     * while arranging are considered part of the arrange phase, hence
+     * the walk stops on the first entity that is being arranged. */
+    while (entity != NULL) {
+        data = entity->data;
+        if (data->arranging)
+            break;
+
+        /* Let the container recheck only the extents of this child */
+        parent = data->parent;
+        if (data->arranged && parent != NULL && ADG_IS_CONTAINER(parent))
+            _adg_container_mark_dirty((AdgContainer *) parent, entity);
+
+        data->arranged = FALSE;
+        _adg_clear_recording(entity);
+        entity = data->parent;
+    }
+}
+
+static void
+_adg_damage(AdgEntity *entity)
+{
+    AdgEntity *toplevel;
+    AdgEntityPrivate *data;
+    AdgEntityClass *klass;
+
+    /* Changes performed while arranging are considered part of the
+     * arrange phase (see _adg_unarrange()), so they are not damages */
+    toplevel = entity;
+    for (;;) {
+        data = toplevel->data;
+        if (data->arranging)
+            return;
+        if (data->parent == NULL)
+            break;
+        toplevel = data->parent;
+    }
+
+    klass = ADG_ENTITY_GET_CLASS(toplevel);
+    if (klass->damage != NULL)
+        klass->damage(toplevel, entity);
+}
+
+static void
+_adg_clear_recording(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = entity->data;
+
+    if (data->recording.surface != NULL) {
+        cairo_surface_destroy(data->recording.surface);
+        data->recording.surface = NULL;
+    }
+}
+
+/* Computes in @remap the transformation from the device space of
+ * the recording to the device space of @ctm. Returns FALSE if the
+ * recording cannot be reused, that is when the two spaces are not
+ * related by a uniform scale close enough to 1 plus a translation */
+static gboolean
+_adg_recording_remap(AdgEntity *entity, const cairo_matrix_t *ctm,
+                     cairo_matrix_t *remap)
+{
+    AdgEntityPrivate *data;
+    gdouble scale;
+
+    data = entity->data;
+    adg_matrix_copy(remap, &data->recording.ctm);
+
+    if (cairo_matrix_invert(remap) != CAIRO_STATUS_SUCCESS)
+        return FALSE;
+
+    cairo_matrix_multiply(remap, remap, ctm);
+    scale = remap->xx;
+
+    return fabs(remap->xy) < _ADG_RECORDING_EPSILON * fabs(scale) &&
+           fabs(remap->yx) < _ADG_RECORDING_EPSILON * fabs(scale) &&
+           fabs(remap->yy - scale) < _ADG_RECORDING_EPSILON * fabs(scale) &&
+           scale * _ADG_RECORDING_DRIFT >= 1 &&
+           scale <= _ADG_RECORDING_DRIFT;
+}
+
+/* Renders @entity without saving the whole cairo state: only what
+ * the styles do not reset on their own is reverted */
+static void
+_adg_render_tracked(AdgEntity *entity, cairo_t *cr)
+{
+    cairo_matrix_t matrix;
+    cairo_antialias_t antialias;
+    int num_dashes;
+
+    cairo_get_matrix(cr, &matrix);
+    antialias = cairo_get_antialias(cr);
+    num_dashes = cairo_get_dash_count(cr);
+
+    ADG_ENTITY_GET_CLASS(entity)->render(entity, cr);
+
+    cairo_new_path(cr);
+    cairo_set_matrix(cr, &matrix);
+
+    if (cairo_get_antialias(cr) != antialias)
+        cairo_set_antialias(cr, antialias);
+
+    if (num_dashes == 0 && cairo_get_dash_count(cr) > 0)
+        cairo_set_dash(cr, NULL, 0, 0);
+}
+
+static void
+_adg_render_recording(AdgEntity *entity, cairo_t *cr)
+{
+    AdgEntityPrivate *data;
+    cairo_matrix_t ctm, remap;
+    guint32 hidden_layers;
+
+    data = entity->data;
+    cairo_get_matrix(cr, &ctm);
+    hidden_layers = adg_get_hidden_layers(cr);
+
+    /* The recording is performed in device space. It is vectorial,
+     * so it can be replayed with a slightly different scale (e.g.
+     * while zooming the render map of AdgGtkArea) or with any
+     * translation (e.g. while panning) without artifacts: only the
+     * font hinting would be a bit off. Any bigger change requires a
+     * new recording */
+    if (data->recording.surface != NULL &&
+        (data->recording.hidden_layers != hidden_layers ||
+         !_adg_recording_remap(entity, &ctm, &remap)))
+        _adg_clear_recording(entity);
+
+    if (data->recording.surface == NULL) {
+        cairo_surface_t *surface;
+        cairo_t *recording_cr;
+
+        surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+        recording_cr = cairo_create(surface);
+        cairo_set_matrix(recording_cr, &ctm);
+        adg_set_hidden_layers(recording_cr, hidden_layers);
+        ADG_ENTITY_GET_CLASS(entity)->render(entity, recording_cr);
+        cairo_destroy(recording_cr);
+
+        data->recording.surface = surface;
+        adg_matrix_copy(&data->recording.ctm, &ctm);
+        data->recording.hidden_layers = hidden_layers;
+        cairo_matrix_init_identity(&remap);
+    }
+
+    cairo_save(cr);
+    cairo_set_matrix(cr, &remap);
+    cairo_set_source_surface(cr, data->recording.surface, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+static gboolean
+_adg_is_clipped(AdgEntity *entity, cairo_t *cr)
+{
+    const CpmlExtents *extents;
+    gdouble x1, y1, x2, y2;
+    gdouble dx, dy;
+
+    extents = &((AdgEntityPrivate *) entity->data)->extents;
+
+    /* Undefined extents means the entity cannot be culled */
+    if (! extents->is_defined)
+        return FALSE;
+
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+
+    /* Some cairo versions return an empty box on unbounded surfaces
+     * (e.g. recording surfaces): treat that case as "no clip" */
+    if (x2 <= x1 || y2 <= y1)
+        return FALSE;
+
+    /* The extents do not consider the line width nor any other
+     * pen related detail, so enlarge the clip box a bit */
+    dx = dy = 10;
+    cairo_device_to_user_distance(cr, &dx, &dy);
+    dx = fabs(dx);
+    dy = fabs(dy);
+
+    return extents->org.x > x2 + dx ||
+           extents->org.y > y2 + dy ||
+           extents->org.x + extents->size.x < x1 - dx ||
+           extents->org.y + extents->size.y < y1 - dy;
+}
+
+/* Checks @entity against a cull region expressed in device space,
+ * so the extents are transformed instead of the region */
+static gboolean
+_adg_is_culled(AdgEntity *entity, cairo_t *cr, const CpmlExtents *region)
+{
+    const CpmlExtents *extents;
+    gdouble x[4], y[4];
+    gdouble x1, y1, x2, y2;
+    gint n;
+
+    extents = &((AdgEntityPrivate *) entity->data)->extents;
+
+    if (! region->is_defined || ! extents->is_defined)
+        return FALSE;
+
+    x[0] = x[3] = extents->org.x;
+    x[1] = x[2] = extents->org.x + extents->size.x;
+    y[0] = y[1] = extents->org.y;
+    y[2] = y[3] = extents->org.y + extents->size.y;
+
+    for (n = 0; n < 4; ++n)
+        cairo_user_to_device(cr, &x[n], &y[n]);
+
+    x1 = x2 = x[0];
+    y1 = y2 = y[0];
+    for (n = 1; n < 4; ++n) {
+        x1 = MIN(x1, x[n]);
+        x2 = MAX(x2, x[n]);
+        y1 = MIN(y1, y[n]);
+        y2 = MAX(y2, y[n]);
+    }
+
+    /* Same margin used by _adg_is_clipped() for the pen details */
+    return x1 > region->org.x + region->size.x + 10 ||
+           y1 > region->org.y + region->size.y + 10 ||
+           x2 < region->org.x - 10 ||
+           y2 < region->org.y - 10;
+}
+
+/* Returns TRUE if @entity has been handled by its level of
+ * detail rule, so it must not be rendered as usual */
+static gboolean
+_adg_apply_lod(AdgEntity *entity, cairo_t *cr, AdgRenderContext *context)
+{
+    const AdgLodRule *rule;
+    AdgLodRule preview_rule;
+    const CpmlExtents *extents;
+    gdouble x1, y1, x2, y2;
+
+    /* The rules of the context take precedence over the global ones */
+    rule = context != NULL ?
+        _adg_lod_rules_lookup(context->lod_rules, G_OBJECT_TYPE(entity)) : NULL;
+    if (rule == NULL)
+        rule = _adg_lod_rules_lookup(_adg_lod_rules, G_OBJECT_TYPE(entity));
+
+    if (rule == NULL && adg_has_preview(cr)) {
+        preview_rule.threshold = ADG_IS_TEXTUAL(entity) ?
+            _ADG_PREVIEW_TEXT_THRESHOLD : _ADG_PREVIEW_THRESHOLD;
+        preview_rule.policy = ADG_LOD_POLICY_SKIP;
+        rule = &preview_rule;
+    }
+
+    if (rule == NULL || rule->policy == ADG_LOD_POLICY_RENDER)
+        return FALSE;
+
+    extents = &((AdgEntityPrivate *) entity->data)->extents;
+    if (! extents->is_defined)
+        return FALSE;
+
+    /* Device size of the extents box, rotations included */
+    x1 = extents->size.x;
+    y1 = 0;
+    x2 = 0;
+    y2 = extents->size.y;
+    cairo_user_to_device_distance(cr, &x1, &y1);
+    cairo_user_to_device_distance(cr, &x2, &y2);
+
+    if (fabs(x1) + fabs(x2) >= rule->threshold ||
+        fabs(y1) + fabs(y2) >= rule->threshold)
+        return FALSE;
+
+    if (rule->policy == ADG_LOD_POLICY_BOX) {
+        cairo_save(cr);
+        cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.5);
+        cairo_rectangle(cr, extents->org.x, extents->org.y,
+                        extents->size.x, extents->size.y);
+        cairo_fill(cr);
+        cairo_restore(cr);
+    }
+
+    return TRUE;
+}
+
+static guint64
+_adg_profile_now(void)
+{
+    GTimeVal now;
+
+    g_get_current_time(&now);
+
+    return ((guint64) now.tv_sec * G_USEC_PER_SEC + now.tv_usec) * 1000;
+}
+
+static void
+_adg_profile_update(AdgEntity *entity, guint counter, guint64 elapsed)
+{
+    GType type;
+    AdgProfile *profile;
+
+    type = G_OBJECT_TYPE(entity);
+
+    G_LOCK(_adg_profiles);
+
+    if (_adg_profiles == NULL)
+        _adg_profiles = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+
+    profile = g_hash_table_lookup(_adg_profiles, GSIZE_TO_POINTER(type));
+    if (profile == NULL) {
+        profile = g_new0(AdgProfile, 1);
+        profile->type = type;
+        g_hash_table_insert(_adg_profiles, GSIZE_TO_POINTER(type), profile);
+    }
+
+    switch (counter) {
+    case _ADG_PROFILE_ARRANGE:
+        ++profile->n_arranges;
+        profile->arrange_time += elapsed;
+        break;
+    case _ADG_PROFILE_RENDER:
+        ++profile->n_renders;
+        profile->render_time += elapsed;
+        break;
+    case _ADG_PROFILE_INVALIDATE:
+        ++profile->n_invalidations;
+        break;
+    }
+
+    G_UNLOCK(_adg_profiles);
+}
+
+static void
+_adg_profile_collect(gpointer key, gpointer value, gpointer user_data)
+{
+    g_array_append_val((GArray *) user_data, *(AdgProfile *) value);
+}
+
+static gint
+_adg_profile_compare(gconstpointer a, gconstpointer b)
+{
+    return strcmp(g_type_name(((const AdgProfile *) a)->type),
+                  g_type_name(((const AdgProfile *) b)->type));
+}
+
+static void
+_adg_cascade_node_free(gpointer data)
+{
+    AdgCascadeNode *node = data;
+
+    g_free(node->label);
+    g_free(node);
+}
+
+static guint
+_adg_cascade_link_hash(gconstpointer key)
+{
+    const AdgCascadeLink *link = key;
+
+    return g_direct_hash(link->cause) ^
+        (g_direct_hash(link->effect) * 31) ^ link->event;
+}
+
+static gboolean
+_adg_cascade_link_equal(gconstpointer a, gconstpointer b)
+{
+    const AdgCascadeLink *link1 = a;
+    const AdgCascadeLink *link2 = b;
+
+    return link1->cause == link2->cause && link1->effect == link2->effect &&
+           link1->event == link2->event;
+}
+
+static void
+_adg_cascade_dump_node(gpointer key, gpointer value, gpointer user_data)
+{
+    AdgCascadeNode *node;
+    GString *dump;
+    guint n;
+
+    node = value;
+    dump = user_data;
+
+    g_string_append_printf(dump, "    \"%p\" [label=\"%s", key, node->label);
+    if (node->n_roots > 0)
+        g_string_append_printf(dump, "\\nroots: %u", node->n_roots);
+    for (n = 0; n < ADG_CASCADE_N_EVENTS; ++n) {
+        if (node->counts[n] > 0)
+            g_string_append_printf(dump, "\\n%s: %u",
+                                   _adg_cascade_names[n], node->counts[n]);
+    }
+    g_string_append(dump, "\"];\n");
+}
+
+static void
+_adg_cascade_dump_link(gpointer key, gpointer value, gpointer user_data)
+{
+    AdgCascadeLink *link = key;
+
+    g_string_append_printf((GString *) user_data,
+                           "    \"%p\" -> \"%p\" [label=\"%s x%u\"];\n",
+                           link->cause, link->effect,
+                           _adg_cascade_names[link->event], link->count);
+}
+
+/* Records @event on @object, linking it to the innermost event being
+ * handled. The events performed by an object on itself (e.g. the
+ * invalidation done by the default geometry change) are counted but
+ * not linked. Returns FALSE if tracing is disabled */
+gboolean
+_adg_cascade_enter(gpointer object, AdgCascadeEvent event)
+{
+    AdgCascadeNode *node;
+    AdgCascadeLink key, *link;
+    guint len;
+
+    if (! _adg_cascade_tracing)
+        return FALSE;
+
+    G_LOCK(_adg_cascade);
+
+    if (_adg_cascade_nodes == NULL) {
+        _adg_cascade_nodes = g_hash_table_new_full(NULL, NULL, NULL,
+                                                   _adg_cascade_node_free);
+        _adg_cascade_links = g_hash_table_new_full(_adg_cascade_link_hash,
+                                                   _adg_cascade_link_equal,
+                                                   g_free, NULL);
+    }
+    if (_adg_cascade_stack == NULL)
+        _adg_cascade_stack = g_ptr_array_new();
+
+    node = g_hash_table_lookup(_adg_cascade_nodes, object);
+    if (node == NULL) {
+        node = g_new0(AdgCascadeNode, 1);
+        node->label = g_strdup_printf("%s %p", G_OBJECT_TYPE_NAME(object),
+                                      object);
+        g_hash_table_insert(_adg_cascade_nodes, object, node);
+    }
+    ++ node->counts[event];
+
+    len = _adg_cascade_stack->len;
+    if (len == 0) {
+        ++ node->n_roots;
+    } else if (g_ptr_array_index(_adg_cascade_stack, len - 1) != object) {
+        key.cause = g_ptr_array_index(_adg_cascade_stack, len - 1);
+        key.effect = object;
+        key.event = event;
+        link = g_hash_table_lookup(_adg_cascade_links, &key);
+        if (link == NULL) {
+            link = g_memdup(&key, sizeof(key));
+            link->count = 0;
+            g_hash_table_insert(_adg_cascade_links, link, link);
+        }
+        ++ link->count;
+    }
+
+    g_ptr_array_add(_adg_cascade_stack, object);
+
+    G_UNLOCK(_adg_cascade);
+
+    return TRUE;
+}
+
+void
+_adg_cascade_leave(void)
+{
+    G_LOCK(_adg_cascade);
+    if (_adg_cascade_stack != NULL && _adg_cascade_stack->len > 0)
+        g_ptr_array_remove_index(_adg_cascade_stack,
+                                 _adg_cascade_stack->len - 1);
+    G_UNLOCK(_adg_cascade);
+}
@@ -39,6 +39,7 @@ G_BEGIN_DECLS
 
 typedef struct _AdgEntity       AdgEntity;
 typedef struct _AdgEntityClass  AdgEntityClass;
+typedef struct _AdgProfile      AdgProfile;
 
 struct _AdgEntity {
     /*< private >*/
@@ -60,16 +61,66 @@ struct _AdgEntityClass {
     void                (*arrange)              (AdgEntity       *entity);
     void                (*render)               (AdgEntity       *entity,
                                                  cairo_t         *cr);
+
+    /* Virtual table */
+    gsize               (*memory_usage)         (AdgEntity       *entity);
+    void                (*trim_caches)          (AdgEntity       *entity,
+                                                 AdgTrimLevel     level);
+    void                (*geometry_changed)     (AdgEntity       *entity);
+    void                (*damage)               (AdgEntity       *entity,
+                                                 AdgEntity       *source);
+};
+
+struct _AdgProfile {
+    GType                type;
+    guint                n_arranges;
+    guint64              arrange_time;
+    guint                n_renders;
+    guint64              render_time;
+    guint                n_invalidations;
 };
 
 
 void            adg_switch_extents              (gboolean         state);
+void            adg_switch_profiling            (gboolean         state);
+AdgProfile *    adg_profiling_report            (guint           *n_profiles);
+void            adg_profiling_reset             (void);
+void            adg_switch_invalidation_tracing (gboolean         state);
+gchar *         adg_invalidation_tracing_dump   (void);
+void            adg_invalidation_tracing_reset  (void);
+void            adg_switch_preview              (cairo_t         *cr,
+                                                 gboolean         state);
+gboolean        adg_has_preview                 (cairo_t         *cr);
+void            adg_switch_state_tracking       (cairo_t         *cr,
+                                                 gboolean         state);
+gboolean        adg_has_state_tracking          (cairo_t         *cr);
+void            adg_set_hidden_layers           (cairo_t         *cr,
+                                                 guint32          layers);
+guint32         adg_get_hidden_layers           (cairo_t         *cr);
+void            adg_set_lod                     (GType            type,
+                                                 gdouble          threshold,
+                                                 AdgLodPolicy     policy);
+AdgLodPolicy    adg_get_lod                     (GType            type,
+                                                 gdouble         *threshold);
 
 GType           adg_entity_get_type             (void);
 void            adg_entity_destroy              (AdgEntity       *entity);
 void            adg_entity_switch_floating      (AdgEntity       *entity,
                                                  gboolean         new_state);
 gboolean        adg_entity_has_floating         (AdgEntity       *entity);
+void            adg_entity_switch_recording_cache
+                                                (AdgEntity       *entity,
+                                                 gboolean         new_state);
+gboolean        adg_entity_has_recording_cache  (AdgEntity       *entity);
+void            adg_entity_set_layer            (AdgEntity       *entity,
+                                                 guint            layer);
+guint           adg_entity_get_layer            (AdgEntity       *entity);
+void            adg_entity_switch_visible       (AdgEntity       *entity,
+                                                 gboolean         new_state);
+gboolean        adg_entity_is_visible           (AdgEntity       *entity);
+void            adg_entity_switch_keep_layout   (AdgEntity       *entity,
+                                                 gboolean         new_state);
+gboolean        adg_entity_has_keep_layout      (AdgEntity       *entity);
 AdgCanvas *     adg_entity_get_canvas           (AdgEntity       *entity);
 void            adg_entity_set_parent           (AdgEntity       *entity,
                                                  AdgEntity       *parent);
@@ -92,6 +143,10 @@ const cairo_matrix_t *
                 adg_entity_get_local_map        (AdgEntity       *entity);
 const cairo_matrix_t *
                 adg_entity_get_local_matrix     (AdgEntity       *entity);
+const cairo_matrix_t *
+                adg_entity_get_combined_matrix  (AdgEntity       *entity);
+const cairo_matrix_t *
+                adg_entity_get_inverse_matrix   (AdgEntity       *entity);
 void            adg_entity_set_local_mix        (AdgEntity       *entity,
                                                  AdgMix           local_mix);
 AdgMix          adg_entity_get_local_mix        (AdgEntity       *entity);
@@ -115,9 +170,16 @@ void            adg_entity_invalidate           (AdgEntity       *entity);
 void            adg_entity_arrange              (AdgEntity       *entity);
 void            adg_entity_render               (AdgEntity       *entity,
                                                  cairo_t         *cr);
+void            adg_entity_render_with_context  (AdgEntity       *entity,
+                                                 cairo_t         *cr,
+                                                 AdgRenderContext *context);
 AdgPoint *      adg_entity_point                (AdgEntity       *entity,
                                                  AdgPoint        *point,
                                                  const AdgPoint  *new_point);
+gsize           adg_entity_get_memory_usage     (AdgEntity       *entity);
+void            adg_entity_trim_caches          (AdgEntity       *entity,
+                                                 AdgTrimLevel     level);
+void            adg_entity_geometry_changed     (AdgEntity       *entity);
 
 G_END_DECLS
 
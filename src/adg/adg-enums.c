@@ -117,3 +117,71 @@
  *
  * Since: 1.0
  **/
+
+/**
+ * AdgJoint:
+ * @ADG_JOINT_NONE:    the primitive is simply followed by the next one
+ * @ADG_JOINT_CHAMFER: join the primitive to the next one with a chamfer
+ * @ADG_JOINT_FILLET:  join the primitive to the next one with a fillet
+ *
+ * Flags to be or-ed to the primitive types passed to
+ * adg_path_append_points(). Their values do not clash with any
+ * #CpmlPrimitiveType, so they can be packed in the same byte.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgAllocDomain:
+ * @ADG_ALLOC_DOMAIN_PATH:  the buffers of #AdgPath
+ * @ADG_ALLOC_DOMAIN_TRAIL: the flattened paths and the segment caches
+ *                          of #AdgTrail
+ * @ADG_ALLOC_DOMAIN_TEXT:  the glyphs and the layouts of the text entities
+ * @ADG_ALLOC_DOMAIN_STYLE: the #AdgStyle instances
+ * @ADG_ALLOC_DOMAIN_DIM:   the #AdgDim instances
+ *
+ * The subsystems whose memory is counted when the library is built
+ * with <code>--enable-alloc-trace</code>. See adg_alloc_stats().
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgTrimLevel:
+ * @ADG_TRIM_LEVEL_RENDER:  drop the data rebuilt while rendering, such
+ *                          as recording surfaces, dash caches, glyphs
+ *                          and text layouts: the extents stay valid
+ * @ADG_TRIM_LEVEL_ARRANGE: drop also the arrange results, so the
+ *                          entities will be arranged again on the next
+ *                          rendering
+ *
+ * Specifies how much derived data adg_entity_trim_caches() must release.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgLodPolicy:
+ * @ADG_LOD_POLICY_RENDER: render the entity as usual
+ * @ADG_LOD_POLICY_BOX:    fill the extents of the entity with a gray box
+ * @ADG_LOD_POLICY_SKIP:   do not render the entity at all
+ *
+ * How an entity must be rendered when its extents, in device space,
+ * fall below the level of detail threshold. See adg_set_lod().
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgSnapType:
+ * @ADG_SNAP_ENDPOINT:   the start and end points of the primitives
+ * @ADG_SNAP_MIDPOINT:   the points halfway along the primitives
+ * @ADG_SNAP_CENTER:     the centers of the arcs
+ * @ADG_SNAP_NAMED_PAIR: the named pairs of the models
+ *
+ * The kinds of points collected by #AdgSnapIndex. These are flags:
+ * they can be or-ed together to restrict a query to a subset of
+ * them, e.g. in adg_snap_index_nearest().
+ *
+ * Since: 1.0
+ **/
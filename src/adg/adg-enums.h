@@ -67,6 +67,12 @@ typedef enum {
     ADG_PROJECTION_SCHEME_THIRD_ANGLE
 } AdgProjectionScheme;
 
+typedef enum {
+    ADG_JOINT_NONE    = 0,
+    ADG_JOINT_CHAMFER = 1 << 6,
+    ADG_JOINT_FILLET  = 1 << 7
+} AdgJoint;
+
 typedef enum {
     ADG_DRESS_UNDEFINED,
     ADG_DRESS_COLOR,
@@ -96,6 +102,32 @@ typedef enum {
     ADG_DRESS_TABLE
 } AdgDress;
 
+typedef enum {
+    ADG_ALLOC_DOMAIN_PATH,
+    ADG_ALLOC_DOMAIN_TRAIL,
+    ADG_ALLOC_DOMAIN_TEXT,
+    ADG_ALLOC_DOMAIN_STYLE,
+    ADG_ALLOC_DOMAIN_DIM
+} AdgAllocDomain;
+
+typedef enum {
+    ADG_TRIM_LEVEL_RENDER,
+    ADG_TRIM_LEVEL_ARRANGE
+} AdgTrimLevel;
+
+typedef enum {
+    ADG_LOD_POLICY_RENDER,
+    ADG_LOD_POLICY_BOX,
+    ADG_LOD_POLICY_SKIP
+} AdgLodPolicy;
+
+typedef enum {
+    ADG_SNAP_ENDPOINT   = 1 << 0,
+    ADG_SNAP_MIDPOINT   = 1 << 1,
+    ADG_SNAP_CENTER     = 1 << 2,
+    ADG_SNAP_NAMED_PAIR = 1 << 3
+} AdgSnapType;
+
 G_END_DECLS
 
 
@@ -39,8 +39,8 @@
 /**
  * AdgFillStyleClass:
  * @set_extents: virtual method that specifies where a specific fill style
- *               must be applied. It is called by #AdgHatch in the rendering
- *               phase passing with its boundary box as argument.
+ *               must be applied when the entity being filled does not
+ *               provide its own extents.
  *
  * The default <function>set_extents</function> implementation simply sets
  * the extents owned by the fill style instance to the one provided, so the
@@ -48,6 +48,10 @@
  * this behavior, for example to keep the greatest boundary box instead of
  * the last one.
  *
+ * The fill style can be shared by many entities, so the extents are not
+ * changed while rendering: use adg_fill_style_get_fill_extents() to get
+ * the area to fill on a specific entity.
+ *
  * Since: 1.0
  **/
 
@@ -234,8 +238,9 @@ adg_fill_style_get_pattern(AdgFillStyle *fill_style)
  * <function>set_extents</function> virtual method to intercept
  * any extents change.
  *
- * Sets new extents on @fill_style. These extents are usually set
- * by the arrange() method of the entity using this filling style.
+ * Sets new extents on @fill_style. These extents are used only when
+ * the entity being filled has no extents on its own, see
+ * adg_fill_style_get_fill_extents() for details.
  *
  * Since: 1.0
  **/
@@ -279,6 +284,42 @@ adg_fill_style_get_extents(AdgFillStyle *fill_style)
     return &data->extents;
 }
 
+/**
+ * adg_fill_style_get_fill_extents:
+ * @fill_style: an #AdgFillStyle
+ * @entity: the entity to fill
+ *
+ * <note><para>
+ * This function is only useful in new fill style implementations.
+ * </para></note>
+ *
+ * Gets the portion of space (in global space) to fill when @fill_style
+ * is applied on @entity. This is the boundary box of @entity or, if it
+ * is not defined, the extents of @fill_style as returned by
+ * adg_fill_style_get_extents().
+ *
+ * The fill style is not modified by this call, so it can be safely
+ * shared among different entities.
+ *
+ * Returns: (transfer none): the extents to fill or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+const CpmlExtents *
+adg_fill_style_get_fill_extents(AdgFillStyle *fill_style, AdgEntity *entity)
+{
+    const CpmlExtents *extents;
+
+    g_return_val_if_fail(ADG_IS_FILL_STYLE(fill_style), NULL);
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    extents = adg_entity_get_extents(entity);
+    if (extents != NULL && extents->is_defined)
+        return extents;
+
+    return adg_fill_style_get_extents(fill_style);
+}
+
 
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
@@ -64,6 +64,9 @@ cairo_pattern_t *  adg_fill_style_get_pattern   (AdgFillStyle       *fill_style)
 void               adg_fill_style_set_extents   (AdgFillStyle       *fill_style,
                                                  const CpmlExtents  *extents);
 const CpmlExtents *adg_fill_style_get_extents   (AdgFillStyle       *fill_style);
+const CpmlExtents *adg_fill_style_get_fill_extents
+                                                (AdgFillStyle       *fill_style,
+                                                 AdgEntity          *entity);
 
 G_END_DECLS
 
@@ -24,6 +24,9 @@
 
 G_BEGIN_DECLS
 
+/* Number of scaled fonts (one per ctm) cached by every font style */
+#define ADG_FONT_STYLE_CACHE_SIZE   4
+
 typedef struct _AdgFontStylePrivate AdgFontStylePrivate;
 
 struct _AdgFontStylePrivate {
@@ -36,9 +39,12 @@ struct _AdgFontStylePrivate {
     cairo_subpixel_order_t       subpixel_order;
     cairo_hint_style_t           hint_style;
     cairo_hint_metrics_t         hint_metrics;
+    gboolean                     outlines;
 
+    cairo_font_options_t        *options;
     cairo_font_face_t           *face;
-    cairo_scaled_font_t         *font;
+    /* Most recently used scaled font first */
+    cairo_scaled_font_t         *fonts[ADG_FONT_STYLE_CACHE_SIZE];
 };
 
 G_END_DECLS
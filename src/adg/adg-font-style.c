@@ -25,6 +25,11 @@
  * Contains parameters on how to draw texts such as font family, slanting,
  * weight, hinting and so on.
  *
+ * When the #AdgFontStyle:outlines property is enabled, the texts are
+ * emitted as filled paths instead of glyphs, so vector outputs do not
+ * embed any font. The outlines are extracted once per font face and
+ * glyph and kept in a process-wide cache shared by all the styles.
+ *
  * Since: 1.0
  */
 
@@ -46,9 +51,28 @@
 #include "adg-font-style.h"
 #include "adg-font-style-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_font_style_parent_class)
 
+/* Size of the unhinted fonts used to extract the glyph outlines */
+#define _ADG_OUTLINE_SIZE      1000.
+/* Maximum number of glyph outlines kept by the process-wide cache */
+#define _ADG_OUTLINE_CACHE_SIZE 4096
+
+
+G_LOCK_DEFINE_STATIC(_adg_font_cache);
+G_LOCK_DEFINE_STATIC(_adg_outline_cache);
+
+typedef struct {
+    cairo_font_face_t   *face;
+    unsigned long        index;
+} AdgOutlineKey;
+
+/* Glyph outlines at _ADG_OUTLINE_SIZE, indexed by font face and glyph */
+static GHashTable *     _adg_outlines = NULL;
+
 
 G_DEFINE_TYPE(AdgFontStyle, adg_font_style, ADG_TYPE_STYLE)
 
@@ -62,10 +86,12 @@ enum {
     PROP_ANTIALIAS,
     PROP_SUBPIXEL_ORDER,
     PROP_HINT_STYLE,
-    PROP_HINT_METRICS
+    PROP_HINT_METRICS,
+    PROP_OUTLINES
 };
 
 
+static void             _adg_finalize           (GObject        *object);
 static void             _adg_get_property       (GObject        *object,
                                                  guint           prop_id,
                                                  GValue         *value,
@@ -78,6 +104,15 @@ static void             _adg_invalidate         (AdgStyle       *style);
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
+static const cairo_font_options_t *
+                        _adg_cached_options     (AdgFontStyle   *font_style);
+static const cairo_path_t *
+                        _adg_cached_outline     (cairo_font_face_t *face,
+                                                 unsigned long   index);
+static guint            _adg_outline_hash       (gconstpointer   key);
+static gboolean         _adg_outline_equal      (gconstpointer   key1,
+                                                 gconstpointer   key2);
+static void             _adg_outline_free       (gpointer        key);
 
 
 static void
@@ -92,6 +127,7 @@ adg_font_style_class_init(AdgFontStyleClass *klass)
 
     g_type_class_add_private(klass, sizeof(AdgFontStylePrivate));
 
+    gobject_class->finalize = _adg_finalize;
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
@@ -162,6 +198,13 @@ adg_font_style_class_init(AdgFontStyleClass *klass)
                              CAIRO_HINT_METRICS_DEFAULT,
                              G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_HINT_METRICS, param);
+
+    param = g_param_spec_boolean("outlines",
+                                 P_("Outlines"),
+                                 P_("Whether to render the texts as filled glyph outlines instead of font glyphs"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_OUTLINES, param);
 }
 
 static void
@@ -180,11 +223,27 @@ adg_font_style_init(AdgFontStyle *font_style)
     data->subpixel_order = CAIRO_SUBPIXEL_ORDER_DEFAULT;
     data->hint_style = CAIRO_HINT_STYLE_DEFAULT;
     data->hint_metrics = CAIRO_HINT_METRICS_DEFAULT;
-    data->font = NULL;
+    data->outlines = FALSE;
+    data->options = NULL;
+    data->face = NULL;
+    memset(data->fonts, 0, sizeof(data->fonts));
 
     font_style->data = data;
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgFontStylePrivate *data = ((AdgFontStyle *) object)->data;
+
+    /* Release the caches of derived styles too */
+    ADG_STYLE_GET_CLASS(object)->invalidate((AdgStyle *) object);
+    g_free(data->family);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
 static void
 _adg_get_property(GObject *object, guint prop_id,
                   GValue *value, GParamSpec *pspec)
@@ -219,6 +278,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_HINT_METRICS:
         g_value_set_int(value, data->hint_metrics);
         break;
+    case PROP_OUTLINES:
+        g_value_set_boolean(value, data->outlines);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -274,6 +336,9 @@ _adg_set_property(GObject *object, guint prop_id,
         data->hint_metrics = g_value_get_int(value);
         adg_style_invalidate(style);
         break;
+    case PROP_OUTLINES:
+        data->outlines = g_value_get_boolean(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -304,6 +369,9 @@ adg_font_style_new(void)
  * picked from @font_style. The returned value must be freed with
  * cairo_font_options_destroy().
  *
+ * Use adg_font_style_get_options() instead if you do not need to
+ * modify the returned options.
+ *
  * Returns: (transfer full): a newly allocated list of cairo font options.
  *
  * Since: 1.0
@@ -311,23 +379,40 @@ adg_font_style_new(void)
 cairo_font_options_t *
 adg_font_style_new_options(AdgFontStyle *font_style)
 {
-    AdgFontStylePrivate *data;
     cairo_font_options_t *options;
 
     g_return_val_if_fail(ADG_IS_FONT_STYLE(font_style), NULL);
 
-    data = font_style->data;
-    options = cairo_font_options_create();
+    G_LOCK(_adg_font_cache);
+    options = cairo_font_options_copy(_adg_cached_options(font_style));
+    G_UNLOCK(_adg_font_cache);
 
-    /* Check for cached font */
-    if (data->font != NULL) {
-        cairo_scaled_font_get_font_options(data->font, options);
-    } else {
-        cairo_font_options_set_antialias(options, data->antialias);
-        cairo_font_options_set_subpixel_order(options, data->subpixel_order);
-        cairo_font_options_set_hint_style(options, data->hint_style);
-        cairo_font_options_set_hint_metrics(options, data->hint_metrics);
-    }
+    return options;
+}
+
+/**
+ * adg_font_style_get_options:
+ * @font_style: an #AdgFontStyle object
+ *
+ * Gets the font options of @font_style. The returned options are
+ * owned by @font_style and must not be modified or destroyed: they
+ * are built on the first request and kept until a property of
+ * @font_style changes.
+ *
+ * Returns: (transfer none): the cairo font options.
+ *
+ * Since: 1.0
+ **/
+const cairo_font_options_t *
+adg_font_style_get_options(AdgFontStyle *font_style)
+{
+    const cairo_font_options_t *options;
+
+    g_return_val_if_fail(ADG_IS_FONT_STYLE(font_style), NULL);
+
+    G_LOCK(_adg_font_cache);
+    options = _adg_cached_options(font_style);
+    G_UNLOCK(_adg_font_cache);
 
     return options;
 }
@@ -340,6 +425,11 @@ adg_font_style_new_options(AdgFontStyle *font_style)
  * Gets the scaled font of @font_style. The returned font is
  * owned by @font_style and must not be destroyed by the caller.
  *
+ * The last few scaled fonts are cached by @font_style, one per
+ * @ctm (translation excluded), so entities with different global
+ * matrices sharing the same font style do not rebuild them at
+ * every request.
+ *
  * Returns: (transfer none): the scaled font.
  *
  * Since: 1.0
@@ -349,42 +439,61 @@ adg_font_style_get_scaled_font(AdgFontStyle *font_style,
                                const cairo_matrix_t *ctm)
 {
     AdgFontStylePrivate *data;
-    cairo_font_options_t *options;
     cairo_matrix_t matrix;
+    cairo_scaled_font_t *font;
+    gint n;
 
     g_return_val_if_fail(ADG_IS_FONT_STYLE(font_style), NULL);
     g_return_val_if_fail(ctm != NULL, NULL);
 
     data = font_style->data;
 
-    /* Check for cached font */
-    if (data->font != NULL) {
+    G_LOCK(_adg_font_cache);
+
+    /* Look for a cached font: the scaled font is valid only if the
+     * two ctm match, translation excluded */
+    for (n = 0; n < ADG_FONT_STYLE_CACHE_SIZE; ++n) {
         cairo_matrix_t font_ctm;
 
-        cairo_scaled_font_get_ctm(data->font, &font_ctm);
+        font = data->fonts[n];
+        if (font == NULL)
+            break;
 
-        /* The scaled font is valid only if the two ctm match */
+        cairo_scaled_font_get_ctm(font, &font_ctm);
         if (ctm->xx == font_ctm.xx && ctm->yy == font_ctm.yy &&
             ctm->xy == font_ctm.xy && ctm->yx == font_ctm.yx)
-            return data->font;
+            break;
 
-        /* No valid cache found: rebuild the scaled font */
-        adg_style_invalidate((AdgStyle *) font_style);
+        font = NULL;
     }
 
-    if (data->face == NULL) {
-        const gchar *family = data->family != NULL ? data->family : "";
+    if (font == NULL) {
+        /* No valid cache found: build a new scaled font in the first
+         * free slot, dropping the least recently used one if needed */
+        if (n == ADG_FONT_STYLE_CACHE_SIZE) {
+            n = ADG_FONT_STYLE_CACHE_SIZE - 1;
+            cairo_scaled_font_destroy(data->fonts[n]);
+        }
+
+        if (data->face == NULL) {
+            const gchar *family = data->family != NULL ? data->family : "";
 
-        data->face = cairo_toy_font_face_create(family, data->slant,
-                                                data->weight);
+            data->face = cairo_toy_font_face_create(family, data->slant,
+                                                    data->weight);
+        }
+
+        cairo_matrix_init_scale(&matrix, data->size, data->size);
+        font = cairo_scaled_font_create(data->face, &matrix, ctm,
+                                        _adg_cached_options(font_style));
     }
 
-    cairo_matrix_init_scale(&matrix, data->size, data->size);
-    options = adg_font_style_new_options(font_style);
-    data->font = cairo_scaled_font_create(data->face, &matrix, ctm, options);
-    cairo_font_options_destroy(options);
+    /* Move the font to the head of the cache */
+    memmove(data->fonts + 1, data->fonts, sizeof(data->fonts[0]) * n);
+    data->fonts[0] = font;
 
-    return data->font;
+    G_UNLOCK(_adg_font_cache);
+
+    return font;
 }
 
 /**
@@ -753,6 +862,117 @@ adg_font_style_get_hint_metrics(AdgFontStyle *font_style)
     return data->hint_metrics;
 }
 
+/**
+ * adg_font_style_switch_outlines:
+ * @font_style: an #AdgFontStyle object
+ * @state: the new outlines state
+ *
+ * Sets the #AdgFontStyle:outlines property of @font_style to @state.
+ * When enabled, adg_font_style_show_glyphs() fills the glyph outlines
+ * instead of showing the glyphs, so the texts are self-contained in
+ * vector outputs and no font is subsetted or embedded.
+ *
+ * Since: 1.0
+ **/
+void
+adg_font_style_switch_outlines(AdgFontStyle *font_style, gboolean state)
+{
+    g_return_if_fail(ADG_IS_FONT_STYLE(font_style));
+    g_object_set(font_style, "outlines", state, NULL);
+}
+
+/**
+ * adg_font_style_has_outlines:
+ * @font_style: an #AdgFontStyle object
+ *
+ * Gets the current state of the #AdgFontStyle:outlines property.
+ *
+ * Returns: %TRUE if the texts are rendered as outlines, %FALSE otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_font_style_has_outlines(AdgFontStyle *font_style)
+{
+    AdgFontStylePrivate *data;
+
+    g_return_val_if_fail(ADG_IS_FONT_STYLE(font_style), FALSE);
+
+    data = font_style->data;
+
+    return data->outlines;
+}
+
+/**
+ * adg_font_style_show_glyphs:
+ * @font_style: an #AdgFontStyle object
+ * @cr: the destination cairo context
+ * @font: the scaled font used to compute @glyphs
+ * @glyphs: (array length=num_glyphs): the glyphs to show
+ * @num_glyphs: number of elements in @glyphs
+ *
+ * Renders @glyphs on @cr using the current source. This is a plain
+ * cairo_show_glyphs() call with the current font of @cr unless the
+ * #AdgFontStyle:outlines property of @font_style is enabled: in that
+ * case the outlines of the glyphs of @font, fetched
+ * from a process-wide cache indexed by font face and glyph index, are
+ * appended to the current path and filled.
+ *
+ * The outlines are extracted without hinting, so they are resolution
+ * independent and can be shared by any scaled font of the same face.
+ *
+ * Since: 1.0
+ **/
+void
+adg_font_style_show_glyphs(AdgFontStyle *font_style, cairo_t *cr,
+                           cairo_scaled_font_t *font,
+                           const cairo_glyph_t *glyphs, int num_glyphs)
+{
+    AdgFontStylePrivate *data;
+    cairo_font_face_t *face;
+    cairo_matrix_t saved, unit;
+    const cairo_path_t *path;
+    int n;
+
+    g_return_if_fail(ADG_IS_FONT_STYLE(font_style));
+    g_return_if_fail(cr != NULL);
+    g_return_if_fail(font != NULL);
+    g_return_if_fail(glyphs != NULL || num_glyphs == 0);
+
+    data = font_style->data;
+
+    if (! data->outlines) {
+        cairo_show_glyphs(cr, (cairo_glyph_t *) glyphs, num_glyphs);
+        return;
+    }
+
+    face = cairo_scaled_font_get_font_face(font);
+    cairo_scaled_font_get_font_matrix(font, &unit);
+    cairo_matrix_scale(&unit, 1 / _ADG_OUTLINE_SIZE, 1 / _ADG_OUTLINE_SIZE);
+    cairo_get_matrix(cr, &saved);
+    cairo_new_path(cr);
+
+    G_LOCK(_adg_outline_cache);
+
+    for (n = 0; n < num_glyphs; ++n) {
+        path = _adg_cached_outline(face, glyphs[n].index);
+        if (path == NULL)
+            continue;
+
+        /* cairo_append_path() maps the outline through the current
+         * matrix, so only the matrix changes between the glyphs */
+        cairo_set_matrix(cr, &saved);
+        cairo_translate(cr, glyphs[n].x, glyphs[n].y);
+        cairo_transform(cr, &unit);
+        cairo_append_path(cr, path);
+    }
+
+    G_UNLOCK(_adg_outline_cache);
+
+    cairo_set_matrix(cr, &saved);
+    cairo_fill(cr);
+}
+
 
 static void
 _adg_invalidate(AdgStyle *style)
@@ -760,18 +980,31 @@ _adg_invalidate(AdgStyle *style)
     AdgFontStyle *font_style;
     AdgFontStylePrivate *data;
 
+    gint n;
+
     font_style = (AdgFontStyle *) style;
     data = font_style->data;
 
-    if (data->font != NULL) {
-        cairo_scaled_font_destroy(data->font);
-        data->font = NULL;
+    G_LOCK(_adg_font_cache);
+
+    for (n = 0; n < ADG_FONT_STYLE_CACHE_SIZE; ++n) {
+        if (data->fonts[n] != NULL) {
+            cairo_scaled_font_destroy(data->fonts[n]);
+            data->fonts[n] = NULL;
+        }
     }
 
-    if (data->face == NULL) {
+    if (data->face != NULL) {
         cairo_font_face_destroy(data->face);
         data->face = NULL;
     }
+
+    if (data->options != NULL) {
+        cairo_font_options_destroy(data->options);
+        data->options = NULL;
+    }
+
+    G_UNLOCK(_adg_font_cache);
 }
 
 static void
@@ -792,3 +1025,110 @@ _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 
     cairo_set_scaled_font(cr, font);
 }
+
+/* Must be called with _adg_font_cache locked */
+static const cairo_font_options_t *
+_adg_cached_options(AdgFontStyle *font_style)
+{
+    AdgFontStylePrivate *data = font_style->data;
+
+    if (data->options == NULL) {
+        data->options = cairo_font_options_create();
+        cairo_font_options_set_antialias(data->options, data->antialias);
+        cairo_font_options_set_subpixel_order(data->options, data->subpixel_order);
+        cairo_font_options_set_hint_style(data->options, data->hint_style);
+        cairo_font_options_set_hint_metrics(data->options, data->hint_metrics);
+    }
+
+    return data->options;
+}
+
+/* Must be called with _adg_outline_cache locked */
+static const cairo_path_t *
+_adg_cached_outline(cairo_font_face_t *face, unsigned long index)
+{
+    AdgOutlineKey key, *new_key;
+    cairo_path_t *path;
+    cairo_matrix_t matrix, ctm;
+    cairo_font_options_t *options;
+    cairo_scaled_font_t *font;
+    cairo_surface_t *surface;
+    cairo_glyph_t glyph;
+    cairo_t *cr;
+
+    if (_adg_outlines == NULL)
+        _adg_outlines = g_hash_table_new_full(_adg_outline_hash,
+                                              _adg_outline_equal,
+                                              _adg_outline_free,
+                                              (GDestroyNotify) cairo_path_destroy);
+
+    key.face = face;
+    key.index = index;
+    path = g_hash_table_lookup(_adg_outlines, &key);
+    if (path != NULL)
+        return path;
+
+    /* The outlines are rarely more than a few thousands: when the
+     * limit is reached, simply start over */
+    if (g_hash_table_size(_adg_outlines) >= _ADG_OUTLINE_CACHE_SIZE)
+        g_hash_table_remove_all(_adg_outlines);
+
+    cairo_matrix_init_scale(&matrix, _ADG_OUTLINE_SIZE, _ADG_OUTLINE_SIZE);
+    cairo_matrix_init_identity(&ctm);
+    options = cairo_font_options_create();
+    cairo_font_options_set_hint_style(options, CAIRO_HINT_STYLE_NONE);
+    cairo_font_options_set_hint_metrics(options, CAIRO_HINT_METRICS_OFF);
+    font = cairo_scaled_font_create(face, &matrix, &ctm, options);
+    cairo_font_options_destroy(options);
+
+    /* The surface is never painted: it only hosts the path */
+    surface = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+    cr = cairo_create(surface);
+    cairo_set_scaled_font(cr, font);
+    glyph.index = index;
+    glyph.x = 0;
+    glyph.y = 0;
+    cairo_glyph_path(cr, &glyph, 1);
+    path = cairo_copy_path(cr);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    cairo_scaled_font_destroy(font);
+
+    if (path->status != CAIRO_STATUS_SUCCESS) {
+        cairo_path_destroy(path);
+        return NULL;
+    }
+
+    new_key = g_new(AdgOutlineKey, 1);
+    new_key->face = cairo_font_face_reference(face);
+    new_key->index = index;
+    g_hash_table_insert(_adg_outlines, new_key, path);
+
+    return path;
+}
+
+static guint
+_adg_outline_hash(gconstpointer key)
+{
+    const AdgOutlineKey *outline_key = key;
+    return g_direct_hash(outline_key->face) ^ (guint) outline_key->index;
+}
+
+static gboolean
+_adg_outline_equal(gconstpointer key1, gconstpointer key2)
+{
+    const AdgOutlineKey *outline_key1 = key1;
+    const AdgOutlineKey *outline_key2 = key2;
+
+    return outline_key1->face == outline_key2->face &&
+           outline_key1->index == outline_key2->index;
+}
+
+static void
+_adg_outline_free(gpointer key)
+{
+    AdgOutlineKey *outline_key = key;
+
+    cairo_font_face_destroy(outline_key->face);
+    g_free(outline_key);
+}
@@ -56,6 +56,8 @@ GType           adg_font_style_get_type         (void);
 AdgFontStyle *  adg_font_style_new              (void);
 cairo_font_options_t *
                 adg_font_style_new_options      (AdgFontStyle    *font_style);
+const cairo_font_options_t *
+                adg_font_style_get_options      (AdgFontStyle    *font_style);
 cairo_scaled_font_t *
                 adg_font_style_get_scaled_font  (AdgFontStyle    *font_style,
                                                  const cairo_matrix_t *ctm);
@@ -94,6 +96,14 @@ void            adg_font_style_set_hint_metrics (AdgFontStyle    *font_style,
                                                  cairo_hint_metrics_t hint_metrics);
 cairo_hint_metrics_t
                 adg_font_style_get_hint_metrics (AdgFontStyle    *font_style);
+void            adg_font_style_switch_outlines  (AdgFontStyle    *font_style,
+                                                 gboolean         state);
+gboolean        adg_font_style_has_outlines     (AdgFontStyle    *font_style);
+void            adg_font_style_show_glyphs      (AdgFontStyle    *font_style,
+                                                 cairo_t         *cr,
+                                                 cairo_scaled_font_t *font,
+                                                 const cairo_glyph_t *glyphs,
+                                                 int              num_glyphs);
 
 G_END_DECLS
 
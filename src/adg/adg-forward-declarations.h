@@ -38,6 +38,7 @@ G_BEGIN_DECLS
 typedef struct _AdgCanvas       AdgCanvas;
 typedef struct _AdgStyle        AdgStyle;
 typedef struct _AdgPoint        AdgPoint;
+typedef struct _AdgRenderContext AdgRenderContext;
 
 /* Needed by adg-table.h */
 typedef struct _AdgTableRow     AdgTableRow;
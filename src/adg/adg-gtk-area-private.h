@@ -31,10 +31,52 @@ struct _AdgGtkAreaPrivate {
     gdouble          factor;
     gboolean         autozoom;
     cairo_matrix_t   render_map;
+    gboolean         progressive;
+    gboolean         threaded;
+    gboolean         accelerated;
+    gboolean         statistics;
 
     gboolean         initialized;
     CpmlExtents      extents;
     gdouble          x_event, y_event;
+    gulong           damaged_handler;
+    guint            damage_id;
+
+    struct {
+        GTimer          *timer;
+        gdouble          last;
+        gdouble          fps;
+        gdouble          arrange;
+        gdouble          render;
+    }                stats;
+
+    struct {
+        cairo_surface_t *surface;
+        cairo_matrix_t   map;
+        gint             width, height;
+        gboolean         is_complete;
+        GPtrArray       *nodes;
+        GPtrArray       *list;
+        guint            n;
+        guint            idle_id;
+    }                back;
+
+    struct {
+        cairo_surface_t *recording;
+        cairo_surface_t *image;
+        cairo_matrix_t   map;
+        gint             width, height;
+        gboolean         is_stale;
+        gboolean         is_busy;
+    }                raster;
+
+    struct {
+        cairo_surface_t *surface;
+        cairo_matrix_t   view;
+        gint             width, height;
+        gint             margin_x, margin_y;
+        guint            timeout_id;
+    }                device;
 };
 
 G_END_DECLS
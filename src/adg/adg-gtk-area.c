@@ -47,6 +47,44 @@
  * without affecting the other layers. Local transformations,
  * instead, are directly applied to the local matrix of the canvas.
  *
+ * Huge canvases can take a long time to be rendered, blocking the
+ * user interface at every zoom or pan. When the
+ * #AdgGtkArea:progressive-rendering property is enabled, every
+ * exposure with a new render map or allocation is served by a
+ * draft pass that skips texts and hatches and flattens the curves
+ * with a coarser tolerance. The full detail rendering is then
+ * performed in a back buffer, one time slice at a time while the
+ * main loop is idle, and shown only when complete.
+ *
+ * The #AdgGtkArea:threaded-rendering property goes further: the
+ * canvas is recorded on the main thread only when its content
+ * changes, while the rasterization of that recording with the
+ * current render map is performed on a worker thread. The
+ * exposures just paint the last completed image (remapped to the
+ * current render map), so zooming and panning in global space
+ * never wait for the rendering.
+ *
+ * The #AdgGtkArea:accelerated-rendering property keeps the rendered
+ * canvas in a surface native to the window target, usually living
+ * in video memory, a bit larger than the widget. Zooming and panning
+ * are served by compositing that surface, so the device does the
+ * scaling, and the canvas is rendered again only when the surface
+ * does not cover the widget anymore or the interaction settles.
+ *
+ * For interactive profiling, the #AdgGtkArea:statistics property
+ * overlays the frame rate and the time spent arranging and rendering
+ * the canvas on the top/left corner of the widget.
+ *
+ * Any change on the entities of the canvas damages only a region of
+ * it (see adg_canvas_take_damage()): #AdgGtkArea collects the damages
+ * while the main loop is idle and exposes only the damaged region of
+ * the widget, so there is no need to redraw it as a whole. The damages
+ * are flushed once per frame, just before the redraw: this is also
+ * the only place where the extents are refreshed after a change of
+ * the canvas, so a burst of changes (as during a parametric edit)
+ * leads to a single #AdgGtkArea::extents-changed emission and to a
+ * single redraw.
+ *
  * Since: 1.0
  **/
 
@@ -80,13 +118,21 @@
 
 #include "adg-internal.h"
 #include <gtk/gtk.h>
+#include <math.h>
 
 #include "adg-container.h"
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-stroke.h"
+#include "adg-hatch.h"
+#include "adg-textual.h"
 #include "adg-table.h"
 #include "adg-title-block.h"
+#include "adg-spatial-index.h"
 #include <adg-canvas.h>
 #include "adg-gtk-utils.h"
 #include "adg-cairo-fallback.h"
+#include "adg-entity-private.h"
 
 #include "adg-gtk-area.h"
 #include "adg-gtk-area-private.h"
@@ -94,6 +140,23 @@
 #define _ADG_OLD_OBJECT_CLASS   ((GObjectClass *) adg_gtk_area_parent_class)
 #define _ADG_OLD_WIDGET_CLASS   ((GtkWidgetClass *) adg_gtk_area_parent_class)
 
+/* Tolerance used by the draft pass of the progressive rendering */
+#define _ADG_DRAFT_TOLERANCE    1.
+/* Time (in seconds) spent by every full detail rendering slice */
+#define _ADG_SLICE_TIME         0.01
+/* Enlargement (in global space) of the damaged regions */
+#define _ADG_DAMAGE_PADDING     10.
+/* Maximum distance (in device space) of a picked stroke */
+#define _ADG_PICK_TOLERANCE     3.
+/* Portion of the widget size rendered around it by the accelerated mode */
+#define _ADG_DEVICE_MARGIN      0.25
+/* Delay (in milliseconds) before rendering a remapped device surface */
+#define _ADG_DEVICE_DELAY       150
+/* Smoothing factor applied to the statistics of every new frame */
+#define _ADG_STATS_SMOOTHING    0.1
+/* Priority of the damage flush: after the resizes and before the redraw */
+#define _ADG_FLUSH_PRIORITY     (GDK_PRIORITY_REDRAW - 10)
+
 
 G_DEFINE_TYPE(AdgGtkArea, adg_gtk_area, GTK_TYPE_DRAWING_AREA)
 
@@ -102,7 +165,11 @@ enum {
     PROP_CANVAS,
     PROP_FACTOR,
     PROP_AUTOZOOM,
-    PROP_RENDER_MAP
+    PROP_RENDER_MAP,
+    PROP_PROGRESSIVE_RENDERING,
+    PROP_THREADED_RENDERING,
+    PROP_ACCELERATED_RENDERING,
+    PROP_STATISTICS
 };
 
 enum {
@@ -115,6 +182,15 @@ enum {
 static guint    _adg_signals[LAST_SIGNAL] = { 0 };
 
 
+typedef struct {
+    AdgGtkArea      *area;
+    cairo_surface_t *recording;
+    cairo_surface_t *image;
+    cairo_matrix_t   map;
+    gint             width, height;
+} AdgRasterJob;
+
+
 static const CpmlExtents *
 _adg_get_extents(AdgGtkArea *area)
 {
@@ -134,7 +210,7 @@ _adg_get_extents(AdgGtkArea *area)
         entity = (AdgEntity *) canvas;
 
         adg_entity_arrange(entity);
-        extents = adg_entity_get_extents(entity);
+        extents = _adg_entity_get_extents(entity);
 
         if (extents != NULL) {
             data->extents = *extents;
@@ -149,6 +225,848 @@ _adg_get_extents(AdgGtkArea *area)
     return &data->extents;
 }
 
+static gboolean
+_adg_pick_stroke(AdgStroke *stroke, const cairo_matrix_t *render_map,
+                 const CpmlPair *device)
+{
+    AdgEntity *entity;
+    AdgTrail *trail;
+    const cairo_path_t *cairo_path;
+    cairo_matrix_t map, inverted;
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlPair pair, closest;
+    gdouble pos;
+
+    entity = (AdgEntity *) stroke;
+    trail = adg_stroke_get_trail(stroke);
+    cairo_path = trail != NULL ? adg_trail_get_cairo_path(trail) : NULL;
+
+    if (cairo_path == NULL || !cpml_segment_from_cairo(&segment, (cairo_path_t *) cairo_path))
+        return FALSE;
+
+    /* Same chain used by the stroke to compute its extents,
+     * with the render map of the widget appended */
+    cairo_matrix_multiply(&map, adg_entity_get_combined_matrix(entity),
+                          render_map);
+    adg_matrix_copy(&inverted, &map);
+    if (cairo_matrix_invert(&inverted) != CAIRO_STATUS_SUCCESS)
+        return FALSE;
+
+    pair = *device;
+    cairo_matrix_transform_point(&inverted, &pair.x, &pair.y);
+
+    do {
+        pos = cpml_segment_get_closest_pos(&segment, &pair, &primitive);
+        if (pos < 0)
+            continue;
+
+        if (cpml_primitive_type(&primitive) == CPML_CURVE)
+            cpml_curve_put_pair_at_time(&primitive, pos, &closest);
+        else
+            cpml_primitive_put_pair_at(&primitive, pos, &closest);
+
+        /* The distance is checked in device space, so the tolerance
+         * does not depend on the zoom factor */
+        cairo_matrix_transform_point(&map, &closest.x, &closest.y);
+        if (cpml_pair_distance(&closest, device) <= _ADG_PICK_TOLERANCE)
+            return TRUE;
+    } while (cpml_segment_next(&segment));
+
+    return FALSE;
+}
+
+static gboolean
+_adg_pick_hit(AdgEntity *entity, const cairo_matrix_t *render_map,
+              const CpmlPair *device, const CpmlPair *pair)
+{
+    const CpmlExtents *extents;
+
+    /* Strokes are thin: the point must stay close to the path */
+    if (ADG_IS_STROKE(entity))
+        return _adg_pick_stroke((AdgStroke *) entity, render_map, device);
+
+    /* Anything else fills its extents (texts, dimensions, hatches...)
+     * so the extents check is precise enough */
+    extents = _adg_entity_get_extents(entity);
+
+    return extents != NULL && cpml_extents_pair_is_inside(extents, pair);
+}
+
+static void
+_adg_device_clear(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = area->data;
+
+    if (data->device.timeout_id != 0) {
+        g_source_remove(data->device.timeout_id);
+        data->device.timeout_id = 0;
+    }
+
+    if (data->device.surface != NULL) {
+        cairo_surface_destroy(data->device.surface);
+        data->device.surface = NULL;
+    }
+}
+
+static void
+_adg_back_clear(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+    GPtrArray *nodes;
+    AdgEntity *entity;
+    guint n;
+
+    data = area->data;
+
+    if (data->back.idle_id != 0) {
+        g_source_remove(data->back.idle_id);
+        data->back.idle_id = 0;
+    }
+
+    if (data->back.surface != NULL) {
+        cairo_surface_destroy(data->back.surface);
+        data->back.surface = NULL;
+    }
+
+    if (data->raster.recording != NULL) {
+        cairo_surface_destroy(data->raster.recording);
+        data->raster.recording = NULL;
+    }
+
+    _adg_device_clear(area);
+
+    data->back.is_complete = FALSE;
+    data->raster.is_stale = TRUE;
+    nodes = data->back.nodes;
+
+    if (nodes == NULL)
+        return;
+
+    /* Reset the pointers before disconnecting the handlers:
+     * this function can be reentered while unreferencing */
+    data->back.nodes = NULL;
+
+    for (n = 0; n < nodes->len; ++n) {
+        entity = g_ptr_array_index(nodes, n);
+        g_signal_handlers_disconnect_by_func(entity, _adg_back_clear, area);
+        g_object_unref(entity);
+    }
+
+    g_ptr_array_free(nodes, TRUE);
+    g_ptr_array_free(data->back.list, TRUE);
+    data->back.list = NULL;
+}
+
+static void
+_adg_back_track(AdgGtkArea *area, AdgEntity *entity)
+{
+    AdgGtkAreaPrivate *data;
+    GCallback callback;
+    GObject *object;
+
+    data = area->data;
+    callback = G_CALLBACK(_adg_back_clear);
+    object = (GObject *) entity;
+
+    /* Any change on a watched entity drops the back buffer */
+    g_object_ref(object);
+    g_ptr_array_add(data->back.nodes, entity);
+    g_signal_connect_swapped(object, "notify", callback, area);
+    g_signal_connect_swapped(object, "destroy", callback, area);
+    g_signal_connect_swapped(object, "global-changed", callback, area);
+    g_signal_connect_swapped(object, "local-changed", callback, area);
+    g_signal_connect_swapped(object, "invalidate", callback, area);
+
+    if (ADG_IS_CONTAINER(entity)) {
+        g_signal_connect_swapped(object, "add", callback, area);
+        g_signal_connect_swapped(object, "remove", callback, area);
+    }
+}
+
+static void
+_adg_back_walk(AdgGtkArea *area, AdgEntity *entity)
+{
+    AdgGtkAreaPrivate *data;
+    AdgEntityClass *container_class;
+
+    data = area->data;
+    container_class = g_type_class_peek(ADG_TYPE_CONTAINER);
+
+    _adg_back_track(area, entity);
+
+    /* Flatten only plain containers, as the render list of
+     * AdgCanvas does: any other entity is a rendering unit */
+    if (ADG_IS_CONTAINER(entity) &&
+        ADG_ENTITY_GET_CLASS(entity)->render == container_class->render) {
+        GSList *children;
+
+        children = adg_container_children((AdgContainer *) entity);
+        while (children != NULL) {
+            if (children->data != NULL)
+                _adg_back_walk(area, children->data);
+            children = g_slist_delete_link(children, children);
+        }
+    } else if (ADG_ENTITY_GET_CLASS(entity)->render != NULL) {
+        g_ptr_array_add(data->back.list, entity);
+    }
+}
+
+static gboolean
+_adg_back_step(gpointer user_data)
+{
+    AdgGtkArea *area;
+    AdgGtkAreaPrivate *data;
+    GPtrArray *list;
+    GTimer *timer;
+    cairo_t *cr;
+
+    area = (AdgGtkArea *) user_data;
+    data = area->data;
+    list = data->back.list;
+    timer = g_timer_new();
+
+    cr = cairo_create(data->back.surface);
+    cairo_transform(cr, &data->back.map);
+
+    /* Render at least one entity per slice. Bail out if the
+     * back buffer has been dropped by some side effect */
+    do {
+        adg_entity_render(g_ptr_array_index(list, data->back.n), cr);
+        ++data->back.n;
+    } while (data->back.list == list && data->back.n < list->len &&
+             g_timer_elapsed(timer, NULL) < _ADG_SLICE_TIME);
+
+    cairo_destroy(cr);
+    g_timer_destroy(timer);
+
+    if (data->back.list != list)
+        return FALSE;
+
+    if (data->back.n < list->len)
+        return TRUE;
+
+    data->back.idle_id = 0;
+    data->back.is_complete = TRUE;
+    gtk_widget_queue_draw((GtkWidget *) area);
+    return FALSE;
+}
+
+static void
+_adg_back_watch(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+    AdgCanvas *canvas;
+    GSList *children;
+    AdgEntity *title_block;
+
+    data = area->data;
+    canvas = data->canvas;
+
+    _adg_back_clear(area);
+
+    /* The canvas must be arranged before watching its entities:
+     * arranging it could change the matrices of the title block */
+    adg_entity_arrange((AdgEntity *) canvas);
+
+    data->back.nodes = g_ptr_array_new();
+    data->back.list = g_ptr_array_new();
+    data->back.n = 0;
+
+    /* The canvas itself is watched but not rendered as a unit */
+    _adg_back_track(area, (AdgEntity *) canvas);
+
+    /* Keep the same order used by AdgCanvas */
+    title_block = (AdgEntity *) adg_canvas_get_title_block(canvas);
+    if (title_block != NULL)
+        _adg_back_walk(area, title_block);
+
+    children = adg_container_children((AdgContainer *) canvas);
+    while (children != NULL) {
+        if (children->data != NULL)
+            _adg_back_walk(area, children->data);
+        children = g_slist_delete_link(children, children);
+    }
+}
+
+static void
+_adg_back_start(AdgGtkArea *area, cairo_t *cr, gint width, gint height)
+{
+    AdgGtkAreaPrivate *data;
+    AdgCanvas *canvas;
+    cairo_t *back_cr;
+
+    data = area->data;
+    canvas = data->canvas;
+
+    _adg_back_watch(area);
+
+    data->back.surface = cairo_surface_create_similar(cairo_get_target(cr),
+                                                      CAIRO_CONTENT_COLOR_ALPHA,
+                                                      width, height);
+    adg_matrix_copy(&data->back.map, &data->render_map);
+    data->back.width = width;
+    data->back.height = height;
+
+    /* The backdrop is cheap: render it straight away */
+    back_cr = cairo_create(data->back.surface);
+    cairo_transform(back_cr, &data->back.map);
+    adg_canvas_render_backdrop(canvas, back_cr);
+    cairo_destroy(back_cr);
+
+    if (data->back.list->len == 0)
+        data->back.is_complete = TRUE;
+    else
+        data->back.idle_id = g_idle_add(_adg_back_step, area);
+}
+
+static void
+_adg_render_draft(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data;
+    GPtrArray *list;
+    AdgEntity *entity;
+    guint n;
+
+    data = area->data;
+    list = data->back.list;
+
+    cairo_save(cr);
+    cairo_transform(cr, &data->render_map);
+    cairo_set_tolerance(cr, _ADG_DRAFT_TOLERANCE);
+    adg_canvas_render_backdrop(data->canvas, cr);
+
+    for (n = 0; data->back.list == list && n < list->len; ++n) {
+        entity = g_ptr_array_index(list, n);
+        if (!ADG_IS_TEXTUAL(entity) && !ADG_IS_HATCH(entity))
+            adg_entity_render(entity, cr);
+    }
+
+    cairo_restore(cr);
+}
+
+static void
+_adg_raster_clear(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = area->data;
+
+    if (data->raster.image != NULL) {
+        cairo_surface_destroy(data->raster.image);
+        data->raster.image = NULL;
+    }
+
+    /* This also drops the recording */
+    _adg_back_clear(area);
+}
+
+static gboolean
+_adg_raster_done(gpointer user_data)
+{
+    AdgRasterJob *job;
+    AdgGtkAreaPrivate *data;
+
+    job = user_data;
+    data = job->area->data;
+    data->raster.is_busy = FALSE;
+
+    /* An image of an outdated recording is still better than
+     * nothing: keep it but mark it as stale */
+    if (data->threaded && data->canvas != NULL) {
+        if (data->raster.image != NULL)
+            cairo_surface_destroy(data->raster.image);
+        data->raster.image = job->image;
+        adg_matrix_copy(&data->raster.map, &job->map);
+        data->raster.width = job->width;
+        data->raster.height = job->height;
+        data->raster.is_stale = job->recording != data->raster.recording;
+        job->image = NULL;
+        gtk_widget_queue_draw((GtkWidget *) job->area);
+    }
+
+    if (job->image != NULL)
+        cairo_surface_destroy(job->image);
+    cairo_surface_destroy(job->recording);
+    g_object_unref(job->area);
+    g_free(job);
+
+    return FALSE;
+}
+
+/* Does not access any ADG object, so it can be run on any thread */
+static void
+_adg_raster_run(gpointer job_data, gpointer user_data)
+{
+    AdgRasterJob *job;
+    cairo_t *cr;
+
+    job = job_data;
+    job->image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                            job->width, job->height);
+
+    cr = cairo_create(job->image);
+    cairo_transform(cr, &job->map);
+    cairo_set_source_surface(cr, job->recording, 0, 0);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    g_idle_add(_adg_raster_done, job);
+}
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+
+static GThreadPool *
+_adg_raster_pool(void)
+{
+    static GThreadPool *pool = NULL;
+    static gsize initialized = 0;
+
+    if (g_once_init_enter(&initialized)) {
+        pool = g_thread_pool_new(_adg_raster_run, NULL,
+                                 g_get_num_processors(), FALSE, NULL);
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return pool;
+}
+
+static void
+_adg_raster_push(AdgRasterJob *job)
+{
+    GThreadPool *pool = _adg_raster_pool();
+
+    if (pool != NULL)
+        g_thread_pool_push(pool, job, NULL);
+    else
+        _adg_raster_run(job, NULL);
+}
+
+#else
+
+static void
+_adg_raster_push(AdgRasterJob *job)
+{
+    /* Thread pools not supported by this GLib version */
+    _adg_raster_run(job, NULL);
+}
+
+#endif
+
+static void
+_adg_raster_schedule(AdgGtkArea *area, gint width, gint height)
+{
+    AdgGtkAreaPrivate *data;
+    AdgRasterJob *job;
+
+    data = area->data;
+
+    /* Only one job per area is in flight: any further request is
+     * coalesced and served by the draw following its completion */
+    data->raster.is_busy = TRUE;
+
+    job = g_new(AdgRasterJob, 1);
+    job->area = g_object_ref(area);
+    job->recording = cairo_surface_reference(data->raster.recording);
+    job->image = NULL;
+    adg_matrix_copy(&job->map, &data->render_map);
+    job->width = width;
+    job->height = height;
+
+    _adg_raster_push(job);
+}
+
+static void
+_adg_render_threaded(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data;
+    GtkAllocation allocation;
+    cairo_matrix_t map;
+    cairo_t *recording_cr;
+
+    data = area->data;
+    gtk_widget_get_allocation((GtkWidget *) area, &allocation);
+
+    if (data->raster.recording == NULL) {
+        cairo_surface_t *recording;
+
+        _adg_back_watch(area);
+        recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA,
+                                                   NULL);
+        recording_cr = cairo_create(recording);
+        adg_entity_render((AdgEntity *) data->canvas, recording_cr);
+        cairo_destroy(recording_cr);
+
+        /* Set it only now: rendering could drop the recording */
+        data->raster.recording = recording;
+        data->raster.is_stale = TRUE;
+    }
+
+    cairo_save(cr);
+
+    if (data->raster.image != NULL) {
+        /* Remap the image from its render map to the current one */
+        adg_matrix_copy(&map, &data->raster.map);
+        if (cairo_matrix_invert(&map) == CAIRO_STATUS_SUCCESS) {
+            cairo_matrix_multiply(&map, &map, &data->render_map);
+            cairo_transform(cr, &map);
+            cairo_set_source_surface(cr, data->raster.image, 0, 0);
+            cairo_paint(cr);
+        }
+    } else {
+        /* No image available yet: replay the recording in place */
+        cairo_transform(cr, &data->render_map);
+        cairo_set_source_surface(cr, data->raster.recording, 0, 0);
+        cairo_paint(cr);
+    }
+
+    cairo_restore(cr);
+
+    if (!data->raster.is_busy &&
+        (data->raster.image == NULL || data->raster.is_stale ||
+         data->raster.width != allocation.width ||
+         data->raster.height != allocation.height ||
+         !adg_matrix_equal(&data->raster.map, &data->render_map))) {
+        _adg_raster_schedule(area, allocation.width, allocation.height);
+    }
+}
+
+static gboolean
+_adg_device_refresh(gpointer user_data)
+{
+    AdgGtkArea *area;
+    AdgGtkAreaPrivate *data;
+
+    area = (AdgGtkArea *) user_data;
+    data = area->data;
+    data->device.timeout_id = 0;
+
+    /* The entities are still watched: only the surface is dropped */
+    if (data->device.surface != NULL) {
+        cairo_surface_destroy(data->device.surface);
+        data->device.surface = NULL;
+    }
+
+    gtk_widget_queue_draw((GtkWidget *) area);
+    return FALSE;
+}
+
+static void
+_adg_device_start(AdgGtkArea *area, cairo_t *cr, gint width, gint height)
+{
+    AdgGtkAreaPrivate *data;
+    cairo_surface_t *surface;
+    cairo_matrix_t map;
+    cairo_t *device_cr;
+
+    data = area->data;
+
+    /* Watching the entities drops the device surface on changes */
+    if (data->back.nodes == NULL)
+        _adg_back_watch(area);
+    else
+        _adg_device_clear(area);
+
+    data->device.width = width;
+    data->device.height = height;
+    data->device.margin_x = ceil(width * _ADG_DEVICE_MARGIN);
+    data->device.margin_y = ceil(height * _ADG_DEVICE_MARGIN);
+    adg_matrix_copy(&data->device.view, &data->render_map);
+
+    surface = cairo_surface_create_similar(cairo_get_target(cr),
+                                           CAIRO_CONTENT_COLOR_ALPHA,
+                                           width + data->device.margin_x * 2,
+                                           height + data->device.margin_y * 2);
+
+    cairo_matrix_init_translate(&map, data->device.margin_x,
+                                data->device.margin_y);
+    cairo_matrix_multiply(&map, &data->render_map, &map);
+
+    device_cr = cairo_create(surface);
+    cairo_transform(device_cr, &map);
+    adg_entity_render((AdgEntity *) data->canvas, device_cr);
+    cairo_destroy(device_cr);
+
+    /* Set it only now: rendering could drop the device surface */
+    _adg_device_clear(area);
+    data->device.surface = surface;
+}
+
+/* Gets the matrix mapping the device surface on the widget with
+ * the current render map. Returns FALSE if the device surface does
+ * not cover the whole widget anymore, so it must be rendered again */
+static gboolean
+_adg_device_remap(AdgGtkArea *area, gint width, gint height,
+                  cairo_matrix_t *remap)
+{
+    AdgGtkAreaPrivate *data;
+    cairo_matrix_t inverted;
+    gdouble x[4], y[4];
+    gint n;
+
+    data = area->data;
+
+    cairo_matrix_init_translate(remap, data->device.margin_x,
+                                data->device.margin_y);
+    cairo_matrix_multiply(remap, &data->device.view, remap);
+    if (cairo_matrix_invert(remap) != CAIRO_STATUS_SUCCESS)
+        return FALSE;
+    cairo_matrix_multiply(remap, remap, &data->render_map);
+
+    adg_matrix_copy(&inverted, remap);
+    if (cairo_matrix_invert(&inverted) != CAIRO_STATUS_SUCCESS)
+        return FALSE;
+
+    x[0] = x[3] = 0;
+    x[1] = x[2] = width;
+    y[0] = y[1] = 0;
+    y[2] = y[3] = height;
+
+    for (n = 0; n < 4; ++n) {
+        cairo_matrix_transform_point(&inverted, &x[n], &y[n]);
+        if (x[n] < 0 || y[n] < 0 ||
+            x[n] > width + data->device.margin_x * 2 ||
+            y[n] > height + data->device.margin_y * 2)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+_adg_render_accelerated(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data;
+    GtkAllocation allocation;
+    cairo_matrix_t remap;
+
+    data = area->data;
+    gtk_widget_get_allocation((GtkWidget *) area, &allocation);
+
+    if (data->device.surface == NULL ||
+        data->device.width != allocation.width ||
+        data->device.height != allocation.height ||
+        !_adg_device_remap(area, allocation.width, allocation.height, &remap)) {
+        _adg_device_start(area, cr, allocation.width, allocation.height);
+        _adg_device_remap(area, allocation.width, allocation.height, &remap);
+    } else if (!adg_matrix_equal(&data->device.view, &data->render_map)) {
+        /* Compose the remapped surface while zooming or panning and
+         * render the exact one when the render map stops changing */
+        if (data->device.timeout_id != 0)
+            g_source_remove(data->device.timeout_id);
+        data->device.timeout_id = g_timeout_add(_ADG_DEVICE_DELAY,
+                                                _adg_device_refresh, area);
+    }
+
+    cairo_save(cr);
+    cairo_transform(cr, &remap);
+    cairo_set_source_surface(cr, data->device.surface, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+static void
+_adg_render_canvas(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data;
+    GtkAllocation allocation;
+
+    data = area->data;
+
+    if (data->threaded) {
+        _adg_render_threaded(area, cr);
+        return;
+    }
+
+    if (data->accelerated) {
+        _adg_render_accelerated(area, cr);
+        return;
+    }
+
+    if (!data->progressive) {
+        cairo_transform(cr, &data->render_map);
+        adg_entity_render((AdgEntity *) data->canvas, cr);
+        return;
+    }
+
+    gtk_widget_get_allocation((GtkWidget *) area, &allocation);
+
+    if (data->back.surface == NULL ||
+        data->back.width != allocation.width ||
+        data->back.height != allocation.height ||
+        !adg_matrix_equal(&data->back.map, &data->render_map)) {
+        _adg_back_start(area, cr, allocation.width, allocation.height);
+    }
+
+    if (data->back.is_complete) {
+        cairo_set_source_surface(cr, data->back.surface, 0, 0);
+        cairo_paint(cr);
+    } else {
+        _adg_render_draft(area, cr);
+    }
+}
+
+static gdouble
+_adg_stats_smooth(gdouble old_value, gdouble new_value)
+{
+    return old_value + (new_value - old_value) * _ADG_STATS_SMOOTHING;
+}
+
+static void
+_adg_render_stats(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data;
+    gchar *lines[3];
+    cairo_text_extents_t extents;
+    gdouble width;
+    gint n;
+
+    data = area->data;
+    lines[0] = g_strdup_printf(_("%.1f fps"), data->stats.fps);
+    lines[1] = g_strdup_printf(_("arrange %.2f ms"), data->stats.arrange * 1000);
+    lines[2] = g_strdup_printf(_("render %.2f ms"), data->stats.render * 1000);
+
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_select_font_face(cr, "monospace",
+                           CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 12);
+
+    width = 0;
+    for (n = 0; n < G_N_ELEMENTS(lines); ++n) {
+        cairo_text_extents(cr, lines[n], &extents);
+        width = MAX(width, extents.x_advance);
+    }
+
+    cairo_rectangle(cr, 0, 0, width + 8, G_N_ELEMENTS(lines) * 14 + 6);
+    cairo_set_source_rgba(cr, 0, 0, 0, 0.6);
+    cairo_fill(cr);
+
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    for (n = 0; n < G_N_ELEMENTS(lines); ++n) {
+        cairo_move_to(cr, 4, 15 + n * 14);
+        cairo_show_text(cr, lines[n]);
+        g_free(lines[n]);
+    }
+
+    cairo_restore(cr);
+}
+
+/**
+ * _adg_render_area:
+ * @area: an #AdgGtkArea
+ * @cr: the destination cairo context
+ *
+ * Renders the canvas of @area on @cr. When #AdgGtkArea:statistics is
+ * enabled, the canvas is explicitly arranged before the rendering, so
+ * the time spent in the two phases can be measured separately, and
+ * the statistics are overlaid on top of it.
+ **/
+static void
+_adg_render_area(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data;
+    gdouble start, now;
+
+    data = area->data;
+
+    if (!data->statistics) {
+        _adg_render_canvas(area, cr);
+        return;
+    }
+
+    if (data->stats.timer == NULL)
+        data->stats.timer = g_timer_new();
+
+    start = g_timer_elapsed(data->stats.timer, NULL);
+    adg_entity_arrange((AdgEntity *) data->canvas);
+    now = g_timer_elapsed(data->stats.timer, NULL);
+    data->stats.arrange = _adg_stats_smooth(data->stats.arrange, now - start);
+
+    start = now;
+    cairo_save(cr);
+    _adg_render_canvas(area, cr);
+    cairo_restore(cr);
+    now = g_timer_elapsed(data->stats.timer, NULL);
+    data->stats.render = _adg_stats_smooth(data->stats.render, now - start);
+
+    /* Frames farther than one second do not contribute to the rate */
+    if (now - data->stats.last > 0 && now - data->stats.last < 1)
+        data->stats.fps = _adg_stats_smooth(data->stats.fps,
+                                            1 / (now - data->stats.last));
+    data->stats.last = now;
+
+    _adg_render_stats(area, cr);
+}
+
+
+static gboolean
+_adg_flush_damage(gpointer user_data)
+{
+    AdgGtkArea *area;
+    AdgGtkAreaPrivate *data;
+    CpmlExtents damage;
+    gint x, y, width, height;
+
+    area = (AdgGtkArea *) user_data;
+    data = area->data;
+    data->damage_id = 0;
+
+    if (data->canvas == NULL || !adg_canvas_take_damage(data->canvas, &damage))
+        return FALSE;
+
+    /* Refresh the extents once for all the collected changes: this
+     * emits #AdgGtkArea::extents-changed at most once per frame */
+    _adg_get_extents(area);
+
+    /* The back buffers are dropped as a whole anyway */
+    if (data->progressive || data->threaded || data->accelerated) {
+        gtk_widget_queue_draw((GtkWidget *) area);
+        return FALSE;
+    }
+
+    damage.org.x -= _ADG_DAMAGE_PADDING;
+    damage.org.y -= _ADG_DAMAGE_PADDING;
+    damage.size.x += _ADG_DAMAGE_PADDING * 2;
+    damage.size.y += _ADG_DAMAGE_PADDING * 2;
+    cpml_extents_transform(&damage, &data->render_map);
+
+    x = floor(damage.org.x);
+    y = floor(damage.org.y);
+    width = ceil(damage.org.x + damage.size.x) - x;
+    height = ceil(damage.org.y + damage.size.y) - y;
+
+    /* The exposure clips the rendering on the damaged area and
+     * the entities outside of it are culled by AdgEntity */
+    gtk_widget_queue_draw_area((GtkWidget *) area, x, y, width, height);
+    return FALSE;
+}
+
+static void
+_adg_canvas_damaged(AdgCanvas *canvas, AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = area->data;
+
+    /* Collect all the damages of the current frame */
+    if (data->damage_id == 0)
+        data->damage_id = g_idle_add_full(_ADG_FLUSH_PRIORITY,
+                                          _adg_flush_damage, area, NULL);
+}
+
+static void
+_adg_unbind_canvas(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = area->data;
+
+    if (data->damage_id != 0) {
+        g_source_remove(data->damage_id);
+        data->damage_id = 0;
+    }
+
+    if (data->damaged_handler != 0) {
+        g_signal_handler_disconnect(data->canvas, data->damaged_handler);
+        data->damaged_handler = 0;
+    }
+}
+
 
 static void
 _adg_get_property(GObject *object, guint prop_id,
@@ -169,6 +1087,18 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_RENDER_MAP:
         g_value_set_boxed(value, &data->render_map);
         break;
+    case PROP_PROGRESSIVE_RENDERING:
+        g_value_set_boolean(value, data->progressive);
+        break;
+    case PROP_THREADED_RENDERING:
+        g_value_set_boolean(value, data->threaded);
+        break;
+    case PROP_ACCELERATED_RENDERING:
+        g_value_set_boolean(value, data->accelerated);
+        break;
+    case PROP_STATISTICS:
+        g_value_set_boolean(value, data->statistics);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -191,11 +1121,17 @@ _adg_set_property(GObject *object, guint prop_id,
         new_canvas = g_value_get_object(value);
         old_canvas = data->canvas;
         if (new_canvas != old_canvas) {
-            if (new_canvas != NULL)
+            _adg_unbind_canvas(area);
+            if (new_canvas != NULL) {
                 g_object_ref(new_canvas);
+                data->damaged_handler =
+                    g_signal_connect(new_canvas, "damaged",
+                                     G_CALLBACK(_adg_canvas_damaged), area);
+            }
             if (old_canvas != NULL)
                 g_object_unref(old_canvas);
             data->canvas = new_canvas;
+            _adg_raster_clear(area);
             g_signal_emit(area, _adg_signals[CANVAS_CHANGED], 0, old_canvas);
         }
         break;
@@ -208,6 +1144,25 @@ _adg_set_property(GObject *object, guint prop_id,
     case PROP_RENDER_MAP:
         adg_matrix_copy(&data->render_map, g_value_get_boxed(value));
         break;
+    case PROP_PROGRESSIVE_RENDERING:
+        data->progressive = g_value_get_boolean(value);
+        if (!data->progressive)
+            _adg_back_clear(area);
+        break;
+    case PROP_THREADED_RENDERING:
+        data->threaded = g_value_get_boolean(value);
+        if (!data->threaded)
+            _adg_raster_clear(area);
+        break;
+    case PROP_ACCELERATED_RENDERING:
+        data->accelerated = g_value_get_boolean(value);
+        if (!data->accelerated)
+            _adg_device_clear(area);
+        break;
+    case PROP_STATISTICS:
+        data->statistics = g_value_get_boolean(value);
+        gtk_widget_queue_draw((GtkWidget *) area);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -220,7 +1175,15 @@ _adg_dispose(GObject *object)
 {
     AdgGtkAreaPrivate *data = ((AdgGtkArea *) object)->data;
 
+    _adg_raster_clear((AdgGtkArea *) object);
+
+    if (data->stats.timer != NULL) {
+        g_timer_destroy(data->stats.timer);
+        data->stats.timer = NULL;
+    }
+
     if (data->canvas) {
+        _adg_unbind_canvas((AdgGtkArea *) object);
         g_object_unref(data->canvas);
         data->canvas = NULL;
     }
@@ -309,7 +1272,7 @@ _adg_get_map(GtkWidget *widget, gboolean local_space,
         adg_matrix_copy(map, adg_entity_get_local_map(entity));
 
         /* The inverted map is subject to the global matrix */
-        adg_matrix_copy(inverted, adg_entity_get_global_matrix(entity));
+        adg_matrix_copy(inverted, _adg_entity_get_global_matrix(entity));
         adg_matrix_transform(inverted, map, ADG_TRANSFORM_BEFORE);
     } else {
         adg_matrix_copy(map, adg_entity_get_global_map(entity));
@@ -473,8 +1436,7 @@ _adg_expose_event(GtkWidget *widget, GdkEventExpose *event)
 
     if (canvas != NULL && event->window != NULL) {
         cairo_t *cr = gdk_cairo_create(event->window);
-        cairo_transform(cr, &data->render_map);
-        adg_entity_render((AdgEntity *) canvas, cr);
+        _adg_render_area((AdgGtkArea *) widget, cr);
         cairo_destroy(cr);
     }
 
@@ -561,10 +1523,8 @@ _adg_draw(GtkWidget *widget, cairo_t *cr)
     data = ((AdgGtkArea *) widget)->data;
     canvas = data->canvas;
 
-    if (canvas != NULL) {
-        cairo_transform(cr, &data->render_map);
-        adg_entity_render((AdgEntity *) canvas, cr);
-    }
+    if (canvas != NULL)
+        _adg_render_area((AdgGtkArea *) widget, cr);
 
     return FALSE;
 }
@@ -635,6 +1595,34 @@ adg_gtk_area_class_init(AdgGtkAreaClass *klass)
                                G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_RENDER_MAP, param);
 
+    param = g_param_spec_boolean("progressive-rendering",
+                                 P_("Progressive Rendering"),
+                                 P_("When enabled, show a draft of the canvas while the full detail rendering is performed in a back buffer during idle time"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_PROGRESSIVE_RENDERING, param);
+
+    param = g_param_spec_boolean("threaded-rendering",
+                                 P_("Threaded Rendering"),
+                                 P_("When enabled, rasterize the canvas on a worker thread and paint the last completed image"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_THREADED_RENDERING, param);
+
+    param = g_param_spec_boolean("accelerated-rendering",
+                                 P_("Accelerated Rendering"),
+                                 P_("When enabled, keep the rendered canvas in a surface native to the window and compose it while zooming or panning"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_ACCELERATED_RENDERING, param);
+
+    param = g_param_spec_boolean("statistics",
+                                 P_("Statistics"),
+                                 P_("When enabled, overlay the frame rate and the arrange and render timings on the canvas"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_STATISTICS, param);
+
     /**
      * AdgGtkArea::canvas-changed:
      * @area: an #AdgGtkArea
@@ -690,10 +1678,45 @@ adg_gtk_area_init(AdgGtkArea *area)
     data->factor = 1.05;
     data->autozoom = FALSE;
     cairo_matrix_init_identity(&data->render_map);
+    data->progressive = FALSE;
+    data->threaded = FALSE;
+    data->accelerated = FALSE;
+    data->statistics = FALSE;
 
     data->initialized = FALSE;
     data->x_event = 0;
     data->y_event = 0;
+    data->damaged_handler = 0;
+    data->damage_id = 0;
+
+    data->stats.timer = NULL;
+    data->stats.last = 0;
+    data->stats.fps = 0;
+    data->stats.arrange = 0;
+    data->stats.render = 0;
+
+    data->back.surface = NULL;
+    data->back.width = 0;
+    data->back.height = 0;
+    data->back.is_complete = FALSE;
+    data->back.nodes = NULL;
+    data->back.list = NULL;
+    data->back.n = 0;
+    data->back.idle_id = 0;
+
+    data->raster.recording = NULL;
+    data->raster.image = NULL;
+    data->raster.width = 0;
+    data->raster.height = 0;
+    data->raster.is_stale = TRUE;
+    data->raster.is_busy = FALSE;
+
+    data->device.surface = NULL;
+    data->device.width = 0;
+    data->device.height = 0;
+    data->device.margin_x = 0;
+    data->device.margin_y = 0;
+    data->device.timeout_id = 0;
 
     area->data = data;
 
@@ -871,6 +1894,86 @@ adg_gtk_area_get_render_map(AdgGtkArea *area)
     return &data->render_map;
 }
 
+/**
+ * adg_gtk_area_pick:
+ * @area: an #AdgGtkArea
+ * @x: the x coordinate in device space
+ * @y: the y coordinate in device space
+ *
+ * Gets the topmost entity of the canvas bound to @area that is
+ * rendered under the (@x, @y) point of the widget, e.g. the entity
+ * under the mouse pointer in a #GtkWidget::button-press-event handler.
+ *
+ * The candidates are looked up in the spatial index of the canvas
+ * (see adg_canvas_get_spatial_index()), so this is cheap enough to
+ * be called on every mouse event. Strokes are then checked against
+ * their path, i.e. they are picked only when the point lies within
+ * a few pixels of the stroked trail. Any other entity is picked when
+ * the point lies inside its extents.
+ *
+ * Only the leaf entities are returned: containers (and the canvas
+ * itself) are never picked.
+ *
+ * Returns: (transfer none): the entity under (@x, @y) or <constant>NULL</constant> if nothing is there or on errors.
+ *
+ * Since: 1.0
+ **/
+AdgEntity *
+adg_gtk_area_pick(AdgGtkArea *area, gdouble x, gdouble y)
+{
+    AdgGtkAreaPrivate *data;
+    AdgSpatialIndex *index;
+    cairo_matrix_t inverted;
+    CpmlPair device, pair;
+    CpmlExtents box;
+    GSList *candidates, *item;
+    AdgEntity *entity;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), NULL);
+
+    data = area->data;
+    if (data->canvas == NULL)
+        return NULL;
+
+    index = adg_canvas_get_spatial_index(data->canvas);
+    if (index == NULL)
+        return NULL;
+
+    adg_matrix_copy(&inverted, &data->render_map);
+    if (cairo_matrix_invert(&inverted) != CAIRO_STATUS_SUCCESS)
+        return NULL;
+
+    device.x = x;
+    device.y = y;
+    pair = device;
+    cairo_matrix_transform_point(&inverted, &pair.x, &pair.y);
+
+    /* Enlarge the query box by the pick tolerance, otherwise
+     * horizontal and vertical strokes (with flat extents) would
+     * never be picked */
+    box.is_defined = TRUE;
+    box.org.x = x - _ADG_PICK_TOLERANCE;
+    box.org.y = y - _ADG_PICK_TOLERANCE;
+    box.size.x = _ADG_PICK_TOLERANCE * 2;
+    box.size.y = _ADG_PICK_TOLERANCE * 2;
+    cpml_extents_transform(&box, &inverted);
+
+    /* The candidates are in rendering order: the topmost is the last */
+    candidates = g_slist_reverse(adg_spatial_index_query_extents(index, &box));
+    entity = NULL;
+
+    for (item = candidates; item != NULL; item = item->next) {
+        if (_adg_pick_hit(item->data, &data->render_map, &device, &pair)) {
+            entity = item->data;
+            break;
+        }
+    }
+
+    g_slist_free(candidates);
+
+    return entity;
+}
+
 /**
  * adg_gtk_area_get_extents:
  * @area: an #AdgGtkArea
@@ -1008,6 +2111,190 @@ adg_gtk_area_has_autozoom(AdgGtkArea *area)
     return data->autozoom;
 }
 
+/**
+ * adg_gtk_area_switch_progressive_rendering:
+ * @area: an #AdgGtkArea
+ * @state: the new progressive rendering state
+ *
+ * Sets the #AdgGtkArea:progressive-rendering property of @area to
+ * @state. When enabled, the exposures of @area show a draft of the
+ * canvas (without texts and hatches and with simplified curves)
+ * until the full detail rendering, performed during idle time in
+ * a back buffer, is complete. The back buffer is dropped on any
+ * change of the render map, of the allocation or of the entities
+ * of the canvas.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_switch_progressive_rendering(AdgGtkArea *area, gboolean state)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "progressive-rendering", state, NULL);
+}
+
+/**
+ * adg_gtk_area_has_progressive_rendering:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the current state of the #AdgGtkArea:progressive-rendering
+ * property on the @area object.
+ *
+ * Returns: the current progressive rendering state
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_gtk_area_has_progressive_rendering(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), FALSE);
+
+    data = area->data;
+    return data->progressive;
+}
+
+/**
+ * adg_gtk_area_switch_threaded_rendering:
+ * @area: an #AdgGtkArea
+ * @state: the new threaded rendering state
+ *
+ * Sets the #AdgGtkArea:threaded-rendering property of @area to
+ * @state. When enabled, the canvas is recorded on the main thread
+ * whenever any of its entities changes and that recording is
+ * rasterized with the current render map on a worker thread. The
+ * exposures of @area paint the last completed image, remapped to
+ * the current render map, and schedule a new rasterization when
+ * it is outdated. Only one rasterization per @area is in flight.
+ *
+ * When enabled, this property takes precedence over
+ * #AdgGtkArea:progressive-rendering. GLib older than 2.36 does not
+ * provide the needed thread pools, so the rasterization is
+ * performed synchronously.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_switch_threaded_rendering(AdgGtkArea *area, gboolean state)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "threaded-rendering", state, NULL);
+}
+
+/**
+ * adg_gtk_area_has_threaded_rendering:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the current state of the #AdgGtkArea:threaded-rendering
+ * property on the @area object.
+ *
+ * Returns: the current threaded rendering state
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_gtk_area_has_threaded_rendering(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), FALSE);
+
+    data = area->data;
+    return data->threaded;
+}
+
+/**
+ * adg_gtk_area_switch_accelerated_rendering:
+ * @area: an #AdgGtkArea
+ * @state: the new accelerated rendering state
+ *
+ * Sets the #AdgGtkArea:accelerated-rendering property of @area to
+ * @state. When enabled, the canvas is rendered in a surface similar
+ * to the window target (hence handled by the graphic device on the
+ * backends supporting it) that covers the widget plus a margin on
+ * every side. The exposures compose that surface with the current
+ * render map, leaving the scaling to the device, and render it
+ * again only when it does not cover the widget anymore or, with
+ * full detail, when the render map has not changed for a while.
+ *
+ * #AdgGtkArea:threaded-rendering, when enabled, takes precedence
+ * over this property, while this property takes precedence over
+ * #AdgGtkArea:progressive-rendering.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_switch_accelerated_rendering(AdgGtkArea *area, gboolean state)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "accelerated-rendering", state, NULL);
+}
+
+/**
+ * adg_gtk_area_has_accelerated_rendering:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the current state of the #AdgGtkArea:accelerated-rendering
+ * property on the @area object.
+ *
+ * Returns: the current accelerated rendering state
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_gtk_area_has_accelerated_rendering(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), FALSE);
+
+    data = area->data;
+    return data->accelerated;
+}
+
+/**
+ * adg_gtk_area_switch_statistics:
+ * @area: an #AdgGtkArea
+ * @state: the new statistics state
+ *
+ * Sets the #AdgGtkArea:statistics property of @area to @state. When
+ * enabled, the frame rate and the time spent arranging and rendering
+ * the canvas (smoothed over the last frames) are painted on the
+ * top/left corner of @area after every exposure. Useful to profile
+ * the interactive editing of a drawing.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_switch_statistics(AdgGtkArea *area, gboolean state)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "statistics", state, NULL);
+}
+
+/**
+ * adg_gtk_area_has_statistics:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the current state of the #AdgGtkArea:statistics property on
+ * the @area object.
+ *
+ * Returns: the current statistics state
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_gtk_area_has_statistics(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), FALSE);
+
+    data = area->data;
+    return data->statistics;
+}
+
 /**
  * adg_gtk_area_reset:
  * @area: an #AdgGtkArea
@@ -75,6 +75,24 @@ gdouble         adg_gtk_area_get_factor         (AdgGtkArea      *area);
 void            adg_gtk_area_switch_autozoom    (AdgGtkArea      *area,
                                                  gboolean         state);
 gboolean        adg_gtk_area_has_autozoom       (AdgGtkArea      *area);
+void            adg_gtk_area_switch_progressive_rendering
+                                                (AdgGtkArea      *area,
+                                                 gboolean         state);
+gboolean        adg_gtk_area_has_progressive_rendering
+                                                (AdgGtkArea      *area);
+void            adg_gtk_area_switch_threaded_rendering
+                                                (AdgGtkArea      *area,
+                                                 gboolean         state);
+gboolean        adg_gtk_area_has_threaded_rendering
+                                                (AdgGtkArea      *area);
+void            adg_gtk_area_switch_accelerated_rendering
+                                                (AdgGtkArea      *area,
+                                                 gboolean         state);
+gboolean        adg_gtk_area_has_accelerated_rendering
+                                                (AdgGtkArea      *area);
+void            adg_gtk_area_switch_statistics  (AdgGtkArea      *area,
+                                                 gboolean         state);
+gboolean        adg_gtk_area_has_statistics     (AdgGtkArea      *area);
 void            adg_gtk_area_reset              (AdgGtkArea      *area);
 void            adg_gtk_area_canvas_changed     (AdgGtkArea      *area,
                                                  AdgCanvas       *old_canvas);
@@ -86,6 +104,9 @@ void            adg_gtk_area_transform_render_map
                                                  AdgTransformMode mode);
 const cairo_matrix_t*
                 adg_gtk_area_get_render_map     (AdgGtkArea      *area);
+AdgEntity *     adg_gtk_area_pick               (AdgGtkArea      *area,
+                                                 gdouble          x,
+                                                 gdouble          y);
 void            adg_gtk_area_extents_changed    (AdgGtkArea      *area,
                                                  const CpmlExtents
                                                                  *old_extents);
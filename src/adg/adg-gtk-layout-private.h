@@ -33,6 +33,7 @@ struct _AdgGtkLayoutPrivate {
     gboolean             policy_stored;
     GtkPolicyType        hpolicy, vpolicy;
     CpmlExtents          viewport;
+    guint                update_id;
 };
 
 G_END_DECLS
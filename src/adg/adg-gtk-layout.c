@@ -42,6 +42,7 @@
 
 #include "adg-internal.h"
 #include <gtk/gtk.h>
+#include <math.h>
 
 #include "adg-container.h"
 #include "adg-table.h"
@@ -56,6 +57,9 @@
 #define _ADG_OLD_WIDGET_CLASS  ((GtkWidgetClass *) adg_gtk_layout_parent_class)
 #define _ADG_OLD_AREA_CLASS    ((AdgGtkAreaClass *) adg_gtk_layout_parent_class)
 
+/* Priority of the adjustments update: after the resizes and before the redraw */
+#define _ADG_UPDATE_PRIORITY   (GDK_PRIORITY_REDRAW - 10)
+
 #ifdef GTK2_ENABLED
 enum {
     PROP_0,
@@ -207,6 +211,39 @@ _adg_update_adjustments(AdgGtkLayout *layout)
                  NULL);
 }
 
+static gboolean
+_adg_update(gpointer user_data)
+{
+    AdgGtkLayout *layout;
+    AdgGtkLayoutPrivate *data;
+
+    layout = (AdgGtkLayout *) user_data;
+    data = layout->data;
+    data->update_id = 0;
+
+    _adg_update_adjustments(layout);
+    return FALSE;
+}
+
+/**
+ * _adg_queue_update:
+ * @layout: an #AdgGtkLayout
+ *
+ * Schedules an update of the adjustments of @layout. All the requests
+ * done in the same frame are coalesced, so a burst of extents changes
+ * (e.g. while editing the model) leads to a single update performed
+ * just before the redraw.
+ **/
+static void
+_adg_queue_update(AdgGtkLayout *layout)
+{
+    AdgGtkLayoutPrivate *data = layout->data;
+
+    if (data->update_id == 0)
+        data->update_id = g_idle_add_full(_ADG_UPDATE_PRIORITY,
+                                          _adg_update, layout, NULL);
+}
+
 static void
 _adg_size_allocate(GtkWidget *widget, GtkAllocation *allocation)
 {
@@ -227,7 +264,7 @@ _adg_size_allocate(GtkWidget *widget, GtkAllocation *allocation)
     data->viewport.size.y = allocation->height;
     data->viewport.is_defined = TRUE;
 
-    _adg_update_adjustments(layout);
+    _adg_queue_update(layout);
 }
 
 static void
@@ -256,7 +293,44 @@ _adg_extents_changed(AdgGtkArea *area, const CpmlExtents *old_extents)
     if (_ADG_OLD_AREA_CLASS->extents_changed != NULL)
         _ADG_OLD_AREA_CLASS->extents_changed(area, old_extents);
 
-    _adg_update_adjustments((AdgGtkLayout *) area);
+    _adg_queue_update((AdgGtkLayout *) area);
+}
+
+/**
+ * _adg_scroll:
+ * @layout: an #AdgGtkLayout
+ * @old_map: the render map before the scrolling
+ *
+ * Redraws @layout after a change of its render map. When the new map
+ * differs from @old_map only by an integer translation in device
+ * space, as it happens while dragging the scrollbars, the previous
+ * frame is moved by gdk_window_scroll(), that copies the overlapping
+ * area and exposes only the newly uncovered stripes. Any other change
+ * requires a full redraw.
+ **/
+static void
+_adg_scroll(AdgGtkLayout *layout, const cairo_matrix_t *old_map)
+{
+    GtkWidget *widget;
+    GdkWindow *window;
+    const cairo_matrix_t *new_map;
+    gdouble dx, dy;
+
+    widget = (GtkWidget *) layout;
+    window = gtk_widget_get_window(widget);
+    new_map = adg_gtk_area_get_render_map((AdgGtkArea *) layout);
+    dx = new_map->x0 - old_map->x0;
+    dy = new_map->y0 - old_map->y0;
+
+    if (window != NULL &&
+        new_map->xx == old_map->xx && new_map->yx == old_map->yx &&
+        new_map->xy == old_map->xy && new_map->yy == old_map->yy &&
+        fabs(dx - floor(dx + 0.5)) < 1e-6 &&
+        fabs(dy - floor(dy + 0.5)) < 1e-6) {
+        gdk_window_scroll(window, floor(dx + 0.5), floor(dy + 0.5));
+    } else {
+        gtk_widget_queue_draw(widget);
+    }
 }
 
 static void
@@ -266,7 +340,7 @@ _adg_value_changed(AdgGtkLayout *layout)
     AdgGtkArea *area;
     AdgGtkLayoutPrivate *data;
     CpmlPair org;
-    cairo_matrix_t map;
+    cairo_matrix_t map, old_map;
 
     widget = (GtkWidget *) layout;
 
@@ -278,12 +352,13 @@ _adg_value_changed(AdgGtkLayout *layout)
     org.x = gtk_adjustment_get_value(data->hadjustment);
     org.y = gtk_adjustment_get_value(data->vadjustment);
 
+    adg_matrix_copy(&old_map, adg_gtk_area_get_render_map(area));
     cairo_matrix_init_translate(&map, data->viewport.org.x - org.x,
                                 data->viewport.org.y - org.y);
     adg_gtk_area_transform_render_map(area, &map, ADG_TRANSFORM_BEFORE);
 
-    gtk_widget_queue_draw(widget);
-    _adg_update_adjustments(layout);
+    _adg_scroll(layout, &old_map);
+    _adg_queue_update(layout);
 }
 
 static void
@@ -314,6 +389,11 @@ _adg_dispose(GObject *object)
 {
     AdgGtkLayoutPrivate *data = ((AdgGtkLayout *) object)->data;
 
+    if (data->update_id != 0) {
+        g_source_remove(data->update_id);
+        data->update_id = 0;
+    }
+
     if (data->hadjustment != NULL) {
         g_object_unref(data->hadjustment);
         data->hadjustment = NULL;
@@ -476,6 +556,7 @@ adg_gtk_layout_init(AdgGtkLayout *layout)
     data->vadjustment = NULL;
     data->policy_stored = FALSE;
     data->viewport.is_defined = FALSE;
+    data->update_id = 0;
 
     layout->data = data;
 }
@@ -224,15 +224,14 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
         AdgFillStyle *fill_style = (AdgFillStyle *)
             adg_entity_style(entity, data->fill_dress);
 
-        adg_fill_style_set_extents(fill_style, adg_entity_get_extents(entity));
-
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_global_matrix(entity));
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, adg_entity_get_combined_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
         adg_style_apply((AdgStyle *) fill_style, entity, cr);
+        if (adg_has_preview(cr))
+            cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
         cairo_fill(cr);
     }
 }
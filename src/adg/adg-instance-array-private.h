@@ -0,0 +1,41 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __ADG_INSTANCE_ARRAY_PRIVATE_H__
+#define __ADG_INSTANCE_ARRAY_PRIVATE_H__
+
+
+G_BEGIN_DECLS
+
+typedef struct _AdgInstanceArrayPrivate AdgInstanceArrayPrivate;
+
+struct _AdgInstanceArrayPrivate {
+    /* Instance matrices, in local space */
+    GArray      *matrices;
+
+    /* The same matrices converted in global space,
+     * computed in the arrange phase */
+    GArray      *transforms;
+};
+
+G_END_DECLS
+
+
+#endif /* __ADG_INSTANCE_ARRAY_PRIVATE_H__ */
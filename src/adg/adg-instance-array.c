@@ -0,0 +1,368 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/**
+ * SECTION:adg-instance-array
+ * @short_description: A container repeating its children
+ *
+ * The #AdgInstanceArray is a container that renders its children
+ * many times, once for every matrix of its list. It is intended for
+ * repeated features (bolt circles, perforation grids, knurling...)
+ * where a copy of the same entities for every instance would be
+ * wasteful.
+ *
+ * The instance matrices are expressed in local space, the same space
+ * used by the models of the children, so adg_instance_array_add_linear()
+ * and adg_instance_array_add_polar() can be fed directly with model
+ * quotes. The children are arranged only once: the extents of every
+ * instance are computed by transforming the extents of the children.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgInstanceArray:
+ *
+ * All fields are private and should not be used directly.
+ * Use its public methods instead.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include "adg-entity.h"
+#include "adg-container.h"
+#include "adg-entity-private.h"
+
+#include "adg-instance-array.h"
+#include "adg-instance-array-private.h"
+
+#include <math.h>
+
+
+#define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_instance_array_parent_class)
+#define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_instance_array_parent_class)
+
+
+G_DEFINE_TYPE(AdgInstanceArray, adg_instance_array, ADG_TYPE_CONTAINER)
+
+
+static void             _adg_finalize           (GObject        *object);
+static void             _adg_arrange            (AdgEntity      *entity);
+static void             _adg_render             (AdgEntity      *entity,
+                                                 cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
+
+
+static void
+adg_instance_array_class_init(AdgInstanceArrayClass *klass)
+{
+    GObjectClass *gobject_class;
+    AdgEntityClass *entity_class;
+
+    gobject_class = (GObjectClass *) klass;
+    entity_class = (AdgEntityClass *) klass;
+
+    g_type_class_add_private(klass, sizeof(AdgInstanceArrayPrivate));
+
+    gobject_class->finalize = _adg_finalize;
+
+    entity_class->arrange = _adg_arrange;
+    entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
+}
+
+static void
+adg_instance_array_init(AdgInstanceArray *instance_array)
+{
+    AdgInstanceArrayPrivate *data = G_TYPE_INSTANCE_GET_PRIVATE(instance_array,
+                                                                ADG_TYPE_INSTANCE_ARRAY,
+                                                                AdgInstanceArrayPrivate);
+
+    data->matrices = g_array_new(FALSE, FALSE, sizeof(cairo_matrix_t));
+    data->transforms = g_array_new(FALSE, FALSE, sizeof(cairo_matrix_t));
+
+    instance_array->data = data;
+}
+
+static void
+_adg_finalize(GObject *object)
+{
+    AdgInstanceArrayPrivate *data = ((AdgInstanceArray *) object)->data;
+
+    g_array_free(data->matrices, TRUE);
+    g_array_free(data->transforms, TRUE);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
+
+/**
+ * adg_instance_array_new:
+ *
+ * Creates a new instance array without instances. Use
+ * adg_container_add() to add the entities to repeat and
+ * the adg_instance_array_add_...() functions to add the
+ * instances.
+ *
+ * Returns: the newly created instance array
+ *
+ * Since: 1.0
+ **/
+AdgInstanceArray *
+adg_instance_array_new(void)
+{
+    return g_object_new(ADG_TYPE_INSTANCE_ARRAY, NULL);
+}
+
+/**
+ * adg_instance_array_add_matrix:
+ * @instance_array: an #AdgInstanceArray
+ * @matrix: the transformation of the new instance
+ *
+ * Adds a new instance of the children of @instance_array,
+ * transformed by @matrix. @matrix is expressed in local space.
+ *
+ * Since: 1.0
+ **/
+void
+adg_instance_array_add_matrix(AdgInstanceArray *instance_array,
+                              const cairo_matrix_t *matrix)
+{
+    AdgInstanceArrayPrivate *data;
+
+    g_return_if_fail(ADG_IS_INSTANCE_ARRAY(instance_array));
+    g_return_if_fail(matrix != NULL);
+
+    data = instance_array->data;
+    g_array_append_vals(data->matrices, matrix, 1);
+
+    adg_entity_invalidate((AdgEntity *) instance_array);
+}
+
+/**
+ * adg_instance_array_add_linear:
+ * @instance_array: an #AdgInstanceArray
+ * @n_instances: number of instances to add
+ * @dx: x step between two instances
+ * @dy: y step between two instances
+ *
+ * Adds @n_instances instances, each one translated by (@dx, @dy)
+ * from the previous one. The first instance is not translated.
+ *
+ * Since: 1.0
+ **/
+void
+adg_instance_array_add_linear(AdgInstanceArray *instance_array,
+                              guint n_instances, gdouble dx, gdouble dy)
+{
+    AdgInstanceArrayPrivate *data;
+    cairo_matrix_t matrix;
+    guint n;
+
+    g_return_if_fail(ADG_IS_INSTANCE_ARRAY(instance_array));
+
+    data = instance_array->data;
+
+    for (n = 0; n < n_instances; ++n) {
+        cairo_matrix_init_translate(&matrix, dx * n, dy * n);
+        g_array_append_val(data->matrices, matrix);
+    }
+
+    adg_entity_invalidate((AdgEntity *) instance_array);
+}
+
+/**
+ * adg_instance_array_add_polar:
+ * @instance_array: an #AdgInstanceArray
+ * @n_instances: number of instances to add
+ * @center: the center of rotation
+ * @angle: angle (in radians) between two instances
+ *
+ * Adds @n_instances instances, each one rotated by @angle around
+ * @center from the previous one. The first instance is not rotated.
+ *
+ * Since: 1.0
+ **/
+void
+adg_instance_array_add_polar(AdgInstanceArray *instance_array,
+                             guint n_instances, const CpmlPair *center,
+                             gdouble angle)
+{
+    AdgInstanceArrayPrivate *data;
+    cairo_matrix_t matrix;
+    guint n;
+
+    g_return_if_fail(ADG_IS_INSTANCE_ARRAY(instance_array));
+    g_return_if_fail(center != NULL);
+
+    data = instance_array->data;
+
+    for (n = 0; n < n_instances; ++n) {
+        cairo_matrix_init_translate(&matrix, center->x, center->y);
+        cairo_matrix_rotate(&matrix, angle * n);
+        cairo_matrix_translate(&matrix, -center->x, -center->y);
+        g_array_append_val(data->matrices, matrix);
+    }
+
+    adg_entity_invalidate((AdgEntity *) instance_array);
+}
+
+/**
+ * adg_instance_array_get_n_matrices:
+ * @instance_array: an #AdgInstanceArray
+ *
+ * Gets the number of instances of @instance_array.
+ *
+ * Returns: the number of instances or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_instance_array_get_n_matrices(AdgInstanceArray *instance_array)
+{
+    AdgInstanceArrayPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_INSTANCE_ARRAY(instance_array), 0);
+
+    data = instance_array->data;
+
+    return data->matrices->len;
+}
+
+/**
+ * adg_instance_array_get_matrix:
+ * @instance_array: an #AdgInstanceArray
+ * @n: the index of the instance
+ *
+ * Gets the local matrix of the @n instance of @instance_array.
+ *
+ * Returns: (transfer none): the requested matrix or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+const cairo_matrix_t *
+adg_instance_array_get_matrix(AdgInstanceArray *instance_array, guint n)
+{
+    AdgInstanceArrayPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_INSTANCE_ARRAY(instance_array), NULL);
+
+    data = instance_array->data;
+    g_return_val_if_fail(n < data->matrices->len, NULL);
+
+    return &g_array_index(data->matrices, cairo_matrix_t, n);
+}
+
+/**
+ * adg_instance_array_clear:
+ * @instance_array: an #AdgInstanceArray
+ *
+ * Removes all the instances from @instance_array. The children
+ * are left untouched.
+ *
+ * Since: 1.0
+ **/
+void
+adg_instance_array_clear(AdgInstanceArray *instance_array)
+{
+    AdgInstanceArrayPrivate *data;
+
+    g_return_if_fail(ADG_IS_INSTANCE_ARRAY(instance_array));
+
+    data = instance_array->data;
+    g_array_set_size(data->matrices, 0);
+
+    adg_entity_invalidate((AdgEntity *) instance_array);
+}
+
+
+static void
+_adg_arrange(AdgEntity *entity)
+{
+    AdgInstanceArrayPrivate *data;
+    cairo_matrix_t ctm, inverted, transform;
+    CpmlExtents children, extents, instance;
+    guint n;
+
+    data = ((AdgInstanceArray *) entity)->data;
+    g_array_set_size(data->transforms, 0);
+
+    /* Arrange the children once, in place */
+    if (_ADG_OLD_ENTITY_CLASS->arrange != NULL)
+        _ADG_OLD_ENTITY_CLASS->arrange(entity);
+
+    cpml_extents_copy(&children, _adg_entity_get_extents(entity));
+    extents.is_defined = FALSE;
+
+    /* The children are rendered after applying the global and the
+     * local matrices: a local space instance matrix M is converted
+     * to the global space transform ctm * M * ctm^-1 */
+    cairo_matrix_multiply(&ctm, _adg_entity_get_local_matrix(entity),
+                          _adg_entity_get_global_matrix(entity));
+    adg_matrix_copy(&inverted, &ctm);
+
+    if (cairo_matrix_invert(&inverted) == CAIRO_STATUS_SUCCESS) {
+        for (n = 0; n < data->matrices->len; ++n) {
+            cairo_matrix_multiply(&transform, &inverted,
+                                  &g_array_index(data->matrices, cairo_matrix_t, n));
+            cairo_matrix_multiply(&transform, &transform, &ctm);
+            g_array_append_val(data->transforms, transform);
+
+            cpml_extents_copy(&instance, &children);
+            cpml_extents_transform(&instance, &transform);
+            cpml_extents_add(&extents, &instance);
+        }
+    }
+
+    adg_entity_set_extents(entity, &extents);
+}
+
+static void
+_adg_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgInstanceArrayPrivate *data;
+    guint n;
+
+    if (_ADG_OLD_ENTITY_CLASS->render == NULL)
+        return;
+
+    data = ((AdgInstanceArray *) entity)->data;
+
+    for (n = 0; n < data->transforms->len; ++n) {
+        cairo_save(cr);
+        cairo_transform(cr, &g_array_index(data->transforms, cairo_matrix_t, n));
+        _ADG_OLD_ENTITY_CLASS->render(entity, cr);
+        cairo_restore(cr);
+    }
+}
+
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgInstanceArrayPrivate *data = ((AdgInstanceArray *) entity)->data;
+
+    return _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgInstanceArrayPrivate) +
+        (data->matrices->len + data->transforms->len) * sizeof(cairo_matrix_t);
+}
@@ -0,0 +1,79 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_INSTANCE_ARRAY_H__
+#define __ADG_INSTANCE_ARRAY_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_INSTANCE_ARRAY             (adg_instance_array_get_type())
+#define ADG_INSTANCE_ARRAY(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), ADG_TYPE_INSTANCE_ARRAY, AdgInstanceArray))
+#define ADG_INSTANCE_ARRAY_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), ADG_TYPE_INSTANCE_ARRAY, AdgInstanceArrayClass))
+#define ADG_IS_INSTANCE_ARRAY(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), ADG_TYPE_INSTANCE_ARRAY))
+#define ADG_IS_INSTANCE_ARRAY_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), ADG_TYPE_INSTANCE_ARRAY))
+#define ADG_INSTANCE_ARRAY_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), ADG_TYPE_INSTANCE_ARRAY, AdgInstanceArrayClass))
+
+
+typedef struct _AdgInstanceArray       AdgInstanceArray;
+typedef struct _AdgInstanceArrayClass  AdgInstanceArrayClass;
+
+struct _AdgInstanceArray {
+    /*< private >*/
+    AdgContainer         parent;
+    gpointer             data;
+};
+
+struct _AdgInstanceArrayClass {
+    /*< private >*/
+    AdgContainerClass    parent_class;
+};
+
+
+GType           adg_instance_array_get_type     (void);
+
+AdgInstanceArray *
+                adg_instance_array_new          (void);
+void            adg_instance_array_add_matrix   (AdgInstanceArray *instance_array,
+                                                 const cairo_matrix_t *matrix);
+void            adg_instance_array_add_linear   (AdgInstanceArray *instance_array,
+                                                 guint             n_instances,
+                                                 gdouble           dx,
+                                                 gdouble           dy);
+void            adg_instance_array_add_polar    (AdgInstanceArray *instance_array,
+                                                 guint             n_instances,
+                                                 const CpmlPair   *center,
+                                                 gdouble           angle);
+guint           adg_instance_array_get_n_matrices
+                                                (AdgInstanceArray *instance_array);
+const cairo_matrix_t *
+                adg_instance_array_get_matrix   (AdgInstanceArray *instance_array,
+                                                 guint             n);
+void            adg_instance_array_clear        (AdgInstanceArray *instance_array);
+
+G_END_DECLS
+
+
+#endif /* __ADG_INSTANCE_ARRAY_H__ */
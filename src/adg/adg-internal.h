@@ -38,6 +38,10 @@
 #include <cairo-gobject.h>
 #endif
 
+#ifdef SYSPROF_ENABLED
+#include <sysprof-capture.h>
+#endif
+
 #include <cpml.h>
 
 /* The following headers are autogenerated, so they could be hosted
@@ -93,4 +97,60 @@ const gchar *           _adg_dpgettext  (const gchar *domain,
                                          gsize        msgidoffset) G_GNUC_FORMAT(2);
 
 
+/* Allocation tracing: the arguments are not evaluated at all
+ * when the library is built without --enable-alloc-trace */
+#ifdef ALLOC_TRACE_ENABLED
+#define ADG_ALLOC_TRACE(domain, n_bytes)        _adg_alloc_trace((domain), (n_bytes))
+#define ADG_ALLOC_SYNC(domain, traced, n_bytes) _adg_alloc_sync((domain), (traced), (n_bytes))
+#else
+#define ADG_ALLOC_TRACE(domain, n_bytes)        ((void) 0)
+#define ADG_ALLOC_SYNC(domain, traced, n_bytes) ((void) 0)
+#endif
+
+/* Tracing spans: ADG_TRACE_START() must be used among the declarations
+ * and ADG_TRACE_STOP() emits the mark, with @detail as message. Both
+ * are no-op when the library is built without --enable-sysprof */
+#ifdef SYSPROF_ENABLED
+#define ADG_TRACE_START(span)                   gint64 span = SYSPROF_CAPTURE_CURRENT_TIME
+#define ADG_TRACE_STOP(span, name, detail)      sysprof_collector_mark((span), SYSPROF_CAPTURE_CURRENT_TIME - (span), \
+                                                                       "adg", (name), "%s", (detail))
+#else
+#define ADG_TRACE_START(span)                   G_GNUC_UNUSED gint64 span = 0
+#define ADG_TRACE_STOP(span, name, detail)      ((void) 0)
+#endif
+
+void                    _adg_alloc_trace(AdgAllocDomain domain,
+                                         gssize       n_bytes);
+void                    _adg_alloc_sync (AdgAllocDomain domain,
+                                         gsize       *traced,
+                                         gsize        n_bytes);
+
+/* Invalidation tracing: every event entered with _adg_cascade_enter()
+ * is considered caused by the innermost event not yet left. When it
+ * returns TRUE, _adg_cascade_leave() must be called once the event
+ * has been handled. See adg_switch_invalidation_tracing() */
+typedef enum {
+    ADG_CASCADE_CHANGED,
+    ADG_CASCADE_GEOMETRY_CHANGED,
+    ADG_CASCADE_INVALIDATE,
+    ADG_CASCADE_GLOBAL_CHANGED,
+    ADG_CASCADE_LOCAL_CHANGED,
+    ADG_CASCADE_N_EVENTS
+} AdgCascadeEvent;
+
+gboolean                _adg_cascade_enter
+                                        (gpointer     object,
+                                         AdgCascadeEvent event);
+void                    _adg_cascade_leave
+                                        (void);
+
+gboolean                _adg_value_equal(const GValue *value,
+                                         const GValue *value2);
+guint                   _adg_value_hash (const GValue *value);
+gboolean                _adg_ptr_array_insert
+                                        (GPtrArray   *array,
+                                         gpointer     data,
+                                         gpointer     before);
+
+
 #endif /* __ADG_INTERNAL_H__ */
@@ -53,6 +53,7 @@ typedef struct _AdgLDimPrivate AdgLDimPrivate;
 
 struct _AdgLDimPrivate {
     double                direction;
+    CpmlVector            extension;
     gboolean              has_extension1;
     gboolean              has_extension2;
 
@@ -75,6 +76,14 @@ struct _AdgLDimPrivate {
         cairo_matrix_t    global_map;
     }                     quote;
 
+    struct {
+        gboolean          is_cached;
+        AdgThreeState     outside, detached;
+        gdouble           available_space;
+        gdouble           markers_space;
+        gboolean          to_outside, to_detach;
+    }                     flags;
+
     struct {
         cairo_path_t      path;
         cairo_path_data_t data[20];
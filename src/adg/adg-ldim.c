@@ -50,14 +50,21 @@
 #include "adg-toy-text.h"
 #include "adg-dim.h"
 #include "adg-dim-private.h"
+#include "adg-entity-private.h"
 
 #include "adg-ldim.h"
 #include "adg-ldim-private.h"
 
+#include <math.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_ldim_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_ldim_parent_class)
 
+/* Relative change of the available space below which the outside
+ * and detached flags previously chosen are kept as they are */
+#define _ADG_FLAGS_HYSTERESIS  0.05
+
 
 G_DEFINE_TYPE(AdgLDim, adg_ldim, ADG_TYPE_DIM)
 
@@ -81,9 +88,11 @@ static void             _adg_set_property       (GObject        *object,
 static void             _adg_global_changed     (AdgEntity      *entity);
 static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_invalidate         (AdgEntity      *entity);
+static void             _adg_geometry_changed   (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
 static gchar *          _adg_default_value      (AdgDim         *dim);
 static gboolean         _adg_compute_geometry   (AdgDim         *dim);
 static void             _adg_update_shift       (AdgLDim        *ldim);
@@ -102,6 +111,7 @@ static void             _adg_update_extents     (AdgLDim        *ldim);
 static void             _adg_unset_trail        (AdgLDim        *ldim);
 static void             _adg_dispose_trail      (AdgLDim        *ldim);
 static void             _adg_dispose_markers    (AdgLDim        *ldim);
+static void             _adg_reset_markers      (AdgLDim        *ldim);
 static cairo_path_t *   _adg_trail_callback     (AdgTrail       *trail,
                                                  gpointer        user_data);
 
@@ -127,8 +137,10 @@ adg_ldim_class_init(AdgLDimClass *klass)
     entity_class->global_changed = _adg_global_changed;
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
+    entity_class->geometry_changed = _adg_geometry_changed;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
 
     dim_class->default_value = _adg_default_value;
     dim_class->compute_geometry = _adg_compute_geometry;
@@ -166,6 +178,7 @@ adg_ldim_init(AdgLDim *ldim)
     line_to.header.length = 2;
 
     data->direction = ADG_DIR_RIGHT;
+    cpml_vector_from_angle(&data->extension, data->direction);
     data->has_extension1 = TRUE;
     data->has_extension2 = TRUE;
 
@@ -187,6 +200,8 @@ adg_ldim_init(AdgLDim *ldim)
     data->marker1 = NULL;
     data->marker2 = NULL;
 
+    data->flags.is_cached = FALSE;
+
     ldim->data = data;
 }
 
@@ -237,6 +252,7 @@ _adg_set_property(GObject *object, guint prop_id,
     switch (prop_id) {
     case PROP_DIRECTION:
         data->direction = cpml_angle(g_value_get_double(value));
+        cpml_vector_from_angle(&data->extension, data->direction);
         break;
     case PROP_HAS_EXTENSION1:
         data->has_extension1 = g_value_get_boolean(value);
@@ -536,15 +552,39 @@ static void
 _adg_invalidate(AdgEntity *entity)
 {
     AdgLDim *ldim = (AdgLDim *) entity;
+    AdgLDimPrivate *data = ldim->data;
 
-    _adg_dispose_trail(ldim);
-    _adg_dispose_markers(ldim);
+    /* The quote or the markers could have been restyled, so the
+     * flags must be chosen again. Geometric changes keep them */
+    data->flags.is_cached = FALSE;
+
+    /* The trail and the markers are kept for the next arrange */
     _adg_unset_trail(ldim);
+    _adg_reset_markers(ldim);
 
     if (_ADG_OLD_ENTITY_CLASS->invalidate)
         _ADG_OLD_ENTITY_CLASS->invalidate(entity);
 }
 
+static void
+_adg_geometry_changed(AdgEntity *entity)
+{
+    AdgLDim *ldim = (AdgLDim *) entity;
+    AdgLDimPrivate *data = ldim->data;
+
+    /* Same as invalidate but without checking the markers against
+     * the dim style, that is not affected by geometric changes */
+    _adg_unset_trail(ldim);
+
+    if (data->marker1 != NULL)
+        adg_entity_invalidate((AdgEntity *) data->marker1);
+    if (data->marker2 != NULL)
+        adg_entity_invalidate((AdgEntity *) data->marker2);
+
+    if (_ADG_OLD_ENTITY_CLASS->geometry_changed != NULL)
+        _ADG_OLD_ENTITY_CLASS->geometry_changed(entity);
+}
+
 static void
 _adg_arrange(AdgEntity *entity)
 {
@@ -580,7 +620,7 @@ _adg_arrange(AdgEntity *entity)
     _adg_choose_flags(ldim, &outside, &detach);
 
     dim_style = _ADG_GET_DIM_STYLE(dim);
-    local = adg_entity_get_local_matrix(entity);
+    local = _adg_entity_get_local_matrix(entity);
 
     cpml_pair_copy(&ref1, (CpmlPair *) adg_dim_get_ref1(dim));
     cpml_pair_copy(&ref2, (CpmlPair *) adg_dim_get_ref2(dim));
@@ -680,6 +720,25 @@ _adg_arrange(AdgEntity *entity)
     _adg_update_extents(ldim);
 }
 
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgLDimPrivate *data = ((AdgLDim *) entity)->data;
+    gsize usage;
+
+    usage = _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgLDimPrivate);
+
+    if (data->trail != NULL)
+        usage += adg_trail_get_memory_usage(data->trail);
+    if (data->marker1 != NULL)
+        usage += adg_entity_get_memory_usage((AdgEntity *) data->marker1);
+    if (data->marker2 != NULL)
+        usage += adg_entity_get_memory_usage((AdgEntity *) data->marker2);
+
+    return usage;
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -706,7 +765,7 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     if (data->marker2)
         adg_entity_render((AdgEntity *) data->marker2, cr);
 
-    cairo_transform(cr, adg_entity_get_global_matrix(entity));
+    cairo_transform(cr, _adg_entity_get_global_matrix(entity));
     dress = adg_dim_style_get_line_dress(dim_style);
     adg_entity_apply_dress(entity, dress, cr);
 
@@ -739,8 +798,8 @@ _adg_compute_geometry(AdgDim *dim)
     AdgLDimPrivate *data;
     AdgPoint *ref1_point, *ref2_point, *pos_point;
     const CpmlPair *ref1, *ref2, *pos;
-    CpmlVector baseline, extension;
-    gdouble d, k;
+    const CpmlVector *extension;
+    gdouble k;
 
     ref1_point = adg_dim_get_ref1(dim);
     if (! adg_point_update(ref1_point)) {
@@ -771,23 +830,17 @@ _adg_compute_geometry(AdgDim *dim)
     ldim = (AdgLDim *) dim;
     data = ldim->data;
 
-    cpml_vector_from_angle(&extension, data->direction);
-    cpml_pair_copy(&baseline, &extension);
-    cpml_vector_normal(&baseline);
-
-    d = extension.y * baseline.x -
-        extension.x * baseline.y;
-    g_return_val_if_fail(d != 0, FALSE);
+    /* The extension vector is a cached unit vector, so the base points
+     * are simply the projections of pos on the extension lines */
+    extension = &data->extension;
 
-    k = ((pos->y - ref1->y) * baseline.x -
-         (pos->x - ref1->x) * baseline.y) / d;
-    data->geometry.base1.x = ref1->x + k * extension.x;
-    data->geometry.base1.y = ref1->y + k * extension.y;
+    k = (pos->x - ref1->x) * extension->x + (pos->y - ref1->y) * extension->y;
+    data->geometry.base1.x = ref1->x + k * extension->x;
+    data->geometry.base1.y = ref1->y + k * extension->y;
 
-    k = ((pos->y - ref2->y) * baseline.x -
-         (pos->x - ref2->x) * baseline.y) / d;
-    data->geometry.base2.x = ref2->x + k * extension.x;
-    data->geometry.base2.y = ref2->y + k * extension.y;
+    k = (pos->x - ref2->x) * extension->x + (pos->y - ref2->y) * extension->y;
+    data->geometry.base2.x = ref2->x + k * extension->x;
+    data->geometry.base2.y = ref2->y + k * extension->y;
 
     data->geometry.distance = cpml_pair_distance(&data->geometry.base1,
                                                  &data->geometry.base2);
@@ -803,7 +856,7 @@ _adg_update_shift(AdgLDim *ldim)
     AdgDimStyle *dim_style;
     gdouble from_offset, to_offset;
     gdouble baseline_spacing, level;
-    CpmlVector vector;
+    const CpmlVector *extension;
 
     data = ldim->data;
 
@@ -816,16 +869,17 @@ _adg_update_shift(AdgLDim *ldim)
     baseline_spacing = adg_dim_style_get_baseline_spacing(dim_style);
     level = adg_dim_get_level((AdgDim *) ldim);
 
-    cpml_vector_from_angle(&vector, data->direction);
+    /* Scaling the unit vector avoids cpml_vector_set_length() */
+    extension = &data->extension;
 
-    cpml_vector_set_length(&vector, from_offset);
-    cpml_pair_copy(&data->shift.from, &vector);
+    data->shift.from.x = extension->x * from_offset;
+    data->shift.from.y = extension->y * from_offset;
 
-    cpml_vector_set_length(&vector, to_offset);
-    cpml_pair_copy(&data->shift.to, &vector);
+    data->shift.to.x = extension->x * to_offset;
+    data->shift.to.y = extension->y * to_offset;
 
-    cpml_vector_set_length(&vector, level * baseline_spacing);
-    cpml_pair_copy(&data->shift.base, &vector);
+    data->shift.base.x = extension->x * level * baseline_spacing;
+    data->shift.base.y = extension->y * level * baseline_spacing;
 }
 
 static void
@@ -876,10 +930,10 @@ _adg_choose_flags(AdgLDim *ldim, gboolean *to_outside, gboolean *to_detach)
         return;
 
     data = ldim->data;
-    local = adg_entity_get_local_matrix((AdgEntity *) ldim);
-    global = adg_entity_get_global_matrix((AdgEntity *) ldim);
-    local_factor = abs(local->xx + local->yy) / 2;
-    global_factor = abs(global->xx + global->yy) / 2;
+    local = _adg_entity_get_local_matrix((AdgEntity *) ldim);
+    global = _adg_entity_get_global_matrix((AdgEntity *) ldim);
+    local_factor = fabs(local->xx + local->yy) / 2;
+    global_factor = fabs(global->xx + global->yy) / 2;
     available_space = data->geometry.distance * local_factor * global_factor;
 
     markers_space = 0;
@@ -892,6 +946,20 @@ _adg_choose_flags(AdgLDim *ldim, gboolean *to_outside, gboolean *to_detach)
         markers_space *= global_factor;
     }
 
+    /* Reuse the previous choice on small changes: this avoids the
+     * arrange of the quote and, while dragging, keeps the quote from
+     * jumping back and forth across the threshold */
+    if (data->flags.is_cached &&
+        data->flags.outside == outside &&
+        data->flags.detached == detached &&
+        data->flags.markers_space == markers_space &&
+        fabs(available_space - data->flags.available_space) <=
+        data->flags.available_space * _ADG_FLAGS_HYSTERESIS) {
+        *to_outside = data->flags.to_outside;
+        *to_detach = data->flags.to_detach;
+        return;
+    }
+
     if (detached == ADG_THREE_STATE_ON) {
         /* Leave at least 0.25 markers_space between the markers */
         quote_space = markers_space * 0.25;
@@ -921,6 +989,14 @@ _adg_choose_flags(AdgLDim *ldim, gboolean *to_outside, gboolean *to_detach)
         /* Only the detached flag may be guessed */
         *to_detach = quote_space + markers_space > available_space;
     }
+
+    data->flags.is_cached = TRUE;
+    data->flags.outside = outside;
+    data->flags.detached = detached;
+    data->flags.available_space = available_space;
+    data->flags.markers_space = markers_space;
+    data->flags.to_outside = *to_outside;
+    data->flags.to_detach = *to_detach;
 }
 
 static void
@@ -1098,6 +1174,40 @@ _adg_dispose_markers(AdgLDim *ldim)
     }
 }
 
+static void
+_adg_reset_markers(AdgLDim *ldim)
+{
+    AdgLDimPrivate *data;
+    AdgDimStyle *dim_style;
+
+    data = ldim->data;
+    dim_style = _ADG_GET_DIM_STYLE(ldim);
+
+    /* Without a resolved dim style the markers cannot be checked */
+    if (dim_style == NULL) {
+        _adg_dispose_markers(ldim);
+        return;
+    }
+
+    if (data->marker1 != NULL) {
+        if (adg_dim_style_reset_marker1(dim_style, data->marker1)) {
+            adg_entity_invalidate((AdgEntity *) data->marker1);
+        } else {
+            g_object_unref(data->marker1);
+            data->marker1 = NULL;
+        }
+    }
+
+    if (data->marker2 != NULL) {
+        if (adg_dim_style_reset_marker2(dim_style, data->marker2)) {
+            adg_entity_invalidate((AdgEntity *) data->marker2);
+        } else {
+            g_object_unref(data->marker2);
+            data->marker2 = NULL;
+        }
+    }
+}
+
 static cairo_path_t *
 _adg_trail_callback(AdgTrail *trail, gpointer user_data)
 {
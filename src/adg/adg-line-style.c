@@ -75,6 +75,8 @@ static gboolean         _adg_change_dash        (AdgLineStyle   *style,
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gboolean         _adg_is_current_dash    (const AdgDash  *dash,
+                                                 cairo_t        *cr);
 
 
 static void
@@ -614,10 +616,36 @@ _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
     cairo_set_miter_limit(cr, data->miter_limit);
     cairo_set_antialias(cr, data->antialias);
 
-    if (data->dash != NULL) {
+    /* cairo copies the dash array on every call: skip it when the
+     * same pattern is already in use */
+    if (data->dash != NULL && ! _adg_is_current_dash(data->dash, cr)) {
         cairo_set_dash(cr,
                        adg_dash_get_dashes(data->dash),
                        adg_dash_get_num_dashes(data->dash),
                        adg_dash_get_offset(data->dash));
     }
 }
+
+static gboolean
+_adg_is_current_dash(const AdgDash *dash, cairo_t *cr)
+{
+    const gdouble *dashes;
+    gdouble *current, offset;
+    gint num_dashes, n;
+
+    num_dashes = adg_dash_get_num_dashes(dash);
+    if (cairo_get_dash_count(cr) != num_dashes)
+        return FALSE;
+
+    current = g_newa(gdouble, num_dashes);
+    cairo_get_dash(cr, current, &offset);
+    if (offset != adg_dash_get_offset(dash))
+        return FALSE;
+
+    dashes = adg_dash_get_dashes(dash);
+    for (n = 0; n < num_dashes; ++n)
+        if (current[n] != dashes[n])
+            return FALSE;
+
+    return TRUE;
+}
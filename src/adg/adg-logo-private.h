@@ -22,14 +22,23 @@
 
 G_BEGIN_DECLS
 
+typedef struct _AdgLogoRecording    AdgLogoRecording;
 typedef struct _AdgLogoClassPrivate AdgLogoClassPrivate;
 typedef struct _AdgLogoPrivate      AdgLogoPrivate;
 
+struct _AdgLogoRecording {
+    cairo_matrix_t   matrix;
+    cairo_matrix_t   local;
+    AdgStyle        *styles[3];
+    cairo_surface_t *surface;
+};
+
 struct _AdgLogoClassPrivate {
     AdgPath     *symbol;
     AdgPath     *screen;
     AdgPath     *frame;
     CpmlExtents  extents;
+    GSList      *recordings;
 };
 
 struct _AdgLogoPrivate {
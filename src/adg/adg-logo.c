@@ -24,6 +24,12 @@
  *
  * The #AdgLogo is an entity representing the default ADG logo.
  *
+ * The logo is identical on every drawing, so its rendering is recorded
+ * once for every device scale and replayed by all the logos of the
+ * process, regardless of the canvas they belong to. The recording is
+ * keyed on the styles resolved by the logo dresses: a style modified
+ * in place after the first rendering is not picked up.
+ *
  * Since: 1.0
  **/
 
@@ -43,10 +49,13 @@
 #include "adg-path.h"
 #include "adg-dress.h"
 #include "adg-param-dress.h"
+#include "adg-entity-private.h"
 
 #include "adg-logo.h"
 #include "adg-logo-private.h"
 
+#include <string.h>
+
 
 G_DEFINE_TYPE(AdgLogo, adg_logo, ADG_TYPE_ENTITY)
 
@@ -70,6 +79,16 @@ static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
 static void             _adg_arrange_class      (AdgLogoClass   *logo_class);
+static void             _adg_draw               (AdgEntity      *entity,
+                                                 cairo_t        *cr);
+static AdgLogoRecording *
+                        _adg_get_recording      (AdgEntity      *entity,
+                                                 const AdgLogoRecording *key);
+
+G_LOCK_DEFINE_STATIC(_adg_logo_class);
+
+/* Maximum number of device scales recorded at the same time */
+#define _ADG_MAX_RECORDINGS     4
 
 
 static void
@@ -123,6 +142,7 @@ adg_logo_class_init(AdgLogoClass *klass)
     data_class->screen = NULL;
     data_class->frame = NULL;
     data_class->extents.is_defined = FALSE;
+    data_class->recordings = NULL;
 
     klass->data_class = data_class;
 }
@@ -352,11 +372,16 @@ _adg_arrange(AdgEntity *entity)
     logo_class = ADG_LOGO_GET_CLASS(entity);
     data_class = logo_class->data_class;
 
+    /* The class data are shared by all the logos, that could be
+     * arranged on different threads by a parallel container */
+    G_LOCK(_adg_logo_class);
     _adg_arrange_class(logo_class);
     cpml_extents_copy(&extents, &data_class->extents);
+    G_UNLOCK(_adg_logo_class);
 
-    cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
-    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+    cpml_extents_transform_chained(&extents,
+                                   _adg_entity_get_local_matrix(entity),
+                                   _adg_entity_get_global_matrix(entity));
     adg_entity_set_extents(entity, &extents);
 }
 
@@ -431,6 +456,101 @@ _adg_arrange_class(AdgLogoClass *logo_class)
 
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgLogoPrivate *data;
+    AdgLogoRecording key, *recording;
+    cairo_surface_t *surface;
+    gdouble x, y, x0, y0;
+
+    data = ((AdgLogo *) entity)->data;
+
+    cairo_transform(cr, _adg_entity_get_global_matrix(entity));
+    cairo_get_matrix(cr, &key.matrix);
+    key.surface = NULL;
+    adg_matrix_copy(&key.local, _adg_entity_get_local_matrix(entity));
+    key.styles[0] = adg_entity_style(entity, data->symbol_dress);
+    key.styles[1] = adg_entity_style(entity, data->screen_dress);
+    key.styles[2] = adg_entity_style(entity, data->frame_dress);
+
+    G_LOCK(_adg_logo_class);
+    recording = _adg_get_recording(entity, &key);
+    surface = cairo_surface_reference(recording->surface);
+
+    /* The recording is valid up to a translation: get the offset
+     * by comparing where the logo origin lands in device space */
+    x = key.local.x0;
+    y = key.local.y0;
+    cairo_matrix_transform_point(&key.matrix, &x, &y);
+    x0 = recording->local.x0;
+    y0 = recording->local.y0;
+    cairo_matrix_transform_point(&recording->matrix, &x0, &y0);
+    G_UNLOCK(_adg_logo_class);
+
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_set_source_surface(cr, surface, x - x0, y - y0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    cairo_surface_destroy(surface);
+}
+
+/* Returns the recording matching @key, creating it if not found.
+ * It must be called with the class lock held */
+static AdgLogoRecording *
+_adg_get_recording(AdgEntity *entity, const AdgLogoRecording *key)
+{
+    AdgLogoClassPrivate *data_class;
+    AdgLogoRecording *recording;
+    GSList *node, *last;
+    cairo_t *cr;
+
+    data_class = ADG_LOGO_GET_CLASS(entity)->data_class;
+
+    for (node = data_class->recordings; node; node = node->next) {
+        recording = node->data;
+        if (recording->matrix.xx == key->matrix.xx &&
+            recording->matrix.yx == key->matrix.yx &&
+            recording->matrix.xy == key->matrix.xy &&
+            recording->matrix.yy == key->matrix.yy &&
+            recording->local.xx == key->local.xx &&
+            recording->local.yx == key->local.yx &&
+            recording->local.xy == key->local.xy &&
+            recording->local.yy == key->local.yy &&
+            memcmp(recording->styles, key->styles, sizeof(key->styles)) == 0) {
+            /* Move the hit on top of the list */
+            data_class->recordings = g_slist_remove_link(data_class->recordings, node);
+            data_class->recordings = g_slist_concat(node, data_class->recordings);
+            return recording;
+        }
+    }
+
+    recording = g_new(AdgLogoRecording, 1);
+    *recording = *key;
+    recording->surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+
+    _adg_arrange_class(ADG_LOGO_GET_CLASS(entity));
+    cr = cairo_create(recording->surface);
+    cairo_set_matrix(cr, &recording->matrix);
+    _adg_draw(entity, cr);
+    cairo_destroy(cr);
+
+    data_class->recordings = g_slist_prepend(data_class->recordings, recording);
+
+    /* Drop the least recently used recording */
+    if (g_slist_length(data_class->recordings) > _ADG_MAX_RECORDINGS) {
+        last = g_slist_last(data_class->recordings);
+        data_class->recordings = g_slist_remove_link(data_class->recordings, last);
+        cairo_surface_destroy(((AdgLogoRecording *) last->data)->surface);
+        g_free(last->data);
+        g_slist_free_1(last);
+    }
+
+    return recording;
+}
+
+static void
+_adg_draw(AdgEntity *entity, cairo_t *cr)
 {
     AdgLogoClassPrivate *data_class;
     AdgLogoPrivate *data;
@@ -439,13 +559,12 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     data_class = ADG_LOGO_GET_CLASS(entity)->data_class;
     data = ((AdgLogo *) entity)->data;
 
-    cairo_transform(cr, adg_entity_get_global_matrix(entity));
     cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
 
     cairo_path = adg_trail_get_cairo_path((AdgTrail *) data_class->symbol);
     if (cairo_path != NULL) {
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, _adg_entity_get_local_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
@@ -458,7 +577,7 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     cairo_path = adg_trail_get_cairo_path((AdgTrail *) data_class->screen);
     if (cairo_path != NULL) {
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, _adg_entity_get_local_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
@@ -471,7 +590,7 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     cairo_path = adg_trail_get_cairo_path((AdgTrail *) data_class->frame);
     if (cairo_path != NULL) {
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, _adg_entity_get_local_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
@@ -64,6 +64,10 @@
  * (the one returned by this method) to every path endings by using
  * different transformations.
  *
+ * The model is kept across invalidations, so a derived class must drop
+ * it with adg_marker_set_model(marker, <constant>NULL</constant>)
+ * whenever a property it depends on is changed.
+ *
  * Since: 1.0
  **/
 
@@ -103,7 +107,6 @@ static void             _adg_set_property       (GObject        *object,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
 static void             _adg_local_changed      (AdgEntity      *entity);
-static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_clear_trail        (AdgMarker      *marker);
 static gboolean         _adg_set_segment        (AdgMarker      *marker,
                                                  AdgTrail       *trail,
@@ -128,7 +131,6 @@ adg_marker_class_init(AdgMarkerClass *klass)
     gobject_class->get_property = _adg_get_property;
 
     entity_class->local_changed = _adg_local_changed;
-    entity_class->invalidate = _adg_invalidate;
 
     klass->create_model = _adg_create_model;
 
@@ -427,6 +429,11 @@ adg_marker_get_segment(AdgMarker *marker)
  * #AdgMarker:trail or #AdgMarker:n-segment) the original segment
  * is automatically restored.
  *
+ * Changing the subject segment only references the data owned by
+ * the trail: this is the only function that copies it, so it should
+ * be called only by markers that really modify the segment. The
+ * buffer of a previous backup is reused when the size matches.
+ *
  * Since: 1.0
  **/
 void
@@ -441,14 +448,21 @@ adg_marker_backup_segment(AdgMarker *marker)
     if (data->n_segment > 0) {
         g_return_if_fail(data->trail != NULL);
 
-        g_free(data->backup_segment);
-
         /* Backup the segment, if a segment to backup exists */
-        if (adg_trail_put_segment(data->trail, data->n_segment,
-                                  &data->segment))
-            data->backup_segment = cpml_segment_deep_dup(&data->segment);
-        else
+        if (! adg_trail_put_segment(data->trail, data->n_segment,
+                                    &data->segment)) {
+            g_free(data->backup_segment);
             data->backup_segment = NULL;
+        } else if (data->backup_segment != NULL &&
+                   data->backup_segment->num_data == data->segment.num_data &&
+                   data->segment.num_data > 0) {
+            /* Same size: overwrite the previous backup in place */
+            memcpy(data->backup_segment->data, data->segment.data,
+                   sizeof(cairo_path_data_t) * data->segment.num_data);
+        } else {
+            g_free(data->backup_segment);
+            data->backup_segment = cpml_segment_deep_dup(&data->segment);
+        }
     }
 }
 
@@ -648,9 +662,14 @@ adg_marker_model(AdgMarker *marker)
     if (data->model == NULL) {
         /* Model not found: regenerate it */
         AdgMarkerClass *marker_class = ADG_MARKER_GET_CLASS(marker);
+        AdgModel *model;
 
-        if (marker_class->create_model)
-            adg_marker_set_model(marker, marker_class->create_model(marker));
+        if (marker_class->create_model) {
+            model = marker_class->create_model(marker);
+            adg_marker_set_model(marker, model);
+            if (model != NULL)
+                g_object_unref(model);
+        }
     }
 
     return data->model;
@@ -688,12 +707,6 @@ _adg_local_changed(AdgEntity *entity)
         _ADG_OLD_ENTITY_CLASS->local_changed(entity);
 }
 
-static void
-_adg_invalidate(AdgEntity *entity)
-{
-    adg_marker_set_model((AdgMarker *) entity, NULL);
-}
-
 
 static void
 _adg_clear_trail(AdgMarker *marker)
@@ -48,14 +48,15 @@
 const cairo_matrix_t *
 adg_matrix_identity(void)
 {
-    static cairo_matrix_t *identity_matrix = NULL;
+    static cairo_matrix_t identity_matrix;
+    static gsize initialized = 0;
 
-    if (G_UNLIKELY(identity_matrix == NULL)) {
-        identity_matrix = g_new(cairo_matrix_t, 1);
-        cairo_matrix_init_identity(identity_matrix);
+    if (g_once_init_enter(&initialized)) {
+        cairo_matrix_init_identity(&identity_matrix);
+        g_once_init_leave(&initialized, 1);
     }
 
-    return identity_matrix;
+    return &identity_matrix;
 }
 
 /**
@@ -71,12 +72,10 @@ adg_matrix_identity(void)
 const cairo_matrix_t *
 adg_matrix_null(void)
 {
-    static cairo_matrix_t *null_matrix = NULL;
+    /* Static storage is zero initialized, so no setup is needed */
+    static cairo_matrix_t null_matrix;
 
-    if (G_UNLIKELY(null_matrix == NULL))
-        null_matrix = g_new0(cairo_matrix_t, 1);
-
-    return null_matrix;
+    return &null_matrix;
 }
 
 /**
@@ -25,19 +25,53 @@
 G_BEGIN_DECLS
 
 typedef struct _AdgModelPrivate  AdgModelPrivate;
-typedef struct _AdgWrapperHelper AdgWrapperHelper;
+typedef struct _AdgModelSlot     AdgModelSlot;
+typedef struct _AdgModelBinding  AdgModelBinding;
 
 struct _AdgModelPrivate {
-    GSList     *dependencies;
-    GHashTable *named_pairs;
+    GHashTable *dependencies;
+    GHashTable *named_dependencies;
+    GSList     *dependency_list;
+    GArray     *named_pairs;
+    GHashTable *slots;
+    GHashTable *bindings;
+    guint       stamp;
+    gboolean    frozen;
 };
 
-struct _AdgWrapperHelper {
-    AdgNamedPairFunc callback;
-    AdgModel        *model;
-    gpointer         user_data;
+/* Slots are never removed from the named_pairs array so their index
+ * can be safely cached by AdgPoint. The was_defined and old_pair fields
+ * keep the state at the last AdgModel::changed emission */
+struct _AdgModelSlot {
+    GQuark      name;
+    gboolean    is_defined;
+    CpmlPair    pair;
+    gboolean    was_defined;
+    CpmlPair    old_pair;
 };
 
+/* A binding holds the resolved value of a named pair, shared by all
+ * the AdgPoint linked to the same (model, name) couple. The value is
+ * fresh as long as stamp matches the stamp of the model, that is
+ * bumped whenever a named pair is set, removed or reset */
+struct _AdgModelBinding {
+    CpmlPair    pair;
+    GQuark      name;
+    guint       slot;
+    gboolean    is_defined;
+    guint       stamp;
+    guint       refcount;
+};
+
+
+AdgModelBinding *
+                _adg_model_bind                 (AdgModel       *model,
+                                                 GQuark          name);
+void            _adg_model_unbind               (AdgModel       *model,
+                                                 AdgModelBinding *binding);
+const CpmlPair *_adg_model_resolve              (AdgModel       *model,
+                                                 AdgModelBinding *binding);
+
 G_END_DECLS
 
 
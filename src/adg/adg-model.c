@@ -36,6 +36,23 @@
  * emitted), every dependency of the model (#AdgEntity instances) is
  * invalidated with adg_entity_invalidate().
  *
+ * Entities bound to a model only through named pairs (that is by using
+ * adg_model_add_named_dependency(), as done by adg_entity_point()) are
+ * invalidated only when one of the named pairs they reference has been
+ * modified since the last #AdgModel::changed emission.
+ *
+ * The invalidation is performed by adg_entity_geometry_changed(): the
+ * entities that support it (e.g. the dimensions) just update their
+ * coordinates while any other entity is fully invalidated.
+ *
+ * When a lot of models are changed at once, the invalidation can be
+ * postponed by wrapping the code between adg_model_freeze_changes() and
+ * adg_model_thaw_changes(): in this way any dependent entity is
+ * invalidated only once, no matter how many of its models changed.
+ *
+ * A model can also be made read-only with adg_model_freeze(), e.g. to
+ * render the same geometry from different threads without locking.
+ *
  * To help the interaction between model and view another concept is
  * introduced: named pairs. This provides a way to abstract real values (the
  * coordinates stored in #CpmlPair) by accessing them using a string. To easily
@@ -57,6 +74,8 @@
  * AdgModelClass:
  * @named_pair:        virtual method that returns the #CpmlPair bound to a
  *                     given name.
+ * @freeze:            virtual method that precomputes any cached data before
+ *                     the model becomes read-only.
  * @set_named_pair:    signal for defining or undefining a new named pair.
  * @clear:             signal for removing the internal cache data, if any.
  * @reset:             signal used to redefine a model from scratch.
@@ -65,24 +84,36 @@
  * @changed:           signal for emitting an #AdgModel::changed signal.
  *
  *
- * The default @named_pair implementation looks up the #CpmlPair in an internal
- * #GHashTable that uses the pair name as key and the #CpmlPair struct as value.
+ * The default @named_pair implementation interns the name into a #GQuark
+ * and looks up the #CpmlPair in an internal dense array of slots, one per
+ * name. The same lookup can be done without the string hashing with
+ * adg_model_get_named_pair_by_quark().
+ *
+ * There is no default @freeze implementation: the named pairs need no
+ * precomputation. Models with lazily built data (such as #AdgTrail) must
+ * build everything here and must not modify their instance afterward.
  *
  * The default @set_named_pair implementation can be used for either adding
  * (if the #CpmlPair is not <constant>NULL</constant>) or removing (if #CpmlPair
- * is <constant>NULL</constant>) an item from the named pairs hash table.
+ * is <constant>NULL</constant>) an item from the named pairs array.
  *
  * The default handler for @clear signals does not do anything.
  *
  * The default @reset involves the clearing of the internal cache data
  * (done by emitting the #AdgModel::clear signal) and the destruction of the
- * internal named pair hash table.
+ * internal named pairs array.
  *
  * The default @add_dependency and @remove_dependency implementations add and
- * remove items from an internal #GSList of #AdgEntity.
+ * remove items from an internal #GHashTable of #AdgEntity, so both are
+ * O(1). An entity can be added more than once (e.g. when more points of
+ * the same entity are bound to @model): in that case it must be removed
+ * the same number of times before being dropped from @model.
  *
  * The default handler of the @changed signal calls adg_entity_invalidate()
- * on every dependency by using adg_model_foreach_dependency().
+ * on every dependency by using adg_model_foreach_dependency(), skipping
+ * the entities that depend only on named pairs left untouched. Inside a
+ * batch of changes the dependencies are collected instead and invalidated
+ * by adg_model_thaw_changes().
  *
  * Since: 1.0
  **/
@@ -139,6 +170,7 @@ enum {
 
 
 static void             _adg_dispose            (GObject        *object);
+static void             _adg_finalize           (GObject        *object);
 static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
@@ -154,13 +186,34 @@ static void             _adg_set_named_pair     (AdgModel       *model,
                                                  const gchar    *name,
                                                  const CpmlPair *pair);
 static void             _adg_changed            (AdgModel       *model);
-static void             _adg_named_pair_wrapper (gpointer        key,
+static const CpmlPair * _adg_slot_lookup       (AdgModelPrivate *data,
+                                                 GQuark          name,
+                                                 guint          *slot);
+static const GSList *   _adg_dependency_list    (AdgModelPrivate *data);
+static void             _adg_touch_bindings     (AdgModelPrivate *data);
+static void             _adg_commit_named_pairs (AdgModelPrivate *data);
+static void             _adg_store_named_pairs  (AdgModel       *model,
+                                                 const gchar   **names,
+                                                 const CpmlPair *pairs,
+                                                 guint           n_pairs);
+static gboolean         _adg_is_affected        (AdgModelPrivate *data,
+                                                 AdgEntity      *entity);
+static void             _adg_free_names         (gpointer        names);
+static void             _adg_prepend_dependency (gpointer        key,
                                                  gpointer        value,
                                                  gpointer        user_data);
 static void             _adg_invalidate_wrapper (AdgModel       *model,
                                                  AdgEntity      *entity,
                                                  gpointer        user_data);
+static void             _adg_postpone_wrapper   (AdgModel       *model,
+                                                 AdgEntity      *entity,
+                                                 gpointer        user_data);
+static void             _adg_invalidate_pending (gpointer        key,
+                                                 gpointer        value,
+                                                 gpointer        user_data);
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
+static guint            _adg_freeze_count = 0;
+static GHashTable *     _adg_pending = NULL;
 
 
 static void
@@ -174,11 +227,13 @@ adg_model_class_init(AdgModelClass *klass)
     g_type_class_add_private(klass, sizeof(AdgModelPrivate));
 
     gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
     gobject_class->set_property = _adg_set_property;
 
     klass->add_dependency = _adg_add_dependency;
     klass->remove_dependency = _adg_remove_dependency;
     klass->named_pair = _adg_named_pair;
+    klass->freeze = NULL;
     klass->set_named_pair = _adg_set_named_pair;
     klass->clear = NULL;
     klass->reset = _adg_reset;
@@ -332,7 +387,15 @@ adg_model_init(AdgModel *model)
     AdgModelPrivate *data = G_TYPE_INSTANCE_GET_PRIVATE(model, ADG_TYPE_MODEL,
                                                         AdgModelPrivate);
 
-    data->dependencies = NULL;
+    data->dependencies = g_hash_table_new(NULL, NULL);
+    data->named_dependencies = g_hash_table_new_full(NULL, NULL, NULL,
+                                                     _adg_free_names);
+    data->dependency_list = NULL;
+    data->named_pairs = NULL;
+    data->slots = NULL;
+    data->bindings = NULL;
+    data->stamp = 1;
+    data->frozen = FALSE;
 
     model->data = data;
 }
@@ -345,7 +408,9 @@ _adg_dispose(GObject *object)
     if (G_UNLIKELY(!is_disposed)) {
         AdgModel *model;
         AdgModelPrivate *data;
+        GSList *dependencies, *dependency;
         AdgEntity *entity;
+        guint count;
 
         model = (AdgModel *) object;
         data = model->data;
@@ -353,10 +418,15 @@ _adg_dispose(GObject *object)
         /* Remove all the dependencies: this will emit a
          * "remove-dependency" signal for every dependency, dropping
          * all references from entities to this model */
-        while (data->dependencies != NULL) {
-            entity = (AdgEntity *) data->dependencies->data;
-            adg_model_remove_dependency(model, entity);
+        dependencies = g_slist_copy((GSList *) _adg_dependency_list(data));
+        for (dependency = dependencies; dependency; dependency = dependency->next) {
+            entity = dependency->data;
+            count = GPOINTER_TO_UINT(g_hash_table_lookup(data->dependencies,
+                                                         entity));
+            while (count --)
+                adg_model_remove_dependency(model, entity);
         }
+        g_slist_free(dependencies);
 
         g_signal_emit(model, _adg_signals[RESET], 0);
     }
@@ -365,6 +435,29 @@ _adg_dispose(GObject *object)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgModelPrivate *data = ((AdgModel *) object)->data;
+
+    g_hash_table_destroy(data->dependencies);
+    g_hash_table_destroy(data->named_dependencies);
+    g_slist_free(data->dependency_list);
+
+    if (data->named_pairs != NULL) {
+        g_array_free(data->named_pairs, TRUE);
+        g_hash_table_destroy(data->slots);
+    }
+
+    /* Every AdgPoint holds a reference to the model, so no binding
+     * can be left at this point */
+    if (data->bindings != NULL)
+        g_hash_table_destroy(data->bindings);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
 static void
 _adg_set_property(GObject *object, guint prop_id,
                   const GValue *value, GParamSpec *pspec)
@@ -429,12 +522,111 @@ adg_model_remove_dependency(AdgModel *model, AdgEntity *entity)
     g_signal_emit(model, _adg_signals[REMOVE_DEPENDENCY], 0, entity);
 }
 
+/**
+ * adg_model_add_named_dependency:
+ * @model: an #AdgModel
+ * @entity: an #AdgEntity
+ * @name: the name of the named pair used by @entity
+ *
+ * <note><para>
+ * This function is only useful in entity implementations.
+ * </para></note>
+ *
+ * Works in the same way of adg_model_add_dependency() but also
+ * records that @entity is using the @name named pair. If all the
+ * dependencies of @entity on @model are named, @entity will be
+ * invalidated only when one of those named pairs changes.
+ *
+ * The dependency must be removed with adg_model_remove_named_dependency().
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_add_named_dependency(AdgModel *model, AdgEntity *entity,
+                               const gchar *name)
+{
+    AdgModelPrivate *data;
+    GArray *names;
+    GQuark quark;
+
+    g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(name != NULL);
+
+    data = model->data;
+    adg_model_add_dependency(model, entity);
+
+    /* Do not record anything if the dependency has not been added */
+    if (g_hash_table_lookup(data->dependencies, entity) == NULL)
+        return;
+
+    names = g_hash_table_lookup(data->named_dependencies, entity);
+    if (names == NULL) {
+        names = g_array_new(FALSE, FALSE, sizeof(GQuark));
+        g_hash_table_insert(data->named_dependencies, entity, names);
+    }
+
+    quark = g_quark_from_string(name);
+    g_array_append_val(names, quark);
+}
+
+/**
+ * adg_model_remove_named_dependency:
+ * @model: an #AdgModel
+ * @entity: an #AdgEntity
+ * @name: the name of the named pair used by @entity
+ *
+ * <note><para>
+ * This function is only useful in entity implementations.
+ * </para></note>
+ *
+ * Removes a dependency previously added with
+ * adg_model_add_named_dependency().
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_remove_named_dependency(AdgModel *model, AdgEntity *entity,
+                                  const gchar *name)
+{
+    AdgModelPrivate *data;
+    GArray *names;
+    GQuark quark;
+    guint n;
+
+    g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(name != NULL);
+
+    data = model->data;
+    names = g_hash_table_lookup(data->named_dependencies, entity);
+    quark = g_quark_try_string(name);
+
+    if (names != NULL) {
+        for (n = 0; n < names->len; ++ n) {
+            if (g_array_index(names, GQuark, n) == quark) {
+                g_array_remove_index_fast(names, n);
+                break;
+            }
+        }
+
+        if (names->len == 0)
+            g_hash_table_remove(data->named_dependencies, entity);
+    }
+
+    adg_model_remove_dependency(model, entity);
+}
+
 /**
  * adg_model_get_dependencies:
  * @model: an #AdgModel
  *.
  * Gets the list of entities dependending on @model. This list
- * is owned by @model and must not be modified or freed.
+ * is owned by @model and must not be modified or freed. It is
+ * valid only until a dependency is added to or removed from @model.
+ *
+ * Every entity is present only once, regardless of how many
+ * times it has been added.
  *
  * Returns: (transfer none) (element-type Adg.Entity): a #GSList of dependencies or <constant>NULL</constant> on error.
  *
@@ -449,7 +641,7 @@ adg_model_get_dependencies(AdgModel *model)
 
     data = model->data;
 
-    return data->dependencies;
+    return _adg_dependency_list(data);
 }
 
 /**
@@ -458,7 +650,9 @@ adg_model_get_dependencies(AdgModel *model)
  * @callback: (scope call): the entity callback
  * @user_data: general purpose user data passed "as is" to @callback
  *
- * Invokes @callback on each entity linked to @model.
+ * Invokes @callback on each entity linked to @model. @callback is
+ * called only once per entity and it is allowed to add or remove
+ * dependencies on @model.
  *
  * Since: 1.0
  **/
@@ -467,23 +661,26 @@ adg_model_foreach_dependency(AdgModel *model, AdgDependencyFunc callback,
                              gpointer user_data)
 {
     AdgModelPrivate *data;
-    GSList *dependency;
+    GSList *dependencies, *dependency;
     AdgEntity *entity;
 
     g_return_if_fail(ADG_IS_MODEL(model));
     g_return_if_fail(callback != NULL);
 
     data = model->data;
-    dependency = data->dependencies;
 
-    while (dependency) {
+    /* Work on a copy, because the cached list is rebuilt
+     * whenever the dependencies change */
+    dependencies = g_slist_copy((GSList *) _adg_dependency_list(data));
+
+    for (dependency = dependencies; dependency; dependency = dependency->next) {
         entity = dependency->data;
 
         if (entity != NULL && ADG_IS_ENTITY(entity))
             callback(model, entity, user_data);
-
-        dependency = dependency->next;
     }
+
+    g_slist_free(dependencies);
 }
 
 /**
@@ -509,6 +706,7 @@ adg_model_set_named_pair(AdgModel *model, const gchar *name,
 {
     g_return_if_fail(ADG_IS_MODEL(model));
     g_return_if_fail(name != NULL);
+    g_return_if_fail(! adg_model_is_frozen(model));
 
     g_signal_emit(model, _adg_signals[SET_NAMED_PAIR], 0, name, pair);
 }
@@ -543,13 +741,141 @@ adg_model_set_named_pair_explicit(AdgModel *model, const gchar *name,
     adg_model_set_named_pair(model, name, &pair);
 }
 
+/**
+ * adg_model_set_named_pairs:
+ * @model: an #AdgModel
+ * @names: (array length=n_names): the names to associate to the pairs
+ * @n_names: number of items in @names
+ * @coords: (array length=n_coords): packed x and y coordinates
+ * @n_coords: number of items in @coords, that is @n_names * 2
+ *
+ * Sets @n_names named pairs in a single call: the pair named
+ * @names[i] is (@coords[i * 2], @coords[i * 2 + 1]). This is
+ * equivalent to a sequence of adg_model_set_named_pair() calls,
+ * but it is more efficient when called from language bindings.
+ * See adg_model_import_named_pairs() for details.
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_set_named_pairs(AdgModel *model, const gchar **names, guint n_names,
+                          const gdouble *coords, guint n_coords)
+{
+    g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(n_names == 0 || names != NULL);
+    g_return_if_fail(n_coords == n_names * 2);
+    g_return_if_fail(n_coords == 0 || coords != NULL);
+    g_return_if_fail(! adg_model_is_frozen(model));
+
+    /* CpmlPair is a couple of packed doubles */
+    _adg_store_named_pairs(model, names, (const CpmlPair *) coords, n_names);
+}
+
+/**
+ * adg_model_import_named_pairs:
+ * @model: an #AdgModel
+ * @names: (array length=n_pairs): the names to associate to the pairs
+ * @pairs: (array length=n_pairs): the pairs to set
+ * @n_pairs: number of items in @names and @pairs
+ *
+ * Sets @n_pairs named pairs in a single call, where @names[i] is the
+ * name of @pairs[i]. %NULL names are skipped. Once all the pairs are
+ * set, the #AdgModel::changed signal is emitted once, so this is the
+ * preferred way to load a whole set of parameters into @model.
+ *
+ * When the #AdgModel::set-named-pair signal is neither connected nor
+ * overridden, the pairs are stored directly without going through
+ * the signal machinery.
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_import_named_pairs(AdgModel *model, const gchar **names,
+                             const CpmlPair *pairs, guint n_pairs)
+{
+    g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(n_pairs == 0 || (names != NULL && pairs != NULL));
+    g_return_if_fail(! adg_model_is_frozen(model));
+
+    _adg_store_named_pairs(model, names, pairs, n_pairs);
+    adg_model_changed(model);
+}
+
+/**
+ * adg_model_export_named_pairs:
+ * @model: an #AdgModel
+ * @names: (out) (array length=n_pairs) (transfer container) (allow-none): where to store the names
+ * @pairs: (out) (array length=n_pairs) (transfer container) (allow-none): where to store the pairs
+ *
+ * Packs all the named pairs defined on @model in two newly allocated
+ * arrays, in the same order used by adg_model_foreach_named_pair().
+ * The names are interned strings, so only the arrays must be freed
+ * with g_free() when no longer needed. The result can be fed back to
+ * adg_model_import_named_pairs().
+ *
+ * Returns: the number of named pairs exported.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_model_export_named_pairs(AdgModel *model, const gchar ***names,
+                             CpmlPair **pairs)
+{
+    AdgModelPrivate *data;
+    AdgModelSlot *slot;
+    guint n, n_pairs;
+
+    if (names != NULL)
+        *names = NULL;
+    if (pairs != NULL)
+        *pairs = NULL;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), 0);
+
+    data = model->data;
+
+    if (data->named_pairs == NULL)
+        return 0;
+
+    n_pairs = 0;
+    for (n = 0; n < data->named_pairs->len; ++ n) {
+        slot = &g_array_index(data->named_pairs, AdgModelSlot, n);
+        if (slot->is_defined)
+            ++ n_pairs;
+    }
+
+    if (n_pairs == 0)
+        return 0;
+
+    if (names != NULL)
+        *names = g_new(const gchar *, n_pairs);
+    if (pairs != NULL)
+        *pairs = g_new(CpmlPair, n_pairs);
+
+    n_pairs = 0;
+    for (n = 0; n < data->named_pairs->len; ++ n) {
+        slot = &g_array_index(data->named_pairs, AdgModelSlot, n);
+        if (! slot->is_defined)
+            continue;
+
+        if (names != NULL)
+            (*names)[n_pairs] = g_quark_to_string(slot->name);
+        if (pairs != NULL)
+            (*pairs)[n_pairs] = slot->pair;
+        ++ n_pairs;
+    }
+
+    return n_pairs;
+}
+
 /**
  * adg_model_get_named_pair:
  * @model: an #AdgModel
  * @name: the name of the pair to get
  *
  * Gets the @name named pair associated to @model. The returned
- * pair is owned by @model and must not be modified or freed.
+ * pair is owned by @model and must not be modified or freed. It is
+ * valid only until a new named pair is added to @model.
  *
  * Returns: the requested #CpmlPair or <constant>NULL</constant> if not found.
  *
@@ -571,6 +897,46 @@ adg_model_get_named_pair(AdgModel *model, const gchar *name)
     return klass->named_pair(model, name);
 }
 
+/**
+ * adg_model_get_named_pair_by_quark:
+ * @model: an #AdgModel
+ * @name: the #GQuark of the name of the pair to get
+ * @slot: (inout) (allow-none): an hint on where the pair is stored
+ *
+ * Works in the same way of adg_model_get_named_pair() but uses an
+ * interned name instead of a string, so no string hashing is involved.
+ *
+ * If @slot is not <constant>NULL</constant>, it is used as an hint
+ * on where the named pair is stored inside @model and it is updated
+ * with the position found. Passing back the same @slot on subsequent
+ * calls turns the lookup into a single array access. Any value is
+ * accepted: a wrong hint is simply ignored.
+ *
+ * Returns: the requested #CpmlPair or <constant>NULL</constant> if not found.
+ *
+ * Since: 1.0
+ **/
+const CpmlPair *
+adg_model_get_named_pair_by_quark(AdgModel *model, GQuark name, guint *slot)
+{
+    AdgModelClass *klass;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), NULL);
+
+    klass = ADG_MODEL_GET_CLASS(model);
+
+    /* If the named_pair method has been overriden,
+     * fallback to the lookup by name */
+    if (klass->named_pair != _adg_named_pair) {
+        if (klass->named_pair == NULL || name == 0)
+            return NULL;
+
+        return klass->named_pair(model, g_quark_to_string(name));
+    }
+
+    return _adg_slot_lookup(model->data, name, slot);
+}
+
 /**
  * adg_model_foreach_named_pair:
  * @model: an #AdgModel
@@ -588,7 +954,8 @@ adg_model_foreach_named_pair(AdgModel *model, AdgNamedPairFunc callback,
                              gpointer user_data)
 {
     AdgModelPrivate *data;
-    AdgWrapperHelper helper;
+    AdgModelSlot *slot;
+    guint n;
 
     g_return_if_fail(ADG_IS_MODEL(model));
     g_return_if_fail(callback != NULL);
@@ -598,11 +965,14 @@ adg_model_foreach_named_pair(AdgModel *model, AdgNamedPairFunc callback,
     if (data->named_pairs == NULL)
         return;
 
-    helper.callback = callback;
-    helper.model = model;
-    helper.user_data = user_data;
-
-    g_hash_table_foreach(data->named_pairs, _adg_named_pair_wrapper, &helper);
+    /* The array is accessed by index on every iteration because
+     * @callback is allowed to add new named pairs */
+    for (n = 0; n < data->named_pairs->len; ++ n) {
+        slot = &g_array_index(data->named_pairs, AdgModelSlot, n);
+        if (slot->is_defined)
+            callback(model, g_quark_to_string(slot->name),
+                     &slot->pair, user_data);
+    }
 }
 
 /**
@@ -621,6 +991,7 @@ void
 adg_model_clear(AdgModel *model)
 {
     g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(! adg_model_is_frozen(model));
 
     g_signal_emit(model, _adg_signals[CLEAR], 0);
 }
@@ -637,10 +1008,62 @@ void
 adg_model_reset(AdgModel *model)
 {
     g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(! adg_model_is_frozen(model));
 
     g_signal_emit(model, _adg_signals[RESET], 0);
 }
 
+/**
+ * adg_model_freeze_changes:
+ *
+ * Starts a batch of changes. Until the matching call to
+ * adg_model_thaw_changes(), the #AdgModel::changed signal emitted by
+ * any model does not invalidate the dependent entities immediately:
+ * they are collected instead and invalidated only once when the
+ * batch ends.
+ *
+ * The batch is global, that is it spans all the models, and calls
+ * can be nested: only the outermost adg_model_thaw_changes() will
+ * invalidate the collected entities. Being global, a batch should
+ * not be used while other threads are generating drawings.
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_freeze_changes(void)
+{
+    ++ _adg_freeze_count;
+}
+
+/**
+ * adg_model_thaw_changes:
+ *
+ * Ends a batch of changes started by adg_model_freeze_changes().
+ * If this is the outermost batch, every entity depending on a model
+ * changed in the meantime is invalidated exactly once.
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_thaw_changes(void)
+{
+    GHashTable *pending;
+
+    g_return_if_fail(_adg_freeze_count > 0);
+
+    -- _adg_freeze_count;
+    if (_adg_freeze_count > 0 || _adg_pending == NULL)
+        return;
+
+    /* Detach the set before walking it: the invalidation can emit
+     * new #AdgModel::changed signals, that must be handled directly */
+    pending = _adg_pending;
+    _adg_pending = NULL;
+
+    g_hash_table_foreach(pending, _adg_invalidate_pending, NULL);
+    g_hash_table_destroy(pending);
+}
+
 /**
  * adg_model_changed:
  * @model: an #AdgModel
@@ -649,7 +1072,9 @@ adg_model_reset(AdgModel *model)
  * This function is only useful in entity implementations.
  * </para></note>
  *
- * Emits the #AdgModel::changed signal on @model.
+ * Emits the #AdgModel::changed signal on @model. If a batch of changes
+ * is in progress (see adg_model_freeze_changes()), the invalidation of
+ * the dependent entities is postponed to the end of the batch.
  *
  * Since: 1.0
  **/
@@ -657,38 +1082,192 @@ void
 adg_model_changed(AdgModel *model)
 {
     g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(! adg_model_is_frozen(model));
 
     g_signal_emit(model, _adg_signals[CHANGED], 0);
 }
 
+/**
+ * adg_model_freeze:
+ * @model: an #AdgModel
+ *
+ * Makes @model read-only. Any data lazily computed by @model (e.g.
+ * the cairo path, the extents, the segments and the lengths tables
+ * of an #AdgTrail) is built at once by the <function>freeze</function>
+ * virtual method and the named pairs referenced by #AdgPoint are
+ * resolved, so any further read access does not modify @model.
+ *
+ * After this call the read accessors of @model (adg_model_get_named_pair(),
+ * adg_trail_get_cairo_path(), adg_trail_get_extents() and so on) can be
+ * called concurrently from different threads without locking, e.g. to
+ * render the same geometry on different sheets or output formats at
+ * the same time. @model must be frozen before being shared.
+ *
+ * Any attempt to change a frozen model through the #AdgModel API, such
+ * as adg_model_set_named_pair() or adg_model_changed(), is refused
+ * with a critical warning. The specific APIs of the subclasses, e.g.
+ * adg_path_append(), are not checked: they must not be used anymore.
+ * Binding new entities to @model (adg_model_add_dependency(),
+ * adg_point_set_pair_from_model() and friends) is still allowed but
+ * is not thread safe, so the entities should be built before spawning
+ * the rendering threads.
+ *
+ * Freezing is definitive: there is no way to unfreeze a model. This is
+ * unrelated to adg_model_freeze_changes(), that only postpones the
+ * invalidation of the dependencies.
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_freeze(AdgModel *model)
+{
+    AdgModelClass *klass;
+    AdgModelPrivate *data;
+    GHashTableIter iter;
+    gpointer binding;
+
+    g_return_if_fail(ADG_IS_MODEL(model));
+
+    data = model->data;
+    if (data->frozen)
+        return;
+
+    klass = ADG_MODEL_GET_CLASS(model);
+    if (klass->freeze != NULL)
+        klass->freeze(model);
+
+    /* The frozen flag must be set before resolving the bindings,
+     * so they are cached also by models overriding named_pair */
+    data->frozen = TRUE;
+
+    if (data->bindings != NULL) {
+        g_hash_table_iter_init(&iter, data->bindings);
+        while (g_hash_table_iter_next(&iter, NULL, &binding))
+            _adg_model_resolve(model, binding);
+    }
+}
+
+/**
+ * adg_model_is_frozen:
+ * @model: an #AdgModel
+ *
+ * Checks if @model has been made read-only by adg_model_freeze().
+ *
+ * Returns: <constant>TRUE</constant> if @model is frozen, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_model_is_frozen(AdgModel *model)
+{
+    AdgModelPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), FALSE);
+
+    data = model->data;
+    return data->frozen;
+}
+
+
+/* Returns the binding of the @name named pair of @model, creating it
+ * if needed. The binding must be released with _adg_model_unbind() */
+AdgModelBinding *
+_adg_model_bind(AdgModel *model, GQuark name)
+{
+    AdgModelPrivate *data = model->data;
+    AdgModelBinding *binding;
+
+    if (data->bindings == NULL)
+        data->bindings = g_hash_table_new(NULL, NULL);
+
+    binding = g_hash_table_lookup(data->bindings, GUINT_TO_POINTER(name));
+    if (binding == NULL) {
+        /* A stamp of 0 is never used by the model,
+         * so a new binding is always resolved */
+        binding = g_new0(AdgModelBinding, 1);
+        binding->name = name;
+        g_hash_table_insert(data->bindings, GUINT_TO_POINTER(name), binding);
+
+        /* Bindings of a frozen model must be read-only */
+        if (data->frozen)
+            _adg_model_resolve(model, binding);
+    }
+
+    ++ binding->refcount;
+    return binding;
+}
+
+void
+_adg_model_unbind(AdgModel *model, AdgModelBinding *binding)
+{
+    AdgModelPrivate *data = model->data;
+
+    if (-- binding->refcount > 0)
+        return;
+
+    g_hash_table_remove(data->bindings, GUINT_TO_POINTER(binding->name));
+    g_free(binding);
+}
+
+/* Returns the value of @binding, looking up the named pair only when
+ * the model changed since the last call. Models overriding the
+ * named_pair method are not tracked by the stamp, so they are always
+ * queried unless frozen */
+const CpmlPair *
+_adg_model_resolve(AdgModel *model, AdgModelBinding *binding)
+{
+    AdgModelPrivate *data = model->data;
+    const CpmlPair *pair;
+
+    if (binding->stamp != data->stamp) {
+        pair = adg_model_get_named_pair_by_quark(model, binding->name,
+                                                 &binding->slot);
+        binding->is_defined = pair != NULL;
+        if (pair != NULL)
+            cpml_pair_copy(&binding->pair, pair);
+
+        if (data->frozen ||
+            ADG_MODEL_GET_CLASS(model)->named_pair == _adg_named_pair)
+            binding->stamp = data->stamp;
+    }
+
+    return binding->is_defined ? &binding->pair : NULL;
+}
+
 
 static void
 _adg_add_dependency(AdgModel *model, AdgEntity *entity)
 {
     AdgModelPrivate *data;
+    guint count;
 
     /* Do not add NULL values */
     if (entity == NULL)
         return;
 
     data = model->data;
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(data->dependencies, entity));
 
-    /* The prepend operation is more efficient */
-    data->dependencies = g_slist_prepend(data->dependencies, entity);
+    if (count == 0) {
+        /* New dependency: the reference is held only once */
+        g_object_ref(entity);
+        g_slist_free(data->dependency_list);
+        data->dependency_list = NULL;
+    }
 
-    g_object_ref(entity);
+    g_hash_table_insert(data->dependencies, entity, GUINT_TO_POINTER(count + 1));
 }
 
 static void
 _adg_remove_dependency(AdgModel *model, AdgEntity *entity)
 {
     AdgModelPrivate *data;
-    GSList *node;
+    guint count;
 
     data = model->data;
-    node = g_slist_find(data->dependencies, entity);
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(data->dependencies, entity));
 
-    if (node == NULL) {
+    if (count == 0) {
         g_warning(_("%s: attempting to remove the nonexistent dependency "
                     "on the entity with type %s from a model of type %s"),
                   G_STRLOC,
@@ -697,7 +1276,16 @@ _adg_remove_dependency(AdgModel *model, AdgEntity *entity)
         return;
     }
 
-    data->dependencies = g_slist_delete_link(data->dependencies, node);
+    if (count > 1) {
+        g_hash_table_insert(data->dependencies, entity,
+                            GUINT_TO_POINTER(count - 1));
+        return;
+    }
+
+    g_hash_table_remove(data->dependencies, entity);
+    g_hash_table_remove(data->named_dependencies, entity);
+    g_slist_free(data->dependency_list);
+    data->dependency_list = NULL;
     g_object_unref(entity);
 }
 
@@ -705,12 +1293,17 @@ static void
 _adg_reset(AdgModel *model)
 {
     AdgModelPrivate *data = model->data;
+    guint n;
 
-    adg_model_clear(model);
+    /* Emitted directly: a frozen model is reset on disposal */
+    g_signal_emit(model, _adg_signals[CLEAR], 0);
 
+    /* The slots are only undefined, so the next AdgModel::changed
+     * can check which named pairs have been really modified */
     if (data->named_pairs) {
-        g_hash_table_destroy(data->named_pairs);
-        data->named_pairs = NULL;
+        for (n = 0; n < data->named_pairs->len; ++ n)
+            g_array_index(data->named_pairs, AdgModelSlot, n).is_defined = FALSE;
+        _adg_touch_bindings(data);
     }
 }
 
@@ -718,66 +1311,271 @@ static void
 _adg_set_named_pair(AdgModel *model, const gchar *name, const CpmlPair *pair)
 {
     AdgModelPrivate *data;
-    GHashTable **hash;
-    gchar *key;
-    CpmlPair *value;
+    AdgModelSlot *slot;
+    GQuark quark;
+    guint n;
 
     data = model->data;
-    hash = &data->named_pairs;
 
     if (pair == NULL) {
-        /* Delete mode: raise a warning if @name is not found */
-        if (*hash == NULL || !g_hash_table_remove(*hash, name))
+        /* Delete mode: raise a warning if @name is not found. The slot
+         * is left in place, so cached indexes are still valid */
+        quark = g_quark_try_string(name);
+        if (_adg_slot_lookup(data, quark, &n) == NULL) {
             g_warning(_("%s: attempting to remove nonexistent '%s' named pair"),
                       G_STRLOC, name);
+            return;
+        }
 
+        slot = &g_array_index(data->named_pairs, AdgModelSlot, n);
+        slot->is_defined = FALSE;
+        _adg_touch_bindings(data);
         return;
     }
 
     /* Insert or update mode */
-    key = g_strdup(name);
-    value = cpml_pair_dup(pair);
+    quark = g_quark_from_string(name);
+
+    if (data->named_pairs == NULL) {
+        data->named_pairs = g_array_new(FALSE, FALSE, sizeof(AdgModelSlot));
+        data->slots = g_hash_table_new(NULL, NULL);
+    }
 
-    if (*hash == NULL)
-        *hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    /* The slots hash table stores the index + 1, so 0 means "not found" */
+    n = GPOINTER_TO_UINT(g_hash_table_lookup(data->slots,
+                                             GUINT_TO_POINTER(quark)));
+    if (n == 0) {
+        n = data->named_pairs->len;
+        g_array_set_size(data->named_pairs, n + 1);
+        g_hash_table_insert(data->slots, GUINT_TO_POINTER(quark),
+                            GUINT_TO_POINTER(n + 1));
+        g_array_index(data->named_pairs, AdgModelSlot, n).was_defined = FALSE;
+    } else {
+        -- n;
+    }
 
-    g_hash_table_insert(*hash, key, value);
+    slot = &g_array_index(data->named_pairs, AdgModelSlot, n);
+    slot->name = quark;
+    slot->is_defined = TRUE;
+    cpml_pair_copy(&slot->pair, pair);
+    _adg_touch_bindings(data);
 }
 
 static const CpmlPair *
 _adg_named_pair(AdgModel *model, const gchar *name)
 {
-    AdgModelPrivate *data = model->data;
+    return _adg_slot_lookup(model->data, g_quark_try_string(name), NULL);
+}
 
-    if (data->named_pairs == NULL)
+static void
+_adg_changed(AdgModel *model)
+{
+    AdgModelPrivate *data;
+    GSList *dependencies, *dependency;
+    AdgEntity *entity;
+    gboolean traced;
+
+    data = model->data;
+    traced = _adg_cascade_enter(model, ADG_CASCADE_CHANGED);
+    dependencies = g_slist_copy((GSList *) _adg_dependency_list(data));
+
+    /* Filter out the entities not affected by the change before
+     * committing the new state of the named pairs */
+    for (dependency = dependencies; dependency; dependency = dependency->next) {
+        entity = dependency->data;
+        if (! _adg_is_affected(data, entity))
+            dependency->data = NULL;
+    }
+
+    _adg_commit_named_pairs(data);
+
+    for (dependency = dependencies; dependency; dependency = dependency->next) {
+        entity = dependency->data;
+        if (entity == NULL || ! ADG_IS_ENTITY(entity))
+            continue;
+
+        if (_adg_freeze_count > 0) {
+            /* Collect the dependent entities to invalidate them later */
+            _adg_postpone_wrapper(model, entity, NULL);
+        } else {
+            _adg_invalidate_wrapper(model, entity, NULL);
+        }
+    }
+
+    g_slist_free(dependencies);
+
+    if (traced)
+        _adg_cascade_leave();
+}
+
+static const CpmlPair *
+_adg_slot_lookup(AdgModelPrivate *data, GQuark name, guint *slot)
+{
+    AdgModelSlot *named_pair;
+    guint n;
+
+    if (data->named_pairs == NULL || name == 0)
+        return NULL;
+
+    /* Try the hint first */
+    if (slot != NULL && *slot < data->named_pairs->len) {
+        named_pair = &g_array_index(data->named_pairs, AdgModelSlot, *slot);
+        if (named_pair->name == name)
+            return named_pair->is_defined ? &named_pair->pair : NULL;
+    }
+
+    n = GPOINTER_TO_UINT(g_hash_table_lookup(data->slots,
+                                             GUINT_TO_POINTER(name)));
+    if (n == 0)
         return NULL;
 
-    return g_hash_table_lookup(data->named_pairs, name);
+    -- n;
+    if (slot != NULL)
+        *slot = n;
+
+    named_pair = &g_array_index(data->named_pairs, AdgModelSlot, n);
+    return named_pair->is_defined ? &named_pair->pair : NULL;
 }
 
 static void
-_adg_changed(AdgModel *model)
+_adg_invalidate_wrapper(AdgModel *model, AdgEntity *entity, gpointer user_data)
+{
+    adg_entity_geometry_changed(entity);
+}
+
+static void
+_adg_postpone_wrapper(AdgModel *model, AdgEntity *entity, gpointer user_data)
+{
+    /* The set holds a reference to every entity, so they are
+     * guaranteed to be alive when the batch ends */
+    if (_adg_pending == NULL)
+        _adg_pending = g_hash_table_new_full(NULL, NULL,
+                                             g_object_unref, NULL);
+
+    if (g_hash_table_lookup(_adg_pending, entity) == NULL)
+        g_hash_table_insert(_adg_pending, g_object_ref(entity), entity);
+}
+
+static void
+_adg_invalidate_pending(gpointer key, gpointer value, gpointer user_data)
+{
+    adg_entity_geometry_changed((AdgEntity *) key);
+}
+
+static const GSList *
+_adg_dependency_list(AdgModelPrivate *data)
+{
+    /* The list is rebuilt lazily only after the dependencies changed */
+    if (data->dependency_list == NULL && data->dependencies != NULL)
+        g_hash_table_foreach(data->dependencies, _adg_prepend_dependency,
+                             &data->dependency_list);
+
+    return data->dependency_list;
+}
+
+static void
+_adg_touch_bindings(AdgModelPrivate *data)
 {
-    /* Invalidate all the entities dependent on this model */
-    adg_model_foreach_dependency(model, _adg_invalidate_wrapper, NULL);
+    /* Skip 0 on wrap around: it is reserved to new bindings */
+    if (++ data->stamp == 0)
+        data->stamp = 1;
+}
+
+static void
+_adg_prepend_dependency(gpointer key, gpointer value, gpointer user_data)
+{
+    GSList **list = user_data;
+    *list = g_slist_prepend(*list, key);
+}
+
+static void
+_adg_store_named_pairs(AdgModel *model, const gchar **names,
+                       const CpmlPair *pairs, guint n_pairs)
+{
+    AdgModelPrivate *data;
+    gboolean direct;
+    guint n;
+
+    data = model->data;
+
+    /* Skip the signal emission when nobody could notice it */
+    direct = ADG_MODEL_GET_CLASS(model)->set_named_pair == _adg_set_named_pair &&
+             ! g_signal_has_handler_pending(model, _adg_signals[SET_NAMED_PAIR],
+                                            0, FALSE);
+
+    if (direct && data->named_pairs == NULL) {
+        data->named_pairs = g_array_sized_new(FALSE, FALSE,
+                                              sizeof(AdgModelSlot), n_pairs);
+        data->slots = g_hash_table_new(NULL, NULL);
+    }
+
+    for (n = 0; n < n_pairs; ++n) {
+        if (names[n] == NULL)
+            continue;
+
+        if (direct)
+            _adg_set_named_pair(model, names[n], &pairs[n]);
+        else
+            g_signal_emit(model, _adg_signals[SET_NAMED_PAIR], 0,
+                          names[n], &pairs[n]);
+    }
 }
 
 static void
-_adg_named_pair_wrapper(gpointer key, gpointer value, gpointer user_data)
+_adg_commit_named_pairs(AdgModelPrivate *data)
+{
+    AdgModelSlot *slot;
+    guint n;
+
+    if (data->named_pairs == NULL)
+        return;
+
+    for (n = 0; n < data->named_pairs->len; ++ n) {
+        slot = &g_array_index(data->named_pairs, AdgModelSlot, n);
+        slot->was_defined = slot->is_defined;
+        slot->old_pair = slot->pair;
+    }
+}
+
+static gboolean
+_adg_is_affected(AdgModelPrivate *data, AdgEntity *entity)
 {
-    const gchar *name;
-    CpmlPair *pair;
-    AdgWrapperHelper *helper;
+    GArray *names;
+    AdgModelSlot *slot;
+    GQuark quark;
+    guint count, n, index;
 
-    name = key;
-    pair = value;
-    helper = user_data;
+    names = g_hash_table_lookup(data->named_dependencies, entity);
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(data->dependencies, entity));
 
-    helper->callback(helper->model, name, pair, helper->user_data);
+    /* Entities with at least one unnamed dependency are always affected */
+    if (names == NULL || names->len < count)
+        return TRUE;
+
+    if (data->named_pairs == NULL)
+        return FALSE;
+
+    for (n = 0; n < names->len; ++ n) {
+        quark = g_array_index(names, GQuark, n);
+        index = GPOINTER_TO_UINT(g_hash_table_lookup(data->slots,
+                                                     GUINT_TO_POINTER(quark)));
+
+        /* Named pairs never defined cannot have been changed */
+        if (index == 0)
+            continue;
+
+        slot = &g_array_index(data->named_pairs, AdgModelSlot, index - 1);
+        if (slot->is_defined != slot->was_defined)
+            return TRUE;
+        if (slot->is_defined && ! cpml_pair_equal(&slot->pair, &slot->old_pair))
+            return TRUE;
+    }
+
+    return FALSE;
 }
 
 static void
-_adg_invalidate_wrapper(AdgModel *model, AdgEntity *entity, gpointer user_data)
+_adg_free_names(gpointer names)
 {
-    adg_entity_invalidate(entity);
+    g_array_free(names, TRUE);
 }
@@ -61,6 +61,7 @@ struct _AdgModelClass {
     /* Virtual table */
     const CpmlPair *    (*named_pair)           (AdgModel         *model,
                                                  const gchar      *name);
+    void                (*freeze)               (AdgModel         *model);
 
     /* Signals */
     void                (*set_named_pair)       (AdgModel         *model,
@@ -82,6 +83,13 @@ void            adg_model_add_dependency        (AdgModel         *model,
                                                  AdgEntity        *entity);
 void            adg_model_remove_dependency     (AdgModel         *model,
                                                  AdgEntity        *entity);
+void            adg_model_add_named_dependency  (AdgModel         *model,
+                                                 AdgEntity        *entity,
+                                                 const gchar      *name);
+void            adg_model_remove_named_dependency
+                                                (AdgModel         *model,
+                                                 AdgEntity        *entity,
+                                                 const gchar      *name);
 const GSList *  adg_model_get_dependencies      (AdgModel         *model);
 void            adg_model_foreach_dependency    (AdgModel         *model,
                                                  AdgDependencyFunc callback,
@@ -94,14 +102,34 @@ void            adg_model_set_named_pair_explicit
                                                  const gchar      *name,
                                                  gdouble           x,
                                                  gdouble           y);
+void            adg_model_set_named_pairs       (AdgModel         *model,
+                                                 const gchar     **names,
+                                                 guint             n_names,
+                                                 const gdouble    *coords,
+                                                 guint             n_coords);
+void            adg_model_import_named_pairs    (AdgModel         *model,
+                                                 const gchar     **names,
+                                                 const CpmlPair   *pairs,
+                                                 guint             n_pairs);
+guint           adg_model_export_named_pairs    (AdgModel         *model,
+                                                 const gchar    ***names,
+                                                 CpmlPair        **pairs);
 const CpmlPair *adg_model_get_named_pair        (AdgModel         *model,
                                                  const gchar      *name);
+const CpmlPair *adg_model_get_named_pair_by_quark
+                                                (AdgModel         *model,
+                                                 GQuark            name,
+                                                 guint            *slot);
 void            adg_model_foreach_named_pair    (AdgModel         *model,
                                                  AdgNamedPairFunc  callback,
                                                  gpointer          user_data);
 void            adg_model_clear                 (AdgModel         *model);
 void            adg_model_reset                 (AdgModel         *model);
 void            adg_model_changed               (AdgModel         *model);
+void            adg_model_freeze_changes        (void);
+void            adg_model_thaw_changes          (void);
+void            adg_model_freeze                (AdgModel         *model);
+gboolean        adg_model_is_frozen             (AdgModel         *model);
 
 G_END_DECLS
 
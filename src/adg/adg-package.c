@@ -0,0 +1,1007 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/**
+ * SECTION:adg-package
+ * @Section_Id:AdgPackage
+ * @title: AdgPackage
+ * @short_description: Lazily loaded snapshots of many sheets
+ *
+ * AdgPackage is an opaque structure that gives access to a package,
+ * that is a file storing the snapshots of a set of canvases saved
+ * with adg_package_save(). It is an evolution of the single sheet
+ * snapshot of adg_canvas_save_snapshot() for drawings with a lot of
+ * sheets, where loading everything up front would be too expensive.
+ *
+ * Every sheet of a package is split in sections. A section contains
+ * the render records, serialized as cairo script, of the entities of
+ * the same sheet belonging to the same set of layers (see
+ * adg_entity_set_layer()) and lying in the same tile of a fixed grid
+ * laid over the sheet. The background and the frame of every sheet
+ * are stored in their own section. A table at the end of the file
+ * lists the sections with their layers and their extents.
+ *
+ * adg_package_open() maps the file in memory and checks only the
+ * table, so opening is fast and does not depend on the size of the
+ * package. The sections are decoded only when needed: adg_package_render()
+ * replays only the sections of the requested sheet that are not in
+ * a hidden layer and that overlap the requested region, caching them
+ * for the next calls. adg_package_release() drops the cached sections
+ * of a sheet, e.g. when the viewer switches to another one. The
+ * operating system loads from the disk only the pages of the mapping
+ * that are actually read.
+ *
+ * The painting order is preserved inside a section but not across
+ * sections, so overlapping entities of different layers or tiles
+ * could be composited in a different order than in the original
+ * canvas.
+ *
+ * The data is stored in the layout of the running architecture, so
+ * a package is not portable across platforms with different endianness
+ * or alignment. Like the canvas snapshots, packages need the cairo
+ * script support, enabled at configure time with
+ * <code>--enable-snapshot</code>. An #AdgPackage must not be used
+ * from more threads at once.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgPackage:
+ *
+ * This is an opaque struct: all its fields are privates.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <string.h>
+#include <errno.h>
+#include <glib/gstdio.h>
+#include "adg-entity.h"
+#include "adg-container.h"
+#include "adg-title-block.h"
+#include "adg-canvas.h"
+
+#include "adg-package.h"
+
+#ifdef SNAPSHOT_ENABLED
+#include <cairo-script.h>
+#include <cairo-script-interpreter.h>
+#endif
+
+
+/* Same magic of the single sheet snapshots of AdgCanvas, whose
+ * format is the version 1 */
+#define _ADG_PACKAGE_MAGIC      "ADGS"
+#define _ADG_PACKAGE_VERSION    2
+
+/* Every sheet is split in a grid of _ADG_PACKAGE_GRID x _ADG_PACKAGE_GRID tiles */
+#define _ADG_PACKAGE_GRID       4
+
+
+/* A package is this header followed by the scripts of the sections
+ * and, at table_offset, by the sheets and the sections tables. All
+ * the structs are a multiple of 8 bytes long and table_offset is
+ * aligned to 8 bytes, so the tables can be accessed in place */
+typedef struct {
+    gchar               magic[4];
+    guint32             version;
+    guint32             n_sheets;
+    guint32             n_sections;
+    guint64             table_offset;
+} _AdgPackageHeader;
+
+typedef struct {
+    gdouble             width;
+    gdouble             height;
+    guint32             first_section;
+    guint32             n_sections;
+} _AdgPackageSheet;
+
+/* The extents are in sheet space, i.e. the space of
+ * adg_canvas_export() with a factor of 1 */
+typedef struct {
+    guint64             offset;
+    guint64             size;
+    guint32             layers;
+    guint32             reserved;
+    gdouble             x, y;
+    gdouble             width, height;
+} _AdgPackageSection;
+
+/* Entities of a sheet grouped by layers and tile while saving */
+typedef struct {
+    guint32             layers;
+    guint               tile;
+    GPtrArray          *leaves;
+    CpmlExtents         extents;
+} _AdgPackageGroup;
+
+typedef struct {
+    FILE               *fp;
+    guint64             offset;
+    gboolean            failed;
+    gdouble             left, top;
+    gdouble             width, height;
+    GArray             *groups;
+} _AdgPackageWriter;
+
+struct _AdgPackage {
+    gint                refcount;
+    GMappedFile        *mapped;
+    gchar              *contents;
+    const _AdgPackageSheet *sheets;
+    const _AdgPackageSection *sections;
+    guint               n_sheets;
+    guint               n_sections;
+    cairo_surface_t   **records;
+    guint               n_loaded;
+};
+
+
+#ifdef SNAPSHOT_ENABLED
+static gboolean         _adg_save_sheet         (_AdgPackageWriter *writer,
+                                                 AdgCanvas      *canvas,
+                                                 GArray         *sheets,
+                                                 GArray         *sections,
+                                                 GError        **gerror);
+static void             _adg_walk               (_AdgPackageWriter *writer,
+                                                 AdgEntity      *entity,
+                                                 guint32         layers);
+static void             _adg_add_leaf           (_AdgPackageWriter *writer,
+                                                 AdgEntity      *entity,
+                                                 guint32         layers);
+static gboolean         _adg_write_section      (_AdgPackageWriter *writer,
+                                                 AdgCanvas      *canvas,
+                                                 _AdgPackageGroup *group,
+                                                 _AdgPackageSection *section,
+                                                 GError        **gerror);
+static gboolean         _adg_write              (_AdgPackageWriter *writer,
+                                                 gconstpointer   data,
+                                                 gsize           length);
+static cairo_status_t   _adg_write_func         (gpointer        closure,
+                                                 const guchar   *data,
+                                                 guint           length);
+static cairo_surface_t *_adg_record_surface     (gpointer        closure,
+                                                 cairo_content_t content,
+                                                 gdouble         width,
+                                                 gdouble         height,
+                                                 glong           uid);
+#endif
+static gboolean         _adg_check_package      (const gchar    *contents,
+                                                 gsize           length);
+static cairo_surface_t *_adg_load_section       (AdgPackage     *package,
+                                                 guint           n_section,
+                                                 const _AdgPackageSheet *sheet,
+                                                 GError        **gerror);
+static gboolean         _adg_section_overlaps   (const _AdgPackageSection *section,
+                                                 const CpmlExtents *region);
+static void             _adg_free_contents      (GMappedFile    *mapped,
+                                                 gchar          *contents);
+
+
+GType
+adg_package_get_type(void)
+{
+    static gsize type = 0;
+
+    if (g_once_init_enter(&type)) {
+        GType new_type = g_boxed_type_register_static("AdgPackage",
+                                                      (GBoxedCopyFunc) adg_package_ref,
+                                                      (GBoxedFreeFunc) adg_package_unref);
+        g_once_init_leave(&type, new_type);
+    }
+
+    return type;
+}
+
+/**
+ * adg_package_save:
+ * @n_canvases: number of canvases
+ * @canvases: (array length=n_canvases): the canvases to save, one per sheet
+ * @file: the name of the package file
+ * @gerror: (allow-none): return location for errors
+ *
+ * Arranges and renders every canvas in @canvases and stores the
+ * resulting drawings in @file, one sheet per canvas. See the
+ * #AdgPackage description for details on the format.
+ *
+ * The sections are streamed to @file while they are rendered, so
+ * the memory needed does not depend on the number of sheets. On
+ * errors @file is removed.
+ *
+ * If the snapshot support has not been enabled at configure time,
+ * this function always fails with #ADG_CANVAS_ERROR_SNAPSHOT.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_package_save(guint n_canvases, AdgCanvas **canvases, const gchar *file,
+                 GError **gerror)
+{
+#ifdef SNAPSHOT_ENABLED
+    _AdgPackageWriter writer;
+    _AdgPackageHeader header;
+    GArray *sheets, *sections;
+    guint64 padding;
+    gboolean success;
+    guint n;
+
+    g_return_val_if_fail(n_canvases == 0 || canvases != NULL, FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    for (n = 0; n < n_canvases; ++n)
+        g_return_val_if_fail(ADG_IS_CANVAS(canvases[n]), FALSE);
+
+    memset(&writer, 0, sizeof(writer));
+    writer.fp = g_fopen(file, "wb");
+    if (writer.fp == NULL) {
+        gint saved_errno = errno;
+        g_set_error(gerror, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+                    _("Failed to create '%s': %s"), file,
+                    g_strerror(saved_errno));
+        return FALSE;
+    }
+
+    /* The header is rewritten at the end, when the table is known */
+    memset(&header, 0, sizeof(header));
+    _adg_write(&writer, &header, sizeof(header));
+
+    sheets = g_array_new(FALSE, FALSE, sizeof(_AdgPackageSheet));
+    sections = g_array_new(FALSE, FALSE, sizeof(_AdgPackageSection));
+    success = TRUE;
+
+    for (n = 0; success && n < n_canvases; ++n)
+        success = _adg_save_sheet(&writer, canvases[n], sheets, sections, gerror);
+
+    if (success) {
+        padding = (8 - writer.offset % 8) % 8;
+        memset(&header, 0, sizeof(header));
+        _adg_write(&writer, &header, padding);
+
+        memcpy(header.magic, _ADG_PACKAGE_MAGIC, sizeof(header.magic));
+        header.version = _ADG_PACKAGE_VERSION;
+        header.n_sheets = sheets->len;
+        header.n_sections = sections->len;
+        header.table_offset = writer.offset;
+
+        _adg_write(&writer, sheets->data, sheets->len * sizeof(_AdgPackageSheet));
+        _adg_write(&writer, sections->data,
+                   sections->len * sizeof(_AdgPackageSection));
+
+        if (fseek(writer.fp, 0, SEEK_SET) != 0)
+            writer.failed = TRUE;
+        else
+            _adg_write(&writer, &header, sizeof(header));
+    }
+
+    g_array_free(sheets, TRUE);
+    g_array_free(sections, TRUE);
+
+    if (fclose(writer.fp) != 0)
+        writer.failed = TRUE;
+
+    if (success && writer.failed) {
+        g_set_error(gerror, G_FILE_ERROR, G_FILE_ERROR_IO,
+                    _("Failed to write '%s'"), file);
+        success = FALSE;
+    }
+
+    if (! success)
+        g_remove(file);
+
+    return success;
+#else
+    g_return_val_if_fail(n_canvases == 0 || canvases != NULL, FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+
+    g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                "snapshot support not enabled");
+    return FALSE;
+#endif
+}
+
+/**
+ * adg_package_open:
+ * @file: the name of a file created by adg_package_save()
+ * @gerror: (allow-none): return location for errors
+ *
+ * Opens a package by mapping @file in memory. Only the header and
+ * the tables of the package are checked: no section is decoded until
+ * requested by adg_package_render().
+ *
+ * If the snapshot support has not been enabled at configure time,
+ * this function always fails with #ADG_CANVAS_ERROR_SNAPSHOT.
+ *
+ * Returns: (transfer full): the opened package, to be freed with adg_package_unref(), or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgPackage *
+adg_package_open(const gchar *file, GError **gerror)
+{
+#ifdef SNAPSHOT_ENABLED
+    GMappedFile *mapped;
+    gchar *contents;
+    gsize length;
+    _AdgPackageHeader header;
+    AdgPackage *package;
+
+    g_return_val_if_fail(file != NULL, NULL);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, NULL);
+
+    mapped = g_mapped_file_new(file, FALSE, NULL);
+    if (mapped != NULL) {
+        contents = g_mapped_file_get_contents(mapped);
+        length = g_mapped_file_get_length(mapped);
+    } else if (! g_file_get_contents(file, &contents, &length, gerror)) {
+        return NULL;
+    }
+
+    if (! _adg_check_package(contents, length)) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                    _("Invalid or incompatible package in '%s'"), file);
+        _adg_free_contents(mapped, contents);
+        return NULL;
+    }
+
+    memcpy(&header, contents, sizeof(header));
+
+    package = g_new0(AdgPackage, 1);
+    package->refcount = 1;
+    package->mapped = mapped;
+    package->contents = mapped == NULL ? contents : NULL;
+    package->n_sheets = header.n_sheets;
+    package->n_sections = header.n_sections;
+    package->sheets = (const _AdgPackageSheet *) (contents + header.table_offset);
+    package->sections = (const _AdgPackageSection *) (package->sheets + header.n_sheets);
+    package->records = g_new0(cairo_surface_t *, header.n_sections);
+
+    return package;
+#else
+    g_return_val_if_fail(file != NULL, NULL);
+
+    g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                "snapshot support not enabled");
+    return NULL;
+#endif
+}
+
+/**
+ * adg_package_ref:
+ * @package: an #AdgPackage
+ *
+ * Adds a reference to @package.
+ *
+ * Returns: @package
+ *
+ * Since: 1.0
+ **/
+AdgPackage *
+adg_package_ref(AdgPackage *package)
+{
+    g_return_val_if_fail(package != NULL, NULL);
+
+    g_atomic_int_inc(&package->refcount);
+
+    return package;
+}
+
+/**
+ * adg_package_unref:
+ * @package: an #AdgPackage
+ *
+ * Drops a reference from @package. When the last reference is
+ * dropped, the cached sections are freed and the file is unmapped.
+ *
+ * Since: 1.0
+ **/
+void
+adg_package_unref(AdgPackage *package)
+{
+    guint n;
+
+    g_return_if_fail(package != NULL);
+
+    if (! g_atomic_int_dec_and_test(&package->refcount))
+        return;
+
+    for (n = 0; n < package->n_sheets; ++n)
+        adg_package_release(package, n);
+
+    g_free(package->records);
+    _adg_free_contents(package->mapped, package->contents);
+    g_free(package);
+}
+
+/**
+ * adg_package_get_n_sheets:
+ * @package: an #AdgPackage
+ *
+ * Gets the number of sheets stored in @package.
+ *
+ * Returns: the number of sheets or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_package_get_n_sheets(AdgPackage *package)
+{
+    g_return_val_if_fail(package != NULL, 0);
+
+    return package->n_sheets;
+}
+
+/**
+ * adg_package_put_sheet_size:
+ * @package: an #AdgPackage
+ * @sheet: the sheet to inspect, where 0 is the first sheet
+ * @size: (out): the destination #CpmlPair
+ *
+ * Stores in @size the size of @sheet, that is the size of the
+ * canvas exported with a factor of 1, margins included. If @sheet
+ * is not found, @size is left untouched.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_package_put_sheet_size(AdgPackage *package, guint sheet, CpmlPair *size)
+{
+    g_return_val_if_fail(package != NULL, FALSE);
+    g_return_val_if_fail(size != NULL, FALSE);
+
+    if (sheet >= package->n_sheets)
+        return FALSE;
+
+    size->x = package->sheets[sheet].width;
+    size->y = package->sheets[sheet].height;
+    return TRUE;
+}
+
+/**
+ * adg_package_render:
+ * @package: an #AdgPackage
+ * @sheet: the sheet to render, where 0 is the first sheet
+ * @hidden_layers: the mask of the layers to hide, as in adg_set_hidden_layers()
+ * @region: (allow-none): the region to render, in sheet space
+ * @cr: the destination cairo context
+ * @gerror: (allow-none): return location for errors
+ *
+ * Renders @sheet on @cr, placed as adg_canvas_export() would do with
+ * a factor of 1. Only the sections not belonging to any layer in
+ * @hidden_layers and overlapping @region are decoded and rendered:
+ * the rendering is also clipped to @region. If @region is
+ * <constant>NULL</constant>, the whole sheet is rendered.
+ *
+ * The decoded sections are cached, so rendering again the same
+ * region is cheap.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_package_render(AdgPackage *package, guint sheet, guint32 hidden_layers,
+                   const CpmlExtents *region, cairo_t *cr, GError **gerror)
+{
+    const _AdgPackageSheet *sheet_data;
+    const _AdgPackageSection *section;
+    cairo_surface_t *record;
+    guint n;
+
+    g_return_val_if_fail(package != NULL, FALSE);
+    g_return_val_if_fail(cr != NULL, FALSE);
+    g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
+
+    if (sheet >= package->n_sheets) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                    _("Sheet %u not found in the package"), sheet);
+        return FALSE;
+    }
+
+    if (region != NULL && ! region->is_defined)
+        return TRUE;
+
+    sheet_data = &package->sheets[sheet];
+
+    for (n = sheet_data->first_section;
+         n < sheet_data->first_section + sheet_data->n_sections; ++n) {
+        section = &package->sections[n];
+        if ((section->layers & hidden_layers) != 0 ||
+            (region != NULL && ! _adg_section_overlaps(section, region)))
+            continue;
+
+        record = _adg_load_section(package, n, sheet_data, gerror);
+        if (record == NULL)
+            return FALSE;
+
+        cairo_save(cr);
+        if (region != NULL) {
+            cairo_rectangle(cr, region->org.x, region->org.y,
+                            region->size.x, region->size.y);
+            cairo_clip(cr);
+        }
+        cairo_set_source_surface(cr, record, 0, 0);
+        cairo_paint(cr);
+        cairo_restore(cr);
+    }
+
+    return TRUE;
+}
+
+/**
+ * adg_package_release:
+ * @package: an #AdgPackage
+ * @sheet: the sheet to release, where 0 is the first sheet
+ *
+ * Frees the sections of @sheet decoded by adg_package_render(). They
+ * will be decoded again on demand.
+ *
+ * Since: 1.0
+ **/
+void
+adg_package_release(AdgPackage *package, guint sheet)
+{
+    const _AdgPackageSheet *sheet_data;
+    guint n;
+
+    g_return_if_fail(package != NULL);
+
+    if (sheet >= package->n_sheets)
+        return;
+
+    sheet_data = &package->sheets[sheet];
+
+    for (n = sheet_data->first_section;
+         n < sheet_data->first_section + sheet_data->n_sections; ++n) {
+        if (package->records[n] != NULL) {
+            cairo_surface_destroy(package->records[n]);
+            package->records[n] = NULL;
+            -- package->n_loaded;
+        }
+    }
+}
+
+/**
+ * adg_package_get_n_loaded:
+ * @package: an #AdgPackage
+ *
+ * Gets the number of sections currently decoded and cached by
+ * @package, e.g. to check the memory used by a viewer.
+ *
+ * Returns: the number of cached sections.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_package_get_n_loaded(AdgPackage *package)
+{
+    g_return_val_if_fail(package != NULL, 0);
+
+    return package->n_loaded;
+}
+
+
+#ifdef SNAPSHOT_ENABLED
+
+static gboolean
+_adg_save_sheet(_AdgPackageWriter *writer, AdgCanvas *canvas,
+                GArray *sheets, GArray *sections, GError **gerror)
+{
+    AdgEntity *entity;
+    AdgTitleBlock *title_block;
+    const CpmlExtents *extents;
+    gdouble top, right, bottom, left;
+    _AdgPackageSheet sheet;
+    _AdgPackageSection section;
+    _AdgPackageGroup *group;
+    guint32 layers;
+    GSList *children;
+    gboolean success;
+    guint n;
+
+    entity = (AdgEntity *) canvas;
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    adg_canvas_get_margins(canvas, &top, &right, &bottom, &left);
+
+    /* Same placement used by adg_canvas_save_snapshot() */
+    writer->left = left;
+    writer->top = top;
+    writer->width = extents->size.x + left + right;
+    writer->height = extents->size.y + top + bottom;
+    writer->groups = g_array_new(FALSE, FALSE, sizeof(_AdgPackageGroup));
+
+    /* The first group, without leaves, is the backdrop. Hiding the
+     * layer of the canvas hides everything, so it is in every mask */
+    layers = 1u << adg_entity_get_layer(entity);
+    g_array_set_size(writer->groups, 1);
+    group = &g_array_index(writer->groups, _AdgPackageGroup, 0);
+    group->layers = layers;
+    group->tile = 0;
+    group->leaves = NULL;
+    group->extents.is_defined = FALSE;
+
+    /* Keep the same order used by the canvas rendering */
+    title_block = adg_canvas_get_title_block(canvas);
+    if (title_block != NULL)
+        _adg_walk(writer, (AdgEntity *) title_block, layers);
+
+    children = adg_container_children((AdgContainer *) canvas);
+    while (children != NULL) {
+        if (children->data != NULL)
+            _adg_walk(writer, children->data, layers);
+        children = g_slist_delete_link(children, children);
+    }
+
+    sheet.width = writer->width;
+    sheet.height = writer->height;
+    sheet.first_section = sections->len;
+    sheet.n_sections = writer->groups->len;
+
+    success = TRUE;
+    for (n = 0; n < writer->groups->len; ++n) {
+        group = &g_array_index(writer->groups, _AdgPackageGroup, n);
+        if (success) {
+            success = _adg_write_section(writer, canvas, group, &section, gerror);
+            g_array_append_val(sections, section);
+        }
+        if (group->leaves != NULL) {
+            g_ptr_array_foreach(group->leaves, (GFunc) g_object_unref, NULL);
+            g_ptr_array_free(group->leaves, TRUE);
+        }
+    }
+
+    g_array_free(writer->groups, TRUE);
+    writer->groups = NULL;
+
+    g_array_append_val(sheets, sheet);
+    return success;
+}
+
+/* @layers is the mask of the layers of the ancestors of @entity:
+ * hiding any of them hides @entity too */
+static void
+_adg_walk(_AdgPackageWriter *writer, AdgEntity *entity, guint32 layers)
+{
+    AdgEntityClass *container_class;
+    AdgEntityClass *klass;
+
+    if (! adg_entity_is_visible(entity))
+        return;
+
+    container_class = g_type_class_peek(ADG_TYPE_CONTAINER);
+    klass = ADG_ENTITY_GET_CLASS(entity);
+    layers |= 1u << adg_entity_get_layer(entity);
+
+    /* Flatten only plain containers: any subclass overriding the
+     * render() method (e.g. AdgAlignment) is rendered as a whole */
+    if (ADG_IS_CONTAINER(entity) && klass->render == container_class->render) {
+        GSList *children = adg_container_children((AdgContainer *) entity);
+
+        while (children != NULL) {
+            if (children->data != NULL)
+                _adg_walk(writer, children->data, layers);
+            children = g_slist_delete_link(children, children);
+        }
+    } else if (klass->render != NULL) {
+        _adg_add_leaf(writer, entity, layers);
+    }
+}
+
+static void
+_adg_add_leaf(_AdgPackageWriter *writer, AdgEntity *entity, guint32 layers)
+{
+    const CpmlExtents *extents;
+    CpmlExtents sheet_extents;
+    _AdgPackageGroup *group, new_group;
+    gint x, y;
+    guint tile, n;
+
+    /* Place the entity in the tile containing the center of its
+     * extents, expressed in sheet space */
+    extents = adg_entity_get_extents(entity);
+    sheet_extents.is_defined = FALSE;
+    tile = 0;
+    if (extents->is_defined) {
+        cpml_extents_copy(&sheet_extents, extents);
+        sheet_extents.org.x += writer->left;
+        sheet_extents.org.y += writer->top;
+
+        x = (sheet_extents.org.x + sheet_extents.size.x / 2) *
+            _ADG_PACKAGE_GRID / writer->width;
+        y = (sheet_extents.org.y + sheet_extents.size.y / 2) *
+            _ADG_PACKAGE_GRID / writer->height;
+        x = CLAMP(x, 0, _ADG_PACKAGE_GRID - 1);
+        y = CLAMP(y, 0, _ADG_PACKAGE_GRID - 1);
+        tile = y * _ADG_PACKAGE_GRID + x;
+    }
+
+    /* The backdrop (group 0) is skipped */
+    group = NULL;
+    for (n = 1; n < writer->groups->len; ++n) {
+        group = &g_array_index(writer->groups, _AdgPackageGroup, n);
+        if (group->layers == layers && group->tile == tile)
+            break;
+        group = NULL;
+    }
+
+    if (group == NULL) {
+        new_group.layers = layers;
+        new_group.tile = tile;
+        new_group.leaves = g_ptr_array_new();
+        new_group.extents.is_defined = FALSE;
+        g_array_append_val(writer->groups, new_group);
+        group = &g_array_index(writer->groups, _AdgPackageGroup,
+                               writer->groups->len - 1);
+    }
+
+    g_ptr_array_add(group->leaves, g_object_ref(entity));
+
+    /* Leaves without extents make the whole sheet their extents */
+    if (! sheet_extents.is_defined) {
+        sheet_extents.is_defined = TRUE;
+        sheet_extents.org.x = 0;
+        sheet_extents.org.y = 0;
+        sheet_extents.size.x = writer->width;
+        sheet_extents.size.y = writer->height;
+    }
+    cpml_extents_add(&group->extents, &sheet_extents);
+}
+
+static gboolean
+_adg_write_section(_AdgPackageWriter *writer, AdgCanvas *canvas,
+                   _AdgPackageGroup *group, _AdgPackageSection *section,
+                   GError **gerror)
+{
+    cairo_rectangle_t rect;
+    cairo_surface_t *recording;
+    cairo_device_t *script;
+    cairo_status_t status;
+    cairo_t *cr;
+    guint n;
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.width = writer->width;
+    rect.height = writer->height;
+
+    recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &rect);
+    cairo_surface_set_device_offset(recording, writer->left, writer->top);
+    cr = cairo_create(recording);
+
+    if (group->leaves == NULL) {
+        adg_canvas_render_backdrop(canvas, cr);
+    } else {
+        for (n = 0; n < group->leaves->len; ++n)
+            adg_entity_render(g_ptr_array_index(group->leaves, n), cr);
+    }
+
+    cairo_destroy(cr);
+
+    memset(section, 0, sizeof(*section));
+    section->offset = writer->offset;
+    section->layers = group->layers;
+
+    if (group->leaves == NULL || ! group->extents.is_defined) {
+        section->width = rect.width;
+        section->height = rect.height;
+    } else {
+        section->x = group->extents.org.x;
+        section->y = group->extents.org.y;
+        section->width = group->extents.size.x;
+        section->height = group->extents.size.y;
+    }
+
+    script = cairo_script_create_for_stream(_adg_write_func, writer);
+    status = cairo_script_from_recording_surface(script, recording);
+    cairo_device_finish(script);
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = cairo_device_status(script);
+    cairo_device_destroy(script);
+    cairo_surface_destroy(recording);
+
+    section->size = writer->offset - section->offset;
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Write errors are sticky: they are checked once at the end */
+static gboolean
+_adg_write(_AdgPackageWriter *writer, gconstpointer data, gsize length)
+{
+    if (writer->failed)
+        return FALSE;
+
+    if (length > 0 && fwrite(data, length, 1, writer->fp) != 1) {
+        writer->failed = TRUE;
+        return FALSE;
+    }
+
+    writer->offset += length;
+    return TRUE;
+}
+
+static cairo_status_t
+_adg_write_func(gpointer closure, const guchar *data, guint length)
+{
+    return _adg_write(closure, data, length) ?
+        CAIRO_STATUS_SUCCESS : CAIRO_STATUS_WRITE_ERROR;
+}
+
+static cairo_surface_t *
+_adg_record_surface(gpointer closure, cairo_content_t content,
+                    gdouble width, gdouble height, glong uid)
+{
+    return cairo_surface_reference((cairo_surface_t *) closure);
+}
+
+#endif
+
+static gboolean
+_adg_check_package(const gchar *contents, gsize length)
+{
+    _AdgPackageHeader header;
+    const _AdgPackageSheet *sheets;
+    const _AdgPackageSection *sections;
+    guint64 table_size;
+    guint n;
+
+    if (length < sizeof(header))
+        return FALSE;
+
+    memcpy(&header, contents, sizeof(header));
+
+    if (memcmp(header.magic, _ADG_PACKAGE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != _ADG_PACKAGE_VERSION ||
+        header.table_offset % 8 != 0 ||
+        header.table_offset < sizeof(header) ||
+        header.table_offset > length)
+        return FALSE;
+
+    table_size = (guint64) header.n_sheets * sizeof(_AdgPackageSheet) +
+                 (guint64) header.n_sections * sizeof(_AdgPackageSection);
+    if (table_size != length - header.table_offset)
+        return FALSE;
+
+    sheets = (const _AdgPackageSheet *) (contents + header.table_offset);
+    sections = (const _AdgPackageSection *) (sheets + header.n_sheets);
+
+    /* The sheets must partition the sections in order */
+    for (n = 0; n < header.n_sheets; ++n) {
+        if (sheets[n].width <= 0 || sheets[n].height <= 0 ||
+            sheets[n].first_section > header.n_sections ||
+            sheets[n].n_sections > header.n_sections - sheets[n].first_section)
+            return FALSE;
+    }
+
+    for (n = 0; n < header.n_sections; ++n) {
+        if (sections[n].offset < sizeof(header) ||
+            sections[n].offset > header.table_offset ||
+            sections[n].size > header.table_offset - sections[n].offset)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static cairo_surface_t *
+_adg_load_section(AdgPackage *package, guint n_section,
+                  const _AdgPackageSheet *sheet, GError **gerror)
+{
+#ifdef SNAPSHOT_ENABLED
+    const _AdgPackageSection *section;
+    const gchar *contents;
+    cairo_rectangle_t rect;
+    cairo_surface_t *recording;
+    cairo_script_interpreter_t *csi;
+    cairo_script_interpreter_hooks_t hooks;
+    cairo_status_t status;
+
+    /* Check for cached result */
+    if (package->records[n_section] != NULL)
+        return package->records[n_section];
+
+    section = &package->sections[n_section];
+    contents = package->mapped != NULL ?
+        g_mapped_file_get_contents(package->mapped) : package->contents;
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.width = sheet->width;
+    rect.height = sheet->height;
+    recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &rect);
+
+    /* The script draws on the surface returned by the hook */
+    memset(&hooks, 0, sizeof(hooks));
+    hooks.closure = recording;
+    hooks.surface_create = _adg_record_surface;
+
+    /* Only the pages of this section are faulted in */
+    csi = cairo_script_interpreter_create();
+    cairo_script_interpreter_install_hooks(csi, &hooks);
+    cairo_script_interpreter_feed_string(csi, contents + section->offset,
+                                         section->size);
+    status = cairo_script_interpreter_finish(csi);
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = cairo_script_interpreter_destroy(csi);
+    else
+        cairo_script_interpreter_destroy(csi);
+
+    if (status == CAIRO_STATUS_SUCCESS)
+        status = cairo_surface_status(recording);
+
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
+                    "cairo reported '%s'",
+                    cairo_status_to_string(status));
+        cairo_surface_destroy(recording);
+        return NULL;
+    }
+
+    package->records[n_section] = recording;
+    ++ package->n_loaded;
+    return recording;
+#else
+    /* A package cannot be opened without snapshot support */
+    g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT,
+                "snapshot support not enabled");
+    return NULL;
+#endif
+}
+
+static gboolean
+_adg_section_overlaps(const _AdgPackageSection *section,
+                      const CpmlExtents *region)
+{
+    return section->x <= region->org.x + region->size.x &&
+           section->x + section->width >= region->org.x &&
+           section->y <= region->org.y + region->size.y &&
+           section->y + section->height >= region->org.y;
+}
+
+static void
+_adg_free_contents(GMappedFile *mapped, gchar *contents)
+{
+    if (mapped == NULL) {
+        g_free(contents);
+    } else {
+#if GLIB_CHECK_VERSION(2, 22, 0)
+        g_mapped_file_unref(mapped);
+#else
+        g_mapped_file_free(mapped);
+#endif
+    }
+}
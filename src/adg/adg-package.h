@@ -0,0 +1,65 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_PACKAGE_H__
+#define __ADG_PACKAGE_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_PACKAGE                        (adg_package_get_type())
+
+typedef struct _AdgPackage AdgPackage;
+
+
+GType           adg_package_get_type            (void);
+
+gboolean        adg_package_save                (guint           n_canvases,
+                                                 AdgCanvas     **canvases,
+                                                 const gchar    *file,
+                                                 GError        **gerror);
+AdgPackage *    adg_package_open                (const gchar    *file,
+                                                 GError        **gerror);
+AdgPackage *    adg_package_ref                 (AdgPackage     *package);
+void            adg_package_unref               (AdgPackage     *package);
+guint           adg_package_get_n_sheets        (AdgPackage     *package);
+gboolean        adg_package_put_sheet_size      (AdgPackage     *package,
+                                                 guint           sheet,
+                                                 CpmlPair       *size);
+gboolean        adg_package_render              (AdgPackage     *package,
+                                                 guint           sheet,
+                                                 guint32         hidden_layers,
+                                                 const CpmlExtents *region,
+                                                 cairo_t        *cr,
+                                                 GError        **gerror);
+void            adg_package_release             (AdgPackage     *package,
+                                                 guint           sheet);
+guint           adg_package_get_n_loaded        (AdgPackage     *package);
+
+G_END_DECLS
+
+
+#endif /* __ADG_PACKAGE_H__ */
@@ -0,0 +1,646 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-param-plan
+ * @Section_Id:AdgParamPlan
+ * @title: AdgParamPlan
+ * @short_description: Parametric update of existing models
+ *
+ * AdgParamPlan is an opaque structure that binds a set of named
+ * parameters (e.g. the diameters and lengths of a part) to the
+ * geometry that depends on them, that is named pairs of any #AdgModel
+ * and points of #AdgPath primitives. When a parameter changes, the
+ * plan patches the bound coordinates in place instead of rebuilding
+ * the models from scratch.
+ *
+ * Every coordinate is considered a linear function of the parameters:
+ * each link registered with adg_param_plan_link_named_pair() or
+ * adg_param_plan_link_point() tells how much a point moves (@dx, @dy)
+ * when its parameter is increased by one. Links to the same point
+ * are summed up, e.g. a point at <constant>(A - B, D / 2)</constant>
+ * needs three links: <constant>A (1, 0)</constant>,
+ * <constant>B (-1, 0)</constant> and <constant>D (0, 0.5)</constant>.
+ *
+ * The models must be built before compiling the plan with
+ * adg_param_plan_compile(): the current coordinates are taken as the
+ * reference for the current values of the parameters and every
+ * parameter gets the list of points depending on it. Any subsequent
+ * adg_param_plan_update() touches only the points depending on the
+ * changed parameters and emits #AdgModel::changed only once and only
+ * on the models really affected.
+ *
+ * Points that do not depend linearly on the parameters, such as the
+ * ones generated by adg_path_chamfer() and adg_path_fillet(), are not
+ * tracked: the models containing them must still be rebuilt.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgParamPlan:
+ *
+ * This is an opaque struct: all its fields are privates.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <string.h>
+
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-path.h"
+
+#include "adg-param-plan.h"
+
+
+typedef struct _AdgPlanParam  AdgPlanParam;
+typedef struct _AdgPlanTerm   AdgPlanTerm;
+typedef struct _AdgPlanTarget AdgPlanTarget;
+
+struct _AdgPlanParam {
+    gchar       *name;
+    gdouble      value;
+    /* The value reflected by the geometry, i.e. the one used by the
+     * last compile or update */
+    gdouble      applied;
+    /* Indexes of the targets depending on this parameter */
+    GArray      *targets;
+};
+
+struct _AdgPlanTerm {
+    guint        param;
+    gdouble      dx, dy;
+};
+
+struct _AdgPlanTarget {
+    AdgModel    *model;
+    /* The named pair or NULL for a point of an AdgPath primitive */
+    gchar       *name;
+    guint        n_primitive;
+    gint         n_point;
+    GArray      *terms;
+    CpmlPair     base;
+    gboolean     is_resolved;
+    gboolean     is_dirty;
+};
+
+struct _AdgParamPlan {
+    GArray      *params;
+    GArray      *targets;
+    gboolean     is_compiled;
+};
+
+
+static gint             _adg_find_param         (AdgParamPlan    *plan,
+                                                 const gchar     *name);
+static void             _adg_link               (AdgParamPlan    *plan,
+                                                 AdgModel        *model,
+                                                 const gchar     *pair_name,
+                                                 guint            n_primitive,
+                                                 gint             n_point,
+                                                 const gchar     *param,
+                                                 gdouble          dx,
+                                                 gdouble          dy);
+static gboolean         _adg_get_target         (AdgPlanTarget   *target,
+                                                 CpmlPair        *pair);
+static void             _adg_set_target         (AdgPlanTarget   *target,
+                                                 const CpmlPair  *pair);
+
+
+GType
+adg_param_plan_get_type(void)
+{
+    static gsize type = 0;
+
+    if (g_once_init_enter(&type)) {
+        GType new_type = g_boxed_type_register_static("AdgParamPlan",
+                                                      (GBoxedCopyFunc) adg_param_plan_dup,
+                                                      (GBoxedFreeFunc) adg_param_plan_destroy);
+        g_once_init_leave(&type, new_type);
+    }
+
+    return type;
+}
+
+/**
+ * adg_param_plan_new:
+ *
+ * Creates a new empty #AdgParamPlan. The returned pointer
+ * should be freed with adg_param_plan_destroy() when no longer
+ * needed.
+ *
+ * Returns: a newly created #AdgParamPlan
+ *
+ * Since: 1.0
+ **/
+AdgParamPlan *
+adg_param_plan_new(void)
+{
+    AdgParamPlan *plan = g_new0(AdgParamPlan, 1);
+
+    plan->params = g_array_new(FALSE, FALSE, sizeof(AdgPlanParam));
+    plan->targets = g_array_new(FALSE, FALSE, sizeof(AdgPlanTarget));
+
+    return plan;
+}
+
+/**
+ * adg_param_plan_dup:
+ * @src: an #AdgParamPlan
+ *
+ * Duplicates @src. The bound models are shared, not copied. The
+ * returned value should be freed with adg_param_plan_destroy() when
+ * no longer needed.
+ *
+ * Returns: the duplicated #AdgParamPlan struct or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgParamPlan *
+adg_param_plan_dup(const AdgParamPlan *src)
+{
+    AdgParamPlan *plan;
+    AdgPlanParam *param;
+    AdgPlanTarget *target;
+    GArray *array;
+    guint n;
+
+    g_return_val_if_fail(src != NULL, NULL);
+
+    plan = g_memdup(src, sizeof(AdgParamPlan));
+    plan->params = g_array_sized_new(FALSE, FALSE, sizeof(AdgPlanParam),
+                                     src->params->len);
+    g_array_append_vals(plan->params, src->params->data, src->params->len);
+    plan->targets = g_array_sized_new(FALSE, FALSE, sizeof(AdgPlanTarget),
+                                      src->targets->len);
+    g_array_append_vals(plan->targets, src->targets->data, src->targets->len);
+
+    for (n = 0; n < plan->params->len; ++n) {
+        param = &g_array_index(plan->params, AdgPlanParam, n);
+        array = param->targets;
+        param->name = g_strdup(param->name);
+        param->targets = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+                                           array->len);
+        g_array_append_vals(param->targets, array->data, array->len);
+    }
+
+    for (n = 0; n < plan->targets->len; ++n) {
+        target = &g_array_index(plan->targets, AdgPlanTarget, n);
+        array = target->terms;
+        g_object_ref(target->model);
+        target->name = g_strdup(target->name);
+        target->terms = g_array_sized_new(FALSE, FALSE, sizeof(AdgPlanTerm),
+                                          array->len);
+        g_array_append_vals(target->terms, array->data, array->len);
+    }
+
+    return plan;
+}
+
+/**
+ * adg_param_plan_destroy:
+ * @plan: an #AdgParamPlan
+ *
+ * Destroys @plan. The bound models are left as they are.
+ *
+ * Since: 1.0
+ **/
+void
+adg_param_plan_destroy(AdgParamPlan *plan)
+{
+    AdgPlanParam *param;
+    AdgPlanTarget *target;
+    guint n;
+
+    g_return_if_fail(plan != NULL);
+
+    for (n = 0; n < plan->params->len; ++n) {
+        param = &g_array_index(plan->params, AdgPlanParam, n);
+        g_free(param->name);
+        g_array_free(param->targets, TRUE);
+    }
+
+    for (n = 0; n < plan->targets->len; ++n) {
+        target = &g_array_index(plan->targets, AdgPlanTarget, n);
+        g_object_unref(target->model);
+        g_free(target->name);
+        g_array_free(target->terms, TRUE);
+    }
+
+    g_array_free(plan->params, TRUE);
+    g_array_free(plan->targets, TRUE);
+    g_free(plan);
+}
+
+/**
+ * adg_param_plan_add_param:
+ * @plan:  an #AdgParamPlan
+ * @name:  the name of the new parameter
+ * @value: the value the current geometry has been built with
+ *
+ * Adds a new parameter to @plan. If a parameter with the same @name
+ * already exists, a warning is raised and @plan is left untouched.
+ *
+ * Since: 1.0
+ **/
+void
+adg_param_plan_add_param(AdgParamPlan *plan, const gchar *name,
+                         gdouble value)
+{
+    AdgPlanParam param;
+
+    g_return_if_fail(plan != NULL);
+    g_return_if_fail(name != NULL);
+
+    if (_adg_find_param(plan, name) >= 0) {
+        g_warning(_("%s: parameter '%s' already defined"), G_STRLOC, name);
+        return;
+    }
+
+    param.name = g_strdup(name);
+    param.value = value;
+    param.applied = value;
+    param.targets = g_array_new(FALSE, FALSE, sizeof(guint));
+    g_array_append_val(plan->params, param);
+}
+
+/**
+ * adg_param_plan_set_param:
+ * @plan:  an #AdgParamPlan
+ * @name:  the name of an existing parameter
+ * @value: the new value
+ *
+ * Changes the value of a parameter. The geometry is not modified
+ * until the next call to adg_param_plan_update(), so many parameters
+ * can be changed in a row with a single update.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> if @name is not a parameter of @plan or on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_param_plan_set_param(AdgParamPlan *plan, const gchar *name,
+                         gdouble value)
+{
+    gint n;
+
+    g_return_val_if_fail(plan != NULL, FALSE);
+    g_return_val_if_fail(name != NULL, FALSE);
+
+    n = _adg_find_param(plan, name);
+    if (n < 0)
+        return FALSE;
+
+    g_array_index(plan->params, AdgPlanParam, n).value = value;
+    return TRUE;
+}
+
+/**
+ * adg_param_plan_get_param:
+ * @plan: an #AdgParamPlan
+ * @name: the name of an existing parameter
+ *
+ * Gets the value of a parameter, as set by adg_param_plan_add_param()
+ * or adg_param_plan_set_param().
+ *
+ * Returns: the value of the parameter or 0 if @name is not a parameter of @plan or on errors.
+ *
+ * Since: 1.0
+ **/
+gdouble
+adg_param_plan_get_param(AdgParamPlan *plan, const gchar *name)
+{
+    gint n;
+
+    g_return_val_if_fail(plan != NULL, 0);
+    g_return_val_if_fail(name != NULL, 0);
+
+    n = _adg_find_param(plan, name);
+    if (n < 0)
+        return 0;
+
+    return g_array_index(plan->params, AdgPlanParam, n).value;
+}
+
+/**
+ * adg_param_plan_link_named_pair:
+ * @plan:      an #AdgParamPlan
+ * @model:     an #AdgModel
+ * @pair_name: the name of a named pair of @model
+ * @param:     the name of an existing parameter
+ * @dx:        the x displacement of the pair per unit of @param
+ * @dy:        the y displacement of the pair per unit of @param
+ *
+ * Makes the @pair_name named pair of @model depend on @param. The
+ * named pair must exist when the plan is compiled and it is updated
+ * with adg_model_set_named_pair().
+ *
+ * Since: 1.0
+ **/
+void
+adg_param_plan_link_named_pair(AdgParamPlan *plan, AdgModel *model,
+                               const gchar *pair_name, const gchar *param,
+                               gdouble dx, gdouble dy)
+{
+    g_return_if_fail(plan != NULL);
+    g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(pair_name != NULL);
+    g_return_if_fail(param != NULL);
+
+    _adg_link(plan, model, pair_name, 0, 0, param, dx, dy);
+}
+
+/**
+ * adg_param_plan_link_point:
+ * @plan:        an #AdgParamPlan
+ * @path:        an #AdgPath
+ * @n_primitive: the index of a primitive of @path
+ * @n_point:     the index of a point of the primitive
+ * @param:       the name of an existing parameter
+ * @dx:          the x displacement of the point per unit of @param
+ * @dy:          the y displacement of the point per unit of @param
+ *
+ * Makes a point of @path depend on @param. The point is addressed
+ * as in adg_path_set_point(): use adg_path_get_n_primitives() while
+ * building @path to know the index of a primitive.
+ *
+ * Since: 1.0
+ **/
+void
+adg_param_plan_link_point(AdgParamPlan *plan, AdgPath *path,
+                          guint n_primitive, gint n_point,
+                          const gchar *param, gdouble dx, gdouble dy)
+{
+    g_return_if_fail(plan != NULL);
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_return_if_fail(param != NULL);
+
+    _adg_link(plan, (AdgModel *) path, NULL, n_primitive, n_point,
+              param, dx, dy);
+}
+
+/**
+ * adg_param_plan_compile:
+ * @plan: an #AdgParamPlan
+ *
+ * Resolves the links of @plan against the current geometry of the
+ * bound models and builds the dependency list of every parameter.
+ * This is implicitly called by adg_param_plan_update() when new
+ * links have been added, so an explicit call is needed only to
+ * check the links in advance.
+ *
+ * Links to named pairs or points not found are discarded with a
+ * warning.
+ *
+ * Returns: <constant>TRUE</constant> if every link has been resolved, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_param_plan_compile(AdgParamPlan *plan)
+{
+    AdgPlanParam *param;
+    AdgPlanTarget *target;
+    const AdgPlanTerm *term;
+    CpmlPair pair;
+    gboolean result;
+    guint n, n_term;
+
+    g_return_val_if_fail(plan != NULL, FALSE);
+
+    result = TRUE;
+
+    for (n = 0; n < plan->params->len; ++n) {
+        param = &g_array_index(plan->params, AdgPlanParam, n);
+        g_array_set_size(param->targets, 0);
+    }
+
+    for (n = 0; n < plan->targets->len; ++n) {
+        target = &g_array_index(plan->targets, AdgPlanTarget, n);
+        target->is_dirty = FALSE;
+        target->is_resolved = _adg_get_target(target, &pair);
+
+        if (! target->is_resolved) {
+            if (target->name != NULL)
+                g_warning(_("%s: named pair '%s' not found"),
+                          G_STRLOC, target->name);
+            else
+                g_warning(_("%s: point %d of primitive %u not found"),
+                          G_STRLOC, target->n_point, target->n_primitive);
+            result = FALSE;
+            continue;
+        }
+
+        /* The base is the position the point would have with all
+         * its parameters set to 0 */
+        for (n_term = 0; n_term < target->terms->len; ++n_term) {
+            term = &g_array_index(target->terms, AdgPlanTerm, n_term);
+            param = &g_array_index(plan->params, AdgPlanParam, term->param);
+            pair.x -= term->dx * param->applied;
+            pair.y -= term->dy * param->applied;
+            g_array_append_val(param->targets, n);
+        }
+        target->base = pair;
+    }
+
+    plan->is_compiled = TRUE;
+    return result;
+}
+
+/**
+ * adg_param_plan_update:
+ * @plan: an #AdgParamPlan
+ *
+ * Moves the points depending on the parameters changed since the
+ * last update and emits #AdgModel::changed on the affected models.
+ * Models not depending on the changed parameters are not touched.
+ *
+ * Returns: the number of models changed.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_param_plan_update(AdgParamPlan *plan)
+{
+    AdgPlanParam *param;
+    AdgPlanTarget *target;
+    const AdgPlanTerm *term;
+    GPtrArray *models;
+    CpmlPair pair;
+    guint n, n_item, n_changed;
+
+    g_return_val_if_fail(plan != NULL, 0);
+
+    if (! plan->is_compiled)
+        adg_param_plan_compile(plan);
+
+    /* Mark only the targets depending on the changed parameters */
+    for (n = 0; n < plan->params->len; ++n) {
+        param = &g_array_index(plan->params, AdgPlanParam, n);
+        if (param->value == param->applied)
+            continue;
+
+        for (n_item = 0; n_item < param->targets->len; ++n_item) {
+            target = &g_array_index(plan->targets, AdgPlanTarget,
+                                    g_array_index(param->targets, guint, n_item));
+            target->is_dirty = TRUE;
+        }
+        param->applied = param->value;
+    }
+
+    models = g_ptr_array_new();
+
+    for (n = 0; n < plan->targets->len; ++n) {
+        target = &g_array_index(plan->targets, AdgPlanTarget, n);
+        if (! target->is_dirty)
+            continue;
+
+        pair = target->base;
+        for (n_item = 0; n_item < target->terms->len; ++n_item) {
+            term = &g_array_index(target->terms, AdgPlanTerm, n_item);
+            param = &g_array_index(plan->params, AdgPlanParam, term->param);
+            pair.x += term->dx * param->value;
+            pair.y += term->dy * param->value;
+        }
+
+        _adg_set_target(target, &pair);
+        target->is_dirty = FALSE;
+
+        /* Targets of the same model are usually contiguous */
+        if (models->len == 0 ||
+            g_ptr_array_index(models, models->len - 1) != target->model) {
+            for (n_item = 0; n_item < models->len; ++n_item)
+                if (g_ptr_array_index(models, n_item) == target->model)
+                    break;
+            if (n_item == models->len)
+                g_ptr_array_add(models, target->model);
+        }
+    }
+
+    for (n = 0; n < models->len; ++n)
+        adg_model_changed(g_ptr_array_index(models, n));
+
+    n_changed = models->len;
+    g_ptr_array_free(models, TRUE);
+
+    return n_changed;
+}
+
+
+static gint
+_adg_find_param(AdgParamPlan *plan, const gchar *name)
+{
+    guint n;
+
+    for (n = 0; n < plan->params->len; ++n)
+        if (strcmp(g_array_index(plan->params, AdgPlanParam, n).name, name) == 0)
+            return n;
+
+    return -1;
+}
+
+static void
+_adg_link(AdgParamPlan *plan, AdgModel *model, const gchar *pair_name,
+          guint n_primitive, gint n_point,
+          const gchar *param, gdouble dx, gdouble dy)
+{
+    AdgPlanTarget *target, new_target;
+    AdgPlanTerm *term, new_term;
+    gint n_param;
+    guint n;
+
+    n_param = _adg_find_param(plan, param);
+    if (n_param < 0) {
+        g_warning(_("%s: parameter '%s' not defined"), G_STRLOC, param);
+        return;
+    }
+
+    /* Look for an existing target on the same point */
+    target = NULL;
+    for (n = 0; n < plan->targets->len; ++n) {
+        target = &g_array_index(plan->targets, AdgPlanTarget, n);
+        if (target->model == model &&
+            (pair_name != NULL ?
+             target->name != NULL && strcmp(target->name, pair_name) == 0 :
+             target->name == NULL && target->n_primitive == n_primitive &&
+             target->n_point == n_point))
+            break;
+        target = NULL;
+    }
+
+    if (target == NULL) {
+        memset(&new_target, 0, sizeof(new_target));
+        new_target.model = g_object_ref(model);
+        new_target.name = g_strdup(pair_name);
+        new_target.n_primitive = n_primitive;
+        new_target.n_point = n_point;
+        new_target.terms = g_array_new(FALSE, FALSE, sizeof(AdgPlanTerm));
+        g_array_append_val(plan->targets, new_target);
+        target = &g_array_index(plan->targets, AdgPlanTarget,
+                                plan->targets->len - 1);
+    }
+
+    /* Links of the same parameter are merged in a single term */
+    for (n = 0; n < target->terms->len; ++n) {
+        term = &g_array_index(target->terms, AdgPlanTerm, n);
+        if (term->param == (guint) n_param) {
+            term->dx += dx;
+            term->dy += dy;
+            plan->is_compiled = FALSE;
+            return;
+        }
+    }
+
+    new_term.param = n_param;
+    new_term.dx = dx;
+    new_term.dy = dy;
+    g_array_append_val(target->terms, new_term);
+    plan->is_compiled = FALSE;
+}
+
+static gboolean
+_adg_get_target(AdgPlanTarget *target, CpmlPair *pair)
+{
+    const CpmlPair *named_pair;
+
+    if (target->name == NULL)
+        return adg_path_put_point((AdgPath *) target->model,
+                                  target->n_primitive, target->n_point, pair);
+
+    named_pair = adg_model_get_named_pair(target->model, target->name);
+    if (named_pair == NULL)
+        return FALSE;
+
+    cpml_pair_copy(pair, named_pair);
+    return TRUE;
+}
+
+static void
+_adg_set_target(AdgPlanTarget *target, const CpmlPair *pair)
+{
+    if (target->name == NULL)
+        adg_path_set_point((AdgPath *) target->model,
+                           target->n_primitive, target->n_point, pair);
+    else
+        adg_model_set_named_pair(target->model, target->name, pair);
+}
@@ -0,0 +1,69 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_PARAM_PLAN_H__
+#define __ADG_PARAM_PLAN_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_PARAM_PLAN                     (adg_param_plan_get_type())
+
+typedef struct _AdgParamPlan AdgParamPlan;
+
+
+GType           adg_param_plan_get_type         (void);
+
+AdgParamPlan *  adg_param_plan_new              (void);
+AdgParamPlan *  adg_param_plan_dup              (const AdgParamPlan *src);
+void            adg_param_plan_destroy          (AdgParamPlan      *plan);
+void            adg_param_plan_add_param        (AdgParamPlan      *plan,
+                                                 const gchar       *name,
+                                                 gdouble            value);
+gboolean        adg_param_plan_set_param        (AdgParamPlan      *plan,
+                                                 const gchar       *name,
+                                                 gdouble            value);
+gdouble         adg_param_plan_get_param        (AdgParamPlan      *plan,
+                                                 const gchar       *name);
+void            adg_param_plan_link_named_pair  (AdgParamPlan      *plan,
+                                                 AdgModel          *model,
+                                                 const gchar       *pair_name,
+                                                 const gchar       *param,
+                                                 gdouble            dx,
+                                                 gdouble            dy);
+void            adg_param_plan_link_point       (AdgParamPlan      *plan,
+                                                 AdgPath           *path,
+                                                 guint              n_primitive,
+                                                 gint               n_point,
+                                                 const gchar       *param,
+                                                 gdouble            dx,
+                                                 gdouble            dy);
+gboolean        adg_param_plan_compile          (AdgParamPlan      *plan);
+guint           adg_param_plan_update           (AdgParamPlan      *plan);
+
+G_END_DECLS
+
+
+#endif /* __ADG_PARAM_PLAN_H__ */
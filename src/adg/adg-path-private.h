@@ -28,6 +28,7 @@ typedef struct _AdgNamedPair     AdgNamedPair;
 typedef enum   _AdgAction        AdgAction;
 typedef struct _AdgOperation     AdgOperation;
 typedef struct _AdgPathPrivate   AdgPathPrivate;
+typedef struct _AdgPrimitiveOffset AdgPrimitiveOffset;
 
 struct _AdgNamedPair {
     const gchar *name;
@@ -54,6 +55,13 @@ struct _AdgOperation{
 
 };
 
+/* Offsets are relative to the start of the cairo.array data, so they
+ * survive any reallocation. An org of -1 means there is no org. */
+struct _AdgPrimitiveOffset {
+    gint         org;
+    gint         data;
+};
+
 struct _AdgPathPrivate {
     gboolean             cp_is_valid;
     CpmlPair             cp;
@@ -63,9 +71,19 @@ struct _AdgPathPrivate {
         GArray          *array;
     }                    cairo;
 
+    GArray              *primitives;
+
+    /* Copy-on-write: when not NULL, cairo.array and primitives are
+     * shared with other paths and this is the number of owners */
+    gint                *shared;
+
     CpmlPrimitive        last;
     CpmlPrimitive        over;
     AdgOperation         operation;
+
+#ifdef ALLOC_TRACE_ENABLED
+    gsize                traced;
+#endif
 };
 
 G_END_DECLS
@@ -32,6 +32,10 @@
  * in mind any method that modifies the path will invalidate the
  * #cairo_path_t returned by adg_trail_get_cairo_path().
  *
+ * The only exception are the extents returned by adg_trail_get_extents():
+ * when a primitive is simply appended, they are enlarged to include it
+ * instead of being recomputed from scratch.
+ *
  * Although some of the provided methods are clearly based on the
  * original cairo path manipulation API, their behavior could be
  * sligthly different. This is intentional, because the ADG provides
@@ -64,22 +68,48 @@
 
 #include "adg-model.h"
 #include "adg-trail.h"
+#include "adg-trail-private.h"
 
 #include "adg-path.h"
 #include "adg-path-private.h"
 
+#include <string.h>
+#include <math.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_path_parent_class)
 #define _ADG_OLD_MODEL_CLASS   ((AdgModelClass *) adg_path_parent_class)
 
-#define REMAPPED(ptr, from, to) \
-    (ptr) == NULL ? NULL : \
-        (gpointer) ((guint8 *) (ptr) - (guint8 *) (from) + (guint8 *) (to))
-
 
 G_DEFINE_TYPE(AdgPath, adg_path, ADG_TYPE_TRAIL)
 
 
+typedef struct _AdgStitchSegment  AdgStitchSegment;
+typedef struct _AdgStitchEnd      AdgStitchEnd;
+typedef struct _AdgStitchLink     AdgStitchLink;
+
+/* State used by adg_path_stitch(): the segments are indexed by the
+ * quantized coordinates of their end points */
+struct _AdgStitchSegment {
+    const cairo_path_data_t *data;
+    gint                     num_data;
+    CpmlPair                 ends[2];
+    gboolean                 is_open;
+    gboolean                 is_used;
+};
+
+struct _AdgStitchEnd {
+    guint                    segment;
+    guint                    n_end;
+    gint                     next;
+};
+
+struct _AdgStitchLink {
+    guint                    segment;
+    gboolean                 is_reversed;
+};
+
+
 static void             _adg_finalize           (GObject        *object);
 static void             _adg_clear              (AdgModel       *model);
 static void             _adg_clear_parent       (AdgModel       *model);
@@ -87,14 +117,43 @@ static void             _adg_changed            (AdgModel       *model);
 static cairo_path_t *   _adg_get_cairo_path     (AdgTrail       *trail);
 static cairo_path_t *   _adg_read_cairo_path    (AdgPath        *path);
 static gint             _adg_primitive_length   (CpmlPrimitiveType type);
-static void             _adg_primitive_remap    (CpmlPrimitive  *primitive,
-                                                 gpointer        to,
-                                                 const CpmlPrimitive
-                                                                *old,
-                                                 gconstpointer   from);
+static void             _adg_push_primitive     (AdgPath        *path,
+                                                 const cairo_path_data_t
+                                                                *org,
+                                                 const cairo_path_data_t
+                                                                *path_data);
+static void             _adg_sync_primitives    (AdgPath        *path);
+static void             _adg_scan               (AdgPath        *path,
+                                                 guint           from);
 static void             _adg_rescan             (AdgPath        *path);
+static void             _adg_rebase_primitives  (AdgPath        *path,
+                                                 const cairo_path_data_t
+                                                                *old_base);
+static void             _adg_unshare            (AdgPath        *path);
+static void             _adg_get_primitive      (AdgPath        *path,
+                                                 guint           n_primitive,
+                                                 CpmlPrimitive  *primitive);
+static void             _adg_reflect_segment    (cairo_path_data_t
+                                                                *dst,
+                                                 const cairo_path_data_t
+                                                                *src,
+                                                 gint            num_data,
+                                                 const cairo_matrix_t
+                                                                *matrix);
+static void             _adg_append_data        (AdgPath        *path,
+                                                 const cairo_path_data_t
+                                                                *path_data,
+                                                 guint           num_data);
 static void             _adg_append_primitive   (AdgPath        *path,
                                                  CpmlPrimitive  *primitive);
+static void             _adg_append_pairs       (AdgPath        *path,
+                                                 CpmlPrimitiveType type,
+                                                 const CpmlPair *pairs,
+                                                 guint           n_pairs);
+static gboolean         _adg_add_extents        (AdgPath        *path,
+                                                 cairo_path_data_t
+                                                                *path_data,
+                                                 CpmlExtents    *extents);
 static void             _adg_clear_operation    (AdgPath        *path);
 static gboolean         _adg_append_operation   (AdgPath        *path,
                                                  gint            action,
@@ -109,15 +168,44 @@ static void             _adg_do_chamfer         (AdgPath        *path,
                                                  CpmlPrimitive  *current);
 static void             _adg_do_fillet          (AdgPath        *path,
                                                  CpmlPrimitive  *current);
+static gboolean         _adg_fillet_lines       (const CpmlPrimitive
+                                                                *last,
+                                                 const CpmlPrimitive
+                                                                *current,
+                                                 gdouble         radius,
+                                                 CpmlPair       *p);
+static CpmlPrimitive *  _adg_primitive_dup      (CpmlPrimitive  *dst,
+                                                 cairo_path_data_t
+                                                                *buffer,
+                                                 const CpmlPrimitive
+                                                                *src);
 static gboolean         _adg_is_convex          (const CpmlPrimitive
                                                                 *primitive1,
                                                  const CpmlPrimitive
                                                                 *primitive2);
 static const gchar *    _adg_action_name        (AdgAction       action);
+static void             _adg_dup_named_pair     (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 CpmlPair       *pair,
+                                                 gpointer        user_data);
 static void             _adg_get_named_pair     (AdgModel       *model,
                                                  const gchar    *name,
                                                  CpmlPair       *pair,
                                                  gpointer        user_data);
+static guint            _adg_stitch_cell        (gint64          x,
+                                                 gint64          y);
+static gint             _adg_stitch_lookup      (GHashTable     *cells,
+                                                 GArray         *ends,
+                                                 GArray         *segments,
+                                                 const CpmlPair *pair,
+                                                 gdouble         tolerance,
+                                                 guint          *n_end);
+static void             _adg_stitch_write       (GArray         *result,
+                                                 GArray         *scratch,
+                                                 const AdgStitchSegment
+                                                                *segment,
+                                                 gboolean        is_reversed,
+                                                 gboolean        is_first);
 static void             _adg_dup_reverse_named_pairs
                                                 (AdgModel       *model,
                                                  const cairo_matrix_t
@@ -158,6 +246,8 @@ adg_path_init(AdgPath *path)
     data->cairo.path.data = NULL;
     data->cairo.path.num_data = 0;
     data->cairo.array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    data->primitives = g_array_new(FALSE, FALSE, sizeof(AdgPrimitiveOffset));
+    data->shared = NULL;
     data->last.segment = NULL;
     data->last.org = NULL;
     data->last.data = NULL;
@@ -165,6 +255,9 @@ adg_path_init(AdgPath *path)
     data->over.org = NULL;
     data->over.data = NULL;
     data->operation.action = ADG_ACTION_NONE;
+#ifdef ALLOC_TRACE_ENABLED
+    data->traced = 0;
+#endif
 
     path->data = data;
 }
@@ -178,7 +271,15 @@ _adg_finalize(GObject *object)
     path = (AdgPath *) object;
     data = path->data;
 
-    g_array_free(data->cairo.array, TRUE);
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_PATH, &data->traced, 0);
+
+    /* Shared buffers are released by their last owner */
+    if (data->shared == NULL || g_atomic_int_dec_and_test(data->shared)) {
+        g_free(data->shared);
+        g_array_free(data->cairo.array, TRUE);
+        g_array_free(data->primitives, TRUE);
+    }
+
     _adg_clear_operation(path);
 
     if (_ADG_OLD_OBJECT_CLASS->finalize)
@@ -202,6 +303,68 @@ adg_path_new(void)
     return g_object_new(ADG_TYPE_PATH, NULL);
 }
 
+/**
+ * adg_path_dup:
+ * @path: an #AdgPath
+ *
+ * Creates a new path model with the same content of @path. The
+ * primitives are not copied: the new path shares them with @path
+ * until one of the two is modified, and only then the modified path
+ * gets its own copy (copy-on-write). This makes cheap to use the same
+ * geometry in many drawings, e.g. in different canvases with their
+ * own annotations: a later adg_path_chamfer() on a variant duplicates
+ * the data of that variant only.
+ *
+ * Arcs and pending operations (e.g. a chamfer waiting for its second
+ * primitive) are preserved as they are. The named pairs, the maximum
+ * angle and the tolerance of @path are copied too, while the
+ * dependencies are not: they belong to the entities using @path.
+ *
+ * Returns: (transfer full): the newly created path model or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgPath *
+adg_path_dup(AdgPath *path)
+{
+    AdgPath *dup;
+    AdgPathPrivate *data, *dup_data;
+    AdgTrail *trail;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), NULL);
+
+    data = path->data;
+    trail = (AdgTrail *) path;
+    dup = g_object_new(ADG_TYPE_PATH,
+                       "max-angle", adg_trail_get_max_angle(trail),
+                       "tolerance", adg_trail_get_tolerance(trail),
+                       NULL);
+    dup_data = dup->data;
+
+    /* Share the buffers of @path instead of copying them */
+    if (data->shared == NULL) {
+        data->shared = g_new(gint, 1);
+        *data->shared = 1;
+    }
+    g_atomic_int_inc(data->shared);
+    g_array_free(dup_data->cairo.array, TRUE);
+    g_array_free(dup_data->primitives, TRUE);
+    dup_data->shared = data->shared;
+    dup_data->cairo.array = data->cairo.array;
+    dup_data->primitives = data->primitives;
+
+    dup_data->cp_is_valid = data->cp_is_valid;
+    dup_data->cp = data->cp;
+    dup_data->last = data->last;
+    dup_data->over = data->over;
+    dup_data->operation = data->operation;
+
+    adg_model_foreach_named_pair((AdgModel *) path,
+                                 _adg_dup_named_pair, dup);
+
+    return dup;
+}
+
 /**
  * adg_path_get_current_point:
  * @path: an #AdgPath
@@ -324,6 +487,116 @@ adg_path_over_primitive(AdgPath *path)
     return &data->over;
 }
 
+/**
+ * adg_path_get_n_primitives:
+ * @path: an #AdgPath
+ *
+ * Gets the number of primitives of @path. As for
+ * adg_path_last_primitive(), the #CPML_MOVE type is not considered a
+ * full-fledged primitive, so the result is also the index the next
+ * appended primitive will have in adg_path_set_point().
+ *
+ * Returns: the number of primitives or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_path_get_n_primitives(AdgPath *path)
+{
+    AdgPathPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), 0);
+
+    data = path->data;
+
+    return data->primitives->len;
+}
+
+/**
+ * adg_path_put_point:
+ * @path:        an #AdgPath
+ * @n_primitive: the index of the primitive, starting from 0
+ * @n_point:     the index of the point, as in cpml_primitive_put_point()
+ * @pair:        (out): the destination #CpmlPair
+ *
+ * Gets the coordinates of a point of a primitive of @path, using the
+ * same indexes of adg_path_set_point().
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> if the point does not exist or on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_path_put_point(AdgPath *path, guint n_primitive, gint n_point,
+                   CpmlPair *pair)
+{
+    AdgPathPrivate *data;
+    CpmlPrimitive primitive;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), FALSE);
+    g_return_val_if_fail(pair != NULL, FALSE);
+
+    data = path->data;
+    if (n_primitive >= data->primitives->len)
+        return FALSE;
+
+    _adg_get_primitive(path, n_primitive, &primitive);
+    return cpml_primitive_put_point(&primitive, n_point, pair);
+}
+
+/**
+ * adg_path_set_point:
+ * @path:        an #AdgPath
+ * @n_primitive: the index of the primitive, starting from 0
+ * @n_point:     the index of the point, as in cpml_primitive_set_point()
+ * @pair:        the new coordinates
+ *
+ * Moves a point of an existing primitive of @path in place, without
+ * rebuilding the path. @n_primitive counts the primitives in the
+ * order they have been appended and the point 0 is the origin of the
+ * primitive, that is the end point of the previous one, so both the
+ * primitives are affected.
+ *
+ * Pending operations, named pairs and the primitives generated by a
+ * chamfer or a fillet are not recomputed. The #cairo_path_t and the
+ * extents of @path are invalidated but no signal is emitted: call
+ * adg_model_changed() once all the points have been moved.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> if the point does not exist or on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_path_set_point(AdgPath *path, guint n_primitive, gint n_point,
+                   const CpmlPair *pair)
+{
+    AdgPathPrivate *data;
+    CpmlPrimitive primitive;
+    CpmlPair old;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), FALSE);
+    g_return_val_if_fail(pair != NULL, FALSE);
+
+    data = path->data;
+    if (n_primitive >= data->primitives->len)
+        return FALSE;
+
+    _adg_unshare(path);
+    _adg_get_primitive(path, n_primitive, &primitive);
+    if (! cpml_primitive_put_point(&primitive, n_point, &old))
+        return FALSE;
+
+    cpml_primitive_set_point(&primitive, n_point, pair);
+
+    /* Keep the current point in sync when the end point moved */
+    if (data->cp_is_valid && n_primitive == data->primitives->len - 1 &&
+        cpml_pair_equal(&old, &data->cp))
+        cpml_pair_copy(&data->cp, pair);
+
+    _adg_clear_parent((AdgModel *) path);
+    return TRUE;
+}
+
 /**
  * adg_path_append:
  * @path: an #AdgPath
@@ -457,6 +730,159 @@ adg_path_append_array(AdgPath *path, CpmlPrimitiveType type,
 }
 
 
+/**
+ * adg_path_append_points:
+ * @path:    an #AdgPath
+ * @types:   (array length=n_types): the primitive types, optionally or-ed
+ *           with an #AdgJoint value
+ * @n_types: number of items in @types
+ * @pairs:   (array): packed point data of all the primitives
+ * @values:  (array) (allow-none): packed joint values
+ *
+ * Appends to @path @n_types primitives in a single call. The type of
+ * every primitive is taken from @types while its points are sequentially
+ * read from @pairs: %CPML_CLOSE consumes no pairs, %CPML_MOVE and
+ * %CPML_LINE one pair, %CPML_ARC two pairs and %CPML_CURVE three pairs.
+ *
+ * A type or-ed with %ADG_JOINT_CHAMFER or %ADG_JOINT_FILLET joins that
+ * primitive with the next one, exactly as adg_path_chamfer() or
+ * adg_path_fillet() would do when called just after appending it. The
+ * joint parameters are sequentially read from @values: a chamfer
+ * consumes two values (delta1 and delta2), a fillet one value (the
+ * radius). @values can be <constant>NULL</constant> only when no joint
+ * is requested.
+ *
+ * This is equivalent to a sequence of adg_path_append() with
+ * adg_path_chamfer() and adg_path_fillet() calls, but it avoids the
+ * overhead of parsing arguments and checking types for every primitive.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_append_points(AdgPath *path, const guint8 *types, guint n_types,
+                       const CpmlPair *pairs, const gdouble *values)
+{
+    AdgPathPrivate *data;
+    cairo_path_data_t path_data[4];
+    cairo_path_data_t org;
+    CpmlPrimitive primitive;
+    CpmlPrimitiveType type;
+    guint8 joint;
+    gint length, n;
+    guint i;
+
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_return_if_fail(n_types == 0 || types != NULL);
+
+    data = path->data;
+
+    for (i = 0; i < n_types; ++i) {
+        type = types[i] & ~(ADG_JOINT_CHAMFER | ADG_JOINT_FILLET);
+        joint = types[i] & (ADG_JOINT_CHAMFER | ADG_JOINT_FILLET);
+        length = _adg_primitive_length(type);
+        if (length == 0 || length > (gint) G_N_ELEMENTS(path_data)) {
+            g_warning(_("%s: invalid primitive type (%d)"), G_STRLOC, type);
+            return;
+        }
+
+        path_data[0].header.type = type;
+        path_data[0].header.length = length;
+        for (n = 1; n < length; ++n) {
+            g_return_if_fail(pairs != NULL);
+            cpml_pair_to_cairo(pairs, &path_data[n]);
+            ++pairs;
+        }
+
+        /* The current point must be saved, because pending operations
+         * are allowed to modify the primitive origin */
+        cpml_pair_to_cairo(&data->cp, &org);
+        primitive.segment = NULL;
+        primitive.org = &org;
+        primitive.data = path_data;
+        _adg_append_primitive(path, &primitive);
+
+        if (joint == ADG_JOINT_CHAMFER) {
+            g_return_if_fail(values != NULL);
+            if (!_adg_append_operation(path, ADG_ACTION_CHAMFER,
+                                       values[0], values[1]))
+                return;
+            values += 2;
+        } else if (joint == ADG_JOINT_FILLET) {
+            g_return_if_fail(values != NULL);
+            if (!_adg_append_operation(path, ADG_ACTION_FILLET, values[0]))
+                return;
+            ++values;
+        } else if (joint != 0) {
+            g_warning(_("%s: chamfer and fillet requested on the same joint"),
+                      G_STRLOC);
+            return;
+        }
+    }
+}
+
+
+/**
+ * adg_path_append_coords:
+ * @path:     an #AdgPath
+ * @types:    (array length=n_types): the primitive types, optionally or-ed
+ *            with an #AdgJoint value
+ * @n_types:  number of items in @types
+ * @coords:   (array length=n_coords) (allow-none): packed x and y
+ *            coordinates of all the points
+ * @n_coords: number of items in @coords
+ * @values:   (array length=n_values) (allow-none): packed joint values
+ * @n_values: number of items in @values
+ *
+ * Flat counterpart of adg_path_append_points(), suitable for language
+ * bindings: every array carries its own length, so a whole profile
+ * can be pushed with a single call, e.g. from a script. @coords
+ * holds the x and y coordinates of the points one after the other.
+ *
+ * The sizes of @coords and @values must exactly match the ones
+ * requested by @types, otherwise a warning is raised and nothing
+ * is appended to @path.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_append_coords(AdgPath *path, const guint8 *types, guint n_types,
+                       const gdouble *coords, guint n_coords,
+                       const gdouble *values, guint n_values)
+{
+    guint i, n_pairs, n_joints;
+    guint8 joint;
+    gint length;
+
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_return_if_fail(n_types == 0 || types != NULL);
+    g_return_if_fail(n_coords == 0 || coords != NULL);
+    g_return_if_fail(n_values == 0 || values != NULL);
+
+    /* Validate everything in advance: never append partial data */
+    n_pairs = 0;
+    n_joints = 0;
+    for (i = 0; i < n_types; ++i) {
+        length = _adg_primitive_length(types[i] & ~(ADG_JOINT_CHAMFER | ADG_JOINT_FILLET));
+        joint = types[i] & (ADG_JOINT_CHAMFER | ADG_JOINT_FILLET);
+        if (length > 0)
+            n_pairs += length - 1;
+        if (joint == ADG_JOINT_CHAMFER)
+            n_joints += 2;
+        else if (joint == ADG_JOINT_FILLET)
+            ++n_joints;
+    }
+
+    if (n_coords != n_pairs * 2 || n_values != n_joints) {
+        g_warning(_("%s: expected %u coordinates and %u values, got %u and %u"),
+                  G_STRLOC, n_pairs * 2, n_joints, n_coords, n_values);
+        return;
+    }
+
+    /* CpmlPair is a couple of doubles, so @coords has the same layout */
+    adg_path_append_points(path, types, n_types,
+                           (const CpmlPair *) coords, values);
+}
+
 /**
  * adg_path_append_primitive:
  * @path:      an #AdgPath
@@ -511,16 +937,9 @@ adg_path_append_segment(AdgPath *path, const CpmlSegment *segment)
     g_return_if_fail(segment != NULL);
 
     if (segment->num_data > 0) {
-        AdgPathPrivate *data;
-
         g_return_if_fail(segment->data != NULL);
 
-        data = path->data;
-
-        _adg_clear_parent((AdgModel *) path);
-        data->cairo.array = g_array_append_vals(data->cairo.array,
-                                                segment->data, segment->num_data);
-        _adg_rescan(path);
+        _adg_append_data(path, segment->data, segment->num_data);
     }
 }
 
@@ -536,18 +955,55 @@ adg_path_append_segment(AdgPath *path, const CpmlSegment *segment)
 void
 adg_path_append_cairo_path(AdgPath *path, const cairo_path_t *cairo_path)
 {
-    AdgPathPrivate *data;
-
     g_return_if_fail(ADG_IS_PATH(path));
     g_return_if_fail(cairo_path != NULL);
 
-    data = path->data;
+    _adg_append_data(path, cairo_path->data, cairo_path->num_data);
+}
 
-    _adg_clear_parent((AdgModel *) path);
-    data->cairo.array = g_array_append_vals(data->cairo.array,
-                                            cairo_path->data,
-                                            cairo_path->num_data);
-    _adg_rescan(path);
+/**
+ * adg_path_append_boolean:
+ * @path:      an #AdgPath
+ * @segment:   the first closed #CpmlSegment
+ * @segment2:  the second closed #CpmlSegment
+ * @operation: the boolean operation to perform
+ * @tolerance: the maximum distance allowed when flattening
+ *
+ * Combines the areas enclosed by @segment and @segment2 with
+ * cpml_segment_put_boolean() and appends the outline of the result
+ * to @path. The result can be made by more than one closed segment,
+ * for instance a union of two disjoint outlines or a difference
+ * leaving a hole, and it is made only by lines: @path can be used as
+ * the trail of an #AdgHatch straight away.
+ *
+ * The segments can be obtained from any #AdgTrail with
+ * adg_trail_put_segment(). Nothing is appended if the result is empty.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_append_boolean(AdgPath *path, const CpmlSegment *segment,
+                        const CpmlSegment *segment2,
+                        CpmlBooleanOperation operation, gdouble tolerance)
+{
+    cairo_path_data_t *path_data;
+    size_t num_data;
+
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_return_if_fail(segment != NULL);
+    g_return_if_fail(segment2 != NULL);
+    g_return_if_fail(tolerance > 0);
+
+    num_data = cpml_segment_put_boolean(segment, segment2, operation,
+                                        tolerance, 0, NULL);
+    if (num_data == 0)
+        return;
+
+    path_data = g_new(cairo_path_data_t, num_data);
+    cpml_segment_put_boolean(segment, segment2, operation,
+                             tolerance, num_data, path_data);
+    _adg_append_data(path, path_data, num_data);
+    g_free(path_data);
 }
 
 /**
@@ -564,26 +1020,16 @@ adg_path_append_cairo_path(AdgPath *path, const cairo_path_t *cairo_path)
 void
 adg_path_append_trail(AdgPath *path, AdgTrail *trail)
 {
-    GSList *named_pairs;
-    AdgNamedPair *named_pair;
-
     g_return_if_fail(ADG_IS_PATH(path));
     g_return_if_fail(ADG_IS_TRAIL(trail));
 
-    adg_path_append_cairo_path(path, adg_trail_get_cairo_path(trail));
-
-    /* Populate named_pairs with all the named pairs of trail */
-    named_pairs = NULL;
-    adg_model_foreach_named_pair((AdgModel *)trail,
-                                 _adg_get_named_pair, &named_pairs);
+    adg_path_append_cairo_path(path, _adg_trail_get_cairo_path(trail));
 
-    /* Readd the pairs to path */
-    while (named_pairs) {
-        named_pair = (AdgNamedPair *) named_pairs->data;
-        adg_model_set_named_pair((AdgModel *) path,
-                                 named_pair->name, &named_pair->pair);
-        named_pairs = g_slist_delete_link(named_pairs, named_pairs);
-    }
+    /* The named pairs are copied straight away: when @trail is @path
+     * itself the pairs are set again to the same value, so no
+     * intermediate copy is needed */
+    adg_model_foreach_named_pair((AdgModel *) trail,
+                                 _adg_dup_named_pair, path);
 }
 
 /**
@@ -597,27 +1043,32 @@ adg_path_append_trail(AdgPath *path, AdgTrail *trail)
 void
 adg_path_remove_primitive(AdgPath *path)
 {
+    AdgPathPrivate *data;
     const CpmlPrimitive *over;
     guint len;
 
     g_return_if_fail(ADG_IS_PATH(path));
 
-    AdgPathPrivate *data = path->data;
-
+    _adg_unshare(path);
+    data = path->data;
     over = adg_path_over_primitive(path);
-    if (over) {
-        cairo_path_data_t *end = over->data + over->data->header.length;
-        len = end - (cairo_path_data_t *) (data->cairo.array)->data;
-    } else {
-        len = 0;
+
+    _adg_clear_parent((AdgModel *) path);
+
+    if (over == NULL) {
+        g_array_set_size(data->cairo.array, 0);
+        _adg_rescan(path);
+        return;
     }
 
     /* Resize the data array */
+    len = over->data + over->data->header.length -
+          (cairo_path_data_t *) (data->cairo.array)->data;
     g_array_set_size(data->cairo.array, len);
 
-    /* Rescan path to compute the new over and last primitives */
-    _adg_clear_parent((AdgModel *) path);
-    _adg_rescan(path);
+    /* The over primitive becomes the last one: no rescan needed */
+    g_array_set_size(data->primitives, data->primitives->len - 1);
+    _adg_sync_primitives(path);
 }
 
 /**
@@ -994,6 +1445,7 @@ adg_path_join(AdgPath *path)
 
     g_return_if_fail(ADG_IS_PATH(path));
 
+    _adg_unshare(path);
     cairo_path = _adg_read_cairo_path(path);
     pen_down = FALSE;
     data = cairo_path->data;
@@ -1006,6 +1458,332 @@ adg_path_join(AdgPath *path)
         }
         data += data->header.length;
     }
+
+    /* The embedded CPML_MOVE are now full-fledged primitives */
+    _adg_clear_parent((AdgModel *) path);
+    _adg_rescan(path);
+}
+
+/**
+ * adg_path_stitch:
+ * @path:      an #AdgPath
+ * @tolerance: the maximum distance between two end points to be joined
+ *
+ * Stitches the open segments of @path end-to-end, e.g. to rebuild the
+ * outlines of a drawing imported as a bunch of disconnected
+ * primitives. Any segment whose start or end point lies within
+ * @tolerance from the end of another segment is appended to it,
+ * reversing it when needed, so every chain of touching segments
+ * becomes a single segment. Closed segments are left untouched.
+ *
+ * Different from adg_path_join(), only segments really sharing an end
+ * point are joined and no new primitive is added. The end points are
+ * quantized in a hash table, so the whole pass is roughly linear on
+ * the number of segments. The resulting segments keep the order of
+ * the first segment of every chain.
+ *
+ * Returns: the number of joins performed.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_path_stitch(AdgPath *path, gdouble tolerance)
+{
+    AdgPathPrivate *data;
+    cairo_path_t *cairo_path;
+    CpmlSegment segment;
+    GArray *segments, *ends, *chain, *backward, *result, *scratch;
+    GHashTable *cells;
+    AdgStitchSegment *stitch, *other;
+    AdgStitchEnd end;
+    AdgStitchLink link;
+    cairo_path_data_t *item;
+    gdouble cell_size;
+    gint64 x, y;
+    gint n_data, n_next, n_last, n_first;
+    guint n, n_end, n_point, n_joins;
+    gpointer head;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), 0);
+    g_return_val_if_fail(tolerance >= 0, 0);
+
+    _adg_unshare(path);
+    data = path->data;
+    cairo_path = _adg_read_cairo_path(path);
+    segments = g_array_new(FALSE, FALSE, sizeof(AdgStitchSegment));
+
+    /* Index the segments with their end points */
+    if (cairo_path->num_data > 0 && cpml_segment_from_cairo(&segment, cairo_path)) {
+        do {
+            AdgStitchSegment new_segment;
+            CpmlPrimitiveType type;
+
+            if (segment.num_data == 0)
+                continue;
+
+            n_last = 0;
+            for (n_data = 0; n_data < segment.num_data;
+                 n_data += segment.data[n_data].header.length)
+                n_last = n_data;
+
+            item = segment.data + n_last;
+            type = item->header.type;
+            n_point = type == CPML_MOVE ? 1 : cpml_primitive_type_get_n_points(type) - 1;
+            new_segment.data = segment.data;
+            new_segment.num_data = segment.num_data;
+            cpml_pair_from_cairo(&new_segment.ends[0], &segment.data[1]);
+            cpml_pair_from_cairo(&new_segment.ends[1], &item[n_point]);
+            new_segment.is_open = type != CPML_CLOSE;
+            new_segment.is_used = FALSE;
+            g_array_append_val(segments, new_segment);
+        } while (cpml_segment_next(&segment));
+    }
+
+    if (segments->len < 2) {
+        g_array_free(segments, TRUE);
+        return 0;
+    }
+
+    /* A null tolerance means exact matches: any cell size is good */
+    cell_size = tolerance > 0 ? tolerance : 1;
+    cells = g_hash_table_new(NULL, NULL);
+    ends = g_array_sized_new(FALSE, FALSE, sizeof(AdgStitchEnd),
+                             segments->len * 2);
+
+    for (n = 0; n < segments->len; ++n) {
+        stitch = &g_array_index(segments, AdgStitchSegment, n);
+        if (! stitch->is_open)
+            continue;
+
+        for (n_end = 0; n_end < 2; ++n_end) {
+            x = floor(stitch->ends[n_end].x / cell_size);
+            y = floor(stitch->ends[n_end].y / cell_size);
+            head = GUINT_TO_POINTER(_adg_stitch_cell(x, y));
+            end.segment = n;
+            end.n_end = n_end;
+            end.next = GPOINTER_TO_INT(g_hash_table_lookup(cells, head)) - 1;
+            g_array_append_val(ends, end);
+            g_hash_table_insert(cells, head, GINT_TO_POINTER(ends->len));
+        }
+    }
+
+    result = g_array_sized_new(FALSE, FALSE, sizeof(cairo_path_data_t),
+                               cairo_path->num_data);
+    scratch = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    chain = g_array_new(FALSE, FALSE, sizeof(AdgStitchLink));
+    backward = g_array_new(FALSE, FALSE, sizeof(AdgStitchLink));
+    n_joins = 0;
+
+    for (n = 0; n < segments->len; ++n) {
+        stitch = &g_array_index(segments, AdgStitchSegment, n);
+        if (stitch->is_used)
+            continue;
+
+        stitch->is_used = TRUE;
+        if (! stitch->is_open) {
+            _adg_stitch_write(result, scratch, stitch, FALSE, TRUE);
+            continue;
+        }
+
+        g_array_set_size(chain, 0);
+        g_array_set_size(backward, 0);
+        link.segment = n;
+        link.is_reversed = FALSE;
+        g_array_append_val(chain, link);
+
+        /* Grow the chain forward from its end... */
+        for (;;) {
+            const AdgStitchLink *tail = &g_array_index(chain, AdgStitchLink,
+                                                       chain->len - 1);
+            other = &g_array_index(segments, AdgStitchSegment, tail->segment);
+            n_next = _adg_stitch_lookup(cells, ends, segments,
+                                        &other->ends[tail->is_reversed ? 0 : 1],
+                                        tolerance, &n_end);
+            if (n_next < 0)
+                break;
+            g_array_index(segments, AdgStitchSegment, n_next).is_used = TRUE;
+            link.segment = n_next;
+            link.is_reversed = n_end == 1;
+            g_array_append_val(chain, link);
+        }
+
+        /* ...and backward from its start */
+        n_first = n;
+        link.is_reversed = FALSE;
+        for (;;) {
+            other = &g_array_index(segments, AdgStitchSegment, n_first);
+            n_next = _adg_stitch_lookup(cells, ends, segments,
+                                        &other->ends[link.is_reversed ? 1 : 0],
+                                        tolerance, &n_end);
+            if (n_next < 0)
+                break;
+            g_array_index(segments, AdgStitchSegment, n_next).is_used = TRUE;
+            n_first = n_next;
+            link.segment = n_next;
+            link.is_reversed = n_end == 0;
+            g_array_append_val(backward, link);
+        }
+
+        n_joins += chain->len + backward->len - 1;
+        for (n_data = backward->len; n_data > 0; --n_data) {
+            link = g_array_index(backward, AdgStitchLink, n_data - 1);
+            _adg_stitch_write(result, scratch,
+                              &g_array_index(segments, AdgStitchSegment, link.segment),
+                              link.is_reversed, n_data == (gint) backward->len);
+        }
+        for (n_data = 0; n_data < (gint) chain->len; ++n_data) {
+            link = g_array_index(chain, AdgStitchLink, n_data);
+            _adg_stitch_write(result, scratch,
+                              &g_array_index(segments, AdgStitchSegment, link.segment),
+                              link.is_reversed, n_data == 0 && backward->len == 0);
+        }
+    }
+
+    if (n_joins > 0) {
+        /* The new data has the same size or it is smaller */
+        g_array_set_size(data->cairo.array, 0);
+        g_array_append_vals(data->cairo.array, result->data, result->len);
+        _adg_clear_parent((AdgModel *) path);
+        _adg_rescan(path);
+    }
+
+    g_array_free(backward, TRUE);
+    g_array_free(chain, TRUE);
+    g_array_free(scratch, TRUE);
+    g_array_free(result, TRUE);
+    g_array_free(ends, TRUE);
+    g_hash_table_destroy(cells);
+    g_array_free(segments, TRUE);
+
+    return n_joins;
+}
+
+/**
+ * adg_path_simplify:
+ * @path:      an #AdgPath
+ * @tolerance: the maximum allowed deviation from the original points
+ * @fit_arcs:  whether runs of lines can be replaced by arcs
+ *
+ * Simplifies in place every segment of @path with
+ * cpml_segment_put_simplified(). This is mainly useful on polylines
+ * coming from imported or scanned geometry, where a lot of tiny
+ * (and often collinear) lines can be reduced to much fewer
+ * primitives without visible changes. If @fit_arcs is
+ * <constant>TRUE</constant>, the runs of lines approximating a
+ * circle are converted to a single arc.
+ *
+ * Only %CPML_LINE primitives are affected: any other primitive and
+ * the end points of every run of lines are kept as they are.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_simplify(AdgPath *path, gdouble tolerance, gboolean fit_arcs)
+{
+    AdgPathPrivate *data;
+    cairo_path_t *cairo_path;
+    CpmlSegment segment;
+    GArray *result;
+    guint len;
+
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_return_if_fail(tolerance > 0);
+
+    _adg_unshare(path);
+    data = path->data;
+    cairo_path = _adg_read_cairo_path(path);
+
+    if (cairo_path->num_data == 0 || ! cpml_segment_from_cairo(&segment, cairo_path))
+        return;
+
+    result = g_array_sized_new(FALSE, FALSE, sizeof(cairo_path_data_t),
+                               cairo_path->num_data);
+
+    do {
+        if (segment.num_data == 0)
+            continue;
+
+        /* The simplified segment is never bigger than the original one */
+        len = result->len;
+        g_array_set_size(result, len + segment.num_data);
+        len += cpml_segment_put_simplified(&segment, tolerance, fit_arcs,
+                                           segment.num_data,
+                                           &g_array_index(result, cairo_path_data_t, len));
+        g_array_set_size(result, len);
+    } while (cpml_segment_next(&segment));
+
+    if (result->len != (guint) cairo_path->num_data) {
+        g_array_set_size(data->cairo.array, 0);
+        g_array_append_vals(data->cairo.array, result->data, result->len);
+        _adg_clear_parent((AdgModel *) path);
+        _adg_rescan(path);
+    }
+
+    g_array_free(result, TRUE);
+}
+
+/**
+ * adg_path_fit_curves:
+ * @path:      an #AdgPath
+ * @tolerance: the maximum allowed deviation from the original points
+ *
+ * Compacts in place every segment of @path with
+ * cpml_segment_put_fitted(), replacing long sequences of short lines
+ * with a few cubic Bézier curves. This is meant for smooth sampled
+ * data, such as surface profiles, where adg_path_simplify() cannot
+ * drop any point: the number of primitives is usually reduced by an
+ * order of magnitude and so are the cache of @path and the size of
+ * the exported drawings.
+ *
+ * Only %CPML_LINE primitives are affected: any other primitive, the
+ * end points of every run of lines and the sharp corners are kept
+ * as they are.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_fit_curves(AdgPath *path, gdouble tolerance)
+{
+    AdgPathPrivate *data;
+    cairo_path_t *cairo_path;
+    CpmlSegment segment;
+    GArray *result;
+    guint len;
+
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_return_if_fail(tolerance > 0);
+
+    _adg_unshare(path);
+    data = path->data;
+    cairo_path = _adg_read_cairo_path(path);
+
+    if (cairo_path->num_data == 0 || ! cpml_segment_from_cairo(&segment, cairo_path))
+        return;
+
+    result = g_array_sized_new(FALSE, FALSE, sizeof(cairo_path_data_t),
+                               cairo_path->num_data);
+
+    do {
+        if (segment.num_data == 0)
+            continue;
+
+        /* The compacted segment is never bigger than the original one */
+        len = result->len;
+        g_array_set_size(result, len + segment.num_data);
+        len += cpml_segment_put_fitted(&segment, tolerance, segment.num_data,
+                                       &g_array_index(result, cairo_path_data_t, len));
+        g_array_set_size(result, len);
+    } while (cpml_segment_next(&segment));
+
+    /* Any fitted curve shrinks the data, so same size means no changes */
+    if (result->len != (guint) cairo_path->num_data) {
+        g_array_set_size(data->cairo.array, 0);
+        g_array_append_vals(data->cairo.array, result->data, result->len);
+        _adg_clear_parent((AdgModel *) path);
+        _adg_rescan(path);
+    }
+
+    g_array_free(result, TRUE);
 }
 
 /**
@@ -1029,16 +1807,18 @@ void
 adg_path_reflect(AdgPath *path, const CpmlVector *vector)
 {
     AdgModel *model;
-    AdgTrail *trail;
+    AdgPathPrivate *data;
     cairo_matrix_t matrix;
-    CpmlSegment segment, *dup_segment;
-    gint n;
+    cairo_path_t *cairo_path;
+    CpmlSegment segment, *src_segment;
+    GArray *segments;
+    cairo_path_data_t *old_base, *base, *dst;
+    guint num_data, from, n;
 
     g_return_if_fail(ADG_IS_PATH(path));
     g_return_if_fail(vector == NULL || vector->x != 0 || vector->y != 0);
 
     model = (AdgModel *) path;
-    trail = (AdgTrail *) path;
 
     if (vector == NULL) {
         cairo_matrix_init_scale(&matrix, 1, -1);
@@ -1062,26 +1842,47 @@ adg_path_reflect(AdgPath *path, const CpmlVector *vector)
                           sin2angle, -cos2angle, 0, 0);
     }
 
-    for (n = adg_trail_n_segments(trail); n > 0; --n) {
-        adg_trail_put_segment(trail, n, &segment);
-
-        /* No need to reverse an empty segment */
-        if (segment.num_data == 0 || segment.num_data == 0)
-            continue;
-
-        dup_segment = cpml_segment_deep_dup(&segment);
-        if (dup_segment == NULL)
-            return;
+    /* Index the segments of @path only once */
+    _adg_unshare(path);
+    data = path->data;
+    cairo_path = _adg_read_cairo_path(path);
+    segments = g_array_new(FALSE, FALSE, sizeof(CpmlSegment));
+    num_data = 0;
+    if (cairo_path->num_data > 0 && cpml_segment_from_cairo(&segment, cairo_path)) {
+        do {
+            /* No need to reverse an empty segment */
+            if (segment.num_data == 0)
+                continue;
 
-        cpml_segment_reverse(dup_segment);
-        cpml_segment_transform(dup_segment, &matrix);
-        dup_segment->data[0].header.type = CPML_MOVE;
+            g_array_append_val(segments, segment);
+            num_data += segment.num_data;
+        } while (cpml_segment_next(&segment));
+    }
 
-        adg_path_append_segment(path, dup_segment);
+    if (num_data > 0) {
+        /* Reserve the space once and write the reflected segments
+         * directly in their final place, from the last to the first.
+         * The array can be relocated, so the segments are rebased. */
+        old_base = cairo_path->data;
+        _adg_clear_parent(model);
+        from = (data->cairo.array)->len;
+        g_array_set_size(data->cairo.array, from + num_data);
+        base = (cairo_path_data_t *) (data->cairo.array)->data;
+        dst = base + from;
+
+        for (n = segments->len; n > 0; --n) {
+            src_segment = &g_array_index(segments, CpmlSegment, n - 1);
+            _adg_reflect_segment(dst, base + (src_segment->data - old_base),
+                                 src_segment->num_data, &matrix);
+            dst += src_segment->num_data;
+        }
 
-        g_free(dup_segment);
+        /* The new data starts with a CPML_MOVE, so only it must be scanned */
+        _adg_scan(path, from);
     }
 
+    g_array_free(segments, TRUE);
+
     _adg_dup_reverse_named_pairs(model, &matrix);
 }
 
@@ -1115,9 +1916,11 @@ _adg_clear(AdgModel *model)
     AdgPathPrivate *data;
 
     path = (AdgPath *) model;
+    _adg_unshare(path);
     data = path->data;
 
     g_array_set_size(data->cairo.array, 0);
+    g_array_set_size(data->primitives, 0);
     _adg_clear_operation(path);
     _adg_clear_parent(model);
 }
@@ -1125,6 +1928,14 @@ _adg_clear(AdgModel *model)
 static void
 _adg_clear_parent(AdgModel *model)
 {
+#ifdef ALLOC_TRACE_ENABLED
+    /* Every change to the buffers ends up here */
+    AdgPathPrivate *data = ((AdgPath *) model)->data;
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_PATH, &data->traced,
+                   data->cairo.array->len * sizeof(cairo_path_data_t) +
+                   data->primitives->len * sizeof(AdgPrimitiveOffset));
+#endif
+
     if (_ADG_OLD_MODEL_CLASS->clear)
         _ADG_OLD_MODEL_CLASS->clear(model);
 }
@@ -1177,100 +1988,289 @@ _adg_primitive_length(CpmlPrimitiveType type)
 }
 
 static void
-_adg_primitive_remap(CpmlPrimitive *primitive, gpointer to,
-                     const CpmlPrimitive *old, gconstpointer from)
+_adg_push_primitive(AdgPath *path, const cairo_path_data_t *org,
+                    const cairo_path_data_t *path_data)
+{
+    AdgPathPrivate *data;
+    const cairo_path_data_t *base;
+    AdgPrimitiveOffset offset;
+
+    data = path->data;
+    base = (const cairo_path_data_t *) (data->cairo.array)->data;
+
+    offset.org = org == NULL ? -1 : org - base;
+    offset.data = path_data - base;
+    g_array_append_val(data->primitives, offset);
+}
+
+static void
+_adg_sync_primitives(AdgPath *path)
 {
-    primitive->org =     REMAPPED(old->org,     from, to);
-    primitive->segment = REMAPPED(old->segment, from, to);
-    primitive->data =    REMAPPED(old->data,    from, to);
+    AdgPathPrivate *data;
+    cairo_path_data_t *base;
+    const AdgPrimitiveOffset *offset;
+    CpmlPrimitive *primitive[2];
+    guint n, len;
+
+    data = path->data;
+    base = (cairo_path_data_t *) (data->cairo.array)->data;
+    len = data->primitives->len;
+    primitive[0] = &data->last;
+    primitive[1] = &data->over;
+
+    /* Rebuild the last and over primitives from the top of the stack,
+     * so any reallocation of the data array is implicitly handled */
+    for (n = 0; n < 2; ++n) {
+        primitive[n]->segment = NULL;
+        if (n < len) {
+            offset = &g_array_index(data->primitives, AdgPrimitiveOffset,
+                                    len - n - 1);
+            primitive[n]->org = offset->org < 0 ? NULL : base + offset->org;
+            primitive[n]->data = base + offset->data;
+        } else {
+            primitive[n]->org = NULL;
+            primitive[n]->data = NULL;
+        }
+    }
+
+    /* Save the last point in the current point */
+    data->cp_is_valid = data->last.data &&
+                        data->last.data->header.type != CPML_CLOSE;
+    if (data->cp_is_valid) {
+        CpmlPrimitiveType type = data->last.data->header.type;
+        size_t n_point = type == CPML_MOVE ? 1 : cpml_primitive_type_get_n_points(type) - 1;
+        cpml_pair_from_cairo(&data->cp, &data->last.data[n_point]);
+    }
+}
+
+static void
+_adg_scan(AdgPath *path, guint from)
+{
+    AdgPathPrivate *data;
+    cairo_path_t tail;
+    CpmlCursor cursor;
+    const cairo_path_data_t *org, *path_data;
+
+    data = path->data;
+
+    /* Scan only the data starting from @from, that must be the start
+     * of a segment: the previous primitives are already on the stack */
+    tail.status = CAIRO_STATUS_SUCCESS;
+    tail.data = (cairo_path_data_t *) (data->cairo.array)->data + from;
+    tail.num_data = (data->cairo.array)->len - from;
+
+    /* The cursor only reads offsets, so no segment or primitive
+     * struct is rebuilt for every step */
+    if (cpml_cursor_from_cairo(&cursor, &tail)) {
+        do {
+            path_data = cpml_cursor_get_data(&cursor);
+            org = cpml_cursor_get_org(&cursor);
+            if (path_data->header.type != CPML_MOVE && org != NULL)
+                _adg_push_primitive(path, org, path_data);
+        } while (cpml_cursor_next(&cursor));
+    }
+
+    _adg_sync_primitives(path);
 }
 
 static void
 _adg_rescan(AdgPath *path)
+{
+    AdgPathPrivate *data = path->data;
+
+    g_array_set_size(data->primitives, 0);
+    _adg_scan(path, 0);
+}
+
+static void
+_adg_get_primitive(AdgPath *path, guint n_primitive, CpmlPrimitive *primitive)
 {
     AdgPathPrivate *data;
-    CpmlSegment segment;
-    CpmlPrimitive current, *last, *over;
+    cairo_path_data_t *base;
+    const AdgPrimitiveOffset *offset;
 
     data = path->data;
-    last = &data->last;
-    over = &data->over;
-
-    last->segment = NULL;
-    last->org = NULL;
-    last->data = NULL;
-    over->segment = NULL;
-    over->org = NULL;
-    over->data = NULL;
-
-    /* When no data is present, just bail out */
-    if (! cpml_segment_from_cairo(&segment, _adg_read_cairo_path(path))) {
-        data->cp_is_valid = FALSE;
+    base = (cairo_path_data_t *) (data->cairo.array)->data;
+    offset = &g_array_index(data->primitives, AdgPrimitiveOffset, n_primitive);
+
+    primitive->segment = NULL;
+    primitive->org = offset->org < 0 ? NULL : base + offset->org;
+    primitive->data = base + offset->data;
+}
+
+static void
+_adg_rebase_primitives(AdgPath *path, const cairo_path_data_t *old_base)
+{
+    AdgPathPrivate *data;
+    cairo_path_data_t *base;
+    CpmlPrimitive *primitive[2];
+    guint n;
+
+    data = path->data;
+    base = (cairo_path_data_t *) (data->cairo.array)->data;
+    primitive[0] = &data->last;
+    primitive[1] = &data->over;
+
+    /* Primitive offsets are relative, but last and over must be
+     * remapped: the current point is kept as is */
+    for (n = 0; n < 2; ++n) {
+        if (primitive[n]->org != NULL)
+            primitive[n]->org = base + (primitive[n]->org - old_base);
+        if (primitive[n]->data != NULL)
+            primitive[n]->data = base + (primitive[n]->data - old_base);
+    }
+}
+
+static void
+_adg_unshare(AdgPath *path)
+{
+    AdgPathPrivate *data;
+    GArray *array, *primitives;
+    const cairo_path_data_t *old_base;
+
+    data = path->data;
+    if (data->shared == NULL)
         return;
+
+    /* If there are other owners, this path must get its own copy
+     * before being modified. The copy is done before releasing the
+     * shared buffers, so they cannot be freed in the meantime. */
+    if (g_atomic_int_get(data->shared) > 1) {
+        array = data->cairo.array;
+        primitives = data->primitives;
+        old_base = (const cairo_path_data_t *) array->data;
+
+        data->cairo.array = g_array_sized_new(FALSE, FALSE,
+                                              sizeof(cairo_path_data_t),
+                                              array->len);
+        g_array_append_vals(data->cairo.array, array->data, array->len);
+        data->primitives = g_array_sized_new(FALSE, FALSE,
+                                             sizeof(AdgPrimitiveOffset),
+                                             primitives->len);
+        g_array_append_vals(data->primitives,
+                            primitives->data, primitives->len);
+
+        _adg_rebase_primitives(path, old_base);
+
+        if (! g_atomic_int_dec_and_test(data->shared)) {
+            data->shared = NULL;
+            return;
+        }
+
+        /* The other owners went away while copying */
+        g_array_free(array, TRUE);
+        g_array_free(primitives, TRUE);
     }
 
-    do {
-        cpml_primitive_from_segment(&current, &segment);
-        do {
-            cpml_primitive_copy(over, last);
-            cpml_primitive_copy(last, &current);
-        } while (cpml_primitive_next(&current));
-    } while (cpml_segment_next(&segment));
+    /* This is the last owner: the buffers can be taken over */
+    g_free(data->shared);
+    data->shared = NULL;
+}
 
-    /* Save the last point in the current point */
-    data->cp_is_valid = last->data && last->data->header.type != CPML_CLOSE;
-    if (data->cp_is_valid) {
-        CpmlPrimitiveType type = last->data->header.type;
-        size_t n = type == CPML_MOVE ? 1 : cpml_primitive_type_get_n_points(type) - 1;
-        cpml_pair_from_cairo(&data->cp, &last->data[n]);
+static void
+_adg_append_data(AdgPath *path, const cairo_path_data_t *path_data,
+                 guint num_data)
+{
+    AdgPathPrivate *data;
+    const cairo_path_data_t *base;
+    cairo_path_data_t *copy;
+    guint from;
+
+    _adg_unshare(path);
+    data = path->data;
+    from = (data->cairo.array)->len;
+    base = (const cairo_path_data_t *) (data->cairo.array)->data;
+
+    /* The source data can be shared with path itself, e.g. when
+     * appending a path to itself: the append could relocate it */
+    if (path_data >= base && path_data < base + from) {
+        copy = g_memdup(path_data, num_data * sizeof(cairo_path_data_t));
+        path_data = copy;
+    } else {
+        copy = NULL;
     }
+
+    _adg_clear_parent((AdgModel *) path);
+    data->cairo.array = g_array_append_vals(data->cairo.array,
+                                            path_data, num_data);
+
+    /* Appended data starting with a CPML_MOVE does not interact with
+     * the existing segments, so only the new data must be scanned.
+     * Otherwise, fallback to a full rescan. */
+    if (num_data > 0 && path_data->header.type == CPML_MOVE)
+        _adg_scan(path, from);
+    else
+        _adg_rescan(path);
+
+    g_free(copy);
 }
 
 static void
 _adg_append_primitive(AdgPath *path, CpmlPrimitive *current)
 {
     AdgPathPrivate *data;
+    AdgTrailPrivate *trail_data;
     cairo_path_data_t *path_data;
     CpmlPrimitiveType type;
+    CpmlExtents extents;
+    gboolean is_incremental;
     int length;
-    gconstpointer old_data;
-    gpointer new_data;
 
+    _adg_unshare(path);
     data = path->data;
+    trail_data = ((AdgTrail *) path)->data;
     path_data = current->data;
     length = path_data->header.length;
     type = path_data->header.type;
 
+    /* A pending operation modifies the primitives already in the path,
+     * so only a plain append can reuse the previous extents */
+    is_incremental = trail_data->extents.is_defined &&
+                     data->operation.action == ADG_ACTION_NONE;
+    if (is_incremental) {
+        cpml_extents_copy(&extents, &trail_data->extents);
+        is_incremental = _adg_add_extents(path, path_data, &extents);
+    }
+
+    /* An operation appends its own primitive before this one: reserve
+     * the room for both now, so the array is reallocated at most once
+     * and the primitives are computed directly in their final place */
+    if (data->operation.action != ADG_ACTION_NONE) {
+        const cairo_path_data_t *old_base;
+        guint len;
+
+        old_base = (const cairo_path_data_t *) (data->cairo.array)->data;
+        len = (data->cairo.array)->len;
+        data->cairo.array = g_array_set_size(data->cairo.array,
+                                             len + length + 3);
+        (data->cairo.array)->len = len;
+        _adg_rebase_primitives(path, old_base);
+    }
+
     /* Execute any pending operation */
     _adg_do_operation(path, path_data);
 
     /* Append the path data to the internal path array */
-    old_data = (data->cairo.array)->data;
     data->cairo.array = g_array_append_vals(data->cairo.array,
                                             path_data, length);
-    new_data = (data->cairo.array)->data;
 
     /* Set path data to point to the recently appended cairo_path_data_t
      * primitive: the first struct is the header */
-    path_data = (cairo_path_data_t *) new_data +
+    path_data = (cairo_path_data_t *) (data->cairo.array)->data +
                 (data->cairo.array)->len - length;
 
-    if (type == CPML_MOVE) {
-        /* Remap last and over, but do not change their content */
-        _adg_primitive_remap(&data->last, new_data, &data->last, old_data);
-        _adg_primitive_remap(&data->over, new_data, &data->over, old_data);
-    } else {
-        /* Store the last primitive into over */
-        _adg_primitive_remap(&data->over, new_data, &data->last, old_data);
-
-        /* Set the last primitive for subsequent binary operations */
+    /* A CPML_MOVE does not change last and over, but it must be
+     * considered as the current point */
+    if (type != CPML_MOVE) {
         /* TODO: the assumption path_data - 1 is the last point is not true
          * e.g. when there are embedded data in primitives */
-        data->last.org = data->cp_is_valid ? path_data - 1 : NULL;
-        data->last.segment = NULL;
-        data->last.data = path_data;
+        _adg_push_primitive(path, data->cp_is_valid ? path_data - 1 : NULL,
+                            path_data);
     }
 
+    /* Remap last and over on the (possibly relocated) array */
+    _adg_sync_primitives(path);
+
     data->cp_is_valid = type != CPML_CLOSE;
     if (data->cp_is_valid) {
         /* Save the last point in the current point */
@@ -1280,6 +2280,70 @@ _adg_append_primitive(AdgPath *path, CpmlPrimitive *current)
 
     /* Invalidate cairo_path: should be recomputed */
     _adg_clear_parent((AdgModel *) path);
+
+    if (is_incremental)
+        cpml_extents_copy(&trail_data->extents, &extents);
+}
+
+static void
+_adg_append_pairs(AdgPath *path, CpmlPrimitiveType type,
+                  const CpmlPair *pairs, guint n_pairs)
+{
+    AdgPathPrivate *data;
+    cairo_path_data_t org, buffer[3];
+    CpmlPrimitive primitive;
+    guint n;
+
+    /* A lightweight adg_path_append() for the primitives generated
+     * internally: no argument parsing and no heap allocations */
+    data = path->data;
+    cpml_pair_to_cairo(&data->cp, &org);
+    buffer[0].header.type = type;
+    buffer[0].header.length = n_pairs + 1;
+    for (n = 0; n < n_pairs; ++n)
+        cpml_pair_to_cairo(&pairs[n], &buffer[n + 1]);
+
+    primitive.segment = NULL;
+    primitive.org = &org;
+    primitive.data = buffer;
+    _adg_append_primitive(path, &primitive);
+}
+
+static gboolean
+_adg_add_extents(AdgPath *path, cairo_path_data_t *path_data,
+                 CpmlExtents *extents)
+{
+    AdgPathPrivate *data;
+    cairo_path_data_t org;
+    CpmlPrimitive primitive;
+    CpmlExtents primitive_extents;
+
+    data = path->data;
+
+    switch ((int) path_data->header.type) {
+    case CPML_MOVE:
+    case CPML_CLOSE:
+        /* The extents include only the points of drawn primitives, and
+         * a CPML_CLOSE draws a line between two already included points */
+        return TRUE;
+    case CPML_LINE:
+    case CPML_ARC:
+    case CPML_CURVE:
+        if (! data->cp_is_valid)
+            return FALSE;
+        break;
+    default:
+        return FALSE;
+    }
+
+    cpml_pair_to_cairo(&data->cp, &org);
+    primitive.segment = NULL;
+    primitive.org = &org;
+    primitive.data = path_data;
+
+    cpml_primitive_put_extents(&primitive, &primitive_extents);
+    cpml_extents_add(extents, &primitive_extents);
+    return TRUE;
 }
 
 static void
@@ -1363,7 +2427,10 @@ _adg_append_operation(AdgPath *path, gint action, ...)
         cairo_path_data_t *path_data;
         CpmlSegment segment;
         CpmlPrimitive current;
+        gboolean cp_is_valid;
+        CpmlPair cp;
 
+        _adg_unshare(path);
         length = data->cairo.array->len;
 
         /* Ensure the close path primitive is not the only data */
@@ -1387,9 +2454,14 @@ _adg_append_operation(AdgPath *path, gint action, ...)
         path_data[length - 1].header.length = 2;
         path_data[length] = *current.org;
 
+        g_array_index(data->primitives, AdgPrimitiveOffset,
+                      data->primitives->len - 1).org = length - 2;
+        cp_is_valid = data->cp_is_valid;
+        cpml_pair_copy(&cp, &data->cp);
+        _adg_sync_primitives(path);
+        data->cp_is_valid = cp_is_valid;
+        cpml_pair_copy(&data->cp, &cp);
         data->last.segment = &segment;
-        data->last.org = &path_data[length - 2];
-        data->last.data = &path_data[length - 1];
 
         _adg_do_action(path, real_action, &current);
     }
@@ -1480,62 +2552,72 @@ _adg_do_chamfer(AdgPath *path, CpmlPrimitive *current)
 
     /* Add the chamfer line */
     data->operation.action = ADG_ACTION_NONE;
-    adg_path_append(path, CPML_LINE, &pair);
+    _adg_append_pairs(path, CPML_LINE, &pair, 1);
 }
 
 static void
 _adg_do_fillet(AdgPath *path, CpmlPrimitive *current)
 {
     AdgPathPrivate *data;
-    CpmlPrimitive *last, *current_dup, *last_dup;
+    CpmlPrimitive *last, current_dup, last_dup;
+    cairo_path_data_t current_buffer[5], last_buffer[5];
+    CpmlPrimitive *p_current, *p_last;
     gdouble radius, offset, pos;
     CpmlPair center, vector, p[3];
 
     data = path->data;
     last = &data->last;
-    current_dup = cpml_primitive_deep_dup(current);
-    last_dup = cpml_primitive_deep_dup(last);
     radius = data->operation.data.fillet.radius;
-    offset = _adg_is_convex(last_dup, current_dup) ? -radius : radius;
-
-    /* Find the center of the fillet from the intersection between
-     * the last and current primitives offseted by radius */
-    cpml_primitive_offset(current_dup, offset);
-    cpml_primitive_offset(last_dup, offset);
-    if (cpml_primitive_put_intersections(current_dup, last_dup, 1, &center) == 0) {
-        g_warning(_("%s: fillet with radius of %lf is not applicable here"),
-                  G_STRLOC, radius);
-        g_free(current_dup);
-        g_free(last_dup);
-        return;
-    }
 
-    /* Compute the start point of the fillet */
-    pos = cpml_primitive_get_closest_pos(last_dup, &center);
-    cpml_primitive_put_vector_at(last_dup, pos, &vector);
-    cpml_vector_set_length(&vector, offset);
-    cpml_vector_normal(&vector);
-    p[0].x = center.x - vector.x;
-    p[0].y = center.y - vector.y;
-
-    /* Compute the mid point of the fillet */
-    cpml_pair_from_cairo(&vector, current->org);
-    vector.x -= center.x;
-    vector.y -= center.y;
-    cpml_vector_set_length(&vector, radius);
-    p[1].x = center.x + vector.x;
-    p[1].y = center.y + vector.y;
-
-    /* Compute the end point of the fillet */
-    pos = cpml_primitive_get_closest_pos(current_dup, &center);
-    cpml_primitive_put_vector_at(current_dup, pos, &vector);
-    cpml_vector_set_length(&vector, offset);
-    cpml_vector_normal(&vector);
-    p[2].x = center.x - vector.x;
-    p[2].y = center.y - vector.y;
-
-    g_free(current_dup);
-    g_free(last_dup);
+    /* Two lines, by far the most common case, are solved directly */
+    if (! _adg_fillet_lines(last, current, radius, p)) {
+        p_current = _adg_primitive_dup(&current_dup, current_buffer, current);
+        p_last = _adg_primitive_dup(&last_dup, last_buffer, last);
+        offset = _adg_is_convex(p_last, p_current) ? -radius : radius;
+
+        /* Find the center of the fillet from the intersection between
+         * the last and current primitives offseted by radius */
+        cpml_primitive_offset(p_current, offset);
+        cpml_primitive_offset(p_last, offset);
+        if (cpml_primitive_put_intersections(p_current, p_last, 1, &center) == 0) {
+            g_warning(_("%s: fillet with radius of %lf is not applicable here"),
+                      G_STRLOC, radius);
+            if (p_current != &current_dup)
+                g_free(p_current);
+            if (p_last != &last_dup)
+                g_free(p_last);
+            return;
+        }
+
+        /* Compute the start point of the fillet */
+        pos = cpml_primitive_get_closest_pos(p_last, &center);
+        cpml_primitive_put_vector_at(p_last, pos, &vector);
+        cpml_vector_set_length(&vector, offset);
+        cpml_vector_normal(&vector);
+        p[0].x = center.x - vector.x;
+        p[0].y = center.y - vector.y;
+
+        /* Compute the mid point of the fillet */
+        cpml_pair_from_cairo(&vector, current->org);
+        vector.x -= center.x;
+        vector.y -= center.y;
+        cpml_vector_set_length(&vector, radius);
+        p[1].x = center.x + vector.x;
+        p[1].y = center.y + vector.y;
+
+        /* Compute the end point of the fillet */
+        pos = cpml_primitive_get_closest_pos(p_current, &center);
+        cpml_primitive_put_vector_at(p_current, pos, &vector);
+        cpml_vector_set_length(&vector, offset);
+        cpml_vector_normal(&vector);
+        p[2].x = center.x - vector.x;
+        p[2].y = center.y - vector.y;
+
+        if (p_current != &current_dup)
+            g_free(p_current);
+        if (p_last != &last_dup)
+            g_free(p_last);
+    }
 
     /* Change the end point of the last primitive */
     cpml_primitive_set_point(last, -1, &p[0]);
@@ -1545,7 +2627,84 @@ _adg_do_fillet(AdgPath *path, CpmlPrimitive *current)
 
     /* Add the fillet arc */
     data->operation.action = ADG_ACTION_NONE;
-    adg_path_append(path, CPML_ARC, &p[1], &p[2]);
+    _adg_append_pairs(path, CPML_ARC, &p[1], 2);
+}
+
+static gboolean
+_adg_fillet_lines(const CpmlPrimitive *last, const CpmlPrimitive *current,
+                  gdouble radius, CpmlPair *p)
+{
+    CpmlPair p0, corner, p2;
+    CpmlVector u1, u2, bisector;
+    gdouble len1, len2, cosine, sine, tangent, distance;
+
+    if (last->data->header.type != CPML_LINE ||
+        current->data->header.type != CPML_LINE)
+        return FALSE;
+
+    cpml_pair_from_cairo(&p0, last->org);
+    cpml_pair_from_cairo(&corner, current->org);
+    cpml_primitive_put_point(current, -1, &p2);
+
+    u1.x = corner.x - p0.x;
+    u1.y = corner.y - p0.y;
+    u2.x = p2.x - corner.x;
+    u2.y = p2.y - corner.y;
+    len1 = cpml_pair_distance(&p0, &corner);
+    len2 = cpml_pair_distance(&corner, &p2);
+
+    /* Degenerated lines are left to the generic algorithm */
+    if (len1 == 0 || len2 == 0)
+        return FALSE;
+
+    u1.x /= len1;
+    u1.y /= len1;
+    u2.x /= len2;
+    u2.y /= len2;
+
+    /* Parallel lines also make the generic algorithm fail */
+    sine = fabs(u1.x * u2.y - u1.y * u2.x);
+    if (sine == 0)
+        return FALSE;
+
+    /* cosine is the cosine of the angle between the two lines, so
+     * the tangent points are at r / tan(angle / 2) from the corner */
+    cosine = - u1.x * u2.x - u1.y * u2.y;
+    tangent = radius * (1 + cosine) / sine;
+    p[0].x = corner.x - u1.x * tangent;
+    p[0].y = corner.y - u1.y * tangent;
+    p[2].x = corner.x + u2.x * tangent;
+    p[2].y = corner.y + u2.y * tangent;
+
+    /* The center lies on the bisector at r / sin(angle / 2) from the
+     * corner and the mid point is at r from the center */
+    bisector.x = u2.x - u1.x;
+    bisector.y = u2.y - u1.y;
+    distance = radius / sqrt((1 - cosine) / 2) - radius;
+    cpml_vector_set_length(&bisector, distance);
+    p[1].x = corner.x + bisector.x;
+    p[1].y = corner.y + bisector.y;
+
+    return TRUE;
+}
+
+static CpmlPrimitive *
+_adg_primitive_dup(CpmlPrimitive *dst, cairo_path_data_t *buffer,
+                   const CpmlPrimitive *src)
+{
+    int length = src->data->header.length;
+
+    /* Primitives with embedded data do not fit in the buffer */
+    if (length > 4)
+        return cpml_primitive_deep_dup(src);
+
+    buffer[0] = *src->org;
+    memcpy(buffer + 1, src->data, length * sizeof(cairo_path_data_t));
+    dst->segment = src->segment;
+    dst->org = buffer;
+    dst->data = buffer + 1;
+
+    return dst;
 }
 
 static gboolean
@@ -1582,45 +2741,182 @@ _adg_action_name(AdgAction action)
     return "undefined";
 }
 
+static void
+_adg_dup_named_pair(AdgModel *model, const gchar *name,
+                    CpmlPair *pair, gpointer user_data)
+{
+    adg_model_set_named_pair((AdgModel *) user_data, name, pair);
+}
+
 static void
 _adg_get_named_pair(AdgModel *model, const gchar *name,
                     CpmlPair *pair, gpointer user_data)
 {
-    GSList **named_pairs;
-    AdgNamedPair *named_pair;
+    AdgNamedPair named_pair;
+
+    named_pair.name = name;
+    named_pair.pair = *pair;
+
+    g_array_append_val((GArray *) user_data, named_pair);
+}
 
-    named_pairs = user_data;
+static void
+_adg_reflect_segment(cairo_path_data_t *dst, const cairo_path_data_t *src,
+                     gint num_data, const cairo_matrix_t *matrix)
+{
+    const cairo_path_data_t *src_data;
+    cairo_path_data_t *dst_data;
+    gdouble end_x, end_y;
+    gint n, length;
+    gsize n_points, n_point;
+
+    /* This is cpml_segment_reverse() followed by cpml_segment_transform()
+     * but the result is written in @dst in a single pass, without any
+     * temporary buffer. @src must be a sanitized segment that does not
+     * overlap @dst: a trailing CPML_CLOSE, if present, is kept last */
+    n = src->header.length;
+    memcpy(dst, src, n * sizeof(cairo_path_data_t));
+    end_x = src[1].point.x;
+    end_y = src[1].point.y;
+
+    if (src[num_data - 1].header.type == CPML_CLOSE) {
+        dst[num_data - 1] = src[num_data - 1];
+        dst_data = dst + num_data - 1;
+    } else {
+        dst_data = dst + num_data;
+    }
+
+    while (n < num_data) {
+        src_data = src + n;
+        if (src_data->header.type == CPML_CLOSE)
+            break;
+
+        n_points = cpml_primitive_type_get_n_points(src_data->header.type);
+        length = src_data->header.length;
+        n += length;
+        dst_data -= length;
+        dst_data->header.type = src_data->header.type;
+        dst_data->header.length = length;
+
+        for (n_point = 1; n_point < n_points; ++n_point) {
+            dst_data[n_points - n_point].point.x = end_x;
+            dst_data[n_points - n_point].point.y = end_y;
+            cairo_matrix_transform_point(matrix,
+                                         &dst_data[n_points - n_point].point.x,
+                                         &dst_data[n_points - n_point].point.y);
+            end_x = src_data[n_point].point.x;
+            end_y = src_data[n_point].point.y;
+        }
+
+        /* Copy also the embedded data, if any */
+        if (n_points < (gsize) length)
+            memcpy(dst_data + n_points, src_data + n_points,
+                   (length - n_points) * sizeof(cairo_path_data_t));
+    }
 
-    named_pair = g_new(AdgNamedPair, 1);
-    named_pair->name = name;
-    named_pair->pair = *pair;
+    dst->header.type = CPML_MOVE;
+    dst[1].point.x = end_x;
+    dst[1].point.y = end_y;
+    cairo_matrix_transform_point(matrix, &dst[1].point.x, &dst[1].point.y);
+}
 
-    *named_pairs = g_slist_prepend(*named_pairs, named_pair);
+static guint
+_adg_stitch_cell(gint64 x, gint64 y)
+{
+    /* Different cells can share the same hash: the end points found
+     * in a cell are always checked against the real distance */
+    return (guint) ((guint64) x * 73856093) ^ (guint) ((guint64) y * 19349663);
+}
+
+static gint
+_adg_stitch_lookup(GHashTable *cells, GArray *ends, GArray *segments,
+                   const CpmlPair *pair, gdouble tolerance, guint *n_end)
+{
+    const AdgStitchEnd *end;
+    const AdgStitchSegment *segment;
+    gdouble cell_size;
+    gint64 x, y, dx, dy;
+    gint n;
+
+    cell_size = tolerance > 0 ? tolerance : 1;
+    x = floor(pair->x / cell_size);
+    y = floor(pair->y / cell_size);
+
+    /* A matching point can lie in any of the neighbouring cells */
+    for (dx = -1; dx <= 1; ++dx) {
+        for (dy = -1; dy <= 1; ++dy) {
+            n = GPOINTER_TO_INT(g_hash_table_lookup(cells,
+                    GUINT_TO_POINTER(_adg_stitch_cell(x + dx, y + dy)))) - 1;
+            while (n >= 0) {
+                end = &g_array_index(ends, AdgStitchEnd, n);
+                segment = &g_array_index(segments, AdgStitchSegment, end->segment);
+                if (! segment->is_used &&
+                    cpml_pair_distance(pair, &segment->ends[end->n_end]) <= tolerance) {
+                    *n_end = end->n_end;
+                    return end->segment;
+                }
+                n = end->next;
+            }
+        }
+    }
+
+    return -1;
+}
+
+static void
+_adg_stitch_write(GArray *result, GArray *scratch,
+                  const AdgStitchSegment *segment,
+                  gboolean is_reversed, gboolean is_first)
+{
+    const cairo_path_data_t *src;
+    gint skip;
+    cairo_matrix_t identity;
+
+    if (is_reversed) {
+        cairo_matrix_init_identity(&identity);
+        g_array_set_size(scratch, segment->num_data);
+        _adg_reflect_segment((cairo_path_data_t *) scratch->data,
+                             segment->data, segment->num_data, &identity);
+        src = (const cairo_path_data_t *) scratch->data;
+    } else {
+        src = segment->data;
+    }
+
+    /* The leading CPML_MOVE is dropped when the segment continues
+     * the previous one */
+    skip = is_first ? 0 : src->header.length;
+    g_array_append_vals(result, src + skip, segment->num_data - skip);
 }
 
 static void
 _adg_dup_reverse_named_pairs(AdgModel *model, const cairo_matrix_t *matrix)
 {
-    AdgNamedPair *old_named_pair;
-    AdgNamedPair named_pair;
-    GSList *named_pairs;
+    GArray *named_pairs;
+    AdgNamedPair *named_pair;
+    GString *name;
+    CpmlPair pair;
+    guint n;
 
-    /* Populate named_pairs with all the named pairs of model */
-    named_pairs = NULL;
-    adg_model_foreach_named_pair(model, _adg_get_named_pair, &named_pairs);
+    /* Populate named_pairs with all the named pairs of model: a copy
+     * is needed because the new pairs are added to the same model.
+     * The names are interned quarks, so they can be safely kept */
+    named_pairs = g_array_new(FALSE, FALSE, sizeof(AdgNamedPair));
+    adg_model_foreach_named_pair(model, _adg_get_named_pair, named_pairs);
 
     /* Readd the pairs applying the reversing transformation matrix to
      * their coordinates and prepending a "-" to their name */
-    while (named_pairs) {
-        old_named_pair = named_pairs->data;
-
-        named_pair.name = g_strdup_printf("-%s", old_named_pair->name);
-        named_pair.pair = old_named_pair->pair;
-        cpml_pair_transform(&named_pair.pair, matrix);
+    name = g_string_new("-");
+    for (n = 0; n < named_pairs->len; ++ n) {
+        named_pair = &g_array_index(named_pairs, AdgNamedPair, n);
 
-        adg_model_set_named_pair(model, named_pair.name, &named_pair.pair);
+        g_string_truncate(name, 1);
+        g_string_append(name, named_pair->name);
+        pair = named_pair->pair;
+        cpml_pair_transform(&pair, matrix);
 
-        g_free((gpointer) named_pair.name);
-        named_pairs = g_slist_delete_link(named_pairs, named_pairs);
+        adg_model_set_named_pair(model, name->str, &pair);
     }
+
+    g_string_free(name, TRUE);
+    g_array_free(named_pairs, TRUE);
 }
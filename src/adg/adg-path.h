@@ -53,6 +53,7 @@ struct _AdgPathClass {
 
 GType           adg_path_get_type               (void);
 AdgPath *       adg_path_new                    (void);
+AdgPath *       adg_path_dup                    (AdgPath        *path);
 
 const CpmlPair *adg_path_get_current_point      (AdgPath        *path);
 gboolean        adg_path_has_current_point      (AdgPath        *path);
@@ -60,6 +61,15 @@ const CpmlPrimitive *
                 adg_path_last_primitive         (AdgPath        *path);
 const CpmlPrimitive *
                 adg_path_over_primitive         (AdgPath        *path);
+guint           adg_path_get_n_primitives       (AdgPath        *path);
+gboolean        adg_path_put_point              (AdgPath        *path,
+                                                 guint           n_primitive,
+                                                 gint            n_point,
+                                                 CpmlPair       *pair);
+gboolean        adg_path_set_point              (AdgPath        *path,
+                                                 guint           n_primitive,
+                                                 gint            n_point,
+                                                 const CpmlPair *pair);
 void            adg_path_append                 (AdgPath        *path,
                                                  gint            type,
                                                  ...);
@@ -69,6 +79,18 @@ void            adg_path_append_valist          (AdgPath        *path,
 void            adg_path_append_array           (AdgPath        *path,
                                                  CpmlPrimitiveType type,
                                                  const CpmlPair**pairs);
+void            adg_path_append_points          (AdgPath        *path,
+                                                 const guint8   *types,
+                                                 guint           n_types,
+                                                 const CpmlPair *pairs,
+                                                 const gdouble  *values);
+void            adg_path_append_coords          (AdgPath        *path,
+                                                 const guint8   *types,
+                                                 guint           n_types,
+                                                 const gdouble  *coords,
+                                                 guint           n_coords,
+                                                 const gdouble  *values,
+                                                 guint           n_values);
 void            adg_path_append_primitive       (AdgPath        *path,
                                                  const CpmlPrimitive
                                                                 *primitive);
@@ -78,6 +100,14 @@ void            adg_path_append_segment         (AdgPath        *path,
 void            adg_path_append_cairo_path      (AdgPath        *path,
                                                  const cairo_path_t
                                                                 *cairo_path);
+void            adg_path_append_boolean         (AdgPath        *path,
+                                                 const CpmlSegment
+                                                                *segment,
+                                                 const CpmlSegment
+                                                                *segment2,
+                                                 CpmlBooleanOperation
+                                                                operation,
+                                                 gdouble         tolerance);
 void            adg_path_append_trail           (AdgPath        *path,
                                                  AdgTrail       *trail);
 void            adg_path_remove_primitive       (AdgPath        *path);
@@ -129,6 +159,13 @@ void            adg_path_chamfer                (AdgPath        *path,
 void            adg_path_fillet                 (AdgPath        *path,
                                                  gdouble         radius);
 void            adg_path_join                   (AdgPath        *path);
+guint           adg_path_stitch                 (AdgPath        *path,
+                                                 gdouble         tolerance);
+void            adg_path_simplify               (AdgPath        *path,
+                                                 gdouble         tolerance,
+                                                 gboolean        fit_arcs);
+void            adg_path_fit_curves             (AdgPath        *path,
+                                                 gdouble         tolerance);
 void            adg_path_reflect                (AdgPath        *path,
                                                  const CpmlVector *vector);
 void            adg_path_reflect_explicit       (AdgPath        *path,
@@ -46,28 +46,34 @@
 
 #include "adg-internal.h"
 #include "adg-model.h"
+#include "adg-model-private.h"
 #include <string.h>
 
 #include "adg-point.h"
 
 
+/* Points linked to the same named pair share a single binding owned
+ * by the model, so the named pair is looked up only once per change */
 struct _AdgPoint {
-    CpmlPair     pair;
-    AdgModel    *model;
-    gchar       *name;
-    gboolean     up_to_date;
+    CpmlPair         pair;
+    AdgModel        *model;
+    GQuark           name;
+    AdgModelBinding *binding;
+    gboolean         up_to_date;
 };
 
 
 GType
 adg_point_get_type(void)
 {
-    static GType type = 0;
+    static gsize type = 0;
 
-    if (G_UNLIKELY(type == 0))
-        type = g_boxed_type_register_static("AdgPoint",
-                                            (GBoxedCopyFunc) adg_point_dup,
-                                            (GBoxedFreeFunc) adg_point_destroy);
+    if (g_once_init_enter(&type)) {
+        GType new_type = g_boxed_type_register_static("AdgPoint",
+                                                      (GBoxedCopyFunc) adg_point_dup,
+                                                      (GBoxedFreeFunc) adg_point_destroy);
+        g_once_init_leave(&type, new_type);
+    }
 
     return type;
 }
@@ -93,7 +99,9 @@ adg_point_new(void)
  * @src: an #AdgPoint
  *
  * Duplicates @src. This operation also adds a new reference
- * to the internal model if @src is linked to a named pair.
+ * to the internal model if @src is linked to a named pair: the
+ * resolved value of the named pair is shared between @src and the
+ * duplicate, so it is looked up only once.
  *
  * The returned value should be freed with adg_point_destroy()
  * when no longer needed.
@@ -109,11 +117,12 @@ adg_point_dup(const AdgPoint *src)
 
     g_return_val_if_fail(src != NULL, NULL);
 
-    if (src->model)
+    if (src->model) {
         g_object_ref(src->model);
+        ++ src->binding->refcount;
+    }
 
     point = g_memdup(src, sizeof(AdgPoint));
-    point->name = g_strdup(src->name);
 
     return point;
 }
@@ -154,17 +163,17 @@ adg_point_copy(AdgPoint *point, const AdgPoint *src)
     g_return_if_fail(point != NULL);
     g_return_if_fail(src != NULL);
 
-    if (src->model != NULL)
-        g_object_ref(src->model);
+    if (point == src)
+        return;
 
-    if (point->model != NULL)
-        g_object_unref(point->model);
+    if (src->model != NULL) {
+        g_object_ref(src->model);
+        ++ src->binding->refcount;
+    }
 
-    if (point->name != NULL)
-        g_free(point->name);
+    adg_point_unset(point);
 
     memcpy(point, src, sizeof(AdgPoint));
-    point->name = g_strdup(src->name);
 }
 
 /**
@@ -226,26 +235,28 @@ void
 adg_point_set_pair_from_model(AdgPoint *point,
                               AdgModel *model, const gchar *name)
 {
+    GQuark quark;
+
     g_return_if_fail(point != NULL);
     g_return_if_fail(ADG_IS_MODEL(model));
     g_return_if_fail(name != NULL);
 
+    quark = g_quark_from_string(name);
+
     /* Return if the new named pair is the same of the old one */
-    if (model == point->model && strcmp(point->name, name) == 0)
+    if (model == point->model && quark == point->name)
         return;
 
     g_object_ref(model);
 
-    if (point->model) {
-        /* Remove the old named pair */
-        g_object_unref(point->model);
-        g_free(point->name);
-    }
+    /* Remove the old named pair */
+    adg_point_unset(point);
 
-    /* Set the new named pair */
-    point->up_to_date = FALSE;
+    /* Set the new named pair: the binding is shared with
+     * the other points linked to the same named pair */
     point->model = model;
-    point->name = g_strdup(name);
+    point->name = quark;
+    point->binding = _adg_model_bind(model, quark);
 }
 
 /**
@@ -286,13 +297,14 @@ adg_point_unset(AdgPoint *point)
 
     if (point->model) {
         /* Remove the old named pair */
+        _adg_model_unbind(point->model, point->binding);
         g_object_unref(point->model);
-        g_free(point->name);
     }
 
     point->up_to_date = FALSE;
     point->model = NULL;
-    point->name = NULL;
+    point->name = 0;
+    point->binding = NULL;
 }
 
 /**
@@ -301,7 +313,9 @@ adg_point_unset(AdgPoint *point)
  *
  * Updates the internal #CpmlPair of @point. The internal
  * implementation is protected against multiple calls so it
- * can be called more times without harms.
+ * can be called more times without harms. The named pair is
+ * looked up only if its model has been modified after the last
+ * update of any point linked to the same named pair.
  *
  * Returns: <constant>TRUE</constant> if @point has been updated or <constant>FALSE</constant> on errors, i.e. when it is bound to a non-existent named pair.
  *
@@ -327,7 +341,7 @@ adg_point_update(AdgPoint *point)
         return FALSE;
     }
 
-    pair = adg_model_get_named_pair(model, point->name);
+    pair = _adg_model_resolve(model, point->binding);
     if (pair == NULL)
         return FALSE;
 
@@ -366,6 +380,33 @@ adg_point_get_pair(AdgPoint *point)
     return cpml_pair_dup(& point->pair);
 }
 
+/**
+ * adg_point_put_pair:
+ * @point: an #AdgPoint
+ * @pair: (out): the destination #CpmlPair
+ *
+ * Same as adg_point_get_pair() but stores the pair of @point in
+ * @pair instead of returning a newly allocated copy, so it can be
+ * used in loops without stressing the allocator. If the named pair
+ * bound to @point does not exist, @pair is left untouched.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> if the named pair does not exist.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_point_put_pair(AdgPoint *point, CpmlPair *pair)
+{
+    g_return_val_if_fail(point != NULL, FALSE);
+    g_return_val_if_fail(pair != NULL, FALSE);
+
+    if (! adg_point_update(point))
+        return FALSE;
+
+    cpml_pair_copy(pair, & point->pair);
+    return TRUE;
+}
+
 /**
  * adg_point_get_model:
  * @point: an #AdgPoint
@@ -402,7 +443,7 @@ const gchar *
 adg_point_get_name(const AdgPoint *point)
 {
     g_return_val_if_fail(point != NULL, NULL);
-    return point->name;
+    return g_quark_to_string(point->name);
 }
 
 /**
@@ -447,7 +488,7 @@ adg_point_equal(const AdgPoint *point1, const AdgPoint *point2)
 
     /* Handle points bound to named pairs */
     if (point1->model != NULL)
-        return g_strcmp0(point1->name, point2->name) == 0;
+        return point1->name == point2->name;
 
     /* Handle points with explicit coordinates */
     return cpml_pair_equal(&point1->pair, &point2->pair);
@@ -51,6 +51,8 @@ void            adg_point_invalidate            (AdgPoint       *point);
 void            adg_point_unset                 (AdgPoint       *point);
 gboolean        adg_point_update                (AdgPoint       *point);
 CpmlPair *      adg_point_get_pair              (AdgPoint       *point);
+gboolean        adg_point_put_pair              (AdgPoint       *point,
+                                                 CpmlPair       *pair);
 AdgModel *      adg_point_get_model             (const AdgPoint *point);
 const gchar *   adg_point_get_name              (const AdgPoint *point);
 gboolean        adg_point_equal                 (const AdgPoint *point1,
@@ -22,14 +22,24 @@
 
 G_BEGIN_DECLS
 
+typedef struct _AdgProjectionRecording    AdgProjectionRecording;
 typedef struct _AdgProjectionClassPrivate AdgProjectionClassPrivate;
 typedef struct _AdgProjectionPrivate      AdgProjectionPrivate;
 
+struct _AdgProjectionRecording {
+    AdgProjectionScheme  scheme;
+    cairo_matrix_t       matrix;
+    cairo_matrix_t       local;
+    AdgStyle            *styles[2];
+    cairo_surface_t     *surface;
+};
+
 struct _AdgProjectionClassPrivate {
     AdgProjectionScheme  scheme;
     AdgPath             *symbol;
     AdgPath             *axis;
     CpmlExtents          extents;
+    GSList              *recordings;
 };
 
 struct _AdgProjectionPrivate {
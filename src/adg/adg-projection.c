@@ -25,6 +25,13 @@
  * The #AdgProjection is an entity representing the standard symbol
  * of the projection scheme.
  *
+ * The symbols are identical on every drawing, so their rendering is
+ * recorded once for every scheme and device scale and replayed by all
+ * the projections of the process, regardless of the canvas they belong
+ * to. The recording is keyed on the styles resolved by the projection
+ * dresses: a style modified in place after the first rendering is not
+ * picked up.
+ *
  * Since: 1.0
  **/
 
@@ -44,10 +51,14 @@
 #include "adg-path.h"
 #include "adg-dress.h"
 #include "adg-param-dress.h"
+#include "adg-entity-private.h"
+#include "adg-trail-private.h"
 
 #include "adg-projection.h"
 #include "adg-projection-private.h"
 
+#include <string.h>
+
 
 G_DEFINE_TYPE(AdgProjection, adg_projection, ADG_TYPE_ENTITY)
 
@@ -72,6 +83,16 @@ static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
 static void             _adg_arrange_class      (AdgProjectionClass *projection_class,
                                                  AdgProjectionScheme scheme);
+static void             _adg_draw               (AdgEntity      *entity,
+                                                 cairo_t        *cr);
+static AdgProjectionRecording *
+                        _adg_get_recording      (AdgEntity      *entity,
+                                                 const AdgProjectionRecording *key);
+
+G_LOCK_DEFINE_STATIC(_adg_projection_class);
+
+/* Maximum number of schemes and device scales recorded at the same time */
+#define _ADG_MAX_RECORDINGS     4
 
 
 static void
@@ -126,6 +147,7 @@ adg_projection_class_init(AdgProjectionClass *klass)
     data_class->symbol = NULL;
     data_class->axis = NULL;
     data_class->extents.is_defined = FALSE;
+    data_class->recordings = NULL;
 
     klass->data_class = data_class;
 }
@@ -356,11 +378,16 @@ _adg_arrange(AdgEntity *entity)
     projection_class = ADG_PROJECTION_GET_CLASS(entity);
     data_class = projection_class->data_class;
 
+    /* The class data are shared by all the projections, that could
+     * be arranged on different threads by a parallel container */
+    G_LOCK(_adg_projection_class);
     _adg_arrange_class(projection_class, data->scheme);
     cpml_extents_copy(&extents, &data_class->extents);
+    G_UNLOCK(_adg_projection_class);
 
-    cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
-    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+    cpml_extents_transform_chained(&extents,
+                                   _adg_entity_get_local_matrix(entity),
+                                   _adg_entity_get_global_matrix(entity));
     adg_entity_set_extents(entity, &extents);
 }
 
@@ -445,6 +472,105 @@ _adg_arrange_class(AdgProjectionClass *projection_class,
 
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgProjectionPrivate *data;
+    AdgProjectionRecording key, *recording;
+    cairo_surface_t *surface;
+    gdouble x, y, x0, y0;
+
+    data = ((AdgProjection *) entity)->data;
+
+    cairo_transform(cr, _adg_entity_get_global_matrix(entity));
+    key.scheme = data->scheme;
+    cairo_get_matrix(cr, &key.matrix);
+    key.surface = NULL;
+    adg_matrix_copy(&key.local, _adg_entity_get_local_matrix(entity));
+    key.styles[0] = adg_entity_style(entity, data->symbol_dress);
+    key.styles[1] = adg_entity_style(entity, data->axis_dress);
+
+    G_LOCK(_adg_projection_class);
+    recording = _adg_get_recording(entity, &key);
+    surface = cairo_surface_reference(recording->surface);
+
+    /* The recording is valid up to a translation: get the offset
+     * by comparing where the symbol origin lands in device space */
+    x = key.local.x0;
+    y = key.local.y0;
+    cairo_matrix_transform_point(&key.matrix, &x, &y);
+    x0 = recording->local.x0;
+    y0 = recording->local.y0;
+    cairo_matrix_transform_point(&recording->matrix, &x0, &y0);
+    G_UNLOCK(_adg_projection_class);
+
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_set_source_surface(cr, surface, x - x0, y - y0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    cairo_surface_destroy(surface);
+}
+
+/* Returns the recording matching @key, creating it if not found.
+ * It must be called with the class lock held */
+static AdgProjectionRecording *
+_adg_get_recording(AdgEntity *entity, const AdgProjectionRecording *key)
+{
+    AdgProjectionClass *projection_class;
+    AdgProjectionClassPrivate *data_class;
+    AdgProjectionRecording *recording;
+    GSList *node, *last;
+    cairo_t *cr;
+
+    projection_class = ADG_PROJECTION_GET_CLASS(entity);
+    data_class = projection_class->data_class;
+
+    for (node = data_class->recordings; node; node = node->next) {
+        recording = node->data;
+        if (recording->scheme == key->scheme &&
+            recording->matrix.xx == key->matrix.xx &&
+            recording->matrix.yx == key->matrix.yx &&
+            recording->matrix.xy == key->matrix.xy &&
+            recording->matrix.yy == key->matrix.yy &&
+            recording->local.xx == key->local.xx &&
+            recording->local.yx == key->local.yx &&
+            recording->local.xy == key->local.xy &&
+            recording->local.yy == key->local.yy &&
+            memcmp(recording->styles, key->styles, sizeof(key->styles)) == 0) {
+            /* Move the hit on top of the list */
+            data_class->recordings = g_slist_remove_link(data_class->recordings, node);
+            data_class->recordings = g_slist_concat(node, data_class->recordings);
+            return recording;
+        }
+    }
+
+    recording = g_new(AdgProjectionRecording, 1);
+    *recording = *key;
+    recording->surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+
+    /* The class paths could have been built for another scheme */
+    _adg_arrange_class(projection_class, key->scheme);
+    cr = cairo_create(recording->surface);
+    cairo_set_matrix(cr, &recording->matrix);
+    _adg_draw(entity, cr);
+    cairo_destroy(cr);
+
+    data_class->recordings = g_slist_prepend(data_class->recordings, recording);
+
+    /* Drop the least recently used recording */
+    if (g_slist_length(data_class->recordings) > _ADG_MAX_RECORDINGS) {
+        last = g_slist_last(data_class->recordings);
+        data_class->recordings = g_slist_remove_link(data_class->recordings, last);
+        cairo_surface_destroy(((AdgProjectionRecording *) last->data)->surface);
+        g_free(last->data);
+        g_slist_free_1(last);
+    }
+
+    return recording;
+}
+
+static void
+_adg_draw(AdgEntity *entity, cairo_t *cr)
 {
     AdgProjectionClassPrivate *data_class;
     AdgProjectionPrivate *data;
@@ -453,13 +579,11 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     data_class = ADG_PROJECTION_GET_CLASS(entity)->data_class;
     data = ((AdgProjection *) entity)->data;
 
-    cairo_transform(cr, adg_entity_get_global_matrix(entity));
-
     if (data_class->symbol != NULL) {
-        cairo_path = adg_trail_get_cairo_path((AdgTrail *) data_class->symbol);
+        cairo_path = _adg_trail_get_cairo_path((AdgTrail *) data_class->symbol);
 
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, _adg_entity_get_local_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
@@ -472,10 +596,10 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     if (data_class->axis != NULL) {
         const gdouble dashes[] = { 5, 2, 1, 2 };
 
-        cairo_path = adg_trail_get_cairo_path((AdgTrail *) data_class->axis);
+        cairo_path = _adg_trail_get_cairo_path((AdgTrail *) data_class->axis);
 
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, _adg_entity_get_local_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
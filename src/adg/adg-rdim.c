@@ -52,6 +52,7 @@
 #include "adg-dim.h"
 #include "adg-dim-private.h"
 #include <math.h>
+#include "adg-entity-private.h"
 
 #include "adg-rdim.h"
 #include "adg-rdim-private.h"
@@ -72,9 +73,11 @@ static void             _adg_dispose            (GObject        *object);
 static void             _adg_global_changed     (AdgEntity      *entity);
 static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_invalidate         (AdgEntity      *entity);
+static void             _adg_geometry_changed   (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
 static gchar *          _adg_default_value      (AdgDim         *dim);
 static gboolean         _adg_compute_geometry   (AdgDim         *dim);
 static void             _adg_update_entities    (AdgRDim        *rdim);
@@ -103,8 +106,10 @@ adg_rdim_class_init(AdgRDimClass *klass)
     entity_class->global_changed = _adg_global_changed;
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
+    entity_class->geometry_changed = _adg_geometry_changed;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
 
     dim_class->default_value = _adg_default_value;
     dim_class->compute_geometry = _adg_compute_geometry;
@@ -146,9 +151,12 @@ adg_rdim_init(AdgRDim *rdim)
 
     adg_dim_style_set_number_format(dim_style, "R%g");
 
-    adg_entity_set_style((AdgEntity *) rdim,
-                         ADG_DRESS_DIMENSION,
-                         (AdgStyle *) dim_style);
+    /* Every instance shares the same tweaked style */
+    style = adg_style_intern((AdgStyle *) dim_style);
+    g_object_unref(dim_style);
+
+    adg_entity_set_style((AdgEntity *) rdim, ADG_DRESS_DIMENSION, style);
+    g_object_unref(style);
 }
 
 static void
@@ -325,6 +333,22 @@ _adg_invalidate(AdgEntity *entity)
         _ADG_OLD_ENTITY_CLASS->invalidate(entity);
 }
 
+static void
+_adg_geometry_changed(AdgEntity *entity)
+{
+    AdgRDim *rdim = (AdgRDim *) entity;
+    AdgRDimPrivate *data = rdim->data;
+
+    /* Keep the trail and the marker: only their coordinates change */
+    _adg_clear_trail(rdim);
+
+    if (data->marker != NULL)
+        adg_entity_invalidate((AdgEntity *) data->marker);
+
+    if (_ADG_OLD_ENTITY_CLASS->geometry_changed != NULL)
+        _ADG_OLD_ENTITY_CLASS->geometry_changed(entity);
+}
+
 static void
 _adg_arrange(AdgEntity *entity)
 {
@@ -364,8 +388,8 @@ _adg_arrange(AdgEntity *entity)
     if (outside == ADG_THREE_STATE_UNKNOWN)
         outside = ADG_THREE_STATE_OFF;
 
-    global = adg_entity_get_global_matrix(entity);
-    local = adg_entity_get_local_matrix(entity);
+    global = _adg_entity_get_global_matrix(entity);
+    local = _adg_entity_get_local_matrix(entity);
     extents.is_defined = FALSE;
 
     cpml_pair_copy(&ref2, (CpmlPair *) adg_dim_get_ref2(dim));
@@ -446,6 +470,23 @@ _adg_arrange(AdgEntity *entity)
     adg_entity_set_extents(entity, &extents);
 }
 
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgRDimPrivate *data = ((AdgRDim *) entity)->data;
+    gsize usage;
+
+    usage = _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgRDimPrivate);
+
+    if (data->trail != NULL)
+        usage += adg_trail_get_memory_usage(data->trail);
+    if (data->marker != NULL)
+        usage += adg_entity_get_memory_usage((AdgEntity *) data->marker);
+
+    return usage;
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -473,7 +514,7 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     if (data->marker != NULL)
         adg_entity_render((AdgEntity *) data->marker, cr);
 
-    cairo_transform(cr, adg_entity_get_global_matrix(entity));
+    cairo_transform(cr, _adg_entity_get_global_matrix(entity));
     dress = adg_dim_style_get_line_dress(dim_style);
     adg_entity_apply_dress(entity, dress, cr);
 
@@ -0,0 +1,55 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __ADG_RENDER_CONTEXT_PRIVATE_H__
+#define __ADG_RENDER_CONTEXT_PRIVATE_H__
+
+
+G_BEGIN_DECLS
+
+/* Level of detail rule of an entity type */
+typedef struct {
+    gdouble             threshold;
+    AdgLodPolicy        policy;
+} AdgLodRule;
+
+struct _AdgRenderContext {
+    gint                refcount;
+    gboolean            show_extents;
+    gboolean            profiling;
+    gboolean            preview;
+    gboolean            state_tracking;
+    CpmlExtents         cull_region;
+    GHashTable         *lod_rules;
+};
+
+
+void            _adg_lod_rules_set              (GHashTable     **rules,
+                                                 GType            type,
+                                                 gdouble          threshold,
+                                                 AdgLodPolicy     policy);
+const AdgLodRule *
+                _adg_lod_rules_lookup           (GHashTable      *rules,
+                                                 GType            type);
+
+G_END_DECLS
+
+
+#endif /* __ADG_RENDER_CONTEXT_PRIVATE_H__ */
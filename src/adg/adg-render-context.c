@@ -0,0 +1,485 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-render-context
+ * @Section_Id:AdgRenderContext
+ * @title: AdgRenderContext
+ * @short_description: Options of a single rendering
+ *
+ * The #AdgRenderContext boxed type collects the options that
+ * affect how the entities are rendered: the extents overlay, the
+ * profiling, the preview quality, the state tracking mode, a cull
+ * region and a set of level of detail rules. Without a context
+ * the process wide settings (adg_switch_extents(),
+ * adg_switch_profiling(), adg_set_lod() and so on) are used.
+ *
+ * A context is bound to a #cairo_t with adg_set_render_context()
+ * or, more conveniently, for the duration of a single rendering
+ * with adg_entity_render_with_context(). Different threads can
+ * hence render, also the same drawing, with different options at
+ * the same time. A context can be shared by concurrent renderings
+ * as long as it is not changed while they are in progress.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgRenderContext:
+ *
+ * This is an opaque struct: all its fields are privates.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include "adg-entity.h"
+
+#include "adg-render-context.h"
+#include "adg-render-context-private.h"
+
+
+static cairo_user_data_key_t _adg_render_context_key;
+
+
+GType
+adg_render_context_get_type(void)
+{
+    static gsize context_type = 0;
+
+    if (g_once_init_enter(&context_type)) {
+        GType new_type = g_boxed_type_register_static("AdgRenderContext",
+                                                      (GBoxedCopyFunc) adg_render_context_ref,
+                                                      (GBoxedFreeFunc) adg_render_context_unref);
+        g_once_init_leave(&context_type, new_type);
+    }
+
+    return context_type;
+}
+
+/**
+ * adg_render_context_new:
+ *
+ * Creates a new render context with every option disabled, no
+ * cull region and no level of detail rule of its own.
+ *
+ * Returns: (transfer full): the newly created context, to be freed with adg_render_context_unref().
+ *
+ * Since: 1.0
+ **/
+AdgRenderContext *
+adg_render_context_new(void)
+{
+    AdgRenderContext *context = g_new0(AdgRenderContext, 1);
+
+    context->refcount = 1;
+    context->cull_region.is_defined = FALSE;
+
+    return context;
+}
+
+/**
+ * adg_render_context_ref:
+ * @context: an #AdgRenderContext
+ *
+ * Adds a reference to @context.
+ *
+ * Returns: @context
+ *
+ * Since: 1.0
+ **/
+AdgRenderContext *
+adg_render_context_ref(AdgRenderContext *context)
+{
+    g_return_val_if_fail(context != NULL, NULL);
+
+    g_atomic_int_inc(&context->refcount);
+
+    return context;
+}
+
+/**
+ * adg_render_context_unref:
+ * @context: an #AdgRenderContext
+ *
+ * Drops a reference from @context, freeing it when the last
+ * reference is dropped.
+ *
+ * Since: 1.0
+ **/
+void
+adg_render_context_unref(AdgRenderContext *context)
+{
+    g_return_if_fail(context != NULL);
+
+    if (! g_atomic_int_dec_and_test(&context->refcount))
+        return;
+
+    if (context->lod_rules != NULL)
+        g_hash_table_destroy(context->lod_rules);
+
+    g_free(context);
+}
+
+/**
+ * adg_render_context_switch_extents:
+ * @context: an #AdgRenderContext
+ * @state:   new extents state
+ *
+ * The same as adg_switch_extents() but limited to the renderings
+ * performed with @context. The global state is ignored by them.
+ *
+ * Since: 1.0
+ **/
+void
+adg_render_context_switch_extents(AdgRenderContext *context, gboolean state)
+{
+    g_return_if_fail(context != NULL);
+
+    context->show_extents = state;
+}
+
+/**
+ * adg_render_context_has_extents:
+ * @context: an #AdgRenderContext
+ *
+ * Checks if the extents of the entities are shown by the renderings
+ * performed with @context.
+ *
+ * Returns: <constant>TRUE</constant> if the extents are shown, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_render_context_has_extents(AdgRenderContext *context)
+{
+    g_return_val_if_fail(context != NULL, FALSE);
+
+    return context->show_extents;
+}
+
+/**
+ * adg_render_context_switch_profiling:
+ * @context: an #AdgRenderContext
+ * @state:   new profiling state
+ *
+ * The same as adg_switch_profiling() but limited to the renderings
+ * performed with @context. The global state is ignored by them.
+ * The statistics are still collected in the global report returned
+ * by adg_profiling_report().
+ *
+ * The arrange phase is not bound to any #cairo_t, so it is profiled
+ * only according to the global state.
+ *
+ * Since: 1.0
+ **/
+void
+adg_render_context_switch_profiling(AdgRenderContext *context, gboolean state)
+{
+    g_return_if_fail(context != NULL);
+
+    context->profiling = state;
+}
+
+/**
+ * adg_render_context_has_profiling:
+ * @context: an #AdgRenderContext
+ *
+ * Checks if the renderings performed with @context are profiled.
+ *
+ * Returns: <constant>TRUE</constant> if profiling is enabled, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_render_context_has_profiling(AdgRenderContext *context)
+{
+    g_return_val_if_fail(context != NULL, FALSE);
+
+    return context->profiling;
+}
+
+/**
+ * adg_render_context_switch_preview:
+ * @context: an #AdgRenderContext
+ * @state:   new preview state
+ *
+ * Enables the preview quality on the renderings performed with
+ * @context, as if adg_switch_preview() was called on their
+ * #cairo_t. A preview explicitly enabled on the #cairo_t is
+ * honored anyway.
+ *
+ * Since: 1.0
+ **/
+void
+adg_render_context_switch_preview(AdgRenderContext *context, gboolean state)
+{
+    g_return_if_fail(context != NULL);
+
+    context->preview = state;
+}
+
+/**
+ * adg_render_context_has_preview:
+ * @context: an #AdgRenderContext
+ *
+ * Checks if the preview quality is enabled on @context.
+ *
+ * Returns: <constant>TRUE</constant> if the preview quality is enabled, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_render_context_has_preview(AdgRenderContext *context)
+{
+    g_return_val_if_fail(context != NULL, FALSE);
+
+    return context->preview;
+}
+
+/**
+ * adg_render_context_switch_state_tracking:
+ * @context: an #AdgRenderContext
+ * @state:   new state tracking mode
+ *
+ * Enables the state tracking mode on the renderings performed with
+ * @context, as if adg_switch_state_tracking() was called on their
+ * #cairo_t. A mode explicitly enabled on the #cairo_t is honored
+ * anyway.
+ *
+ * Since: 1.0
+ **/
+void
+adg_render_context_switch_state_tracking(AdgRenderContext *context,
+                                         gboolean state)
+{
+    g_return_if_fail(context != NULL);
+
+    context->state_tracking = state;
+}
+
+/**
+ * adg_render_context_has_state_tracking:
+ * @context: an #AdgRenderContext
+ *
+ * Checks if the state tracking mode is enabled on @context.
+ *
+ * Returns: <constant>TRUE</constant> if the state tracking mode is enabled, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_render_context_has_state_tracking(AdgRenderContext *context)
+{
+    g_return_val_if_fail(context != NULL, FALSE);
+
+    return context->state_tracking;
+}
+
+/**
+ * adg_render_context_set_cull_region:
+ * @context: an #AdgRenderContext
+ * @region:  (allow-none): the region to render, in device space
+ *
+ * Limits the renderings performed with @context to the entities
+ * whose extents overlap @region. Unlike the clip region of cairo,
+ * that still requires the entities to be rendered and discarded by
+ * the backend, the entities outside @region are skipped altogether,
+ * children included. This is useful e.g. to render only a tile of a
+ * drawing. Pass <constant>NULL</constant> or an undefined region to
+ * disable the culling.
+ *
+ * The extents do not include the line width, so a margin of some
+ * device units is added to @region.
+ *
+ * Since: 1.0
+ **/
+void
+adg_render_context_set_cull_region(AdgRenderContext *context,
+                                   const CpmlExtents *region)
+{
+    g_return_if_fail(context != NULL);
+
+    if (region != NULL)
+        cpml_extents_copy(&context->cull_region, region);
+    else
+        context->cull_region.is_defined = FALSE;
+}
+
+/**
+ * adg_render_context_get_cull_region:
+ * @context: an #AdgRenderContext
+ *
+ * Gets the cull region of @context. See
+ * adg_render_context_set_cull_region() for details.
+ *
+ * Returns: (transfer none): the cull region, possibly undefined.
+ *
+ * Since: 1.0
+ **/
+const CpmlExtents *
+adg_render_context_get_cull_region(AdgRenderContext *context)
+{
+    g_return_val_if_fail(context != NULL, NULL);
+
+    return &context->cull_region;
+}
+
+/**
+ * adg_render_context_set_lod:
+ * @context:   an #AdgRenderContext
+ * @type:      an #AdgEntity derived type
+ * @threshold: the size threshold, in device units (usually pixels)
+ * @policy:    how to render entities below @threshold
+ *
+ * The same as adg_set_lod() but limited to the renderings performed
+ * with @context. The rules of @context are looked up before the
+ * global ones, so a rule with %ADG_LOD_POLICY_RENDER can be used to
+ * disable a global rule.
+ *
+ * Since: 1.0
+ **/
+void
+adg_render_context_set_lod(AdgRenderContext *context, GType type,
+                           gdouble threshold, AdgLodPolicy policy)
+{
+    g_return_if_fail(context != NULL);
+    g_return_if_fail(g_type_is_a(type, ADG_TYPE_ENTITY));
+
+    _adg_lod_rules_set(&context->lod_rules, type, threshold, policy);
+}
+
+/**
+ * adg_render_context_get_lod:
+ * @context:   an #AdgRenderContext
+ * @type:      an #AdgEntity derived type
+ * @threshold: (out) (allow-none): where to store the threshold
+ *
+ * Gets the level of detail rule of @context applied to the entities
+ * of @type. The global rules are not considered: see adg_get_lod()
+ * for them.
+ *
+ * Returns: the policy to apply or %ADG_LOD_POLICY_RENDER if @context does not have a rule for @type.
+ *
+ * Since: 1.0
+ **/
+AdgLodPolicy
+adg_render_context_get_lod(AdgRenderContext *context, GType type,
+                           gdouble *threshold)
+{
+    const AdgLodRule *rule;
+
+    g_return_val_if_fail(context != NULL, ADG_LOD_POLICY_RENDER);
+    g_return_val_if_fail(g_type_is_a(type, ADG_TYPE_ENTITY),
+                         ADG_LOD_POLICY_RENDER);
+
+    rule = _adg_lod_rules_lookup(context->lod_rules, type);
+
+    if (threshold != NULL)
+        *threshold = rule != NULL ? rule->threshold : 0;
+
+    return rule != NULL ? rule->policy : ADG_LOD_POLICY_RENDER;
+}
+
+/**
+ * adg_set_render_context:
+ * @cr:      a #cairo_t
+ * @context: (allow-none): the #AdgRenderContext to bind
+ *
+ * Binds @context to @cr, so every rendering performed on @cr uses
+ * its options. A new reference is added to @context, dropped when
+ * @cr is destroyed or when another context is bound. Pass
+ * <constant>NULL</constant> to go back to the global settings.
+ *
+ * Since: 1.0
+ **/
+void
+adg_set_render_context(cairo_t *cr, AdgRenderContext *context)
+{
+    g_return_if_fail(cr != NULL);
+
+    if (context != NULL)
+        adg_render_context_ref(context);
+
+    cairo_set_user_data(cr, &_adg_render_context_key, context,
+                        (cairo_destroy_func_t) adg_render_context_unref);
+}
+
+/**
+ * adg_get_render_context:
+ * @cr: a #cairo_t
+ *
+ * Gets the render context bound to @cr with adg_set_render_context().
+ *
+ * Returns: (transfer none): the bound context or <constant>NULL</constant> if the global settings are used.
+ *
+ * Since: 1.0
+ **/
+AdgRenderContext *
+adg_get_render_context(cairo_t *cr)
+{
+    g_return_val_if_fail(cr != NULL, NULL);
+
+    return cairo_get_user_data(cr, &_adg_render_context_key);
+}
+
+
+void
+_adg_lod_rules_set(GHashTable **rules, GType type,
+                   gdouble threshold, AdgLodPolicy policy)
+{
+    AdgLodRule *rule;
+
+    if (threshold <= 0) {
+        if (*rules != NULL)
+            g_hash_table_remove(*rules, GSIZE_TO_POINTER(type));
+        return;
+    }
+
+    if (*rules == NULL)
+        *rules = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+
+    rule = g_new(AdgLodRule, 1);
+    rule->threshold = threshold;
+    rule->policy = policy;
+    g_hash_table_insert(*rules, GSIZE_TO_POINTER(type), rule);
+}
+
+const AdgLodRule *
+_adg_lod_rules_lookup(GHashTable *rules, GType type)
+{
+    const AdgLodRule *rule;
+
+    if (rules == NULL)
+        return NULL;
+
+    /* Walk up the hierarchy up to AdgEntity */
+    while (type != G_TYPE_INVALID) {
+        rule = g_hash_table_lookup(rules, GSIZE_TO_POINTER(type));
+        if (rule != NULL)
+            return rule;
+        if (type == ADG_TYPE_ENTITY)
+            break;
+        type = g_type_parent(type);
+    }
+
+    return NULL;
+}
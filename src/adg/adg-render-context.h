@@ -0,0 +1,80 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_RENDER_CONTEXT_H__
+#define __ADG_RENDER_CONTEXT_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_RENDER_CONTEXT                 (adg_render_context_get_type())
+
+
+GType           adg_render_context_get_type     (void);
+AdgRenderContext *
+                adg_render_context_new          (void);
+AdgRenderContext *
+                adg_render_context_ref          (AdgRenderContext *context);
+void            adg_render_context_unref        (AdgRenderContext *context);
+void            adg_render_context_switch_extents
+                                                (AdgRenderContext *context,
+                                                 gboolean        state);
+gboolean        adg_render_context_has_extents  (AdgRenderContext *context);
+void            adg_render_context_switch_profiling
+                                                (AdgRenderContext *context,
+                                                 gboolean        state);
+gboolean        adg_render_context_has_profiling(AdgRenderContext *context);
+void            adg_render_context_switch_preview
+                                                (AdgRenderContext *context,
+                                                 gboolean        state);
+gboolean        adg_render_context_has_preview  (AdgRenderContext *context);
+void            adg_render_context_switch_state_tracking
+                                                (AdgRenderContext *context,
+                                                 gboolean        state);
+gboolean        adg_render_context_has_state_tracking
+                                                (AdgRenderContext *context);
+void            adg_render_context_set_cull_region
+                                                (AdgRenderContext *context,
+                                                 const CpmlExtents *region);
+const CpmlExtents *
+                adg_render_context_get_cull_region
+                                                (AdgRenderContext *context);
+void            adg_render_context_set_lod      (AdgRenderContext *context,
+                                                 GType           type,
+                                                 gdouble         threshold,
+                                                 AdgLodPolicy    policy);
+AdgLodPolicy    adg_render_context_get_lod      (AdgRenderContext *context,
+                                                 GType           type,
+                                                 gdouble        *threshold);
+void            adg_set_render_context          (cairo_t        *cr,
+                                                 AdgRenderContext *context);
+AdgRenderContext *
+                adg_get_render_context          (cairo_t        *cr);
+
+G_END_DECLS
+
+
+#endif /* __ADG_RENDER_CONTEXT_H__ */
@@ -29,6 +29,9 @@ struct _AdgRuledFillPrivate {
     AdgDress     line_dress;
     gdouble      spacing;
     gdouble      angle;
+    gboolean     has_vector_lines;
+    gdouble      tile_factor;
+    CpmlPair     pattern_size;
 };
 
 G_END_DECLS
@@ -26,6 +26,17 @@
  * adg_ruled_fill_set_spacing() method. The angle of the lines should
  * be changed with adg_ruled_fill_set_angle().
  *
+ * Being the lines periodic, the pattern is usually generated as a
+ * small tile, rendered at the device resolution, that is repeated
+ * over the whole area. The tile is shared by every entity using the
+ * same style and it is regenerated only when the spacing, the angle
+ * or the device scale change.
+ *
+ * Raster patterns are not well suited for vector backends such as
+ * PDF or SVG. Enabling the #AdgRuledFill:has-vector-lines property,
+ * the lines are stroked as real segments clipped to the filled area,
+ * giving small and resolution independent output.
+ *
  * Since: 1.0
  **/
 
@@ -44,6 +55,11 @@
 #include "adg-fill-style.h"
 #include "adg-dress.h"
 #include "adg-param-dress.h"
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-stroke.h"
+#include "adg-hatch.h"
+#include "adg-trail-private.h"
 
 #include "adg-ruled-fill.h"
 #include "adg-ruled-fill-private.h"
@@ -51,8 +67,7 @@
 #include <math.h>
 
 
-#define _ADG_OLD_STYLE_CLASS      ((AdgStyleClass *) adg_ruled_fill_parent_class)
-#define _ADG_OLD_FILL_STYLE_CLASS ((AdgFillStyleClass *) adg_ruled_fill_parent_class)
+#define _ADG_OLD_STYLE_CLASS  ((AdgStyleClass *) adg_ruled_fill_parent_class)
 
 
 G_DEFINE_TYPE(AdgRuledFill, adg_ruled_fill, ADG_TYPE_FILL_STYLE)
@@ -61,7 +76,8 @@ enum {
     PROP_0,
     PROP_LINE_DRESS,
     PROP_SPACING,
-    PROP_ANGLE
+    PROP_ANGLE,
+    PROP_HAS_VECTOR_LINES
 };
 
 
@@ -76,10 +92,25 @@ static void             _adg_set_property       (GObject        *object,
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
-static void             _adg_set_extents        (AdgFillStyle   *fill_style,
-                                                 const CpmlExtents *extents);
+static void             _adg_apply_vector       (AdgRuledFill   *ruled_fill,
+                                                 AdgEntity      *entity,
+                                                 const CpmlExtents *extents,
+                                                 cairo_t        *cr);
+static void             _adg_free_flat          (cairo_path_t   *flat,
+                                                 GArray         *array);
+static gdouble          _adg_device_factor      (cairo_t        *cr);
 static cairo_pattern_t *_adg_create_pattern     (AdgRuledFill   *ruled_fill,
                                                  AdgEntity      *entity,
+                                                 const CpmlExtents *extents,
+                                                 cairo_t        *cr,
+                                                 gdouble         factor);
+static cairo_pattern_t *_adg_create_tile        (AdgRuledFill   *ruled_fill,
+                                                 AdgStyle       *line_style,
+                                                 AdgEntity      *entity,
+                                                 cairo_t        *cr,
+                                                 const CpmlPair *spacing,
+                                                 gdouble         factor);
+static void             _adg_draw_tile          (const CpmlPair *spacing,
                                                  cairo_t        *cr);
 static void             _adg_draw_lines         (const CpmlPair *spacing,
                                                  const CpmlPair *size,
@@ -91,12 +122,10 @@ adg_ruled_fill_class_init(AdgRuledFillClass *klass)
 {
     GObjectClass *gobject_class;
     AdgStyleClass *style_class;
-    AdgFillStyleClass *fill_style_class;
     GParamSpec *param;
 
     gobject_class = (GObjectClass *) klass;
     style_class = (AdgStyleClass *) klass;
-    fill_style_class = (AdgFillStyleClass *) klass;
 
     g_type_class_add_private(klass, sizeof(AdgRuledFillPrivate));
 
@@ -105,8 +134,6 @@ adg_ruled_fill_class_init(AdgRuledFillClass *klass)
 
     style_class->apply = _adg_apply;
 
-    fill_style_class->set_extents = _adg_set_extents;
-
     param = adg_param_spec_dress("line-dress",
                                  P_("Line Dress"),
                                  P_("Dress to be used for rendering the lines"),
@@ -127,6 +154,13 @@ adg_ruled_fill_class_init(AdgRuledFillClass *klass)
                                0, G_PI, G_PI_4,
                                G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_ANGLE, param);
+
+    param = g_param_spec_boolean("has-vector-lines",
+                                 P_("Has Vector Lines"),
+                                 P_("Whether the lines must be stroked as vector segments clipped to the filled area instead of being painted with a raster pattern"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_HAS_VECTOR_LINES, param);
 }
 
 static void
@@ -139,6 +173,10 @@ adg_ruled_fill_init(AdgRuledFill *ruled_fill)
     data->line_dress = ADG_DRESS_LINE_FILL;
     data->angle = G_PI_4;
     data->spacing = 16;
+    data->has_vector_lines = FALSE;
+    data->tile_factor = 0;
+    data->pattern_size.x = 0;
+    data->pattern_size.y = 0;
 
     ruled_fill->data = data;
 }
@@ -159,6 +197,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_ANGLE:
         g_value_set_double(value, data->angle);
         break;
+    case PROP_HAS_VECTOR_LINES:
+        g_value_set_boolean(value, data->has_vector_lines);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -187,6 +228,9 @@ _adg_set_property(GObject *object, guint prop_id,
         data->angle = g_value_get_double(value);
         adg_fill_style_set_pattern((AdgFillStyle *) object, NULL);
         break;
+    case PROP_HAS_VECTOR_LINES:
+        data->has_vector_lines = g_value_get_boolean(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -323,20 +367,87 @@ adg_ruled_fill_get_angle(AdgRuledFill *ruled_fill)
     return data->angle;
 }
 
+/**
+ * adg_ruled_fill_switch_vector_lines:
+ * @ruled_fill: an #AdgRuledFill
+ * @new_state: the new state
+ *
+ * Sets the #AdgRuledFill:has-vector-lines property of @ruled_fill.
+ * When enabled, applying @ruled_fill strokes the lines inside the
+ * current path of the cairo context, leaving the path empty, instead
+ * of setting a raster pattern as source.
+ *
+ * Since: 1.0
+ **/
+void
+adg_ruled_fill_switch_vector_lines(AdgRuledFill *ruled_fill,
+                                   gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_RULED_FILL(ruled_fill));
+    g_object_set(ruled_fill, "has-vector-lines", new_state, NULL);
+}
+
+/**
+ * adg_ruled_fill_has_vector_lines:
+ * @ruled_fill: an #AdgRuledFill
+ *
+ * Gets the state of the #AdgRuledFill:has-vector-lines property.
+ *
+ * Returns: <constant>TRUE</constant> if the lines are stroked as vector segments, <constant>FALSE</constant> otherwise or on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_ruled_fill_has_vector_lines(AdgRuledFill *ruled_fill)
+{
+    AdgRuledFillPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_RULED_FILL(ruled_fill), FALSE);
+
+    data = ruled_fill->data;
+
+    return data->has_vector_lines;
+}
+
 
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 {
     AdgFillStyle *fill_style;
+    AdgRuledFillPrivate *data;
     cairo_pattern_t *pattern;
     const CpmlExtents *extents;
+    gdouble factor;
 
     fill_style = (AdgFillStyle *) style;
+    data = ((AdgRuledFill *) style)->data;
+    extents = adg_fill_style_get_fill_extents(fill_style, entity);
+
+    if (data->has_vector_lines) {
+        _adg_apply_vector((AdgRuledFill *) style, entity, extents, cr);
+        return;
+    }
+
     pattern = adg_fill_style_get_pattern(fill_style);
-    extents = adg_fill_style_get_extents(fill_style);
+    factor = _adg_device_factor(cr);
+
+    /* A tile is rendered at the device resolution, so it must be
+     * regenerated whenever the device scale changes. Any other
+     * pattern covers a fixed area and it is regenerated only when
+     * the entity to fill is wider than that area */
+    if (pattern != NULL) {
+        if (data->tile_factor > 0) {
+            if (data->tile_factor != factor)
+                pattern = NULL;
+        } else if (extents->size.x > data->pattern_size.x ||
+                   extents->size.y > data->pattern_size.y) {
+            pattern = NULL;
+        }
+    }
 
     if (pattern == NULL) {
-        pattern = _adg_create_pattern((AdgRuledFill *) style, entity, cr);
+        pattern = _adg_create_pattern((AdgRuledFill *) style, entity,
+                                      extents, cr, factor);
         if (pattern == NULL)
             return;
 
@@ -351,31 +462,118 @@ _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 }
 
 static void
-_adg_set_extents(AdgFillStyle *fill_style, const CpmlExtents *extents)
+_adg_apply_vector(AdgRuledFill *ruled_fill, AdgEntity *entity,
+                  const CpmlExtents *extents, cairo_t *cr)
 {
-    CpmlExtents old, new;
+    AdgRuledFillPrivate *data;
+    AdgTrail *trail;
+    GArray *array;
+    cairo_path_t *flat, shared;
+    CpmlSegment segment;
+    CpmlPair spacing, normal, *dest;
+    gdouble angle, length, distance, offset;
+    size_t n, n_spans;
 
-    cpml_extents_copy(&old, adg_fill_style_get_extents(fill_style));
+    data = ruled_fill->data;
+    spacing.x = cos(data->angle) * data->spacing;
+    spacing.y = sin(data->angle) * data->spacing;
 
-    /* The pattern is invalidated (and thus regenerated) only
-     * when the new extents are wider than the old ones */
-    if (old.size.x >= extents->size.x && old.size.y >= extents->size.y) {
-        new.org = extents->org;
-        new.size = old.size;
+    /* The lines are computed on the flattened area, so the spans
+     * are exact and the scanline does not need to approximate. A hatch
+     * renders its trail as is, so the flattened copy shared by all the
+     * entities showing that trail can be used instead of flattening
+     * the current path again */
+    trail = ADG_IS_HATCH(entity) ?
+        adg_stroke_get_trail((AdgStroke *) entity) : NULL;
+    array = NULL;
+    if (trail != NULL) {
+        array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+        shared.status = _adg_trail_append_flat(trail, cr,
+                                               adg_entity_get_combined_matrix(entity),
+                                               array) ?
+            CAIRO_STATUS_SUCCESS : CAIRO_STATUS_INVALID_PATH_DATA;
+        shared.data = (cairo_path_data_t *) array->data;
+        shared.num_data = array->len;
+        flat = &shared;
     } else {
-        cpml_extents_copy(&new, extents);
-        adg_fill_style_set_pattern(fill_style, NULL);
+        flat = cairo_copy_path_flat(cr);
     }
 
-    if (_ADG_OLD_FILL_STYLE_CLASS->set_extents)
-        _ADG_OLD_FILL_STYLE_CLASS->set_extents(fill_style, &new);
+    /* On errors, or when the lines are parallel to an axis (degenerated
+     * as in the pattern), the path is dropped without painting */
+    if (!extents->is_defined || spacing.x == 0 || spacing.y == 0 ||
+        flat->status != CAIRO_STATUS_SUCCESS ||
+        ! cpml_segment_from_cairo(&segment, flat)) {
+        _adg_free_flat(flat, array);
+        cairo_new_path(cr);
+        return;
+    }
+
+    /* Relative to the extents origin, as the pattern does, every line
+     * satisfies x/spacing.x + y/spacing.y = k + 1/2, that is any line
+     * is parallel to (spacing.x, -spacing.y). Along the normal
+     * (spacing.y, spacing.x) / length the lines are distance apart */
+    angle = atan2(-spacing.y, spacing.x);
+    length = sqrt(spacing.x * spacing.x + spacing.y * spacing.y);
+    normal.x = spacing.y / length;
+    normal.y = spacing.x / length;
+    distance = spacing.x * spacing.y / length;
+    offset = normal.x * extents->org.x + normal.y * extents->org.y +
+        distance / 2;
+
+    cairo_save(cr);
+    cairo_clip(cr);
+    adg_style_apply(adg_entity_style(entity, data->line_dress), entity, cr);
+
+    /* Every segment is scanned on its own: the clip trims the spans
+     * crossing holes or overlapping areas, honoring the fill rule */
+    dest = NULL;
+    do {
+        n_spans = cpml_segment_put_scanline_spans(&segment, angle,
+                                                  fabs(distance), offset,
+                                                  0, NULL);
+        if (n_spans == 0)
+            continue;
+
+        dest = g_renew(CpmlPair, dest, n_spans * 2);
+        n_spans = cpml_segment_put_scanline_spans(&segment, angle,
+                                                  fabs(distance), offset,
+                                                  n_spans, dest);
+        for (n = 0; n < n_spans; ++n) {
+            cairo_move_to(cr, dest[n * 2].x, dest[n * 2].y);
+            cairo_line_to(cr, dest[n * 2 + 1].x, dest[n * 2 + 1].y);
+        }
+    } while (cpml_segment_next(&segment));
+    g_free(dest);
+
+    cairo_stroke(cr);
+    cairo_restore(cr);
+    _adg_free_flat(flat, array);
+}
+
+static void
+_adg_free_flat(cairo_path_t *flat, GArray *array)
+{
+    if (array != NULL)
+        g_array_free(array, TRUE);
+    else
+        cairo_path_destroy(flat);
+}
+
+static gdouble
+_adg_device_factor(cairo_t *cr)
+{
+    cairo_matrix_t ctm;
+
+    cairo_get_matrix(cr, &ctm);
+
+    return sqrt(fabs(ctm.xx * ctm.yy - ctm.xy * ctm.yx));
 }
 
 static cairo_pattern_t *
-_adg_create_pattern(AdgRuledFill *ruled_fill, AdgEntity *entity, cairo_t *cr)
+_adg_create_pattern(AdgRuledFill *ruled_fill, AdgEntity *entity,
+                    const CpmlExtents *extents, cairo_t *cr, gdouble factor)
 {
-    AdgFillStyle *fill_style;
-    const CpmlExtents *extents;
     AdgRuledFillPrivate *data;
     AdgStyle *line_style;
     cairo_pattern_t *pattern;
@@ -383,15 +581,24 @@ _adg_create_pattern(AdgRuledFill *ruled_fill, AdgEntity *entity, cairo_t *cr)
     CpmlPair spacing;
     cairo_t *context;
 
-    fill_style = (AdgFillStyle *) ruled_fill;
-    extents = adg_fill_style_get_extents(fill_style);
-
     /* Check for valid extents */
     if (!extents->is_defined)
         return NULL;
 
     data = ruled_fill->data;
     line_style = adg_entity_style(entity, data->line_dress);
+
+    spacing.x = cos(data->angle) * data->spacing;
+    spacing.y = sin(data->angle) * data->spacing;
+
+    pattern = _adg_create_tile(ruled_fill, line_style, entity,
+                               cr, &spacing, factor);
+    if (pattern != NULL)
+        return pattern;
+
+    /* Fallback: render the lines on the whole extents */
+    data->tile_factor = 0;
+    data->pattern_size = extents->size;
     surface = cairo_surface_create_similar(cairo_get_target(cr),
                                            CAIRO_CONTENT_COLOR_ALPHA,
                                            extents->size.x, extents->size.y);
@@ -401,9 +608,6 @@ _adg_create_pattern(AdgRuledFill *ruled_fill, AdgEntity *entity, cairo_t *cr)
      * there is no need to hold another reference here */
     cairo_surface_destroy(surface);
 
-    spacing.x = cos(data->angle) * data->spacing;
-    spacing.y = sin(data->angle) * data->spacing;
-
     context = cairo_create(surface);
     adg_style_apply(line_style, entity, context);
     _adg_draw_lines(&spacing, &extents->size, context);
@@ -412,6 +616,89 @@ _adg_create_pattern(AdgRuledFill *ruled_fill, AdgEntity *entity, cairo_t *cr)
     return pattern;
 }
 
+static cairo_pattern_t *
+_adg_create_tile(AdgRuledFill *ruled_fill, AdgStyle *line_style,
+                 AdgEntity *entity, cairo_t *cr,
+                 const CpmlPair *spacing, gdouble factor)
+{
+    AdgRuledFillPrivate *data;
+    CpmlPair size;
+    gint width, height;
+    cairo_surface_t *surface;
+    cairo_pattern_t *pattern;
+    cairo_matrix_t matrix;
+    cairo_t *context;
+
+    /* The lines repeat every spacing->x horizontally and every
+     * spacing->y vertically: a tile smaller than a device pixel
+     * (lines almost parallel to an axis) cannot be used */
+    size.x = fabs(spacing->x);
+    size.y = fabs(spacing->y);
+    if (size.x * factor < 1 || size.y * factor < 1)
+        return NULL;
+
+    width = ceil(size.x * factor);
+    height = ceil(size.y * factor);
+    cairo_matrix_init_scale(&matrix, width / size.x, height / size.y);
+
+    surface = cairo_surface_create_similar(cairo_get_target(cr),
+                                           CAIRO_CONTENT_COLOR_ALPHA,
+                                           width, height);
+    context = cairo_create(surface);
+    cairo_transform(context, &matrix);
+    adg_style_apply(line_style, entity, context);
+
+    /* Dashes are not periodic with the tile */
+    if (cairo_get_dash_count(context) > 0) {
+        cairo_destroy(context);
+        cairo_surface_destroy(surface);
+        return NULL;
+    }
+
+    _adg_draw_tile(spacing, context);
+    cairo_destroy(context);
+
+    pattern = cairo_pattern_create_for_surface(surface);
+    cairo_surface_destroy(surface);
+    cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REPEAT);
+    cairo_pattern_set_matrix(pattern, &matrix);
+
+    data = ruled_fill->data;
+    data->tile_factor = factor;
+
+    return pattern;
+}
+
+static void
+_adg_draw_tile(const CpmlPair *spacing, cairo_t *cr)
+{
+    gdouble w, h, c, y1, y2;
+    gint k;
+
+    w = fabs(spacing->x);
+    h = fabs(spacing->y);
+
+    /* Every line satisfies x/w + y/h = k + 1/2. The lines just
+     * outside the tile are drawn too, so their stroke overflowing
+     * inside the tile is not lost */
+    for (k = -1; k <= 2; ++k) {
+        c = k + 0.5;
+        y1 = (c + 1) * h;
+        y2 = (c - 2) * h;
+
+        /* Spacings with different signs mirror the lines */
+        if (spacing->x * spacing->y < 0) {
+            y1 = h - y1;
+            y2 = h - y2;
+        }
+
+        cairo_move_to(cr, -w, y1);
+        cairo_line_to(cr, 2 * w, y2);
+    }
+
+    cairo_stroke(cr);
+}
+
 static void
 _adg_draw_lines(const CpmlPair *spacing, const CpmlPair *size, cairo_t *cr)
 {
@@ -63,6 +63,10 @@ gdouble         adg_ruled_fill_get_spacing      (AdgRuledFill   *ruled_fill);
 void            adg_ruled_fill_set_angle        (AdgRuledFill   *ruled_fill,
                                                  gdouble         angle);
 gdouble         adg_ruled_fill_get_angle        (AdgRuledFill   *ruled_fill);
+void            adg_ruled_fill_switch_vector_lines
+                                                (AdgRuledFill   *ruled_fill,
+                                                 gboolean        new_state);
+gboolean        adg_ruled_fill_has_vector_lines (AdgRuledFill   *ruled_fill);
 
 G_END_DECLS
 
@@ -0,0 +1,676 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/**
+ * SECTION:adg-snap-index
+ * @Section_Id:AdgSnapIndex
+ * @title: AdgSnapIndex
+ * @short_description: A k-d tree of snap points
+ *
+ * AdgSnapIndex is an opaque structure that collects the points a
+ * pointer can snap to from a set of models and allows to quickly
+ * look for the one nearest to a given point.
+ *
+ * The points are collected in model space from any model added with
+ * adg_snap_index_add_model(): the named pairs of every model and,
+ * for #AdgTrail instances, the endpoints and the midpoints of every
+ * primitive and the centers of the arcs. See #AdgSnapType.
+ *
+ * The points are kept in a 2-d tree, so adg_snap_index_nearest() is
+ * O(log n) on average. The index tracks its models: when a model
+ * changes, only the points of that model are collected again on the
+ * next query and appended to a small unsorted tail that is scanned
+ * linearly. The tree is rebuilt from scratch only when the tail and
+ * the stale points become a significant part of the index.
+ *
+ * The index keeps weak references to its models: a model can be
+ * freed at any time and its points are dropped.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgSnapIndex:
+ *
+ * This is an opaque struct: all its fields are privates.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgSnap:
+ * @type: the kind of the snap point
+ * @pair: the snap point, in model space
+ * @model: the model the point has been collected from
+ * @name: the name of the pair for #ADG_SNAP_NAMED_PAIR, <constant>NULL</constant> otherwise
+ *
+ * A point found by adg_snap_index_nearest(). @model is not
+ * referenced and @name is an interned string, so the struct does
+ * not need to be freed.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <stdlib.h>
+#include "adg-model.h"
+#include "adg-trail.h"
+
+#include "adg-snap-index.h"
+
+
+typedef struct _AdgSnapSource AdgSnapSource;
+typedef struct _AdgSnapEntry  AdgSnapEntry;
+
+struct _AdgSnapSource {
+    AdgSnapIndex *index;
+    AdgModel     *model;
+    gboolean      is_stale;
+};
+
+struct _AdgSnapEntry {
+    CpmlPair       pair;
+    AdgSnapType    type;
+    AdgSnapSource *source;
+    const gchar   *name;
+    gboolean       is_dead;
+};
+
+struct _AdgSnapIndex {
+    /* The first n_packed entries are the k-d tree, followed by the
+     * unsorted entries collected after the last repacking */
+    GArray      *entries;
+    guint        n_packed;
+    guint        n_dead;
+    GSList      *sources;
+};
+
+typedef struct {
+    const CpmlPair *pair;
+    guint           types;
+    gdouble         best;
+    AdgSnapEntry   *entry;
+} AdgSnapQuery;
+
+
+static AdgSnapSource *  _adg_add_source         (AdgSnapIndex   *index,
+                                                 AdgModel       *model);
+static AdgSnapSource *  _adg_find_source        (AdgSnapIndex   *index,
+                                                 AdgModel       *model);
+static void             _adg_free_source        (AdgSnapSource  *source,
+                                                 gboolean        disconnect);
+static void             _adg_source_stale       (AdgSnapSource  *source);
+static void             _adg_source_finalized   (gpointer        user_data,
+                                                 GObject        *model);
+static void             _adg_kill_entries       (AdgSnapIndex   *index,
+                                                 AdgSnapSource  *source);
+static void             _adg_refresh            (AdgSnapIndex   *index);
+static void             _adg_collect            (AdgSnapSource  *source);
+static void             _adg_collect_trail      (AdgSnapSource  *source,
+                                                 AdgTrail       *trail);
+static void             _adg_collect_named_pair (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 CpmlPair       *pair,
+                                                 gpointer        user_data);
+static void             _adg_append             (AdgSnapSource  *source,
+                                                 AdgSnapType     type,
+                                                 const CpmlPair *pair,
+                                                 const gchar    *name);
+static void             _adg_repack             (AdgSnapIndex   *index);
+static void             _adg_build              (AdgSnapEntry   *entries,
+                                                 guint           n_entries,
+                                                 guint           depth);
+static int              _adg_compare_x          (gconstpointer   p1,
+                                                 gconstpointer   p2);
+static int              _adg_compare_y          (gconstpointer   p1,
+                                                 gconstpointer   p2);
+static void             _adg_check              (AdgSnapQuery   *query,
+                                                 AdgSnapEntry   *entry);
+static void             _adg_search             (AdgSnapQuery   *query,
+                                                 AdgSnapEntry   *entries,
+                                                 guint           n_entries,
+                                                 guint           depth);
+
+
+GType
+adg_snap_index_get_type(void)
+{
+    static gsize type = 0;
+
+    if (g_once_init_enter(&type)) {
+        GType new_type = g_boxed_type_register_static("AdgSnapIndex",
+                                                      (GBoxedCopyFunc) adg_snap_index_dup,
+                                                      (GBoxedFreeFunc) adg_snap_index_destroy);
+        g_once_init_leave(&type, new_type);
+    }
+
+    return type;
+}
+
+/**
+ * adg_snap_index_new:
+ *
+ * Creates a new empty #AdgSnapIndex. The returned pointer should be
+ * freed with adg_snap_index_destroy() when no longer needed.
+ *
+ * Returns: a newly created #AdgSnapIndex
+ *
+ * Since: 1.0
+ **/
+AdgSnapIndex *
+adg_snap_index_new(void)
+{
+    AdgSnapIndex *index = g_new0(AdgSnapIndex, 1);
+
+    index->entries = g_array_new(FALSE, FALSE, sizeof(AdgSnapEntry));
+
+    return index;
+}
+
+/**
+ * adg_snap_index_dup:
+ * @src: an #AdgSnapIndex
+ *
+ * Duplicates @src. The new index tracks the same models of @src
+ * and their points are collected again on the first query. The
+ * returned value should be freed with adg_snap_index_destroy()
+ * when no longer needed.
+ *
+ * Returns: the duplicated #AdgSnapIndex struct or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgSnapIndex *
+adg_snap_index_dup(const AdgSnapIndex *src)
+{
+    AdgSnapIndex *index;
+    GSList *item;
+
+    g_return_val_if_fail(src != NULL, NULL);
+
+    index = adg_snap_index_new();
+
+    /* Keep the original insertion order */
+    for (item = src->sources; item != NULL; item = item->next)
+        _adg_add_source(index, ((AdgSnapSource *) item->data)->model);
+    index->sources = g_slist_reverse(index->sources);
+
+    return index;
+}
+
+/**
+ * adg_snap_index_destroy:
+ * @index: an #AdgSnapIndex
+ *
+ * Destroys @index. The indexed models are not affected.
+ *
+ * Since: 1.0
+ **/
+void
+adg_snap_index_destroy(AdgSnapIndex *index)
+{
+    GSList *item;
+
+    g_return_if_fail(index != NULL);
+
+    for (item = index->sources; item != NULL; item = item->next)
+        _adg_free_source(item->data, TRUE);
+
+    g_slist_free(index->sources);
+    g_array_free(index->entries, TRUE);
+    g_free(index);
+}
+
+/**
+ * adg_snap_index_add_model:
+ * @index: an #AdgSnapIndex
+ * @model: an #AdgModel
+ *
+ * Adds the snap points of @model to @index. From now on @index
+ * follows the changes of @model, so there is no need to add it
+ * again when it is modified. Adding a model already present in
+ * @index does nothing.
+ *
+ * The points are lazily collected on the next query, so adding a
+ * bunch of models in a row is O(1) for every addition.
+ *
+ * Since: 1.0
+ **/
+void
+adg_snap_index_add_model(AdgSnapIndex *index, AdgModel *model)
+{
+    g_return_if_fail(index != NULL);
+    g_return_if_fail(ADG_IS_MODEL(model));
+
+    if (_adg_find_source(index, model) == NULL)
+        _adg_add_source(index, model);
+}
+
+/**
+ * adg_snap_index_remove_model:
+ * @index: an #AdgSnapIndex
+ * @model: an #AdgModel
+ *
+ * Removes the snap points of @model from @index and stops
+ * tracking @model. Removing a model not present in @index does
+ * nothing.
+ *
+ * Since: 1.0
+ **/
+void
+adg_snap_index_remove_model(AdgSnapIndex *index, AdgModel *model)
+{
+    AdgSnapSource *source;
+
+    g_return_if_fail(index != NULL);
+    g_return_if_fail(ADG_IS_MODEL(model));
+
+    source = _adg_find_source(index, model);
+    if (source == NULL)
+        return;
+
+    _adg_kill_entries(index, source);
+    index->sources = g_slist_remove(index->sources, source);
+    _adg_free_source(source, TRUE);
+}
+
+/**
+ * adg_snap_index_size:
+ * @index: an #AdgSnapIndex
+ *
+ * Gets the number of snap points indexed by @index. The points of
+ * the models changed since the last query are collected before
+ * counting.
+ *
+ * Returns: the number of indexed points.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_snap_index_size(AdgSnapIndex *index)
+{
+    g_return_val_if_fail(index != NULL, 0);
+
+    _adg_refresh(index);
+
+    return index->entries->len - index->n_dead;
+}
+
+/**
+ * adg_snap_index_nearest:
+ * @index: an #AdgSnapIndex
+ * @pair: the point to check, in model space
+ * @max_distance: the maximum allowed distance or a negative value for no limit
+ * @types: the or-ed #AdgSnapType flags of the points to consider
+ * @snap: (out) (allow-none): where to store the point found
+ *
+ * Looks for the snap point of @index nearest to @pair, among the
+ * ones whose kind is in @types and whose distance from @pair is not
+ * greater than @max_distance. If a point is found and @snap is not
+ * <constant>NULL</constant>, its data is stored in @snap.
+ *
+ * When two points are at the same distance, which one is returned
+ * is undefined.
+ *
+ * Returns: <constant>TRUE</constant> if a point has been found, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_snap_index_nearest(AdgSnapIndex *index, const CpmlPair *pair,
+                       gdouble max_distance, guint types, AdgSnap *snap)
+{
+    AdgSnapQuery query;
+    AdgSnapEntry *entries;
+    guint n;
+
+    g_return_val_if_fail(index != NULL, FALSE);
+    g_return_val_if_fail(pair != NULL, FALSE);
+
+    _adg_refresh(index);
+
+    query.pair = pair;
+    query.types = types;
+    query.best = max_distance < 0 ? G_MAXDOUBLE : max_distance * max_distance;
+    query.entry = NULL;
+
+    entries = (AdgSnapEntry *) index->entries->data;
+    _adg_search(&query, entries, index->n_packed, 0);
+    for (n = index->n_packed; n < index->entries->len; ++n)
+        _adg_check(&query, &entries[n]);
+
+    if (query.entry == NULL)
+        return FALSE;
+
+    if (snap != NULL) {
+        snap->type = query.entry->type;
+        snap->pair = query.entry->pair;
+        snap->model = query.entry->source->model;
+        snap->name = query.entry->name;
+    }
+
+    return TRUE;
+}
+
+
+static AdgSnapSource *
+_adg_add_source(AdgSnapIndex *index, AdgModel *model)
+{
+    AdgSnapSource *source = g_new(AdgSnapSource, 1);
+
+    source->index = index;
+    source->model = model;
+    source->is_stale = TRUE;
+    g_signal_connect_swapped(model, "changed",
+                             G_CALLBACK(_adg_source_stale), source);
+    g_signal_connect_swapped(model, "clear",
+                             G_CALLBACK(_adg_source_stale), source);
+    g_signal_connect_swapped(model, "set-named-pair",
+                             G_CALLBACK(_adg_source_stale), source);
+    g_object_weak_ref((GObject *) model, _adg_source_finalized, source);
+
+    index->sources = g_slist_prepend(index->sources, source);
+
+    return source;
+}
+
+static AdgSnapSource *
+_adg_find_source(AdgSnapIndex *index, AdgModel *model)
+{
+    GSList *item;
+
+    for (item = index->sources; item != NULL; item = item->next)
+        if (((AdgSnapSource *) item->data)->model == model)
+            return item->data;
+
+    return NULL;
+}
+
+static void
+_adg_free_source(AdgSnapSource *source, gboolean disconnect)
+{
+    if (disconnect) {
+        g_signal_handlers_disconnect_by_func(source->model,
+                                             _adg_source_stale, source);
+        g_object_weak_unref((GObject *) source->model,
+                            _adg_source_finalized, source);
+    }
+
+    g_free(source);
+}
+
+static void
+_adg_source_stale(AdgSnapSource *source)
+{
+    source->is_stale = TRUE;
+}
+
+static void
+_adg_source_finalized(gpointer user_data, GObject *model)
+{
+    AdgSnapSource *source = user_data;
+    AdgSnapIndex *index = source->index;
+
+    _adg_kill_entries(index, source);
+    index->sources = g_slist_remove(index->sources, source);
+    _adg_free_source(source, FALSE);
+}
+
+static void
+_adg_kill_entries(AdgSnapIndex *index, AdgSnapSource *source)
+{
+    AdgSnapEntry *entry;
+    guint n;
+
+    for (n = 0; n < index->entries->len; ++n) {
+        entry = &g_array_index(index->entries, AdgSnapEntry, n);
+        if (entry->source == source && ! entry->is_dead) {
+            entry->is_dead = TRUE;
+            entry->source = NULL;
+            ++ index->n_dead;
+        }
+    }
+}
+
+static void
+_adg_refresh(AdgSnapIndex *index)
+{
+    AdgSnapSource *source;
+    AdgSnapEntry *entry;
+    GSList *item;
+    gboolean is_stale;
+    guint n, n_tail;
+
+    is_stale = FALSE;
+    for (item = index->sources; item != NULL; item = item->next)
+        is_stale = is_stale || ((AdgSnapSource *) item->data)->is_stale;
+
+    if (! is_stale)
+        return;
+
+    /* Mark the entries of the stale sources as dead in a single pass */
+    for (n = 0; n < index->entries->len; ++n) {
+        entry = &g_array_index(index->entries, AdgSnapEntry, n);
+        if (! entry->is_dead && entry->source->is_stale) {
+            entry->is_dead = TRUE;
+            entry->source = NULL;
+            ++ index->n_dead;
+        }
+    }
+
+    /* Append the fresh entries to the unsorted tail. The models are
+     * visited in insertion order, so the result is reproducible */
+    index->sources = g_slist_reverse(index->sources);
+    for (item = index->sources; item != NULL; item = item->next) {
+        source = item->data;
+        /* Collecting can clear the model cache while building the
+         * path, so the flag is reset only afterwards */
+        if (source->is_stale) {
+            _adg_collect(source);
+            source->is_stale = FALSE;
+        }
+    }
+    index->sources = g_slist_reverse(index->sources);
+
+    /* Rebuild the tree when the linear part of the queries (the tail)
+     * and the wasted part of the tree (the dead entries) grow too much */
+    n_tail = index->entries->len - index->n_packed;
+    if (n_tail + index->n_dead > index->n_packed / 4)
+        _adg_repack(index);
+}
+
+static void
+_adg_collect(AdgSnapSource *source)
+{
+    if (ADG_IS_TRAIL(source->model))
+        _adg_collect_trail(source, (AdgTrail *) source->model);
+
+    adg_model_foreach_named_pair(source->model,
+                                 _adg_collect_named_pair, source);
+}
+
+static void
+_adg_collect_trail(AdgSnapSource *source, AdgTrail *trail)
+{
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlPrimitiveType type;
+    CpmlPair pair;
+    guint n, n_segments;
+
+    n_segments = adg_trail_n_segments(trail);
+
+    for (n = 1; n <= n_segments; ++n) {
+        if (! adg_trail_put_segment(trail, n, &segment))
+            break;
+
+        cpml_primitive_from_segment(&primitive, &segment);
+        cpml_primitive_put_point(&primitive, 0, &pair);
+        _adg_append(source, ADG_SNAP_ENDPOINT, &pair, NULL);
+
+        do {
+            type = cpml_primitive_type(&primitive);
+
+            /* The end of a close primitive is the start of the segment */
+            if (type != CPML_CLOSE) {
+                cpml_primitive_put_point(&primitive, -1, &pair);
+                _adg_append(source, ADG_SNAP_ENDPOINT, &pair, NULL);
+            }
+
+            cpml_primitive_put_pair_at(&primitive, 0.5, &pair);
+            _adg_append(source, ADG_SNAP_MIDPOINT, &pair, NULL);
+
+            if (type == CPML_ARC && cpml_arc_info(&primitive, &pair,
+                                                  NULL, NULL, NULL))
+                _adg_append(source, ADG_SNAP_CENTER, &pair, NULL);
+        } while (cpml_primitive_next(&primitive));
+    }
+}
+
+static void
+_adg_collect_named_pair(AdgModel *model, const gchar *name,
+                        CpmlPair *pair, gpointer user_data)
+{
+    _adg_append((AdgSnapSource *) user_data, ADG_SNAP_NAMED_PAIR,
+                pair, g_intern_string(name));
+}
+
+static void
+_adg_append(AdgSnapSource *source, AdgSnapType type,
+            const CpmlPair *pair, const gchar *name)
+{
+    AdgSnapEntry entry;
+
+    entry.pair = *pair;
+    entry.type = type;
+    entry.source = source;
+    entry.name = name;
+    entry.is_dead = FALSE;
+
+    g_array_append_val(source->index->entries, entry);
+}
+
+static void
+_adg_repack(AdgSnapIndex *index)
+{
+    AdgSnapEntry *entries;
+    guint n, n_alive;
+
+    /* Compact the live entries at the beginning of the array */
+    entries = (AdgSnapEntry *) index->entries->data;
+    n_alive = 0;
+    for (n = 0; n < index->entries->len; ++n) {
+        if (! entries[n].is_dead) {
+            entries[n_alive] = entries[n];
+            ++ n_alive;
+        }
+    }
+    g_array_set_size(index->entries, n_alive);
+
+    _adg_build((AdgSnapEntry *) index->entries->data, n_alive, 0);
+
+    index->n_packed = n_alive;
+    index->n_dead = 0;
+}
+
+/* Builds an implicit k-d tree: the median of every range, split on x
+ * at even depths and on y at odd depths, is the root of the subtree
+ * and the two halves are its children */
+static void
+_adg_build(AdgSnapEntry *entries, guint n_entries, guint depth)
+{
+    guint median;
+
+    if (n_entries <= 1)
+        return;
+
+    qsort(entries, n_entries, sizeof(AdgSnapEntry),
+          depth % 2 == 0 ? _adg_compare_x : _adg_compare_y);
+
+    median = n_entries / 2;
+    _adg_build(entries, median, depth + 1);
+    _adg_build(entries + median + 1, n_entries - median - 1, depth + 1);
+}
+
+static int
+_adg_compare_x(gconstpointer p1, gconstpointer p2)
+{
+    gdouble x1 = ((const AdgSnapEntry *) p1)->pair.x;
+    gdouble x2 = ((const AdgSnapEntry *) p2)->pair.x;
+
+    return x1 < x2 ? -1 : x1 > x2 ? 1 : 0;
+}
+
+static int
+_adg_compare_y(gconstpointer p1, gconstpointer p2)
+{
+    gdouble y1 = ((const AdgSnapEntry *) p1)->pair.y;
+    gdouble y2 = ((const AdgSnapEntry *) p2)->pair.y;
+
+    return y1 < y2 ? -1 : y1 > y2 ? 1 : 0;
+}
+
+static void
+_adg_check(AdgSnapQuery *query, AdgSnapEntry *entry)
+{
+    gdouble distance;
+
+    if (entry->is_dead || (entry->type & query->types) == 0)
+        return;
+
+    distance = cpml_pair_squared_distance(&entry->pair, query->pair);
+    if (distance <= query->best) {
+        query->best = distance;
+        query->entry = entry;
+    }
+}
+
+static void
+_adg_search(AdgSnapQuery *query, AdgSnapEntry *entries,
+            guint n_entries, guint depth)
+{
+    AdgSnapEntry *median;
+    guint n_median;
+    gdouble delta;
+
+    if (n_entries == 0)
+        return;
+
+    n_median = n_entries / 2;
+    median = &entries[n_median];
+    delta = depth % 2 == 0 ? query->pair->x - median->pair.x :
+                             query->pair->y - median->pair.y;
+
+    _adg_check(query, median);
+
+    /* Visit first the half containing the point, then the other one
+     * only if the splitting line is nearer than the best match */
+    if (delta < 0) {
+        _adg_search(query, entries, n_median, depth + 1);
+        if (delta * delta <= query->best)
+            _adg_search(query, median + 1, n_entries - n_median - 1, depth + 1);
+    } else {
+        _adg_search(query, median + 1, n_entries - n_median - 1, depth + 1);
+        if (delta * delta <= query->best)
+            _adg_search(query, entries, n_median, depth + 1);
+    }
+}
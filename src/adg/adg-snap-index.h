@@ -0,0 +1,65 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_SNAP_INDEX_H__
+#define __ADG_SNAP_INDEX_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_SNAP_INDEX                     (adg_snap_index_get_type())
+
+typedef struct _AdgSnapIndex AdgSnapIndex;
+typedef struct _AdgSnap      AdgSnap;
+
+struct _AdgSnap {
+    AdgSnapType  type;
+    CpmlPair     pair;
+    AdgModel    *model;
+    const gchar *name;
+};
+
+
+GType           adg_snap_index_get_type         (void);
+
+AdgSnapIndex *  adg_snap_index_new              (void);
+AdgSnapIndex *  adg_snap_index_dup              (const AdgSnapIndex *src);
+void            adg_snap_index_destroy          (AdgSnapIndex      *index);
+void            adg_snap_index_add_model        (AdgSnapIndex      *index,
+                                                 AdgModel          *model);
+void            adg_snap_index_remove_model     (AdgSnapIndex      *index,
+                                                 AdgModel          *model);
+guint           adg_snap_index_size             (AdgSnapIndex      *index);
+gboolean        adg_snap_index_nearest          (AdgSnapIndex      *index,
+                                                 const CpmlPair    *pair,
+                                                 gdouble            max_distance,
+                                                 guint              types,
+                                                 AdgSnap           *snap);
+
+G_END_DECLS
+
+
+#endif /* __ADG_SNAP_INDEX_H__ */
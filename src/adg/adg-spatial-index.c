@@ -0,0 +1,457 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-spatial-index
+ * @Section_Id:AdgSpatialIndex
+ * @title: AdgSpatialIndex
+ * @short_description: An R-tree of entity extents
+ *
+ * AdgSpatialIndex is an opaque structure that keeps track of the
+ * extents of a set of entities and allows to quickly look for the
+ * entities that lie under a specific point or intersect a specific
+ * box, e.g. for hit-testing in interactive applications.
+ *
+ * The index is a packed R-tree, bulk loaded with the
+ * Sort-Tile-Recursive algorithm the first time it is queried after
+ * some entity has been added. Any query is O(log n) on the number of
+ * entities, other than the number of matches.
+ *
+ * The index does not keep any reference to its entities and it does
+ * not track their changes: the extents are copied when the entity is
+ * added. Use adg_canvas_get_spatial_index() to get an index that is
+ * automatically kept in sync with the content of a canvas.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgSpatialIndex:
+ *
+ * This is an opaque struct: all its fields are privates.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include "adg-entity-private.h"
+
+#include "adg-spatial-index.h"
+
+
+/* Maximum number of children of any non-leaf node */
+#define FANOUT  8
+
+
+typedef struct _AdgSpatialNode AdgSpatialNode;
+
+struct _AdgSpatialNode {
+    gdouble      x1, y1, x2, y2;
+    guint        first;
+    guint        n;
+    guint        order;
+    AdgEntity   *entity;
+};
+
+struct _AdgSpatialIndex {
+    /* The first n_entries nodes are the leaves, followed by the
+     * upper levels of the tree: the root is always the last node */
+    GArray      *nodes;
+    guint        n_entries;
+    gboolean     is_packed;
+};
+
+
+static void             _adg_pack               (AdgSpatialIndex *index);
+static void             _adg_sort_tile          (AdgSpatialNode  *nodes,
+                                                 guint            n_nodes);
+static int              _adg_compare_x          (gconstpointer    p1,
+                                                 gconstpointer    p2);
+static int              _adg_compare_y          (gconstpointer    p1,
+                                                 gconstpointer    p2);
+static int              _adg_compare_order      (gconstpointer    p1,
+                                                 gconstpointer    p2);
+static void             _adg_query              (AdgSpatialIndex *index,
+                                                 guint            n_node,
+                                                 const AdgSpatialNode *box,
+                                                 GSList         **result);
+static GSList *         _adg_matches            (AdgSpatialIndex *index,
+                                                 const AdgSpatialNode *box);
+
+
+GType
+adg_spatial_index_get_type(void)
+{
+    static gsize type = 0;
+
+    if (g_once_init_enter(&type)) {
+        GType new_type = g_boxed_type_register_static("AdgSpatialIndex",
+                                                      (GBoxedCopyFunc) adg_spatial_index_dup,
+                                                      (GBoxedFreeFunc) adg_spatial_index_destroy);
+        g_once_init_leave(&type, new_type);
+    }
+
+    return type;
+}
+
+/**
+ * adg_spatial_index_new:
+ *
+ * Creates a new empty #AdgSpatialIndex. The returned pointer
+ * should be freed with adg_spatial_index_destroy() when no longer
+ * needed.
+ *
+ * Returns: a newly created #AdgSpatialIndex
+ *
+ * Since: 1.0
+ **/
+AdgSpatialIndex *
+adg_spatial_index_new(void)
+{
+    AdgSpatialIndex *index = g_new0(AdgSpatialIndex, 1);
+
+    index->nodes = g_array_new(FALSE, FALSE, sizeof(AdgSpatialNode));
+
+    return index;
+}
+
+/**
+ * adg_spatial_index_dup:
+ * @src: an #AdgSpatialIndex
+ *
+ * Duplicates @src. The returned value should be freed with
+ * adg_spatial_index_destroy() when no longer needed.
+ *
+ * Returns: the duplicated #AdgSpatialIndex struct or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgSpatialIndex *
+adg_spatial_index_dup(const AdgSpatialIndex *src)
+{
+    AdgSpatialIndex *index;
+
+    g_return_val_if_fail(src != NULL, NULL);
+
+    index = g_memdup(src, sizeof(AdgSpatialIndex));
+    index->nodes = g_array_sized_new(FALSE, FALSE, sizeof(AdgSpatialNode),
+                                     src->nodes->len);
+    g_array_append_vals(index->nodes, src->nodes->data, src->nodes->len);
+
+    return index;
+}
+
+/**
+ * adg_spatial_index_destroy:
+ * @index: an #AdgSpatialIndex
+ *
+ * Destroys @index. The indexed entities are not affected.
+ *
+ * Since: 1.0
+ **/
+void
+adg_spatial_index_destroy(AdgSpatialIndex *index)
+{
+    g_return_if_fail(index != NULL);
+
+    g_array_free(index->nodes, TRUE);
+    g_free(index);
+}
+
+/**
+ * adg_spatial_index_add:
+ * @index: an #AdgSpatialIndex
+ * @entity: an #AdgEntity
+ *
+ * Adds @entity to @index, using its current extents as returned by
+ * adg_entity_get_extents(). Entities with undefined extents are
+ * silently ignored.
+ *
+ * The tree is lazily rebuilt on the next query, so adding a bunch
+ * of entities in a row is O(1) for every addition.
+ *
+ * Since: 1.0
+ **/
+void
+adg_spatial_index_add(AdgSpatialIndex *index, AdgEntity *entity)
+{
+    const CpmlExtents *extents;
+    AdgSpatialNode node;
+
+    g_return_if_fail(index != NULL);
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+
+    extents = _adg_entity_get_extents(entity);
+    if (extents == NULL || ! extents->is_defined)
+        return;
+
+    /* Drop the upper levels of the tree, if already built */
+    g_array_set_size(index->nodes, index->n_entries);
+    index->is_packed = FALSE;
+
+    node.x1 = extents->org.x;
+    node.y1 = extents->org.y;
+    node.x2 = extents->org.x + extents->size.x;
+    node.y2 = extents->org.y + extents->size.y;
+    node.first = 0;
+    node.n = 0;
+    node.order = index->n_entries;
+    node.entity = entity;
+
+    g_array_append_val(index->nodes, node);
+    ++ index->n_entries;
+}
+
+/**
+ * adg_spatial_index_size:
+ * @index: an #AdgSpatialIndex
+ *
+ * Gets the number of entities indexed by @index.
+ *
+ * Returns: the number of indexed entities.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_spatial_index_size(const AdgSpatialIndex *index)
+{
+    g_return_val_if_fail(index != NULL, 0);
+
+    return index->n_entries;
+}
+
+/**
+ * adg_spatial_index_query_point:
+ * @index: an #AdgSpatialIndex
+ * @pair: the point to check
+ *
+ * Gets the entities whose extents contain @pair. The extents
+ * are considered closed, i.e. a point lying on the boundary is
+ * considered inside. The entities are returned in the same order
+ * they have been added, so with the index returned by
+ * adg_canvas_get_spatial_index() the topmost entity is the last one.
+ *
+ * The returned list must be freed with g_slist_free() when no
+ * longer needed.
+ *
+ * Returns: (element-type AdgEntity) (transfer container): a newly allocated #GSList of #AdgEntity or <constant>NULL</constant> if no entity matches.
+ *
+ * Since: 1.0
+ **/
+GSList *
+adg_spatial_index_query_point(AdgSpatialIndex *index, const CpmlPair *pair)
+{
+    AdgSpatialNode box;
+
+    g_return_val_if_fail(index != NULL, NULL);
+    g_return_val_if_fail(pair != NULL, NULL);
+
+    box.x1 = box.x2 = pair->x;
+    box.y1 = box.y2 = pair->y;
+
+    return _adg_matches(index, &box);
+}
+
+/**
+ * adg_spatial_index_query_extents:
+ * @index: an #AdgSpatialIndex
+ * @extents: the box to check
+ *
+ * Gets the entities whose extents intersect @extents, touching
+ * boundaries included. If @extents is not defined, nothing matches.
+ * The entities are returned in the same order they have been added.
+ *
+ * The returned list must be freed with g_slist_free() when no
+ * longer needed.
+ *
+ * Returns: (element-type AdgEntity) (transfer container): a newly allocated #GSList of #AdgEntity or <constant>NULL</constant> if no entity matches.
+ *
+ * Since: 1.0
+ **/
+GSList *
+adg_spatial_index_query_extents(AdgSpatialIndex *index,
+                                const CpmlExtents *extents)
+{
+    AdgSpatialNode box;
+
+    g_return_val_if_fail(index != NULL, NULL);
+    g_return_val_if_fail(extents != NULL, NULL);
+
+    if (! extents->is_defined)
+        return NULL;
+
+    box.x1 = extents->org.x;
+    box.y1 = extents->org.y;
+    box.x2 = extents->org.x + extents->size.x;
+    box.y2 = extents->org.y + extents->size.y;
+
+    return _adg_matches(index, &box);
+}
+
+
+static void
+_adg_pack(AdgSpatialIndex *index)
+{
+    guint first, n_nodes, n;
+    AdgSpatialNode parent, *child;
+
+    if (index->is_packed)
+        return;
+
+    first = 0;
+    n_nodes = index->n_entries;
+
+    /* Build the tree bottom-up, one level per cycle, until
+     * a level made of a single node (the root) is reached */
+    while (n_nodes > 1) {
+        _adg_sort_tile(&g_array_index(index->nodes, AdgSpatialNode, first),
+                       n_nodes);
+
+        for (n = 0; n < n_nodes; n += FANOUT) {
+            parent.first = first + n;
+            parent.n = MIN(FANOUT, n_nodes - n);
+            parent.order = 0;
+            parent.entity = NULL;
+
+            child = &g_array_index(index->nodes, AdgSpatialNode, parent.first);
+            parent.x1 = child->x1;
+            parent.y1 = child->y1;
+            parent.x2 = child->x2;
+            parent.y2 = child->y2;
+
+            for (++ child; child < &g_array_index(index->nodes, AdgSpatialNode,
+                                                  parent.first + parent.n);
+                 ++ child) {
+                parent.x1 = MIN(parent.x1, child->x1);
+                parent.y1 = MIN(parent.y1, child->y1);
+                parent.x2 = MAX(parent.x2, child->x2);
+                parent.y2 = MAX(parent.y2, child->y2);
+            }
+
+            /* This can reallocate the array, so do not keep around
+             * pointers to the nodes across this call */
+            g_array_append_val(index->nodes, parent);
+        }
+
+        first += n_nodes;
+        n_nodes = index->nodes->len - first;
+    }
+
+    index->is_packed = TRUE;
+}
+
+static void
+_adg_sort_tile(AdgSpatialNode *nodes, guint n_nodes)
+{
+    guint n_slices, slice_size, n;
+
+    /* Sort-Tile-Recursive: sort by x, split the result in sqrt(P)
+     * vertical slices, P being the number of parent nodes, and
+     * sort every slice by y */
+    n_slices = ceil(sqrt(ceil((gdouble) n_nodes / FANOUT)));
+    slice_size = n_slices * FANOUT;
+
+    qsort(nodes, n_nodes, sizeof(AdgSpatialNode), _adg_compare_x);
+
+    for (n = 0; n < n_nodes; n += slice_size)
+        qsort(nodes + n, MIN(slice_size, n_nodes - n),
+              sizeof(AdgSpatialNode), _adg_compare_y);
+}
+
+static int
+_adg_compare_x(gconstpointer p1, gconstpointer p2)
+{
+    const AdgSpatialNode *node1 = p1;
+    const AdgSpatialNode *node2 = p2;
+    gdouble x1 = node1->x1 + node1->x2;
+    gdouble x2 = node2->x1 + node2->x2;
+
+    return x1 < x2 ? -1 : x1 > x2 ? 1 : 0;
+}
+
+static int
+_adg_compare_y(gconstpointer p1, gconstpointer p2)
+{
+    const AdgSpatialNode *node1 = p1;
+    const AdgSpatialNode *node2 = p2;
+    gdouble y1 = node1->y1 + node1->y2;
+    gdouble y2 = node2->y1 + node2->y2;
+
+    return y1 < y2 ? -1 : y1 > y2 ? 1 : 0;
+}
+
+static void
+_adg_query(AdgSpatialIndex *index, guint n_node,
+           const AdgSpatialNode *box, GSList **result)
+{
+    const AdgSpatialNode *node;
+    guint n;
+
+    node = &g_array_index(index->nodes, AdgSpatialNode, n_node);
+
+    if (node->x1 > box->x2 || node->x2 < box->x1 ||
+        node->y1 > box->y2 || node->y2 < box->y1)
+        return;
+
+    if (node->entity != NULL) {
+        *result = g_slist_prepend(*result, (gpointer) node);
+        return;
+    }
+
+    for (n = node->first; n < node->first + node->n; ++n)
+        _adg_query(index, n, box, result);
+}
+
+static int
+_adg_compare_order(gconstpointer p1, gconstpointer p2)
+{
+    const AdgSpatialNode *node1 = p1;
+    const AdgSpatialNode *node2 = p2;
+
+    if (node1->order < node2->order)
+        return -1;
+
+    return node1->order > node2->order;
+}
+
+/* Collects the leaves intersecting @box and returns their entities
+ * sorted by insertion order. The leaves are collected first and
+ * mapped to their entities afterwards, so the order is available
+ * while sorting */
+static GSList *
+_adg_matches(AdgSpatialIndex *index, const AdgSpatialNode *box)
+{
+    GSList *result, *item;
+
+    result = NULL;
+
+    _adg_pack(index);
+    if (index->nodes->len > 0)
+        _adg_query(index, index->nodes->len - 1, box, &result);
+
+    result = g_slist_sort(result, _adg_compare_order);
+    for (item = result; item != NULL; item = item->next)
+        item->data = ((AdgSpatialNode *) item->data)->entity;
+
+    return result;
+}
@@ -0,0 +1,55 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_SPATIAL_INDEX_H__
+#define __ADG_SPATIAL_INDEX_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_SPATIAL_INDEX                  (adg_spatial_index_get_type())
+
+typedef struct _AdgSpatialIndex AdgSpatialIndex;
+
+
+GType           adg_spatial_index_get_type      (void);
+
+AdgSpatialIndex *
+                adg_spatial_index_new           (void);
+AdgSpatialIndex *
+                adg_spatial_index_dup           (const AdgSpatialIndex *src);
+void            adg_spatial_index_destroy       (AdgSpatialIndex   *index);
+void            adg_spatial_index_add           (AdgSpatialIndex   *index,
+                                                 AdgEntity         *entity);
+guint           adg_spatial_index_size          (const AdgSpatialIndex *index);
+GSList *        adg_spatial_index_query_point   (AdgSpatialIndex   *index,
+                                                 const CpmlPair    *pair);
+GSList *        adg_spatial_index_query_extents (AdgSpatialIndex   *index,
+                                                 const CpmlExtents *extents);
+
+G_END_DECLS
+
+
+#endif /* __ADG_SPATIAL_INDEX_H__ */
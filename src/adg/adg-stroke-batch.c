@@ -0,0 +1,508 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/**
+ * SECTION:adg-stroke-batch
+ * @short_description: Many strokes rendered as a single entity
+ *
+ * The #AdgStrokeBatch entity strokes a collection of paths with the
+ * same line dress and the same matrices. It is intended for drawings
+ * with thousands of simple strokes (grids, overlays, construction
+ * lines), where an #AdgStroke for every path would be too expensive.
+ *
+ * The paths can be provided as raw cairo paths, copied inside the
+ * batch, or as #AdgTrail models. The batch is arranged and rendered
+ * as a whole: there is only one boundary box, the union of all the
+ * paths, and only one stroke operation.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgStrokeBatch:
+ *
+ * All fields are private and should not be used directly.
+ * Use its public methods instead.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include "adg-style.h"
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-dress.h"
+#include "adg-param-dress.h"
+#include "adg-entity-private.h"
+#include "adg-trail-private.h"
+
+#include "adg-stroke-batch.h"
+#include "adg-stroke-batch-private.h"
+
+
+#define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_stroke_batch_parent_class)
+#define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_stroke_batch_parent_class)
+
+
+G_DEFINE_TYPE(AdgStrokeBatch, adg_stroke_batch, ADG_TYPE_ENTITY)
+
+enum {
+    PROP_0,
+    PROP_LINE_DRESS
+};
+
+
+static void             _adg_dispose            (GObject        *object);
+static void             _adg_finalize           (GObject        *object);
+static void             _adg_get_property       (GObject        *object,
+                                                 guint           param_id,
+                                                 GValue         *value,
+                                                 GParamSpec     *pspec);
+static void             _adg_set_property       (GObject        *object,
+                                                 guint           param_id,
+                                                 const GValue   *value,
+                                                 GParamSpec     *pspec);
+static void             _adg_global_changed     (AdgEntity      *entity);
+static void             _adg_local_changed      (AdgEntity      *entity);
+static void             _adg_arrange            (AdgEntity      *entity);
+static void             _adg_render             (AdgEntity      *entity,
+                                                 cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
+static void             _adg_clear_trails       (AdgStrokeBatch *stroke_batch);
+
+
+static void
+adg_stroke_batch_class_init(AdgStrokeBatchClass *klass)
+{
+    GObjectClass *gobject_class;
+    AdgEntityClass *entity_class;
+    GParamSpec *param;
+
+    gobject_class = (GObjectClass *) klass;
+    entity_class = (AdgEntityClass *) klass;
+
+    g_type_class_add_private(klass, sizeof(AdgStrokeBatchPrivate));
+
+    gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
+    gobject_class->get_property = _adg_get_property;
+    gobject_class->set_property = _adg_set_property;
+
+    entity_class->global_changed = _adg_global_changed;
+    entity_class->local_changed = _adg_local_changed;
+    entity_class->arrange = _adg_arrange;
+    entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
+
+    param = adg_param_spec_dress("line-dress",
+                                 P_("Line Dress"),
+                                 P_("The dress to use for stroking all the paths of this batch"),
+                                 ADG_DRESS_LINE_STROKE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_LINE_DRESS, param);
+}
+
+static void
+adg_stroke_batch_init(AdgStrokeBatch *stroke_batch)
+{
+    AdgStrokeBatchPrivate *data = G_TYPE_INSTANCE_GET_PRIVATE(stroke_batch,
+                                                              ADG_TYPE_STROKE_BATCH,
+                                                              AdgStrokeBatchPrivate);
+
+    data->line_dress = ADG_DRESS_LINE_STROKE;
+    data->path_data = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    data->n_paths = 0;
+    data->path_extents.is_defined = FALSE;
+    data->trails = g_ptr_array_new();
+
+    stroke_batch->data = data;
+}
+
+static void
+_adg_dispose(GObject *object)
+{
+    /* Drop the trails here: they hold a reference to the batch
+     * through the dependency, so finalize would never be reached */
+    _adg_clear_trails((AdgStrokeBatch *) object);
+
+    if (_ADG_OLD_OBJECT_CLASS->dispose)
+        _ADG_OLD_OBJECT_CLASS->dispose(object);
+}
+
+static void
+_adg_finalize(GObject *object)
+{
+    AdgStrokeBatchPrivate *data = ((AdgStrokeBatch *) object)->data;
+
+    g_array_free(data->path_data, TRUE);
+    g_ptr_array_free(data->trails, TRUE);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
+static void
+_adg_get_property(GObject *object, guint prop_id,
+                  GValue *value, GParamSpec *pspec)
+{
+    AdgStrokeBatchPrivate *data = ((AdgStrokeBatch *) object)->data;
+
+    switch (prop_id) {
+    case PROP_LINE_DRESS:
+        g_value_set_enum(value, data->line_dress);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+_adg_set_property(GObject *object, guint prop_id,
+                  const GValue *value, GParamSpec *pspec)
+{
+    AdgStrokeBatchPrivate *data = ((AdgStrokeBatch *) object)->data;
+
+    switch (prop_id) {
+    case PROP_LINE_DRESS:
+        data->line_dress = g_value_get_enum(value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+
+/**
+ * adg_stroke_batch_new:
+ *
+ * Creates a new empty stroke batch.
+ *
+ * Returns: the newly created stroke batch entity
+ *
+ * Since: 1.0
+ **/
+AdgStrokeBatch *
+adg_stroke_batch_new(void)
+{
+    return g_object_new(ADG_TYPE_STROKE_BATCH, NULL);
+}
+
+/**
+ * adg_stroke_batch_set_line_dress:
+ * @stroke_batch: an #AdgStrokeBatch
+ * @dress: the new #AdgDress to use
+ *
+ * Sets a new line dress for rendering all the paths of
+ * @stroke_batch. The new dress must be related to the original
+ * dress for this property: you cannot set a dress used for line
+ * styles to a dress managing fonts.
+ *
+ * Since: 1.0
+ **/
+void
+adg_stroke_batch_set_line_dress(AdgStrokeBatch *stroke_batch, AdgDress dress)
+{
+    g_return_if_fail(ADG_IS_STROKE_BATCH(stroke_batch));
+    g_object_set(stroke_batch, "line-dress", dress, NULL);
+}
+
+/**
+ * adg_stroke_batch_get_line_dress:
+ * @stroke_batch: an #AdgStrokeBatch
+ *
+ * Gets the line dress to be used in rendering @stroke_batch.
+ *
+ * Returns: (transfer none): the current line dress.
+ *
+ * Since: 1.0
+ **/
+AdgDress
+adg_stroke_batch_get_line_dress(AdgStrokeBatch *stroke_batch)
+{
+    AdgStrokeBatchPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_STROKE_BATCH(stroke_batch), ADG_DRESS_UNDEFINED);
+
+    data = stroke_batch->data;
+
+    return data->line_dress;
+}
+
+/**
+ * adg_stroke_batch_add_path:
+ * @stroke_batch: an #AdgStrokeBatch
+ * @cairo_path: a cairo path in model space
+ *
+ * Appends a copy of @cairo_path to the paths stroked by @stroke_batch.
+ * Nothing else than the path data is stored, so this is the cheapest
+ * way to add static geometry to a batch.
+ *
+ * Since: 1.0
+ **/
+void
+adg_stroke_batch_add_path(AdgStrokeBatch *stroke_batch,
+                          const cairo_path_t *cairo_path)
+{
+    AdgStrokeBatchPrivate *data;
+    cairo_path_t path;
+    CpmlSegment segment;
+    CpmlExtents extents;
+
+    g_return_if_fail(ADG_IS_STROKE_BATCH(stroke_batch));
+    g_return_if_fail(cairo_path != NULL);
+
+    if (cairo_path->num_data <= 0)
+        return;
+
+    data = stroke_batch->data;
+    g_array_append_vals(data->path_data, cairo_path->data,
+                        cairo_path->num_data);
+    ++data->n_paths;
+
+    /* The union is updated on the fly, so the arrange phase does
+     * not need to scan the raw paths again */
+    path = *cairo_path;
+    if (cpml_segment_from_cairo(&segment, &path)) {
+        do {
+            cpml_segment_put_extents(&segment, &extents);
+            cpml_extents_add(&data->path_extents, &extents);
+        } while (cpml_segment_next(&segment));
+    }
+
+    adg_entity_invalidate((AdgEntity *) stroke_batch);
+}
+
+/**
+ * adg_stroke_batch_add_trail:
+ * @stroke_batch:       an #AdgStrokeBatch
+ * @trail: (transfer none): the #AdgTrail to add
+ *
+ * Appends @trail to the models stroked by @stroke_batch. A reference
+ * to @trail is held by @stroke_batch and any change on @trail will
+ * invalidate the whole batch.
+ *
+ * Since: 1.0
+ **/
+void
+adg_stroke_batch_add_trail(AdgStrokeBatch *stroke_batch, AdgTrail *trail)
+{
+    AdgStrokeBatchPrivate *data;
+
+    g_return_if_fail(ADG_IS_STROKE_BATCH(stroke_batch));
+    g_return_if_fail(ADG_IS_TRAIL(trail));
+
+    data = stroke_batch->data;
+    g_ptr_array_add(data->trails, g_object_ref(trail));
+    adg_model_add_dependency((AdgModel *) trail, (AdgEntity *) stroke_batch);
+
+    adg_entity_invalidate((AdgEntity *) stroke_batch);
+}
+
+/**
+ * adg_stroke_batch_get_n_paths:
+ * @stroke_batch: an #AdgStrokeBatch
+ *
+ * Gets the number of raw paths added to @stroke_batch with
+ * adg_stroke_batch_add_path().
+ *
+ * Returns: the number of raw paths or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_stroke_batch_get_n_paths(AdgStrokeBatch *stroke_batch)
+{
+    AdgStrokeBatchPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_STROKE_BATCH(stroke_batch), 0);
+
+    data = stroke_batch->data;
+
+    return data->n_paths;
+}
+
+/**
+ * adg_stroke_batch_get_n_trails:
+ * @stroke_batch: an #AdgStrokeBatch
+ *
+ * Gets the number of trails added to @stroke_batch with
+ * adg_stroke_batch_add_trail().
+ *
+ * Returns: the number of trails or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_stroke_batch_get_n_trails(AdgStrokeBatch *stroke_batch)
+{
+    AdgStrokeBatchPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_STROKE_BATCH(stroke_batch), 0);
+
+    data = stroke_batch->data;
+
+    return data->trails->len;
+}
+
+/**
+ * adg_stroke_batch_clear:
+ * @stroke_batch: an #AdgStrokeBatch
+ *
+ * Removes all the paths and the trails from @stroke_batch.
+ *
+ * Since: 1.0
+ **/
+void
+adg_stroke_batch_clear(AdgStrokeBatch *stroke_batch)
+{
+    AdgStrokeBatchPrivate *data;
+
+    g_return_if_fail(ADG_IS_STROKE_BATCH(stroke_batch));
+
+    data = stroke_batch->data;
+
+    g_array_set_size(data->path_data, 0);
+    data->n_paths = 0;
+    data->path_extents.is_defined = FALSE;
+    _adg_clear_trails(stroke_batch);
+
+    adg_entity_invalidate((AdgEntity *) stroke_batch);
+}
+
+
+static void
+_adg_global_changed(AdgEntity *entity)
+{
+    if (_ADG_OLD_ENTITY_CLASS->global_changed)
+        _ADG_OLD_ENTITY_CLASS->global_changed(entity);
+
+    adg_entity_invalidate(entity);
+}
+
+static void
+_adg_local_changed(AdgEntity *entity)
+{
+    if (_ADG_OLD_ENTITY_CLASS->local_changed)
+        _ADG_OLD_ENTITY_CLASS->local_changed(entity);
+
+    adg_entity_invalidate(entity);
+}
+
+static void
+_adg_arrange(AdgEntity *entity)
+{
+    AdgStrokeBatchPrivate *data;
+    const CpmlExtents *trail_extents;
+    CpmlExtents extents;
+    guint n;
+
+    /* Check for cached result */
+    if (_adg_entity_get_extents(entity)->is_defined)
+        return;
+
+    data = ((AdgStrokeBatch *) entity)->data;
+    cpml_extents_copy(&extents, &data->path_extents);
+
+    for (n = 0; n < data->trails->len; ++n) {
+        trail_extents = adg_trail_get_extents(g_ptr_array_index(data->trails, n));
+        if (trail_extents != NULL)
+            cpml_extents_add(&extents, trail_extents);
+    }
+
+    /* All the paths share the same matrices, so the union
+     * is transformed only once */
+    cpml_extents_transform_chained(&extents,
+                                   _adg_entity_get_local_matrix(entity),
+                                   _adg_entity_get_global_matrix(entity));
+    adg_entity_set_extents(entity, &extents);
+}
+
+static void
+_adg_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgStrokeBatchPrivate *data;
+    const cairo_path_t *cairo_path;
+    cairo_path_t path;
+    guint n;
+
+    data = ((AdgStrokeBatch *) entity)->data;
+
+    if (data->path_data->len == 0 && data->trails->len == 0)
+        return;
+
+    cairo_transform(cr, _adg_entity_get_global_matrix(entity));
+
+    cairo_save(cr);
+    cairo_transform(cr, _adg_entity_get_local_matrix(entity));
+
+    if (data->path_data->len > 0) {
+        path.status = CAIRO_STATUS_SUCCESS;
+        path.data = (cairo_path_data_t *) data->path_data->data;
+        path.num_data = data->path_data->len;
+        cairo_append_path(cr, &path);
+    }
+
+    for (n = 0; n < data->trails->len; ++n) {
+        cairo_path = _adg_trail_get_cairo_path(g_ptr_array_index(data->trails, n));
+        if (cairo_path != NULL)
+            cairo_append_path(cr, cairo_path);
+    }
+
+    cairo_restore(cr);
+
+    /* The whole batch is stroked at once */
+    adg_entity_apply_dress(entity, data->line_dress, cr);
+    cairo_stroke(cr);
+}
+
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgStrokeBatchPrivate *data = ((AdgStrokeBatch *) entity)->data;
+
+    /* The trails are shared, so only the raw paths are accounted */
+    return _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgStrokeBatchPrivate) +
+        data->path_data->len * sizeof(cairo_path_data_t) +
+        data->trails->len * sizeof(gpointer);
+}
+
+static void
+_adg_clear_trails(AdgStrokeBatch *stroke_batch)
+{
+    AdgStrokeBatchPrivate *data;
+    AdgTrail *trail;
+    guint n;
+
+    data = stroke_batch->data;
+
+    for (n = 0; n < data->trails->len; ++n) {
+        trail = g_ptr_array_index(data->trails, n);
+        adg_model_remove_dependency((AdgModel *) trail,
+                                    (AdgEntity *) stroke_batch);
+        g_object_unref(trail);
+    }
+
+    g_ptr_array_set_size(data->trails, 0);
+}
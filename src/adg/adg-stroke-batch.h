@@ -0,0 +1,72 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_STROKE_BATCH_H__
+#define __ADG_STROKE_BATCH_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_STROKE_BATCH             (adg_stroke_batch_get_type())
+#define ADG_STROKE_BATCH(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), ADG_TYPE_STROKE_BATCH, AdgStrokeBatch))
+#define ADG_STROKE_BATCH_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), ADG_TYPE_STROKE_BATCH, AdgStrokeBatchClass))
+#define ADG_IS_STROKE_BATCH(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), ADG_TYPE_STROKE_BATCH))
+#define ADG_IS_STROKE_BATCH_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), ADG_TYPE_STROKE_BATCH))
+#define ADG_STROKE_BATCH_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), ADG_TYPE_STROKE_BATCH, AdgStrokeBatchClass))
+
+typedef struct _AdgStrokeBatch        AdgStrokeBatch;
+typedef struct _AdgStrokeBatchClass   AdgStrokeBatchClass;
+
+struct _AdgStrokeBatch {
+    /*< private >*/
+    AdgEntity           parent;
+    gpointer            data;
+};
+
+struct _AdgStrokeBatchClass {
+    /*< private >*/
+    AdgEntityClass      parent_class;
+};
+
+
+GType           adg_stroke_batch_get_type       (void);
+
+AdgStrokeBatch *adg_stroke_batch_new            (void);
+
+void            adg_stroke_batch_set_line_dress (AdgStrokeBatch *stroke_batch,
+                                                 AdgDress        dress);
+AdgDress        adg_stroke_batch_get_line_dress (AdgStrokeBatch *stroke_batch);
+void            adg_stroke_batch_add_path       (AdgStrokeBatch *stroke_batch,
+                                                 const cairo_path_t *cairo_path);
+void            adg_stroke_batch_add_trail      (AdgStrokeBatch *stroke_batch,
+                                                 AdgTrail       *trail);
+guint           adg_stroke_batch_get_n_paths    (AdgStrokeBatch *stroke_batch);
+guint           adg_stroke_batch_get_n_trails   (AdgStrokeBatch *stroke_batch);
+void            adg_stroke_batch_clear          (AdgStrokeBatch *stroke_batch);
+
+G_END_DECLS
+
+
+#endif /* __ADG_STROKE_BATCH_H__ */
@@ -29,6 +29,14 @@ typedef struct _AdgStrokePrivate AdgStrokePrivate;
 struct _AdgStrokePrivate {
     AdgDress     line_dress;
     AdgTrail    *trail;
+    gboolean     has_dash_cache;
+
+    struct {
+        GArray  *array;
+        gdouble *dashes;
+        gint     num_dashes;
+        gdouble  offset;
+    }            dash_cache;
 };
 
 G_END_DECLS
@@ -24,6 +24,13 @@
  *
  * The #AdgStroke object is a stroked representation of an #AdgTrail model.
  *
+ * Dashed lines are usually left to cairo, that computes the dashes
+ * on every stroke. Enabling the #AdgStroke:has-dash-cache property,
+ * the dashes are computed only once into a cached path that is
+ * reused by the following renderings, until @stroke is invalidated
+ * (for example because the trail has changed) or the dash pattern
+ * is modified.
+ *
  * Since: 1.0
  **/
 
@@ -45,10 +52,14 @@
 #include "adg-trail.h"
 #include "adg-dress.h"
 #include "adg-param-dress.h"
+#include "adg-entity-private.h"
+#include "adg-trail-private.h"
 
 #include "adg-stroke.h"
 #include "adg-stroke-private.h"
 
+#include <math.h>
+
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_stroke_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_stroke_parent_class)
 
@@ -58,11 +69,13 @@ G_DEFINE_TYPE(AdgStroke, adg_stroke, ADG_TYPE_ENTITY)
 enum {
     PROP_0,
     PROP_LINE_DRESS,
-    PROP_TRAIL
+    PROP_TRAIL,
+    PROP_HAS_DASH_CACHE
 };
 
 
 static void             _adg_dispose            (GObject        *object);
+static void             _adg_finalize           (GObject        *object);
 static void             _adg_get_property       (GObject        *object,
                                                  guint           param_id,
                                                  GValue         *value,
@@ -73,10 +86,29 @@ static void             _adg_set_property       (GObject        *object,
                                                  GParamSpec     *pspec);
 static void             _adg_global_changed     (AdgEntity      *entity);
 static void             _adg_local_changed      (AdgEntity      *entity);
+static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
+static void             _adg_trim_caches        (AdgEntity      *entity,
+                                                 AdgTrimLevel    level);
 static void             _adg_unset_trail        (AdgStroke      *stroke);
+static void             _adg_clear_dash_cache   (AdgStroke      *stroke);
+static gboolean         _adg_dash_cache_is_valid(AdgStroke      *stroke,
+                                                 const gdouble  *dashes,
+                                                 gint            num_dashes,
+                                                 gdouble         offset);
+static gboolean         _adg_fill_dash_cache    (AdgStroke      *stroke,
+                                                 cairo_t        *cr);
+static void             _adg_dash_segment       (GArray         *array,
+                                                 CpmlSegment    *segment,
+                                                 const gdouble  *dashes,
+                                                 gint            num_dashes,
+                                                 gdouble         offset);
+static void             _adg_append_pair        (GArray         *array,
+                                                 CpmlPrimitiveType type,
+                                                 const CpmlPair *pair);
 
 
 static void
@@ -92,13 +124,17 @@ adg_stroke_class_init(AdgStrokeClass *klass)
     g_type_class_add_private(klass, sizeof(AdgStrokePrivate));
 
     gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
     entity_class->global_changed = _adg_global_changed;
     entity_class->local_changed = _adg_local_changed;
+    entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
+    entity_class->trim_caches = _adg_trim_caches;
 
     param = adg_param_spec_dress("line-dress",
                                  P_("Line Dress"),
@@ -113,6 +149,13 @@ adg_stroke_class_init(AdgStrokeClass *klass)
                                 ADG_TYPE_TRAIL,
                                 G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
     g_object_class_install_property(gobject_class, PROP_TRAIL, param);
+
+    param = g_param_spec_boolean("has-dash-cache",
+                                 P_("Has Dash Cache"),
+                                 P_("Whether the dashes must be computed once and cached instead of being generated by cairo on every stroke"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_HAS_DASH_CACHE, param);
 }
 
 static void
@@ -124,6 +167,12 @@ adg_stroke_init(AdgStroke *stroke)
 
     data->line_dress = ADG_DRESS_LINE_STROKE;
     data->trail = NULL;
+    data->has_dash_cache = FALSE;
+    data->dash_cache.array = g_array_new(FALSE, FALSE,
+                                         sizeof(cairo_path_data_t));
+    data->dash_cache.dashes = NULL;
+    data->dash_cache.num_dashes = 0;
+    data->dash_cache.offset = 0;
 
     stroke->data = data;
 }
@@ -139,6 +188,18 @@ _adg_dispose(GObject *object)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgStrokePrivate *data = ((AdgStroke *) object)->data;
+
+    g_array_free(data->dash_cache.array, TRUE);
+    g_free(data->dash_cache.dashes);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
 static void
 _adg_get_property(GObject *object, guint prop_id,
                   GValue *value, GParamSpec *pspec)
@@ -152,6 +213,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_TRAIL:
         g_value_set_object(value, data->trail);
         break;
+    case PROP_HAS_DASH_CACHE:
+        g_value_set_boolean(value, data->has_dash_cache);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -188,8 +252,14 @@ _adg_set_property(GObject *object, guint prop_id,
                 adg_model_remove_dependency((AdgModel *) old_trail,
                                             (AdgEntity *) object);
             }
+            _adg_clear_dash_cache((AdgStroke *) object);
         }
         break;
+    case PROP_HAS_DASH_CACHE:
+        data->has_dash_cache = g_value_get_boolean(value);
+        if (! data->has_dash_cache)
+            _adg_clear_dash_cache((AdgStroke *) object);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -300,6 +370,47 @@ adg_stroke_get_trail(AdgStroke *stroke)
     return data->trail;
 }
 
+/**
+ * adg_stroke_switch_dash_cache:
+ * @stroke: an #AdgStroke
+ * @new_state: the new state
+ *
+ * Sets the #AdgStroke:has-dash-cache property of @stroke. When
+ * enabled, a dashed line style is rendered by stroking a cached
+ * path containing the dashes, computed on the first rendering and
+ * kept until @stroke is invalidated or the dash pattern changes.
+ *
+ * Since: 1.0
+ **/
+void
+adg_stroke_switch_dash_cache(AdgStroke *stroke, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_STROKE(stroke));
+    g_object_set(stroke, "has-dash-cache", new_state, NULL);
+}
+
+/**
+ * adg_stroke_has_dash_cache:
+ * @stroke: an #AdgStroke
+ *
+ * Gets the state of the #AdgStroke:has-dash-cache property.
+ *
+ * Returns: <constant>TRUE</constant> if the dashes are cached, <constant>FALSE</constant> otherwise or on errors.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_stroke_has_dash_cache(AdgStroke *stroke)
+{
+    AdgStrokePrivate *data;
+
+    g_return_val_if_fail(ADG_IS_STROKE(stroke), FALSE);
+
+    data = stroke->data;
+
+    return data->has_dash_cache;
+}
+
 
 static void
 _adg_global_changed(AdgEntity *entity)
@@ -319,6 +430,16 @@ _adg_local_changed(AdgEntity *entity)
     adg_entity_invalidate(entity);
 }
 
+static void
+_adg_invalidate(AdgEntity *entity)
+{
+    /* The cached dashes depend on both the trail and the matrices */
+    _adg_clear_dash_cache((AdgStroke *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->invalidate)
+        _ADG_OLD_ENTITY_CLASS->invalidate(entity);
+}
+
 static void
 _adg_arrange(AdgEntity *entity)
 {
@@ -328,7 +449,7 @@ _adg_arrange(AdgEntity *entity)
     CpmlExtents extents;
 
     /* Check for cached result */
-    if (adg_entity_get_extents(entity)->is_defined)
+    if (_adg_entity_get_extents(entity)->is_defined)
         return;
 
     stroke = (AdgStroke *) entity;
@@ -340,11 +461,36 @@ _adg_arrange(AdgEntity *entity)
         return;
 
     cpml_extents_copy(&extents, trail_extents);
-    cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
-    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+    cpml_extents_transform_chained(&extents,
+                                   _adg_entity_get_local_matrix(entity),
+                                   _adg_entity_get_global_matrix(entity));
     adg_entity_set_extents(entity, &extents);
 }
 
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgStrokePrivate *data = ((AdgStroke *) entity)->data;
+    gsize usage;
+
+    /* The trail is shared, so only the dash cache is accounted */
+    usage = _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgStrokePrivate);
+
+    if (data->dash_cache.array != NULL)
+        usage += data->dash_cache.array->len * sizeof(cairo_path_data_t);
+    usage += data->dash_cache.num_dashes * sizeof(gdouble);
+
+    return usage;
+}
+
+static void
+_adg_trim_caches(AdgEntity *entity, AdgTrimLevel level)
+{
+    _adg_clear_dash_cache((AdgStroke *) entity);
+    _ADG_OLD_ENTITY_CLASS->trim_caches(entity, level);
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -354,17 +500,33 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 
     stroke = (AdgStroke *) entity;
     data = stroke->data;
-    cairo_path = adg_trail_get_cairo_path(data->trail);
+    cairo_path = data->trail != NULL ?
+        _adg_trail_get_cairo_path(data->trail) : NULL;
 
     if (cairo_path != NULL) {
-        cairo_transform(cr, adg_entity_get_global_matrix(entity));
+        cairo_transform(cr, _adg_entity_get_global_matrix(entity));
 
         cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, _adg_entity_get_local_matrix(entity));
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
         adg_entity_apply_dress(entity, data->line_dress, cr);
+
+        /* Replace the path with the cached dashes, if possible */
+        if (data->has_dash_cache && cairo_get_dash_count(cr) > 0 &&
+            _adg_fill_dash_cache(stroke, cr)) {
+            cairo_path_t dashed;
+
+            dashed.status = CAIRO_STATUS_SUCCESS;
+            dashed.data = (cairo_path_data_t *) data->dash_cache.array->data;
+            dashed.num_data = data->dash_cache.array->len;
+
+            cairo_new_path(cr);
+            cairo_append_path(cr, &dashed);
+            cairo_set_dash(cr, NULL, 0, 0);
+        }
+
         cairo_stroke(cr);
     }
 }
@@ -374,3 +536,183 @@ _adg_unset_trail(AdgStroke *stroke)
 {
     g_object_set(stroke, "trail", NULL, NULL);
 }
+
+static void
+_adg_clear_dash_cache(AdgStroke *stroke)
+{
+    AdgStrokePrivate *data = stroke->data;
+
+    g_array_set_size(data->dash_cache.array, 0);
+    g_free(data->dash_cache.dashes);
+    data->dash_cache.dashes = NULL;
+    data->dash_cache.num_dashes = 0;
+}
+
+static gboolean
+_adg_dash_cache_is_valid(AdgStroke *stroke, const gdouble *dashes,
+                         gint num_dashes, gdouble offset)
+{
+    AdgStrokePrivate *data = stroke->data;
+    gint n;
+
+    if (data->dash_cache.dashes == NULL ||
+        data->dash_cache.num_dashes != num_dashes ||
+        data->dash_cache.offset != offset)
+        return FALSE;
+
+    for (n = 0; n < num_dashes; ++n)
+        if (data->dash_cache.dashes[n] != dashes[n])
+            return FALSE;
+
+    return TRUE;
+}
+
+/* Ensures the dash cache of @stroke contains the dashes of the
+ * current path of @cr, computed with the current dash pattern.
+ * Returns FALSE if the dashes cannot be computed, in which case
+ * stroking must be left to cairo. */
+static gboolean
+_adg_fill_dash_cache(AdgStroke *stroke, cairo_t *cr)
+{
+    AdgStrokePrivate *data;
+    gdouble *dashes;
+    gdouble offset, period;
+    gint num_dashes, n;
+    GArray *array;
+    cairo_path_t flat;
+    CpmlSegment segment;
+
+    data = stroke->data;
+    num_dashes = cairo_get_dash_count(cr);
+    dashes = g_new(gdouble, num_dashes);
+    cairo_get_dash(cr, dashes, &offset);
+
+    if (_adg_dash_cache_is_valid(stroke, dashes, num_dashes, offset)) {
+        g_free(dashes);
+        return TRUE;
+    }
+
+    /* A pattern without length would never advance */
+    period = 0;
+    for (n = 0; n < num_dashes; ++n) {
+        if (dashes[n] < 0)
+            break;
+        period += dashes[n];
+    }
+
+    if (n < num_dashes || period <= 0) {
+        g_free(dashes);
+        return FALSE;
+    }
+
+    /* The path is flattened, so every primitive is a line and its
+     * length is exact. The flattening is shared with any other entity
+     * rendering the same trail: here only the local map is applied */
+    array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    if (! _adg_trail_append_flat(data->trail, cr,
+                                 _adg_entity_get_local_matrix((AdgEntity *) stroke),
+                                 array)) {
+        g_array_free(array, TRUE);
+        g_free(dashes);
+        return FALSE;
+    }
+
+    flat.status = CAIRO_STATUS_SUCCESS;
+    flat.data = (cairo_path_data_t *) array->data;
+    flat.num_data = array->len;
+
+    _adg_clear_dash_cache(stroke);
+
+    /* An odd number of dashes is repeated twice, as done by cairo */
+    if (num_dashes % 2 == 1)
+        period *= 2;
+
+    data->dash_cache.offset = offset;
+    offset = fmod(offset, period);
+    if (offset < 0)
+        offset += period;
+
+    if (cpml_segment_from_cairo(&segment, &flat)) {
+        do {
+            _adg_dash_segment(data->dash_cache.array, &segment,
+                              dashes, num_dashes, offset);
+        } while (cpml_segment_next(&segment));
+    }
+
+    g_array_free(array, TRUE);
+
+    data->dash_cache.dashes = dashes;
+    data->dash_cache.num_dashes = num_dashes;
+
+    return TRUE;
+}
+
+/* Appends to @array the dashes of @segment. As cairo does, the dash
+ * pattern restarts at the beginning of every segment. */
+static void
+_adg_dash_segment(GArray *array, CpmlSegment *segment,
+                  const gdouble *dashes, gint num_dashes, gdouble offset)
+{
+    CpmlPrimitive primitive;
+    CpmlPair pair;
+    gboolean on;
+    gdouble remaining, length, pos;
+    gint n;
+
+    /* Skip the dashes consumed by offset */
+    n = 0;
+    on = TRUE;
+    remaining = dashes[0];
+    while (offset > 0) {
+        if (offset < remaining) {
+            remaining -= offset;
+            break;
+        }
+        offset -= remaining;
+        n = (n + 1) % num_dashes;
+        on = ! on;
+        remaining = dashes[n];
+    }
+
+    cpml_primitive_from_segment(&primitive, segment);
+
+    if (on) {
+        cpml_primitive_put_pair_at(&primitive, 0, &pair);
+        _adg_append_pair(array, CPML_MOVE, &pair);
+    }
+
+    do {
+        length = cpml_primitive_get_length(&primitive);
+        pos = 0;
+
+        /* Toggle the pen at every dash ending inside this primitive */
+        while (length - pos > remaining) {
+            pos += remaining;
+            cpml_primitive_put_pair_at(&primitive, pos / length, &pair);
+            _adg_append_pair(array, on ? CPML_LINE : CPML_MOVE, &pair);
+            n = (n + 1) % num_dashes;
+            on = ! on;
+            remaining = dashes[n];
+        }
+
+        remaining -= length - pos;
+
+        if (on) {
+            cpml_primitive_put_pair_at(&primitive, 1, &pair);
+            _adg_append_pair(array, CPML_LINE, &pair);
+        }
+    } while (cpml_primitive_next(&primitive));
+}
+
+static void
+_adg_append_pair(GArray *array, CpmlPrimitiveType type,
+                 const CpmlPair *pair)
+{
+    cairo_path_data_t path_data[2];
+
+    path_data[0].header.type = type;
+    path_data[0].header.length = 2;
+    cpml_pair_to_cairo(pair, &path_data[1]);
+
+    g_array_append_vals(array, path_data, 2);
+}
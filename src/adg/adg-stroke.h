@@ -61,6 +61,9 @@ AdgDress        adg_stroke_get_line_dress       (AdgStroke      *stroke);
 void            adg_stroke_set_trail            (AdgStroke      *stroke,
                                                  AdgTrail       *trail);
 AdgTrail *      adg_stroke_get_trail            (AdgStroke      *stroke);
+void            adg_stroke_switch_dash_cache    (AdgStroke      *stroke,
+                                                 gboolean        new_state);
+gboolean        adg_stroke_has_dash_cache       (AdgStroke      *stroke);
 
 G_END_DECLS
 
@@ -24,6 +24,12 @@
  *
  * This is the fundamental abstract class for styles.
  *
+ * Styles are usually customized by cloning a fallback style and
+ * changing some of its properties. When many entities need the same
+ * customization, adg_style_intern() can be used to share a single
+ * instance among all of them: equal styles are then also identical,
+ * so they can be compared by pointer.
+ *
  * Since: 1.0
  **/
 
@@ -38,9 +44,15 @@
 
 /**
  * AdgStyleClass:
+ * @clone:      virtual method to duplicate a style.
+ * @equal:      virtual method to compare two styles of the same type.
  * @invalidate: virtual method to reset the style.
  * @apply:      abstract virtual to apply a style to a cairo context.
  *
+ * The default @equal implementation compares the values of all the
+ * readable and writable properties, so it must be overriden only
+ * when some state is not exposed that way.
+ *
  * The default @invalidate handler does not do anything.
  *
  * The virtual method @apply *must* be implemented by any derived class.
@@ -58,6 +70,9 @@
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_style_parent_class)
 
 
+G_LOCK_DEFINE_STATIC(_adg_interned);
+
+
 G_DEFINE_ABSTRACT_TYPE(AdgStyle, adg_style, G_TYPE_OBJECT)
 
 enum {
@@ -67,10 +82,17 @@ enum {
 };
 
 static void             _adg_dispose            (GObject        *object);
+static void             _adg_finalize           (GObject        *object);
+static gboolean         _adg_equal              (AdgStyle       *style,
+                                                 AdgStyle       *other);
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
+static guint            _adg_hash               (gconstpointer   key);
+static gboolean         _adg_key_equal          (gconstpointer   key,
+                                                 gconstpointer   key2);
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
+static GHashTable *     _adg_interned = NULL;
 
 
 static void
@@ -81,8 +103,10 @@ adg_style_class_init(AdgStyleClass *klass)
     gobject_class = (GObjectClass *) klass;
 
     gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
 
     klass->clone = (AdgStyle *(*)(AdgStyle *)) adg_object_clone;
+    klass->equal = _adg_equal;
     klass->invalidate = NULL;
     klass->apply = _adg_apply;
 
@@ -134,6 +158,7 @@ adg_style_class_init(AdgStyleClass *klass)
 static void
 adg_style_init(AdgStyle *style)
 {
+    ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_STYLE, sizeof(AdgStyle));
 }
 
 static void
@@ -145,6 +170,15 @@ _adg_dispose(GObject *object)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_STYLE, -(gssize) sizeof(AdgStyle));
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize != NULL)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
 
 /**
  * adg_style_invalidate:
@@ -193,6 +227,98 @@ adg_style_clone(AdgStyle *style)
     return klass->clone(style);
 }
 
+/**
+ * adg_style_equal:
+ * @style: an #AdgStyle derived style
+ * @other: another #AdgStyle derived style
+ *
+ * Checks if @style and @other are structurally identical, that is
+ * they are of the same type and applying them gives the same result.
+ * Identical pointers are always equal, so no property is compared
+ * between interned styles.
+ *
+ * Returns: %TRUE if the styles are equal, %FALSE otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_style_equal(AdgStyle *style, AdgStyle *other)
+{
+    AdgStyleClass *klass;
+
+    g_return_val_if_fail(ADG_IS_STYLE(style), FALSE);
+    g_return_val_if_fail(ADG_IS_STYLE(other), FALSE);
+
+    if (style == other)
+        return TRUE;
+
+    if (G_TYPE_FROM_INSTANCE(style) != G_TYPE_FROM_INSTANCE(other))
+        return FALSE;
+
+    klass = ADG_STYLE_GET_CLASS(style);
+
+    if (klass->equal == NULL)
+        return FALSE;
+
+    return klass->equal(style, other);
+}
+
+/**
+ * adg_style_intern:
+ * @style: (transfer none): an #AdgStyle derived style
+ *
+ * Gets the shared instance of the styles equal to @style, as checked by
+ * adg_style_equal(). If no such instance is found, @style itself is
+ * registered as the shared one.
+ *
+ * The registry keeps a reference to every interned style, so the
+ * number of different styles is expected to be small. An interned style
+ * is shared by all its users and must be considered read-only: clone it
+ * if you need to change it.
+ *
+ * <informalexample><programlisting language="C">
+ * AdgStyle *clone, *style;
+ *
+ * clone = adg_style_clone(adg_dress_get_fallback(ADG_DRESS_DIMENSION));
+ * adg_dim_style_set_number_format(ADG_DIM_STYLE(clone), "R%g");
+ * style = adg_style_intern(clone);
+ * g_object_unref(clone);
+ *
+ * // The same instance is returned for every dimension
+ * adg_entity_set_style(entity, ADG_DRESS_DIMENSION, style);
+ * g_object_unref(style);
+ * </programlisting></informalexample>
+ *
+ * Returns: (transfer full): the shared style.
+ *
+ * Since: 1.0
+ **/
+AdgStyle *
+adg_style_intern(AdgStyle *style)
+{
+    AdgStyle *interned;
+
+    g_return_val_if_fail(ADG_IS_STYLE(style), NULL);
+
+    G_LOCK(_adg_interned);
+
+    if (_adg_interned == NULL)
+        _adg_interned = g_hash_table_new_full(_adg_hash, _adg_key_equal,
+                                              g_object_unref, NULL);
+
+    interned = g_hash_table_lookup(_adg_interned, style);
+    if (interned == NULL) {
+        interned = style;
+        g_hash_table_insert(_adg_interned, g_object_ref(style), style);
+    }
+
+    g_object_ref(interned);
+
+    G_UNLOCK(_adg_interned);
+
+    return interned;
+}
+
 /**
  * adg_style_apply:
  * @style: an #AdgStyle derived style
@@ -215,6 +341,36 @@ adg_style_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 }
 
 
+static gboolean
+_adg_equal(AdgStyle *style, AdgStyle *other)
+{
+    GParamSpec **specs;
+    GValue value = { 0 }, value2 = { 0 };
+    gboolean is_equal;
+    guint n, n_specs;
+
+    /* The same properties copied by adg_object_clone() */
+    specs = g_object_class_list_properties(G_OBJECT_GET_CLASS(style), &n_specs);
+    is_equal = TRUE;
+
+    for (n = 0; is_equal && n < n_specs; ++n) {
+        if ((specs[n]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
+            continue;
+
+        g_value_init(&value, specs[n]->value_type);
+        g_value_init(&value2, specs[n]->value_type);
+        g_object_get_property((GObject *) style, specs[n]->name, &value);
+        g_object_get_property((GObject *) other, specs[n]->name, &value2);
+        is_equal = _adg_value_equal(&value, &value2);
+        g_value_unset(&value);
+        g_value_unset(&value2);
+    }
+
+    g_free(specs);
+
+    return is_equal;
+}
+
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 {
@@ -222,3 +378,36 @@ _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
     g_warning(_("%s: 'apply' method not implemented for type '%s'"),
               G_STRLOC, g_type_name(G_OBJECT_TYPE(style)));
 }
+
+static guint
+_adg_hash(gconstpointer key)
+{
+    GObject *object;
+    GParamSpec **specs;
+    GValue value = { 0 };
+    guint hash, n, n_specs;
+
+    object = (GObject *) key;
+    specs = g_object_class_list_properties(G_OBJECT_GET_CLASS(object), &n_specs);
+    hash = G_TYPE_FROM_INSTANCE(object);
+
+    for (n = 0; n < n_specs; ++n) {
+        if ((specs[n]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
+            continue;
+
+        g_value_init(&value, specs[n]->value_type);
+        g_object_get_property(object, specs[n]->name, &value);
+        hash = hash * 31 + _adg_value_hash(&value);
+        g_value_unset(&value);
+    }
+
+    g_free(specs);
+
+    return hash;
+}
+
+static gboolean
+_adg_key_equal(gconstpointer key, gconstpointer key2)
+{
+    return adg_style_equal((AdgStyle *) key, (AdgStyle *) key2);
+}
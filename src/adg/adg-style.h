@@ -51,6 +51,8 @@ struct _AdgStyleClass {
     /*< public >*/
     /* Virtual table */
     AdgStyle *          (*clone)                (AdgStyle       *style);
+    gboolean            (*equal)                (AdgStyle       *style,
+                                                 AdgStyle       *other);
 
     /* Signals */
     void                (*invalidate)           (AdgStyle       *style);
@@ -63,6 +65,9 @@ struct _AdgStyleClass {
 GType                   adg_style_get_type      (void);
 
 AdgStyle *              adg_style_clone         (AdgStyle       *style);
+gboolean                adg_style_equal         (AdgStyle       *style,
+                                                 AdgStyle       *other);
+AdgStyle *              adg_style_intern        (AdgStyle       *style);
 void                    adg_style_invalidate    (AdgStyle       *style);
 void                    adg_style_apply         (AdgStyle       *style,
                                                  AdgEntity      *entity,
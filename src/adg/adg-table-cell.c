@@ -85,6 +85,10 @@ struct _AdgTableCell {
 
 static AdgTableCell *   _adg_cell_new           (void);
 static void             _adg_cell_invalidate    (AdgTableCell   *table_cell);
+static void             _adg_cell_check_grid    (AdgTableCell   *table_cell,
+                                                 const CpmlExtents *old_extents);
+static void             _adg_cell_set_map       (AdgEntity      *entity,
+                                                 const cairo_matrix_t *map);
 static gboolean         _adg_cell_set_title     (AdgTableCell   *table_cell,
                                                  AdgEntity      *title);
 static gboolean         _adg_cell_set_value     (AdgTableCell   *table_cell,
@@ -97,12 +101,14 @@ static void             _adg_cell_set_value_pos (AdgTableCell   *table_cell,
 GType
 adg_table_cell_get_type(void)
 {
-    static GType cell_type = 0;
+    static gsize cell_type = 0;
 
-    if (G_UNLIKELY(cell_type == 0))
-        cell_type = g_boxed_type_register_static("AdgTableCell",
-                                                 (GBoxedCopyFunc) adg_table_cell_dup,
-                                                 (GBoxedFreeFunc) adg_table_cell_free);
+    if (g_once_init_enter(&cell_type)) {
+        GType new_type = g_boxed_type_register_static("AdgTableCell",
+                                                      (GBoxedCopyFunc) adg_table_cell_dup,
+                                                      (GBoxedFreeFunc) adg_table_cell_free);
+        g_once_init_leave(&cell_type, new_type);
+    }
 
     return cell_type;
 }
@@ -180,7 +186,7 @@ adg_table_cell_new_before(AdgTableCell *before_cell)
     table_cell = _adg_cell_new();
     table_cell->row = table_row;
 
-    adg_table_row_insert(table_row, table_cell, NULL);
+    adg_table_row_insert(table_row, table_cell, before_cell);
     _adg_cell_invalidate(table_cell);
 
     return table_cell;
@@ -372,6 +378,9 @@ adg_table_cell_set_title(AdgTableCell *table_cell, AdgEntity *title)
  * entity with the font dress picked from #AdgTable:table-dress with
  * a call to adg_table_style_get_title_dress().
  *
+ * If the current title is already an #AdgTextual entity, only its text
+ * is changed so the layout of the other cells is preserved.
+ *
  * Since: 1.0
  **/
 void
@@ -403,6 +412,13 @@ adg_table_cell_set_text_title(AdgTableCell *table_cell, const gchar *title)
 
         if (unchanged)
             return;
+
+        /* Replacing only the text keeps the entity and its alignment:
+         * the other cells of the table are not invalidated */
+        if (title != NULL && ADG_IS_TEXTUAL(table_cell->title)) {
+            adg_textual_set_text((AdgTextual *) table_cell->title, title);
+            return;
+        }
     }
 
     table = adg_table_cell_get_table(table_cell);
@@ -476,6 +492,9 @@ adg_table_cell_set_value(AdgTableCell *table_cell, AdgEntity *value)
  * entity with a value font dress picked from #AdgTable:table-dress with
  * a call to adg_table_style_get_value_dress().
  *
+ * If the current value is already an #AdgTextual entity, only its text
+ * is changed so the layout of the other cells is preserved.
+ *
  * Since: 1.0
  **/
 void
@@ -506,6 +525,13 @@ adg_table_cell_set_text_value(AdgTableCell *table_cell, const gchar *value)
         g_free(old_value);
         if (unchanged)
             return;
+
+        /* Replacing only the text keeps the entity and its alignment:
+         * the other cells of the table are not invalidated */
+        if (value != NULL && ADG_IS_TEXTUAL(table_cell->value)) {
+            adg_textual_set_text((AdgTextual *) table_cell->value, value);
+            return;
+        }
     }
 
     table = adg_table_cell_get_table(table_cell);
@@ -730,8 +756,10 @@ adg_table_cell_size_request(AdgTableCell *table_cell,
     AdgAlignment *title_alignment;
     AdgAlignment *value_alignment;
     AdgTable *table;
+    CpmlExtents old_extents;
 
     size = &table_cell->extents.size;
+    old_extents = table_cell->extents;
 
     if (table_cell->title) {
         title_alignment = (AdgAlignment *) adg_entity_get_parent(table_cell->title);
@@ -773,6 +801,7 @@ adg_table_cell_size_request(AdgTableCell *table_cell,
         size->x = table_cell->width;
     }
 
+    _adg_cell_check_grid(table_cell, &old_extents);
     return size;
 }
 
@@ -799,11 +828,13 @@ const CpmlExtents *
 adg_table_cell_arrange(AdgTableCell *table_cell, const CpmlExtents *layout)
 {
     CpmlExtents *extents;
+    CpmlExtents old_extents;
     AdgAlignment *alignment;
     cairo_matrix_t map;
 
     /* Set the new extents */
     extents = &table_cell->extents;
+    old_extents = *extents;
     extents->org = layout->org;
     if (layout->size.x > 0)
         extents->size.x = layout->size.x;
@@ -811,11 +842,13 @@ adg_table_cell_arrange(AdgTableCell *table_cell, const CpmlExtents *layout)
         extents->size.y = layout->size.y;
     extents->is_defined = TRUE;
 
+    _adg_cell_check_grid(table_cell, &old_extents);
+
     if (table_cell->title) {
         alignment = (AdgAlignment *) adg_entity_get_parent(table_cell->title);
 
         cairo_matrix_init_translate(&map, extents->org.x, extents->org.y);
-        adg_entity_set_global_map((AdgEntity *) alignment, &map);
+        _adg_cell_set_map((AdgEntity *) alignment, &map);
     }
 
     if (table_cell->value) {
@@ -826,7 +859,7 @@ adg_table_cell_arrange(AdgTableCell *table_cell, const CpmlExtents *layout)
         to.y = extents->size.y * table_cell->value_factor.y + extents->org.y;
 
         cairo_matrix_init_translate(&map, to.x, to.y);
-        adg_entity_set_global_map((AdgEntity *) alignment, &map);
+        _adg_cell_set_map((AdgEntity *) alignment, &map);
     }
 
     return extents;
@@ -860,6 +893,30 @@ _adg_cell_invalidate(AdgTableCell *table_cell)
         adg_entity_invalidate((AdgEntity *) table);
 }
 
+static void
+_adg_cell_check_grid(AdgTableCell *table_cell, const CpmlExtents *old_extents)
+{
+    AdgTable *table;
+
+    /* Only framed cells are part of the grid */
+    if (! table_cell->has_frame ||
+        cpml_extents_equal(&table_cell->extents, old_extents))
+        return;
+
+    table = adg_table_cell_get_table(table_cell);
+    if (table)
+        adg_table_invalidate_grid(table);
+}
+
+static void
+_adg_cell_set_map(AdgEntity *entity, const cairo_matrix_t *map)
+{
+    /* Setting the same map would needlessly rearrange the cell content,
+     * throwing away its measured size */
+    if (! adg_matrix_equal(adg_entity_get_global_map(entity), map))
+        adg_entity_set_global_map(entity, map);
+}
+
 static gboolean
 _adg_cell_set_title(AdgTableCell *table_cell, AdgEntity *title)
 {
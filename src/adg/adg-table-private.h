@@ -40,10 +40,21 @@ struct _AdgTablePrivate {
     AdgTableStyle *table_style;
     AdgStroke     *grid;
     AdgStroke     *frame;
-    GSList        *rows;
+    GPtrArray     *rows;
     GHashTable    *cell_names;
 };
 
+
+/* Parts of a table that can be hidden while rendering: the static
+ * part is what does not depend on the textual values of the cells */
+#define ADG_TABLE_PARTS_STATIC      (1 << 0)
+#define ADG_TABLE_PARTS_DYNAMIC     (1 << 1)
+
+void            _adg_table_set_hidden_parts     (cairo_t        *cr,
+                                                 guint           parts);
+guint           _adg_table_get_hidden_parts     (cairo_t        *cr);
+gchar *         _adg_table_dup_signature        (AdgTable       *table);
+
 G_END_DECLS
 
 
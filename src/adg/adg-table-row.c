@@ -31,6 +31,10 @@
  * by using the #AdgTableCell APIs, such as adg_table_cell_new() or
  * adg_table_cell_new_before().
  *
+ * The cells are kept in a contiguous array: appending a cell and
+ * accessing it by position with adg_table_row_get_nth_cell() are
+ * constant time operations.
+ *
  * Since: 1.0
  **/
 
@@ -56,24 +60,28 @@
 
 struct _AdgTableRow {
     AdgTable      *table;
-    GSList        *cells;
+    GPtrArray     *cells;
     gdouble        height;
     CpmlExtents    extents;
 };
 
 
 static AdgTableRow *    _adg_row_new        (AdgTable       *table);
+static AdgTableCell **  _adg_row_cells      (AdgTableRow    *table_row,
+                                             guint          *n_cells);
 
 
 GType
 adg_table_row_get_type(void)
 {
-    static GType row_type = 0;
+    static gsize row_type = 0;
 
-    if (G_UNLIKELY(row_type == 0))
-        row_type = g_boxed_type_register_static("AdgTableRow",
-                                                (GBoxedCopyFunc) adg_table_row_dup,
-                                                (GBoxedFreeFunc) adg_table_row_free);
+    if (g_once_init_enter(&row_type)) {
+        GType new_type = g_boxed_type_register_static("AdgTableRow",
+                                                      (GBoxedCopyFunc) adg_table_row_dup,
+                                                      (GBoxedFreeFunc) adg_table_row_free);
+        g_once_init_leave(&row_type, new_type);
+    }
 
     return row_type;
 }
@@ -167,10 +175,18 @@ adg_table_row_free(AdgTableRow *table_row)
 {
     AdgTable *table;
 
+    GPtrArray *cells;
+
     g_return_if_fail(table_row != NULL);
 
-    g_slist_foreach(table_row->cells, (GFunc) adg_table_cell_free, NULL);
-    g_slist_free(table_row->cells);
+    /* Detach the cells before freeing them, so adg_table_row_remove()
+     * will not modify the array while it is being walked */
+    cells = table_row->cells;
+    table_row->cells = NULL;
+    if (cells != NULL) {
+        g_ptr_array_foreach(cells, (GFunc) adg_table_cell_free, NULL);
+        g_ptr_array_free(cells, TRUE);
+    }
 
     table = table_row->table;
     if (table != NULL)
@@ -197,17 +213,12 @@ adg_table_row_insert(AdgTableRow *table_row, AdgTableCell *table_cell,
     g_return_if_fail(table_row != NULL);
     g_return_if_fail(table_cell != NULL);
 
-    if (before_cell == NULL) {
-        table_row->cells = g_slist_append(table_row->cells, table_cell);
-    } else {
-        GSList *before = g_slist_find(table_row->cells, before_cell);
+    if (table_row->cells == NULL)
+        table_row->cells = g_ptr_array_new();
 
-        /* This MUST be present, otherwise something really bad happened */
-        g_return_if_fail(before != NULL);
-
-        table_row->cells = g_slist_insert_before(table_row->cells,
-                                                 before, table_cell);
-    }
+    /* before_cell MUST be present, otherwise something really bad happened */
+    if (! _adg_ptr_array_insert(table_row->cells, table_cell, before_cell))
+        g_return_if_reached();
 }
 
 /**
@@ -225,7 +236,10 @@ adg_table_row_remove(AdgTableRow *table_row, AdgTableCell *table_cell)
     g_return_if_fail(table_row != NULL);
     g_return_if_fail(table_cell != NULL);
 
-    table_row->cells = g_slist_remove(table_row->cells, table_cell);
+    if (table_row->cells == NULL)
+        return;
+
+    g_ptr_array_remove(table_row->cells, table_cell);
 }
 
 /**
@@ -250,7 +264,49 @@ adg_table_row_foreach(AdgTableRow *table_row,
     g_return_if_fail(table_row != NULL);
     g_return_if_fail(callback != NULL);
 
-    g_slist_foreach(table_row->cells, (GFunc) callback, user_data);
+    if (table_row->cells != NULL)
+        g_ptr_array_foreach(table_row->cells, (GFunc) callback, user_data);
+}
+
+/**
+ * adg_table_row_get_n_cells:
+ * @table_row: a valid #AdgTableRow
+ *
+ * Gets the number of cells of @table_row.
+ *
+ * Returns: the number of cells or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_table_row_get_n_cells(AdgTableRow *table_row)
+{
+    g_return_val_if_fail(table_row != NULL, 0);
+
+    return table_row->cells != NULL ? table_row->cells->len : 0;
+}
+
+/**
+ * adg_table_row_get_nth_cell:
+ * @table_row: a valid #AdgTableRow
+ * @n: the position of the cell, starting from 0
+ *
+ * Gets the cell of @table_row at position @n. The returned cell
+ * is owned by @table_row and must not be modified or freed.
+ *
+ * Returns: (transfer none): the requested cell or <constant>NULL</constant> if @n is out of range.
+ *
+ * Since: 1.0
+ **/
+AdgTableCell *
+adg_table_row_get_nth_cell(AdgTableRow *table_row, guint n)
+{
+    g_return_val_if_fail(table_row != NULL, NULL);
+
+    if (table_row->cells == NULL || n >= table_row->cells->len)
+        return NULL;
+
+    return g_ptr_array_index(table_row->cells, n);
 }
 
 /**
@@ -352,8 +408,8 @@ adg_table_row_size_request(AdgTableRow *table_row)
     gdouble xpad;
     CpmlExtents *extents;
     CpmlVector *size;
-    AdgTableCell *cell;
-    GSList *cell_node;
+    AdgTableCell **cells;
+    guint n, n_cells;
     const CpmlPair *cell_size;
 
     g_return_val_if_fail(table_row != NULL, NULL);
@@ -371,9 +427,9 @@ adg_table_row_size_request(AdgTableRow *table_row)
         size->y = table_row->height;
 
     /* Compute the row width by summing every cell width */
-    for (cell_node = table_row->cells; cell_node; cell_node = cell_node->next) {
-        cell = cell_node->data;
-        cell_size = adg_table_cell_size_request(cell, extents);
+    cells = _adg_row_cells(table_row, &n_cells);
+    for (n = 0; n < n_cells; ++n) {
+        cell_size = adg_table_cell_size_request(cells[n], extents);
         size->x += cell_size->x + xpad;
     }
 
@@ -411,8 +467,8 @@ adg_table_row_arrange(AdgTableRow *table_row, const CpmlExtents *layout)
     AdgTableStyle *table_style;
     const CpmlPair *spacing;
     gdouble xpad;
-    AdgTableCell *cell;
-    GSList *cell_node;
+    AdgTableCell **cells;
+    guint n, n_cells;
 
     g_return_val_if_fail(table_row != NULL, NULL);
     g_return_val_if_fail(layout != NULL, NULL);
@@ -437,9 +493,9 @@ adg_table_row_arrange(AdgTableRow *table_row, const CpmlExtents *layout)
     cell_layout.size.x = -1;
     cell_layout.size.y = extents->size.y;
 
-    for (cell_node = table_row->cells; cell_node; cell_node = cell_node->next) {
-        cell = cell_node->data;
-        cell_extents = adg_table_cell_arrange(cell, &cell_layout);
+    cells = _adg_row_cells(table_row, &n_cells);
+    for (n = 0; n < n_cells; ++n) {
+        cell_extents = adg_table_cell_arrange(cells[n], &cell_layout);
         cell_layout.org.x += cell_extents->size.x + xpad;
     }
 
@@ -459,3 +515,15 @@ _adg_row_new(AdgTable *table)
 
     return table_row;
 }
+
+static AdgTableCell **
+_adg_row_cells(AdgTableRow *table_row, guint *n_cells)
+{
+    if (table_row->cells == NULL) {
+        *n_cells = 0;
+        return NULL;
+    }
+
+    *n_cells = table_row->cells->len;
+    return (AdgTableCell **) table_row->cells->pdata;
+}
@@ -46,6 +46,9 @@ void            adg_table_row_remove            (AdgTableRow    *table_row,
 void            adg_table_row_foreach           (AdgTableRow    *table_row,
                                                  GCallback       callback,
                                                  gpointer        user_data);
+guint           adg_table_row_get_n_cells       (AdgTableRow    *table_row);
+AdgTableCell *  adg_table_row_get_nth_cell      (AdgTableRow    *table_row,
+                                                 guint           n);
 AdgTable *      adg_table_row_get_table         (AdgTableRow    *table_row);
 void            adg_table_row_set_height        (AdgTableRow    *table_row,
                                                  gdouble         height);
@@ -64,6 +64,9 @@
 #include "adg-table-private.h"
 #include "adg-table-row.h"
 #include "adg-table-cell.h"
+#include "adg-textual.h"
+
+#include <math.h>
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_table_parent_class)
@@ -83,6 +86,9 @@ typedef struct {
     gpointer        user_data;
 } AdgClosure;
 
+/* The parts to hide are bound to the cairo context, as done for the
+ * hidden layers, so renderings on other contexts are not affected */
+static cairo_user_data_key_t _adg_hidden_parts_key;
 
 
 static void         _adg_dispose            (GObject        *object);
@@ -114,9 +120,24 @@ static void         _adg_append_frame       (AdgTableCell   *table_cell,
                                              AdgPath        *path);
 static void         _adg_proxy_signal       (AdgTableCell   *table_cell,
                                              AdgProxyData   *proxy_data);
+static gboolean     _adg_row_is_visible     (AdgEntity      *entity,
+                                             AdgTableRow    *table_row,
+                                             const CpmlExtents *clip);
+static void         _adg_render_cell        (AdgTableCell   *table_cell,
+                                             cairo_t        *cr);
 static gboolean     _adg_value_match        (gpointer        key,
                                              gpointer        value,
                                              gpointer        user_data);
+static AdgTableRow **_adg_rows              (AdgTable       *table,
+                                             guint          *n_rows);
+static void         _adg_append_cell        (AdgTableCell   *table_cell,
+                                             GString        *signature);
+static void         _adg_append_entity      (GString        *signature,
+                                             AdgEntity      *entity);
+static void         _adg_append_value       (GString        *signature,
+                                             const GValue   *value);
+static void         _adg_append_extents     (GString        *signature,
+                                             const CpmlExtents *extents);
 
 
 static void
@@ -189,18 +210,19 @@ _adg_dispose(GObject *object)
     AdgTable *table = (AdgTable *) object;
     AdgTablePrivate *data = table->data;
 
-    adg_table_invalidate_grid(table);
+    if (data->grid) {
+        g_object_unref(data->grid);
+        data->grid = NULL;
+    }
 
     if (data->frame) {
         g_object_unref(data->frame);
         data->frame = NULL;
     }
 
-    if (data->rows) {
+    if (data->rows)
         adg_table_foreach_cell(table,
                                (GCallback) adg_table_cell_dispose, NULL);
-        data->rows = NULL;
-    }
 
     if (_ADG_OLD_OBJECT_CLASS->dispose)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
@@ -215,13 +237,21 @@ _adg_finalize(GObject *object)
     table = (AdgTable *) object;
     data = table->data;
 
-    if (data->rows) {
-        g_slist_foreach(data->rows, (GFunc) adg_table_row_free, NULL);
-        g_slist_free(data->rows);
+    /* Without the names hash table, freeing a cell does not need
+     * to scan it looking for a binding to remove */
+    if (data->cell_names) {
+        g_hash_table_destroy(data->cell_names);
+        data->cell_names = NULL;
     }
 
-    if (data->cell_names)
-        g_hash_table_destroy(data->cell_names);
+    /* Detach the rows before freeing them, so adg_table_remove()
+     * will not modify the array while it is being walked */
+    if (data->rows) {
+        GPtrArray *rows = data->rows;
+        data->rows = NULL;
+        g_ptr_array_foreach(rows, (GFunc) adg_table_row_free, NULL);
+        g_ptr_array_free(rows, TRUE);
+    }
 
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
@@ -303,16 +333,12 @@ adg_table_insert(AdgTable *table, AdgTableRow *table_row,
 
     data = table->data;
 
-    if (before_row == NULL) {
-        data->rows = g_slist_append(data->rows, table_row);
-    } else {
-        GSList *before = g_slist_find(data->rows, before_row);
+    if (data->rows == NULL)
+        data->rows = g_ptr_array_new();
 
-        /* This MUST be present, otherwise something really bad happened */
-        g_return_if_fail(before != NULL);
-
-        data->rows = g_slist_insert_before(data->rows, before, table_row);
-    }
+    /* before_row MUST be present, otherwise something really bad happened */
+    if (! _adg_ptr_array_insert(data->rows, table_row, before_row))
+        g_return_if_reached();
 }
 
 /**
@@ -333,7 +359,9 @@ adg_table_remove(AdgTable *table, AdgTableRow *table_row)
     g_return_if_fail(table_row != NULL);
 
     data = table->data;
-    data->rows = g_slist_remove(data->rows, table_row);
+
+    if (data->rows != NULL)
+        g_ptr_array_remove(data->rows, table_row);
 }
 
 /**
@@ -359,7 +387,56 @@ adg_table_foreach(AdgTable *table, GCallback callback, gpointer user_data)
     g_return_if_fail(table != NULL);
     g_return_if_fail(callback != NULL);
 
-    g_slist_foreach(data->rows, (GFunc) callback, user_data);
+    if (data->rows != NULL)
+        g_ptr_array_foreach(data->rows, (GFunc) callback, user_data);
+}
+
+/**
+ * adg_table_get_n_rows:
+ * @table: an #AdgTable
+ *
+ * Gets the number of rows of @table.
+ *
+ * Returns: the number of rows or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_table_get_n_rows(AdgTable *table)
+{
+    AdgTablePrivate *data;
+
+    g_return_val_if_fail(ADG_IS_TABLE(table), 0);
+
+    data = table->data;
+    return data->rows != NULL ? data->rows->len : 0;
+}
+
+/**
+ * adg_table_get_nth_row:
+ * @table: an #AdgTable
+ * @n: the position of the row, starting from 0
+ *
+ * Gets the row of @table at position @n. The returned row
+ * is owned by @table and must not be modified or freed.
+ *
+ * Returns: (transfer none): the requested row or <constant>NULL</constant> if @n is out of range.
+ *
+ * Since: 1.0
+ **/
+AdgTableRow *
+adg_table_get_nth_row(AdgTable *table, guint n)
+{
+    AdgTablePrivate *data;
+
+    g_return_val_if_fail(ADG_IS_TABLE(table), NULL);
+
+    data = table->data;
+
+    if (data->rows == NULL || n >= data->rows->len)
+        return NULL;
+
+    return g_ptr_array_index(data->rows, n);
 }
 
 /**
@@ -492,6 +569,45 @@ adg_table_get_cell(AdgTable *table, const gchar *name)
     return g_hash_table_lookup(data->cell_names, name);
 }
 
+/**
+ * adg_table_set_text_values:
+ * @table: an #AdgTable
+ * @names: (array length=n_cells): the names of the cells
+ * @values: (array length=n_cells): the new text values
+ * @n_cells: number of items in @names and @values
+ *
+ * Sets the text value of @n_cells named cells of @table in a single
+ * call, as adg_table_cell_set_text_value() would do on every cell
+ * returned by adg_table_get_cell(). A <constant>NULL</constant> item
+ * in @values unsets the value of that cell. The names not bound to
+ * any cell are silently skipped.
+ *
+ * This is mainly intended for language bindings, where filling a
+ * title block or a bill of materials one cell at a time pays the
+ * call overhead on every cell.
+ *
+ * Since: 1.0
+ **/
+void
+adg_table_set_text_values(AdgTable *table, const gchar **names,
+                          const gchar **values, guint n_cells)
+{
+    AdgTableCell *table_cell;
+    guint n;
+
+    g_return_if_fail(ADG_IS_TABLE(table));
+    g_return_if_fail(n_cells == 0 || (names != NULL && values != NULL));
+
+    for (n = 0; n < n_cells; ++n) {
+        if (names[n] == NULL)
+            continue;
+
+        table_cell = adg_table_get_cell(table, names[n]);
+        if (table_cell != NULL)
+            adg_table_cell_set_text_value(table_cell, values[n]);
+    }
+}
+
 /**
  * adg_table_set_table_dress:
  * @table: an #AdgTable
@@ -587,6 +703,7 @@ adg_table_has_frame(AdgTable *table)
  *
  * Clears the internal grid cache, effectively forcing its
  * regeneration next time the #AdgEntity::arrange signal is emitted.
+ * The grid entity and its path are kept and refilled in place.
  **/
 void
 adg_table_invalidate_grid(AdgTable *table)
@@ -597,10 +714,54 @@ adg_table_invalidate_grid(AdgTable *table)
 
     data = table->data;
 
-    if (data->grid) {
-        g_object_unref(data->grid);
-        data->grid = NULL;
+    if (data->grid)
+        adg_model_clear((AdgModel *) adg_stroke_get_trail(data->grid));
+}
+
+/* Hides @parts (a mask of ADG_TABLE_PARTS_... values) of any table
+ * rendered on @cr: 0 restores the full rendering */
+void
+_adg_table_set_hidden_parts(cairo_t *cr, guint parts)
+{
+    cairo_set_user_data(cr, &_adg_hidden_parts_key,
+                        GUINT_TO_POINTER(parts), NULL);
+}
+
+guint
+_adg_table_get_hidden_parts(cairo_t *cr)
+{
+    return GPOINTER_TO_UINT(cairo_get_user_data(cr, &_adg_hidden_parts_key));
+}
+
+/* Builds a string that changes whenever the static part of the
+ * arranged @table (frame, grid, titles and non-textual values)
+ * would be rendered differently. The textual values are left out,
+ * so tables differing only in their contents share the signature */
+gchar *
+_adg_table_dup_signature(AdgTable *table)
+{
+    AdgTablePrivate *data;
+    AdgEntity *entity;
+    GString *signature;
+    AdgTableRow **rows;
+    guint n, n_rows;
+
+    data = table->data;
+    entity = (AdgEntity *) table;
+    signature = g_string_new(G_OBJECT_TYPE_NAME(table));
+
+    g_string_append_printf(signature, " %d %d %p", data->table_dress,
+                           data->has_frame,
+                           (gpointer) adg_entity_style(entity, data->table_dress));
+    _adg_append_extents(signature, adg_entity_get_extents(entity));
+
+    rows = _adg_rows(table, &n_rows);
+    for (n = 0; n < n_rows; ++n) {
+        g_string_append(signature, "\n");
+        adg_table_row_foreach(rows[n], (GCallback) _adg_append_cell, signature);
     }
+
+    return g_string_free(signature, FALSE);
 }
 
 
@@ -647,8 +808,8 @@ _adg_arrange(AdgEntity *entity)
     const CpmlExtents *row_extents;
     const CpmlPair *spacing;
     const CpmlPair *size;
-    GSList *row_node;
-    AdgTableRow *row;
+    AdgTableRow **rows;
+    guint n, n_rows;
 
     table = (AdgTable *) entity;
     data = table->data;
@@ -661,9 +822,9 @@ _adg_arrange(AdgEntity *entity)
     spacing = adg_table_style_get_cell_spacing(data->table_style);
 
     /* Compute the size of the table */
-    for (row_node = data->rows; row_node; row_node = row_node->next) {
-        row = row_node->data;
-        size = adg_table_row_size_request(row);
+    rows = _adg_rows(table, &n_rows);
+    for (n = 0; n < n_rows; ++n) {
+        size = adg_table_row_size_request(rows[n]);
 
         if (size->x > extents.size.x)
             extents.size.x = size->x;
@@ -676,9 +837,8 @@ _adg_arrange(AdgEntity *entity)
     row_layout.org.y = extents.org.y + spacing->y;
     row_layout.size.x = extents.size.x;
     row_layout.size.y = -1;
-    for (row_node = data->rows; row_node; row_node = row_node->next) {
-        row = row_node->data;
-        row_extents = adg_table_row_arrange(row, &row_layout);
+    for (n = 0; n < n_rows; ++n) {
+        row_extents = adg_table_row_arrange(rows[n], &row_layout);
         row_layout.org.y += row_extents->size.y + spacing->y;
     }
 
@@ -686,8 +846,9 @@ _adg_arrange(AdgEntity *entity)
     _adg_arrange_frame(entity, &extents);
 
     extents.is_defined = TRUE;
-    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
-    cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
+    cpml_extents_transform_chained(&extents,
+                                   _adg_entity_get_global_matrix(entity),
+                                   _adg_entity_get_local_matrix(entity));
     adg_entity_set_extents(entity, &extents);
 }
 
@@ -697,29 +858,30 @@ _adg_arrange_grid(AdgEntity *entity)
     AdgTable *table;
     AdgTablePrivate *data;
     AdgPath *path;
-    AdgTrail *trail;
     AdgDress dress;
 
     table = (AdgTable *) entity;
     data = table->data;
 
-    if (data->grid)
-        return;
-
-    path = adg_path_new();
-    trail = (AdgTrail *) path;
-
-    adg_table_foreach_cell(table, (GCallback) _adg_append_frame, path);
+    if (data->grid == NULL) {
+        path = adg_path_new();
+        dress = adg_table_style_get_grid_dress(data->table_style);
+        data->grid = g_object_new(ADG_TYPE_STROKE,
+                                  "line-dress", dress,
+                                  "trail", path,
+                                  "parent", entity,
+                                  NULL);
+        g_object_unref(path);
+    } else {
+        path = (AdgPath *) adg_stroke_get_trail(data->grid);
+    }
 
-    if (!adg_trail_get_extents(trail)->is_defined)
-        return;
+    /* An empty path means the grid must be (re)generated */
+    if (! adg_trail_get_extents((AdgTrail *) path)->is_defined) {
+        adg_table_foreach_cell(table, (GCallback) _adg_append_frame, path);
+        adg_entity_invalidate((AdgEntity *) data->grid);
+    }
 
-    dress = adg_table_style_get_grid_dress(data->table_style);
-    data->grid = g_object_new(ADG_TYPE_STROKE,
-                              "line-dress", dress,
-                              "trail", trail,
-                              "parent", entity,
-                              NULL);
     adg_entity_arrange((AdgEntity *) data->grid);
 }
 
@@ -734,11 +896,33 @@ _adg_arrange_frame(AdgEntity *entity, const CpmlExtents *extents)
 
     data = ((AdgTable *) entity)->data;
 
-    if (data->frame || !data->has_frame)
+    if (!data->has_frame)
         return;
 
-    path = adg_path_new();
-    trail = (AdgTrail *) path;
+    if (data->frame == NULL) {
+        path = adg_path_new();
+        trail = (AdgTrail *) path;
+        dress = adg_table_style_get_frame_dress(data->table_style);
+        data->frame = g_object_new(ADG_TYPE_STROKE,
+                                   "line-dress", dress,
+                                   "trail", trail,
+                                   "parent", entity,
+                                   NULL);
+        g_object_unref(path);
+    } else {
+        trail = adg_stroke_get_trail(data->frame);
+        path = (AdgPath *) trail;
+
+        /* The frame is refilled in place only when the table has
+         * been resized */
+        if (cpml_pair_equal(&adg_trail_get_extents(trail)->org, &extents->org) &&
+            cpml_pair_equal(&adg_trail_get_extents(trail)->size, &extents->size)) {
+            adg_entity_arrange((AdgEntity *) data->frame);
+            return;
+        }
+
+        adg_model_clear((AdgModel *) path);
+    }
 
     cpml_pair_copy(&pair, &extents->org);
     adg_path_move_to(path, &pair);
@@ -750,23 +934,61 @@ _adg_arrange_frame(AdgEntity *entity, const CpmlExtents *extents)
     adg_path_line_to(path, &pair);
     adg_path_close(path);
 
-    dress = adg_table_style_get_frame_dress(data->table_style);
-    data->frame = g_object_new(ADG_TYPE_STROKE,
-                               "line-dress", dress,
-                               "trail", trail,
-                               "parent", entity,
-                               NULL);
+    adg_entity_invalidate((AdgEntity *) data->frame);
     adg_entity_arrange((AdgEntity *) data->frame);
 }
 
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
-    AdgTablePrivate *data = ((AdgTable *) entity)->data;
+    AdgTablePrivate *data;
+    CpmlExtents clip;
+    gdouble dx, dy;
+    AdgTableRow **rows;
+    guint n, n_rows, hidden_parts;
+
+    data = ((AdgTable *) entity)->data;
+    hidden_parts = _adg_table_get_hidden_parts(cr);
 
     adg_style_apply((AdgStyle *) data->table_style, entity, cr);
 
-    _adg_propagate((AdgTable *) entity, "render", cr);
+    if ((hidden_parts & ADG_TABLE_PARTS_STATIC) == 0) {
+        if (data->frame)
+            adg_entity_render((AdgEntity *) data->frame, cr);
+        if (data->grid)
+            adg_entity_render((AdgEntity *) data->grid, cr);
+    }
+
+    /* The cell contents are not readable in a preview */
+    if (adg_has_preview(cr))
+        return;
+
+    cairo_clip_extents(cr, &clip.org.x, &clip.org.y, &clip.size.x, &clip.size.y);
+    clip.size.x -= clip.org.x;
+    clip.size.y -= clip.org.y;
+
+    /* An empty box is returned by unbounded surfaces: that
+     * case is considered as "no clip" */
+    clip.is_defined = clip.size.x > 0 && clip.size.y > 0;
+
+    if (clip.is_defined) {
+        /* Enlarge the clip box to include the pen related details,
+         * in the same way done by the entity culling */
+        dx = dy = 10;
+        cairo_device_to_user_distance(cr, &dx, &dy);
+        clip.org.x -= fabs(dx);
+        clip.org.y -= fabs(dy);
+        clip.size.x += fabs(dx) * 2;
+        clip.size.y += fabs(dy) * 2;
+    }
+
+    /* Big tables are usually only partially visible: skip the rows
+     * outside the clip box without walking their cells at all */
+    rows = _adg_rows((AdgTable *) entity, &n_rows);
+    for (n = 0; n < n_rows; ++n) {
+        if (_adg_row_is_visible(entity, rows[n], &clip))
+            adg_table_row_foreach(rows[n], (GCallback) _adg_render_cell, cr);
+    }
 }
 
 static void
@@ -852,6 +1074,49 @@ _adg_proxy_signal(AdgTableCell *table_cell, AdgProxyData *proxy_data)
     }
 }
 
+static gboolean
+_adg_row_is_visible(AdgEntity *entity, AdgTableRow *table_row,
+                    const CpmlExtents *clip)
+{
+    CpmlExtents extents;
+
+    cpml_extents_copy(&extents, adg_table_row_get_extents(table_row));
+
+    if (! clip->is_defined || ! extents.is_defined)
+        return TRUE;
+
+    /* Use the same transformations applied to the table extents */
+    cpml_extents_transform_chained(&extents,
+                                   _adg_entity_get_global_matrix(entity),
+                                   _adg_entity_get_local_matrix(entity));
+
+    return extents.org.x <= clip->org.x + clip->size.x &&
+           extents.org.y <= clip->org.y + clip->size.y &&
+           extents.org.x + extents.size.x >= clip->org.x &&
+           extents.org.y + extents.size.y >= clip->org.y;
+}
+
+static void
+_adg_render_cell(AdgTableCell *table_cell, cairo_t *cr)
+{
+    AdgEntity *entity;
+    guint hidden_parts, part;
+
+    hidden_parts = _adg_table_get_hidden_parts(cr);
+
+    entity = adg_table_cell_title(table_cell);
+    if (entity && (hidden_parts & ADG_TABLE_PARTS_STATIC) == 0)
+        adg_entity_render(adg_entity_get_parent(entity), cr);
+
+    entity = adg_table_cell_value(table_cell);
+    if (entity) {
+        part = ADG_IS_TEXTUAL(entity) ?
+            ADG_TABLE_PARTS_DYNAMIC : ADG_TABLE_PARTS_STATIC;
+        if ((hidden_parts & part) == 0)
+            adg_entity_render(adg_entity_get_parent(entity), cr);
+    }
+}
+
 static gboolean
 _adg_value_match(gpointer key, gpointer value, gpointer user_data)
 {
@@ -863,3 +1128,114 @@ _adg_value_match(gpointer key, gpointer value, gpointer user_data)
     }
     return FALSE;
 }
+
+static AdgTableRow **
+_adg_rows(AdgTable *table, guint *n_rows)
+{
+    AdgTablePrivate *data = table->data;
+
+    if (data->rows == NULL) {
+        *n_rows = 0;
+        return NULL;
+    }
+
+    *n_rows = data->rows->len;
+    return (AdgTableRow **) data->rows->pdata;
+}
+
+static void
+_adg_append_cell(AdgTableCell *table_cell, GString *signature)
+{
+    AdgEntity *entity;
+
+    g_string_append_printf(signature, " [%.17g %d",
+                           adg_table_cell_get_width(table_cell),
+                           adg_table_cell_has_frame(table_cell));
+    _adg_append_extents(signature, adg_table_cell_get_extents(table_cell));
+
+    /* The title is always static, the value only if not textual */
+    entity = adg_table_cell_title(table_cell);
+    if (entity)
+        _adg_append_entity(signature, entity);
+
+    entity = adg_table_cell_value(table_cell);
+    if (entity && ! ADG_IS_TEXTUAL(entity))
+        _adg_append_entity(signature, entity);
+
+    g_string_append_c(signature, ']');
+}
+
+/* Appends the type, the extents and the plain properties of @entity:
+ * object properties are skipped, as they are not part of the state
+ * that can be compared by value */
+static void
+_adg_append_entity(GString *signature, AdgEntity *entity)
+{
+    GParamSpec **specs;
+    guint n, n_specs;
+    GType type;
+    GValue value = { 0 };
+
+    g_string_append_printf(signature, " %s", G_OBJECT_TYPE_NAME(entity));
+    _adg_append_extents(signature, adg_entity_get_extents(entity));
+
+    specs = g_object_class_list_properties(G_OBJECT_GET_CLASS(entity), &n_specs);
+    for (n = 0; n < n_specs; ++n) {
+        type = G_PARAM_SPEC_VALUE_TYPE(specs[n]);
+        if ((specs[n]->flags & G_PARAM_READABLE) == 0 ||
+            G_TYPE_IS_OBJECT(type) || G_TYPE_IS_INTERFACE(type) ||
+            type == G_TYPE_POINTER)
+            continue;
+
+        g_value_init(&value, type);
+        g_object_get_property((GObject *) entity, specs[n]->name, &value);
+        g_string_append_printf(signature, " %s=", specs[n]->name);
+        _adg_append_value(signature, &value);
+        g_value_unset(&value);
+    }
+
+    g_free(specs);
+}
+
+static void
+_adg_append_value(GString *signature, const GValue *value)
+{
+    gchar *contents;
+
+    if (G_VALUE_HOLDS(value, CAIRO_GOBJECT_TYPE_MATRIX)) {
+        const cairo_matrix_t *matrix = g_value_get_boxed(value);
+
+        if (matrix != NULL) {
+            g_string_append_printf(signature, "%.17g,%.17g,%.17g,%.17g,%.17g,%.17g",
+                                   matrix->xx, matrix->yx, matrix->xy,
+                                   matrix->yy, matrix->x0, matrix->y0);
+            return;
+        }
+    } else if (G_VALUE_HOLDS(value, CPML_TYPE_PAIR)) {
+        const CpmlPair *pair = g_value_get_boxed(value);
+
+        if (pair != NULL) {
+            g_string_append_printf(signature, "%.17g,%.17g", pair->x, pair->y);
+            return;
+        }
+    }
+
+    /* Good enough for numbers, enums, flags and strings: the other
+     * boxed values are printed by address, so they never match */
+    contents = g_strdup_value_contents(value);
+    g_string_append(signature, contents);
+    g_free(contents);
+}
+
+static void
+_adg_append_extents(GString *signature, const CpmlExtents *extents)
+{
+    if (extents == NULL || ! extents->is_defined) {
+        g_string_append(signature, " -");
+        return;
+    }
+
+    g_string_append_printf(signature, " %.17g,%.17g,%.17g,%.17g",
+                           extents->org.x, extents->org.y,
+                           extents->size.x, extents->size.y);
+}
@@ -64,6 +64,9 @@ void            adg_table_remove                (AdgTable       *table,
 void            adg_table_foreach               (AdgTable       *table,
                                                  GCallback       callback,
                                                  gpointer        user_data);
+guint           adg_table_get_n_rows            (AdgTable       *table);
+AdgTableRow *   adg_table_get_nth_row           (AdgTable       *table,
+                                                 guint           n);
 void            adg_table_foreach_cell          (AdgTable       *table,
                                                  GCallback       callback,
                                                  gpointer        user_data);
@@ -72,6 +75,10 @@ void            adg_table_set_cell              (AdgTable       *table,
                                                  AdgTableCell   *table_cell);
 AdgTableCell *  adg_table_get_cell              (AdgTable       *table,
                                                  const gchar    *name);
+void            adg_table_set_text_values       (AdgTable       *table,
+                                                 const gchar   **names,
+                                                 const gchar   **values,
+                                                 guint           n_cells);
 AdgStyle *      adg_table_get_table_style       (AdgTable       *table);
 void            adg_table_set_table_dress       (AdgTable       *table,
                                                  AdgDress        dress);
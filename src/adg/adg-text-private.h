@@ -30,6 +30,8 @@ struct _AdgTextPrivate {
     AdgDress             font_dress;
     gchar               *text;
 
+    gboolean             metrics_only;
+
     PangoLayout         *layout;
     CpmlExtents          raw_extents;
 };
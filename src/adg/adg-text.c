@@ -28,6 +28,17 @@
  *
  * The text entity is not subject to the local matrix, only its origin is.
  *
+ * The pango layouts are kept in a process-wide cache shared by all the
+ * #AdgText instances, so texts with the same string, font and spacing
+ * are shaped only once. The layout is updated to the cairo context
+ * just before being rendered, hence sharing it is harmless.
+ *
+ * When only the extents are needed (e.g. to autoscale a canvas or to
+ * compute the sheet size), #AdgText:metrics-only can be enabled: the
+ * extents are then estimated from cached per-font advance tables and
+ * the text is shaped only when it is rendered. The estimate does not
+ * take kerning and ligatures into account.
+ *
  * <note><para>
  * By default, the #AdgEntity:local-mix property is set to
  * #ADG_MIX_ANCESTORS_NORMALIZED on #AdgText entities.
@@ -59,10 +70,15 @@
 #include "adg-text.h"
 #include "adg-text-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_text_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_text_parent_class)
 
+/* Maximum number of layouts kept by the process-wide layout cache */
+#define _ADG_LAYOUT_CACHE_SIZE  256
+
 
 static void             _adg_iface_init         (AdgTextualIface *iface);
 
@@ -73,7 +89,8 @@ G_DEFINE_TYPE_WITH_CODE(AdgText, adg_text, ADG_TYPE_ENTITY,
 enum {
     PROP_0,
     PROP_FONT_DRESS,
-    PROP_TEXT
+    PROP_TEXT,
+    PROP_METRICS_ONLY
 };
 
 
@@ -93,14 +110,48 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
+static void             _adg_trim_caches        (AdgEntity      *entity,
+                                                 AdgTrimLevel    level);
 static void             _adg_set_font_dress     (AdgTextual     *textual,
                                                  AdgDress        dress);
 static AdgDress         _adg_get_font_dress     (AdgTextual     *textual);
 static void             _adg_set_text           (AdgTextual     *textual,
                                                  const gchar    *text);
 static gchar *          _adg_dup_text           (AdgTextual     *textual);
+static void             _adg_shape              (AdgTextual     *textual);
+static void             _adg_iface_shape        (AdgTextual     *textual);
+static void             _adg_estimate           (AdgText        *text);
 static void             _adg_refresh_extents    (AdgText        *text);
 static void             _adg_clear_layout       (AdgText        *text);
+static PangoLayout *    _adg_cached_layout      (AdgPangoStyle  *pango_style,
+                                                 const gchar    *text);
+static PangoContext *   _adg_cached_context     (const cairo_font_options_t *options);
+static void             _adg_show_outlines      (AdgFontStyle   *font_style,
+                                                 cairo_t        *cr,
+                                                 PangoLayout    *layout);
+
+typedef struct {
+    gchar       *key;
+    PangoLayout *layout;
+} AdgLayoutItem;
+
+/* Layouts are shared by all the texts with the same string, font and
+ * spacing: the most recently used ones are kept at the head of the
+ * queue while the hash table maps the keys to the queue links */
+static GHashTable *     _adg_layouts = NULL;
+static GQueue           _adg_layout_queue = G_QUEUE_INIT;
+static GHashTable *     _adg_contexts = NULL;
+
+typedef struct {
+    gint         line_height;
+    GHashTable  *advances;
+} AdgFontMetrics;
+
+/* Per-font metrics used by #AdgText:metrics-only, indexed by the
+ * font description and options. Protected by the layout cache lock */
+static GHashTable *     _adg_metrics = NULL;
+G_LOCK_DEFINE_STATIC(_adg_layout_cache);
 
 
 static void
@@ -108,6 +159,7 @@ adg_text_class_init(AdgTextClass *klass)
 {
     GObjectClass *gobject_class;
     AdgEntityClass *entity_class;
+    GParamSpec *param;
 
     gobject_class = (GObjectClass *) klass;
     entity_class = (AdgEntityClass *) klass;
@@ -124,9 +176,18 @@ adg_text_class_init(AdgTextClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
+    entity_class->trim_caches = _adg_trim_caches;
 
     g_object_class_override_property(gobject_class, PROP_FONT_DRESS, "font-dress");
     g_object_class_override_property(gobject_class, PROP_TEXT, "text");
+
+    param = g_param_spec_boolean("metrics-only",
+                                 P_("Metrics Only"),
+                                 P_("Whether the extents must be estimated from the font metrics, deferring the text shaping to the rendering"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_METRICS_ONLY, param);
 }
 
 static void
@@ -136,6 +197,7 @@ _adg_iface_init(AdgTextualIface *iface)
     iface->get_font_dress = _adg_get_font_dress;
     iface->set_text = _adg_set_text;
     iface->dup_text = _adg_dup_text;
+    iface->shape = _adg_iface_shape;
     iface->text_changed = NULL;
 }
 
@@ -148,6 +210,7 @@ adg_text_init(AdgText *text)
 
     data->font_dress = ADG_DRESS_FONT_TEXT;
     data->text = NULL;
+    data->metrics_only = FALSE;
     data->layout = NULL;
 
     text->data = data;
@@ -197,6 +260,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_TEXT:
         g_value_set_string(value, data->text);
         break;
+    case PROP_METRICS_ONLY:
+        g_value_set_boolean(value, data->metrics_only);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -223,6 +289,10 @@ _adg_set_property(GObject *object, guint prop_id,
         data->text = g_value_dup_string(value);
         _adg_clear_layout(text);
         break;
+    case PROP_METRICS_ONLY:
+        data->metrics_only = g_value_get_boolean(value);
+        _adg_clear_layout(text);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -247,6 +317,47 @@ adg_text_new(const gchar *text)
                         "text", text, NULL);
 }
 
+/**
+ * adg_text_set_metrics_only:
+ * @text: an #AdgText
+ * @metrics_only: the new metrics-only flag
+ *
+ * Sets the #AdgText:metrics-only property of @text. When enabled,
+ * the arrange phase estimates the extents of @text from the font
+ * metrics without shaping it: the text will be shaped, if ever,
+ * only when rendered.
+ *
+ * Since: 1.0
+ **/
+void
+adg_text_set_metrics_only(AdgText *text, gboolean metrics_only)
+{
+    g_return_if_fail(ADG_IS_TEXT(text));
+    g_object_set(text, "metrics-only", metrics_only, NULL);
+}
+
+/**
+ * adg_text_get_metrics_only:
+ * @text: an #AdgText
+ *
+ * Checks if the extents of @text are estimated from the font metrics.
+ * See adg_text_set_metrics_only() for details.
+ *
+ * Returns: <constant>TRUE</constant> if the metrics-only mode is enabled, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_text_get_metrics_only(AdgText *text)
+{
+    AdgTextPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_TEXT(text), FALSE);
+
+    data = text->data;
+    return data->metrics_only;
+}
+
 
 static void
 _adg_global_changed(AdgEntity *entity)
@@ -280,7 +391,6 @@ _adg_arrange(AdgEntity *entity)
 {
     AdgText *text;
     AdgTextPrivate *data;
-    PangoRectangle size;
 
     text = (AdgText *) entity;
     data = text->data;
@@ -292,61 +402,44 @@ _adg_arrange(AdgEntity *entity)
         adg_entity_set_extents(entity, &new_extents);
         _adg_clear_layout(text);
         return;
-    } else if (data->layout != NULL) {
-        /* Cached result */
-        return;
     }
 
+    /* The layout could be already there, e.g. built by a shaping pass */
     if (data->layout == NULL) {
-        static PangoFontMap *font_map = NULL;
-        AdgDress dress;
-        AdgPangoStyle *pango_style;
-        PangoFontDescription *font_description;
-        cairo_font_options_t *options;
-        PangoContext *context;
-
-        /* Keep around the font_map object. The rationale is:
-         * https://bugzilla.gnome.org/show_bug.cgi?id=143542
-         *
-         * Basically, PangoFontMap is a heavy object and
-         * creating/destroying it is not the right thing to do.
-         *
-         * In reality, the blocking issue for me was the following
-         * line makes the adg-demo program crash on MinGW32:
-         * g_object_unref(font_map);
-         */
-        if (font_map == NULL)
-            font_map = pango_cairo_font_map_new();
-
-        dress = data->font_dress;
-        pango_style = (AdgPangoStyle *) adg_entity_style(entity, dress);
-        font_description = adg_pango_style_get_description(pango_style);
-
-        context = pango_context_new();
-        pango_context_set_font_map(context, font_map);
-        pango_cairo_context_set_resolution(context, 72);
+        if (data->metrics_only)
+            _adg_estimate(text);
+        else
+            _adg_shape((AdgTextual *) entity);
+    }
 
-        options = adg_font_style_new_options((AdgFontStyle *) pango_style);
-        pango_cairo_context_set_font_options(context, options);
-        cairo_font_options_destroy(options);
+    _adg_refresh_extents(text);
+}
 
-        data->layout = pango_layout_new(context);
-        g_object_unref(context);
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgTextPrivate *data = ((AdgText *) entity)->data;
+    gsize usage, length;
 
-        pango_layout_set_spacing(data->layout, adg_pango_style_get_spacing(pango_style));
-        pango_layout_set_text(data->layout, data->text, -1);
-        pango_layout_set_font_description(data->layout, font_description);
-    }
+    usage = _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgTextPrivate);
+    length = data->text != NULL ? strlen(data->text) : 0;
+    usage += length + 1;
 
-    pango_layout_get_extents(data->layout, NULL, &size);
+    /* PangoLayout does not expose its size: estimate one glyph and
+     * one log attribute per byte on top of the bare instance */
+    if (data->layout != NULL)
+        usage += 256 + length * (sizeof(PangoGlyphInfo) + sizeof(PangoLogAttr));
 
-    data->raw_extents.org.x = pango_units_to_double(size.x);
-    data->raw_extents.org.y = pango_units_to_double(size.y);
-    data->raw_extents.size.x = pango_units_to_double(size.width);
-    data->raw_extents.size.y = pango_units_to_double(size.height);
-    data->raw_extents.is_defined = TRUE;
+    return usage;
+}
 
-    _adg_refresh_extents((AdgText *) entity);
+static void
+_adg_trim_caches(AdgEntity *entity, AdgTrimLevel level)
+{
+    /* The layout is shaped again by the next rendering */
+    _adg_clear_layout((AdgText *) entity);
+    _ADG_OLD_ENTITY_CLASS->trim_caches(entity, level);
 }
 
 static void
@@ -354,24 +447,101 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 {
     AdgText *text;
     AdgTextPrivate *data;
+    AdgFontStyle *font_style;
 
     text = (AdgText *) entity;
     data = text->data;
 
+    /* Metrics-only or trimmed text: shape it now, keeping the extents */
+    if (data->layout == NULL)
+        _adg_shape((AdgTextual *) entity);
+
     if (data->layout != NULL) {
         adg_entity_apply_dress(entity, data->font_dress, cr);
-        cairo_transform(cr, adg_entity_get_global_matrix(entity));
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_transform(cr, adg_entity_get_combined_matrix(entity));
 
         /* Realign the text to follow the cairo toy text convention:
          * use bottom/left corner as reference (pango uses top/left). */
         cairo_translate(cr, 0, -data->raw_extents.size.y);
 
         pango_cairo_update_layout(cr, data->layout);
-        pango_cairo_show_layout(cr, data->layout);
+
+        font_style = (AdgFontStyle *) adg_entity_style(entity, data->font_dress);
+        if (adg_font_style_has_outlines(font_style))
+            _adg_show_outlines(font_style, cr, data->layout);
+        else
+            pango_cairo_show_layout(cr, data->layout);
     }
 }
 
+#if PANGO_VERSION_CHECK(1, 18, 0)
+
+/* Fills the glyph outlines of @layout, one glyph run at a time, using
+ * the outline cache of AdgFontStyle */
+static void
+_adg_show_outlines(AdgFontStyle *font_style, cairo_t *cr, PangoLayout *layout)
+{
+    PangoLayoutIter *iter;
+    PangoLayoutRun *run;
+    PangoGlyphString *string;
+    PangoRectangle logical;
+    cairo_scaled_font_t *font;
+    cairo_glyph_t *glyphs;
+    gint baseline, x, n, num_glyphs;
+
+    iter = pango_layout_get_iter(layout);
+
+    do {
+        run = pango_layout_iter_get_run(iter);
+        if (run == NULL)
+            continue;
+
+        font = pango_cairo_font_get_scaled_font((PangoCairoFont *) run->item->analysis.font);
+        if (font == NULL)
+            continue;
+
+        string = run->glyphs;
+        baseline = pango_layout_iter_get_baseline(iter);
+        pango_layout_iter_get_run_extents(iter, NULL, &logical);
+        x = logical.x;
+
+        glyphs = cairo_glyph_allocate(string->num_glyphs);
+        num_glyphs = 0;
+
+        for (n = 0; n < string->num_glyphs; ++n) {
+            PangoGlyphInfo *info = &string->glyphs[n];
+
+            if (info->glyph != PANGO_GLYPH_EMPTY &&
+                (info->glyph & PANGO_GLYPH_UNKNOWN_FLAG) == 0) {
+                glyphs[num_glyphs].index = info->glyph;
+                glyphs[num_glyphs].x = (gdouble) (x + info->geometry.x_offset) / PANGO_SCALE;
+                glyphs[num_glyphs].y = (gdouble) (baseline + info->geometry.y_offset) / PANGO_SCALE;
+                ++num_glyphs;
+            }
+
+            x += info->geometry.width;
+        }
+
+        adg_font_style_show_glyphs(font_style, cr, font, glyphs, num_glyphs);
+        cairo_glyph_free(glyphs);
+    } while (pango_layout_iter_next_run(iter));
+
+    pango_layout_iter_free(iter);
+}
+
+#else
+
+static void
+_adg_show_outlines(AdgFontStyle *font_style, cairo_t *cr, PangoLayout *layout)
+{
+    /* Scaled fonts not accessible: fill the (uncached) layout path */
+    cairo_new_path(cr);
+    pango_cairo_layout_path(cr, layout);
+    cairo_fill(cr);
+}
+
+#endif
+
 static void
 _adg_set_font_dress(AdgTextual *textual, AdgDress dress)
 {
@@ -398,6 +568,137 @@ _adg_dup_text(AdgTextual *textual)
     return g_strdup(data->text);
 }
 
+static void
+_adg_shape(AdgTextual *textual)
+{
+    AdgEntity *entity;
+    AdgTextPrivate *data;
+    AdgPangoStyle *pango_style;
+    PangoRectangle size;
+
+    entity = (AdgEntity *) textual;
+    data = ((AdgText *) textual)->data;
+
+    if (data->layout != NULL || adg_is_string_empty(data->text))
+        return;
+
+    pango_style = (AdgPangoStyle *) adg_entity_style(entity, data->font_dress);
+    data->layout = _adg_cached_layout(pango_style, data->text);
+
+    pango_layout_get_extents(data->layout, NULL, &size);
+
+    data->raw_extents.org.x = pango_units_to_double(size.x);
+    data->raw_extents.org.y = pango_units_to_double(size.y);
+    data->raw_extents.size.x = pango_units_to_double(size.width);
+    data->raw_extents.size.y = pango_units_to_double(size.height);
+    data->raw_extents.is_defined = TRUE;
+}
+
+static void
+_adg_iface_shape(AdgTextual *textual)
+{
+    AdgTextPrivate *data = ((AdgText *) textual)->data;
+
+    /* Shaping in advance would defeat the metrics-only mode */
+    if (! data->metrics_only)
+        _adg_shape(textual);
+}
+
+/* Estimates the raw extents of @text by summing the advances of its
+ * characters, without building any layout */
+static void
+_adg_estimate(AdgText *text)
+{
+    AdgTextPrivate *data;
+    AdgPangoStyle *pango_style;
+    PangoFontDescription *font_description;
+    const cairo_font_options_t *options;
+    gchar *font_name, *key;
+    AdgFontMetrics *metrics;
+    PangoContext *context;
+    const gchar *p;
+    gint spacing, n_lines, width, max_width;
+
+    data = text->data;
+    pango_style = (AdgPangoStyle *) adg_entity_style((AdgEntity *) text,
+                                                     data->font_dress);
+    font_description = adg_pango_style_get_description(pango_style);
+    spacing = adg_pango_style_get_spacing(pango_style);
+    options = adg_font_style_get_options((AdgFontStyle *) pango_style);
+
+    font_name = pango_font_description_to_string(font_description);
+    key = g_strdup_printf("%lu\x1f%s",
+                          cairo_font_options_hash(options), font_name);
+    g_free(font_name);
+
+    G_LOCK(_adg_layout_cache);
+
+    if (_adg_metrics == NULL)
+        _adg_metrics = g_hash_table_new(g_str_hash, g_str_equal);
+
+    context = _adg_cached_context(options);
+    metrics = g_hash_table_lookup(_adg_metrics, key);
+
+    if (metrics == NULL) {
+        PangoFontMetrics *font_metrics;
+
+        font_metrics = pango_context_get_metrics(context, font_description, NULL);
+        metrics = g_new(AdgFontMetrics, 1);
+        metrics->line_height = pango_font_metrics_get_ascent(font_metrics) +
+                               pango_font_metrics_get_descent(font_metrics);
+        metrics->advances = g_hash_table_new(NULL, NULL);
+        pango_font_metrics_unref(font_metrics);
+
+        g_hash_table_insert(_adg_metrics, key, metrics);
+    } else {
+        g_free(key);
+    }
+
+    n_lines = 1;
+    width = max_width = 0;
+
+    for (p = data->text; *p != '\0'; p = g_utf8_next_char(p)) {
+        gunichar ch = g_utf8_get_char(p);
+        gpointer advance;
+
+        if (ch == '\n') {
+            ++n_lines;
+            width = 0;
+            continue;
+        }
+
+        if (! g_hash_table_lookup_extended(metrics->advances,
+                                           GUINT_TO_POINTER(ch),
+                                           NULL, &advance)) {
+            /* Unknown character: measure it once and for all */
+            PangoLayout *layout;
+            PangoRectangle size;
+
+            layout = pango_layout_new(context);
+            pango_layout_set_font_description(layout, font_description);
+            pango_layout_set_text(layout, p, g_utf8_next_char(p) - p);
+            pango_layout_get_extents(layout, NULL, &size);
+            g_object_unref(layout);
+
+            advance = GINT_TO_POINTER(size.width);
+            g_hash_table_insert(metrics->advances, GUINT_TO_POINTER(ch), advance);
+        }
+
+        width += GPOINTER_TO_INT(advance);
+        if (width > max_width)
+            max_width = width;
+    }
+
+    data->raw_extents.org.x = 0;
+    data->raw_extents.org.y = 0;
+    data->raw_extents.size.x = pango_units_to_double(max_width);
+    data->raw_extents.size.y = pango_units_to_double(metrics->line_height * n_lines +
+                                                     spacing * (n_lines - 1));
+    data->raw_extents.is_defined = TRUE;
+
+    G_UNLOCK(_adg_layout_cache);
+}
+
 static void
 _adg_refresh_extents(AdgText *text)
 {
@@ -413,8 +714,8 @@ _adg_refresh_extents(AdgText *text)
 
     entity = (AdgEntity *) text;
 
-    adg_matrix_copy(&ctm, adg_entity_get_global_matrix(entity));
-    adg_matrix_transform(&ctm, adg_entity_get_local_matrix(entity),
+    adg_matrix_copy(&ctm, _adg_entity_get_global_matrix(entity));
+    adg_matrix_transform(&ctm, _adg_entity_get_local_matrix(entity),
                          ADG_TRANSFORM_AFTER);
     cpml_extents_copy(&new_extents, &data->raw_extents);
 
@@ -436,3 +737,125 @@ _adg_clear_layout(AdgText *text)
         data->layout = NULL;
     }
 }
+
+/* Returns a new reference to a layout showing @text with @pango_style,
+ * shaping it only if not found in the layout cache */
+static PangoLayout *
+_adg_cached_layout(AdgPangoStyle *pango_style, const gchar *text)
+{
+    PangoFontDescription *font_description;
+    const cairo_font_options_t *options;
+    gchar *font_name, *key;
+    gint spacing;
+    GList *link;
+    AdgLayoutItem *item;
+    PangoLayout *layout;
+    ADG_TRACE_START(span);
+
+    font_description = adg_pango_style_get_description(pango_style);
+    spacing = adg_pango_style_get_spacing(pango_style);
+    options = adg_font_style_get_options((AdgFontStyle *) pango_style);
+
+    /* The key uses a separator that cannot be found in font names */
+    font_name = pango_font_description_to_string(font_description);
+    key = g_strdup_printf("%lu\x1f%d\x1f%s\x1f%s",
+                          cairo_font_options_hash(options),
+                          spacing, font_name, text);
+    g_free(font_name);
+
+    G_LOCK(_adg_layout_cache);
+
+    if (_adg_layouts == NULL)
+        _adg_layouts = g_hash_table_new(g_str_hash, g_str_equal);
+
+    link = g_hash_table_lookup(_adg_layouts, key);
+
+    if (link != NULL) {
+        /* Cache hit: move the item to the head of the queue */
+        g_queue_unlink(&_adg_layout_queue, link);
+        g_queue_push_head_link(&_adg_layout_queue, link);
+        g_free(key);
+    } else {
+        layout = pango_layout_new(_adg_cached_context(options));
+        pango_layout_set_spacing(layout, spacing);
+        pango_layout_set_text(layout, text, -1);
+        pango_layout_set_font_description(layout, font_description);
+        ADG_TRACE_STOP(span, "text-layout", text);
+
+        item = g_new(AdgLayoutItem, 1);
+        item->key = key;
+        item->layout = layout;
+        ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_TEXT,
+                        sizeof(AdgLayoutItem) + strlen(key) + 1);
+        g_queue_push_head(&_adg_layout_queue, item);
+        link = g_queue_peek_head_link(&_adg_layout_queue);
+        g_hash_table_insert(_adg_layouts, key, link);
+
+        /* Drop the least recently used layout: the texts using it
+         * still hold their own reference */
+        if (g_queue_get_length(&_adg_layout_queue) > _ADG_LAYOUT_CACHE_SIZE) {
+            item = g_queue_pop_tail(&_adg_layout_queue);
+            g_hash_table_remove(_adg_layouts, item->key);
+            ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_TEXT,
+                            -(gssize) (sizeof(AdgLayoutItem) + strlen(item->key) + 1));
+            g_object_unref(item->layout);
+            g_free(item->key);
+            g_free(item);
+        }
+    }
+
+    item = link->data;
+    layout = g_object_ref(item->layout);
+
+    G_UNLOCK(_adg_layout_cache);
+
+    return layout;
+}
+
+/* Returns the context shared by all the layouts with @options.
+ * Must be called with the layout cache lock held */
+static PangoContext *
+_adg_cached_context(const cairo_font_options_t *options)
+{
+    static PangoFontMap *font_map = NULL;
+    gpointer hash;
+    PangoContext *context;
+
+    /* Keep around the font_map object. The rationale is:
+     * https://bugzilla.gnome.org/show_bug.cgi?id=143542
+     *
+     * Basically, PangoFontMap is a heavy object and
+     * creating/destroying it is not the right thing to do.
+     *
+     * In reality, the blocking issue for me was the following
+     * line makes the adg-demo program crash on MinGW32:
+     * g_object_unref(font_map);
+     *
+     * The font map is shared by every thread: the layout cache
+     * lock guarantees it is created only once.
+     */
+    if (font_map == NULL)
+        font_map = pango_cairo_font_map_new();
+
+    if (_adg_contexts == NULL)
+        _adg_contexts = g_hash_table_new(NULL, NULL);
+
+    /* The cairo hash of font options packs all the fields,
+     * so it can be used as a key without any further check */
+    hash = GSIZE_TO_POINTER(cairo_font_options_hash(options));
+    context = g_hash_table_lookup(_adg_contexts, hash);
+
+    if (context == NULL) {
+        context = pango_context_new();
+        pango_context_set_font_map(context, font_map);
+        pango_cairo_context_set_resolution(context, 72);
+        pango_cairo_context_set_font_options(context, options);
+        g_hash_table_insert(_adg_contexts, hash, context);
+    } else {
+        /* Rendering sets the context matrix to the cairo ctm: restore
+         * the identity so the new layout is measured in user space */
+        pango_context_set_matrix(context, NULL);
+    }
+
+    return context;
+}
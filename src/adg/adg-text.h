@@ -53,6 +53,9 @@ struct _AdgTextClass {
 
 GType           adg_text_get_type               (void);
 AdgText *       adg_text_new                    (const gchar    *text);
+void            adg_text_set_metrics_only       (AdgText        *text,
+                                                 gboolean        metrics_only);
+gboolean        adg_text_get_metrics_only       (AdgText        *text);
 
 G_END_DECLS
 
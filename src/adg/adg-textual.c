@@ -46,6 +46,7 @@
  * @set_text:       abstract virtual method to set a new text.
  * @dup_text:       abstract virtual method that returns a duplicate of
  *                  the actual text.
+ * @shape:          optional virtual method that shapes the text in advance.
  * @text_changed:   default signal handler for #AdgTextual::text-changed.
  *
  * The virtual methods @set_text and @dup_text must be implemented
@@ -273,6 +274,32 @@ adg_textual_text_changed(AdgTextual *textual, const gchar *old_text)
     g_signal_emit(textual, _adg_signals[TEXT_CHANGED], 0, old_text);
 }
 
+/**
+ * adg_textual_shape:
+ * @textual: an object that implements #AdgTextual
+ *
+ * Shapes the text of @textual in advance, so the next arrange phase
+ * will only need to place the glyphs. This is used by #AdgCanvas to
+ * shape all the texts in a single pass before the geometric arrange.
+ *
+ * The shape() method is optional: it is not provided by the types
+ * that need the global matrix to shape the text (e.g. #AdgToyText),
+ * in which case this function does nothing.
+ *
+ * Since: 1.0
+ **/
+void
+adg_textual_shape(AdgTextual *textual)
+{
+    AdgTextualIface *iface;
+
+    g_return_if_fail(ADG_IS_TEXTUAL(textual));
+
+    iface = ADG_TEXTUAL_GET_IFACE(textual);
+    if (iface->shape != NULL)
+        iface->shape(textual);
+}
+
 
 static gchar *
 _adg_dup_text(AdgTextual *textual, AdgTextualIface *iface)
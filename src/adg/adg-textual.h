@@ -50,6 +50,7 @@ struct _AdgTextualIface {
     void                (*set_text)             (AdgTextual     *textual,
                                                  const gchar    *text);
     gchar *             (*dup_text)             (AdgTextual     *textual);
+    void                (*shape)                (AdgTextual     *textual);
 
     /* Signals */
     void                (*text_changed)         (AdgTextual     *textual,
@@ -66,6 +67,7 @@ void            adg_textual_set_text            (AdgTextual     *textual,
 gchar *         adg_textual_dup_text            (AdgTextual     *textual);
 void            adg_textual_text_changed        (AdgTextual     *textual,
                                                  const gchar    *old_text);
+void            adg_textual_shape               (AdgTextual     *textual);
 
 G_END_DECLS
 
@@ -35,6 +35,7 @@ struct _AdgTitleBlockPrivate {
     gchar       *date;
     AdgEntity   *logo;
     AdgEntity   *projection;
+    gboolean     has_titles;
 };
 
 G_END_DECLS
@@ -30,6 +30,14 @@
  * Actually this entity is only a place-holder: it will be implemented
  * properly in a 0.6.x release, after having AdgToyTable in place.
  *
+ * Title blocks are usually created in bulk, so only the bare cells are
+ * built at construction time: the title entities ("TITLE", "SIZE" and
+ * so on) are created by the first arrange, i.e. at the latest by the
+ * first rendering, and the value entities only when the related field
+ * is set. The titles are the same on every title block, so they are
+ * shaped only once thanks to the process-wide caches of the text
+ * entities (see #AdgText and #AdgToyText).
+ *
  * Since: 1.0
  **/
 
@@ -54,6 +62,7 @@
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_title_block_parent_class)
+#define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_title_block_parent_class)
 
 
 G_DEFINE_TYPE(AdgTitleBlock, adg_title_block, ADG_TYPE_TABLE);
@@ -70,6 +79,19 @@ enum {
     PROP_PROJECTION
 };
 
+/* The titles of the named cells, created by _adg_add_titles() */
+static const struct {
+    const gchar *name;
+    const gchar *title;
+} _adg_titles[] = {
+    { "title",      N_("TITLE") },
+    { "size",       N_("SIZE") },
+    { "scale",      N_("SCALE") },
+    { "drawing",    N_("DRAWING") },
+    { "author",     N_("AUTHOR") },
+    { "date",       N_("DATE") }
+};
+
 
 static void             _adg_finalize           (GObject        *object);
 static void             _adg_get_property       (GObject        *object,
@@ -80,15 +102,19 @@ static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
+static void             _adg_arrange            (AdgEntity      *entity);
+static void             _adg_add_titles         (AdgTitleBlock  *title_block);
 
 
 static void
 adg_title_block_class_init(AdgTitleBlockClass *klass)
 {
     GObjectClass *gobject_class;
+    AdgEntityClass *entity_class;
     GParamSpec *param;
 
     gobject_class = (GObjectClass *) klass;
+    entity_class = (AdgEntityClass *) klass;
 
     g_type_class_add_private(klass, sizeof(AdgTitleBlockPrivate));
 
@@ -96,6 +122,8 @@ adg_title_block_class_init(AdgTitleBlockClass *klass)
     gobject_class->set_property = _adg_set_property;
     gobject_class->get_property = _adg_get_property;
 
+    entity_class->arrange = _adg_arrange;
+
     param = g_param_spec_string("title",
                                 P_("Title"),
                                 P_("A descriptive title of the drawing"),
@@ -170,31 +198,33 @@ adg_title_block_init(AdgTitleBlock *title_block)
     data->author = NULL;
     data->date = NULL;
     data->projection = NULL;
+    data->has_titles = FALSE;
 
     title_block->data = data;
 
     /* By default the title block should be floating */
     adg_entity_switch_floating((AdgEntity *) title_block, TRUE);
 
-    /* Create the title block template*/
+    /* Create the title block template: the cells have a fixed width,
+     * so the titles do not change the layout and are added later */
 
     /* First row */
     row = adg_table_row_new(table);
     adg_table_cell_new_with_width(row, 62);
-    adg_table_cell_new_full(row, 200, "title", _("TITLE"), TRUE);
+    adg_table_cell_new_full(row, 200, "title", NULL, TRUE);
 
     /* Second row */
     row = adg_table_row_new(table);
     adg_table_cell_new_full(row, 62, "logo", NULL, FALSE);
-    adg_table_cell_new_full(row, 40, "size", _("SIZE"), TRUE);
-    adg_table_cell_new_full(row, 60, "scale", _("SCALE"), TRUE);
-    adg_table_cell_new_full(row, 100, "drawing", _("DRAWING"), TRUE);
+    adg_table_cell_new_full(row, 40, "size", NULL, TRUE);
+    adg_table_cell_new_full(row, 60, "scale", NULL, TRUE);
+    adg_table_cell_new_full(row, 100, "drawing", NULL, TRUE);
 
     /* Third row */
     row = adg_table_row_new(table);
     adg_table_cell_new_full(row, 62, "projection", NULL, TRUE);
-    adg_table_cell_new_full(row, 100, "author", _("AUTHOR"), TRUE);
-    adg_table_cell_new_full(row, 100, "date", _("DATE"), TRUE);
+    adg_table_cell_new_full(row, 100, "author", NULL, TRUE);
+    adg_table_cell_new_full(row, 100, "date", NULL, TRUE);
 }
 
 static void
@@ -332,6 +362,37 @@ _adg_set_property(GObject *object, guint prop_id,
 }
 
 
+static void
+_adg_arrange(AdgEntity *entity)
+{
+    _adg_add_titles((AdgTitleBlock *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->arrange)
+        _ADG_OLD_ENTITY_CLASS->arrange(entity);
+}
+
+static void
+_adg_add_titles(AdgTitleBlock *title_block)
+{
+    AdgTitleBlockPrivate *data;
+    AdgTableCell *cell;
+    guint n;
+
+    data = title_block->data;
+    if (data->has_titles)
+        return;
+
+    data->has_titles = TRUE;
+
+    /* Called while arranging, so the invalidations of the table
+     * triggered by the new titles do not propagate upward */
+    for (n = 0; n < G_N_ELEMENTS(_adg_titles); ++n) {
+        cell = adg_table_get_cell((AdgTable *) title_block, _adg_titles[n].name);
+        if (cell != NULL && adg_table_cell_title(cell) == NULL)
+            adg_table_cell_set_text_title(cell, _(_adg_titles[n].title));
+    }
+}
+
 /**
  * adg_title_block_new:
  *
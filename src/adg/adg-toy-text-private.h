@@ -32,6 +32,7 @@ struct _AdgToyTextPrivate {
 
     int                  num_glyphs;
     cairo_glyph_t       *glyphs;
+    CpmlExtents          raw_extents;
 
     cairo_scaled_font_t *font;
 };
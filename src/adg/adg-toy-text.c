@@ -27,6 +27,13 @@
  *
  * The toy text entity is not subject to the local matrix, only its origin is.
  *
+ * The glyphs are kept in a process-wide cache indexed by scaled font and
+ * text, so equal strings are shaped only once. Furthermore a toy text
+ * keeps its glyphs when its matrices are changed without affecting the
+ * scaled font, e.g. when it is only translated. Arranging only fetches the
+ * text extents: the glyphs are copied by the first rendering, so a toy
+ * text outside of the clip area never owns them.
+ *
  * <note><para>
  * By default, the #AdgEntity:local-mix property is set to
  * #ADG_MIX_ANCESTORS_NORMALIZED on #AdgToyText entities.
@@ -55,10 +62,15 @@
 #include "adg-toy-text.h"
 #include "adg-toy-text-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_toy_text_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_toy_text_parent_class)
 
+/* Maximum number of glyph runs kept by the process-wide glyph cache */
+#define _ADG_GLYPH_CACHE_SIZE  256
+
 
 static void             _adg_iface_init         (AdgTextualIface *iface);
 
@@ -88,6 +100,9 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gsize            _adg_memory_usage       (AdgEntity      *entity);
+static void             _adg_trim_caches        (AdgEntity      *entity,
+                                                 AdgTrimLevel    level);
 static void             _adg_set_font_dress     (AdgTextual     *textual,
                                                  AdgDress        dress);
 static AdgDress         _adg_get_font_dress     (AdgTextual     *textual);
@@ -96,6 +111,27 @@ static void             _adg_set_text           (AdgTextual     *textual,
 static gchar *          _adg_dup_text           (AdgTextual     *textual);
 static void             _adg_clear_font         (AdgToyText     *toy_text);
 static void             _adg_clear_glyphs       (AdgToyText     *toy_text);
+static gboolean         _adg_cached_glyphs      (AdgToyText     *toy_text,
+                                                 gboolean        measure_only);
+static guint            _adg_run_hash           (gconstpointer   key);
+static gboolean         _adg_run_equal          (gconstpointer   key1,
+                                                 gconstpointer   key2);
+static void             _adg_run_free           (gpointer        run);
+
+typedef struct {
+    cairo_scaled_font_t *font;
+    gchar               *text;
+    int                  num_glyphs;
+    cairo_glyph_t       *glyphs;
+    CpmlExtents          extents;
+} AdgGlyphRun;
+
+/* Glyph runs shared by all the toy texts: the most recently used ones
+ * are kept at the head of the queue while the hash table maps every
+ * run (used also as key) to its queue link */
+static GHashTable *     _adg_runs = NULL;
+static GQueue           _adg_run_queue = G_QUEUE_INIT;
+G_LOCK_DEFINE_STATIC(_adg_glyph_cache);
 
 
 static void
@@ -118,6 +154,8 @@ adg_toy_text_class_init(AdgToyTextClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_usage = _adg_memory_usage;
+    entity_class->trim_caches = _adg_trim_caches;
 
     g_object_class_override_property(gobject_class, PROP_FONT_DRESS, "font-dress");
     g_object_class_override_property(gobject_class, PROP_TEXT, "text");
@@ -130,6 +168,7 @@ _adg_iface_init(AdgTextualIface *iface)
     iface->get_font_dress = _adg_get_font_dress;
     iface->set_text = _adg_set_text;
     iface->dup_text = _adg_dup_text;
+    iface->shape = NULL;
     iface->text_changed = NULL;
 }
 
@@ -143,7 +182,9 @@ adg_toy_text_init(AdgToyText *toy_text)
 
     data->font_dress = ADG_DRESS_FONT_TEXT;
     data->text = NULL;
+    data->num_glyphs = 0;
     data->glyphs = NULL;
+    data->font = NULL;
 
     toy_text->data = data;
 
@@ -237,10 +278,14 @@ adg_toy_text_new(const gchar *text)
 static void
 _adg_global_changed(AdgEntity *entity)
 {
+    AdgEntityPrivate *entity_data = entity->data;
+
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    adg_entity_invalidate(entity);
+    /* A translation does not affect the scaled font nor the glyphs */
+    if (! entity_data->global.is_shifted)
+        adg_entity_invalidate(entity);
 }
 
 static void
@@ -255,9 +300,8 @@ _adg_local_changed(AdgEntity *entity)
 static void
 _adg_invalidate(AdgEntity *entity)
 {
-    _adg_clear_font((AdgToyText *) entity);
-    _adg_clear_glyphs((AdgToyText *) entity);
-
+    /* Font and glyphs are not cleared here: they are still valid if
+     * the scaled font returned by the next arrange does not change */
     if (_ADG_OLD_ENTITY_CLASS->invalidate)
         _ADG_OLD_ENTITY_CLASS->invalidate(entity);
 }
@@ -267,58 +311,71 @@ _adg_arrange(AdgEntity *entity)
 {
     AdgToyText *toy_text;
     AdgToyTextPrivate *data;
+    AdgEntityPrivate *entity_data;
+    AdgFontStyle *font_style;
+    cairo_matrix_t ctm;
+    cairo_scaled_font_t *font;
     CpmlExtents extents;
 
     toy_text = (AdgToyText *) entity;
     data = toy_text->data;
+    entity_data = entity->data;
 
-    if (data->font == NULL) {
-        AdgDress dress;
-        AdgFontStyle *font_style;
-        cairo_matrix_t ctm;
+    /* After a pure translation the current font is still the right one */
+    if (data->font == NULL || ! entity_data->global.is_shifted) {
+        font_style = (AdgFontStyle *) adg_entity_style(entity, data->font_dress);
 
-        dress = data->font_dress;
-        font_style = (AdgFontStyle *) adg_entity_style(entity, dress);
+        adg_matrix_copy(&ctm, adg_entity_get_combined_matrix(entity));
 
-        adg_matrix_copy(&ctm, adg_entity_get_global_matrix(entity));
-        adg_matrix_transform(&ctm, adg_entity_get_local_matrix(entity),
-                             ADG_TRANSFORM_BEFORE);
+        font = adg_font_style_get_scaled_font(font_style, &ctm);
 
-        data->font = adg_font_style_get_scaled_font(font_style, &ctm);
+        /* The same scaled font (a reference is held, so the pointer cannot
+         * be recycled) means the glyphs can be reused as they are */
+        if (font != data->font) {
+            _adg_clear_font(toy_text);
+            _adg_clear_glyphs(toy_text);
+            data->font = cairo_scaled_font_reference(font);
+        }
     }
 
     if (adg_is_string_empty(data->text)) {
         /* Undefined text */
         extents.is_defined = FALSE;
-    } else if (data->glyphs != NULL) {
-        /* Cached result */
+    } else if (data->glyphs == NULL && ! _adg_cached_glyphs(toy_text, TRUE)) {
         return;
     } else {
-        cairo_status_t status;
-        cairo_text_extents_t cairo_extents;
+        cpml_extents_copy(&extents, &data->raw_extents);
+        cpml_extents_transform_chained(&extents,
+                                       _adg_entity_get_local_matrix(entity),
+                                       _adg_entity_get_global_matrix(entity));
+    }
 
-        status = cairo_scaled_font_text_to_glyphs(data->font, 0, 0,
-                                                  data->text, -1,
-                                                  &data->glyphs,
-                                                  &data->num_glyphs,
-                                                  NULL, NULL, NULL);
+    adg_entity_set_extents(entity, &extents);
+}
 
-        if (status != CAIRO_STATUS_SUCCESS) {
-            _adg_clear_glyphs(toy_text);
-            g_error(_("Unable to build glyphs (cairo message: %s)"),
-                    cairo_status_to_string(status));
-            return;
-        }
+static gsize
+_adg_memory_usage(AdgEntity *entity)
+{
+    AdgToyTextPrivate *data = ((AdgToyText *) entity)->data;
+    gsize usage;
 
-        cairo_scaled_font_glyph_extents(data->font, data->glyphs,
-                                        data->num_glyphs, &cairo_extents);
-        cpml_extents_from_cairo_text(&extents, &cairo_extents);
-        cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
-        cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+    usage = _ADG_OLD_ENTITY_CLASS->memory_usage(entity) +
+        sizeof(AdgToyTextPrivate);
 
-    }
+    if (data->text != NULL)
+        usage += strlen(data->text) + 1;
+    usage += data->num_glyphs * sizeof(cairo_glyph_t);
 
-    adg_entity_set_extents(entity, &extents);
+    return usage;
+}
+
+static void
+_adg_trim_caches(AdgEntity *entity, AdgTrimLevel level)
+{
+    /* The glyphs are fetched again, usually from the glyph cache,
+     * by the next rendering */
+    _adg_clear_glyphs((AdgToyText *) entity);
+    _ADG_OLD_ENTITY_CLASS->trim_caches(entity, level);
 }
 
 static void
@@ -330,11 +387,19 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     toy_text = (AdgToyText *) entity;
     data = toy_text->data;
 
+    /* The glyphs could have been dropped by adg_entity_trim_caches() */
+    if (data->glyphs == NULL && data->font != NULL &&
+        ! adg_is_string_empty(data->text))
+        _adg_cached_glyphs(toy_text, FALSE);
+
     if (data->glyphs != NULL) {
+        AdgFontStyle *font_style;
+
+        font_style = (AdgFontStyle *) adg_entity_style(entity, data->font_dress);
         adg_entity_apply_dress(entity, data->font_dress, cr);
-        cairo_transform(cr, adg_entity_get_global_matrix(entity));
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
-        cairo_show_glyphs(cr, data->glyphs, data->num_glyphs);
+        cairo_transform(cr, adg_entity_get_combined_matrix(entity));
+        adg_font_style_show_glyphs(font_style, cr, data->font,
+                                   data->glyphs, data->num_glyphs);
     }
 }
 
@@ -369,7 +434,10 @@ _adg_clear_font(AdgToyText *toy_text)
 {
     AdgToyTextPrivate *data = toy_text->data;
 
-    data->font = NULL;
+    if (data->font != NULL) {
+        cairo_scaled_font_destroy(data->font);
+        data->font = NULL;
+    }
 }
 
 static void
@@ -378,9 +446,137 @@ _adg_clear_glyphs(AdgToyText *toy_text)
     AdgToyTextPrivate *data = toy_text->data;
 
     if (data->glyphs != NULL) {
+        ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_TEXT,
+                        -(gssize) (sizeof(cairo_glyph_t) * data->num_glyphs));
         cairo_glyph_free(data->glyphs);
         data->glyphs = NULL;
     }
 
     data->num_glyphs = 0;
 }
+
+/* Fills the glyphs of @toy_text, possibly copying them from the glyph
+ * cache, and returns %FALSE on errors. When @measure_only is %TRUE,
+ * only the raw extents are updated */
+static gboolean
+_adg_cached_glyphs(AdgToyText *toy_text, gboolean measure_only)
+{
+    AdgToyTextPrivate *data;
+    AdgGlyphRun key, *run;
+    GList *link;
+    ADG_TRACE_START(span);
+
+    data = toy_text->data;
+    key.font = data->font;
+    key.text = data->text;
+
+    G_LOCK(_adg_glyph_cache);
+
+    if (_adg_runs == NULL)
+        _adg_runs = g_hash_table_new(_adg_run_hash, _adg_run_equal);
+
+    link = g_hash_table_lookup(_adg_runs, &key);
+
+    if (link != NULL) {
+        /* Cache hit: move the run to the head of the queue */
+        g_queue_unlink(&_adg_run_queue, link);
+        g_queue_push_head_link(&_adg_run_queue, link);
+        run = link->data;
+    } else {
+        cairo_status_t status;
+        cairo_text_extents_t cairo_extents;
+
+        run = g_new(AdgGlyphRun, 1);
+        run->font = NULL;
+        run->text = NULL;
+        run->glyphs = NULL;
+        run->num_glyphs = 0;
+
+        status = cairo_scaled_font_text_to_glyphs(data->font, 0, 0,
+                                                  data->text, -1,
+                                                  &run->glyphs,
+                                                  &run->num_glyphs,
+                                                  NULL, NULL, NULL);
+
+        if (status != CAIRO_STATUS_SUCCESS) {
+            G_UNLOCK(_adg_glyph_cache);
+            _adg_run_free(run);
+            g_error(_("Unable to build glyphs (cairo message: %s)"),
+                    cairo_status_to_string(status));
+            return FALSE;
+        }
+
+        cairo_scaled_font_glyph_extents(data->font, run->glyphs,
+                                        run->num_glyphs, &cairo_extents);
+        cpml_extents_from_cairo_text(&run->extents, &cairo_extents);
+        ADG_TRACE_STOP(span, "text-glyphs", data->text);
+
+        run->font = cairo_scaled_font_reference(data->font);
+        run->text = g_strdup(data->text);
+        ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_TEXT,
+                        sizeof(AdgGlyphRun) + strlen(run->text) + 1 +
+                        sizeof(cairo_glyph_t) * run->num_glyphs);
+
+        g_queue_push_head(&_adg_run_queue, run);
+        g_hash_table_insert(_adg_runs, run,
+                            g_queue_peek_head_link(&_adg_run_queue));
+
+        /* Drop the least recently used run */
+        if (g_queue_get_length(&_adg_run_queue) > _ADG_GLYPH_CACHE_SIZE) {
+            AdgGlyphRun *old_run = g_queue_pop_tail(&_adg_run_queue);
+            g_hash_table_remove(_adg_runs, old_run);
+            _adg_run_free(old_run);
+        }
+    }
+
+    /* Every toy text owns a copy of the glyphs, so the run
+     * can be dropped from the cache at any time */
+    if (! measure_only) {
+        data->num_glyphs = run->num_glyphs;
+        data->glyphs = cairo_glyph_allocate(run->num_glyphs);
+        ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_TEXT,
+                        sizeof(cairo_glyph_t) * run->num_glyphs);
+        memcpy(data->glyphs, run->glyphs, sizeof(cairo_glyph_t) * run->num_glyphs);
+    }
+    cpml_extents_copy(&data->raw_extents, &run->extents);
+
+    G_UNLOCK(_adg_glyph_cache);
+
+    return TRUE;
+}
+
+static guint
+_adg_run_hash(gconstpointer key)
+{
+    const AdgGlyphRun *run = key;
+    return g_direct_hash(run->font) ^ g_str_hash(run->text);
+}
+
+static gboolean
+_adg_run_equal(gconstpointer key1, gconstpointer key2)
+{
+    const AdgGlyphRun *run1 = key1;
+    const AdgGlyphRun *run2 = key2;
+
+    return run1->font == run2->font && strcmp(run1->text, run2->text) == 0;
+}
+
+static void
+_adg_run_free(gpointer run)
+{
+    AdgGlyphRun *glyph_run = run;
+
+    /* The text is set only after a successful conversion */
+    if (glyph_run->text != NULL)
+        ADG_ALLOC_TRACE(ADG_ALLOC_DOMAIN_TEXT,
+                        -(gssize) (sizeof(AdgGlyphRun) + strlen(glyph_run->text) + 1 +
+                                   sizeof(cairo_glyph_t) * glyph_run->num_glyphs));
+
+    if (glyph_run->glyphs != NULL)
+        cairo_glyph_free(glyph_run->glyphs);
+    if (glyph_run->font != NULL)
+        cairo_scaled_font_destroy(glyph_run->font);
+
+    g_free(glyph_run->text);
+    g_free(glyph_run);
+}
@@ -28,14 +28,60 @@ typedef struct _AdgTrailPrivate AdgTrailPrivate;
 
 struct _AdgTrailPrivate {
     cairo_path_t        cairo_path;
+    GArray             *cairo_array;
     AdgTrailCallback    callback;
     gpointer            user_data;
+    cairo_path_t       *raw_path;
+    cairo_path_t       *frozen_path;
     gdouble             max_angle;
+    gdouble             tolerance;
 
     gboolean            in_construction;
+    gboolean            computing;
+    gboolean            announcing;
     CpmlExtents         extents;
+    GArray             *segments;
+    GArray             *segments_extents;
+    GArray             *arc_caches;
+    GArray             *lengths;
+    GArray             *flats;
+
+    GMappedFile        *mapped;
+    gchar              *dump;
+    cairo_path_t        mapped_path;
+
+    GArray             *compact;
+    GArray             *expanded;
+    cairo_path_t        compact_path;
+
+#ifdef ALLOC_TRACE_ENABLED
+    gsize               traced_array;
+    gsize               traced_segments;
+    gsize               traced_extents;
+    gsize               traced_lengths;
+#endif
 };
 
+
+/* Unchecked accessor for the library hot paths: @trail must be a
+ * valid AdgTrail. Only the cached path is returned inline, otherwise
+ * the conversion is delegated to adg_trail_get_cairo_path() */
+static inline const cairo_path_t *
+_adg_trail_get_cairo_path(AdgTrail *trail)
+{
+    AdgTrailPrivate *data = trail->data;
+
+    if (data->cairo_path.data != NULL && ! data->computing)
+        return &data->cairo_path;
+
+    return adg_trail_get_cairo_path(trail);
+}
+
+gboolean        _adg_trail_append_flat          (AdgTrail       *trail,
+                                                 cairo_t        *cr,
+                                                 const cairo_matrix_t *matrix,
+                                                 GArray         *dest);
+
 G_END_DECLS
 
 
@@ -49,10 +49,21 @@
 /**
  * AdgTrailClass:
  * @get_cairo_path: virtual method to get the #cairo_path_t bound to the trail.
+ * @prepare: virtual method called by adg_trail_compute_parallel() before
+ *           building the path on a worker thread.
  *
  * The default @get_cairo_path calls the #AdgTrailCallback callback passed
- * to adg_trail_new() during construction. No caching is performed in
- * between.
+ * to adg_trail_new() during construction. The returned path is cached
+ * until the trail is cleared, either explicitly with adg_model_clear()
+ * or implicitly by emitting #AdgModel::changed, so the callback is
+ * called at most once per change.
+ *
+ * @prepare must build, on the calling thread, the caches of any other
+ * model read by @get_cairo_path and return <constant>TRUE</constant>
+ * if @get_cairo_path can then run on a worker thread, that is if it
+ * only reads from other models and only writes on the trail itself.
+ * The default @prepare is <constant>NULL</constant>: the user callback
+ * could do anything, so trails without it are never built concurrently.
  *
  * Since: 1.0
  **/
@@ -63,7 +74,8 @@
  * @user_data: the general purpose pointer set by adg_trail_new()
  *
  * This is the callback used to generate the #cairo_path_t and it is
- * called directly by adg_trail_cairo_path(). The caller owns
+ * called by adg_trail_cairo_path() whenever there is no cached path,
+ * i.e. on the first request after a change of @trail. The caller owns
  * the returned path, that is the finalization of the returned
  * #cairo_path_t should be made by the caller when appropriate.
  *
@@ -72,9 +84,28 @@
  * Since: 1.0
  **/
 
+/**
+ * ADG_TRAIL_ERROR:
+ *
+ * Error domain for trail loading. Errors in this domain will be from the
+ * #AdgTrailError enumeration. See #GError for information on error domains.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgTrailError:
+ * @ADG_TRAIL_ERROR_FORMAT: The file is not a valid (or compatible) trail dump.
+ *
+ * Error codes returned by adg_trail_new_from_file().
+ *
+ * Since: 1.0
+ **/
+
 
 #include "adg-internal.h"
 #include <math.h>
+#include <string.h>
 
 #include "adg-model.h"
 
@@ -87,11 +118,77 @@
 
 #define EMPTY_PATH(p)          ((p) == NULL || (p)->data == NULL || (p)->num_data <= 0)
 
+#define _ADG_DUMP_MAGIC        "ADGT"
+#define _ADG_DUMP_BYTE_ORDER   0x01020304
+#define _ADG_DUMP_VERSION      1
+
+/* Number of chunks a Bézier curve is divided into when measuring it */
+#define _ADG_CURVE_CHUNKS      16
+
 G_DEFINE_TYPE(AdgTrail, adg_trail, ADG_TYPE_MODEL)
 
+/* The dump is a verbatim copy of the in-memory representation, so it
+ * can be mapped and used without any conversion: the header is
+ * followed by the cairo_path_data_t array, the named pairs table and
+ * the blob of NUL terminated names, in this order */
+typedef struct {
+    gchar               magic[4];
+    guint32             byte_order;
+    guint32             version;
+    guint32             data_size;
+    guint32             num_data;
+    guint32             n_pairs;
+    guint32             names_size;
+    guint32             reserved;
+} _AdgDumpHeader;
+
+typedef struct {
+    guint32             name;
+    guint32             reserved;
+    gdouble             x;
+    gdouble             y;
+} _AdgDumpPair;
+
+typedef struct {
+    GByteArray         *pairs;
+    GString            *names;
+} _AdgDumpPairs;
+
+/* The compact storage packs every primitive in 4 byte units: a header
+ * with the type and the cairo length followed by the single precision
+ * coordinates of the points, i.e. (length - 1) * 2 units */
+typedef union {
+    struct {
+        guint16         type;
+        guint16         length;
+    }                   header;
+    gfloat              coord;
+} _AdgCompactData;
+
+/* An entry of the lengths table: the chunk of @primitive between the
+ * @from and @to positions (or times, for curves) ends at @length from
+ * the start of the trail */
+typedef struct {
+    CpmlPrimitive       primitive;
+    gdouble             from;
+    gdouble             to;
+    gdouble             length;
+} _AdgLength;
+
+/* The trail flattened in model space by cairo with @tolerance, that
+ * is always a power of 2 so close scales share the same entry */
+typedef struct {
+    gdouble             tolerance;
+    cairo_path_t       *path;
+} _AdgFlat;
+
+/* Maximum number of flattened copies kept by a trail */
+#define MAX_FLATS       8
+
 enum {
     PROP_0,
-    PROP_MAX_ANGLE
+    PROP_MAX_ANGLE,
+    PROP_TOLERANCE
 };
 
 
@@ -105,10 +202,51 @@ static void             _adg_set_property       (GObject        *object,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
 static void             _adg_clear              (AdgModel       *model);
+static void             _adg_changed            (AdgModel       *model);
+static void             _adg_freeze             (AdgModel       *model);
+static void             _adg_clear_cache        (AdgTrail       *trail);
+static void             _adg_clear_flats        (GArray         *flats);
+static const cairo_path_t *
+                        _adg_get_flat           (AdgTrail       *trail,
+                                                 gdouble         tolerance,
+                                                 cairo_path_t  **owned);
 static cairo_path_t *   _adg_get_cairo_path     (AdgTrail       *trail);
+static const cairo_path_t *
+                        _adg_convert_cairo_path (AdgTrail       *trail);
+static cairo_path_t *   _adg_raw_cairo_path     (AdgTrail       *trail);
+static GThreadPool *    _adg_compute_pool       (void);
+static void             _adg_compute_job        (gpointer        job_data,
+                                                 gpointer        user_data);
+static gboolean         _adg_computed           (gpointer        user_data);
+static void             _adg_compute_jobs       (GPtrArray      *trails);
+static GArray *         _adg_get_segments       (AdgTrail       *trail);
+static GArray *         _adg_get_segments_extents
+                                                (AdgTrail       *trail);
+static GArray *         _adg_get_lengths        (AdgTrail       *trail);
+static const _AdgLength *
+                        _adg_find_length        (AdgTrail       *trail,
+                                                 gdouble         length,
+                                                 gdouble        *pos);
 static GArray *         _adg_arc_to_curves      (GArray         *array,
+                                                 const cairo_path_data_t *org,
                                                  const cairo_path_data_t *src,
-                                                 gdouble         max_angle);
+                                                 guint           n_arc,
+                                                 AdgTrailPrivate *data);
+static gdouble          _adg_arc_error          (gdouble         angle);
+static void             _adg_dump_pair          (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 AdgPair        *pair,
+                                                 gpointer        user_data);
+static gboolean         _adg_check_dump         (const gchar    *contents,
+                                                 gsize           length);
+static void             _adg_copy_named_pair    (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 AdgPair        *pair,
+                                                 gpointer        user_data);
+static cairo_path_t *   _adg_compact_cairo_path (AdgTrail       *trail,
+                                                 gpointer        user_data);
+static cairo_path_t *   _adg_mapped_cairo_path  (AdgTrail       *trail,
+                                                 gpointer        user_data);
 
 
 static void
@@ -128,6 +266,8 @@ adg_trail_class_init(AdgTrailClass *klass)
     gobject_class->set_property = _adg_set_property;
 
     model_class->clear = _adg_clear;
+    model_class->changed = _adg_changed;
+    model_class->freeze = _adg_freeze;
 
     klass->get_cairo_path = _adg_get_cairo_path;
 
@@ -137,6 +277,13 @@ adg_trail_class_init(AdgTrailClass *klass)
                                 0, G_PI, G_PI_2,
                                 G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_MAX_ANGLE, param);
+
+    param = g_param_spec_double("tolerance",
+                                P_("Tolerance"),
+                                P_("Max distance allowed between an arc and its Bezier approximation: check adg_trail_set_tolerance() for details"),
+                                0, G_MAXDOUBLE, 0,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_TOLERANCE, param);
 }
 
 static void
@@ -148,11 +295,37 @@ adg_trail_init(AdgTrail *trail)
     data->cairo_path.status = CAIRO_STATUS_INVALID_PATH_DATA;
     data->cairo_path.data = NULL;
     data->cairo_path.num_data = 0;
+    data->cairo_array = NULL;
     data->callback = NULL;
     data->user_data = NULL;
+    data->raw_path = NULL;
+    data->frozen_path = NULL;
     data->max_angle = G_PI_2;
+    data->tolerance = 0;
     data->in_construction = FALSE;
+    data->computing = FALSE;
+    data->announcing = FALSE;
     data->extents.is_defined = FALSE;
+    data->segments = NULL;
+    data->segments_extents = NULL;
+    data->arc_caches = NULL;
+    data->lengths = NULL;
+    data->mapped = NULL;
+    data->dump = NULL;
+    data->mapped_path.status = CAIRO_STATUS_SUCCESS;
+    data->mapped_path.data = NULL;
+    data->mapped_path.num_data = 0;
+    data->compact = NULL;
+    data->expanded = NULL;
+    data->compact_path.status = CAIRO_STATUS_SUCCESS;
+    data->compact_path.data = NULL;
+    data->compact_path.num_data = 0;
+#ifdef ALLOC_TRACE_ENABLED
+    data->traced_array = 0;
+    data->traced_segments = 0;
+    data->traced_extents = 0;
+    data->traced_lengths = 0;
+#endif
 
     trail->data = data;
 }
@@ -160,8 +333,40 @@ adg_trail_init(AdgTrail *trail)
 static void
 _adg_finalize(GObject *object)
 {
+    AdgTrailPrivate *data = ((AdgTrail *) object)->data;
+
     _adg_clear((AdgModel *) object);
 
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_array, 0);
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_segments, 0);
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_extents, 0);
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_lengths, 0);
+
+    if (data->cairo_array != NULL)
+        g_array_free(data->cairo_array, TRUE);
+    if (data->segments != NULL)
+        g_array_free(data->segments, TRUE);
+    if (data->segments_extents != NULL)
+        g_array_free(data->segments_extents, TRUE);
+    if (data->arc_caches != NULL)
+        g_array_free(data->arc_caches, TRUE);
+    if (data->lengths != NULL)
+        g_array_free(data->lengths, TRUE);
+    if (data->flats != NULL)
+        g_array_free(data->flats, TRUE);
+    if (data->mapped != NULL) {
+#if GLIB_CHECK_VERSION(2, 22, 0)
+        g_mapped_file_unref(data->mapped);
+#else
+        g_mapped_file_free(data->mapped);
+#endif
+    }
+    g_free(data->dump);
+    if (data->compact != NULL)
+        g_array_free(data->compact, TRUE);
+    if (data->expanded != NULL)
+        g_array_free(data->expanded, TRUE);
+
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
 }
@@ -180,6 +385,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_MAX_ANGLE:
         g_value_set_double(value, data->max_angle);
         break;
+    case PROP_TOLERANCE:
+        g_value_set_double(value, data->tolerance);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -199,6 +407,11 @@ _adg_set_property(GObject *object, guint prop_id,
     switch (prop_id) {
     case PROP_MAX_ANGLE:
         data->max_angle = g_value_get_double(value);
+        _adg_clear_cache(trail);
+        break;
+    case PROP_TOLERANCE:
+        data->tolerance = g_value_get_double(value);
+        _adg_clear_cache(trail);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -207,6 +420,17 @@ _adg_set_property(GObject *object, guint prop_id,
 }
 
 
+GQuark
+adg_trail_error_quark(void)
+{
+  static GQuark q;
+
+  if G_UNLIKELY (q == 0)
+    q = g_quark_from_static_string("adg-trail-error-quark");
+
+  return q;
+}
+
 /**
  * adg_trail_new:
  * @callback: (scope notified): the #cairo_path_t constructor function
@@ -235,6 +459,281 @@ adg_trail_new(AdgTrailCallback callback, gpointer user_data)
     return trail;
 }
 
+/**
+ * adg_trail_new_from_file:
+ * @file: the name of a file created by adg_trail_save()
+ * @gerror: (allow-none): return location for errors
+ *
+ * Creates a new trail model from the binary dump in @file. The file is
+ * memory mapped and its data is used as is, without any copy: loading a
+ * trail is hence O(1) on the number of primitives, apart from the
+ * validation pass and the named pairs, that are restored with
+ * adg_model_set_named_pair().
+ *
+ * The mapping is private, so the data can be modified in the usual
+ * ways (e.g. by the markers) without touching @file. If @file cannot
+ * be mapped for writing (e.g. because it is read-only) its contents
+ * are loaded in memory with a single read. The returned trail cannot
+ * be extended though: use adg_path_append_trail() to get an editable
+ * #AdgPath out of it.
+ *
+ * Returns: (transfer full): the newly created trail or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgTrail *
+adg_trail_new_from_file(const gchar *file, GError **gerror)
+{
+    GMappedFile *mapped;
+    gchar *contents;
+    gsize length;
+    const _AdgDumpHeader *header;
+    const _AdgDumpPair *pair;
+    const gchar *names;
+    AdgTrail *trail;
+    AdgTrailPrivate *data;
+    AdgPair named_pair;
+    guint n;
+
+    g_return_val_if_fail(file != NULL, NULL);
+
+    /* A writable mapping is private (copy-on-write) in GLib */
+    mapped = g_mapped_file_new(file, TRUE, NULL);
+    if (mapped != NULL) {
+        contents = g_mapped_file_get_contents(mapped);
+        length = g_mapped_file_get_length(mapped);
+    } else if (! g_file_get_contents(file, &contents, &length, gerror)) {
+        return NULL;
+    }
+
+    if (! _adg_check_dump(contents, length)) {
+        g_set_error(gerror, ADG_TRAIL_ERROR, ADG_TRAIL_ERROR_FORMAT,
+                    _("Invalid or incompatible trail dump in '%s'"), file);
+        if (mapped == NULL) {
+            g_free(contents);
+        } else {
+#if GLIB_CHECK_VERSION(2, 22, 0)
+            g_mapped_file_unref(mapped);
+#else
+            g_mapped_file_free(mapped);
+#endif
+        }
+        return NULL;
+    }
+
+    header = (const _AdgDumpHeader *) contents;
+    trail = adg_trail_new(_adg_mapped_cairo_path, NULL);
+    data = trail->data;
+
+    data->mapped = mapped;
+    data->dump = mapped == NULL ? contents : NULL;
+    data->mapped_path.num_data = header->num_data;
+    data->mapped_path.data = (cairo_path_data_t *) (header + 1);
+
+    pair = (const _AdgDumpPair *) (data->mapped_path.data + header->num_data);
+    names = (const gchar *) (pair + header->n_pairs);
+
+    for (n = 0; n < header->n_pairs; ++n, ++pair) {
+        named_pair.x = pair->x;
+        named_pair.y = pair->y;
+        adg_model_set_named_pair((AdgModel *) trail, names + pair->name,
+                                 &named_pair);
+    }
+
+    return trail;
+}
+
+/**
+ * adg_trail_new_compact:
+ * @trail: an #AdgTrail
+ *
+ * Creates a new trail with the same primitives and named pairs of
+ * @trail but keeping them in a compact form: every header takes 4
+ * bytes instead of 16 and every point is stored with single precision
+ * coordinates, so the memory needed by the path is roughly halved.
+ * The cairo path is expanded only when requested, e.g. while
+ * arranging or rendering, and can be dropped again with
+ * adg_trail_release_cache() once done.
+ *
+ * This is intended for keeping a big library of parts in memory: the
+ * single precision has 24 bits of mantissa, that is an error below
+ * 0.1 micrometers on coordinates up to one meter when using
+ * millimeters as units. #CPML_ARC primitives are preserved as is.
+ *
+ * The new trail is a snapshot: further changes to @trail are not
+ * reflected on it.
+ *
+ * Returns: (transfer full): the newly created trail or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgTrail *
+adg_trail_new_compact(AdgTrail *trail)
+{
+    cairo_path_t *cairo_path;
+    AdgTrail *compact;
+    AdgTrailPrivate *data;
+    _AdgCompactData unit;
+    const cairo_path_data_t *src, *end;
+    gint n;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), NULL);
+
+    cairo_path = adg_trail_cairo_path(trail);
+
+    compact = adg_trail_new(_adg_compact_cairo_path, NULL);
+    data = compact->data;
+    data->compact = g_array_new(FALSE, FALSE, sizeof(_AdgCompactData));
+
+    if (cairo_path != NULL && cairo_path->data != NULL) {
+        src = cairo_path->data;
+        end = src + cairo_path->num_data;
+
+        for (; src < end; src += src->header.length) {
+            unit.header.type = src->header.type;
+            unit.header.length = src->header.length;
+            g_array_append_val(data->compact, unit);
+
+            for (n = 1; n < src->header.length; ++n) {
+                unit.coord = src[n].point.x;
+                g_array_append_val(data->compact, unit);
+                unit.coord = src[n].point.y;
+                g_array_append_val(data->compact, unit);
+            }
+        }
+    }
+
+    adg_model_foreach_named_pair((AdgModel *) trail,
+                                 _adg_copy_named_pair, compact);
+
+    return compact;
+}
+
+/**
+ * adg_trail_release_cache:
+ * @trail: an #AdgTrail
+ *
+ * Frees the memory of the data cached by @trail, that is the cairo
+ * path with the arcs converted to Bézier curves, the segments, the
+ * extents and the lengths tables, the flattened copies and, for
+ * trails created with
+ * adg_trail_new_compact(), the expanded cairo path. Everything is
+ * rebuilt on demand, so this does not change @trail in any way and
+ * no change is notified. Any pointer previously returned by
+ * adg_trail_cairo_path() or adg_trail_get_cairo_path() is invalid
+ * after this call.
+ *
+ * Nothing is done while @trail is being computed by
+ * adg_trail_compute_async() or if @trail has been frozen by
+ * adg_model_freeze().
+ *
+ * Since: 1.0
+ **/
+void
+adg_trail_release_cache(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+
+    g_return_if_fail(ADG_IS_TRAIL(trail));
+
+    data = trail->data;
+    if (data->computing || adg_model_is_frozen((AdgModel *) trail))
+        return;
+
+    _adg_clear_cache(trail);
+
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_array, 0);
+
+    if (data->cairo_array != NULL) {
+        g_array_free(data->cairo_array, TRUE);
+        data->cairo_array = NULL;
+    }
+    if (data->segments != NULL) {
+        g_array_free(data->segments, TRUE);
+        data->segments = NULL;
+    }
+    if (data->segments_extents != NULL) {
+        g_array_free(data->segments_extents, TRUE);
+        data->segments_extents = NULL;
+    }
+    if (data->lengths != NULL) {
+        g_array_free(data->lengths, TRUE);
+        data->lengths = NULL;
+    }
+    if (data->flats != NULL) {
+        g_array_free(data->flats, TRUE);
+        data->flats = NULL;
+    }
+    if (data->expanded != NULL) {
+        g_array_free(data->expanded, TRUE);
+        data->expanded = NULL;
+    }
+}
+
+/**
+ * adg_trail_save:
+ * @trail: an #AdgTrail
+ * @file: the name of the file to write
+ * @gerror: (allow-none): return location for errors
+ *
+ * Dumps the cairo path returned by adg_trail_cairo_path() together
+ * with the named pairs of @trail into @file. The primitives are
+ * stored in the #cairo_path_data_t layout of the running architecture,
+ * so the dump can be reloaded with adg_trail_new_from_file() without
+ * any parsing but it is not portable across platforms with different
+ * endianness or alignment.
+ *
+ * #CPML_ARC primitives are preserved as is, so no precision is lost
+ * and the trail properties (such as #AdgTrail:max-angle) still apply
+ * on the loaded trail.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_trail_save(AdgTrail *trail, const gchar *file, GError **gerror)
+{
+    cairo_path_t *cairo_path;
+    _AdgDumpHeader header;
+    _AdgDumpPairs pairs;
+    GByteArray *dump;
+    gboolean result;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+
+    cairo_path = adg_trail_cairo_path(trail);
+    pairs.pairs = g_byte_array_new();
+    pairs.names = g_string_new("");
+    adg_model_foreach_named_pair((AdgModel *) trail, _adg_dump_pair, &pairs);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _ADG_DUMP_MAGIC, sizeof(header.magic));
+    header.byte_order = _ADG_DUMP_BYTE_ORDER;
+    header.version = _ADG_DUMP_VERSION;
+    header.data_size = sizeof(cairo_path_data_t);
+    header.num_data = EMPTY_PATH(cairo_path) ? 0 : cairo_path->num_data;
+    header.n_pairs = pairs.pairs->len / sizeof(_AdgDumpPair);
+    header.names_size = pairs.names->len;
+
+    dump = g_byte_array_new();
+    g_byte_array_append(dump, (guint8 *) &header, sizeof(header));
+    if (header.num_data > 0)
+        g_byte_array_append(dump, (guint8 *) cairo_path->data,
+                            header.num_data * sizeof(cairo_path_data_t));
+    g_byte_array_append(dump, pairs.pairs->data, pairs.pairs->len);
+    g_byte_array_append(dump, (guint8 *) pairs.names->str, pairs.names->len);
+
+    result = g_file_set_contents(file, (gchar *) dump->data, dump->len, gerror);
+
+    g_byte_array_free(dump, TRUE);
+    g_byte_array_free(pairs.pairs, TRUE);
+    g_string_free(pairs.names, TRUE);
+
+    return result;
+}
+
 /**
  * adg_trail_get_cairo_path:
  * @trail: an #AdgTrail
@@ -249,6 +748,10 @@ adg_trail_new(AdgTrailCallback callback, gpointer user_data)
  * request is O(1). This cache is cleared only by the
  * adg_model_clear() method.
  *
+ * When there are no arcs to convert, no copy is done at all and the
+ * returned path shares its data with the one returned by
+ * adg_trail_cairo_path().
+ *
  * Returns: (transfer none): a pointer to the internal cairo path or <constant>NULL</constant> on errors.
  *
  * Since: 1.0
@@ -257,42 +760,16 @@ const cairo_path_t *
 adg_trail_get_cairo_path(AdgTrail *trail)
 {
     AdgTrailPrivate *data;
-    cairo_path_t *cairo_path;
-    GArray *dst;
-    const cairo_path_data_t *p_src;
-    int i;
 
     g_return_val_if_fail(ADG_IS_TRAIL(trail), NULL);
 
     data = trail->data;
 
-    /* Check for cached result */
-    if (data->cairo_path.data != NULL)
-        return &data->cairo_path;
-
-    cairo_path = adg_trail_cairo_path(trail);
-    if (EMPTY_PATH(cairo_path))
+    /* The path is being built by a worker thread */
+    if (data->computing)
         return NULL;
 
-    dst = g_array_sized_new(FALSE, FALSE,
-                            sizeof(cairo_path_data_t), cairo_path->num_data);
-
-    /* Cycle the cairo_path_t and convert arcs to Bézier curves */
-    for (i = 0; i < cairo_path->num_data; i += p_src->header.length) {
-        p_src = (const cairo_path_data_t *) cairo_path->data + i;
-
-        if (p_src->header.type == CPML_ARC)
-            dst = _adg_arc_to_curves(dst, p_src, data->max_angle);
-        else
-            dst = g_array_append_vals(dst, p_src, p_src->header.length);
-    }
-
-    cairo_path = &data->cairo_path;
-    cairo_path->status = CAIRO_STATUS_SUCCESS;
-    cairo_path->num_data = dst->len;
-    cairo_path->data = (cairo_path_data_t *) g_array_free(dst, FALSE);
-
-    return cairo_path;
+    return _adg_convert_cairo_path(trail);
 }
 
 /**
@@ -322,28 +799,154 @@ adg_trail_get_cairo_path(AdgTrail *trail)
 cairo_path_t *
 adg_trail_cairo_path(AdgTrail *trail)
 {
-    AdgTrailClass *klass;
     AdgTrailPrivate *data;
-    cairo_path_t *cairo_path;
 
     g_return_val_if_fail(ADG_IS_TRAIL(trail), NULL);
 
-    klass = ADG_TRAIL_GET_CLASS(trail);
-    if (klass->get_cairo_path == NULL)
+    data = trail->data;
+
+    /* The path is being built by a worker thread */
+    if (data->computing)
         return NULL;
 
+    return _adg_raw_cairo_path(trail);
+}
+
+/**
+ * adg_trail_compute_async:
+ * @trail: an #AdgTrail
+ *
+ * Builds the cairo path of @trail on a worker thread, so expensive
+ * trails (e.g. complex callbacks or #AdgEdges on big sources) do not
+ * block the main loop. Until the computation is done, @trail behaves
+ * as an empty trail: adg_trail_cairo_path() and
+ * adg_trail_get_cairo_path() return <constant>NULL</constant>.
+ *
+ * When the path is ready, adg_model_changed() is emitted on @trail
+ * from the default main context, so the dependent entities are
+ * invalidated and pick up the new path on the next arrange. The
+ * computed path is retained by that emission.
+ *
+ * The computations are serialized on a single worker, so trails
+ * sharing the same source can be safely scheduled together. Anyway
+ * @trail and the models it depends on must not be modified while
+ * the computation is in progress. If no worker can be spawned, the
+ * path is built synchronously but the change is still notified from
+ * the main loop.
+ *
+ * Nothing is done if @trail is already being computed, if its path
+ * is already cached or if @trail is frozen.
+ *
+ * Since: 1.0
+ **/
+void
+adg_trail_compute_async(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+    GThreadPool *pool;
+
+    g_return_if_fail(ADG_IS_TRAIL(trail));
+
     data = trail->data;
-    if (data->in_construction) {
-        g_warning(_("%s: you cannot access the path from the callback you provided to build it"),
-                  G_STRLOC);
-        return NULL;
-    }
 
-    data->in_construction = TRUE;
-    cairo_path = klass->get_cairo_path(trail);
-    data->in_construction = FALSE;
+    if (data->computing || data->cairo_path.data != NULL ||
+        adg_model_is_frozen((AdgModel *) trail))
+        return;
 
-    return cairo_path;
+    data->computing = TRUE;
+    g_object_ref(trail);
+
+    pool = _adg_compute_pool();
+    if (pool != NULL)
+        g_thread_pool_push(pool, trail, NULL);
+    else
+        _adg_compute_job(trail, NULL);
+}
+
+/**
+ * adg_trail_is_computing:
+ * @trail: an #AdgTrail
+ *
+ * Checks if the cairo path of @trail is being built on a worker
+ * thread by adg_trail_compute_async().
+ *
+ * Returns: <constant>TRUE</constant> if a computation is pending, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_trail_is_computing(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), FALSE);
+
+    data = trail->data;
+    return data->computing;
+}
+
+/**
+ * adg_trail_compute_parallel:
+ * @n_trails: number of trails
+ * @trails: (array length=n_trails): the trails to build
+ *
+ * Builds the cairo paths of @trails concurrently on a pool of worker
+ * threads and waits for all of them, so it is intended to be called
+ * after a batched update of the models (e.g. a parametric change
+ * recomputing the edges of many sources) and before arranging the
+ * canvas: the arrange phase will find the paths already cached.
+ *
+ * Only the trails whose class implements the
+ * <function>prepare</function> method (e.g. #AdgEdges) are built on
+ * the workers: the other ones, and the ones refused by prepare(), are
+ * built in sequence on the calling thread. The trails already cached,
+ * frozen or being computed by adg_trail_compute_async() are skipped.
+ *
+ * Unlike adg_trail_compute_async(), no #AdgModel::changed signal is
+ * emitted: the models must have already announced their changes, so
+ * the dependent entities are already waiting for a new arrange.
+ * @trails and the models they depend on must not be modified by
+ * other threads while this function is running.
+ *
+ * Since: 1.0
+ **/
+void
+adg_trail_compute_parallel(guint n_trails, AdgTrail **trails)
+{
+    AdgTrailClass *klass;
+    AdgTrailPrivate *data;
+    AdgTrail *trail;
+    GPtrArray *jobs;
+    guint n;
+
+    g_return_if_fail(n_trails == 0 || trails != NULL);
+
+    for (n = 0; n < n_trails; ++n)
+        g_return_if_fail(ADG_IS_TRAIL(trails[n]));
+
+    jobs = g_ptr_array_new();
+
+    /* After this loop whatever is shared between the trails (their
+     * sources, or the trails themselves when used as sources by other
+     * trails of the batch) is cached, so every job only writes on its
+     * own trail */
+    for (n = 0; n < n_trails; ++n) {
+        trail = trails[n];
+        data = trail->data;
+
+        if (data->computing || data->cairo_path.data != NULL ||
+            adg_model_is_frozen((AdgModel *) trail))
+            continue;
+
+        klass = ADG_TRAIL_GET_CLASS(trail);
+        if (klass->prepare != NULL && klass->prepare(trail))
+            g_ptr_array_add(jobs, trail);
+        else
+            _adg_convert_cairo_path(trail);
+    }
+
+    _adg_compute_jobs(jobs);
+    g_ptr_array_free(jobs, TRUE);
 }
 
 /**
@@ -353,6 +956,9 @@ adg_trail_cairo_path(AdgTrail *trail)
  * Convenient function that returns the number of non-empty segments defined
  * by the cairo path embedded in @trail.
  *
+ * The segments are indexed on the first call, so any further call is O(1)
+ * until the cache is cleared by adg_model_clear().
+ *
  * Returns: the number of segments or 0 on errrors.
  *
  * Since: 1.0
@@ -360,21 +966,13 @@ adg_trail_cairo_path(AdgTrail *trail)
 guint
 adg_trail_n_segments(AdgTrail *trail)
 {
-    cairo_path_t *cairo_path;
-    CpmlSegment iterator;
-    guint n;
+    GArray *segments;
 
     g_return_val_if_fail(ADG_IS_TRAIL(trail), 0);
 
-    cairo_path = adg_trail_cairo_path(trail);
-
-    n = 0;
-    if (! EMPTY_PATH(cairo_path) && cpml_segment_from_cairo(&iterator, cairo_path)) {
-        for (n = 1; cpml_segment_next(&iterator); ++n) {
-        }
-    }
+    segments = _adg_get_segments(trail);
 
-    return n;
+    return segments != NULL ? segments->len : 0;
 }
 
 /**
@@ -393,6 +991,9 @@ adg_trail_n_segments(AdgTrail *trail)
  * untouched. If the segment is found and @segment is
  * not <constant>NULL</constant>, the resulting segment is copied in @segment.
  *
+ * The lookup is O(1): the segments are indexed once and the index is
+ * retained until the cache is cleared by adg_model_clear().
+ *
  * Returns: <constant>TRUE</constant> on success or <constant>FALSE</constant> on errors.
  *
  * Since: 1.0
@@ -400,10 +1001,7 @@ adg_trail_n_segments(AdgTrail *trail)
 gboolean
 adg_trail_put_segment(AdgTrail *trail, guint n_segment, CpmlSegment *segment)
 {
-    cairo_path_t *cairo_path;
-    gboolean found;
-    CpmlSegment iterator;
-    guint cnt;
+    GArray *segments;
 
     g_return_val_if_fail(ADG_IS_TRAIL(trail), FALSE);
 
@@ -413,17 +1011,52 @@ adg_trail_put_segment(AdgTrail *trail, guint n_segment, CpmlSegment *segment)
         return FALSE;
     }
 
-    cairo_path = adg_trail_cairo_path(trail);
-    found = ! EMPTY_PATH(cairo_path) &&
-        cpml_segment_from_cairo(&iterator, cairo_path);
+    segments = _adg_get_segments(trail);
+    if (segments == NULL || n_segment > segments->len)
+        return FALSE;
+
+    if (segment != NULL)
+        cpml_segment_copy(segment,
+                          &g_array_index(segments, CpmlSegment, n_segment - 1));
+
+    return TRUE;
+}
+
+/**
+ * adg_trail_get_segment_extents:
+ * @trail: an #AdgTrail
+ * @n_segment: the segment to inspect, where 1 is the first segment
+ *
+ * Gets the extents of the @n_segment segment of @trail. The returned
+ * pointer is owned by @trail and should not be freed nor modified.
+ *
+ * The extents of all the segments are computed once and retained
+ * until the cache is cleared by adg_model_clear(), so any further
+ * call is O(1).
+ *
+ * Returns: the requested extents or <constant>NULL</constant> if the
+ *          segment is not found.
+ *
+ * Since: 1.0
+ **/
+const CpmlExtents *
+adg_trail_get_segment_extents(AdgTrail *trail, guint n_segment)
+{
+    GArray *segments_extents;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), NULL);
 
-    for (cnt = 1; found && cnt < n_segment; ++cnt)
-        found = cpml_segment_next(&iterator);
+    if (n_segment == 0) {
+        g_warning(_("%s: requested undefined segment for type '%s'"),
+                  G_STRLOC, g_type_name(G_OBJECT_TYPE(trail)));
+        return NULL;
+    }
 
-    if (found && segment != NULL)
-        cpml_segment_copy(segment, &iterator);
+    segments_extents = _adg_get_segments_extents(trail);
+    if (segments_extents == NULL || n_segment > segments_extents->len)
+        return NULL;
 
-    return found;
+    return &g_array_index(segments_extents, CpmlExtents, n_segment - 1);
 }
 
 /**
@@ -433,6 +1066,10 @@ adg_trail_put_segment(AdgTrail *trail, guint n_segment, CpmlSegment *segment)
  * Gets the extents of @trail. The returned pointer is owned by
  * @trail and should not be freed nor modified.
  *
+ * The result is the union of the extents of the segments, as
+ * returned by adg_trail_get_segment_extents(), so the primitives
+ * are inspected only once per cache invalidation.
+ *
  * Returns: the requested extents or <constant>NULL</constant> on errors.
  *
  * Since: 1.0
@@ -447,23 +1084,123 @@ adg_trail_get_extents(AdgTrail *trail)
     data = trail->data;
 
     if (!data->extents.is_defined) {
-        cairo_path_t *cairo_path;
-        CpmlSegment segment;
-        CpmlExtents extents;
-
-        cairo_path = adg_trail_cairo_path(trail);
-        if (! EMPTY_PATH(cairo_path) &&
-            cpml_segment_from_cairo(&segment, cairo_path)) {
-            do {
-                cpml_segment_put_extents(&segment, &extents);
-                cpml_extents_add(&data->extents, &extents);
-            } while (cpml_segment_next(&segment));
+        GArray *segments_extents = _adg_get_segments_extents(trail);
+        guint n;
+
+        if (segments_extents != NULL) {
+            for (n = 0; n < segments_extents->len; ++n)
+                cpml_extents_add(&data->extents,
+                                 &g_array_index(segments_extents,
+                                                CpmlExtents, n));
         }
     }
 
     return &data->extents;
 }
 
+/**
+ * adg_trail_get_length:
+ * @trail: an #AdgTrail
+ *
+ * Gets the total length of @trail, that is the sum of the lengths
+ * of all its segments. The gaps between the segments are not counted.
+ *
+ * Bézier curves are measured by dividing them in a fixed number of
+ * chunks, so their length is slightly underestimated.
+ *
+ * Returns: the length of @trail or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+gdouble
+adg_trail_get_length(AdgTrail *trail)
+{
+    GArray *lengths;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), 0);
+
+    lengths = _adg_get_lengths(trail);
+    if (lengths == NULL || lengths->len == 0)
+        return 0;
+
+    return g_array_index(lengths, _AdgLength, lengths->len - 1).length;
+}
+
+/**
+ * adg_trail_put_pair_at_length:
+ * @trail: an #AdgTrail
+ * @length: the distance from the start of @trail
+ * @pair: (out): the destination #CpmlPair
+ *
+ * Gets the point of @trail at @length from its start, walking
+ * along all the segments as if they were joined together. This is
+ * the function to use to place repeated symbols along a path.
+ *
+ * The cumulative lengths of the primitives are computed once and
+ * retained until the cache is cleared by adg_model_clear(), so any
+ * lookup is O(log n) on the number of primitives.
+ *
+ * Returns: <constant>TRUE</constant> on success or <constant>FALSE</constant> if @length is out of range.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_trail_put_pair_at_length(AdgTrail *trail, gdouble length, CpmlPair *pair)
+{
+    const _AdgLength *entry;
+    gdouble pos;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), FALSE);
+    g_return_val_if_fail(pair != NULL, FALSE);
+
+    entry = _adg_find_length(trail, length, &pos);
+    if (entry == NULL)
+        return FALSE;
+
+    if (cpml_primitive_type(&entry->primitive) == CPML_CURVE)
+        cpml_curve_put_pair_at_time(&entry->primitive, pos, pair);
+    else
+        cpml_primitive_put_pair_at(&entry->primitive, pos, pair);
+
+    return TRUE;
+}
+
+/**
+ * adg_trail_put_vector_at_length:
+ * @trail: an #AdgTrail
+ * @length: the distance from the start of @trail
+ * @vector: (out): the destination #CpmlVector
+ *
+ * Gets the steepness of @trail at @length from its start. See
+ * adg_trail_put_pair_at_length() for details on how @length is
+ * interpreted.
+ *
+ * Returns: <constant>TRUE</constant> on success or <constant>FALSE</constant> if @length is out of range.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_trail_put_vector_at_length(AdgTrail *trail, gdouble length,
+                               CpmlVector *vector)
+{
+    const _AdgLength *entry;
+    gdouble pos;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), FALSE);
+    g_return_val_if_fail(vector != NULL, FALSE);
+
+    entry = _adg_find_length(trail, length, &pos);
+    if (entry == NULL)
+        return FALSE;
+
+    if (cpml_primitive_type(&entry->primitive) == CPML_CURVE)
+        cpml_curve_put_vector_at_time(&entry->primitive, pos, vector);
+    else
+        cpml_primitive_put_vector_at(&entry->primitive, pos, vector);
+
+    return TRUE;
+}
+
 /**
  * adg_trail_dump:
  * @trail: an #AdgTrail
@@ -480,7 +1217,7 @@ adg_trail_dump(AdgTrail *trail)
 
     g_return_if_fail(ADG_IS_TRAIL(trail));
 
-    cairo_path = (cairo_path_t *) adg_trail_get_cairo_path(trail);
+    cairo_path = (cairo_path_t *) _adg_trail_get_cairo_path(trail);
 
     g_return_if_fail(cairo_path != NULL);
 
@@ -548,21 +1285,256 @@ adg_trail_get_max_angle(AdgTrail *trail)
     return data->max_angle;
 }
 
+/**
+ * adg_trail_set_tolerance:
+ * @trail:     an #AdgTrail
+ * @tolerance: the new tolerance
+ *
+ * Sets the tolerance of @trail to @tolerance, basically setting
+ * the #AdgTrail:tolerance property.
+ *
+ * When the tolerance is greater than 0, the number of Bézier curves
+ * used by adg_trail_get_cairo_path() to approximate an arc is not
+ * derived from #AdgTrail:max-angle anymore: it is instead the minimum
+ * number of curves that keeps the distance between the arc and its
+ * approximation below @tolerance. Bigger arcs will hence use more
+ * curves while small arcs can be approximated by a single curve
+ * spanning up to %G_PI.
+ *
+ * @tolerance is expressed in the same space as the trail. To bound the
+ * error on the output device, divide the device tolerance by the
+ * scale factor applied on rendering, that is the scale of the global
+ * and local matrices of the entity multiplied by the
+ * #AdgCanvas:factor of the canvas.
+ *
+ * Since: 1.0
+ **/
+void
+adg_trail_set_tolerance(AdgTrail *trail, gdouble tolerance)
+{
+    g_return_if_fail(ADG_IS_TRAIL(trail));
+    g_object_set(trail, "tolerance", tolerance, NULL);
+}
+
+/**
+ * adg_trail_get_tolerance:
+ * @trail: an #AdgTrail
+ *
+ * Gets the #AdgTrail:tolerance property value of @trail.
+ * Refer to adg_trail_set_tolerance() for details of what
+ * this parameter is used for.
+ *
+ * Returns: the tolerance or 0 if the max angle must be used instead
+ *
+ * Since: 1.0
+ **/
+gdouble
+adg_trail_get_tolerance(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), 0);
+
+    data = trail->data;
+    return data->tolerance;
+}
+
+/**
+ * adg_trail_get_memory_usage:
+ * @trail: an #AdgTrail
+ *
+ * Estimates the memory used by @trail, including the instance data and
+ * the flattened copies and segments cached by the trail itself. The
+ * path returned by the callback, if any, is owned by the caller and
+ * it is not included.
+ *
+ * Returns: the estimated number of bytes used by @trail.
+ *
+ * Since: 1.0
+ **/
+gsize
+adg_trail_get_memory_usage(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+    GTypeQuery query;
+    gsize usage;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), 0);
+
+    data = trail->data;
+    g_type_query(G_OBJECT_TYPE(trail), &query);
+    usage = query.instance_size + sizeof(AdgTrailPrivate);
+
+    if (data->cairo_array != NULL)
+        usage += data->cairo_array->len * sizeof(cairo_path_data_t);
+    if (data->segments != NULL)
+        usage += data->segments->len * sizeof(CpmlSegment);
+    if (data->segments_extents != NULL)
+        usage += data->segments_extents->len * sizeof(CpmlExtents);
+    if (data->arc_caches != NULL)
+        usage += data->arc_caches->len * sizeof(CpmlArcCache);
+    if (data->lengths != NULL)
+        usage += data->lengths->len * sizeof(_AdgLength);
+    if (data->flats != NULL) {
+        guint n;
+
+        for (n = 0; n < data->flats->len; ++n)
+            usage += sizeof(cairo_path_t) + sizeof(cairo_path_data_t) *
+                g_array_index(data->flats, _AdgFlat, n).path->num_data;
+    }
+
+    return usage;
+}
+
 
 static void
 _adg_clear(AdgModel *model)
 {
-    AdgTrailPrivate *data = ((AdgTrail *) model)->data;
+    _adg_clear_cache((AdgTrail *) model);
+
+    if (_ADG_OLD_MODEL_CLASS->clear)
+        _ADG_OLD_MODEL_CLASS->clear(model);
+}
+
+static void
+_adg_changed(AdgModel *model)
+{
+    _adg_clear_cache((AdgTrail *) model);
+
+    if (_ADG_OLD_MODEL_CLASS->changed)
+        _ADG_OLD_MODEL_CLASS->changed(model);
+}
+
+static void
+_adg_freeze(AdgModel *model)
+{
+    AdgTrail *trail;
+    AdgTrailPrivate *data;
+
+    trail = (AdgTrail *) model;
+    data = trail->data;
+
+    if (data->computing)
+        g_warning(_("%s: freezing a trail while computing its path"),
+                  G_STRLOC);
+
+    /* Build every cache: after this call no accessor can write on
+     * data, so the trail can be read from more threads at once */
+    data->frozen_path = _adg_raw_cairo_path(trail);
+    _adg_convert_cairo_path(trail);
+    adg_trail_get_extents(trail);
+    _adg_get_lengths(trail);
+
+    if (_ADG_OLD_MODEL_CLASS->freeze)
+        _ADG_OLD_MODEL_CLASS->freeze(model);
+}
+
+static void
+_adg_clear_cache(AdgTrail *trail)
+{
+    AdgTrailPrivate *data = trail->data;
+
+    /* A frozen trail can still be cleared by a subclass, e.g. while
+     * disposing it: the caches must be retained anyway */
+    if (adg_model_is_frozen((AdgModel *) trail))
+        return;
 
-    g_free(data->cairo_path.data);
+    /* The change announcing a path built by adg_trail_compute_async()
+     * must not throw away the result */
+    if (data->announcing)
+        return;
 
+    /* The converted data, if any, lives in data->cairo_array
+     * that is kept for reuse */
     data->cairo_path.status = CAIRO_STATUS_INVALID_PATH_DATA;
     data->cairo_path.data = NULL;
     data->cairo_path.num_data = 0;
     data->extents.is_defined = FALSE;
 
-    if (_ADG_OLD_MODEL_CLASS->clear)
-        _ADG_OLD_MODEL_CLASS->clear(model);
+    if (data->segments != NULL)
+        g_array_set_size(data->segments, 0);
+    if (data->segments_extents != NULL)
+        g_array_set_size(data->segments_extents, 0);
+    if (data->lengths != NULL)
+        g_array_set_size(data->lengths, 0);
+    if (data->flats != NULL)
+        _adg_clear_flats(data->flats);
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_segments, 0);
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_extents, 0);
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_lengths, 0);
+
+    data->raw_path = NULL;
+}
+
+static void
+_adg_clear_flats(GArray *flats)
+{
+    guint n;
+
+    for (n = 0; n < flats->len; ++n)
+        cairo_path_destroy(g_array_index(flats, _AdgFlat, n).path);
+
+    g_array_set_size(flats, 0);
+}
+
+/* The result is cached, unless @trail is frozen: in that case
+ * the flattened path is returned in @owned and must be freed */
+static const cairo_path_t *
+_adg_get_flat(AdgTrail *trail, gdouble tolerance, cairo_path_t **owned)
+{
+    AdgTrailPrivate *data;
+    const cairo_path_t *cairo_path;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    _AdgFlat flat;
+    guint n;
+
+    data = trail->data;
+    *owned = NULL;
+
+    /* Check for cached result */
+    if (data->flats != NULL) {
+        for (n = 0; n < data->flats->len; ++n)
+            if (g_array_index(data->flats, _AdgFlat, n).tolerance == tolerance)
+                return g_array_index(data->flats, _AdgFlat, n).path;
+    }
+
+    cairo_path = _adg_trail_get_cairo_path(trail);
+    if (cairo_path == NULL)
+        return NULL;
+
+    /* With an identity matrix the device space is the model space */
+    surface = cairo_recording_surface_create(CAIRO_CONTENT_ALPHA, NULL);
+    cr = cairo_create(surface);
+    cairo_surface_destroy(surface);
+    cairo_set_tolerance(cr, tolerance);
+    cairo_append_path(cr, cairo_path);
+    flat.tolerance = tolerance;
+    flat.path = cairo_copy_path_flat(cr);
+    cairo_destroy(cr);
+
+    if (flat.path->status != CAIRO_STATUS_SUCCESS) {
+        cairo_path_destroy(flat.path);
+        return NULL;
+    }
+
+    if (adg_model_is_frozen((AdgModel *) trail)) {
+        *owned = flat.path;
+        return flat.path;
+    }
+
+    if (data->flats == NULL)
+        data->flats = g_array_new(FALSE, FALSE, sizeof(_AdgFlat));
+
+    /* Drop the oldest entry, e.g. on continuous zooming */
+    if (data->flats->len >= MAX_FLATS) {
+        cairo_path_destroy(g_array_index(data->flats, _AdgFlat, 0).path);
+        g_array_remove_index(data->flats, 0);
+    }
+
+    g_array_append_val(data->flats, flat);
+
+    return flat.path;
 }
 
 static cairo_path_t *
@@ -576,36 +1548,687 @@ _adg_get_cairo_path(AdgTrail *trail)
         return NULL;
     }
 
-    return data->callback(trail, data->user_data);
+    /* Check for cached result */
+    if (data->raw_path == NULL) {
+        cairo_path_t *cairo_path = data->callback(trail, data->user_data);
+
+        /* Do not cache paths still under construction */
+        if (EMPTY_PATH(cairo_path) || cairo_path->status != CAIRO_STATUS_SUCCESS)
+            return cairo_path;
+
+        data->raw_path = cairo_path;
+    }
+
+    return data->raw_path;
+}
+
+static const cairo_path_t *
+_adg_convert_cairo_path(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+    cairo_path_t *cairo_path;
+    GArray *dst;
+    const cairo_path_data_t *p_src;
+    guint n_arc;
+    CpmlCursor cursor;
+
+    data = trail->data;
+
+    /* Check for cached result */
+    if (data->cairo_path.data != NULL)
+        return &data->cairo_path;
+
+    cairo_path = _adg_raw_cairo_path(trail);
+    if (EMPTY_PATH(cairo_path))
+        return NULL;
+
+    /* Look for the first arc */
+    if (! cpml_cursor_from_cairo(&cursor, cairo_path))
+        return NULL;
+
+    do {
+        p_src = cpml_cursor_get_data(&cursor);
+        if (p_src->header.type == CPML_ARC)
+            break;
+    } while (cpml_cursor_next(&cursor));
+
+    if (p_src->header.type != CPML_ARC) {
+        /* No arcs to convert: share the data with the source path */
+        data->cairo_path = *cairo_path;
+        return &data->cairo_path;
+    }
+
+    /* The buffer is kept across invalidations, so its capacity
+     * is reused by the next conversion */
+    dst = data->cairo_array;
+    if (dst == NULL)
+        dst = g_array_sized_new(FALSE, FALSE, sizeof(cairo_path_data_t),
+                                cairo_path->num_data);
+    else
+        g_array_set_size(dst, 0);
+
+    /* Copy the data before the first arc as is, then cycle the
+     * cairo_path_t and convert arcs to Bézier curves */
+    dst = g_array_append_vals(dst, cairo_path->data,
+                              cpml_cursor_get_offset(&cursor));
+    n_arc = 0;
+    do {
+        p_src = cpml_cursor_get_data(&cursor);
+
+        if (p_src->header.type == CPML_ARC)
+            dst = _adg_arc_to_curves(dst, cpml_cursor_get_org(&cursor),
+                                     p_src, n_arc++, data);
+        else
+            dst = g_array_append_vals(dst, p_src, p_src->header.length);
+    } while (cpml_cursor_next(&cursor));
+
+    cairo_path = &data->cairo_path;
+    cairo_path->status = CAIRO_STATUS_SUCCESS;
+    cairo_path->num_data = dst->len;
+    cairo_path->data = (cairo_path_data_t *) dst->data;
+    data->cairo_array = dst;
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_array,
+                   dst->len * sizeof(cairo_path_data_t));
+
+    return cairo_path;
+}
+
+static cairo_path_t *
+_adg_raw_cairo_path(AdgTrail *trail)
+{
+    AdgTrailClass *klass;
+    AdgTrailPrivate *data;
+    cairo_path_t *cairo_path;
+    ADG_TRACE_START(span);
+
+    data = trail->data;
+
+    /* The path of a frozen trail is built once by _adg_freeze() */
+    if (adg_model_is_frozen((AdgModel *) trail))
+        return data->frozen_path;
+
+    klass = ADG_TRAIL_GET_CLASS(trail);
+    if (klass->get_cairo_path == NULL)
+        return NULL;
+
+    if (data->in_construction) {
+        g_warning(_("%s: you cannot access the path from the callback you provided to build it"),
+                  G_STRLOC);
+        return NULL;
+    }
+
+    data->in_construction = TRUE;
+    cairo_path = klass->get_cairo_path(trail);
+    data->in_construction = FALSE;
+
+    ADG_TRACE_STOP(span, "trail-cairo-path", G_OBJECT_TYPE_NAME(trail));
+
+    return cairo_path;
+}
+
+static GThreadPool *
+_adg_compute_pool(void)
+{
+    static GThreadPool *pool = NULL;
+    static gsize initialized = 0;
+
+    /* A single worker: the trails could share their sources, so
+     * running two computations concurrently would not be safe */
+    if (g_once_init_enter(&initialized)) {
+        pool = g_thread_pool_new(_adg_compute_job, NULL, 1, FALSE, NULL);
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return pool;
 }
 
+static void
+_adg_compute_job(gpointer job_data, gpointer user_data)
+{
+    AdgTrail *trail = job_data;
+
+    _adg_convert_cairo_path(trail);
+    g_idle_add(_adg_computed, trail);
+}
+
+static gboolean
+_adg_computed(gpointer user_data)
+{
+    AdgTrail *trail;
+    AdgTrailPrivate *data;
+
+    trail = user_data;
+    data = trail->data;
+
+    data->computing = FALSE;
+    data->announcing = TRUE;
+    adg_model_changed((AdgModel *) trail);
+    data->announcing = FALSE;
+
+    g_object_unref(trail);
+    return FALSE;
+}
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+
+typedef struct {
+    GMutex      mutex;
+    GCond       cond;
+    guint       pending;
+} AdgComputeBatch;
+
+typedef struct {
+    AdgTrail         *trail;
+    AdgComputeBatch  *batch;
+} AdgComputeJob;
+
+static void
+_adg_parallel_job(gpointer job_data, gpointer user_data)
+{
+    AdgComputeJob *job;
+    AdgComputeBatch *batch;
+
+    job = job_data;
+    batch = job->batch;
+
+    _adg_convert_cairo_path(job->trail);
+
+    g_mutex_lock(&batch->mutex);
+    if (-- batch->pending == 0)
+        g_cond_signal(&batch->cond);
+    g_mutex_unlock(&batch->mutex);
+
+    g_free(job);
+}
+
+static GThreadPool *
+_adg_parallel_pool(void)
+{
+    static GThreadPool *pool = NULL;
+    static gsize initialized = 0;
+
+    /* Not the _adg_compute_pool() worker: that one must stay
+     * serialized, while these jobs are independent by construction */
+    if (g_once_init_enter(&initialized)) {
+        pool = g_thread_pool_new(_adg_parallel_job, NULL,
+                                 g_get_num_processors(), FALSE, NULL);
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return pool;
+}
+
+static void
+_adg_compute_jobs(GPtrArray *trails)
+{
+    GThreadPool *pool;
+    AdgComputeBatch batch;
+    AdgComputeJob *job;
+    guint n;
+
+    pool = trails->len > 1 ? _adg_parallel_pool() : NULL;
+    if (pool == NULL) {
+        for (n = 0; n < trails->len; ++n)
+            _adg_convert_cairo_path(g_ptr_array_index(trails, n));
+        return;
+    }
+
+    g_mutex_init(&batch.mutex);
+    g_cond_init(&batch.cond);
+    batch.pending = trails->len;
+
+    g_mutex_lock(&batch.mutex);
+    for (n = 0; n < trails->len; ++n) {
+        job = g_new(AdgComputeJob, 1);
+        job->trail = g_ptr_array_index(trails, n);
+        job->batch = &batch;
+        g_thread_pool_push(pool, job, NULL);
+    }
+
+    while (batch.pending > 0)
+        g_cond_wait(&batch.cond, &batch.mutex);
+    g_mutex_unlock(&batch.mutex);
+
+    g_cond_clear(&batch.cond);
+    g_mutex_clear(&batch.mutex);
+}
+
+#else
+
+static void
+_adg_compute_jobs(GPtrArray *trails)
+{
+    guint n;
+
+    /* Parallel computation not supported by this GLib version */
+    for (n = 0; n < trails->len; ++n)
+        _adg_convert_cairo_path(g_ptr_array_index(trails, n));
+}
+
+#endif
+
 static GArray *
-_adg_arc_to_curves(GArray *array, const cairo_path_data_t *src,
-                   gdouble max_angle)
+_adg_get_segments(AdgTrail *trail)
 {
-    CpmlPrimitive arc;
-    double start, end;
+    AdgTrailPrivate *data;
+    cairo_path_t *cairo_path;
+    CpmlSegment iterator;
+    GArray *segments;
+
+    data = trail->data;
+
+    /* Check for cached result: an empty index of a frozen
+     * trail is final, so it must not be rebuilt */
+    if (data->segments != NULL && data->segments->len > 0)
+        return data->segments;
+    if (adg_model_is_frozen((AdgModel *) trail))
+        return NULL;
+
+    /* This could indirectly call adg_model_clear(), so it must be
+     * called before setting data->segments */
+    cairo_path = adg_trail_cairo_path(trail);
+    if (EMPTY_PATH(cairo_path) || ! cpml_segment_from_cairo(&iterator, cairo_path))
+        return NULL;
+
+    segments = data->segments;
+    if (segments == NULL)
+        segments = g_array_new(FALSE, FALSE, sizeof(CpmlSegment));
+    else
+        g_array_set_size(segments, 0);
+
+    do {
+        g_array_append_val(segments, iterator);
+    } while (cpml_segment_next(&iterator));
+
+    data->segments = segments;
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_segments,
+                   segments->len * sizeof(CpmlSegment));
+    return segments;
+}
+
+static GArray *
+_adg_get_segments_extents(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+    GArray *segments, *segments_extents;
+    CpmlExtents extents;
+    guint n;
+
+    data = trail->data;
+
+    /* Check for cached result */
+    if (data->segments_extents != NULL && data->segments_extents->len > 0)
+        return data->segments_extents;
+    if (adg_model_is_frozen((AdgModel *) trail))
+        return NULL;
+
+    segments = _adg_get_segments(trail);
+    if (segments == NULL)
+        return NULL;
+
+    segments_extents = data->segments_extents;
+    if (segments_extents == NULL)
+        segments_extents = g_array_sized_new(FALSE, FALSE, sizeof(CpmlExtents),
+                                             segments->len);
+    else
+        g_array_set_size(segments_extents, 0);
+
+    for (n = 0; n < segments->len; ++n) {
+        cpml_segment_put_extents(&g_array_index(segments, CpmlSegment, n),
+                                 &extents);
+        g_array_append_val(segments_extents, extents);
+    }
+
+    data->segments_extents = segments_extents;
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_extents,
+                   segments_extents->len * sizeof(CpmlExtents));
+    return segments_extents;
+}
+
+static GArray *
+_adg_get_lengths(AdgTrail *trail)
+{
+    AdgTrailPrivate *data;
+    GArray *segments, *lengths;
+    CpmlPrimitive primitive;
+    CpmlPair from, to;
+    _AdgLength entry;
+    gdouble total;
+    guint n, n_chunk;
+
+    data = trail->data;
+
+    /* Check for cached result */
+    if (data->lengths != NULL && data->lengths->len > 0)
+        return data->lengths;
+    if (adg_model_is_frozen((AdgModel *) trail))
+        return NULL;
+
+    segments = _adg_get_segments(trail);
+    if (segments == NULL)
+        return NULL;
+
+    lengths = data->lengths;
+    if (lengths == NULL)
+        lengths = g_array_new(FALSE, FALSE, sizeof(_AdgLength));
+    else
+        g_array_set_size(lengths, 0);
 
-    /* Build the arc primitive: the arc origin is supposed to be the previous
-     * point (src-1): this means a primitive must exist before the arc */
+    total = 0;
+
+    for (n = 0; n < segments->len; ++n) {
+        cpml_primitive_from_segment(&primitive,
+                                    &g_array_index(segments, CpmlSegment, n));
+        do {
+            cpml_primitive_copy(&entry.primitive, &primitive);
+
+            if (cpml_primitive_type(&primitive) != CPML_CURVE) {
+                total += cpml_primitive_get_length(&primitive);
+                entry.from = 0;
+                entry.to = 1;
+                entry.length = total;
+                g_array_append_val(lengths, entry);
+                continue;
+            }
+
+            /* Curves are split in chunks measured by their chords */
+            cpml_primitive_put_point(&primitive, 0, &from);
+            for (n_chunk = 1; n_chunk <= _ADG_CURVE_CHUNKS; ++n_chunk) {
+                entry.from = (gdouble) (n_chunk - 1) / _ADG_CURVE_CHUNKS;
+                entry.to = (gdouble) n_chunk / _ADG_CURVE_CHUNKS;
+                cpml_curve_put_pair_at_time(&primitive, entry.to, &to);
+                total += cpml_pair_distance(&from, &to);
+                entry.length = total;
+                g_array_append_val(lengths, entry);
+                from = to;
+            }
+        } while (cpml_primitive_next(&primitive));
+    }
+
+    data->lengths = lengths;
+    ADG_ALLOC_SYNC(ADG_ALLOC_DOMAIN_TRAIL, &data->traced_lengths,
+                   lengths->len * sizeof(_AdgLength));
+    return lengths;
+}
+
+/* Returns the entry of the lengths table containing @length and
+ * stores in @pos the position (or time) inside its primitive */
+static const _AdgLength *
+_adg_find_length(AdgTrail *trail, gdouble length, gdouble *pos)
+{
+    GArray *lengths;
+    const _AdgLength *entry;
+    gdouble start, size;
+    guint low, high, mid;
+
+    lengths = _adg_get_lengths(trail);
+    if (lengths == NULL || lengths->len == 0 || length < 0 ||
+        length > g_array_index(lengths, _AdgLength, lengths->len - 1).length)
+        return NULL;
+
+    /* Binary search of the first entry ending at or after @length */
+    low = 0;
+    high = lengths->len - 1;
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (g_array_index(lengths, _AdgLength, mid).length < length)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    entry = &g_array_index(lengths, _AdgLength, low);
+    start = low > 0 ? g_array_index(lengths, _AdgLength, low - 1).length : 0;
+    size = entry->length - start;
+
+    if (size > 0)
+        *pos = entry->from + (entry->to - entry->from) * (length - start) / size;
+    else
+        *pos = entry->from;
+
+    return entry;
+}
+
+static GArray *
+_adg_arc_to_curves(GArray *array, const cairo_path_data_t *org,
+                   const cairo_path_data_t *src, guint n_arc,
+                   AdgTrailPrivate *data)
+{
+    CpmlPrimitive arc;
+    CpmlArcCache *cache;
+    double r, start, end;
+
+    /* The arc caches survive the invalidations of the trail: they are
+     * bound to the n-th arc of the path and checked by value, so only
+     * the arcs really changed are recomputed. New caches are zeroed,
+     * that is invalid, by g_array_set_size() */
+    if (data->arc_caches == NULL)
+        data->arc_caches = g_array_new(FALSE, TRUE, sizeof(CpmlArcCache));
+    if (n_arc >= data->arc_caches->len)
+        g_array_set_size(data->arc_caches, n_arc + 1);
+    cache = &g_array_index(data->arc_caches, CpmlArcCache, n_arc);
+
+    /* Build the arc primitive: the origin is provided by the cursor,
+     * so it is valid also when the arc follows a CPML_CLOSE */
     arc.segment = NULL;
-    arc.org = (cairo_path_data_t *) (src-1);
+    arc.org = (cairo_path_data_t *) (org != NULL ? org : src - 1);
     arc.data = (cairo_path_data_t *) src;
 
-    if (cpml_arc_info(&arc, NULL, NULL, &start, &end)) {
+    if (cpml_arc_info_cached(&arc, cache, NULL, &r, &start, &end)) {
         CpmlSegment segment;
         int n_curves;
-        cairo_path_data_t *curves;
+        guint len;
+
+        if (data->tolerance > 0) {
+            /* Use the minimum number of curves that respects the
+             * tolerance, limiting every curve to half a circle */
+            n_curves = ceil(fabs(end-start) / G_PI);
+            if (n_curves < 1)
+                n_curves = 1;
+            while (n_curves < 1024 &&
+                   r * _adg_arc_error(fabs(end-start) / n_curves) > data->tolerance)
+                ++n_curves;
+        } else {
+            n_curves = ceil(fabs(end-start) / data->max_angle);
+        }
+        /* Generate the curves directly inside @array */
+        len = array->len;
+        array = g_array_set_size(array, len + n_curves * 4);
+        segment.data = &g_array_index(array, cairo_path_data_t, len);
+        cpml_arc_to_curves_cached(&arc, cache, &segment, n_curves);
+    }
+
+    return array;
+}
 
-        n_curves = ceil(fabs(end-start) / max_angle);
-        curves = g_new(cairo_path_data_t, n_curves * 4);
-        segment.data = curves;
-        cpml_arc_to_curves(&arc, &segment, n_curves);
+/* Error of the Bézier approximation of an arc with unitary radius,
+ * as computed by _arc_error_normalized() in cairo-arc.c */
+static gdouble
+_adg_arc_error(gdouble angle)
+{
+    return 2.0 / 27.0 * pow(sin(angle / 4), 6) / pow(cos(angle / 4), 2);
+}
+
+static void
+_adg_dump_pair(AdgModel *model, const gchar *name, AdgPair *pair,
+               gpointer user_data)
+{
+    _AdgDumpPairs *pairs;
+    _AdgDumpPair dump_pair;
+
+    pairs = (_AdgDumpPairs *) user_data;
+
+    dump_pair.name = pairs->names->len;
+    dump_pair.reserved = 0;
+    dump_pair.x = pair->x;
+    dump_pair.y = pair->y;
+
+    g_byte_array_append(pairs->pairs, (guint8 *) &dump_pair, sizeof(dump_pair));
+    /* Include the trailing NUL */
+    g_string_append_len(pairs->names, name, strlen(name) + 1);
+}
+
+static gboolean
+_adg_check_dump(const gchar *contents, gsize length)
+{
+    const _AdgDumpHeader *header;
+    const cairo_path_data_t *cairo_data;
+    const _AdgDumpPair *pair;
+    const gchar *names;
+    guint n;
 
-        array = g_array_append_vals(array, curves, n_curves * 4);
+    header = (const _AdgDumpHeader *) contents;
 
-        g_free(curves);
+    if (contents == NULL || length < sizeof(_AdgDumpHeader) ||
+        memcmp(header->magic, _ADG_DUMP_MAGIC, sizeof(header->magic)) != 0 ||
+        header->byte_order != _ADG_DUMP_BYTE_ORDER ||
+        header->version != _ADG_DUMP_VERSION ||
+        header->data_size != sizeof(cairo_path_data_t))
+        return FALSE;
+
+    /* 64 bit arithmetic avoids overflows on 32 bit platforms */
+    if (header->num_data > G_MAXINT ||
+        (guint64) length != (guint64) sizeof(_AdgDumpHeader) +
+                            (guint64) header->num_data * sizeof(cairo_path_data_t) +
+                            (guint64) header->n_pairs * sizeof(_AdgDumpPair) +
+                            header->names_size)
+        return FALSE;
+
+    /* Every primitive must be contained inside the data array */
+    cairo_data = (const cairo_path_data_t *) (header + 1);
+    for (n = 0; n < header->num_data; n += cairo_data[n].header.length) {
+        if (cairo_data[n].header.length <= 0 ||
+            cairo_data[n].header.length > (gint) (header->num_data - n))
+            return FALSE;
     }
 
-    return array;
+    /* Every name must be a NUL terminated string inside the blob */
+    pair = (const _AdgDumpPair *) (cairo_data + header->num_data);
+    names = (const gchar *) (pair + header->n_pairs);
+    if (header->n_pairs > 0 &&
+        (header->names_size == 0 || names[header->names_size - 1] != '\0'))
+        return FALSE;
+
+    for (n = 0; n < header->n_pairs; ++n, ++pair) {
+        if (pair->name >= header->names_size)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+_adg_copy_named_pair(AdgModel *model, const gchar *name,
+                     AdgPair *pair, gpointer user_data)
+{
+    adg_model_set_named_pair((AdgModel *) user_data, name, pair);
+}
+
+static cairo_path_t *
+_adg_compact_cairo_path(AdgTrail *trail, gpointer user_data)
+{
+    AdgTrailPrivate *data;
+    const _AdgCompactData *src, *end;
+    cairo_path_data_t item;
+    gint n;
+
+    data = trail->data;
+
+    if (data->expanded == NULL) {
+        data->expanded = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+        src = (const _AdgCompactData *) data->compact->data;
+        end = src + data->compact->len;
+
+        while (src < end) {
+            item.header.type = src->header.type;
+            item.header.length = src->header.length;
+            g_array_append_val(data->expanded, item);
+
+            for (n = src->header.length, ++src; n > 1; --n, src += 2) {
+                item.point.x = src[0].coord;
+                item.point.y = src[1].coord;
+                g_array_append_val(data->expanded, item);
+            }
+        }
+    }
+
+    data->compact_path.status = CAIRO_STATUS_SUCCESS;
+    data->compact_path.data = (cairo_path_data_t *) data->expanded->data;
+    data->compact_path.num_data = data->expanded->len;
+
+    return &data->compact_path;
+}
+
+static cairo_path_t *
+_adg_mapped_cairo_path(AdgTrail *trail, gpointer user_data)
+{
+    AdgTrailPrivate *data = trail->data;
+    return &data->mapped_path;
+}
+
+
+/**
+ * _adg_trail_append_flat:
+ * @trail: an #AdgTrail
+ * @cr: the destination cairo context
+ * @matrix: the transformation from model space to the user space of @cr
+ * @dest: (element-type cairo_path_data_t): where to append the path
+ *
+ * Appends to @dest the data of @trail flattened and transformed by
+ * @matrix, i.e. what cairo_copy_path_flat() would return on @cr after
+ * appending @trail under @matrix, with at least the same accuracy.
+ *
+ * The flattening is done in model space and cached by @trail, so all
+ * the entities showing the same trail at similar scales, e.g. several
+ * views of the same part, share it: only the cheap transformation of
+ * the points is done for every view.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> on errors.
+ **/
+gboolean
+_adg_trail_append_flat(AdgTrail *trail, cairo_t *cr,
+                       const cairo_matrix_t *matrix, GArray *dest)
+{
+    const cairo_path_t *flat;
+    cairo_path_t *owned;
+    cairo_path_data_t *path_data;
+    CpmlVector dx, dy;
+    gdouble scale, tolerance;
+    gint n, exponent;
+    guint first;
+
+    /* The largest stretching of a model unit on the device */
+    dx.x = matrix->xx;
+    dx.y = matrix->yx;
+    dy.x = matrix->xy;
+    dy.y = matrix->yy;
+    cairo_user_to_device_distance(cr, &dx.x, &dx.y);
+    cairo_user_to_device_distance(cr, &dy.x, &dy.y);
+    scale = sqrt(MAX(dx.x * dx.x + dx.y * dx.y, dy.x * dy.x + dy.y * dy.y));
+    if (scale <= 0)
+        return FALSE;
+
+    /* Round the tolerance down to a power of 2 */
+    tolerance = cairo_get_tolerance(cr) / scale;
+    frexp(tolerance, &exponent);
+    tolerance = ldexp(1, exponent - 1);
+
+    flat = _adg_get_flat(trail, tolerance, &owned);
+    if (flat == NULL)
+        return FALSE;
+
+    first = dest->len;
+    g_array_append_vals(dest, flat->data, flat->num_data);
+    path_data = &g_array_index(dest, cairo_path_data_t, first);
+
+    for (n = 0; n < flat->num_data; n += path_data[n].header.length) {
+        if (path_data[n].header.type != CAIRO_PATH_CLOSE_PATH)
+            cairo_matrix_transform_point(matrix, &path_data[n + 1].point.x,
+                                         &path_data[n + 1].point.y);
+    }
+
+    if (owned != NULL)
+        cairo_path_destroy(owned);
+
+    return TRUE;
 }
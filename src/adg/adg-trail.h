@@ -35,6 +35,7 @@ G_BEGIN_DECLS
 #define ADG_IS_TRAIL(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), ADG_TYPE_TRAIL))
 #define ADG_IS_TRAIL_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), ADG_TYPE_TRAIL))
 #define ADG_TRAIL_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), ADG_TYPE_TRAIL, AdgTrailClass))
+#define ADG_TRAIL_ERROR            (adg_trail_error_quark())
 
 
 typedef struct _AdgTrail        AdgTrail;
@@ -54,24 +55,57 @@ struct _AdgTrailClass {
     /*< public >*/
     /* Virtual table */
     cairo_path_t *  (*get_cairo_path)           (AdgTrail        *trail);
+    gboolean        (*prepare)                  (AdgTrail        *trail);
 };
 
+typedef enum {
+    ADG_TRAIL_ERROR_FORMAT,
+} AdgTrailError;
+
 
 GType               adg_trail_get_type          (void);
+GQuark              adg_trail_error_quark       (void);
 AdgTrail *          adg_trail_new               (AdgTrailCallback callback,
                                                  gpointer         user_data);
+AdgTrail *          adg_trail_new_from_file     (const gchar     *file,
+                                                 GError         **gerror);
+AdgTrail *          adg_trail_new_compact       (AdgTrail        *trail);
+void                adg_trail_release_cache     (AdgTrail        *trail);
+gboolean            adg_trail_save              (AdgTrail        *trail,
+                                                 const gchar     *file,
+                                                 GError         **gerror);
 
 const cairo_path_t *adg_trail_get_cairo_path    (AdgTrail        *trail);
 cairo_path_t *      adg_trail_cairo_path        (AdgTrail        *trail);
+void                adg_trail_compute_async     (AdgTrail        *trail);
+gboolean            adg_trail_is_computing      (AdgTrail        *trail);
+void                adg_trail_compute_parallel  (guint           n_trails,
+                                                 AdgTrail      **trails);
 guint               adg_trail_n_segments        (AdgTrail        *trail);
 gboolean            adg_trail_put_segment       (AdgTrail        *trail,
                                                  guint            n_segment,
                                                  CpmlSegment     *segment);
+const CpmlExtents * adg_trail_get_segment_extents
+                                                (AdgTrail        *trail,
+                                                 guint            n_segment);
 const CpmlExtents * adg_trail_get_extents       (AdgTrail        *trail);
+gdouble             adg_trail_get_length        (AdgTrail        *trail);
+gboolean            adg_trail_put_pair_at_length
+                                                (AdgTrail        *trail,
+                                                 gdouble          length,
+                                                 CpmlPair        *pair);
+gboolean            adg_trail_put_vector_at_length
+                                                (AdgTrail        *trail,
+                                                 gdouble          length,
+                                                 CpmlVector      *vector);
 void                adg_trail_dump              (AdgTrail        *trail);
 void                adg_trail_set_max_angle     (AdgTrail        *trail,
                                                  gdouble          angle);
 gdouble             adg_trail_get_max_angle     (AdgTrail        *trail);
+void                adg_trail_set_tolerance     (AdgTrail        *trail,
+                                                 gdouble         tolerance);
+gdouble             adg_trail_get_tolerance     (AdgTrail        *trail);
+gsize               adg_trail_get_memory_usage  (AdgTrail        *trail);
 
 G_END_DECLS
 
@@ -90,6 +90,8 @@
 
 
 #include "adg-internal.h"
+#include "adg-dash.h"
+#include "adg-cairo-fallback.h"
 #include <string.h>
 #include <limits.h>
 #include <math.h>
@@ -570,3 +572,207 @@ adg_unescaped_strchr(const gchar *string, gint ch)
 
     return ptr;
 }
+
+
+typedef struct {
+    gsize       live_bytes;
+    guint       n_live;
+    guint       n_allocations;
+} AdgAllocStats;
+
+static AdgAllocStats _adg_alloc_stats[ADG_ALLOC_DOMAIN_DIM + 1];
+G_LOCK_DEFINE_STATIC(_adg_alloc_stats);
+
+/**
+ * adg_alloc_stats:
+ * @domain: (type AdgAllocDomain): the subsystem to inspect
+ * @live_bytes: (out) (allow-none): where to store the bytes still allocated
+ * @n_live: (out) (allow-none): where to store the number of blocks still allocated
+ * @n_allocations: (out) (allow-none): where to store the number of
+ *                 allocations performed since the start
+ *
+ * Gets the memory accounted to @domain. The counters are updated only
+ * when the library has been configured with
+ * <code>--enable-alloc-trace</code>: in the other cases this function
+ * returns %FALSE and leaves the arguments untouched.
+ *
+ * The counting is done at the allocation points owned by the
+ * subsystem, so memory allocated on its behalf by third party
+ * libraries (e.g. the internals of a #PangoLayout) is not included.
+ *
+ * Returns: %TRUE if the counters are available, %FALSE otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_alloc_stats(AdgAllocDomain domain, gsize *live_bytes,
+                guint *n_live, guint *n_allocations)
+{
+    g_return_val_if_fail(adg_is_enum_value(domain, ADG_TYPE_ALLOC_DOMAIN), FALSE);
+
+#ifdef ALLOC_TRACE_ENABLED
+    G_LOCK(_adg_alloc_stats);
+
+    if (live_bytes != NULL)
+        *live_bytes = _adg_alloc_stats[domain].live_bytes;
+    if (n_live != NULL)
+        *n_live = _adg_alloc_stats[domain].n_live;
+    if (n_allocations != NULL)
+        *n_allocations = _adg_alloc_stats[domain].n_allocations;
+
+    G_UNLOCK(_adg_alloc_stats);
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/* Accounts a block of size @n_bytes to @domain: a positive value is
+ * an allocation, a negative value a release */
+void
+_adg_alloc_trace(AdgAllocDomain domain, gssize n_bytes)
+{
+    AdgAllocStats *stats = &_adg_alloc_stats[domain];
+
+    G_LOCK(_adg_alloc_stats);
+
+    if (n_bytes > 0) {
+        stats->live_bytes += n_bytes;
+        ++stats->n_live;
+        ++stats->n_allocations;
+    } else if (n_bytes < 0) {
+        stats->live_bytes -= -n_bytes;
+        --stats->n_live;
+    }
+
+    G_UNLOCK(_adg_alloc_stats);
+}
+
+/* Accounts a resizable buffer whose size was the value pointed by
+ * @traced and now is @n_bytes: 0 means the buffer has been released */
+void
+_adg_alloc_sync(AdgAllocDomain domain, gsize *traced, gsize n_bytes)
+{
+    AdgAllocStats *stats;
+
+    if (*traced == n_bytes)
+        return;
+
+    stats = &_adg_alloc_stats[domain];
+
+    G_LOCK(_adg_alloc_stats);
+
+    if (*traced == 0) {
+        ++stats->n_live;
+        ++stats->n_allocations;
+    } else if (n_bytes == 0) {
+        --stats->n_live;
+    }
+
+    stats->live_bytes = stats->live_bytes - *traced + n_bytes;
+    *traced = n_bytes;
+
+    G_UNLOCK(_adg_alloc_stats);
+}
+
+/* Compares two values of the same type by content: strings, pairs,
+ * matrices and dashes are compared by value, anything else by its
+ * raw data, that is numbers and enums by value and the other
+ * pointers by identity */
+gboolean
+_adg_value_equal(const GValue *value, const GValue *value2)
+{
+    if (G_VALUE_TYPE(value) != G_VALUE_TYPE(value2))
+        return FALSE;
+
+    if (G_VALUE_HOLDS_STRING(value))
+        return g_strcmp0(g_value_get_string(value),
+                         g_value_get_string(value2)) == 0;
+
+    if (G_VALUE_HOLDS(value, CPML_TYPE_PAIR)) {
+        const CpmlPair *pair = g_value_get_boxed(value);
+        const CpmlPair *pair2 = g_value_get_boxed(value2);
+
+        if (pair == NULL || pair2 == NULL)
+            return pair == pair2;
+
+        return pair->x == pair2->x && pair->y == pair2->y;
+    }
+
+    if (G_VALUE_HOLDS(value, CAIRO_GOBJECT_TYPE_MATRIX)) {
+        const cairo_matrix_t *matrix = g_value_get_boxed(value);
+        const cairo_matrix_t *matrix2 = g_value_get_boxed(value2);
+
+        if (matrix == NULL || matrix2 == NULL)
+            return matrix == matrix2;
+
+        return adg_matrix_equal(matrix, matrix2);
+    }
+
+    if (G_VALUE_HOLDS(value, ADG_TYPE_DASH)) {
+        const AdgDash *dash = g_value_get_boxed(value);
+        const AdgDash *dash2 = g_value_get_boxed(value2);
+        gint num_dashes;
+
+        if (dash == NULL || dash2 == NULL)
+            return dash == dash2;
+
+        num_dashes = adg_dash_get_num_dashes(dash);
+        return num_dashes == adg_dash_get_num_dashes(dash2) &&
+               adg_dash_get_offset(dash) == adg_dash_get_offset(dash2) &&
+               memcmp(adg_dash_get_dashes(dash), adg_dash_get_dashes(dash2),
+                      num_dashes * sizeof(gdouble)) == 0;
+    }
+
+    return memcmp(value->data, value2->data, sizeof(value->data)) == 0;
+}
+
+/* An hash consistent with _adg_value_equal(): the boxed values
+ * compared by content do not contribute to it */
+guint
+_adg_value_hash(const GValue *value)
+{
+    guint64 bits;
+
+    if (G_VALUE_HOLDS_STRING(value))
+        return value->data[0].v_pointer == NULL ?
+            0 : g_str_hash(value->data[0].v_pointer);
+
+    if (G_VALUE_HOLDS(value, CPML_TYPE_PAIR) ||
+        G_VALUE_HOLDS(value, CAIRO_GOBJECT_TYPE_MATRIX) ||
+        G_VALUE_HOLDS(value, ADG_TYPE_DASH))
+        return 0;
+
+    bits = value->data[0].v_uint64;
+    return (guint) (bits ^ (bits >> 32));
+}
+
+/* Inserts @data in @array just before the @before item, or appends it
+ * if @before is NULL. The pointer comparison walks a contiguous block
+ * of memory, so this is still cheap on big arrays. Returns FALSE,
+ * leaving @array untouched, if @before is not found */
+gboolean
+_adg_ptr_array_insert(GPtrArray *array, gpointer data, gpointer before)
+{
+    guint n;
+
+    if (before == NULL) {
+        g_ptr_array_add(array, data);
+        return TRUE;
+    }
+
+    for (n = 0; n < array->len; ++n)
+        if (g_ptr_array_index(array, n) == before)
+            break;
+
+    if (n == array->len)
+        return FALSE;
+
+    g_ptr_array_add(array, NULL);
+    memmove(array->pdata + n + 1, array->pdata + n,
+            (array->len - n - 1) * sizeof(gpointer));
+    array->pdata[n] = data;
+
+    return TRUE;
+}
@@ -60,6 +60,10 @@ gdouble                 adg_round               (gdouble         value,
                                                  gint            decimals);
 const gchar *           adg_unescaped_strchr    (const gchar    *string,
                                                  gint            ch);
+gboolean                adg_alloc_stats         (AdgAllocDomain  domain,
+                                                 gsize          *live_bytes,
+                                                 guint          *n_live,
+                                                 guint          *n_allocations);
 
 G_END_DECLS
 
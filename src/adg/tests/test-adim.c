@@ -270,6 +270,34 @@ _adg_property_has_extension2(void)
 
     adg_entity_destroy(ADG_ENTITY(adim));
 }
+static void
+_adg_method_compute_geometry(void)
+{
+    AdgADim *adim;
+    AdgEntity *entity;
+    CpmlExtents extents;
+
+    adim = adg_adim_new_full_explicit(10, 0, 0, 10, 0, 0, 0, 0, 8, 8);
+    entity = ADG_ENTITY(adim);
+
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(extents.is_defined);
+
+    /* Unchanged inputs must give back the same geometry */
+    adg_entity_invalidate(entity);
+    adg_entity_arrange(entity);
+    g_assert_true(cpml_extents_equal(&extents, adg_entity_get_extents(entity)));
+
+    /* Moving the dimension must update the geometry */
+    adg_dim_set_pos_explicit(ADG_DIM(adim), 16, 16);
+    adg_entity_invalidate(entity);
+    adg_entity_arrange(entity);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+    g_assert_false(cpml_extents_equal(&extents, adg_entity_get_extents(entity)));
+
+    adg_entity_destroy(entity);
+}
 
 
 int
@@ -295,5 +323,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/adim/property/has-extension1", _adg_property_has_extension1);
     g_test_add_func("/adg/adim/property/has-extension2", _adg_property_has_extension2);
 
+    g_test_add_func("/adg/adim/method/compute-geometry", _adg_method_compute_geometry);
+
     return g_test_run();
 }
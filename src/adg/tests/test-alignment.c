@@ -71,6 +71,34 @@ _adg_property_factor(void)
 
     g_object_unref(alignment);
 }
+static void
+_adg_method_arrange(void)
+{
+    AdgAlignment *alignment;
+    AdgEntity *entity;
+    CpmlExtents extents;
+    const CpmlExtents *new_extents;
+
+    alignment = adg_alignment_new_explicit(0.5, 0.5);
+    entity = (AdgEntity *) alignment;
+    adg_container_add(ADG_CONTAINER(alignment), ADG_ENTITY(adg_logo_new()));
+
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(extents.is_defined);
+
+    /* Changing the factor must only move the extents */
+    adg_alignment_set_factor_explicit(alignment, 1, 1);
+    adg_entity_arrange(entity);
+    new_extents = adg_entity_get_extents(entity);
+    g_assert_true(new_extents->is_defined);
+    adg_assert_isapprox(new_extents->org.x, extents.org.x - extents.size.x / 2);
+    adg_assert_isapprox(new_extents->org.y, extents.org.y - extents.size.y / 2);
+    adg_assert_isapprox(new_extents->size.x, extents.size.x);
+    adg_assert_isapprox(new_extents->size.y, extents.size.y);
+
+    adg_entity_destroy(entity);
+}
 
 
 int
@@ -93,5 +121,7 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/alignment/property/factor", _adg_property_factor);
 
+    g_test_add_func("/adg/alignment/method/arrange", _adg_method_arrange);
+
     return g_test_run();
 }
@@ -22,6 +22,32 @@
 #include <adg.h>
 
 
+static void
+_adg_behavior_template(void)
+{
+    AdgArrow *arrow1, *arrow2;
+    AdgModel *model1, *model2;
+
+    arrow1 = adg_arrow_new();
+    arrow2 = adg_arrow_new();
+
+    /* Arrows with the same angle share the same model */
+    model1 = adg_marker_model(ADG_MARKER(arrow1));
+    model2 = adg_marker_model(ADG_MARKER(arrow2));
+    g_assert_nonnull(model1);
+    g_assert_true(model1 == model2);
+
+    /* A different angle gives a different model */
+    adg_arrow_set_angle(arrow2, G_PI_4);
+    model2 = adg_marker_model(ADG_MARKER(arrow2));
+    g_assert_nonnull(model2);
+    g_assert_true(model1 != model2);
+    g_assert_nonnull(adg_trail_get_cairo_path(ADG_TRAIL(model2)));
+
+    adg_entity_destroy(ADG_ENTITY(arrow1));
+    adg_entity_destroy(ADG_ENTITY(arrow2));
+}
+
 static void
 _adg_property_local_mix(void)
 {
@@ -96,6 +122,8 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/arrow/type/object", ADG_TYPE_ARROW);
     adg_test_add_entity_checks("/adg/arrow/type/entity", ADG_TYPE_ARROW);
 
+    g_test_add_func("/adg/arrow/behavior/template", _adg_behavior_template);
+
     g_test_add_func("/adg/arrow/property/local-mix", _adg_property_local_mix);
     g_test_add_func("/adg/arrow/property/angle", _adg_property_angle);
 
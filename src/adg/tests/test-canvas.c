@@ -21,6 +21,8 @@
 #include <config.h>
 #include <adg-test.h>
 #include <adg.h>
+#include <glib/gstdio.h>
+#include <string.h>
 
 #ifdef G_OS_WIN32
 
@@ -656,6 +658,162 @@ _adg_property_left_padding(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_property_has_render_list(void)
+{
+    AdgCanvas *canvas;
+    gboolean invalid_boolean;
+    gboolean has_render_list;
+
+    canvas = ADG_CANVAS(adg_canvas_new());
+    invalid_boolean = (gboolean) 1234;
+
+    /* Check the default value */
+    has_render_list = adg_canvas_has_render_list(canvas);
+    g_assert_false(has_render_list);
+
+    /* Using the public APIs */
+    adg_canvas_switch_render_list(canvas, TRUE);
+    has_render_list = adg_canvas_has_render_list(canvas);
+    g_assert_true(has_render_list);
+
+    adg_canvas_switch_render_list(canvas, invalid_boolean);
+    has_render_list = adg_canvas_has_render_list(canvas);
+    g_assert_true(has_render_list);
+
+    adg_canvas_switch_render_list(canvas, FALSE);
+    has_render_list = adg_canvas_has_render_list(canvas);
+    g_assert_false(has_render_list);
+
+    /* Using GObject property methods */
+    g_object_set(canvas, "has-render-list", TRUE, NULL);
+    g_object_get(canvas, "has-render-list", &has_render_list, NULL);
+    g_assert_true(has_render_list);
+
+    g_object_set(canvas, "has-render-list", invalid_boolean, NULL);
+    g_object_get(canvas, "has-render-list", &has_render_list, NULL);
+    g_assert_true(has_render_list);
+
+    g_object_set(canvas, "has-render-list", FALSE, NULL);
+    g_object_get(canvas, "has-render-list", &has_render_list, NULL);
+    g_assert_false(has_render_list);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_behavior_render_list(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    AdgPath *path;
+    AdgStroke *stroke;
+    cairo_t *cr;
+    const CpmlExtents *extents;
+
+    canvas = adg_test_canvas();
+    entity = ADG_ENTITY(canvas);
+    cr = adg_test_cairo_context();
+
+    adg_canvas_switch_render_list(canvas, TRUE);
+
+    /* The first rendering compiles the list, the second one replays it */
+    adg_entity_render(entity, cr);
+    adg_entity_render(entity, cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 1);
+    adg_assert_isapprox(extents->size.y, 1);
+
+    /* Adding a new entity must drop the list and arrange again */
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 2, 3);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+
+    adg_entity_render(entity, cr);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 2);
+    adg_assert_isapprox(extents->size.y, 3);
+
+    /* Changing a model must drop the list too */
+    adg_entity_render(entity, cr);
+    path = ADG_PATH(adg_stroke_get_trail(stroke));
+    adg_path_line_to_explicit(path, 4, 5);
+    adg_model_changed(ADG_MODEL(path));
+
+    adg_entity_render(entity, cr);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 4);
+    adg_assert_isapprox(extents->size.y, 5);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_render_to_surface(AdgEntity *entity, cairo_surface_t *surface)
+{
+    cairo_t *cr = cairo_create(surface);
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+    adg_entity_render(entity, cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+}
+
+static void
+_adg_behavior_render_batch(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    AdgPath *path;
+    AdgStroke *stroke;
+    cairo_surface_t *expected, *surface;
+    gint n;
+
+    canvas = adg_canvas_new();
+    entity = ADG_ENTITY(canvas);
+
+    /* Two batchable strokes around one with a different dress */
+    for (n = 0; n < 3; ++n) {
+        path = adg_path_new();
+        adg_path_move_to_explicit(path, 10, 10 + n * 10);
+        adg_path_line_to_explicit(path, 50, 10 + n * 10);
+        stroke = adg_stroke_new(ADG_TRAIL(path));
+        g_object_unref(path);
+        if (n == 1)
+            adg_stroke_set_line_dress(stroke, ADG_DRESS_LINE_DIMENSION);
+        adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    }
+
+    expected = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 60, 40);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 60, 40);
+    _adg_render_to_surface(entity, expected);
+
+    /* The replayed list must give the same result */
+    adg_canvas_switch_render_list(canvas, TRUE);
+    _adg_render_to_surface(entity, surface);
+    _adg_render_to_surface(entity, surface);
+    g_assert_cmpint(memcmp(cairo_image_surface_get_data(expected),
+                           cairo_image_surface_get_data(surface),
+                           cairo_image_surface_get_stride(surface) * 40), ==, 0);
+
+    cairo_surface_destroy(surface);
+    cairo_surface_destroy(expected);
+    adg_entity_destroy(entity);
+}
+
 static void
 _adg_method_autoscale(void)
 {
@@ -874,6 +1032,827 @@ _adg_method_export(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static cairo_status_t
+_adg_write_func(void *closure, const unsigned char *data, unsigned int length)
+{
+    g_string_append_len((GString *) closure, (const gchar *) data, length);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_adg_method_export_to_stream(void)
+{
+    AdgCanvas *canvas;
+    GString *buffer;
+
+    canvas = adg_test_canvas();
+    buffer = g_string_new("");
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_export_to_stream(NULL, CAIRO_SURFACE_TYPE_IMAGE, _adg_write_func, buffer, NULL));
+    g_assert_false(adg_canvas_export_to_stream(canvas, CAIRO_SURFACE_TYPE_IMAGE, NULL, buffer, NULL));
+
+    g_assert_true(adg_canvas_export_to_stream(canvas, CAIRO_SURFACE_TYPE_IMAGE, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, >, 0);
+
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_to_stream(canvas, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, >, 0);
+
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_to_stream(canvas, CAIRO_SURFACE_TYPE_SVG, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, >, 0);
+
+    g_string_truncate(buffer, 0);
+    g_assert_false(adg_canvas_export_to_stream(canvas, CAIRO_SURFACE_TYPE_XLIB, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, ==, 0);
+
+    g_string_free(buffer, TRUE);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+typedef struct {
+    GString *buffer;
+    gsize offset;
+} _AdgReader;
+
+static cairo_status_t
+_adg_read_func(void *closure, unsigned char *data, unsigned int length)
+{
+    _AdgReader *reader = closure;
+
+    if (reader->offset + length > reader->buffer->len)
+        return CAIRO_STATUS_READ_ERROR;
+
+    memcpy(data, reader->buffer->str + reader->offset, length);
+    reader->offset += length;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_adg_method_export_tiled(void)
+{
+    AdgCanvas *canvas;
+    GString *buffer, *reference;
+    _AdgReader reader;
+    cairo_surface_t *surface, *reference_surface;
+
+    canvas = adg_test_canvas();
+    buffer = g_string_new("");
+
+    /* Sanity checks */
+    g_assert_false(adg_canvas_export_tiled(NULL, 0, _adg_write_func, buffer, NULL));
+    g_assert_false(adg_canvas_export_tiled(canvas, 0, NULL, buffer, NULL));
+    g_assert_cmpuint(buffer->len, ==, 0);
+
+    /* Use a strip height that does not divide the image height */
+    g_assert_true(adg_canvas_export_tiled(canvas, 7, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, >, 8);
+    g_assert_true(memcmp(buffer->str, "\x89PNG\r\n\x1a\n", 8) == 0);
+
+    /* The result must be a valid PNG as big as the plain export */
+    reference = g_string_new("");
+    g_assert_true(adg_canvas_export_to_stream(canvas, CAIRO_SURFACE_TYPE_IMAGE, _adg_write_func, reference, NULL));
+
+    reader.buffer = buffer;
+    reader.offset = 0;
+    surface = cairo_image_surface_create_from_png_stream(_adg_read_func, &reader);
+    g_assert_cmpint(cairo_surface_status(surface), ==, CAIRO_STATUS_SUCCESS);
+
+    reader.buffer = reference;
+    reader.offset = 0;
+    reference_surface = cairo_image_surface_create_from_png_stream(_adg_read_func, &reader);
+    g_assert_cmpint(cairo_surface_status(reference_surface), ==, CAIRO_STATUS_SUCCESS);
+
+    g_assert_cmpint(cairo_image_surface_get_width(surface), ==,
+                    cairo_image_surface_get_width(reference_surface));
+    g_assert_cmpint(cairo_image_surface_get_height(surface), ==,
+                    cairo_image_surface_get_height(reference_surface));
+
+    cairo_surface_destroy(reference_surface);
+    cairo_surface_destroy(surface);
+
+    /* A strip taller than the image must work too */
+    g_string_truncate(reference, 0);
+    g_assert_true(adg_canvas_export_tiled(canvas, G_MAXINT, _adg_write_func, reference, NULL));
+    reader.buffer = reference;
+    reader.offset = 0;
+    surface = cairo_image_surface_create_from_png_stream(_adg_read_func, &reader);
+    g_assert_cmpint(cairo_surface_status(surface), ==, CAIRO_STATUS_SUCCESS);
+    cairo_surface_destroy(surface);
+
+    g_string_free(reference, TRUE);
+    g_string_free(buffer, TRUE);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_render_to_buffer(void)
+{
+    AdgCanvas *canvas;
+    guchar *buffer;
+    gint stride;
+    GError *error;
+
+    canvas = adg_test_canvas();
+    stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, 16);
+    buffer = g_malloc(stride * 16);
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_render_to_buffer(NULL, buffer, CAIRO_FORMAT_ARGB32, 16, 16, stride, NULL));
+    g_assert_false(adg_canvas_render_to_buffer(canvas, NULL, CAIRO_FORMAT_ARGB32, 16, 16, stride, NULL));
+    g_assert_false(adg_canvas_render_to_buffer(canvas, buffer, CAIRO_FORMAT_ARGB32, 0, 16, stride, NULL));
+
+    g_assert_true(adg_canvas_render_to_buffer(canvas, buffer, CAIRO_FORMAT_ARGB32, 16, 16, stride, NULL));
+    g_assert_true(adg_canvas_render_to_buffer(canvas, buffer, CAIRO_FORMAT_RGB24, 16, 16, stride, NULL));
+    g_assert_true(adg_canvas_render_to_buffer(canvas, buffer, CAIRO_FORMAT_A8, 16, 16, 16, NULL));
+
+    /* A stride too small for the width must be refused */
+    error = NULL;
+    g_assert_false(adg_canvas_render_to_buffer(canvas, buffer, CAIRO_FORMAT_ARGB32, 16, 16, 16, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE);
+    g_error_free(error);
+
+    error = NULL;
+    g_assert_false(adg_canvas_render_to_buffer(canvas, buffer, CAIRO_FORMAT_A1, 16, 16, stride, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE);
+    g_error_free(error);
+
+    g_free(buffer);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_render_preview(void)
+{
+    AdgCanvas *canvas;
+    guchar *buffer;
+    gint stride;
+    GError *error;
+
+    canvas = adg_test_canvas();
+    stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, 16);
+    buffer = g_malloc(stride * 16);
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_render_preview(NULL, buffer, CAIRO_FORMAT_ARGB32, 16, 16, stride, NULL));
+    g_assert_false(adg_canvas_render_preview(canvas, NULL, CAIRO_FORMAT_ARGB32, 16, 16, stride, NULL));
+
+    g_assert_true(adg_canvas_render_preview(canvas, buffer, CAIRO_FORMAT_ARGB32, 16, 16, stride, NULL));
+
+    error = NULL;
+    g_assert_false(adg_canvas_render_preview(canvas, buffer, CAIRO_FORMAT_ARGB32, 16, 16, 16, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE);
+    g_error_free(error);
+
+    g_free(buffer);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_export_multi(void)
+{
+    AdgCanvas *canvas;
+    cairo_surface_type_t types[3];
+    const gchar *files[3];
+    gdouble factors[3];
+    GError *error;
+
+    canvas = adg_test_canvas();
+    types[0] = CAIRO_SURFACE_TYPE_IMAGE;
+    types[1] = CAIRO_SURFACE_TYPE_PDF;
+    types[2] = CAIRO_SURFACE_TYPE_SVG;
+    files[0] = files[1] = files[2] = NULL_FILE;
+    factors[0] = 0.5;
+    factors[1] = 1;
+    factors[2] = 2;
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_export_multi(NULL, 3, types, files, NULL, NULL));
+    g_assert_false(adg_canvas_export_multi(canvas, 3, NULL, files, NULL, NULL));
+    g_assert_false(adg_canvas_export_multi(canvas, 3, types, NULL, NULL, NULL));
+
+    /* No targets is a valid (although useless) request */
+    g_assert_true(adg_canvas_export_multi(canvas, 0, NULL, NULL, NULL, NULL));
+
+    g_assert_true(adg_canvas_export_multi(canvas, 3, types, files, NULL, NULL));
+    g_assert_true(adg_canvas_export_multi(canvas, 3, types, files, factors, NULL));
+
+    /* An unsupported surface type stops the export */
+    types[1] = CAIRO_SURFACE_TYPE_XLIB;
+    error = NULL;
+    g_assert_false(adg_canvas_export_multi(canvas, 3, types, files, NULL, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE);
+    g_error_free(error);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_export_sheets(void)
+{
+    AdgCanvas *canvases[3];
+    AdgTitleBlock *title_block;
+    GString *buffer;
+    GError *error;
+    gsize single_len;
+
+    canvases[0] = adg_test_canvas();
+    canvases[1] = adg_test_canvas();
+    canvases[2] = NULL;
+    adg_canvas_set_factor(canvases[1], 2);
+    buffer = g_string_new("");
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_export_sheets(0, canvases, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, NULL));
+    g_assert_false(adg_canvas_export_sheets(2, NULL, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, NULL));
+    g_assert_false(adg_canvas_export_sheets(2, canvases, CAIRO_SURFACE_TYPE_PDF, NULL, buffer, NULL));
+    g_assert_false(adg_canvas_export_sheets(3, canvases, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, ==, 0);
+
+    g_assert_true(adg_canvas_export_sheets(1, canvases, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, NULL));
+    single_len = buffer->len;
+    g_assert_cmpuint(single_len, >, 0);
+
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_sheets(2, canvases, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, >, single_len);
+
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_sheets(2, canvases, CAIRO_SURFACE_TYPE_PS, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, >, 0);
+
+    /* Sheets with title blocks differing only in their values */
+    title_block = adg_title_block_new();
+    adg_title_block_set_title(title_block, "First sheet");
+    adg_canvas_set_title_block(canvases[0], title_block);
+    g_object_unref(title_block);
+    title_block = adg_title_block_new();
+    adg_title_block_set_title(title_block, "Second sheet");
+    adg_canvas_set_title_block(canvases[1], title_block);
+    g_object_unref(title_block);
+
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_sheets(2, canvases, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, NULL));
+    g_assert_cmpuint(buffer->len, >, single_len);
+
+    /* Parallel export */
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_sheets_full(2, canvases, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, 2, NULL));
+    g_assert_cmpuint(buffer->len, >, single_len);
+
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_sheets_full(2, canvases, CAIRO_SURFACE_TYPE_PDF, _adg_write_func, buffer, 0, NULL));
+    g_assert_cmpuint(buffer->len, >, single_len);
+
+    /* Formats without pages must be refused */
+    g_string_truncate(buffer, 0);
+    error = NULL;
+    g_assert_false(adg_canvas_export_sheets(2, canvases, CAIRO_SURFACE_TYPE_SVG, _adg_write_func, buffer, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE);
+    g_assert_cmpuint(buffer->len, ==, 0);
+    g_error_free(error);
+
+    g_string_free(buffer, TRUE);
+    adg_entity_destroy(ADG_ENTITY(canvases[0]));
+    adg_entity_destroy(ADG_ENTITY(canvases[1]));
+}
+
+static void
+_adg_method_export_dxf(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    GString *buffer;
+
+    canvas = adg_canvas_new();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_arc_to_explicit(path, 15, 5, 10, 10);
+    adg_path_curve_to_explicit(path, 5, 10, 0, 5, 0, 0);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    buffer = g_string_new("");
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_export_dxf(NULL, _adg_write_func, buffer, NULL));
+    g_assert_false(adg_canvas_export_dxf(canvas, NULL, buffer, NULL));
+    g_assert_cmpuint(buffer->len, ==, 0);
+
+    g_assert_true(adg_canvas_export_dxf(canvas, _adg_write_func, buffer, NULL));
+    g_assert_nonnull(strstr(buffer->str, "AC1009"));
+    g_assert_nonnull(strstr(buffer->str, "\nLAYER\n"));
+    g_assert_nonnull(strstr(buffer->str, "\nENTITIES\n"));
+    g_assert_nonnull(strstr(buffer->str, "\nLINE\n"));
+    g_assert_nonnull(strstr(buffer->str, "\nARC\n"));
+    g_assert_nonnull(strstr(buffer->str, "\nPOLYLINE\n"));
+    g_assert_true(g_str_has_suffix(buffer->str, "  0\nEOF\n"));
+
+    /* An empty canvas is still a valid document */
+    g_string_truncate(buffer, 0);
+    adg_container_remove(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    g_assert_true(adg_canvas_export_dxf(canvas, _adg_write_func, buffer, NULL));
+    g_assert_null(strstr(buffer->str, "\nLINE\n"));
+    g_assert_true(g_str_has_suffix(buffer->str, "  0\nEOF\n"));
+
+    g_string_free(buffer, TRUE);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static guint
+_adg_count(const gchar *haystack, const gchar *needle)
+{
+    guint n = 0;
+
+    while ((haystack = strstr(haystack, needle)) != NULL) {
+        ++n;
+        ++haystack;
+    }
+
+    return n;
+}
+
+static void
+_adg_method_export_svg(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    cairo_matrix_t map;
+    GString *buffer;
+
+    canvas = adg_canvas_new();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_arc_to_explicit(path, 15, 5, 10, 10);
+
+    /* The same trail placed twice */
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    cairo_matrix_init_translate(&map, 20, 0);
+    adg_entity_set_local_map(ADG_ENTITY(stroke), &map);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    g_object_unref(path);
+
+    buffer = g_string_new("");
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_export_svg(NULL, _adg_write_func, buffer, NULL));
+    g_assert_false(adg_canvas_export_svg(canvas, NULL, buffer, NULL));
+    g_assert_cmpuint(buffer->len, ==, 0);
+
+    g_assert_true(adg_canvas_export_svg(canvas, _adg_write_func, buffer, NULL));
+    g_assert_true(g_str_has_prefix(buffer->str, "<?xml"));
+    g_assert_true(g_str_has_suffix(buffer->str, "</svg>\n"));
+    g_assert_nonnull(strstr(buffer->str, "<style>"));
+
+    /* One shared path and one shared class for both the strokes */
+    g_assert_cmpuint(_adg_count(buffer->str, "<path id="), ==, 1);
+    g_assert_cmpuint(_adg_count(buffer->str, "xlink:href=\"#p1\" class=\"c1\""), ==, 2);
+    g_assert_cmpuint(_adg_count(buffer->str, ".c1{"), ==, 1);
+    g_assert_null(strstr(buffer->str, ".c2{"));
+
+    g_string_free(buffer, TRUE);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_export_stream(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    GString *buffer;
+    GHashTable *versions;
+
+    canvas = adg_test_canvas();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 5);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    buffer = g_string_new("");
+
+    /* Sanity check */
+    g_assert_false(adg_canvas_export_stream(NULL, NULL, _adg_write_func, buffer, NULL));
+    g_assert_false(adg_canvas_export_stream(canvas, NULL, NULL, buffer, NULL));
+    g_assert_cmpuint(buffer->len, ==, 0);
+
+    /* Full export */
+    g_assert_true(adg_canvas_export_stream(canvas, NULL, _adg_write_func, buffer, NULL));
+    g_assert_true(g_str_has_prefix(buffer->str, "{\"version\":1,"));
+    g_assert_nonnull(strstr(buffer->str, "\"type\":\"AdgStroke\""));
+    g_assert_nonnull(strstr(buffer->str, "<svg"));
+    g_assert_true(g_str_has_suffix(buffer->str, "\"removed\":[]}\n"));
+
+    /* The first diff is a full export */
+    versions = g_hash_table_new(NULL, NULL);
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_stream(canvas, versions, _adg_write_func, buffer, NULL));
+    g_assert_nonnull(strstr(buffer->str, "\"type\":\"AdgStroke\""));
+    g_assert_cmpuint(g_hash_table_size(versions), ==, 2);
+
+    /* Nothing changed */
+    g_string_truncate(buffer, 0);
+    g_assert_true(adg_canvas_export_stream(canvas, versions, _adg_write_func, buffer, NULL));
+    g_assert_nonnull(strstr(buffer->str, "\"entities\":[]"));
+    g_assert_true(g_str_has_suffix(buffer->str, "\"removed\":[]}\n"));
+
+    /* A removed entity is listed as such */
+    g_string_truncate(buffer, 0);
+    adg_container_remove(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    g_assert_true(adg_canvas_export_stream(canvas, versions, _adg_write_func, buffer, NULL));
+    g_assert_nonnull(strstr(buffer->str, "\"entities\":[]"));
+    g_assert_false(g_str_has_suffix(buffer->str, "\"removed\":[]}\n"));
+    g_assert_cmpuint(g_hash_table_size(versions), ==, 1);
+
+    g_hash_table_destroy(versions);
+    g_string_free(buffer, TRUE);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_clone(void)
+{
+    AdgCanvas *canvas, *clone;
+    AdgPath *path;
+    AdgStroke *stroke1, *stroke2;
+    AdgTitleBlock *title_block;
+    AdgStyle *style;
+    GSList *children;
+    AdgTrail *trail1, *trail2;
+
+    canvas = adg_canvas_new();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    stroke1 = adg_stroke_new(ADG_TRAIL(path));
+    stroke2 = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke1));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke2));
+    style = adg_entity_style(ADG_ENTITY(stroke1), ADG_DRESS_LINE);
+    adg_entity_set_style(ADG_ENTITY(stroke1), ADG_DRESS_LINE, style);
+    title_block = adg_title_block_new();
+    adg_title_block_set_title(title_block, "Template");
+    adg_canvas_set_title_block(canvas, title_block);
+    g_object_unref(title_block);
+
+    /* Sanity check */
+    g_assert_null(adg_canvas_clone(NULL));
+
+    clone = adg_canvas_clone(canvas);
+    g_assert_nonnull(clone);
+    g_assert_true(clone != canvas);
+
+    children = adg_container_children(ADG_CONTAINER(clone));
+    g_assert_cmpint(g_slist_length(children), ==, 2);
+    g_assert_true(ADG_IS_STROKE(children->data));
+    g_assert_true(ADG_IS_STROKE(children->next->data));
+    g_assert_true(children->data != stroke1 && children->data != stroke2);
+
+    /* The shared path must be cloned once and still be shared */
+    trail1 = adg_stroke_get_trail(children->data);
+    trail2 = adg_stroke_get_trail(children->next->data);
+    g_assert_true(ADG_IS_PATH(trail1));
+    g_assert_true(trail1 == trail2);
+    g_assert_true(trail1 != adg_stroke_get_trail(stroke1));
+    g_assert_cmpint(adg_trail_cairo_path(trail1)->num_data, ==,
+                    adg_trail_cairo_path(adg_stroke_get_trail(stroke1))->num_data);
+
+    /* Style overrides are shared */
+    g_assert_true(adg_entity_get_style(children->data, ADG_DRESS_LINE) == style ||
+                  adg_entity_get_style(children->next->data, ADG_DRESS_LINE) == style);
+    g_slist_free(children);
+
+    title_block = adg_canvas_get_title_block(clone);
+    g_assert_nonnull(title_block);
+    g_assert_true(title_block != adg_canvas_get_title_block(canvas));
+    g_assert_cmpstr(adg_title_block_get_title(title_block), ==, "Template");
+
+    /* Changing the clone must not affect the template */
+    adg_path_line_to_explicit(ADG_PATH(trail1), 10, 10);
+    g_assert_cmpint(adg_trail_cairo_path(adg_stroke_get_trail(stroke1))->num_data, <,
+                    adg_trail_cairo_path(trail1)->num_data);
+
+    adg_entity_destroy(ADG_ENTITY(clone));
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_snapshot(void)
+{
+    AdgCanvas *canvas;
+    cairo_surface_t *snapshot;
+    gchar *file;
+    GError *error;
+#ifdef SNAPSHOT_ENABLED
+    cairo_rectangle_t extents;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+#endif
+
+    canvas = adg_test_canvas();
+    file = g_build_filename(g_get_tmp_dir(), "adg-test-canvas.snapshot", NULL);
+
+    /* Sanity checks */
+    g_assert_false(adg_canvas_save_snapshot(NULL, file, NULL));
+    g_assert_false(adg_canvas_save_snapshot(canvas, NULL, NULL));
+    g_assert_null(adg_canvas_load_snapshot(NULL, NULL));
+
+#ifdef SNAPSHOT_ENABLED
+    g_assert_true(adg_canvas_save_snapshot(canvas, file, NULL));
+    snapshot = adg_canvas_load_snapshot(file, NULL);
+    g_assert_nonnull(snapshot);
+    g_assert_cmpint(cairo_surface_get_type(snapshot), ==, CAIRO_SURFACE_TYPE_RECORDING);
+    g_assert_true(cairo_recording_surface_get_extents(snapshot, &extents));
+    g_assert_cmpfloat(extents.width, >, 0);
+    g_assert_cmpfloat(extents.height, >, 0);
+
+    /* The snapshot must be renderable */
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         extents.width, extents.height);
+    cr = cairo_create(surface);
+    cairo_set_source_surface(cr, snapshot, 0, 0);
+    cairo_paint(cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    cairo_surface_destroy(snapshot);
+
+    /* Garbage must be refused */
+    g_assert_true(g_file_set_contents(file, "Not a snapshot", -1, NULL));
+    error = NULL;
+    snapshot = adg_canvas_load_snapshot(file, &error);
+    g_assert_null(snapshot);
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT);
+    g_error_free(error);
+    g_remove(file);
+#else
+    /* Without snapshot support both functions must fail gracefully */
+    error = NULL;
+    g_assert_false(adg_canvas_save_snapshot(canvas, file, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT);
+    g_error_free(error);
+
+    error = NULL;
+    snapshot = adg_canvas_load_snapshot(file, &error);
+    g_assert_null(snapshot);
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT);
+    g_error_free(error);
+#endif
+
+    g_free(file);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_get_spatial_index(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    AdgSpatialIndex *index;
+    CpmlPair pair;
+    GSList *result;
+
+    canvas = adg_test_canvas();
+
+    /* Invalid canvas */
+    g_assert_null(adg_canvas_get_spatial_index(NULL));
+
+    index = adg_canvas_get_spatial_index(canvas);
+    g_assert_nonnull(index);
+    g_assert_cmpuint(adg_spatial_index_size(index), ==, 1);
+
+    /* The index must be retained while nothing changes */
+    g_assert_true(adg_canvas_get_spatial_index(canvas) == index);
+
+    pair.x = 0.5;
+    pair.y = 0.5;
+    result = adg_spatial_index_query_point(index, &pair);
+    g_assert_cmpint(g_slist_length(result), ==, 1);
+    g_slist_free(result);
+
+    /* Adding an entity must refresh the index */
+    entity = ADG_ENTITY(adg_toy_text_new("Testing..."));
+    adg_container_add(ADG_CONTAINER(canvas), entity);
+    index = adg_canvas_get_spatial_index(canvas);
+    g_assert_nonnull(index);
+    g_assert_cmpuint(adg_spatial_index_size(index), ==, 2);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_layout_quotes(void)
+{
+    AdgCanvas *canvas;
+    AdgDim *dim1, *dim2;
+    const CpmlExtents *extents1, *extents2;
+
+    canvas = adg_canvas_new();
+
+    /* Invalid canvas */
+    g_assert_cmpuint(adg_canvas_layout_quotes(NULL, 0), ==, 0);
+
+    /* Nothing to do on a canvas without dimensions */
+    g_assert_cmpuint(adg_canvas_layout_quotes(canvas, 0), ==, 0);
+
+    /* Two identical dimensions have overlapping quotes */
+    dim1 = ADG_DIM(adg_ldim_new_full_explicit(0, 0, 10, 0, 5, -5, ADG_DIR_RIGHT));
+    dim2 = ADG_DIM(adg_ldim_new_full_explicit(0, 0, 10, 0, 5, -5, ADG_DIR_RIGHT));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(dim1));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(dim2));
+
+    g_assert_cmpuint(adg_canvas_layout_quotes(canvas, 0), ==, 1);
+    adg_assert_isapprox(adg_dim_get_level(dim1) + adg_dim_get_level(dim2), 3);
+
+    extents1 = adg_entity_get_extents(ADG_ENTITY(adg_dim_get_quote(dim1)));
+    extents2 = adg_entity_get_extents(ADG_ENTITY(adg_dim_get_quote(dim2)));
+    g_assert_true(extents1->is_defined);
+    g_assert_true(extents2->is_defined);
+    g_assert_false(cpml_extents_equal(extents1, extents2));
+
+    /* The canvas must be left arranged */
+    g_assert_true(adg_entity_get_extents(ADG_ENTITY(canvas))->is_defined);
+
+    /* Once resolved, a new pass does not move anything */
+    g_assert_cmpuint(adg_canvas_layout_quotes(canvas, 0), ==, 0);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_damaged(AdgCanvas *canvas, gint *n_damaged)
+{
+    ++ *n_damaged;
+}
+
+static void
+_adg_method_take_damage(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgEntity *entity;
+    CpmlExtents damage;
+    gint n_damaged;
+
+    canvas = adg_test_canvas();
+    n_damaged = 0;
+
+    /* Invalid canvas */
+    g_assert_false(adg_canvas_take_damage(NULL, &damage));
+
+    /* Without any handler nothing is tracked */
+    adg_entity_invalidate(ADG_ENTITY(canvas));
+    g_assert_false(adg_canvas_take_damage(canvas, &damage));
+
+    g_signal_connect(canvas, "damaged", G_CALLBACK(_adg_damaged), &n_damaged);
+    g_assert_false(adg_canvas_take_damage(canvas, &damage));
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 10, 10);
+    adg_path_line_to_explicit(path, 12, 13);
+    entity = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    adg_container_add(ADG_CONTAINER(canvas), entity);
+    g_assert_cmpint(n_damaged, ==, 1);
+
+    /* Only the new extents of the added stroke are damaged */
+    g_assert_true(adg_canvas_take_damage(canvas, &damage));
+    adg_assert_isapprox(damage.org.x, 10);
+    adg_assert_isapprox(damage.org.y, 10);
+    adg_assert_isapprox(damage.size.x, 2);
+    adg_assert_isapprox(damage.size.y, 3);
+    g_assert_false(adg_canvas_take_damage(canvas, &damage));
+
+    /* Changing the path damages both the old and the new extents,
+     * but the signal is emitted only once */
+    adg_path_line_to_explicit(path, 15, 10);
+    adg_model_changed(ADG_MODEL(path));
+    adg_entity_invalidate(entity);
+    g_assert_cmpint(n_damaged, ==, 2);
+    g_assert_true(adg_canvas_take_damage(canvas, &damage));
+    adg_assert_isapprox(damage.org.x, 10);
+    adg_assert_isapprox(damage.org.y, 10);
+    adg_assert_isapprox(damage.size.x, 5);
+    adg_assert_isapprox(damage.size.y, 3);
+
+    /* Removing the stroke damages its old extents */
+    adg_container_remove(ADG_CONTAINER(canvas), entity);
+    g_assert_cmpint(n_damaged, ==, 3);
+    g_assert_true(adg_canvas_take_damage(canvas, &damage));
+    adg_assert_isapprox(damage.org.x, 10);
+    adg_assert_isapprox(damage.size.x, 5);
+
+    g_object_unref(path);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_set_layer_visible(void)
+{
+    AdgCanvas *canvas;
+    CpmlExtents damage;
+    gint n_damaged;
+
+    canvas = adg_test_canvas();
+    n_damaged = 0;
+    g_signal_connect(canvas, "damaged", G_CALLBACK(_adg_damaged), &n_damaged);
+
+    /* Invalid input */
+    adg_canvas_set_layer_visible(NULL, 3, FALSE);
+    adg_canvas_set_layer_visible(canvas, 32, FALSE);
+    g_assert_false(adg_canvas_is_layer_visible(NULL, 3));
+    g_assert_false(adg_canvas_is_layer_visible(canvas, 32));
+    g_assert_cmpint(n_damaged, ==, 0);
+
+    /* By default every layer is visible */
+    g_assert_true(adg_canvas_is_layer_visible(canvas, 0));
+    g_assert_true(adg_canvas_is_layer_visible(canvas, 3));
+
+    /* Hiding a layer damages the whole sheet without arranging */
+    adg_entity_arrange(ADG_ENTITY(canvas));
+    adg_canvas_set_layer_visible(canvas, 3, FALSE);
+    g_assert_false(adg_canvas_is_layer_visible(canvas, 3));
+    g_assert_true(adg_canvas_is_layer_visible(canvas, 0));
+    g_assert_cmpint(n_damaged, ==, 1);
+    g_assert_true(adg_entity_get_extents(ADG_ENTITY(canvas))->is_defined);
+
+    /* Setting the same state again is a no-op */
+    adg_canvas_set_layer_visible(canvas, 3, FALSE);
+    g_assert_cmpint(n_damaged, ==, 1);
+
+    g_assert_true(adg_canvas_take_damage(canvas, &damage));
+    adg_canvas_set_layer_visible(canvas, 3, TRUE);
+    g_assert_true(adg_canvas_is_layer_visible(canvas, 3));
+    g_assert_cmpint(n_damaged, ==, 2);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_arrange_step(void)
+{
+    AdgCanvas *canvas;
+    AdgContainer *container;
+    AdgPath *path;
+    AdgStroke *stroke;
+    const CpmlExtents *extents;
+    gint n_steps;
+
+    canvas = adg_test_canvas();
+    container = adg_container_new();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 2, 2);
+    adg_path_line_to_explicit(path, 5, 3);
+
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    adg_container_add(container, ADG_ENTITY(stroke));
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    adg_container_add(container, ADG_ENTITY(stroke));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(container));
+    g_object_unref(path);
+
+    /* Invalid input */
+    g_assert_false(adg_canvas_arrange_step(NULL, 0));
+
+    /* With no budget, every step arranges a single entity */
+    n_steps = 1;
+    while (!adg_canvas_arrange_step(canvas, 0))
+        ++n_steps;
+    g_assert_cmpint(n_steps, >=, 3);
+
+    extents = adg_entity_get_extents(ADG_ENTITY(canvas));
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, 0);
+    adg_assert_isapprox(extents->org.y, 0);
+    adg_assert_isapprox(extents->size.x, 5);
+    adg_assert_isapprox(extents->size.y, 3);
+    extents = adg_entity_get_extents(ADG_ENTITY(stroke));
+    g_assert_true(extents->is_defined);
+
+    /* Once arranged, there is nothing left to do */
+    g_assert_true(adg_canvas_arrange_step(canvas, 0));
+
+    /* A change restarts the traversal; a generous budget
+     * completes it in a single call */
+    adg_entity_global_changed(ADG_ENTITY(stroke));
+    g_assert_true(adg_canvas_arrange_step(canvas, G_USEC_PER_SEC));
+    g_assert_true(adg_entity_get_extents(ADG_ENTITY(canvas))->is_defined);
+
+    /* Destroying the canvas in the middle drops the pending stack */
+    adg_entity_global_changed(ADG_ENTITY(canvas));
+    g_assert_false(adg_canvas_arrange_step(canvas, 0));
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 #if GTK3_ENABLED || GTK2_ENABLED
 
 static void
@@ -1001,6 +1980,36 @@ _adg_method_set_page_setup(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_method_print_operation_new(void)
+{
+    AdgCanvas *canvas;
+    GtkPageSetup *page_setup;
+    GtkPrintOperation *operation;
+
+    canvas = ADG_CANVAS(adg_canvas_new());
+    page_setup = gtk_page_setup_new();
+
+    /* Sanity check */
+    g_assert_null(adg_canvas_print_operation_new(NULL));
+
+    operation = adg_canvas_print_operation_new(canvas);
+    g_assert_true(GTK_IS_PRINT_OPERATION(operation));
+    g_assert_null(gtk_print_operation_get_default_page_setup(operation));
+    g_object_unref(operation);
+
+    /* The page setup bound to canvas must be used by default */
+    adg_canvas_set_page_setup(canvas, page_setup);
+    operation = adg_canvas_print_operation_new(canvas);
+    g_assert_true(gtk_print_operation_get_default_page_setup(operation) == page_setup);
+
+    /* The operation must keep canvas alive */
+    adg_entity_destroy(ADG_ENTITY(canvas));
+    g_object_unref(operation);
+
+    g_object_unref(page_setup);
+}
+
 #endif
 
 
@@ -1015,6 +2024,8 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/canvas/behavior/entity", _adg_behavior_entity);
     g_test_add_func("/adg/canvas/behavior/misc", _adg_behavior_misc);
+    g_test_add_func("/adg/canvas/behavior/render-list", _adg_behavior_render_list);
+    g_test_add_func("/adg/canvas/behavior/render-batch", _adg_behavior_render_batch);
     adg_test_add_global_space_checks("/adg/canvas/behavior/global-space", adg_test_canvas());
     adg_test_add_local_space_checks("/adg/canvas/behavior/local-space", adg_test_canvas());
 
@@ -1033,6 +2044,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/canvas/property/right-padding", _adg_property_right_padding);
     g_test_add_func("/adg/canvas/property/bottom-padding", _adg_property_bottom_padding);
     g_test_add_func("/adg/canvas/property/left-padding", _adg_property_left_padding);
+    g_test_add_func("/adg/canvas/property/has-render-list", _adg_property_has_render_list);
 
     g_test_add_func("/adg/canvas/method/autoscale", _adg_method_autoscale);
     g_test_add_func("/adg/canvas/method/set-margins", _adg_method_set_margins);
@@ -1041,10 +2053,27 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/canvas/method/set-paddings", _adg_method_set_paddings);
     g_test_add_func("/adg/canvas/method/get-paddings", _adg_method_get_paddings);
     g_test_add_func("/adg/canvas/method/export", _adg_method_export);
+    g_test_add_func("/adg/canvas/method/export-to-stream", _adg_method_export_to_stream);
+    g_test_add_func("/adg/canvas/method/export-tiled", _adg_method_export_tiled);
+    g_test_add_func("/adg/canvas/method/render-to-buffer", _adg_method_render_to_buffer);
+    g_test_add_func("/adg/canvas/method/render-preview", _adg_method_render_preview);
+    g_test_add_func("/adg/canvas/method/export-multi", _adg_method_export_multi);
+    g_test_add_func("/adg/canvas/method/export-sheets", _adg_method_export_sheets);
+    g_test_add_func("/adg/canvas/method/export-dxf", _adg_method_export_dxf);
+    g_test_add_func("/adg/canvas/method/export-svg", _adg_method_export_svg);
+    g_test_add_func("/adg/canvas/method/export-stream", _adg_method_export_stream);
+    g_test_add_func("/adg/canvas/method/clone", _adg_method_clone);
+    g_test_add_func("/adg/canvas/method/snapshot", _adg_method_snapshot);
+    g_test_add_func("/adg/canvas/method/get-spatial-index", _adg_method_get_spatial_index);
+    g_test_add_func("/adg/canvas/method/layout-quotes", _adg_method_layout_quotes);
+    g_test_add_func("/adg/canvas/method/take-damage", _adg_method_take_damage);
+    g_test_add_func("/adg/canvas/method/set-layer-visible", _adg_method_set_layer_visible);
+    g_test_add_func("/adg/canvas/method/arrange-step", _adg_method_arrange_step);
 #if GTK3_ENABLED || GTK2_ENABLED
     g_test_add_func("/adg/canvas/method/set-paper", _adg_method_set_paper);
     g_test_add_func("/adg/canvas/method/get-page-setup", _adg_method_get_page_setup);
     g_test_add_func("/adg/canvas/method/set-page-setup", _adg_method_set_page_setup);
+    g_test_add_func("/adg/canvas/method/print-operation-new", _adg_method_print_operation_new);
 #endif
 
     return g_test_run();
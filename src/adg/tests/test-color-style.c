@@ -22,6 +22,43 @@
 #include <adg.h>
 
 
+static void
+_adg_behavior_apply(void)
+{
+    AdgColorStyle *color_style;
+    AdgEntity *entity;
+    cairo_t *cr;
+    cairo_pattern_t *source;
+    gdouble red, green, blue, alpha;
+
+    color_style = adg_color_style_new();
+    entity = (AdgEntity *) adg_logo_new();
+    cr = adg_test_cairo_context();
+    adg_color_style_set_red(color_style, 0.5);
+    adg_color_style_set_alpha(color_style, 0.25);
+
+    adg_style_apply((AdgStyle *) color_style, entity, cr);
+    source = cairo_get_source(cr);
+    g_assert_cmpint(cairo_pattern_get_rgba(source, &red, &green, &blue, &alpha), ==, CAIRO_STATUS_SUCCESS);
+    adg_assert_isapprox(red, 0.5);
+    adg_assert_isapprox(alpha, 0.25);
+
+    /* Applying the same color again must keep the current source */
+    adg_style_apply((AdgStyle *) color_style, entity, cr);
+    g_assert_true(cairo_get_source(cr) == source);
+
+    /* A different color must replace it */
+    adg_color_style_set_green(color_style, 1);
+    adg_style_apply((AdgStyle *) color_style, entity, cr);
+    source = cairo_get_source(cr);
+    g_assert_cmpint(cairo_pattern_get_rgba(source, &red, &green, &blue, &alpha), ==, CAIRO_STATUS_SUCCESS);
+    adg_assert_isapprox(green, 1);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+    g_object_unref(color_style);
+}
+
 static void
 _adg_property_alpha(void)
 {
@@ -190,6 +227,8 @@ main(int argc, char *argv[])
 
     adg_test_add_object_checks("/adg/color-style/type/object", ADG_TYPE_COLOR_STYLE);
 
+    g_test_add_func("/adg/color-style/behavior/apply", _adg_behavior_apply);
+
     g_test_add_func("/adg/color-style/property/alpha", _adg_property_alpha);
     g_test_add_func("/adg/color-style/property/blue", _adg_property_blue);
     g_test_add_func("/adg/color-style/property/green", _adg_property_green);
@@ -61,6 +61,164 @@ _adg_behavior_misc(void)
     adg_entity_destroy(ADG_ENTITY(container));
 }
 
+static void
+_adg_behavior_order(void)
+{
+    AdgContainer *container;
+    AdgEntity *entities[100];
+    GSList *children, *child;
+    gint n;
+
+    container = adg_container_new();
+
+    for (n = 0; n < 100; ++n) {
+        entities[n] = ADG_ENTITY(adg_toy_text_new("Testing..."));
+        adg_container_add(container, entities[n]);
+    }
+
+    /* Remove the even children, enough to trigger a compaction */
+    for (n = 0; n < 100; n += 2)
+        adg_container_remove(container, entities[n]);
+
+    /* The remaining children must be returned newest first */
+    children = adg_container_children(container);
+    g_assert_cmpint(g_slist_length(children), ==, 50);
+    for (child = children, n = 99; child != NULL; child = child->next, n -= 2)
+        g_assert_true(child->data == entities[n]);
+    g_slist_free(children);
+
+    /* Destroying a child must remove it from the container */
+    adg_entity_destroy(entities[99]);
+    children = adg_container_children(container);
+    g_assert_cmpint(g_slist_length(children), ==, 49);
+    g_assert_true(children->data == entities[97]);
+    g_slist_free(children);
+
+    /* Add a child after the compaction */
+    entities[0] = ADG_ENTITY(adg_toy_text_new("Testing..."));
+    adg_container_add(container, entities[0]);
+    children = adg_container_children(container);
+    g_assert_cmpint(g_slist_length(children), ==, 50);
+    g_assert_true(children->data == entities[0]);
+    g_assert_true(g_slist_last(children)->data == entities[1]);
+    g_slist_free(children);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+static void
+_adg_count_emissions(AdgEntity *entity, gpointer user_data)
+{
+    ++ *(gint *) user_data;
+}
+
+static void
+_adg_behavior_propagation(void)
+{
+    AdgContainer *root, *container;
+    AdgEntity *leaf, *entity;
+    cairo_matrix_t map;
+    gint n, emissions;
+
+    root = adg_container_new();
+    container = root;
+    for (n = 0; n < 10; ++n) {
+        entity = ADG_ENTITY(adg_container_new());
+        adg_container_add(container, entity);
+        container = (AdgContainer *) entity;
+    }
+    leaf = ADG_ENTITY(adg_toy_text_new("Testing..."));
+    adg_container_add(container, leaf);
+
+    emissions = 0;
+    g_signal_connect(leaf, "global-changed",
+                     G_CALLBACK(_adg_count_emissions), &emissions);
+    g_signal_connect(leaf, "local-changed",
+                     G_CALLBACK(_adg_count_emissions), &emissions);
+
+    /* The matrices must reach the deepest child */
+    cairo_matrix_init_scale(&map, 2, 2);
+    adg_entity_set_global_map(ADG_ENTITY(root), &map);
+    adg_entity_global_changed(ADG_ENTITY(root));
+    g_assert_cmpint(emissions, ==, 1);
+    adg_assert_isapprox(adg_entity_get_global_matrix(leaf)->xx, 2);
+
+    cairo_matrix_init_translate(&map, 3, 4);
+    adg_entity_set_local_map(ADG_ENTITY(root), &map);
+    adg_entity_local_changed(ADG_ENTITY(root));
+    g_assert_cmpint(emissions, ==, 2);
+    adg_assert_isapprox(adg_entity_get_local_matrix(leaf)->x0, 3);
+    adg_assert_isapprox(adg_entity_get_local_matrix(leaf)->y0, 4);
+
+    adg_entity_destroy(ADG_ENTITY(root));
+}
+
+/* The handlers are called before the default arrange: undefined
+ * extents mean the entity is really going to be arranged */
+static void
+_adg_change_model(AdgEntity *entity, gpointer user_data)
+{
+    if (! adg_entity_get_extents(entity)->is_defined)
+        adg_model_changed((AdgModel *) user_data);
+}
+
+static void
+_adg_count_arranges(AdgEntity *entity, gpointer user_data)
+{
+    if (! adg_entity_get_extents(entity)->is_defined)
+        ++ *(gint *) user_data;
+}
+
+static void
+_adg_behavior_dependencies(void)
+{
+    AdgContainer *container;
+    AdgPath *path;
+    AdgEntity *producer, *dependent;
+    gint arranges;
+
+    container = adg_container_new();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+
+    /* The producer changes the model of the dependent while arranging,
+     * but by default the dependent (the newest child) comes first */
+    producer = ADG_ENTITY(adg_toy_text_new("Testing..."));
+    g_signal_connect(producer, "arrange",
+                     G_CALLBACK(_adg_change_model), path);
+    adg_container_add(container, producer);
+
+    dependent = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    g_object_unref(path);
+    arranges = 0;
+    g_signal_connect(dependent, "arrange",
+                     G_CALLBACK(_adg_count_arranges), &arranges);
+    adg_container_add(container, dependent);
+
+    /* The first arrange finds out the dependency and fixes the
+     * dependent in the same pass */
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpint(arranges, ==, 2);
+    g_assert_true(adg_entity_get_extents(dependent)->is_defined);
+
+    /* From now on the dependent is arranged after the producer */
+    arranges = 0;
+    adg_entity_invalidate(ADG_ENTITY(container));
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpint(arranges, ==, 1);
+    g_assert_true(adg_entity_get_extents(dependent)->is_defined);
+
+    /* Removing the producer drops the dependency */
+    adg_container_remove(container, producer);
+    arranges = 0;
+    adg_entity_invalidate(ADG_ENTITY(container));
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpint(arranges, ==, 1);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
 static void
 _adg_property_child(void)
 {
@@ -123,6 +281,180 @@ _adg_property_child(void)
     adg_entity_destroy(valid_entity);
 }
 
+static void
+_adg_property_parallel_arrange(void)
+{
+    AdgContainer *container;
+    gboolean parallel_arrange;
+
+    container = adg_container_new();
+
+    /* Using the public APIs */
+    g_assert_false(adg_container_get_parallel_arrange(container));
+    adg_container_set_parallel_arrange(container, TRUE);
+    g_assert_true(adg_container_get_parallel_arrange(container));
+    adg_container_set_parallel_arrange(container, FALSE);
+    g_assert_false(adg_container_get_parallel_arrange(container));
+
+    /* Using GObject property methods */
+    g_object_set(container, "parallel-arrange", TRUE, NULL);
+    g_object_get(container, "parallel-arrange", &parallel_arrange, NULL);
+    g_assert_true(parallel_arrange);
+    g_object_set(container, "parallel-arrange", FALSE, NULL);
+    g_object_get(container, "parallel-arrange", &parallel_arrange, NULL);
+    g_assert_false(parallel_arrange);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+static void
+_adg_behavior_parallel_arrange(void)
+{
+    AdgContainer *sequential, *parallel;
+    AdgEntity *entity;
+    cairo_matrix_t map;
+    CpmlExtents extents;
+    gint n;
+
+    sequential = adg_container_new();
+    parallel = adg_container_new();
+    adg_container_set_parallel_arrange(parallel, TRUE);
+
+    for (n = 0; n < 16; ++n) {
+        cairo_matrix_init_translate(&map, n * 10, -n * 5);
+
+        entity = ADG_ENTITY(adg_logo_new());
+        adg_entity_set_global_map(entity, &map);
+        adg_container_add(sequential, entity);
+
+        entity = ADG_ENTITY(adg_logo_new());
+        adg_entity_set_global_map(entity, &map);
+        adg_container_add(parallel, entity);
+    }
+
+    adg_entity_arrange(ADG_ENTITY(sequential));
+    adg_entity_arrange(ADG_ENTITY(parallel));
+
+    cpml_extents_copy(&extents, adg_entity_get_extents(ADG_ENTITY(sequential)));
+    g_assert_true(extents.is_defined);
+    g_assert_true(cpml_extents_equal(&extents,
+                                     adg_entity_get_extents(ADG_ENTITY(parallel))));
+
+    adg_entity_destroy(ADG_ENTITY(sequential));
+    adg_entity_destroy(ADG_ENTITY(parallel));
+}
+
+static void
+_adg_behavior_extents(void)
+{
+    AdgContainer *container;
+    AdgEntity *logos[4], *entity;
+    cairo_matrix_t map;
+    CpmlExtents extents, expected;
+    gint n;
+
+    container = adg_container_new();
+
+    for (n = 0; n < 4; ++n) {
+        cairo_matrix_init_translate(&map, n * 10, n * 10);
+        logos[n] = ADG_ENTITY(adg_logo_new());
+        adg_entity_set_global_map(logos[n], &map);
+        adg_container_add(container, logos[n]);
+    }
+
+    entity = ADG_ENTITY(container);
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(extents.is_defined);
+
+    /* Moving an inner child does not change the union */
+    cairo_matrix_init_translate(&map, 15, 15);
+    adg_entity_set_global_map(logos[1], &map);
+    adg_entity_arrange(entity);
+    g_assert_true(cpml_extents_equal(&extents, adg_entity_get_extents(entity)));
+
+    /* Growing a child enlarges the union */
+    cairo_matrix_init_translate(&map, 100, 100);
+    adg_entity_set_global_map(logos[2], &map);
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    cpml_extents_copy(&expected, adg_entity_get_extents(logos[0]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[1]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[2]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[3]));
+    g_assert_true(cpml_extents_equal(&extents, &expected));
+
+    /* Shrinking the child on the border shrinks the union */
+    cairo_matrix_init_translate(&map, 20, 20);
+    adg_entity_set_global_map(logos[2], &map);
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&expected, adg_entity_get_extents(logos[0]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[1]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[2]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[3]));
+    g_assert_true(cpml_extents_equal(adg_entity_get_extents(entity), &expected));
+
+    /* Removing a child on the border shrinks the union */
+    adg_container_remove(container, logos[3]);
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&expected, adg_entity_get_extents(logos[0]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[1]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[2]));
+    g_assert_true(cpml_extents_equal(adg_entity_get_extents(entity), &expected));
+
+    /* Floating children do not contribute */
+    adg_entity_switch_floating(logos[0], TRUE);
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&expected, adg_entity_get_extents(logos[1]));
+    cpml_extents_add(&expected, adg_entity_get_extents(logos[2]));
+    g_assert_true(cpml_extents_equal(adg_entity_get_extents(entity), &expected));
+
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_count_destroy(AdgEntity *entity, gint *n_destroyed)
+{
+    ++ *n_destroyed;
+}
+
+static void
+_adg_behavior_teardown(void)
+{
+    AdgContainer *container, *nested;
+    AdgEntity *watched, *plain, *leaf;
+    gint n_destroyed;
+
+    container = adg_container_new();
+    nested = adg_container_new();
+    watched = ADG_ENTITY(adg_logo_new());
+    plain = ADG_ENTITY(adg_logo_new());
+    leaf = ADG_ENTITY(adg_logo_new());
+    n_destroyed = 0;
+
+    adg_container_add(container, watched);
+    adg_container_add(container, plain);
+    adg_container_add(container, ADG_ENTITY(nested));
+    adg_container_add(nested, leaf);
+    adg_entity_arrange(ADG_ENTITY(container));
+
+    g_signal_connect(watched, "destroy",
+                     G_CALLBACK(_adg_count_destroy), &n_destroyed);
+    g_object_add_weak_pointer((GObject *) watched, (gpointer *) &watched);
+    g_object_add_weak_pointer((GObject *) plain, (gpointer *) &plain);
+    g_object_add_weak_pointer((GObject *) nested, (gpointer *) &nested);
+    g_object_add_weak_pointer((GObject *) leaf, (gpointer *) &leaf);
+
+    /* The whole tree is released at once, but the entities
+     * with a "destroy" handler still get their signal */
+    adg_entity_destroy(ADG_ENTITY(container));
+    g_assert_cmpint(n_destroyed, ==, 1);
+    g_assert_null(watched);
+    g_assert_null(plain);
+    g_assert_null(nested);
+    g_assert_null(leaf);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -130,7 +462,13 @@ main(int argc, char *argv[])
     AdgContainer *container;
     adg_test_init(&argc, &argv);
 
+    g_test_add_func("/adg/container/behavior/dependencies", _adg_behavior_dependencies);
+    g_test_add_func("/adg/container/behavior/extents", _adg_behavior_extents);
     g_test_add_func("/adg/container/behavior/misc", _adg_behavior_misc);
+    g_test_add_func("/adg/container/behavior/order", _adg_behavior_order);
+    g_test_add_func("/adg/container/behavior/parallel-arrange", _adg_behavior_parallel_arrange);
+    g_test_add_func("/adg/container/behavior/propagation", _adg_behavior_propagation);
+    g_test_add_func("/adg/container/behavior/teardown", _adg_behavior_teardown);
 
     adg_test_add_object_checks("/adg/container/type/object", ADG_TYPE_CONTAINER);
     adg_test_add_entity_checks("/adg/container/type/entity", ADG_TYPE_CONTAINER);
@@ -144,6 +482,7 @@ main(int argc, char *argv[])
     adg_test_add_local_space_checks("/adg/container/behavior/local-space", container);
 
     g_test_add_func("/adg/container/property/child", _adg_property_child);
+    g_test_add_func("/adg/container/property/parallel-arrange", _adg_property_parallel_arrange);
 
     return g_test_run();
 }
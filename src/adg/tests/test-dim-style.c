@@ -856,6 +856,53 @@ _adg_property_value_dress(void)
     g_object_unref(dim_style);
 }
 
+static void
+_adg_method_format_value(void)
+{
+    AdgDimStyle *dim_style;
+    gchar *text;
+
+    dim_style = adg_dim_style_new();
+    adg_dim_style_set_decimals(dim_style, 2);
+
+    /* Sanity check */
+    g_assert_null(adg_dim_style_format_value(NULL, 1));
+
+    adg_dim_style_set_number_arguments(dim_style, "d");
+    adg_dim_style_set_number_format(dim_style, "%g");
+    text = adg_dim_style_format_value(dim_style, 1.234);
+    g_assert_cmpstr(text, ==, "1.23");
+    g_free(text);
+
+    /* The same compiled format must work with different values */
+    text = adg_dim_style_format_value(dim_style, 5.678);
+    g_assert_cmpstr(text, ==, "5.68");
+    g_free(text);
+
+    /* Changing the format must drop the compiled one */
+    adg_dim_style_set_number_arguments(dim_style, "DM");
+    adg_dim_style_set_number_format(dim_style, "\\%%g°(%g')");
+    text = adg_dim_style_format_value(dim_style, 3.5);
+    g_assert_cmpstr(text, ==, "%3°30'");
+    g_free(text);
+
+    /* Unvalorized groups disappear */
+    text = adg_dim_style_format_value(dim_style, 3);
+    g_assert_cmpstr(text, ==, "%3°");
+    g_free(text);
+
+    /* Without arguments the format is returned as is */
+    adg_dim_style_set_number_arguments(dim_style, NULL);
+    text = adg_dim_style_format_value(dim_style, 3);
+    g_assert_cmpstr(text, ==, "\\%%g°(%g')");
+    g_free(text);
+
+    adg_dim_style_set_number_format(dim_style, NULL);
+    g_assert_null(adg_dim_style_format_value(dim_style, 3));
+
+    g_object_unref(dim_style);
+}
+
 static void
 _adg_method_convert(void)
 {
@@ -937,6 +984,48 @@ _adg_method_convert(void)
     g_object_unref(dim_style);
 }
 
+static void
+_adg_method_reset_marker(void)
+{
+    AdgDimStyle *dim_style;
+    AdgArrow *template;
+    AdgMarker *marker;
+
+    dim_style = adg_dim_style_new();
+    template = adg_arrow_new();
+    adg_marker_set_size(ADG_MARKER(template), 5);
+    adg_arrow_set_angle(template, G_PI / 4);
+    adg_dim_style_set_marker1(dim_style, ADG_MARKER(template));
+
+    marker = adg_dim_style_marker1_new(dim_style);
+    g_assert_nonnull(marker);
+
+    /* Sanity checks */
+    g_assert_false(adg_dim_style_reset_marker1(NULL, marker));
+    g_assert_false(adg_dim_style_reset_marker1(dim_style, NULL));
+
+    adg_marker_set_size(marker, 10);
+    adg_arrow_set_angle(ADG_ARROW(marker), G_PI / 3);
+    g_assert_true(adg_dim_style_reset_marker1(dim_style, marker));
+    adg_assert_isapprox(adg_marker_get_size(marker), 5);
+    adg_assert_isapprox(adg_arrow_get_angle(ADG_ARROW(marker)), G_PI / 4);
+
+    /* Template changes must be picked up by the reused marker */
+    adg_marker_set_size(ADG_MARKER(template), 7);
+    adg_dim_style_set_marker1(dim_style, ADG_MARKER(template));
+    g_assert_true(adg_dim_style_reset_marker1(dim_style, marker));
+    adg_assert_isapprox(adg_marker_get_size(marker), 7);
+
+    /* A marker cannot be reset to an unset template */
+    g_assert_false(adg_dim_style_reset_marker2(dim_style, marker));
+    adg_dim_style_set_marker1(dim_style, NULL);
+    g_assert_false(adg_dim_style_reset_marker1(dim_style, marker));
+
+    g_object_unref(dim_style);
+    adg_entity_destroy(ADG_ENTITY(marker));
+    adg_entity_destroy(ADG_ENTITY(template));
+}
+
 static void
 _adg_method_clone(void)
 {
@@ -1000,6 +1089,8 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/dim-style/property/value-dress", _adg_property_value_dress);
 
     g_test_add_func("/adg/dim-style/method/convert", _adg_method_convert);
+    g_test_add_func("/adg/dim-style/method/format-value", _adg_method_format_value);
+    g_test_add_func("/adg/dim-style/method/reset-marker", _adg_method_reset_marker);
     g_test_add_func("/adg/dim-style/method/clone", _adg_method_clone);
 
     return g_test_run();
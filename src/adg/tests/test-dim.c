@@ -686,6 +686,47 @@ _adg_method_get_text(void)
     adg_entity_destroy(ADG_ENTITY(dim));
 }
 
+static void
+_adg_behavior_quote_reuse(void)
+{
+    AdgDim *dim;
+    AdgEntity *entity;
+    AdgContainer *quote;
+    GSList *children, *new_children;
+
+    dim = ADG_DIM(adg_ldim_new_full_explicit(0, 0, 10, 0, 5, 5, 0));
+    entity = (AdgEntity *) dim;
+    adg_dim_set_limits(dim, "-0.1", "+0.1");
+
+    adg_entity_arrange(entity);
+    quote = (AdgContainer *) adg_dim_get_quote(dim);
+    g_assert_nonnull(quote);
+    children = adg_container_children(quote);
+    g_assert_cmpint(g_slist_length(children), ==, 3);
+
+    /* Changing the limits must reuse the same text entities */
+    adg_dim_set_limits(dim, "-0.2", "+0.2");
+    adg_entity_invalidate(entity);
+    adg_entity_arrange(entity);
+    g_assert_true((AdgContainer *) adg_dim_get_quote(dim) == quote);
+    new_children = adg_container_children(quote);
+    g_assert_cmpint(g_slist_length(new_children), ==, 3);
+    g_assert_true(g_slist_find(new_children, children->data) != NULL);
+    g_assert_true(g_slist_find(new_children, children->next->data) != NULL);
+    g_assert_true(g_slist_find(new_children, children->next->next->data) != NULL);
+    g_slist_free(new_children);
+
+    /* Unsetting a limit must drop its text entity */
+    adg_dim_set_max(dim, NULL);
+    adg_entity_arrange(entity);
+    new_children = adg_container_children(quote);
+    g_assert_cmpint(g_slist_length(new_children), ==, 2);
+    g_slist_free(new_children);
+
+    g_slist_free(children);
+    adg_entity_destroy(entity);
+}
+
 static void
 _adg_method_set_limits(void)
 {
@@ -777,6 +818,7 @@ main(int argc, char *argv[])
     adg_test_add_entity_checks("/adg/dim/type/entity", ADG_TYPE_DIM);
 
     g_test_add_func("/adg/dim/behavior/geometry", _adg_behavior_geometry);
+    g_test_add_func("/adg/dim/behavior/quote-reuse", _adg_behavior_quote_reuse);
 
     g_test_add_func("/adg/dim/property/detached", _adg_property_detached);
     g_test_add_func("/adg/dim/property/dim-dress", _adg_property_dim_dress);
@@ -301,6 +301,34 @@ _adg_method_get_ancestor_type(void)
     g_assert_cmpint(adg_dress_get_ancestor_type(ADG_DRESS_TABLE),                 ==, ADG_TYPE_TABLE_STYLE);
 }
 
+static void
+_adg_method_get_fallback(void)
+{
+    AdgStyle *style;
+
+    /* Invalid and pass-through dresses do not have any fallback */
+    g_assert_null(adg_dress_get_fallback(ADG_DRESS_UNDEFINED));
+    g_assert_null(adg_dress_get_fallback(ADG_DRESS_COLOR));
+    g_assert_null(adg_dress_get_fallback(ADG_DRESS_LINE));
+    g_assert_null(adg_dress_get_fallback(ADG_DRESS_FILL));
+
+    /* Built-in fallbacks are created on the first lookup and
+     * the same instance must be returned afterwards */
+    style = adg_dress_get_fallback(ADG_DRESS_DIMENSION);
+    g_assert_true(ADG_IS_DIM_STYLE(style));
+    g_assert_true(adg_dress_get_fallback(ADG_DRESS_DIMENSION) == style);
+
+    style = adg_dress_get_fallback(ADG_DRESS_LINE_AXIS);
+    g_assert_true(ADG_IS_LINE_STYLE(style));
+    g_assert_nonnull(adg_line_style_get_dash(ADG_LINE_STYLE(style)));
+    g_assert_true(adg_dress_get_fallback(ADG_DRESS_LINE_AXIS) == style);
+
+    g_assert_true(G_TYPE_CHECK_INSTANCE_TYPE(adg_dress_get_fallback(ADG_DRESS_FONT_TEXT),
+                                             ADG_TYPE_BEST_FONT_STYLE));
+    g_assert_true(ADG_IS_RULED_FILL(adg_dress_get_fallback(ADG_DRESS_FILL_HATCH)));
+    g_assert_true(ADG_IS_TABLE_STYLE(adg_dress_get_fallback(ADG_DRESS_TABLE)));
+}
+
 
 int
 main(int argc, char *argv[])
@@ -313,6 +341,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/dress/method/set", _adg_method_set);
     g_test_add_func("/adg/dress/method/are-related",  _adg_method_are_related);
     g_test_add_func("/adg/dress/method/ancestor-type", _adg_method_get_ancestor_type);
+    g_test_add_func("/adg/dress/method/get-fallback", _adg_method_get_fallback);
 
     return g_test_run();
 }
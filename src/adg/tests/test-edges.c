@@ -71,6 +71,129 @@ _adg_behavior_misc(void)
     g_object_unref(edges);
 }
 
+static void
+_adg_behavior_cache(void)
+{
+    AdgPath *path;
+    AdgEdges *edges, *fresh;
+    cairo_path_t *cairo_path, *fresh_path;
+    gint n;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 5);
+    adg_path_line_to_explicit(path, 1, 6);
+    adg_path_line_to_explicit(path, 2, 3);
+    adg_path_line_to_explicit(path, 3, 1);
+    adg_path_reflect(path, NULL);
+
+    edges = adg_edges_new_with_source(ADG_TRAIL(path));
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(edges));
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 8);
+
+    /* Changing the source must give the same result of a new
+     * AdgEdges built from scratch, even if part of the vertices
+     * has been taken from the cache */
+    adg_path_move_to_explicit(path, 4, 2);
+    adg_path_line_to_explicit(path, 5, 4);
+    adg_path_line_to_explicit(path, 6, -4);
+    adg_path_line_to_explicit(path, 7, -2);
+    adg_model_clear(ADG_MODEL(edges));
+
+    fresh = adg_edges_new_with_source(ADG_TRAIL(path));
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(edges));
+    fresh_path = adg_trail_cairo_path(ADG_TRAIL(fresh));
+    g_assert_nonnull(cairo_path);
+    g_assert_nonnull(fresh_path);
+    g_assert_cmpint(cairo_path->num_data, >, 8);
+    g_assert_cmpint(cairo_path->num_data, ==, fresh_path->num_data);
+
+    for (n = 0; n < cairo_path->num_data; ++n) {
+        if (n % 2 == 0) {
+            g_assert_cmpint(cairo_path->data[n].header.type, ==,
+                            fresh_path->data[n].header.type);
+        } else {
+            adg_assert_isapprox(cairo_path->data[n].point.x,
+                                fresh_path->data[n].point.x);
+            adg_assert_isapprox(cairo_path->data[n].point.y,
+                                fresh_path->data[n].point.y);
+        }
+    }
+
+    /* Clearing the source must drop the stale vertices */
+    adg_model_clear(ADG_MODEL(path));
+    adg_model_clear(ADG_MODEL(edges));
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(edges));
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 0);
+
+    g_object_unref(fresh);
+    g_object_unref(edges);
+    g_object_unref(path);
+}
+
+static void
+_adg_behavior_parallel(void)
+{
+    AdgPath *path;
+    AdgTrail *trails[3];
+    AdgEdges *fresh;
+    cairo_path_t *cairo_path, *fresh_path;
+    gint n;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 5);
+    adg_path_line_to_explicit(path, 1, 6);
+    adg_path_line_to_explicit(path, 2, 3);
+    adg_path_line_to_explicit(path, 3, 1);
+    adg_path_reflect(path, NULL);
+
+    /* Sanity checks */
+    adg_trail_compute_parallel(1, NULL);
+    adg_trail_compute_parallel(0, NULL);
+
+    /* Two edges sharing the same source and one without source */
+    trails[0] = ADG_TRAIL(adg_edges_new_with_source(ADG_TRAIL(path)));
+    trails[1] = ADG_TRAIL(adg_edges_new_with_source(ADG_TRAIL(path)));
+    trails[2] = ADG_TRAIL(adg_edges_new());
+    adg_trail_compute_parallel(3, trails);
+
+    fresh = adg_edges_new_with_source(ADG_TRAIL(path));
+    fresh_path = adg_trail_cairo_path(ADG_TRAIL(fresh));
+    g_assert_nonnull(fresh_path);
+    g_assert_cmpint(fresh_path->num_data, ==, 8);
+
+    cairo_path = adg_trail_cairo_path(trails[0]);
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, fresh_path->num_data);
+    for (n = 1; n < cairo_path->num_data; n += 2) {
+        adg_assert_isapprox(cairo_path->data[n].point.x,
+                            fresh_path->data[n].point.x);
+        adg_assert_isapprox(cairo_path->data[n].point.y,
+                            fresh_path->data[n].point.y);
+    }
+
+    cairo_path = adg_trail_cairo_path(trails[1]);
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, fresh_path->num_data);
+
+    cairo_path = adg_trail_cairo_path(trails[2]);
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 0);
+
+    /* Already computed trails are left untouched */
+    cairo_path = adg_trail_cairo_path(trails[1]);
+    adg_trail_compute_parallel(3, trails);
+    g_assert_true(adg_trail_cairo_path(trails[1]) == cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 8);
+
+    g_object_unref(fresh);
+    g_object_unref(trails[0]);
+    g_object_unref(trails[1]);
+    g_object_unref(trails[2]);
+    g_object_unref(path);
+}
+
 static void
 _adg_property_source(void)
 {
@@ -188,6 +311,8 @@ main(int argc, char *argv[])
     adg_test_add_model_checks("/adg/edges/type/model", ADG_TYPE_EDGES);
 
     g_test_add_func("/adg/edges/behavior/misc", _adg_behavior_misc);
+    g_test_add_func("/adg/edges/behavior/cache", _adg_behavior_cache);
+    g_test_add_func("/adg/edges/behavior/parallel", _adg_behavior_parallel);
 
     g_test_add_func("/adg/edges/property/source", _adg_property_source);
     g_test_add_func("/adg/edges/property/axis-angle", _adg_property_axis_angle);
@@ -20,6 +20,7 @@
 
 #include <adg-test.h>
 #include <adg.h>
+#include <string.h>
 
 #define ADG_TYPE_DUMMY      (adg_dummy_get_type())
 
@@ -94,6 +95,48 @@ _adg_behavior_style(void)
     g_object_unref(line_style);
 }
 
+static void
+_adg_behavior_style_cache(void)
+{
+    AdgContainer *container;
+    AdgEntity *entity;
+    AdgStyle *fallback, *style1, *style2;
+
+    container = adg_container_new();
+    entity = ADG_ENTITY(adg_logo_new());
+    style1 = ADG_STYLE(adg_color_style_new());
+    style2 = ADG_STYLE(adg_color_style_new());
+    fallback = adg_dress_get_fallback(ADG_DRESS_COLOR);
+
+    adg_container_add(container, entity);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == fallback);
+
+    /* Overrides on the parent must be picked up by the cached child */
+    adg_entity_set_style(ADG_ENTITY(container), ADG_DRESS_COLOR, style1);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == style1);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == style1);
+
+    adg_entity_set_style(ADG_ENTITY(container), ADG_DRESS_COLOR, style2);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == style2);
+
+    /* The own override has precedence */
+    adg_entity_set_style(entity, ADG_DRESS_COLOR, style1);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == style1);
+
+    adg_entity_set_style(entity, ADG_DRESS_COLOR, NULL);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == style2);
+
+    /* Unparenting must drop the inherited style */
+    g_object_ref(entity);
+    adg_container_remove(container, entity);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == fallback);
+
+    adg_entity_destroy(entity);
+    adg_entity_destroy(ADG_ENTITY(container));
+    g_object_unref(style1);
+    g_object_unref(style2);
+}
+
 static void
 _adg_behavior_local(void)
 {
@@ -143,6 +186,507 @@ _adg_behavior_local(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static gboolean
+_adg_is_blank(cairo_surface_t *surface)
+{
+    const guchar *data;
+    gint stride, height, n;
+
+    cairo_surface_flush(surface);
+    data = cairo_image_surface_get_data(surface);
+    stride = cairo_image_surface_get_stride(surface);
+    height = cairo_image_surface_get_height(surface);
+
+    for (n = 0; n < stride * height; ++n)
+        if (data[n] != 0)
+            return FALSE;
+
+    return TRUE;
+}
+
+static gboolean
+_adg_render_is_blank(AdgEntity *entity)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gboolean is_blank;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+    cr = cairo_create(surface);
+    adg_entity_render(entity, cr);
+    cairo_destroy(cr);
+    is_blank = _adg_is_blank(surface);
+    cairo_surface_destroy(surface);
+
+    return is_blank;
+}
+
+static void
+_adg_behavior_lod(void)
+{
+    AdgPath *path;
+    AdgEntity *entity;
+    gdouble threshold;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 2, 2);
+    adg_path_line_to_explicit(path, 4, 4);
+    entity = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    g_object_unref(path);
+
+    /* No rules by default */
+    g_assert_cmpint(adg_get_lod(ADG_TYPE_STROKE, &threshold), ==, ADG_LOD_POLICY_RENDER);
+    adg_assert_isapprox(threshold, 0);
+    g_assert_false(_adg_render_is_blank(entity));
+
+    /* Rules are inherited by the derived types */
+    adg_set_lod(ADG_TYPE_ENTITY, 5, ADG_LOD_POLICY_SKIP);
+    g_assert_cmpint(adg_get_lod(ADG_TYPE_STROKE, &threshold), ==, ADG_LOD_POLICY_SKIP);
+    adg_assert_isapprox(threshold, 5);
+    g_assert_true(_adg_render_is_blank(entity));
+
+    /* A rule on a derived type takes precedence */
+    adg_set_lod(ADG_TYPE_STROKE, 5, ADG_LOD_POLICY_BOX);
+    g_assert_cmpint(adg_get_lod(ADG_TYPE_STROKE, NULL), ==, ADG_LOD_POLICY_BOX);
+    g_assert_cmpint(adg_get_lod(ADG_TYPE_ENTITY, NULL), ==, ADG_LOD_POLICY_SKIP);
+    g_assert_false(_adg_render_is_blank(entity));
+
+    /* Entities above the threshold are always rendered */
+    adg_set_lod(ADG_TYPE_STROKE, 1, ADG_LOD_POLICY_SKIP);
+    g_assert_false(_adg_render_is_blank(entity));
+
+    /* Removing the rules */
+    adg_set_lod(ADG_TYPE_STROKE, 0, ADG_LOD_POLICY_RENDER);
+    adg_set_lod(ADG_TYPE_ENTITY, 0, ADG_LOD_POLICY_RENDER);
+    g_assert_cmpint(adg_get_lod(ADG_TYPE_STROKE, &threshold), ==, ADG_LOD_POLICY_RENDER);
+    adg_assert_isapprox(threshold, 0);
+
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_behavior_preview(void)
+{
+    AdgPath *path;
+    AdgEntity *entity;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+    cr = cairo_create(surface);
+
+    /* Preview is disabled by default */
+    g_assert_false(adg_has_preview(cr));
+    adg_switch_preview(cr, TRUE);
+    g_assert_true(adg_has_preview(cr));
+
+    /* An entity smaller than a pixel must be skipped in preview */
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 2, 2);
+    adg_path_line_to_explicit(path, 2.5, 2.5);
+    entity = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    g_object_unref(path);
+
+    g_assert_false(_adg_render_is_blank(entity));
+    adg_entity_render(entity, cr);
+    g_assert_true(_adg_is_blank(surface));
+
+    adg_switch_preview(cr, FALSE);
+    g_assert_false(adg_has_preview(cr));
+    adg_entity_render(entity, cr);
+    g_assert_false(_adg_is_blank(surface));
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_behavior_state_tracking(void)
+{
+    AdgPath *path;
+    AdgEntity *entity;
+    AdgLineStyle *line_style;
+    AdgDash *dash;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    cairo_matrix_t matrix;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+    cr = cairo_create(surface);
+
+    /* Sanity check */
+    adg_switch_state_tracking(NULL, TRUE);
+    g_assert_false(adg_has_state_tracking(NULL));
+
+    /* State tracking is disabled by default */
+    g_assert_false(adg_has_state_tracking(cr));
+    adg_switch_state_tracking(cr, TRUE);
+    g_assert_true(adg_has_state_tracking(cr));
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 1, 1);
+    adg_path_line_to_explicit(path, 9, 9);
+    entity = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    g_object_unref(path);
+
+    line_style = adg_line_style_new();
+    dash = adg_dash_new_with_dashes(2, 1., 2.);
+    adg_line_style_set_dash(line_style, dash);
+    adg_dash_destroy(dash);
+    adg_entity_set_style(entity, adg_stroke_get_line_dress((AdgStroke *) entity),
+                         (AdgStyle *) line_style);
+    g_object_unref(line_style);
+
+    /* The entity must be rendered anyway... */
+    adg_entity_render(entity, cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+    g_assert_false(_adg_is_blank(surface));
+
+    /* ...leaving the matrix, the path and the dashes as they were */
+    cairo_get_matrix(cr, &matrix);
+    g_assert_true(adg_matrix_equal(&matrix, adg_matrix_identity()));
+    g_assert_false(cairo_has_current_point(cr));
+    g_assert_cmpint(cairo_get_dash_count(cr), ==, 0);
+
+    adg_switch_state_tracking(cr, FALSE);
+    g_assert_false(adg_has_state_tracking(cr));
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_behavior_arrange(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity, *child;
+    GSList *children;
+    CpmlExtents bogus;
+    const CpmlExtents *extents;
+
+    canvas = adg_test_canvas();
+    entity = ADG_ENTITY(canvas);
+    children = adg_container_children(ADG_CONTAINER(canvas));
+    child = children->data;
+    g_slist_free(children);
+
+    bogus.is_defined = TRUE;
+    bogus.org.x = 0;
+    bogus.org.y = 0;
+    bogus.size.x = 5;
+    bogus.size.y = 5;
+
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 1);
+
+    /* Arranging an unchanged entity is a no-op, so the extents
+     * directly set with adg_entity_set_extents() are retained */
+    adg_entity_set_extents(entity, &bogus);
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    adg_assert_isapprox(extents->size.x, 5);
+
+    /* Invalidating a child must trigger a new arrange of its ancestors */
+    adg_entity_invalidate(child);
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    adg_assert_isapprox(extents->size.x, 1);
+
+    /* Changing a property must do the same */
+    adg_entity_set_extents(entity, &bogus);
+    adg_entity_set_global_map(child, adg_matrix_identity());
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    adg_assert_isapprox(extents->size.x, 1);
+
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_behavior_culling(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity, *child;
+    GSList *children;
+    cairo_t *cr;
+
+    canvas = adg_test_canvas();
+    entity = ADG_ENTITY(canvas);
+    children = adg_container_children(ADG_CONTAINER(canvas));
+    child = children->data;
+    g_slist_free(children);
+    cr = adg_test_cairo_context();
+
+    /* An entity outside the clip region must not be rendered */
+    cairo_save(cr);
+    cairo_rectangle(cr, 500, 500, 10, 10);
+    cairo_clip(cr);
+    adg_test_signal(child, "render");
+    adg_entity_render(entity, cr);
+    g_assert_false(adg_test_signal_check(TRUE));
+    cairo_restore(cr);
+
+    /* The same entity inside the clip region must be rendered */
+    adg_test_signal(child, "render");
+    adg_entity_render(entity, cr);
+    g_assert_true(adg_test_signal_check(TRUE));
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_count_emissions(AdgEntity *entity, gpointer user_data)
+{
+    ++ *(gint *) user_data;
+}
+
+static void
+_adg_behavior_signals(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gint arranged, rendered, invalidated;
+
+    canvas = adg_test_canvas();
+    entity = ADG_ENTITY(adg_logo_new());
+    adg_container_add(ADG_CONTAINER(canvas), entity);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    /* Without handlers the default handlers must be called anyway */
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+    adg_entity_invalidate(ADG_ENTITY(canvas));
+    g_assert_false(adg_entity_get_extents(entity)->is_defined);
+
+    arranged = rendered = invalidated = 0;
+    g_signal_connect(entity, "arrange", G_CALLBACK(_adg_count_emissions), &arranged);
+    g_signal_connect(entity, "render", G_CALLBACK(_adg_count_emissions), &rendered);
+    g_signal_connect(entity, "invalidate", G_CALLBACK(_adg_count_emissions), &invalidated);
+
+    /* Connected handlers must still be reached through the hierarchy */
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpint(arranged, >, 0);
+    g_assert_cmpint(rendered, ==, 1);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+
+    adg_entity_invalidate(ADG_ENTITY(canvas));
+    g_assert_cmpint(invalidated, ==, 1);
+    g_assert_false(adg_entity_get_extents(entity)->is_defined);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_behavior_profiling(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    AdgProfile *report;
+    guint n, n_profiles;
+    gboolean found;
+    cairo_t *cr;
+
+    canvas = adg_test_canvas();
+    entity = ADG_ENTITY(canvas);
+    cr = adg_test_cairo_context();
+
+    adg_profiling_reset();
+    adg_switch_profiling(TRUE);
+    adg_entity_render(entity, cr);
+    adg_entity_invalidate(entity);
+    adg_switch_profiling(FALSE);
+
+    report = adg_profiling_report(&n_profiles);
+    g_assert_nonnull(report);
+    g_assert_cmpuint(n_profiles, >, 0);
+
+    found = FALSE;
+    for (n = 0; n < n_profiles; ++n) {
+        if (report[n].type == ADG_TYPE_CANVAS) {
+            found = TRUE;
+            g_assert_cmpuint(report[n].n_arranges, >, 0);
+            g_assert_cmpuint(report[n].n_renders, ==, 1);
+            g_assert_cmpuint(report[n].n_invalidations, ==, 1);
+        }
+    }
+    g_assert_true(found);
+    g_free(report);
+
+    /* Without profiling nothing is collected */
+    adg_profiling_reset();
+    adg_entity_render(entity, cr);
+    report = adg_profiling_report(&n_profiles);
+    g_assert_null(report);
+    g_assert_cmpuint(n_profiles, ==, 0);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_behavior_invalidation_tracing(void)
+{
+    AdgPath *path;
+    AdgStroke *stroke;
+    gchar *dump;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+
+    adg_invalidation_tracing_reset();
+    adg_switch_invalidation_tracing(TRUE);
+    adg_model_changed(ADG_MODEL(path));
+    adg_model_changed(ADG_MODEL(path));
+    adg_switch_invalidation_tracing(FALSE);
+
+    /* The stroke is reached twice through its trail */
+    dump = adg_invalidation_tracing_dump();
+    g_assert_nonnull(strstr(dump, "digraph"));
+    g_assert_nonnull(strstr(dump, "AdgPath"));
+    g_assert_nonnull(strstr(dump, "AdgStroke"));
+    g_assert_nonnull(strstr(dump, "roots: 2"));
+    g_assert_nonnull(strstr(dump, "geometry-changed x2"));
+    g_free(dump);
+
+    /* Without tracing nothing is collected */
+    adg_invalidation_tracing_reset();
+    adg_model_changed(ADG_MODEL(path));
+    dump = adg_invalidation_tracing_dump();
+    g_assert_null(strstr(dump, "AdgPath"));
+    g_free(dump);
+
+    adg_entity_destroy(ADG_ENTITY(stroke));
+    g_object_unref(path);
+}
+
+static void
+_adg_behavior_hidden_layers(void)
+{
+    AdgEntity *entity;
+    cairo_t *cr;
+
+    entity = ADG_ENTITY(adg_logo_new());
+    cr = adg_test_cairo_context();
+
+    /* By default every layer is visible */
+    g_assert_cmpuint(adg_get_hidden_layers(cr), ==, 0);
+
+    adg_set_hidden_layers(cr, 1 << 2);
+    g_assert_cmpuint(adg_get_hidden_layers(cr), ==, 1 << 2);
+
+    /* An entity in a hidden layer is not even arranged */
+    adg_entity_set_layer(entity, 2);
+    adg_entity_render(entity, cr);
+    g_assert_false(adg_entity_get_extents(entity)->is_defined);
+
+    adg_set_hidden_layers(cr, 0);
+    adg_entity_render(entity, cr);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+}
+
+static guint
+_adg_logo_arranges(void)
+{
+    AdgProfile *report;
+    guint n, n_profiles, n_arranges;
+
+    report = adg_profiling_report(&n_profiles);
+    n_arranges = 0;
+    for (n = 0; n < n_profiles; ++n)
+        if (report[n].type == ADG_TYPE_LOGO)
+            n_arranges += report[n].n_arranges;
+    g_free(report);
+
+    return n_arranges;
+}
+
+static void
+_adg_behavior_visible(void)
+{
+    AdgContainer *container;
+    AdgEntity *entity, *logos[2];
+    gboolean invalid_boolean, visible, keep_layout;
+    cairo_matrix_t map;
+    CpmlExtents extents, logo_extents;
+
+    container = adg_container_new();
+    entity = ADG_ENTITY(container);
+    logos[0] = ADG_ENTITY(adg_logo_new());
+    logos[1] = ADG_ENTITY(adg_logo_new());
+    cairo_matrix_init_translate(&map, 100, 100);
+    adg_entity_set_global_map(logos[1], &map);
+    adg_container_add(container, logos[0]);
+    adg_container_add(container, logos[1]);
+    invalid_boolean = (gboolean) 1234;
+
+    /* Ensure the default states are true */
+    g_assert_true(adg_entity_is_visible(logos[1]));
+    g_assert_true(adg_entity_has_keep_layout(logos[1]));
+
+    /* Using the public APIs */
+    adg_entity_switch_visible(logos[1], invalid_boolean);
+    g_assert_true(adg_entity_is_visible(logos[1]));
+    adg_entity_switch_keep_layout(logos[1], invalid_boolean);
+    g_assert_true(adg_entity_has_keep_layout(logos[1]));
+
+    /* Using GObject property methods */
+    g_object_set(logos[1], "visible", FALSE, NULL);
+    g_object_get(logos[1], "visible", &visible, NULL);
+    g_assert_false(visible);
+    g_object_set(logos[1], "visible", TRUE, NULL);
+    g_object_get(logos[1], "keep-layout", &keep_layout, NULL);
+    g_assert_true(keep_layout);
+
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    cpml_extents_copy(&logo_extents, adg_entity_get_extents(logos[1]));
+
+    adg_profiling_reset();
+    adg_switch_profiling(TRUE);
+
+    /* By default hiding does not change the layout */
+    adg_entity_switch_visible(logos[1], FALSE);
+    g_assert_false(adg_entity_is_visible(logos[1]));
+    adg_entity_arrange(entity);
+    g_assert_true(cpml_extents_equal(adg_entity_get_extents(entity), &extents));
+
+    /* Without layout the entity does not contribute to the extents */
+    adg_entity_switch_visible(logos[1], TRUE);
+    adg_entity_switch_keep_layout(logos[1], FALSE);
+    adg_entity_arrange(entity);
+    adg_profiling_reset();
+    adg_entity_switch_visible(logos[1], FALSE);
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(cpml_extents_equal(&extents, adg_entity_get_extents(logos[0])));
+
+    /* Its caches are kept, so showing it again does not arrange it */
+    g_assert_true(cpml_extents_equal(adg_entity_get_extents(logos[1]), &logo_extents));
+    adg_entity_switch_visible(logos[1], TRUE);
+    adg_entity_arrange(entity);
+    g_assert_cmpuint(_adg_logo_arranges(), ==, 0);
+    g_assert_false(cpml_extents_equal(adg_entity_get_extents(entity), &extents));
+
+    adg_switch_profiling(FALSE);
+    adg_profiling_reset();
+    adg_entity_destroy(entity);
+}
+
 static void
 _adg_property_floating(void)
 {
@@ -179,6 +723,84 @@ _adg_property_floating(void)
     adg_entity_destroy(entity);
 }
 
+static void
+_adg_property_layer(void)
+{
+    AdgEntity *entity;
+    guint layer;
+
+    entity = ADG_ENTITY(adg_logo_new());
+
+    /* Ensure the default layer is 0 */
+    g_assert_cmpuint(adg_entity_get_layer(entity), ==, 0);
+
+    /* Using the public APIs */
+    adg_entity_set_layer(entity, 3);
+    g_assert_cmpuint(adg_entity_get_layer(entity), ==, 3);
+
+    adg_entity_set_layer(entity, 32);
+    g_assert_cmpuint(adg_entity_get_layer(entity), ==, 3);
+
+    /* Using GObject property methods */
+    g_object_set(entity, "layer", 31, NULL);
+    g_object_get(entity, "layer", &layer, NULL);
+    g_assert_cmpuint(layer, ==, 31);
+
+    g_object_set(entity, "layer", 32, NULL);
+    g_object_get(entity, "layer", &layer, NULL);
+    g_assert_cmpuint(layer, ==, 31);
+
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_property_has_recording_cache(void)
+{
+    AdgEntity *entity;
+    gboolean invalid_boolean;
+    gboolean has_recording_cache;
+    cairo_t *cr;
+
+    entity = ADG_ENTITY(adg_logo_new());
+    invalid_boolean = (gboolean) 1234;
+
+    /* Ensure the default state is false */
+    g_assert_false(adg_entity_has_recording_cache(entity));
+
+    /* Using the public APIs */
+    adg_entity_switch_recording_cache(entity, invalid_boolean);
+    g_assert_false(adg_entity_has_recording_cache(entity));
+
+    adg_entity_switch_recording_cache(entity, TRUE);
+    g_assert_true(adg_entity_has_recording_cache(entity));
+
+    /* Using GObject property methods */
+    g_object_set(entity, "has-recording-cache", FALSE, NULL);
+    g_object_get(entity, "has-recording-cache", &has_recording_cache, NULL);
+    g_assert_false(has_recording_cache);
+
+    g_object_set(entity, "has-recording-cache", invalid_boolean, NULL);
+    g_object_get(entity, "has-recording-cache", &has_recording_cache, NULL);
+    g_assert_false(has_recording_cache);
+
+    g_object_set(entity, "has-recording-cache", TRUE, NULL);
+    g_object_get(entity, "has-recording-cache", &has_recording_cache, NULL);
+    g_assert_true(has_recording_cache);
+
+    /* Record, replay and record again after a change */
+    cr = adg_test_cairo_context();
+    adg_entity_render(entity, cr);
+    adg_entity_render(entity, cr);
+    adg_entity_invalidate(entity);
+    adg_entity_render(entity, cr);
+    cairo_scale(cr, 2, 2);
+    adg_entity_render(entity, cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+    cairo_destroy(cr);
+
+    adg_entity_destroy(entity);
+}
+
 static void
 _adg_property_parent(void)
 {
@@ -437,6 +1059,137 @@ _adg_method_get_canvas(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_method_get_memory_usage(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    gsize canvas_usage, entity_usage;
+
+    /* Sanity check */
+    g_assert_cmpuint(adg_entity_get_memory_usage(NULL), ==, 0);
+
+    canvas = adg_canvas_new();
+    entity = ADG_ENTITY(adg_toy_text_new("Memory"));
+    entity_usage = adg_entity_get_memory_usage(entity);
+    g_assert_cmpuint(entity_usage, >, 0);
+
+    canvas_usage = adg_entity_get_memory_usage(ADG_ENTITY(canvas));
+    adg_container_add(ADG_CONTAINER(canvas), entity);
+    g_assert_cmpuint(adg_entity_get_memory_usage(ADG_ENTITY(canvas)), >=,
+                     canvas_usage + entity_usage);
+
+    /* The glyphs cached while arranging must be accounted */
+    adg_entity_arrange(entity);
+    g_assert_cmpuint(adg_entity_get_memory_usage(entity), >, entity_usage);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_get_combined_matrix(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    cairo_matrix_t map;
+    const cairo_matrix_t *matrix, *inverse;
+    gdouble x, y;
+
+    /* Sanity check */
+    g_assert_null(adg_entity_get_combined_matrix(NULL));
+    g_assert_null(adg_entity_get_inverse_matrix(NULL));
+
+    canvas = adg_canvas_new();
+    entity = ADG_ENTITY(adg_logo_new());
+    adg_container_add(ADG_CONTAINER(canvas), entity);
+
+    cairo_matrix_init_scale(&map, 2, 2);
+    adg_entity_set_global_map(entity, &map);
+    cairo_matrix_init_translate(&map, 3, 4);
+    adg_entity_set_local_map(entity, &map);
+    adg_entity_global_changed(ADG_ENTITY(canvas));
+    adg_entity_local_changed(ADG_ENTITY(canvas));
+
+    /* The local matrix must be applied before the global one */
+    matrix = adg_entity_get_combined_matrix(entity);
+    g_assert_nonnull(matrix);
+    x = 1;
+    y = 1;
+    cairo_matrix_transform_point(matrix, &x, &y);
+    adg_assert_isapprox(x, 8);
+    adg_assert_isapprox(y, 10);
+
+    inverse = adg_entity_get_inverse_matrix(entity);
+    g_assert_nonnull(inverse);
+    cairo_matrix_transform_point(inverse, &x, &y);
+    adg_assert_isapprox(x, 1);
+    adg_assert_isapprox(y, 1);
+
+    /* The cache must follow the changes of the maps */
+    cairo_matrix_init_identity(&map);
+    adg_entity_set_local_map(entity, &map);
+    adg_entity_local_changed(ADG_ENTITY(canvas));
+    x = 1;
+    y = 1;
+    cairo_matrix_transform_point(adg_entity_get_combined_matrix(entity), &x, &y);
+    adg_assert_isapprox(x, 2);
+    adg_assert_isapprox(y, 2);
+
+    /* A singular matrix has no inverse */
+    cairo_matrix_init_scale(&map, 0, 0);
+    adg_entity_set_global_map(entity, &map);
+    adg_entity_global_changed(ADG_ENTITY(canvas));
+    g_assert_null(adg_entity_get_inverse_matrix(entity));
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_trim_caches(void)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    cairo_matrix_t map;
+    cairo_t *cr;
+    gsize arranged_usage;
+
+    /* Sanity check */
+    adg_entity_trim_caches(NULL, ADG_TRIM_LEVEL_RENDER);
+
+    canvas = adg_canvas_new();
+    entity = ADG_ENTITY(adg_toy_text_new("Trim"));
+
+    /* Keep the text inside the surface, so it is not clipped out */
+    cairo_matrix_init_translate(&map, 100, 100);
+    adg_entity_set_global_map(entity, &map);
+    adg_container_add(ADG_CONTAINER(canvas), entity);
+    adg_entity_arrange(ADG_ENTITY(canvas));
+    arranged_usage = adg_entity_get_memory_usage(ADG_ENTITY(canvas));
+
+    /* Invalid level */
+    adg_entity_trim_caches(ADG_ENTITY(canvas), 1234);
+    g_assert_cmpuint(adg_entity_get_memory_usage(ADG_ENTITY(canvas)), ==, arranged_usage);
+
+    /* Trimming the render caches must keep the extents */
+    adg_entity_trim_caches(ADG_ENTITY(canvas), ADG_TRIM_LEVEL_RENDER);
+    g_assert_cmpuint(adg_entity_get_memory_usage(ADG_ENTITY(canvas)), <, arranged_usage);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+
+    /* Rendering must rebuild what has been dropped */
+    cr = adg_test_cairo_context();
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpuint(adg_entity_get_memory_usage(ADG_ENTITY(canvas)), ==, arranged_usage);
+
+    adg_entity_trim_caches(ADG_ENTITY(canvas), ADG_TRIM_LEVEL_ARRANGE);
+    g_assert_false(adg_entity_get_extents(entity)->is_defined);
+
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 
 int
 main(int argc, char *argv[])
@@ -448,9 +1201,22 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/entity/behavior/misc", _adg_behavior_misc);
     g_test_add_func("/adg/entity/behavior/style", _adg_behavior_style);
+    g_test_add_func("/adg/entity/behavior/style-cache", _adg_behavior_style_cache);
     g_test_add_func("/adg/entity/behavior/local", _adg_behavior_local);
+    g_test_add_func("/adg/entity/behavior/arrange", _adg_behavior_arrange);
+    g_test_add_func("/adg/entity/behavior/lod", _adg_behavior_lod);
+    g_test_add_func("/adg/entity/behavior/preview", _adg_behavior_preview);
+    g_test_add_func("/adg/entity/behavior/state-tracking", _adg_behavior_state_tracking);
+    g_test_add_func("/adg/entity/behavior/hidden-layers", _adg_behavior_hidden_layers);
+    g_test_add_func("/adg/entity/behavior/visible", _adg_behavior_visible);
+    g_test_add_func("/adg/entity/behavior/culling", _adg_behavior_culling);
+    g_test_add_func("/adg/entity/behavior/signals", _adg_behavior_signals);
+    g_test_add_func("/adg/entity/behavior/profiling", _adg_behavior_profiling);
+    g_test_add_func("/adg/entity/behavior/invalidation-tracing", _adg_behavior_invalidation_tracing);
 
     g_test_add_func("/adg/entity/property/floating", _adg_property_floating);
+    g_test_add_func("/adg/entity/property/has-recording-cache", _adg_property_has_recording_cache);
+    g_test_add_func("/adg/entity/property/layer", _adg_property_layer);
     g_test_add_func("/adg/entity/property/parent", _adg_property_parent);
     g_test_add_func("/adg/entity/property/global-map", _adg_property_global_map);
     g_test_add_func("/adg/entity/property/local-map", _adg_property_local_map);
@@ -458,6 +1224,9 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/entity/property/extents", _adg_property_extents);
 
     g_test_add_func("/adg/entity/method/get-canvas", _adg_method_get_canvas);
+    g_test_add_func("/adg/entity/method/get-memory-usage", _adg_method_get_memory_usage);
+    g_test_add_func("/adg/entity/method/get-combined-matrix", _adg_method_get_combined_matrix);
+    g_test_add_func("/adg/entity/method/trim-caches", _adg_method_trim_caches);
 
     return g_test_run();
 }
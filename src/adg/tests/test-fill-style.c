@@ -68,6 +68,45 @@ _adg_property_pattern(void)
     g_object_unref(fill_style);
 }
 
+static void
+_adg_method_get_fill_extents(void)
+{
+    AdgFillStyle *fill_style;
+    AdgEntity *entity;
+    CpmlExtents extents;
+    const CpmlExtents *fill_extents;
+
+    fill_style = ADG_FILL_STYLE(adg_ruled_fill_new());
+    entity = (AdgEntity *) adg_logo_new();
+
+    extents.is_defined = TRUE;
+    extents.org.x = 1;
+    extents.org.y = 2;
+    extents.size.x = 3;
+    extents.size.y = 4;
+    adg_fill_style_set_extents(fill_style, &extents);
+
+    /* Invalid input */
+    g_assert_null(adg_fill_style_get_fill_extents(NULL, entity));
+    g_assert_null(adg_fill_style_get_fill_extents(fill_style, NULL));
+
+    /* Without extents on the entity, the fill style ones are used */
+    fill_extents = adg_fill_style_get_fill_extents(fill_style, entity);
+    g_assert_true(fill_extents == adg_fill_style_get_extents(fill_style));
+
+    /* The extents of the entity have precedence and
+     * the fill style must not be modified */
+    adg_entity_arrange(entity);
+    fill_extents = adg_fill_style_get_fill_extents(fill_style, entity);
+    g_assert_true(fill_extents == adg_entity_get_extents(entity));
+    fill_extents = adg_fill_style_get_extents(fill_style);
+    g_assert_cmpfloat(fill_extents->org.x, ==, 1);
+    g_assert_cmpfloat(fill_extents->size.y, ==, 4);
+
+    adg_entity_destroy(entity);
+    g_object_unref(fill_style);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -77,6 +116,7 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/fill-style/type/object", ADG_TYPE_FILL_STYLE);
 
     g_test_add_func("/adg/fill-style/property/pattern", _adg_property_pattern);
+    g_test_add_func("/adg/fill-style/method/get-fill-extents", _adg_method_get_fill_extents);
 
     return g_test_run();
 }
@@ -201,6 +201,44 @@ _adg_property_hint_style(void)
     g_object_unref(font_style);
 }
 
+static void
+_adg_property_outlines(void)
+{
+    AdgFontStyle *font_style;
+    gboolean invalid_boolean;
+    gboolean has_outlines;
+
+    font_style = adg_font_style_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    g_assert_false(adg_font_style_has_outlines(font_style));
+
+    adg_font_style_switch_outlines(font_style, invalid_boolean);
+    g_assert_false(adg_font_style_has_outlines(font_style));
+
+    adg_font_style_switch_outlines(font_style, TRUE);
+    g_assert_true(adg_font_style_has_outlines(font_style));
+
+    adg_font_style_switch_outlines(font_style, FALSE);
+    g_assert_false(adg_font_style_has_outlines(font_style));
+
+    /* Using GObject property methods */
+    g_object_set(font_style, "outlines", invalid_boolean, NULL);
+    g_object_get(font_style, "outlines", &has_outlines, NULL);
+    g_assert_false(has_outlines);
+
+    g_object_set(font_style, "outlines", TRUE, NULL);
+    g_object_get(font_style, "outlines", &has_outlines, NULL);
+    g_assert_true(has_outlines);
+
+    g_object_set(font_style, "outlines", FALSE, NULL);
+    g_object_get(font_style, "outlines", &has_outlines, NULL);
+    g_assert_false(has_outlines);
+
+    g_object_unref(font_style);
+}
+
 static void
 _adg_property_size(void)
 {
@@ -338,6 +376,122 @@ _adg_property_weight(void)
     g_object_unref(font_style);
 }
 
+static void
+_adg_method_get_scaled_font(void)
+{
+    AdgFontStyle *font_style;
+    cairo_matrix_t ctm1, ctm2;
+    cairo_scaled_font_t *font1, *font2;
+
+    font_style = adg_font_style_new();
+    cairo_matrix_init_scale(&ctm1, 2, 2);
+    cairo_matrix_init_scale(&ctm2, 3, 3);
+
+    font1 = adg_font_style_get_scaled_font(font_style, &ctm1);
+    g_assert_nonnull(font1);
+    font2 = adg_font_style_get_scaled_font(font_style, &ctm2);
+    g_assert_nonnull(font2);
+    g_assert_true(font1 != font2);
+
+    /* Alternating the ctm must not rebuild the fonts */
+    g_assert_true(adg_font_style_get_scaled_font(font_style, &ctm1) == font1);
+    g_assert_true(adg_font_style_get_scaled_font(font_style, &ctm2) == font2);
+
+    /* Translations are ignored */
+    cairo_matrix_translate(&ctm1, 10, 20);
+    g_assert_true(adg_font_style_get_scaled_font(font_style, &ctm1) == font1);
+
+    g_object_unref(font_style);
+}
+
+static void
+_adg_method_get_options(void)
+{
+    AdgFontStyle *font_style;
+    const cairo_font_options_t *options;
+    cairo_font_options_t *copy;
+
+    font_style = adg_font_style_new();
+    adg_font_style_set_antialias(font_style, CAIRO_ANTIALIAS_GRAY);
+
+    options = adg_font_style_get_options(font_style);
+    g_assert_nonnull(options);
+    g_assert_cmpint(cairo_font_options_get_antialias(options), ==, CAIRO_ANTIALIAS_GRAY);
+
+    /* The options must be cached */
+    g_assert_true(adg_font_style_get_options(font_style) == options);
+
+    copy = adg_font_style_new_options(font_style);
+    g_assert_true(cairo_font_options_equal(copy, options));
+    cairo_font_options_destroy(copy);
+
+    /* Changing a property must refresh the options */
+    adg_font_style_set_antialias(font_style, CAIRO_ANTIALIAS_NONE);
+    options = adg_font_style_get_options(font_style);
+    g_assert_cmpint(cairo_font_options_get_antialias(options), ==, CAIRO_ANTIALIAS_NONE);
+
+    g_object_unref(font_style);
+}
+
+
+static void
+_adg_method_show_glyphs(void)
+{
+    AdgFontStyle *font_style;
+    cairo_matrix_t ctm;
+    cairo_scaled_font_t *font;
+    cairo_surface_t *surface;
+    cairo_glyph_t *glyphs;
+    int num_glyphs;
+    cairo_t *cr;
+    unsigned char *pixels;
+    gint n, stride;
+    gboolean painted;
+
+    font_style = adg_font_style_new();
+    adg_font_style_set_size(font_style, 40);
+    adg_font_style_switch_outlines(font_style, TRUE);
+    cairo_matrix_init_identity(&ctm);
+    font = adg_font_style_get_scaled_font(font_style, &ctm);
+
+    glyphs = NULL;
+    num_glyphs = 0;
+    g_assert_cmpint(cairo_scaled_font_text_to_glyphs(font, 5, 45, "H", -1,
+                                                     &glyphs, &num_glyphs,
+                                                     NULL, NULL, NULL),
+                    ==, CAIRO_STATUS_SUCCESS);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_A8, 50, 50);
+    cr = cairo_create(surface);
+
+    /* Invalid input */
+    adg_font_style_show_glyphs(NULL, cr, font, glyphs, num_glyphs);
+    adg_font_style_show_glyphs(font_style, NULL, font, glyphs, num_glyphs);
+    adg_font_style_show_glyphs(font_style, cr, NULL, glyphs, num_glyphs);
+
+    /* The outlines are filled and the path is consumed */
+    adg_font_style_show_glyphs(font_style, cr, font, glyphs, num_glyphs);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+    g_assert_false(cairo_has_current_point(cr));
+
+    /* The second rendering fetches the outlines from the cache */
+    adg_font_style_show_glyphs(font_style, cr, font, glyphs, num_glyphs);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+
+    cairo_surface_flush(surface);
+    pixels = cairo_image_surface_get_data(surface);
+    stride = cairo_image_surface_get_stride(surface);
+    painted = FALSE;
+    for (n = 0; n < stride * 50; ++n)
+        if (pixels[n] != 0)
+            painted = TRUE;
+    g_assert_true(painted);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    cairo_glyph_free(glyphs);
+    g_object_unref(font_style);
+}
 
 int
 main(int argc, char *argv[])
@@ -351,10 +505,15 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/font-style/property/family", _adg_property_family);
     g_test_add_func("/adg/font-style/property/hint-metrics", _adg_property_hint_metrics);
     g_test_add_func("/adg/font-style/property/hint-style", _adg_property_hint_style);
+    g_test_add_func("/adg/font-style/property/outlines", _adg_property_outlines);
     g_test_add_func("/adg/font-style/property/size", _adg_property_size);
     g_test_add_func("/adg/font-style/property/slant", _adg_property_slant);
     g_test_add_func("/adg/font-style/property/subpixel-order", _adg_property_subpixel_order);
     g_test_add_func("/adg/font-style/property/weight", _adg_property_weight);
 
+    g_test_add_func("/adg/font-style/method/get-scaled-font", _adg_method_get_scaled_font);
+    g_test_add_func("/adg/font-style/method/get-options", _adg_method_get_options);
+    g_test_add_func("/adg/font-style/method/show-glyphs", _adg_method_show_glyphs);
+
     return g_test_run();
 }
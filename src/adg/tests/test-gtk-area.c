@@ -239,6 +239,174 @@ _adg_property_autozoom(void)
     gtk_widget_destroy(GTK_WIDGET(area));
 }
 
+static void
+_adg_property_progressive_rendering(void)
+{
+    AdgGtkArea *area;
+    gboolean invalid_boolean;
+    gboolean has_progressive_rendering;
+
+    area = (AdgGtkArea *) adg_gtk_area_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    has_progressive_rendering = adg_gtk_area_has_progressive_rendering(area);
+    g_assert_false(has_progressive_rendering);
+
+    adg_gtk_area_switch_progressive_rendering(area, invalid_boolean);
+    has_progressive_rendering = adg_gtk_area_has_progressive_rendering(area);
+    g_assert_false(has_progressive_rendering);
+
+    adg_gtk_area_switch_progressive_rendering(area, TRUE);
+    has_progressive_rendering = adg_gtk_area_has_progressive_rendering(area);
+    g_assert_true(has_progressive_rendering);
+
+    adg_gtk_area_switch_progressive_rendering(area, FALSE);
+    has_progressive_rendering = adg_gtk_area_has_progressive_rendering(area);
+    g_assert_false(has_progressive_rendering);
+
+    /* Using GObject property methods */
+    g_object_set(area, "progressive-rendering", invalid_boolean, NULL);
+    g_object_get(area, "progressive-rendering", &has_progressive_rendering, NULL);
+    g_assert_false(has_progressive_rendering);
+
+    g_object_set(area, "progressive-rendering", TRUE, NULL);
+    g_object_get(area, "progressive-rendering", &has_progressive_rendering, NULL);
+    g_assert_true(has_progressive_rendering);
+
+    g_object_set(area, "progressive-rendering", FALSE, NULL);
+    g_object_get(area, "progressive-rendering", &has_progressive_rendering, NULL);
+    g_assert_false(has_progressive_rendering);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_property_threaded_rendering(void)
+{
+    AdgGtkArea *area;
+    gboolean invalid_boolean;
+    gboolean has_threaded_rendering;
+
+    area = (AdgGtkArea *) adg_gtk_area_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    has_threaded_rendering = adg_gtk_area_has_threaded_rendering(area);
+    g_assert_false(has_threaded_rendering);
+
+    adg_gtk_area_switch_threaded_rendering(area, invalid_boolean);
+    has_threaded_rendering = adg_gtk_area_has_threaded_rendering(area);
+    g_assert_false(has_threaded_rendering);
+
+    adg_gtk_area_switch_threaded_rendering(area, TRUE);
+    has_threaded_rendering = adg_gtk_area_has_threaded_rendering(area);
+    g_assert_true(has_threaded_rendering);
+
+    adg_gtk_area_switch_threaded_rendering(area, FALSE);
+    has_threaded_rendering = adg_gtk_area_has_threaded_rendering(area);
+    g_assert_false(has_threaded_rendering);
+
+    /* Using GObject property methods */
+    g_object_set(area, "threaded-rendering", invalid_boolean, NULL);
+    g_object_get(area, "threaded-rendering", &has_threaded_rendering, NULL);
+    g_assert_false(has_threaded_rendering);
+
+    g_object_set(area, "threaded-rendering", TRUE, NULL);
+    g_object_get(area, "threaded-rendering", &has_threaded_rendering, NULL);
+    g_assert_true(has_threaded_rendering);
+
+    g_object_set(area, "threaded-rendering", FALSE, NULL);
+    g_object_get(area, "threaded-rendering", &has_threaded_rendering, NULL);
+    g_assert_false(has_threaded_rendering);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_property_accelerated_rendering(void)
+{
+    AdgGtkArea *area;
+    gboolean invalid_boolean;
+    gboolean has_accelerated_rendering;
+
+    area = (AdgGtkArea *) adg_gtk_area_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    has_accelerated_rendering = adg_gtk_area_has_accelerated_rendering(area);
+    g_assert_false(has_accelerated_rendering);
+
+    adg_gtk_area_switch_accelerated_rendering(area, invalid_boolean);
+    has_accelerated_rendering = adg_gtk_area_has_accelerated_rendering(area);
+    g_assert_false(has_accelerated_rendering);
+
+    adg_gtk_area_switch_accelerated_rendering(area, TRUE);
+    has_accelerated_rendering = adg_gtk_area_has_accelerated_rendering(area);
+    g_assert_true(has_accelerated_rendering);
+
+    adg_gtk_area_switch_accelerated_rendering(area, FALSE);
+    has_accelerated_rendering = adg_gtk_area_has_accelerated_rendering(area);
+    g_assert_false(has_accelerated_rendering);
+
+    /* Using GObject property methods */
+    g_object_set(area, "accelerated-rendering", invalid_boolean, NULL);
+    g_object_get(area, "accelerated-rendering", &has_accelerated_rendering, NULL);
+    g_assert_false(has_accelerated_rendering);
+
+    g_object_set(area, "accelerated-rendering", TRUE, NULL);
+    g_object_get(area, "accelerated-rendering", &has_accelerated_rendering, NULL);
+    g_assert_true(has_accelerated_rendering);
+
+    g_object_set(area, "accelerated-rendering", FALSE, NULL);
+    g_object_get(area, "accelerated-rendering", &has_accelerated_rendering, NULL);
+    g_assert_false(has_accelerated_rendering);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_property_statistics(void)
+{
+    AdgGtkArea *area;
+    gboolean invalid_boolean;
+    gboolean has_statistics;
+
+    area = (AdgGtkArea *) adg_gtk_area_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    has_statistics = adg_gtk_area_has_statistics(area);
+    g_assert_false(has_statistics);
+
+    adg_gtk_area_switch_statistics(area, invalid_boolean);
+    has_statistics = adg_gtk_area_has_statistics(area);
+    g_assert_false(has_statistics);
+
+    adg_gtk_area_switch_statistics(area, TRUE);
+    has_statistics = adg_gtk_area_has_statistics(area);
+    g_assert_true(has_statistics);
+
+    adg_gtk_area_switch_statistics(area, FALSE);
+    has_statistics = adg_gtk_area_has_statistics(area);
+    g_assert_false(has_statistics);
+
+    /* Using GObject property methods */
+    g_object_set(area, "statistics", invalid_boolean, NULL);
+    g_object_get(area, "statistics", &has_statistics, NULL);
+    g_assert_false(has_statistics);
+
+    g_object_set(area, "statistics", TRUE, NULL);
+    g_object_get(area, "statistics", &has_statistics, NULL);
+    g_assert_true(has_statistics);
+
+    g_object_set(area, "statistics", FALSE, NULL);
+    g_object_get(area, "statistics", &has_statistics, NULL);
+    g_assert_false(has_statistics);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
 static void
 _adg_property_render_map(void)
 {
@@ -326,6 +494,49 @@ _adg_method_get_extents(void)
     gtk_widget_destroy(GTK_WIDGET(area));
 }
 
+static void
+_adg_method_pick(void)
+{
+    AdgGtkArea *area;
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    cairo_matrix_t map;
+
+    area = ADG_GTK_AREA(adg_gtk_area_new());
+    canvas = adg_canvas_new();
+
+    /* Sanity check */
+    g_assert_null(adg_gtk_area_pick(NULL, 0, 0));
+
+    /* Without a canvas nothing can be picked */
+    g_assert_null(adg_gtk_area_pick(area, 0, 0));
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 100, 0);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+
+    adg_gtk_area_set_canvas(area, canvas);
+    g_object_unref(canvas);
+
+    /* The stroke has flat extents: it must be picked nearby */
+    g_assert_true(adg_gtk_area_pick(area, 50, 0) == ADG_ENTITY(stroke));
+    g_assert_true(adg_gtk_area_pick(area, 50, 2) == ADG_ENTITY(stroke));
+    g_assert_null(adg_gtk_area_pick(area, 50, 10));
+    g_assert_null(adg_gtk_area_pick(area, 150, 0));
+
+    /* The tolerance is in device space, whatever the render map */
+    cairo_matrix_init_scale(&map, 10, 10);
+    adg_gtk_area_set_render_map(area, &map);
+    g_assert_true(adg_gtk_area_pick(area, 500, 2) == ADG_ENTITY(stroke));
+    g_assert_null(adg_gtk_area_pick(area, 500, 10));
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
 static void
 _adg_method_get_zoom(void)
 {
@@ -637,9 +848,14 @@ main(int argc, char *argv[])
     g_test_add_func("/adg-gtk/area/property/factor", _adg_property_factor);
     g_test_add_func("/adg-gtk/area/property/autozoom", _adg_property_autozoom);
     g_test_add_func("/adg-gtk/area/property/render-map", _adg_property_render_map);
+    g_test_add_func("/adg-gtk/area/property/progressive-rendering", _adg_property_progressive_rendering);
+    g_test_add_func("/adg-gtk/area/property/threaded-rendering", _adg_property_threaded_rendering);
+    g_test_add_func("/adg-gtk/area/property/accelerated-rendering", _adg_property_accelerated_rendering);
+    g_test_add_func("/adg-gtk/area/property/statistics", _adg_property_statistics);
 
     g_test_add_func("/adg-gtk/area/method/get-extents", _adg_method_get_extents);
     g_test_add_func("/adg-gtk/area/method/get-zoom", _adg_method_get_zoom);
+    g_test_add_func("/adg-gtk/area/method/pick", _adg_method_pick);
     g_test_add_func("/adg-gtk/area/method/switch-autozoom", _adg_method_switch_autozoom);
     g_test_add_func("/adg-gtk/area/method/reset", _adg_method_reset);
     g_test_add_func("/adg-gtk/area/method/extents-changed", _adg_method_extents_changed);
@@ -0,0 +1,147 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+
+
+static AdgInstanceArray *
+_adg_instance_array_with_segment(gdouble x1, gdouble y1,
+                                 gdouble x2, gdouble y2)
+{
+    AdgInstanceArray *instance_array;
+    AdgPath *path;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, x1, y1);
+    adg_path_line_to_explicit(path, x2, y2);
+
+    instance_array = adg_instance_array_new();
+    adg_container_add(ADG_CONTAINER(instance_array),
+                      ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+    g_object_unref(path);
+
+    return instance_array;
+}
+
+static void
+_adg_method_add_matrix(void)
+{
+    AdgInstanceArray *instance_array;
+    cairo_matrix_t matrix;
+    const cairo_matrix_t *got_matrix;
+    const CpmlExtents *extents;
+
+    instance_array = _adg_instance_array_with_segment(0, 0, 1, 1);
+
+    /* Invalid input */
+    adg_instance_array_add_matrix(NULL, &matrix);
+    adg_instance_array_add_matrix(instance_array, NULL);
+    g_assert_cmpuint(adg_instance_array_get_n_matrices(instance_array), ==, 0);
+    g_assert_null(adg_instance_array_get_matrix(instance_array, 0));
+
+    /* Without instances nothing is rendered */
+    adg_entity_arrange(ADG_ENTITY(instance_array));
+    extents = adg_entity_get_extents(ADG_ENTITY(instance_array));
+    g_assert_false(extents->is_defined);
+
+    cairo_matrix_init_scale(&matrix, 2, 3);
+    adg_instance_array_add_matrix(instance_array, &matrix);
+    g_assert_cmpuint(adg_instance_array_get_n_matrices(instance_array), ==, 1);
+    got_matrix = adg_instance_array_get_matrix(instance_array, 0);
+    g_assert_nonnull(got_matrix);
+    adg_assert_isapprox(got_matrix->xx, 2);
+    adg_assert_isapprox(got_matrix->yy, 3);
+
+    adg_entity_arrange(ADG_ENTITY(instance_array));
+    extents = adg_entity_get_extents(ADG_ENTITY(instance_array));
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 2);
+    adg_assert_isapprox(extents->size.y, 3);
+
+    adg_instance_array_clear(instance_array);
+    g_assert_cmpuint(adg_instance_array_get_n_matrices(instance_array), ==, 0);
+
+    adg_entity_destroy(ADG_ENTITY(instance_array));
+}
+
+static void
+_adg_method_add_linear(void)
+{
+    AdgInstanceArray *instance_array;
+    const CpmlExtents *extents;
+
+    instance_array = _adg_instance_array_with_segment(0, 0, 1, 1);
+
+    adg_instance_array_add_linear(instance_array, 3, 10, 0);
+    g_assert_cmpuint(adg_instance_array_get_n_matrices(instance_array), ==, 3);
+
+    adg_entity_arrange(ADG_ENTITY(instance_array));
+    extents = adg_entity_get_extents(ADG_ENTITY(instance_array));
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, 0);
+    adg_assert_isapprox(extents->org.y, 0);
+    adg_assert_isapprox(extents->size.x, 21);
+    adg_assert_isapprox(extents->size.y, 1);
+
+    adg_entity_destroy(ADG_ENTITY(instance_array));
+}
+
+static void
+_adg_method_add_polar(void)
+{
+    AdgInstanceArray *instance_array;
+    CpmlPair center;
+    const CpmlExtents *extents;
+
+    instance_array = _adg_instance_array_with_segment(1, 0, 2, 0);
+    center.x = 0;
+    center.y = 0;
+
+    adg_instance_array_add_polar(instance_array, 4, &center, G_PI_2);
+    g_assert_cmpuint(adg_instance_array_get_n_matrices(instance_array), ==, 4);
+
+    adg_entity_arrange(ADG_ENTITY(instance_array));
+    extents = adg_entity_get_extents(ADG_ENTITY(instance_array));
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, -2);
+    adg_assert_isapprox(extents->org.y, -2);
+    adg_assert_isapprox(extents->size.x, 4);
+    adg_assert_isapprox(extents->size.y, 4);
+
+    adg_entity_destroy(ADG_ENTITY(instance_array));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    adg_test_add_object_checks("/adg/instance-array/type/object", ADG_TYPE_INSTANCE_ARRAY);
+    adg_test_add_entity_checks("/adg/instance-array/type/entity", ADG_TYPE_INSTANCE_ARRAY);
+    adg_test_add_container_checks("/adg/instance-array/type/container", ADG_TYPE_INSTANCE_ARRAY);
+
+    g_test_add_func("/adg/instance-array/method/add-matrix", _adg_method_add_matrix);
+    g_test_add_func("/adg/instance-array/method/add-linear", _adg_method_add_linear);
+    g_test_add_func("/adg/instance-array/method/add-polar", _adg_method_add_polar);
+
+    return g_test_run();
+}
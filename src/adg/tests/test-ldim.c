@@ -158,6 +158,50 @@ _adg_property_has_extension2(void)
 
     adg_entity_destroy(ADG_ENTITY(ldim));
 }
+static void
+_adg_method_geometry_changed(void)
+{
+    AdgModel *model;
+    AdgLDim *ldim;
+    AdgEntity *quote;
+    CpmlPair pair;
+    CpmlExtents extents;
+
+    model = ADG_MODEL(adg_path_new());
+    pair.x = 0;
+    pair.y = 0;
+    adg_model_set_named_pair(model, "ref1", &pair);
+    pair.x = 10;
+    adg_model_set_named_pair(model, "ref2", &pair);
+    pair.y = 5;
+    adg_model_set_named_pair(model, "pos", &pair);
+
+    ldim = adg_ldim_new_full_from_model(model, "ref1", "ref2", "pos", 0);
+    adg_entity_arrange(ADG_ENTITY(ldim));
+    quote = (AdgEntity *) adg_dim_get_quote(ADG_DIM(ldim));
+    g_assert_nonnull(quote);
+    cpml_extents_copy(&extents, adg_entity_get_extents(ADG_ENTITY(ldim)));
+    g_assert_true(extents.is_defined);
+
+    /* Moving a named pair must keep the quote around */
+    pair.x = 20;
+    pair.y = 0;
+    adg_model_set_named_pair(model, "ref2", &pair);
+    adg_model_changed(model);
+    g_assert_false(adg_entity_get_extents(ADG_ENTITY(ldim))->is_defined);
+
+    adg_entity_arrange(ADG_ENTITY(ldim));
+    g_assert_true(adg_dim_get_quote(ADG_DIM(ldim)) == (AdgAlignment *) quote);
+    g_assert_true(adg_entity_get_extents(ADG_ENTITY(ldim))->is_defined);
+    g_assert_cmpfloat(adg_entity_get_extents(ADG_ENTITY(ldim))->size.x, >, extents.size.x);
+
+    /* A geometric change must reset the extents */
+    adg_entity_geometry_changed(ADG_ENTITY(ldim));
+    g_assert_false(adg_entity_get_extents(ADG_ENTITY(ldim))->is_defined);
+
+    adg_entity_destroy(ADG_ENTITY(ldim));
+    g_object_unref(model);
+}
 
 
 int
@@ -179,5 +223,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/ldim/property/has-extension1", _adg_property_has_extension1);
     g_test_add_func("/adg/ldim/property/has-extension2", _adg_property_has_extension2);
 
+    g_test_add_func("/adg/ldim/method/geometry-changed", _adg_method_geometry_changed);
+
     return g_test_run();
 }
@@ -20,6 +20,7 @@
 
 #include <adg-test.h>
 #include <adg.h>
+#include <string.h>
 
 
 static void
@@ -144,6 +145,46 @@ _adg_property_symbol_dress(void)
 
     adg_entity_destroy(ADG_ENTITY(logo));
 }
+static void
+_adg_method_render(void)
+{
+    AdgLogo *logo1, *logo2;
+    cairo_surface_t *surface1, *surface2;
+    cairo_t *cr;
+    cairo_matrix_t map;
+
+    logo1 = adg_logo_new();
+    logo2 = adg_logo_new();
+    cairo_matrix_init_translate(&map, 10, 10);
+    adg_entity_set_global_map(ADG_ENTITY(logo2), &map);
+
+    surface1 = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 80, 60);
+    cr = cairo_create(surface1);
+    cairo_translate(cr, 10, 10);
+    adg_entity_arrange(ADG_ENTITY(logo1));
+    adg_entity_render(ADG_ENTITY(logo1), cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+    cairo_destroy(cr);
+
+    /* The second logo replays the recording of the first one */
+    surface2 = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 80, 60);
+    cr = cairo_create(surface2);
+    adg_entity_arrange(ADG_ENTITY(logo2));
+    adg_entity_render(ADG_ENTITY(logo2), cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+    cairo_destroy(cr);
+
+    cairo_surface_flush(surface1);
+    cairo_surface_flush(surface2);
+    g_assert_cmpint(memcmp(cairo_image_surface_get_data(surface1),
+                           cairo_image_surface_get_data(surface2),
+                           cairo_image_surface_get_stride(surface1) * 60), ==, 0);
+
+    cairo_surface_destroy(surface1);
+    cairo_surface_destroy(surface2);
+    adg_entity_destroy(ADG_ENTITY(logo1));
+    adg_entity_destroy(ADG_ENTITY(logo2));
+}
 
 
 int
@@ -161,5 +202,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/logo/property/screen-dress", _adg_property_screen_dress);
     g_test_add_func("/adg/logo/property/symbol-dress", _adg_property_symbol_dress);
 
+    g_test_add_func("/adg/logo/method/render", _adg_method_render);
+
     return g_test_run();
 }
@@ -49,6 +49,147 @@ _adg_property_named_pair(void)
     g_object_unref(model);
 }
 
+static void
+_adg_method_set_named_pairs(void)
+{
+    AdgModel *model;
+    const gchar *names[] = { "First", NULL, "Third" };
+    gdouble coords[] = { 1, 2, 3, 4, 5, 6 };
+    const CpmlPair *named_pair;
+
+    model = ADG_MODEL(adg_path_new());
+
+    /* Sanity checks */
+    adg_model_set_named_pairs(NULL, names, 3, coords, 6);
+    adg_model_set_named_pairs(model, names, 3, coords, 4);
+    g_assert_null(adg_model_get_named_pair(model, "First"));
+
+    adg_model_set_named_pairs(model, names, 3, coords, 6);
+
+    named_pair = adg_model_get_named_pair(model, "First");
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 1);
+    adg_assert_isapprox(named_pair->y, 2);
+
+    /* NULL names are skipped without shifting the coordinates */
+    named_pair = adg_model_get_named_pair(model, "Third");
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 5);
+    adg_assert_isapprox(named_pair->y, 6);
+
+    g_object_unref(model);
+}
+
+static void
+_adg_method_import_named_pairs(void)
+{
+    AdgModel *model, *copy;
+    const gchar *names[] = { "First", NULL, "Third" };
+    CpmlPair pairs[] = { { 1, 2 }, { 3, 4 }, { 5, 6 } };
+    const gchar **exported_names;
+    CpmlPair *exported_pairs;
+    const CpmlPair *named_pair;
+    guint n;
+
+    model = ADG_MODEL(adg_path_new());
+
+    /* Sanity checks */
+    adg_model_import_named_pairs(NULL, names, pairs, 3);
+    adg_model_import_named_pairs(model, NULL, pairs, 3);
+    g_assert_cmpuint(adg_model_export_named_pairs(NULL, NULL, NULL), ==, 0);
+    g_assert_cmpuint(adg_model_export_named_pairs(model, NULL, NULL), ==, 0);
+
+    adg_test_signal(model, "changed");
+    adg_model_import_named_pairs(model, names, pairs, 3);
+    g_assert_true(adg_test_signal_check(TRUE));
+
+    named_pair = adg_model_get_named_pair(model, "First");
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 1);
+    adg_assert_isapprox(named_pair->y, 2);
+
+    named_pair = adg_model_get_named_pair(model, "Third");
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 5);
+    adg_assert_isapprox(named_pair->y, 6);
+
+    /* Export and import on another model */
+    n = adg_model_export_named_pairs(model, &exported_names, &exported_pairs);
+    g_assert_cmpuint(n, ==, 2);
+    g_assert_cmpstr(exported_names[0], ==, "First");
+    g_assert_cmpstr(exported_names[1], ==, "Third");
+    adg_assert_isapprox(exported_pairs[1].x, 5);
+    adg_assert_isapprox(exported_pairs[1].y, 6);
+
+    copy = ADG_MODEL(adg_path_new());
+    adg_model_import_named_pairs(copy, exported_names, exported_pairs, n);
+    named_pair = adg_model_get_named_pair(copy, "Third");
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 5);
+
+    g_free(exported_names);
+    g_free(exported_pairs);
+    g_object_unref(copy);
+    g_object_unref(model);
+}
+
+static void
+_adg_method_get_named_pair_by_quark(void)
+{
+    AdgModel *model;
+    CpmlPair pair;
+    const CpmlPair *named_pair;
+    GQuark quark;
+    guint slot;
+
+    model = ADG_MODEL(adg_path_new());
+    pair.x = 1;
+    pair.y = 2;
+
+    adg_model_set_named_pair(model, "First", &pair);
+    pair.x = 3;
+    adg_model_set_named_pair(model, "Second", &pair);
+
+    quark = g_quark_from_string("Second");
+
+    /* A wrong hint must be fixed */
+    slot = 1234;
+    named_pair = adg_model_get_named_pair_by_quark(model, quark, &slot);
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 3);
+    g_assert_cmpuint(slot, ==, 1);
+
+    named_pair = adg_model_get_named_pair_by_quark(model, quark, &slot);
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 3);
+
+    named_pair = adg_model_get_named_pair_by_quark(model, quark, NULL);
+    g_assert_nonnull(named_pair);
+
+    named_pair = adg_model_get_named_pair_by_quark(model, 0, &slot);
+    g_assert_null(named_pair);
+
+    /* Removed named pairs must not be found, even with a valid hint */
+    adg_model_set_named_pair(model, "Second", NULL);
+    named_pair = adg_model_get_named_pair_by_quark(model, quark, &slot);
+    g_assert_null(named_pair);
+    g_assert_null(adg_model_get_named_pair(model, "Second"));
+
+    /* Defining it again must reuse the same slot */
+    pair.x = 5;
+    adg_model_set_named_pair(model, "Second", &pair);
+    named_pair = adg_model_get_named_pair_by_quark(model, quark, &slot);
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 5);
+    g_assert_cmpuint(slot, ==, 1);
+
+    adg_model_reset(model);
+    named_pair = adg_model_get_named_pair_by_quark(model, quark, &slot);
+    g_assert_null(named_pair);
+
+    g_object_unref(model);
+}
+
 static void
 _adg_property_dependency(void)
 {
@@ -100,10 +241,146 @@ _adg_property_dependency(void)
     dependencies = adg_model_get_dependencies(model);
     g_assert_null(dependencies);
 
+    /* Adding the same entity twice must keep only one dependency,
+     * that is dropped only after the second removal */
+    adg_model_add_dependency(model, valid_entity);
+    adg_model_add_dependency(model, valid_entity);
+    dependencies = adg_model_get_dependencies(model);
+    g_assert_nonnull(dependencies);
+    g_assert_cmpuint(g_slist_length((GSList *) dependencies), ==, 1);
+
+    adg_model_remove_dependency(model, valid_entity);
+    dependencies = adg_model_get_dependencies(model);
+    g_assert_nonnull(dependencies);
+    g_assert_true(dependencies->data == valid_entity);
+
+    adg_model_remove_dependency(model, valid_entity);
+    dependencies = adg_model_get_dependencies(model);
+    g_assert_null(dependencies);
+
     g_object_unref(model);
     adg_entity_destroy(valid_entity);
 }
 
+static void
+_adg_invalidate_counter(AdgEntity *entity, gpointer user_data)
+{
+    ++ *((gint *) user_data);
+}
+
+static void
+_adg_method_freeze_changes(void)
+{
+    AdgModel *model1, *model2;
+    AdgEntity *entity;
+    gint counter;
+
+    model1 = ADG_MODEL(adg_path_new());
+    model2 = ADG_MODEL(adg_path_new());
+    entity = ADG_ENTITY(adg_logo_new());
+    counter = 0;
+
+    g_signal_connect(entity, "invalidate",
+                     G_CALLBACK(_adg_invalidate_counter), &counter);
+
+    adg_model_add_dependency(model1, entity);
+    adg_model_add_dependency(model2, entity);
+
+    /* Without a batch, every change invalidates the entity */
+    adg_model_changed(model1);
+    adg_model_changed(model2);
+    g_assert_cmpint(counter, ==, 2);
+
+    /* Inside a batch, the entity is invalidated only once at the end */
+    counter = 0;
+    adg_model_freeze_changes();
+    adg_model_changed(model1);
+    adg_model_changed(model2);
+    adg_model_freeze_changes();
+    adg_model_changed(model1);
+    adg_model_thaw_changes();
+    g_assert_cmpint(counter, ==, 0);
+    adg_model_thaw_changes();
+    g_assert_cmpint(counter, ==, 1);
+
+    /* An empty batch does not invalidate anything */
+    adg_model_freeze_changes();
+    adg_model_thaw_changes();
+    g_assert_cmpint(counter, ==, 1);
+
+    adg_model_remove_dependency(model1, entity);
+    adg_model_remove_dependency(model2, entity);
+    g_object_unref(model1);
+    g_object_unref(model2);
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_method_named_dependency(void)
+{
+    AdgModel *model;
+    AdgEntity *entity1, *entity2;
+    gint counter1, counter2;
+
+    model = ADG_MODEL(adg_path_new());
+    entity1 = ADG_ENTITY(adg_logo_new());
+    entity2 = ADG_ENTITY(adg_logo_new());
+    counter1 = 0;
+    counter2 = 0;
+
+    g_signal_connect(entity1, "invalidate",
+                     G_CALLBACK(_adg_invalidate_counter), &counter1);
+    g_signal_connect(entity2, "invalidate",
+                     G_CALLBACK(_adg_invalidate_counter), &counter2);
+
+    adg_model_set_named_pair_explicit(model, "A", 1, 2);
+    adg_model_set_named_pair_explicit(model, "B", 3, 4);
+    adg_model_add_named_dependency(model, entity1, "A");
+    adg_model_add_named_dependency(model, entity2, "B");
+    adg_model_changed(model);
+    counter1 = counter2 = 0;
+
+    /* Unchanged named pairs do not invalidate anything */
+    adg_model_changed(model);
+    g_assert_cmpint(counter1, ==, 0);
+    g_assert_cmpint(counter2, ==, 0);
+
+    /* Only the entity bound to "A" must be invalidated */
+    adg_model_set_named_pair_explicit(model, "A", 5, 6);
+    adg_model_changed(model);
+    g_assert_cmpint(counter1, ==, 1);
+    g_assert_cmpint(counter2, ==, 0);
+
+    /* Redefining the same values after a reset is not a change */
+    adg_model_reset(model);
+    adg_model_set_named_pair_explicit(model, "A", 5, 6);
+    adg_model_set_named_pair_explicit(model, "B", 3, 4);
+    adg_model_changed(model);
+    g_assert_cmpint(counter1, ==, 1);
+    g_assert_cmpint(counter2, ==, 0);
+
+    /* Undefining a named pair is a change */
+    adg_model_set_named_pair(model, "B", NULL);
+    adg_model_changed(model);
+    g_assert_cmpint(counter1, ==, 1);
+    g_assert_cmpint(counter2, ==, 1);
+
+    /* An unnamed dependency is always invalidated */
+    adg_model_add_dependency(model, entity1);
+    adg_model_changed(model);
+    g_assert_cmpint(counter1, ==, 2);
+    g_assert_cmpint(counter2, ==, 1);
+
+    adg_model_remove_dependency(model, entity1);
+    adg_model_remove_named_dependency(model, entity1, "A");
+    adg_model_remove_named_dependency(model, entity2, "B");
+    g_assert_null(adg_model_get_dependencies(model));
+
+    g_object_unref(model);
+    adg_entity_destroy(entity1);
+    adg_entity_destroy(entity2);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -115,6 +392,11 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/model/named-pair", _adg_property_named_pair);
     g_test_add_func("/adg/model/dependency", _adg_property_dependency);
+    g_test_add_func("/adg/model/method/set-named-pairs", _adg_method_set_named_pairs);
+    g_test_add_func("/adg/model/method/import-named-pairs", _adg_method_import_named_pairs);
+    g_test_add_func("/adg/model/method/get-named-pair-by-quark", _adg_method_get_named_pair_by_quark);
+    g_test_add_func("/adg/model/method/freeze-changes", _adg_method_freeze_changes);
+    g_test_add_func("/adg/model/method/named-dependency", _adg_method_named_dependency);
 
     return g_test_run();
 }
@@ -0,0 +1,175 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <config.h>
+#include <adg-test.h>
+#include <adg.h>
+#include <glib/gstdio.h>
+
+
+static void
+_adg_type_boxed(void)
+{
+    /* A package cannot be built without a file, so only the type is checked */
+    g_assert_true(G_TYPE_IS_BOXED(ADG_TYPE_PACKAGE));
+}
+
+static void
+_adg_method_save(void)
+{
+    AdgCanvas *canvases[2];
+    gchar *file;
+    GError *error;
+
+    canvases[0] = adg_test_canvas();
+    canvases[1] = adg_test_canvas();
+    file = g_build_filename(g_get_tmp_dir(), "adg-test-package.save", NULL);
+
+    /* Sanity checks */
+    g_assert_false(adg_package_save(2, NULL, file, NULL));
+    g_assert_false(adg_package_save(2, canvases, NULL, NULL));
+    g_assert_null(adg_package_open(NULL, NULL));
+
+#ifdef SNAPSHOT_ENABLED
+    g_assert_true(adg_package_save(2, canvases, file, NULL));
+    g_assert_true(g_file_test(file, G_FILE_TEST_IS_REGULAR));
+
+    /* An empty package is still valid */
+    g_assert_true(adg_package_save(0, NULL, file, NULL));
+    g_assert_true(g_file_test(file, G_FILE_TEST_IS_REGULAR));
+    g_remove(file);
+#else
+    error = NULL;
+    g_assert_false(adg_package_save(2, canvases, file, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT);
+    g_error_free(error);
+    g_assert_false(g_file_test(file, G_FILE_TEST_EXISTS));
+#endif
+
+    /* Missing files must be reported */
+    error = NULL;
+    g_assert_null(adg_package_open(file, &error));
+    g_assert_nonnull(error);
+    g_error_free(error);
+
+    g_free(file);
+    adg_entity_destroy(ADG_ENTITY(canvases[0]));
+    adg_entity_destroy(ADG_ENTITY(canvases[1]));
+}
+
+static void
+_adg_method_render(void)
+{
+#ifdef SNAPSHOT_ENABLED
+    AdgCanvas *canvases[2];
+    AdgPackage *package;
+    gchar *file;
+    GError *error;
+    CpmlPair size;
+    CpmlExtents region;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    guint n_loaded;
+
+    canvases[0] = adg_test_canvas();
+    canvases[1] = adg_test_canvas();
+    file = g_build_filename(g_get_tmp_dir(), "adg-test-package.render", NULL);
+    g_assert_true(adg_package_save(2, canvases, file, NULL));
+    adg_entity_destroy(ADG_ENTITY(canvases[0]));
+    adg_entity_destroy(ADG_ENTITY(canvases[1]));
+
+    package = adg_package_open(file, NULL);
+    g_assert_nonnull(package);
+
+    /* Opening must not decode anything */
+    g_assert_cmpuint(adg_package_get_n_sheets(package), ==, 2);
+    g_assert_cmpuint(adg_package_get_n_loaded(package), ==, 0);
+
+    g_assert_true(adg_package_put_sheet_size(package, 1, &size));
+    g_assert_cmpfloat(size.x, >, 0);
+    g_assert_cmpfloat(size.y, >, 0);
+    g_assert_false(adg_package_put_sheet_size(package, 2, &size));
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size.x, size.y);
+    cr = cairo_create(surface);
+
+    /* Hiding every layer renders nothing */
+    g_assert_true(adg_package_render(package, 0, 0xffffffff, NULL, cr, NULL));
+    g_assert_cmpuint(adg_package_get_n_loaded(package), ==, 0);
+
+    /* A region decodes only the overlapping sections */
+    region.is_defined = TRUE;
+    region.org.x = 0;
+    region.org.y = 0;
+    region.size.x = 1;
+    region.size.y = 1;
+    g_assert_true(adg_package_render(package, 0, 0, &region, cr, NULL));
+    n_loaded = adg_package_get_n_loaded(package);
+    g_assert_cmpuint(n_loaded, >, 0);
+
+    /* The whole sheet decodes everything, reusing the cached sections */
+    g_assert_true(adg_package_render(package, 0, 0, NULL, cr, NULL));
+    g_assert_cmpuint(adg_package_get_n_loaded(package), >=, n_loaded);
+    n_loaded = adg_package_get_n_loaded(package);
+    g_assert_true(adg_package_render(package, 0, 0, NULL, cr, NULL));
+    g_assert_cmpuint(adg_package_get_n_loaded(package), ==, n_loaded);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+
+    /* Releasing a sheet drops only its sections */
+    g_assert_true(adg_package_render(package, 1, 0, NULL, cr, NULL));
+    adg_package_release(package, 0);
+    g_assert_cmpuint(adg_package_get_n_loaded(package), ==, n_loaded);
+    adg_package_release(package, 1);
+    g_assert_cmpuint(adg_package_get_n_loaded(package), ==, 0);
+
+    error = NULL;
+    g_assert_false(adg_package_render(package, 2, 0, NULL, cr, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT);
+    g_error_free(error);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_package_unref(package);
+
+    /* Garbage must be refused */
+    g_assert_true(g_file_set_contents(file, "Not a package", -1, NULL));
+    error = NULL;
+    g_assert_null(adg_package_open(file, &error));
+    g_assert_error(error, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SNAPSHOT);
+    g_error_free(error);
+
+    g_remove(file);
+    g_free(file);
+#endif
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/adg/package/type/boxed", _adg_type_boxed);
+
+    g_test_add_func("/adg/package/method/save", _adg_method_save);
+    g_test_add_func("/adg/package/method/render", _adg_method_render);
+
+    return g_test_run();
+}
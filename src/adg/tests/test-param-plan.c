@@ -0,0 +1,136 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+
+
+static void
+_adg_changed(AdgModel *model, gint *counter)
+{
+    ++*counter;
+}
+
+static void
+_adg_behavior_misc(void)
+{
+    AdgParamPlan *plan, *dup_plan;
+    AdgPath *body, *axis;
+    CpmlPair pair;
+    const CpmlPair *named_pair;
+    guint n_primitive;
+    gint body_changes, axis_changes;
+
+    /* A rectangle (A x D) with its diameter on a named pair */
+    body = adg_path_new();
+    adg_path_move_to_explicit(body, 0, 5);
+    adg_path_line_to_explicit(body, 20, 5);
+    n_primitive = adg_path_get_n_primitives(body);
+    adg_path_line_to_explicit(body, 20, -5);
+    adg_path_line_to_explicit(body, 0, -5);
+    adg_path_close(body);
+    adg_model_set_named_pair_explicit(ADG_MODEL(body), "D", 20, 5);
+    g_assert_cmpuint(n_primitive, ==, 1);
+    g_assert_cmpuint(adg_path_get_n_primitives(body), ==, 4);
+
+    axis = adg_path_new();
+    adg_path_move_to_explicit(axis, -1, 0);
+    adg_path_line_to_explicit(axis, 21, 0);
+
+    body_changes = axis_changes = 0;
+    g_signal_connect(body, "changed", G_CALLBACK(_adg_changed), &body_changes);
+    g_signal_connect(axis, "changed", G_CALLBACK(_adg_changed), &axis_changes);
+
+    plan = adg_param_plan_new();
+    g_assert_nonnull(plan);
+    adg_param_plan_add_param(plan, "A", 20);
+    adg_param_plan_add_param(plan, "D", 10);
+    g_assert_true(adg_param_plan_set_param(plan, "A", 20));
+    g_assert_false(adg_param_plan_set_param(plan, "unknown", 1));
+    adg_assert_isapprox(adg_param_plan_get_param(plan, "D"), 10);
+
+    /* Primitive 1 goes from (20, 5) to (20, -5) */
+    adg_param_plan_link_point(plan, body, n_primitive, 0, "A", 1, 0);
+    adg_param_plan_link_point(plan, body, n_primitive, 0, "D", 0, 0.5);
+    adg_param_plan_link_point(plan, body, n_primitive, -1, "A", 1, 0);
+    adg_param_plan_link_point(plan, body, n_primitive, -1, "D", 0, -0.5);
+    adg_param_plan_link_named_pair(plan, ADG_MODEL(body), "D", "A", 1, 0);
+    adg_param_plan_link_named_pair(plan, ADG_MODEL(body), "D", "D", 0, 0.5);
+    adg_param_plan_link_point(plan, axis, 0, -1, "A", 1, 0);
+    g_assert_true(adg_param_plan_compile(plan));
+
+    /* Nothing changed: nothing to update */
+    g_assert_cmpuint(adg_param_plan_update(plan), ==, 0);
+    g_assert_cmpint(body_changes, ==, 0);
+
+    /* Changing D must leave the axis alone */
+    adg_param_plan_set_param(plan, "D", 12);
+    g_assert_cmpuint(adg_param_plan_update(plan), ==, 1);
+    g_assert_cmpint(body_changes, ==, 1);
+    g_assert_cmpint(axis_changes, ==, 0);
+    g_assert_true(adg_path_put_point(body, n_primitive, 0, &pair));
+    adg_assert_isapprox(pair.x, 20);
+    adg_assert_isapprox(pair.y, 6);
+    g_assert_true(adg_path_put_point(body, n_primitive, -1, &pair));
+    adg_assert_isapprox(pair.x, 20);
+    adg_assert_isapprox(pair.y, -6);
+    named_pair = adg_model_get_named_pair(ADG_MODEL(body), "D");
+    adg_assert_isapprox(named_pair->x, 20);
+    adg_assert_isapprox(named_pair->y, 6);
+
+    /* Changing A affects both models, each notified once */
+    adg_param_plan_set_param(plan, "A", 30);
+    g_assert_cmpuint(adg_param_plan_update(plan), ==, 2);
+    g_assert_cmpint(body_changes, ==, 2);
+    g_assert_cmpint(axis_changes, ==, 1);
+    g_assert_true(adg_path_put_point(axis, 0, -1, &pair));
+    adg_assert_isapprox(pair.x, 31);
+    adg_assert_isapprox(pair.y, 0);
+    named_pair = adg_model_get_named_pair(ADG_MODEL(body), "D");
+    adg_assert_isapprox(named_pair->x, 30);
+    adg_assert_isapprox(adg_trail_get_extents(ADG_TRAIL(body))->size.x, 30);
+
+    /* A duplicated plan keeps working on the same models */
+    dup_plan = adg_param_plan_dup(plan);
+    adg_param_plan_destroy(plan);
+    adg_assert_isapprox(adg_param_plan_get_param(dup_plan, "A"), 30);
+    adg_param_plan_set_param(dup_plan, "A", 20);
+    g_assert_cmpuint(adg_param_plan_update(dup_plan), ==, 2);
+    g_assert_true(adg_path_put_point(body, n_primitive, 0, &pair));
+    adg_assert_isapprox(pair.x, 20);
+    adg_assert_isapprox(pair.y, 6);
+    adg_param_plan_destroy(dup_plan);
+
+    g_object_unref(body);
+    g_object_unref(axis);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    adg_test_add_boxed_checks("/adg/param-plan/type/boxed", ADG_TYPE_PARAM_PLAN, adg_param_plan_new());
+
+    g_test_add_func("/adg/param-plan/behavior/misc", _adg_behavior_misc);
+
+    return g_test_run();
+}
@@ -20,8 +20,69 @@
 
 #include <adg-test.h>
 #include <adg.h>
+#include <math.h>
 
 
+static void
+_adg_behavior_extents(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    const CpmlExtents *extents;
+    CpmlExtents incremental;
+
+    path = adg_path_new();
+    trail = ADG_TRAIL(path);
+
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 2, 1);
+    extents = adg_trail_get_extents(trail);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 2);
+    adg_assert_isapprox(extents->size.y, 1);
+
+    /* Appended primitives enlarge the cached extents */
+    adg_path_line_to_explicit(path, 4, -1);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.y, -1);
+    adg_assert_isapprox(extents->size.x, 4);
+    adg_assert_isapprox(extents->size.y, 2);
+
+    adg_path_curve_to_explicit(path, 6, 3, 7, 3, 8, 0);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 8);
+    adg_assert_isapprox(extents->size.y, 3.138);
+
+    /* A lonely CPML_MOVE does not change the extents */
+    adg_path_move_to_explicit(path, 20, 20);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 8);
+
+    /* A chamfer modifies the previous primitive, so a full
+     * recomputation is expected */
+    adg_path_move_to_explicit(path, 10, 0);
+    adg_path_line_to_explicit(path, 12, 0);
+    extents = adg_trail_get_extents(trail);
+    adg_assert_isapprox(extents->size.x, 12);
+    adg_path_chamfer(path, 1, 1);
+    adg_path_line_to_explicit(path, 12, 2);
+    g_assert_false(extents->is_defined);
+    extents = adg_trail_get_extents(trail);
+    adg_assert_isapprox(extents->size.x, 12);
+    adg_assert_isapprox(extents->size.y, 3.138);
+
+    /* The incremental result must match a full recomputation */
+    adg_path_line_to_explicit(path, 14, 4);
+    g_assert_true(extents->is_defined);
+    cpml_extents_copy(&incremental, extents);
+    adg_model_changed(ADG_MODEL(path));
+    extents = adg_trail_get_extents(trail);
+    g_assert_true(cpml_pair_equal(&extents->org, &incremental.org));
+    g_assert_true(cpml_pair_equal(&extents->size, &incremental.size));
+
+    g_object_unref(path);
+}
+
 static void
 _adg_method_get_current_point(void)
 {
@@ -323,6 +384,121 @@ _adg_method_append_primitive(void)
     g_object_unref(path);
 }
 
+static void
+_adg_method_append_points(void)
+{
+    AdgPath *path;
+    cairo_path_t *cairo_path;
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    guint8 types[] = {
+        CPML_MOVE,
+        CPML_LINE | ADG_JOINT_CHAMFER,
+        CPML_LINE | ADG_JOINT_FILLET,
+        CPML_LINE
+    };
+    CpmlPair pairs[] = {
+        { 0, 0 }, { 0, 8 }, { 10, 8 }, { 10, 0 }
+    };
+    gdouble values[] = { 2, 3, 1 };
+
+    path = adg_path_new();
+
+    /* Sanity checks */
+    adg_path_append_points(NULL, types, G_N_ELEMENTS(types), pairs, values);
+    adg_path_append_points(path, NULL, 1, pairs, values);
+    adg_path_append_points(path, types, 0, NULL, NULL);
+    g_assert_null(adg_path_last_primitive(path));
+
+    adg_path_append_points(path, types, G_N_ELEMENTS(types), pairs, values);
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(path));
+    g_assert_nonnull(cairo_path);
+    g_assert_true(cpml_segment_from_cairo(&segment, cairo_path));
+
+    /* Chamfered line */
+    cpml_primitive_from_segment(&primitive, &segment);
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(primitive.data[1].point.x, 0);
+    adg_assert_isapprox(primitive.data[1].point.y, 6);
+
+    /* Chamfer */
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(primitive.data[1].point.x, 3);
+    adg_assert_isapprox(primitive.data[1].point.y, 8);
+
+    /* Filleted line */
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(primitive.data[1].point.x, 9);
+    adg_assert_isapprox(primitive.data[1].point.y, 8);
+
+    /* Fillet */
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_ARC);
+    adg_assert_isapprox(primitive.data[2].point.x, 10);
+    adg_assert_isapprox(primitive.data[2].point.y, 7);
+
+    /* Last line */
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(primitive.data[1].point.x, 10);
+    adg_assert_isapprox(primitive.data[1].point.y, 0);
+    g_assert_false(cpml_primitive_next(&primitive));
+
+    /* Joints without values must fail */
+    adg_model_clear(ADG_MODEL(path));
+    adg_path_append_points(path, types, G_N_ELEMENTS(types), pairs, NULL);
+    g_assert_nonnull(adg_path_last_primitive(path));
+    adg_assert_isapprox(adg_path_get_current_point(path)->y, 8);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_method_append_coords(void)
+{
+    AdgPath *path;
+    guint8 types[] = {
+        CPML_MOVE,
+        CPML_LINE | ADG_JOINT_CHAMFER,
+        CPML_LINE,
+        CPML_CLOSE
+    };
+    gdouble coords[] = { 0, 0, 0, 8, 10, 8 };
+    gdouble values[] = { 2, 3 };
+
+    path = adg_path_new();
+
+    /* Sanity checks */
+    adg_path_append_coords(NULL, types, G_N_ELEMENTS(types),
+                           coords, G_N_ELEMENTS(coords),
+                           values, G_N_ELEMENTS(values));
+    adg_path_append_coords(path, NULL, 1, coords, G_N_ELEMENTS(coords),
+                           values, G_N_ELEMENTS(values));
+    adg_path_append_coords(path, types, 0, NULL, 0, NULL, 0);
+    g_assert_null(adg_path_last_primitive(path));
+
+    /* Mismatching sizes must not append anything */
+    adg_path_append_coords(path, types, G_N_ELEMENTS(types),
+                           coords, G_N_ELEMENTS(coords) - 2,
+                           values, G_N_ELEMENTS(values));
+    g_assert_null(adg_path_last_primitive(path));
+    adg_path_append_coords(path, types, G_N_ELEMENTS(types),
+                           coords, G_N_ELEMENTS(coords), values, 1);
+    g_assert_null(adg_path_last_primitive(path));
+
+    adg_path_append_coords(path, types, G_N_ELEMENTS(types),
+                           coords, G_N_ELEMENTS(coords),
+                           values, G_N_ELEMENTS(values));
+
+    /* Chamfered line, chamfer, line and close */
+    g_assert_cmpuint(adg_path_get_n_primitives(path), ==, 4);
+    g_assert_cmpint(adg_path_last_primitive(path)->data[0].header.type, ==, CPML_CLOSE);
+
+    g_object_unref(path);
+}
+
 static void
 _adg_method_append_segment(void)
 {
@@ -464,10 +640,110 @@ _adg_method_append_trail(void)
     g_object_unref(path);
 }
 
+static void
+_adg_method_set_point(void)
+{
+    AdgPath *path;
+    CpmlPair pair;
+
+    path = adg_path_new();
+
+    /* Sanity check */
+    g_assert_cmpuint(adg_path_get_n_primitives(NULL), ==, 0);
+    g_assert_false(adg_path_put_point(NULL, 0, 0, &pair));
+    g_assert_false(adg_path_set_point(path, 0, 0, NULL));
+    g_assert_false(adg_path_put_point(path, 0, 0, &pair));
+
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+    g_assert_cmpuint(adg_path_get_n_primitives(path), ==, 2);
+    g_assert_false(adg_path_put_point(path, 2, 0, &pair));
+
+    /* The origin of a primitive is the end of the previous one */
+    pair.x = 3;
+    pair.y = 0;
+    g_assert_true(adg_path_set_point(path, 1, 0, &pair));
+    g_assert_true(adg_path_put_point(path, 0, -1, &pair));
+    adg_assert_isapprox(pair.x, 3);
+    adg_assert_isapprox(pair.y, 0);
+
+    /* Moving the last point moves the current point too */
+    pair.x = 3;
+    pair.y = 4;
+    g_assert_true(adg_path_set_point(path, 1, -1, &pair));
+    adg_assert_isapprox(adg_path_get_current_point(path)->x, 3);
+    adg_assert_isapprox(adg_path_get_current_point(path)->y, 4);
+    adg_assert_isapprox(adg_trail_get_extents(ADG_TRAIL(path))->size.y, 4);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_method_dup(void)
+{
+    AdgPath *path, *dup;
+    const cairo_path_t *cairo_path, *dup_cairo_path;
+    const CpmlPair *pair;
+
+    /* Sanity check */
+    g_assert_null(adg_path_dup(NULL));
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 2, 0);
+    adg_path_arc_to_explicit(path, 3, 1, 2, 2);
+    adg_path_chamfer(path, 0.5, 0.5);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "test", 1, 2);
+    adg_trail_set_max_angle(ADG_TRAIL(path), G_PI_4);
+
+    dup = adg_path_dup(path);
+    g_assert_nonnull(dup);
+    g_assert_true(dup != path);
+
+    /* Same primitives, arcs included, and same current point */
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(path));
+    dup_cairo_path = adg_trail_cairo_path(ADG_TRAIL(dup));
+    g_assert_cmpint(dup_cairo_path->num_data, ==, cairo_path->num_data);
+    g_assert_true(dup_cairo_path->data == cairo_path->data);
+    g_assert_true(adg_path_has_current_point(dup));
+    g_assert_nonnull(adg_path_last_primitive(dup));
+    g_assert_cmpint(adg_path_last_primitive(dup)->data[0].header.type, ==, CPML_ARC);
+
+    pair = adg_model_get_named_pair(ADG_MODEL(dup), "test");
+    g_assert_nonnull(pair);
+    adg_assert_isapprox(pair->x, 1);
+    adg_assert_isapprox(pair->y, 2);
+    adg_assert_isapprox(adg_trail_get_max_angle(ADG_TRAIL(dup)), G_PI_4);
+
+    /* Changing the copy must not affect the original path */
+    adg_path_line_to_explicit(dup, 2, 4);
+    g_assert_cmpint(adg_trail_cairo_path(ADG_TRAIL(dup))->num_data, >,
+                    adg_trail_cairo_path(ADG_TRAIL(path))->num_data);
+    g_assert_true(adg_trail_cairo_path(ADG_TRAIL(dup))->data !=
+                  adg_trail_cairo_path(ADG_TRAIL(path))->data);
+    g_assert_cmpint(adg_path_last_primitive(path)->data[0].header.type, ==, CPML_ARC);
+
+    /* The original path can be modified after releasing the copy */
+    g_object_unref(dup);
+    dup = adg_path_dup(path);
+    g_object_unref(dup);
+    adg_path_line_to_explicit(path, 0, 2);
+    g_assert_cmpint(adg_path_last_primitive(path)->data[0].header.type, ==, CPML_LINE);
+    dup = adg_path_dup(path);
+    adg_path_remove_primitive(path);
+    g_assert_cmpint(adg_path_last_primitive(dup)->data[0].header.type, ==, CPML_LINE);
+
+    g_object_unref(dup);
+    g_object_unref(path);
+}
+
 static void
 _adg_method_remove_primitive(void)
 {
     AdgPath *path;
+    const CpmlPrimitive *primitive;
+    const CpmlPair *cp;
     int n;
 
     path = adg_path_new();
@@ -487,6 +763,33 @@ _adg_method_remove_primitive(void)
     /* Ensure the current point is no more set */
     g_assert_false(adg_path_has_current_point(path));
 
+    /* Check last and over primitives are properly updated */
+    adg_model_clear(ADG_MODEL(path));
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+    adg_path_line_to_explicit(path, 2, 2);
+    adg_path_line_to_explicit(path, 3, 3);
+    adg_path_remove_primitive(path);
+
+    primitive = adg_path_last_primitive(path);
+    g_assert_nonnull(primitive);
+    adg_assert_isapprox(primitive->org->point.x, 1);
+    adg_assert_isapprox(primitive->data[1].point.x, 2);
+
+    primitive = adg_path_over_primitive(path);
+    g_assert_nonnull(primitive);
+    adg_assert_isapprox(primitive->org->point.x, 0);
+    adg_assert_isapprox(primitive->data[1].point.x, 1);
+
+    cp = adg_path_get_current_point(path);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 2);
+    adg_assert_isapprox(cp->y, 2);
+
+    adg_path_remove_primitive(path);
+    g_assert_nonnull(adg_path_last_primitive(path));
+    g_assert_null(adg_path_over_primitive(path));
+
     g_object_unref(path);
 }
 
@@ -784,11 +1087,253 @@ _adg_method_fillet(void)
 
     g_assert_false(cpml_primitive_next(&primitive));
 
-    /* TODO: perform more complex tests */
+    /* Fillet on an acute corner */
+    adg_model_reset(ADG_MODEL(path));
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_fillet(path, 1);
+    adg_path_line_to_explicit(path, 0, 10);
+
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(path));
+    g_assert_true(cpml_segment_from_cairo(&segment, cairo_path));
+    cpml_primitive_from_segment(&primitive, &segment);
+    adg_assert_isapprox(primitive.data[1].point.x, 7.586);
+    adg_assert_isapprox(primitive.data[1].point.y, 0);
+
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_ARC);
+    adg_assert_isapprox(primitive.data[1].point.x, 8.510);
+    adg_assert_isapprox(primitive.data[1].point.y, 0.617);
+    adg_assert_isapprox(primitive.data[2].point.x, 8.293);
+    adg_assert_isapprox(primitive.data[2].point.y, 1.707);
+
+    /* Fillet between an arc and a line */
+    adg_model_reset(ADG_MODEL(path));
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_arc_to_explicit(path, 5, 5, 10, 0);
+    adg_path_fillet(path, 1);
+    adg_path_line_to_explicit(path, 20, 0);
+
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(path));
+    g_assert_true(cpml_segment_from_cairo(&segment, cairo_path));
+    cpml_primitive_from_segment(&primitive, &segment);
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_ARC);
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_ARC);
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_LINE);
+    g_assert_false(cpml_primitive_next(&primitive));
 
     g_object_unref(path);
 }
 
+static void
+_adg_method_stitch(void)
+{
+    AdgPath *path;
+    cairo_path_t *cairo_path;
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlPair pair;
+
+    path = adg_path_new();
+
+    /* Sanity check */
+    g_assert_cmpuint(adg_path_stitch(NULL, 0.001), ==, 0);
+    g_assert_cmpuint(adg_path_stitch(path, -1), ==, 0);
+    g_assert_cmpuint(adg_path_stitch(path, 0.001), ==, 0);
+
+    /* A chain requiring a reversed segment and a near miss */
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    adg_path_move_to_explicit(path, 2, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    adg_path_move_to_explicit(path, 3, 3);
+    adg_path_line_to_explicit(path, 4, 4);
+    adg_path_move_to_explicit(path, 2, 0.0005);
+    adg_path_line_to_explicit(path, 2, 1);
+
+    /* A closed segment that must be left alone */
+    adg_path_move_to_explicit(path, 1, 0);
+    adg_path_line_to_explicit(path, 1, -1);
+    adg_path_line_to_explicit(path, 0, -1);
+    adg_path_close(path);
+
+    /* A chain growing backward */
+    adg_path_move_to_explicit(path, 10, 10);
+    adg_path_line_to_explicit(path, 11, 10);
+    adg_path_move_to_explicit(path, 9, 10);
+    adg_path_line_to_explicit(path, 10, 10);
+
+    g_assert_cmpuint(adg_path_stitch(path, 0.001), ==, 3);
+
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(path));
+    g_assert_true(cpml_segment_from_cairo(&segment, cairo_path));
+    cpml_primitive_from_segment(&primitive, &segment);
+    adg_assert_isapprox((primitive.org)->point.x, 0);
+    adg_assert_isapprox(primitive.data[1].point.x, 1);
+    g_assert_true(cpml_primitive_next(&primitive));
+    adg_assert_isapprox(primitive.data[1].point.x, 2);
+    adg_assert_isapprox(primitive.data[1].point.y, 0);
+    g_assert_true(cpml_primitive_next(&primitive));
+    adg_assert_isapprox(primitive.data[1].point.x, 2);
+    adg_assert_isapprox(primitive.data[1].point.y, 1);
+    g_assert_false(cpml_primitive_next(&primitive));
+
+    g_assert_true(cpml_segment_next(&segment));
+    cpml_primitive_from_segment(&primitive, &segment);
+    adg_assert_isapprox((primitive.org)->point.x, 3);
+    g_assert_false(cpml_primitive_next(&primitive));
+
+    g_assert_true(cpml_segment_next(&segment));
+    cpml_segment_put_pair_at(&segment, 0, &pair);
+    adg_assert_isapprox(pair.x, 1);
+    adg_assert_isapprox(pair.y, 0);
+
+    g_assert_true(cpml_segment_next(&segment));
+    cpml_primitive_from_segment(&primitive, &segment);
+    adg_assert_isapprox((primitive.org)->point.x, 9);
+    adg_assert_isapprox(primitive.data[1].point.x, 10);
+    g_assert_true(cpml_primitive_next(&primitive));
+    adg_assert_isapprox(primitive.data[1].point.x, 11);
+    g_assert_false(cpml_segment_next(&segment));
+
+    /* Nothing left to stitch */
+    g_assert_cmpuint(adg_path_stitch(path, 0.001), ==, 0);
+    adg_assert_isapprox(adg_path_get_current_point(path)->x, 11);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_method_simplify(void)
+{
+    AdgPath *path;
+    cairo_path_t *cairo_path;
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+
+    path = adg_path_new();
+
+    /* Sanity check */
+    adg_path_simplify(NULL, 0.01, FALSE);
+    adg_path_simplify(path, 0, FALSE);
+    adg_path_simplify(path, 0.01, FALSE);
+    g_assert_null(adg_path_last_primitive(path));
+
+    /* Collinear lines followed by a corner: only the corner survives */
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    adg_path_line_to_explicit(path, 2, 0);
+    adg_path_line_to_explicit(path, 3, 0);
+    adg_path_line_to_explicit(path, 3, 3);
+    adg_path_close(path);
+    adg_path_simplify(path, 0.01, FALSE);
+
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(path));
+    g_assert_cmpint(cairo_path->num_data, ==, 7);
+    g_assert_true(cpml_segment_from_cairo(&segment, cairo_path));
+    cpml_primitive_from_segment(&primitive, &segment);
+    adg_assert_isapprox((primitive.org)->point.x, 0);
+    adg_assert_isapprox(primitive.data[1].point.x, 3);
+    adg_assert_isapprox(primitive.data[1].point.y, 0);
+    g_assert_true(cpml_primitive_next(&primitive));
+    adg_assert_isapprox(primitive.data[1].point.x, 3);
+    adg_assert_isapprox(primitive.data[1].point.y, 3);
+    g_assert_true(cpml_primitive_next(&primitive));
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_CLOSE);
+    g_assert_false(cpml_primitive_next(&primitive));
+
+    /* Nothing left to simplify */
+    adg_path_simplify(path, 0.01, TRUE);
+    g_assert_cmpint(adg_trail_cairo_path(ADG_TRAIL(path))->num_data, ==, 7);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_method_fit_curves(void)
+{
+    AdgPath *path;
+    cairo_path_t *cairo_path;
+    CpmlPrimitive primitive;
+    CpmlSegment segment;
+    gint n;
+
+    path = adg_path_new();
+
+    /* Sanity check */
+    adg_path_fit_curves(NULL, 0.01);
+    adg_path_fit_curves(path, 0);
+    adg_path_fit_curves(path, 0.01);
+    g_assert_null(adg_path_last_primitive(path));
+
+    /* A dense arc of 50 lines is reduced to a few curves */
+    adg_path_move_to_explicit(path, 10, 0);
+    for (n = 1; n <= 50; ++n)
+        adg_path_line_to_explicit(path, cos(G_PI * n / 50) * 10,
+                                  sin(G_PI * n / 50) * 10);
+    adg_path_fit_curves(path, 0.01);
+
+    cairo_path = adg_trail_cairo_path(ADG_TRAIL(path));
+    g_assert_cmpint(cairo_path->num_data, <, 30);
+    g_assert_true(cpml_segment_from_cairo(&segment, cairo_path));
+    cpml_primitive_from_segment(&primitive, &segment);
+    g_assert_cmpint(primitive.data[0].header.type, ==, CPML_CURVE);
+    adg_assert_isapprox((primitive.org)->point.x, 10);
+    adg_assert_isapprox((primitive.org)->point.y, 0);
+    adg_assert_isapprox(cairo_path->data[cairo_path->num_data - 1].point.x, -10);
+    adg_assert_isapprox(cairo_path->data[cairo_path->num_data - 1].point.y, 0);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_method_append_boolean(void)
+{
+    AdgPath *path, *body, *hole;
+    CpmlSegment segment, segment2;
+    CpmlExtents extents;
+
+    path = adg_path_new();
+    body = adg_path_new();
+    hole = adg_path_new();
+
+    adg_path_move_to_explicit(body, 0, 0);
+    adg_path_line_to_explicit(body, 4, 0);
+    adg_path_line_to_explicit(body, 4, 2);
+    adg_path_line_to_explicit(body, 0, 2);
+    adg_path_close(body);
+    g_assert_true(adg_trail_put_segment(ADG_TRAIL(body), 1, &segment));
+
+    adg_path_move_to_explicit(hole, 3, -1);
+    adg_path_line_to_explicit(hole, 5, -1);
+    adg_path_line_to_explicit(hole, 5, 3);
+    adg_path_line_to_explicit(hole, 3, 3);
+    adg_path_close(hole);
+    g_assert_true(adg_trail_put_segment(ADG_TRAIL(hole), 1, &segment2));
+
+    /* Sanity check */
+    adg_path_append_boolean(NULL, &segment, &segment2, CPML_BOOLEAN_UNION, 0.01);
+    adg_path_append_boolean(path, NULL, &segment2, CPML_BOOLEAN_UNION, 0.01);
+    adg_path_append_boolean(path, &segment, NULL, CPML_BOOLEAN_UNION, 0.01);
+    adg_path_append_boolean(path, &segment, &segment2, CPML_BOOLEAN_UNION, 0);
+    g_assert_null(adg_path_last_primitive(path));
+
+    /* Cutaway of the right side of the body */
+    adg_path_append_boolean(path, &segment, &segment2, CPML_BOOLEAN_DIFFERENCE, 0.01);
+    g_assert_cmpint(adg_trail_cairo_path(ADG_TRAIL(path))->num_data, ==, 9);
+    g_assert_cmpint(adg_path_last_primitive(path)->data[0].header.type, ==, CPML_CLOSE);
+    cpml_extents_copy(&extents, adg_trail_get_extents(ADG_TRAIL(path)));
+    adg_assert_isapprox(extents.org.x, 0);
+    adg_assert_isapprox(extents.size.x, 3);
+    adg_assert_isapprox(extents.size.y, 2);
+
+    g_object_unref(hole);
+    g_object_unref(body);
+    g_object_unref(path);
+}
+
 static void
 _adg_method_join(void)
 {
@@ -996,6 +1541,37 @@ _adg_method_reflect(void)
     adg_assert_isapprox(p->y, -30);
 
     g_object_unref(path);
+
+    /* Multiple segments must be appended from the last to the first,
+     * keeping any CPML_CLOSE at the end of its reflected segment */
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 1);
+    adg_path_line_to_explicit(path, 2, 3);
+    adg_path_close(path);
+    adg_path_move_to_explicit(path, 4, 5);
+    adg_path_line_to_explicit(path, 6, 7);
+
+    adg_path_reflect(path, NULL);
+    g_assert_cmpuint(adg_trail_n_segments(ADG_TRAIL(path)), ==, 4);
+
+    g_assert_true(adg_trail_put_segment(ADG_TRAIL(path), 3, &segment));
+    g_assert_cmpint(segment.num_data, ==, 4);
+    adg_assert_isapprox(segment.data[1].point.x, 6);
+    adg_assert_isapprox(segment.data[1].point.y, -7);
+    adg_assert_isapprox(segment.data[3].point.x, 4);
+    adg_assert_isapprox(segment.data[3].point.y, -5);
+
+    g_assert_true(adg_trail_put_segment(ADG_TRAIL(path), 4, &segment));
+    g_assert_cmpint(segment.num_data, ==, 5);
+    g_assert_cmpint(segment.data[0].header.type, ==, CPML_MOVE);
+    adg_assert_isapprox(segment.data[1].point.x, 2);
+    adg_assert_isapprox(segment.data[1].point.y, -3);
+    g_assert_cmpint(segment.data[2].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(segment.data[3].point.x, 0);
+    adg_assert_isapprox(segment.data[3].point.y, -1);
+    g_assert_cmpint(segment.data[4].header.type, ==, CPML_CLOSE);
+
+    g_object_unref(path);
 }
 
 
@@ -1007,14 +1583,20 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/path/type/object", ADG_TYPE_PATH);
     adg_test_add_model_checks("/adg/path/type/model", ADG_TYPE_PATH);
 
+    g_test_add_func("/adg/path/behavior/extents", _adg_behavior_extents);
+
     g_test_add_func("/adg/path/method/get-current-point", _adg_method_get_current_point);
     g_test_add_func("/adg/path/method/has-current-point", _adg_method_has_current_point);
     g_test_add_func("/adg/path/method/last-primitive", _adg_method_last_primitive);
     g_test_add_func("/adg/path/method/over-primitive", _adg_method_over_primitive);
     g_test_add_func("/adg/path/method/append-primitive", _adg_method_append_primitive);
+    g_test_add_func("/adg/path/method/append-points", _adg_method_append_points);
+    g_test_add_func("/adg/path/method/append-coords", _adg_method_append_coords);
     g_test_add_func("/adg/path/method/append-segment", _adg_method_append_segment);
     g_test_add_func("/adg/path/method/append-cairo-path", _adg_method_append_cairo_path);
     g_test_add_func("/adg/path/method/append-trail", _adg_method_append_trail);
+    g_test_add_func("/adg/path/method/dup", _adg_method_dup);
+    g_test_add_func("/adg/path/method/set-point", _adg_method_set_point);
     g_test_add_func("/adg/path/method/remove-primitive", _adg_method_remove_primitive);
     g_test_add_func("/adg/path/method/move-to", _adg_method_move_to);
     g_test_add_func("/adg/path/method/line-to", _adg_method_line_to);
@@ -1024,6 +1606,10 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/path/method/chamfer", _adg_method_chamfer);
     g_test_add_func("/adg/path/method/fillet", _adg_method_fillet);
     g_test_add_func("/adg/path/method/join", _adg_method_join);
+    g_test_add_func("/adg/path/method/stitch", _adg_method_stitch);
+    g_test_add_func("/adg/path/method/simplify", _adg_method_simplify);
+    g_test_add_func("/adg/path/method/fit-curves", _adg_method_fit_curves);
+    g_test_add_func("/adg/path/method/append-boolean", _adg_method_append_boolean);
     g_test_add_func("/adg/path/method/reflect", _adg_method_reflect);
 
     return g_test_run();
@@ -90,6 +90,7 @@ static void
 _adg_behavior_named_pair(void)
 {
     CpmlPair p1 = { 123, 456 };
+    CpmlPair p2;
     AdgPoint *explicit_point, *explicit_point2, *model_point;
     AdgModel *model;
     CpmlPair *pair;
@@ -154,11 +155,81 @@ _adg_behavior_named_pair(void)
     g_assert_true(cpml_pair_equal(pair, &p1));
     g_free(pair);
 
+    /* Same checks on the allocation-free variant */
+    g_assert_false(adg_point_put_pair(NULL, &p2));
+    g_assert_false(adg_point_put_pair(model_point, NULL));
+    adg_point_set_pair_from_model(model_point, model, "Named-Pair");
+    p2.x = p2.y = 0;
+    g_assert_false(adg_point_put_pair(model_point, &p2));
+    adg_assert_isapprox(p2.x, 0);
+    adg_assert_isapprox(p2.y, 0);
+    adg_point_set_pair_from_model(model_point, model, "named-pair");
+    g_assert_true(adg_point_put_pair(model_point, &p2));
+    g_assert_true(cpml_pair_equal(&p2, &p1));
+    g_assert_true(adg_point_put_pair(explicit_point2, &p2));
+    adg_assert_isapprox(p2.x, 78);
+    adg_assert_isapprox(p2.y, 90);
+
     adg_point_destroy(explicit_point);
     adg_point_destroy(model_point);
     g_object_unref(model);
 }
 
+static void
+_adg_behavior_shared(void)
+{
+    CpmlPair p1 = { 1, 2 };
+    CpmlPair p2 = { 3, 4 };
+    AdgPoint *point1, *point2, *dup_point;
+    AdgModel *model;
+    CpmlPair *pair;
+
+    model = ADG_MODEL(adg_path_new());
+    adg_model_set_named_pair(model, "shared", &p1);
+
+    point1 = adg_point_new();
+    adg_point_set_pair_from_model(point1, model, "shared");
+    point2 = adg_point_new();
+    adg_point_set_pair_from_model(point2, model, "shared");
+    dup_point = adg_point_dup(point1);
+
+    g_assert_true(adg_point_update(point1));
+    g_assert_true(adg_point_update(point2));
+    g_assert_true(cpml_pair_equal((CpmlPair *) point2, &p1));
+
+    /* A change in the model must be seen by every point */
+    adg_model_set_named_pair(model, "shared", &p2);
+    adg_point_invalidate(point1);
+    adg_point_invalidate(point2);
+    adg_point_invalidate(dup_point);
+    g_assert_true(adg_point_update(point1));
+    g_assert_true(adg_point_update(point2));
+    g_assert_true(adg_point_update(dup_point));
+    g_assert_true(cpml_pair_equal((CpmlPair *) point1, &p2));
+    g_assert_true(cpml_pair_equal((CpmlPair *) point2, &p2));
+    g_assert_true(cpml_pair_equal((CpmlPair *) dup_point, &p2));
+
+    /* Destroying a point must not affect the others */
+    adg_point_destroy(point1);
+    adg_model_set_named_pair(model, "shared", NULL);
+    adg_point_invalidate(point2);
+    g_assert_false(adg_point_update(point2));
+    adg_model_set_named_pair(model, "shared", &p1);
+    adg_point_invalidate(dup_point);
+    pair = adg_point_get_pair(dup_point);
+    g_assert_true(cpml_pair_equal(pair, &p1));
+    g_free(pair);
+
+    /* Unbinding the last points */
+    adg_point_copy(point2, dup_point);
+    adg_point_set_pair(dup_point, &p2);
+    adg_point_destroy(dup_point);
+    g_assert_true(adg_point_update(point2));
+    adg_point_destroy(point2);
+
+    g_object_unref(model);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -169,6 +240,7 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/point/behavior/misc", _adg_behavior_misc);
     g_test_add_func("/adg/point/behavior/named-pair", _adg_behavior_named_pair);
+    g_test_add_func("/adg/point/behavior/shared", _adg_behavior_shared);
 
     return g_test_run();
 }
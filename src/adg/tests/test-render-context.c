@@ -0,0 +1,285 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <config.h>
+#include <adg-test.h>
+#include <adg.h>
+#include <glib/gstdio.h>
+
+
+
+static gboolean
+_adg_is_blank(cairo_surface_t *surface)
+{
+    const guchar *data;
+    gint n, stride, height;
+
+    cairo_surface_flush(surface);
+    data = cairo_image_surface_get_data(surface);
+    stride = cairo_image_surface_get_stride(surface);
+    height = cairo_image_surface_get_height(surface);
+
+    for (n = 0; n < stride * height; ++n)
+        if (data[n] != 0)
+            return FALSE;
+
+    return TRUE;
+}
+
+static gboolean
+_adg_render_is_blank(AdgEntity *entity, AdgRenderContext *context)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gboolean is_blank;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+    cr = cairo_create(surface);
+    adg_entity_render_with_context(entity, cr, context);
+    cairo_destroy(cr);
+    is_blank = _adg_is_blank(surface);
+    cairo_surface_destroy(surface);
+
+    return is_blank;
+}
+
+static AdgEntity *
+_adg_stroke(gdouble x1, gdouble y1, gdouble x2, gdouble y2)
+{
+    AdgPath *path;
+    AdgEntity *entity;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, x1, y1);
+    adg_path_line_to_explicit(path, x2, y2);
+    entity = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    g_object_unref(path);
+
+    return entity;
+}
+
+
+static void
+_adg_type_boxed(void)
+{
+    AdgRenderContext *context;
+
+    g_assert_true(G_TYPE_IS_BOXED(ADG_TYPE_RENDER_CONTEXT));
+
+    context = adg_render_context_new();
+    g_assert_nonnull(context);
+
+    /* Boxed copies are shared references */
+    g_assert_true(g_boxed_copy(ADG_TYPE_RENDER_CONTEXT, context) == context);
+    g_boxed_free(ADG_TYPE_RENDER_CONTEXT, context);
+
+    adg_render_context_unref(context);
+}
+
+static void
+_adg_method_switches(void)
+{
+    AdgRenderContext *context = adg_render_context_new();
+
+    /* Everything disabled by default */
+    g_assert_false(adg_render_context_has_extents(context));
+    g_assert_false(adg_render_context_has_profiling(context));
+    g_assert_false(adg_render_context_has_preview(context));
+    g_assert_false(adg_render_context_has_state_tracking(context));
+    g_assert_false(adg_render_context_get_cull_region(context)->is_defined);
+
+    adg_render_context_switch_extents(context, TRUE);
+    g_assert_true(adg_render_context_has_extents(context));
+    adg_render_context_switch_profiling(context, TRUE);
+    g_assert_true(adg_render_context_has_profiling(context));
+    adg_render_context_switch_preview(context, TRUE);
+    g_assert_true(adg_render_context_has_preview(context));
+    adg_render_context_switch_state_tracking(context, TRUE);
+    g_assert_true(adg_render_context_has_state_tracking(context));
+
+    adg_render_context_switch_extents(context, FALSE);
+    g_assert_false(adg_render_context_has_extents(context));
+    adg_render_context_switch_profiling(context, FALSE);
+    g_assert_false(adg_render_context_has_profiling(context));
+
+    adg_render_context_unref(context);
+}
+
+static void
+_adg_method_bind(void)
+{
+    AdgRenderContext *context;
+    AdgEntity *entity;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    context = adg_render_context_new();
+    entity = _adg_stroke(2, 2, 4, 4);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+    cr = cairo_create(surface);
+
+    /* The options of a bound context are visible through cr */
+    g_assert_null(adg_get_render_context(cr));
+    adg_render_context_switch_preview(context, TRUE);
+    adg_render_context_switch_state_tracking(context, TRUE);
+    adg_set_render_context(cr, context);
+    g_assert_true(adg_get_render_context(cr) == context);
+    g_assert_true(adg_has_preview(cr));
+    g_assert_true(adg_has_state_tracking(cr));
+
+    /* A temporary context is unbound after the rendering */
+    adg_entity_render_with_context(entity, cr, NULL);
+    g_assert_true(adg_get_render_context(cr) == context);
+
+    adg_set_render_context(cr, NULL);
+    g_assert_null(adg_get_render_context(cr));
+    g_assert_false(adg_has_preview(cr));
+    g_assert_false(adg_has_state_tracking(cr));
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(entity);
+    adg_render_context_unref(context);
+}
+
+static void
+_adg_behavior_lod(void)
+{
+    AdgRenderContext *context;
+    AdgEntity *entity;
+    gdouble threshold;
+
+    context = adg_render_context_new();
+    entity = _adg_stroke(2, 2, 4, 4);
+
+    g_assert_cmpint(adg_render_context_get_lod(context, ADG_TYPE_STROKE, &threshold),
+                    ==, ADG_LOD_POLICY_RENDER);
+    adg_assert_isapprox(threshold, 0);
+
+    /* The rules of a context do not leak into the global ones */
+    adg_render_context_set_lod(context, ADG_TYPE_ENTITY, 5, ADG_LOD_POLICY_SKIP);
+    g_assert_cmpint(adg_render_context_get_lod(context, ADG_TYPE_STROKE, &threshold),
+                    ==, ADG_LOD_POLICY_SKIP);
+    adg_assert_isapprox(threshold, 5);
+    g_assert_cmpint(adg_get_lod(ADG_TYPE_STROKE, NULL), ==, ADG_LOD_POLICY_RENDER);
+    g_assert_true(_adg_render_is_blank(entity, context));
+    g_assert_false(_adg_render_is_blank(entity, NULL));
+
+    /* The rules of a context take precedence over the global ones */
+    adg_render_context_set_lod(context, ADG_TYPE_ENTITY, 0, ADG_LOD_POLICY_RENDER);
+    adg_set_lod(ADG_TYPE_ENTITY, 5, ADG_LOD_POLICY_SKIP);
+    g_assert_true(_adg_render_is_blank(entity, context));
+    adg_render_context_set_lod(context, ADG_TYPE_STROKE, 5, ADG_LOD_POLICY_RENDER);
+    g_assert_false(_adg_render_is_blank(entity, context));
+    g_assert_true(_adg_render_is_blank(entity, NULL));
+    adg_set_lod(ADG_TYPE_ENTITY, 0, ADG_LOD_POLICY_RENDER);
+
+    adg_entity_destroy(entity);
+    adg_render_context_unref(context);
+}
+
+static void
+_adg_behavior_cull_region(void)
+{
+    AdgRenderContext *context;
+    AdgEntity *entity;
+    CpmlExtents region;
+
+    context = adg_render_context_new();
+    entity = _adg_stroke(2, 2, 4, 4);
+
+    /* A region far from the entity skips it */
+    region.is_defined = TRUE;
+    region.org.x = 500;
+    region.org.y = 500;
+    region.size.x = 10;
+    region.size.y = 10;
+    adg_render_context_set_cull_region(context, &region);
+    g_assert_true(adg_render_context_get_cull_region(context)->is_defined);
+    g_assert_true(_adg_render_is_blank(entity, context));
+
+    /* A region overlapping the entity renders it */
+    region.org.x = 0;
+    region.org.y = 0;
+    adg_render_context_set_cull_region(context, &region);
+    g_assert_false(_adg_render_is_blank(entity, context));
+
+    adg_render_context_set_cull_region(context, NULL);
+    g_assert_false(adg_render_context_get_cull_region(context)->is_defined);
+    g_assert_false(_adg_render_is_blank(entity, context));
+
+    adg_entity_destroy(entity);
+    adg_render_context_unref(context);
+}
+
+static void
+_adg_behavior_profiling(void)
+{
+    AdgRenderContext *context;
+    AdgEntity *entity;
+    AdgProfile *report;
+    guint n, n_profiles, n_renders;
+
+    context = adg_render_context_new();
+    entity = _adg_stroke(2, 2, 4, 4);
+    adg_entity_arrange(entity);
+    adg_profiling_reset();
+
+    /* The global state is ignored when a context is used */
+    adg_switch_profiling(TRUE);
+    _adg_render_is_blank(entity, context);
+    adg_switch_profiling(FALSE);
+    report = adg_profiling_report(&n_profiles);
+    g_assert_null(report);
+    g_assert_cmpuint(n_profiles, ==, 0);
+
+    /* Only the renderings performed with the context are profiled */
+    adg_render_context_switch_profiling(context, TRUE);
+    _adg_render_is_blank(entity, context);
+    _adg_render_is_blank(entity, NULL);
+    report = adg_profiling_report(&n_profiles);
+    n_renders = 0;
+    for (n = 0; n < n_profiles; ++n)
+        if (report[n].type == ADG_TYPE_STROKE)
+            n_renders += report[n].n_renders;
+    g_free(report);
+    g_assert_cmpuint(n_renders, ==, 1);
+
+    adg_profiling_reset();
+    adg_entity_destroy(entity);
+    adg_render_context_unref(context);
+}
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/adg/render-context/type/boxed", _adg_type_boxed);
+
+    g_test_add_func("/adg/render-context/method/switches", _adg_method_switches);
+    g_test_add_func("/adg/render-context/method/bind", _adg_method_bind);
+
+    g_test_add_func("/adg/render-context/behavior/lod", _adg_behavior_lod);
+    g_test_add_func("/adg/render-context/behavior/cull-region", _adg_behavior_cull_region);
+    g_test_add_func("/adg/render-context/behavior/profiling", _adg_behavior_profiling);
+
+    return g_test_run();
+}
@@ -22,6 +22,89 @@
 #include <adg.h>
 
 
+static void
+_adg_behavior_tile(void)
+{
+    AdgRuledFill *ruled_fill;
+    AdgFillStyle *fill_style;
+    AdgEntity *entity;
+    CpmlExtents extents;
+    cairo_pattern_t *pattern;
+    cairo_matrix_t matrix;
+    cairo_t *cr;
+
+    ruled_fill = adg_ruled_fill_new();
+    fill_style = (AdgFillStyle *) ruled_fill;
+    entity = (AdgEntity *) adg_logo_new();
+    cr = adg_test_cairo_context();
+
+    extents.is_defined = TRUE;
+    extents.org.x = 0;
+    extents.org.y = 0;
+    extents.size.x = 100;
+    extents.size.y = 100;
+    adg_fill_style_set_extents(fill_style, &extents);
+    adg_style_apply((AdgStyle *) ruled_fill, entity, cr);
+
+    pattern = adg_fill_style_get_pattern(fill_style);
+    g_assert_nonnull(pattern);
+    g_assert_cmpint(cairo_pattern_get_extend(pattern), ==, CAIRO_EXTEND_REPEAT);
+
+    /* The tile does not depend on the extents */
+    extents.size.x = 1000;
+    extents.size.y = 1000;
+    adg_fill_style_set_extents(fill_style, &extents);
+    g_assert_true(adg_fill_style_get_pattern(fill_style) == pattern);
+
+    /* A change of the device scale regenerates the tile */
+    cairo_pattern_get_matrix(pattern, &matrix);
+    g_assert_cmpfloat(matrix.xx, <, 1.5);
+    cairo_scale(cr, 2, 2);
+    adg_style_apply((AdgStyle *) ruled_fill, entity, cr);
+    pattern = adg_fill_style_get_pattern(fill_style);
+    cairo_pattern_get_matrix(pattern, &matrix);
+    g_assert_cmpfloat(matrix.xx, >, 1.5);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+    g_object_unref(ruled_fill);
+}
+
+static void
+_adg_behavior_vector_lines(void)
+{
+    AdgRuledFill *ruled_fill;
+    AdgFillStyle *fill_style;
+    AdgEntity *entity;
+    CpmlExtents extents;
+    cairo_t *cr;
+
+    ruled_fill = adg_ruled_fill_new();
+    fill_style = (AdgFillStyle *) ruled_fill;
+    entity = (AdgEntity *) adg_logo_new();
+    cr = adg_test_cairo_context();
+    adg_ruled_fill_switch_vector_lines(ruled_fill, TRUE);
+
+    extents.is_defined = TRUE;
+    extents.org.x = 10;
+    extents.org.y = 10;
+    extents.size.x = 100;
+    extents.size.y = 50;
+    adg_fill_style_set_extents(fill_style, &extents);
+
+    cairo_rectangle(cr, 10, 10, 100, 50);
+    adg_style_apply((AdgStyle *) ruled_fill, entity, cr);
+
+    /* The lines are stroked directly: no pattern and no path left */
+    g_assert_null(adg_fill_style_get_pattern(fill_style));
+    g_assert_false(cairo_has_current_point(cr));
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+    g_object_unref(ruled_fill);
+}
+
 static void
 _adg_property_angle(void)
 {
@@ -67,6 +150,45 @@ _adg_property_angle(void)
     g_object_unref(ruled_fill);
 }
 
+static void
+_adg_property_has_vector_lines(void)
+{
+    AdgRuledFill *ruled_fill;
+    gboolean invalid_boolean;
+    gboolean has_vector_lines;
+
+    ruled_fill = adg_ruled_fill_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    adg_ruled_fill_switch_vector_lines(ruled_fill, FALSE);
+    has_vector_lines = adg_ruled_fill_has_vector_lines(ruled_fill);
+    g_assert_false(has_vector_lines);
+
+    adg_ruled_fill_switch_vector_lines(ruled_fill, invalid_boolean);
+    has_vector_lines = adg_ruled_fill_has_vector_lines(ruled_fill);
+    g_assert_false(has_vector_lines);
+
+    adg_ruled_fill_switch_vector_lines(ruled_fill, TRUE);
+    has_vector_lines = adg_ruled_fill_has_vector_lines(ruled_fill);
+    g_assert_true(has_vector_lines);
+
+    /* Using GObject property methods */
+    g_object_set(ruled_fill, "has-vector-lines", FALSE, NULL);
+    g_object_get(ruled_fill, "has-vector-lines", &has_vector_lines, NULL);
+    g_assert_false(has_vector_lines);
+
+    g_object_set(ruled_fill, "has-vector-lines", invalid_boolean, NULL);
+    g_object_get(ruled_fill, "has-vector-lines", &has_vector_lines, NULL);
+    g_assert_false(has_vector_lines);
+
+    g_object_set(ruled_fill, "has-vector-lines", TRUE, NULL);
+    g_object_get(ruled_fill, "has-vector-lines", &has_vector_lines, NULL);
+    g_assert_true(has_vector_lines);
+
+    g_object_unref(ruled_fill);
+}
+
 static void
 _adg_property_line_dress(void)
 {
@@ -153,7 +275,11 @@ main(int argc, char *argv[])
 
     adg_test_add_object_checks("/adg/ruled-fill/type/object", ADG_TYPE_RULED_FILL);
 
+    g_test_add_func("/adg/ruled-fill/behavior/tile", _adg_behavior_tile);
+    g_test_add_func("/adg/ruled-fill/behavior/vector-lines", _adg_behavior_vector_lines);
+
     g_test_add_func("/adg/ruled-fill/property/angle", _adg_property_angle);
+    g_test_add_func("/adg/ruled-fill/property/has-vector-lines", _adg_property_has_vector_lines);
     g_test_add_func("/adg/ruled-fill/property/line-dress", _adg_property_line_dress);
     g_test_add_func("/adg/ruled-fill/property/spacing", _adg_property_spacing);
 
@@ -0,0 +1,142 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+
+
+static void
+_adg_behavior_misc(void)
+{
+    AdgSnapIndex *index, *dup_index;
+    AdgPath *path, *path2;
+    AdgModel *model;
+    CpmlPair pair;
+    AdgSnap snap;
+
+    index = adg_snap_index_new();
+    g_assert_nonnull(index);
+    g_assert_cmpuint(adg_snap_index_size(index), ==, 0);
+
+    /* Querying an empty index must be a no-op */
+    pair.x = 0;
+    pair.y = 0;
+    g_assert_false(adg_snap_index_nearest(index, &pair, -1, ~0, &snap));
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+
+    model = ADG_MODEL(adg_path_new());
+    adg_model_set_named_pair_explicit(model, "P", 20, 20);
+
+    adg_snap_index_add_model(index, ADG_MODEL(path));
+    adg_snap_index_add_model(index, model);
+
+    /* Adding twice the same model must be a no-op */
+    adg_snap_index_add_model(index, model);
+
+    /* 3 endpoints, 2 midpoints and 1 named pair */
+    g_assert_cmpuint(adg_snap_index_size(index), ==, 6);
+
+    pair.x = 6;
+    pair.y = 1;
+    g_assert_true(adg_snap_index_nearest(index, &pair, -1, ~0, &snap));
+    g_assert_cmpint(snap.type, ==, ADG_SNAP_MIDPOINT);
+    adg_assert_isapprox(snap.pair.x, 5);
+    adg_assert_isapprox(snap.pair.y, 0);
+    g_assert_true(snap.model == ADG_MODEL(path));
+    g_assert_null(snap.name);
+
+    /* Filtering by type */
+    g_assert_true(adg_snap_index_nearest(index, &pair, -1, ADG_SNAP_ENDPOINT, &snap));
+    g_assert_cmpint(snap.type, ==, ADG_SNAP_ENDPOINT);
+    adg_assert_isapprox(snap.pair.x, 10);
+    adg_assert_isapprox(snap.pair.y, 0);
+    g_assert_false(adg_snap_index_nearest(index, &pair, -1, ADG_SNAP_CENTER, &snap));
+
+    /* Limiting the distance */
+    g_assert_false(adg_snap_index_nearest(index, &pair, 1, ~0, NULL));
+    g_assert_true(adg_snap_index_nearest(index, &pair, 2, ~0, NULL));
+
+    pair.x = 19;
+    pair.y = 19;
+    g_assert_true(adg_snap_index_nearest(index, &pair, -1, ~0, &snap));
+    g_assert_cmpint(snap.type, ==, ADG_SNAP_NAMED_PAIR);
+    g_assert_cmpstr(snap.name, ==, "P");
+    g_assert_true(snap.model == model);
+
+    /* The index must follow the changes of its models */
+    adg_model_set_named_pair_explicit(model, "P", 30, 30);
+    g_assert_true(adg_snap_index_nearest(index, &pair, -1, ~0, &snap));
+    g_assert_cmpint(snap.type, ==, ADG_SNAP_ENDPOINT);
+    adg_assert_isapprox(snap.pair.x, 10);
+    adg_assert_isapprox(snap.pair.y, 10);
+    g_assert_cmpuint(adg_snap_index_size(index), ==, 6);
+
+    /* Arcs provide their center too */
+    path2 = adg_path_new();
+    adg_path_move_to_explicit(path2, 100, 0);
+    adg_path_arc_to_explicit(path2, 0, 100, -100, 0);
+    adg_snap_index_add_model(index, ADG_MODEL(path2));
+    g_assert_cmpuint(adg_snap_index_size(index), ==, 10);
+    pair.x = 1;
+    pair.y = 1;
+    g_assert_true(adg_snap_index_nearest(index, &pair, -1, ADG_SNAP_CENTER, &snap));
+    adg_assert_isapprox(snap.pair.x, 0);
+    adg_assert_isapprox(snap.pair.y, 0);
+    g_assert_true(snap.model == ADG_MODEL(path2));
+
+    /* Checking the duplicate */
+    dup_index = adg_snap_index_dup(index);
+    g_assert_cmpuint(adg_snap_index_size(dup_index), ==, 10);
+    adg_snap_index_destroy(dup_index);
+
+    /* Removing a model */
+    adg_snap_index_remove_model(index, ADG_MODEL(path2));
+    g_assert_cmpuint(adg_snap_index_size(index), ==, 6);
+    g_assert_false(adg_snap_index_nearest(index, &pair, -1, ADG_SNAP_CENTER, NULL));
+
+    /* Finalizing a model must drop its points */
+    g_object_unref(model);
+    g_assert_cmpuint(adg_snap_index_size(index), ==, 5);
+
+    adg_snap_index_destroy(index);
+
+    /* The models must survive the index */
+    g_assert_cmpuint(adg_trail_n_segments(ADG_TRAIL(path)), ==, 1);
+
+    g_object_unref(path);
+    g_object_unref(path2);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    adg_test_add_boxed_checks("/adg/snap-index/type/boxed", ADG_TYPE_SNAP_INDEX, adg_snap_index_new());
+
+    g_test_add_func("/adg/snap-index/behavior/misc", _adg_behavior_misc);
+
+    return g_test_run();
+}
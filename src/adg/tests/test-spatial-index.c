@@ -0,0 +1,138 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+
+
+static void
+_adg_behavior_misc(void)
+{
+    AdgSpatialIndex *index, *dup_index;
+    AdgEntity *entities[100];
+    AdgEntity *entity;
+    CpmlExtents extents;
+    CpmlPair pair;
+    GSList *result;
+    gint n;
+
+    index = adg_spatial_index_new();
+    g_assert_nonnull(index);
+    g_assert_cmpuint(adg_spatial_index_size(index), ==, 0);
+
+    /* Querying an empty index must be a no-op */
+    pair.x = 0;
+    pair.y = 0;
+    g_assert_null(adg_spatial_index_query_point(index, &pair));
+
+    /* Populate a 10x10 grid of 1x1 entities spaced by 1 */
+    extents.is_defined = TRUE;
+    extents.size.x = 1;
+    extents.size.y = 1;
+    for (n = 0; n < 100; ++n) {
+        entities[n] = ADG_ENTITY(adg_toy_text_new("Testing..."));
+        extents.org.x = (n % 10) * 2;
+        extents.org.y = (n / 10) * 2;
+        adg_entity_set_extents(entities[n], &extents);
+        adg_spatial_index_add(index, entities[n]);
+    }
+    g_assert_cmpuint(adg_spatial_index_size(index), ==, 100);
+
+    /* Entities with undefined extents must be ignored */
+    entity = ADG_ENTITY(adg_toy_text_new("Testing..."));
+    adg_spatial_index_add(index, entity);
+    g_assert_cmpuint(adg_spatial_index_size(index), ==, 100);
+
+    pair.x = 4.5;
+    pair.y = 6.5;
+    result = adg_spatial_index_query_point(index, &pair);
+    g_assert_cmpint(g_slist_length(result), ==, 1);
+    g_assert_true(result->data == entities[32]);
+    g_slist_free(result);
+
+    /* A point between the entities must not match anything */
+    pair.x = 5.5;
+    pair.y = 5.5;
+    g_assert_null(adg_spatial_index_query_point(index, &pair));
+
+    /* Boundaries are included */
+    extents.org.x = 0;
+    extents.org.y = 0;
+    extents.size.x = 2;
+    extents.size.y = 2;
+    result = adg_spatial_index_query_extents(index, &extents);
+    g_assert_cmpint(g_slist_length(result), ==, 4);
+
+    /* Matches must be returned in insertion order */
+    g_assert_true(g_slist_nth_data(result, 0) == entities[0]);
+    g_assert_true(g_slist_nth_data(result, 1) == entities[1]);
+    g_assert_true(g_slist_nth_data(result, 2) == entities[10]);
+    g_assert_true(g_slist_nth_data(result, 3) == entities[11]);
+    g_slist_free(result);
+
+    extents.is_defined = FALSE;
+    g_assert_null(adg_spatial_index_query_extents(index, &extents));
+
+    /* The duplicate must give the same results */
+    dup_index = adg_spatial_index_dup(index);
+    g_assert_nonnull(dup_index);
+    g_assert_cmpuint(adg_spatial_index_size(dup_index), ==, 100);
+    pair.x = 4.5;
+    pair.y = 6.5;
+    result = adg_spatial_index_query_point(dup_index, &pair);
+    g_assert_cmpint(g_slist_length(result), ==, 1);
+    g_assert_true(result->data == entities[32]);
+    g_slist_free(result);
+    adg_spatial_index_destroy(dup_index);
+
+    /* Adding an entity to an already queried index */
+    extents.is_defined = TRUE;
+    extents.org.x = 4;
+    extents.org.y = 6;
+    extents.size.x = 10;
+    extents.size.y = 10;
+    adg_entity_set_extents(entity, &extents);
+    adg_spatial_index_add(index, entity);
+    g_assert_cmpuint(adg_spatial_index_size(index), ==, 101);
+    result = adg_spatial_index_query_point(index, &pair);
+    g_assert_cmpint(g_slist_length(result), ==, 2);
+    g_assert_true(result->data == entities[32]);
+    g_assert_true(result->next->data == entity);
+    g_slist_free(result);
+
+    adg_spatial_index_destroy(index);
+
+    adg_entity_destroy(entity);
+    for (n = 0; n < 100; ++n)
+        adg_entity_destroy(entities[n]);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    adg_test_add_boxed_checks("/adg/spatial-index/type/boxed", ADG_TYPE_SPATIAL_INDEX, adg_spatial_index_new());
+
+    g_test_add_func("/adg/spatial-index/behavior/misc", _adg_behavior_misc);
+
+    return g_test_run();
+}
@@ -0,0 +1,198 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+
+
+static void
+_adg_method_add_path(void)
+{
+    AdgStrokeBatch *stroke_batch;
+    AdgEntity *entity;
+    cairo_path_data_t path_data[4];
+    cairo_path_t cairo_path;
+    const CpmlExtents *extents;
+
+    stroke_batch = adg_stroke_batch_new();
+    entity = (AdgEntity *) stroke_batch;
+
+    path_data[0].header.type = CPML_MOVE;
+    path_data[0].header.length = 2;
+    path_data[1].point.x = 1;
+    path_data[1].point.y = 2;
+    path_data[2].header.type = CPML_LINE;
+    path_data[2].header.length = 2;
+    path_data[3].point.x = 4;
+    path_data[3].point.y = 6;
+    cairo_path.status = CAIRO_STATUS_SUCCESS;
+    cairo_path.data = path_data;
+    cairo_path.num_data = 4;
+
+    /* Invalid input */
+    adg_stroke_batch_add_path(NULL, &cairo_path);
+    adg_stroke_batch_add_path(stroke_batch, NULL);
+    g_assert_cmpuint(adg_stroke_batch_get_n_paths(stroke_batch), ==, 0);
+
+    adg_stroke_batch_add_path(stroke_batch, &cairo_path);
+    g_assert_cmpuint(adg_stroke_batch_get_n_paths(stroke_batch), ==, 1);
+
+    /* The path is copied, so the original data can be reused */
+    path_data[1].point.x = 10;
+    path_data[1].point.y = 20;
+    path_data[3].point.x = 11;
+    path_data[3].point.y = 21;
+    adg_stroke_batch_add_path(stroke_batch, &cairo_path);
+    g_assert_cmpuint(adg_stroke_batch_get_n_paths(stroke_batch), ==, 2);
+
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, 1);
+    adg_assert_isapprox(extents->org.y, 2);
+    adg_assert_isapprox(extents->size.x, 10);
+    adg_assert_isapprox(extents->size.y, 19);
+
+    adg_stroke_batch_clear(stroke_batch);
+    g_assert_cmpuint(adg_stroke_batch_get_n_paths(stroke_batch), ==, 0);
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_false(extents->is_defined);
+
+    adg_entity_destroy(entity);
+}
+
+static void
+_adg_method_add_trail(void)
+{
+    AdgStrokeBatch *stroke_batch;
+    AdgEntity *entity;
+    AdgPath *path1, *path2;
+    const CpmlExtents *extents;
+
+    stroke_batch = adg_stroke_batch_new();
+    entity = (AdgEntity *) stroke_batch;
+
+    path1 = adg_path_new();
+    adg_path_move_to_explicit(path1, 0, 0);
+    adg_path_line_to_explicit(path1, 5, 5);
+
+    path2 = adg_path_new();
+    adg_path_move_to_explicit(path2, 10, 0);
+    adg_path_line_to_explicit(path2, 15, 2);
+
+    /* Invalid input */
+    adg_stroke_batch_add_trail(NULL, ADG_TRAIL(path1));
+    adg_stroke_batch_add_trail(stroke_batch, NULL);
+    g_assert_cmpuint(adg_stroke_batch_get_n_trails(stroke_batch), ==, 0);
+
+    adg_stroke_batch_add_trail(stroke_batch, ADG_TRAIL(path1));
+    adg_stroke_batch_add_trail(stroke_batch, ADG_TRAIL(path2));
+    g_assert_cmpuint(adg_stroke_batch_get_n_trails(stroke_batch), ==, 2);
+
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 15);
+    adg_assert_isapprox(extents->size.y, 5);
+
+    /* A change on any trail invalidates the whole batch */
+    adg_model_clear(ADG_MODEL(path2));
+    adg_path_move_to_explicit(path2, 10, 0);
+    adg_path_line_to_explicit(path2, 20, 8);
+    adg_model_changed(ADG_MODEL(path2));
+
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    adg_assert_isapprox(extents->size.x, 20);
+    adg_assert_isapprox(extents->size.y, 8);
+
+    adg_stroke_batch_clear(stroke_batch);
+    g_assert_cmpuint(adg_stroke_batch_get_n_trails(stroke_batch), ==, 0);
+
+    adg_entity_destroy(entity);
+    g_object_unref(path1);
+    g_object_unref(path2);
+}
+
+static void
+_adg_property_line_dress(void)
+{
+    AdgStrokeBatch *stroke_batch;
+    AdgDress valid_dress, incompatible_dress;
+    AdgDress line_dress;
+
+    stroke_batch = adg_stroke_batch_new();
+    valid_dress = ADG_DRESS_LINE_DIMENSION;
+    incompatible_dress = ADG_DRESS_FONT_ANNOTATION;
+
+    /* Using the public APIs */
+    adg_stroke_batch_set_line_dress(stroke_batch, valid_dress);
+    line_dress = adg_stroke_batch_get_line_dress(stroke_batch);
+    g_assert_cmpint(line_dress, ==, valid_dress);
+
+    adg_stroke_batch_set_line_dress(stroke_batch, incompatible_dress);
+    line_dress = adg_stroke_batch_get_line_dress(stroke_batch);
+    g_assert_cmpint(line_dress, ==, valid_dress);
+
+    /* Using GObject property methods */
+    g_object_set(stroke_batch, "line-dress", ADG_DRESS_LINE_STROKE, NULL);
+    g_object_get(stroke_batch, "line-dress", &line_dress, NULL);
+    g_assert_cmpint(line_dress, ==, ADG_DRESS_LINE_STROKE);
+
+    g_object_set(stroke_batch, "line-dress", incompatible_dress, NULL);
+    g_object_get(stroke_batch, "line-dress", &line_dress, NULL);
+    g_assert_cmpint(line_dress, ==, ADG_DRESS_LINE_STROKE);
+
+    adg_entity_destroy(ADG_ENTITY(stroke_batch));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    AdgStrokeBatch *stroke_batch;
+    AdgPath *path;
+
+    adg_test_init(&argc, &argv);
+
+    adg_test_add_object_checks("/adg/stroke-batch/type/object", ADG_TYPE_STROKE_BATCH);
+    adg_test_add_entity_checks("/adg/stroke-batch/type/entity", ADG_TYPE_STROKE_BATCH);
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 1, 2);
+    adg_path_line_to_explicit(path, 4, 5);
+    adg_path_line_to_explicit(path, 7, 8);
+    adg_path_close(path);
+    stroke_batch = adg_stroke_batch_new();
+    adg_stroke_batch_add_trail(stroke_batch, ADG_TRAIL(path));
+    adg_test_add_global_space_checks("/adg/stroke-batch/behavior/global-space", stroke_batch);
+    stroke_batch = adg_stroke_batch_new();
+    adg_stroke_batch_add_trail(stroke_batch, ADG_TRAIL(path));
+    adg_test_add_local_space_checks("/adg/stroke-batch/behavior/local-space", stroke_batch);
+    g_object_unref(path);
+
+    g_test_add_func("/adg/stroke-batch/method/add-path", _adg_method_add_path);
+    g_test_add_func("/adg/stroke-batch/method/add-trail", _adg_method_add_trail);
+
+    g_test_add_func("/adg/stroke-batch/property/line-dress", _adg_property_line_dress);
+
+    return g_test_run();
+}
@@ -22,6 +22,189 @@
 #include <adg.h>
 
 
+static guint
+_adg_alpha_at(cairo_surface_t *surface, gint x, gint y)
+{
+    const guint32 *row;
+
+    cairo_surface_flush(surface);
+    row = (const guint32 *) (cairo_image_surface_get_data(surface) +
+                             y * cairo_image_surface_get_stride(surface));
+
+    return row[x] >> 24;
+}
+
+static void
+_adg_behavior_dash_cache(void)
+{
+    AdgStroke *stroke;
+    AdgEntity *entity;
+    AdgPath *path;
+    AdgLineStyle *line_style;
+    AdgDash *dash;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gint n;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 5);
+    adg_path_line_to_explicit(path, 40, 5);
+
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    entity = (AdgEntity *) stroke;
+    adg_stroke_switch_dash_cache(stroke, TRUE);
+
+    dash = adg_dash_new_with_dashes(2, 4., 4.);
+    line_style = adg_line_style_new();
+    adg_line_style_set_width(line_style, 2);
+    adg_line_style_set_antialias(line_style, CAIRO_ANTIALIAS_NONE);
+    adg_line_style_set_dash(line_style, dash);
+    adg_entity_set_style(entity, ADG_DRESS_LINE_STROKE, (AdgStyle *) line_style);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 40, 10);
+    cr = cairo_create(surface);
+
+    /* The second rendering uses the cached dashes */
+    for (n = 0; n < 2; ++n) {
+        cairo_save(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_restore(cr);
+
+        adg_entity_render(entity, cr);
+        g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+        g_assert_cmpuint(_adg_alpha_at(surface, 2, 5), !=, 0);
+        g_assert_cmpuint(_adg_alpha_at(surface, 6, 5), ==, 0);
+        g_assert_cmpuint(_adg_alpha_at(surface, 10, 5), !=, 0);
+        g_assert_cmpuint(_adg_alpha_at(surface, 14, 5), ==, 0);
+    }
+
+    /* Changing the trail must refresh the cache */
+    adg_model_clear(ADG_MODEL(path));
+    adg_path_move_to_explicit(path, 4, 5);
+    adg_path_line_to_explicit(path, 40, 5);
+    adg_model_changed(ADG_MODEL(path));
+
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    adg_entity_render(entity, cr);
+    g_assert_cmpuint(_adg_alpha_at(surface, 2, 5), ==, 0);
+    g_assert_cmpuint(_adg_alpha_at(surface, 6, 5), !=, 0);
+    g_assert_cmpuint(_adg_alpha_at(surface, 10, 5), ==, 0);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_dash_destroy(dash);
+    adg_entity_destroy(entity);
+    g_object_unref(line_style);
+    g_object_unref(path);
+}
+
+static void
+_adg_behavior_shared_flattening(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    AdgEntity *views[3];
+    AdgLineStyle *line_style;
+    AdgDash *dash;
+    cairo_matrix_t map;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gsize usage;
+    gint n;
+
+    path = adg_path_new();
+    trail = ADG_TRAIL(path);
+    adg_path_move_to_explicit(path, 0, 5);
+    adg_path_arc_to_explicit(path, 5, 0, 10, 5);
+
+    dash = adg_dash_new_with_dashes(2, 1., 1.);
+    line_style = adg_line_style_new();
+    adg_line_style_set_dash(line_style, dash);
+
+    /* Same trail, three views: the second is only translated
+     * while the third is a 5:1 detail */
+    for (n = 0; n < 3; ++n) {
+        views[n] = (AdgEntity *) adg_stroke_new(trail);
+        adg_stroke_switch_dash_cache((AdgStroke *) views[n], TRUE);
+        adg_entity_set_style(views[n], ADG_DRESS_LINE_STROKE, (AdgStyle *) line_style);
+    }
+    cairo_matrix_init_translate(&map, 20, 0);
+    adg_entity_set_local_map(views[1], &map);
+    cairo_matrix_init_scale(&map, 5, 5);
+    adg_entity_set_local_map(views[2], &map);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 60, 30);
+    cr = cairo_create(surface);
+
+    adg_entity_render(views[0], cr);
+    usage = adg_trail_get_memory_usage(trail);
+
+    /* The flattening of the first view is reused by the second one */
+    adg_entity_render(views[1], cr);
+    g_assert_cmpuint(adg_trail_get_memory_usage(trail), ==, usage);
+
+    /* A different scale needs a more accurate flattening */
+    adg_entity_render(views[2], cr);
+    g_assert_cmpuint(adg_trail_get_memory_usage(trail), >, usage);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+
+    /* Releasing the caches must drop the flattened copies too */
+    adg_trail_release_cache(trail);
+    g_assert_cmpuint(adg_trail_get_memory_usage(trail), <, usage);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    for (n = 0; n < 3; ++n)
+        adg_entity_destroy(views[n]);
+    adg_dash_destroy(dash);
+    g_object_unref(line_style);
+    g_object_unref(path);
+}
+
+static void
+_adg_property_has_dash_cache(void)
+{
+    AdgStroke *stroke;
+    gboolean invalid_boolean;
+    gboolean has_dash_cache;
+
+    stroke = adg_stroke_new(NULL);
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    adg_stroke_switch_dash_cache(stroke, FALSE);
+    has_dash_cache = adg_stroke_has_dash_cache(stroke);
+    g_assert_false(has_dash_cache);
+
+    adg_stroke_switch_dash_cache(stroke, invalid_boolean);
+    has_dash_cache = adg_stroke_has_dash_cache(stroke);
+    g_assert_false(has_dash_cache);
+
+    adg_stroke_switch_dash_cache(stroke, TRUE);
+    has_dash_cache = adg_stroke_has_dash_cache(stroke);
+    g_assert_true(has_dash_cache);
+
+    /* Using GObject property methods */
+    g_object_set(stroke, "has-dash-cache", FALSE, NULL);
+    g_object_get(stroke, "has-dash-cache", &has_dash_cache, NULL);
+    g_assert_false(has_dash_cache);
+
+    g_object_set(stroke, "has-dash-cache", invalid_boolean, NULL);
+    g_object_get(stroke, "has-dash-cache", &has_dash_cache, NULL);
+    g_assert_false(has_dash_cache);
+
+    g_object_set(stroke, "has-dash-cache", TRUE, NULL);
+    g_object_get(stroke, "has-dash-cache", &has_dash_cache, NULL);
+    g_assert_true(has_dash_cache);
+
+    adg_entity_destroy(ADG_ENTITY(stroke));
+}
+
 static void
 _adg_property_line_dress(void)
 {
@@ -135,6 +318,10 @@ main(int argc, char *argv[])
     adg_test_add_local_space_checks("/adg/stroke/behavior/local-space", adg_stroke_new(ADG_TRAIL(path)));
     g_object_unref(path);
 
+    g_test_add_func("/adg/stroke/behavior/dash-cache", _adg_behavior_dash_cache);
+    g_test_add_func("/adg/stroke/behavior/shared-flattening", _adg_behavior_shared_flattening);
+
+    g_test_add_func("/adg/stroke/property/has-dash-cache", _adg_property_has_dash_cache);
     g_test_add_func("/adg/stroke/property/line-dress", _adg_property_line_dress);
     g_test_add_func("/adg/stroke/property/trail", _adg_property_trail);
 
@@ -33,6 +33,67 @@ _adg_method_clone(void)
     g_type_class_unref(klass);
 }
 
+static void
+_adg_method_equal(void)
+{
+    AdgColorStyle *color_style1, *color_style2;
+    AdgDimStyle *dim_style1, *dim_style2;
+    AdgMarker *marker;
+
+    color_style1 = adg_color_style_new();
+    color_style2 = adg_color_style_new();
+
+    g_assert_false(adg_style_equal(NULL, (AdgStyle *) color_style1));
+    g_assert_false(adg_style_equal((AdgStyle *) color_style1, NULL));
+    g_assert_true(adg_style_equal((AdgStyle *) color_style1, (AdgStyle *) color_style1));
+    g_assert_true(adg_style_equal((AdgStyle *) color_style1, (AdgStyle *) color_style2));
+
+    adg_color_style_set_red(color_style2, 0.5);
+    g_assert_false(adg_style_equal((AdgStyle *) color_style1, (AdgStyle *) color_style2));
+
+    /* Styles of different types are never equal */
+    dim_style1 = adg_dim_style_new();
+    g_assert_false(adg_style_equal((AdgStyle *) color_style1, (AdgStyle *) dim_style1));
+
+    /* Markers are compared by value */
+    dim_style2 = adg_dim_style_new();
+    g_assert_true(adg_style_equal((AdgStyle *) dim_style1, (AdgStyle *) dim_style2));
+
+    marker = (AdgMarker *) adg_arrow_new();
+    adg_marker_set_size(marker, 123);
+    adg_dim_style_set_marker1(dim_style2, marker);
+    g_object_unref(marker);
+    g_assert_false(adg_style_equal((AdgStyle *) dim_style1, (AdgStyle *) dim_style2));
+
+    g_object_unref(color_style1);
+    g_object_unref(color_style2);
+    g_object_unref(dim_style1);
+    g_object_unref(dim_style2);
+}
+
+static void
+_adg_method_intern(void)
+{
+    AdgColorStyle *color_style1, *color_style2;
+    AdgStyle *interned1, *interned2;
+
+    color_style1 = adg_color_style_new();
+    adg_color_style_set_rgb(color_style1, 0.1, 0.2, 0.3);
+    color_style2 = adg_color_style_new();
+    adg_color_style_set_rgb(color_style2, 0.1, 0.2, 0.3);
+
+    interned1 = adg_style_intern((AdgStyle *) color_style1);
+    g_assert_true(interned1 == (AdgStyle *) color_style1);
+
+    interned2 = adg_style_intern((AdgStyle *) color_style2);
+    g_assert_true(interned2 == interned1);
+
+    g_object_unref(interned1);
+    g_object_unref(interned2);
+    g_object_unref(color_style1);
+    g_object_unref(color_style2);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -42,6 +103,8 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/style/type/object", ADG_TYPE_STYLE);
 
     g_test_add_func("/adg/style/method/clone", _adg_method_clone);
+    g_test_add_func("/adg/style/method/equal", _adg_method_equal);
+    g_test_add_func("/adg/style/method/intern", _adg_method_intern);
 
     return g_test_run();
 }
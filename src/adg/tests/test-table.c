@@ -117,6 +117,152 @@ _adg_property_has_frame(void)
 
     adg_entity_destroy(ADG_ENTITY(table));
 }
+static void
+_adg_method_arrange(void)
+{
+    AdgTable *table;
+    AdgEntity *entity;
+    AdgTableRow *row;
+    AdgTableCell *cell;
+    CpmlExtents extents;
+
+    table = adg_table_new();
+    entity = (AdgEntity *) table;
+    row = adg_table_row_new(table);
+    cell = adg_table_cell_new_with_width(row, 10);
+    adg_table_cell_switch_frame(cell, TRUE);
+    adg_table_cell_new_with_width(row, 20);
+
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(extents.is_defined);
+
+    /* Arranging again an unchanged table gives the same layout */
+    adg_entity_invalidate(entity);
+    adg_entity_arrange(entity);
+    g_assert_true(cpml_extents_equal(&extents, adg_entity_get_extents(entity)));
+
+    /* Frame and grid must follow the resized cells */
+    adg_table_cell_set_width(cell, 40);
+    adg_entity_arrange(entity);
+    g_assert_cmpfloat(adg_entity_get_extents(entity)->size.x, >, extents.size.x);
+    g_assert_cmpfloat(adg_table_cell_get_extents(cell)->size.x, ==, 40);
+
+    adg_entity_destroy(entity);
+}
+static void
+_adg_method_set_text_values(void)
+{
+    AdgTable *table;
+    AdgTableRow *row;
+    AdgTableCell *cell1, *cell2;
+    const gchar *names[] = { "first", "unknown", "second" };
+    const gchar *values[] = { "1", "?", NULL };
+    gchar *text;
+
+    table = adg_table_new();
+    row = adg_table_row_new(table);
+    cell1 = adg_table_cell_new_full(row, 10, "first", NULL, FALSE);
+    cell2 = adg_table_cell_new_full(row, 10, "second", NULL, FALSE);
+    adg_table_cell_set_text_value(cell2, "2");
+
+    /* Sanity checks */
+    adg_table_set_text_values(NULL, names, values, 3);
+    adg_table_set_text_values(table, NULL, values, 3);
+    g_assert_null(adg_table_cell_value(cell1));
+
+    adg_table_set_text_values(table, names, values, 3);
+
+    g_assert_nonnull(adg_table_cell_value(cell1));
+    text = adg_textual_dup_text((AdgTextual *) adg_table_cell_value(cell1));
+    g_assert_cmpstr(text, ==, "1");
+    g_free(text);
+    g_assert_null(adg_table_cell_value(cell2));
+
+    adg_entity_destroy((AdgEntity *) table);
+}
+
+static void
+_adg_method_get_nth_row(void)
+{
+    AdgTable *table;
+    AdgTableRow *row1, *row2, *row3;
+    AdgTableCell *cell1, *cell2;
+
+    table = adg_table_new();
+
+    /* Sanity checks */
+    g_assert_cmpuint(adg_table_get_n_rows(NULL), ==, 0);
+    g_assert_null(adg_table_get_nth_row(NULL, 0));
+    g_assert_cmpuint(adg_table_row_get_n_cells(NULL), ==, 0);
+    g_assert_null(adg_table_row_get_nth_cell(NULL, 0));
+
+    g_assert_cmpuint(adg_table_get_n_rows(table), ==, 0);
+    g_assert_null(adg_table_get_nth_row(table, 0));
+
+    row1 = adg_table_row_new(table);
+    row3 = adg_table_row_new(table);
+    row2 = adg_table_row_new_before(row3);
+
+    g_assert_cmpuint(adg_table_get_n_rows(table), ==, 3);
+    g_assert_true(adg_table_get_nth_row(table, 0) == row1);
+    g_assert_true(adg_table_get_nth_row(table, 1) == row2);
+    g_assert_true(adg_table_get_nth_row(table, 2) == row3);
+    g_assert_null(adg_table_get_nth_row(table, 3));
+
+    g_assert_cmpuint(adg_table_row_get_n_cells(row1), ==, 0);
+    cell2 = adg_table_cell_new(row1);
+    cell1 = adg_table_cell_new_before(cell2);
+    g_assert_cmpuint(adg_table_row_get_n_cells(row1), ==, 2);
+    g_assert_true(adg_table_row_get_nth_cell(row1, 0) == cell1);
+    g_assert_true(adg_table_row_get_nth_cell(row1, 1) == cell2);
+    g_assert_null(adg_table_row_get_nth_cell(row1, 2));
+
+    adg_table_cell_free(cell1);
+    g_assert_cmpuint(adg_table_row_get_n_cells(row1), ==, 1);
+    g_assert_true(adg_table_row_get_nth_cell(row1, 0) == cell2);
+
+    adg_table_row_free(row2);
+    g_assert_cmpuint(adg_table_get_n_rows(table), ==, 2);
+    g_assert_true(adg_table_get_nth_row(table, 1) == row3);
+
+    adg_entity_destroy((AdgEntity *) table);
+}
+
+static void
+_adg_method_render(void)
+{
+    AdgTable *table;
+    AdgEntity *entity;
+    AdgTableRow *row;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gint n;
+
+    table = adg_table_new();
+    entity = (AdgEntity *) table;
+    for (n = 0; n < 100; ++n) {
+        row = adg_table_row_new(table);
+        adg_table_cell_new_full(row, 20, NULL, "Title", TRUE);
+    }
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    /* Only the first rows are inside the clip area */
+    adg_entity_arrange(entity);
+    adg_entity_render(entity, cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+
+    /* Rendering a table completely outside the clip area */
+    cairo_translate(cr, 0, -10000);
+    adg_entity_render(entity, cr);
+    g_assert_cmpint(cairo_status(cr), ==, CAIRO_STATUS_SUCCESS);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(entity);
+}
 
 
 int
@@ -131,5 +277,10 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/table/property/table-dress", _adg_property_table_dress);
     g_test_add_func("/adg/table/property/has-frame", _adg_property_has_frame);
 
+    g_test_add_func("/adg/table/method/arrange", _adg_method_arrange);
+    g_test_add_func("/adg/table/method/set-text-values", _adg_method_set_text_values);
+    g_test_add_func("/adg/table/method/get-nth-row", _adg_method_get_nth_row);
+    g_test_add_func("/adg/table/method/render", _adg_method_render);
+
     return g_test_run();
 }
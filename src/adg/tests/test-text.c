@@ -137,6 +137,138 @@ _adg_property_text(void)
     adg_entity_destroy(ADG_ENTITY(text));
 }
 
+static void
+_adg_property_metrics_only(void)
+{
+    AdgText *text;
+    gboolean metrics_only;
+
+    text = adg_text_new("Metrics");
+
+    /* Using the public APIs */
+    g_assert_false(adg_text_get_metrics_only(text));
+    adg_text_set_metrics_only(text, TRUE);
+    g_assert_true(adg_text_get_metrics_only(text));
+    adg_text_set_metrics_only(text, FALSE);
+    g_assert_false(adg_text_get_metrics_only(text));
+
+    /* Using GObject property methods */
+    g_object_set(text, "metrics-only", TRUE, NULL);
+    g_object_get(text, "metrics-only", &metrics_only, NULL);
+    g_assert_true(metrics_only);
+    g_object_set(text, "metrics-only", FALSE, NULL);
+    g_object_get(text, "metrics-only", &metrics_only, NULL);
+    g_assert_false(metrics_only);
+
+    adg_entity_destroy(ADG_ENTITY(text));
+}
+
+static void
+_adg_behavior_metrics_only(void)
+{
+    AdgText *text1, *text2;
+    AdgEntity *entity1, *entity2;
+    const CpmlExtents *extents1, *extents2;
+    cairo_t *cr;
+
+    text1 = adg_text_new("Estimated");
+    text2 = adg_text_new("Estimated");
+    entity1 = (AdgEntity *) text1;
+    entity2 = (AdgEntity *) text2;
+    adg_text_set_metrics_only(text1, TRUE);
+
+    adg_entity_arrange(entity1);
+    adg_entity_arrange(entity2);
+    extents1 = adg_entity_get_extents(entity1);
+    extents2 = adg_entity_get_extents(entity2);
+    g_assert_true(extents1->is_defined);
+    g_assert_true(extents2->is_defined);
+
+    /* Without kerning the estimate should be quite close */
+    g_assert_cmpfloat(extents1->size.x, >, extents2->size.x * 0.8);
+    g_assert_cmpfloat(extents1->size.x, <, extents2->size.x * 1.2);
+    g_assert_cmpfloat(extents1->size.y, >, 0);
+
+    /* The text must be shaped on demand when rendered */
+    cr = adg_test_cairo_context();
+    adg_entity_render(entity1, cr);
+    cairo_destroy(cr);
+
+    adg_entity_destroy(entity1);
+    adg_entity_destroy(entity2);
+}
+
+static void
+_adg_behavior_layout_cache(void)
+{
+    AdgText *text1, *text2;
+    AdgEntity *entity1, *entity2;
+    const CpmlExtents *extents1, *extents2;
+    gdouble width;
+
+    text1 = adg_text_new("Shared layout");
+    text2 = adg_text_new("Shared layout");
+    entity1 = (AdgEntity *) text1;
+    entity2 = (AdgEntity *) text2;
+
+    adg_entity_arrange(entity1);
+    adg_entity_arrange(entity2);
+    extents1 = adg_entity_get_extents(entity1);
+    extents2 = adg_entity_get_extents(entity2);
+    g_assert_true(extents1->is_defined);
+    g_assert_true(extents2->is_defined);
+    adg_assert_isapprox(extents1->size.x, extents2->size.x);
+    adg_assert_isapprox(extents1->size.y, extents2->size.y);
+    width = extents1->size.x;
+
+    /* Destroying one text must not affect the other one */
+    adg_entity_destroy(entity1);
+    adg_textual_set_text((AdgTextual *) text2, "Another layout");
+    adg_entity_arrange(entity2);
+    extents2 = adg_entity_get_extents(entity2);
+    g_assert_true(extents2->is_defined);
+
+    adg_textual_set_text((AdgTextual *) text2, "Shared layout");
+    adg_entity_arrange(entity2);
+    extents2 = adg_entity_get_extents(entity2);
+    g_assert_true(extents2->is_defined);
+    adg_assert_isapprox(extents2->size.x, width);
+
+    adg_entity_destroy(entity2);
+}
+
+static void
+_adg_method_shape(void)
+{
+    AdgText *text1, *text2;
+    AdgEntity *entity1, *entity2;
+    const CpmlExtents *extents1, *extents2;
+
+    text1 = adg_text_new("Shaped in advance");
+    text2 = adg_text_new("Shaped in advance");
+    entity1 = (AdgEntity *) text1;
+    entity2 = (AdgEntity *) text2;
+
+    /* Shaping does not compute the extents... */
+    adg_textual_shape((AdgTextual *) text1);
+    g_assert_false(adg_entity_get_extents(entity1)->is_defined);
+
+    /* ...but the result must be the same of a plain arrange */
+    adg_entity_arrange(entity1);
+    adg_entity_arrange(entity2);
+    extents1 = adg_entity_get_extents(entity1);
+    extents2 = adg_entity_get_extents(entity2);
+    g_assert_true(extents1->is_defined);
+    g_assert_true(extents2->is_defined);
+    adg_assert_isapprox(extents1->org.x, extents2->org.x);
+    adg_assert_isapprox(extents1->org.y, extents2->org.y);
+    adg_assert_isapprox(extents1->size.x, extents2->size.x);
+    adg_assert_isapprox(extents1->size.y, extents2->size.y);
+
+    adg_entity_destroy(entity1);
+    adg_entity_destroy(entity2);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -151,6 +283,12 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/text/property/local-mix", _adg_property_local_mix);
     g_test_add_func("/adg/text/property/font-dress", _adg_property_font_dress);
     g_test_add_func("/adg/text/property/string", _adg_property_text);
+    g_test_add_func("/adg/text/property/metrics-only", _adg_property_metrics_only);
+
+    g_test_add_func("/adg/text/behavior/layout-cache", _adg_behavior_layout_cache);
+    g_test_add_func("/adg/text/behavior/metrics-only", _adg_behavior_metrics_only);
+
+    g_test_add_func("/adg/text/method/shape", _adg_method_shape);
 
     return g_test_run();
 }
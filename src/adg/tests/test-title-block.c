@@ -407,6 +407,64 @@ _adg_property_title(void)
 
     adg_entity_destroy(ADG_ENTITY(title_block));
 }
+static void
+_adg_method_set_date(void)
+{
+    AdgTitleBlock *title_block;
+    AdgTableCell *cell;
+    AdgEntity *value;
+    gchar *text;
+
+    title_block = adg_title_block_new();
+    adg_title_block_set_date(title_block, "2001-01-01");
+    cell = adg_table_get_cell(ADG_TABLE(title_block), "date");
+    g_assert_nonnull(cell);
+    value = adg_table_cell_value(cell);
+    g_assert_nonnull(value);
+
+    /* Changing the date must only update the text of the cell */
+    adg_title_block_set_date(title_block, "2002-02-02");
+    g_assert_true(adg_table_cell_value(cell) == value);
+    text = adg_textual_dup_text(ADG_TEXTUAL(value));
+    g_assert_cmpstr(text, ==, "2002-02-02");
+    g_free(text);
+
+    adg_entity_destroy(ADG_ENTITY(title_block));
+}
+
+static void
+_adg_behavior_lazy_titles(void)
+{
+    AdgTitleBlock *title_block;
+    AdgTableCell *cell;
+    AdgEntity *title;
+    CpmlExtents extents;
+
+    title_block = adg_title_block_new();
+    cell = adg_table_get_cell(ADG_TABLE(title_block), "size");
+    g_assert_nonnull(cell);
+
+    /* Setting a value does not create the title */
+    adg_title_block_set_size(title_block, "A4");
+    g_assert_nonnull(adg_table_cell_value(cell));
+    g_assert_null(adg_table_cell_title(cell));
+
+    /* The first arrange does */
+    adg_entity_arrange(ADG_ENTITY(title_block));
+    title = adg_table_cell_title(cell);
+    g_assert_nonnull(title);
+    g_assert_true(ADG_IS_TEXTUAL(title));
+    cpml_extents_copy(&extents, adg_entity_get_extents(ADG_ENTITY(title_block)));
+    g_assert_true(extents.is_defined);
+
+    /* The titles are created only once and do not change the layout */
+    adg_entity_invalidate(ADG_ENTITY(title_block));
+    adg_entity_arrange(ADG_ENTITY(title_block));
+    g_assert_true(adg_table_cell_title(cell) == title);
+    g_assert_true(cpml_extents_equal(&extents, adg_entity_get_extents(ADG_ENTITY(title_block))));
+
+    adg_entity_destroy(ADG_ENTITY(title_block));
+}
 
 
 int
@@ -418,6 +476,7 @@ main(int argc, char *argv[])
     adg_test_add_entity_checks("/adg/title-block/type/entity", ADG_TYPE_TITLE_BLOCK);
 
     adg_test_add_global_space_checks("/adg/title-block/behavior/global-space", adg_title_block_new());
+    g_test_add_func("/adg/title-block/behavior/lazy-titles", _adg_behavior_lazy_titles);
 
     g_test_add_func("/adg/title-block/property/local-mix", _adg_property_local_mix);
     g_test_add_func("/adg/title-block/property/author", _adg_property_author);
@@ -429,5 +488,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/title-block/property/size", _adg_property_size);
     g_test_add_func("/adg/title-block/property/title", _adg_property_title);
 
+    g_test_add_func("/adg/title-block/method/set-date", _adg_method_set_date);
+
     return g_test_run();
 }
@@ -137,6 +137,65 @@ _adg_property_text(void)
     adg_entity_destroy(ADG_ENTITY(toy_text));
 }
 
+static void
+_adg_behavior_translation(void)
+{
+    AdgToyText *toy_text;
+    AdgEntity *entity;
+    const CpmlExtents *extents;
+    CpmlExtents old_extents;
+    cairo_matrix_t map;
+
+    toy_text = adg_toy_text_new("Translated text");
+    entity = (AdgEntity *) toy_text;
+
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    cpml_extents_copy(&old_extents, extents);
+
+    /* A pure translation must only move the extents */
+    cairo_matrix_init_translate(&map, 10, 20);
+    adg_entity_set_global_map(entity, &map);
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, old_extents.org.x + 10);
+    adg_assert_isapprox(extents->org.y, old_extents.org.y + 20);
+    adg_assert_isapprox(extents->size.x, old_extents.size.x);
+    adg_assert_isapprox(extents->size.y, old_extents.size.y);
+
+    /* Translating again must not pick the original position */
+    cairo_matrix_init_translate(&map, 30, 20);
+    adg_entity_set_global_map(entity, &map);
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    adg_assert_isapprox(extents->org.x, old_extents.org.x + 30);
+    adg_assert_isapprox(extents->org.y, old_extents.org.y + 20);
+
+    /* Any other change must rebuild the font */
+    cairo_matrix_init_scale(&map, 2, 2);
+    adg_entity_set_global_map(entity, &map);
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    g_assert_cmpfloat(extents->size.x, >, old_extents.size.x * 1.5);
+    cairo_matrix_init_identity(&map);
+    adg_entity_set_global_map(entity, &map);
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    adg_assert_isapprox(extents->size.x, old_extents.size.x);
+
+    /* A different text with the same font must be reshaped */
+    adg_textual_set_text((AdgTextual *) toy_text, "Translated text, longer");
+    adg_entity_arrange(entity);
+    extents = adg_entity_get_extents(entity);
+    g_assert_true(extents->is_defined);
+    g_assert_cmpfloat(extents->size.x, >, old_extents.size.x);
+
+    adg_entity_destroy(entity);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -152,5 +211,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/toy-text/property/font-dress", _adg_property_font_dress);
     g_test_add_func("/adg/toy-text/property/text", _adg_property_text);
 
+    g_test_add_func("/adg/toy-text/behavior/translation", _adg_behavior_translation);
+
     return g_test_run();
 }
@@ -20,6 +20,8 @@
 
 #include <adg-test.h>
 #include <adg.h>
+#include <glib/gstdio.h>
+#include <string.h>
 
 
 static cairo_path_t *
@@ -42,6 +44,38 @@ _adg_path_callback(AdgTrail *trail, gpointer user_data)
     return &path;
 }
 
+static cairo_path_t *
+_adg_arc_callback(AdgTrail *trail, gpointer user_data)
+{
+    static cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 1, 0 }},
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 0, 1 }},
+        { .point = { -1, 0 }}
+    };
+    static cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+
+    return &path;
+}
+
+static cairo_path_t *
+_adg_counting_callback(AdgTrail *trail, gpointer user_data)
+{
+    ++ *((gint *) user_data);
+    return _adg_path_callback(trail, NULL);
+}
+
+static void
+_adg_changed(AdgModel *model, gpointer user_data)
+{
+    ++ *((gint *) user_data);
+}
+
 
 static void
 _adg_property_max_angle(void)
@@ -75,6 +109,84 @@ _adg_property_max_angle(void)
     g_object_unref(trail);
 }
 
+static void
+_adg_property_tolerance(void)
+{
+    AdgTrail *trail;
+    gdouble valid_value, invalid_value;
+    gdouble tolerance;
+
+    trail = adg_trail_new(_adg_arc_callback, NULL);
+    valid_value = 0.01;
+    invalid_value = -1;
+
+    /* Using the public APIs */
+    adg_trail_set_tolerance(trail, valid_value);
+    tolerance = adg_trail_get_tolerance(trail);
+    adg_assert_isapprox(tolerance, valid_value);
+
+    adg_trail_set_tolerance(trail, invalid_value);
+    tolerance = adg_trail_get_tolerance(trail);
+    g_assert_cmpfloat(tolerance, !=, invalid_value);
+
+    /* Using GObject property methods */
+    g_object_set(trail, "tolerance", valid_value, NULL);
+    g_object_get(trail, "tolerance", &tolerance, NULL);
+    adg_assert_isapprox(tolerance, valid_value);
+
+    g_object_set(trail, "tolerance", invalid_value, NULL);
+    g_object_get(trail, "tolerance", &tolerance, NULL);
+    g_assert_cmpfloat(tolerance, !=, invalid_value);
+
+    /* By default, the max angle (G_PI_2) is used: 2 curves */
+    adg_trail_set_tolerance(trail, 0);
+    g_assert_cmpint(adg_trail_get_cairo_path(trail)->num_data, ==, 2 + 4 * 2);
+
+    /* A loose tolerance uses a single curve */
+    adg_trail_set_tolerance(trail, 1);
+    g_assert_cmpint(adg_trail_get_cairo_path(trail)->num_data, ==, 2 + 4 * 1);
+
+    /* A strict tolerance requires more curves */
+    adg_trail_set_tolerance(trail, 1e-6);
+    g_assert_cmpint(adg_trail_get_cairo_path(trail)->num_data, >, 2 + 4 * 2);
+
+    g_object_unref(trail);
+}
+
+static void
+_adg_behavior_cache(void)
+{
+    AdgTrail *trail;
+    gint n_calls;
+
+    n_calls = 0;
+    trail = adg_trail_new(_adg_counting_callback, &n_calls);
+
+    /* The callback must be called only once */
+    g_assert_cmpuint(adg_trail_n_segments(trail), ==, 1);
+    g_assert_true(adg_trail_put_segment(trail, 1, NULL));
+    g_assert_nonnull(adg_trail_get_extents(trail));
+    g_assert_nonnull(adg_trail_get_cairo_path(trail));
+    g_assert_cmpint(n_calls, ==, 1);
+
+    /* A change must invalidate the cache */
+    adg_model_changed(ADG_MODEL(trail));
+    g_assert_cmpuint(adg_trail_n_segments(trail), ==, 1);
+    g_assert_true(adg_trail_put_segment(trail, 1, NULL));
+    g_assert_cmpint(n_calls, ==, 2);
+
+    adg_model_clear(ADG_MODEL(trail));
+    g_assert_nonnull(adg_trail_cairo_path(trail));
+    g_assert_cmpint(n_calls, ==, 3);
+
+    /* A path without arcs must not be copied */
+    g_assert_true(adg_trail_get_cairo_path(trail)->data ==
+                  adg_trail_cairo_path(trail)->data);
+    g_assert_cmpint(n_calls, ==, 3);
+
+    g_object_unref(trail);
+}
+
 static void
 _adg_method_n_segments(void)
 {
@@ -98,6 +210,58 @@ _adg_method_n_segments(void)
     /* Count segments on a more complex path */
     g_assert_cmpuint(adg_trail_n_segments(ADG_TRAIL(path)), ==, 5+1);
 
+    /* The cached segments must be updated after a change */
+    adg_path_move_to_explicit(path, 5, 6);
+    adg_path_line_to_explicit(path, 7, 8);
+    g_assert_cmpuint(adg_trail_n_segments(ADG_TRAIL(path)), ==, 5+2);
+    g_assert_true(adg_trail_put_segment(ADG_TRAIL(path), 5+2, NULL));
+    g_assert_false(adg_trail_put_segment(ADG_TRAIL(path), 5+3, NULL));
+
+    adg_model_clear(ADG_MODEL(path));
+    g_assert_cmpuint(adg_trail_n_segments(ADG_TRAIL(path)), ==, 0);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_browse_segments(guint size, gpointer user_data)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    CpmlSegment segment;
+    guint n;
+
+    path = adg_path_new();
+    trail = ADG_TRAIL(path);
+
+    for (n = 0; n < size; ++n) {
+        adg_path_move_to_explicit(path, n, 0);
+        adg_path_line_to_explicit(path, n, 1);
+    }
+
+    for (n = 1; n <= size; ++n)
+        adg_trail_put_segment(trail, n, &segment);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_behavior_scaling(void)
+{
+    AdgPath *path;
+    gint n;
+
+    /* Browsing all the segments must be linear */
+    adg_test_assert_linear(_adg_browse_segments, 256, NULL);
+
+    /* Browsing a trail must not leave any object around */
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+    n = adg_test_count_instances(G_TYPE_OBJECT);
+    adg_trail_put_segment(ADG_TRAIL(path), 1, NULL);
+    adg_assert_max_instances(G_TYPE_OBJECT, n, 0);
+
     g_object_unref(path);
 }
 
@@ -162,6 +326,339 @@ _adg_method_put_segment(void)
     g_object_unref(path);
 }
 
+static void
+_adg_method_get_segment_extents(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    const CpmlExtents *extents;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 1, 2);
+    adg_path_line_to_explicit(path, 3, 4);
+    adg_path_move_to_explicit(path, 5, 6);
+    adg_path_line_to_explicit(path, 7, 9);
+    trail = ADG_TRAIL(path);
+
+    /* Sanity checks */
+    g_assert_null(adg_trail_get_segment_extents(NULL, 1));
+    g_assert_null(adg_trail_get_segment_extents(trail, 0));
+    g_assert_null(adg_trail_get_segment_extents(trail, 3));
+
+    extents = adg_trail_get_segment_extents(trail, 1);
+    g_assert_nonnull(extents);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, 1);
+    adg_assert_isapprox(extents->org.y, 2);
+    adg_assert_isapprox(extents->size.x, 2);
+    adg_assert_isapprox(extents->size.y, 2);
+
+    extents = adg_trail_get_segment_extents(trail, 2);
+    g_assert_nonnull(extents);
+    adg_assert_isapprox(extents->org.x, 5);
+    adg_assert_isapprox(extents->org.y, 6);
+    adg_assert_isapprox(extents->size.x, 2);
+    adg_assert_isapprox(extents->size.y, 3);
+
+    /* The whole extents are the union of the segment extents */
+    extents = adg_trail_get_extents(trail);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, 1);
+    adg_assert_isapprox(extents->org.y, 2);
+    adg_assert_isapprox(extents->size.x, 6);
+    adg_assert_isapprox(extents->size.y, 7);
+
+    /* The cache must be invalidated by a path change */
+    adg_path_line_to_explicit(path, 10, 9);
+    extents = adg_trail_get_segment_extents(trail, 2);
+    g_assert_nonnull(extents);
+    adg_assert_isapprox(extents->size.x, 5);
+    adg_assert_isapprox(adg_trail_get_extents(trail)->size.x, 9);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_method_length(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    CpmlPair pair;
+    CpmlVector vector;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_move_to_explicit(path, 0, 10);
+    adg_path_line_to_explicit(path, 0, 20);
+    adg_path_move_to_explicit(path, 1, 30);
+    adg_path_arc_to_explicit(path, 0, 31, -1, 30);
+    adg_path_curve_to_explicit(path, -1, 33, -1, 36, -1, 39);
+    trail = ADG_TRAIL(path);
+
+    /* Sanity checks */
+    g_assert_cmpfloat(adg_trail_get_length(NULL), ==, 0);
+    g_assert_false(adg_trail_put_pair_at_length(NULL, 0, &pair));
+    g_assert_false(adg_trail_put_pair_at_length(trail, 0, NULL));
+    g_assert_false(adg_trail_put_vector_at_length(NULL, 0, &vector));
+    g_assert_false(adg_trail_put_vector_at_length(trail, 0, NULL));
+
+    /* The gaps between the segments are not counted */
+    adg_assert_isapprox(adg_trail_get_length(trail), 29 + G_PI);
+
+    g_assert_false(adg_trail_put_pair_at_length(trail, -1, &pair));
+    g_assert_false(adg_trail_put_pair_at_length(trail, 30 + G_PI, &pair));
+
+    g_assert_true(adg_trail_put_pair_at_length(trail, 0, &pair));
+    adg_assert_isapprox(pair.x, 0);
+    adg_assert_isapprox(pair.y, 0);
+    g_assert_true(adg_trail_put_pair_at_length(trail, 5, &pair));
+    adg_assert_isapprox(pair.x, 5);
+    adg_assert_isapprox(pair.y, 0);
+    g_assert_true(adg_trail_put_pair_at_length(trail, 15, &pair));
+    adg_assert_isapprox(pair.x, 0);
+    adg_assert_isapprox(pair.y, 15);
+    g_assert_true(adg_trail_put_pair_at_length(trail, 20 + G_PI_2, &pair));
+    adg_assert_isapprox(pair.x, 0);
+    adg_assert_isapprox(pair.y, 31);
+    g_assert_true(adg_trail_put_pair_at_length(trail, 24.5 + G_PI, &pair));
+    adg_assert_isapprox(pair.x, -1);
+    adg_assert_isapprox(pair.y, 34.5);
+    g_assert_true(adg_trail_put_pair_at_length(trail, 29 + G_PI, &pair));
+    adg_assert_isapprox(pair.x, -1);
+    adg_assert_isapprox(pair.y, 39);
+
+    g_assert_true(adg_trail_put_vector_at_length(trail, 15, &vector));
+    adg_assert_isapprox(vector.x, 0);
+    g_assert_cmpfloat(vector.y, >, 0);
+    g_assert_true(adg_trail_put_vector_at_length(trail, 27 + G_PI, &vector));
+    adg_assert_isapprox(vector.x, 0);
+    g_assert_cmpfloat(vector.y, >, 0);
+
+    /* The cache must be invalidated by a path change */
+    adg_path_line_to_explicit(path, -1, 40);
+    adg_assert_isapprox(adg_trail_get_length(trail), 30 + G_PI);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_method_save(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    const cairo_path_t *original, *loaded;
+    const CpmlPair *pair;
+    gchar *file;
+    GError *error;
+
+    file = g_build_filename(g_get_tmp_dir(), "adg-test-trail.dump", NULL);
+    path = adg_path_new();
+    adg_path_append_cairo_path(path, adg_test_path());
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "P1", 1, 2);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "P2", 3, 4);
+
+    /* Sanity checks */
+    g_assert_false(adg_trail_save(NULL, file, NULL));
+    g_assert_false(adg_trail_save(ADG_TRAIL(path), NULL, NULL));
+    g_assert_null(adg_trail_new_from_file(NULL, NULL));
+
+    g_assert_true(adg_trail_save(ADG_TRAIL(path), file, NULL));
+    trail = adg_trail_new_from_file(file, NULL);
+    g_assert_nonnull(trail);
+
+    /* The primitives, arcs included, must be restored verbatim */
+    original = adg_trail_cairo_path(ADG_TRAIL(path));
+    loaded = adg_trail_cairo_path(trail);
+    g_assert_nonnull(loaded);
+    g_assert_cmpint(loaded->num_data, ==, original->num_data);
+    g_assert_true(memcmp(loaded->data, original->data,
+                         original->num_data * sizeof(cairo_path_data_t)) == 0);
+    g_assert_cmpuint(adg_trail_n_segments(trail), ==,
+                     adg_trail_n_segments(ADG_TRAIL(path)));
+
+    pair = adg_model_get_named_pair(ADG_MODEL(trail), "P1");
+    g_assert_nonnull(pair);
+    adg_assert_isapprox(pair->x, 1);
+    adg_assert_isapprox(pair->y, 2);
+    pair = adg_model_get_named_pair(ADG_MODEL(trail), "P2");
+    g_assert_nonnull(pair);
+    adg_assert_isapprox(pair->x, 3);
+    adg_assert_isapprox(pair->y, 4);
+
+    g_object_unref(trail);
+
+    /* An empty path is still a valid dump */
+    adg_model_reset(ADG_MODEL(path));
+    g_assert_true(adg_trail_save(ADG_TRAIL(path), file, NULL));
+    trail = adg_trail_new_from_file(file, NULL);
+    g_assert_nonnull(trail);
+    g_assert_cmpuint(adg_trail_n_segments(trail), ==, 0);
+    g_assert_null(adg_model_get_named_pair(ADG_MODEL(trail), "P1"));
+    g_object_unref(trail);
+
+    /* Garbage must be refused */
+    g_assert_true(g_file_set_contents(file, "Not a trail dump", -1, NULL));
+    error = NULL;
+    g_assert_null(adg_trail_new_from_file(file, &error));
+    g_assert_error(error, ADG_TRAIL_ERROR, ADG_TRAIL_ERROR_FORMAT);
+    g_error_free(error);
+
+    g_remove(file);
+    g_free(file);
+    g_object_unref(path);
+}
+
+static void
+_adg_method_new_compact(void)
+{
+    AdgTrail *trail, *compact;
+    const cairo_path_t *cairo_path;
+    const CpmlPair *named_pair;
+
+    trail = adg_trail_new(_adg_arc_callback, NULL);
+    adg_model_set_named_pair_explicit(ADG_MODEL(trail), "P1", 1.5, -2);
+
+    /* Invalid input */
+    g_assert_null(adg_trail_new_compact(NULL));
+
+    compact = adg_trail_new_compact(trail);
+    g_assert_nonnull(compact);
+    g_object_unref(trail);
+
+    /* Arcs are preserved as is */
+    cairo_path = adg_trail_cairo_path(compact);
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 5);
+    g_assert_cmpint(cairo_path->data[0].header.type, ==, CPML_MOVE);
+    g_assert_cmpint(cairo_path->data[2].header.type, ==, CPML_ARC);
+    g_assert_cmpint(cairo_path->data[2].header.length, ==, 3);
+    adg_assert_isapprox(cairo_path->data[1].point.x, 1);
+    adg_assert_isapprox(cairo_path->data[4].point.x, -1);
+    adg_assert_isapprox(cairo_path->data[4].point.y, 0);
+
+    named_pair = adg_model_get_named_pair(ADG_MODEL(compact), "P1");
+    g_assert_nonnull(named_pair);
+    adg_assert_isapprox(named_pair->x, 1.5);
+    adg_assert_isapprox(named_pair->y, -2);
+
+    /* Releasing the cache does not change the trail */
+    adg_trail_release_cache(NULL);
+    g_assert_cmpuint(adg_trail_n_segments(compact), ==, 1);
+    adg_trail_release_cache(compact);
+    g_assert_cmpuint(adg_trail_n_segments(compact), ==, 1);
+    cairo_path = adg_trail_get_cairo_path(compact);
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->data[0].header.type, ==, CPML_MOVE);
+    adg_assert_isapprox(cairo_path->data[1].point.x, 1);
+
+    g_object_unref(compact);
+}
+
+static void
+_adg_method_compute_async(void)
+{
+    AdgTrail *trail;
+    gint n_calls, n_changes;
+    const cairo_path_t *cairo_path;
+
+    n_calls = 0;
+    n_changes = 0;
+    trail = adg_trail_new(_adg_counting_callback, &n_calls);
+    g_signal_connect(trail, "changed", G_CALLBACK(_adg_changed), &n_changes);
+
+    /* Invalid input */
+    adg_trail_compute_async(NULL);
+    g_assert_false(adg_trail_is_computing(NULL));
+
+    /* While computing, the trail is empty */
+    g_assert_false(adg_trail_is_computing(trail));
+    adg_trail_compute_async(trail);
+    g_assert_true(adg_trail_is_computing(trail));
+    g_assert_null(adg_trail_cairo_path(trail));
+    g_assert_null(adg_trail_get_cairo_path(trail));
+
+    /* A second request while computing is ignored */
+    adg_trail_compute_async(trail);
+
+    while (adg_trail_is_computing(trail))
+        g_main_context_iteration(NULL, TRUE);
+
+    /* The change is notified once and the computed path is retained */
+    g_assert_cmpint(n_changes, ==, 1);
+    g_assert_cmpint(n_calls, ==, 1);
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 6);
+    g_assert_cmpint(n_calls, ==, 1);
+
+    /* Nothing to do on an already cached path */
+    adg_trail_compute_async(trail);
+    g_assert_false(adg_trail_is_computing(trail));
+    g_assert_cmpint(n_changes, ==, 1);
+
+    g_object_unref(trail);
+}
+
+static void
+_adg_method_freeze(void)
+{
+    AdgTrail *trail;
+    AdgModel *model;
+    AdgPoint *point;
+    const CpmlExtents *extents;
+    const cairo_path_t *cairo_path;
+    CpmlPair pair;
+    gint n_calls;
+
+    n_calls = 0;
+    trail = adg_trail_new(_adg_counting_callback, &n_calls);
+    model = (AdgModel *) trail;
+    adg_model_set_named_pair_explicit(model, "origin", 1, 2);
+
+    point = adg_point_new();
+    adg_point_set_pair_from_model(point, model, "origin");
+
+    /* Sanity checks */
+    adg_model_freeze(NULL);
+    g_assert_false(adg_model_is_frozen(NULL));
+
+    g_assert_false(adg_model_is_frozen(model));
+    adg_model_freeze(model);
+    g_assert_true(adg_model_is_frozen(model));
+    g_assert_cmpint(n_calls, ==, 1);
+
+    /* Freezing twice is harmless */
+    adg_model_freeze(model);
+    g_assert_cmpint(n_calls, ==, 1);
+
+    /* The caches survive any attempt to release them */
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    adg_trail_release_cache(trail);
+    g_assert_true(adg_trail_get_cairo_path(trail) == cairo_path);
+
+    extents = adg_trail_get_extents(trail);
+    g_assert_true(extents->is_defined);
+    g_assert_cmpuint(adg_trail_n_segments(trail), ==, 1);
+    g_assert_true(adg_trail_put_pair_at_length(trail, 0, &pair));
+    adg_assert_isapprox(pair.x, 0);
+    adg_assert_isapprox(pair.y, 1);
+    g_assert_cmpint(n_calls, ==, 1);
+
+    /* Points bound before and after freezing are resolved */
+    g_assert_true(adg_point_update(point));
+    adg_assert_isapprox(((CpmlPair *) point)->x, 1);
+    adg_point_set_pair_from_model(point, model, "undefined");
+    g_assert_false(adg_point_update(point));
+    adg_point_set_pair_from_model(point, model, "origin");
+    g_assert_true(adg_point_update(point));
+    adg_assert_isapprox(((CpmlPair *) point)->y, 2);
+
+    adg_point_destroy(point);
+    g_object_unref(trail);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -171,10 +668,20 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/trail/type/object", ADG_TYPE_TRAIL);
     adg_test_add_model_checks("/adg/trail/type/model", ADG_TYPE_TRAIL);
 
+    g_test_add_func("/adg/trail/behavior/cache", _adg_behavior_cache);
+    g_test_add_func("/adg/trail/behavior/scaling", _adg_behavior_scaling);
+
     g_test_add_func("/adg/trail/property/max-angle", _adg_property_max_angle);
+    g_test_add_func("/adg/trail/property/tolerance", _adg_property_tolerance);
 
     g_test_add_func("/adg/trail/method/n-segments", _adg_method_n_segments);
     g_test_add_func("/adg/trail/method/put-segment", _adg_method_put_segment);
+    g_test_add_func("/adg/trail/method/get-segment-extents", _adg_method_get_segment_extents);
+    g_test_add_func("/adg/trail/method/length", _adg_method_length);
+    g_test_add_func("/adg/trail/method/save", _adg_method_save);
+    g_test_add_func("/adg/trail/method/new-compact", _adg_method_new_compact);
+    g_test_add_func("/adg/trail/method/compute-async", _adg_method_compute_async);
+    g_test_add_func("/adg/trail/method/freeze", _adg_method_freeze);
 
     return g_test_run();
 }
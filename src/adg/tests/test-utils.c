@@ -209,6 +209,38 @@ _adg_method_unescaped_strchr(void)
     g_assert_null(result);
 }
 
+static void
+_adg_method_alloc_stats(void)
+{
+    AdgPath *path;
+    gsize live_bytes, old_live_bytes;
+    guint n_live, n_allocations;
+
+    /* Sanity check */
+    g_assert_false(adg_alloc_stats(1234, NULL, NULL, NULL));
+
+    if (! adg_alloc_stats(ADG_ALLOC_DOMAIN_PATH, &old_live_bytes, NULL, NULL)) {
+        /* Library built without --enable-alloc-trace */
+        return;
+    }
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+
+    g_assert_true(adg_alloc_stats(ADG_ALLOC_DOMAIN_PATH,
+                                  &live_bytes, &n_live, &n_allocations));
+    g_assert_cmpuint(live_bytes, >, old_live_bytes);
+    g_assert_cmpuint(n_live, >, 0);
+    g_assert_cmpuint(n_allocations, >=, n_live);
+
+    g_object_unref(path);
+
+    g_assert_true(adg_alloc_stats(ADG_ALLOC_DOMAIN_PATH,
+                                  &live_bytes, NULL, NULL));
+    g_assert_cmpuint(live_bytes, ==, old_live_bytes);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -227,6 +259,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/method/nop", _adg_method_nop);
     g_test_add_func("/adg/method/round", _adg_method_round);
     g_test_add_func("/adg/method/unescaped-strchr", _adg_method_unescaped_strchr);
+    g_test_add_func("/adg/method/alloc-stats", _adg_method_alloc_stats);
 
     return g_test_run();
 }
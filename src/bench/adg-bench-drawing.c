@@ -0,0 +1,210 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/* Generator of synthetic drawings with a known number of entities.
+ *
+ * Every entity lives in its own 20x20 cell of a square grid, so the
+ * output is reproducible and the extents grow linearly with the entity
+ * count. The entities are grouped by _ADG_FANOUT in leaf containers
+ * nested @depth levels below the canvas, to exercise the container
+ * propagation code. The table cells, if any, are packed in a single
+ * table with _ADG_COLUMNS columns added directly to the canvas. */
+
+
+#include "adg-bench-drawing.h"
+
+#define _ADG_FANOUT     100
+#define _ADG_COLUMNS    10
+
+
+typedef struct {
+    AdgContainer *root;
+    AdgContainer *leaf;
+    guint         depth;
+    guint         n_children;
+    guint         side;
+    guint         n;
+} AdgBenchGrid;
+
+
+static void             _adg_grid_add           (AdgBenchGrid       *grid,
+                                                 AdgEntity      *entity);
+static void             _adg_grid_origin        (AdgBenchGrid       *grid,
+                                                 CpmlPair       *origin);
+static AdgPath *        _adg_square             (const CpmlPair *origin);
+
+
+static void
+_adg_grid_add(AdgBenchGrid *grid, AdgEntity *entity)
+{
+    if (grid->leaf == NULL || grid->n_children >= _ADG_FANOUT) {
+        AdgContainer *parent = grid->root;
+        AdgContainer *child;
+        guint level;
+
+        for (level = 0; level < grid->depth; ++level) {
+            child = adg_container_new();
+            adg_container_add(parent, (AdgEntity *) child);
+            parent = child;
+        }
+
+        grid->leaf = parent;
+        grid->n_children = 0;
+    }
+
+    adg_container_add(grid->leaf, entity);
+    ++grid->n_children;
+    ++grid->n;
+}
+
+static void
+_adg_grid_origin(AdgBenchGrid *grid, CpmlPair *origin)
+{
+    origin->x = (grid->n % grid->side) * 20;
+    origin->y = (grid->n / grid->side) * 20;
+}
+
+static AdgPath *
+_adg_square(const CpmlPair *origin)
+{
+    AdgPath *path = adg_path_new();
+
+    adg_path_move_to_explicit(path, origin->x, origin->y);
+    adg_path_line_to_explicit(path, origin->x + 10, origin->y);
+    adg_path_line_to_explicit(path, origin->x + 10, origin->y + 10);
+    adg_path_line_to_explicit(path, origin->x, origin->y + 10);
+    adg_path_close(path);
+
+    return path;
+}
+
+
+/**
+ * adg_bench_drawing_size:
+ * @drawing: the drawing description
+ *
+ * Gets the number of entities described by @drawing, not counting
+ * the containers and the table.
+ *
+ * Returns: the number of entities.
+ **/
+guint
+adg_bench_drawing_size(const AdgBenchDrawing *drawing)
+{
+    g_return_val_if_fail(drawing != NULL, 0);
+
+    return drawing->n_paths + drawing->n_ldims + drawing->n_adims +
+        drawing->n_rdims + drawing->n_hatches + drawing->n_cells;
+}
+
+/**
+ * adg_bench_drawing_new:
+ * @drawing: the drawing description
+ *
+ * Builds a new canvas filled with the entities described by @drawing.
+ * Two calls with the same description generate the same drawing.
+ *
+ * Returns: (transfer full): the newly created canvas.
+ **/
+AdgCanvas *
+adg_bench_drawing_new(const AdgBenchDrawing *drawing)
+{
+    AdgCanvas *canvas;
+    AdgBenchGrid grid;
+    CpmlPair origin;
+    AdgPath *path;
+    AdgEntity *entity;
+    guint n, size;
+
+    g_return_val_if_fail(drawing != NULL, NULL);
+
+    canvas = adg_canvas_new();
+    size = adg_bench_drawing_size(drawing);
+
+    grid.root = (AdgContainer *) canvas;
+    grid.leaf = NULL;
+    grid.depth = drawing->depth;
+    grid.n_children = 0;
+    grid.side = 1;
+    grid.n = 0;
+    while (grid.side * grid.side < size)
+        ++grid.side;
+
+    for (n = 0; n < drawing->n_paths; ++n) {
+        _adg_grid_origin(&grid, &origin);
+        path = _adg_square(&origin);
+        entity = (AdgEntity *) adg_stroke_new((AdgTrail *) path);
+        g_object_unref(path);
+        _adg_grid_add(&grid, entity);
+    }
+
+    for (n = 0; n < drawing->n_hatches; ++n) {
+        _adg_grid_origin(&grid, &origin);
+        path = _adg_square(&origin);
+        entity = (AdgEntity *) adg_hatch_new((AdgTrail *) path);
+        g_object_unref(path);
+        _adg_grid_add(&grid, entity);
+    }
+
+    for (n = 0; n < drawing->n_ldims; ++n) {
+        _adg_grid_origin(&grid, &origin);
+        entity = (AdgEntity *) adg_ldim_new_full_explicit(origin.x, origin.y,
+                                                          origin.x + 10, origin.y,
+                                                          origin.x + 5, origin.y + 5,
+                                                          0);
+        _adg_grid_add(&grid, entity);
+    }
+
+    for (n = 0; n < drawing->n_adims; ++n) {
+        _adg_grid_origin(&grid, &origin);
+        entity = (AdgEntity *) adg_adim_new_full_explicit(origin.x + 10, origin.y,
+                                                          origin.x, origin.y + 10,
+                                                          origin.x, origin.y,
+                                                          origin.x, origin.y,
+                                                          origin.x + 8, origin.y + 8);
+        _adg_grid_add(&grid, entity);
+    }
+
+    for (n = 0; n < drawing->n_rdims; ++n) {
+        _adg_grid_origin(&grid, &origin);
+        entity = (AdgEntity *) adg_rdim_new_full_explicit(origin.x + 5, origin.y + 5,
+                                                          origin.x + 10, origin.y + 5,
+                                                          origin.x + 15, origin.y + 10);
+        _adg_grid_add(&grid, entity);
+    }
+
+    if (drawing->n_cells > 0) {
+        AdgTable *table = adg_table_new();
+        AdgTableRow *row = NULL;
+        AdgTableCell *cell;
+
+        for (n = 0; n < drawing->n_cells; ++n) {
+            if (n % _ADG_COLUMNS == 0)
+                row = adg_table_row_new(table);
+            cell = adg_table_cell_new_full(row, 20, NULL, "T", TRUE);
+            adg_table_cell_set_text_value(cell, "Value");
+        }
+
+        adg_container_add(grid.root, (AdgEntity *) table);
+    }
+
+    return canvas;
+}
@@ -0,0 +1,141 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/* Helpers shared by the benchmark programs.
+ *
+ * Every benchmark is delimited by adg_bench_start() and
+ * adg_bench_stop(), the latter printing a single line in JSON format
+ * on the standard output, e.g.:
+ *
+ * {"name": "cpml/pair/transform", "iterations": 1000000, "seconds": 0.0123, "ns-per-iteration": 12.3, "allocations": 0}
+ *
+ * The allocations are the ones done through the GLib allocator: the
+ * direct malloc() calls (as done by CPML and cairo) are not counted.
+ * The "bench" make target sets G_SLICE=always-malloc, so also the
+ * GSlice allocations are accounted.
+ * On GLib 2.46 and later the allocator cannot be hooked anymore,
+ * so "allocations" is always null.
+ *
+ * Results that are not timings (e.g. the accuracy of an algorithm)
+ * are printed by adg_bench_report() in the same format, e.g.:
+ *
+ * {"name": "cpml/curve/offset/handcraft", "max-error": 0.00123}
+ */
+
+
+#include <glib-object.h>
+#include <stdlib.h>
+#include "adg-bench.h"
+
+
+static GTimer *         _adg_bench_timer = NULL;
+static guint            _adg_bench_allocations = 0;
+
+
+#if !GLIB_CHECK_VERSION(2, 46, 0)
+
+static gpointer
+_adg_bench_malloc(gsize n_bytes)
+{
+    ++_adg_bench_allocations;
+    return malloc(n_bytes);
+}
+
+static gpointer
+_adg_bench_realloc(gpointer mem, gsize n_bytes)
+{
+    if (mem == NULL)
+        ++_adg_bench_allocations;
+    return realloc(mem, n_bytes);
+}
+
+static gpointer
+_adg_bench_calloc(gsize n_blocks, gsize n_block_bytes)
+{
+    ++_adg_bench_allocations;
+    return calloc(n_blocks, n_block_bytes);
+}
+
+static GMemVTable _adg_bench_vtable = {
+    _adg_bench_malloc,
+    _adg_bench_realloc,
+    free,
+    _adg_bench_calloc,
+    NULL,
+    NULL
+};
+
+#endif
+
+
+void
+adg_bench_init(int *p_argc, char **p_argv[])
+{
+#if !GLIB_CHECK_VERSION(2, 46, 0)
+    /* This must be done before any other GLib call */
+    g_mem_set_vtable(&_adg_bench_vtable);
+#endif
+
+#if GLIB_CHECK_VERSION(2, 34, 0)
+#else
+    /* On GLib older than 2.34.0 g_type_init() *must* be called */
+    g_type_init();
+#endif
+
+    _adg_bench_timer = g_timer_new();
+}
+
+void
+adg_bench_start(void)
+{
+    _adg_bench_allocations = 0;
+    g_timer_start(_adg_bench_timer);
+}
+
+void
+adg_bench_stop(const gchar *name, guint iterations)
+{
+    gdouble seconds;
+    gchar allocations[32];
+
+    g_timer_stop(_adg_bench_timer);
+    seconds = g_timer_elapsed(_adg_bench_timer, NULL);
+
+#if GLIB_CHECK_VERSION(2, 46, 0)
+    g_strlcpy(allocations, "null", sizeof(allocations));
+#else
+    g_snprintf(allocations, sizeof(allocations), "%u", _adg_bench_allocations);
+#endif
+
+    if (iterations == 0)
+        iterations = 1;
+
+    g_print("{\"name\": \"%s\", \"iterations\": %u, \"seconds\": %g, "
+            "\"ns-per-iteration\": %g, \"allocations\": %s}\n",
+            name, iterations, seconds, seconds * 1e9 / iterations,
+            allocations);
+}
+
+void
+adg_bench_report(const gchar *name, const gchar *key, gdouble value)
+{
+    g_print("{\"name\": \"%s\", \"%s\": %g}\n", name, key, value);
+}
@@ -0,0 +1,42 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#ifndef __ADG_BENCH_H__
+#define __ADG_BENCH_H__
+
+#include <glib.h>
+
+
+G_BEGIN_DECLS
+
+void            adg_bench_init                  (int            *p_argc,
+                                                 char          **p_argv[]);
+void            adg_bench_start                 (void);
+void            adg_bench_stop                  (const gchar    *name,
+                                                 guint           iterations);
+void            adg_bench_report                (const gchar    *name,
+                                                 const gchar    *key,
+                                                 gdouble         value);
+
+G_END_DECLS
+
+
+#endif /* __ADG_BENCH_H__ */
@@ -0,0 +1,209 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/* Macro-benchmarks on synthetic drawings: every drawing is measured
+ * while building, arranging, rendering, exporting and destroying it.
+ * The same mix of entities is generated at increasing sizes and nesting
+ * depths, so super-linear behaviors show up in the per-entity times.
+ * Profiles dense of fillets and chamfers are measured on their own */
+
+
+#include <adg.h>
+#include "adg-bench.h"
+#include "adg-bench-drawing.h"
+
+
+static cairo_status_t
+_adg_discard(gpointer closure, const guchar *data, guint length)
+{
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_adg_bench_phase(const gchar *phase, guint n_entities, guint depth)
+{
+    gchar *name = g_strdup_printf("adg/drawing/%u/depth-%u/%s",
+                                  n_entities, depth, phase);
+    adg_bench_stop(name, n_entities);
+    g_free(name);
+}
+
+static void
+_adg_bench_drawing(guint n_entities, guint depth)
+{
+    AdgBenchDrawing drawing;
+    AdgCanvas *canvas;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    /* Mix of entities roughly resembling a mechanical drawing */
+    drawing.n_paths = n_entities / 2;
+    drawing.n_ldims = n_entities * 15 / 100;
+    drawing.n_adims = n_entities / 10;
+    drawing.n_rdims = n_entities / 10;
+    drawing.n_hatches = n_entities / 10;
+    drawing.n_cells = n_entities - drawing.n_paths - drawing.n_ldims -
+        drawing.n_adims - drawing.n_rdims - drawing.n_hatches;
+    drawing.depth = depth;
+
+    adg_bench_start();
+    canvas = adg_bench_drawing_new(&drawing);
+    _adg_bench_phase("build", n_entities, depth);
+
+    adg_bench_start();
+    adg_entity_arrange((AdgEntity *) canvas);
+    _adg_bench_phase("arrange", n_entities, depth);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 800, 600);
+    cr = cairo_create(surface);
+
+    adg_bench_start();
+    adg_entity_render((AdgEntity *) canvas, cr);
+    _adg_bench_phase("render", n_entities, depth);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+#ifdef CAIRO_HAS_PDF_SURFACE
+    adg_bench_start();
+    if (adg_canvas_export_to_stream(canvas, CAIRO_SURFACE_TYPE_PDF,
+                                    _adg_discard, NULL, NULL))
+        _adg_bench_phase("export-pdf", n_entities, depth);
+#endif
+
+    adg_bench_start();
+    adg_entity_destroy((AdgEntity *) canvas);
+    _adg_bench_phase("destroy", n_entities, depth);
+}
+
+static void
+_adg_bench_profile(guint n_corners, gboolean is_fillet)
+{
+    AdgPath *path;
+    gchar *name;
+    guint n;
+
+    /* A staircase profile with a fillet or a chamfer on every corner */
+    adg_bench_start();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    for (n = 0; n < n_corners; ++n) {
+        if (n % 2 == 0)
+            adg_path_line_to_explicit(path, n + 1, n);
+        else
+            adg_path_line_to_explicit(path, n, n + 1);
+
+        if (is_fillet)
+            adg_path_fillet(path, 0.2);
+        else
+            adg_path_chamfer(path, 0.2, 0.2);
+    }
+    adg_path_line_to_explicit(path, n_corners, n_corners + 1);
+
+    name = g_strdup_printf("adg/profile/%u/%s", n_corners,
+                           is_fillet ? "fillet" : "chamfer");
+    adg_bench_stop(name, n_corners);
+    g_free(name);
+
+    g_object_unref(path);
+}
+
+static void
+_adg_bench_named_pairs(guint n_pairs)
+{
+    AdgPath *path, *copy;
+    CpmlPair pair;
+    gchar name[32];
+    gchar *bench_name;
+    guint n;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+    for (n = 0; n < n_pairs; ++n) {
+        g_snprintf(name, sizeof(name), "P%u", n);
+        pair.x = n;
+        pair.y = n + 1;
+        adg_model_set_named_pair((AdgModel *) path, name, &pair);
+    }
+
+    /* Copy every named pair to another model */
+    copy = adg_path_new();
+    adg_bench_start();
+    adg_path_append_trail(copy, (AdgTrail *) path);
+    bench_name = g_strdup_printf("adg/named-pairs/%u/append-trail", n_pairs);
+    adg_bench_stop(bench_name, n_pairs);
+    g_free(bench_name);
+
+    /* Add the reversed duplicate of every named pair */
+    adg_bench_start();
+    adg_path_reflect_explicit(path, 1, 0);
+    bench_name = g_strdup_printf("adg/named-pairs/%u/reflect", n_pairs);
+    adg_bench_stop(bench_name, n_pairs);
+    g_free(bench_name);
+
+    g_object_unref(copy);
+    g_object_unref(path);
+}
+
+static void
+_adg_bench_format_value(guint n_values)
+{
+    AdgDimStyle *dim_style;
+    gchar *text;
+    guint n;
+
+    /* Sexagesimal quotes exercise every conversion stage */
+    dim_style = adg_dim_style_new();
+    adg_dim_style_set_number_arguments(dim_style, "DMs");
+    adg_dim_style_set_number_format(dim_style, "%g°(%g'(%g\"))");
+
+    adg_bench_start();
+    for (n = 0; n < n_values; ++n) {
+        text = adg_dim_style_format_value(dim_style, n * 0.0137);
+        g_free(text);
+    }
+    adg_bench_stop("adg/dim-style/format-value", n_values);
+
+    g_object_unref(dim_style);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_bench_init(&argc, &argv);
+
+    _adg_bench_drawing(1000, 1);
+    _adg_bench_drawing(10000, 1);
+    _adg_bench_drawing(100000, 1);
+
+    _adg_bench_drawing(10000, 4);
+    _adg_bench_drawing(10000, 16);
+
+    _adg_bench_profile(100, TRUE);
+    _adg_bench_profile(10000, TRUE);
+    _adg_bench_profile(10000, FALSE);
+
+    _adg_bench_named_pairs(10000);
+    _adg_bench_format_value(100000);
+
+    return 0;
+}
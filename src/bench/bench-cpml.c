@@ -0,0 +1,580 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/* Micro-benchmarks of the CPML kernels */
+
+
+#include <cpml.h>
+#include "adg-bench.h"
+#include <math.h>
+#include <string.h>
+
+
+#define N_ITERATIONS            1000000
+#define N_OFFSET_SAMPLES        64
+#define OFFSET_DISTANCE         2
+#define OFFSET_TOLERANCE        0.001
+#define N_CURVE_PAIRS           1000
+#define N_REFERENCE_SAMPLES     128
+#define MATCH_DISTANCE          0.01
+
+
+static cairo_path_data_t lines_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 10, 10 }},
+
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 10 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 10, 0 }}
+};
+
+static cairo_path_data_t arc_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 3 }},
+    { .header = { CPML_ARC, 3 }},
+    { .point = { 3, 0 }},
+    { .point = { 0, -3 }}
+};
+
+static cairo_path_data_t segment_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 10, 0 }},
+    { .header = { CPML_ARC, 3 }},
+    { .point = { 15, 5 }},
+    { .point = { 10, 10 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 0, 10 }}
+};
+
+static cairo_path_data_t curve_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_CURVE, 4 }},
+    { .point = { 0, 8 }},
+    { .point = { 2, 10 }},
+    { .point = { 10, 10 }}
+};
+
+static CpmlPrimitive line1 = { NULL, &lines_data[1], &lines_data[2] };
+static CpmlPrimitive line2 = { NULL, &lines_data[5], &lines_data[6] };
+static CpmlPrimitive arc = { NULL, &arc_data[1], &arc_data[2] };
+static CpmlPrimitive curve = { NULL, &curve_data[1], &curve_data[2] };
+
+static const struct {
+    const gchar *               name;
+    CpmlCurveOffsetAlgorithm    algorithm;
+} offset_algorithms[] = {
+    { "geometrical", CPML_CURVE_OFFSET_ALGORITHM_GEOMETRICAL },
+    { "handcraft",   CPML_CURVE_OFFSET_ALGORITHM_HANDCRAFT },
+    { "baioca",      CPML_CURVE_OFFSET_ALGORITHM_BAIOCA }
+};
+
+static const double intersection_tolerances[] = { 1e-3, 1e-6, 1e-9 };
+
+/* Accumulates the results, so the benchmarked calls are not optimized out */
+static volatile double sink = 0;
+
+
+static void
+_cpml_bench_pair_transform(void)
+{
+    cairo_matrix_t matrix;
+    CpmlPair pair;
+    guint n;
+
+    cairo_matrix_init(&matrix, 1, 0.5, -0.5, 1, 3, 4);
+    pair.x = 1;
+    pair.y = 2;
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_pair_transform(&pair, &matrix);
+        pair.x /= 1.2;
+        pair.y /= 1.2;
+    }
+    adg_bench_stop("cpml/pair/transform", N_ITERATIONS);
+
+    sink += pair.x + pair.y;
+}
+
+static void
+_cpml_bench_primitive_intersections(void)
+{
+    CpmlPair dest[2];
+    guint n;
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_primitive_put_intersections(&line1, &line2, 2, dest);
+        sink += dest[0].x;
+    }
+    adg_bench_stop("cpml/primitive/intersections/line-line", N_ITERATIONS);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_primitive_put_intersections(&line1, &arc, 2, dest);
+        sink += dest[0].x;
+    }
+    adg_bench_stop("cpml/primitive/intersections/line-arc", N_ITERATIONS);
+}
+
+static void
+_cpml_bench_segment_offset(void)
+{
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        segment_data,
+        G_N_ELEMENTS(segment_data)
+    };
+    CpmlSegment segment;
+    guint n;
+
+    cpml_segment_from_cairo(&segment, &path);
+
+    /* Alternate the offsets to keep the segment in shape */
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n)
+        cpml_segment_offset(&segment, n % 2 == 0 ? 1 : -1);
+    adg_bench_stop("cpml/segment/offset", N_ITERATIONS);
+
+    sink += segment.data[1].point.x;
+}
+
+static void
+_cpml_bench_segment_extents(void)
+{
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        segment_data,
+        G_N_ELEMENTS(segment_data)
+    };
+    CpmlSegment segment;
+    CpmlExtents extents;
+    guint n;
+
+    cpml_segment_from_cairo(&segment, &path);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_segment_put_extents(&segment, &extents);
+        sink += extents.size.x;
+    }
+    adg_bench_stop("cpml/segment/extents", N_ITERATIONS);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n)
+        sink += cpml_segment_get_length(&segment);
+    adg_bench_stop("cpml/segment/length", N_ITERATIONS);
+}
+
+static void
+_cpml_bench_extents_transform(void)
+{
+    CpmlExtents extents[64];
+    cairo_matrix_t local, global;
+    guint n, k;
+
+    cairo_matrix_init_rotate(&local, G_PI / 6);
+    cairo_matrix_init_scale(&global, 2, 2);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS / G_N_ELEMENTS(extents); ++n) {
+        for (k = 0; k < G_N_ELEMENTS(extents); ++k) {
+            extents[k].is_defined = 1;
+            extents[k].org.x = k;
+            extents[k].org.y = k;
+            extents[k].size.x = 10;
+            extents[k].size.y = 5;
+            cpml_extents_transform(&extents[k], &local);
+            cpml_extents_transform(&extents[k], &global);
+        }
+        sink += extents[0].size.x;
+    }
+    adg_bench_stop("cpml/extents/transform-twice", N_ITERATIONS);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS / G_N_ELEMENTS(extents); ++n) {
+        for (k = 0; k < G_N_ELEMENTS(extents); ++k) {
+            extents[k].is_defined = 1;
+            extents[k].org.x = k;
+            extents[k].org.y = k;
+            extents[k].size.x = 10;
+            extents[k].size.y = 5;
+            cpml_extents_transform_chained(&extents[k], &local, &global);
+        }
+        sink += extents[0].size.x;
+    }
+    adg_bench_stop("cpml/extents/transform-chained", N_ITERATIONS);
+
+    cairo_matrix_multiply(&local, &local, &global);
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS / G_N_ELEMENTS(extents); ++n) {
+        for (k = 0; k < G_N_ELEMENTS(extents); ++k) {
+            extents[k].is_defined = 1;
+            extents[k].org.x = k;
+            extents[k].org.y = k;
+            extents[k].size.x = 10;
+            extents[k].size.y = 5;
+        }
+        cpml_extents_transform_array(extents, G_N_ELEMENTS(extents), &local);
+        sink += extents[0].size.x;
+    }
+    adg_bench_stop("cpml/extents/transform-array", N_ITERATIONS);
+}
+
+static void
+_cpml_bench_path_soa(void)
+{
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        segment_data,
+        G_N_ELEMENTS(segment_data)
+    };
+    CpmlPathSoA *soa;
+    CpmlExtents extents;
+    guint n;
+
+    soa = cpml_path_soa_from_cairo(&path);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_path_soa_put_extents(soa, &extents);
+        sink += extents.size.x;
+    }
+    adg_bench_stop("cpml/path-soa/extents", N_ITERATIONS);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n)
+        sink += cpml_path_soa_get_length(soa);
+    adg_bench_stop("cpml/path-soa/length", N_ITERATIONS);
+
+    cpml_path_soa_destroy(soa);
+}
+
+static void
+_cpml_bench_cursor(void)
+{
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        lines_data,
+        G_N_ELEMENTS(lines_data)
+    };
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlCursor cursor;
+    guint n;
+
+    /* Browse the same primitives with the segment and primitive
+     * iterators and with a read-only cursor */
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_segment_from_cairo(&segment, &path);
+        do {
+            cpml_primitive_from_segment(&primitive, &segment);
+            do {
+                sink += primitive.org->point.x;
+            } while (cpml_primitive_next(&primitive));
+        } while (cpml_segment_next(&segment));
+    }
+    adg_bench_stop("cpml/cursor/segment-browsing", N_ITERATIONS);
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_cursor_from_cairo(&cursor, &path);
+        do {
+            if (cpml_cursor_get_data(&cursor)->header.type != CPML_MOVE)
+                sink += cpml_cursor_get_org(&cursor)->point.x;
+        } while (cpml_cursor_next(&cursor));
+    }
+    adg_bench_stop("cpml/cursor/browsing", N_ITERATIONS);
+}
+
+static void
+_cpml_bench_arc_to_curves(void)
+{
+    cairo_path_data_t data[4 * 4];
+    CpmlSegment segment = { NULL, data, 0 };
+    guint n;
+
+    adg_bench_start();
+    for (n = 0; n < N_ITERATIONS; ++n) {
+        cpml_arc_to_curves(&arc, &segment, 4);
+        sink += data[1].point.x;
+    }
+    adg_bench_stop("cpml/arc/to-curves", N_ITERATIONS);
+}
+
+/* Returns the maximum difference between OFFSET_DISTANCE and the
+ * distance of the points of offseted from the original curve */
+static double
+_cpml_bench_offset_error(const CpmlPrimitive *offseted)
+{
+    CpmlPair pair, closest;
+    double error, max_error;
+    guint n;
+
+    max_error = 0;
+    for (n = 0; n <= N_OFFSET_SAMPLES; ++n) {
+        cpml_curve_put_pair_at_time(offseted,
+                                    (double) n / N_OFFSET_SAMPLES, &pair);
+        cpml_curve_put_pair_at_time(&curve,
+                                    cpml_primitive_get_closest_pos(&curve, &pair),
+                                    &closest);
+        error = fabs(cpml_pair_distance(&pair, &closest) - OFFSET_DISTANCE);
+        if (error > max_error)
+            max_error = error;
+    }
+
+    return max_error;
+}
+
+static void
+_cpml_bench_curve_offset(void)
+{
+    cairo_path_data_t data[G_N_ELEMENTS(curve_data)];
+    cairo_path_data_t curves[64 * 4];
+    CpmlSegment segment = { NULL, curves, 0 };
+    CpmlPrimitive offseted = { NULL, &data[1], &data[2] };
+    CpmlPrimitive chunk;
+    CpmlPair pair;
+    CpmlOffsetContext context;
+    gchar name[64];
+    double max_error;
+    size_t n_curves, n_curve;
+    guint n, n_algorithm;
+
+    context.tolerance = OFFSET_TOLERANCE;
+
+    for (n_algorithm = 0; n_algorithm < G_N_ELEMENTS(offset_algorithms); ++n_algorithm) {
+        context.algorithm = offset_algorithms[n_algorithm].algorithm;
+
+        /* Single curve offset, as done by cpml_primitive_offset() */
+        g_snprintf(name, sizeof(name), "cpml/curve/offset/%s",
+                   offset_algorithms[n_algorithm].name);
+        adg_bench_start();
+        for (n = 0; n < N_ITERATIONS; ++n) {
+            memcpy(data, curve_data, sizeof(data));
+            cpml_primitive_offset_full(&offseted, OFFSET_DISTANCE, &context);
+        }
+        adg_bench_stop(name, N_ITERATIONS);
+        adg_bench_report(name, "max-error", _cpml_bench_offset_error(&offseted));
+        sink += data[5].point.x;
+
+        /* Adaptive offset with error control */
+        g_snprintf(name, sizeof(name), "cpml/curve/offset-to-curves/%s",
+                   offset_algorithms[n_algorithm].name);
+        n_curves = 0;
+        adg_bench_start();
+        for (n = 0; n < N_ITERATIONS / 10; ++n) {
+            n_curves = cpml_curve_offset_to_curves(&curve, OFFSET_DISTANCE,
+                                                   &context, &segment,
+                                                   G_N_ELEMENTS(curves) / 4);
+            sink += curves[3].point.x;
+        }
+        adg_bench_stop(name, N_ITERATIONS / 10);
+        adg_bench_report(name, "curves", n_curves);
+
+        /* Every chunk starts where the previous one ends */
+        max_error = 0;
+        cpml_curve_put_offset_at_time(&curve, 0, OFFSET_DISTANCE, &pair);
+        cpml_pair_to_cairo(&pair, &data[1]);
+        chunk.segment = NULL;
+        chunk.org = &data[1];
+        for (n_curve = 0; n_curve < n_curves; ++n_curve) {
+            chunk.data = &curves[n_curve * 4];
+            max_error = MAX(max_error, _cpml_bench_offset_error(&chunk));
+            chunk.org = &chunk.data[3];
+        }
+        adg_bench_report(name, "max-error", max_error);
+    }
+}
+
+/* Brute force reference: intersects the polylines of the
+ * curves sampled at N_REFERENCE_SAMPLES uniform times */
+static size_t
+_cpml_bench_reference_intersections(const CpmlPrimitive *curve1,
+                                    const CpmlPrimitive *curve2,
+                                    size_t n_dest, CpmlPair *dest)
+{
+    CpmlPair p1[N_REFERENCE_SAMPLES + 1], p2[N_REFERENCE_SAMPLES + 1];
+    CpmlVector v1, v2, w;
+    CpmlPair pair;
+    double factor, t1, t2;
+    size_t n, i, j, k;
+
+    for (i = 0; i <= N_REFERENCE_SAMPLES; ++i) {
+        cpml_curve_put_pair_at_time(curve1, (double) i / N_REFERENCE_SAMPLES, &p1[i]);
+        cpml_curve_put_pair_at_time(curve2, (double) i / N_REFERENCE_SAMPLES, &p2[i]);
+    }
+
+    n = 0;
+    for (i = 0; i < N_REFERENCE_SAMPLES; ++i) {
+        v1.x = p1[i+1].x - p1[i].x;
+        v1.y = p1[i+1].y - p1[i].y;
+        for (j = 0; j < N_REFERENCE_SAMPLES && n < n_dest; ++j) {
+            v2.x = p2[j+1].x - p2[j].x;
+            v2.y = p2[j+1].y - p2[j].y;
+            factor = v1.x * v2.y - v1.y * v2.x;
+            if (factor == 0)
+                continue;
+            w.x = p2[j].x - p1[i].x;
+            w.y = p2[j].y - p1[i].y;
+            t1 = (w.x * v2.y - w.y * v2.x) / factor;
+            t2 = (w.x * v1.y - w.y * v1.x) / factor;
+            if (t1 < 0 || t1 >= 1 || t2 < 0 || t2 >= 1)
+                continue;
+            pair.x = p1[i].x + v1.x * t1;
+            pair.y = p1[i].y + v1.y * t1;
+            for (k = 0; k < n; ++k)
+                if (cpml_pair_distance(&dest[k], &pair) < MATCH_DISTANCE)
+                    break;
+            if (k == n)
+                dest[n++] = pair;
+        }
+    }
+
+    return n;
+}
+
+/* Returns the number of pairs in @expected not found in @found */
+static guint
+_cpml_bench_missed(const CpmlPair *expected, size_t n_expected,
+                   const CpmlPair *found, size_t n_found)
+{
+    guint missed;
+    size_t i, j;
+
+    missed = 0;
+    for (i = 0; i < n_expected; ++i) {
+        for (j = 0; j < n_found; ++j)
+            if (cpml_pair_distance(&expected[i], &found[j]) < MATCH_DISTANCE)
+                break;
+        if (j == n_found)
+            ++missed;
+    }
+
+    return missed;
+}
+
+static void
+_cpml_bench_curve_intersections(void)
+{
+    static cairo_path_data_t data[N_CURVE_PAIRS * 2][5];
+    static CpmlPair reference[N_CURVE_PAIRS][9];
+    static size_t n_reference[N_CURVE_PAIRS];
+    CpmlPrimitive curve1 = { NULL }, curve2 = { NULL };
+    CpmlPair dest[9];
+    GRand *rand;
+    gchar name[64];
+    size_t n_found, n_total;
+    guint n, n_tolerance, missed, spurious;
+    int i;
+
+    /* Random curve pairs in a 10x10 box, repeatable between runs */
+    rand = g_rand_new_with_seed(N_CURVE_PAIRS);
+    for (n = 0; n < N_CURVE_PAIRS * 2; ++n) {
+        data[n][1].header.type = CPML_CURVE;
+        data[n][1].header.length = 4;
+        for (i = 0; i < 5; ++i) {
+            if (i == 1)
+                continue;
+            data[n][i].point.x = g_rand_double_range(rand, 0, 10);
+            data[n][i].point.y = g_rand_double_range(rand, 0, 10);
+        }
+    }
+    g_rand_free(rand);
+
+    n_total = 0;
+    adg_bench_start();
+    for (n = 0; n < N_CURVE_PAIRS; ++n) {
+        curve1.org = &data[n * 2][0];
+        curve1.data = &data[n * 2][1];
+        curve2.org = &data[n * 2 + 1][0];
+        curve2.data = &data[n * 2 + 1][1];
+        n_reference[n] = _cpml_bench_reference_intersections(&curve1, &curve2,
+                                                             9, reference[n]);
+        n_total += n_reference[n];
+    }
+    adg_bench_stop("cpml/curve/intersections/reference", N_CURVE_PAIRS);
+    adg_bench_report("cpml/curve/intersections/reference", "found", n_total);
+
+    for (n_tolerance = 0; n_tolerance < G_N_ELEMENTS(intersection_tolerances); ++n_tolerance) {
+        g_snprintf(name, sizeof(name), "cpml/curve/intersections/subdivision/%g",
+                   intersection_tolerances[n_tolerance]);
+
+        adg_bench_start();
+        for (n = 0; n < N_CURVE_PAIRS; ++n) {
+            curve1.org = &data[n * 2][0];
+            curve1.data = &data[n * 2][1];
+            curve2.org = &data[n * 2 + 1][0];
+            curve2.data = &data[n * 2 + 1][1];
+            n_found = cpml_curve_put_intersections(&curve1, &curve2,
+                                                   intersection_tolerances[n_tolerance],
+                                                   9, dest);
+            sink += n_found;
+        }
+        adg_bench_stop(name, N_CURVE_PAIRS);
+
+        /* Compare the results with the reference, out of the timing */
+        n_total = 0;
+        missed = spurious = 0;
+        for (n = 0; n < N_CURVE_PAIRS; ++n) {
+            curve1.org = &data[n * 2][0];
+            curve1.data = &data[n * 2][1];
+            curve2.org = &data[n * 2 + 1][0];
+            curve2.data = &data[n * 2 + 1][1];
+            n_found = cpml_curve_put_intersections(&curve1, &curve2,
+                                                   intersection_tolerances[n_tolerance],
+                                                   9, dest);
+            n_total += n_found;
+            missed += _cpml_bench_missed(reference[n], n_reference[n], dest, n_found);
+            spurious += _cpml_bench_missed(dest, n_found, reference[n], n_reference[n]);
+        }
+        adg_bench_report(name, "found", n_total);
+        adg_bench_report(name, "missed", missed);
+        adg_bench_report(name, "spurious", spurious);
+    }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_bench_init(&argc, &argv);
+
+    _cpml_bench_pair_transform();
+    _cpml_bench_primitive_intersections();
+    _cpml_bench_segment_offset();
+    _cpml_bench_segment_extents();
+    _cpml_bench_extents_transform();
+    _cpml_bench_path_soa();
+    _cpml_bench_cursor();
+    _cpml_bench_arc_to_curves();
+    _cpml_bench_curve_offset();
+    _cpml_bench_curve_intersections();
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/* Headless benchmark of the AdgGtkArea rendering: the area is drawn on
+ * an offscreen image surface at different zoom levels and pan offsets,
+ * the same way the widget does when handling the draw (or expose)
+ * events. Every iteration is a frame, so the frames per second are
+ * 1e9 / ns-per-iteration */
+
+
+#include <config.h>
+#include <adg.h>
+#include "adg-bench.h"
+#include "adg-bench-drawing.h"
+
+#define N_FRAMES        50
+#define WIDTH           800
+#define HEIGHT          600
+
+
+static void
+_adg_allocate(AdgGtkArea *area, gint width, gint height)
+{
+    GtkAllocation allocation;
+    GtkRequisition requisition;
+
+    /* Newer GTK+3 releases complain if the size is not requested first */
+#ifdef GTK3_ENABLED
+    gtk_widget_get_preferred_size((GtkWidget *) area, &requisition, NULL);
+#else
+    gtk_widget_size_request((GtkWidget *) area, &requisition);
+#endif
+
+    allocation.x = 0;
+    allocation.y = 0;
+    allocation.width = width;
+    allocation.height = height;
+    gtk_widget_size_allocate((GtkWidget *) area, &allocation);
+}
+
+static void
+_adg_draw(AdgGtkArea *area, cairo_t *cr)
+{
+#ifdef GTK3_ENABLED
+    gtk_widget_draw((GtkWidget *) area, cr);
+#else
+    /* GTK+2 renders inside expose-event, that needs a real window:
+     * replicate what it does on the offscreen surface */
+    cairo_save(cr);
+    cairo_transform(cr, adg_gtk_area_get_render_map(area));
+    adg_entity_render((AdgEntity *) adg_gtk_area_get_canvas(area), cr);
+    cairo_restore(cr);
+#endif
+}
+
+static void
+_adg_bench_view(AdgGtkArea *area, gdouble zoom, gdouble pan)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    cairo_matrix_t map;
+    gchar *name;
+    guint n;
+
+    cairo_matrix_init_scale(&map, zoom, zoom);
+    cairo_matrix_translate(&map, -pan, -pan);
+    adg_gtk_area_set_render_map(area, &map);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+    cr = cairo_create(surface);
+
+    /* First frame out of the measure: it arranges the canvas */
+    _adg_draw(area, cr);
+
+    name = g_strdup_printf("adg/gtk-area/zoom-%g/pan-%g", zoom, pan);
+    adg_bench_start();
+    for (n = 0; n < N_FRAMES; ++n)
+        _adg_draw(area, cr);
+    adg_bench_stop(name, N_FRAMES);
+    g_free(name);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+/* Every frame resizes the area, so the render map is recomputed by
+ * the autozoom code before drawing */
+static void
+_adg_bench_autozoom(AdgGtkArea *area)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    guint n;
+
+    adg_gtk_area_switch_autozoom(area, TRUE);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+    cr = cairo_create(surface);
+
+    adg_bench_start();
+    for (n = 0; n < N_FRAMES; ++n) {
+        _adg_allocate(area, WIDTH - n % 2 * 100, HEIGHT - n % 2 * 100);
+        _adg_draw(area, cr);
+    }
+    adg_bench_stop("adg/gtk-area/autozoom", N_FRAMES);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    adg_gtk_area_switch_autozoom(area, FALSE);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    static const gdouble zooms[] = { 0.25, 1, 4 };
+    static const gdouble pans[] = { 0, 500, 2000 };
+    AdgBenchDrawing drawing = { 5000, 1500, 1000, 1000, 1000, 500, 1 };
+    AdgCanvas *canvas;
+    GtkWidget *area;
+    guint i, j;
+
+    if (! gtk_init_check(&argc, &argv)) {
+        g_printerr("Unable to initialize GTK+: gtk-area benchmarks skipped\n");
+        return 0;
+    }
+
+    adg_bench_init(&argc, &argv);
+
+    canvas = adg_bench_drawing_new(&drawing);
+    area = adg_gtk_area_new_with_canvas(canvas);
+    g_object_unref(canvas);
+    g_object_ref_sink(area);
+    _adg_allocate((AdgGtkArea *) area, WIDTH, HEIGHT);
+
+    for (i = 0; i < G_N_ELEMENTS(zooms); ++i)
+        for (j = 0; j < G_N_ELEMENTS(pans); ++j)
+            _adg_bench_view((AdgGtkArea *) area, zooms[i], pans[j]);
+
+    _adg_bench_autozoom((AdgGtkArea *) area);
+
+    gtk_widget_destroy(area);
+    g_object_unref(area);
+
+    return 0;
+}
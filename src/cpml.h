@@ -28,8 +28,12 @@
 #include "cpml/cpml-primitive.h"
 #include "cpml/cpml-arc.h"
 #include "cpml/cpml-curve.h"
+#include "cpml/cpml-path-soa.h"
+#include "cpml/cpml-cursor.h"
 
+#ifndef CPML_DISABLE_GOBJECT
 #include <glib-object.h>
 #include "cpml/cpml-gobject.h"
+#endif
 
 #endif /* __CPML_H__ */
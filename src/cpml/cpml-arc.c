@@ -60,6 +60,11 @@
  * approach as it allows to specify the number of curves to use and do
  * not need a cairo context.
  *
+ * Computing the center and the angles of an arc is relatively
+ * expensive: when the same arcs are inspected over and over, a
+ * #CpmlArcCache can be bound to each arc and the ..._cached()
+ * variants of the above APIs used instead.
+ *
  * <important>
  * <title>TODO</title>
  * <itemizedlist>
@@ -73,6 +78,17 @@
  * Since: 1.0
  **/
 
+/**
+ * CpmlArcCache:
+ *
+ * An opaque structure holding the geometry of an arc (center, radius
+ * and angles) together with the points it has been computed from.
+ * It can be allocated on the stack or embedded in other structs but
+ * it must be initialized with cpml_arc_cache_invalidate() before use.
+ *
+ * Since: 1.0
+ **/
+
 
 #include "cpml-internal.h"
 #include "cpml-extents.h"
@@ -119,6 +135,12 @@ static void     arc_to_curve            (CpmlPrimitive          *curve,
                                          double                  r,
                                          double                  start,
                                          double                  end);
+static void     arc_to_curves           (CpmlSegment            *segment,
+                                         const CpmlPair         *center,
+                                         double                  r,
+                                         double                  start,
+                                         double                  end,
+                                         size_t                  n_curves);
 static int      circle_line             (const CpmlPair         *center,
                                          double                  r,
                                          const CpmlPair         *p1,
@@ -284,21 +306,117 @@ cpml_arc_to_curves(const CpmlPrimitive *arc, CpmlSegment *segment,
 {
     CpmlPair center;
     double r, start, end;
-    double step, angle;
-    CpmlPrimitive curve;
 
     if (!cpml_arc_info(arc, &center, &r, &start, &end))
         return;
 
-    step = (end-start) / (double) n_curves;
-    segment->num_data = n_curves*4;
-    curve.segment = segment;
-    curve.data = segment->data;
+    arc_to_curves(segment, &center, r, start, end, n_curves);
+}
 
-    for (angle = start; n_curves--; angle += step) {
-        arc_to_curve(&curve, &center, r, angle, angle+step);
-        curve.data += 4;
+/**
+ * cpml_arc_cache_invalidate:
+ * @cache: (inout): a #CpmlArcCache
+ *
+ * Invalidates @cache, so the next lookup will recompute the arc
+ * data. Any #CpmlArcCache must be initialized with this function
+ * (or filled with zeros) before its first use.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_arc_cache_invalidate(CpmlArcCache *cache)
+{
+    cache->status = 0;
+}
+
+/**
+ * cpml_arc_info_cached:
+ * @arc:    (in):               the #CpmlPrimitive arc data
+ * @cache:  (inout):            the #CpmlArcCache bound to @arc
+ * @center: (out) (allow-none): where to store the center coordinates
+ * @r:      (out) (allow-none): where to store the radius
+ * @start:  (out) (allow-none): where to store the starting angle
+ * @end:    (out) (allow-none): where to store the ending angle
+ *
+ * Works in the same way as cpml_arc_info() but the result is taken
+ * from @cache if the three points of @arc did not change since the
+ * last call, avoiding the computation of the center and the angles.
+ * Otherwise the result is recomputed and stored in @cache.
+ *
+ * The points are compared by value, so @cache can be safely kept
+ * across modifications of the path containing @arc: a changed arc
+ * simply misses the cache.
+ *
+ * Returns: (type boolean): 1 if the function worked succesfully, 0 on errors.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_arc_info_cached(const CpmlPrimitive *arc, CpmlArcCache *cache,
+                     CpmlPair *center, double *r, double *start, double *end)
+{
+    CpmlPair p[3];
+
+    cpml_pair_from_cairo(&p[0], arc->org);
+    cpml_pair_from_cairo(&p[1], &arc->data[1]);
+    cpml_pair_from_cairo(&p[2], &arc->data[2]);
+
+    if (cache->status == 0 ||
+        ! cpml_pair_equal(&p[0], &cache->p[0]) ||
+        ! cpml_pair_equal(&p[1], &cache->p[1]) ||
+        ! cpml_pair_equal(&p[2], &cache->p[2])) {
+        cache->p[0] = p[0];
+        cache->p[1] = p[1];
+        cache->p[2] = p[2];
+
+        if (get_center(p, &cache->center)) {
+            cache->r = cpml_pair_distance(&p[0], &cache->center);
+            get_angles(p, &cache->center, &cache->start, &cache->end);
+            cache->status = 1;
+        } else {
+            /* Cache also the failures */
+            cache->status = -1;
+        }
     }
+
+    if (cache->status < 0)
+        return 0;
+
+    if (center != NULL)
+        *center = cache->center;
+    if (r != NULL)
+        *r = cache->r;
+    if (start != NULL)
+        *start = cache->start;
+    if (end != NULL)
+        *end = cache->end;
+
+    return 1;
+}
+
+/**
+ * cpml_arc_to_curves_cached:
+ * @arc:      (in):    the #CpmlPrimitive arc data
+ * @cache:    (inout): the #CpmlArcCache bound to @arc
+ * @segment:  (out):   the destination #CpmlSegment
+ * @n_curves: (in):    number of Bézier to use
+ *
+ * Works in the same way as cpml_arc_to_curves() but gets the arc
+ * data through cpml_arc_info_cached().
+ *
+ * Since: 1.0
+ **/
+void
+cpml_arc_to_curves_cached(const CpmlPrimitive *arc, CpmlArcCache *cache,
+                          CpmlSegment *segment, size_t n_curves)
+{
+    CpmlPair center;
+    double r, start, end;
+
+    if (!cpml_arc_info_cached(arc, cache, &center, &r, &start, &end))
+        return;
+
+    arc_to_curves(segment, &center, r, start, end, n_curves);
 }
 
 
@@ -574,6 +692,24 @@ arc_to_curve(CpmlPrimitive *curve, const CpmlPair *center,
     curve->data[3].point.y = center->y + r_sin2;
 }
 
+static void
+arc_to_curves(CpmlSegment *segment, const CpmlPair *center,
+              double r, double start, double end, size_t n_curves)
+{
+    double step, angle;
+    CpmlPrimitive curve;
+
+    step = (end-start) / (double) n_curves;
+    segment->num_data = n_curves*4;
+    curve.segment = segment;
+    curve.data = segment->data;
+
+    for (angle = start; n_curves--; angle += step) {
+        arc_to_curve(&curve, center, r, angle, angle+step);
+        curve.data += 4;
+    }
+}
+
 static int
 circle_line(const CpmlPair *center, double r,
             const CpmlPair *p1, const CpmlPair *p2,
@@ -29,6 +29,19 @@
 
 CAIRO_BEGIN_DECLS
 
+typedef struct _CpmlArcCache CpmlArcCache;
+
+struct _CpmlArcCache {
+    /*< private >*/
+    int          status;
+    CpmlPair     p[3];
+    CpmlPair     center;
+    double       r;
+    double       start;
+    double       end;
+};
+
+
 int             cpml_arc_info           (const CpmlPrimitive    *arc,
                                          CpmlPair               *center,
                                          double                 *r,
@@ -39,6 +52,19 @@ void            cpml_arc_to_cairo       (const CpmlPrimitive    *arc,
 void            cpml_arc_to_curves      (const CpmlPrimitive    *arc,
                                          CpmlSegment            *segment,
                                          size_t                  n_curves);
+void            cpml_arc_cache_invalidate
+                                        (CpmlArcCache           *cache);
+int             cpml_arc_info_cached    (const CpmlPrimitive    *arc,
+                                         CpmlArcCache           *cache,
+                                         CpmlPair               *center,
+                                         double                 *r,
+                                         double                 *start,
+                                         double                 *end);
+void            cpml_arc_to_curves_cached
+                                        (const CpmlPrimitive    *arc,
+                                         CpmlArcCache           *cache,
+                                         CpmlSegment            *segment,
+                                         size_t                  n_curves);
 
 CAIRO_END_DECLS
 
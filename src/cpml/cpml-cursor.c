@@ -0,0 +1,315 @@
+/* CPML - Cairo Path Manipulation Library
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:cpml-cursor
+ * @Section_Id:CpmlCursor
+ * @title: CpmlCursor
+ * @short_description: Read-only browsing of cairo path data
+ *
+ * A #CpmlCursor walks the primitives of a #cairo_path_t without
+ * touching the path and without building any #CpmlSegment or
+ * #CpmlPrimitive on the way. It only keeps the offsets of the current
+ * primitive, of its origin and of the previous primitive, so the data
+ * of the current and the previous primitive are always available
+ * without copying any struct.
+ *
+ * Differently from the segment API, every primitive is returned,
+ * %CPML_MOVE included: it is up to the caller to skip them if needed.
+ * This makes a #CpmlCursor the preferred way to scan a whole path
+ * when the primitives are only read, e.g. to collect or to convert
+ * them.
+ *
+ * <informalexample><programlisting language="C">
+ * CpmlCursor cursor;
+ * const cairo_path_data_t *data;
+ *
+ * if (cpml_cursor_from_cairo(&cursor, path)) {
+ *     do {
+ *         data = cpml_cursor_get_data(&cursor);
+ *         ...
+ *     } while (cpml_cursor_next(&cursor));
+ * }
+ * </programlisting></informalexample>
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * CpmlCursor:
+ *
+ * An opaque struct, meant to be allocated on the stack and
+ * initialized by cpml_cursor_from_cairo(). It refers to the data
+ * of the source path, so that path must outlive the cursor.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "cpml-internal.h"
+#include "cpml-extents.h"
+#include "cpml-segment.h"
+#include "cpml-primitive.h"
+#include "cpml-cursor.h"
+
+
+static int      is_valid                (const CpmlCursor       *cursor,
+                                         int                     offset);
+static void     step                    (CpmlCursor             *cursor);
+
+
+/**
+ * cpml_cursor_from_cairo:
+ * @cursor: (out): the destination #CpmlCursor
+ * @path: (in):    the source #cairo_path_t
+ *
+ * Initializes @cursor to the first primitive of @path. No copy of
+ * @path is done, so its data must be kept alive while @cursor is
+ * in use.
+ *
+ * This function will fail if @path is empty, if its first primitive
+ * is not valid or if its <structfield>status</structfield> member is
+ * not %CAIRO_STATUS_SUCCESS.
+ *
+ * Returns: (type gboolean): 1 on success, 0 on errors.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_cursor_from_cairo(CpmlCursor *cursor, const cairo_path_t *path)
+{
+    if (path->num_data <= 0 || path->status != CAIRO_STATUS_SUCCESS)
+        return 0;
+
+    cursor->data = path->data;
+    cursor->num_data = path->num_data;
+    cpml_cursor_reset(cursor);
+
+    return is_valid(cursor, 0);
+}
+
+/**
+ * cpml_cursor_reset:
+ * @cursor: (inout): a #CpmlCursor
+ *
+ * Moves @cursor back to the first primitive of the source path.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_cursor_reset(CpmlCursor *cursor)
+{
+    cursor->offset = 0;
+    cursor->org = -1;
+    cursor->prev = -1;
+    cursor->move = cursor->data->header.type == CPML_MOVE ? 0 : -1;
+}
+
+/**
+ * cpml_cursor_next:
+ * @cursor: (inout): a #CpmlCursor
+ *
+ * Moves @cursor to the next primitive of the source path. If there
+ * are no more primitives or the next one is not valid, @cursor is
+ * not changed and 0 is returned.
+ *
+ * Returns: (type gboolean): 1 on success, 0 if no next primitive found.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_cursor_next(CpmlCursor *cursor)
+{
+    const cairo_path_data_t *data = cursor->data + cursor->offset;
+
+    if (! is_valid(cursor, cursor->offset + data->header.length))
+        return 0;
+
+    step(cursor);
+    return 1;
+}
+
+/**
+ * cpml_cursor_prev:
+ * @cursor: (inout): a #CpmlCursor
+ *
+ * Moves @cursor to the previous primitive of the source path. If
+ * @cursor is on the first primitive, it is not changed and 0 is
+ * returned.
+ *
+ * The header lengths can only be walked forward, so the offsets
+ * needed by the previous primitive are recomputed by browsing the
+ * path from the start. If you only need to read the previous
+ * primitive, use cpml_cursor_get_prev() instead: it is immediate.
+ *
+ * Returns: (type gboolean): 1 on success, 0 if no previous primitive found.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_cursor_prev(CpmlCursor *cursor)
+{
+    int prev = cursor->prev;
+
+    if (prev < 0)
+        return 0;
+
+    cpml_cursor_reset(cursor);
+    while (cursor->offset < prev)
+        step(cursor);
+
+    return 1;
+}
+
+/**
+ * cpml_cursor_peek:
+ * @cursor: a #CpmlCursor
+ *
+ * Gets the primitive following the current one without moving
+ * @cursor.
+ *
+ * Returns: (transfer none): the header of the next primitive or %NULL if
+ *                           there are no more valid primitives.
+ *
+ * Since: 1.0
+ **/
+const cairo_path_data_t *
+cpml_cursor_peek(const CpmlCursor *cursor)
+{
+    int offset = cursor->offset + cursor->data[cursor->offset].header.length;
+
+    return is_valid(cursor, offset) ? cursor->data + offset : NULL;
+}
+
+/**
+ * cpml_cursor_get_data:
+ * @cursor: a #CpmlCursor
+ *
+ * Gets the current primitive, that is its header followed by its
+ * points, in the same format used by #CpmlPrimitive.
+ *
+ * Returns: (transfer none): the header of the current primitive.
+ *
+ * Since: 1.0
+ **/
+const cairo_path_data_t *
+cpml_cursor_get_data(const CpmlCursor *cursor)
+{
+    return cursor->data + cursor->offset;
+}
+
+/**
+ * cpml_cursor_get_org:
+ * @cursor: a #CpmlCursor
+ *
+ * Gets the origin of the current primitive, that is the end point of
+ * the previous one. After a %CPML_CLOSE this is the start point of
+ * the closed segment, as it happens in cairo.
+ *
+ * Returns: (transfer none): the origin point or %NULL if the current
+ *                           primitive has no origin.
+ *
+ * Since: 1.0
+ **/
+const cairo_path_data_t *
+cpml_cursor_get_org(const CpmlCursor *cursor)
+{
+    return cursor->org < 0 ? NULL : cursor->data + cursor->org;
+}
+
+/**
+ * cpml_cursor_get_prev:
+ * @cursor: a #CpmlCursor
+ *
+ * Gets the primitive preceding the current one without moving
+ * @cursor.
+ *
+ * Returns: (transfer none): the header of the previous primitive or
+ *                           %NULL if @cursor is on the first one.
+ *
+ * Since: 1.0
+ **/
+const cairo_path_data_t *
+cpml_cursor_get_prev(const CpmlCursor *cursor)
+{
+    return cursor->prev < 0 ? NULL : cursor->data + cursor->prev;
+}
+
+/**
+ * cpml_cursor_get_offset:
+ * @cursor: a #CpmlCursor
+ *
+ * Gets the position of the current primitive, expressed as the index
+ * of its header in the data array of the source path.
+ *
+ * Returns: the offset of the current primitive.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_cursor_get_offset(const CpmlCursor *cursor)
+{
+    return cursor->offset;
+}
+
+
+static int
+is_valid(const CpmlCursor *cursor, int offset)
+{
+    int length;
+
+    if (offset >= cursor->num_data)
+        return 0;
+
+    length = cursor->data[offset].header.length;
+    return length >= 1 && length <= cursor->num_data - offset;
+}
+
+/*
+ * step:
+ * @cursor: a #CpmlCursor
+ *
+ * Unconditionally moves @cursor to the next primitive, updating the
+ * offsets of the origin, of the previous primitive and of the last
+ * %CPML_MOVE. The next primitive must have been already validated.
+ */
+static void
+step(CpmlCursor *cursor)
+{
+    const cairo_path_data_t *data = cursor->data + cursor->offset;
+    int length = data->header.length;
+
+    /* As in cpml_primitive_from_segment(), the origin after a
+     * CPML_MOVE is its first point, even with embedded data */
+    if (data->header.type == CPML_CLOSE)
+        cursor->org = cursor->move < 0 ? -1 : cursor->move + 1;
+    else if (data->header.type == CPML_MOVE)
+        cursor->org = length > 1 ? cursor->offset + 1 : -1;
+    else if (length > 1)
+        cursor->org = cursor->offset + length - 1;
+    else
+        cursor->org = -1;
+
+    cursor->prev = cursor->offset;
+    cursor->offset += length;
+
+    if (cursor->data[cursor->offset].header.type == CPML_MOVE)
+        cursor->move = cursor->offset;
+}
@@ -0,0 +1,63 @@
+/* CPML - Cairo Path Manipulation Library
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__CPML_H__)
+#error "Only <cpml/cpml.h> can be included directly."
+#endif
+
+
+#ifndef __CPML_CURSOR_H__
+#define __CPML_CURSOR_H__
+
+
+CAIRO_BEGIN_DECLS
+
+typedef struct _CpmlCursor CpmlCursor;
+
+struct _CpmlCursor {
+    /*< private >*/
+    const cairo_path_data_t *data;
+    int                      num_data;
+    int                      offset;
+    int                      org;
+    int                      prev;
+    int                      move;
+};
+
+
+int     cpml_cursor_from_cairo          (CpmlCursor             *cursor,
+                                         const cairo_path_t     *path);
+void    cpml_cursor_reset               (CpmlCursor             *cursor);
+int     cpml_cursor_next                (CpmlCursor             *cursor);
+int     cpml_cursor_prev                (CpmlCursor             *cursor);
+const cairo_path_data_t *
+        cpml_cursor_peek                (const CpmlCursor       *cursor);
+const cairo_path_data_t *
+        cpml_cursor_get_data            (const CpmlCursor       *cursor);
+const cairo_path_data_t *
+        cpml_cursor_get_org             (const CpmlCursor       *cursor);
+const cairo_path_data_t *
+        cpml_cursor_get_prev            (const CpmlCursor       *cursor);
+int     cpml_cursor_get_offset          (const CpmlCursor       *cursor);
+
+CAIRO_END_DECLS
+
+
+#endif /* __CPML_CURSOR_H__ */
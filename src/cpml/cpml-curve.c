@@ -34,18 +34,10 @@
  * <itemizedlist>
  * <listitem>the <function>get_length</function> method must be
  *           implemented;</listitem>
- * <listitem>actually the <function>put_extents</function> method is
- *           implemented by computing the bounding box of the control
- *           polygon and this will likely include some empty space:
- *           there is room for improvements;</listitem>
  * <listitem>the <function>put_pair_at</function> method must be
  *           implemented;</listitem>
  * <listitem>the <function>put_vector_at</function> method must be
  *           implemented;</listitem>
- * <listitem>the <function>get_closest_pos</function> method must be
- *           implemented;</listitem>
- * <listitem>the <function>put_intersections</function> method must be
- *           implemented;</listitem>
  * </itemizedlist>
  * </important>
  *
@@ -84,25 +76,115 @@
  * Since: 1.0
  **/
 
+/**
+ * CpmlOffsetContext:
+ * @algorithm: the algorithm to use for offsetting curves
+ * @tolerance: the maximum allowed error
+ *
+ * Settings for a single offset operation, to be passed to functions
+ * such as cpml_primitive_offset_full() or cpml_segment_offset_full().
+ *
+ * @algorithm overrides the process-wide algorithm selected with
+ * cpml_curve_offset_algorithm(): use #CPML_CURVE_OFFSET_ALGORITHM_NONE
+ * to fall back to it. Because a context is not shared, different
+ * threads can offset curves with different algorithms at the same
+ * time.
+ *
+ * @tolerance is used only by the functions that can generate more
+ * curves to approximate a single one, such as
+ * cpml_curve_offset_to_curves(): the in-place offset functions
+ * ignore it.
+ *
+ * Since: 1.0
+ **/
+
 
 #include "cpml-internal.h"
 #include "cpml-extents.h"
 #include "cpml-segment.h"
 #include "cpml-primitive.h"
 #include "cpml-primitive-private.h"
+#include "cpml-arc.h"
 #include "cpml-curve.h"
+#include <math.h>
 
 #define DEFAULT_ALGORITHM   offset_handcraft
+#define CLOSEST_SEEDS       16
+#define CLOSEST_ITERATIONS  8
+#define OFFSET_MAX_DEPTH    8
+#define OFFSET_SAMPLES      3
+#define INTERSECTION_TOLERANCE  1e-9
+#define INTERSECTION_MAX_DEPTH  40
+
+
+/* A chunk of the curve pending to be offseted by
+ * cpml_curve_offset_to_curves(): @depth is the number of
+ * splits done to get it out of the original curve */
+typedef struct {
+    CpmlPair    p[4];
+    int         depth;
+} OffsetPiece;
+
+/* Two chunks of curve pending to be intersected */
+typedef struct {
+    OffsetPiece a, b;
+} IntersectionPiece;
 
 
 static void     put_extents             (const CpmlPrimitive    *curve,
                                          CpmlExtents            *extents);
+static int      derivative_roots        (double                  p0,
+                                         double                  p1,
+                                         double                  p2,
+                                         double                  p3,
+                                         double                 *t);
+static double   get_closest_pos         (const CpmlPrimitive    *curve,
+                                         const CpmlPair         *pair);
 static void     offset_geometrical      (CpmlPrimitive          *curve,
                                          double                  offset);
 static void     offset_handcraft        (CpmlPrimitive          *curve,
                                          double                  offset);
 static void     offset_baioca           (CpmlPrimitive          *curve,
                                          double                  offset);
+static void     piece_to_primitive      (const OffsetPiece      *piece,
+                                         cairo_path_data_t      *data,
+                                         CpmlPrimitive          *curve);
+static void     piece_split             (const OffsetPiece      *piece,
+                                         OffsetPiece            *left,
+                                         OffsetPiece            *right);
+static double   offset_error            (const CpmlPrimitive    *curve,
+                                         const CpmlPrimitive    *offseted,
+                                         double                  offset);
+static size_t   put_intersections       (const CpmlPrimitive    *curve,
+                                         const CpmlPrimitive    *primitive,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
+static void     piece_box               (const OffsetPiece      *piece,
+                                         CpmlPair               *min,
+                                         CpmlPair               *max);
+static int      piece_is_flat           (const OffsetPiece      *piece,
+                                         double                  tolerance);
+static size_t   store_intersection      (CpmlPair               *dest,
+                                         size_t                  n,
+                                         const CpmlPair         *pair,
+                                         double                  tolerance);
+static size_t   curve_line              (const OffsetPiece      *curve,
+                                         const CpmlPair         *p1,
+                                         const CpmlPair         *p2,
+                                         double                  tolerance,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
+static size_t   curve_circle            (const OffsetPiece      *curve,
+                                         const CpmlPair         *center,
+                                         double                  r,
+                                         double                  tolerance,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
+static size_t   curve_curve             (const OffsetPiece      *curve,
+                                         const OffsetPiece      *curve2,
+                                         double                  tolerance,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
 
 /* class_data is outside get_class so it can be modified by other methods */
 static _CpmlPrimitiveClass class_data = {
@@ -111,8 +193,8 @@ static _CpmlPrimitiveClass class_data = {
     put_extents,
     NULL,
     NULL,
-    NULL,
-    NULL,
+    get_closest_pos,
+    put_intersections,
     DEFAULT_ALGORITHM,
     NULL
 };
@@ -139,7 +221,8 @@ _cpml_curve_get_class(void)
  * This function is <emphasis>not thread-safe</emphasis>. If you
  * are changing the algorithm in a thread environment you must
  * ensure by yourself no other threads are calling #CpmlCurve
- * methods in the meantime.
+ * methods in the meantime. Alternatively, specify the algorithm
+ * per call with a #CpmlOffsetContext.
  * </para></important>
  *
  * Returns: the previous algorithm used.
@@ -182,6 +265,31 @@ cpml_curve_offset_algorithm(CpmlCurveOffsetAlgorithm new_algorithm)
     return old_algorithm;
 }
 
+/* Offsets @curve with the algorithm specified by @context: the
+ * switch avoids the indirect call through class_data */
+void
+_cpml_curve_offset(CpmlPrimitive *curve, double offset,
+                   const CpmlOffsetContext *context)
+{
+    switch (context != NULL ? context->algorithm : CPML_CURVE_OFFSET_ALGORITHM_NONE) {
+    case CPML_CURVE_OFFSET_ALGORITHM_DEFAULT:
+        DEFAULT_ALGORITHM(curve, offset);
+        break;
+    case CPML_CURVE_OFFSET_ALGORITHM_GEOMETRICAL:
+        offset_geometrical(curve, offset);
+        break;
+    case CPML_CURVE_OFFSET_ALGORITHM_HANDCRAFT:
+        offset_handcraft(curve, offset);
+        break;
+    case CPML_CURVE_OFFSET_ALGORITHM_BAIOCA:
+        offset_baioca(curve, offset);
+        break;
+    default:
+        class_data.offset(curve, offset);
+        break;
+    }
+}
+
 /**
  * cpml_curve_put_pair_at_time:
  * @curve: the #CpmlPrimitive curve data
@@ -293,22 +401,232 @@ cpml_curve_put_offset_at_time(const CpmlPrimitive *curve,
     pair->y += vector.y;
 }
 
+/**
+ * cpml_curve_offset_to_curves:
+ * @curve:      (in):              the #CpmlPrimitive curve data
+ * @offset:     (in):              the offset distance
+ * @context:    (in) (allow-none): the offset settings
+ * @segment:    (out):             the destination #CpmlSegment
+ * @max_curves: (in):              maximum number of Bézier to generate
+ *
+ * Offsets @curve by @offset and puts the result inside @segment as
+ * a serie of Bézier curves. Differently from cpml_primitive_offset(),
+ * the original curve is not modified and it is recursively split in
+ * halves until the distance of the offseted curves from @curve does
+ * not differ from @offset more than the tolerance of @context.
+ *
+ * Every chunk is offseted with the algorithm of @context or, if not
+ * specified, with the one selected by cpml_curve_offset_algorithm().
+ * A %NULL @context is the same as a null tolerance with no specific
+ * algorithm. The number of generated curves (and hence the speed)
+ * depends on the algorithm quality. The error
+ * is estimated by checking few intermediate points of the offseted
+ * chunks against the closest points on @curve.
+ *
+ * The subdivision stops anyway when @max_curves is reached or after
+ * a fixed amount of recursion levels, so the tolerance can be
+ * exceeded on degenerated curves (e.g. curves with cusps). A null
+ * tolerance splits @curve as much as allowed.
+ *
+ * @segment must have enough space to contain at least @max_curves
+ * curves (that is 4 * @max_curves #cairo_path_data_t). As in
+ * cpml_arc_to_curves(), the start point of the first curve is not
+ * stored: it is the offset of the start point of @curve, as
+ * returned by cpml_curve_put_offset_at_time() at time 0.
+ *
+ * Returns: the number of curves stored in @segment.
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_curve_offset_to_curves(const CpmlPrimitive *curve, double offset,
+                            const CpmlOffsetContext *context,
+                            CpmlSegment *segment, size_t max_curves)
+{
+    OffsetPiece stack[OFFSET_MAX_DEPTH + 1];
+    OffsetPiece piece;
+    cairo_path_data_t src_data[5], dst_data[5];
+    CpmlPrimitive src, dst;
+    cairo_path_data_t *data;
+    size_t n_stack, n_curves;
+    double tolerance;
+    int n;
+
+    segment->num_data = 0;
+    if (max_curves == 0)
+        return 0;
+
+    for (n = 0; n < 4; ++n)
+        cpml_primitive_put_point(curve, n, &stack[0].p[n]);
+    stack[0].depth = 0;
+    n_stack = 1;
+    tolerance = context != NULL ? context->tolerance : 0;
+    n_curves = 0;
+    data = segment->data;
+
+    /* Depth-first visit: the left half is always popped first,
+     * so the curves are generated in the proper order */
+    while (n_stack > 0) {
+        piece = stack[--n_stack];
+        piece_to_primitive(&piece, src_data, &src);
+        piece_to_primitive(&piece, dst_data, &dst);
+        _cpml_curve_offset(&dst, offset, context);
+
+        /* Splitting requires a slot for every pending piece
+         * plus the two new halves */
+        if (piece.depth < OFFSET_MAX_DEPTH &&
+            n_curves + n_stack + 2 <= max_curves &&
+            offset_error(&src, &dst, offset) > tolerance) {
+            piece_split(&piece, &stack[n_stack+1], &stack[n_stack]);
+            n_stack += 2;
+            continue;
+        }
+
+        data[0].header.type = CPML_CURVE;
+        data[0].header.length = 4;
+        data[1] = dst_data[2];
+        data[2] = dst_data[3];
+        data[3] = dst_data[4];
+        data += 4;
+        ++n_curves;
+    }
+
+    segment->num_data = n_curves * 4;
+    return n_curves;
+}
+
+/**
+ * cpml_curve_put_intersections:
+ * @curve:                                              the #CpmlPrimitive curve data
+ * @primitive:                                          the other #CpmlPrimitive
+ * @tolerance:                                          the maximum allowed error
+ * @n_dest:                                             maximum number of intersections to return
+ * @dest: (out caller-allocates) (array length=n_dest): the destination buffer that can contain @n_dest #CpmlPair
+ *
+ * Finds the intersections between the @curve Bézier cubic and
+ * @primitive by recursively subdividing @curve (and @primitive, if
+ * it is a curve too). Chunks whose control polygons cannot meet are
+ * pruned, so only the chunks close to an intersection are split up
+ * to when they differ from their chords less than @tolerance. Those
+ * chords are then intersected as lines.
+ *
+ * As done by the other primitives, lines are considered infinite and
+ * arcs are considered full circles: the points are always on @curve
+ * but can be outside @primitive. A non-positive @tolerance selects
+ * the default one, used by cpml_primitive_put_intersections(). Tangent
+ * points could be missed.
+ *
+ * Returns: the number of intersection points found.
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_curve_put_intersections(const CpmlPrimitive *curve,
+                             const CpmlPrimitive *primitive,
+                             double tolerance,
+                             size_t n_dest, CpmlPair *dest)
+{
+    OffsetPiece piece, piece2;
+    CpmlPair p1, p2;
+    double r;
+    int n;
+
+    if (n_dest == 0)
+        return 0;
+
+    if (tolerance <= 0)
+        tolerance = INTERSECTION_TOLERANCE;
+
+    for (n = 0; n < 4; ++n)
+        cpml_primitive_put_point(curve, n, &piece.p[n]);
+    piece.depth = 0;
+
+    switch ((int) cpml_primitive_type(primitive)) {
+
+    case CPML_LINE:
+    case CPML_CLOSE:
+        cpml_primitive_put_point(primitive, 0, &p1);
+        cpml_primitive_put_point(primitive, -1, &p2);
+        return curve_line(&piece, &p1, &p2, tolerance, n_dest, dest);
+
+    case CPML_ARC:
+        if (!cpml_arc_info(primitive, &p1, &r, NULL, NULL))
+            return 0;
+        return curve_circle(&piece, &p1, r, tolerance, n_dest, dest);
+
+    case CPML_CURVE:
+        for (n = 0; n < 4; ++n)
+            cpml_primitive_put_point(primitive, n, &piece2.p[n]);
+        piece2.depth = 0;
+        return curve_curve(&piece, &piece2, tolerance, n_dest, dest);
+    }
+
+    return 0;
+}
+
+
 static void
 put_extents(const CpmlPrimitive *curve, CpmlExtents *extents)
 {
-    CpmlPair p1, p2, p3, p4;
+    CpmlPair p[4], pair;
+    double t[4];
+    int n, n_t;
 
     extents->is_defined = 0;
 
-    cpml_primitive_put_point(curve, 0, &p1);
-    cpml_primitive_put_point(curve, 1, &p2);
-    cpml_primitive_put_point(curve, 2, &p3);
-    cpml_primitive_put_point(curve, 3, &p4);
+    for (n = 0; n < 4; ++ n)
+        cpml_primitive_put_point(curve, n, &p[n]);
 
-    cpml_extents_pair_add(extents, &p1);
-    cpml_extents_pair_add(extents, &p2);
-    cpml_extents_pair_add(extents, &p3);
-    cpml_extents_pair_add(extents, &p4);
+    cpml_extents_pair_add(extents, &p[0]);
+    cpml_extents_pair_add(extents, &p[3]);
+
+    /* The curve can go beyond its end points only where one of
+     * its coordinates has a local minimum or maximum */
+    n_t = derivative_roots(p[0].x, p[1].x, p[2].x, p[3].x, t);
+    n_t += derivative_roots(p[0].y, p[1].y, p[2].y, p[3].y, t + n_t);
+
+    for (n = 0; n < n_t; ++ n) {
+        cpml_curve_put_pair_at_time(curve, t[n], &pair);
+        cpml_extents_pair_add(extents, &pair);
+    }
+}
+
+/* Stores in @t the roots inside (0, 1) of the derivative of the
+ * cubic Bézier polynomial with @p0, @p1, @p2 and @p3 as control
+ * coordinates, returning their number (at most 2) */
+static int
+derivative_roots(double p0, double p1, double p2, double p3, double *t)
+{
+    double a, b, c, d, root[2];
+    int n, n_root, n_t;
+
+    /* The derivative, divided by 3, is a t^2 + b t + c */
+    a = p3 - p0 + 3 * (p1 - p2);
+    b = 2 * (p0 - 2 * p1 + p2);
+    c = p1 - p0;
+
+    if (a < 1e-12 && a > -1e-12) {
+        if (b < 1e-12 && b > -1e-12)
+            return 0;
+        root[0] = -c / b;
+        n_root = 1;
+    } else {
+        d = b * b - 4 * a * c;
+        if (d < 0)
+            return 0;
+        d = sqrt(d);
+        root[0] = (-b + d) / (2 * a);
+        root[1] = (-b - d) / (2 * a);
+        n_root = 2;
+    }
+
+    n_t = 0;
+    for (n = 0; n < n_root; ++ n) {
+        if (root[n] > 0 && root[n] < 1)
+            t[n_t++] = root[n];
+    }
+
+    return n_t;
 }
 
 static int
@@ -526,3 +844,426 @@ offset_baioca(CpmlPrimitive *curve, double offset)
     if (! baioca(curve, offset, t, n))
         offset_geometrical(curve, offset);
 }
+
+/* The closest point is seeded by sampling the curve as a polyline and
+ * then refined with few Newton iterations on the derivative of the
+ * squared distance: the returned value is the time of that point */
+static double
+get_closest_pos(const CpmlPrimitive *curve, const CpmlPair *pair)
+{
+    CpmlPair p1, p2, p3, p4;
+    CpmlPair a, b, c, d, diff, d1, d2;
+    double t, t_best, dt, distance, distance_best, f, df;
+    int n;
+
+    cpml_primitive_put_point(curve, 0, &p1);
+    cpml_primitive_put_point(curve, 1, &p2);
+    cpml_primitive_put_point(curve, 2, &p3);
+    cpml_primitive_put_point(curve, 3, &p4);
+
+    /* Polynomial form: B(t) = a t^3 + b t^2 + c t + d */
+    a.x = p4.x - 3 * p3.x + 3 * p2.x - p1.x;
+    a.y = p4.y - 3 * p3.y + 3 * p2.y - p1.y;
+    b.x = 3 * (p3.x - 2 * p2.x + p1.x);
+    b.y = 3 * (p3.y - 2 * p2.y + p1.y);
+    c.x = 3 * (p2.x - p1.x);
+    c.y = 3 * (p2.y - p1.y);
+    d.x = p1.x - pair->x;
+    d.y = p1.y - pair->y;
+
+    /* Coarse polyline seed */
+    t_best = 0;
+    distance_best = d.x * d.x + d.y * d.y;
+    for (n = 1; n <= CLOSEST_SEEDS; ++n) {
+        t = (double) n / CLOSEST_SEEDS;
+        diff.x = ((a.x * t + b.x) * t + c.x) * t + d.x;
+        diff.y = ((a.y * t + b.y) * t + c.y) * t + d.y;
+        distance = diff.x * diff.x + diff.y * diff.y;
+        if (distance < distance_best) {
+            distance_best = distance;
+            t_best = t;
+        }
+    }
+
+    /* Newton refinement with a bounded number of iterations */
+    t = t_best;
+    for (n = 0; n < CLOSEST_ITERATIONS; ++n) {
+        diff.x = ((a.x * t + b.x) * t + c.x) * t + d.x;
+        diff.y = ((a.y * t + b.y) * t + c.y) * t + d.y;
+        d1.x = (3 * a.x * t + 2 * b.x) * t + c.x;
+        d1.y = (3 * a.y * t + 2 * b.y) * t + c.y;
+        d2.x = 6 * a.x * t + 2 * b.x;
+        d2.y = 6 * a.y * t + 2 * b.y;
+
+        f = diff.x * d1.x + diff.y * d1.y;
+        df = d1.x * d1.x + d1.y * d1.y + diff.x * d2.x + diff.y * d2.y;
+        if (df == 0)
+            break;
+
+        dt = f / df;
+        t -= dt;
+        if (t < 0)
+            t = 0;
+        else if (t > 1)
+            t = 1;
+
+        if (dt < 1e-9 && dt > -1e-9)
+            break;
+    }
+
+    /* Newton could diverge: keep the seed if it is still better */
+    diff.x = ((a.x * t + b.x) * t + c.x) * t + d.x;
+    diff.y = ((a.y * t + b.y) * t + c.y) * t + d.y;
+    distance = diff.x * diff.x + diff.y * diff.y;
+
+    return distance <= distance_best ? t : t_best;
+}
+
+static void
+piece_to_primitive(const OffsetPiece *piece, cairo_path_data_t *data,
+                   CpmlPrimitive *curve)
+{
+    cpml_pair_to_cairo(&piece->p[0], &data[0]);
+    data[1].header.type = CPML_CURVE;
+    data[1].header.length = 4;
+    cpml_pair_to_cairo(&piece->p[1], &data[2]);
+    cpml_pair_to_cairo(&piece->p[2], &data[3]);
+    cpml_pair_to_cairo(&piece->p[3], &data[4]);
+
+    curve->segment = NULL;
+    curve->org = &data[0];
+    curve->data = &data[1];
+}
+
+/* De Casteljau subdivision at t=0.5 */
+static void
+piece_split(const OffsetPiece *piece, OffsetPiece *left, OffsetPiece *right)
+{
+    const CpmlPair *p = piece->p;
+    CpmlPair p01, p12, p23, p012, p123, mid;
+
+    p01.x = (p[0].x + p[1].x) / 2;
+    p01.y = (p[0].y + p[1].y) / 2;
+    p12.x = (p[1].x + p[2].x) / 2;
+    p12.y = (p[1].y + p[2].y) / 2;
+    p23.x = (p[2].x + p[3].x) / 2;
+    p23.y = (p[2].y + p[3].y) / 2;
+    p012.x = (p01.x + p12.x) / 2;
+    p012.y = (p01.y + p12.y) / 2;
+    p123.x = (p12.x + p23.x) / 2;
+    p123.y = (p12.y + p23.y) / 2;
+    mid.x = (p012.x + p123.x) / 2;
+    mid.y = (p012.y + p123.y) / 2;
+
+    cpml_pair_copy(&right->p[0], &mid);
+    cpml_pair_copy(&right->p[1], &p123);
+    cpml_pair_copy(&right->p[2], &p23);
+    cpml_pair_copy(&right->p[3], &p[3]);
+    right->depth = piece->depth + 1;
+
+    cpml_pair_copy(&left->p[0], &p[0]);
+    cpml_pair_copy(&left->p[1], &p01);
+    cpml_pair_copy(&left->p[2], &p012);
+    cpml_pair_copy(&left->p[3], &mid);
+    left->depth = piece->depth + 1;
+}
+
+/* Returns the maximum difference between the expected @offset and the
+ * distance of some point of @offseted from its closest point on @curve */
+static double
+offset_error(const CpmlPrimitive *curve, const CpmlPrimitive *offseted,
+             double offset)
+{
+    CpmlPair pair, closest;
+    double error, max_error;
+    int n;
+
+    max_error = 0;
+    for (n = 1; n <= OFFSET_SAMPLES; ++n) {
+        cpml_curve_put_pair_at_time(offseted,
+                                    (double) n / (OFFSET_SAMPLES + 1),
+                                    &pair);
+        cpml_curve_put_pair_at_time(curve, get_closest_pos(curve, &pair),
+                                    &closest);
+        error = fabs(cpml_pair_distance(&pair, &closest) - fabs(offset));
+        if (error > max_error)
+            max_error = error;
+    }
+
+    return max_error;
+}
+
+static size_t
+put_intersections(const CpmlPrimitive *curve, const CpmlPrimitive *primitive,
+                  size_t n_dest, CpmlPair *dest)
+{
+    return cpml_curve_put_intersections(curve, primitive, 0, n_dest, dest);
+}
+
+/* Bounding box of the control polygon: for the convex hull
+ * property it contains the whole chunk of curve */
+static void
+piece_box(const OffsetPiece *piece, CpmlPair *min, CpmlPair *max)
+{
+    int n;
+
+    cpml_pair_copy(min, &piece->p[0]);
+    cpml_pair_copy(max, &piece->p[0]);
+
+    for (n = 1; n < 4; ++n) {
+        if (piece->p[n].x < min->x)
+            min->x = piece->p[n].x;
+        else if (piece->p[n].x > max->x)
+            max->x = piece->p[n].x;
+        if (piece->p[n].y < min->y)
+            min->y = piece->p[n].y;
+        else if (piece->p[n].y > max->y)
+            max->y = piece->p[n].y;
+    }
+}
+
+/* Checks if the inner control points are closer than @tolerance to
+ * the chord and do not fall outside its ends, that is if the chunk of
+ * curve can be replaced by its chord */
+static int
+piece_is_flat(const OffsetPiece *piece, double tolerance)
+{
+    CpmlVector v, w;
+    double length, cross, dot;
+    int n;
+
+    v.x = piece->p[3].x - piece->p[0].x;
+    v.y = piece->p[3].y - piece->p[0].y;
+    length = v.x * v.x + v.y * v.y;
+
+    for (n = 1; n < 3; ++n) {
+        w.x = piece->p[n].x - piece->p[0].x;
+        w.y = piece->p[n].y - piece->p[0].y;
+
+        if (length == 0) {
+            if (w.x * w.x + w.y * w.y > tolerance * tolerance)
+                return 0;
+            continue;
+        }
+
+        cross = v.x * w.y - v.y * w.x;
+        dot = v.x * w.x + v.y * w.y;
+        if (cross * cross > tolerance * tolerance * length ||
+            dot < 0 || dot > length)
+            return 0;
+    }
+
+    return 1;
+}
+
+/* Appends @pair to @dest, unless it is the same intersection found
+ * on both sides of a split point. Returns the new number of pairs */
+static size_t
+store_intersection(CpmlPair *dest, size_t n, const CpmlPair *pair,
+                   double tolerance)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        if (cpml_pair_squared_distance(dest + i, pair) <= tolerance * tolerance)
+            return n;
+
+    cpml_pair_copy(dest + n, pair);
+    return n + 1;
+}
+
+static size_t
+curve_line(const OffsetPiece *curve, const CpmlPair *p1, const CpmlPair *p2,
+           double tolerance, size_t n_dest, CpmlPair *dest)
+{
+    OffsetPiece stack[INTERSECTION_MAX_DEPTH + 1];
+    OffsetPiece piece;
+    CpmlVector v;
+    CpmlPair pair;
+    double d[4], factor;
+    size_t n_stack, n;
+    int i, above, below;
+
+    v.x = p2->x - p1->x;
+    v.y = p2->y - p1->y;
+    if (v.x == 0 && v.y == 0)
+        return 0;
+
+    stack[0] = *curve;
+    n_stack = 1;
+    n = 0;
+
+    while (n_stack > 0 && n < n_dest) {
+        piece = stack[--n_stack];
+
+        /* Scaled distances of the control points from the line:
+         * if all of them are on the same side, the curve is too */
+        above = below = 0;
+        for (i = 0; i < 4; ++i) {
+            d[i] = v.x * (piece.p[i].y - p1->y) - v.y * (piece.p[i].x - p1->x);
+            above += d[i] >= 0;
+            below += d[i] <= 0;
+        }
+        if (above == 0 || below == 0)
+            continue;
+
+        if (piece.depth < INTERSECTION_MAX_DEPTH &&
+            !piece_is_flat(&piece, tolerance)) {
+            piece_split(&piece, &stack[n_stack+1], &stack[n_stack]);
+            n_stack += 2;
+            continue;
+        }
+
+        /* Intersect the chord */
+        if (d[0] * d[3] > 0 || d[0] == d[3])
+            continue;
+
+        factor = d[0] / (d[0] - d[3]);
+        pair.x = piece.p[0].x + (piece.p[3].x - piece.p[0].x) * factor;
+        pair.y = piece.p[0].y + (piece.p[3].y - piece.p[0].y) * factor;
+        n = store_intersection(dest, n, &pair, tolerance);
+    }
+
+    return n;
+}
+
+static size_t
+curve_circle(const OffsetPiece *curve, const CpmlPair *center, double r,
+             double tolerance, size_t n_dest, CpmlPair *dest)
+{
+    OffsetPiece stack[INTERSECTION_MAX_DEPTH + 1];
+    OffsetPiece piece;
+    CpmlPair min, max, pair;
+    CpmlVector v, w;
+    double dx, dy, near, far, a, b, c, delta, t[2];
+    size_t n_stack, n;
+    int i;
+
+    stack[0] = *curve;
+    n_stack = 1;
+    n = 0;
+
+    while (n_stack > 0 && n < n_dest) {
+        piece = stack[--n_stack];
+
+        /* Skip the chunks whose box is fully inside or outside
+         * the circle: they cannot cross its circumference */
+        piece_box(&piece, &min, &max);
+        dx = center->x < min.x ? min.x - center->x :
+             center->x > max.x ? center->x - max.x : 0;
+        dy = center->y < min.y ? min.y - center->y :
+             center->y > max.y ? center->y - max.y : 0;
+        near = dx * dx + dy * dy;
+        dx = center->x - min.x > max.x - center->x ?
+             center->x - min.x : max.x - center->x;
+        dy = center->y - min.y > max.y - center->y ?
+             center->y - min.y : max.y - center->y;
+        far = dx * dx + dy * dy;
+        if (near > r * r || far < r * r)
+            continue;
+
+        if (piece.depth < INTERSECTION_MAX_DEPTH &&
+            !piece_is_flat(&piece, tolerance)) {
+            piece_split(&piece, &stack[n_stack+1], &stack[n_stack]);
+            n_stack += 2;
+            continue;
+        }
+
+        /* Intersect the chord: |p0 + v t - center|² = r² */
+        v.x = piece.p[3].x - piece.p[0].x;
+        v.y = piece.p[3].y - piece.p[0].y;
+        w.x = piece.p[0].x - center->x;
+        w.y = piece.p[0].y - center->y;
+        a = v.x * v.x + v.y * v.y;
+        b = 2 * (v.x * w.x + v.y * w.y);
+        c = w.x * w.x + w.y * w.y - r * r;
+        delta = b * b - 4 * a * c;
+        if (a == 0 || delta < 0)
+            continue;
+
+        delta = sqrt(delta);
+        t[0] = (-b - delta) / (2 * a);
+        t[1] = (-b + delta) / (2 * a);
+
+        for (i = 0; i < 2 && n < n_dest; ++i) {
+            if (t[i] < 0 || t[i] > 1)
+                continue;
+            pair.x = piece.p[0].x + v.x * t[i];
+            pair.y = piece.p[0].y + v.y * t[i];
+            n = store_intersection(dest, n, &pair, tolerance);
+        }
+    }
+
+    return n;
+}
+
+static size_t
+curve_curve(const OffsetPiece *curve, const OffsetPiece *curve2,
+            double tolerance, size_t n_dest, CpmlPair *dest)
+{
+    IntersectionPiece stack[INTERSECTION_MAX_DEPTH * 2 + 1];
+    IntersectionPiece piece;
+    CpmlPair min, max, min2, max2, pair;
+    CpmlVector v, v2, w;
+    double factor, t, t2;
+    size_t n_stack, n;
+    int flat, flat2;
+
+    stack[0].a = *curve;
+    stack[0].b = *curve2;
+    n_stack = 1;
+    n = 0;
+
+    while (n_stack > 0 && n < n_dest) {
+        piece = stack[--n_stack];
+
+        piece_box(&piece.a, &min, &max);
+        piece_box(&piece.b, &min2, &max2);
+        if (min.x > max2.x || min2.x > max.x ||
+            min.y > max2.y || min2.y > max.y)
+            continue;
+
+        flat = piece.a.depth >= INTERSECTION_MAX_DEPTH ||
+               piece_is_flat(&piece.a, tolerance);
+        flat2 = piece.b.depth >= INTERSECTION_MAX_DEPTH ||
+                piece_is_flat(&piece.b, tolerance);
+
+        /* Split the bigger chunk between the not yet flat ones */
+        if (!flat && (flat2 || (max.x - min.x) + (max.y - min.y) >=
+                               (max2.x - min2.x) + (max2.y - min2.y))) {
+            stack[n_stack + 1].b = piece.b;
+            stack[n_stack].b = piece.b;
+            piece_split(&piece.a, &stack[n_stack+1].a, &stack[n_stack].a);
+            n_stack += 2;
+            continue;
+        } else if (!flat2) {
+            stack[n_stack + 1].a = piece.a;
+            stack[n_stack].a = piece.a;
+            piece_split(&piece.b, &stack[n_stack+1].b, &stack[n_stack].b);
+            n_stack += 2;
+            continue;
+        }
+
+        /* Intersect the chords */
+        v.x = piece.a.p[3].x - piece.a.p[0].x;
+        v.y = piece.a.p[3].y - piece.a.p[0].y;
+        v2.x = piece.b.p[3].x - piece.b.p[0].x;
+        v2.y = piece.b.p[3].y - piece.b.p[0].y;
+        factor = v.x * v2.y - v.y * v2.x;
+        if (factor == 0)
+            continue;
+
+        w.x = piece.b.p[0].x - piece.a.p[0].x;
+        w.y = piece.b.p[0].y - piece.a.p[0].y;
+        t = (w.x * v2.y - w.y * v2.x) / factor;
+        t2 = (w.x * v.y - w.y * v.x) / factor;
+        if (t < 0 || t > 1 || t2 < 0 || t2 > 1)
+            continue;
+
+        pair.x = piece.a.p[0].x + v.x * t;
+        pair.y = piece.a.p[0].y + v.y * t;
+        n = store_intersection(dest, n, &pair, tolerance);
+    }
+
+    return n;
+}
@@ -34,6 +34,14 @@ typedef enum {
     CPML_CURVE_OFFSET_ALGORITHM_BAIOCA,
 } CpmlCurveOffsetAlgorithm;
 
+typedef struct _CpmlOffsetContext CpmlOffsetContext;
+
+struct _CpmlOffsetContext {
+    /*< public >*/
+    CpmlCurveOffsetAlgorithm    algorithm;
+    double                      tolerance;
+};
+
 CAIRO_BEGIN_DECLS
 
 CpmlCurveOffsetAlgorithm
@@ -48,6 +56,16 @@ void    cpml_curve_put_offset_at_time   (const CpmlPrimitive     *curve,
                                          double                   t,
                                          double                   offset,
                                          CpmlPair                *pair);
+size_t  cpml_curve_offset_to_curves     (const CpmlPrimitive     *curve,
+                                         double                   offset,
+                                         const CpmlOffsetContext *context,
+                                         CpmlSegment             *segment,
+                                         size_t                   max_curves);
+size_t  cpml_curve_put_intersections    (const CpmlPrimitive     *curve,
+                                         const CpmlPrimitive     *primitive,
+                                         double                   tolerance,
+                                         size_t                   n_dest,
+                                         CpmlPair                *dest);
 
 CAIRO_END_DECLS
 
@@ -50,6 +50,10 @@
 #include <math.h>
 
 
+static void     transform_box           (CpmlExtents            *extents,
+                                         const cairo_matrix_t   *matrix);
+
+
 /**
  * cpml_extents_copy:
  * @extents: (out): the destination #CpmlExtents
@@ -213,6 +217,34 @@ cpml_extents_is_inside(const CpmlExtents *extents, const CpmlExtents *src)
     return ps.x <= pe.x && ps.y <= pe.y;
 }
 
+/**
+ * cpml_extents_overlap:
+ * @extents: a #CpmlExtents
+ * @src:     another #CpmlExtents
+ *
+ * Checks wheter @extents and @src have at least one point in common.
+ * If any of them is undefined, 0 will be returned. The borders are
+ * considered inside, so the result is coherent with
+ * cpml_extents_pair_is_inside(): if 0 is returned, no pair can be
+ * inside both @extents and @src.
+ *
+ * Returns: (type gboolean): 1 if @extents and @src overlap, 0 otherwise.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_extents_overlap(const CpmlExtents *extents, const CpmlExtents *src)
+{
+    if (extents->is_defined == 0 || src->is_defined == 0 ||
+        src->org.x > extents->org.x + extents->size.x ||
+        src->org.y > extents->org.y + extents->size.y ||
+        extents->org.x > src->org.x + src->size.x ||
+        extents->org.y > src->org.y + src->size.y)
+        return 0;
+
+    return 1;
+}
+
 /**
  * cpml_extents_pair_is_inside:
  * @extents: the container #CpmlExtents
@@ -275,3 +307,82 @@ cpml_extents_transform(CpmlExtents *extents, const cairo_matrix_t *matrix)
     cpml_extents_pair_add(extents, &p[2]);
     cpml_extents_pair_add(extents, &p[3]);
 }
+
+/**
+ * cpml_extents_transform_array:
+ * @extents:   (inout) (array length=n_extents): an array of #CpmlExtents
+ * @n_extents: (in):    number of items in @extents
+ * @matrix:    (in):    the transformation matrix
+ *
+ * Transforms all the @n_extents items of @extents with @matrix, skipping
+ * the undefined ones. The result is the same of calling
+ * cpml_extents_transform() on every item but the corners are not
+ * explicitly computed: the extents of the transformed box are derived
+ * directly from the matrix coefficients, so this is considerably
+ * cheaper when working on many extents.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_extents_transform_array(CpmlExtents *extents, size_t n_extents,
+                             const cairo_matrix_t *matrix)
+{
+    size_t n;
+
+    for (n = 0; n < n_extents; ++ n) {
+        if (extents[n].is_defined)
+            transform_box(&extents[n], matrix);
+    }
+}
+
+/**
+ * cpml_extents_transform_chained:
+ * @extents: (inout): the container #CpmlExtents
+ * @first:   (in):    the first transformation matrix
+ * @second:  (in):    the transformation matrix to apply after @first
+ *
+ * Transforms @extents with @first and then with @second in a single
+ * pass. This is the same as calling cpml_extents_transform() twice,
+ * but the intermediate bounding box is not computed: if the matrices
+ * rotate or shear the shape, the result is tighter and it matches the
+ * transformation of the original box by the combined matrix.
+ *
+ * A typical use is applying the local and the global matrices of an
+ * entity to some extents expressed in model space.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_extents_transform_chained(CpmlExtents *extents,
+                               const cairo_matrix_t *first,
+                               const cairo_matrix_t *second)
+{
+    cairo_matrix_t matrix;
+
+    if (extents->is_defined == 0)
+        return;
+
+    cairo_matrix_multiply(&matrix, first, second);
+    transform_box(extents, &matrix);
+}
+
+
+/* The extents of the box transformed by @matrix are computed by
+ * transforming the origin and projecting the size on both axes */
+static void
+transform_box(CpmlExtents *extents, const cairo_matrix_t *matrix)
+{
+    double x, y, dx1, dx2, dy1, dy2;
+
+    x = matrix->xx * extents->org.x + matrix->xy * extents->org.y + matrix->x0;
+    y = matrix->yx * extents->org.x + matrix->yy * extents->org.y + matrix->y0;
+    dx1 = matrix->xx * extents->size.x;
+    dx2 = matrix->xy * extents->size.y;
+    dy1 = matrix->yx * extents->size.x;
+    dy2 = matrix->yy * extents->size.y;
+
+    extents->org.x = x + (dx1 < 0 ? dx1 : 0) + (dx2 < 0 ? dx2 : 0);
+    extents->org.y = y + (dy1 < 0 ? dy1 : 0) + (dy2 < 0 ? dy2 : 0);
+    extents->size.x = fabs(dx1) + fabs(dx2);
+    extents->size.y = fabs(dy1) + fabs(dy2);
+}
@@ -52,10 +52,18 @@ void            cpml_extents_pair_add           (CpmlExtents       *extents,
                                                  const CpmlPair    *src);
 int             cpml_extents_is_inside          (const CpmlExtents *extents,
                                                  const CpmlExtents *src);
+int             cpml_extents_overlap            (const CpmlExtents *extents,
+                                                 const CpmlExtents *src);
 int             cpml_extents_pair_is_inside     (const CpmlExtents *extents,
                                                  const CpmlPair    *src);
 void            cpml_extents_transform          (CpmlExtents       *extents,
                                                  const cairo_matrix_t *matrix);
+void            cpml_extents_transform_array    (CpmlExtents       *extents,
+                                                 size_t             n_extents,
+                                                 const cairo_matrix_t *matrix);
+void            cpml_extents_transform_chained  (CpmlExtents       *extents,
+                                                 const cairo_matrix_t *first,
+                                                 const cairo_matrix_t *second);
 
 CAIRO_END_DECLS
 
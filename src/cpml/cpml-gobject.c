@@ -309,3 +309,38 @@ cpml_primitive_type_get_type(void)
 
     return etype;
 }
+
+GType
+cpml_boolean_operation_get_type(void)
+{
+    static GType etype = 0;
+    if (G_UNLIKELY(etype == 0)) {
+        static const GEnumValue values[] = {
+            { CPML_BOOLEAN_UNION, "CPML_BOOLEAN_UNION", "union" },
+            { CPML_BOOLEAN_INTERSECTION, "CPML_BOOLEAN_INTERSECTION", "intersection" },
+            { CPML_BOOLEAN_DIFFERENCE, "CPML_BOOLEAN_DIFFERENCE", "difference" },
+            { 0, NULL, NULL }
+        };
+
+        etype = g_enum_register_static("CpmlBooleanOperation", values);
+    }
+
+    return etype;
+}
+
+GType
+cpml_trig_mode_get_type(void)
+{
+    static GType etype = 0;
+    if (G_UNLIKELY(etype == 0)) {
+        static const GEnumValue values[] = {
+            { CPML_TRIG_EXACT, "CPML_TRIG_EXACT", "exact" },
+            { CPML_TRIG_FAST, "CPML_TRIG_FAST", "fast" },
+            { 0, NULL, NULL }
+        };
+
+        etype = g_enum_register_static("CpmlTrigMode", values);
+    }
+
+    return etype;
+}
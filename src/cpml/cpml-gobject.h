@@ -51,6 +51,13 @@ CpmlSegment *   cpml_segment_deep_dup       (const CpmlSegment      *segment);
 GType           cpml_curve_offset_algorithm_get_type
                                             (void);
 
+#define         CPML_TYPE_BOOLEAN_OPERATION (cpml_boolean_operation_get_type())
+GType           cpml_boolean_operation_get_type
+                                            (void);
+
+#define         CPML_TYPE_TRIG_MODE         (cpml_trig_mode_get_type())
+GType           cpml_trig_mode_get_type     (void);
+
 G_END_DECLS
 
 
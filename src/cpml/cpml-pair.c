@@ -147,6 +147,51 @@ cpml_pair_transform(CpmlPair *pair, const cairo_matrix_t *matrix)
     }
 }
 
+/**
+ * cpml_pairs_transform:
+ * @n:                    number of pairs to transform
+ * @src:                  (array length=n): the source pairs
+ * @dst:                  (array length=n): the destination pairs
+ * @matrix: (allow-none): the transformation matrix
+ *
+ * Applies @matrix to @n contiguous pairs of @src and stores the result
+ * in @dst. @src and @dst can be the same array to transform in-place.
+ *
+ * This is equivalent to calling cpml_pair_transform() on every pair
+ * but avoids a function call per pair: the loop is kept simple enough
+ * to be vectorized by the compiler.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_pairs_transform(size_t n, const CpmlPair *src, CpmlPair *dst,
+                     const cairo_matrix_t *matrix)
+{
+    double xx, yx, xy, yy, x0, y0;
+    double x, y;
+    size_t i;
+
+    if (matrix == NULL) {
+        if (dst != src)
+            memmove(dst, src, n * sizeof(CpmlPair));
+        return;
+    }
+
+    xx = matrix->xx;
+    yx = matrix->yx;
+    xy = matrix->xy;
+    yy = matrix->yy;
+    x0 = matrix->x0;
+    y0 = matrix->y0;
+
+    for (i = 0; i < n; ++i) {
+        x = src[i].x;
+        y = src[i].y;
+        dst[i].x = xx * x + xy * y + x0;
+        dst[i].y = yx * x + yy * y + y0;
+    }
+}
+
 /**
  * cpml_pair_squared_distance:
  * @from: (allow-none): the first #CpmlPair struct
@@ -48,6 +48,11 @@ int             cpml_pair_equal                 (const CpmlPair *pair,
 void            cpml_pair_transform             (CpmlPair       *pair,
                                                  const cairo_matrix_t
                                                                 *matrix);
+void            cpml_pairs_transform            (size_t          n,
+                                                 const CpmlPair *src,
+                                                 CpmlPair       *dst,
+                                                 const cairo_matrix_t
+                                                                *matrix);
 double          cpml_pair_squared_distance      (const CpmlPair *from,
                                                  const CpmlPair *to);
 double          cpml_pair_distance              (const CpmlPair *from,
@@ -0,0 +1,421 @@
+/* CPML - Cairo Path Manipulation Library
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:cpml-path-soa
+ * @Section_Id:CpmlPathSoA
+ * @title: CpmlPathSoA
+ * @short_description: Structure of arrays representation of a path
+ *
+ * A cairo path interleaves headers and points in a single array of
+ * #cairo_path_data_t. This is handy for browsing the path primitive
+ * by primitive but it is not the best layout for applying the same
+ * operation on every point, because the headers are in the way.
+ *
+ * A #CpmlPathSoA keeps the data of a whole path (possibly composed by
+ * many segments) in separate arrays: the x and y coordinates of all
+ * the points are contiguous, so the loops on them are tight and can
+ * be easily vectorized by the compiler. It is meant to be used on
+ * big paths, e.g. imported contours with thousands of primitives.
+ *
+ * The conversion from a cairo path is done by
+ * cpml_path_soa_from_cairo() while cpml_path_soa_put_data() does the
+ * opposite conversion.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * CpmlPathSoA:
+ * @n_primitives: number of primitives, %CPML_MOVE included
+ * @n_points:     number of points
+ * @x:            x coordinates of the points
+ * @y:            y coordinates of the points
+ * @offsets:      index of the first point of every primitive: it has
+ *                @n_primitives + 1 items, the last one being @n_points
+ * @type:         type of every primitive
+ *
+ * The points of the i-th primitive are the ones between
+ * @offsets[i] (included) and @offsets[i+1] (excluded) and, as in
+ * cairo, they do not include the implicit start point. Every field
+ * is allocated together with the struct: do not free them directly
+ * but use cpml_path_soa_destroy() instead.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "cpml-internal.h"
+#include "cpml-extents.h"
+#include "cpml-segment.h"
+#include "cpml-primitive.h"
+#include "cpml-curve.h"
+#include "cpml-path-soa.h"
+#include <stdlib.h>
+#include <math.h>
+
+/* Number of chords used to approximate the length of a curve */
+#define CURVE_SAMPLES   16
+
+
+static void     put_primitive           (const CpmlPathSoA      *soa,
+                                         size_t                  n,
+                                         size_t                  org,
+                                         cairo_path_data_t      *data,
+                                         CpmlPrimitive          *primitive);
+
+
+/**
+ * cpml_path_soa_from_cairo:
+ * @path: (in): the source #cairo_path_t
+ *
+ * Converts @path to a newly allocated #CpmlPathSoA. Only the header
+ * lengths are checked, to avoid overflows: if they are not valid or
+ * the status of @path is not %CAIRO_STATUS_SUCCESS, %NULL is returned.
+ *
+ * Returns: (transfer full): the newly created #CpmlPathSoA: free it
+ *                           with cpml_path_soa_destroy() when no
+ *                           longer needed.
+ *
+ * Since: 1.0
+ **/
+CpmlPathSoA *
+cpml_path_soa_from_cairo(const cairo_path_t *path)
+{
+    CpmlPathSoA *soa;
+    const cairo_path_data_t *data;
+    size_t n_primitives, n_points, n, i, k;
+    int length;
+    char *ptr;
+
+    if (path->status != CAIRO_STATUS_SUCCESS)
+        return NULL;
+
+    /* Count the primitives and the points */
+    n_primitives = n_points = 0;
+    for (i = 0; i < (size_t) path->num_data; i += length) {
+        data = path->data + i;
+        length = data->header.length;
+        if (length < 1 || i + length > (size_t) path->num_data ||
+            (data->header.type == CPML_ARC && length != 3) ||
+            (data->header.type == CPML_CURVE && length != 4))
+            return NULL;
+        ++ n_primitives;
+        n_points += length - 1;
+    }
+
+    /* Allocate everything in the same chunk, keeping the fields
+     * with the stricter alignment first */
+    soa = malloc(sizeof(CpmlPathSoA) +
+                 n_points * 2 * sizeof(double) +
+                 (n_primitives + 1) * sizeof(size_t) +
+                 n_primitives * sizeof(CpmlPrimitiveType));
+    ptr = (char *) (soa + 1);
+    soa->n_primitives = n_primitives;
+    soa->n_points = n_points;
+    soa->x = (double *) ptr;
+    soa->y = soa->x + n_points;
+    soa->offsets = (size_t *) (soa->y + n_points);
+    soa->type = (CpmlPrimitiveType *) (soa->offsets + n_primitives + 1);
+
+    data = path->data;
+    k = 0;
+    for (n = 0; n < n_primitives; ++ n) {
+        length = data->header.length;
+        soa->type[n] = data->header.type;
+        soa->offsets[n] = k;
+        for (++ data; -- length > 0; ++ data, ++ k) {
+            soa->x[k] = data->point.x;
+            soa->y[k] = data->point.y;
+        }
+    }
+    soa->offsets[n_primitives] = n_points;
+
+    return soa;
+}
+
+/**
+ * cpml_path_soa_destroy:
+ * @soa: a #CpmlPathSoA
+ *
+ * Frees @soa and all its data.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_path_soa_destroy(CpmlPathSoA *soa)
+{
+    free(soa);
+}
+
+/**
+ * cpml_path_soa_put_data:
+ * @soa:                 a #CpmlPathSoA
+ * @n_dest:              size of @dest, in #cairo_path_data_t
+ * @dest: (allow-none):  the destination buffer
+ *
+ * Converts @soa back to the cairo format, storing the result in
+ * @dest. If @dest is <constant>NULL</constant> or too small, nothing
+ * is stored but the required size is returned anyway, so the
+ * destination buffer can be allocated in advance.
+ *
+ * Returns: the number of #cairo_path_data_t needed by @soa
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_path_soa_put_data(const CpmlPathSoA *soa,
+                       size_t n_dest, cairo_path_data_t *dest)
+{
+    size_t n_data, n, k;
+
+    n_data = soa->n_primitives + soa->n_points;
+    if (dest == NULL || n_dest < n_data)
+        return n_data;
+
+    for (n = 0; n < soa->n_primitives; ++ n) {
+        dest->header.type = soa->type[n];
+        dest->header.length = soa->offsets[n+1] - soa->offsets[n] + 1;
+        ++ dest;
+        for (k = soa->offsets[n]; k < soa->offsets[n+1]; ++ k, ++ dest) {
+            dest->point.x = soa->x[k];
+            dest->point.y = soa->y[k];
+        }
+    }
+
+    return n_data;
+}
+
+/**
+ * cpml_path_soa_put_extents:
+ * @soa:     a #CpmlPathSoA
+ * @extents: where to store the extents
+ *
+ * Gets the whole extents of @soa. As done by cpml_segment_put_extents(),
+ * the extents are tight: the control points of the %CPML_CURVE
+ * primitives are not included unless they are effectively reached.
+ *
+ * The bounding box of the points of the %CPML_MOVE and %CPML_LINE
+ * primitives is computed directly on the coordinate arrays: only the
+ * %CPML_ARC and %CPML_CURVE primitives, that can go beyond or not reach
+ * their points, require further processing.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_path_soa_put_extents(const CpmlPathSoA *soa, CpmlExtents *extents)
+{
+    const double *x, *y;
+    double x_min, y_min, x_max, y_max;
+    cairo_path_data_t data[5];
+    CpmlPrimitive primitive;
+    CpmlExtents primitive_extents;
+    size_t n, k, org, move;
+    int has_points;
+
+    extents->is_defined = 0;
+    if (soa->n_points == 0)
+        return;
+
+    x = soa->x;
+    y = soa->y;
+    x_min = x_max = y_min = y_max = 0;
+    has_points = 0;
+    org = move = 0;
+
+    for (n = 0; n < soa->n_primitives; ++ n) {
+        switch ((int) soa->type[n]) {
+        case CPML_MOVE:
+            move = soa->offsets[n];
+            /* Fall through */
+        case CPML_LINE:
+            for (k = soa->offsets[n]; k < soa->offsets[n+1]; ++ k) {
+                if (! has_points) {
+                    x_min = x_max = x[k];
+                    y_min = y_max = y[k];
+                    has_points = 1;
+                } else if (x[k] < x_min)
+                    x_min = x[k];
+                else if (x[k] > x_max)
+                    x_max = x[k];
+                if (y[k] < y_min)
+                    y_min = y[k];
+                else if (y[k] > y_max)
+                    y_max = y[k];
+            }
+            break;
+        case CPML_ARC:
+        case CPML_CURVE:
+            put_primitive(soa, n, org, data, &primitive);
+            cpml_primitive_put_extents(&primitive, &primitive_extents);
+            cpml_extents_add(extents, &primitive_extents);
+            break;
+        default:
+            break;
+        }
+
+        /* Keep track of the current point */
+        if (soa->type[n] == CPML_CLOSE)
+            org = move;
+        else if (soa->offsets[n+1] > soa->offsets[n])
+            org = soa->offsets[n+1] - 1;
+    }
+
+    if (has_points) {
+        CpmlExtents points_extents;
+
+        points_extents.is_defined = 1;
+        points_extents.org.x = x_min;
+        points_extents.org.y = y_min;
+        points_extents.size.x = x_max - x_min;
+        points_extents.size.y = y_max - y_min;
+        cpml_extents_add(extents, &points_extents);
+    }
+}
+
+/**
+ * cpml_path_soa_transform:
+ * @soa:    a #CpmlPathSoA
+ * @matrix: the matrix to be applied
+ *
+ * Applies @matrix on all the points of @soa.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_path_soa_transform(CpmlPathSoA *soa, const cairo_matrix_t *matrix)
+{
+    double *x, *y;
+    double xx, yx, xy, yy, x0, y0, tmp;
+    size_t k;
+
+    x = soa->x;
+    y = soa->y;
+    xx = matrix->xx;
+    yx = matrix->yx;
+    xy = matrix->xy;
+    yy = matrix->yy;
+    x0 = matrix->x0;
+    y0 = matrix->y0;
+
+    for (k = 0; k < soa->n_points; ++ k) {
+        tmp = x[k];
+        x[k] = xx * tmp + xy * y[k] + x0;
+        y[k] = yx * tmp + yy * y[k] + y0;
+    }
+}
+
+/**
+ * cpml_path_soa_get_length:
+ * @soa: a #CpmlPathSoA
+ *
+ * Gets the whole length of @soa, that is the sum of the lengths of
+ * all its segments. Differently from cpml_segment_get_length(), the
+ * %CPML_CURVE primitives are approximated by a polyline instead of
+ * being ignored.
+ *
+ * Returns: the requested length
+ *
+ * Since: 1.0
+ **/
+double
+cpml_path_soa_get_length(const CpmlPathSoA *soa)
+{
+    const double *x, *y;
+    cairo_path_data_t data[5];
+    CpmlPrimitive primitive;
+    CpmlPair pair, last_pair;
+    double length, dx, dy;
+    size_t n, k, org, move;
+    int j;
+
+    x = soa->x;
+    y = soa->y;
+    length = 0;
+    org = move = 0;
+
+    for (n = 0; n < soa->n_primitives; ++ n) {
+        switch ((int) soa->type[n]) {
+        case CPML_MOVE:
+            move = soa->offsets[n];
+            break;
+        case CPML_LINE:
+            for (k = soa->offsets[n]; k < soa->offsets[n+1]; org = k ++) {
+                dx = x[k] - x[org];
+                dy = y[k] - y[org];
+                length += sqrt(dx * dx + dy * dy);
+            }
+            break;
+        case CPML_CLOSE:
+            dx = x[move] - x[org];
+            dy = y[move] - y[org];
+            length += sqrt(dx * dx + dy * dy);
+            break;
+        case CPML_ARC:
+            put_primitive(soa, n, org, data, &primitive);
+            length += cpml_primitive_get_length(&primitive);
+            break;
+        case CPML_CURVE:
+            put_primitive(soa, n, org, data, &primitive);
+            cpml_pair_from_cairo(&last_pair, primitive.org);
+            for (j = 1; j <= CURVE_SAMPLES; ++ j) {
+                cpml_curve_put_pair_at_time(&primitive,
+                                            (double) j / CURVE_SAMPLES,
+                                            &pair);
+                length += cpml_pair_distance(&last_pair, &pair);
+                cpml_pair_copy(&last_pair, &pair);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (soa->type[n] == CPML_CLOSE)
+            org = move;
+        else if (soa->offsets[n+1] > soa->offsets[n])
+            org = soa->offsets[n+1] - 1;
+    }
+
+    return length;
+}
+
+
+/* Builds in @data a standalone @primitive with the n-th primitive
+ * of @soa, using the @org point as origin: @data must be big enough
+ * to contain the origin, the header and the points */
+static void
+put_primitive(const CpmlPathSoA *soa, size_t n, size_t org,
+              cairo_path_data_t *data, CpmlPrimitive *primitive)
+{
+    size_t k;
+
+    data[0].point.x = soa->x[org];
+    data[0].point.y = soa->y[org];
+    data[1].header.type = soa->type[n];
+    data[1].header.length = soa->offsets[n+1] - soa->offsets[n] + 1;
+    for (k = soa->offsets[n]; k < soa->offsets[n+1]; ++ k) {
+        data[2 + k - soa->offsets[n]].point.x = soa->x[k];
+        data[2 + k - soa->offsets[n]].point.y = soa->y[k];
+    }
+
+    primitive->segment = NULL;
+    primitive->org = &data[0];
+    primitive->data = &data[1];
+}
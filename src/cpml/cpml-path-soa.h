@@ -0,0 +1,60 @@
+/* CPML - Cairo Path Manipulation Library
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__CPML_H__)
+#error "Only <cpml/cpml.h> can be included directly."
+#endif
+
+
+#ifndef __CPML_PATH_SOA_H__
+#define __CPML_PATH_SOA_H__
+
+
+CAIRO_BEGIN_DECLS
+
+typedef struct _CpmlPathSoA CpmlPathSoA;
+
+struct _CpmlPathSoA {
+    /*< public >*/
+    size_t             n_primitives;
+    size_t             n_points;
+    double            *x;
+    double            *y;
+    size_t            *offsets;
+    CpmlPrimitiveType *type;
+};
+
+
+CpmlPathSoA *
+        cpml_path_soa_from_cairo        (const cairo_path_t     *path);
+void    cpml_path_soa_destroy           (CpmlPathSoA            *soa);
+size_t  cpml_path_soa_put_data          (const CpmlPathSoA      *soa,
+                                         size_t                  n_dest,
+                                         cairo_path_data_t      *dest);
+void    cpml_path_soa_put_extents       (const CpmlPathSoA      *soa,
+                                         CpmlExtents            *extents);
+void    cpml_path_soa_transform         (CpmlPathSoA            *soa,
+                                         const cairo_matrix_t   *matrix);
+double  cpml_path_soa_get_length        (const CpmlPathSoA      *soa);
+
+CAIRO_END_DECLS
+
+
+#endif /* __CPML_PATH_SOA_H__ */
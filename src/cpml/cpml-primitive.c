@@ -506,6 +506,9 @@ cpml_primitive_is_inside(const CpmlPrimitive *primitive, const CpmlPair *pair)
  * Returns the pos value of the point on @primitive nearest to @pair.
  * The returned value is always clamped between 0 and 1.
  *
+ * On %CPML_CURVE primitives the returned value is the time to be
+ * passed to cpml_curve_put_pair_at_time().
+ *
  * Returns: the requested pos value between 0 and 1, or -1 on errors.
  *
  * <!-- Virtual: get_closest_pos -->
@@ -635,8 +638,39 @@ size_t
 cpml_primitive_put_intersections_with_segment(const CpmlPrimitive *primitive,
                                               const CpmlSegment *segment,
                                               size_t n_dest, CpmlPair *dest)
+{
+    CpmlExtents extents = { 0 };
+
+    cpml_primitive_put_extents(primitive, &extents);
+    return _cpml_primitive_put_intersections_with_extents(primitive, &extents,
+                                                          segment, NULL,
+                                                          n_dest, dest);
+}
+
+/*
+ * _cpml_primitive_put_intersections_with_extents:
+ * @primitive:       a #CpmlPrimitive
+ * @extents:         the precomputed extents of @primitive
+ * @segment:         a #CpmlSegment
+ * @segment_extents: (allow-none): the precomputed extents of every
+ *                   primitive in @segment or NULL to compute them on the fly
+ * @n_dest:          maximum number of intersections to return
+ * @dest:            the destination buffer
+ *
+ * Does the dirty work of cpml_primitive_put_intersections_with_segment().
+ * Primitives not overlapping @extents cannot have real intersections,
+ * so they are skipped before calling the expensive method.
+ */
+size_t
+_cpml_primitive_put_intersections_with_extents(const CpmlPrimitive *primitive,
+                                               const CpmlExtents *extents,
+                                               const CpmlSegment *segment,
+                                               const CpmlExtents *segment_extents,
+                                               size_t n_dest, CpmlPair *dest)
 {
     CpmlPrimitive portion;
+    CpmlExtents portion_extents;
+    const CpmlExtents *pe;
     CpmlPair partial[5];
     const CpmlPair *pair;
     size_t found, total;
@@ -645,14 +679,26 @@ cpml_primitive_put_intersections_with_segment(const CpmlPrimitive *primitive,
     total = 0;
 
     while (total < n_dest) {
-        found = cpml_primitive_put_intersections(&portion, primitive, 5, partial);
-
-        /* Store only real intersections */
-        for (pair = partial; found; -- found, ++ pair) {
-            if (cpml_primitive_is_inside(&portion, pair) &&
-                cpml_primitive_is_inside(primitive, pair)) {
-                cpml_pair_copy(dest+total, pair);
-                ++ total;
+        if (segment_extents != NULL) {
+            pe = segment_extents;
+            ++ segment_extents;
+        } else {
+            portion_extents.is_defined = 0;
+            cpml_primitive_put_extents(&portion, &portion_extents);
+            pe = &portion_extents;
+        }
+
+        if (cpml_extents_overlap(pe, extents)) {
+            found = cpml_primitive_put_intersections(&portion, primitive,
+                                                     5, partial);
+
+            /* Store only real intersections */
+            for (pair = partial; found && total < n_dest; -- found, ++ pair) {
+                if (cpml_extents_pair_is_inside(pe, pair) &&
+                    cpml_extents_pair_is_inside(extents, pair)) {
+                    cpml_pair_copy(dest+total, pair);
+                    ++ total;
+                }
             }
         }
 
@@ -675,19 +721,48 @@ cpml_primitive_put_intersections_with_segment(const CpmlPrimitive *primitive,
  * On errors, that is if the offset primitive cannot be calculated
  * for some reason, this function does nothing.
  *
+ * Curves are offseted with the algorithm selected by
+ * cpml_curve_offset_algorithm(): use cpml_primitive_offset_full()
+ * to specify a different one.
+ *
  * <!-- Virtual: offset -->
  *
  * Since: 1.0
  **/
 void
 cpml_primitive_offset(CpmlPrimitive *primitive, double offset)
+{
+    cpml_primitive_offset_full(primitive, offset, NULL);
+}
+
+/**
+ * cpml_primitive_offset_full:
+ * @primitive: (inout):           a #CpmlPrimitive
+ * @offset:    (in):              distance for the computed offset primitive
+ * @context:   (in) (allow-none): the offset settings
+ *
+ * Same as cpml_primitive_offset() but using the settings of @context.
+ * Only curves are affected by @context: see #CpmlOffsetContext for
+ * further details. A %NULL @context is the same as calling
+ * cpml_primitive_offset().
+ *
+ * <!-- Virtual: offset -->
+ *
+ * Since: 1.0
+ **/
+void
+cpml_primitive_offset_full(CpmlPrimitive *primitive, double offset,
+                           const CpmlOffsetContext *context)
 {
     const _CpmlPrimitiveClass *class_data = _cpml_class_from_obj(primitive);
 
     if (class_data == NULL || class_data->offset == NULL)
         return;
 
-    class_data->offset(primitive, offset);
+    if (context != NULL && class_data == _cpml_curve_get_class())
+        _cpml_curve_offset(primitive, offset, context);
+    else
+        class_data->offset(primitive, offset);
 }
 
 /**
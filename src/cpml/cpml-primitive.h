@@ -29,6 +29,8 @@
 
 CAIRO_BEGIN_DECLS
 
+struct _CpmlOffsetContext;
+
 typedef struct _CpmlPrimitive CpmlPrimitive;
 typedef cairo_path_data_type_t CpmlPrimitiveType;
 
@@ -88,6 +90,9 @@ size_t  cpml_primitive_put_intersections_with_segment
                                          CpmlPair               *dest);
 void    cpml_primitive_offset           (CpmlPrimitive          *primitive,
                                          double                  offset);
+void    cpml_primitive_offset_full      (CpmlPrimitive          *primitive,
+                                         double                  offset,
+                                         const struct _CpmlOffsetContext *context);
 int     cpml_primitive_join             (CpmlPrimitive          *primitive,
                                          CpmlPrimitive          *primitive2);
 void    cpml_primitive_to_cairo         (const CpmlPrimitive    *primitive,
@@ -64,17 +64,341 @@
  * Since: 1.0
  **/
 
+/**
+ * CpmlBooleanOperation:
+ * @CPML_BOOLEAN_UNION: the area enclosed by any of the segments
+ * @CPML_BOOLEAN_INTERSECTION: the area enclosed by both the segments
+ * @CPML_BOOLEAN_DIFFERENCE: the area enclosed by the first segment
+ *                           but not by the second one
+ *
+ * The operations available to cpml_segment_put_boolean().
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * CpmlSegmentLengthTable:
+ *
+ * An opaque struct holding the arc-length parameterization of a
+ * #CpmlSegment. Check cpml_segment_length_table_new() for details.
+ *
+ * Since: 1.0
+ **/
+
 
 #include "cpml-internal.h"
 #include "cpml-extents.h"
 #include "cpml-segment.h"
 #include "cpml-primitive.h"
+#include "cpml-arc.h"
 #include "cpml-curve.h"
 #include <string.h>
+#include <math.h>
+
+#define OFFSET_MAX_CURVES   16
+#define FLATTEN_MAX_DEPTH   16
+#define FIT_MAX_ITERATIONS  4
+#define FIT_CORNER_COS      0.70710678118654752440
+#define BOOLEAN_EPSILON     1e-6
+
+
+typedef struct _LengthSample LengthSample;
+typedef struct _SweepItem SweepItem;
+typedef struct _ScanEdge ScanEdge;
+typedef struct _OffsetItem OffsetItem;
+typedef struct _FlatBuffer FlatBuffer;
+typedef struct _FitSpan FitSpan;
+typedef struct _BoolPolygon BoolPolygon;
+typedef struct _BoolItem BoolItem;
+typedef struct _BoolSplit BoolSplit;
+typedef struct _BoolEdge BoolEdge;
+
+struct _CpmlSegmentLengthTable {
+    CpmlPrimitive  *primitives;
+    LengthSample   *samples;
+    size_t          n_samples;
+};
+
+struct _LengthSample {
+    size_t          primitive;
+    double          pos;
+    double          length;
+};
+
+struct _SweepItem {
+    CpmlPrimitive   primitive;
+    CpmlExtents     extents;
+    int             owner;
+    size_t          index;
+    size_t          n_primitives;
+    int             is_closed;
+};
+
+/* An edge of the polygon approximating a segment, expressed in the
+ * (u, v) frame where the scanlines are the v = constant lines */
+struct _ScanEdge {
+    double          u;
+    double          v1;
+    double          v2;
+    double          slope;
+};
+
+/* An offseted primitive pending to be stored by cpml_segment_put_offset().
+ * When a tolerance is requested, an offseted curve can be a chain of
+ * curves: @last is the index of the last primitive in @data */
+struct _OffsetItem {
+    cairo_path_data_t   data[1 + OFFSET_MAX_CURVES * 4];
+    size_t              num_data;
+    size_t              last;
+    CpmlPair            vertex;
+    CpmlVector          start_vector;
+    CpmlVector          end_vector;
+};
+
+/* The destination of cpml_segment_flatten(): @n is the number of points
+ * stored so far or, when @dest is NULL, the number of points found */
+struct _FlatBuffer {
+    double              tolerance;
+    size_t              n_dest;
+    size_t              n;
+    CpmlPair           *dest;
+};
+
+/* Position of an edge piece relative to the other polygon: inside,
+ * outside or lying on its boundary, with the same direction of the
+ * boundary or with the opposite one */
+enum {
+    BOOL_INSIDE,
+    BOOL_OUTSIDE,
+    BOOL_SAME,
+    BOOL_OPPOSITE
+};
+
+/* A closed segment flattened by cpml_segment_put_boolean(): the
+ * vertices are always in counterclockwise order and the closing edge
+ * from the last vertex to the first one is implicit */
+struct _BoolPolygon {
+    CpmlPair           *points;
+    size_t              n_points;
+};
+
+/* An edge of one of the polygons, in the sweep order: @index is the
+ * position of the edge in the polygons, counting from the first one */
+struct _BoolItem {
+    CpmlPair            p1;
+    CpmlPair            p2;
+    int                 owner;
+    size_t              index;
+    double              x_min;
+    double              x_max;
+    double              y_min;
+    double              y_max;
+};
+
+/* A point where an edge must be split, @t being its position on it */
+struct _BoolSplit {
+    size_t              index;
+    double              t;
+    CpmlPair            pair;
+};
+
+/* A piece of edge belonging to the result, already oriented */
+struct _BoolEdge {
+    CpmlPair            from;
+    CpmlPair            to;
+    int                 used;
+};
+
+/* A run of points pending to be fitted by cpml_segment_put_fitted(),
+ * from @first to @last (included) with the unit tangents at both ends
+ * pointing inside the span */
+struct _FitSpan {
+    size_t              first;
+    size_t              last;
+    CpmlVector          start_tangent;
+    CpmlVector          end_tangent;
+};
+
 
 static int              normalize               (CpmlSegment       *segment);
 static int              ensure_one_leading_move (CpmlSegment       *segment);
 static int              reshape                 (CpmlSegment       *segment);
+static SweepItem *      sweep_items             (const CpmlSegment *segment,
+                                                 int                owner,
+                                                 SweepItem         *items,
+                                                 size_t            *n_items);
+static const LengthSample *
+                        length_table_lookup     (const CpmlSegmentLengthTable
+                                                                   *table,
+                                                 double             length,
+                                                 double            *pos);
+static double           extents_squared_distance
+                                                (const CpmlExtents *extents,
+                                                 const CpmlPair    *pair);
+static int              sweep_compare           (const void        *a,
+                                                 const void        *b);
+static size_t           sweep                   (SweepItem         *items,
+                                                 size_t             n_items,
+                                                 int                self,
+                                                 size_t             n_dest,
+                                                 CpmlPair          *dest);
+static size_t           sweep_pair              (const SweepItem   *item,
+                                                 const SweepItem   *item2,
+                                                 int                self,
+                                                 size_t             n_dest,
+                                                 CpmlPair          *dest);
+static ScanEdge *       scan_edges              (const CpmlSegment *segment,
+                                                 const CpmlVector  *direction,
+                                                 size_t            *n_edges);
+static void             scan_add_edge           (ScanEdge          *edge,
+                                                 const CpmlPair    *p1,
+                                                 const CpmlPair    *p2,
+                                                 const CpmlVector  *direction,
+                                                 size_t            *n_edges);
+static int              scan_compare            (const void        *a,
+                                                 const void        *b);
+static int              double_compare          (const void        *a,
+                                                 const void        *b);
+static int              fast_get_length         (const CpmlPrimitive
+                                                                   *primitive,
+                                                 double            *length);
+static int              fast_put_extents        (const CpmlPrimitive
+                                                                   *primitive,
+                                                 CpmlExtents       *extents);
+static int              offset_item             (OffsetItem        *item,
+                                                 const CpmlPrimitive
+                                                                   *primitive,
+                                                 double             offset,
+                                                 const CpmlOffsetContext
+                                                                   *context);
+static void             offset_item_first       (OffsetItem        *item,
+                                                 CpmlPrimitive     *primitive);
+static void             offset_item_last        (OffsetItem        *item,
+                                                 CpmlPrimitive     *primitive);
+static size_t           offset_join             (OffsetItem        *item,
+                                                 OffsetItem        *item2,
+                                                 double             offset,
+                                                 cairo_line_join_t  join,
+                                                 int                trim,
+                                                 cairo_path_data_t *extra);
+static void             flat_add                (FlatBuffer        *buffer,
+                                                 const CpmlPair    *pair);
+static void             flat_arc                (FlatBuffer        *buffer,
+                                                 const CpmlPrimitive
+                                                                   *arc);
+static void             flat_curve              (FlatBuffer        *buffer,
+                                                 const CpmlPair    *p,
+                                                 int                depth);
+static size_t           simplify_run            (const CpmlPair    *points,
+                                                 size_t             n_points,
+                                                 double             tolerance,
+                                                 int                fit_arcs,
+                                                 unsigned char     *keep,
+                                                 size_t            *stack,
+                                                 size_t             n_dest,
+                                                 size_t             n_data,
+                                                 cairo_path_data_t *dest);
+static void             simplify_lines          (const CpmlPair    *points,
+                                                 size_t             first,
+                                                 size_t             last,
+                                                 double             tolerance,
+                                                 unsigned char     *keep,
+                                                 size_t            *stack);
+static size_t           simplify_arc_end        (const CpmlPair    *points,
+                                                 size_t             first,
+                                                 size_t             n_points,
+                                                 double             tolerance);
+static int              simplify_arc_fits       (const CpmlPair    *points,
+                                                 size_t             first,
+                                                 size_t             last,
+                                                 double             tolerance);
+static size_t           fit_run                 (const CpmlPair    *points,
+                                                 size_t             n_points,
+                                                 double             tolerance,
+                                                 double            *times,
+                                                 FitSpan           *stack,
+                                                 size_t             n_dest,
+                                                 size_t             n_data,
+                                                 cairo_path_data_t *dest);
+static size_t           fit_span                (const CpmlPair    *points,
+                                                 size_t             first,
+                                                 size_t             last,
+                                                 double             tolerance,
+                                                 double            *times,
+                                                 FitSpan           *stack,
+                                                 size_t             n_dest,
+                                                 size_t             n_data,
+                                                 cairo_path_data_t *dest);
+static void             fit_curve               (const CpmlPair    *points,
+                                                 const FitSpan     *span,
+                                                 const double      *times,
+                                                 CpmlPair          *p);
+static double           fit_error               (const CpmlPair    *points,
+                                                 const FitSpan     *span,
+                                                 const double      *times,
+                                                 const CpmlPair    *p,
+                                                 size_t            *split);
+static void             fit_reparameterize      (const CpmlPair    *points,
+                                                 const FitSpan     *span,
+                                                 double            *times,
+                                                 const CpmlPair    *p);
+static void             fit_tangent             (const CpmlPair    *p0,
+                                                 const CpmlPair    *p1,
+                                                 const CpmlPair    *p2,
+                                                 CpmlVector        *tangent);
+static void             bezier_pair             (const CpmlPair    *p,
+                                                 double             t,
+                                                 CpmlPair          *pair);
+static int              unit_vector             (const CpmlPair    *from,
+                                                 const CpmlPair    *to,
+                                                 CpmlVector        *vector);
+static int              bool_polygon            (const CpmlSegment *segment,
+                                                 double             tolerance,
+                                                 BoolPolygon       *polygon);
+static BoolItem *       bool_items              (const BoolPolygon *polygon,
+                                                 int                owner,
+                                                 size_t             first,
+                                                 BoolItem          *items);
+static int              bool_item_compare       (const void        *a,
+                                                 const void        *b);
+static BoolSplit *      bool_intersect          (const BoolItem    *item,
+                                                 const BoolItem    *item2,
+                                                 BoolSplit         *splits,
+                                                 size_t            *n_splits,
+                                                 size_t            *n_max);
+static BoolSplit *      bool_add_split          (BoolSplit         *splits,
+                                                 size_t            *n_splits,
+                                                 size_t            *n_max,
+                                                 size_t             index,
+                                                 double             t,
+                                                 const CpmlPair    *pair);
+static int              bool_split_compare      (const void        *a,
+                                                 const void        *b);
+static int              bool_classify           (const CpmlPair    *from,
+                                                 const CpmlPair    *to,
+                                                 const BoolPolygon *polygon);
+static int              bool_edge_compare       (const void        *a,
+                                                 const void        *b);
+static BoolEdge *       bool_next_edge          (BoolEdge          *edges,
+                                                 size_t             n_edges,
+                                                 const CpmlPair    *pair);
+static size_t           bool_put_loop           (CpmlPair          *loop,
+                                                 size_t             n_loop,
+                                                 size_t             n_dest,
+                                                 size_t             n_data,
+                                                 cairo_path_data_t *dest);
+static int              bool_is_collinear       (const CpmlPair    *p1,
+                                                 const CpmlPair    *p2,
+                                                 const CpmlPair    *p3);
+static double           chord_distance          (const CpmlPair    *pair,
+                                                 const CpmlPair    *from,
+                                                 const CpmlPair    *to);
+static size_t           put_data                (cairo_path_data_t *dest,
+                                                 size_t             n_dest,
+                                                 size_t             n_data,
+                                                 const cairo_path_data_t
+                                                                   *data,
+                                                 size_t             n);
 
 
 /**
@@ -229,13 +553,15 @@ double
 cpml_segment_get_length(const CpmlSegment *segment)
 {
     CpmlPrimitive primitive;
-    double length;
+    double length, primitive_length;
 
     cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
     length = 0;
 
     do {
-        length += cpml_primitive_get_length(&primitive);
+        if (! fast_get_length(&primitive, &primitive_length))
+            primitive_length = cpml_primitive_get_length(&primitive);
+        length += primitive_length;
     } while (cpml_primitive_next(&primitive));
 
     return length;
@@ -261,8 +587,10 @@ cpml_segment_put_extents(const CpmlSegment *segment, CpmlExtents *extents)
     cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
 
     do {
-        cpml_primitive_put_extents(&primitive, &primitive_extents);
-        cpml_extents_add(extents, &primitive_extents);
+        if (! fast_put_extents(&primitive, extents)) {
+            cpml_primitive_put_extents(&primitive, &primitive_extents);
+            cpml_extents_add(extents, &primitive_extents);
+        }
     } while (cpml_primitive_next(&primitive));
 }
 
@@ -361,9 +689,11 @@ cpml_segment_put_vector_at(const CpmlSegment *segment, double pos,
  * returns the found points in @dest. If the intersections are more
  * than @n_dest, only the first @n_dest pairs are stored in @dest.
  *
- * To get the job done, the primitives of @segment are sequentially
- * scanned for intersections with any primitive in @segment2. This
- * means @segment has a higher precedence over @segment2.
+ * The primitives of both segments are sorted by the left side of their
+ * extents and swept from left to right: only primitives whose extents
+ * overlap are checked for intersections, so the cost is proportional
+ * to the number of overlapping pairs instead of to the product of the
+ * number of primitives. The intersections are returned in sweep order.
  *
  * Returns: the number of intersections found
  *
@@ -374,23 +704,225 @@ cpml_segment_put_intersections(const CpmlSegment *segment,
                                const CpmlSegment *segment2,
                                size_t n_dest, CpmlPair *dest)
 {
-    CpmlPrimitive portion;
-    size_t partial, total;
+    SweepItem *items;
+    size_t n_items, total;
+
+    n_items = 0;
+    items = sweep_items(segment, 1, NULL, &n_items);
+    items = sweep_items(segment2, 2, items, &n_items);
+    total = sweep(items, n_items, 0, n_dest, dest);
+    free(items);
+
+    return total;
+}
+
+/**
+ * cpml_segment_put_self_intersections:
+ * @segment: a #CpmlSegment
+ * @n_dest:  maximum number of intersections to return
+ * @dest:    the destination vector of #CpmlPair
+ *
+ * Computes the points where @segment intersects itself and returns
+ * them in @dest. If the intersections are more than @n_dest, only the
+ * first @n_dest pairs are stored in @dest.
+ *
+ * The joint between two consecutive primitives (including the joint
+ * between the last and the first primitive of a closed segment) is not
+ * considered an intersection. The same sweep algorithm described in
+ * cpml_segment_put_intersections() is used.
+ *
+ * Returns: the number of self-intersections found
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_put_self_intersections(const CpmlSegment *segment,
+                                    size_t n_dest, CpmlPair *dest)
+{
+    SweepItem *items;
+    size_t n_items, total;
+
+    n_items = 0;
+    items = sweep_items(segment, 1, NULL, &n_items);
+    total = sweep(items, n_items, 1, n_dest, dest);
+    free(items);
+
+    return total;
+}
+
+/**
+ * cpml_segment_put_scanline_spans:
+ * @segment: a closed #CpmlSegment
+ * @angle:   the direction of the lines, in radians
+ * @spacing: the distance between two consecutive lines
+ * @offset:  the distance of the reference line from (0, 0)
+ * @n_dest:  maximum number of spans to return
+ * @dest: (allow-none): the destination vector of #CpmlPair
+ *
+ * Computes the spans of a family of parallel lines lying inside
+ * @segment. The lines have an @angle direction and are @spacing
+ * apart, the reference one being at @offset from the (0, 0) point
+ * along the direction perpendicular to @angle (that is, rotated by
+ * 90 degrees counterclockwise). @segment is considered closed even
+ * if it does not end with a %CPML_CLOSE primitive and the even-odd
+ * rule is used to find out what is inside.
+ *
+ * Every span is stored as two consecutive #CpmlPair, the start and
+ * the end point, so @dest must be able to contain at least
+ * 2 * @n_dest pairs. The spans are ordered by line and, inside
+ * every line, along @angle. If @dest is <constant>NULL</constant>,
+ * nothing is stored and the total number of spans is returned, so
+ * the destination buffer can be allocated in advance.
+ *
+ * Instead of intersecting every line with every primitive, the
+ * primitive edges are sorted by their extents across the lines and
+ * all the lines are computed in a single sweep, keeping only the
+ * edges crossing the current line. The %CPML_ARC and %CPML_CURVE
+ * primitives are approximated by a polyline.
+ *
+ * Returns: the number of spans found
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_put_scanline_spans(const CpmlSegment *segment, double angle,
+                                double spacing, double offset,
+                                size_t n_dest, CpmlPair *dest)
+{
+    CpmlVector direction;
+    ScanEdge *edges, **active;
+    double *cuts;
+    double v, v_max;
+    size_t n_edges, n_active, n_kept, n_cuts, total, n, i;
+    long k;
+
+    if (spacing <= 0)
+        return 0;
+
+    cpml_vector_from_angle(&direction, angle);
+    edges = scan_edges(segment, &direction, &n_edges);
+    if (n_edges == 0) {
+        free(edges);
+        return 0;
+    }
+
+    qsort(edges, n_edges, sizeof(ScanEdge), scan_compare);
+    v_max = edges[0].v2;
+    for (n = 1; n < n_edges; ++ n)
+        if (edges[n].v2 > v_max)
+            v_max = edges[n].v2;
 
-    cpml_primitive_from_segment(&portion, (CpmlSegment *) segment);
+    active = malloc(n_edges * sizeof(ScanEdge *));
+    cuts = malloc(n_edges * sizeof(double));
+    n_active = 0;
     total = 0;
+    n = 0;
+
+    /* The first line at or after the lowest edge */
+    k = (long) ceil((edges[0].v1 - offset) / spacing);
+
+    for (v = offset + k * spacing; v < v_max; v = offset + (++ k) * spacing) {
+        /* Every edge covers the half-open [v1, v2) range, so a vertex
+         * shared by two edges is counted only once */
+        n_kept = 0;
+        for (i = 0; i < n_active; ++ i)
+            if (active[i]->v2 > v)
+                active[n_kept++] = active[i];
+        n_active = n_kept;
+
+        for (; n < n_edges && edges[n].v1 <= v; ++ n)
+            if (edges[n].v2 > v)
+                active[n_active++] = &edges[n];
+
+        if (n_active < 2)
+            continue;
+
+        for (n_cuts = 0; n_cuts < n_active; ++ n_cuts)
+            cuts[n_cuts] = active[n_cuts]->u +
+                (v - active[n_cuts]->v1) * active[n_cuts]->slope;
+        qsort(cuts, n_cuts, sizeof(double), double_compare);
+
+        for (i = 0; i + 1 < n_cuts; i += 2) {
+            if (dest != NULL) {
+                if (total >= n_dest)
+                    goto done;
+                dest[total * 2].x = cuts[i] * direction.x - v * direction.y;
+                dest[total * 2].y = cuts[i] * direction.y + v * direction.x;
+                dest[total * 2 + 1].x = cuts[i + 1] * direction.x - v * direction.y;
+                dest[total * 2 + 1].y = cuts[i + 1] * direction.y + v * direction.x;
+            }
+            ++ total;
+        }
+    }
 
-    do {
-        partial = cpml_primitive_put_intersections_with_segment(&portion,
-                                                                segment2,
-                                                                n_dest - total,
-                                                                dest + total);
-        total += partial;
-    } while (total < n_dest && cpml_primitive_next(&portion));
+done:
+    free(cuts);
+    free(active);
+    free(edges);
 
     return total;
 }
 
+/**
+ * cpml_segment_get_closest_pos:
+ * @segment:   a #CpmlSegment
+ * @pair:      the coordinates of the subject point
+ * @primitive: (out) (allow-none): where to store the closest primitive
+ *
+ * Looks for the point of @segment nearest to @pair. The primitive
+ * containing that point is stored in @primitive, if not
+ * <constant>NULL</constant>, and the pos value of the point on that
+ * primitive, as returned by cpml_primitive_get_closest_pos(), is
+ * returned.
+ *
+ * Primitives whose extents are farther than the best match found so
+ * far are skipped without computing their closest point.
+ *
+ * Returns: the pos value on the closest primitive, or -1 on errors.
+ *
+ * Since: 1.0
+ **/
+double
+cpml_segment_get_closest_pos(const CpmlSegment *segment, const CpmlPair *pair,
+                             CpmlPrimitive *primitive)
+{
+    CpmlPrimitive current;
+    CpmlExtents extents;
+    CpmlPair closest;
+    double pos, pos_best, distance, distance_best;
+
+    cpml_primitive_from_segment(&current, (CpmlSegment *) segment);
+    pos_best = -1;
+    distance_best = 0;
+
+    do {
+        extents.is_defined = 0;
+        cpml_primitive_put_extents(&current, &extents);
+        if (pos_best >= 0 && extents.is_defined &&
+            extents_squared_distance(&extents, pair) >= distance_best)
+            continue;
+
+        pos = cpml_primitive_get_closest_pos(&current, pair);
+        if (pos < 0)
+            continue;
+
+        if (cpml_primitive_type(&current) == CPML_CURVE)
+            cpml_curve_put_pair_at_time(&current, pos, &closest);
+        else
+            cpml_primitive_put_pair_at(&current, pos, &closest);
+
+        distance = cpml_pair_squared_distance(&closest, pair);
+        if (pos_best < 0 || distance < distance_best) {
+            pos_best = pos;
+            distance_best = distance;
+            if (primitive != NULL)
+                cpml_primitive_copy(primitive, &current);
+        }
+    } while (cpml_primitive_next(&current));
+
+    return pos_best;
+}
+
 /**
  * cpml_segment_offset:
  * @segment: a #CpmlSegment
@@ -415,6 +947,24 @@ cpml_segment_put_intersections(const CpmlSegment *segment,
  **/
 void
 cpml_segment_offset(CpmlSegment *segment, double offset)
+{
+    cpml_segment_offset_full(segment, offset, NULL);
+}
+
+/**
+ * cpml_segment_offset_full:
+ * @segment:                  a #CpmlSegment
+ * @offset:                   the offset distance
+ * @context: (allow-none):    the offset settings
+ *
+ * Same as cpml_segment_offset() but every primitive is offseted with
+ * cpml_primitive_offset_full() using the settings of @context.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_segment_offset_full(CpmlSegment *segment, double offset,
+                         const CpmlOffsetContext *context)
 {
     CpmlPrimitive primitive;
     CpmlPrimitive last_primitive;
@@ -433,7 +983,7 @@ cpml_segment_offset(CpmlSegment *segment, double offset)
         }
 
         cpml_primitive_put_point(&primitive, -1, &old_end);
-        cpml_primitive_offset(&primitive, offset);
+        cpml_primitive_offset_full(&primitive, offset, context);
 
         if (! first_cycle) {
             cpml_primitive_join(&last_primitive, &primitive);
@@ -445,6 +995,569 @@ cpml_segment_offset(CpmlSegment *segment, double offset)
     } while (cpml_primitive_next(&primitive));
 }
 
+/**
+ * cpml_segment_put_offset:
+ * @segment:                a #CpmlSegment
+ * @offset:                 the offset distance
+ * @context: (allow-none):  the offset settings
+ * @join:                   how to connect the offseted primitives
+ * @trim:                   whether to trim overlapping primitives
+ * @n_dest:                 size of @dest, in #cairo_path_data_t
+ * @dest: (allow-none):     the destination buffer
+ *
+ * Offsets @segment of the specified amount as cpml_segment_offset()
+ * but without modifying @segment: the offseted segment is stored
+ * in @dest, so there is no need to duplicate @segment in advance.
+ *
+ * Being out-of-place, the number of primitives can grow. Where two
+ * offseted primitives do not meet anymore, they are connected
+ * according to @join: %CAIRO_LINE_JOIN_MITER extends both primitives
+ * up to their intersection (falling back to a bevel when the
+ * primitives are parallel), %CAIRO_LINE_JOIN_BEVEL adds a line and
+ * %CAIRO_LINE_JOIN_ROUND adds a %CPML_ARC centered on the original
+ * vertex. When @context has a positive tolerance, every curve is
+ * split in more curves by cpml_curve_offset_to_curves().
+ *
+ * When @trim is not 0, the primitives overlapping on the inner side
+ * of a corner are cut at their intersection instead of being joined.
+ * Only adjacent primitives are checked: the loops generated by an
+ * @offset bigger than the curvature radius are not removed.
+ *
+ * The result can contain %CPML_ARC primitives, so use
+ * cpml_segment_to_cairo() to render it. If @dest is
+ * <constant>NULL</constant> or too small, nothing (or only the data
+ * fitting inside @n_dest) is stored but the required size is returned
+ * anyway, so the destination buffer can be allocated in advance.
+ *
+ * Returns: the number of #cairo_path_data_t needed by the offseted segment
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_put_offset(const CpmlSegment *segment, double offset,
+                        const CpmlOffsetContext *context,
+                        cairo_line_join_t join, int trim,
+                        size_t n_dest, cairo_path_data_t *dest)
+{
+    OffsetItem items[2], first;
+    OffsetItem *prev, *cur;
+    CpmlPrimitive primitive;
+    cairo_path_data_t extra[3];
+    size_t n_data, n_extra;
+    int is_closed;
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    prev = NULL;
+    cur = &items[0];
+    n_data = 0;
+    is_closed = 0;
+
+    do {
+        if (cpml_primitive_type(&primitive) == CPML_CLOSE)
+            is_closed = 1;
+
+        /* Degenerated primitives are silently skipped */
+        if (! offset_item(cur, &primitive, offset, context))
+            continue;
+
+        if (prev == NULL) {
+            extra[0].header.type = CPML_MOVE;
+            extra[0].header.length = 2;
+            extra[1] = cur->data[0];
+            n_data = put_data(dest, n_dest, n_data, extra, 2);
+            first = *cur;
+        } else {
+            n_extra = offset_join(prev, cur, offset, join, trim, extra);
+            n_data = put_data(dest, n_dest, n_data,
+                              prev->data + 1, prev->num_data);
+            n_data = put_data(dest, n_dest, n_data, extra, n_extra);
+        }
+
+        /* The current item becomes the previous one */
+        prev = cur;
+        cur = cur == &items[0] ? &items[1] : &items[0];
+    } while (cpml_primitive_next(&primitive));
+
+    if (prev == NULL)
+        return 0;
+
+    n_extra = 0;
+    if (is_closed) {
+        /* Joining the last primitive with the first one can move the
+         * start point, that is the point of the leading CPML_MOVE */
+        n_extra = offset_join(prev, &first, offset, join, trim, extra);
+        if (dest != NULL && n_dest > 1)
+            dest[1] = first.data[0];
+    }
+
+    n_data = put_data(dest, n_dest, n_data, prev->data + 1, prev->num_data);
+    n_data = put_data(dest, n_dest, n_data, extra, n_extra);
+
+    if (is_closed) {
+        extra[0].header.type = CPML_CLOSE;
+        extra[0].header.length = 1;
+        n_data = put_data(dest, n_dest, n_data, extra, 1);
+    }
+
+    return n_data;
+}
+
+/**
+ * cpml_segment_flatten:
+ * @segment:   a #CpmlSegment
+ * @tolerance: the maximum distance between @segment and the polyline
+ * @n_dest:    maximum number of points to return
+ * @dest: (allow-none): the destination vector of #CpmlPair
+ *
+ * Approximates @segment with a polyline, storing its vertices in @dest.
+ * The first point is the start of @segment and a %CPML_CLOSE primitive
+ * adds the start point again at the end. The %CPML_LINE primitives are
+ * kept as is, while the %CPML_ARC and %CPML_CURVE primitives are split
+ * in chords not further than @tolerance from the original primitive:
+ * arcs by computing the number of chords from their radius and curves
+ * by subdividing them until they are flat enough.
+ *
+ * Differently from cairo_copy_path_flat(), no cairo context is needed
+ * and nothing is allocated: if @dest is <constant>NULL</constant>,
+ * nothing is stored and the total number of points is returned, so
+ * the destination buffer can be allocated in advance. Otherwise at
+ * most @n_dest points are stored.
+ *
+ * Returns: the number of points of the polyline or 0 if @tolerance
+ *          is not positive.
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_flatten(const CpmlSegment *segment, double tolerance,
+                     size_t n_dest, CpmlPair *dest)
+{
+    FlatBuffer buffer;
+    CpmlPrimitive primitive;
+    CpmlPair p[4];
+
+    if (tolerance <= 0)
+        return 0;
+
+    buffer.tolerance = tolerance;
+    buffer.n_dest = n_dest;
+    buffer.n = 0;
+    buffer.dest = dest;
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    cpml_primitive_put_point(&primitive, 0, &p[0]);
+    flat_add(&buffer, &p[0]);
+
+    do {
+        switch ((int) cpml_primitive_type(&primitive)) {
+        case CPML_ARC:
+            flat_arc(&buffer, &primitive);
+            break;
+        case CPML_CURVE:
+            cpml_primitive_put_point(&primitive, 0, &p[0]);
+            cpml_primitive_put_point(&primitive, 1, &p[1]);
+            cpml_primitive_put_point(&primitive, 2, &p[2]);
+            cpml_primitive_put_point(&primitive, 3, &p[3]);
+            flat_curve(&buffer, p, 0);
+            break;
+        default:
+            /* CPML_LINE and CPML_CLOSE: the end point is enough */
+            cpml_primitive_put_point(&primitive, -1, &p[0]);
+            flat_add(&buffer, &p[0]);
+            break;
+        }
+    } while (cpml_primitive_next(&primitive));
+
+    return buffer.n;
+}
+
+/**
+ * cpml_segment_put_simplified:
+ * @segment:            a #CpmlSegment
+ * @tolerance:          the maximum distance from the original points
+ * @fit_arcs:           whether %CPML_ARC primitives can be generated
+ * @n_dest:             size of @dest, in #cairo_path_data_t
+ * @dest: (allow-none): the destination buffer
+ *
+ * Simplifies @segment, storing the result in @dest. Every run of
+ * consecutive %CPML_LINE primitives is reduced with the
+ * Douglas-Peucker algorithm: the points not further than @tolerance
+ * from the polyline of the remaining ones are dropped, so in
+ * particular collinear lines are merged. Any other primitive is
+ * copied as is and the end points of every run are preserved.
+ *
+ * When @fit_arcs is not 0, runs of at least three lines whose points
+ * lie within @tolerance from a circle, progressing always in the same
+ * direction, are replaced by a single %CPML_ARC before reducing the
+ * remaining lines. Use cpml_segment_to_cairo() to render the result.
+ *
+ * The result is never bigger than @segment, so a buffer of
+ * <structfield>num_data</structfield> items is always enough. If @dest
+ * is <constant>NULL</constant> or too small, nothing (or only the data
+ * fitting inside @n_dest) is stored but the required size is returned
+ * anyway.
+ *
+ * Returns: the number of #cairo_path_data_t of the simplified segment
+ *          or 0 if @tolerance is not positive.
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_put_simplified(const CpmlSegment *segment, double tolerance,
+                            int fit_arcs, size_t n_dest,
+                            cairo_path_data_t *dest)
+{
+    const cairo_path_data_t *data, *item;
+    CpmlPair *points;
+    unsigned char *keep;
+    size_t *stack;
+    size_t n_max, n_points, n_data, n_point;
+    int n, length;
+
+    if (tolerance <= 0 || segment->num_data <= 0)
+        return 0;
+
+    /* No run can have more points than half the data, plus the origin */
+    n_max = segment->num_data / 2 + 1;
+    points = malloc(n_max * sizeof(CpmlPair));
+    keep = malloc(n_max);
+    stack = malloc(n_max * 2 * sizeof(size_t));
+
+    /* The leading CPML_MOVE is the origin of the first run */
+    data = segment->data;
+    n = data->header.length;
+    n_data = put_data(dest, n_dest, 0, data, n);
+    cpml_pair_from_cairo(&points[0], &data[1]);
+    n_points = 1;
+
+    while (n < segment->num_data) {
+        item = data + n;
+        length = item->header.length;
+
+        if (item->header.type == CPML_LINE && length == 2) {
+            cpml_pair_from_cairo(&points[n_points], &item[1]);
+            ++n_points;
+        } else {
+            /* Any other primitive breaks the run and starts a new one */
+            n_data = simplify_run(points, n_points, tolerance, fit_arcs,
+                                  keep, stack, n_dest, n_data, dest);
+            n_data = put_data(dest, n_dest, n_data, item, length);
+
+            if (item->header.type == CPML_CLOSE) {
+                cpml_pair_from_cairo(&points[0], &data[1]);
+            } else {
+                n_point = item->header.type == CPML_MOVE ? 1 :
+                    cpml_primitive_type_get_n_points(item->header.type) - 1;
+                cpml_pair_from_cairo(&points[0], &item[n_point]);
+            }
+            n_points = 1;
+        }
+
+        n += length;
+    }
+
+    n_data = simplify_run(points, n_points, tolerance, fit_arcs,
+                          keep, stack, n_dest, n_data, dest);
+
+    free(stack);
+    free(keep);
+    free(points);
+
+    return n_data;
+}
+
+/**
+ * cpml_segment_put_fitted:
+ * @segment:            a #CpmlSegment
+ * @tolerance:          the maximum distance from the original points
+ * @n_dest:             size of @dest, in #cairo_path_data_t
+ * @dest: (allow-none): the destination buffer
+ *
+ * Compacts @segment by fitting cubic Bézier curves to its runs of
+ * consecutive %CPML_LINE primitives, storing the result in @dest.
+ * This is meant for dense sampled data, such as profiles made of
+ * hundreds of tiny lines, where cpml_segment_put_simplified() is not
+ * effective because no point is really collinear with its neighbours.
+ *
+ * Every run is first split where two consecutive lines make an angle
+ * wider than 45 degrees, so sharp corners are preserved. Every part is
+ * then fitted with the least squares method described in the
+ * "An Algorithm for Automatically Fitting Digitized Curves" paper by
+ * Philip J. Schneider: a curve is accepted when all the points of the
+ * part are not further than @tolerance from it, otherwise the part is
+ * split at the worst point and the halves are fitted again, keeping
+ * the same tangent on both sides of the split. Parts spanning less
+ * than three lines are left as they are, so any other primitive and
+ * the end points of every run are preserved.
+ *
+ * The result is never bigger than @segment, so a buffer of
+ * <structfield>num_data</structfield> items is always enough. If @dest
+ * is <constant>NULL</constant> or too small, nothing (or only the data
+ * fitting inside @n_dest) is stored but the required size is returned
+ * anyway.
+ *
+ * Returns: the number of #cairo_path_data_t of the compacted segment
+ *          or 0 if @tolerance is not positive.
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_put_fitted(const CpmlSegment *segment, double tolerance,
+                        size_t n_dest, cairo_path_data_t *dest)
+{
+    const cairo_path_data_t *data, *item;
+    CpmlPair *points;
+    double *times;
+    FitSpan *stack;
+    size_t n_max, n_points, n_data, n_point;
+    int n, length;
+
+    if (tolerance <= 0 || segment->num_data <= 0)
+        return 0;
+
+    /* No run can have more points than half the data, plus the origin */
+    n_max = segment->num_data / 2 + 1;
+    points = malloc(n_max * sizeof(CpmlPair));
+    times = malloc(n_max * sizeof(double));
+    stack = malloc(n_max * sizeof(FitSpan));
+
+    /* The leading CPML_MOVE is the origin of the first run */
+    data = segment->data;
+    n = data->header.length;
+    n_data = put_data(dest, n_dest, 0, data, n);
+    cpml_pair_from_cairo(&points[0], &data[1]);
+    n_points = 1;
+
+    while (n < segment->num_data) {
+        item = data + n;
+        length = item->header.length;
+
+        if (item->header.type == CPML_LINE && length == 2) {
+            cpml_pair_from_cairo(&points[n_points], &item[1]);
+            ++n_points;
+        } else {
+            /* Any other primitive breaks the run and starts a new one */
+            n_data = fit_run(points, n_points, tolerance, times, stack,
+                             n_dest, n_data, dest);
+            n_data = put_data(dest, n_dest, n_data, item, length);
+
+            if (item->header.type == CPML_CLOSE) {
+                cpml_pair_from_cairo(&points[0], &data[1]);
+            } else {
+                n_point = item->header.type == CPML_MOVE ? 1 :
+                    cpml_primitive_type_get_n_points(item->header.type) - 1;
+                cpml_pair_from_cairo(&points[0], &item[n_point]);
+            }
+            n_points = 1;
+        }
+
+        n += length;
+    }
+
+    n_data = fit_run(points, n_points, tolerance, times, stack,
+                     n_dest, n_data, dest);
+
+    free(stack);
+    free(times);
+    free(points);
+
+    return n_data;
+}
+
+/**
+ * cpml_segment_put_boolean:
+ * @segment:            the first closed #CpmlSegment
+ * @segment2:           the second closed #CpmlSegment
+ * @operation:          the boolean operation to perform
+ * @tolerance:          the maximum distance allowed when flattening
+ * @n_dest:             size of @dest, in #cairo_path_data_t
+ * @dest: (allow-none): the destination buffer
+ *
+ * Combines the areas enclosed by @segment and @segment2 with
+ * @operation, storing the outline of the result in @dest. Both
+ * segments are considered closed even if they do not end with a
+ * %CPML_CLOSE primitive and must not intersect themselves: their
+ * direction is not relevant.
+ *
+ * The segments are flattened with cpml_segment_flatten(), so the
+ * result is made only of %CPML_LINE primitives not further than
+ * @tolerance from the original outlines: use cpml_segment_put_fitted()
+ * if smooth curves must be recovered. The edges of both polygons are
+ * split at their intersections, found with the same sweep described in
+ * cpml_segment_put_intersections(), and every piece is kept or dropped
+ * depending on its position relative to the other polygon. Overlapping
+ * edges are handled, so outlines sharing a side are joined properly.
+ *
+ * The result can be made by more than one closed segment (e.g. a
+ * difference leaving a hole or an intersection between two concave
+ * outlines), each one starting with a %CPML_MOVE and ending with a
+ * %CPML_CLOSE: outer boundaries are counterclockwise and holes are
+ * clockwise, so the result can be filled with any fill rule. Use
+ * cpml_segment_from_cairo() and cpml_segment_next() to browse it or
+ * append it directly to an #AdgPath.
+ *
+ * If @dest is <constant>NULL</constant> or too small, nothing (or only
+ * the data fitting inside @n_dest) is stored but the required size is
+ * returned anyway.
+ *
+ * Returns: the number of #cairo_path_data_t of the result, 0 if the
+ *          result is empty or @tolerance is not positive.
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_put_boolean(const CpmlSegment *segment,
+                         const CpmlSegment *segment2,
+                         CpmlBooleanOperation operation, double tolerance,
+                         size_t n_dest, cairo_path_data_t *dest)
+{
+    BoolPolygon polygons[2];
+    const BoolPolygon *polygon, *other;
+    BoolItem *items;
+    const BoolItem **active;
+    BoolSplit *splits;
+    BoolEdge *edges, *edge;
+    CpmlPair *loop, from, to;
+    const CpmlPair *end;
+    size_t n_items, n_active, n_kept, n_splits, n_max, n_edges, n_loop;
+    size_t n_data, n, i, split;
+    int owner, position, keep, reverse, is_last;
+
+    if (tolerance <= 0 ||
+        ! bool_polygon(segment, tolerance, &polygons[0]))
+        return 0;
+    if (! bool_polygon(segment2, tolerance, &polygons[1])) {
+        free(polygons[0].points);
+        return 0;
+    }
+
+    n_items = polygons[0].n_points + polygons[1].n_points;
+    items = malloc(n_items * sizeof(BoolItem));
+    bool_items(&polygons[0], 0, 0, items);
+    bool_items(&polygons[1], 1, polygons[0].n_points, items);
+
+    /* Sweep the edges from left to right, looking for intersections
+     * only between overlapping edges of different polygons */
+    qsort(items, n_items, sizeof(BoolItem), bool_item_compare);
+    active = malloc(n_items * sizeof(BoolItem *));
+    n_active = 0;
+    n_splits = 0;
+    n_max = 0;
+    splits = NULL;
+
+    for (n = 0; n < n_items; ++ n) {
+        n_kept = 0;
+        for (i = 0; i < n_active; ++ i)
+            if (active[i]->x_max >= items[n].x_min - BOOLEAN_EPSILON)
+                active[n_kept++] = active[i];
+        n_active = n_kept;
+
+        for (i = 0; i < n_active; ++ i) {
+            if (active[i]->owner != items[n].owner &&
+                active[i]->y_max >= items[n].y_min - BOOLEAN_EPSILON &&
+                active[i]->y_min <= items[n].y_max + BOOLEAN_EPSILON)
+                splits = bool_intersect(active[i], &items[n],
+                                        splits, &n_splits, &n_max);
+        }
+
+        active[n_active++] = &items[n];
+    }
+
+    free(active);
+    free(items);
+    if (n_splits > 0)
+        qsort(splits, n_splits, sizeof(BoolSplit), bool_split_compare);
+
+    /* Split the edges and select the pieces belonging to the result */
+    edges = malloc((n_items + n_splits) * sizeof(BoolEdge));
+    n_edges = 0;
+    split = 0;
+    n = 0;
+
+    for (owner = 0; owner < 2; ++ owner) {
+        polygon = &polygons[owner];
+        other = &polygons[1 - owner];
+
+        for (i = 0; i < polygon->n_points; ++ i, ++ n) {
+            from = polygon->points[i];
+            end = &polygon->points[(i + 1) % polygon->n_points];
+
+            do {
+                is_last = split >= n_splits || splits[split].index != n;
+                to = is_last ? *end : splits[split++].pair;
+
+                /* Coincident splits give zero length pieces */
+                if (cpml_pair_squared_distance(&from, &to) >=
+                    BOOLEAN_EPSILON * BOOLEAN_EPSILON) {
+                    position = bool_classify(&from, &to, other);
+                    switch (operation) {
+                    case CPML_BOOLEAN_UNION:
+                        keep = position == BOOL_OUTSIDE ||
+                            (owner == 0 && position == BOOL_SAME);
+                        break;
+                    case CPML_BOOLEAN_INTERSECTION:
+                        keep = position == BOOL_INSIDE ||
+                            (owner == 0 && position == BOOL_SAME);
+                        break;
+                    case CPML_BOOLEAN_DIFFERENCE:
+                        /* The hole carved by @segment2 is reversed */
+                        keep = owner == 0 ?
+                            position == BOOL_OUTSIDE || position == BOOL_OPPOSITE :
+                            position == BOOL_INSIDE;
+                        break;
+                    default:
+                        keep = 0;
+                        break;
+                    }
+
+                    if (keep) {
+                        reverse = operation == CPML_BOOLEAN_DIFFERENCE && owner == 1;
+                        edge = &edges[n_edges++];
+                        edge->from = reverse ? to : from;
+                        edge->to = reverse ? from : to;
+                        edge->used = 0;
+                    }
+                }
+
+                from = to;
+            } while (! is_last);
+        }
+    }
+
+    free(splits);
+    free(polygons[1].points);
+    free(polygons[0].points);
+
+    /* Chain the selected edges in closed loops */
+    if (n_edges > 0)
+        qsort(edges, n_edges, sizeof(BoolEdge), bool_edge_compare);
+    loop = malloc((n_edges + 1) * sizeof(CpmlPair));
+    n_data = 0;
+
+    for (n = 0; n < n_edges; ++ n) {
+        if (edges[n].used)
+            continue;
+
+        edge = &edges[n];
+        n_loop = 0;
+        do {
+            edge->used = 1;
+            loop[n_loop++] = edge->from;
+            if (cpml_pair_squared_distance(&edge->to, &edges[n].from) <
+                BOOLEAN_EPSILON * BOOLEAN_EPSILON)
+                break;
+            edge = bool_next_edge(edges, n_edges, &edge->to);
+        } while (edge != NULL);
+
+        n_data = bool_put_loop(loop, n_loop, n_dest, n_data, dest);
+    }
+
+    free(loop);
+    free(edges);
+
+    return n_data;
+}
+
 /**
  * cpml_segment_transform:
  * @segment: a #CpmlSegment
@@ -465,16 +1578,16 @@ cpml_segment_transform(CpmlSegment *segment, const cairo_matrix_t *matrix)
     cairo_matrix_transform_point(matrix, &(primitive.org)->point.x,
                                  &(primitive.org)->point.y);
 
+    /* The points of a primitive are contiguous and a cairo_path_data_t
+     * point has the same layout of a CpmlPair, so they can be
+     * transformed in a single batch */
     do {
         data = primitive.data;
         if (data->header.type != CPML_CLOSE) {
             n_points = cpml_primitive_get_n_points(&primitive);
-
-            while (--n_points > 0) {
-                ++data;
-                cairo_matrix_transform_point(matrix,
-                                             &data->point.x, &data->point.y);
-            }
+            if (n_points > 1)
+                cpml_pairs_transform(n_points - 1, (CpmlPair *) (data + 1),
+                                     (CpmlPair *) (data + 1), matrix);
         }
     } while (cpml_primitive_next(&primitive));
 }
@@ -606,27 +1719,204 @@ cpml_segment_dump(const CpmlSegment *segment)
  *
  * Returns: 1 on success, 0 on no leading MOVE_TOs or on errors.
  **/
-static int
-normalize(CpmlSegment *segment)
+/**
+ * cpml_segment_length_table_new:
+ * @segment:   a #CpmlSegment
+ * @n_samples: number of samples used to approximate every
+ *             %CPML_CURVE primitive
+ *
+ * Builds an arc-length parameterization of @segment, so points and
+ * vectors at a given distance from the start can be looked up with a
+ * binary search, without computing the primitive lengths every time.
+ *
+ * Lines and arcs are parameterized exactly. Curves are approximated by
+ * @n_samples chords: more samples mean a better precision. Values
+ * lower than 1 are handled as 1.
+ *
+ * The table refers to the data of @segment, so it is valid only while
+ * the underlying path is not modified or freed.
+ *
+ * Returns: (transfer full): the newly created table: free it with cpml_segment_length_table_destroy() when no longer needed.
+ *
+ * Since: 1.0
+ **/
+CpmlSegmentLengthTable *
+cpml_segment_length_table_new(const CpmlSegment *segment, size_t n_samples)
 {
-    if (!ensure_one_leading_move(segment))
-        return 0;
+    CpmlSegmentLengthTable *table;
+    CpmlPrimitive primitive;
+    LengthSample *sample;
+    CpmlPair pair, last_pair;
+    size_t n_primitives, n_total, n, k, j;
+    double length;
 
-    return reshape(segment);
+    if (n_samples < 1)
+        n_samples = 1;
+
+    /* Count the primitives and the samples needed */
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    n_primitives = 0;
+    n_total = 0;
+    do {
+        ++ n_primitives;
+        n_total += cpml_primitive_type(&primitive) == CPML_CURVE ? n_samples + 1 : 2;
+    } while (cpml_primitive_next(&primitive));
+
+    table = malloc(sizeof(CpmlSegmentLengthTable));
+    table->primitives = malloc(n_primitives * sizeof(CpmlPrimitive));
+    table->samples = malloc(n_total * sizeof(LengthSample));
+    table->n_samples = n_total;
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    sample = table->samples;
+    length = 0;
+    n = 0;
+    do {
+        cpml_primitive_copy(table->primitives + n, &primitive);
+
+        sample->primitive = n;
+        sample->pos = 0;
+        sample->length = length;
+        ++ sample;
+
+        if (cpml_primitive_type(&primitive) == CPML_CURVE) {
+            k = n_samples;
+            cpml_pair_from_cairo(&last_pair, primitive.org);
+            for (j = 1; j <= k; ++ j) {
+                sample->primitive = n;
+                sample->pos = (double) j / k;
+                cpml_curve_put_pair_at_time(&primitive, sample->pos, &pair);
+                length += cpml_pair_distance(&last_pair, &pair);
+                sample->length = length;
+                cpml_pair_copy(&last_pair, &pair);
+                ++ sample;
+            }
+        } else {
+            length += cpml_primitive_get_length(&primitive);
+            sample->primitive = n;
+            sample->pos = 1;
+            sample->length = length;
+            ++ sample;
+        }
+
+        ++ n;
+    } while (cpml_primitive_next(&primitive));
+
+    return table;
 }
 
-/*
- * ensure_one_leading_move:
- * @segment: a #CpmlSegment
+/**
+ * cpml_segment_length_table_destroy:
+ * @table: a #CpmlSegmentLengthTable
  *
- * Jumps to the first %CPML_MOVE primitives and skips all eventual
- * subsequent %CPML_MOVE but the last. This is done unobtrusively,
- * by updating the <structname>CpmlSegment</structname> fields
- * accordingly. One, and only one, %CPML_MOVE primitive is left.
+ * Frees @table and all the resources it uses.
  *
- * Returns: 1 on success, 0 on no leading MOVE_TOs or on empty path
+ * Since: 1.0
  **/
-static int
+void
+cpml_segment_length_table_destroy(CpmlSegmentLengthTable *table)
+{
+    free(table->primitives);
+    free(table->samples);
+    free(table);
+}
+
+/**
+ * cpml_segment_length_table_get_length:
+ * @table: a #CpmlSegmentLengthTable
+ *
+ * Gets the length of the segment used to build @table. This is O(1).
+ *
+ * Returns: the (approximated) length of the segment
+ *
+ * Since: 1.0
+ **/
+double
+cpml_segment_length_table_get_length(const CpmlSegmentLengthTable *table)
+{
+    return table->samples[table->n_samples - 1].length;
+}
+
+/**
+ * cpml_segment_length_table_put_pair_at_length:
+ * @table:  a #CpmlSegmentLengthTable
+ * @length: the distance from the start of the segment
+ * @pair:   the destination #CpmlPair
+ *
+ * Gets the coordinates of the point that is @length far (along the
+ * segment) from the start of the segment used to build @table.
+ * @length is clamped between 0 and the segment length.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_segment_length_table_put_pair_at_length(const CpmlSegmentLengthTable *table,
+                                             double length, CpmlPair *pair)
+{
+    const LengthSample *sample;
+    const CpmlPrimitive *primitive;
+    double pos;
+
+    sample = length_table_lookup(table, length, &pos);
+    primitive = table->primitives + sample->primitive;
+
+    if (cpml_primitive_type(primitive) == CPML_CURVE)
+        cpml_curve_put_pair_at_time(primitive, pos, pair);
+    else
+        cpml_primitive_put_pair_at(primitive, pos, pair);
+}
+
+/**
+ * cpml_segment_length_table_put_vector_at_length:
+ * @table:  a #CpmlSegmentLengthTable
+ * @length: the distance from the start of the segment
+ * @vector: the destination #CpmlVector
+ *
+ * Gets the steepness of the point that is @length far (along the
+ * segment) from the start of the segment used to build @table.
+ * @length is clamped between 0 and the segment length.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_segment_length_table_put_vector_at_length(const CpmlSegmentLengthTable *table,
+                                               double length, CpmlVector *vector)
+{
+    const LengthSample *sample;
+    const CpmlPrimitive *primitive;
+    double pos;
+
+    sample = length_table_lookup(table, length, &pos);
+    primitive = table->primitives + sample->primitive;
+
+    if (cpml_primitive_type(primitive) == CPML_CURVE)
+        cpml_curve_put_vector_at_time(primitive, pos, vector);
+    else
+        cpml_primitive_put_vector_at(primitive, pos, vector);
+}
+
+
+static int
+normalize(CpmlSegment *segment)
+{
+    if (!ensure_one_leading_move(segment))
+        return 0;
+
+    return reshape(segment);
+}
+
+/*
+ * ensure_one_leading_move:
+ * @segment: a #CpmlSegment
+ *
+ * Jumps to the first %CPML_MOVE primitives and skips all eventual
+ * subsequent %CPML_MOVE but the last. This is done unobtrusively,
+ * by updating the <structname>CpmlSegment</structname> fields
+ * accordingly. One, and only one, %CPML_MOVE primitive is left.
+ *
+ * Returns: 1 on success, 0 on no leading MOVE_TOs or on empty path
+ **/
+static int
 ensure_one_leading_move(CpmlSegment *segment)
 {
     cairo_path_data_t *data = segment->data;
@@ -711,3 +2001,1431 @@ reshape(CpmlSegment *segment)
     segment->num_data = num_data;
     return 1;
 }
+
+static SweepItem *
+sweep_items(const CpmlSegment *segment, int owner,
+            SweepItem *items, size_t *n_items)
+{
+    CpmlPrimitive primitive;
+    SweepItem *item;
+    size_t n, first;
+    int is_closed;
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    n = 1;
+    while (cpml_primitive_next(&primitive))
+        ++ n;
+
+    is_closed = primitive.data->header.type == CPML_CLOSE;
+    first = *n_items;
+    items = realloc(items, (first + n) * sizeof(SweepItem));
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    n = 0;
+    do {
+        item = items + first + n;
+        cpml_primitive_copy(&item->primitive, &primitive);
+        item->extents.is_defined = 0;
+        if (! fast_put_extents(&primitive, &item->extents))
+            cpml_primitive_put_extents(&primitive, &item->extents);
+        item->owner = owner;
+        item->index = n;
+        item->is_closed = is_closed;
+        ++ n;
+    } while (cpml_primitive_next(&primitive));
+
+    for (item = items + first; item < items + first + n; ++ item)
+        item->n_primitives = n;
+
+    *n_items = first + n;
+    return items;
+}
+
+static int
+sweep_compare(const void *a, const void *b)
+{
+    const SweepItem *item = a;
+    const SweepItem *item2 = b;
+
+    /* Undefined extents are moved at the end */
+    if (item->extents.is_defined != item2->extents.is_defined)
+        return item->extents.is_defined ? -1 : 1;
+
+    if (item->extents.org.x < item2->extents.org.x)
+        return -1;
+
+    return item->extents.org.x > item2->extents.org.x ? 1 : 0;
+}
+
+static size_t
+sweep(SweepItem *items, size_t n_items, int self,
+      size_t n_dest, CpmlPair *dest)
+{
+    const SweepItem **active;
+    const SweepItem *item;
+    size_t n, i, n_active, n_kept, total;
+
+    qsort(items, n_items, sizeof(SweepItem), sweep_compare);
+    active = malloc(n_items * sizeof(SweepItem *));
+    n_active = 0;
+    total = 0;
+
+    for (n = 0; n < n_items && total < n_dest; ++ n) {
+        item = items + n;
+        if (item->extents.is_defined == 0)
+            break;
+
+        /* Drop the active items ending before the current one */
+        n_kept = 0;
+        for (i = 0; i < n_active; ++ i) {
+            if (active[i]->extents.org.x + active[i]->extents.size.x >=
+                item->extents.org.x)
+                active[n_kept++] = active[i];
+        }
+        n_active = n_kept;
+
+        for (i = 0; i < n_active && total < n_dest; ++ i) {
+            if ((self || active[i]->owner != item->owner) &&
+                cpml_extents_overlap(&active[i]->extents, &item->extents))
+                total += sweep_pair(active[i], item, self,
+                                    n_dest - total, dest + total);
+        }
+
+        active[n_active++] = item;
+    }
+
+    free(active);
+    return total;
+}
+
+static size_t
+sweep_pair(const SweepItem *item, const SweepItem *item2, int self,
+           size_t n_dest, CpmlPair *dest)
+{
+    CpmlPair partial[5], joint;
+    const CpmlPair *pair;
+    size_t found, total, first, last;
+    int is_adjacent;
+
+    found = cpml_primitive_put_intersections(&item->primitive,
+                                             &item2->primitive, 5, partial);
+    if (found == 0)
+        return 0;
+
+    /* On self-intersections, the joint between adjacent primitives
+     * must be skipped */
+    is_adjacent = 0;
+    if (self) {
+        first = item->index < item2->index ? item->index : item2->index;
+        last = item->index < item2->index ? item2->index : item->index;
+        if (last == first + 1) {
+            is_adjacent = 1;
+            cpml_pair_from_cairo(&joint, item->index == first ?
+                                 item2->primitive.org : item->primitive.org);
+        } else if (item->is_closed && first == 0 &&
+                   last == item->n_primitives - 1) {
+            is_adjacent = 1;
+            cpml_pair_from_cairo(&joint, item->index == first ?
+                                 item->primitive.org : item2->primitive.org);
+        }
+    }
+
+    total = 0;
+    for (pair = partial; found && total < n_dest; -- found, ++ pair) {
+        if (! cpml_extents_pair_is_inside(&item->extents, pair) ||
+            ! cpml_extents_pair_is_inside(&item2->extents, pair))
+            continue;
+        if (is_adjacent && cpml_pair_squared_distance(pair, &joint) < 1e-12)
+            continue;
+        cpml_pair_copy(dest + total, pair);
+        ++ total;
+    }
+
+    return total;
+}
+
+/* Number of chords used to approximate arcs and curves */
+#define SCAN_CHORDS 16
+
+static ScanEdge *
+scan_edges(const CpmlSegment *segment, const CpmlVector *direction,
+           size_t *n_edges)
+{
+    CpmlPrimitive primitive;
+    CpmlPair first, last, pair;
+    ScanEdge *edges;
+    CpmlPrimitiveType type;
+    size_t n_max;
+    int n;
+
+    /* Count the maximum number of edges, closing edge included */
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    n_max = 1;
+    do {
+        type = cpml_primitive_type(&primitive);
+        n_max += type == CPML_ARC || type == CPML_CURVE ? SCAN_CHORDS : 1;
+    } while (cpml_primitive_next(&primitive));
+
+    edges = malloc(n_max * sizeof(ScanEdge));
+    *n_edges = 0;
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    cpml_primitive_put_pair_at(&primitive, 0, &first);
+    cpml_pair_copy(&last, &first);
+
+    do {
+        type = cpml_primitive_type(&primitive);
+        if (type == CPML_ARC || type == CPML_CURVE) {
+            for (n = 1; n <= SCAN_CHORDS; ++ n) {
+                cpml_primitive_put_pair_at(&primitive,
+                                           (double) n / SCAN_CHORDS, &pair);
+                scan_add_edge(edges + *n_edges, &last, &pair,
+                              direction, n_edges);
+                cpml_pair_copy(&last, &pair);
+            }
+        } else {
+            cpml_primitive_put_pair_at(&primitive, 1, &pair);
+            scan_add_edge(edges + *n_edges, &last, &pair, direction, n_edges);
+            cpml_pair_copy(&last, &pair);
+        }
+    } while (cpml_primitive_next(&primitive));
+
+    /* Implicitly close the segment */
+    scan_add_edge(edges + *n_edges, &last, &first, direction, n_edges);
+
+    return edges;
+}
+
+static void
+scan_add_edge(ScanEdge *edge, const CpmlPair *p1, const CpmlPair *p2,
+              const CpmlVector *direction, size_t *n_edges)
+{
+    double u1, v1, u2, v2;
+
+    /* Rotate the points so the lines will be horizontal */
+    u1 = p1->x * direction->x + p1->y * direction->y;
+    v1 = p1->y * direction->x - p1->x * direction->y;
+    u2 = p2->x * direction->x + p2->y * direction->y;
+    v2 = p2->y * direction->x - p2->x * direction->y;
+
+    /* Edges parallel to the lines never cross them */
+    if (v1 == v2)
+        return;
+
+    if (v1 < v2) {
+        edge->u = u1;
+        edge->v1 = v1;
+        edge->v2 = v2;
+    } else {
+        edge->u = u2;
+        edge->v1 = v2;
+        edge->v2 = v1;
+    }
+
+    edge->slope = (u2 - u1) / (v2 - v1);
+    ++ *n_edges;
+}
+
+static int
+scan_compare(const void *a, const void *b)
+{
+    const ScanEdge *edge = a;
+    const ScanEdge *edge2 = b;
+
+    if (edge->v1 < edge2->v1)
+        return -1;
+
+    return edge->v1 > edge2->v1 ? 1 : 0;
+}
+
+static int
+double_compare(const void *a, const void *b)
+{
+    double value = *(const double *) a;
+    double value2 = *(const double *) b;
+
+    if (value < value2)
+        return -1;
+
+    return value > value2 ? 1 : 0;
+}
+
+static const LengthSample *
+length_table_lookup(const CpmlSegmentLengthTable *table, double length,
+                    double *pos)
+{
+    const LengthSample *samples, *sample, *prev;
+    size_t lo, hi, mid;
+
+    samples = table->samples;
+
+    if (length <= 0) {
+        *pos = 0;
+        return samples;
+    }
+
+    /* Look for the first sample not shorter than length */
+    lo = 1;
+    hi = table->n_samples - 1;
+    if (length >= samples[hi].length) {
+        *pos = 1;
+        return samples + hi;
+    }
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (samples[mid].length < length)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    sample = samples + lo;
+    prev = sample - 1;
+
+    if (prev->primitive != sample->primitive ||
+        sample->length <= prev->length) {
+        *pos = sample->pos;
+    } else {
+        /* Linear interpolation inside the sampled interval */
+        *pos = prev->pos + (sample->pos - prev->pos) *
+               (length - prev->length) / (sample->length - prev->length);
+    }
+
+    return sample;
+}
+
+static double
+extents_squared_distance(const CpmlExtents *extents, const CpmlPair *pair)
+{
+    double dx, dy;
+
+    dx = 0;
+    if (pair->x < extents->org.x)
+        dx = extents->org.x - pair->x;
+    else if (pair->x > extents->org.x + extents->size.x)
+        dx = pair->x - extents->org.x - extents->size.x;
+
+    dy = 0;
+    if (pair->y < extents->org.y)
+        dy = extents->org.y - pair->y;
+    else if (pair->y > extents->org.y + extents->size.y)
+        dy = pair->y - extents->org.y - extents->size.y;
+
+    return dx * dx + dy * dy;
+}
+
+/* The fast_...() functions are specialized versions of the primitive
+ * methods for the most common (and simplest) types, switching directly
+ * on the primitive type instead of passing through the class table.
+ * They return 0 when @primitive must be handled by the generic API */
+static int
+fast_get_length(const CpmlPrimitive *primitive, double *length)
+{
+    const cairo_path_data_t *end;
+    double dx, dy;
+
+    switch (primitive->data->header.type) {
+    case CPML_LINE:
+        end = &primitive->data[1];
+        break;
+    case CPML_CLOSE:
+        end = &primitive->segment->data[1];
+        break;
+    default:
+        return 0;
+    }
+
+    dx = end->point.x - primitive->org->point.x;
+    dy = end->point.y - primitive->org->point.y;
+    *length = sqrt(dx * dx + dy * dy);
+    return 1;
+}
+
+/* Differently from cpml_primitive_put_extents(), @extents is
+ * enlarged to include @primitive instead of being replaced */
+static int
+fast_put_extents(const CpmlPrimitive *primitive, CpmlExtents *extents)
+{
+    CpmlPair pair;
+
+    switch (primitive->data->header.type) {
+    case CPML_LINE:
+        cpml_pair_from_cairo(&pair, &primitive->data[1]);
+        break;
+    case CPML_CLOSE:
+        cpml_pair_from_cairo(&pair, &primitive->segment->data[1]);
+        break;
+    default:
+        /* Arcs and curves can go beyond their points */
+        return 0;
+    }
+
+    cpml_extents_pair_add(extents, &pair);
+    cpml_pair_from_cairo(&pair, primitive->org);
+    cpml_extents_pair_add(extents, &pair);
+
+    return 1;
+}
+
+/* Stores in @item the offset of @primitive, returning 0 on degenerated
+ * primitives. A CPML_CLOSE is converted to the equivalent CPML_LINE */
+static int
+offset_item(OffsetItem *item, const CpmlPrimitive *primitive,
+            double offset, const CpmlOffsetContext *context)
+{
+    cairo_path_data_t src_data[5];
+    CpmlPrimitive src, dst;
+    CpmlSegment curves;
+    CpmlPrimitiveType type;
+    CpmlPair start, end;
+    size_t n_curves;
+
+    type = cpml_primitive_type(primitive);
+    cpml_primitive_put_point(primitive, 0, &item->vertex);
+    cpml_primitive_put_point(primitive, -1, &end);
+
+    if (type == CPML_CLOSE || type == CPML_LINE) {
+        if (item->vertex.x == end.x && item->vertex.y == end.y)
+            return 0;
+        src_data[1].header.type = CPML_LINE;
+        src_data[1].header.length = 2;
+        cpml_pair_to_cairo(&end, &src_data[2]);
+    } else if (type == CPML_ARC || type == CPML_CURVE) {
+        memcpy(src_data + 1, primitive->data,
+               sizeof(cairo_path_data_t) * primitive->data->header.length);
+    } else {
+        return 0;
+    }
+
+    cpml_pair_to_cairo(&item->vertex, &src_data[0]);
+    src.segment = NULL;
+    src.org = &src_data[0];
+    src.data = &src_data[1];
+
+    if (type == CPML_CURVE) {
+        cpml_curve_put_vector_at_time(&src, 0, &item->start_vector);
+        cpml_curve_put_vector_at_time(&src, 1, &item->end_vector);
+    } else {
+        cpml_primitive_put_vector_at(&src, 0, &item->start_vector);
+        cpml_primitive_put_vector_at(&src, 1, &item->end_vector);
+    }
+
+    if (type == CPML_CURVE && context != NULL && context->tolerance > 0) {
+        curves.path = NULL;
+        curves.data = item->data + 1;
+        curves.num_data = 0;
+        n_curves = cpml_curve_offset_to_curves(&src, offset, context,
+                                               &curves, OFFSET_MAX_CURVES);
+        if (n_curves == 0)
+            return 0;
+
+        cpml_curve_put_offset_at_time(&src, 0, offset, &start);
+        cpml_pair_to_cairo(&start, &item->data[0]);
+        item->num_data = n_curves * 4;
+        item->last = item->num_data - 3;
+        return 1;
+    }
+
+    item->num_data = src_data[1].header.length;
+    item->last = 1;
+    memcpy(item->data, src_data,
+           sizeof(cairo_path_data_t) * (item->num_data + 1));
+
+    offset_item_first(item, &dst);
+    cpml_primitive_offset_full(&dst, offset, context);
+    return 1;
+}
+
+static void
+offset_item_first(OffsetItem *item, CpmlPrimitive *primitive)
+{
+    primitive->segment = NULL;
+    primitive->org = &item->data[0];
+    primitive->data = &item->data[1];
+}
+
+static void
+offset_item_last(OffsetItem *item, CpmlPrimitive *primitive)
+{
+    primitive->segment = NULL;
+    primitive->org = &item->data[item->last - 1];
+    primitive->data = &item->data[item->last];
+}
+
+/* Connects the end of @item to the start of @item2, possibly
+ * modifying them, and returns in @extra the primitive to insert
+ * between them: the number of data stored in @extra is returned */
+static size_t
+offset_join(OffsetItem *item, OffsetItem *item2, double offset,
+            cairo_line_join_t join, int trim, cairo_path_data_t *extra)
+{
+    CpmlPrimitive primitive, primitive2;
+    CpmlPair end, start, pair;
+    CpmlVector bisector;
+    double cross;
+
+    offset_item_last(item, &primitive);
+    offset_item_first(item2, &primitive2);
+    cpml_primitive_put_point(&primitive, -1, &end);
+    cpml_primitive_put_point(&primitive2, 0, &start);
+
+    if (end.x == start.x && end.y == start.y)
+        return 0;
+
+    /* cpml_vector_normal() rotates counterclockwise, so on the inner
+     * side of a corner the turn and @offset have the same sign */
+    cross = item->end_vector.x * item2->start_vector.y -
+            item->end_vector.y * item2->start_vector.x;
+
+    if (trim && cross * offset > 0) {
+        if (cpml_primitive_put_intersections(&primitive, &primitive2,
+                                             1, &pair) > 0) {
+            cpml_primitive_set_point(&primitive, -1, &pair);
+            cpml_primitive_set_point(&primitive2, 0, &pair);
+            return 0;
+        }
+        if (cpml_primitive_join(&primitive, &primitive2))
+            return 0;
+    }
+
+    if (join == CAIRO_LINE_JOIN_MITER &&
+        cpml_primitive_join(&primitive, &primitive2))
+        return 0;
+
+    if (join == CAIRO_LINE_JOIN_ROUND) {
+        bisector.x = end.x + start.x - 2 * item2->vertex.x;
+        bisector.y = end.y + start.y - 2 * item2->vertex.y;
+        if (bisector.x != 0 || bisector.y != 0) {
+            cpml_vector_set_length(&bisector, fabs(offset));
+            pair.x = item2->vertex.x + bisector.x;
+            pair.y = item2->vertex.y + bisector.y;
+            extra[0].header.type = CPML_ARC;
+            extra[0].header.length = 3;
+            cpml_pair_to_cairo(&pair, &extra[1]);
+            cpml_pair_to_cairo(&start, &extra[2]);
+            return 3;
+        }
+    }
+
+    /* Bevel, also used as fallback */
+    extra[0].header.type = CPML_LINE;
+    extra[0].header.length = 2;
+    cpml_pair_to_cairo(&start, &extra[1]);
+    return 2;
+}
+
+/* Appends @n data to @dest, without overflowing @n_dest:
+ * returns the new number of data, including the skipped ones */
+static void
+flat_add(FlatBuffer *buffer, const CpmlPair *pair)
+{
+    if (buffer->dest == NULL) {
+        ++ buffer->n;
+    } else if (buffer->n < buffer->n_dest) {
+        buffer->dest[buffer->n] = *pair;
+        ++ buffer->n;
+    }
+}
+
+/* The chords of an arc are equally spaced: the sagitta of a chord
+ * spanning an angle a is r (1 - cos(a/2)), so the maximum angle
+ * allowed by the tolerance follows directly. The approximated
+ * trigonometry is used whenever its error, scaled by r, is well
+ * below the tolerance */
+static void
+flat_arc(FlatBuffer *buffer, const CpmlPrimitive *arc)
+{
+    CpmlPair center, pair;
+    double r, start, end, step, sine, cosine;
+    size_t n, n_chords;
+    CpmlTrigMode mode;
+
+    if (cpml_arc_info(arc, &center, &r, &start, &end) &&
+        r > buffer->tolerance) {
+        step = 2 * acos(1 - buffer->tolerance / r);
+        n_chords = (size_t) ceil(fabs(end - start) / step);
+        step = (end - start) / n_chords;
+        mode = r * 1e-9 < buffer->tolerance ? CPML_TRIG_FAST : CPML_TRIG_EXACT;
+        for (n = 1; n < n_chords; ++ n) {
+            cpml_sincos(start + step * n, &sine, &cosine, mode);
+            pair.x = center.x + r * cosine;
+            pair.y = center.y + r * sine;
+            flat_add(buffer, &pair);
+        }
+    }
+
+    /* The end point is always reached exactly */
+    cpml_primitive_put_point(arc, -1, &pair);
+    flat_add(buffer, &pair);
+}
+
+/* Adds the points of the cubic Bézier curve defined by @p, the start
+ * point excluded, by recursively splitting it in the middle until the
+ * control points are close enough to the chord: the flatness check
+ * is the one in the "Piecewise Linear Approximation of Bézier Curves"
+ * paper by Roger Willcocks, that never underestimates the distance */
+static void
+flat_curve(FlatBuffer *buffer, const CpmlPair *p, int depth)
+{
+    CpmlPair left[4], right[4], p12, p23;
+    double ux, uy, vx, vy;
+
+    ux = 3 * p[1].x - 2 * p[0].x - p[3].x;
+    uy = 3 * p[1].y - 2 * p[0].y - p[3].y;
+    vx = 3 * p[2].x - 2 * p[3].x - p[0].x;
+    vy = 3 * p[2].y - 2 * p[3].y - p[0].y;
+    ux *= ux;
+    uy *= uy;
+    vx *= vx;
+    vy *= vy;
+    if (vx > ux)
+        ux = vx;
+    if (vy > uy)
+        uy = vy;
+
+    if (depth >= FLATTEN_MAX_DEPTH ||
+        ux + uy <= 16 * buffer->tolerance * buffer->tolerance) {
+        flat_add(buffer, &p[3]);
+        return;
+    }
+
+    /* de Casteljau subdivision at t = 0.5 */
+    left[0] = p[0];
+    right[3] = p[3];
+    left[1].x = (p[0].x + p[1].x) / 2;
+    left[1].y = (p[0].y + p[1].y) / 2;
+    p12.x = (p[1].x + p[2].x) / 2;
+    p12.y = (p[1].y + p[2].y) / 2;
+    right[2].x = (p[2].x + p[3].x) / 2;
+    right[2].y = (p[2].y + p[3].y) / 2;
+    left[2].x = (left[1].x + p12.x) / 2;
+    left[2].y = (left[1].y + p12.y) / 2;
+    p23.x = (p12.x + right[2].x) / 2;
+    p23.y = (p12.y + right[2].y) / 2;
+    right[1] = p23;
+    left[3].x = (left[2].x + p23.x) / 2;
+    left[3].y = (left[2].y + p23.y) / 2;
+    right[0] = left[3];
+
+    flat_curve(buffer, left, depth + 1);
+    flat_curve(buffer, right, depth + 1);
+}
+
+static size_t
+simplify_run(const CpmlPair *points, size_t n_points, double tolerance,
+             int fit_arcs, unsigned char *keep, size_t *stack,
+             size_t n_dest, size_t n_data, cairo_path_data_t *dest)
+{
+    cairo_path_data_t item[3];
+    size_t first, last, next, arc_end, n;
+
+    if (n_points < 2)
+        return n_data;
+
+    last = n_points - 1;
+    first = 0;
+    arc_end = fit_arcs ? simplify_arc_end(points, 0, n_points, tolerance) : 0;
+
+    while (first < last) {
+        if (arc_end > 0) {
+            item[0].header.type = CPML_ARC;
+            item[0].header.length = 3;
+            cpml_pair_to_cairo(&points[(first + arc_end) / 2], &item[1]);
+            cpml_pair_to_cairo(&points[arc_end], &item[2]);
+            n_data = put_data(dest, n_dest, n_data, item, 3);
+
+            first = arc_end;
+            arc_end = fit_arcs && first < last ?
+                simplify_arc_end(points, first, n_points, tolerance) : 0;
+            continue;
+        }
+
+        /* Lines up to the end of the run or to the next arc */
+        for (next = first + 1; next < last && fit_arcs; ++next) {
+            arc_end = simplify_arc_end(points, next, n_points, tolerance);
+            if (arc_end > 0)
+                break;
+        }
+        if (! fit_arcs)
+            next = last;
+
+        simplify_lines(points, first, next, tolerance, keep, stack);
+        item[0].header.type = CPML_LINE;
+        item[0].header.length = 2;
+        for (n = first + 1; n <= next; ++n) {
+            if (keep[n]) {
+                cpml_pair_to_cairo(&points[n], &item[1]);
+                n_data = put_data(dest, n_dest, n_data, item, 2);
+            }
+        }
+
+        first = next;
+    }
+
+    return n_data;
+}
+
+static void
+simplify_lines(const CpmlPair *points, size_t first, size_t last,
+               double tolerance, unsigned char *keep, size_t *stack)
+{
+    size_t n_stack, from, to, n, farthest;
+    double distance, max_distance;
+
+    /* Iterative Douglas-Peucker: the intervals on the stack are always
+     * disjoint, so there cannot be more than one per point */
+    for (n = first; n <= last; ++n)
+        keep[n] = 0;
+    keep[first] = keep[last] = 1;
+
+    stack[0] = first;
+    stack[1] = last;
+    n_stack = 1;
+
+    while (n_stack > 0) {
+        --n_stack;
+        from = stack[n_stack * 2];
+        to = stack[n_stack * 2 + 1];
+        farthest = from;
+        max_distance = tolerance;
+
+        for (n = from + 1; n < to; ++n) {
+            distance = chord_distance(&points[n], &points[from], &points[to]);
+            if (distance > max_distance) {
+                max_distance = distance;
+                farthest = n;
+            }
+        }
+
+        if (farthest != from) {
+            keep[farthest] = 1;
+            stack[n_stack * 2] = from;
+            stack[n_stack * 2 + 1] = farthest;
+            stack[n_stack * 2 + 2] = farthest;
+            stack[n_stack * 2 + 3] = to;
+            n_stack += 2;
+        }
+    }
+}
+
+static size_t
+simplify_arc_end(const CpmlPair *points, size_t first, size_t n_points,
+                 double tolerance)
+{
+    size_t last, arc_end;
+
+    /* An arc must replace at least three lines to save some data */
+    arc_end = 0;
+    for (last = first + 3; last < n_points; ++last) {
+        if (! simplify_arc_fits(points, first, last, tolerance))
+            break;
+        arc_end = last;
+    }
+
+    return arc_end;
+}
+
+static int
+simplify_arc_fits(const CpmlPair *points, size_t first, size_t last,
+                  double tolerance)
+{
+    const CpmlPair *a, *b, *c;
+    CpmlPair center;
+    CpmlVector v1, v2;
+    double d, a2, b2, c2, radius, sign, step, sweep;
+    size_t n;
+
+    a = &points[first];
+    b = &points[(first + last) / 2];
+    c = &points[last];
+
+    /* Aligned points are better served by a line */
+    if (chord_distance(b, a, c) <= tolerance)
+        return 0;
+
+    d = 2 * (a->x * (b->y - c->y) + b->x * (c->y - a->y) + c->x * (a->y - b->y));
+    if (d == 0)
+        return 0;
+
+    a2 = a->x * a->x + a->y * a->y;
+    b2 = b->x * b->x + b->y * b->y;
+    c2 = c->x * c->x + c->y * c->y;
+    center.x = (a2 * (b->y - c->y) + b2 * (c->y - a->y) + c2 * (a->y - b->y)) / d;
+    center.y = (a2 * (c->x - b->x) + b2 * (a->x - c->x) + c2 * (b->x - a->x)) / d;
+    radius = cpml_pair_distance(a, &center);
+    sign = d > 0 ? 1 : -1;
+    sweep = 0;
+
+    /* Every point must be near the circle and must advance along it */
+    for (n = first + 1; n <= last; ++n) {
+        if (fabs(cpml_pair_distance(&points[n], &center) - radius) > tolerance)
+            return 0;
+
+        v1.x = points[n - 1].x - center.x;
+        v1.y = points[n - 1].y - center.y;
+        v2.x = points[n].x - center.x;
+        v2.y = points[n].y - center.y;
+        step = sign * atan2(v1.x * v2.y - v1.y * v2.x, v1.x * v2.x + v1.y * v2.y);
+        if (step < 0)
+            return 0;
+
+        sweep += step;
+        if (sweep >= M_PI * 2)
+            return 0;
+    }
+
+    return 1;
+}
+
+static size_t
+fit_run(const CpmlPair *points, size_t n_points, double tolerance,
+        double *times, FitSpan *stack,
+        size_t n_dest, size_t n_data, cairo_path_data_t *dest)
+{
+    CpmlVector v1, v2;
+    size_t first, n;
+    int has_v1;
+
+    if (n_points < 2)
+        return n_data;
+
+    /* Split the run at the corners, ignoring zero length lines */
+    first = 0;
+    has_v1 = 0;
+    for (n = 1; n < n_points - 1; ++n) {
+        if (unit_vector(&points[n - 1], &points[n], &v1))
+            has_v1 = 1;
+        if (has_v1 && unit_vector(&points[n], &points[n + 1], &v2) &&
+            v1.x * v2.x + v1.y * v2.y < FIT_CORNER_COS) {
+            n_data = fit_span(points, first, n, tolerance, times, stack,
+                              n_dest, n_data, dest);
+            first = n;
+            has_v1 = 0;
+        }
+    }
+
+    return fit_span(points, first, n_points - 1, tolerance, times, stack,
+                    n_dest, n_data, dest);
+}
+
+static size_t
+fit_span(const CpmlPair *points, size_t first, size_t last, double tolerance,
+         double *times, FitSpan *stack,
+         size_t n_dest, size_t n_data, cairo_path_data_t *dest)
+{
+    cairo_path_data_t item[4];
+    FitSpan *span, left, right;
+    CpmlPair p[4];
+    CpmlVector center;
+    size_t n_stack, n, split;
+    double length, error;
+    int iteration;
+
+    stack[0].first = first;
+    stack[0].last = last;
+    if (last - first >= 3) {
+        fit_tangent(&points[first], &points[first + 1], &points[first + 2],
+                    &stack[0].start_tangent);
+        fit_tangent(&points[last], &points[last - 1], &points[last - 2],
+                    &stack[0].end_tangent);
+    }
+    n_stack = 1;
+
+    /* The spans are popped in order: the right half of a split span is
+     * pushed before the left one. Spans are disjoint, so there cannot
+     * be more than one per point */
+    while (n_stack > 0) {
+        span = &stack[n_stack - 1];
+        first = span->first;
+        last = span->last;
+
+        /* A curve is not worth it on less than three lines */
+        if (last - first < 3) {
+            item[0].header.type = CPML_LINE;
+            item[0].header.length = 2;
+            for (n = first + 1; n <= last; ++n) {
+                cpml_pair_to_cairo(&points[n], &item[1]);
+                n_data = put_data(dest, n_dest, n_data, item, 2);
+            }
+            --n_stack;
+            continue;
+        }
+
+        /* Chord length parameterization */
+        times[first] = 0;
+        for (n = first + 1; n <= last; ++n)
+            times[n] = times[n - 1] + cpml_pair_distance(&points[n - 1], &points[n]);
+        length = times[last];
+        for (n = first + 1; n <= last; ++n)
+            times[n] = length > 0 ? times[n] / length : 1;
+
+        fit_curve(points, span, times, p);
+        error = fit_error(points, span, times, p, &split);
+        for (iteration = 0;
+             iteration < FIT_MAX_ITERATIONS && error > tolerance &&
+             error <= tolerance * 16;
+             ++iteration) {
+            fit_reparameterize(points, span, times, p);
+            fit_curve(points, span, times, p);
+            error = fit_error(points, span, times, p, &split);
+        }
+
+        if (error <= tolerance) {
+            item[0].header.type = CPML_CURVE;
+            item[0].header.length = 4;
+            cpml_pair_to_cairo(&p[1], &item[1]);
+            cpml_pair_to_cairo(&p[2], &item[2]);
+            cpml_pair_to_cairo(&p[3], &item[3]);
+            n_data = put_data(dest, n_dest, n_data, item, 4);
+            --n_stack;
+            continue;
+        }
+
+        /* Split at the worst point, keeping the tangent continuous */
+        if (! unit_vector(&points[split + 1], &points[split - 1], &center)) {
+            center.x = -span->start_tangent.x;
+            center.y = -span->start_tangent.y;
+        }
+        left = right = *span;
+        left.last = split;
+        left.end_tangent = center;
+        right.first = split;
+        right.start_tangent.x = -center.x;
+        right.start_tangent.y = -center.y;
+        stack[n_stack - 1] = right;
+        stack[n_stack] = left;
+        ++n_stack;
+    }
+
+    return n_data;
+}
+
+/* Computes in @p the curve best approximating the points of @span at
+ * @times while keeping its tangents, as explained in the Schneider's
+ * paper. When the system is degenerated, the Wu-Barsky heuristic
+ * (one third of the chord length) is used instead */
+static void
+fit_curve(const CpmlPair *points, const FitSpan *span, const double *times,
+          CpmlPair *p)
+{
+    const CpmlVector *t1, *t2;
+    double c00, c01, c11, x0, x1, det, alpha1, alpha2, chord, t, s;
+    double b0, b1, b2, b3;
+    CpmlVector a1, a2, tmp;
+    size_t n;
+
+    t1 = &span->start_tangent;
+    t2 = &span->end_tangent;
+    p[0] = points[span->first];
+    p[3] = points[span->last];
+    c00 = c01 = c11 = x0 = x1 = 0;
+
+    for (n = span->first; n <= span->last; ++n) {
+        t = times[n];
+        s = 1 - t;
+        b0 = s * s * s;
+        b1 = 3 * t * s * s;
+        b2 = 3 * t * t * s;
+        b3 = t * t * t;
+        a1.x = t1->x * b1;
+        a1.y = t1->y * b1;
+        a2.x = t2->x * b2;
+        a2.y = t2->y * b2;
+        c00 += a1.x * a1.x + a1.y * a1.y;
+        c01 += a1.x * a2.x + a1.y * a2.y;
+        c11 += a2.x * a2.x + a2.y * a2.y;
+        tmp.x = points[n].x - p[0].x * (b0 + b1) - p[3].x * (b2 + b3);
+        tmp.y = points[n].y - p[0].y * (b0 + b1) - p[3].y * (b2 + b3);
+        x0 += a1.x * tmp.x + a1.y * tmp.y;
+        x1 += a2.x * tmp.x + a2.y * tmp.y;
+    }
+
+    chord = cpml_pair_distance(&p[0], &p[3]);
+    det = c00 * c11 - c01 * c01;
+    if (det != 0) {
+        alpha1 = (x0 * c11 - x1 * c01) / det;
+        alpha2 = (c00 * x1 - c01 * x0) / det;
+    } else {
+        alpha1 = alpha2 = 0;
+    }
+
+    if (alpha1 < chord * 1e-6 || alpha2 < chord * 1e-6)
+        alpha1 = alpha2 = chord / 3;
+
+    p[1].x = p[0].x + t1->x * alpha1;
+    p[1].y = p[0].y + t1->y * alpha1;
+    p[2].x = p[3].x + t2->x * alpha2;
+    p[2].y = p[3].y + t2->y * alpha2;
+}
+
+/* Returns the maximum distance between the points of @span and the
+ * curve @p at @times, storing in @split the (inner) worst point */
+static double
+fit_error(const CpmlPair *points, const FitSpan *span, const double *times,
+          const CpmlPair *p, size_t *split)
+{
+    CpmlPair pair;
+    double distance, max_distance;
+    size_t n;
+
+    max_distance = 0;
+    *split = (span->first + span->last) / 2;
+
+    for (n = span->first + 1; n < span->last; ++n) {
+        bezier_pair(p, times[n], &pair);
+        distance = cpml_pair_distance(&pair, &points[n]);
+        if (distance > max_distance) {
+            max_distance = distance;
+            *split = n;
+        }
+    }
+
+    return max_distance;
+}
+
+/* One Newton-Raphson step towards the time of the nearest curve point */
+static void
+fit_reparameterize(const CpmlPair *points, const FitSpan *span, double *times,
+                   const CpmlPair *p)
+{
+    CpmlPair q, d1, d2;
+    double t, s, numerator, denominator;
+    size_t n;
+
+    for (n = span->first + 1; n < span->last; ++n) {
+        t = times[n];
+        s = 1 - t;
+        bezier_pair(p, t, &q);
+        d1.x = 3 * (s * s * (p[1].x - p[0].x) + 2 * s * t * (p[2].x - p[1].x) +
+                    t * t * (p[3].x - p[2].x));
+        d1.y = 3 * (s * s * (p[1].y - p[0].y) + 2 * s * t * (p[2].y - p[1].y) +
+                    t * t * (p[3].y - p[2].y));
+        d2.x = 6 * (s * (p[2].x - 2 * p[1].x + p[0].x) +
+                    t * (p[3].x - 2 * p[2].x + p[1].x));
+        d2.y = 6 * (s * (p[2].y - 2 * p[1].y + p[0].y) +
+                    t * (p[3].y - 2 * p[2].y + p[1].y));
+
+        q.x -= points[n].x;
+        q.y -= points[n].y;
+        numerator = q.x * d1.x + q.y * d1.y;
+        denominator = d1.x * d1.x + d1.y * d1.y + q.x * d2.x + q.y * d2.y;
+        if (denominator == 0)
+            continue;
+
+        t -= numerator / denominator;
+        times[n] = t < 0 ? 0 : t > 1 ? 1 : t;
+    }
+}
+
+/* Estimates the unit tangent in @p0 from the parabola passing through
+ * @p0, @p1 and @p2: the direction of the first line alone is off by
+ * half the turning angle, enough to spoil the fitting of dense data */
+static void
+fit_tangent(const CpmlPair *p0, const CpmlPair *p1, const CpmlPair *p2,
+            CpmlVector *tangent)
+{
+    CpmlPair pair;
+
+    pair.x = 4 * p1->x - 2 * p0->x - p2->x;
+    pair.y = 4 * p1->y - 2 * p0->y - p2->y;
+
+    if (! unit_vector(p0, &pair, tangent) &&
+        ! unit_vector(p0, p1, tangent) &&
+        ! unit_vector(p0, p2, tangent))
+        tangent->x = tangent->y = 0;
+}
+
+static void
+bezier_pair(const CpmlPair *p, double t, CpmlPair *pair)
+{
+    double s, b0, b1, b2, b3;
+
+    s = 1 - t;
+    b0 = s * s * s;
+    b1 = 3 * t * s * s;
+    b2 = 3 * t * t * s;
+    b3 = t * t * t;
+    pair->x = b0 * p[0].x + b1 * p[1].x + b2 * p[2].x + b3 * p[3].x;
+    pair->y = b0 * p[0].y + b1 * p[1].y + b2 * p[2].y + b3 * p[3].y;
+}
+
+/* Stores in @vector the unit vector from @from to @to: returns 0 if
+ * the two pairs are coincident */
+static int
+unit_vector(const CpmlPair *from, const CpmlPair *to, CpmlVector *vector)
+{
+    double length;
+
+    vector->x = to->x - from->x;
+    vector->y = to->y - from->y;
+    length = sqrt(vector->x * vector->x + vector->y * vector->y);
+    if (length == 0)
+        return 0;
+
+    vector->x /= length;
+    vector->y /= length;
+    return 1;
+}
+
+/* Flattens @segment in @polygon, dropping the duplicated vertices and
+ * reversing it when clockwise: returns 0 if no area is enclosed */
+static int
+bool_polygon(const CpmlSegment *segment, double tolerance,
+             BoolPolygon *polygon)
+{
+    CpmlPair *points;
+    size_t n_points, n, i;
+    double area;
+
+    n_points = cpml_segment_flatten(segment, tolerance, 0, NULL);
+    points = malloc((n_points + 1) * sizeof(CpmlPair));
+    cpml_segment_flatten(segment, tolerance, n_points, points);
+
+    i = 0;
+    for (n = 0; n < n_points; ++ n) {
+        if (i > 0 && cpml_pair_squared_distance(&points[i - 1], &points[n]) <
+            BOOLEAN_EPSILON * BOOLEAN_EPSILON)
+            continue;
+        points[i++] = points[n];
+    }
+    while (i > 1 && cpml_pair_squared_distance(&points[i - 1], &points[0]) <
+           BOOLEAN_EPSILON * BOOLEAN_EPSILON)
+        --i;
+    n_points = i;
+
+    area = 0;
+    for (n = 0; n < n_points; ++ n) {
+        i = (n + 1) % n_points;
+        area += points[n].x * points[i].y - points[i].x * points[n].y;
+    }
+
+    if (n_points < 3 || area == 0) {
+        free(points);
+        return 0;
+    }
+
+    if (area < 0) {
+        for (n = 0, i = n_points - 1; n < i; ++ n, -- i) {
+            points[n_points] = points[n];
+            points[n] = points[i];
+            points[i] = points[n_points];
+        }
+    }
+
+    polygon->points = points;
+    polygon->n_points = n_points;
+    return 1;
+}
+
+static BoolItem *
+bool_items(const BoolPolygon *polygon, int owner, size_t first,
+           BoolItem *items)
+{
+    BoolItem *item;
+    size_t n;
+
+    for (n = 0; n < polygon->n_points; ++ n) {
+        item = &items[first + n];
+        item->p1 = polygon->points[n];
+        item->p2 = polygon->points[(n + 1) % polygon->n_points];
+        item->owner = owner;
+        item->index = first + n;
+        item->x_min = item->p1.x < item->p2.x ? item->p1.x : item->p2.x;
+        item->x_max = item->p1.x < item->p2.x ? item->p2.x : item->p1.x;
+        item->y_min = item->p1.y < item->p2.y ? item->p1.y : item->p2.y;
+        item->y_max = item->p1.y < item->p2.y ? item->p2.y : item->p1.y;
+    }
+
+    return items;
+}
+
+static int
+bool_item_compare(const void *a, const void *b)
+{
+    const BoolItem *item = a;
+    const BoolItem *item2 = b;
+
+    if (item->x_min < item2->x_min)
+        return -1;
+
+    return item->x_min > item2->x_min ? 1 : 0;
+}
+
+/* Adds to @splits the points where @item and @item2 must be split:
+ * a point near an end of an edge is snapped to that end, so the pieces
+ * of both polygons meet exactly. Collinear overlapping edges are split
+ * at the ends of the other one */
+static BoolSplit *
+bool_intersect(const BoolItem *item, const BoolItem *item2,
+               BoolSplit *splits, size_t *n_splits, size_t *n_max)
+{
+    CpmlVector r, s, qp;
+    CpmlPair pair;
+    double length, length2, denominator, t, u, t_eps, u_eps;
+
+    r.x = item->p2.x - item->p1.x;
+    r.y = item->p2.y - item->p1.y;
+    s.x = item2->p2.x - item2->p1.x;
+    s.y = item2->p2.y - item2->p1.y;
+    qp.x = item2->p1.x - item->p1.x;
+    qp.y = item2->p1.y - item->p1.y;
+    length = sqrt(r.x * r.x + r.y * r.y);
+    length2 = sqrt(s.x * s.x + s.y * s.y);
+    t_eps = BOOLEAN_EPSILON / length;
+    u_eps = BOOLEAN_EPSILON / length2;
+    denominator = r.x * s.y - r.y * s.x;
+
+    if (fabs(denominator) <= BOOLEAN_EPSILON * length * length2) {
+        /* Parallel edges: only collinear ones can overlap */
+        if (fabs(qp.x * r.y - qp.y * r.x) > BOOLEAN_EPSILON * length)
+            return splits;
+
+        t = (qp.x * r.x + qp.y * r.y) / (length * length);
+        if (t > t_eps && t < 1 - t_eps)
+            splits = bool_add_split(splits, n_splits, n_max,
+                                    item->index, t, &item2->p1);
+        t = ((item2->p2.x - item->p1.x) * r.x +
+             (item2->p2.y - item->p1.y) * r.y) / (length * length);
+        if (t > t_eps && t < 1 - t_eps)
+            splits = bool_add_split(splits, n_splits, n_max,
+                                    item->index, t, &item2->p2);
+        u = -(qp.x * s.x + qp.y * s.y) / (length2 * length2);
+        if (u > u_eps && u < 1 - u_eps)
+            splits = bool_add_split(splits, n_splits, n_max,
+                                    item2->index, u, &item->p1);
+        u = ((item->p2.x - item2->p1.x) * s.x +
+             (item->p2.y - item2->p1.y) * s.y) / (length2 * length2);
+        if (u > u_eps && u < 1 - u_eps)
+            splits = bool_add_split(splits, n_splits, n_max,
+                                    item2->index, u, &item->p2);
+        return splits;
+    }
+
+    t = (qp.x * s.y - qp.y * s.x) / denominator;
+    u = (qp.x * r.y - qp.y * r.x) / denominator;
+    if (t < -t_eps || t > 1 + t_eps || u < -u_eps || u > 1 + u_eps)
+        return splits;
+
+    if (t <= t_eps) {
+        pair = item->p1;
+    } else if (t >= 1 - t_eps) {
+        pair = item->p2;
+    } else if (u <= u_eps) {
+        pair = item2->p1;
+    } else if (u >= 1 - u_eps) {
+        pair = item2->p2;
+    } else {
+        pair.x = item->p1.x + r.x * t;
+        pair.y = item->p1.y + r.y * t;
+    }
+
+    if (t > t_eps && t < 1 - t_eps)
+        splits = bool_add_split(splits, n_splits, n_max, item->index, t, &pair);
+    if (u > u_eps && u < 1 - u_eps)
+        splits = bool_add_split(splits, n_splits, n_max, item2->index, u, &pair);
+
+    return splits;
+}
+
+static BoolSplit *
+bool_add_split(BoolSplit *splits, size_t *n_splits, size_t *n_max,
+               size_t index, double t, const CpmlPair *pair)
+{
+    BoolSplit *split;
+
+    if (*n_splits >= *n_max) {
+        *n_max = *n_max > 0 ? *n_max * 2 : 16;
+        splits = realloc(splits, *n_max * sizeof(BoolSplit));
+    }
+
+    split = &splits[*n_splits];
+    split->index = index;
+    split->t = t;
+    split->pair = *pair;
+    ++ *n_splits;
+
+    return splits;
+}
+
+static int
+bool_split_compare(const void *a, const void *b)
+{
+    const BoolSplit *split = a;
+    const BoolSplit *split2 = b;
+
+    if (split->index != split2->index)
+        return split->index < split2->index ? -1 : 1;
+    if (split->t < split2->t)
+        return -1;
+
+    return split->t > split2->t ? 1 : 0;
+}
+
+/* Finds the position of the edge piece from @from to @to relative to
+ * @polygon by checking its middle point: the pieces do not cross the
+ * boundary of @polygon, so the middle point is enough. The even-odd
+ * rule is used for the inside test */
+static int
+bool_classify(const CpmlPair *from, const CpmlPair *to,
+              const BoolPolygon *polygon)
+{
+    const CpmlPair *p1, *p2;
+    CpmlPair middle;
+    size_t n;
+    int is_inside;
+
+    middle.x = (from->x + to->x) / 2;
+    middle.y = (from->y + to->y) / 2;
+    is_inside = 0;
+
+    for (n = 0; n < polygon->n_points; ++ n) {
+        p1 = &polygon->points[n];
+        p2 = &polygon->points[(n + 1) % polygon->n_points];
+
+        if (chord_distance(&middle, p1, p2) < BOOLEAN_EPSILON)
+            return (to->x - from->x) * (p2->x - p1->x) +
+                   (to->y - from->y) * (p2->y - p1->y) > 0 ?
+                   BOOL_SAME : BOOL_OPPOSITE;
+
+        if ((p1->y > middle.y) != (p2->y > middle.y) &&
+            middle.x < p1->x + (middle.y - p1->y) * (p2->x - p1->x) / (p2->y - p1->y))
+            is_inside = ! is_inside;
+    }
+
+    return is_inside ? BOOL_INSIDE : BOOL_OUTSIDE;
+}
+
+static int
+bool_edge_compare(const void *a, const void *b)
+{
+    const BoolEdge *edge = a;
+    const BoolEdge *edge2 = b;
+
+    if (edge->from.x < edge2->from.x)
+        return -1;
+
+    return edge->from.x > edge2->from.x ? 1 : 0;
+}
+
+/* Returns the first unused edge starting at @pair, looking for it
+ * with a binary search on @edges, sorted by the x of their start */
+static BoolEdge *
+bool_next_edge(BoolEdge *edges, size_t n_edges, const CpmlPair *pair)
+{
+    size_t low, high, middle;
+
+    low = 0;
+    high = n_edges;
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (edges[middle].from.x < pair->x - BOOLEAN_EPSILON)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    for (; low < n_edges && edges[low].from.x <= pair->x + BOOLEAN_EPSILON; ++ low)
+        if (! edges[low].used &&
+            cpml_pair_squared_distance(&edges[low].from, pair) <
+            BOOLEAN_EPSILON * BOOLEAN_EPSILON)
+            return &edges[low];
+
+    return NULL;
+}
+
+/* Stores the closed polyline @loop, merging collinear edges */
+static size_t
+bool_put_loop(CpmlPair *loop, size_t n_loop,
+              size_t n_dest, size_t n_data, cairo_path_data_t *dest)
+{
+    cairo_path_data_t item[2];
+    size_t n, i, first;
+
+    i = 0;
+    for (n = 0; n < n_loop; ++ n) {
+        while (i >= 2 && bool_is_collinear(&loop[i - 2], &loop[i - 1], &loop[n]))
+            -- i;
+        loop[i++] = loop[n];
+    }
+
+    /* Check the vertices around the implicit closing edge too */
+    first = 0;
+    while (i - first >= 3 &&
+           bool_is_collinear(&loop[i - 2], &loop[i - 1], &loop[first]))
+        -- i;
+    while (i - first >= 3 &&
+           bool_is_collinear(&loop[i - 1], &loop[first], &loop[first + 1]))
+        ++ first;
+
+    if (i - first < 3)
+        return n_data;
+
+    item[0].header.type = CPML_MOVE;
+    item[0].header.length = 2;
+    cpml_pair_to_cairo(&loop[first], &item[1]);
+    n_data = put_data(dest, n_dest, n_data, item, 2);
+
+    item[0].header.type = CPML_LINE;
+    for (n = first + 1; n < i; ++ n) {
+        cpml_pair_to_cairo(&loop[n], &item[1]);
+        n_data = put_data(dest, n_dest, n_data, item, 2);
+    }
+
+    item[0].header.type = CPML_CLOSE;
+    item[0].header.length = 1;
+    return put_data(dest, n_dest, n_data, item, 1);
+}
+
+static int
+bool_is_collinear(const CpmlPair *p1, const CpmlPair *p2, const CpmlPair *p3)
+{
+    CpmlVector v1, v2;
+
+    v1.x = p2->x - p1->x;
+    v1.y = p2->y - p1->y;
+    v2.x = p3->x - p2->x;
+    v2.y = p3->y - p2->y;
+
+    return v1.x * v2.x + v1.y * v2.y > 0 &&
+           fabs(v1.x * v2.y - v1.y * v2.x) <=
+           BOOLEAN_EPSILON * cpml_pair_distance(p1, p3);
+}
+
+static double
+chord_distance(const CpmlPair *pair, const CpmlPair *from, const CpmlPair *to)
+{
+    CpmlVector chord;
+    double length2, pos;
+    CpmlPair foot;
+
+    chord.x = to->x - from->x;
+    chord.y = to->y - from->y;
+    length2 = chord.x * chord.x + chord.y * chord.y;
+    if (length2 == 0)
+        return cpml_pair_distance(pair, from);
+
+    /* Distance from the segment, not from the infinite line */
+    pos = ((pair->x - from->x) * chord.x + (pair->y - from->y) * chord.y) / length2;
+    if (pos < 0)
+        pos = 0;
+    else if (pos > 1)
+        pos = 1;
+
+    foot.x = from->x + chord.x * pos;
+    foot.y = from->y + chord.y * pos;
+    return cpml_pair_distance(pair, &foot);
+}
+
+static size_t
+put_data(cairo_path_data_t *dest, size_t n_dest, size_t n_data,
+         const cairo_path_data_t *data, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i, ++n_data)
+        if (dest != NULL && n_data < n_dest)
+            dest[n_data] = data[i];
+
+    return n_data;
+}
@@ -29,7 +29,17 @@
 
 CAIRO_BEGIN_DECLS
 
+struct _CpmlPrimitive;
+struct _CpmlOffsetContext;
+
+typedef enum {
+    CPML_BOOLEAN_UNION,
+    CPML_BOOLEAN_INTERSECTION,
+    CPML_BOOLEAN_DIFFERENCE
+} CpmlBooleanOperation;
+
 typedef struct _CpmlSegment CpmlSegment;
+typedef struct _CpmlSegmentLengthTable CpmlSegmentLengthTable;
 
 struct _CpmlSegment {
     /*< public >*/
@@ -56,12 +66,54 @@ void    cpml_segment_put_pair_at        (const CpmlSegment      *segment,
 void    cpml_segment_put_vector_at      (const CpmlSegment      *segment,
                                          double                  pos,
                                          CpmlVector             *vector);
+double  cpml_segment_get_closest_pos    (const CpmlSegment      *segment,
+                                         const CpmlPair         *pair,
+                                         struct _CpmlPrimitive  *primitive);
 size_t  cpml_segment_put_intersections  (const CpmlSegment      *segment,
                                          const CpmlSegment      *segment2,
                                          size_t                  n_dest,
                                          CpmlPair               *dest);
+size_t  cpml_segment_put_self_intersections
+                                        (const CpmlSegment      *segment,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
+size_t  cpml_segment_put_scanline_spans (const CpmlSegment      *segment,
+                                         double                  angle,
+                                         double                  spacing,
+                                         double                  offset,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
 void    cpml_segment_offset             (CpmlSegment            *segment,
                                          double                  offset);
+void    cpml_segment_offset_full        (CpmlSegment            *segment,
+                                         double                  offset,
+                                         const struct _CpmlOffsetContext *context);
+size_t  cpml_segment_put_offset         (const CpmlSegment      *segment,
+                                         double                  offset,
+                                         const struct _CpmlOffsetContext *context,
+                                         cairo_line_join_t       join,
+                                         int                     trim,
+                                         size_t                  n_dest,
+                                         cairo_path_data_t      *dest);
+size_t  cpml_segment_flatten            (const CpmlSegment      *segment,
+                                         double                  tolerance,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
+size_t  cpml_segment_put_simplified     (const CpmlSegment      *segment,
+                                         double                  tolerance,
+                                         int                     fit_arcs,
+                                         size_t                  n_dest,
+                                         cairo_path_data_t      *dest);
+size_t  cpml_segment_put_boolean        (const CpmlSegment      *segment,
+                                         const CpmlSegment      *segment2,
+                                         CpmlBooleanOperation    operation,
+                                         double                  tolerance,
+                                         size_t                  n_dest,
+                                         cairo_path_data_t      *dest);
+size_t  cpml_segment_put_fitted         (const CpmlSegment      *segment,
+                                         double                  tolerance,
+                                         size_t                  n_dest,
+                                         cairo_path_data_t      *dest);
 void    cpml_segment_transform          (CpmlSegment            *segment,
                                          const cairo_matrix_t   *matrix);
 void    cpml_segment_reverse            (CpmlSegment            *segment);
@@ -69,6 +121,25 @@ void    cpml_segment_to_cairo           (const CpmlSegment      *segment,
                                          cairo_t                *cr);
 void    cpml_segment_dump               (const CpmlSegment      *segment);
 
+CpmlSegmentLengthTable *
+        cpml_segment_length_table_new   (const CpmlSegment      *segment,
+                                         size_t                  n_samples);
+void    cpml_segment_length_table_destroy
+                                        (CpmlSegmentLengthTable *table);
+double  cpml_segment_length_table_get_length
+                                        (const CpmlSegmentLengthTable
+                                                                *table);
+void    cpml_segment_length_table_put_pair_at_length
+                                        (const CpmlSegmentLengthTable
+                                                                *table,
+                                         double                  length,
+                                         CpmlPair               *pair);
+void    cpml_segment_length_table_put_vector_at_length
+                                        (const CpmlSegmentLengthTable
+                                                                *table,
+                                         double                  length,
+                                         CpmlVector             *vector);
+
 CAIRO_END_DECLS
 
 
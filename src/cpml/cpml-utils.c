@@ -26,6 +26,23 @@
  *
  * Collection of macros and functions that do not fit inside any other topic.
  *
+ * The trigonometric helpers take a #CpmlTrigMode argument, so the
+ * caller can decide on every call whether the exact results of the C
+ * math library are needed (e.g. when exporting a drawing) or an
+ * approximation is good enough (e.g. for an on-screen preview).
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * CpmlTrigMode:
+ * @CPML_TRIG_EXACT: use the C math library
+ * @CPML_TRIG_FAST:  use polynomial approximations: the absolute error
+ *                   is below 1e-8 for cpml_atan2() and below 1e-12 for
+ *                   cpml_sincos()
+ *
+ * The way trigonometric functions are computed.
+ *
  * Since: 1.0
  **/
 
@@ -34,6 +51,24 @@
 #include <math.h>
 
 
+/* Taylor coefficients of atan(z) / z - 1, in powers of z^2 */
+static const double atan_coeffs[] = {
+    -1. / 17, 1. / 15, -1. / 13, 1. / 11, -1. / 9, 1. / 7, -1. / 5, 1. / 3
+};
+
+/* M_PI_2 split in two parts (Cody-Waite), to reduce the angle
+ * without losing precision on the first turns */
+#define PI_2_HI         1.57079632673412561417e+00
+#define PI_2_LO         6.07710050650619224932e-11
+
+
+static double   fast_atan2              (double         y,
+                                         double         x);
+static void     fast_sincos             (double         angle,
+                                         double        *sine,
+                                         double        *cosine);
+
+
 /**
  * cpml_angle:
  * @angle: an angle in radians
@@ -57,3 +92,168 @@ cpml_angle(double angle)
 
     return angle;
 }
+
+/**
+ * cpml_atan2:
+ * @y:    the y component of a vector
+ * @x:    the x component of a vector
+ * @mode: how the result must be computed
+ *
+ * Computes the arc tangent of @y / @x, using the signs of both
+ * arguments to determine the quadrant, as atan2() does. If @mode is
+ * #CPML_TRIG_FAST, an approximation is returned. In that case the
+ * result of the (0, 0) vector is 0 and the negative x axis always
+ * gives <constant>M_PI</constant>, as cpml_vector_angle() does.
+ *
+ * Returns: the angle in radians, a value between -M_PI and M_PI
+ *
+ * Since: 1.0
+ **/
+double
+cpml_atan2(double y, double x, CpmlTrigMode mode)
+{
+    if (mode == CPML_TRIG_FAST)
+        return fast_atan2(y, x);
+
+    return atan2(y, x);
+}
+
+/**
+ * cpml_sincos:
+ * @angle:  an angle in radians
+ * @sine:   (out): where to store the sine of @angle
+ * @cosine: (out): where to store the cosine of @angle
+ * @mode:   how the result must be computed
+ *
+ * Computes the sine and the cosine of @angle in a single call.
+ * If @mode is #CPML_TRIG_FAST, they are approximated by the same
+ * range reduction, so the overhead is shared.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_sincos(double angle, double *sine, double *cosine, CpmlTrigMode mode)
+{
+    if (mode == CPML_TRIG_FAST) {
+        fast_sincos(angle, sine, cosine);
+    } else {
+        *sine = sin(angle);
+        *cosine = cos(angle);
+    }
+}
+
+/**
+ * cpml_sincos_n:
+ * @angles:   (array length=n_angles): the angles in radians
+ * @n_angles: number of items in @angles
+ * @sines:    (out caller-allocates) (array length=n_angles): destination of the sines
+ * @cosines:  (out caller-allocates) (array length=n_angles): destination of the cosines
+ * @mode:     how the results must be computed
+ *
+ * Calls cpml_sincos() on every item of @angles. This is the entry
+ * point to use when many angles must be converted at once, e.g. to
+ * put points along an arc.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_sincos_n(const double *angles, size_t n_angles,
+              double *sines, double *cosines, CpmlTrigMode mode)
+{
+    size_t n;
+
+    if (mode == CPML_TRIG_FAST) {
+        for (n = 0; n < n_angles; ++n)
+            fast_sincos(angles[n], &sines[n], &cosines[n]);
+    } else {
+        for (n = 0; n < n_angles; ++n) {
+            sines[n] = sin(angles[n]);
+            cosines[n] = cos(angles[n]);
+        }
+    }
+}
+
+
+/* The argument is reduced to [0, 1] by swapping the components
+ * and then to [-tan(M_PI/8), tan(M_PI/8)] by the identity
+ * atan(a) = M_PI_4 + atan((a - 1) / (a + 1)): on this range
+ * the truncated Taylor series is accurate to about 2e-9 */
+static double
+fast_atan2(double y, double x)
+{
+    double ax, ay, a, z, z2, p, angle;
+    size_t n;
+
+    ax = fabs(x);
+    ay = fabs(y);
+    if (ax == 0 && ay == 0)
+        return 0;
+
+    a = ay > ax ? ax / ay : ay / ax;
+    if (a > M_SQRT2 - 1) {
+        z = (a - 1) / (a + 1);
+        angle = M_PI_4;
+    } else {
+        z = a;
+        angle = 0;
+    }
+
+    z2 = z * z;
+    p = atan_coeffs[0];
+    for (n = 1; n < sizeof(atan_coeffs) / sizeof(atan_coeffs[0]); ++n)
+        p = p * z2 + atan_coeffs[n];
+    angle += z - z * z2 * p;
+
+    if (ay > ax)
+        angle = M_PI_2 - angle;
+    if (x < 0)
+        angle = M_PI - angle;
+
+    return y < 0 ? -angle : angle;
+}
+
+/* The angle is reduced to [-M_PI_4, M_PI_4] and the quadrant is
+ * restored by swapping and negating the results. k * PI_2_HI is
+ * exact up to 1e6 radians: above that (and for NaN or infinity)
+ * the C math library is used instead */
+static void
+fast_sincos(double angle, double *sine, double *cosine)
+{
+    double k, r, r2, s, c;
+    long q;
+
+    if (! (fabs(angle) < 1e6)) {
+        *sine = sin(angle);
+        *cosine = cos(angle);
+        return;
+    }
+
+    q = (long) (angle * M_2_PI + (angle < 0 ? -0.5 : 0.5));
+    k = q;
+    r = (angle - k * PI_2_HI) - k * PI_2_LO;
+    r2 = r * r;
+
+    s = r + r * r2 * (-1. / 6 + r2 * (1. / 120 + r2 * (-1. / 5040 +
+        r2 * (1. / 362880 + r2 * (-1. / 39916800 + r2 / 6227020800.)))));
+    c = 1 + r2 * (-1. / 2 + r2 * (1. / 24 + r2 * (-1. / 720 +
+        r2 * (1. / 40320 + r2 * (-1. / 3628800 + r2 / 479001600.)))));
+
+    switch (q & 3) {
+    case 0:
+        *sine = s;
+        *cosine = c;
+        break;
+    case 1:
+        *sine = c;
+        *cosine = -s;
+        break;
+    case 2:
+        *sine = -s;
+        *cosine = -c;
+        break;
+    default:
+        *sine = -c;
+        *cosine = s;
+        break;
+    }
+}
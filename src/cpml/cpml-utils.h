@@ -31,9 +31,27 @@
 #include <cairo.h>
 
 
+typedef enum {
+    CPML_TRIG_EXACT,
+    CPML_TRIG_FAST
+} CpmlTrigMode;
+
+
 CAIRO_BEGIN_DECLS
 
 double          cpml_angle              (double         angle);
+double          cpml_atan2              (double         y,
+                                         double         x,
+                                         CpmlTrigMode   mode);
+void            cpml_sincos             (double         angle,
+                                         double        *sine,
+                                         double        *cosine,
+                                         CpmlTrigMode   mode);
+void            cpml_sincos_n           (const double  *angles,
+                                         size_t         n_angles,
+                                         double        *sines,
+                                         double        *cosines,
+                                         CpmlTrigMode   mode);
 
 CAIRO_END_DECLS
 
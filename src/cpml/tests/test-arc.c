@@ -21,6 +21,7 @@
 #include <adg-test.h>
 #include <cpml.h>
 #include <math.h>
+#include <string.h>
 
 
 static cairo_path_data_t arc_data[] = {
@@ -158,6 +159,55 @@ _cpml_method_to_curves(void)
 
 
 
+static void
+_cpml_method_info_cached(void)
+{
+    cairo_path_data_t data[4];
+    CpmlPrimitive moved = { NULL, &data[0], &data[1] };
+    cairo_path_data_t curves[4*2];
+    CpmlSegment segment = { NULL, curves, 0 };
+    CpmlArcCache cache;
+    CpmlPair center;
+    double r, start, end;
+
+    cpml_arc_cache_invalidate(&cache);
+    g_assert_true(cpml_arc_info_cached(&arc, &cache, NULL, NULL, NULL, NULL));
+    g_assert_true(cpml_arc_info_cached(&arc, &cache, &center, &r, &start, &end));
+    adg_assert_isapprox(center.x, 0);
+    adg_assert_isapprox(center.y, 0);
+    adg_assert_isapprox(r, 3);
+    adg_assert_isapprox(start, M_PI_2);
+    adg_assert_isapprox(end, -M_PI_2);
+
+    /* A different arc must miss the cache */
+    memcpy(data, arc_data + 1, sizeof(data));
+    data[2].point.x = 6;
+    data[2].point.y = 3;
+    data[3].point.x = 3;
+    data[3].point.y = 6;
+    g_assert_true(cpml_arc_info_cached(&moved, &cache, &center, &r, NULL, NULL));
+    adg_assert_isapprox(center.x, 3);
+    adg_assert_isapprox(center.y, 3);
+    adg_assert_isapprox(r, 3);
+
+    /* Aligned points do not define an arc, and the failure is cached */
+    data[2].point.x = 1;
+    data[2].point.y = 3;
+    data[3].point.x = 2;
+    data[3].point.y = 3;
+    g_assert_false(cpml_arc_info_cached(&moved, &cache, NULL, NULL, NULL, NULL));
+    g_assert_false(cpml_arc_info_cached(&moved, &cache, NULL, NULL, NULL, NULL));
+
+    /* The result must match the uncached API */
+    cpml_arc_to_curves_cached(&arc, &cache, &segment, 1);
+    g_assert_cmpint(curves[0].header.type, ==, CPML_CURVE);
+    adg_assert_isapprox(curves[1].point.x, 4);
+    adg_assert_isapprox(curves[1].point.y, 3);
+    adg_assert_isapprox(curves[3].point.x, 0);
+    adg_assert_isapprox(curves[3].point.y, -3);
+}
+
+
 int
 main(int argc, char *argv[])
 {
@@ -168,6 +218,7 @@ main(int argc, char *argv[])
     adg_test_add_traps("/cpml/arc/sanity/to-curves", _cpml_sanity_to_curves, 2);
 
     g_test_add_func("/cpml/arc/method/info", _cpml_method_info);
+    g_test_add_func("/cpml/arc/method/info-cached", _cpml_method_info_cached);
     g_test_add_func("/cpml/arc/method/to-curves", _cpml_method_to_curves);
 
     return g_test_run();
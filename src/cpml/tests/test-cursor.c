@@ -0,0 +1,170 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#include <adg-test.h>
+#include <cpml.h>
+
+
+static cairo_path_data_t path_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 3, 0 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 3, 4 }},
+    { .header = { CPML_CLOSE, 1 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 5, 5 }},
+
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 10, 10 }},
+    { .header = { CPML_ARC, 3 }},
+    { .point = { 11.70710678, 10.70710678 }},
+    { .point = { 12, 10 }}
+};
+
+static cairo_path_t path = {
+    CAIRO_STATUS_SUCCESS,
+    path_data,
+    G_N_ELEMENTS(path_data)
+};
+
+
+static void
+_cpml_method_from_cairo(void)
+{
+    CpmlCursor cursor;
+    cairo_path_t empty_path = { CAIRO_STATUS_SUCCESS, path_data, 0 };
+    cairo_path_t invalid_path = { CAIRO_STATUS_INVALID_PATH_DATA, path_data, 2 };
+
+    g_assert_cmpint(cpml_cursor_from_cairo(&cursor, &empty_path), ==, 0);
+    g_assert_cmpint(cpml_cursor_from_cairo(&cursor, &invalid_path), ==, 0);
+
+    g_assert_cmpint(cpml_cursor_from_cairo(&cursor, &path), ==, 1);
+    g_assert_true(cpml_cursor_get_data(&cursor) == path_data);
+    g_assert_null(cpml_cursor_get_org(&cursor));
+    g_assert_null(cpml_cursor_get_prev(&cursor));
+    g_assert_cmpint(cpml_cursor_get_offset(&cursor), ==, 0);
+}
+
+static void
+_cpml_method_next(void)
+{
+    CpmlCursor cursor;
+    cairo_path_data_t truncated_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 3 }},
+        { .point = { 1, 1 }}
+    };
+    cairo_path_t truncated_path = {
+        CAIRO_STATUS_SUCCESS,
+        truncated_data,
+        G_N_ELEMENTS(truncated_data)
+    };
+    int n;
+
+    cpml_cursor_from_cairo(&cursor, &path);
+
+    g_assert_cmpint(cpml_cursor_next(&cursor), ==, 1);
+    g_assert_true(cpml_cursor_get_data(&cursor) == path_data + 2);
+    g_assert_true(cpml_cursor_get_org(&cursor) == path_data + 1);
+    g_assert_true(cpml_cursor_get_prev(&cursor) == path_data);
+
+    /* The origin after a CPML_CLOSE is the start of the segment */
+    g_assert_cmpint(cpml_cursor_next(&cursor), ==, 1);
+    g_assert_cmpint(cpml_cursor_next(&cursor), ==, 1);
+    g_assert_cmpint(cpml_cursor_get_data(&cursor)->header.type, ==, CPML_CLOSE);
+    g_assert_true(cpml_cursor_get_org(&cursor) == path_data + 5);
+    g_assert_cmpint(cpml_cursor_next(&cursor), ==, 1);
+    g_assert_cmpint(cpml_cursor_get_offset(&cursor), ==, 7);
+    g_assert_true(cpml_cursor_get_org(&cursor) == path_data + 1);
+
+    /* Browse up to the end: the cursor must be left on the last primitive */
+    n = 0;
+    while (cpml_cursor_next(&cursor))
+        ++ n;
+    g_assert_cmpint(n, ==, 2);
+    g_assert_true(cpml_cursor_get_data(&cursor) == path_data + 11);
+    g_assert_true(cpml_cursor_get_org(&cursor) == path_data + 10);
+    g_assert_cmpint(cpml_cursor_next(&cursor), ==, 0);
+    g_assert_true(cpml_cursor_get_data(&cursor) == path_data + 11);
+
+    /* A primitive exceeding the path data is not valid */
+    cpml_cursor_from_cairo(&cursor, &truncated_path);
+    g_assert_cmpint(cpml_cursor_next(&cursor), ==, 0);
+    g_assert_cmpint(cpml_cursor_get_offset(&cursor), ==, 0);
+}
+
+static void
+_cpml_method_prev(void)
+{
+    CpmlCursor cursor;
+
+    cpml_cursor_from_cairo(&cursor, &path);
+    g_assert_cmpint(cpml_cursor_prev(&cursor), ==, 0);
+
+    while (cpml_cursor_next(&cursor))
+        ;
+
+    g_assert_cmpint(cpml_cursor_prev(&cursor), ==, 1);
+    g_assert_cmpint(cpml_cursor_get_offset(&cursor), ==, 9);
+    g_assert_true(cpml_cursor_get_org(&cursor) == path_data + 8);
+    g_assert_true(cpml_cursor_get_prev(&cursor) == path_data + 7);
+
+    g_assert_cmpint(cpml_cursor_prev(&cursor), ==, 1);
+    g_assert_cmpint(cpml_cursor_prev(&cursor), ==, 1);
+    g_assert_cmpint(cpml_cursor_get_offset(&cursor), ==, 6);
+    g_assert_true(cpml_cursor_get_org(&cursor) == path_data + 5);
+
+    cpml_cursor_reset(&cursor);
+    g_assert_cmpint(cpml_cursor_get_offset(&cursor), ==, 0);
+    g_assert_null(cpml_cursor_get_prev(&cursor));
+}
+
+static void
+_cpml_method_peek(void)
+{
+    CpmlCursor cursor;
+
+    cpml_cursor_from_cairo(&cursor, &path);
+    g_assert_true(cpml_cursor_peek(&cursor) == path_data + 2);
+    g_assert_cmpint(cpml_cursor_get_offset(&cursor), ==, 0);
+
+    while (cpml_cursor_next(&cursor))
+        ;
+
+    g_assert_null(cpml_cursor_peek(&cursor));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/cpml/cursor/method/from-cairo", _cpml_method_from_cairo);
+    g_test_add_func("/cpml/cursor/method/next", _cpml_method_next);
+    g_test_add_func("/cpml/cursor/method/prev", _cpml_method_prev);
+    g_test_add_func("/cpml/cursor/method/peek", _cpml_method_peek);
+
+    return g_test_run();
+}
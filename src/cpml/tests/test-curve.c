@@ -186,6 +186,129 @@ _cpml_method_offset_at_time(void)
     g_assert_cmpint((pair.y + 0.00005) * 10000, ==, 40000);
 }
 
+static void
+_cpml_method_offset_to_curves(void)
+{
+    cairo_path_data_t data[16 * 4];
+    CpmlSegment segment = { NULL, data, 0 };
+    CpmlOffsetContext context = { CPML_CURVE_OFFSET_ALGORITHM_NONE, 1e6 };
+    size_t n_curves;
+
+    n_curves = cpml_curve_offset_to_curves(&curve, 1, &context, &segment, 0);
+    g_assert_cmpuint(n_curves, ==, 0);
+    g_assert_cmpint(segment.num_data, ==, 0);
+
+    /* A huge tolerance must not split the curve */
+    n_curves = cpml_curve_offset_to_curves(&curve, 1, &context, &segment, 16);
+    g_assert_cmpuint(n_curves, ==, 1);
+    g_assert_cmpint(segment.num_data, ==, 4);
+    g_assert_cmpint(data[0].header.type, ==, CPML_CURVE);
+    adg_assert_isapprox(data[3].point.x, 2);
+    adg_assert_isapprox(data[3].point.y, 5);
+
+    /* A null tolerance must split the curve up to max_curves */
+    n_curves = cpml_curve_offset_to_curves(&curve, 1, NULL, &segment, 4);
+    g_assert_cmpuint(n_curves, ==, 4);
+    g_assert_cmpint(segment.num_data, ==, 16);
+    g_assert_cmpint(data[12].header.type, ==, CPML_CURVE);
+    adg_assert_isapprox(data[15].point.x, 2);
+    adg_assert_isapprox(data[15].point.y, 5);
+
+    context.algorithm = CPML_CURVE_OFFSET_ALGORITHM_HANDCRAFT;
+    context.tolerance = 1e-3;
+    n_curves = cpml_curve_offset_to_curves(&curve, 1, &context, &segment, 16);
+    g_assert_cmpuint(n_curves, >=, 1);
+    g_assert_cmpuint(n_curves, <=, 16);
+    adg_assert_isapprox(data[n_curves * 4 - 1].point.x, 2);
+    adg_assert_isapprox(data[n_curves * 4 - 1].point.y, 5);
+
+    /* The original curve must be left untouched */
+    adg_assert_isapprox(curve_data[5].point.x, 3);
+    adg_assert_isapprox(curve_data[5].point.y, 5);
+}
+
+static void
+_cpml_method_put_intersections(void)
+{
+    cairo_path_data_t data[] = {
+        /* S shaped curve crossing the x axis at 0, 1.5 and 3 */
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_CURVE, 4 }},
+        { .point = { 1, 2 }},
+        { .point = { 2, -2 }},
+        { .point = { 3, 0 }},
+
+        /* Its mirror on the x axis */
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_CURVE, 4 }},
+        { .point = { 1, -2 }},
+        { .point = { 2, 2 }},
+        { .point = { 3, 0 }},
+
+        /* The x axis */
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { -1, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 1, 0 }},
+
+        /* A circle of radius 1 centered in (2, 3) */
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 1, 3 }},
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 2, 4 }},
+        { .point = { 3, 3 }}
+    };
+    CpmlPrimitive curve1 = { NULL, &data[1], &data[2] };
+    CpmlPrimitive curve2 = { NULL, &data[7], &data[8] };
+    CpmlPrimitive line = { NULL, &data[13], &data[14] };
+    CpmlPrimitive arc = { NULL, &data[17], &data[18] };
+    CpmlPair pair[4], center = { 2, 3 };
+    size_t n;
+
+    n = cpml_curve_put_intersections(&curve1, &line, 1e-6, 0, pair);
+    g_assert_cmpuint(n, ==, 0);
+    n = cpml_curve_put_intersections(&curve1, &line, 1e-6, 1, pair);
+    g_assert_cmpuint(n, ==, 1);
+
+    /* Lines are infinite, so all the crossings must be found */
+    n = cpml_curve_put_intersections(&curve1, &line, 1e-6, 4, pair);
+    g_assert_cmpuint(n, ==, 3);
+    adg_assert_isapprox(pair[0].x, 0);
+    adg_assert_isapprox(pair[0].y, 0);
+    adg_assert_isapprox(pair[1].x, 1.5);
+    adg_assert_isapprox(pair[1].y, 0);
+    adg_assert_isapprox(pair[2].x, 3);
+    adg_assert_isapprox(pair[2].y, 0);
+
+    /* Same results with the generic API, whatever the order */
+    n = cpml_primitive_put_intersections(&line, &curve1, 4, pair);
+    g_assert_cmpuint(n, ==, 3);
+    adg_assert_isapprox(pair[1].x, 1.5);
+
+    n = cpml_primitive_put_intersections(&curve1, &curve2, 4, pair);
+    g_assert_cmpuint(n, ==, 3);
+    adg_assert_isapprox(pair[0].x, 0);
+    adg_assert_isapprox(pair[0].y, 0);
+    adg_assert_isapprox(pair[1].x, 1.5);
+    adg_assert_isapprox(pair[1].y, 0);
+    adg_assert_isapprox(pair[2].x, 3);
+    adg_assert_isapprox(pair[2].y, 0);
+
+    /* The curve passes through the center of the circle */
+    n = cpml_primitive_put_intersections(&arc, &curve, 4, pair);
+    g_assert_cmpuint(n, ==, 2);
+    adg_assert_isapprox(cpml_pair_distance(&pair[0], &center), 1);
+    adg_assert_isapprox(cpml_pair_distance(&pair[1], &center), 1);
+    adg_assert_isapprox(pair[0].x + pair[1].x, 4);
+    adg_assert_isapprox(pair[0].y + pair[1].y, 6);
+
+    /* Curves far away from each other */
+    n = cpml_primitive_put_intersections(&curve, &curve2, 4, pair);
+    g_assert_cmpuint(n, ==, 0);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -200,6 +323,8 @@ main(int argc, char *argv[])
     g_test_add_func("/cpml/curve/method/pair-at-time", _cpml_method_pair_at_time);
     g_test_add_func("/cpml/curve/method/vector-at-time", _cpml_method_vector_at_time);
     g_test_add_func("/cpml/curve/method/offset-at-time", _cpml_method_offset_at_time);
+    g_test_add_func("/cpml/curve/method/offset-to-curves", _cpml_method_offset_to_curves);
+    g_test_add_func("/cpml/curve/method/put-intersections", _cpml_method_put_intersections);
 
     return g_test_run();
 }
@@ -112,6 +112,48 @@ _cpml_method_add(void)
     g_assert_true(is_inside);
 }
 
+static void
+_cpml_method_overlap(void)
+{
+    CpmlExtents extents, extents2;
+    CpmlPair pair;
+
+    extents.is_defined = 0;
+    extents2.is_defined = 0;
+
+    /* Undefined extents never overlap */
+    g_assert_false(cpml_extents_overlap(&extents, &extents2));
+
+    pair.x = 0;
+    pair.y = 0;
+    cpml_extents_pair_add(&extents, &pair);
+    pair.x = 2;
+    pair.y = 2;
+    cpml_extents_pair_add(&extents, &pair);
+    g_assert_false(cpml_extents_overlap(&extents, &extents2));
+    g_assert_false(cpml_extents_overlap(&extents2, &extents));
+
+    /* Borders are considered inside */
+    cpml_extents_pair_add(&extents2, &pair);
+    pair.x = 4;
+    pair.y = 3;
+    cpml_extents_pair_add(&extents2, &pair);
+    g_assert_true(cpml_extents_overlap(&extents, &extents2));
+    g_assert_true(cpml_extents_overlap(&extents2, &extents));
+
+    /* Disjoint extents */
+    extents2.org.x = 3;
+    g_assert_false(cpml_extents_overlap(&extents, &extents2));
+    g_assert_false(cpml_extents_overlap(&extents2, &extents));
+    extents2.org.x = 1;
+    extents2.org.y = -5;
+    g_assert_false(cpml_extents_overlap(&extents, &extents2));
+    g_assert_false(cpml_extents_overlap(&extents2, &extents));
+
+    /* Contained extents */
+    g_assert_true(cpml_extents_overlap(&extents, &extents));
+}
+
 static void
 _cpml_method_transform(void)
 {
@@ -143,6 +185,73 @@ _cpml_method_transform(void)
 }
 
 
+static void
+_cpml_method_transform_array(void)
+{
+    CpmlExtents extents[3], expected;
+    cairo_matrix_t matrix;
+
+    extents[0].is_defined = 1;
+    extents[0].org.x = 2;
+    extents[0].org.y = 3;
+    extents[0].size.x = 4;
+    extents[0].size.y = 5;
+    extents[1].is_defined = 0;
+    cpml_extents_copy(&extents[2], &extents[0]);
+    cpml_extents_copy(&expected, &extents[0]);
+
+    cairo_matrix_init(&matrix, 0.6, -0.8, 0.8, 0.6, 10, 20);
+    cpml_extents_transform(&expected, &matrix);
+    cpml_extents_transform_array(extents, 3, &matrix);
+
+    /* The result must match the one of cpml_extents_transform() */
+    g_assert_true(extents[0].is_defined);
+    adg_assert_isapprox(extents[0].org.x, expected.org.x);
+    adg_assert_isapprox(extents[0].org.y, expected.org.y);
+    adg_assert_isapprox(extents[0].size.x, expected.size.x);
+    adg_assert_isapprox(extents[0].size.y, expected.size.y);
+    g_assert_false(extents[1].is_defined);
+    g_assert_true(cpml_extents_equal(&extents[0], &extents[2]));
+
+    /* No extents at all is a valid input */
+    cpml_extents_transform_array(NULL, 0, &matrix);
+}
+
+static void
+_cpml_method_transform_chained(void)
+{
+    CpmlExtents extents, twice;
+    cairo_matrix_t rotate, unrotate;
+
+    extents.is_defined = 1;
+    extents.org.x = 2;
+    extents.org.y = 3;
+    extents.size.x = 4;
+    extents.size.y = 5;
+    cpml_extents_copy(&twice, &extents);
+
+    cairo_matrix_init_rotate(&rotate, G_PI_4);
+    cairo_matrix_init_rotate(&unrotate, -G_PI_4);
+
+    /* Two passes enlarge the extents, a chained transform does not */
+    cpml_extents_transform(&twice, &rotate);
+    cpml_extents_transform(&twice, &unrotate);
+    g_assert_cmpfloat(twice.size.x, >, 4.5);
+
+    cpml_extents_transform_chained(&extents, &rotate, &unrotate);
+    g_assert_true(extents.is_defined);
+    adg_assert_isapprox(extents.org.x, 2);
+    adg_assert_isapprox(extents.org.y, 3);
+    adg_assert_isapprox(extents.size.x, 4);
+    adg_assert_isapprox(extents.size.y, 5);
+
+    /* Undefined extents must be left untouched */
+    extents.is_defined = 0;
+    cpml_extents_transform_chained(&extents, &rotate, &unrotate);
+    g_assert_false(extents.is_defined);
+}
+
+
 int
 main(int argc, char *argv[])
 {
@@ -151,7 +260,10 @@ main(int argc, char *argv[])
     g_test_add_func("/cpml/extents/behavior/misc", _cmpl_behavior_misc);
 
     g_test_add_func("/cpml/extents/method/add", _cpml_method_add);
+    g_test_add_func("/cpml/extents/method/overlap", _cpml_method_overlap);
     g_test_add_func("/cpml/extents/method/transform", _cpml_method_transform);
+    g_test_add_func("/cpml/extents/method/transform-array", _cpml_method_transform_array);
+    g_test_add_func("/cpml/extents/method/transform-chained", _cpml_method_transform_chained);
 
     return g_test_run();
 }
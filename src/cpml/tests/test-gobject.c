@@ -154,5 +154,9 @@ main(int argc, char *argv[])
 
     adg_test_add_enum_checks("/cpml/curve-offset-algorithm/type/enum", CPML_TYPE_CURVE_OFFSET_ALGORITHM);
 
+    adg_test_add_enum_checks("/cpml/boolean-operation/type/enum", CPML_TYPE_BOOLEAN_OPERATION);
+
+    adg_test_add_enum_checks("/cpml/trig-mode/type/enum", CPML_TYPE_TRIG_MODE);
+
     return g_test_run();
 }
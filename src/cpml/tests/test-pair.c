@@ -103,6 +103,44 @@ _cpml_method_pair_transform(void)
     adg_assert_isapprox(pair.y, diag3.y);
 }
 
+static void
+_cpml_method_pairs_transform(void)
+{
+    CpmlPair src[3], dst[3];
+    cairo_matrix_t matrix;
+
+    cpml_pair_copy(&src[0], &org);
+    cpml_pair_copy(&src[1], &diag);
+    cpml_pair_copy(&src[2], &junk);
+
+    /* Without a matrix, the pairs must be simply copied */
+    cpml_pairs_transform(3, src, dst, NULL);
+    g_assert_true(cpml_pair_equal(&dst[0], &org));
+    g_assert_true(cpml_pair_equal(&dst[1], &diag));
+    g_assert_true(cpml_pair_equal(&dst[2], &junk));
+
+    /* The result must match cpml_pair_transform() */
+    cairo_matrix_init_scale(&matrix, 3, 3);
+    cairo_matrix_rotate(&matrix, 0.5);
+    cairo_matrix_translate(&matrix, diag.x, diag.y);
+    cpml_pairs_transform(3, src, dst, &matrix);
+    cpml_pair_transform(&src[1], &matrix);
+    adg_assert_isapprox(dst[1].x, src[1].x);
+    adg_assert_isapprox(dst[1].y, src[1].y);
+
+    /* In-place transformation */
+    cairo_matrix_init_scale(&matrix, 3, 3);
+    cpml_pair_copy(&src[1], &diag);
+    cpml_pairs_transform(3, src, src, &matrix);
+    adg_assert_isapprox(src[0].x, org.x);
+    adg_assert_isapprox(src[0].y, org.y);
+    adg_assert_isapprox(src[1].x, diag3.x);
+    adg_assert_isapprox(src[1].y, diag3.y);
+
+    /* Nothing to transform */
+    cpml_pairs_transform(0, NULL, NULL, &matrix);
+}
+
 static void
 _cpml_method_distance(void)
 {
@@ -185,6 +223,41 @@ _cpml_method_angle(void)
     adg_assert_isapprox(vector.y, 1);
 }
 
+static void
+_cpml_method_trig(void)
+{
+    double angles[] = { 0, M_PI_4, -M_PI_2, 3, -3, M_PI, 100.5 };
+    double sines[G_N_ELEMENTS(angles)], cosines[G_N_ELEMENTS(angles)];
+    double sine, cosine;
+    gsize n;
+
+    /* The exact mode is the C math library */
+    g_assert_cmpfloat(cpml_atan2(1, -2, CPML_TRIG_EXACT), ==, atan2(1, -2));
+    cpml_sincos(1.234, &sine, &cosine, CPML_TRIG_EXACT);
+    g_assert_cmpfloat(sine, ==, sin(1.234));
+    g_assert_cmpfloat(cosine, ==, cos(1.234));
+
+    for (n = 0; n < G_N_ELEMENTS(angles); ++n) {
+        cpml_sincos(angles[n], &sine, &cosine, CPML_TRIG_FAST);
+        g_assert_cmpfloat(fabs(sine - sin(angles[n])), <, 1e-12);
+        g_assert_cmpfloat(fabs(cosine - cos(angles[n])), <, 1e-12);
+        g_assert_cmpfloat(fabs(cpml_atan2(sine, cosine, CPML_TRIG_FAST) -
+                               atan2(sine, cosine)), <, 1e-8);
+    }
+
+    cpml_sincos_n(angles, G_N_ELEMENTS(angles), sines, cosines, CPML_TRIG_FAST);
+    for (n = 0; n < G_N_ELEMENTS(angles); ++n) {
+        cpml_sincos(angles[n], &sine, &cosine, CPML_TRIG_FAST);
+        g_assert_cmpfloat(sines[n], ==, sine);
+        g_assert_cmpfloat(cosines[n], ==, cosine);
+    }
+
+    /* Same conventions of cpml_vector_angle() */
+    g_assert_cmpfloat(cpml_atan2(0, 0, CPML_TRIG_FAST), ==, 0);
+    adg_assert_isapprox(cpml_atan2(0, -1, CPML_TRIG_FAST), M_PI);
+    adg_assert_isapprox(cpml_atan2(-1, 0, CPML_TRIG_FAST), -M_PI_2);
+}
+
 static void
 _cpml_method_length(void)
 {
@@ -255,8 +328,10 @@ main(int argc, char *argv[])
     g_test_add_func("/cpml/pair/behavior/misc", _cmpl_behavior_misc);
 
     g_test_add_func("/cpml/pair/method/transform", _cpml_method_pair_transform);
+    g_test_add_func("/cpml/pair/method/pairs-transform", _cpml_method_pairs_transform);
     g_test_add_func("/cpml/pair/method/distance", _cpml_method_distance);
     g_test_add_func("/cpml/vector/method/angle", _cpml_method_angle);
+    g_test_add_func("/cpml/vector/method/trig", _cpml_method_trig);
     g_test_add_func("/cpml/vector/method/length", _cpml_method_length);
     g_test_add_func("/cpml/vector/method/transform", _cpml_method_vector_transform);
 
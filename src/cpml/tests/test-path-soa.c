@@ -0,0 +1,180 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <cpml.h>
+
+
+static cairo_path_data_t path_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 3, 0 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 3, 4 }},
+    { .header = { CPML_CLOSE, 1 }},
+
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 10, 10 }},
+    { .header = { CPML_ARC, 3 }},
+    { .point = { 11.70710678, 10.70710678 }},
+    { .point = { 12, 10 }}
+};
+
+static cairo_path_t path = {
+    CAIRO_STATUS_SUCCESS,
+    path_data,
+    G_N_ELEMENTS(path_data)
+};
+
+
+static void
+_cpml_method_from_cairo(void)
+{
+    CpmlPathSoA *soa;
+    cairo_path_data_t invalid_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 3 }},
+        { .point = { 1, 1 }}
+    };
+    cairo_path_t invalid_path = {
+        CAIRO_STATUS_SUCCESS,
+        invalid_data,
+        G_N_ELEMENTS(invalid_data)
+    };
+
+    soa = cpml_path_soa_from_cairo(&path);
+    g_assert_nonnull(soa);
+    g_assert_cmpuint(soa->n_primitives, ==, 6);
+    g_assert_cmpuint(soa->n_points, ==, 6);
+
+    g_assert_cmpint(soa->type[0], ==, CPML_MOVE);
+    g_assert_cmpint(soa->type[3], ==, CPML_CLOSE);
+    g_assert_cmpint(soa->type[5], ==, CPML_ARC);
+
+    g_assert_cmpuint(soa->offsets[0], ==, 0);
+    g_assert_cmpuint(soa->offsets[3], ==, 3);
+    g_assert_cmpuint(soa->offsets[4], ==, 3);
+    g_assert_cmpuint(soa->offsets[5], ==, 4);
+    g_assert_cmpuint(soa->offsets[6], ==, 6);
+
+    adg_assert_isapprox(soa->x[2], 3);
+    adg_assert_isapprox(soa->y[2], 4);
+    adg_assert_isapprox(soa->x[5], 12);
+    adg_assert_isapprox(soa->y[5], 10);
+
+    cpml_path_soa_destroy(soa);
+
+    /* The length of the line header overflows the path */
+    g_assert_null(cpml_path_soa_from_cairo(&invalid_path));
+}
+
+static void
+_cpml_method_put_data(void)
+{
+    CpmlPathSoA *soa;
+    cairo_path_data_t data[G_N_ELEMENTS(path_data)];
+    size_t n;
+
+    soa = cpml_path_soa_from_cairo(&path);
+
+    g_assert_cmpuint(cpml_path_soa_put_data(soa, 0, NULL), ==, G_N_ELEMENTS(path_data));
+    g_assert_cmpuint(cpml_path_soa_put_data(soa, G_N_ELEMENTS(data), data), ==, G_N_ELEMENTS(path_data));
+
+    for (n = 0; n < G_N_ELEMENTS(path_data); ++n) {
+        if (n == 0 || n == 2 || n == 4 || n == 6 || n == 7 || n == 9) {
+            g_assert_cmpint(data[n].header.type, ==, path_data[n].header.type);
+            g_assert_cmpint(data[n].header.length, ==, path_data[n].header.length);
+        } else {
+            adg_assert_isapprox(data[n].point.x, path_data[n].point.x);
+            adg_assert_isapprox(data[n].point.y, path_data[n].point.y);
+        }
+    }
+
+    cpml_path_soa_destroy(soa);
+}
+
+static void
+_cpml_method_put_extents(void)
+{
+    CpmlPathSoA *soa;
+    CpmlExtents extents;
+
+    soa = cpml_path_soa_from_cairo(&path);
+    cpml_path_soa_put_extents(soa, &extents);
+
+    /* The arc goes beyond its points up to y = 11 */
+    g_assert_true(extents.is_defined);
+    adg_assert_isapprox(extents.org.x, 0);
+    adg_assert_isapprox(extents.org.y, 0);
+    adg_assert_isapprox(extents.size.x, 12);
+    adg_assert_isapprox(extents.size.y, 11);
+
+    cpml_path_soa_destroy(soa);
+}
+
+static void
+_cpml_method_transform(void)
+{
+    CpmlPathSoA *soa;
+    cairo_matrix_t matrix;
+
+    soa = cpml_path_soa_from_cairo(&path);
+    cairo_matrix_init(&matrix, 2, 0, 0, 3, 1, 2);
+    cpml_path_soa_transform(soa, &matrix);
+
+    adg_assert_isapprox(soa->x[0], 1);
+    adg_assert_isapprox(soa->y[0], 2);
+    adg_assert_isapprox(soa->x[2], 7);
+    adg_assert_isapprox(soa->y[2], 14);
+    adg_assert_isapprox(soa->x[5], 25);
+    adg_assert_isapprox(soa->y[5], 32);
+
+    cpml_path_soa_destroy(soa);
+}
+
+static void
+_cpml_method_get_length(void)
+{
+    CpmlPathSoA *soa;
+
+    soa = cpml_path_soa_from_cairo(&path);
+
+    /* The triangle perimeter plus an half circle of radius 1 */
+    adg_assert_isapprox(cpml_path_soa_get_length(soa), 12 + G_PI);
+
+    cpml_path_soa_destroy(soa);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/cpml/path-soa/method/from-cairo", _cpml_method_from_cairo);
+    g_test_add_func("/cpml/path-soa/method/put-data", _cpml_method_put_data);
+    g_test_add_func("/cpml/path-soa/method/put-extents", _cpml_method_put_extents);
+    g_test_add_func("/cpml/path-soa/method/transform", _cpml_method_transform);
+    g_test_add_func("/cpml/path-soa/method/get-length", _cpml_method_get_length);
+
+    return g_test_run();
+}
@@ -636,15 +636,15 @@ _cpml_method_put_extents(void)
     g_assert_cmpfloat(extents.size.x, >=, 3);
     g_assert_cmpfloat(extents.size.y, >=, 6);
 
-    /* Curve: actually the extents are computed by using the
-     * convex hull (hence the exact coordinates of the points) */
+    /* Curve: the extents are computed precisely, so the control
+     * points (8,9) and (10,11) are not included */
     cpml_primitive_next(&primitive);
     cpml_primitive_put_extents(&primitive, &extents);
     g_assert_true(extents.is_defined);
     adg_assert_isapprox(extents.org.x, -2);
     adg_assert_isapprox(extents.org.y, 2);
-    adg_assert_isapprox(extents.size.x, 12);
-    adg_assert_isapprox(extents.size.y, 9);
+    adg_assert_isapprox(extents.size.x, 9.512);
+    adg_assert_isapprox(extents.size.y, 6.706);
 
     /* Close */
     cpml_primitive_next(&primitive);
@@ -809,18 +809,14 @@ _cpml_method_get_closest_pos(void)
      * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
      */
 
-    /* Close */
+    /* Curve */
     cpml_primitive_next(&primitive);
-    /* TODO: not yet implemented
-     * pair.x = 6; pair.y = 7;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0);
-     * pair.x = -2; pair.y = 2;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
-     * pair.x = 10; pair.y = 10;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0);
-     * pair.x = 0; pair.y = 0;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
-     */
+    pair.x = 6; pair.y = 7;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0);
+    pair.x = -2; pair.y = 2;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
+    pair.x = 7.25; pair.y = 8.625;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0.5);
 
     /* Close */
     cpml_primitive_next(&primitive);
@@ -1071,8 +1067,11 @@ _cpml_method_put_intersections(void)
 
     cpml_primitive_next(&primitive1);
 
-    /* primitive1 (1.3) does not intersect primitive2 (2.2) */
-    g_assert_cmpuint(cpml_primitive_put_intersections(&primitive1, &primitive2, 2, pair), ==, 0);
+    /* primitive1 (1.3) intersects primitive2 (2.2) outside the boundaries of primitive2 */
+    g_assert_cmpuint(cpml_primitive_put_intersections(&primitive1, &primitive2, 2, pair), ==, 1);
+    adg_assert_isapprox(pair[0].x, 1);
+    adg_assert_isapprox(pair[0].y, 4.237);
+    g_assert_cmpint(cpml_primitive_is_inside(&primitive2, pair), ==, 0);
 
     cpml_primitive_next(&primitive1);
 
@@ -1377,6 +1376,57 @@ _cpml_method_offset(void)
     g_free(segment);
 }
 
+static void
+_cpml_method_offset_full(void)
+{
+    CpmlSegment original, *segment;
+    CpmlPrimitive primitive;
+    CpmlPrimitive *backup;
+    CpmlOffsetContext context;
+
+    cpml_segment_from_cairo(&original, (cairo_path_t *) adg_test_path());
+    segment = cpml_segment_deep_dup(&original);
+    cpml_primitive_from_segment(&primitive, segment);
+
+    /* Line: the context does not affect it */
+    context.algorithm = CPML_CURVE_OFFSET_ALGORITHM_BAIOCA;
+    context.tolerance = 0;
+    cpml_primitive_offset_full(&primitive, 1, &context);
+    adg_assert_isapprox((primitive.org)->point.x, 0);
+    adg_assert_isapprox((primitive.org)->point.y, 2);
+    adg_assert_isapprox(primitive.data[1].point.x, 3);
+    adg_assert_isapprox(primitive.data[1].point.y, 2);
+    cpml_primitive_offset_full(&primitive, -1, NULL);
+    adg_assert_isapprox((primitive.org)->point.x, 0);
+    adg_assert_isapprox((primitive.org)->point.y, 1);
+
+    /* Curve: the context algorithm must override the global one */
+    cpml_primitive_next(&primitive);
+    cpml_primitive_next(&primitive);
+    backup = cpml_primitive_deep_dup(&primitive);
+    cpml_curve_offset_algorithm(CPML_CURVE_OFFSET_ALGORITHM_GEOMETRICAL);
+
+    cpml_primitive_offset_full(&primitive, 1, &context);
+    adg_assert_isapprox(primitive.data[1].point.x, 6.901);
+    adg_assert_isapprox(primitive.data[1].point.y, 9.315);
+    adg_assert_isapprox(primitive.data[2].point.x, 10.806);
+    adg_assert_isapprox(primitive.data[2].point.y, 10.355);
+    g_assert_cmpint(cpml_curve_offset_algorithm(CPML_CURVE_OFFSET_ALGORITHM_NONE), ==, CPML_CURVE_OFFSET_ALGORITHM_GEOMETRICAL);
+    cpml_primitive_copy_data(&primitive, backup);
+
+    /* CPML_CURVE_OFFSET_ALGORITHM_NONE falls back to the global one */
+    context.algorithm = CPML_CURVE_OFFSET_ALGORITHM_NONE;
+    cpml_primitive_offset_full(&primitive, 1, &context);
+    adg_assert_isapprox(primitive.data[1].point.x, 7.889);
+    adg_assert_isapprox(primitive.data[1].point.y, 8.515);
+    adg_assert_isapprox(primitive.data[2].point.x, 11.196);
+    adg_assert_isapprox(primitive.data[2].point.y, 9.007);
+
+    g_free(backup);
+    cpml_curve_offset_algorithm(CPML_CURVE_OFFSET_ALGORITHM_DEFAULT);
+    g_free(segment);
+}
+
 static void
 _cpml_method_join(void)
 {
@@ -1519,6 +1569,7 @@ main(int argc, char *argv[])
     g_test_add_func("/cpml/primitive/method/put-intersections/circle-line", _cpml_method_put_intersections_circle_line);
     g_test_add_func("/cpml/primitive/method/put-intersections-with-segment", _cpml_method_put_intersections_with_segment);
     g_test_add_func("/cpml/primitive/method/offset", _cpml_method_offset);
+    g_test_add_func("/cpml/primitive/method/offset-full", _cpml_method_offset_full);
     g_test_add_func("/cpml/primitive/method/join", _cpml_method_join);
     g_test_add_func("/cpml/primitive/method/to-cairo", _cpml_method_to_cairo);
     adg_test_add_traps("/cpml/primitive/method/dump", _cpml_method_dump, 1);
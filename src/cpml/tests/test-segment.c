@@ -20,6 +20,7 @@
 
 #include <adg-test.h>
 #include <cpml.h>
+#include <math.h>
 
 
 static void
@@ -395,6 +396,100 @@ _cpml_method_get_length(void)
     adg_assert_isapprox(cpml_segment_get_length(&segment), 0);
 }
 
+static void
+_cpml_method_get_closest_pos(void)
+{
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlPair pair;
+
+    /* Second segment: (0,0) -> (1,0) -> (1,2) */
+    cpml_segment_from_cairo(&segment, (cairo_path_t *) adg_test_path());
+    cpml_segment_next(&segment);
+
+    pair.x = 0.5; pair.y = -1;
+    adg_assert_isapprox(cpml_segment_get_closest_pos(&segment, &pair, &primitive), 0.5);
+    adg_assert_isapprox(primitive.org->point.x, 0);
+
+    pair.x = 3; pair.y = 1;
+    adg_assert_isapprox(cpml_segment_get_closest_pos(&segment, &pair, &primitive), 0.5);
+    adg_assert_isapprox(primitive.org->point.x, 1);
+    adg_assert_isapprox(primitive.org->point.y, 0);
+
+    /* The primitive is optional */
+    pair.x = 1; pair.y = 3;
+    adg_assert_isapprox(cpml_segment_get_closest_pos(&segment, &pair, NULL), 1);
+
+    /* Third segment: the closest point lies on the curve */
+    cpml_segment_next(&segment);
+    pair.x = 10; pair.y = 13;
+    adg_assert_isapprox(cpml_segment_get_closest_pos(&segment, &pair, &primitive), 0);
+    g_assert_cmpint(cpml_primitive_type(&primitive), ==, CPML_CURVE);
+}
+
+static void
+_cpml_method_length_table(void)
+{
+    cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 4 }},
+        { .header = { CPML_CURVE, 4 }},
+        { .point = { 4, 4 }},
+        { .point = { 5, 4 }},
+        { .point = { 6, 4 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+    CpmlSegment segment;
+    CpmlSegmentLengthTable *table;
+    CpmlPair pair;
+    CpmlVector vector;
+
+    g_assert_true(cpml_segment_from_cairo(&segment, &path));
+    table = cpml_segment_length_table_new(&segment, 8);
+    g_assert_nonnull(table);
+    adg_assert_isapprox(cpml_segment_length_table_get_length(table), 10);
+
+    /* Out of range lengths are clamped */
+    cpml_segment_length_table_put_pair_at_length(table, -1, &pair);
+    adg_assert_isapprox(pair.x, 0);
+    adg_assert_isapprox(pair.y, 0);
+    cpml_segment_length_table_put_pair_at_length(table, 100, &pair);
+    adg_assert_isapprox(pair.x, 6);
+    adg_assert_isapprox(pair.y, 4);
+
+    /* Lines */
+    cpml_segment_length_table_put_pair_at_length(table, 1.5, &pair);
+    adg_assert_isapprox(pair.x, 1.5);
+    adg_assert_isapprox(pair.y, 0);
+    cpml_segment_length_table_put_pair_at_length(table, 3, &pair);
+    adg_assert_isapprox(pair.x, 3);
+    adg_assert_isapprox(pair.y, 0);
+    cpml_segment_length_table_put_pair_at_length(table, 5, &pair);
+    adg_assert_isapprox(pair.x, 3);
+    adg_assert_isapprox(pair.y, 2);
+    cpml_segment_length_table_put_vector_at_length(table, 5, &vector);
+    adg_assert_isapprox(vector.x, 0);
+    g_assert_cmpfloat(vector.y, >, 0);
+
+    /* Curve (degenerated to a straight line) */
+    cpml_segment_length_table_put_pair_at_length(table, 8.5, &pair);
+    adg_assert_isapprox(pair.x, 4.5);
+    adg_assert_isapprox(pair.y, 4);
+    cpml_segment_length_table_put_vector_at_length(table, 8.5, &vector);
+    g_assert_cmpfloat(vector.x, >, 0);
+    adg_assert_isapprox(vector.y, 0);
+
+    cpml_segment_length_table_destroy(table);
+}
+
 static void
 _cpml_method_put_intersections(void)
 {
@@ -416,6 +511,121 @@ _cpml_method_put_intersections(void)
     g_assert_cmpuint(cpml_segment_put_intersections(&segment1, &segment2, 10, pair), ==, 0);
 }
 
+static void
+_cpml_method_put_self_intersections(void)
+{
+    cairo_path_data_t bowtie_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 2 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 0, 2 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t bowtie = {
+        CAIRO_STATUS_SUCCESS,
+        bowtie_data,
+        G_N_ELEMENTS(bowtie_data)
+    };
+    cairo_path_data_t triangle_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 1, 2 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t triangle = {
+        CAIRO_STATUS_SUCCESS,
+        triangle_data,
+        G_N_ELEMENTS(triangle_data)
+    };
+    CpmlSegment segment;
+    CpmlPair pair[10];
+
+    /* The bowtie crosses itself only in (1, 1): joints do not count */
+    g_assert_true(cpml_segment_from_cairo(&segment, &bowtie));
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 10, pair), ==, 1);
+    adg_assert_isapprox(pair[0].x, 1);
+    adg_assert_isapprox(pair[0].y, 1);
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 0, pair), ==, 0);
+
+    /* A closed triangle has no self-intersections */
+    g_assert_true(cpml_segment_from_cairo(&segment, &triangle));
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 10, pair), ==, 0);
+}
+
+static void
+_cpml_method_put_scanline_spans(void)
+{
+    cairo_path_data_t u_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 3 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 3 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 1 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 1, 1 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 1, 3 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 0, 3 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t u_path = {
+        CAIRO_STATUS_SUCCESS,
+        u_data,
+        G_N_ELEMENTS(u_data)
+    };
+    CpmlSegment segment;
+    CpmlPair pair[10];
+
+    g_assert_true(cpml_segment_from_cairo(&segment, &u_path));
+
+    /* Horizontal lines at y = 0.5, 1.5 and 2.5 */
+    g_assert_cmpuint(cpml_segment_put_scanline_spans(&segment, 0, 1, 0.5, 0, NULL), ==, 5);
+    g_assert_cmpuint(cpml_segment_put_scanline_spans(&segment, 0, 1, 0.5, 5, pair), ==, 5);
+    adg_assert_isapprox(pair[0].x, 0);
+    adg_assert_isapprox(pair[0].y, 0.5);
+    adg_assert_isapprox(pair[1].x, 3);
+    adg_assert_isapprox(pair[1].y, 0.5);
+    adg_assert_isapprox(pair[2].x, 0);
+    adg_assert_isapprox(pair[2].y, 1.5);
+    adg_assert_isapprox(pair[3].x, 1);
+    adg_assert_isapprox(pair[3].y, 1.5);
+    adg_assert_isapprox(pair[4].x, 2);
+    adg_assert_isapprox(pair[4].y, 1.5);
+    adg_assert_isapprox(pair[5].x, 3);
+    adg_assert_isapprox(pair[5].y, 1.5);
+    adg_assert_isapprox(pair[8].x, 2);
+    adg_assert_isapprox(pair[8].y, 2.5);
+    adg_assert_isapprox(pair[9].x, 3);
+    adg_assert_isapprox(pair[9].y, 2.5);
+
+    /* The destination buffer is never overflowed */
+    g_assert_cmpuint(cpml_segment_put_scanline_spans(&segment, 0, 1, 0.5, 2, pair), ==, 2);
+
+    /* Vertical lines at x = 0.5, 1.5 and 2.5: the line at x = 1.5
+     * crosses only the bottom of the U */
+    g_assert_cmpuint(cpml_segment_put_scanline_spans(&segment, G_PI_2, 1, -0.5, 5, pair), ==, 3);
+    adg_assert_isapprox(pair[2].x, 1.5);
+    adg_assert_isapprox(pair[2].y, 0);
+    adg_assert_isapprox(pair[3].x, 1.5);
+    adg_assert_isapprox(pair[3].y, 1);
+
+    /* Invalid spacing */
+    g_assert_cmpuint(cpml_segment_put_scanline_spans(&segment, 0, 0, 0.5, 5, pair), ==, 0);
+}
+
 static void
 _cpml_method_offset(void)
 {
@@ -448,6 +658,402 @@ _cpml_method_offset(void)
     g_free(segment);
 }
 
+static void
+_cpml_method_put_offset(void)
+{
+    cairo_path_data_t square_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 10, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 10, 10 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 0, 10 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        square_data,
+        G_N_ELEMENTS(square_data)
+    };
+    CpmlSegment segment;
+    cairo_path_data_t data[32];
+
+    cpml_segment_from_cairo(&segment, &path);
+
+    /* Only the size is returned when no buffer is provided */
+    g_assert_cmpuint(cpml_segment_put_offset(&segment, -1, NULL, CAIRO_LINE_JOIN_MITER, 1, 0, NULL), ==, 11);
+    g_assert_cmpuint(cpml_segment_put_offset(&segment, -1, NULL, CAIRO_LINE_JOIN_BEVEL, 1, 0, NULL), ==, 19);
+    g_assert_cmpuint(cpml_segment_put_offset(&segment, -1, NULL, CAIRO_LINE_JOIN_ROUND, 1, 0, NULL), ==, 23);
+
+    /* Outer miter joins */
+    g_assert_cmpuint(cpml_segment_put_offset(&segment, -1, NULL, CAIRO_LINE_JOIN_MITER, 1, G_N_ELEMENTS(data), data), ==, 11);
+    g_assert_cmpint(data[0].header.type, ==, CPML_MOVE);
+    adg_assert_isapprox(data[1].point.x, -1);
+    adg_assert_isapprox(data[1].point.y, -1);
+    g_assert_cmpint(data[2].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(data[3].point.x, 11);
+    adg_assert_isapprox(data[3].point.y, -1);
+    adg_assert_isapprox(data[5].point.x, 11);
+    adg_assert_isapprox(data[5].point.y, 11);
+    g_assert_cmpint(data[10].header.type, ==, CPML_CLOSE);
+
+    /* The original segment must be left untouched */
+    adg_assert_isapprox(square_data[3].point.x, 10);
+    adg_assert_isapprox(square_data[3].point.y, 0);
+
+    /* Outer round joins */
+    g_assert_cmpuint(cpml_segment_put_offset(&segment, -1, NULL, CAIRO_LINE_JOIN_ROUND, 1, G_N_ELEMENTS(data), data), ==, 23);
+    adg_assert_isapprox(data[1].point.x, 0);
+    adg_assert_isapprox(data[1].point.y, -1);
+    adg_assert_isapprox(data[3].point.x, 10);
+    adg_assert_isapprox(data[3].point.y, -1);
+    g_assert_cmpint(data[4].header.type, ==, CPML_ARC);
+    adg_assert_isapprox(data[5].point.x, 10.707);
+    adg_assert_isapprox(data[5].point.y, -0.707);
+    adg_assert_isapprox(data[6].point.x, 11);
+    adg_assert_isapprox(data[6].point.y, 0);
+
+    /* Inner corners are trimmed, whatever the join is */
+    g_assert_cmpuint(cpml_segment_put_offset(&segment, 1, NULL, CAIRO_LINE_JOIN_ROUND, 1, G_N_ELEMENTS(data), data), ==, 11);
+    adg_assert_isapprox(data[1].point.x, 1);
+    adg_assert_isapprox(data[1].point.y, 1);
+    adg_assert_isapprox(data[3].point.x, 9);
+    adg_assert_isapprox(data[3].point.y, 1);
+
+    /* A small buffer must not be overflowed */
+    data[4].header.type = CPML_CLOSE;
+    g_assert_cmpuint(cpml_segment_put_offset(&segment, 1, NULL, CAIRO_LINE_JOIN_MITER, 1, 4, data), ==, 11);
+    g_assert_cmpint(data[4].header.type, ==, CPML_CLOSE);
+}
+
+static void
+_cpml_method_flatten(void)
+{
+    cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 10, 0 }},
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 13, 3 }},
+        { .point = { 10, 6 }},
+        { .header = { CPML_CURVE, 4 }},
+        { .point = { 6, 10 }},
+        { .point = { 2, -4 }},
+        { .point = { 0, 6 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+    CpmlSegment segment;
+    CpmlPair pair[256], center = { 10, 3 };
+    size_t n, n_coarse, n_fine;
+
+    g_assert_true(cpml_segment_from_cairo(&segment, &path));
+
+    /* A non-positive tolerance is not valid */
+    g_assert_cmpuint(cpml_segment_flatten(&segment, 0, 0, NULL), ==, 0);
+
+    /* The size returned without buffer is the size of the polyline */
+    n_coarse = cpml_segment_flatten(&segment, 0.1, 0, NULL);
+    g_assert_cmpuint(n_coarse, ==, 23);
+    g_assert_cmpuint(cpml_segment_flatten(&segment, 0.1, G_N_ELEMENTS(pair), pair), ==, n_coarse);
+
+    /* The end points of the primitives are always included */
+    adg_assert_isapprox(pair[0].x, 0);
+    adg_assert_isapprox(pair[0].y, 0);
+    adg_assert_isapprox(pair[1].x, 10);
+    adg_assert_isapprox(pair[1].y, 0);
+    adg_assert_isapprox(pair[n_coarse-1].x, 0);
+    adg_assert_isapprox(pair[n_coarse-1].y, 0);
+
+    /* The arc vertices lay on the circle */
+    for (n = 2; pair[n].x > 10; ++n)
+        adg_assert_isapprox(cpml_pair_distance(&pair[n], &center), 3);
+    adg_assert_isapprox(pair[n].x, 10);
+    adg_assert_isapprox(pair[n].y, 6);
+
+    /* A smaller tolerance gives a finer polyline */
+    n_fine = cpml_segment_flatten(&segment, 0.01, 0, NULL);
+    g_assert_cmpuint(n_fine, >, n_coarse);
+
+    /* Only the available room must be used */
+    g_assert_cmpuint(cpml_segment_flatten(&segment, 0.1, 3, pair), ==, 3);
+
+    /* A polyline is left as is */
+    g_assert_true(cpml_segment_from_cairo(&segment, (cairo_path_t *) adg_test_path()));
+    cpml_segment_next(&segment);
+    g_assert_cmpuint(cpml_segment_flatten(&segment, 1, 0, NULL), ==, 3);
+}
+
+static void
+_cpml_method_put_simplified(void)
+{
+    cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 1, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 0.001 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 4, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 4, 4 }},
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 6, 6 }},
+        { .point = { 4, 8 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+    cairo_path_data_t arc_data[20], dest[20];
+    CpmlSegment segment;
+    double angle;
+    int n;
+
+    g_assert_true(cpml_segment_from_cairo(&segment, &path));
+
+    /* A non-positive tolerance is not valid */
+    g_assert_cmpuint(cpml_segment_put_simplified(&segment, 0, 0, 0, NULL), ==, 0);
+
+    /* Nearly collinear lines are merged, other primitives are kept */
+    g_assert_cmpuint(cpml_segment_put_simplified(&segment, 0.01, 0, 0, NULL), ==, 10);
+    g_assert_cmpuint(cpml_segment_put_simplified(&segment, 0.01, 0, G_N_ELEMENTS(dest), dest), ==, 10);
+    g_assert_cmpint(dest[0].header.type, ==, CPML_MOVE);
+    g_assert_cmpint(dest[2].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(dest[3].point.x, 4);
+    adg_assert_isapprox(dest[3].point.y, 0);
+    g_assert_cmpint(dest[4].header.type, ==, CPML_LINE);
+    adg_assert_isapprox(dest[5].point.y, 4);
+    g_assert_cmpint(dest[6].header.type, ==, CPML_ARC);
+    adg_assert_isapprox(dest[8].point.y, 8);
+    g_assert_cmpint(dest[9].header.type, ==, CPML_CLOSE);
+
+    /* A smaller tolerance keeps the deviating points */
+    g_assert_cmpuint(cpml_segment_put_simplified(&segment, 0.0001, 0, 0, NULL), ==, 14);
+
+    /* A quarter of circle approximated by 9 lines */
+    arc_data[0].header.type = CPML_MOVE;
+    arc_data[0].header.length = 2;
+    arc_data[1].point.x = 10;
+    arc_data[1].point.y = 0;
+    for (n = 1; n < 10; ++n) {
+        angle = M_PI_2 * n / 9;
+        arc_data[n * 2].header.type = CPML_LINE;
+        arc_data[n * 2].header.length = 2;
+        arc_data[n * 2 + 1].point.x = cos(angle) * 10;
+        arc_data[n * 2 + 1].point.y = sin(angle) * 10;
+    }
+    path.data = arc_data;
+    path.num_data = G_N_ELEMENTS(arc_data);
+    g_assert_true(cpml_segment_from_cairo(&segment, &path));
+
+    g_assert_cmpuint(cpml_segment_put_simplified(&segment, 0.01, 0, 0, NULL), ==, 20);
+    g_assert_cmpuint(cpml_segment_put_simplified(&segment, 0.01, 1, G_N_ELEMENTS(dest), dest), ==, 5);
+    g_assert_cmpint(dest[2].header.type, ==, CPML_ARC);
+    adg_assert_isapprox(dest[3].point.x, cos(M_PI_2 * 4 / 9) * 10);
+    adg_assert_isapprox(dest[3].point.y, sin(M_PI_2 * 4 / 9) * 10);
+    adg_assert_isapprox(dest[4].point.x, 0);
+    adg_assert_isapprox(dest[4].point.y, 10);
+
+    /* Only the available room must be used */
+    g_assert_cmpuint(cpml_segment_put_simplified(&segment, 0.01, 1, 2, dest), ==, 5);
+}
+
+static void
+_cpml_method_put_boolean(void)
+{
+    cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 2 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 0, 2 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_data_t data2[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 1, 1 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 1, 3 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 3 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 1 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+    cairo_path_t path2 = {
+        CAIRO_STATUS_SUCCESS,
+        data2,
+        G_N_ELEMENTS(data2)
+    };
+    cairo_path_t result = {
+        CAIRO_STATUS_SUCCESS,
+        NULL,
+        0
+    };
+    cairo_path_data_t dest[40];
+    CpmlSegment segment, segment2, segment3;
+    CpmlExtents extents;
+
+    g_assert_true(cpml_segment_from_cairo(&segment, &path));
+    g_assert_true(cpml_segment_from_cairo(&segment2, &path2));
+
+    /* A non-positive tolerance is not valid */
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_UNION, 0, 0, NULL), ==, 0);
+
+    /* The union is a single outline of 8 vertices, counterclockwise
+     * even if the second segment is clockwise */
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_UNION, 0.01, 0, NULL), ==, 17);
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_UNION, 0.01, G_N_ELEMENTS(dest), dest), ==, 17);
+    g_assert_cmpint(dest[0].header.type, ==, CPML_MOVE);
+    adg_assert_isapprox(dest[1].point.x, 0);
+    adg_assert_isapprox(dest[1].point.y, 0);
+    adg_assert_isapprox(dest[3].point.x, 2);
+    adg_assert_isapprox(dest[3].point.y, 0);
+    adg_assert_isapprox(dest[5].point.x, 2);
+    adg_assert_isapprox(dest[5].point.y, 1);
+    adg_assert_isapprox(dest[7].point.x, 3);
+    adg_assert_isapprox(dest[7].point.y, 1);
+    g_assert_cmpint(dest[16].header.type, ==, CPML_CLOSE);
+
+    /* The intersection is the overlapping square */
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_INTERSECTION, 0.01, G_N_ELEMENTS(dest), dest), ==, 9);
+    result.data = dest;
+    result.num_data = 9;
+    g_assert_true(cpml_segment_from_cairo(&segment3, &result));
+    cpml_segment_put_extents(&segment3, &extents);
+    adg_assert_isapprox(extents.org.x, 1);
+    adg_assert_isapprox(extents.org.y, 1);
+    adg_assert_isapprox(extents.size.x, 1);
+    adg_assert_isapprox(extents.size.y, 1);
+
+    /* The difference cuts away a corner */
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_DIFFERENCE, 0.01, G_N_ELEMENTS(dest), dest), ==, 13);
+    adg_assert_isapprox(dest[7].point.x, 1);
+    adg_assert_isapprox(dest[7].point.y, 1);
+
+    /* A shared side is dissolved by the union */
+    data2[1].point.x = 2;
+    data2[1].point.y = 0;
+    data2[3].point.x = 2;
+    data2[3].point.y = 2;
+    data2[5].point.x = 4;
+    data2[5].point.y = 2;
+    data2[7].point.x = 4;
+    data2[7].point.y = 0;
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_UNION, 0.01, G_N_ELEMENTS(dest), dest), ==, 9);
+    adg_assert_isapprox(dest[3].point.x, 4);
+    adg_assert_isapprox(dest[3].point.y, 0);
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_INTERSECTION, 0.01, 0, NULL), ==, 0);
+
+    /* A difference with a contained segment leaves a hole */
+    data2[1].point.x = 0.5;
+    data2[1].point.y = 0.5;
+    data2[3].point.x = 1.5;
+    data2[3].point.y = 0.5;
+    data2[5].point.x = 1.5;
+    data2[5].point.y = 1.5;
+    data2[7].point.x = 0.5;
+    data2[7].point.y = 1.5;
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_DIFFERENCE, 0.01, G_N_ELEMENTS(dest), dest), ==, 18);
+    g_assert_cmpint(dest[9].header.type, ==, CPML_MOVE);
+
+    /* Only the available room must be used */
+    g_assert_cmpuint(cpml_segment_put_boolean(&segment, &segment2, CPML_BOOLEAN_DIFFERENCE, 0.01, 2, dest), ==, 18);
+}
+
+static void
+_cpml_method_put_fitted(void)
+{
+    cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 1, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 1 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 2 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 3, 3 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+    cairo_path_data_t wave_data[202], dest[202];
+    CpmlSegment segment;
+    size_t n_data;
+    int n;
+
+    g_assert_true(cpml_segment_from_cairo(&segment, &path));
+
+    /* A non-positive tolerance is not valid */
+    g_assert_cmpuint(cpml_segment_put_fitted(&segment, 0, 0, NULL), ==, 0);
+
+    /* The corner splits the run in two curves */
+    g_assert_cmpuint(cpml_segment_put_fitted(&segment, 0.01, 0, NULL), ==, 11);
+    g_assert_cmpuint(cpml_segment_put_fitted(&segment, 0.01, G_N_ELEMENTS(dest), dest), ==, 11);
+    g_assert_cmpint(dest[0].header.type, ==, CPML_MOVE);
+    g_assert_cmpint(dest[2].header.type, ==, CPML_CURVE);
+    adg_assert_isapprox(dest[5].point.x, 3);
+    adg_assert_isapprox(dest[5].point.y, 0);
+    g_assert_cmpint(dest[6].header.type, ==, CPML_CURVE);
+    adg_assert_isapprox(dest[9].point.x, 3);
+    adg_assert_isapprox(dest[9].point.y, 3);
+    g_assert_cmpint(dest[10].header.type, ==, CPML_CLOSE);
+
+    /* A dense wave of 100 lines */
+    wave_data[0].header.type = CPML_MOVE;
+    wave_data[0].header.length = 2;
+    wave_data[1].point.x = 0;
+    wave_data[1].point.y = 0;
+    for (n = 1; n <= 100; ++n) {
+        wave_data[n * 2].header.type = CPML_LINE;
+        wave_data[n * 2].header.length = 2;
+        wave_data[n * 2 + 1].point.x = n * 0.1;
+        wave_data[n * 2 + 1].point.y = sin(n * 0.1);
+    }
+    path.data = wave_data;
+    path.num_data = G_N_ELEMENTS(wave_data);
+    g_assert_true(cpml_segment_from_cairo(&segment, &path));
+
+    n_data = cpml_segment_put_fitted(&segment, 0.001, G_N_ELEMENTS(dest), dest);
+    g_assert_cmpuint(n_data, <, 70);
+    g_assert_cmpint(dest[2].header.type, ==, CPML_CURVE);
+    adg_assert_isapprox(dest[n_data - 1].point.x, 10);
+    adg_assert_isapprox(dest[n_data - 1].point.y, sin(10));
+
+    /* Only the available room must be used */
+    g_assert_cmpuint(cpml_segment_put_fitted(&segment, 0.001, 2, dest), ==, n_data);
+}
+
 static void
 _cpml_method_transform(void)
 {
@@ -594,8 +1200,17 @@ main(int argc, char *argv[])
     g_test_add_func("/cpml/segment/method/copy", _cpml_method_copy);
     g_test_add_func("/cpml/segment/method/copy-data", _cpml_method_copy_data);
     g_test_add_func("/cpml/segment/method/get-length", _cpml_method_get_length);
+    g_test_add_func("/cpml/segment/method/get-closest-pos", _cpml_method_get_closest_pos);
+    g_test_add_func("/cpml/segment/method/length-table", _cpml_method_length_table);
     g_test_add_func("/cpml/segment/method/put-intersections", _cpml_method_put_intersections);
+    g_test_add_func("/cpml/segment/method/put-self-intersections", _cpml_method_put_self_intersections);
+    g_test_add_func("/cpml/segment/method/put-scanline-spans", _cpml_method_put_scanline_spans);
     g_test_add_func("/cpml/segment/method/offset", _cpml_method_offset);
+    g_test_add_func("/cpml/segment/method/put-offset", _cpml_method_put_offset);
+    g_test_add_func("/cpml/segment/method/flatten", _cpml_method_flatten);
+    g_test_add_func("/cpml/segment/method/put-simplified", _cpml_method_put_simplified);
+    g_test_add_func("/cpml/segment/method/put-fitted", _cpml_method_put_fitted);
+    g_test_add_func("/cpml/segment/method/put-boolean", _cpml_method_put_boolean);
     g_test_add_func("/cpml/segment/method/transform", _cpml_method_transform);
     g_test_add_func("/cpml/segment/method/reverse", _cpml_method_reverse);
     g_test_add_func("/cpml/segment/method/to-cairo", _cpml_method_to_cairo);
@@ -30,6 +30,12 @@
 #include "adg-test.h"
 
 
+/* Minimum time (in seconds) for a meaningful scaling measurement */
+#define _ADG_SCALING_MIN_TIME   0.005
+/* Maximum input size reached while looking for a measurable time */
+#define _ADG_SCALING_MAX_SIZE   (1 << 22)
+
+
 typedef struct {
     GType type;
     gpointer instance;
@@ -768,3 +774,109 @@ adg_test_add_traps(const gchar *testpath, AdgTrapsFunc func, gint n_fragments)
     traps_data->n_fragments = n_fragments;
     g_test_add_data_func(testpath, traps_data, (gpointer) _adg_traps);
 }
+
+#if GLIB_CHECK_VERSION(2, 44, 0)
+
+static gint
+_adg_count_instances(GType type)
+{
+    GType *children;
+    guint n, n_children;
+    gint count;
+
+    count = g_type_get_instance_count(type);
+    children = g_type_children(type, &n_children);
+
+    for (n = 0; n < n_children; ++n)
+        count += _adg_count_instances(children[n]);
+
+    g_free(children);
+    return count;
+}
+
+gint
+adg_test_count_instances(GType type)
+{
+    static gint supported = -1;
+
+    /* The counters are updated only when GOBJECT_DEBUG=instance-count
+     * is set in the environment, as done by the gtester rules */
+    if (supported < 0) {
+        GObject *probe = g_object_new(G_TYPE_OBJECT, NULL);
+        supported = g_type_get_instance_count(G_TYPE_OBJECT) > 0;
+        g_object_unref(probe);
+    }
+
+    return supported ? _adg_count_instances(type) : -1;
+}
+
+#else
+
+gint
+adg_test_count_instances(GType type)
+{
+    /* Instance counting not supported by this GLib version */
+    return -1;
+}
+
+#endif
+
+static gdouble
+_adg_scaling_time(AdgScalingFunc func, guint size, gpointer user_data)
+{
+    GTimer *timer;
+    gdouble elapsed, best;
+    gint n;
+
+    timer = g_timer_new();
+    best = G_MAXDOUBLE;
+
+    /* Keep the best of three runs, to filter out the system noise */
+    for (n = 0; n < 3; ++n) {
+        g_timer_start(timer);
+        func(size, user_data);
+        elapsed = g_timer_elapsed(timer, NULL);
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    g_timer_destroy(timer);
+    return best;
+}
+
+void
+adg_test_assert_linear(AdgScalingFunc func, guint size, gpointer user_data)
+{
+    gdouble time1, time4;
+    gchar *message;
+
+    g_return_if_fail(func != NULL);
+    g_return_if_fail(size > 0);
+
+    /* Grow the input until the time is measurable */
+    time1 = _adg_scaling_time(func, size, user_data);
+    while (time1 < _ADG_SCALING_MIN_TIME && size < _ADG_SCALING_MAX_SIZE) {
+        size *= 2;
+        time1 = _adg_scaling_time(func, size, user_data);
+    }
+
+    if (time1 < _ADG_SCALING_MIN_TIME) {
+        g_test_message("Too fast to be measured: scaling check skipped");
+        return;
+    }
+
+    time4 = _adg_scaling_time(func, size * 4, user_data);
+    g_test_message("%u elements in %g s, %u elements in %g s",
+                   size, time1, size * 4, time4);
+
+    /* Quadrupling the input of a linear function should roughly
+     * quadruple the time, while a quadratic one would need 16 times
+     * longer: 8 leaves enough room for the measurement noise */
+    if (time4 > time1 * 8) {
+        message = g_strdup_printf("%u elements took %g s but %u elements took %g s: "
+                                  "the complexity is not linear",
+                                  size, time1, size * 4, time4);
+        g_assertion_message(G_LOG_DOMAIN, __FILE__, __LINE__, G_STRFUNC, message);
+        g_free(message);
+    }
+}
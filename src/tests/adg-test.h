@@ -81,6 +81,40 @@ G_BEGIN_DECLS
                                     } G_STMT_END
 
 
+/**
+ * Check the number of instances created by a code fragment.
+ * @type: (type GType): the type of the instances to count
+ * @before: (type gint): the result of adg_test_count_instances()
+ *          called before the code fragment
+ * @max: (type gint): the maximum number of new instances allowed
+ *
+ * Fails if the code fragment left more than @max new instances of
+ * @type (or of any type derived from it) alive, e.g.:
+ *
+ *     n = adg_test_count_instances(ADG_TYPE_ENTITY);
+ *     adg_entity_arrange(entity);
+ *     adg_assert_max_instances(ADG_TYPE_ENTITY, n, 0);
+ *
+ * The check is skipped when the instance counting is not available:
+ * see adg_test_count_instances().
+ **/
+#define adg_assert_max_instances(type,before,max) \
+                                    G_STMT_START { \
+                                        gint __n1 = adg_test_count_instances(type), \
+                                             __n2 = (before), __n3 = (max); \
+                                        if (__n1 < 0 || __n2 < 0 || __n1 - __n2 <= __n3) ; else \
+                                          g_assertion_message_cmpnum (G_LOG_DOMAIN, __FILE__, __LINE__, G_STRFUNC, \
+                                            "new instances of " #type " <= " #max, __n1 - __n2, "<=", __n3, 'i'); \
+                                    } G_STMT_END
+
+
+/* The following type is used by adg_test_assert_linear() to run
+ * the code fragment to be measured on an input of @size elements.
+ * The time spent by the whole function is measured, so preparing
+ * the input inside it is fine as long as that is linear too. */
+typedef void (*AdgScalingFunc)(guint size, gpointer user_data);
+
+
 /* The following type is used by adg_test_add_traps() to handle
  * in a consistent way trap assertions. The AdgTrapsFunc function
  * must implement one or more code fragments and a serie of
@@ -142,6 +176,10 @@ void            adg_test_add_local_space_checks (const gchar    *testpath,
 void            adg_test_add_traps              (const gchar    *testpath,
                                                  AdgTrapsFunc    func,
                                                  gint            n_fragments);
+gint            adg_test_count_instances        (GType           type);
+void            adg_test_assert_linear          (AdgScalingFunc  func,
+                                                 guint           size,
+                                                 gpointer        user_data);
 
 G_END_DECLS
 
@@ -0,0 +1,482 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2017  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+/* Batch renderer: every group of a key file (read from the files given
+ * on the command line or from the standard input) describes a drawing
+ * that is built and exported with adg_canvas_export() by a single
+ * long-lived process, so the type system and the style registry are
+ * initialized only once. The group name is the output file, e.g.:
+ *
+ * [plate.pdf]
+ * factor=2
+ * strokes=M 0 0 L 40 0 L 40 20 L 0 20 Z;M 5 10 L 35 10
+ * hatches=M 10 5 L 30 5 L 30 15 L 10 15 Z
+ * texts=0 -5 Plate
+ *
+ * Available keys:
+ * - type: the export format (png, pdf, ps or svg), guessed from the
+ *   output file when not specified;
+ * - factor: the export factor, see adg_canvas_set_factor();
+ * - strokes: list of paths to stroke;
+ * - hatches: list of closed paths to hatch and stroke;
+ * - texts: list of "x y text" toy texts.
+ *
+ * The paths use a subset of the SVG path syntax with absolute
+ * coordinates only: M (move to), L (line to), A (arc through two
+ * points), C (cubic Bézier curve) and Z (close path).
+ *
+ * Every job prints a single line in JSON format on the standard
+ * output, as done by the benchmark programs, e.g.:
+ *
+ * {"name": "plate.pdf", "build-seconds": 0.0001, "export-seconds": 0.0042}
+ *
+ * The jobs do not share any entity, model or style instance, so
+ * they can be run in parallel with the --jobs option. */
+
+
+#include <config.h>
+#include <adg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef struct {
+    gchar                *name;
+    cairo_surface_type_t  type;
+    gdouble               factor;
+    gchar               **strokes;
+    gchar               **hatches;
+    gchar               **texts;
+} AdgRenderJob;
+
+
+static gint             _adg_n_jobs = 1;
+static gint             _adg_n_failures = 0;
+G_LOCK_DEFINE_STATIC(_adg_n_failures);
+
+
+static void
+_adg_version(void)
+{
+    g_print("adg-render " PACKAGE_VERSION "\n");
+    exit(0);
+}
+
+static gboolean
+_adg_parse_number(gchar ***p_tokens, gdouble *number)
+{
+    gchar *token, *end;
+
+    /* Skip the empty tokens left by consecutive separators */
+    while (**p_tokens != NULL && ***p_tokens == '\0')
+        ++*p_tokens;
+
+    token = **p_tokens;
+    if (token == NULL)
+        return FALSE;
+
+    *number = g_ascii_strtod(token, &end);
+    ++*p_tokens;
+
+    return end != token && *end == '\0';
+}
+
+static gboolean
+_adg_parse_path(AdgPath *path, const gchar *data, GError **error)
+{
+    gchar **tokens, **p_token;
+    gdouble n[6];
+    gboolean valid;
+    gint i, needed;
+    gchar command;
+
+    tokens = g_strsplit_set(data, " \t,", -1);
+    p_token = tokens;
+    valid = TRUE;
+
+    while (valid && *p_token != NULL) {
+        if (**p_token == '\0') {
+            ++p_token;
+            continue;
+        }
+
+        command = **p_token;
+        valid = (*p_token)[1] == '\0';
+        ++p_token;
+
+        switch (command) {
+        case 'M':
+        case 'L':
+            needed = 2;
+            break;
+        case 'A':
+            needed = 4;
+            break;
+        case 'C':
+            needed = 6;
+            break;
+        case 'Z':
+            needed = 0;
+            break;
+        default:
+            needed = 0;
+            valid = FALSE;
+        }
+
+        for (i = 0; valid && i < needed; ++i)
+            valid = _adg_parse_number(&p_token, &n[i]);
+
+        if (!valid)
+            break;
+
+        switch (command) {
+        case 'M':
+            adg_path_move_to_explicit(path, n[0], n[1]);
+            break;
+        case 'L':
+            adg_path_line_to_explicit(path, n[0], n[1]);
+            break;
+        case 'A':
+            adg_path_arc_to_explicit(path, n[0], n[1], n[2], n[3]);
+            break;
+        case 'C':
+            adg_path_curve_to_explicit(path, n[0], n[1], n[2], n[3], n[4], n[5]);
+            break;
+        case 'Z':
+            adg_path_close(path);
+            break;
+        }
+    }
+
+    g_strfreev(tokens);
+
+    if (!valid)
+        g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                    "invalid path data '%s'", data);
+
+    return valid;
+}
+
+static gboolean
+_adg_parse_text(AdgCanvas *canvas, const gchar *data, GError **error)
+{
+    gdouble x, y;
+    gchar *end;
+    AdgToyText *toy_text;
+    cairo_matrix_t map;
+
+    x = g_ascii_strtod(data, &end);
+    if (end != data)
+        y = g_ascii_strtod(data = end, &end);
+
+    if (end == data || !g_ascii_isspace(*end)) {
+        g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                    "invalid text '%s'", data);
+        return FALSE;
+    }
+
+    toy_text = adg_toy_text_new(g_strchug(end));
+    cairo_matrix_init_translate(&map, x, y);
+    adg_entity_set_local_map((AdgEntity *) toy_text, &map);
+    adg_container_add((AdgContainer *) canvas, (AdgEntity *) toy_text);
+
+    return TRUE;
+}
+
+static AdgCanvas *
+_adg_build_canvas(AdgRenderJob *job, GError **error)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    gchar **p_data;
+    gchar *text;
+
+    canvas = adg_canvas_new();
+    if (job->factor > 0)
+        adg_canvas_set_factor(canvas, job->factor);
+
+    for (p_data = job->strokes; p_data != NULL && *p_data != NULL; ++p_data) {
+        path = adg_path_new();
+        if (!_adg_parse_path(path, *p_data, error)) {
+            g_object_unref(path);
+            g_object_unref(canvas);
+            return NULL;
+        }
+        adg_container_add((AdgContainer *) canvas,
+                          (AdgEntity *) adg_stroke_new((AdgTrail *) path));
+        g_object_unref(path);
+    }
+
+    for (p_data = job->hatches; p_data != NULL && *p_data != NULL; ++p_data) {
+        path = adg_path_new();
+        if (!_adg_parse_path(path, *p_data, error)) {
+            g_object_unref(path);
+            g_object_unref(canvas);
+            return NULL;
+        }
+        adg_container_add((AdgContainer *) canvas,
+                          (AdgEntity *) adg_hatch_new((AdgTrail *) path));
+        adg_container_add((AdgContainer *) canvas,
+                          (AdgEntity *) adg_stroke_new((AdgTrail *) path));
+        g_object_unref(path);
+    }
+
+    for (p_data = job->texts; p_data != NULL && *p_data != NULL; ++p_data) {
+        /* _adg_parse_text() modifies the string in place */
+        text = g_strdup(*p_data);
+        if (!_adg_parse_text(canvas, text, error)) {
+            g_free(text);
+            g_object_unref(canvas);
+            return NULL;
+        }
+        g_free(text);
+    }
+
+    return canvas;
+}
+
+/* Does not share any ADG object with the other jobs,
+ * so it can be run on any thread */
+static void
+_adg_run_job(gpointer job_data, gpointer user_data)
+{
+    AdgRenderJob *job;
+    AdgCanvas *canvas;
+    GTimer *timer;
+    GError *error;
+    gdouble build_seconds, export_seconds;
+    gboolean success;
+
+    job = job_data;
+    timer = g_timer_new();
+    error = NULL;
+
+    canvas = _adg_build_canvas(job, &error);
+    build_seconds = g_timer_elapsed(timer, NULL);
+
+    if (canvas != NULL) {
+        g_timer_start(timer);
+        success = adg_canvas_export(canvas, job->type, job->name, &error);
+        export_seconds = g_timer_elapsed(timer, NULL);
+        g_object_unref(canvas);
+    } else {
+        success = FALSE;
+        export_seconds = 0;
+    }
+
+    if (success) {
+        g_print("{\"name\": \"%s\", \"build-seconds\": %g, \"export-seconds\": %g}\n",
+                job->name, build_seconds, export_seconds);
+    } else {
+        g_printerr("%s: %s\n", job->name,
+                   error != NULL ? error->message : "export failed");
+        G_LOCK(_adg_n_failures);
+        ++_adg_n_failures;
+        G_UNLOCK(_adg_n_failures);
+    }
+
+    if (error != NULL)
+        g_error_free(error);
+
+    g_timer_destroy(timer);
+    g_free(job->name);
+    g_strfreev(job->strokes);
+    g_strfreev(job->hatches);
+    g_strfreev(job->texts);
+    g_free(job);
+}
+
+static cairo_surface_type_t
+_adg_type_from_name(const gchar *name)
+{
+    gchar *file;
+    cairo_surface_type_t type;
+
+    /* Reuse the guess on file names with a fake one */
+    file = g_strconcat("job.", name, NULL);
+    type = adg_type_from_filename(file);
+    g_free(file);
+
+    return type;
+}
+
+static AdgRenderJob *
+_adg_job_new(GKeyFile *key_file, const gchar *group)
+{
+    AdgRenderJob *job;
+    gchar *type;
+
+    job = g_new0(AdgRenderJob, 1);
+    job->name = g_strdup(group);
+    job->factor = g_key_file_has_key(key_file, group, "factor", NULL) ?
+        g_key_file_get_double(key_file, group, "factor", NULL) : 0;
+    job->strokes = g_key_file_get_string_list(key_file, group, "strokes", NULL, NULL);
+    job->hatches = g_key_file_get_string_list(key_file, group, "hatches", NULL, NULL);
+    job->texts = g_key_file_get_string_list(key_file, group, "texts", NULL, NULL);
+
+    type = g_key_file_get_string(key_file, group, "type", NULL);
+    job->type = type != NULL ? _adg_type_from_name(type) :
+                               adg_type_from_filename(group);
+    g_free(type);
+
+    return job;
+}
+
+static GKeyFile *
+_adg_load_jobs(const gchar *file, GError **error)
+{
+    GKeyFile *key_file;
+    GString *contents;
+    gchar buffer[4096];
+    gsize length;
+    gboolean success;
+
+    key_file = g_key_file_new();
+
+    if (strcmp(file, "-") != 0) {
+        success = g_key_file_load_from_file(key_file, file,
+                                            G_KEY_FILE_NONE, error);
+    } else {
+        contents = g_string_new(NULL);
+        while ((length = fread(buffer, 1, sizeof(buffer), stdin)) > 0)
+            g_string_append_len(contents, buffer, length);
+        success = g_key_file_load_from_data(key_file, contents->str,
+                                            contents->len,
+                                            G_KEY_FILE_NONE, error);
+        g_string_free(contents, TRUE);
+    }
+
+    if (!success) {
+        g_key_file_free(key_file);
+        return NULL;
+    }
+
+    return key_file;
+}
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+
+static GThreadPool *
+_adg_pool_new(void)
+{
+    gint n_jobs = _adg_n_jobs > 0 ? _adg_n_jobs : (gint) g_get_num_processors();
+
+    if (n_jobs <= 1)
+        return NULL;
+
+    return g_thread_pool_new(_adg_run_job, NULL, n_jobs, TRUE, NULL);
+}
+
+#else
+
+static GThreadPool *
+_adg_pool_new(void)
+{
+    /* Thread pools not supported by this GLib version */
+    return NULL;
+}
+
+#endif
+
+static void
+_adg_parse_args(gint *p_argc, gchar **p_argv[])
+{
+    GOptionEntry entries[] = {
+        {"version", 'V', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK,
+         (gpointer) _adg_version, "Display version information", NULL},
+        {"jobs", 'j', 0, G_OPTION_ARG_INT,
+         &_adg_n_jobs, "Number of parallel jobs (0 for one per processor)", "N"},
+        {NULL}
+    };
+    GOptionContext *context;
+    GError *error;
+
+    context = g_option_context_new("[JOB-FILE...] - render drawings in batch");
+    g_option_context_add_main_entries(context, entries, NULL);
+
+    error = NULL;
+    if (!g_option_context_parse(context, p_argc, p_argv, &error)) {
+        g_printerr("%s\n", error->message);
+        exit(2);
+    }
+
+    g_option_context_free(context);
+}
+
+
+int
+main(gint argc, gchar **argv)
+{
+    GThreadPool *pool;
+    GKeyFile *key_file;
+    GError *error;
+    gchar **groups;
+    gchar *stdin_argv[] = { NULL, "-", NULL };
+    gint n;
+    gsize g;
+
+#if !GLIB_CHECK_VERSION(2, 34, 0)
+    /* On GLib older than 2.34.0 g_type_init() *must* be called */
+    g_type_init();
+#endif
+
+    _adg_parse_args(&argc, &argv);
+
+    /* Without job files, read the jobs from the standard input */
+    if (argc < 2) {
+        stdin_argv[0] = argv[0];
+        argv = stdin_argv;
+        argc = 2;
+    }
+
+    pool = _adg_pool_new();
+
+    for (n = 1; n < argc; ++n) {
+        error = NULL;
+        key_file = _adg_load_jobs(argv[n], &error);
+        if (key_file == NULL) {
+            g_printerr("%s: %s\n", argv[n], error->message);
+            g_error_free(error);
+            ++_adg_n_failures;
+            continue;
+        }
+
+        groups = g_key_file_get_groups(key_file, NULL);
+        for (g = 0; groups[g] != NULL; ++g) {
+            AdgRenderJob *job = _adg_job_new(key_file, groups[g]);
+
+            if (pool != NULL)
+                g_thread_pool_push(pool, job, NULL);
+            else
+                _adg_run_job(job, NULL);
+        }
+
+        g_strfreev(groups);
+        g_key_file_free(key_file);
+    }
+
+    /* Wait for the pending jobs */
+    if (pool != NULL)
+        g_thread_pool_free(pool, FALSE, TRUE);
+
+    return _adg_n_failures > 0 ? 1 : 0;
+}